@@ -0,0 +1,101 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/area_model/area_estimator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/base/no_destructor.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+absl::StatusOr<int64_t> AreaEstimator::GetLogicArea(FunctionBase* f) const {
+  int64_t area = 0;
+  for (Node* node : f->nodes()) {
+    XLS_ASSIGN_OR_RETURN(int64_t node_area, GetOperationArea(node));
+    area += node_area;
+  }
+  return area;
+}
+
+AreaEstimatorManager& GetAreaEstimatorManagerSingleton() {
+  static absl::NoDestructor<AreaEstimatorManager> manager;
+  return *manager;
+}
+
+absl::StatusOr<AreaEstimator*> AreaEstimatorManager::GetAreaEstimator(
+    std::string_view name) const {
+  if (!estimators_.contains(name)) {
+    if (estimator_names_.empty()) {
+      return absl::NotFoundError(
+          absl::StrFormat("No area estimator found named \"%s\". No "
+                          "estimators are registered. Was InitXls called?",
+                          name));
+    }
+    return absl::NotFoundError(absl::StrFormat(
+        "No area estimator found named \"%s\". Available estimators: %s", name,
+        absl::StrJoin(estimator_names_, ", ")));
+  }
+  return estimators_.at(name).second.get();
+}
+
+absl::StatusOr<AreaEstimator*> AreaEstimatorManager::GetDefaultAreaEstimator()
+    const {
+  if (estimators_.empty()) {
+    return absl::NotFoundError(
+        "No area estimator has been registered. Did the build "
+        "target forget to link a plugin?");
+  }
+  int highest_precedence = 0;
+  AreaEstimator* highest = nullptr;
+  for (const std::string& name : estimator_names_) {
+    const std::pair<AreaEstimatorPrecedence, std::unique_ptr<AreaEstimator>>&
+        pair = estimators_.at(name);
+    int precedence_value = static_cast<int>(pair.first);
+    if (precedence_value > highest_precedence) {
+      highest_precedence = precedence_value;
+      highest = pair.second.get();
+    }
+  }
+  return highest;
+}
+
+absl::Status AreaEstimatorManager::RegisterAreaEstimator(
+    std::unique_ptr<AreaEstimator> area_estimator,
+    AreaEstimatorPrecedence precedence) {
+  std::string name = area_estimator->name();
+  if (estimators_.contains(name)) {
+    return absl::InternalError(
+        absl::StrFormat("Area estimator named %s already exists", name));
+  }
+  estimators_[name] = {precedence, std::move(area_estimator)};
+  estimator_names_.push_back(name);
+  std::sort(estimator_names_.begin(), estimator_names_.end());
+
+  return absl::OkStatus();
+}
+
+}  // namespace xls
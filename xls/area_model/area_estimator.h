@@ -0,0 +1,101 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_AREA_MODEL_AREA_ESTIMATOR_H_
+#define XLS_AREA_MODEL_AREA_ESTIMATOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// Abstraction describing an area model for XLS operations. Areas are integers
+// in units chosen by the model.
+class AreaEstimator {
+ public:
+  AreaEstimator(std::string_view name, int64_t register_area_per_bit)
+      : name_(name), register_area_per_bit_(register_area_per_bit) {}
+  virtual ~AreaEstimator() = default;
+
+  const std::string& name() const { return name_; }
+
+  // Returns the estimated area of the logic implementing the given node.
+  virtual absl::StatusOr<int64_t> GetOperationArea(Node* node) const = 0;
+
+  // Returns the estimated area of a register holding `bit_count` bits. By
+  // default this is linear in the bit count.
+  virtual int64_t GetRegisterArea(int64_t bit_count) const {
+    return bit_count * register_area_per_bit_;
+  }
+
+  int64_t register_area_per_bit() const { return register_area_per_bit_; }
+
+  // Returns the sum of the estimated areas of the nodes in `f`. Registers are
+  // not included.
+  absl::StatusOr<int64_t> GetLogicArea(FunctionBase* f) const;
+
+ private:
+  std::string name_;
+  int64_t register_area_per_bit_;
+};
+
+enum class AreaEstimatorPrecedence {
+  kLow = 1,
+  kMedium = 2,
+  kHigh = 3,
+};
+
+// An abstraction which holds multiple AreaEstimator objects organized by name.
+class AreaEstimatorManager {
+ public:
+  // Returns the area estimator with the given name, or returns an error if no
+  // such estimator exists.
+  absl::StatusOr<AreaEstimator*> GetAreaEstimator(std::string_view name) const;
+
+  absl::StatusOr<AreaEstimator*> GetDefaultAreaEstimator() const;
+
+  // Adds an AreaEstimator to the manager and associates it with its name.
+  absl::Status RegisterAreaEstimator(
+      std::unique_ptr<AreaEstimator> area_estimator,
+      AreaEstimatorPrecedence precedence);
+
+  // Returns a list of the names of available models in this manager.
+  absl::Span<const std::string> estimator_names() const {
+    return estimator_names_;
+  }
+
+ private:
+  absl::flat_hash_map<std::string, std::pair<AreaEstimatorPrecedence,
+                                             std::unique_ptr<AreaEstimator>>>
+      estimators_;
+  std::vector<std::string> estimator_names_;
+};
+
+// Returns the singleton manager which holds the area estimators.
+AreaEstimatorManager& GetAreaEstimatorManagerSingleton();
+
+}  // namespace xls
+
+#endif  // XLS_AREA_MODEL_AREA_ESTIMATOR_H_
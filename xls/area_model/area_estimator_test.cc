@@ -0,0 +1,103 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/area_model/area_estimator.h"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+// A test area estimator where the area of a node is its result bit count.
+class BitCountAreaEstimator : public AreaEstimator {
+ public:
+  explicit BitCountAreaEstimator(std::string_view name)
+      : AreaEstimator(name, /*register_area_per_bit=*/3) {}
+
+  absl::StatusOr<int64_t> GetOperationArea(Node* node) const override {
+    if (node->Is<Param>()) {
+      return 0;
+    }
+    return node->GetType()->GetFlatBitCount();
+  }
+};
+
+class AreaEstimatorTest : public IrTestBase {};
+
+TEST_F(AreaEstimatorTest, LogicAndRegisterArea) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  fb.Concat({fb.Add(x, fb.Literal(UBits(1, 8))), x});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  BitCountAreaEstimator estimator("bit_count");
+  // The literal, the add and the concat.
+  EXPECT_THAT(estimator.GetLogicArea(f), IsOkAndHolds(8 + 8 + 16));
+  EXPECT_EQ(estimator.GetRegisterArea(5), 15);
+  EXPECT_EQ(estimator.register_area_per_bit(), 3);
+}
+
+TEST_F(AreaEstimatorTest, Manager) {
+  AreaEstimatorManager manager;
+  EXPECT_THAT(manager.GetAreaEstimator("foo"),
+              StatusIs(absl::StatusCode::kNotFound,
+                       HasSubstr("No estimators are registered")));
+  EXPECT_THAT(manager.GetDefaultAreaEstimator(),
+              StatusIs(absl::StatusCode::kNotFound));
+
+  XLS_ASSERT_OK(manager.RegisterAreaEstimator(
+      std::make_unique<BitCountAreaEstimator>("low"),
+      AreaEstimatorPrecedence::kLow));
+  XLS_ASSERT_OK(manager.RegisterAreaEstimator(
+      std::make_unique<BitCountAreaEstimator>("high"),
+      AreaEstimatorPrecedence::kHigh));
+  EXPECT_THAT(manager.RegisterAreaEstimator(
+                  std::make_unique<BitCountAreaEstimator>("low"),
+                  AreaEstimatorPrecedence::kMedium),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("already exists")));
+
+  EXPECT_THAT(manager.estimator_names(), ElementsAre("high", "low"));
+  XLS_ASSERT_OK_AND_ASSIGN(AreaEstimator * low,
+                           manager.GetAreaEstimator("low"));
+  EXPECT_EQ(low->name(), "low");
+  XLS_ASSERT_OK_AND_ASSIGN(AreaEstimator * default_estimator,
+                           manager.GetDefaultAreaEstimator());
+  EXPECT_EQ(default_estimator->name(), "high");
+  EXPECT_THAT(manager.GetAreaEstimator("foo"),
+              StatusIs(absl::StatusCode::kNotFound,
+                       HasSubstr("Available estimators: high, low")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,30 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_AREA_MODEL_AREA_ESTIMATORS_H_
+#define XLS_AREA_MODEL_AREA_ESTIMATORS_H_
+
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/area_model/area_estimator.h"
+
+namespace xls {
+
+// Returns the registered area estimator with the given name.
+absl::StatusOr<AreaEstimator*> GetAreaEstimator(std::string_view name);
+
+}  // namespace xls
+
+#endif  // XLS_AREA_MODEL_AREA_ESTIMATORS_H_
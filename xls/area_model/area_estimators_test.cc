@@ -0,0 +1,57 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/area_model/area_estimators.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/area_model/area_estimator.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+
+class AreaEstimatorsTest : public IrTestBase {};
+
+TEST_F(AreaEstimatorsTest, UnitAreaModel) {
+  XLS_ASSERT_OK_AND_ASSIGN(AreaEstimator * estimator,
+                           GetAreaEstimator("unit"));
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue sum = fb.Add(x, y);
+  BValue negated = fb.Negate(sum);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(estimator->GetOperationArea(x.node()), IsOkAndHolds(0));
+  EXPECT_THAT(estimator->GetOperationArea(sum.node()), IsOkAndHolds(1));
+  EXPECT_THAT(estimator->GetOperationArea(negated.node()), IsOkAndHolds(1));
+  EXPECT_THAT(estimator->GetLogicArea(f), IsOkAndHolds(2));
+  EXPECT_EQ(estimator->GetRegisterArea(32), 32);
+}
+
+TEST_F(AreaEstimatorsTest, UnknownAreaModel) {
+  EXPECT_THAT(GetAreaEstimator("not_a_model"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,88 @@
+# Copyright 2024 The XLS Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+r"""Area model utility.
+
+Joins an "op_models" textproto and an "area data points" textproto, as written
+by timing_characterization_client --area_checkpoint_path, into a single
+"area_model" textproto.
+
+Usage:
+  area_model_join --op_models=/path/to/area_op_models.textproto \
+      --data_points=/path/to/area_data_points.textproto \
+      --output=/path/to/area_model.textproto
+"""
+
+from absl import app
+from absl import flags
+
+from google.protobuf import text_format
+from xls.area_model import area_model_pb2
+from xls.common import gfile
+from xls.delay_model import delay_model_pb2
+
+
+_OP_MODELS = flags.DEFINE_string(
+    'op_models', None,
+    'The file path/name location of the input op_models textproto.')
+flags.mark_flag_as_required('op_models')
+
+_DATA_POINTS = flags.DEFINE_string(
+    'data_points', None,
+    'The file path/name location of the input area data points textproto.')
+flags.mark_flag_as_required('data_points')
+
+_OUTPUT = flags.DEFINE_string(
+    'output', None,
+    'The file path/name to write the output area_model textproto.')
+
+
+def join(oms: delay_model_pb2.OpModels,
+         dps: area_model_pb2.AreaDataPoints) -> area_model_pb2.AreaModel:
+  """Returns the area model with the given op models and data points."""
+  am = area_model_pb2.AreaModel()
+  am.op_models.extend(oms.op_models)
+  am.data_points.extend(dps.data_points)
+  am.register_area_per_bit = dps.register_area_per_bit
+  return am
+
+
+def main(argv):
+  if len(argv) > 1:
+    raise app.UsageError('Too many command-line arguments.')
+
+  oms = delay_model_pb2.OpModels()
+  with gfile.open(_OP_MODELS.value, 'r') as f:
+    oms = text_format.Parse(f.read(), oms)
+
+  dps = area_model_pb2.AreaDataPoints()
+  with gfile.open(_DATA_POINTS.value, 'r') as f:
+    dps = text_format.Parse(f.read(), dps)
+
+  am = join(oms, dps)
+
+  print('# proto-file: xls/area_model/area_model.proto')
+  print('# proto-message: xls.area_model.AreaModel')
+  print(am, end='')
+
+  if _OUTPUT.value:
+    with gfile.open(_OUTPUT.value, 'w') as f:
+      f.write('# proto-file: xls/area_model/area_model.proto\n')
+      f.write('# proto-message: xls.area_model.AreaModel\n')
+      f.write(text_format.MessageToString(am))
+
+
+if __name__ == '__main__':
+  app.run(main)
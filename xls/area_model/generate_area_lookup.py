@@ -0,0 +1,100 @@
+# Copyright 2024 The XLS Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+"""Extracts an area model from a text proto, constructs C++ lookup code."""
+
+from absl import app
+from absl import flags
+
+import jinja2
+
+from google.protobuf import text_format
+from xls.area_model import area_model_pb2
+from xls.common import runfiles
+from xls.delay_model import delay_model
+from xls.delay_model import delay_model_pb2
+
+flags.DEFINE_string(
+    'model_name', None,
+    'Name of model. Should be a short string (e.g., "unit"). Used as the '
+    'identifier when accessing the model via xls::GetAreaEstimator.')
+flags.DEFINE_enum(
+    'precedence',
+    None,
+    help='Precedence of model.',
+    enum_values=('kLow', 'kMedium', 'kHigh'))
+flags.mark_flag_as_required('model_name')
+flags.mark_flag_as_required('precedence')
+FLAGS = flags.FLAGS
+
+
+def to_delay_model_proto(
+    area_model: area_model_pb2.AreaModel) -> delay_model_pb2.DelayModel:
+  """Returns a DelayModel whose "delays" are the areas of `area_model`.
+
+  This lets area models share the estimators and code generation of delay
+  models.
+
+  Args:
+    area_model: The area model to convert.
+  """
+  result = delay_model_pb2.DelayModel()
+  result.op_models.extend(area_model.op_models)
+  for area_data_point in area_model.data_points:
+    data_point = result.data_points.add()
+    data_point.operation.CopyFrom(area_data_point.operation)
+    data_point.delay = area_data_point.area
+    data_point.delay_offset = area_data_point.area_offset
+  return result
+
+
+def main(argv):
+  if len(argv) > 2:
+    raise app.UsageError('Too many command-line arguments.')
+
+  with open(argv[1], 'rb') as f:
+    contents = f.read()
+
+  am = text_format.Parse(contents, area_model_pb2.AreaModel())
+  dm = delay_model.DelayModel(to_delay_model_proto(am))
+  for op in dm.ops():
+    for estimator in dm.op_model(op).estimators():
+      if isinstance(estimator, delay_model.LogicalEffortEstimator):
+        raise app.UsageError(
+            f'Logical effort estimators are not supported in area models: {op}'
+        )
+
+  env = jinja2.Environment(undefined=jinja2.StrictUndefined)
+  tmpl_text = runfiles.get_contents_as_text(
+      'xls/area_model/generate_area_lookup.tmpl')
+  template = env.from_string(tmpl_text)
+  rendered = template.render(
+      area_model=dm,
+      register_area_per_bit=am.register_area_per_bit,
+      name=FLAGS.model_name,
+      precedence=FLAGS.precedence,
+      camel_case_name=''.join(
+          s.capitalize() for s in FLAGS.model_name.split('_')))
+  print(
+      '// DO NOT EDIT: this file is AUTOMATICALLY GENERATED by'
+      ' generate_area_lookup.py from {} and should not be changed.'.format(
+          argv[1]
+      )
+  )
+  print(rendered)
+
+
+if __name__ == '__main__':
+  app.run(main)
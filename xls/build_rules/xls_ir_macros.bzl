@@ -206,7 +206,8 @@ def xls_ir_cc_library_macro(
         name,
         src,
         top = None,
-        namespaces = ""):
+        namespaces = "",
+        is_proc_network = False):
     """Invokes the AOT compiles the input IR into a cc_library.
 
     Example:
@@ -228,17 +229,23 @@ def xls_ir_cc_library_macro(
     This will produce a cc_library that will execute the fn `bar` from the
     `foo` IR file. The call itself will be inside the namespace `a::b::c`.
 
+    If `top` is a proc, the proc network elaborated from it is compiled instead
+    and `is_proc_network` must be set. The library then provides a class named
+    after the proc which runs the network with a SerialProcRuntime.
+
     Args:
       name: The name of the resulting library.
       src: The path to the IR file to compile.
       top: The entry point in the IR file of interest.
       namespaces: A comma-separated list of namespaces into which the
                   generated code should go.
+      is_proc_network: Whether `top` is a proc.
     """
     string_type_check("name", name)
     string_type_check("src", src)
     string_type_check("top", top, True)
     string_type_check("namespaces", namespaces)
+    bool_type_check("is_proc_network", is_proc_network)
 
     header_file = name + ".h"
     object_file = name + ".o"
@@ -254,6 +261,28 @@ def xls_ir_cc_library_macro(
         with_msan = XLS_IS_MSAN_BUILD,
     )
 
+    function_deps = [
+        "@com_google_absl//absl/status:statusor",
+        "@com_google_absl//absl/types:span",
+        "//xls/ir:events",
+        "//xls/ir:value",
+        "//xls/jit:aot_runtime",
+        "//xls/jit:type_layout",
+    ]
+    proc_network_deps = [
+        "@com_google_absl//absl/memory",
+        "@com_google_absl//absl/status",
+        "@com_google_absl//absl/status:statusor",
+        "//xls/common/status:status_macros",
+        "//xls/interpreter:serial_proc_runtime",
+        "//xls/ir",
+        "//xls/ir:ir_parser",
+        "//xls/jit:aot_entrypoint_cc_proto",
+        "//xls/jit:function_base_jit",
+        "//xls/jit:jit_channel_queue",
+        "//xls/jit:jit_proc_runtime",
+        "@com_google_protobuf//:protobuf",
+    ]
     native.cc_library(
         name = name,
         srcs = [
@@ -264,12 +293,5 @@ def xls_ir_cc_library_macro(
             ":" + header_file,
         ],
         # The XLS AOT compiler does not currently support cross-compilation.
-        deps = [
-            "@com_google_absl//absl/status:statusor",
-            "@com_google_absl//absl/types:span",
-            "//xls/ir:events",
-            "//xls/ir:value",
-            "//xls/jit:aot_runtime",
-            "//xls/jit:type_layout",
-        ],
+        deps = proc_network_deps if is_proc_network else function_deps,
     )
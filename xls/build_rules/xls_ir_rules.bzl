@@ -130,8 +130,10 @@ def _convert_to_ir(ctx, src):
     """
     ir_converter_tool = ctx.executable._xls_ir_converter_tool
     IR_CONV_FLAGS = (
+        "compile_server",
         "dslx_path",
         "emit_fail_as_assert",
+        "simplify_ir",
         "warnings_as_errors",
         "disable_warnings",
     )
@@ -213,6 +215,8 @@ def _optimize_ir(ctx, src, original_input_files):
         "convert_array_index_to_select",
         "inline_procs",
         "use_context_narrowing_analysis",
+        "opt_cache_dir",
+        "incremental_verification_interval",
         "top",
     )
 
@@ -296,6 +300,9 @@ def get_ir_equivalence_test_cmd(
     ir_equivalence_tool = ctx.executable._xls_ir_equivalence_tool
     IR_EQUIVALENCE_FLAGS = (
         "timeout",
+        "sweep",
+        "sweep_sample_count",
+        "sweep_candidate_timeout",
     )
 
     ir_equivalence_args = dict(ctx.attr.ir_equivalence_args)
@@ -344,6 +351,7 @@ def get_eval_ir_test_cmd(ctx, src, append_cmd_line_args = True):
     IR_EVAL_FLAGS = (
         "input",
         "input_file",
+        "input_proto_file",
         "random_inputs",
         "expected",
         "expected_file",
@@ -444,6 +452,10 @@ def get_benchmark_ir_cmd(ctx, src, append_cmd_line_args = True):
         "inline_procs",
         "use_context_narrowing_analysis",
         "run_evaluators",
+        "evaluator_run_ms",
+        "evaluator_warmup_ms",
+        "evaluator_batch_size",
+        "evaluator_threads",
     ] + _CODEGEN_FLAGS + _SCHEDULING_FLAGS
 
     benchmark_ir_args = append_default_to_args(
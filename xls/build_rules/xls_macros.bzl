@@ -375,7 +375,8 @@ def xls_dslx_opt_ir_macro(
 def xls_dslx_cpp_type_library(
         name,
         src,
-        namespace = None):
+        namespace = None,
+        packed_conversions = False):
     """Creates a cc_library target for transpiled DSLX types.
 
     This macros invokes the DSLX-to-C++ transpiler and compiles the result as
@@ -385,6 +386,8 @@ def xls_dslx_cpp_type_library(
       name: The name of the eventual cc_library.
       src: The DSLX file whose types to compile as C++.
       namespace: The C++ namespace to generate the code in (e.g., `foo::bar`).
+      packed_conversions: Whether to also generate conversions to and from the
+        packed layout taken by the JIT's packed views.
     """
     native.genrule(
         name = name + "_generate_sources",
@@ -400,6 +403,7 @@ def xls_dslx_cpp_type_library(
               "--output_header_path=$(@D)/{}.h ".format(name) +
               "--output_source_path=$(@D)/{}.cc ".format(name) +
               ("" if namespace == None else "--namespaces={} ".format(namespace)) +
+              ("--emit_packed_conversions " if packed_conversions else "") +
               "$(location {})".format(src),
     )
 
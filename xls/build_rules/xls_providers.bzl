@@ -107,6 +107,9 @@ CODEGEN_FIELDS = {
     "max_trace_verbosity": "Maximum verbosity for traces. Traces with higher " +
                            "verbosity are stripped from codegen output. 0 by " +
                            "default.",
+    "min_delay_line_length": "If at least 2, chains of at least this many " +
+                             "pass-through pipeline registers are emitted " +
+                             "as delay lines.",
     "register_merge_strategy": "The strategy to use for merging registers. Either " +
                                "'IdentityOnly' or 'None'",
 }
@@ -116,6 +119,17 @@ SCHEDULING_FIELDS = {
                        "scheduling.",
     "pipeline_stages": "Optional(string): The number of pipeline stages.",
     "delay_model": "Optional(string) Delay model used in codegen.",
+    "area_model": "Optional(string) Area model whose estimated pipeline " +
+                  "register area the SDC scheduler minimizes.",
+    "scheduling_strategy": "Optional(string) The scheduler to use: 'sdc' " +
+                           "(the default), 'min_cut', 'list' or " +
+                           "'partitioned_sdc'.",
+    "refine_list_schedule_with_sdc": "If true, the schedule found by the " +
+                                     "list scheduler is refined with the " +
+                                     "SDC scheduler.",
+    "max_scheduling_region_size": "The maximum number of nodes in each " +
+                                  "region scheduled by the partitioned SDC " +
+                                  "scheduler.",
     "clock_margin_percent": "The percentage of clock period to set aside as " +
                             "a margin to ensure timing is met.",
     "period_relaxation_percent": "The percentage of clock period that will " +
@@ -128,6 +142,8 @@ SCHEDULING_FIELDS = {
                                       "when `--clock_period_ps` is given but is infeasible for " +
                                       "scheduling, will print a warning and continue scheduling " +
                                       "as if the shortest feasible clock period had been given.",
+    "scheduling_threads": "The number of threads to use when searching for the " +
+                          "minimum feasible clock period.",
     "minimize_worst_case_throughput": "If true, when `--worst_case_throughput` " +
                                       "is not given, search for & report the best " +
                                       "possible worst-case throughput of the circuit " +
@@ -171,6 +187,10 @@ SCHEDULING_FIELDS = {
     "fdo_yosys_path": "Absolute path of Yosys.",
     "fdo_sta_path": "Absolute path of OpenSTA.",
     "fdo_synthesis_libraries": "Synthesis and STA libraries.",
+    "fdo_synthesis_cache_dir": "Directory in which FDO synthesis results " +
+                               "are cached across runs.",
+    "fdo_synthesis_batch_size": "Number of node cuts synthesized by each " +
+                                "invocation of the synthesis tools.",
     "multi_proc": "If true, schedule all procs and codegen them all.",
 }
 
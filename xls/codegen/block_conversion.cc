@@ -2202,18 +2202,35 @@ class CloneNodesIntoBlockHandler {
   // scheduled at or before this cycle and has a use after this cycle.
   absl::Status AddNextPipelineStage(const PipelineSchedule& schedule,
                                     int64_t stage) {
-    for (Node* function_base_node : function_base_->nodes()) {
-      if (schedule.IsLiveOutOfCycle(function_base_node, stage)) {
-        Node* node = node_map_.at(function_base_node);
+    if (live_out_of_stage_.empty()) {
+      // Bucket the nodes by the stages they are live out of once rather than
+      // scanning every node for every stage, which is quadratic for deep
+      // pipelines of large functions. Nodes are kept in the order of
+      // function_base_->nodes() so registers are created in a stable order.
+      live_out_of_stage_.resize(schedule.length());
+      for (Node* function_base_node : function_base_->nodes()) {
+        std::optional<int64_t> last_stage =
+            schedule.LastCycleLiveOutOf(function_base_node);
+        if (!last_stage.has_value()) {
+          continue;
+        }
+        for (int64_t s = schedule.cycle(function_base_node); s <= *last_stage;
+             ++s) {
+          live_out_of_stage_[s].push_back(function_base_node);
+        }
+      }
+    }
 
-        XLS_ASSIGN_OR_RETURN(
-            Node * node_after_stage,
-            CreatePipelineRegistersForNode(
-                PipelineSignalName(node->GetName(), stage), node, stage,
-                result_.pipeline_registers.at(stage)));
+    for (Node* function_base_node : live_out_of_stage_.at(stage)) {
+      Node* node = node_map_.at(function_base_node);
 
-        node_map_[function_base_node] = node_after_stage;
-      }
+      XLS_ASSIGN_OR_RETURN(
+          Node * node_after_stage,
+          CreatePipelineRegistersForNode(
+              PipelineSignalName(node->GetName(), stage), node, stage,
+              result_.pipeline_registers.at(stage)));
+
+      node_map_[function_base_node] = node_after_stage;
     }
 
     return absl::OkStatus();
@@ -2827,6 +2844,9 @@ class CloneNodesIntoBlockHandler {
   absl::flat_hash_map<Node*, Node*> node_map_;
   absl::flat_hash_set<int64_t> loopback_channel_ids_;
   absl::flat_hash_map<int64_t, xls::Instantiation*> fifo_instantiations_;
+  // The nodes of function_base_ which are live out of each stage, computed on
+  // the first call to AddNextPipelineStage.
+  std::vector<std::vector<Node*>> live_out_of_stage_;
 };
 
 // Adds the nodes in the given schedule to the block. Pipeline registers are
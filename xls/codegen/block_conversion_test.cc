@@ -29,6 +29,7 @@
 #include <utility>
 #include <vector>
 
+#include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
@@ -5615,6 +5616,55 @@ TEST_F(ProcConversionTestFixture, DISABLED_SimpleMultiProcConversion) {
       PackageToPipelinedBlocks(schedules, options, p.get()));
 }
 
+// Benchmark of converting a deep pipeline with many live values to a block.
+// The function has `width` parameters, each of which is incremented once in
+// every one of the `stages` stages, and all of the parameters are also used in
+// the final stage, so each stage has 2 * `width` pipeline registers.
+void BM_FunctionToPipelinedBlock(benchmark::State& state) {
+  const int64_t stages = state.range(0);
+  const int64_t width = state.range(1);
+  for (auto _ : state) {
+    state.PauseTiming();
+    Package package("benchmark_pkg");
+    FunctionBuilder fb("deep_pipeline", &package);
+    ScheduleCycleMap cycle_map;
+    std::vector<BValue> params;
+    for (int64_t i = 0; i < width; ++i) {
+      params.push_back(
+          fb.Param(absl::StrCat("x", i), package.GetBitsType(32)));
+      cycle_map[params.back().node()] = 0;
+    }
+    std::vector<BValue> values = params;
+    for (int64_t stage = 0; stage < stages; ++stage) {
+      for (BValue& value : values) {
+        value = fb.Add(value, fb.Literal(UBits(1, 32)));
+        cycle_map[value.node()] = stage;
+        cycle_map[value.node()->operand(1)] = stage;
+      }
+    }
+    std::vector<BValue> results;
+    for (int64_t i = 0; i < width; ++i) {
+      results.push_back(fb.Add(values[i], params[i]));
+      cycle_map[results.back().node()] = stages - 1;
+    }
+    BValue ret = fb.Tuple(results);
+    cycle_map[ret.node()] = stages - 1;
+    absl::StatusOr<Function*> f = fb.BuildWithReturnValue(ret);
+    CHECK_OK(f.status());
+    PipelineSchedule schedule(*f, cycle_map, /*length=*/stages);
+    CodegenOptions options;
+    options.flop_inputs(false).flop_outputs(false).clock_name("clk");
+    state.ResumeTiming();
+
+    absl::StatusOr<CodegenPassUnit> unit =
+        FunctionBaseToPipelinedBlock(schedule, options, *f);
+    CHECK_OK(unit.status());
+    benchmark::DoNotOptimize(unit->top_block);
+  }
+}
+
+BENCHMARK(BM_FunctionToPipelinedBlock)->RangePair(2, 256, 1, 64);
+
 }  // namespace
 }  // namespace verilog
 }  // namespace xls
@@ -15,10 +15,12 @@
 #include "xls/codegen/block_generator.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <initializer_list>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -26,6 +28,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
@@ -36,6 +39,8 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/codegen/block_conversion.h"
+#include "xls/codegen/block_verilog_cache.h"
+#include "xls/codegen/block_verilog_cache.pb.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/flattening.h"
 #include "xls/codegen/module_builder.h"
@@ -49,6 +54,7 @@
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/block.h"
 #include "xls/ir/format_preference.h"
@@ -56,6 +62,7 @@
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
+#include "xls/ir/package.h"
 #include "xls/ir/register.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/topo_sort.h"
@@ -893,6 +900,34 @@ absl::StatusOr<std::vector<Block*>> GatherInstantiatedBlocks(Block* top) {
   return blocks;
 }
 
+// Adds a mapping to `verilog_line_map` for each source location of the nodes
+// recorded in `line_info`.
+absl::Status AddLineMappings(Package* package, const LineInfo& line_info,
+                             VerilogLineMap* verilog_line_map) {
+  for (const auto& [vast_node, partial_spans] : line_info.Spans()) {
+    std::optional<std::vector<LineSpan>> spans =
+        line_info.LookupNode(vast_node);
+    if (!spans.has_value()) {
+      return absl::InternalError("Unbalanced calls to LineInfo::{Start, End}");
+    }
+    for (const LineSpan& span : spans.value()) {
+      SourceInfo info = vast_node->loc();
+      for (const SourceLocation& loc : info.locations) {
+        int64_t line = static_cast<int32_t>(loc.lineno());
+        VerilogLineMapping* mapping = verilog_line_map->add_mapping();
+        mapping->set_source_file(
+            package->GetFilename(loc.fileno()).value_or(""));
+        mapping->mutable_source_span()->set_line_start(line);
+        mapping->mutable_source_span()->set_line_end(line);
+        mapping->set_verilog_file("");  // to be updated later on
+        mapping->mutable_verilog_span()->set_line_start(span.StartLine());
+        mapping->mutable_verilog_span()->set_line_end(span.EndLine());
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 absl::StatusOr<std::string> GenerateVerilog(Block* top,
@@ -905,43 +940,86 @@ absl::StatusOr<std::string> GenerateVerilog(Block* top,
 
   XLS_ASSIGN_OR_RETURN(std::vector<Block*> blocks,
                        GatherInstantiatedBlocks(top));
-  VerilogFile file(options.use_system_verilog() ? FileType::kSystemVerilog
-                                                : FileType::kVerilog);
-  for (Block* block : blocks) {
+
+  // Blocks only read the IR so the module of each block is generated and
+  // emitted concurrently into its own file. The fragments are concatenated in
+  // the order of `blocks` afterwards so the output is deterministic. Line
+  // numbers in the line map of each fragment are relative to its text.
+  struct Fragment {
+    std::string text;
+    VerilogLineMap line_map;
+  };
+  bool use_cache = options.verilog_cache_dir().has_value();
+  bool build_line_maps = verilog_line_map != nullptr || use_cache;
+  std::vector<absl::StatusOr<Fragment>> fragments(blocks.size());
+  auto generate_fragment = [&](Block* block) -> absl::StatusOr<Fragment> {
+    if (use_cache) {
+      XLS_ASSIGN_OR_RETURN(std::optional<BlockVerilogCacheEntryProto> entry,
+                           LookupBlockVerilog(block, options));
+      if (entry.has_value()) {
+        VLOG(2) << "Reusing cached Verilog of block " << block->name();
+        return Fragment{
+            .text = std::move(*entry->mutable_verilog_text()),
+            .line_map = std::move(*entry->mutable_verilog_line_map())};
+      }
+    }
+    VerilogFile file(options.use_system_verilog() ? FileType::kSystemVerilog
+                                                  : FileType::kVerilog);
     XLS_RETURN_IF_ERROR(BlockGenerator::Generate(block, &file, options));
-    if (block != blocks.back()) {
-      file.Add(file.Make<BlankLine>(SourceInfo()));
-      file.Add(file.Make<BlankLine>(SourceInfo()));
+    LineInfo line_info;
+    Fragment fragment{.text = file.Emit(&line_info)};
+    if (build_line_maps) {
+      XLS_RETURN_IF_ERROR(
+          AddLineMappings(top->package(), line_info, &fragment.line_map));
+    }
+    if (use_cache) {
+      XLS_RETURN_IF_ERROR(
+          CacheBlockVerilog(block, options, fragment.text, fragment.line_map));
+    }
+    return fragment;
+  };
+  int64_t thread_count = std::min<int64_t>(std::max(1, AvailableCPUs()),
+                                           static_cast<int64_t>(blocks.size()));
+  if (thread_count <= 1) {
+    for (int64_t i = 0; i < blocks.size(); ++i) {
+      fragments[i] = generate_fragment(blocks[i]);
+    }
+  } else {
+    std::atomic<int64_t> next_index = 0;
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t t = 0; t < thread_count; ++t) {
+      threads.push_back(std::make_unique<Thread>([&]() {
+        for (int64_t i = next_index++; i < blocks.size(); i = next_index++) {
+          fragments[i] = generate_fragment(blocks[i]);
+        }
+      }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
     }
   }
 
-  LineInfo line_info;
-  std::string text = file.Emit(&line_info);
-  if (verilog_line_map != nullptr) {
-    for (const auto& [vast_node, partial_spans] : line_info.Spans()) {
-      std::optional<std::vector<LineSpan>> spans =
-          line_info.LookupNode(vast_node);
-      if (!spans.has_value()) {
-        return absl::InternalError(
-            "Unbalanced calls to LineInfo::{Start, End}");
-      }
-      for (const LineSpan& span : spans.value()) {
-        SourceInfo info = vast_node->loc();
-        for (const SourceLocation& loc : info.locations) {
-          int64_t line = static_cast<int32_t>(loc.lineno());
-          VerilogLineMapping* mapping = verilog_line_map->add_mapping();
-          mapping->set_source_file(
-              top->package()->GetFilename(loc.fileno()).value_or(""));
-          mapping->mutable_source_span()->set_line_start(line);
-          mapping->mutable_source_span()->set_line_end(line);
-          mapping->set_verilog_file("");  // to be updated later on
-          mapping->mutable_verilog_span()->set_line_start(span.StartLine());
-          mapping->mutable_verilog_span()->set_line_end(span.EndLine());
-        }
+  // The modules of the blocks are separated by two blank lines.
+  std::string text;
+  int64_t line_offset = 0;
+  for (int64_t i = 0; i < fragments.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(Fragment fragment, std::move(fragments[i]));
+    if (i != 0) {
+      absl::StrAppend(&text, "\n\n");
+      line_offset += 2;
+    }
+    if (verilog_line_map != nullptr) {
+      for (VerilogLineMapping& mapping : *fragment.line_map.mutable_mapping()) {
+        SourceSpan* span = mapping.mutable_verilog_span();
+        span->set_line_start(span->line_start() + line_offset);
+        span->set_line_end(span->line_end() + line_offset);
+        *verilog_line_map->add_mapping() = std::move(mapping);
       }
     }
+    absl::StrAppend(&text, fragment.text);
+    line_offset += absl::c_count(fragment.text, '\n');
   }
-
   VLOG(2) << "Verilog output:";
   XLS_VLOG_LINES(2, text);
 
@@ -33,15 +33,20 @@
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "xls/codegen/block_conversion.h"
+#include "xls/codegen/block_verilog_cache.pb.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/codegen_pass.h"
 #include "xls/codegen/codegen_pass_pipeline.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/op_override_impls.h"
 #include "xls/codegen/signature_generator.h"
+#include "xls/codegen/verilog_line_map.pb.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
@@ -51,6 +56,7 @@
 #include "xls/ir/block.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
+#include "xls/ir/fileno.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/instantiation.h"
 #include "xls/ir/ir_parser.h"
@@ -900,6 +906,110 @@ TEST_P(BlockGeneratorTest, InstantiatedBlock) {
   XLS_ASSERT_OK(tb->Run());
 }
 
+TEST_P(BlockGeneratorTest, ManyInstantiatedBlocks) {
+  constexpr int64_t kBlockCount = 16;
+  Package package(TestBaseName());
+  Type* u32 = package.GetBitsType(32);
+
+  BlockBuilder bb("my_block", &package);
+  BValue x = bb.InputPort("x", u32);
+  BValue y = bb.InputPort("y", u32);
+  BValue value = x;
+  for (int64_t i = 0; i < kBlockCount; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Block * sub_block,
+        MakeSubtractBlock(absl::StrCat("subtractor", i), &package));
+    XLS_ASSERT_OK_AND_ASSIGN(xls::Instantiation * subtractor,
+                             bb.block()->AddBlockInstantiation(
+                                 absl::StrCat("sub", i), sub_block));
+    bb.InstantiationInput(subtractor, "a", value);
+    bb.InstantiationInput(subtractor, "b", y);
+    value = bb.InstantiationOutput(subtractor, "result");
+  }
+  SourceLocation loc = package.AddSourceLocation("foo.x", Lineno(42), Colno(0));
+  BValue sum = bb.Add(value, x, SourceInfo(loc));
+  bb.OutputPort("out", sum);
+  bb.OutputPort("out_shifted", bb.Shll(sum, y));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  VerilogLineMap line_map;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string verilog,
+      GenerateVerilog(block, codegen_options(), &line_map));
+
+  // The module of each block appears in instantiation order, separated by two
+  // blank lines, and the top block comes last.
+  std::vector<std::string_view> lines = absl::StrSplit(verilog, '\n');
+  std::vector<std::string> modules;
+  int64_t top_module_line = -1;
+  for (int64_t i = 0; i < lines.size(); ++i) {
+    if (!absl::StartsWith(lines[i], "module ")) {
+      continue;
+    }
+    if (!modules.empty()) {
+      ASSERT_GE(i, 2);
+      EXPECT_TRUE(lines[i - 1].empty() && lines[i - 2].empty());
+    }
+    modules.push_back(std::string(lines[i]));
+    top_module_line = i;
+  }
+  ASSERT_EQ(modules.size(), kBlockCount + 1);
+  for (int64_t i = 0; i < kBlockCount; ++i) {
+    EXPECT_EQ(modules[i], absl::StrCat("module subtractor", i, "("));
+  }
+  EXPECT_EQ(modules.back(), "module my_block(");
+
+  // Lines of the mappings are relative to the whole file.
+  int64_t mappings_of_sum = 0;
+  for (const VerilogLineMapping& mapping : line_map.mapping()) {
+    if (mapping.source_span().line_start() != 42) {
+      continue;
+    }
+    ++mappings_of_sum;
+    EXPECT_GT(mapping.verilog_span().line_start(), top_module_line);
+    EXPECT_LT(mapping.verilog_span().line_end(), lines.size());
+  }
+  EXPECT_GT(mappings_of_sum, 0);
+}
+
+TEST_P(BlockGeneratorTest, VerilogCache) {
+  Package package(TestBaseName());
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * sub_block,
+                           MakeSubtractBlock("subtractor", &package));
+  BlockBuilder bb("my_block", &package);
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Instantiation * subtractor,
+                           bb.block()->AddBlockInstantiation("sub", sub_block));
+  bb.InstantiationInput(subtractor, "a", bb.InputPort("x", u32));
+  bb.InstantiationInput(subtractor, "b", bb.InputPort("y", u32));
+  bb.OutputPort("out", bb.InstantiationOutput(subtractor, "result"));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory cache_dir, TempDirectory::Create());
+  CodegenOptions options = codegen_options();
+  options.verilog_cache(cache_dir.path().string(), "key");
+  XLS_ASSERT_OK_AND_ASSIGN(std::string uncached,
+                           GenerateVerilog(block, codegen_options()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string cached,
+                           GenerateVerilog(block, options));
+  EXPECT_EQ(cached, uncached);
+
+  // Tamper with the cached module of the subtractor to observe its reuse.
+  std::filesystem::path entry_path =
+      cache_dir.path() / "subtractor.verilog_cache";
+  BlockVerilogCacheEntryProto entry;
+  XLS_ASSERT_OK(ParseProtobinFile(entry_path, &entry));
+  entry.set_verilog_text(absl::StrCat("// cached\n", entry.verilog_text()));
+  XLS_ASSERT_OK(SetProtobinFile(entry_path, entry));
+  XLS_ASSERT_OK_AND_ASSIGN(cached, GenerateVerilog(block, options));
+  EXPECT_EQ(cached, absl::StrCat("// cached\n", uncached));
+
+  // Entries produced with a different key are not reused.
+  options.verilog_cache(cache_dir.path().string(), "other key");
+  XLS_ASSERT_OK_AND_ASSIGN(cached, GenerateVerilog(block, options));
+  EXPECT_EQ(cached, uncached);
+}
+
 TEST_P(BlockGeneratorTest, InstantiatedBlockWithClockButNoClock) {
   Package package(TestBaseName());
   Type* u32 = package.GetBitsType(32);
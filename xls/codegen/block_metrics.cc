@@ -19,6 +19,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/log/log.h"
 #include "absl/strings/str_format.h"
 #include "xls/codegen/xls_metrics.pb.h"
@@ -40,37 +41,19 @@ int64_t GenerateFlopCount(Block* block) {
   return count;
 }
 
-// Returns true if there is a combinational feedthrough path from an input port
-// to an output port.
-bool HasFeedthroughPass(Block* block) {
-  // Nodes which have a combinational path from an input port.
-  absl::flat_hash_set<Node*> input_path_nodes;
-  for (Node* node : TopoSort(block)) {
-    if (node->Is<InputPort>()) {
-      input_path_nodes.insert(node);
-      continue;
-    }
-    for (Node* operand : node->operands()) {
-      if (operand->GetType()->GetFlatBitCount() > 0 &&
-          input_path_nodes.contains(operand)) {
-        input_path_nodes.insert(node);
-        break;
-      }
-    }
-    if (node->Is<OutputPort>() && input_path_nodes.contains(node)) {
-      return true;
-    }
-  }
-  return false;
-}
-
-// Sets the delay fields of `proto` based on analysis of `block`.
-absl::Status SetDelayFields(Block* block, const DelayEstimator& delay_estimator,
-                            BlockMetricsProto* proto) {
-  // Maximum delay from input to each node.
+// Sets the feedthrough field and, if `delay_estimator` is non-null, the delay
+// fields of `proto` with a single topological traversal of `block`.
+absl::Status SetPathFields(Block* block, const DelayEstimator* delay_estimator,
+                           BlockMetricsProto* proto) {
+  // Maximum delay from input to each node. Contains exactly the nodes which
+  // have a combinational path from an input port.
   absl::flat_hash_map<Node*, int64_t> input_delay_map;
   // Maximum delay from a register read to each node.
   absl::flat_hash_map<Node*, int64_t> reg_delay_map;
+  input_delay_map.reserve(block->node_count());
+  reg_delay_map.reserve(block->node_count());
+
+  bool feedthrough_path_exists = false;
 
   // Delay metrics to set on the proto.
   std::optional<int64_t> max_reg_to_reg_delay;
@@ -78,33 +61,46 @@ absl::Status SetDelayFields(Block* block, const DelayEstimator& delay_estimator,
   std::optional<int64_t> max_reg_to_output_delay;
   std::optional<int64_t> max_feedthrough_path_delay;
 
+  auto optional_max = [](int64_t value, std::optional<int64_t> opt_value) {
+    if (opt_value.has_value()) {
+      return std::max(value, opt_value.value());
+    }
+    return value;
+  };
+
   for (Node* node : TopoSort(block)) {
     if (node->Is<InputPort>()) {
       input_delay_map[node] = 0;
       continue;
     }
 
-    auto optional_max = [](int64_t value, std::optional<int64_t> opt_value) {
-      if (opt_value.has_value()) {
-        return std::max(value, opt_value.value());
-      }
-      return value;
-    };
-    absl::StatusOr<int64_t> node_delay_or =
-        delay_estimator.GetOperationDelayInPs(node);
-    int64_t node_delay = node_delay_or.ok() ? node_delay_or.value() : 0;
+    // Nodes which are not on a path from an input port or a register do not
+    // contribute to any metric so skip estimating their delay.
+    if (!node->Is<RegisterRead>() &&
+        absl::c_none_of(node->operands(), [&](Node* operand) {
+          return input_delay_map.contains(operand) ||
+                 reg_delay_map.contains(operand);
+        })) {
+      continue;
+    }
+
+    int64_t node_delay = 0;
+    if (delay_estimator != nullptr) {
+      absl::StatusOr<int64_t> node_delay_or =
+          delay_estimator->GetOperationDelayInPs(node);
+      node_delay = node_delay_or.ok() ? node_delay_or.value() : 0;
+    }
 
     std::optional<int64_t> input_delay;
     std::optional<int64_t> reg_delay;
     for (Node* operand : node->operands()) {
       if (operand->GetType()->GetFlatBitCount() > 0) {
-        if (input_delay_map.contains(operand)) {
-          input_delay = optional_max(input_delay_map.at(operand) + node_delay,
-                                     input_delay);
+        if (auto it = input_delay_map.find(operand);
+            it != input_delay_map.end()) {
+          input_delay = optional_max(it->second + node_delay, input_delay);
         }
-        if (reg_delay_map.contains(operand)) {
-          reg_delay =
-              optional_max(reg_delay_map.at(operand) + node_delay, reg_delay);
+        if (auto it = reg_delay_map.find(operand); it != reg_delay_map.end()) {
+          reg_delay = optional_max(it->second + node_delay, reg_delay);
         }
       }
     }
@@ -116,14 +112,15 @@ absl::Status SetDelayFields(Block* block, const DelayEstimator& delay_estimator,
     }
 
     if (node->Is<OutputPort>()) {
+      feedthrough_path_exists |= input_delay.has_value();
       Node* data = node->operand(0);
-      if (input_delay_map.contains(data)) {
+      if (auto it = input_delay_map.find(data); it != input_delay_map.end()) {
         max_feedthrough_path_delay =
-            optional_max(input_delay_map.at(data), max_feedthrough_path_delay);
+            optional_max(it->second, max_feedthrough_path_delay);
       }
-      if (reg_delay_map.contains(data)) {
+      if (auto it = reg_delay_map.find(data); it != reg_delay_map.end()) {
         max_reg_to_output_delay =
-            optional_max(reg_delay_map.at(data), max_reg_to_output_delay);
+            optional_max(it->second, max_reg_to_output_delay);
       }
       continue;
     }
@@ -141,19 +138,25 @@ absl::Status SetDelayFields(Block* block, const DelayEstimator& delay_estimator,
         operands.push_back(node->As<RegisterWrite>()->load_enable().value());
       }
       for (Node* operand : operands) {
-        if (input_delay_map.contains(operand)) {
+        if (auto it = input_delay_map.find(operand);
+            it != input_delay_map.end()) {
           max_input_to_reg_delay =
-              optional_max(input_delay_map.at(operand), max_input_to_reg_delay);
+              optional_max(it->second, max_input_to_reg_delay);
         }
-        if (reg_delay_map.contains(operand)) {
-          max_reg_to_reg_delay =
-              optional_max(reg_delay_map.at(operand), max_reg_to_reg_delay);
+        if (auto it = reg_delay_map.find(operand); it != reg_delay_map.end()) {
+          max_reg_to_reg_delay = optional_max(it->second, max_reg_to_reg_delay);
         }
       }
       continue;
     }
   }
 
+  proto->set_feedthrough_path_exists(feedthrough_path_exists);
+  if (delay_estimator == nullptr) {
+    return absl::OkStatus();
+  }
+
+  proto->set_delay_model(delay_estimator->name());
   if (max_reg_to_reg_delay.has_value()) {
     proto->set_max_reg_to_reg_delay_ps(max_reg_to_reg_delay.value());
   }
@@ -342,12 +345,7 @@ absl::StatusOr<BlockMetricsProto> GenerateBlockMetrics(
     Block* block, const DelayEstimator* delay_estimator) {
   BlockMetricsProto proto;
   proto.set_flop_count(GenerateFlopCount(block));
-  proto.set_feedthrough_path_exists(HasFeedthroughPass(block));
-
-  if (delay_estimator != nullptr) {
-    proto.set_delay_model(delay_estimator->name());
-    XLS_RETURN_IF_ERROR(SetDelayFields(block, *delay_estimator, &proto));
-  }
+  XLS_RETURN_IF_ERROR(SetPathFields(block, delay_estimator, &proto));
 
   XLS_RETURN_IF_ERROR(GenerateBom(block, &proto));
 
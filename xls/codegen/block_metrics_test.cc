@@ -14,16 +14,22 @@
 
 #include "xls/codegen/block_metrics.h"
 
+#include <cstdint>
+
 #include "gtest/gtest.h"
+#include "absl/status/statusor.h"
 #include "xls/codegen/block_conversion.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/codegen_pass.h"
 #include "xls/codegen/xls_metrics.pb.h"
 #include "xls/common/status/matchers.h"
+#include "xls/delay_model/delay_estimator.h"
 #include "xls/delay_model/delay_estimators.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/block.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
 #include "xls/ir/package.h"
 #include "xls/ir/type.h"
 #include "xls/scheduling/pipeline_schedule.h"
@@ -34,6 +40,22 @@ namespace xls {
 namespace verilog {
 namespace {
 
+// A delay estimator which counts the number of delays it has estimated.
+class CountingDelayEstimator : public DelayEstimator {
+ public:
+  CountingDelayEstimator() : DelayEstimator("counting") {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    ++query_count_;
+    return 1;
+  }
+
+  int64_t query_count() const { return query_count_; }
+
+ private:
+  mutable int64_t query_count_ = 0;
+};
+
 TEST(BlockMetricsGeneratorTest, ZeroRegisters) {
   Package package("test");
 
@@ -427,6 +449,24 @@ TEST(BlockMetricsGeneratorTest, DelayMetrics) {
   }
 }
 
+TEST(BlockMetricsGeneratorTest, DelayOnlyEstimatedOnPaths) {
+  Package package("test");
+  Type* u32 = package.GetBitsType(32);
+  BlockBuilder bb("test_block", &package);
+  bb.OutputPort("constant", bb.Not(bb.Not(bb.Literal(UBits(42, 32)))));
+  bb.OutputPort("out", bb.Not(bb.InputPort("in", u32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  CountingDelayEstimator delay_estimator;
+  XLS_ASSERT_OK_AND_ASSIGN(BlockMetricsProto proto,
+                           GenerateBlockMetrics(block, &delay_estimator));
+  EXPECT_TRUE(proto.feedthrough_path_exists());
+  EXPECT_EQ(proto.max_feedthrough_path_delay_ps(), 1);
+  // Only the `not` of the input port and the `out` port are on a path from an
+  // input port or register.
+  EXPECT_EQ(delay_estimator.query_count(), 2);
+}
+
 }  // namespace
 }  // namespace verilog
 }  // namespace xls
@@ -0,0 +1,105 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/codegen/block_verilog_cache.h"
+
+#include <unistd.h>
+
+#include <filesystem>  // NOLINT
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <thread>  // NOLINT(build/c++11)
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/codegen/block_verilog_cache.pb.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/codegen/verilog_line_map.pb.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/block.h"
+
+namespace xls::verilog {
+namespace {
+
+std::filesystem::path EntryPath(Block* block, const CodegenOptions& options) {
+  return std::filesystem::path(*options.verilog_cache_dir()) /
+         absl::StrCat(block->name(), ".verilog_cache");
+}
+
+// The IR text includes the names and ids of the nodes, from which the names of
+// the signals in the generated Verilog are derived.
+std::string EntryKey(Block* block, const CodegenOptions& options) {
+  return absl::StrCat(options.verilog_cache_key(), "\n", block->DumpIr());
+}
+
+}  // namespace
+
+absl::StatusOr<std::optional<BlockVerilogCacheEntryProto>> LookupBlockVerilog(
+    Block* block, const CodegenOptions& options) {
+  XLS_RET_CHECK(options.verilog_cache_dir().has_value());
+  std::filesystem::path path = EntryPath(block, options);
+  if (!FileExists(path).ok()) {
+    return std::nullopt;
+  }
+  BlockVerilogCacheEntryProto entry;
+  if (absl::Status status = ParseProtobinFile(path, &entry); !status.ok()) {
+    LOG(WARNING) << absl::StreamFormat(
+        "Ignoring unreadable Verilog cache entry `%s`: %s", path.string(),
+        status.message());
+    return std::nullopt;
+  }
+  if (entry.key() != EntryKey(block, options)) {
+    return std::nullopt;
+  }
+  return entry;
+}
+
+absl::Status CacheBlockVerilog(Block* block, const CodegenOptions& options,
+                               std::string_view verilog_text,
+                               const VerilogLineMap& verilog_line_map) {
+  XLS_RET_CHECK(options.verilog_cache_dir().has_value());
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(*options.verilog_cache_dir()));
+  BlockVerilogCacheEntryProto entry;
+  entry.set_key(EntryKey(block, options));
+  entry.set_verilog_text(verilog_text);
+  *entry.mutable_verilog_line_map() = verilog_line_map;
+
+  // Write to a temporary file and rename it into place so that concurrent runs
+  // never observe a partially written entry.
+  std::filesystem::path path = EntryPath(block, options);
+  std::filesystem::path temp_path = path;
+  temp_path += absl::StrFormat(
+      ".tmp.%d.%d", getpid(),
+      std::hash<std::thread::id>()(std::this_thread::get_id()));
+  XLS_RETURN_IF_ERROR(SetProtobinFile(temp_path, entry));
+  std::error_code ec;
+  std::filesystem::rename(temp_path, path, ec);
+  if (ec) {
+    return absl::InternalError(
+        absl::StrFormat("Unable to write Verilog cache entry `%s`: %s",
+                        path.string(), ec.message()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls::verilog
@@ -0,0 +1,47 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_CODEGEN_BLOCK_VERILOG_CACHE_H_
+#define XLS_CODEGEN_BLOCK_VERILOG_CACHE_H_
+
+#include <optional>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/codegen/block_verilog_cache.pb.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/codegen/verilog_line_map.pb.h"
+#include "xls/ir/block.h"
+
+namespace xls::verilog {
+
+// Returns the module previously cached for `block` in the cache configured in
+// `options`, or std::nullopt if there is none or if it was generated from
+// different IR or with a different key. Unreadable entries are treated as
+// missing.
+absl::StatusOr<std::optional<BlockVerilogCacheEntryProto>> LookupBlockVerilog(
+    Block* block, const CodegenOptions& options);
+
+// Stores the module generated for `block` in the cache configured in
+// `options`, replacing any previous entry for a block of the same name. Line
+// numbers in `verilog_line_map` are relative to the start of `verilog_text`.
+absl::Status CacheBlockVerilog(Block* block, const CodegenOptions& options,
+                               std::string_view verilog_text,
+                               const VerilogLineMap& verilog_line_map);
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_BLOCK_VERILOG_CACHE_H_
@@ -56,7 +56,10 @@ CodegenOptions::CodegenOptions(const CodegenOptions& options)
       streaming_channel_valid_suffix_(options.streaming_channel_valid_suffix_),
       array_index_bounds_checking_(options.array_index_bounds_checking_),
       gate_recvs_(options.gate_recvs_),
-      register_merge_strategy_(options.register_merge_strategy_) {
+      register_merge_strategy_(options.register_merge_strategy_),
+      min_delay_line_length_(options.min_delay_line_length_),
+      verilog_cache_dir_(options.verilog_cache_dir_),
+      verilog_cache_key_(options.verilog_cache_key_) {
   for (auto& [op, op_override] : options.op_overrides_) {
     op_overrides_.insert_or_assign(op, op_override->Clone());
   }
@@ -88,6 +91,9 @@ CodegenOptions& CodegenOptions::operator=(const CodegenOptions& options) {
   array_index_bounds_checking_ = options.array_index_bounds_checking_;
   gate_recvs_ = options.gate_recvs_;
   register_merge_strategy_ = options.register_merge_strategy_;
+  min_delay_line_length_ = options.min_delay_line_length_;
+  verilog_cache_dir_ = options.verilog_cache_dir_;
+  verilog_cache_key_ = options.verilog_cache_key_;
   for (auto& [op, op_override] : options.op_overrides_) {
     op_overrides_.insert_or_assign(op, op_override->Clone());
   }
@@ -269,4 +275,16 @@ CodegenOptions& CodegenOptions::register_merge_strategy(
   return *this;
 }
 
+CodegenOptions& CodegenOptions::min_delay_line_length(int64_t value) {
+  min_delay_line_length_ = value;
+  return *this;
+}
+
+CodegenOptions& CodegenOptions::verilog_cache(std::string_view directory,
+                                              std::string_view key) {
+  verilog_cache_dir_ = directory;
+  verilog_cache_key_ = key;
+  return *this;
+}
+
 }  // namespace xls::verilog
@@ -249,12 +249,30 @@ class CodegenOptions {
     return register_merge_strategy_;
   }
 
+  // Minimum number of registers in a chain of pass-through pipeline registers
+  // for the chain to be replaced by a delay line (a shift register which
+  // synthesis can map to shift-register primitives). Values less than two
+  // disable delay lines. Delay lines are not used when emitting as a pipeline.
+  CodegenOptions& min_delay_line_length(int64_t value);
+  int64_t min_delay_line_length() const { return min_delay_line_length_; }
+
   int64_t max_trace_verbosity() const { return max_trace_verbosity_; }
   CodegenOptions& set_max_trace_verbosity(int64_t value) {
     max_trace_verbosity_ = value;
     return *this;
   }
 
+  // Directory of an on-disk cache of the Verilog module generated for each
+  // block. When set, a block whose IR matches the IR of the block cached by a
+  // previous run with the same `key` reuses the cached module text. `key` must
+  // identify all of the options which affect the generated Verilog.
+  CodegenOptions& verilog_cache(std::string_view directory,
+                                std::string_view key);
+  std::optional<std::string_view> verilog_cache_dir() const {
+    return verilog_cache_dir_;
+  }
+  std::string_view verilog_cache_key() const { return verilog_cache_key_; }
+
  private:
   std::optional<std::string> entry_;
   std::optional<std::string> module_name_;
@@ -279,8 +297,11 @@ class CodegenOptions {
   bool gate_recvs_ = true;
   std::vector<std::unique_ptr<RamConfiguration>> ram_configurations_;
   int64_t max_trace_verbosity_ = 0;
+  int64_t min_delay_line_length_ = 0;
   RegisterMergeStrategy register_merge_strategy_ =
       RegisterMergeStrategy::kDefault;
+  std::optional<std::string> verilog_cache_dir_;
+  std::string verilog_cache_key_;
 };
 
 template <typename Sink>
@@ -305,7 +305,7 @@ struct CodegenPassUnit {
     return top_block->name();
   }
   int64_t GetNodeCount() const;
-  const TransformMetrics& transform_metrics() const {
+  TransformMetrics transform_metrics() const {
     return package->transform_metrics();
   }
 
@@ -25,6 +25,7 @@
 #include "xls/codegen/codegen_checker.h"
 #include "xls/codegen/codegen_pass.h"
 #include "xls/codegen/codegen_wrapper_pass.h"
+#include "xls/codegen/delay_line_pass.h"
 #include "xls/codegen/ffi_instantiation_pass.h"
 #include "xls/codegen/mulp_combining_pass.h"
 #include "xls/codegen/port_legalization_pass.h"
@@ -91,6 +92,9 @@ std::unique_ptr<CodegenCompoundPass> CreateCodegenPassPipeline() {
   // Deduplicate registers across mutually exclusive stages.
   top->Add<RegisterCombiningPass>();
 
+  // Replace long chains of pass-through pipeline registers with delay lines.
+  top->Add<DelayLinePass>();
+
   // Remove any identity ops which might have been added earlier in the
   // pipeline.
   top->Add<CodegenWrapperPass>(std::make_unique<IdentityRemovalPass>());
@@ -25,6 +25,7 @@
 #include "xls/codegen/module_signature.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/trace.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/node.h"
 #include "xls/passes/pass_base.h"
@@ -35,6 +36,8 @@ namespace verilog {
 absl::StatusOr<ModuleGeneratorResult> GenerateCombinationalModule(
     FunctionBase* module, const CodegenOptions& options,
     const DelayEstimator* delay_estimator) {
+  TraceSpan span("codegen");
+  span.AddArg("module", module->name());
   XLS_ASSIGN_OR_RETURN(CodegenPassUnit unit,
                        FunctionBaseToCombinationalBlock(module, options));
 
@@ -58,7 +61,8 @@ absl::StatusOr<ModuleGeneratorResult> GenerateCombinationalModule(
   // not just top.
   return ModuleGeneratorResult{
       verilog, verilog_line_map,
-      unit.metadata.at(unit.top_block).signature.value()};
+      unit.metadata.at(unit.top_block).signature.value(),
+      PassResultsToProfileProto(results)};
 }
 
 }  // namespace verilog
@@ -0,0 +1,211 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/codegen/delay_line_pass.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/register.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls::verilog {
+
+namespace {
+
+// Returns the chains of pipeline registers in `metadata` which may be replaced
+// by delay lines. The registers of each chain are ordered from first written
+// to last written.
+std::vector<std::vector<PipelineRegister>> FindRegisterChains(
+    const CodegenMetadata& metadata) {
+  // Delay lines are shifted without reset so only registers without a reset
+  // value are candidates.
+  std::vector<PipelineRegister> candidates;
+  absl::flat_hash_map<Register*, PipelineRegister> candidate_map;
+  for (const PipelineStageRegisters& stage :
+       metadata.streaming_io_and_pipeline.pipeline_registers) {
+    for (const PipelineRegister& reg : stage) {
+      if (!reg.reg->reset().has_value() &&
+          !reg.reg_write->reset().has_value()) {
+        candidates.push_back(reg);
+        candidate_map[reg.reg] = reg;
+      }
+    }
+  }
+
+  // Returns the register which is written with the value of `reg` if `reg`
+  // feeds nothing else and the registers can be shifted together.
+  auto next_in_chain =
+      [&](const PipelineRegister& reg) -> std::optional<PipelineRegister> {
+    if (reg.reg_read->users().size() != 1 ||
+        !reg.reg_read->users().front()->Is<RegisterWrite>()) {
+      return std::nullopt;
+    }
+    RegisterWrite* write = reg.reg_read->users().front()->As<RegisterWrite>();
+    if (write->data() != reg.reg_read ||
+        write->load_enable() != reg.reg_write->load_enable() ||
+        write->GetRegister()->type() != reg.reg->type()) {
+      return std::nullopt;
+    }
+    auto it = candidate_map.find(write->GetRegister());
+    if (it == candidate_map.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  };
+
+  absl::flat_hash_set<Register*> has_predecessor;
+  for (const PipelineRegister& reg : candidates) {
+    if (std::optional<PipelineRegister> next = next_in_chain(reg)) {
+      has_predecessor.insert(next->reg);
+    }
+  }
+
+  std::vector<std::vector<PipelineRegister>> chains;
+  for (const PipelineRegister& reg : candidates) {
+    if (has_predecessor.contains(reg.reg)) {
+      continue;
+    }
+    std::vector<PipelineRegister>& chain = chains.emplace_back();
+    for (std::optional<PipelineRegister> link = reg; link.has_value();
+         link = next_in_chain(*link)) {
+      chain.push_back(*link);
+    }
+  }
+  return chains;
+}
+
+// Replaces the registers of `chain` with a single array-typed register whose
+// element `i` holds the value of the `i`-th register of the chain.
+absl::Status ReplaceWithDelayLine(absl::Span<const PipelineRegister> chain,
+                                  Block* block, CodegenMetadata& metadata) {
+  const PipelineRegister& first = chain.front();
+  const SourceInfo& loc = first.reg_write->loc();
+  const int64_t length = chain.size();
+  Type* element_type = first.reg->type();
+  absl::flat_hash_map<Node*, Stage>& node_to_stage_map =
+      metadata.streaming_io_and_pipeline.node_to_stage_map;
+  const Stage write_stage = node_to_stage_map.at(first.reg_write);
+  VLOG(2) << "Replacing " << length << " registers starting at "
+          << first.reg->name() << " with a delay line";
+
+  XLS_ASSIGN_OR_RETURN(
+      Register * delay_line,
+      block->AddRegister(absl::StrCat(first.reg->name(), "_delay"),
+                         block->package()->GetArrayType(length, element_type)));
+  XLS_ASSIGN_OR_RETURN(RegisterRead * delay_line_read,
+                       block->MakeNodeWithName<RegisterRead>(
+                           loc, delay_line, /*name=*/delay_line->name()));
+  node_to_stage_map[delay_line_read] = write_stage + 1;
+
+  const int64_t index_width = Bits::MinBitCountUnsigned(length);
+  auto element = [&](int64_t i, Stage stage) -> absl::StatusOr<Node*> {
+    XLS_ASSIGN_OR_RETURN(
+        Node * index,
+        block->MakeNode<xls::Literal>(loc, Value(UBits(i, index_width))));
+    XLS_ASSIGN_OR_RETURN(Node * element,
+                         block->MakeNode<ArrayIndex>(
+                             loc, delay_line_read, std::vector<Node*>{index}));
+    node_to_stage_map[index] = stage;
+    node_to_stage_map[element] = stage;
+    return element;
+  };
+
+  // Shift the delay line by one element, inserting the input of the chain.
+  std::vector<Node*> next_elements = {first.reg_write->data()};
+  for (int64_t i = 0; i < length - 1; ++i) {
+    XLS_ASSIGN_OR_RETURN(Node * shifted, element(i, write_stage));
+    next_elements.push_back(shifted);
+  }
+  XLS_ASSIGN_OR_RETURN(
+      Node * next, block->MakeNode<Array>(loc, next_elements, element_type));
+  XLS_ASSIGN_OR_RETURN(
+      Node * delay_line_write,
+      block->MakeNode<RegisterWrite>(loc, next, first.reg_write->load_enable(),
+                                     /*reset=*/std::nullopt, delay_line));
+  node_to_stage_map[next] = write_stage;
+  node_to_stage_map[delay_line_write] = write_stage;
+
+  const PipelineRegister& last = chain.back();
+  XLS_ASSIGN_OR_RETURN(
+      Node * output,
+      element(length - 1, node_to_stage_map.at(last.reg_read)));
+  XLS_RETURN_IF_ERROR(last.reg_read->ReplaceUsesWith(output));
+
+  // Each read other than the last is used only by the next write in the chain
+  // so remove all of the writes before the reads.
+  absl::flat_hash_set<Register*> removed;
+  for (const PipelineRegister& reg : chain) {
+    XLS_RETURN_IF_ERROR(block->RemoveNode(reg.reg_write));
+    removed.insert(reg.reg);
+  }
+  for (const PipelineRegister& reg : chain) {
+    XLS_RETURN_IF_ERROR(block->RemoveNode(reg.reg_read));
+    XLS_RETURN_IF_ERROR(block->RemoveRegister(reg.reg));
+  }
+  for (PipelineStageRegisters& stage :
+       metadata.streaming_io_and_pipeline.pipeline_registers) {
+    std::erase_if(stage, [&](const PipelineRegister& reg) {
+      return removed.contains(reg.reg);
+    });
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<bool> DelayLinePass::RunInternal(
+    CodegenPassUnit* unit, const CodegenPassOptions& options,
+    PassResults* results) const {
+  const int64_t min_length = options.codegen_options.min_delay_line_length();
+  if (min_length < 2 || options.codegen_options.emit_as_pipeline()) {
+    return false;
+  }
+
+  bool changed = false;
+  for (auto& [block, metadata] : unit->metadata) {
+    for (const std::vector<PipelineRegister>& chain :
+         FindRegisterChains(metadata)) {
+      if (chain.size() < min_length) {
+        continue;
+      }
+      XLS_RETURN_IF_ERROR(ReplaceWithDelayLine(chain, block, metadata));
+      changed = true;
+    }
+  }
+  if (changed) {
+    unit->GcMetadata();
+  }
+  return changed;
+}
+
+}  // namespace xls::verilog
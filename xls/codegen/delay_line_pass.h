@@ -0,0 +1,52 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_CODEGEN_DELAY_LINE_PASS_H_
+#define XLS_CODEGEN_DELAY_LINE_PASS_H_
+
+#include "absl/status/statusor.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls::verilog {
+
+// Replaces chains of pass-through pipeline registers with delay lines.
+//
+// A chain is a sequence of pipeline registers without reset values where each
+// register is written with the value of the previous register, the value of
+// each register other than the last is used only by the next register, and
+// all of the registers share the same load enable (if any). Chains of at least
+// CodegenOptions::min_delay_line_length() registers are replaced by a single
+// array-typed register which is shifted by one element whenever it is
+// enabled. Synthesis tools map such shift registers onto shift-register
+// primitives (e.g., SRLs) rather than individual flops.
+//
+// Delay lines span several pipeline stages so the pass does nothing when the
+// block is emitted as a pipeline.
+class DelayLinePass : public CodegenPass {
+ public:
+  DelayLinePass()
+      : CodegenPass("delay_line",
+                    "Replace pipeline register chains with delay lines") {}
+  ~DelayLinePass() override = default;
+
+  absl::StatusOr<bool> RunInternal(CodegenPassUnit* unit,
+                                   const CodegenPassOptions& options,
+                                   PassResults* results) const override;
+};
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_DELAY_LINE_PASS_H_
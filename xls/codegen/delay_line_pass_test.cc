@@ -0,0 +1,145 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/codegen/delay_line_pass.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "xls/codegen/block_conversion.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/register.h"
+#include "xls/passes/pass_base.h"
+#include "xls/scheduling/pipeline_schedule.h"
+
+namespace xls::verilog {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+class DelayLinePassTest : public IrTestBase {
+ protected:
+  // Converts f(x, y) = ~x + y to a block with a five stage pipeline. The
+  // negation is computed in the first stage and the sum in the last so both
+  // the negation and `y` pass through a register in each of the first four
+  // stages.
+  absl::StatusOr<CodegenPassUnit> ConvertToBlock(
+      Package* p, const CodegenOptions& options) {
+    FunctionBuilder fb(TestName(), p);
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue y = fb.Param("y", p->GetBitsType(32));
+    BValue not_x = fb.Not(x);
+    BValue sum = fb.Add(not_x, y);
+    XLS_ASSIGN_OR_RETURN(Function * f, fb.BuildWithReturnValue(sum));
+    PipelineSchedule schedule(f,
+                              ScheduleCycleMap({{x.node(), 0},
+                                                {y.node(), 0},
+                                                {not_x.node(), 0},
+                                                {sum.node(), 4}}),
+                              /*length=*/5);
+    return FunctionBaseToPipelinedBlock(schedule, options, f);
+  }
+
+  absl::StatusOr<bool> Run(CodegenPassUnit* unit,
+                           const CodegenOptions& options) {
+    PassResults results;
+    return DelayLinePass().Run(
+        unit, CodegenPassOptions{.codegen_options = options}, &results);
+  }
+
+  CodegenOptions Options() {
+    return CodegenOptions().clock_name("clk").module_name(TestName());
+  }
+};
+
+TEST_F(DelayLinePassTest, ReplacesRegisterChains) {
+  auto p = CreatePackage();
+  CodegenOptions options = Options().min_delay_line_length(4);
+  XLS_ASSERT_OK_AND_ASSIGN(CodegenPassUnit unit,
+                           ConvertToBlock(p.get(), options));
+  Block* block = unit.top_block;
+  EXPECT_EQ(block->GetRegisters().size(), 8);
+
+  EXPECT_THAT(Run(&unit, options), IsOkAndHolds(true));
+
+  ASSERT_EQ(block->GetRegisters().size(), 2);
+  for (Register* reg : block->GetRegisters()) {
+    EXPECT_EQ(reg->type(), p->GetArrayType(4, p->GetBitsType(32)));
+  }
+  for (const PipelineStageRegisters& stage : unit.metadata.at(block)
+                                                 .streaming_io_and_pipeline
+                                                 .pipeline_registers) {
+    EXPECT_TRUE(stage.empty());
+  }
+
+  // The block must still compute the function with a latency of four cycles.
+  std::vector<absl::flat_hash_map<std::string, uint64_t>> inputs;
+  for (uint64_t i = 0; i < 12; ++i) {
+    inputs.push_back({{"x", i}, {"y", 3 * i}});
+  }
+  std::vector<absl::flat_hash_map<std::string, uint64_t>> outputs;
+  XLS_ASSERT_OK_AND_ASSIGN(outputs, InterpretSequentialBlock(block, inputs));
+  ASSERT_EQ(outputs.size(), inputs.size());
+  for (uint64_t i = 4; i < outputs.size(); ++i) {
+    uint64_t x = i - 4;
+    EXPECT_EQ(outputs[i].at("out"), (~x + 3 * x) & 0xffffffff)
+        << "cycle " << i;
+  }
+}
+
+TEST_F(DelayLinePassTest, ShortChainsAreNotReplaced) {
+  auto p = CreatePackage();
+  CodegenOptions options = Options().min_delay_line_length(5);
+  XLS_ASSERT_OK_AND_ASSIGN(CodegenPassUnit unit,
+                           ConvertToBlock(p.get(), options));
+
+  EXPECT_THAT(Run(&unit, options), IsOkAndHolds(false));
+  EXPECT_EQ(unit.top_block->GetRegisters().size(), 8);
+}
+
+TEST_F(DelayLinePassTest, DisabledByDefault) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(CodegenPassUnit unit,
+                           ConvertToBlock(p.get(), Options()));
+
+  EXPECT_THAT(Run(&unit, Options()), IsOkAndHolds(false));
+  EXPECT_EQ(unit.top_block->GetRegisters().size(), 8);
+}
+
+TEST_F(DelayLinePassTest, NotUsedWhenEmittingAsPipeline) {
+  auto p = CreatePackage();
+  CodegenOptions options =
+      Options().min_delay_line_length(2).emit_as_pipeline(true);
+  XLS_ASSERT_OK_AND_ASSIGN(CodegenPassUnit unit,
+                           ConvertToBlock(p.get(), options));
+
+  EXPECT_THAT(Run(&unit, options), IsOkAndHolds(false));
+  EXPECT_EQ(unit.top_block->GetRegisters().size(), 8);
+}
+
+}  // namespace
+}  // namespace xls::verilog
@@ -38,6 +38,7 @@
 #include "xls/ir/package.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/passes/pass_metrics.pb.h"
 
 namespace xls {
 namespace verilog {
@@ -308,6 +309,8 @@ struct ModuleGeneratorResult {
   std::string verilog_text;
   VerilogLineMap verilog_line_map;
   ModuleSignature signature;
+  // Per-pass run times and change counts of the codegen pass pipeline.
+  PassPipelineProfileProto pass_profile;
 };
 
 std::ostream& operator<<(std::ostream& os, const ModuleSignature& signature);
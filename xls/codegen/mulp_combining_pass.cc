@@ -17,7 +17,11 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "xls/codegen/codegen_pass.h"
 #include "xls/common/status/status_macros.h"
@@ -30,60 +34,135 @@
 namespace xls::verilog {
 namespace {
 
-// Tries to match `node` to the sum of the two elements of a single-use mulp
-// operation. Returns the mulp node if successful, nullopt otherwise. For
-// example, The node `x` will match with `m` being the returned
-// PartialProductOp:
-//
-//   m = umulp(a, b)
-//   x = add(tuple-index(m, 0), tuple-index(m, 1))
-//
-// Also handles the case where the add operation sums LSB slices of the partial
-// product, e.g.:
-//
-//   m = umulp(a, b)
-//   lhs = bitslice(tuple-index(m, 0), 0, N)
-//   rhs = bitslice(tuple-index(m, 1), 0, N)
-//   x = add(lhs, rhs)
+// An element of a partial product operation used as an addend, either
+// directly or through an LSB slice, e.g. `tuple-index(m, 0)` or
+// `bitslice(tuple-index(m, 1), 0, N)`.
+struct PartialProductAddend {
+  Node* addend;
+  PartialProductOp* mulp;
+  int64_t index;
+
+  // The add consuming `addend` and the operand number of `addend` in it.
+  Node* add;
+  int64_t operand_no;
+};
+
+// Tries to match `node` to a single-use element of a partial product
+// operation, possibly sliced to its least-significant bits.
 //
 // TODO(meheff): 2022/8/3 Remove bitslice matching when bitslices can be hoisted
 // above mulp operations.
-std::optional<PartialProductOp*> MatchMulpAdd(Node* node) {
-  if (node->op() != Op::kAdd) {
-    return std::nullopt;
-  }
-  Node* lhs = node->operand(0);
-  Node* rhs = node->operand(1);
-  if (lhs->Is<BitSlice>() && rhs->Is<BitSlice>()) {
-    if (lhs->As<BitSlice>()->start() != 0 || !HasSingleUse(lhs) ||
-        rhs->As<BitSlice>()->start() != 0 || !HasSingleUse(rhs)) {
+std::optional<PartialProductAddend> MatchPartialProductAddend(Node* node) {
+  Node* element = node;
+  if (element->Is<BitSlice>()) {
+    if (element->As<BitSlice>()->start() != 0 || !HasSingleUse(element)) {
       return std::nullopt;
     }
-    lhs = lhs->operand(0);
-    rhs = rhs->operand(0);
+    element = element->operand(0);
   }
-  if (!lhs->Is<TupleIndex>() || !rhs->Is<TupleIndex>()) {
+  if (!element->Is<TupleIndex>() || !HasSingleUse(element) ||
+      !element->operand(0)->Is<PartialProductOp>()) {
     return std::nullopt;
   }
-  int64_t lhs_index = lhs->As<TupleIndex>()->index();
-  Node* lhs_src = lhs->operand(0);
-  int64_t rhs_index = rhs->As<TupleIndex>()->index();
-  Node* rhs_src = rhs->operand(0);
-  if (!(lhs_src == rhs_src && lhs_src->Is<PartialProductOp>() &&
-        ((lhs_index == 0 && rhs_index == 1) ||
-         (lhs_index == 1 && rhs_index == 0)))) {
-    return std::nullopt;
+  return PartialProductAddend{
+      .addend = node,
+      .mulp = element->operand(0)->As<PartialProductOp>(),
+      .index = element->As<TupleIndex>()->index(),
+      .add = nullptr,
+      .operand_no = 0};
+}
+
+// Returns true if `node` is an add whose value is only used by another add, so
+// `node` is an interior node of a larger sum.
+bool IsInteriorAdd(Node* node) {
+  return node->op() == Op::kAdd && HasSingleUse(node) &&
+         node->users().front()->op() == Op::kAdd;
+}
+
+// Collects the partial product elements summed by the tree of single-use adds
+// rooted at `add`.
+void CollectPartialProductAddends(Node* add,
+                                  std::vector<PartialProductAddend>& addends) {
+  for (int64_t operand_no = 0; operand_no < add->operand_count();
+       ++operand_no) {
+    Node* operand = add->operand(operand_no);
+    if (IsInteriorAdd(operand)) {
+      CollectPartialProductAddends(operand, addends);
+      continue;
+    }
+    if (std::optional<PartialProductAddend> addend =
+            MatchPartialProductAddend(operand)) {
+      addend->add = add;
+      addend->operand_no = operand_no;
+      addends.push_back(*addend);
+    }
+  }
+}
+
+// Recombines the partial products summed anywhere within the tree of adds
+// rooted at `root`. For example, with `m = umulp(a, b)` and the addends
+// reassociated by the optimizer:
+//
+//   x = add(add(tuple-index(m, 0), acc), tuple-index(m, 1))
+//
+//   =>
+//
+//   x = add(umul(a, b), acc)
+//
+// The two elements of a mulp are the only uses of the mulp, so their sum
+// anywhere in the tree may be replaced by the product. The first element is
+// replaced by the multiply and the add consuming the second element is
+// bypassed, which keeps the tree no deeper than scheduled. This handles the
+// common multiply-add and sum-of-products (multiply-accumulate) shapes.
+absl::StatusOr<bool> CombineMulpsInSum(Node* root) {
+  std::vector<PartialProductAddend> addends;
+  CollectPartialProductAddends(root, addends);
+
+  absl::flat_hash_map<PartialProductOp*, std::vector<PartialProductAddend>>
+      addends_by_mulp;
+  std::vector<PartialProductOp*> mulps;
+  for (const PartialProductAddend& addend : addends) {
+    std::vector<PartialProductAddend>& mulp_addends =
+        addends_by_mulp[addend.mulp];
+    if (mulp_addends.empty()) {
+      mulps.push_back(addend.mulp);
+    }
+    mulp_addends.push_back(addend);
   }
-  PartialProductOp* mulp = lhs_src->As<PartialProductOp>();
 
-  // Verify the only use of the mulp operation is the add (ignoring the
-  // tuple-index operation which select the mulp output elements). The mulp
-  // itself should have two users: tuple-index for element 0, and tuple-index
-  // for element 1.
-  if (mulp->users().size() != 2 || !HasSingleUse(lhs) || !HasSingleUse(rhs)) {
-    return std::nullopt;
+  // Adds which have been bypassed; each add can drop at most one operand.
+  absl::flat_hash_set<Node*> bypassed_adds;
+  bool changed = false;
+  for (PartialProductOp* mulp : mulps) {
+    // The mulp itself should have two users: tuple-index for element 0, and
+    // tuple-index for element 1.
+    const std::vector<PartialProductAddend>& mulp_addends =
+        addends_by_mulp.at(mulp);
+    if (mulp->users().size() != 2 || mulp_addends.size() != 2 ||
+        mulp_addends[0].index == mulp_addends[1].index) {
+      continue;
+    }
+    const PartialProductAddend* product = &mulp_addends[0];
+    const PartialProductAddend* removed = &mulp_addends[1];
+    if (bypassed_adds.contains(removed->add)) {
+      std::swap(product, removed);
+    }
+    if (bypassed_adds.contains(removed->add)) {
+      continue;
+    }
+    XLS_RETURN_IF_ERROR(
+        product->addend
+            ->ReplaceUsesWithNew<ArithOp>(
+                mulp->operand(0), mulp->operand(1),
+                product->addend->BitCountOrDie(),
+                mulp->op() == Op::kSMulp ? Op::kSMul : Op::kUMul)
+            .status());
+    XLS_RETURN_IF_ERROR(removed->add->ReplaceUsesWith(
+        removed->add->operand(1 - removed->operand_no)));
+    bypassed_adds.insert(removed->add);
+    changed = true;
   }
-  return mulp;
+  return changed;
 }
 
 }  // namespace
@@ -93,17 +172,18 @@ absl::StatusOr<bool> MulpCombiningPass::RunInternal(
     PassResults* results) const {
   bool changed = false;
   for (const std::unique_ptr<Block>& block : unit->package->blocks()) {
+    // Collect the roots of the trees of adds first as rewriting a tree leaves
+    // dead nodes behind.
+    std::vector<Node*> roots;
     for (Node* node : block->nodes()) {
-      if (std::optional<PartialProductOp*> mulp = MatchMulpAdd(node)) {
-        XLS_RETURN_IF_ERROR(
-            node->ReplaceUsesWithNew<ArithOp>(
-                    mulp.value()->operand(0), mulp.value()->operand(1),
-                    node->BitCountOrDie(),
-                    mulp.value()->op() == Op::kSMulp ? Op::kSMul : Op::kUMul)
-                .status());
-        changed = true;
+      if (node->op() == Op::kAdd && !IsInteriorAdd(node)) {
+        roots.push_back(node);
       }
     }
+    for (Node* root : roots) {
+      XLS_ASSIGN_OR_RETURN(bool root_changed, CombineMulpsInSum(root));
+      changed = changed || root_changed;
+    }
   }
   if (changed) {
     unit->GcMetadata();
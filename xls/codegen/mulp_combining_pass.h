@@ -34,6 +34,20 @@ namespace xls::verilog {
 // splitting potentially expensive multiplies into two operations. After
 // scheduling these split operations can be recombined if the partial product
 // and add are scheduled in the same cycle.
+//
+// The two partial products need not be summed by the same add: any tree of
+// single-use adds which sums both of them, along with other addends, has the
+// pair replaced by the multiply. This recombines multiply-add and
+// sum-of-products (multiply-accumulate) chains whose adds were reassociated,
+// leaving each multiply feeding an adder directly as DSP slices and MAC
+// macros expect:
+//
+//     tmp = umulp(a, b)
+//     y = add(add(tuple-index(tmp, 0), acc), tuple-index(tmp, 1))
+//
+//   =>
+//
+//     y = add(umul(a, b), acc)
 class MulpCombiningPass : public CodegenPass {
  public:
   MulpCombiningPass()
@@ -200,5 +200,69 @@ TEST_F(MulpCombiningPassTest, MulpThenAddWithRegisterInBetween) {
   EXPECT_THAT(Run(block), IsOkAndHolds(false));
 }
 
+TEST_F(MulpCombiningPassTest, ReassociatedMultiplyAdd) {
+  auto p = CreatePackage();
+
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InputPort("a", p->GetBitsType(32));
+  BValue b = bb.InputPort("b", p->GetBitsType(32));
+  BValue acc = bb.InputPort("acc", p->GetBitsType(32));
+  BValue umulp = bb.UMulp(a, b);
+  BValue x = bb.OutputPort(
+      "x", bb.Add(bb.Add(bb.TupleIndex(umulp, 0), acc),
+                  bb.TupleIndex(umulp, 1)));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  EXPECT_THAT(Run(block), IsOkAndHolds(true));
+
+  EXPECT_THAT(x.node(), m::OutputPort(m::Add(
+                            m::UMul(m::InputPort("a"), m::InputPort("b")),
+                            m::InputPort("acc"))));
+}
+
+TEST_F(MulpCombiningPassTest, SumOfProducts) {
+  auto p = CreatePackage();
+
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InputPort("a", p->GetBitsType(32));
+  BValue b = bb.InputPort("b", p->GetBitsType(32));
+  BValue c = bb.InputPort("c", p->GetBitsType(32));
+  BValue d = bb.InputPort("d", p->GetBitsType(32));
+  BValue umulp = bb.UMulp(a, b);
+  BValue smulp = bb.SMulp(c, d);
+  BValue x = bb.OutputPort(
+      "x",
+      bb.Add(bb.Add(bb.TupleIndex(umulp, 0), bb.TupleIndex(smulp, 0)),
+             bb.Add(bb.TupleIndex(umulp, 1), bb.TupleIndex(smulp, 1))));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  EXPECT_THAT(Run(block), IsOkAndHolds(true));
+
+  EXPECT_THAT(x.node(), m::OutputPort(m::Add(
+                            m::UMul(m::InputPort("a"), m::InputPort("b")),
+                            m::SMul(m::InputPort("c"), m::InputPort("d")))));
+}
+
+TEST_F(MulpCombiningPassTest, MultiplyAddWithSharedPartialSum) {
+  auto p = CreatePackage();
+
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InputPort("a", p->GetBitsType(32));
+  BValue b = bb.InputPort("b", p->GetBitsType(32));
+  BValue acc = bb.InputPort("acc", p->GetBitsType(32));
+  BValue umulp = bb.UMulp(a, b);
+  // The partial sum is used elsewhere so the partial products cannot be
+  // combined.
+  BValue partial_sum = bb.Add(bb.TupleIndex(umulp, 0), acc);
+  bb.OutputPort("x", bb.Add(partial_sum, bb.TupleIndex(umulp, 1)));
+  bb.OutputPort("y", partial_sum);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  EXPECT_THAT(Run(block), IsOkAndHolds(false));
+}
+
 }  // namespace
 }  // namespace xls::verilog
@@ -30,6 +30,7 @@
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/trace.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
@@ -50,6 +51,8 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, FunctionBase* module,
     const CodegenOptions& options, const DelayEstimator* delay_estimator) {
+  TraceSpan span("codegen");
+  span.AddArg("module", module->name());
   VLOG(2) << "Generating pipelined module for module:";
   XLS_VLOG_LINES(2, module->DumpIr());
   XLS_VLOG_LINES(2, schedule.ToString());
@@ -85,12 +88,15 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
   // not just top.
   return ModuleGeneratorResult{
       verilog, verilog_line_map,
-      unit.metadata.at(unit.top_block).signature.value()};
+      unit.metadata.at(unit.top_block).signature.value(),
+      PassResultsToProfileProto(results)};
 }
 
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PackagePipelineSchedules& schedules, Package* package,
     const CodegenOptions& options, const DelayEstimator* delay_estimator) {
+  TraceSpan span("codegen");
+  span.AddArg("package", package->name());
   VLOG(2) << "Generating pipelined module for module:";
   XLS_VLOG_LINES(2, package->DumpIr());
   if (VLOG_IS_ON(2)) {
@@ -133,7 +139,8 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
   // not just top.
   return ModuleGeneratorResult{
       verilog, verilog_line_map,
-      unit.metadata.at(unit.top_block).signature.value()};
+      unit.metadata.at(unit.top_block).signature.value(),
+      PassResultsToProfileProto(results)};
 }
 
 }  // namespace verilog
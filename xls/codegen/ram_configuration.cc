@@ -20,19 +20,53 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/scheduling/scheduling_options.h"
 
 namespace xls::verilog {
 namespace {
+// Options accepted by every RAM kind as trailing key=value fields.
+struct RamOptions {
+  int64_t bank_count = 1;
+};
+
+// Removes the trailing key=value fields from `fields` and parses them into
+// RamOptions.
+absl::StatusOr<RamOptions> ParseRamOptions(
+    absl::Span<const std::string_view>& fields) {
+  RamOptions options;
+  while (!fields.empty() && absl::StrContains(fields.back(), '=')) {
+    std::pair<std::string_view, std::string_view> key_value =
+        absl::StrSplit(fields.back(), absl::MaxSplits('=', 1));
+    fields.remove_suffix(1);
+    if (key_value.first == "banks") {
+      if (!absl::SimpleAtoi(key_value.second, &options.bank_count) ||
+          options.bank_count <= 0 || !IsPowerOfTwo(options.bank_count)) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Bank count must be a positive power of two, got %s.",
+            key_value.second));
+      }
+      continue;
+    }
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unknown RAM configuration option %s.",
+                        key_value.first));
+  }
+  return options;
+}
+
 // Parses a split configuration string of the form
 // "(ram_name, "1RW", request_channel_name, response_channel_name[,
 // latency])".
@@ -158,7 +192,12 @@ absl::StatusOr<std::unique_ptr<RamConfiguration>> RamConfiguration::ParseString(
     return absl::InvalidArgumentError(absl::StrFormat(
         "No RAM configuration parser found for kind %s.", ram_kind));
   }
-  return (*configuration_parser)(split_str);
+  absl::Span<const std::string_view> fields = split_str;
+  XLS_ASSIGN_OR_RETURN(RamOptions options, ParseRamOptions(fields));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<RamConfiguration> configuration,
+                       (*configuration_parser)(fields));
+  configuration->set_bank_count(options.bank_count);
+  return configuration;
 }
 
 std::unique_ptr<RamConfiguration> Ram1RWConfiguration::Clone() const {
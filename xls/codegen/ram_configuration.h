@@ -15,6 +15,7 @@
 #ifndef XLS_CODEGEN_RAM_CONFIGURATION_H_
 #define XLS_CODEGEN_RAM_CONFIGURATION_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -46,7 +47,11 @@ struct RamWPortConfiguration {
 class RamConfiguration {
  public:
   // Parses a split configuration string of the form
-  // "(ram_name, ram_kind[, <kind-specific configuration>])".
+  // "(ram_name, ram_kind[, <kind-specific configuration>][, key=value...])".
+  //
+  // The trailing key=value options apply to every RAM kind:
+  //   banks=N: interleave the logical RAM across N physical banks selected by
+  //            the low log2(N) bits of the address. N must be a power of two.
   static absl::StatusOr<std::unique_ptr<RamConfiguration>> ParseString(
       std::string_view text);
 
@@ -59,6 +64,13 @@ class RamConfiguration {
   int64_t latency() const { return latency_; }
   std::string_view ram_kind() const { return ram_kind_; }
 
+  // The number of physical RAM instances the logical RAM is interleaved
+  // across. Consecutive addresses map to consecutive banks, so each bank holds
+  // every bank_count()-th word and is addressed by the remaining upper address
+  // bits.
+  int64_t bank_count() const { return bank_count_; }
+  void set_bank_count(int64_t bank_count) { bank_count_ = bank_count; }
+
  protected:
   RamConfiguration(std::string_view ram_name, int64_t latency,
                    std::string ram_kind)
@@ -69,6 +81,7 @@ class RamConfiguration {
   std::string ram_name_;
   std::string ram_kind_;
   int64_t latency_;
+  int64_t bank_count_ = 1;
 };
 
 // Configuration for a single-port RAM.
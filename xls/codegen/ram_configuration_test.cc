@@ -0,0 +1,71 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/ram_configuration.h"
+
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls::verilog {
+namespace {
+
+using ::testing::HasSubstr;
+using ::xls::status_testing::StatusIs;
+
+TEST(RamConfigurationTest, Parse1RW) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<RamConfiguration> config,
+      RamConfiguration::ParseString("ram:1RW:req:resp:wr_comp:2"));
+  EXPECT_EQ(config->ram_name(), "ram");
+  EXPECT_EQ(config->ram_kind(), "1RW");
+  EXPECT_EQ(config->latency(), 2);
+  EXPECT_EQ(config->bank_count(), 1);
+}
+
+TEST(RamConfigurationTest, ParseBanks) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<RamConfiguration> config,
+      RamConfiguration::ParseString("ram:1RW:req:resp:wr_comp:banks=4"));
+  EXPECT_EQ(config->latency(), 1);
+  EXPECT_EQ(config->bank_count(), 4);
+  EXPECT_EQ(config->Clone()->bank_count(), 4);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      config, RamConfiguration::ParseString(
+                  "ram:1R1W:rd_req:rd_resp:wr_req:wr_comp:3:banks=2"));
+  EXPECT_EQ(config->latency(), 3);
+  EXPECT_EQ(config->bank_count(), 2);
+}
+
+TEST(RamConfigurationTest, InvalidOptions) {
+  EXPECT_THAT(
+      RamConfiguration::ParseString("ram:1RW:req:resp:wr_comp:banks=3"),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("positive power of two")));
+  EXPECT_THAT(
+      RamConfiguration::ParseString("ram:1RW:req:resp:wr_comp:banks=0"),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("positive power of two")));
+  EXPECT_THAT(
+      RamConfiguration::ParseString("ram:1RW:req:resp:wr_comp:ports=2"),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("Unknown RAM configuration option ports")));
+}
+
+}  // namespace
+}  // namespace xls::verilog
@@ -35,6 +35,7 @@
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/ram_configuration.h"
 #include "xls/common/casts.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
@@ -283,12 +284,22 @@ absl::Status WriteCompletionRewrite(
   return absl::OkStatus();
 }
 
-absl::Status Ram1RWUpdateSignature(
-    ModuleSignature& signature, const Ram1RWConfiguration& ram_config,
-    std::string_view ram_name, Package* package, OutputPort* req_addr_port,
-    OutputPort* req_re_port, OutputPort* req_we_port,
-    OutputPort* req_wr_data_port, OutputPort* req_wr_mask_port,
-    OutputPort* req_rd_mask_port, InputPort* resp_rd_data_port) {
+// The ports of one physical bank of a 1RW RAM.
+struct Ram1RWBankPorts {
+  std::string ram_name;
+  OutputPort* addr;
+  OutputPort* re;
+  OutputPort* we;
+  OutputPort* wr_data;
+  OutputPort* wr_mask;
+  OutputPort* rd_mask;
+  InputPort* rd_data;
+};
+
+absl::Status Ram1RWUpdateSignature(ModuleSignature& signature,
+                                   const Ram1RWConfiguration& ram_config,
+                                   Package* package,
+                                   absl::Span<const Ram1RWBankPorts> banks) {
   auto builder = ModuleSignatureBuilder::FromProto(signature.proto());
   XLS_RETURN_IF_ERROR(builder.RemoveStreamingChannel(
       ram_config.rw_port_configuration().request_channel_name));
@@ -317,46 +328,145 @@ absl::Status Ram1RWUpdateSignature(
     }
   }
 
-  for (const OutputPort* port : {
-           req_addr_port,
-           req_re_port,
-           req_we_port,
-           req_wr_data_port,
-           req_wr_mask_port,
-           req_rd_mask_port,
-       }) {
-    if (port->operand(0)->GetType()->GetFlatBitCount() > 0) {
-      builder.AddDataOutput(port->name(), port->operand(0)->GetType());
+  for (const Ram1RWBankPorts& bank : banks) {
+    for (const OutputPort* port : {
+             bank.addr,
+             bank.re,
+             bank.we,
+             bank.wr_data,
+             bank.wr_mask,
+             bank.rd_mask,
+         }) {
+      if (port->operand(0)->GetType()->GetFlatBitCount() > 0) {
+        builder.AddDataOutput(port->name(), port->operand(0)->GetType());
+      }
     }
-  }
-  for (const xls::InputPort* port : {resp_rd_data_port}) {
-    if (resp_rd_data_port->GetType()->GetFlatBitCount() > 0) {
-      builder.AddDataInput(port->name(), port->GetType());
+    for (const xls::InputPort* port : {bank.rd_data}) {
+      if (port->GetType()->GetFlatBitCount() > 0) {
+        builder.AddDataInput(port->name(), port->GetType());
+      }
     }
   }
 
-  builder.AddRam1RW({
-      .package = package,
-      .data_type = req_wr_data_port->GetType(),
-      .ram_name = ram_name,
-      .req_name = ram_config.rw_port_configuration().request_channel_name,
-      .resp_name = ram_config.rw_port_configuration().response_channel_name,
-      .address_width = req_addr_port->GetType()->GetFlatBitCount(),
-      .read_mask_width = req_rd_mask_port->GetType()->GetFlatBitCount(),
-      .write_mask_width = req_wr_mask_port->GetType()->GetFlatBitCount(),
-      .address_name = req_addr_port->GetName(),
-      .read_enable_name = req_re_port->GetName(),
-      .write_enable_name = req_we_port->GetName(),
-      .read_data_name = resp_rd_data_port->GetName(),
-      .write_data_name = req_wr_data_port->GetName(),
-      .write_mask_name = req_wr_mask_port->GetName(),
-      .read_mask_name = req_rd_mask_port->GetName(),
-  });
+  for (const Ram1RWBankPorts& bank : banks) {
+    builder.AddRam1RW({
+        .package = package,
+        .data_type = bank.wr_data->GetType(),
+        .ram_name = bank.ram_name,
+        .req_name = ram_config.rw_port_configuration().request_channel_name,
+        .resp_name = ram_config.rw_port_configuration().response_channel_name,
+        .address_width = bank.addr->GetType()->GetFlatBitCount(),
+        .read_mask_width = bank.rd_mask->GetType()->GetFlatBitCount(),
+        .write_mask_width = bank.wr_mask->GetType()->GetFlatBitCount(),
+        .address_name = bank.addr->GetName(),
+        .read_enable_name = bank.re->GetName(),
+        .write_enable_name = bank.we->GetName(),
+        .read_data_name = bank.rd_data->GetName(),
+        .write_data_name = bank.wr_data->GetName(),
+        .write_mask_name = bank.wr_mask->GetName(),
+        .read_mask_name = bank.rd_mask->GetName(),
+    });
+  }
 
   XLS_ASSIGN_OR_RETURN(signature, builder.Build());
   return absl::OkStatus();
 }
 
+// The bank index and the address within the bank of an access to a RAM which
+// is interleaved across several banks.
+struct BankedAddress {
+  Node* bank;
+  Node* bank_addr;
+};
+
+// Splits `addr` for a RAM interleaved across `bank_count` banks: the low
+// log2(bank_count) bits select the bank and the remaining bits address the
+// word within it.
+absl::StatusOr<BankedAddress> SplitBankedAddress(Block* block, Node* addr,
+                                                 int64_t bank_count,
+                                                 std::string_view name) {
+  int64_t bank_bits = CeilOfLog2(bank_count);
+  int64_t addr_width = addr->GetType()->GetFlatBitCount();
+  if (addr_width <= bank_bits) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Address of %s has width %d which is too narrow to select among %d "
+        "banks.",
+        name, addr_width, bank_count));
+  }
+  XLS_ASSIGN_OR_RETURN(
+      Node * bank,
+      block->MakeNodeWithName<BitSlice>(
+          /*loc=*/SourceInfo(), addr, /*start=*/0, /*width=*/bank_bits,
+          block->UniquifyNodeName(absl::StrCat(name, "_bank"))));
+  XLS_ASSIGN_OR_RETURN(
+      Node * bank_addr,
+      block->MakeNodeWithName<BitSlice>(
+          /*loc=*/SourceInfo(), addr, /*start=*/bank_bits,
+          /*width=*/addr_width - bank_bits,
+          block->UniquifyNodeName(absl::StrCat(name, "_bank_addr"))));
+  return BankedAddress{.bank = bank, .bank_addr = bank_addr};
+}
+
+// Returns `enable` gated by `bank` selecting bank `index`, named `name`.
+absl::StatusOr<Node*> GateByBank(Block* block, Node* enable, Node* bank,
+                                 int64_t index, std::string_view name) {
+  XLS_ASSIGN_OR_RETURN(
+      Node * index_literal,
+      block->MakeNode<xls::Literal>(
+          /*loc=*/SourceInfo(),
+          Value(UBits(index, bank->GetType()->GetFlatBitCount()))));
+  XLS_ASSIGN_OR_RETURN(Node * selected,
+                       block->MakeNode<CompareOp>(/*loc=*/SourceInfo(), bank,
+                                                  index_literal, Op::kEq));
+  return block->MakeNodeWithName<NaryOp>(
+      /*loc=*/SourceInfo(), std::vector<Node*>({enable, selected}), Op::kAnd,
+      name);
+}
+
+// Returns the read data of the bank accessed by the read issued in the
+// previous cycle. The bank index is registered alongside the read valid so the
+// mux lines up with the RAM's response.
+absl::StatusOr<Node*> SelectBankReadData(
+    Block* block, Node* bank, absl::Span<InputPort* const> rd_data_ports,
+    const std::optional<xls::Reset>& reset_behavior, std::string_view name) {
+  XLS_ASSIGN_OR_RETURN(
+      Node * bank_buf,
+      block->MakeNodeWithName<UnOp>(
+          /*loc=*/SourceInfo(), bank, Op::kIdentity,
+          block->UniquifyNodeName(absl::StrFormat("__%s_buffer", name))));
+  XLS_ASSIGN_OR_RETURN(
+      Node * bank_delay,
+      AddRegisterAfterNode(absl::StrCat(name, "_delay"), reset_behavior,
+                           std::nullopt, bank_buf, block));
+  return block->MakeNode<Select>(
+      /*loc=*/SourceInfo(), bank_delay,
+      std::vector<Node*>(rd_data_ports.begin(), rd_data_ports.end()),
+      /*default_value=*/std::nullopt);
+}
+
+// The ports of one physical bank of a 1R1W RAM.
+struct Ram1R1WBankPorts {
+  std::string ram_name;
+  OutputPort* rd_addr;
+  OutputPort* rd_mask;
+  OutputPort* rd_en;
+  OutputPort* wr_addr;
+  OutputPort* wr_data;
+  OutputPort* wr_mask;
+  OutputPort* wr_en;
+  InputPort* rd_data;
+};
+
+// Returns the name prefix of the ports of bank `index` of `ram_name`. An
+// unbanked RAM keeps the name of the RAM itself.
+std::string BankName(std::string_view ram_name, int64_t bank_count,
+                     int64_t index) {
+  if (bank_count == 1) {
+    return std::string(ram_name);
+  }
+  return absl::StrCat(ram_name, "_bank", index);
+}
+
 absl::StatusOr<bool> Ram1RWRewrite(
     CodegenPassUnit* unit, const CodegenPassOptions& pass_options,
     const RamConfiguration& base_ram_configuration) {
@@ -423,20 +533,21 @@ absl::StatusOr<bool> Ram1RWRewrite(
   Node* req_valid = rw_block_ports.req_ports.req_valid->operand(0);
 
   // Make names for each element of the request tuple. They will end up each
-  // having their own port.
+  // having their own port, one set per bank.
   std::string_view ram_name = ram_config.ram_name();
-  std::string req_addr_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_addr"));
-  std::string req_wr_data_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_wr_data"));
-  std::string req_wr_mask_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_wr_mask"));
-  std::string req_rd_mask_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_rd_mask"));
+  int64_t bank_count = ram_config.bank_count();
   std::string req_we_name =
       block->UniquifyNodeName(absl::StrCat(ram_name, "_we"));
   std::string req_re_name =
       block->UniquifyNodeName(absl::StrCat(ram_name, "_re"));
+  std::vector<Ram1RWBankPorts> bank_ports(bank_count);
+  for (int64_t bank = 0; bank < bank_count; ++bank) {
+    bank_ports[bank].ram_name = BankName(ram_name, bank_count, bank);
+  }
+  auto port_name = [&](int64_t bank, std::string_view suffix) {
+    return block->UniquifyNodeName(
+        absl::StrCat(bank_ports[bank].ram_name, suffix));
+  };
 
   // we is asserted when req.we is asserted and when the request is valid.
   XLS_ASSIGN_OR_RETURN(
@@ -451,6 +562,13 @@ absl::StatusOr<bool> Ram1RWRewrite(
           /*loc=*/SourceInfo(), std::vector<Node*>({req_re, req_valid}),
           Op::kAnd, req_re_name));
 
+  std::optional<BankedAddress> banked_addr;
+  if (bank_count > 1) {
+    XLS_ASSIGN_OR_RETURN(
+        banked_addr,
+        SplitBankedAddress(block, req_addr, bank_count, ram_name));
+  }
+
   std::string req_re_valid_buf_name = block->UniquifyNodeName(
       absl::StrFormat("__%s_buffer", req_re_valid->GetName()));
   XLS_ASSIGN_OR_RETURN(Node * req_re_valid_buf,
@@ -467,15 +585,25 @@ absl::StatusOr<bool> Ram1RWRewrite(
                            reset_behavior, std::nullopt, req_re_valid_buf,
                            block));
 
-  // Make a new response port with a new name.
-  std::string resp_rd_data_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_rd_data"));
-  XLS_ASSIGN_OR_RETURN(
-      InputPort * resp_rd_data_port,
-      block->AddInputPort(resp_rd_data_name,
-                          rw_block_ports.resp_ports.resp_data->GetType()));
+  // Make a new response port per bank with a new name. A banked RAM returns
+  // the read data of the bank accessed in the previous cycle.
+  std::vector<InputPort*> rd_data_ports;
+  for (int64_t bank = 0; bank < bank_count; ++bank) {
+    XLS_ASSIGN_OR_RETURN(
+        bank_ports[bank].rd_data,
+        block->AddInputPort(port_name(bank, "_rd_data"),
+                            rw_block_ports.resp_ports.resp_data->GetType()));
+    rd_data_ports.push_back(bank_ports[bank].rd_data);
+  }
+  Node* resp_rd_data = rd_data_ports.front();
+  if (banked_addr.has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        resp_rd_data,
+        SelectBankReadData(block, banked_addr->bank, rd_data_ports,
+                           reset_behavior, absl::StrCat(ram_name, "_rd_bank")));
+  }
   XLS_RETURN_IF_ERROR(
-      rw_block_ports.resp_ports.resp_data->ReplaceUsesWith(resp_rd_data_port));
+      rw_block_ports.resp_ports.resp_data->ReplaceUsesWith(resp_rd_data));
 
   // Add buffer before resp_ready
   std::string resp_ready_port_buf_name = absl::StrFormat(
@@ -488,7 +616,7 @@ absl::StatusOr<bool> Ram1RWRewrite(
 
   // Update channel ready/valid ports usages with new internal signals.
   absl::flat_hash_map<Node*, Node*> replaced_nodes = {
-      {rw_block_ports.resp_ports.resp_data, resp_rd_data_port},
+      {rw_block_ports.resp_ports.resp_data, resp_rd_data},
       {rw_block_ports.resp_ports.resp_ready, resp_ready_port_buf},
       {rw_block_ports.resp_ports.resp_ready->operand(0), resp_ready_port_buf},
       {rw_block_ports.resp_ports.resp_valid, ram_resp_valid},
@@ -516,24 +644,43 @@ absl::StatusOr<bool> Ram1RWRewrite(
   std::string zero_latency_buffer_name =
       absl::StrCat(ram_name, "_ram_zero_latency0");
   XLS_RETURN_IF_ERROR(AddZeroLatencyBufferToRDVNodes(
-                          resp_rd_data_port, ram_resp_valid,
-                          resp_ready_port_buf, zero_latency_buffer_name,
-                          reset_behavior, block, valid_nodes)
+                          resp_rd_data, ram_resp_valid, resp_ready_port_buf,
+                          zero_latency_buffer_name, reset_behavior, block,
+                          valid_nodes)
                           .status());
 
-  // Add output ports for expanded req.data.
-  XLS_ASSIGN_OR_RETURN(auto* req_addr_port,
-                       block->AddOutputPort(req_addr_name, req_addr));
-  XLS_ASSIGN_OR_RETURN(auto* req_wr_data_port,
-                       block->AddOutputPort(req_wr_data_name, req_wr_data));
-  XLS_ASSIGN_OR_RETURN(auto* req_wr_mask_port,
-                       block->AddOutputPort(req_wr_mask_name, req_wr_mask));
-  XLS_ASSIGN_OR_RETURN(auto* req_rd_mask_port,
-                       block->AddOutputPort(req_rd_mask_name, req_rd_mask));
-  XLS_ASSIGN_OR_RETURN(auto* req_we_port,
-                       block->AddOutputPort(req_we_name, req_we_valid));
-  XLS_ASSIGN_OR_RETURN(auto* req_re_port,
-                       block->AddOutputPort(req_re_name, req_re_valid));
+  // Add output ports for expanded req.data. Each bank sees every request but
+  // only enables reads and writes addressed to it.
+  for (int64_t bank = 0; bank < bank_count; ++bank) {
+    std::string addr_name = port_name(bank, "_addr");
+    std::string wr_data_name = port_name(bank, "_wr_data");
+    std::string wr_mask_name = port_name(bank, "_wr_mask");
+    std::string rd_mask_name = port_name(bank, "_rd_mask");
+    Node* addr = req_addr;
+    Node* we = req_we_valid;
+    Node* re = req_re_valid;
+    std::string we_name = req_we_name;
+    std::string re_name = req_re_name;
+    if (banked_addr.has_value()) {
+      we_name = port_name(bank, "_we");
+      re_name = port_name(bank, "_re");
+      addr = banked_addr->bank_addr;
+      XLS_ASSIGN_OR_RETURN(we, GateByBank(block, req_we_valid,
+                                          banked_addr->bank, bank, we_name));
+      XLS_ASSIGN_OR_RETURN(re, GateByBank(block, req_re_valid,
+                                          banked_addr->bank, bank, re_name));
+    }
+    Ram1RWBankPorts& ports = bank_ports[bank];
+    XLS_ASSIGN_OR_RETURN(ports.addr, block->AddOutputPort(addr_name, addr));
+    XLS_ASSIGN_OR_RETURN(ports.wr_data,
+                         block->AddOutputPort(wr_data_name, req_wr_data));
+    XLS_ASSIGN_OR_RETURN(ports.wr_mask,
+                         block->AddOutputPort(wr_mask_name, req_wr_mask));
+    XLS_ASSIGN_OR_RETURN(ports.rd_mask,
+                         block->AddOutputPort(rd_mask_name, req_rd_mask));
+    XLS_ASSIGN_OR_RETURN(ports.we, block->AddOutputPort(we_name, we));
+    XLS_ASSIGN_OR_RETURN(ports.re, block->AddOutputPort(re_name, re));
+  }
 
   // Remove ports that have been replaced.
   XLS_RETURN_IF_ERROR(block->RemoveNode(rw_block_ports.req_ports.req_data));
@@ -556,15 +703,8 @@ absl::StatusOr<bool> Ram1RWRewrite(
 
     if (metadata_itr->second.signature.has_value()) {
       ModuleSignature& signature = *metadata_itr->second.signature;
-      XLS_RETURN_IF_ERROR(
-          Ram1RWUpdateSignature(signature, ram_config, ram_name, unit->package,
-                                /*req_addr_port=*/req_addr_port,
-                                /*req_re_port=*/req_re_port,
-                                /*req_we_port=*/req_we_port,
-                                /*req_wr_data_port=*/req_wr_data_port,
-                                /*req_wr_mask_port=*/req_wr_mask_port,
-                                /*req_rd_mask_port=*/req_rd_mask_port,
-                                /*resp_rd_data_port=*/resp_rd_data_port));
+      XLS_RETURN_IF_ERROR(Ram1RWUpdateSignature(signature, ram_config,
+                                                unit->package, bank_ports));
     }
   }
 
@@ -627,26 +767,38 @@ absl::StatusOr<bool> Ram1R1WRewrite(
   Node* wr_en = w_block_ports.req_ports.req_valid->operand(0);
 
   // Make names for each element of the request tuple. They will end up each
-  // having their own port.
+  // having their own port, one set per bank.
   std::string_view ram_name = ram_config.ram_name();
-  std::string rd_addr_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_rd_addr"));
-  std::string rd_mask_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_rd_mask"));
+  int64_t bank_count = ram_config.bank_count();
   std::string rd_en_name =
       block->UniquifyNodeName(absl::StrCat(ram_name, "_rd_en"));
-  std::string wr_addr_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_wr_addr"));
-  std::string wr_data_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_wr_data"));
-  std::string wr_mask_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_wr_mask"));
   std::string wr_en_name =
       block->UniquifyNodeName(absl::StrCat(ram_name, "_wr_en"));
+  std::vector<Ram1R1WBankPorts> bank_ports(bank_count);
+  for (int64_t bank = 0; bank < bank_count; ++bank) {
+    bank_ports[bank].ram_name = BankName(ram_name, bank_count, bank);
+  }
+  auto port_name = [&](int64_t bank, std::string_view suffix) {
+    return block->UniquifyNodeName(
+        absl::StrCat(bank_ports[bank].ram_name, suffix));
+  };
 
   wr_en->SetName(wr_en_name);
   rd_en->SetName(rd_en_name);
 
+  std::optional<BankedAddress> banked_rd_addr;
+  std::optional<BankedAddress> banked_wr_addr;
+  if (bank_count > 1) {
+    XLS_ASSIGN_OR_RETURN(
+        banked_rd_addr,
+        SplitBankedAddress(block, rd_addr, bank_count,
+                           absl::StrCat(ram_name, "_rd")));
+    XLS_ASSIGN_OR_RETURN(
+        banked_wr_addr,
+        SplitBankedAddress(block, wr_addr, bank_count,
+                           absl::StrCat(ram_name, "_wr")));
+  }
+
   std::string req_re_valid_buf_name =
       block->UniquifyNodeName(absl::StrFormat("__%s_buffer", rd_en->GetName()));
   XLS_ASSIGN_OR_RETURN(
@@ -663,15 +815,26 @@ absl::StatusOr<bool> Ram1R1WRewrite(
                            reset_behavior, std::nullopt, req_re_valid_buf,
                            block));
 
-  // Make a new response port with a new name.
-  std::string rd_data_name =
-      block->UniquifyNodeName(absl::StrCat(ram_name, "_rd_data"));
-  XLS_ASSIGN_OR_RETURN(InputPort * rd_data_port,
-                       block->AddInputPort(rd_data_name, rd_data->GetType()));
+  // Make a new response port per bank with a new name. A banked RAM returns
+  // the read data of the bank accessed in the previous cycle.
+  std::vector<InputPort*> rd_data_ports;
+  for (int64_t bank = 0; bank < bank_count; ++bank) {
+    XLS_ASSIGN_OR_RETURN(
+        bank_ports[bank].rd_data,
+        block->AddInputPort(port_name(bank, "_rd_data"), rd_data->GetType()));
+    rd_data_ports.push_back(bank_ports[bank].rd_data);
+  }
+  Node* rd_data_value = rd_data_ports.front();
+  if (banked_rd_addr.has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        rd_data_value,
+        SelectBankReadData(block, banked_rd_addr->bank, rd_data_ports,
+                           reset_behavior, absl::StrCat(ram_name, "_rd_bank")));
+  }
   XLS_ASSIGN_OR_RETURN(
       Tuple * rd_data_tuple,
       block->MakeNode<Tuple>(/*loc=*/SourceInfo(),
-                             std::vector<Node*>{rd_data_port}));
+                             std::vector<Node*>{rd_data_value}));
   XLS_RETURN_IF_ERROR(
       r_block_ports.resp_ports.resp_data->ReplaceUsesWith(rd_data_tuple));
 
@@ -697,7 +860,7 @@ absl::StatusOr<bool> Ram1R1WRewrite(
   std::string zero_latency_buffer_name =
       absl::StrCat(ram_name, "_ram_zero_latency0");
   XLS_RETURN_IF_ERROR(AddZeroLatencyBufferToRDVNodes(
-                          rd_data_port, rd_resp_valid, resp_ready_port_buf,
+                          rd_data_value, rd_resp_valid, resp_ready_port_buf,
                           zero_latency_buffer_name, reset_behavior, block,
                           valid_nodes)
                           .status());
@@ -709,21 +872,48 @@ absl::StatusOr<bool> Ram1R1WRewrite(
   XLS_RETURN_IF_ERROR(
       w_block_ports.req_ports.req_ready->ReplaceUsesWith(literal_1));
 
-  // Add output ports for expanded req.data.
-  XLS_ASSIGN_OR_RETURN(auto* rd_addr_port,
-                       block->AddOutputPort(rd_addr_name, rd_addr));
-  XLS_ASSIGN_OR_RETURN(auto* rd_mask_port,
-                       block->AddOutputPort(rd_mask_name, rd_mask));
-  XLS_ASSIGN_OR_RETURN(auto* rd_en_port,
-                       block->AddOutputPort(rd_en_name, rd_en));
-  XLS_ASSIGN_OR_RETURN(auto* wr_addr_port,
-                       block->AddOutputPort(wr_addr_name, wr_addr));
-  XLS_ASSIGN_OR_RETURN(auto* wr_data_port,
-                       block->AddOutputPort(wr_data_name, wr_data));
-  XLS_ASSIGN_OR_RETURN(auto* wr_mask_port,
-                       block->AddOutputPort(wr_mask_name, wr_mask));
-  XLS_ASSIGN_OR_RETURN(auto* wr_en_port,
-                       block->AddOutputPort(wr_en_name, wr_en));
+  // Add output ports for expanded req.data. Each bank sees every request but
+  // only enables reads and writes addressed to it.
+  for (int64_t bank = 0; bank < bank_count; ++bank) {
+    std::string rd_addr_name = port_name(bank, "_rd_addr");
+    std::string rd_mask_name = port_name(bank, "_rd_mask");
+    std::string wr_addr_name = port_name(bank, "_wr_addr");
+    std::string wr_data_name = port_name(bank, "_wr_data");
+    std::string wr_mask_name = port_name(bank, "_wr_mask");
+    Node* bank_rd_addr = rd_addr;
+    Node* bank_wr_addr = wr_addr;
+    Node* bank_rd_en = rd_en;
+    Node* bank_wr_en = wr_en;
+    std::string bank_rd_en_name = rd_en_name;
+    std::string bank_wr_en_name = wr_en_name;
+    if (bank_count > 1) {
+      bank_rd_en_name = port_name(bank, "_rd_en");
+      bank_wr_en_name = port_name(bank, "_wr_en");
+      bank_rd_addr = banked_rd_addr->bank_addr;
+      bank_wr_addr = banked_wr_addr->bank_addr;
+      XLS_ASSIGN_OR_RETURN(bank_rd_en,
+                           GateByBank(block, rd_en, banked_rd_addr->bank, bank,
+                                      bank_rd_en_name));
+      XLS_ASSIGN_OR_RETURN(bank_wr_en,
+                           GateByBank(block, wr_en, banked_wr_addr->bank, bank,
+                                      bank_wr_en_name));
+    }
+    Ram1R1WBankPorts& ports = bank_ports[bank];
+    XLS_ASSIGN_OR_RETURN(ports.rd_addr,
+                         block->AddOutputPort(rd_addr_name, bank_rd_addr));
+    XLS_ASSIGN_OR_RETURN(ports.rd_mask,
+                         block->AddOutputPort(rd_mask_name, rd_mask));
+    XLS_ASSIGN_OR_RETURN(ports.rd_en,
+                         block->AddOutputPort(bank_rd_en_name, bank_rd_en));
+    XLS_ASSIGN_OR_RETURN(ports.wr_addr,
+                         block->AddOutputPort(wr_addr_name, bank_wr_addr));
+    XLS_ASSIGN_OR_RETURN(ports.wr_data,
+                         block->AddOutputPort(wr_data_name, wr_data));
+    XLS_ASSIGN_OR_RETURN(ports.wr_mask,
+                         block->AddOutputPort(wr_mask_name, wr_mask));
+    XLS_ASSIGN_OR_RETURN(ports.wr_en,
+                         block->AddOutputPort(bank_wr_en_name, bank_wr_en));
+  }
 
   // Remove ports that have been replaced.
   XLS_RETURN_IF_ERROR(block->RemoveNode(r_block_ports.req_ports.req_data));
@@ -782,45 +972,51 @@ absl::StatusOr<bool> Ram1R1WRewrite(
               builder.RemoveData(channel->GetValidPortName().value()));
         }
       }
-      for (const xls::OutputPort* port : {
-               rd_addr_port,
-               rd_mask_port,
-               rd_en_port,
-               wr_addr_port,
-               wr_data_port,
-               wr_mask_port,
-               wr_en_port,
-           }) {
-        if (port->operand(0)->GetType()->GetFlatBitCount() > 0) {
-          builder.AddDataOutput(port->name(), port->operand(0)->GetType());
+      for (const Ram1R1WBankPorts& bank : bank_ports) {
+        for (const xls::OutputPort* port : {
+                 bank.rd_addr,
+                 bank.rd_mask,
+                 bank.rd_en,
+                 bank.wr_addr,
+                 bank.wr_data,
+                 bank.wr_mask,
+                 bank.wr_en,
+             }) {
+          if (port->operand(0)->GetType()->GetFlatBitCount() > 0) {
+            builder.AddDataOutput(port->name(), port->operand(0)->GetType());
+          }
         }
-      }
-      for (const xls::InputPort* port : {rd_data_port}) {
-        if (port->GetType()->GetFlatBitCount() > 0) {
-          builder.AddDataInput(port->name(), port->GetType());
+        for (const xls::InputPort* port : {bank.rd_data}) {
+          if (port->GetType()->GetFlatBitCount() > 0) {
+            builder.AddDataInput(port->name(), port->GetType());
+          }
         }
       }
 
-      builder.AddRam1R1W({
-          .package = unit->package,
-          .data_type = rd_data->GetType(),
-          .ram_name = ram_name,
-          .rd_req_name = ram_config.r_port_configuration().request_channel_name,
-          .rd_resp_name =
-              ram_config.r_port_configuration().response_channel_name,
-          .wr_req_name = ram_config.w_port_configuration().request_channel_name,
-          .address_width = rd_addr_port->GetType()->GetFlatBitCount(),
-          .read_mask_width = rd_mask_port->GetType()->GetFlatBitCount(),
-          .write_mask_width = wr_mask_port->GetType()->GetFlatBitCount(),
-          .read_address_name = rd_addr_port->GetName(),
-          .read_data_name = rd_data_port->GetName(),
-          .read_mask_name = rd_mask_port->GetName(),
-          .read_enable_name = rd_en_port->GetName(),
-          .write_address_name = wr_addr_port->GetName(),
-          .write_data_name = wr_data_port->GetName(),
-          .write_mask_name = wr_mask_port->GetName(),
-          .write_enable_name = wr_en_port->GetName(),
-      });
+      for (const Ram1R1WBankPorts& bank : bank_ports) {
+        builder.AddRam1R1W({
+            .package = unit->package,
+            .data_type = rd_data->GetType(),
+            .ram_name = bank.ram_name,
+            .rd_req_name =
+                ram_config.r_port_configuration().request_channel_name,
+            .rd_resp_name =
+                ram_config.r_port_configuration().response_channel_name,
+            .wr_req_name =
+                ram_config.w_port_configuration().request_channel_name,
+            .address_width = bank.rd_addr->GetType()->GetFlatBitCount(),
+            .read_mask_width = bank.rd_mask->GetType()->GetFlatBitCount(),
+            .write_mask_width = bank.wr_mask->GetType()->GetFlatBitCount(),
+            .read_address_name = bank.rd_addr->GetName(),
+            .read_data_name = bank.rd_data->GetName(),
+            .read_mask_name = bank.rd_mask->GetName(),
+            .read_enable_name = bank.rd_en->GetName(),
+            .write_address_name = bank.wr_addr->GetName(),
+            .write_data_name = bank.wr_data->GetName(),
+            .write_mask_name = bank.wr_mask->GetName(),
+            .write_enable_name = bank.wr_en->GetName(),
+        });
+      }
 
       XLS_ASSIGN_OR_RETURN(signature, builder.Build());
     }
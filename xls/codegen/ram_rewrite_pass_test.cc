@@ -974,7 +974,8 @@ INSTANTIATE_TEST_SUITE_P(
 
 // Expects channels named "req" and "resp" and a top level proc named "my_proc".
 absl::StatusOr<Block*> MakeBlockAndRunPasses(Package* package,
-                                             std::string_view ram_kind) {
+                                             std::string_view ram_kind,
+                                             int64_t bank_count = 1) {
   std::vector<std::unique_ptr<RamConfiguration>> ram_configurations;
   if (ram_kind == "1RW") {
     ram_configurations.push_back(std::make_unique<Ram1RWConfiguration>(
@@ -986,6 +987,7 @@ absl::StatusOr<Block*> MakeBlockAndRunPasses(Package* package,
     return absl::InvalidArgumentError(
         absl::StrFormat("Unrecognized ram_kind %s.", ram_kind));
   }
+  ram_configurations.front()->set_bank_count(bank_count);
 
   CodegenOptions codegen_options;
   codegen_options.flop_inputs(false)
@@ -1456,6 +1458,68 @@ TEST(RamRewritePassInvalidInputsTest, ReadResponseElementNotBits1R1W) {
                                  "contain token, got token.")));
 }
 
+// Tests for RAMs interleaved across several banks.
+TEST(RamRewritePassBankingTest, Banked1RW) {
+  std::string ir_text = MakeTestProc1RW({});
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * block,
+      MakeBlockAndRunPasses(package.get(), /*ram_kind=*/"1RW",
+                            /*bank_count=*/4));
+  for (int64_t bank = 0; bank < 4; ++bank) {
+    std::string prefix = absl::StrCat("ram_bank", bank);
+    XLS_ASSERT_OK_AND_ASSIGN(OutputPort * addr,
+                             block->GetOutputPort(prefix + "_addr"));
+    // The low two address bits select the bank.
+    EXPECT_EQ(addr->operand(0)->GetType()->GetFlatBitCount(), 30);
+    XLS_EXPECT_OK(block->GetOutputPort(prefix + "_wr_data"));
+    XLS_EXPECT_OK(block->GetOutputPort(prefix + "_we"));
+    XLS_EXPECT_OK(block->GetOutputPort(prefix + "_re"));
+    XLS_ASSERT_OK_AND_ASSIGN(InputPort * rd_data,
+                             block->GetInputPort(prefix + "_rd_data"));
+    EXPECT_EQ(rd_data->GetType()->GetFlatBitCount(), 32);
+  }
+  EXPECT_THAT(block->GetOutputPort("ram_addr"),
+              StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_THAT(block->GetInputPort("ram_rd_data"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(RamRewritePassBankingTest, Banked1R1W) {
+  std::string ir_text = MakeTestProc1R1W({});
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * block,
+      MakeBlockAndRunPasses(package.get(), /*ram_kind=*/"1R1W",
+                            /*bank_count=*/2));
+  for (int64_t bank = 0; bank < 2; ++bank) {
+    std::string prefix = absl::StrCat("ram_bank", bank);
+    XLS_ASSERT_OK_AND_ASSIGN(OutputPort * rd_addr,
+                             block->GetOutputPort(prefix + "_rd_addr"));
+    EXPECT_EQ(rd_addr->operand(0)->GetType()->GetFlatBitCount(), 31);
+    XLS_ASSERT_OK_AND_ASSIGN(OutputPort * wr_addr,
+                             block->GetOutputPort(prefix + "_wr_addr"));
+    EXPECT_EQ(wr_addr->operand(0)->GetType()->GetFlatBitCount(), 31);
+    XLS_EXPECT_OK(block->GetOutputPort(prefix + "_rd_en"));
+    XLS_EXPECT_OK(block->GetOutputPort(prefix + "_wr_en"));
+    XLS_EXPECT_OK(block->GetOutputPort(prefix + "_wr_data"));
+    XLS_EXPECT_OK(block->GetInputPort(prefix + "_rd_data"));
+  }
+  EXPECT_THAT(block->GetOutputPort("ram_rd_addr"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(RamRewritePassBankingTest, AddressTooNarrowForBanks) {
+  std::string ir_text = MakeTestProc1RW(
+      {.req_type = "(bits[2], bits[32], (), (), bits[1], bits[1])",
+       .send_value = "literal(value=(0, 0, (), (), 1, 0))"});
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  EXPECT_THAT(MakeBlockAndRunPasses(package.get(), /*ram_kind=*/"1RW",
+                                    /*bank_count=*/4),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("too narrow to select among 4 banks")));
+}
+
 }  // namespace
 }  // namespace verilog
 }  // namespace xls
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <optional>
+#include <sstream>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -112,6 +113,28 @@ void LineInfo::End(const VastNode* node) {
 
 void LineInfo::Increase(int64_t delta) { current_line_number_ += delta; }
 
+void VastStreamEmitter::Write(std::string_view text) {
+  while (!text.empty()) {
+    size_t newline = text.find('\n');
+    std::string_view line = text.substr(0, newline);
+    if (!line.empty()) {
+      // Like Indent(), empty lines are not indented to avoid trailing white
+      // space.
+      if (at_line_start_ && indent_level_ > 0) {
+        *out_ << std::string(indent_level_ * kDefaultIndentSpaces, ' ');
+      }
+      *out_ << line;
+      at_line_start_ = false;
+    }
+    if (newline == std::string_view::npos) {
+      break;
+    }
+    *out_ << '\n';
+    at_line_start_ = true;
+    text.remove_prefix(newline + 1);
+  }
+}
+
 std::optional<std::vector<LineSpan>> LineInfo::LookupNode(
     const VastNode* node) const {
   if (!spans_.contains(node)) {
@@ -212,21 +235,24 @@ UnpackedArrayType* VerilogFile::UnpackedArrayType(
 }
 
 std::string VerilogFile::Emit(LineInfo* line_info) const {
-  auto file_member_str = [=](const FileMember& member) -> std::string {
-    return absl::visit(
-        Visitor{[=](Include* m) -> std::string { return m->Emit(line_info); },
-                [=](Module* m) -> std::string { return m->Emit(line_info); },
-                [=](BlankLine* m) -> std::string { return m->Emit(line_info); },
-                [=](Comment* m) -> std::string { return m->Emit(line_info); }},
-        member);
-  };
+  std::ostringstream out;
+  VastStreamEmitter emitter(&out);
+  EmitTo(&emitter, line_info);
+  return std::move(out).str();
+}
 
-  std::string out;
+void VerilogFile::EmitTo(VastStreamEmitter* emitter,
+                         LineInfo* line_info) const {
   for (const FileMember& member : members_) {
-    absl::StrAppend(&out, file_member_str(member), "\n");
+    absl::visit(
+        Visitor{[=](Include* m) { emitter->Write(m->Emit(line_info)); },
+                [=](Module* m) { m->EmitTo(emitter, line_info); },
+                [=](BlankLine* m) { emitter->Write(m->Emit(line_info)); },
+                [=](Comment* m) { emitter->Write(m->Emit(line_info)); }},
+        member);
+    emitter->Write("\n");
     LineInfoIncrease(line_info, 1);
   }
-  return out;
 }
 
 LocalParamItemRef* LocalParam::AddItem(std::string_view name,
@@ -708,22 +734,37 @@ std::string EmitModuleMember(LineInfo* line_info, const ModuleMember& member) {
 }  // namespace
 
 std::string ModuleSection::Emit(LineInfo* line_info) const {
+  std::ostringstream out;
+  VastStreamEmitter emitter(&out);
+  EmitTo(&emitter, line_info);
+  return std::move(out).str();
+}
+
+void ModuleSection::EmitTo(VastStreamEmitter* emitter,
+                           LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::vector<std::string> elements;
+  bool first = true;
   for (const ModuleMember& member : members_) {
     if (std::holds_alternative<ModuleSection*>(member)) {
       if (std::get<ModuleSection*>(member)->members_.empty()) {
         continue;
       }
     }
-    elements.push_back(EmitModuleMember(line_info, member));
+    if (!first) {
+      emitter->Write("\n");
+    }
+    first = false;
+    if (std::holds_alternative<ModuleSection*>(member)) {
+      std::get<ModuleSection*>(member)->EmitTo(emitter, line_info);
+    } else {
+      emitter->Write(EmitModuleMember(line_info, member));
+    }
     LineInfoIncrease(line_info, 1);
   }
-  if (!elements.empty()) {
+  if (!first) {
     LineInfoIncrease(line_info, -1);
   }
   LineInfoEnd(line_info, this);
-  return absl::StrJoin(elements, "\n");
 }
 
 std::string ContinuousAssignment::Emit(LineInfo* line_info) const {
@@ -828,29 +869,37 @@ std::string SystemFunctionCall::Emit(LineInfo* line_info) const {
 }
 
 std::string Module::Emit(LineInfo* line_info) const {
+  std::ostringstream out;
+  VastStreamEmitter emitter(&out);
+  EmitTo(&emitter, line_info);
+  return std::move(out).str();
+}
+
+void Module::EmitTo(VastStreamEmitter* emitter, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::string result = absl::StrCat("module ", name_);
+  emitter->Write(absl::StrCat("module ", name_));
   if (ports_.empty()) {
-    absl::StrAppend(&result, ";\n");
+    emitter->Write(";\n");
     LineInfoIncrease(line_info, 1);
   } else {
-    absl::StrAppend(&result, "(\n  ");
+    emitter->Write("(\n  ");
     LineInfoIncrease(line_info, 1);
-    absl::StrAppend(
-        &result,
+    emitter->Write(
         absl::StrJoin(ports_, ",\n  ", [=](std::string* out, const Port& port) {
           absl::StrAppendFormat(out, "%s %s", ToString(port.direction),
                                 port.wire->EmitNoSemi(line_info));
           LineInfoIncrease(line_info, 1);
         }));
-    absl::StrAppend(&result, "\n);\n");
+    emitter->Write("\n);\n");
     LineInfoIncrease(line_info, 1);
   }
-  absl::StrAppend(&result, Indent(top_.Emit(line_info)), "\n");
+  emitter->Indent();
+  top_.EmitTo(emitter, line_info);
+  emitter->Dedent();
+  emitter->Write("\n");
   LineInfoIncrease(line_info, 1);
-  absl::StrAppend(&result, "endmodule");
+  emitter->Write("endmodule");
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 std::string Literal::Emit(LineInfo* line_info) const {
@@ -148,6 +148,30 @@ class LineInfo {
   absl::flat_hash_map<const VastNode*, PartialLineSpans> spans_;
 };
 
+// A sink into which Verilog text is written incrementally, for example into a
+// file, so that emitting a large VerilogFile does not require building (and
+// repeatedly copying) the text of every module in memory. Non-empty lines are
+// prefixed with the current indentation.
+class VastStreamEmitter {
+ public:
+  explicit VastStreamEmitter(std::ostream* out) : out_(out) {}
+
+  void Write(std::string_view text);
+
+  // Increases or decreases the indentation of subsequently started lines by
+  // `kDefaultIndentSpaces`.
+  void Indent() { ++indent_level_; }
+  void Dedent() {
+    CHECK_GT(indent_level_, 0);
+    --indent_level_;
+  }
+
+ private:
+  std::ostream* out_;
+  int64_t indent_level_ = 0;
+  bool at_line_start_ = true;
+};
+
 // Returns a sanitized identifier string based on the given name. Invalid
 // characters are replaced with '_'.
 std::string SanitizeIdentifier(std::string_view name);
@@ -1612,6 +1636,7 @@ class ModuleSection : public VastNode {
   std::vector<ModuleMember> GatherMembers() const;
 
   std::string Emit(LineInfo* line_info) const override;
+  void EmitTo(VastStreamEmitter* emitter, LineInfo* line_info) const;
 
  private:
   std::vector<ModuleMember> members_;
@@ -1679,6 +1704,7 @@ class Module : public VastNode {
   const std::string& name() const { return name_; }
 
   std::string Emit(LineInfo* line_info) const override;
+  void EmitTo(VastStreamEmitter* emitter, LineInfo* line_info) const;
 
  private:
   // Add the given Def as a port on the module.
@@ -1735,6 +1761,10 @@ class VerilogFile {
 
   std::string Emit(LineInfo* line_info = nullptr) const;
 
+  // Emits the file into `emitter` one module member at a time. Produces the
+  // same text and line info as Emit().
+  void EmitTo(VastStreamEmitter* emitter, LineInfo* line_info = nullptr) const;
+
   verilog::Slice* Slice(IndexableExpression* subject, Expression* hi,
                         Expression* lo, const SourceInfo& loc) {
     return Make<verilog::Slice>(loc, subject, hi, lo);
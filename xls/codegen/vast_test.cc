@@ -15,6 +15,7 @@
 #include "xls/codegen/vast.h"
 
 #include <optional>
+#include <sstream>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -1245,6 +1246,55 @@ endmodule)");
             std::vector<LineSpan>{LineSpan(7, 7)});
 }
 
+TEST_P(VastTest, StreamedFileMatchesEmittedFile) {
+  VerilogFile f(GetFileType());
+  f.Add(f.Make<Comment>(SourceInfo(), "first line\nsecond line"));
+  Module* m0 = f.AddModule("m0", SourceInfo());
+  LogicRef* a =
+      m0->AddInput("a", f.BitVectorType(8, SourceInfo()), SourceInfo());
+  LogicRef* b =
+      m0->AddOutput("b", f.BitVectorType(8, SourceInfo()), SourceInfo());
+  ModuleSection* section = m0->Add<ModuleSection>(SourceInfo());
+  section->Add<Comment>(SourceInfo(), "multi\nline");
+  section->Add<BlankLine>(SourceInfo());
+  VastNode* assign = section->Add<ContinuousAssignment>(SourceInfo(), b, a);
+  f.Add(f.Make<BlankLine>(SourceInfo()));
+  Module* m1 = f.AddModule("m1", SourceInfo());
+  m1->AddWire("w", f.BitVectorType(1, SourceInfo()), SourceInfo());
+
+  LineInfo line_info;
+  std::string emitted = f.Emit(&line_info);
+  EXPECT_EQ(emitted, R"(// first line
+// second line
+module m0(
+  input wire [7:0] a,
+  output wire [7:0] b
+);
+  // multi
+  // line
+
+  assign b = a;
+endmodule
+
+module m1;
+  wire w;
+endmodule
+)");
+
+  std::ostringstream out;
+  VastStreamEmitter emitter(&out);
+  LineInfo streamed_line_info;
+  f.EmitTo(&emitter, &streamed_line_info);
+  EXPECT_EQ(out.str(), emitted);
+  for (VastNode* node : std::vector<VastNode*>{m0, section, assign, m1}) {
+    EXPECT_EQ(streamed_line_info.LookupNode(node), line_info.LookupNode(node));
+  }
+  EXPECT_EQ(line_info.LookupNode(assign).value(),
+            std::vector<LineSpan>{LineSpan(9, 9)});
+  EXPECT_EQ(line_info.LookupNode(m1).value(),
+            std::vector<LineSpan>{LineSpan(12, 14)});
+}
+
 TEST_P(VastTest, VerilogFunction) {
   VerilogFile f(GetFileType());
   Module* m = f.AddModule("top", SourceInfo());
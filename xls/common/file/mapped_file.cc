@@ -0,0 +1,103 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/file/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/file_descriptor.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/error_code_to_status.h"
+#include "xls/common/status/status_builder.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+namespace {
+
+absl::Status ErrnoToStatusWithPath(int errno_value,
+                                   const std::filesystem::path& path) {
+  xabsl::StatusBuilder builder = ErrnoToStatus(errno_value);
+  builder << path.string();
+  return std::move(builder);
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<MappedFile> MappedFile::Open(
+    const std::filesystem::path& path) {
+  if (path == "-" || path == "/dev/stdin") {
+    XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+    return MappedFile(std::move(contents));
+  }
+  FileDescriptor fd(open(path.c_str(), O_RDONLY));
+  if (fd.get() == -1) {
+    return ErrnoToStatusWithPath(errno, path);
+  }
+  struct stat st;
+  if (fstat(fd.get(), &st) != 0) {
+    return ErrnoToStatusWithPath(errno, path);
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  if (!S_ISREG(st.st_mode) || size == 0) {
+    // Pipes and devices can't be mapped, and mmap rejects zero-length
+    // mappings. Some special files (e.g., under /proc) also report a size of
+    // zero despite having contents, so read rather than assume empty.
+    XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+    return MappedFile(std::move(contents));
+  }
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+  if (data == MAP_FAILED) {
+    return ErrnoToStatusWithPath(errno, path);
+  }
+  // Inputs are normally consumed front to back.
+  (void)madvise(data, size, MADV_SEQUENTIAL);
+  return MappedFile(data, size);
+}
+
+MappedFile::~MappedFile() { Unmap(); }
+
+MappedFile::MappedFile(MappedFile&& other)
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      read_contents_(std::move(other.read_contents_)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+  if (this != &other) {
+    Unmap();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    read_contents_ = std::move(other.read_contents_);
+  }
+  return *this;
+}
+
+void MappedFile::Unmap() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,79 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_FILE_MAPPED_FILE_H_
+#define XLS_COMMON_FILE_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/statusor.h"
+
+namespace xls {
+
+// RAII wrapper around a read-only memory mapping of an entire file. Mapping
+// lets very large inputs (e.g., multi-gigabyte netlists) be scanned without
+// copying them onto the heap; pages are faulted in on demand and may be
+// dropped by the kernel under memory pressure.
+//
+// Inputs which cannot be mapped, such as standard input ("-" or "/dev/stdin")
+// and other pipes, are read onto the heap instead so that tools can take any
+// input path through this class.
+class MappedFile {
+ public:
+  // Maps the file at `path` into memory, or reads it if it is not a regular
+  // file. An empty file yields an empty view.
+  static absl::StatusOr<MappedFile> Open(const std::filesystem::path& path);
+
+  ~MappedFile();
+
+  // MappedFile is movable but not copyable. The mapped address does not change
+  // on move, so views returned by contents() remain valid.
+  MappedFile(MappedFile&& other);
+  MappedFile& operator=(MappedFile&& other);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Returns the contents of the file. Valid for the lifetime of the mapping.
+  std::string_view contents() const {
+    if (read_contents_ != nullptr) {
+      return *read_contents_;
+    }
+    return std::string_view(static_cast<const char*>(data_), size_);
+  }
+
+  // Returns whether the contents are mapped rather than read onto the heap.
+  bool is_mapped() const { return data_ != nullptr; }
+
+ private:
+  MappedFile(void* data, size_t size) : data_(data), size_(size) {}
+  explicit MappedFile(std::string contents)
+      : read_contents_(std::make_unique<std::string>(std::move(contents))) {}
+
+  void Unmap();
+
+  void* data_ = nullptr;
+  size_t size_ = 0;
+  // The contents of an input which could not be mapped. Held by pointer so
+  // that views remain valid when the MappedFile is moved.
+  std::unique_ptr<std::string> read_contents_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_FILE_MAPPED_FILE_H_
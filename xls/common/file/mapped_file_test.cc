@@ -0,0 +1,90 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/file/mapped_file.h"
+
+#include <unistd.h>
+
+#include <filesystem>  // NOLINT
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+
+TEST(MappedFileTest, MapsContents) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "file.txt";
+  std::string text = "module m(a);\n  input a;\nendmodule\n";
+  XLS_ASSERT_OK(SetFileContents(path, text));
+
+  XLS_ASSERT_OK_AND_ASSIGN(MappedFile file, MappedFile::Open(path));
+  EXPECT_TRUE(file.is_mapped());
+  EXPECT_EQ(file.contents(), text);
+
+  // Moving the mapping keeps outstanding views valid.
+  std::string_view view = file.contents();
+  MappedFile moved = std::move(file);
+  EXPECT_EQ(moved.contents().data(), view.data());
+  EXPECT_EQ(view, text);
+}
+
+TEST(MappedFileTest, ReadsPipes) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  std::string text = "package p\n";
+  ASSERT_EQ(write(fds[1], text.data(), text.size()),
+            static_cast<ssize_t>(text.size()));
+  ASSERT_EQ(close(fds[1]), 0);
+
+  XLS_ASSERT_OK_AND_ASSIGN(MappedFile file,
+                           MappedFile::Open(absl::StrCat("/dev/fd/", fds[0])));
+  EXPECT_FALSE(file.is_mapped());
+  EXPECT_EQ(file.contents(), text);
+
+  // Moving keeps outstanding views valid for read contents too.
+  std::string_view view = file.contents();
+  MappedFile moved = std::move(file);
+  EXPECT_EQ(moved.contents().data(), view.data());
+  close(fds[0]);
+}
+
+TEST(MappedFileTest, EmptyFile) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "empty.txt";
+  XLS_ASSERT_OK(SetFileContents(path, ""));
+
+  XLS_ASSERT_OK_AND_ASSIGN(MappedFile file, MappedFile::Open(path));
+  EXPECT_TRUE(file.contents().empty());
+}
+
+TEST(MappedFileTest, MissingFile) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  EXPECT_THAT(MappedFile::Open(temp_dir.path() / "missing.txt"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace xls
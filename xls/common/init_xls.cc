@@ -14,18 +14,43 @@
 
 #include "xls/common/init_xls.h"
 
+#include <cstdlib>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
 #include "absl/flags/usage.h"
 #include "absl/flags/usage_config.h"
 #include "absl/log/check.h"
 #include "absl/log/initialize.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
 #include "xls/common/build_embed.h"
+#include "xls/common/trace.h"
+
+ABSL_FLAG(std::optional<std::string>, trace_path, std::nullopt,
+          "If specified, record the time spent in each phase of the toolchain "
+          "(parsing, type checking, IR conversion, passes, scheduling, "
+          "codegen, JIT compilation) and write it to this path on exit as "
+          "Chrome trace event JSON, viewable in Perfetto (ui.perfetto.dev) or "
+          "chrome://tracing.");
 
 namespace xls {
+namespace {
+
+void WriteTraceAtExit() {
+  std::optional<std::string> trace_path = absl::GetFlag(FLAGS_trace_path);
+  StopTracing();
+  absl::Status status = WriteTraceJson(*trace_path);
+  if (!status.ok()) {
+    LOG(ERROR) << "Unable to write trace to " << *trace_path << ": " << status;
+  }
+}
+
+}  // namespace
 
 std::vector<std::string_view> InitXls(std::string_view usage, int argc,
                                       char* argv[]) {
@@ -47,6 +72,11 @@ std::vector<std::string_view> InitXls(std::string_view usage, int argc,
 
   internal::InitXlsPostAbslFlagParse();
 
+  if (absl::GetFlag(FLAGS_trace_path).has_value()) {
+    StartTracing();
+    std::atexit(WriteTraceAtExit);
+  }
+
   return std::vector<std::string_view>(remaining.begin() + 1, remaining.end());
 }
 
@@ -0,0 +1,71 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Functions which estimate the heap memory held by standard containers. These
+// are used to account for the memory used by the IR and by analyses. The
+// estimates count the storage allocated by the container itself but not heap
+// memory held by its elements, and ignore allocator overhead.
+
+#ifndef XLS_COMMON_MEMORY_USAGE_H_
+#define XLS_COMMON_MEMORY_USAGE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/container/node_hash_map.h"
+
+namespace xls {
+
+inline int64_t EstimateHeapBytes(const std::string& s) {
+  // Short strings are stored inline.
+  return s.capacity() > std::string().capacity() ? s.capacity() + 1 : 0;
+}
+
+template <typename T>
+int64_t EstimateHeapBytes(const std::vector<T>& v) {
+  return v.capacity() * sizeof(T);
+}
+
+template <typename T, size_t N>
+int64_t EstimateHeapBytes(const absl::InlinedVector<T, N>& v) {
+  return v.capacity() > N ? v.capacity() * sizeof(T) : 0;
+}
+
+// Swiss tables store one control byte per slot in addition to the slot.
+template <typename K, typename V>
+int64_t EstimateHeapBytes(const absl::flat_hash_map<K, V>& m) {
+  return m.capacity() *
+         (sizeof(typename absl::flat_hash_map<K, V>::value_type) + 1);
+}
+
+template <typename T>
+int64_t EstimateHeapBytes(const absl::flat_hash_set<T>& s) {
+  return s.capacity() * (sizeof(T) + 1);
+}
+
+// Node hash maps store a pointer per slot and allocate each entry separately.
+template <typename K, typename V>
+int64_t EstimateHeapBytes(const absl::node_hash_map<K, V>& m) {
+  return m.capacity() * (sizeof(void*) + 1) +
+         m.size() * sizeof(typename absl::node_hash_map<K, V>::value_type);
+}
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_MEMORY_USAGE_H_
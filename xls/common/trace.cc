@@ -0,0 +1,175 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/trace.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/base/no_destructor.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/stopwatch.h"
+
+namespace xls {
+
+namespace internal {
+std::atomic<bool> tracing_enabled = false;
+}  // namespace internal
+
+namespace {
+
+struct TraceEvent {
+  std::string name;
+  int64_t thread_id;
+  absl::Duration start;
+  absl::Duration duration;
+  std::vector<std::pair<std::string, std::string>> args;
+};
+
+struct TraceBuffer {
+  absl::Mutex mutex;
+  SteadyTime start ABSL_GUARDED_BY(mutex);
+  std::vector<TraceEvent> events ABSL_GUARDED_BY(mutex);
+};
+
+TraceBuffer& GetTraceBuffer() {
+  static absl::NoDestructor<TraceBuffer> buffer;
+  return *buffer;
+}
+
+// Returns a small integer identifying the current thread, assigned in the
+// order threads first record a span.
+int64_t CurrentThreadId() {
+  static std::atomic<int64_t> next_thread_id = 1;
+  thread_local const int64_t thread_id = next_thread_id.fetch_add(1);
+  return thread_id;
+}
+
+std::string JsonString(std::string_view s) {
+  std::string result = "\"";
+  for (char c : s) {
+    switch (c) {
+      case '"':
+        absl::StrAppend(&result, "\\\"");
+        break;
+      case '\\':
+        absl::StrAppend(&result, "\\\\");
+        break;
+      case '\n':
+        absl::StrAppend(&result, "\\n");
+        break;
+      case '\t':
+        absl::StrAppend(&result, "\\t");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          absl::StrAppendFormat(&result, "\\u%04x", static_cast<int>(c));
+        } else {
+          result.push_back(c);
+        }
+    }
+  }
+  result.push_back('"');
+  return result;
+}
+
+}  // namespace
+
+void StartTracing() {
+  TraceBuffer& buffer = GetTraceBuffer();
+  absl::MutexLock lock(&buffer.mutex);
+  buffer.events.clear();
+  buffer.start = SteadyTime::Now();
+  internal::tracing_enabled.store(true, std::memory_order_relaxed);
+}
+
+void StopTracing() {
+  internal::tracing_enabled.store(false, std::memory_order_relaxed);
+}
+
+std::string GetTraceJson() {
+  TraceBuffer& buffer = GetTraceBuffer();
+  absl::MutexLock lock(&buffer.mutex);
+  std::string json = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  bool first = true;
+  for (const TraceEvent& event : buffer.events) {
+    absl::StrAppend(&json, first ? "\n" : ",\n");
+    first = false;
+    // Complete ("X") events with timestamps in microseconds.
+    absl::StrAppendFormat(
+        &json,
+        "{\"name\": %s, \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, "
+        "\"dur\": %.3f, \"args\": {",
+        JsonString(event.name), event.thread_id,
+        absl::ToDoubleMicroseconds(event.start),
+        absl::ToDoubleMicroseconds(event.duration));
+    for (int64_t i = 0; i < event.args.size(); ++i) {
+      absl::StrAppend(&json, i == 0 ? "" : ", ",
+                      JsonString(event.args[i].first), ": ",
+                      event.args[i].second);
+    }
+    absl::StrAppend(&json, "}}");
+  }
+  absl::StrAppend(&json, "\n]}\n");
+  return json;
+}
+
+absl::Status WriteTraceJson(std::string_view path) {
+  return SetFileContents(std::filesystem::path(path), GetTraceJson());
+}
+
+TraceSpan::~TraceSpan() {
+  if (!active_) {
+    return;
+  }
+  SteadyTime end = SteadyTime::Now();
+  TraceBuffer& buffer = GetTraceBuffer();
+  int64_t thread_id = CurrentThreadId();
+  absl::MutexLock lock(&buffer.mutex);
+  // Spans which started before the last StartTracing belong to a previous
+  // trace.
+  if (start_ < buffer.start) {
+    return;
+  }
+  buffer.events.push_back(TraceEvent{.name = std::move(name_),
+                                     .thread_id = thread_id,
+                                     .start = start_ - buffer.start,
+                                     .duration = end - start_,
+                                     .args = std::move(args_)});
+}
+
+void TraceSpan::AddArg(std::string_view key, std::string_view value) {
+  if (active_) {
+    args_.push_back({std::string(key), JsonString(value)});
+  }
+}
+
+void TraceSpan::AddArg(std::string_view key, int64_t value) {
+  if (active_) {
+    args_.push_back({std::string(key), absl::StrCat(value)});
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,97 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_TRACE_H_
+#define XLS_COMMON_TRACE_H_
+
+// A lightweight tracing facility recording where time goes across the
+// toolchain. Phases of interest are wrapped in a TraceSpan:
+//
+//   TraceSpan span("typecheck");
+//   span.AddArg("module", module->name());
+//
+// While tracing is enabled (see StartTracing or the --trace_path flag of
+// InitXls) each span records its start time, duration, thread and arguments;
+// the recorded spans can be written as Chrome trace event JSON which is
+// viewable in Perfetto (ui.perfetto.dev) or chrome://tracing. While tracing is
+// disabled a span costs a relaxed atomic load and nothing is recorded.
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "xls/common/stopwatch.h"
+
+namespace xls {
+
+namespace internal {
+extern std::atomic<bool> tracing_enabled;
+}  // namespace internal
+
+// Returns whether spans are currently recorded.
+inline bool TracingEnabled() {
+  return internal::tracing_enabled.load(std::memory_order_relaxed);
+}
+
+// Discards previously recorded spans and starts recording.
+void StartTracing();
+
+// Stops recording. Recorded spans are kept until the next StartTracing.
+void StopTracing();
+
+// Returns the recorded spans as a Chrome trace event JSON object. Spans still
+// open are not included.
+std::string GetTraceJson();
+
+// Writes GetTraceJson() to `path`.
+absl::Status WriteTraceJson(std::string_view path);
+
+// Records the time between its construction and destruction as a span named
+// `name` on the current thread, if tracing is enabled at construction.
+class TraceSpan {
+ public:
+  explicit TraceSpan(std::string_view name) : active_(TracingEnabled()) {
+    if (active_) {
+      name_ = name;
+      start_ = SteadyTime::Now();
+    }
+  }
+  ~TraceSpan();
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+  // Returns whether the span is recorded. Arguments which are expensive to
+  // compute should only be computed and added if so.
+  bool active() const { return active_; }
+
+  // Adds an argument shown with the span. No-op if the span is not recorded.
+  void AddArg(std::string_view key, std::string_view value);
+  void AddArg(std::string_view key, int64_t value);
+
+ private:
+  bool active_;
+  std::string name_;
+  SteadyTime start_;
+  // Arguments with JSON-encoded values.
+  std::vector<std::pair<std::string, std::string>> args_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_TRACE_H_
@@ -0,0 +1,78 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/trace.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/thread.h"
+
+namespace xls {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+TEST(TraceTest, SpansAreNotRecordedWhenDisabled) {
+  StopTracing();
+  {
+    TraceSpan span("disabled_span");
+    EXPECT_FALSE(span.active());
+    span.AddArg("key", "value");
+  }
+  EXPECT_THAT(GetTraceJson(), Not(HasSubstr("disabled_span")));
+}
+
+TEST(TraceTest, RecordsSpansWithArguments) {
+  StartTracing();
+  {
+    TraceSpan outer("outer");
+    EXPECT_TRUE(outer.active());
+    outer.AddArg("module", "a \"quoted\" name");
+    outer.AddArg("count", 42);
+    TraceSpan inner("inner");
+  }
+  StopTracing();
+  std::string json = GetTraceJson();
+  EXPECT_THAT(json, HasSubstr("\"traceEvents\""));
+  EXPECT_THAT(json, HasSubstr("{\"name\": \"outer\", \"ph\": \"X\""));
+  EXPECT_THAT(json, HasSubstr("{\"name\": \"inner\", \"ph\": \"X\""));
+  EXPECT_THAT(json, HasSubstr("\"module\": \"a \\\"quoted\\\" name\""));
+  EXPECT_THAT(json, HasSubstr("\"count\": 42"));
+
+  // Starting a new trace discards the previous one.
+  StartTracing();
+  StopTracing();
+  EXPECT_THAT(GetTraceJson(), Not(HasSubstr("outer")));
+}
+
+TEST(TraceTest, SpansOnOtherThreadsHaveTheirOwnThreadId) {
+  StartTracing();
+  {
+    TraceSpan span("main_thread");
+  }
+  Thread thread([] { TraceSpan span("other_thread"); });
+  thread.Join();
+  StopTracing();
+  std::string json = GetTraceJson();
+  EXPECT_THAT(json, HasSubstr("\"main_thread\", \"ph\": \"X\", \"pid\": 1, "
+                              "\"tid\": 1,"));
+  EXPECT_THAT(json, HasSubstr("\"other_thread\", \"ph\": \"X\", \"pid\": 1, "
+                              "\"tid\": 2,"));
+}
+
+}  // namespace
+}  // namespace xls
@@ -19,7 +19,7 @@
 
 #include "absl/status/statusor.h"
 
-namespace xls {
+namespace xls::integrator {
 
 absl::StatusOr<std::unique_ptr<AreaEstimator>> GetAreaEstimatorByName(
     std::string_view name) {
@@ -29,4 +29,4 @@ absl::StatusOr<std::unique_ptr<AreaEstimator>> GetAreaEstimatorByName(
   return std::make_unique<AreaEstimator>(delay_estimator);
 }
 
-}  // namespace xls
+}  // namespace xls::integrator
@@ -22,7 +22,7 @@
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/node.h"
 
-namespace xls {
+namespace xls::integrator {
 
 // Abstraction describing an area model for XLS operations.
 class AreaEstimator {
@@ -47,6 +47,6 @@ class AreaEstimator {
 absl::StatusOr<std::unique_ptr<AreaEstimator>> GetAreaEstimatorByName(
     std::string_view name);
 
-}  // namespace xls
+}  // namespace xls::integrator
 
 #endif  // XLS_CONTRIB_INTEGRATOR_AREA_MODEL_AREA_ESTIMATOR_H_
@@ -25,7 +25,7 @@
 #include "xls/ir/package.h"
 #include "xls/ir/source_location.h"
 
-namespace xls {
+namespace xls::integrator {
 namespace {
 
 using status_testing::IsOkAndHolds;
@@ -82,4 +82,4 @@ TEST_F(AreaEstimatorTest, AreaModelIce40Multiply) {
 }
 
 }  // namespace
-}  // namespace xls
+}  // namespace xls::integrator
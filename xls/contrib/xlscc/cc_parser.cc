@@ -24,6 +24,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <system_error>  // NOLINT
 #include <utility>
 #include <vector>
 
@@ -40,6 +41,8 @@
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/synchronization/blocking_counter.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "clang/include/clang/AST/ASTConsumer.h"
 #include "clang/include/clang/AST/Decl.h"
@@ -49,12 +52,16 @@
 #include "clang/include/clang/Basic/FileSystemOptions.h"
 #include "clang/include/clang/Basic/LLVM.h"
 #include "clang/include/clang/Basic/SourceLocation.h"
+#include "clang/include/clang/Basic/Version.h"
 #include "clang/include/clang/Frontend/CompilerInstance.h"
 #include "clang/include/clang/Frontend/FrontendAction.h"
+#include "clang/include/clang/Frontend/FrontendActions.h"
 #include "clang/include/clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/include/clang/Tooling/Tooling.h"
 #include "llvm/include/llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/include/llvm/ADT/StringExtras.h"
 #include "llvm/include/llvm/Support/MemoryBuffer.h"
+#include "llvm/include/llvm/Support/SHA256.h"
 #include "llvm/include/llvm/Support/VirtualFileSystem.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "xls/common/file/filesystem.h"
@@ -586,48 +593,10 @@ absl::StatusOr<const clang::VarDecl*> CCParser::GetXlsccOnReset() const {
   return xlscc_on_reset_;
 }
 
-LibToolThread::LibToolThread(std::string_view source_filename,
-                             std::string_view top_class_name,
-                             absl::Span<std::string_view> command_line_args,
-                             CCParser& parser)
-    : source_filename_(source_filename),
-      top_class_name_(top_class_name),
-      command_line_args_(command_line_args),
-      parser_(parser) {}
-
-void LibToolThread::Start() {
-  thread_.emplace([this] { Run(); });
-}
-
-void LibToolThread::Join() { thread_->Join(); }
-
-void LibToolThread::Run() {
-  std::vector<std::string> argv;
-  argv.emplace_back("binary");
-  argv.emplace_back("/xls_top.cc");
-  for (const auto& view : command_line_args_) {
-    argv.emplace_back(view);
-  }
-  // For xls_top.cc to include the source file
-  argv.emplace_back("-I.");
-  argv.emplace_back("-fsyntax-only");
-  argv.emplace_back("-std=c++17");
-  argv.emplace_back("-nostdinc");
-  argv.emplace_back("-Wno-unused-label");
-  argv.emplace_back("-Wno-constant-logical-operand");
-  argv.emplace_back("-Wno-unused-but-set-variable");
-  argv.emplace_back("-Wno-c++11-narrowing");
-
-  llvm::IntrusiveRefCntPtr<clang::FileManager> libtool_files;
-
-  std::unique_ptr<LibToolFrontendAction> libtool_action(
-      new LibToolFrontendAction(parser_));
+namespace {
 
-  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs(
-      new llvm::vfs::InMemoryFileSystem);
-  mem_fs->addFile("/xls_builtin.h", 0,
-                  llvm::MemoryBuffer::getMemBuffer(
-                      R"(
+// Builtins included by every translation unit
+constexpr std::string_view kXlsBuiltinHeader = R"(
 #ifndef __XLS_BUILTIN_H
 #define __XLS_BUILTIN_H
 template<int N>
@@ -702,7 +671,179 @@ void __xlscc_unroll(long long factor) { }
 void __xlscc_asap() { }
 
 #endif//__XLS_BUILTIN_H
-          )"));
+          )";
+
+// Main file of precompiled headers
+constexpr std::string_view kPrecompiledHeaderPath = "/xls_prefix.h";
+
+// Increment to invalidate cached precompiled headers
+constexpr int64_t kPrecompiledHeaderCacheKeyVersion = 1;
+
+// Returns a file manager for the real file system, overlaid with the builtins
+//  header and the given in-memory files.
+llvm::IntrusiveRefCntPtr<clang::FileManager> CreateFileManager(
+    const std::vector<std::pair<std::string, std::string>>& virtual_files) {
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs(
+      new llvm::vfs::InMemoryFileSystem);
+  mem_fs->addFile("/xls_builtin.h", 0,
+                  llvm::MemoryBuffer::getMemBuffer(kXlsBuiltinHeader));
+  for (const auto& [path, contents] : virtual_files) {
+    mem_fs->addFile(path, 0, llvm::MemoryBuffer::getMemBufferCopy(contents));
+  }
+
+  llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> overlay_fs(
+      new llvm::vfs::OverlayFileSystem(llvm::vfs::getRealFileSystem()));
+
+  overlay_fs->pushOverlay(mem_fs);
+
+  return new clang::FileManager(clang::FileSystemOptions(), overlay_fs);
+}
+
+// Source of the precompiled header's main file
+std::string PrecompiledHeaderSource(std::string_view prefix_header) {
+  return absl::StrFormat(
+      "#include \"/xls_builtin.h\"\n#include \"%s\"\n", prefix_header);
+}
+
+// Runs a Clang invocation to completion, returning false on errors
+bool RunClangInvocation(
+    std::vector<std::string> argv,
+    std::unique_ptr<clang::FrontendAction> action,
+    const std::vector<std::pair<std::string, std::string>>& virtual_files,
+    clang::DiagnosticConsumer& diag_consumer) {
+  llvm::IntrusiveRefCntPtr<clang::FileManager> files =
+      CreateFileManager(virtual_files);
+  clang::tooling::ToolInvocation invocation(std::move(argv), std::move(action),
+                                            files.get());
+  invocation.setDiagnosticConsumer(&diag_consumer);
+  return invocation.run();
+}
+
+}  // namespace
+
+LibToolThread::LibToolThread(std::string_view source_filename,
+                             std::string_view top_class_name,
+                             absl::Span<std::string_view> command_line_args,
+                             CCParser& parser)
+    : source_filename_(source_filename),
+      top_class_name_(top_class_name),
+      command_line_args_(command_line_args),
+      parser_(parser) {}
+
+void LibToolThread::Start() {
+  thread_.emplace([this] { Run(); });
+}
+
+void LibToolThread::Join() { thread_->Join(); }
+
+absl::StatusOr<std::string> LibToolThread::GetPrecompiledHeader(
+    const std::vector<std::string>& flags) {
+  const std::string& prefix_header = parser_.pch_prefix_header_;
+  XLS_ASSIGN_OR_RETURN(std::string prefix_contents,
+                       xls::GetFileContents(prefix_header));
+  const std::string prefix_src = PrecompiledHeaderSource(prefix_header);
+
+  std::string key_data = absl::StrFormat(
+      "version: %d\nclang: %s\nflags: %s\n", kPrecompiledHeaderCacheKeyVersion,
+      clang::getClangFullVersion(), absl::StrJoin(flags, " "));
+  absl::StrAppend(&key_data, kXlsBuiltinHeader, prefix_src, prefix_contents);
+  llvm::SHA256 sha;
+  sha.update(key_data);
+  const std::filesystem::path pch_path =
+      std::filesystem::path(parser_.pch_cache_dir_) /
+      absl::StrCat("xlscc_", llvm::toHex(sha.final(), /*LowerCase=*/true),
+                   ".pch");
+  const std::vector<std::pair<std::string, std::string>> virtual_files = {
+      {std::string(kPrecompiledHeaderPath), prefix_src},
+      {"/xls_pch_check.cc", ""}};
+
+  if (xls::FileExists(pch_path).ok()) {
+    // Loading fails if any header it was built from has changed since.
+    std::vector<std::string> argv = {"binary", "/xls_pch_check.cc"};
+    argv.insert(argv.end(), flags.begin(), flags.end());
+    argv.insert(argv.end(),
+                {"-fsyntax-only", "-include-pch", pch_path.string()});
+    clang::IgnoringDiagConsumer ignore_diags;
+    if (RunClangInvocation(std::move(argv),
+                           std::make_unique<clang::SyntaxOnlyAction>(),
+                           virtual_files, ignore_diags)) {
+      return pch_path.string();
+    }
+    LOG(INFO) << "Rebuilding out of date precompiled header " << pch_path;
+  }
+
+  XLS_RETURN_IF_ERROR(xls::RecursivelyCreateDir(parser_.pch_cache_dir_));
+
+  // Built under a temporary name, so that concurrent runs never load a
+  //  partially written header.
+  const std::string temp_path = absl::StrCat(
+      pch_path.string(), ".tmp.", absl::ToUnixNanos(absl::Now()));
+  std::vector<std::string> argv = {"binary", "-x", "c++-header",
+                                   std::string(kPrecompiledHeaderPath)};
+  argv.insert(argv.end(), flags.begin(), flags.end());
+  argv.insert(argv.end(), {"-o", temp_path});
+  llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> diag_opts =
+      new clang::DiagnosticOptions();
+  clang::TextDiagnosticPrinter diag_print(llvm::errs(), &*diag_opts);
+  const bool generated = RunClangInvocation(
+      std::move(argv), std::make_unique<clang::GeneratePCHAction>(),
+      virtual_files, diag_print);
+
+  std::error_code ec;
+  if (!generated) {
+    std::filesystem::remove(temp_path, ec);
+    return absl::InternalError(
+        absl::StrFormat("Failed to precompile header %s", prefix_header));
+  }
+  std::filesystem::rename(temp_path, pch_path, ec);
+  if (ec) {
+    return absl::InternalError(
+        absl::StrFormat("Failed to write precompiled header %s: %s",
+                        pch_path.string(), ec.message()));
+  }
+  return pch_path.string();
+}
+
+void LibToolThread::Run() {
+  std::vector<std::string> flags;
+  for (const auto& view : command_line_args_) {
+    flags.emplace_back(view);
+  }
+  // For xls_top.cc to include the source file
+  flags.emplace_back("-I.");
+  flags.emplace_back("-std=c++17");
+  flags.emplace_back("-nostdinc");
+  flags.emplace_back("-Wno-unused-label");
+  flags.emplace_back("-Wno-constant-logical-operand");
+  flags.emplace_back("-Wno-unused-but-set-variable");
+  flags.emplace_back("-Wno-c++11-narrowing");
+
+  std::vector<std::string> argv;
+  argv.emplace_back("binary");
+  argv.emplace_back("/xls_top.cc");
+  argv.insert(argv.end(), flags.begin(), flags.end());
+  argv.emplace_back("-fsyntax-only");
+
+  std::vector<std::pair<std::string, std::string>> virtual_files;
+
+  if (!parser_.pch_prefix_header_.empty()) {
+    absl::StatusOr<std::string> pch_path = GetPrecompiledHeader(flags);
+    if (pch_path.ok()) {
+      argv.emplace_back("-include-pch");
+      argv.emplace_back(*pch_path);
+      // The precompiled header records its main file, which must still exist
+      virtual_files.emplace_back(
+          kPrecompiledHeaderPath,
+          PrecompiledHeaderSource(parser_.pch_prefix_header_));
+    } else {
+      LOG(WARNING) << "Parsing without a precompiled header: "
+                   << pch_path.status();
+    }
+  }
+
+  std::unique_ptr<LibToolFrontendAction> libtool_action(
+      new LibToolFrontendAction(parser_));
+
 
   // Inject an instantiation to make Clang parse the constructor bodies
   std::string top_class_inst_injection = top_class_name_.empty()
@@ -731,15 +872,10 @@ void __xlscc_top_class_instance_ref2() {
           )",
                       source_filename_, top_class_inst_injection);
 
-  mem_fs->addFile("/xls_top.cc", 0, llvm::MemoryBuffer::getMemBuffer(top_src));
-
-  llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> overlay_fs(
-      new llvm::vfs::OverlayFileSystem(llvm::vfs::getRealFileSystem()));
-
-  overlay_fs->pushOverlay(mem_fs);
+  virtual_files.emplace_back("/xls_top.cc", top_src);
 
-  libtool_files =
-      new clang::FileManager(clang::FileSystemOptions(), overlay_fs);
+  llvm::IntrusiveRefCntPtr<clang::FileManager> libtool_files =
+      CreateFileManager(virtual_files);
 
   std::unique_ptr<clang::tooling::ToolInvocation> libtool_inv(
       new clang::tooling::ToolInvocation(argv, std::move(libtool_action),
@@ -775,6 +911,14 @@ absl::Status CCParser::SelectTop(std::string_view top_function_name,
   return absl::OkStatus();
 }
 
+void CCParser::UsePrecompiledHeader(std::string_view prefix_header,
+                                    std::string_view cache_dir) {
+  // ScanFile may only be called once, so this can't affect a prior parse.
+  CHECK_EQ(libtool_thread_.get(), nullptr);
+  pch_prefix_header_ = prefix_header;
+  pch_cache_dir_ = cache_dir;
+}
+
 absl::StatusOr<const clang::FunctionDecl*> CCParser::GetTopFunction() const {
   if (top_function_ == nullptr) {
     return absl::NotFoundError("No top function found");
@@ -20,6 +20,7 @@
 #include <string>
 #include <string_view>
 #include <tuple>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -82,6 +83,10 @@ class LibToolThread {
 
  private:
   void Run();
+  // Returns the path of an up to date precompiled header for the parser's
+  //  prefix header, building it if it isn't in the cache.
+  absl::StatusOr<std::string> GetPrecompiledHeader(
+      const std::vector<std::string>& flags);
 
   std::optional<xls::Thread> thread_;
   std::string_view source_filename_;
@@ -95,6 +100,7 @@ class CCParser {
   friend class LibToolVisitor;
   friend class DiagnosticInterceptor;
   friend class LibToolFrontendAction;
+  friend class LibToolThread;
 
  public:
   // Deletes the AST
@@ -108,6 +114,17 @@ class CCParser {
   absl::Status SelectTop(std::string_view top_function_name,
                          std::string_view top_class_name = "");
 
+  // Parses prefix_header once into a Clang precompiled header, cached in
+  //  cache_dir, which is loaded instead of parsing the header again.
+  // The cache is keyed by the contents of prefix_header, the command line
+  //  arguments, and the Clang version. Clang also checks that none of the
+  //  headers it includes have changed, and the header is rebuilt if they
+  //  have. prefix_header must have include guards, and should be included
+  //  by the source before any other code.
+  // Must be called before ScanFile.
+  void UsePrecompiledHeader(std::string_view prefix_header,
+                            std::string_view cache_dir);
+
   // This function uses Clang to parse a source file and then walks its
   //  AST to discover global constructs. It will also scan the file
   //  and includes, recursively, for #pragma statements.
@@ -173,6 +190,9 @@ class CCParser {
   std::string_view top_class_name_ = "";
   const clang::VarDecl* xlscc_on_reset_ = nullptr;
 
+  std::string pch_prefix_header_;
+  std::string pch_cache_dir_;
+
   // For source location
   absl::flat_hash_map<std::string, int> file_numbers_;
   int next_file_number_ = 1;
@@ -16,6 +16,7 @@
 // front-end. It accepts as input a C/C++ file and produces as textual output
 // the equivalent XLS intermediate representation (IR).
 
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>  // NOLINT
 #include <fstream>
@@ -34,17 +35,22 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
+#include "absl/time/time.h"
 #include "clang/include/clang/AST/Decl.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/log_flags.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/stopwatch.h"
 #include "xls/contrib/xlscc/flags.h"
 #include "xls/contrib/xlscc/hls_block.pb.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
+#include "xls/contrib/xlscc/translation_profile.pb.h"
 #include "xls/contrib/xlscc/translator.h"
 #include "xls/ir/channel.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/package.h"
 
 const char kUsage[] = R"(
 Generates XLS IR from a given C++ file, or generates Verilog in the special
@@ -83,11 +89,27 @@ ABSL_FLAG(std::vector<std::string>, defines, std::vector<std::string>(),
 ABSL_FLAG(std::vector<std::string>, include_dirs, std::vector<std::string>(),
           "Comma separated list of include directories to pass to clang");
 
+ABSL_FLAG(std::string, precompiled_header, "",
+          "Header to precompile and reuse across runs, for example one "
+          "including the heavy template headers used by the sources. It "
+          "should be included by the source before any other code.");
+
+ABSL_FLAG(std::string, precompiled_header_cache_dir, "",
+          "Directory in which precompiled headers are cached. Required with "
+          "--precompiled_header.");
+
 ABSL_FLAG(std::string, meta_out, "",
           "Path at which to output metadata protobuf");
 
 ABSL_FLAG(bool, meta_out_text, false, "Output metadata as textproto?");
 
+ABSL_FLAG(std::string, profile_out, "",
+          "Path at which to output a TranslationProfile protobuf with the "
+          "time spent in each phase and per-function translation counters");
+
+ABSL_FLAG(bool, profile_out_text, false,
+          "Output translation profile as textproto?");
+
 ABSL_FLAG(std::string, verilog_line_map_out, "",
           "Path at which to output Verilog line map protobuf");
 
@@ -123,6 +145,11 @@ ABSL_FLAG(int, max_unroll_iters, 1000,
 ABSL_FLAG(int, warn_unroll_iters, 100,
           "Maximum number of iterations to allow loops to be unrolled");
 
+ABSL_FLAG(int64_t, max_unroll_nodes, -1,
+          "Maximum number of IR nodes a loop may generate when unrolled, "
+          "or -1 for no limit. Loops over the limit are errors; they should "
+          "be pipelined instead.");
+
 ABSL_FLAG(int, z3_rlimit, 100000L,
           "rlimit to set for z3 solver (eg for loop unrolling)");
 
@@ -146,6 +173,9 @@ ABSL_FLAG(bool, debug_ir_trace_loop_control, false,
 ABSL_FLAG(bool, debug_print_fsm_states, false,
           "Print FSM states to XLS_LOG (try --alsologtostderr).");
 
+ABSL_FLAG(bool, print_translation_profile, false,
+          "Print the time spent translating each function to stderr.");
+
 namespace xlscc {
 
 static absl::Status Run(std::string_view cpp_path) {
@@ -194,6 +224,7 @@ static absl::Status Run(std::string_view cpp_path) {
       absl::GetFlag(FLAGS_max_unroll_iters),
       absl::GetFlag(FLAGS_warn_unroll_iters), absl::GetFlag(FLAGS_z3_rlimit),
       io_op_token_ordering);
+  translator.SetMaxUnrollNodes(absl::GetFlag(FLAGS_max_unroll_nodes));
 
   const std::string block_pb_name = absl::GetFlag(FLAGS_block_pb);
 
@@ -222,6 +253,18 @@ static absl::Status Run(std::string_view cpp_path) {
         translator.SelectTop(top_function_name, block_from_class_name));
   }
 
+  const std::string precompiled_header =
+      absl::GetFlag(FLAGS_precompiled_header);
+  if (!precompiled_header.empty()) {
+    const std::string cache_dir =
+        absl::GetFlag(FLAGS_precompiled_header_cache_dir);
+    if (cache_dir.empty()) {
+      return absl::InvalidArgumentError(
+          "--precompiled_header requires --precompiled_header_cache_dir");
+    }
+    translator.UsePrecompiledHeader(precompiled_header, cache_dir);
+  }
+
   std::vector<std::string> clang_argvs;
 
   const std::string clang_args_file = absl::GetFlag(FLAGS_clang_args_file);
@@ -249,11 +292,23 @@ static absl::Status Run(std::string_view cpp_path) {
     clang_argv.push_back(i);
   }
 
+  // Phases are timed back to back, each from the end of the previous one.
+  std::vector<xlscc_metadata::PhaseProfile> phases;
+  xls::Stopwatch phase_stopwatch;
+  auto end_phase = [&](std::string_view name) {
+    xlscc_metadata::PhaseProfile& phase = phases.emplace_back();
+    phase.set_name(std::string(name));
+    phase.set_duration_us(
+        absl::ToInt64Microseconds(phase_stopwatch.GetElapsedTime()));
+    phase_stopwatch.Reset();
+  };
+
   std::cerr << "Parsing file '" << cpp_path << "' with clang..." << '\n';
   XLS_RETURN_IF_ERROR(translator.ScanFile(
       cpp_path, clang_argv.empty()
                     ? absl::Span<std::string_view>()
                     : absl::MakeSpan(&clang_argv[0], clang_argv.size())));
+  end_phase("clang_parse");
 
   XLS_ASSIGN_OR_RETURN(std::string top_name, translator.GetEntryFunctionName());
 
@@ -288,10 +343,12 @@ static absl::Status Run(std::string_view cpp_path) {
     XLS_RETURN_IF_ERROR(
         translator.GenerateIR_Top_Function(&package, top_channel_injections)
             .status());
+    end_phase("translation");
     // TODO(seanhaskell): Simplify IR
     XLS_RETURN_IF_ERROR(package.SetTopByName(top_name));
     translator.AddSourceInfoToPackage(package);
     XLS_RETURN_IF_ERROR(write_to_output(absl::StrCat(package.DumpIr(), "\n")));
+    end_phase("ir_output");
   } else {
     xls::Proc* proc = nullptr;
 
@@ -313,10 +370,17 @@ static absl::Status Run(std::string_view cpp_path) {
       }
     }
 
+    end_phase("translation");
+
     XLS_RETURN_IF_ERROR(package.SetTop(proc));
     std::cerr << "Saving Package IR..." << '\n';
     translator.AddSourceInfoToPackage(package);
     XLS_RETURN_IF_ERROR(write_to_output(absl::StrCat(package.DumpIr(), "\n")));
+    end_phase("ir_output");
+  }
+
+  if (absl::GetFlag(FLAGS_print_translation_profile)) {
+    std::cerr << translator.FunctionTranslationProfileReport();
   }
 
   const std::string metadata_out_path = absl::GetFlag(FLAGS_meta_out);
@@ -336,6 +400,34 @@ static absl::Status Run(std::string_view cpp_path) {
         return absl::UnknownError("Error writing metadata proto");
       }
     }
+    end_phase("metadata");
+  }
+
+  const std::string profile_out_path = absl::GetFlag(FLAGS_profile_out);
+  if (!profile_out_path.empty()) {
+    xlscc_metadata::TranslationProfile profile =
+        translator.GenerateTranslationProfile();
+    for (xlscc_metadata::PhaseProfile& phase : phases) {
+      *profile.add_phases() = std::move(phase);
+    }
+    int64_t ir_node_count = 0;
+    for (xls::FunctionBase* function_base : package.GetFunctionBases()) {
+      ir_node_count += function_base->node_count();
+    }
+    profile.set_ir_node_count(ir_node_count);
+
+    if (absl::GetFlag(FLAGS_profile_out_text)) {
+      XLS_RETURN_IF_ERROR(xls::SetTextProtoFile(profile_out_path, profile));
+    } else {
+      std::ofstream ostr(profile_out_path);
+      if (!ostr.good()) {
+        return absl::NotFoundError(absl::StrFormat(
+            "Couldn't open profile output path: %s", profile_out_path));
+      }
+      if (!profile.SerializeToOstream(&ostr)) {
+        return absl::UnknownError("Error writing profile proto");
+      }
+    }
   }
 
   return absl::OkStatus();
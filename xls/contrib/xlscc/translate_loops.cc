@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "absl/base/casts.h"
+#include "absl/cleanup/cleanup.h"
 #include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -29,6 +30,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "clang/include/clang/AST/Decl.h"
 #include "clang/include/clang/AST/Expr.h"
@@ -168,6 +170,17 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
   Z3_solver solver =
       xls::solvers::z3::CreateSolver(z3_translator_parent->ctx(), 1);
 
+  // Only the outermost unrolled loop accumulates time, so that nested loops
+  // are not counted twice.
+  const absl::Time start_time = absl::Now();
+  ++unrolled_loop_depth_;
+  absl::Cleanup profile_cleanup = [&]() {
+    --unrolled_loop_depth_;
+    if (unrolled_loop_depth_ == 0) {
+      unrolled_loop_time_ += absl::Now() - start_time;
+    }
+  };
+
   class SolverDeref {
    public:
     SolverDeref(Z3_context ctx, Z3_solver solver)
@@ -196,6 +209,17 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
 
   absl::Duration slowest_iter = absl::ZeroDuration();
 
+  // Values from before the loop are left alone when folding, so that only
+  // variables the loop assigns are replaced.
+  absl::flat_hash_set<xls::Node*> skip_fold_nodes;
+  for (const auto& [name, cval] : context().variables) {
+    if (cval.rvalue().valid()) {
+      skip_fold_nodes.insert(cval.rvalue().node());
+    }
+  }
+
+  const int64_t start_node_count = context().fb->function()->node_count();
+
   for (int64_t nIters = 0;; ++nIters) {
     const bool first_iter = nIters == 0;
     const bool always_this_iter = always_first_iter && first_iter;
@@ -213,6 +237,15 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
       LOG(WARNING) << ErrorMessage(
           loc, "Loop unrolling has reached %i iterations", warn_unroll_iters_);
     }
+    const int64_t loop_node_count =
+        context().fb->function()->node_count() - start_node_count;
+    if (max_unroll_nodes_ >= 0 && loop_node_count > max_unroll_nodes_) {
+      return absl::ResourceExhaustedError(ErrorMessage(
+          loc,
+          "Loop unrolling generated %i nodes in %i iterations, over the limit "
+          "of %i nodes. Consider pipelining the loop instead.",
+          loop_node_count, nIters, max_unroll_nodes_));
+    }
 
     // Generate condition.
     //
@@ -240,11 +273,18 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
       }
     }
 
+    ++unrolled_loop_iterations_;
+    if (profiled_function_ != nullptr) {
+      ++function_translation_profiles_[profiled_function_]
+            .unrolled_loop_iterations;
+    }
+
     // Generate body
     {
       PushContextGuard for_body_guard(*this, loc);
       context().propagate_break_up = true;
       context().propagate_continue_up = false;
+      context().in_unrolled_for_body = true;
 
       XLS_RETURN_IF_ERROR(GenerateIR_Compound(body, ctx));
     }
@@ -254,6 +294,10 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
     if (inc != nullptr) {
       XLS_RETURN_IF_ERROR(GenerateIR_Stmt(inc, ctx));
     }
+
+    // Keep loop-carried values constant where possible so that the next
+    // iteration's condition can be evaluated without the solver.
+    XLS_RETURN_IF_ERROR(FoldConstantVariables(skip_fold_nodes, loc));
     // Print slow unrolling warning
     const absl::Duration elapsed_time = stopwatch.GetElapsedTime();
     if (elapsed_time > absl::Seconds(0.1) && elapsed_time > slowest_iter) {
@@ -266,6 +310,36 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
   return absl::OkStatus();
 }
 
+absl::Status Translator::FoldConstantVariables(
+    absl::flat_hash_set<xls::Node*>& skip_nodes, const xls::SourceInfo& loc) {
+  if (context().sf == nullptr) {
+    return absl::OkStatus();
+  }
+  // Deterministic order so that literals are created in the same order on
+  // every run.
+  for (const clang::NamedDecl* name :
+       context().sf->DeterministicKeyNames(context().variables)) {
+    CValue& cval = context().variables.at(name);
+    // Pointers and references are tracked by their lvalues
+    if (!cval.rvalue().valid() || cval.lvalue() != nullptr) {
+      continue;
+    }
+    xls::Node* node = cval.rvalue().node();
+    if (node->Is<xls::Literal>() || skip_nodes.contains(node)) {
+      continue;
+    }
+    absl::StatusOr<xls::Value> const_value =
+        EvaluateNode(node, loc, /*do_check=*/false);
+    if (!const_value.ok()) {
+      skip_nodes.insert(node);
+      continue;
+    }
+    cval = CValue(context().fb->Literal(const_value.value(), loc),
+                  cval.type());
+  }
+  return absl::OkStatus();
+}
+
 bool Translator::LValueContainsOnlyChannels(
     const std::shared_ptr<LValue>& lvalue) {
   if (lvalue == nullptr) {
@@ -46,6 +46,8 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "clang/include/clang/AST/APValue.h"
 #include "clang/include/clang/AST/ASTContext.h"
@@ -1083,6 +1085,32 @@ absl::Status Translator::GenerateIR_Function_Body(
   XLS_ASSIGN_OR_RETURN(const clang::Stmt* body, GetFunctionBody(funcdecl));
   xls::SourceInfo body_loc = GetLoc(*funcdecl);
 
+  // Callees are translated recursively from within this body, so their time
+  //  is accumulated separately and excluded from this function's self time.
+  const absl::Time start_time = absl::Now();
+  const absl::Duration enclosing_callee_time = callee_translation_time_;
+  callee_translation_time_ = absl::ZeroDuration();
+  const clang::NamedDecl* enclosing_profiled_function = profiled_function_;
+  profiled_function_ = funcdecl;
+  auto profile_guard = MakeLambdaGuard([&]() {
+    const absl::Duration elapsed = absl::Now() - start_time;
+    profiled_function_ = enclosing_profiled_function;
+    FunctionTranslationProfile& profile =
+        function_translation_profiles_[funcdecl];
+    if (sf.xls_func != nullptr) {
+      profile.ir_node_count = sf.xls_func->node_count();
+    }
+    if (profile.name.empty()) {
+      // Includes template arguments to tell instantiations apart.
+      llvm::raw_string_ostream name_stream(profile.name);
+      funcdecl->getNameForDiagnostics(
+          name_stream, funcdecl->getASTContext().getPrintingPolicy(),
+          /*Qualified=*/true);
+    }
+    profile.self_time += elapsed - callee_translation_time_;
+    callee_translation_time_ = enclosing_callee_time + elapsed;
+  });
+
   PushContextGuard context_guard(*this, *header.translation_context, body_loc);
 
   // Extra context layer to generate selects
@@ -3068,6 +3096,77 @@ absl::StatusOr<bool> Translator::ApplyArrayAssignHack(
   return false;
 }
 
+std::vector<Translator::FunctionTranslationProfile>
+Translator::GetFunctionTranslationProfiles() const {
+  std::vector<FunctionTranslationProfile> profiles;
+  profiles.reserve(function_translation_profiles_.size());
+  for (const auto& [_, profile] : function_translation_profiles_) {
+    profiles.push_back(profile);
+  }
+  std::sort(profiles.begin(), profiles.end(),
+            [](const FunctionTranslationProfile& a,
+               const FunctionTranslationProfile& b) {
+              if (a.self_time != b.self_time) {
+                return a.self_time > b.self_time;
+              }
+              return a.name < b.name;
+            });
+  return profiles;
+}
+
+std::string Translator::FunctionTranslationProfileReport(
+    int64_t max_entries) const {
+  std::vector<FunctionTranslationProfile> profiles =
+      GetFunctionTranslationProfiles();
+  absl::Duration total = absl::ZeroDuration();
+  for (const FunctionTranslationProfile& profile : profiles) {
+    total += profile.self_time;
+  }
+  std::string report = absl::StrFormat(
+      "Translated %d functions in %s\n%12s %7s %8s  %s\n", profiles.size(),
+      absl::FormatDuration(total), "self ms", "%", "reuses", "function");
+  int64_t shown = std::min<int64_t>(max_entries, profiles.size());
+  for (int64_t i = 0; i < shown; ++i) {
+    const FunctionTranslationProfile& profile = profiles[i];
+    absl::StrAppendFormat(
+        &report, "%12.2f %6.2f%% %8d  %s\n",
+        absl::ToDoubleMilliseconds(profile.self_time),
+        total == absl::ZeroDuration()
+            ? 0.0
+            : 100.0 * absl::FDivDuration(profile.self_time, total),
+        profile.reuse_count, profile.name);
+  }
+  if (shown < profiles.size()) {
+    absl::StrAppendFormat(&report, "... %d more functions\n",
+                          profiles.size() - shown);
+  }
+  return report;
+}
+
+xlscc_metadata::TranslationProfile Translator::GenerateTranslationProfile()
+    const {
+  xlscc_metadata::TranslationProfile proto;
+  if (ir_optimization_time_ > absl::ZeroDuration()) {
+    xlscc_metadata::PhaseProfile* phase = proto.add_phases();
+    phase->set_name("ir_optimization");
+    phase->set_duration_us(absl::ToInt64Microseconds(ir_optimization_time_));
+  }
+  for (const FunctionTranslationProfile& profile :
+       GetFunctionTranslationProfiles()) {
+    xlscc_metadata::FunctionProfile* function = proto.add_functions();
+    function->set_name(profile.name);
+    function->set_self_time_us(absl::ToInt64Microseconds(profile.self_time));
+    function->set_reuse_count(profile.reuse_count);
+    function->set_ir_node_count(profile.ir_node_count);
+    function->set_unrolled_loop_iterations(profile.unrolled_loop_iterations);
+  }
+  proto.set_functions_translated(proto.functions_size());
+  proto.set_unrolled_loop_iterations(unrolled_loop_iterations_);
+  proto.set_unrolled_loop_time_us(
+      absl::ToInt64Microseconds(unrolled_loop_time_));
+  return proto;
+}
+
 absl::StatusOr<const clang::Stmt*> Translator::GetFunctionBody(
     const clang::FunctionDecl*& funcdecl) {
   const bool trivial = funcdecl->hasTrivialBody() || funcdecl->isTrivial();
@@ -3158,6 +3257,7 @@ absl::StatusOr<CValue> Translator::GenerateIR_Call(
   if (found != inst_functions_.end()) {
     XLSCC_CHECK(!functions_in_progress_.contains(signature), loc);
     func = found->second.get();
+    ++function_translation_profiles_[signature].reuse_count;
   } else if (functions_in_progress_.contains(funcdecl)) {
     XLSCC_CHECK(!inst_functions_.contains(signature), loc);
     func = functions_in_progress_.at(signature)->generated_function.get();
@@ -5082,6 +5182,22 @@ absl::Status Translator::GenerateIR_Stmt(const clang::Stmt* stmt,
       return absl::UnimplementedError(
           ErrorMessage(loc, "Unimplemented C++17 if initializers"));
     }
+    // In unrolled loops, conditions often depend only on the iteration, so
+    // skip generating branches which are known not to be taken.
+    if (context().in_unrolled_for_body) {
+      absl::StatusOr<xls::Value> const_cond =
+          EvaluateBVal(cond.rvalue(), loc, /*do_check=*/false);
+      if (const_cond.ok()) {
+        const bool taken = const_cond->bits().IsOne();
+        const clang::Stmt* taken_stmt =
+            taken ? ifst->getThen() : ifst->getElse();
+        if (taken_stmt != nullptr) {
+          PushContextGuard context_guard(*this, loc);
+          XLS_RETURN_IF_ERROR(GenerateIR_Compound(taken_stmt, ctx));
+        }
+        return absl::OkStatus();
+      }
+    }
     if (ifst->getThen() != nullptr) {
       PushContextGuard context_guard(*this, cond.rvalue(), loc);
       XLS_RETURN_IF_ERROR(GenerateIR_Compound(ifst->getThen(), ctx));
@@ -5391,6 +5507,13 @@ absl::StatusOr<bool> Translator::BitMustBe(bool assert_value, xls::BValue& bval,
 
   XLS_RETURN_IF_ERROR(ShortCircuitBVal(bval, loc));
 
+  // Constant conditions, such as those of loops with constant bounds, don't
+  // need the solver.
+  if (bval.node()->Is<xls::Literal>()) {
+    return bval.node()->As<xls::Literal>()->value().bits().IsOne() ==
+           assert_value;
+  }
+
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<xls::solvers::z3::IrTranslator> z3_translator,
       xls::solvers::z3::IrTranslator::CreateAndTranslate(
@@ -5846,6 +5969,12 @@ absl::Status Translator::SelectTop(std::string_view top_function_name,
   return parser_->SelectTop(top_function_name, top_class_name);
 }
 
+void Translator::UsePrecompiledHeader(std::string_view prefix_header,
+                                      std::string_view cache_dir) {
+  CHECK_NE(parser_.get(), nullptr);
+  parser_->UsePrecompiledHeader(prefix_header, cache_dir);
+}
+
 absl::StatusOr<GeneratedFunction*> Translator::GenerateIR_Top_Function(
     xls::Package* package,
     const absl::flat_hash_map<const clang::NamedDecl*, ChannelBundle>&
@@ -5918,6 +6047,9 @@ absl::StatusOr<bool> Translator::ExprIsChannel(const clang::Expr* object,
 }
 
 absl::Status Translator::InlineAllInvokes(xls::Package* package) {
+  const absl::Time start_time = absl::Now();
+  auto time_guard = MakeLambdaGuard(
+      [&]() { ir_optimization_time_ += absl::Now() - start_time; });
   std::unique_ptr<xls::OptimizationCompoundPass> pipeline =
       xls::CreateOptimizationPassPipeline();
   xls::OptimizationPassOptions options;
@@ -37,6 +37,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
 #include "clang/include/clang/AST/ASTContext.h"
 #include "clang/include/clang/AST/Decl.h"
 #include "clang/include/clang/AST/Expr.h"
@@ -48,6 +49,7 @@
 #include "xls/contrib/xlscc/cc_parser.h"
 #include "xls/contrib/xlscc/hls_block.pb.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
+#include "xls/contrib/xlscc/translation_profile.pb.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/caret.h"
 #include "xls/ir/channel.h"
@@ -1038,6 +1040,10 @@ struct TranslationContext {
   // Assume for loops without pragmas are unrolled
   bool for_loops_default_unroll = false;
 
+  // Flag set in unrolled for body. Branches with constant conditions are
+  // only generated when taken.
+  bool in_unrolled_for_body = false;
+
   // Flag set in pipelined for body
   // TODO(seanhaskell): Remove once all features are supported
   bool in_pipelined_for_body = false;
@@ -1134,6 +1140,10 @@ class Translator {
   absl::Status SelectTop(std::string_view top_function_name,
                          std::string_view top_class_name = "");
 
+  // See CCParser::UsePrecompiledHeader()
+  void UsePrecompiledHeader(std::string_view prefix_header,
+                            std::string_view cache_dir);
+
   // Generates IR as an XLS function, that is, a pure function without
   //  IO / state / side effects.
   // If top_function is 0 or "" then top must be specified via pragma
@@ -1175,6 +1185,12 @@ class Translator {
 
   inline void SetIOTestMode() { io_test_mode_ = true; }
 
+  // Limits the number of IR nodes a single unrolled loop may generate.
+  // Negative values mean no limit.
+  inline void SetMaxUnrollNodes(int64_t max_unroll_nodes) {
+    max_unroll_nodes_ = max_unroll_nodes;
+  }
+
   absl::StatusOr<const clang::FunctionDecl*> GetTopFunction() const {
     CHECK_NE(parser_, nullptr);
     return parser_->GetTopFunction();
@@ -1185,6 +1201,34 @@ class Translator {
     return inst_functions_.at(decl).get();
   }
 
+  // Profile of the translation of one function. Each function (or template
+  //  instantiation) is translated once and reused by all of its calls.
+  struct FunctionTranslationProfile {
+    std::string name;
+    // Time spent translating the function body, excluding the time spent
+    //  translating the bodies of its callees.
+    absl::Duration self_time;
+    // Number of calls which reused the already translated function.
+    int64_t reuse_count = 0;
+    // Number of nodes in the generated XLS function.
+    int64_t ir_node_count = 0;
+    // Iterations of loops unrolled directly in the function body.
+    int64_t unrolled_loop_iterations = 0;
+  };
+
+  // Returns the profile of each translated function, by decreasing self time.
+  std::vector<FunctionTranslationProfile> GetFunctionTranslationProfiles()
+      const;
+
+  // Returns a human-readable table of the `max_entries` functions which took
+  //  the longest to translate.
+  std::string FunctionTranslationProfileReport(int64_t max_entries = 50) const;
+
+  // Returns the function profiles and translation counters as a proto.
+  //  Phases outside of the translator, such as parsing, are left to the
+  //  caller to add.
+  xlscc_metadata::TranslationProfile GenerateTranslationProfile() const;
+
  private:
   friend class CInstantiableTypeAlias;
   friend class CStructType;
@@ -1385,6 +1429,9 @@ class Translator {
   const int64_t max_unroll_iters_;
   // The maximum number of iterations before loop unrolling prints a warning.
   const int64_t warn_unroll_iters_;
+  // The maximum number of IR nodes an unrolled loop may generate before
+  // unrolling fails, or -1 for no limit.
+  int64_t max_unroll_nodes_ = -1;
   // The rlimit to set for z3 when unrolling loops
   const int64_t z3_rlimit_;
 
@@ -1443,6 +1490,21 @@ class Translator {
       functions_in_progress_;
   absl::flat_hash_set<const clang::NamedDecl*> functions_in_call_stack_;
 
+  absl::flat_hash_map<const clang::NamedDecl*, FunctionTranslationProfile>
+      function_translation_profiles_;
+  // Time spent translating callee bodies during the function body currently
+  //  being translated, subtracted from its self time.
+  absl::Duration callee_translation_time_;
+  // Function whose body is currently being translated, for attributing
+  //  unrolled loop iterations.
+  const clang::NamedDecl* profiled_function_ = nullptr;
+  int64_t unrolled_loop_iterations_ = 0;
+  // Nesting depth of unrolled loops, so that only the time in outermost
+  //  loops is accumulated.
+  int64_t unrolled_loop_depth_ = 0;
+  absl::Duration unrolled_loop_time_;
+  absl::Duration ir_optimization_time_;
+
   void print_types() {
     std::cerr << "Types {" << std::endl;
     for (const auto& var : inst_types_) {
@@ -1843,6 +1905,12 @@ class Translator {
                                        const clang::Stmt* body,
                                        clang::ASTContext& ctx,
                                        const xls::SourceInfo& loc);
+  // Replaces the values of variables which can be evaluated as constants with
+  // literals, so that values carried between unrolled iterations don't grow
+  // into long chains of operations. Nodes in skip_nodes aren't tried, and
+  // nodes which couldn't be evaluated are added to it.
+  absl::Status FoldConstantVariables(
+      absl::flat_hash_set<xls::Node*>& skip_nodes, const xls::SourceInfo& loc);
   // init, cond, and inc can be nullptr
   absl::Status GenerateIR_PipelinedLoop(
       bool always_first_iter, const clang::Stmt* init,
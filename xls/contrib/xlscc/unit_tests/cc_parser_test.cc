@@ -14,13 +14,18 @@
 
 #include "xls/contrib/xlscc/cc_parser.h"
 
+#include <filesystem>  // NOLINT
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_format.h"
 #include "clang/include/clang/Basic/SourceLocation.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
 #include "xls/contrib/xlscc/unit_tests/unit_test.h"
@@ -786,4 +791,49 @@ TEST_F(CCParserTest, DesignUnknown) {
   EXPECT_THAT(top, xls::status_testing::StatusIs(absl::StatusCode::kNotFound));
 }
 
+TEST_F(CCParserTest, PrecompiledHeader) {
+  XLS_ASSERT_OK_AND_ASSIGN(xls::TempDirectory cache_dir,
+                           xls::TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(xls::TempFile header,
+                           xls::TempFile::CreateWithContent(R"(
+    #ifndef PCH_TEST_H
+    #define PCH_TEST_H
+    template<int N>
+    int add_n(int a) {
+      return a + N;
+    }
+    #endif
+  )",
+                                                            ".h"));
+
+  const std::string cpp_src = absl::StrFormat(R"(
+    #include "%s"
+    #pragma hls_top
+    int foo(int a) {
+      return add_n<3>(a);
+    }
+  )",
+                                              header.path().string());
+
+  auto cached_headers = [&]() {
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry :
+         std::filesystem::directory_iterator(cache_dir.path())) {
+      paths.push_back(entry.path());
+    }
+    return paths;
+  };
+
+  // The first parse builds the precompiled header and the second reuses it.
+  for (int i = 0; i < 2; ++i) {
+    xlscc::CCParser parser;
+    parser.UsePrecompiledHeader(header.path().string(),
+                                cache_dir.path().string());
+    XLS_ASSERT_OK(ScanTempFileWithContent(cpp_src, {}, &parser));
+    XLS_ASSERT_OK_AND_ASSIGN(const auto* top_ptr, parser.GetTopFunction());
+    EXPECT_NE(top_ptr, nullptr);
+    EXPECT_EQ(cached_headers().size(), 1);
+  }
+}
+
 }  // namespace
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <cstdio>
 #include <list>
 #include <memory>
@@ -24,6 +25,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
@@ -35,12 +37,14 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/contrib/xlscc/hls_block.pb.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
+#include "xls/contrib/xlscc/translation_profile.pb.h"
 #include "xls/contrib/xlscc/translator.h"
 #include "xls/contrib/xlscc/unit_tests/unit_test.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
 #include "xls/ir/value.h"
 
 using xls::status_testing::IsOkAndHolds;
@@ -2144,6 +2148,51 @@ TEST_F(TranslatorLogicTest, MaxUnrollItersError) {
                                     testing::HasSubstr("broke at maximum")));
 }
 
+TEST_F(TranslatorLogicTest, MaxUnrollNodesError) {
+  std::string_view content = R"(
+    #pragma hls_top
+    int foo(int b) {
+      int ret = 0;
+
+      #pragma hls_unroll yes
+      for(int i=0;i<50;++i) {
+        ret += b * i;
+      }
+      return ret;
+    })";
+  XLS_ASSERT_OK(ScanFile(content));
+  translator_->SetMaxUnrollNodes(20);
+  package_ = std::make_unique<xls::Package>("my_package");
+  absl::flat_hash_map<const clang::NamedDecl*, xlscc::ChannelBundle>
+      top_channel_injections = {};
+  ASSERT_THAT(
+      translator_
+          ->GenerateIR_Top_Function(package_.get(), top_channel_injections)
+          .status(),
+      xls::status_testing::StatusIs(absl::StatusCode::kResourceExhausted,
+                                    testing::HasSubstr("over the limit")));
+}
+
+TEST_F(TranslatorLogicTest, ForUnrollConstantBranches) {
+  std::string_view content = R"(
+    int my_package(int a) {
+      int ret = 0;
+      #pragma hls_unroll yes
+      for(int i=0;i<10;++i) {
+        if(i == 3) {
+          ret += a;
+        } else if(i > 7) {
+          ret += 2 * a;
+        } else {
+          ret += 1;
+        }
+      }
+      return ret;
+    })";
+  // 1*a + 2*2*a + 7*1
+  Run({{"a", 5}}, 32, content);
+}
+
 TEST_F(TranslatorLogicTest, MaxUnrollItersEquals) {
   std::string_view content = R"(
     #pragma hls_top
@@ -3299,6 +3348,71 @@ TEST_F(TranslatorLogicTest, TemplateFunction) {
   Run({{"a", 3}}, 8, content);
 }
 
+TEST_F(TranslatorLogicTest, TemplateFunctionTranslationProfile) {
+  std::string_view content = R"(
+      template<int N>
+      int do_something(int a) {
+        return a+N;
+      }
+      int my_package(int a) {
+        return do_something<5>(a) + do_something<5>(a) +
+               do_something<5>(a) + do_something<6>(a);
+      })";
+
+  Run({{"a", 3}}, 3 * 8 + 9, content);
+
+  // Each instantiation is translated once and reused by its other calls.
+  std::vector<xlscc::Translator::FunctionTranslationProfile> profiles =
+      translator_->GetFunctionTranslationProfiles();
+  absl::flat_hash_map<std::string, int64_t> reuse_counts;
+  for (const xlscc::Translator::FunctionTranslationProfile& profile :
+       profiles) {
+    reuse_counts[profile.name] = profile.reuse_count;
+  }
+  EXPECT_THAT(reuse_counts,
+              testing::UnorderedElementsAre(
+                  testing::Pair("my_package", 0),
+                  testing::Pair("do_something<5>", 2),
+                  testing::Pair("do_something<6>", 0)));
+  EXPECT_THAT(translator_->FunctionTranslationProfileReport(),
+              testing::HasSubstr("Translated 3 functions"));
+}
+
+TEST_F(TranslatorLogicTest, TranslationProfileCountsUnrolledIterations) {
+  std::string_view content = R"(
+      int add_all(int a) {
+        int ret = 0;
+        #pragma hls_unroll yes
+        for(int i=0;i<3;++i) {
+          ret += a;
+        }
+        return ret;
+      }
+      int my_package(int a) {
+        int ret = add_all(a);
+        #pragma hls_unroll yes
+        for(int i=0;i<5;++i) {
+          ret += i;
+        }
+        return ret;
+      })";
+
+  Run({{"a", 3}}, 9 + 10, content);
+
+  xlscc_metadata::TranslationProfile profile =
+      translator_->GenerateTranslationProfile();
+  EXPECT_EQ(profile.functions_translated(), 2);
+  EXPECT_EQ(profile.unrolled_loop_iterations(), 8);
+  absl::flat_hash_map<std::string, int64_t> iterations;
+  for (const xlscc_metadata::FunctionProfile& function : profile.functions()) {
+    iterations[function.name()] = function.unrolled_loop_iterations();
+    EXPECT_GT(function.ir_node_count(), 0) << function.name();
+  }
+  EXPECT_THAT(iterations, testing::UnorderedElementsAre(
+                              testing::Pair("my_package", 5),
+                              testing::Pair("add_all", 3)));
+}
+
 TEST_F(TranslatorLogicTest, TemplateFunctionBool) {
   constexpr const char* content = R"(
       template<bool C>
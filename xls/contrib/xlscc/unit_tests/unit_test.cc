@@ -28,6 +28,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
@@ -769,8 +770,8 @@ XlsccTestBase::GetStatesByIONodeForFSMProc(std::string_view func_name) {
     XLS_ASSIGN_OR_RETURN(const int64_t state_index,
                          literal_value.bits().ToUint64());
 
-    absl::btree_set<xls::Node*, xls::Node::NodeIdLessThan> users =
-        node->users();
+    absl::btree_set<xls::Node*, xls::Node::NodeIdLessThan> users(
+        node->users().begin(), node->users().end());
     while (!users.empty()) {
       absl::btree_set<xls::Node*, xls::Node::NodeIdLessThan> next_users;
 
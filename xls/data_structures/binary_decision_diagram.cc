@@ -15,11 +15,13 @@
 #include "xls/data_structures/binary_decision_diagram.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <string>
-#include <tuple>
+#include <utility>
 #include <vector>
 
+#include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -27,10 +29,25 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/common/memory_usage.h"
 
 namespace xls {
 
-BinaryDecisionDiagram::BinaryDecisionDiagram() {
+namespace {
+
+// The initial number of slots of the unique table and the computed table.
+constexpr int64_t kInitialTableSize = 1024;
+
+// The marker of an empty slot in the unique table. Terminal nodes are never
+// in the table.
+constexpr BddNodeIndex kEmptySlot = BddNodeIndex(0);
+
+}  // namespace
+
+BinaryDecisionDiagram::BinaryDecisionDiagram()
+    : unique_table_(kInitialTableSize, kEmptySlot),
+      ite_cache_(kInitialTableSize) {
   // Leaf node 0.
   nodes_.push_back(BddNode(BddVariable(-1), BddNodeIndex(-1), BddNodeIndex(-1),
                            /*p=*/1));
@@ -39,28 +56,179 @@ BinaryDecisionDiagram::BinaryDecisionDiagram() {
                            /*p=*/1));
 }
 
+int64_t BinaryDecisionDiagram::FindUniqueTableSlot(BddVariable var,
+                                                   BddNodeIndex high,
+                                                   BddNodeIndex low) const {
+  const uint64_t mask = unique_table_.size() - 1;
+  uint64_t slot = absl::HashOf(var.value(), high.value(), low.value()) & mask;
+  while (unique_table_[slot] != kEmptySlot) {
+    const BddNode& node = nodes_[unique_table_[slot].value()];
+    if (node.variable == var && node.high == high && node.low == low) {
+      break;
+    }
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+void BinaryDecisionDiagram::RebuildUniqueTable(int64_t slot_count) {
+  unique_table_.assign(slot_count, kEmptySlot);
+  for (int64_t i = 2; i < nodes_.size(); ++i) {
+    const BddNode& node = nodes_[i];
+    if (node.path_count == 0) {
+      // Freed node.
+      continue;
+    }
+    unique_table_[FindUniqueTableSlot(node.variable, node.high, node.low)] =
+        BddNodeIndex(i);
+  }
+}
+
+int64_t BinaryDecisionDiagram::IteCacheSlot(BddNodeIndex cond,
+                                            BddNodeIndex if_true,
+                                            BddNodeIndex if_false) const {
+  return absl::HashOf(cond.value(), if_true.value(), if_false.value()) &
+         (ite_cache_.size() - 1);
+}
+
+void BinaryDecisionDiagram::ResizeIteCache(int64_t slot_count) {
+  std::vector<IteCacheEntry> old_cache = std::move(ite_cache_);
+  ite_cache_ = std::vector<IteCacheEntry>(slot_count);
+  for (const IteCacheEntry& entry : old_cache) {
+    if (entry.cond != zero()) {
+      ite_cache_[IteCacheSlot(entry.cond, entry.if_true, entry.if_false)] =
+          entry;
+    }
+  }
+}
+
 BddNodeIndex BinaryDecisionDiagram::GetOrCreateNode(BddVariable var,
                                                     BddNodeIndex high,
                                                     BddNodeIndex low) {
-  NodeKey key = std::make_tuple(var, high, low);
-  auto it = node_map_.find(key);
-  if (it != node_map_.end()) {
-    return it->second;
-  }
   if (low == high) {
     return low;
   }
+  int64_t slot = FindUniqueTableSlot(var, high, low);
+  if (unique_table_[slot] != kEmptySlot) {
+    return unique_table_[slot];
+  }
   // Compute the number of paths that the new node will have to the terminal
   // nodes 0 and 1. Use int64s to avoid overflowing and saturate at INT32_MAX.
   int32_t paths = std::min(
       static_cast<int64_t>(GetNode(low).path_count) + GetNode(high).path_count,
       static_cast<int64_t>(std::numeric_limits<int32_t>::max()));
-  nodes_.emplace_back(var, high, low, paths);
-  BddNodeIndex node_index = BddNodeIndex(nodes_.size() - 1);
-  node_map_[key] = node_index;
+  BddNodeIndex node_index;
+  if (free_nodes_.empty()) {
+    nodes_.emplace_back(var, high, low, paths);
+    node_index = BddNodeIndex(nodes_.size() - 1);
+  } else {
+    node_index = free_nodes_.back();
+    free_nodes_.pop_back();
+    nodes_[node_index.value()] = BddNode(var, high, low, paths);
+  }
+  unique_table_[slot] = node_index;
+  ++unique_node_count_;
+  if (2 * unique_node_count_ > unique_table_.size()) {
+    RebuildUniqueTable(2 * unique_table_.size());
+  }
+  if (size() > ite_cache_.size() && ite_cache_.size() < kMaxIteCacheSize) {
+    ResizeIteCache(2 * ite_cache_.size());
+  }
   return node_index;
 }
 
+int64_t BinaryDecisionDiagram::GarbageCollect(
+    absl::Span<const BddNodeIndex> roots) {
+  // Mark the nodes reachable from the roots.
+  std::vector<bool> live(nodes_.size(), false);
+  live[zero().value()] = true;
+  live[one().value()] = true;
+  std::vector<BddNodeIndex> worklist(roots.begin(), roots.end());
+  worklist.insert(worklist.end(), variable_base_nodes_.begin(),
+                  variable_base_nodes_.end());
+  while (!worklist.empty()) {
+    BddNodeIndex node_index = worklist.back();
+    worklist.pop_back();
+    if (live[node_index.value()]) {
+      continue;
+    }
+    live[node_index.value()] = true;
+    worklist.push_back(GetNode(node_index).high);
+    worklist.push_back(GetNode(node_index).low);
+  }
+
+  // Sweep the unmarked nodes. Iterate backwards so the lowest free slots are
+  // reused first.
+  int64_t freed = 0;
+  for (int64_t i = nodes_.size() - 1; i >= 2; --i) {
+    if (!live[i] && nodes_[i].path_count != 0) {
+      nodes_[i] = BddNode();
+      free_nodes_.push_back(BddNodeIndex(i));
+      ++freed;
+    }
+  }
+  if (freed == 0) {
+    return 0;
+  }
+  unique_node_count_ -= freed;
+  RebuildUniqueTable(unique_table_.size());
+  for (IteCacheEntry& entry : ite_cache_) {
+    if (entry.cond != zero() &&
+        (!live[entry.cond.value()] || !live[entry.if_true.value()] ||
+         !live[entry.if_false.value()] || !live[entry.result.value()])) {
+      entry = IteCacheEntry();
+    }
+  }
+  VLOG(3) << absl::StreamFormat("Freed %d BDD nodes, %d remain", freed,
+                                size());
+  return freed;
+}
+
+std::vector<BddNodeIndex> BinaryDecisionDiagram::Import(
+    const BinaryDecisionDiagram& other, absl::Span<const BddNodeIndex> roots) {
+  const int64_t variable_offset = next_var_.value();
+  for (int64_t i = 0; i < other.variable_count(); ++i) {
+    NewVariable();
+  }
+
+  // The node of this BDD corresponding to each node of `other`. Nodes which
+  // have not been imported yet are mapped to -1.
+  constexpr BddNodeIndex kNotImported = BddNodeIndex(-1);
+  std::vector<BddNodeIndex> imported(other.nodes_.size(), kNotImported);
+  imported[other.zero().value()] = zero();
+  imported[other.one().value()] = one();
+  std::vector<BddNodeIndex> result;
+  result.reserve(roots.size());
+  std::vector<BddNodeIndex> worklist;
+  for (BddNodeIndex root : roots) {
+    worklist.push_back(root);
+    while (!worklist.empty()) {
+      BddNodeIndex node_index = worklist.back();
+      if (imported[node_index.value()] != kNotImported) {
+        worklist.pop_back();
+        continue;
+      }
+      const BddNode& node = other.GetNode(node_index);
+      BddNodeIndex high = imported[node.high.value()];
+      BddNodeIndex low = imported[node.low.value()];
+      if (high == kNotImported || low == kNotImported) {
+        if (high == kNotImported) {
+          worklist.push_back(node.high);
+        }
+        if (low == kNotImported) {
+          worklist.push_back(node.low);
+        }
+        continue;
+      }
+      imported[node_index.value()] = GetOrCreateNode(
+          BddVariable(node.variable.value() + variable_offset), high, low);
+      worklist.pop_back();
+    }
+    result.push_back(imported[root.value()]);
+  }
+  return result;
+}
+
 BddNodeIndex BinaryDecisionDiagram::Restrict(BddNodeIndex expr, BddVariable var,
                                              bool value) {
   if (expr == zero() || expr == one()) {
@@ -90,10 +258,11 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
   if (if_true == if_false) {
     return if_true;
   }
-  auto key = std::make_tuple(cond, if_true, if_false);
-  auto it = ite_map_.find(key);
-  if (it != ite_map_.end()) {
-    return it->second;
+  if (const IteCacheEntry& entry =
+          ite_cache_[IteCacheSlot(cond, if_true, if_false)];
+      entry.cond == cond && entry.if_true == if_true &&
+      entry.if_false == if_false) {
+    return entry.result;
   }
 
   // The expression is non-trivial and has not been computed before. Recursively
@@ -123,19 +292,20 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
                                            Restrict(if_true, min_var, false),
                                            Restrict(if_false, min_var, false));
 
-  if (true_cofactor == false_cofactor) {
-    ite_map_[key] = true_cofactor;
-    return true_cofactor;
-  }
   BddNodeIndex expr = GetOrCreateNode(min_var, true_cofactor, false_cofactor);
-  ite_map_[key] = expr;
+  // The slot must be computed after creating the node which may have resized
+  // the cache.
+  ite_cache_[IteCacheSlot(cond, if_true, if_false)] = IteCacheEntry{
+      .cond = cond, .if_true = if_true, .if_false = if_false, .result = expr};
   return expr;
 }
 
 BddNodeIndex BinaryDecisionDiagram::NewVariable() {
   BddVariable var = next_var_;
   ++next_var_;
-  return GetOrCreateNode(var, one(), zero());
+  BddNodeIndex node = GetOrCreateNode(var, one(), zero());
+  variable_base_nodes_.push_back(node);
+  return node;
 }
 
 BddNodeIndex BinaryDecisionDiagram::Not(BddNodeIndex expr) {
@@ -231,4 +401,10 @@ std::string BinaryDecisionDiagram::ToStringDnf(BddNodeIndex expr,
   return result;
 }
 
+int64_t BinaryDecisionDiagram::EstimateMemoryUsage() const {
+  return EstimateHeapBytes(nodes_) + EstimateHeapBytes(free_nodes_) +
+         EstimateHeapBytes(variable_base_nodes_) +
+         EstimateHeapBytes(unique_table_) + EstimateHeapBytes(ite_cache_);
+}
+
 }  // namespace xls
@@ -17,11 +17,11 @@
 
 #include <cstdint>
 #include <string>
-#include <tuple>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/strong_int.h"
 
 namespace xls {
@@ -93,11 +93,29 @@ class BinaryDecisionDiagram {
   }
 
   // Returns the number of nodes in the graph.
-  int64_t size() const { return nodes_.size(); }
+  int64_t size() const { return nodes_.size() - free_nodes_.size(); }
 
   // Returns the number of variables in the graph.
   int64_t variable_count() const { return next_var_.value(); }
 
+  // Returns an estimate of the heap memory in bytes used by the BDD, including
+  // the node vector and the lookup tables.
+  int64_t EstimateMemoryUsage() const;
+
+  // Frees the nodes which are not reachable from `roots`. The terminal nodes
+  // and the base nodes of the variables are always retained. The indices of
+  // retained nodes are unchanged but the indices of freed nodes are reused by
+  // nodes created later, so callers must not hold on to any node which is not
+  // reachable from `roots`. Returns the number of nodes freed.
+  int64_t GarbageCollect(absl::Span<const BddNodeIndex> roots);
+
+  // Copies the expressions `roots` of `other` into this BDD and returns the
+  // corresponding nodes of this BDD. Each variable of `other` is mapped to a
+  // new variable of this BDD. The new variables are ordered after the existing
+  // variables and in the same relative order as in `other`.
+  std::vector<BddNodeIndex> Import(const BinaryDecisionDiagram& other,
+                                   absl::Span<const BddNodeIndex> roots);
+
   // Returns the number of paths in the given expression.
   int64_t path_count(BddNodeIndex expr) const {
     return GetNode(expr).path_count;
@@ -136,27 +154,60 @@ class BinaryDecisionDiagram {
 
   // Returns the node corresponding to the value of the given variable.
   BddNodeIndex GetVariableBaseNode(BddVariable variable) const {
-    return node_map_.at({variable, one(), zero()});
+    return variable_base_nodes_.at(variable.value());
   }
 
+  // Returns the slot of the unique table which holds the node with the given
+  // content, or the empty slot where such a node would be inserted.
+  int64_t FindUniqueTableSlot(BddVariable var, BddNodeIndex high,
+                              BddNodeIndex low) const;
+
+  // Rebuilds the unique table with `slot_count` slots from the live nodes.
+  void RebuildUniqueTable(int64_t slot_count);
+
+  // Returns the computed-table slot for the given if-then-else expression.
+  int64_t IteCacheSlot(BddNodeIndex cond, BddNodeIndex if_true,
+                       BddNodeIndex if_false) const;
+
+  // Grows the computed table to `slot_count` slots, retaining its entries
+  // where they do not collide.
+  void ResizeIteCache(int64_t slot_count);
+
   // The numeric id to use for the next created variable. Increments with each
   // call to NewVariable which
   BddVariable next_var_ = BddVariable(0);
 
-  // The vector of all the nodes in the BDD.
+  // The vector of all the nodes in the BDD. Slots of freed nodes have a path
+  // count of zero and are listed in `free_nodes_`.
   std::vector<BddNode> nodes_;
-
-  // A map from BDD node content (variable id, high child, low child) to the
-  // index of the respective node. This map is used to ensure that no duplicate
-  // nodes are created.
-  using NodeKey = std::tuple<BddVariable, BddNodeIndex, BddNodeIndex>;
-  absl::flat_hash_map<NodeKey, BddNodeIndex> node_map_;
-
-  // A map from if-then-else expression to the node corresponding to that
-  // expression. The key elements are (condition, if-true, if-false). This map
-  // enables fast lookup for expressions.
-  using IteKey = std::tuple<BddNodeIndex, BddNodeIndex, BddNodeIndex>;
-  absl::flat_hash_map<IteKey, BddNodeIndex> ite_map_;
+  std::vector<BddNodeIndex> free_nodes_;
+
+  // The base node of each variable indexed by variable.
+  std::vector<BddNodeIndex> variable_base_nodes_;
+
+  // An open-addressed hash table (with linear probing) of the indices of all
+  // non-terminal nodes keyed on the node content (variable id, high child, low
+  // child). This table is used to ensure that no duplicate nodes are created.
+  // Terminal nodes are never in the table so index zero marks an empty slot.
+  // The number of slots is a power of two and is kept at least twice the
+  // number of nodes in the table.
+  std::vector<BddNodeIndex> unique_table_;
+  int64_t unique_node_count_ = 0;
+
+  // A lossy, direct-mapped cache (the "computed table") from if-then-else
+  // expressions to the node corresponding to that expression. A colliding
+  // entry replaces the previous occupant of the slot, so the memory used is
+  // bounded. The number of slots is a power of two which grows with the number
+  // of nodes up to kMaxIteCacheSize. Entries with a `cond` of zero are empty
+  // (such expressions are trivial and never cached).
+  struct IteCacheEntry {
+    BddNodeIndex cond = BddNodeIndex(0);
+    BddNodeIndex if_true = BddNodeIndex(0);
+    BddNodeIndex if_false = BddNodeIndex(0);
+    BddNodeIndex result = BddNodeIndex(0);
+  };
+  static constexpr int64_t kMaxIteCacheSize = int64_t{1} << 20;
+  std::vector<IteCacheEntry> ite_cache_;
 };
 
 }  // namespace xls
@@ -313,5 +313,93 @@ TEST(BinaryDecisionDiagramTest, ThreeVariableExhaustive) {
   }
 }
 
+TEST(BinaryDecisionDiagramTest, GarbageCollect) {
+  BinaryDecisionDiagram bdd;
+  std::vector<BddNodeIndex> vars;
+  for (int64_t i = 0; i < 8; ++i) {
+    vars.push_back(bdd.NewVariable());
+  }
+  // Nothing other than the terminals and base nodes exists.
+  EXPECT_EQ(bdd.GarbageCollect({}), 0);
+  EXPECT_EQ(bdd.size(), 10);
+
+  BddNodeIndex keep = bdd.And(vars[0], bdd.Or(vars[3], bdd.Not(vars[7])));
+  BddNodeIndex parity = bdd.zero();
+  for (BddNodeIndex var : vars) {
+    parity = bdd.Or(bdd.And(parity, bdd.Not(var)),
+                    bdd.And(bdd.Not(parity), var));
+  }
+  int64_t size_before = bdd.size();
+  int64_t freed = bdd.GarbageCollect({keep});
+  EXPECT_GT(freed, 0);
+  EXPECT_EQ(bdd.size(), size_before - freed);
+
+  // The retained expression and the variables are intact.
+  EXPECT_THAT(bdd.Evaluate(keep, {{vars[0], true},
+                                  {vars[3], false},
+                                  {vars[7], false}}),
+              IsOkAndHolds(true));
+  EXPECT_THAT(bdd.Evaluate(keep, {{vars[0], true},
+                                  {vars[3], false},
+                                  {vars[7], true}}),
+              IsOkAndHolds(false));
+  EXPECT_EQ(bdd.And(vars[0], bdd.Or(vars[3], bdd.Not(vars[7]))), keep);
+
+  // Rebuilding the collected expression reuses the freed nodes and produces
+  // the same function.
+  int64_t size_after_gc = bdd.size();
+  BddNodeIndex rebuilt_parity = bdd.zero();
+  for (BddNodeIndex var : vars) {
+    rebuilt_parity = bdd.Or(bdd.And(rebuilt_parity, bdd.Not(var)),
+                            bdd.And(bdd.Not(rebuilt_parity), var));
+  }
+  EXPECT_GT(bdd.size(), size_after_gc);
+  EXPECT_LE(bdd.size(), size_before);
+  EXPECT_EQ(bdd.path_count(rebuilt_parity), 256);
+  absl::flat_hash_map<BddNodeIndex, bool> values;
+  for (int64_t i = 0; i < 8; ++i) {
+    values[vars[i]] = i == 2 || i == 5 || i == 6;
+  }
+  EXPECT_THAT(bdd.Evaluate(rebuilt_parity, values), IsOkAndHolds(true));
+}
+
+TEST(BinaryDecisionDiagramTest, Import) {
+  BinaryDecisionDiagram bdd;
+  BddNodeIndex a = bdd.NewVariable();
+  BddNodeIndex b = bdd.NewVariable();
+  BddNodeIndex a_and_b = bdd.And(a, b);
+
+  BinaryDecisionDiagram other;
+  BddNodeIndex x = other.NewVariable();
+  BddNodeIndex y = other.NewVariable();
+  BddNodeIndex z = other.NewVariable();
+  BddNodeIndex expr = other.Or(other.And(x, other.Not(y)), z);
+
+  std::vector<BddNodeIndex> imported =
+      bdd.Import(other, {expr, x, y, z, other.one(), other.zero()});
+  ASSERT_EQ(imported.size(), 6);
+  EXPECT_EQ(bdd.variable_count(), 5);
+  EXPECT_EQ(bdd.GetNode(imported[1]).variable, BddVariable(2));
+  EXPECT_EQ(bdd.GetNode(imported[3]).variable, BddVariable(4));
+  EXPECT_EQ(imported[4], bdd.one());
+  EXPECT_EQ(imported[5], bdd.zero());
+  EXPECT_EQ(bdd.path_count(imported[0]), other.path_count(expr));
+
+  // The imported expressions can be combined with the existing ones.
+  BddNodeIndex combined = bdd.And(a_and_b, imported[0]);
+  for (int64_t i = 0; i < 16; ++i) {
+    bool va = (i & 1) != 0;
+    bool vx = (i & 2) != 0;
+    bool vy = (i & 4) != 0;
+    bool vz = (i & 8) != 0;
+    EXPECT_THAT(bdd.Evaluate(combined, {{a, va},
+                                        {b, true},
+                                        {imported[1], vx},
+                                        {imported[2], vy},
+                                        {imported[3], vz}}),
+                IsOkAndHolds(va && ((vx && !vy) || vz)));
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,186 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/graph_coloring.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/numeric/bits.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
+
+namespace xls {
+namespace {
+
+// Returns the number of bits set in both `a` and `b`.
+int64_t IntersectionCount(const InlineBitmap& a, const InlineBitmap& b) {
+  int64_t count = 0;
+  for (int64_t i = 0; i < a.word_count(); ++i) {
+    count += absl::popcount(a.GetWord(i) & b.GetWord(i));
+  }
+  return count;
+}
+
+// Calls `f` with the index of each bit set in `bitmap` in increasing order.
+template <typename F>
+void ForEachSetBit(const InlineBitmap& bitmap, F f) {
+  for (int64_t i = 0; i < bitmap.word_count(); ++i) {
+    uint64_t word = bitmap.GetWord(i);
+    while (word != 0) {
+      f(i * 64 + absl::countr_zero(word));
+      word &= word - 1;
+    }
+  }
+}
+
+// Bitset version of FindMaximalIndependentSet in graph_coloring.h, restricted
+// to the subgraph induced by `vertices`. Makes the same choices as the generic
+// version so returns the same set.
+std::vector<int64_t> FindMaximalIndependentSet(
+    absl::Span<const InlineBitmap> adjacency, const InlineBitmap& vertices) {
+  const int64_t vertex_count = adjacency.size();
+  std::vector<int64_t> result;
+  // The vertices not yet in the result, and the vertices adjacent to the
+  // result.
+  InlineBitmap available = vertices;
+  InlineBitmap neighboring_result(vertex_count);
+  auto add_to_result = [&](int64_t vertex) {
+    result.push_back(vertex);
+    for (int64_t i = 0; i < neighboring_result.word_count(); ++i) {
+      neighboring_result.SetWord(
+          i, neighboring_result.GetWord(i) |
+                 (adjacency[vertex].GetWord(i) & vertices.GetWord(i)));
+    }
+    available.Set(vertex, false);
+  };
+
+  {
+    int64_t largest_degree = 0;
+    std::optional<int64_t> best;
+    ForEachSetBit(available, [&](int64_t vertex) {
+      int64_t degree = IntersectionCount(adjacency[vertex], vertices);
+      if (degree >= largest_degree) {
+        largest_degree = degree;
+        best = vertex;
+      }
+    });
+    CHECK(best.has_value());
+    add_to_result(*best);
+  }
+
+  while (!available.IsAllZeroes()) {
+    std::pair<int64_t, int64_t> best_measure = {-1, -1};
+    std::optional<int64_t> best;
+    ForEachSetBit(available, [&](int64_t vertex) {
+      if (neighboring_result.Get(vertex)) {
+        return;
+      }
+      std::pair<int64_t, int64_t> measure = {
+          IntersectionCount(adjacency[vertex], neighboring_result),
+          -IntersectionCount(adjacency[vertex], available)};
+      if (measure > best_measure) {
+        best_measure = measure;
+        best = vertex;
+      }
+    });
+    if (!best.has_value()) {
+      break;
+    }
+    add_to_result(*best);
+  }
+
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+}  // namespace
+
+std::vector<std::vector<int64_t>> RecursiveLargestFirstColoring(
+    absl::Span<const InlineBitmap> adjacency) {
+  const int64_t vertex_count = adjacency.size();
+  std::vector<std::vector<int64_t>> result;
+  InlineBitmap uncolored(vertex_count, /*fill=*/true);
+  while (!uncolored.IsAllZeroes()) {
+    std::vector<int64_t> independent_set =
+        FindMaximalIndependentSet(adjacency, uncolored);
+    for (int64_t vertex : independent_set) {
+      uncolored.Set(vertex, false);
+    }
+    result.push_back(std::move(independent_set));
+  }
+  return result;
+}
+
+std::vector<std::vector<int64_t>> DSaturColoring(
+    absl::Span<const InlineBitmap> adjacency) {
+  const int64_t vertex_count = adjacency.size();
+  // For each vertex, the colors of its colored neighbors; a vertex can never
+  // need more than `vertex_count` colors.
+  std::vector<InlineBitmap> neighbor_colors(vertex_count,
+                                            InlineBitmap(vertex_count));
+  std::vector<int64_t> saturation(vertex_count, 0);
+  std::vector<int64_t> uncolored_degree(vertex_count, 0);
+  for (int64_t v = 0; v < vertex_count; ++v) {
+    uncolored_degree[v] = adjacency[v].Get(v) ? -1 : 0;
+    ForEachSetBit(adjacency[v], [&](int64_t) { ++uncolored_degree[v]; });
+  }
+  InlineBitmap uncolored(vertex_count, /*fill=*/true);
+
+  std::vector<std::vector<int64_t>> result;
+  for (int64_t colored = 0; colored < vertex_count; ++colored) {
+    std::optional<int64_t> best;
+    ForEachSetBit(uncolored, [&](int64_t v) {
+      if (!best.has_value() || saturation[v] > saturation[*best] ||
+          (saturation[v] == saturation[*best] &&
+           uncolored_degree[v] > uncolored_degree[*best])) {
+        best = v;
+      }
+    });
+    const int64_t vertex = *best;
+
+    // The lowest color none of the neighbors have.
+    int64_t color = 0;
+    while (neighbor_colors[vertex].Get(color)) {
+      ++color;
+    }
+    if (color == result.size()) {
+      result.push_back({});
+    }
+    result[color].push_back(vertex);
+    uncolored.Set(vertex, false);
+
+    ForEachSetBit(adjacency[vertex], [&](int64_t neighbor) {
+      if (neighbor == vertex || !uncolored.Get(neighbor)) {
+        return;
+      }
+      --uncolored_degree[neighbor];
+      if (!neighbor_colors[neighbor].Get(color)) {
+        neighbor_colors[neighbor].Set(color);
+        ++saturation[neighbor];
+      }
+    });
+  }
+
+  for (std::vector<int64_t>& color_class : result) {
+    std::sort(color_class.begin(), color_class.end());
+  }
+  return result;
+}
+
+}  // namespace xls
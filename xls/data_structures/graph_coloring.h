@@ -15,6 +15,7 @@
 #ifndef XLS_DATA_STRUCTURES_GRAPH_COLORING_H_
 #define XLS_DATA_STRUCTURES_GRAPH_COLORING_H_
 
+#include <cstdint>
 #include <functional>
 #include <optional>
 #include <string>
@@ -27,6 +28,8 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "../z3/src/api/c++/z3++.h"
 
 namespace xls {
@@ -154,6 +157,31 @@ std::vector<absl::flat_hash_set<V>> RecursiveLargestFirstColoring(
   return result;
 }
 
+// The following colorings operate on graphs whose vertices are the integers
+// [0, n) given as an adjacency matrix: `adjacency[v]` has n bits and bit u is
+// set iff u is a neighbor of v. The matrix must be symmetric. Color classes are
+// returned as vectors of vertices in increasing order.
+//
+// These are much faster than the generic versions above on dense graphs as the
+// neighborhoods are intersected a word at a time.
+
+// As RecursiveLargestFirstColoring<int64_t> above, and returns the same color
+// classes in the same order.
+std::vector<std::vector<int64_t>> RecursiveLargestFirstColoring(
+    absl::Span<const InlineBitmap> adjacency);
+
+// Color the given graph using the DSatur algorithm: repeatedly give the
+// uncolored vertex with the most distinct colors among its neighbors the lowest
+// color not used by any of its neighbors. Ties are broken by the number of
+// uncolored neighbors and then by the lowest vertex. Self-loops are ignored.
+//
+// DSatur usually needs about as many colors as RLF and is considerably faster.
+//
+// This algorithm is explained on page 39 of "Guide to Graph Colouring" second
+// edition by R. M. R. Lewis. https://doi.org/10.1007%2F978-3-030-81054-2
+std::vector<std::vector<int64_t>> DSaturColoring(
+    absl::Span<const InlineBitmap> adjacency);
+
 inline std::optional<int64_t> LookupIntegerInZ3Model(z3::model model,
                                                      std::string_view name) {
   for (int32_t i = 0; i < model.size(); i++) {
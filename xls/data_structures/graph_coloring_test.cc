@@ -14,13 +14,21 @@
 
 #include "xls/data_structures/graph_coloring.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/random/distributions.h"
+#include "absl/types/span.h"
+#include "benchmark/benchmark.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 namespace {
@@ -144,5 +152,162 @@ TEST(GraphColoringTest, Wheel) {
   EXPECT_TRUE(IsValidColoring(graph, Z3FromMap(graph)));
 }
 
+// Builds a graph like those colored by the mutual exclusion pass: each vertex
+// is an operation of one of `kind_count` kinds, and two operations conflict
+// (are adjacent) unless they are of the same kind and mutually exclusive, which
+// happens with probability `exclusive_probability`. As in the pass, every
+// vertex is adjacent to itself.
+std::vector<InlineBitmap> MutualExclusionLikeGraph(int64_t vertex_count,
+                                                   int64_t kind_count,
+                                                   double exclusive_probability,
+                                                   std::mt19937_64& bit_gen) {
+  std::vector<InlineBitmap> adjacency(
+      vertex_count, InlineBitmap(vertex_count, /*fill=*/true));
+  for (int64_t x = 0; x < vertex_count; ++x) {
+    for (int64_t y = x + 1; y < vertex_count; ++y) {
+      if (x % kind_count == y % kind_count &&
+          absl::Bernoulli(bit_gen, exclusive_probability)) {
+        adjacency[x].Set(y, false);
+        adjacency[y].Set(x, false);
+      }
+    }
+  }
+  return adjacency;
+}
+
+std::vector<InlineBitmap> BitmapGraph(
+    int64_t vertex_count,
+    absl::Span<const std::pair<int64_t, int64_t>> edges) {
+  std::vector<InlineBitmap> adjacency(vertex_count,
+                                      InlineBitmap(vertex_count));
+  for (const auto& [x, y] : edges) {
+    adjacency[x].Set(y);
+    adjacency[y].Set(x);
+  }
+  return adjacency;
+}
+
+bool IsValidBitmapColoring(absl::Span<const InlineBitmap> adjacency,
+                           absl::Span<const std::vector<int64_t>> coloring) {
+  std::vector<int64_t> color(adjacency.size(), -1);
+  for (int64_t c = 0; c < coloring.size(); ++c) {
+    for (int64_t vertex : coloring[c]) {
+      if (color[vertex] != -1) {
+        return false;
+      }
+      color[vertex] = c;
+    }
+  }
+  for (int64_t x = 0; x < adjacency.size(); ++x) {
+    if (color[x] == -1) {
+      return false;
+    }
+    for (int64_t y = 0; y < adjacency.size(); ++y) {
+      if (x != y && adjacency[x].Get(y) && color[x] == color[y]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+std::vector<std::vector<int64_t>> GenericRLF(
+    absl::Span<const InlineBitmap> adjacency) {
+  absl::flat_hash_set<int64_t> vertices;
+  std::vector<absl::flat_hash_set<int64_t>> neighborhoods(adjacency.size());
+  for (int64_t x = 0; x < adjacency.size(); ++x) {
+    vertices.insert(x);
+    for (int64_t y = 0; y < adjacency.size(); ++y) {
+      if (adjacency[x].Get(y)) {
+        neighborhoods[x].insert(y);
+      }
+    }
+  }
+  std::vector<std::vector<int64_t>> result;
+  for (const absl::flat_hash_set<int64_t>& color_class :
+       RecursiveLargestFirstColoring<int64_t>(
+           vertices, [&](const int64_t& vertex) {
+             return neighborhoods[vertex];
+           })) {
+    result.emplace_back(color_class.begin(), color_class.end());
+    std::sort(result.back().begin(), result.back().end());
+  }
+  return result;
+}
+
+TEST(GraphColoringTest, BitmapRLFMatchesGeneric) {
+  std::mt19937_64 bit_gen;
+  for (int64_t vertex_count : {1, 10, 70, 150}) {
+    std::vector<InlineBitmap> graph =
+        MutualExclusionLikeGraph(vertex_count, 3, 0.5, bit_gen);
+    std::vector<std::vector<int64_t>> coloring =
+        RecursiveLargestFirstColoring(graph);
+    EXPECT_TRUE(IsValidBitmapColoring(graph, coloring));
+    EXPECT_EQ(coloring, GenericRLF(graph));
+  }
+}
+
+TEST(GraphColoringTest, DSatur) {
+  EXPECT_TRUE(DSaturColoring({}).empty());
+
+  std::vector<InlineBitmap> odd_cycle =
+      BitmapGraph(5, {{0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 0}});
+  EXPECT_EQ(DSaturColoring(odd_cycle).size(), 3);
+  EXPECT_TRUE(IsValidBitmapColoring(odd_cycle, DSaturColoring(odd_cycle)));
+
+  std::vector<InlineBitmap> even_cycle =
+      BitmapGraph(4, {{0, 1}, {1, 2}, {2, 3}, {3, 0}});
+  EXPECT_EQ(DSaturColoring(even_cycle).size(), 2);
+  EXPECT_TRUE(IsValidBitmapColoring(even_cycle, DSaturColoring(even_cycle)));
+
+  std::vector<InlineBitmap> wheel = BitmapGraph(
+      6, {{0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 0}, {5, 0}, {5, 1}, {5, 2},
+          {5, 3}, {5, 4}});
+  EXPECT_EQ(DSaturColoring(wheel).size(), 4);
+  EXPECT_TRUE(IsValidBitmapColoring(wheel, DSaturColoring(wheel)));
+
+  // Self-loops do not prevent coloring.
+  std::vector<InlineBitmap> self_loops = BitmapGraph(2, {{0, 0}, {1, 1}});
+  EXPECT_EQ(DSaturColoring(self_loops),
+            (std::vector<std::vector<int64_t>>{{0, 1}}));
+
+  std::mt19937_64 bit_gen;
+  std::vector<InlineBitmap> graph =
+      MutualExclusionLikeGraph(200, 4, 0.5, bit_gen);
+  EXPECT_TRUE(IsValidBitmapColoring(graph, DSaturColoring(graph)));
+}
+
+// The colorings of a mutual-exclusion-like graph of `state.range(0)` vertices,
+// so the generic and bitmap implementations can be compared.
+void BM_GenericRLF(benchmark::State& state) {
+  std::mt19937_64 bit_gen;
+  std::vector<InlineBitmap> graph =
+      MutualExclusionLikeGraph(state.range(0), 8, 0.3, bit_gen);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(GenericRLF(graph));
+  }
+}
+BENCHMARK(BM_GenericRLF)->Arg(100)->Arg(400);
+
+void BM_BitmapRLF(benchmark::State& state) {
+  std::mt19937_64 bit_gen;
+  std::vector<InlineBitmap> graph =
+      MutualExclusionLikeGraph(state.range(0), 8, 0.3, bit_gen);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(RecursiveLargestFirstColoring(graph));
+  }
+}
+BENCHMARK(BM_BitmapRLF)->Arg(100)->Arg(400)->Arg(2000);
+
+void BM_DSatur(benchmark::State& state) {
+  std::mt19937_64 bit_gen;
+  std::vector<InlineBitmap> graph =
+      MutualExclusionLikeGraph(state.range(0), 8, 0.3, bit_gen);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(DSaturColoring(graph));
+  }
+}
+BENCHMARK(BM_DSatur)->Arg(100)->Arg(400)->Arg(2000);
+
 }  // namespace
 }  // namespace xls
@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
 #include <tuple>
@@ -27,6 +28,7 @@
 #include "absl/algorithm/container.h"
 #include "absl/base/attributes.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -322,6 +324,12 @@ class LeafTypeTreeIterator {
 // stored in a flat vector which provides fast iteration, but indexing through
 // tuple types is O(#elements in tuple).
 //
+// Trees with more than one leaf keep their elements in copy-on-write storage:
+// copies and subtrees (see Subtree) share the elements of the original tree
+// until one of them is mutated through a non-const accessor, at which point the
+// mutated tree makes its own copy. Spans and mutable views obtained from a tree
+// are invalidated if the tree is then copied.
+//
 // Example usage where T is an int64_t:
 //
 //   Type* t = ...; /* (bits[42], bits[55], (bits[123], bits[64])) */
@@ -356,26 +364,25 @@ class LeafTypeTree {
   LeafTypeTree(LeafTypeTree<T>&& other) = default;
   LeafTypeTree& operator=(LeafTypeTree<T>&& other) = default;
   friend bool operator==(const LeafTypeTree<T>& lhs,
-                         const LeafTypeTree<T>& rhs) = default;
+                         const LeafTypeTree<T>& rhs) {
+    return lhs.type_ == rhs.type_ &&
+           absl::c_equal(lhs.elements(), rhs.elements());
+  }
 
   // Creates a leaf type tree in which each data member is default constructed.
-  explicit LeafTypeTree(Type* type)
-      : type_(type),
-        elements_(type->leaf_count()),
-        leaf_types_(leaf_type_tree_internal::GetLeafTypes(type)) {}
+  explicit LeafTypeTree(Type* type) : type_(type) {
+    Initialize(DataContainerT(type->leaf_count()));
+  }
 
   // Creates a leaf type tree in which each data member set to `init_value`.
-  LeafTypeTree(Type* type, const T& init_value)
-      : type_(type),
-        elements_(type->leaf_count(), init_value),
-        leaf_types_(leaf_type_tree_internal::GetLeafTypes(type)) {}
+  LeafTypeTree(Type* type, const T& init_value) : type_(type) {
+    Initialize(DataContainerT(type->leaf_count(), init_value));
+  }
 
   // Constructor which takes a flattened representation of the leaf elements.
-  LeafTypeTree(Type* type, absl::Span<const T> elements)
-      : type_(type),
-        elements_(elements.begin(), elements.end()),
-        leaf_types_(leaf_type_tree_internal::GetLeafTypes(type)) {
-    CHECK_EQ(elements_.size(), leaf_types_.size());
+  LeafTypeTree(Type* type, absl::Span<const T> elements) : type_(type) {
+    CHECK_EQ(elements.size(), type->leaf_count());
+    Initialize(DataContainerT(elements.begin(), elements.end()));
   }
 
   // Factory for efficiently constructing a LeafTypeTree by moving in the vector
@@ -385,8 +392,7 @@ class LeafTypeTree {
     CHECK_EQ(elements.size(), type->leaf_count());
     LeafTypeTree<T> ltt;
     ltt.type_ = type;
-    ltt.elements_ = elements;
-    ltt.leaf_types_ = leaf_type_tree_internal::GetLeafTypes(type);
+    ltt.Initialize(std::move(elements));
     return ltt;
   }
 
@@ -395,8 +401,8 @@ class LeafTypeTree {
     CHECK_EQ(type->leaf_count(), 1);
     LeafTypeTree<T> ltt;
     ltt.type_ = type;
-    ltt.elements_ = {element};
-    ltt.leaf_types_ = leaf_type_tree_internal::GetLeafTypes(type);
+    ltt.inline_elements_.push_back(std::move(element));
+    ltt.inline_leaf_types_ = leaf_type_tree_internal::GetLeafTypes(type);
     return ltt;
   }
 
@@ -423,33 +429,96 @@ class LeafTypeTree {
 
   // Returns the number of values in the container (equivalently number of
   // leaves of the type).
-  int64_t size() const { return elements_.size(); }
+  int64_t size() const { return type_ == nullptr ? 0 : type_->leaf_count(); }
 
   // Returns the element at the given Type index.  The Type index defines a
   // recursive traversal through the object's XLS type. The Type index must
   // correspond to a leaf Bits-type element in the object's XLS type.
   T& Get(absl::Span<int64_t const> index) {
-    return elements_[leaf_type_tree_internal::GetLeafTypeOffset(type(), index)];
+    return elements()[leaf_type_tree_internal::GetLeafTypeOffset(type(),
+                                                                  index)];
   }
   const T& Get(absl::Span<int64_t const> index) const {
-    return elements_[leaf_type_tree_internal::GetLeafTypeOffset(type(), index)];
+    return elements()[leaf_type_tree_internal::GetLeafTypeOffset(type(),
+                                                                  index)];
   }
 
   // Sets the element at the given Type index to the given value.
   void Set(absl::Span<int64_t const> index, const T& value) {
-    elements_[leaf_type_tree_internal::GetLeafTypeOffset(type(), index)] =
+    elements()[leaf_type_tree_internal::GetLeafTypeOffset(type(), index)] =
         value;
   }
 
-  // Returns the values stored in this container.
-  absl::Span<T> elements() { return absl::Span<T>(elements_); }
+  // Returns the values stored in this container. The mutable overload first
+  // gives this tree its own copy of the elements if they are shared with
+  // another tree.
+  absl::Span<T> elements() {
+    if (shared_ == nullptr) {
+      return absl::Span<T>(inline_elements_);
+    }
+    MakeUnique();
+    return absl::Span<T>(shared_->elements);
+  }
   absl::Span<T const> elements() const {
-    return absl::Span<T const>(elements_);
+    if (shared_ == nullptr) {
+      return absl::Span<T const>(inline_elements_);
+    }
+    return absl::Span<T const>(shared_->elements).subspan(offset_, size());
   }
 
   // Returns the types of each leaf in the XLS type of this object. The order
   // of these types corresponds to the order of elements().
-  absl::Span<Type* const> leaf_types() const { return leaf_types_; }
+  absl::Span<Type* const> leaf_types() const {
+    if (shared_ == nullptr) {
+      return inline_leaf_types_;
+    }
+    return absl::Span<Type* const>(shared_->leaf_types)
+        .subspan(offset_, size());
+  }
+
+  // Returns true if this tree holds its elements in storage shared with
+  // another tree. Copies and subtrees of trees with more than one leaf share
+  // storage until one of them is mutated.
+  bool IsShared() const {
+    return shared_ != nullptr && shared_.use_count() > 1;
+  }
+
+  // Returns the subtree at the given type index as a separate
+  // LeafTypeTree. Unlike Clone(AsView(index)) the elements of the subtree are
+  // not copied but shared with this tree until either is mutated.
+  LeafTypeTree<T> Subtree(absl::Span<const int64_t> index) const {
+    auto [subtype, linear_offset] =
+        leaf_type_tree_internal::GetSubtypeAndOffset(type(), index);
+    if (shared_ == nullptr || subtype->leaf_count() <= 1) {
+      absl::Span<T const> subelements =
+          elements().subspan(linear_offset, subtype->leaf_count());
+      return LeafTypeTree<T>(subtype, subelements);
+    }
+    LeafTypeTree<T> ltt;
+    ltt.type_ = subtype;
+    ltt.shared_ = shared_;
+    ltt.offset_ = offset_ + linear_offset;
+    return ltt;
+  }
+
+  // Returns an estimate of the heap memory in bytes held by this tree.
+  // `element_bytes` returns the heap memory held by a single element. Storage
+  // shared with other trees is counted in full by each of them.
+  int64_t EstimateMemoryUsage(
+      absl::FunctionRef<int64_t(const T&)> element_bytes) const {
+    int64_t bytes = 0;
+    if (shared_ != nullptr) {
+      // The storage is allocated along with the control block of a
+      // shared_ptr.
+      bytes += sizeof(SharedStorage) + 2 * sizeof(void*) +
+               shared_->elements.capacity() * sizeof(T) +
+               shared_->leaf_types.capacity() * sizeof(Type*);
+    }
+    for (const T& element : elements()) {
+      bytes += element_bytes(element);
+    }
+    return bytes;
+  }
 
   // Returns an immutable view of the LeafTypeTree.
   LeafTypeTreeView<T> AsView(absl::Span<const int64_t> index = {}) const
@@ -458,11 +527,13 @@ class LeafTypeTree {
                                                 leaf_types(), index);
   }
 
-  // Returns a mutable view of the LeafTypeTree.
+  // Returns a mutable view of the LeafTypeTree. The view is invalidated if the
+  // tree is subsequently copied.
   MutableLeafTypeTreeView<T> AsMutableView(absl::Span<const int64_t> index = {})
       ABSL_ATTRIBUTE_LIFETIME_BOUND {
-    return MutableLeafTypeTreeView<T>::CreateFromSpans(type(), elements(),
-                                                       leaf_types(), index);
+    absl::Span<T> mutable_elements = elements();
+    return MutableLeafTypeTreeView<T>::CreateFromSpans(
+        type(), mutable_elements, leaf_types(), index);
   }
 
   // Returns the stringified elements of the LeafTypeTree in a structured
@@ -509,10 +580,51 @@ class LeafTypeTree {
     return H::combine(std::move(h), ltt.type_, ltt.elements());
   }
 
- protected:
+ private:
+  // Storage for the elements of trees with more than one leaf. Shared between
+  // copies and subtrees of a tree, each of which refers to `size()` elements
+  // starting at its `offset_`.
+  struct SharedStorage {
+    DataContainerT elements;
+    TypeContainerT leaf_types;
+  };
+
+  // Sets the elements of this tree, which must be of type `type_`.
+  void Initialize(DataContainerT&& elements) {
+    TypeContainerT leaf_types = leaf_type_tree_internal::GetLeafTypes(type_);
+    if (elements.size() <= 1) {
+      inline_elements_ = std::move(elements);
+      inline_leaf_types_ = std::move(leaf_types);
+      return;
+    }
+    shared_ = std::make_shared<SharedStorage>(
+        SharedStorage{std::move(elements), std::move(leaf_types)});
+  }
+
+  // Gives this tree sole ownership of its elements, copying them out of the
+  // shared storage if any other tree refers to it.
+  void MakeUnique() {
+    if (shared_.use_count() == 1 && offset_ == 0 &&
+        shared_->elements.size() == size()) {
+      return;
+    }
+    absl::Span<T const> old_elements = std::as_const(*this).elements();
+    absl::Span<Type* const> old_leaf_types = leaf_types();
+    shared_ = std::make_shared<SharedStorage>(SharedStorage{
+        DataContainerT(old_elements.begin(), old_elements.end()),
+        TypeContainerT(old_leaf_types.begin(), old_leaf_types.end())});
+    offset_ = 0;
+  }
+
   Type* type_;
-  DataContainerT elements_;
-  TypeContainerT leaf_types_;
+
+  // Storage of trees with at most one leaf, which are cheap to copy.
+  DataContainerT inline_elements_;
+  TypeContainerT inline_leaf_types_;
+
+  // Storage of trees with more than one leaf.
+  std::shared_ptr<SharedStorage> shared_;
+  int64_t offset_ = 0;
 };
 
 namespace leaf_type_tree_internal {
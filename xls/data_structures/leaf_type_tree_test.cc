@@ -19,6 +19,7 @@
 #include <limits>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -311,6 +312,64 @@ TEST_F(LeafTypeTreeTest, Token) {
   EXPECT_EQ(tree.AsView().ToString(), "0");
 }
 
+TEST_F(LeafTypeTreeTest, CopiesShareElements) {
+  LeafTypeTree<int64_t> tree(AsType("(bits[1], bits[2], bits[3])"), {1, 2, 3});
+  EXPECT_FALSE(tree.IsShared());
+
+  LeafTypeTree<int64_t> copy = tree;
+  EXPECT_TRUE(tree.IsShared());
+  EXPECT_TRUE(copy.IsShared());
+  EXPECT_EQ(std::as_const(tree).elements().data(),
+            std::as_const(copy).elements().data());
+  EXPECT_EQ(tree, copy);
+
+  // Mutating the copy must not affect the original.
+  copy.Set({1}, 42);
+  EXPECT_FALSE(tree.IsShared());
+  EXPECT_FALSE(copy.IsShared());
+  EXPECT_THAT(std::as_const(tree).elements(), ElementsAre(1, 2, 3));
+  EXPECT_THAT(std::as_const(copy).elements(), ElementsAre(1, 42, 3));
+  EXPECT_NE(tree, copy);
+
+  // Trees with a single leaf are stored inline and never shared.
+  LeafTypeTree<int64_t> single(AsType("bits[8]"), {7});
+  LeafTypeTree<int64_t> single_copy = single;
+  EXPECT_FALSE(single.IsShared());
+  EXPECT_EQ(single, single_copy);
+}
+
+TEST_F(LeafTypeTreeTest, SubtreeSharesElements) {
+  LeafTypeTree<int64_t> tree(AsType("(bits[1], (bits[2], bits[3]), bits[4])"),
+                             {1, 2, 3, 4});
+
+  LeafTypeTree<int64_t> subtree = tree.Subtree({1});
+  EXPECT_EQ(subtree.type()->ToString(), "(bits[2], bits[3])");
+  EXPECT_EQ(subtree.size(), 2);
+  EXPECT_TRUE(subtree.IsShared());
+  EXPECT_EQ(std::as_const(subtree).elements().data(),
+            std::as_const(tree).elements().data() + 1);
+  EXPECT_THAT(std::as_const(subtree).elements(), ElementsAre(2, 3));
+  EXPECT_THAT(AsStrings(subtree.leaf_types()),
+              ElementsAre("bits[2]", "bits[3]"));
+  EXPECT_EQ(subtree.Get({1}), 3);
+  EXPECT_EQ(subtree.AsView(), tree.AsView({1}));
+
+  // Subtrees of subtrees share the same storage.
+  LeafTypeTree<int64_t> leaf = subtree.Subtree({0});
+  EXPECT_EQ(leaf.type()->ToString(), "bits[2]");
+  EXPECT_THAT(std::as_const(leaf).elements(), ElementsAre(2));
+
+  subtree.Set({0}, 20);
+  EXPECT_THAT(std::as_const(subtree).elements(), ElementsAre(20, 3));
+  EXPECT_THAT(std::as_const(tree).elements(), ElementsAre(1, 2, 3, 4));
+  EXPECT_THAT(AsStrings(subtree.leaf_types()),
+              ElementsAre("bits[2]", "bits[3]"));
+
+  tree.Set({2}, 40);
+  EXPECT_THAT(std::as_const(tree).elements(), ElementsAre(1, 2, 3, 40));
+  EXPECT_EQ(tree.Subtree({}), tree);
+}
+
 TEST_F(LeafTypeTreeTest, ForEachTest) {
   std::string result;
   auto append_to_result = [&result](Type* type, int64_t data,
@@ -0,0 +1,132 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/maximum_clique.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
+
+namespace xls {
+namespace {
+
+int64_t PopCount(const InlineBitmap& bitmap) {
+  int64_t count = 0;
+  for (int64_t i = 0; i < bitmap.word_count(); ++i) {
+    count += absl::popcount(bitmap.GetWord(i));
+  }
+  return count;
+}
+
+// Returns the number of bits set in both `a` and `b`.
+int64_t IntersectionCount(const InlineBitmap& a, const InlineBitmap& b) {
+  int64_t count = 0;
+  for (int64_t i = 0; i < a.word_count(); ++i) {
+    count += absl::popcount(a.GetWord(i) & b.GetWord(i));
+  }
+  return count;
+}
+
+// Calls `f` with the index of each bit set in `bitmap` in increasing order.
+template <typename F>
+void ForEachSetBit(const InlineBitmap& bitmap, F f) {
+  for (int64_t i = 0; i < bitmap.word_count(); ++i) {
+    uint64_t word = bitmap.GetWord(i);
+    while (word != 0) {
+      f(i * 64 + absl::countr_zero(word));
+      word &= word - 1;
+    }
+  }
+}
+
+class CliqueSearch {
+ public:
+  explicit CliqueSearch(absl::Span<const InlineBitmap> adjacency)
+      : adjacency_(adjacency.begin(), adjacency.end()) {
+    for (int64_t v = 0; v < adjacency_.size(); ++v) {
+      adjacency_[v].Set(v, false);
+    }
+  }
+
+  std::vector<int64_t> Run() {
+    std::vector<int64_t> clique;
+    Expand(clique,
+           InlineBitmap(adjacency_.size(), /*fill=*/!adjacency_.empty()));
+    std::sort(best_.begin(), best_.end());
+    return best_;
+  }
+
+ private:
+  // Extends `clique` with vertices from `candidates`, all of which are adjacent
+  // to every vertex of `clique`, recording the largest clique found in `best_`.
+  void Expand(std::vector<int64_t>& clique, InlineBitmap candidates) {
+    int64_t candidate_count = PopCount(candidates);
+    if (candidate_count == 0) {
+      if (clique.size() > best_.size()) {
+        best_ = clique;
+      }
+      return;
+    }
+    if (clique.size() + candidate_count <= best_.size()) {
+      return;
+    }
+
+    // Any maximal clique contains the pivot or one of its non-neighbors, so
+    // only those need to be tried. The pivot with the most neighbors among the
+    // candidates leaves the fewest branches.
+    int64_t pivot = -1;
+    int64_t pivot_degree = -1;
+    ForEachSetBit(candidates, [&](int64_t u) {
+      int64_t degree = IntersectionCount(candidates, adjacency_[u]);
+      if (degree > pivot_degree) {
+        pivot = u;
+        pivot_degree = degree;
+      }
+    });
+    InlineBitmap branches = candidates;
+    for (int64_t i = 0; i < branches.word_count(); ++i) {
+      branches.SetWord(i,
+                       branches.GetWord(i) & ~adjacency_[pivot].GetWord(i));
+    }
+
+    ForEachSetBit(branches, [&](int64_t v) {
+      if (clique.size() + candidate_count <= best_.size()) {
+        return;
+      }
+      InlineBitmap next = candidates;
+      next.Intersect(adjacency_[v]);
+      clique.push_back(v);
+      Expand(clique, std::move(next));
+      clique.pop_back();
+      candidates.Set(v, false);
+      --candidate_count;
+    });
+  }
+
+  std::vector<InlineBitmap> adjacency_;
+  std::vector<int64_t> best_;
+};
+
+}  // namespace
+
+std::vector<int64_t> MaximumClique(absl::Span<const InlineBitmap> adjacency) {
+  return CliqueSearch(adjacency).Run();
+}
+
+}  // namespace xls
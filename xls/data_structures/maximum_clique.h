@@ -15,16 +15,20 @@
 #ifndef XLS_DATA_STRUCTURES_MAXIMUM_CLIQUE_H_
 #define XLS_DATA_STRUCTURES_MAXIMUM_CLIQUE_H_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "ortools/linear_solver/linear_solver.h"
 
 namespace xls {
@@ -94,6 +98,16 @@ absl::StatusOr<absl::btree_set<V, Compare>> MaximumClique(
   return result;
 }
 
+// Compute a maximum clique in the graph whose vertices are the integers [0, n)
+// given as an adjacency matrix: `adjacency[v]` has n bits and bit u is set iff
+// u is a neighbor of v. The matrix must be symmetric; self-loops are ignored.
+// Returns the vertices of the clique in increasing order.
+//
+// This is a branch-and-bound Bron-Kerbosch search with pivoting in which the
+// candidate sets are bitmaps, so unlike the ILP above it copes with graphs of
+// several hundred vertices.
+std::vector<int64_t> MaximumClique(absl::Span<const InlineBitmap> adjacency);
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_MAXIMUM_CLIQUE_H_
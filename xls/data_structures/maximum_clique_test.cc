@@ -14,6 +14,7 @@
 
 #include "xls/data_structures/maximum_clique.h"
 
+#include <cstdint>
 #include <functional>
 #include <random>
 #include <string>
@@ -24,6 +25,10 @@
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
 #include "absl/random/distributions.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "benchmark/benchmark.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 namespace {
@@ -66,6 +71,21 @@ absl::btree_set<V> CliqueFromMap(const Graph& neighborhood) {
       .value();
 }
 
+std::vector<InlineBitmap> BitmapFromMap(const Graph& neighborhood,
+                                        absl::Span<const V> nodes) {
+  Graph symmetric_neighborhood = Symmetrize(neighborhood);
+  std::vector<InlineBitmap> adjacency(nodes.size(),
+                                      InlineBitmap(nodes.size()));
+  for (int64_t x = 0; x < nodes.size(); ++x) {
+    for (int64_t y = 0; y < nodes.size(); ++y) {
+      if (symmetric_neighborhood[nodes[x]].contains(nodes[y])) {
+        adjacency[x].Set(y);
+      }
+    }
+  }
+  return adjacency;
+}
+
 bool IsValidClique(const absl::btree_map<V, absl::btree_set<V>>& neighborhood,
                    const absl::btree_set<V>& clique) {
   Graph symmetric_neighborhood = Symmetrize(neighborhood);
@@ -154,7 +174,83 @@ TEST(MaximumCliqueTest, Big) {
   absl::btree_set<V> clique = CliqueFromMap(graph);
   EXPECT_EQ(clique.size(), 16);
   EXPECT_TRUE(IsValidClique(graph, clique));
+
+  EXPECT_EQ(MaximumClique(BitmapFromMap(graph, nodes)).size(), 16);
+}
+
+std::vector<InlineBitmap> RandomGraph(int64_t vertex_count,
+                                      double edge_probability,
+                                      std::mt19937_64& bit_gen) {
+  std::vector<InlineBitmap> adjacency(vertex_count,
+                                      InlineBitmap(vertex_count));
+  for (int64_t x = 0; x < vertex_count; ++x) {
+    for (int64_t y = x + 1; y < vertex_count; ++y) {
+      if (absl::Bernoulli(bit_gen, edge_probability)) {
+        adjacency[x].Set(y);
+        adjacency[y].Set(x);
+      }
+    }
+  }
+  return adjacency;
+}
+
+bool IsValidBitmapClique(absl::Span<const InlineBitmap> adjacency,
+                         absl::Span<const int64_t> clique) {
+  for (int64_t x : clique) {
+    for (int64_t y : clique) {
+      if (x != y && !adjacency[x].Get(y)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Returns the size of the maximum clique by trying every subset.
+int64_t BruteForceMaximumCliqueSize(absl::Span<const InlineBitmap> adjacency) {
+  int64_t largest = 0;
+  for (uint64_t subset = 0; subset < (uint64_t{1} << adjacency.size());
+       ++subset) {
+    std::vector<int64_t> clique;
+    for (int64_t v = 0; v < adjacency.size(); ++v) {
+      if ((subset >> v) & 1) {
+        clique.push_back(v);
+      }
+    }
+    if (clique.size() > largest && IsValidBitmapClique(adjacency, clique)) {
+      largest = clique.size();
+    }
+  }
+  return largest;
+}
+
+TEST(MaximumCliqueTest, Bitmap) {
+  EXPECT_TRUE(MaximumClique(std::vector<InlineBitmap>()).empty());
+  // A single vertex with a self-loop.
+  EXPECT_EQ(MaximumClique({InlineBitmap(1, /*fill=*/true)}),
+            std::vector<int64_t>{0});
+
+  std::mt19937_64 bit_gen;
+  for (double edge_probability : {0.1, 0.5, 0.9}) {
+    for (int64_t vertex_count : {2, 7, 14}) {
+      std::vector<InlineBitmap> graph =
+          RandomGraph(vertex_count, edge_probability, bit_gen);
+      std::vector<int64_t> clique = MaximumClique(graph);
+      EXPECT_TRUE(IsValidBitmapClique(graph, clique));
+      EXPECT_EQ(clique.size(), BruteForceMaximumCliqueSize(graph));
+    }
+  }
+}
+
+// Dense random graphs are the hard case for clique search.
+void BM_BitmapMaximumClique(benchmark::State& state) {
+  std::mt19937_64 bit_gen;
+  std::vector<InlineBitmap> graph = RandomGraph(state.range(0), 0.5, bit_gen);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(MaximumClique(graph));
+  }
 }
+BENCHMARK(BM_BitmapMaximumClique)->Arg(50)->Arg(100)->Arg(200);
 
 }  // namespace
 }  // namespace xls
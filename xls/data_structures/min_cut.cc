@@ -15,6 +15,7 @@
 #include "xls/data_structures/min_cut.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <deque>
 #include <limits>
 #include <set>
@@ -22,7 +23,7 @@
 #include <utility>
 #include <vector>
 
-#include "absl/container/flat_hash_set.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/strings/str_cat.h"
@@ -272,9 +273,11 @@ int64_t AugmentFlow(const Graph& graph, NodeId source, NodeId sink,
   return 0;
 }
 
-}  // namespace
-
-GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink) {
+// Computes a maximum flow with the augmenting path algorithm and returns the
+// set of nodes reachable from the source in the residual graph, indexed by
+// NodeId.
+std::vector<bool> AugmentingPathSourcePartition(const Graph& graph,
+                                                NodeId source, NodeId sink) {
   // This loop is the core of the Ford-Fulkerson method. Starting with zero flow
   // on all edges, flow is increased along a path from source to sink with
   // residual capacity (called an augmenting path). When no further augmenting
@@ -286,34 +289,249 @@ GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink) {
 
   // Once a maximum flow is found, walk the residual graph from the source. All
   // reachable nodes form one partition.
-  absl::flat_hash_set<NodeId> reachable_from_source;
+  std::vector<bool> reachable_from_source(graph.node_count(), false);
   std::deque<NodeId> frontier = {source};
-  reachable_from_source.insert(source);
+  reachable_from_source[int64_t{source}] = true;
   while (!frontier.empty()) {
     NodeId node = frontier.front();
     frontier.pop_front();
     for (EdgeId successor_edge_id : residual_graph.successors(node)) {
       const ResidualEdge& edge = residual_graph.edge(successor_edge_id);
-      if (edge.capacity > 0 && !reachable_from_source.contains(edge.to)) {
-        reachable_from_source.insert(edge.to);
+      if (edge.capacity > 0 && !reachable_from_source[int64_t{edge.to}]) {
+        reachable_from_source[int64_t{edge.to}] = true;
         frontier.push_back(edge.to);
       }
     }
   }
-  CHECK(!reachable_from_source.contains(sink));
+  return reachable_from_source;
+}
+
+// A residual graph stored in compressed sparse row form for the push-relabel
+// algorithm. Each edge in the original graph corresponds to a forward arc with
+// the capacity of the edge and a reverse arc with zero capacity. The arcs
+// leaving node v are [arc_begin(v), arc_end(v)), and arc indices are
+// unrelated to EdgeIds.
+class CsrResidualGraph {
+ public:
+  CsrResidualGraph(const Graph& graph, int64_t capacity_limit)
+      : arc_begin_(graph.node_count() + 1, 0),
+        head_(2 * graph.edge_count()),
+        capacity_(2 * graph.edge_count()),
+        reverse_(2 * graph.edge_count()) {
+    for (EdgeId edge_id = EdgeId{0}; edge_id <= graph.max_edge_id();
+         ++edge_id) {
+      const Edge& edge = graph.edge(edge_id);
+      ++arc_begin_[int64_t{edge.from} + 1];
+      ++arc_begin_[int64_t{edge.to} + 1];
+    }
+    for (int64_t v = 0; v < graph.node_count(); ++v) {
+      arc_begin_[v + 1] += arc_begin_[v];
+    }
+    std::vector<int32_t> next_arc(arc_begin_.begin(), arc_begin_.end() - 1);
+    for (EdgeId edge_id = EdgeId{0}; edge_id <= graph.max_edge_id();
+         ++edge_id) {
+      const Edge& edge = graph.edge(edge_id);
+      int32_t forward = next_arc[int64_t{edge.from}]++;
+      int32_t backward = next_arc[int64_t{edge.to}]++;
+      head_[forward] = int64_t{edge.to};
+      capacity_[forward] = std::min(edge.weight, capacity_limit);
+      reverse_[forward] = backward;
+      head_[backward] = int64_t{edge.from};
+      capacity_[backward] = 0;
+      reverse_[backward] = forward;
+    }
+  }
+
+  int32_t node_count() const { return arc_begin_.size() - 1; }
+  int32_t arc_begin(int32_t node) const { return arc_begin_[node]; }
+  int32_t arc_end(int32_t node) const { return arc_begin_[node + 1]; }
+  int32_t head(int32_t arc) const { return head_[arc]; }
+  int32_t reverse(int32_t arc) const { return reverse_[arc]; }
+  int64_t capacity(int32_t arc) const { return capacity_[arc]; }
+
+  void PushFlow(int64_t amount, int32_t arc) {
+    DCHECK_GE(capacity_[arc], amount);
+    capacity_[arc] -= amount;
+    capacity_[reverse_[arc]] += amount;
+  }
+
+ private:
+  std::vector<int32_t> arc_begin_;
+  std::vector<int32_t> head_;
+  std::vector<int64_t> capacity_;
+  std::vector<int32_t> reverse_;
+};
+
+// Returns the value above which edge weights are clamped by the push-relabel
+// algorithm. Edges of weight std::numeric_limits<int64_t>::max() are used to
+// forbid cutting an edge. Clamping them to one more than the sum of all other
+// weights does not change the minimum cut (any finite cut is cheaper) but
+// avoids overflow when summing flow into a node. The limit is also bounded such
+// that the sum of all capacities cannot overflow.
+int64_t PushRelabelCapacityLimit(const Graph& graph) {
+  const int64_t kMaxLimit = std::numeric_limits<int64_t>::max() /
+                            std::max(int64_t{1}, 2 * graph.edge_count());
+  int64_t sum = 1;
+  for (EdgeId edge_id = EdgeId{0}; edge_id <= graph.max_edge_id(); ++edge_id) {
+    int64_t weight = graph.edge(edge_id).weight;
+    if (weight == std::numeric_limits<int64_t>::max()) {
+      continue;
+    }
+    sum += std::min(weight, kMaxLimit);
+    if (sum >= kMaxLimit) {
+      return kMaxLimit;
+    }
+  }
+  return sum;
+}
+
+// Computes a maximum flow with the FIFO push-relabel algorithm and returns the
+// set of nodes reachable from the source in the residual graph, indexed by
+// NodeId.
+std::vector<bool> PushRelabelSourcePartition(const Graph& graph, NodeId source,
+                                             NodeId sink) {
+  CsrResidualGraph residual_graph(graph, PushRelabelCapacityLimit(graph));
+  const int32_t n = residual_graph.node_count();
+  const int32_t s = int64_t{source};
+  const int32_t t = int64_t{sink};
+
+  std::vector<int64_t> excess(n, 0);
+  std::vector<int32_t> label(n, 0);
+  std::vector<int32_t> current_arc(n);
+  std::vector<bool> is_active(n, false);
+  std::deque<int32_t> active;
+  auto activate = [&](int32_t node) {
+    if (node != s && node != t && !is_active[node]) {
+      is_active[node] = true;
+      active.push_back(node);
+    }
+  };
+
+  // Sets each label to the exact residual distance to the sink, or for nodes
+  // which cannot reach the sink, n plus the residual distance to the source.
+  // Nodes which can reach neither never hold excess and are labeled 2n.
+  std::vector<int32_t> bfs_queue;
+  bfs_queue.reserve(n);
+  auto global_relabel = [&]() {
+    std::fill(label.begin(), label.end(), 2 * n);
+    for (int32_t root : {t, s}) {
+      label[root] = root == t ? 0 : n;
+      bfs_queue.assign({root});
+      for (int64_t i = 0; i < bfs_queue.size(); ++i) {
+        int32_t v = bfs_queue[i];
+        for (int32_t arc = residual_graph.arc_begin(v);
+             arc < residual_graph.arc_end(v); ++arc) {
+          int32_t u = residual_graph.head(arc);
+          if (label[u] == 2 * n &&
+              residual_graph.capacity(residual_graph.reverse(arc)) > 0) {
+            label[u] = label[v] + 1;
+            bfs_queue.push_back(u);
+          }
+        }
+      }
+    }
+    for (int32_t v = 0; v < n; ++v) {
+      current_arc[v] = residual_graph.arc_begin(v);
+    }
+  };
+
+  // Saturate all arcs leaving the source.
+  for (int32_t arc = residual_graph.arc_begin(s);
+       arc < residual_graph.arc_end(s); ++arc) {
+    int64_t amount = residual_graph.capacity(arc);
+    if (amount > 0) {
+      residual_graph.PushFlow(amount, arc);
+      excess[residual_graph.head(arc)] += amount;
+      activate(residual_graph.head(arc));
+    }
+  }
+  global_relabel();
+
+  // Discharges active nodes in FIFO order. Labels are recomputed globally
+  // after every n local relabels which greatly reduces the number of pushes in
+  // practice.
+  int64_t relabels_since_global = 0;
+  while (!active.empty()) {
+    if (relabels_since_global >= n) {
+      global_relabel();
+      relabels_since_global = 0;
+    }
+    int32_t v = active.front();
+    active.pop_front();
+    is_active[v] = false;
+    while (excess[v] > 0) {
+      if (current_arc[v] == residual_graph.arc_end(v)) {
+        // No admissible arcs remain. A node with excess always has a residual
+        // arc back toward the source so a new label can be found.
+        int32_t new_label = std::numeric_limits<int32_t>::max();
+        for (int32_t arc = residual_graph.arc_begin(v);
+             arc < residual_graph.arc_end(v); ++arc) {
+          if (residual_graph.capacity(arc) > 0) {
+            new_label =
+                std::min(new_label, label[residual_graph.head(arc)] + 1);
+          }
+        }
+        CHECK_NE(new_label, std::numeric_limits<int32_t>::max());
+        label[v] = new_label;
+        current_arc[v] = residual_graph.arc_begin(v);
+        ++relabels_since_global;
+        continue;
+      }
+      int32_t arc = current_arc[v];
+      int32_t u = residual_graph.head(arc);
+      if (residual_graph.capacity(arc) > 0 && label[v] == label[u] + 1) {
+        int64_t amount = std::min(excess[v], residual_graph.capacity(arc));
+        residual_graph.PushFlow(amount, arc);
+        excess[v] -= amount;
+        excess[u] += amount;
+        activate(u);
+      } else {
+        ++current_arc[v];
+      }
+    }
+  }
+
+  // All excess has been returned to the source or delivered to the sink so the
+  // preflow is a maximum flow. Walk the residual graph from the source.
+  std::vector<bool> reachable_from_source(n, false);
+  reachable_from_source[s] = true;
+  bfs_queue.assign({s});
+  for (int64_t i = 0; i < bfs_queue.size(); ++i) {
+    int32_t v = bfs_queue[i];
+    for (int32_t arc = residual_graph.arc_begin(v);
+         arc < residual_graph.arc_end(v); ++arc) {
+      int32_t u = residual_graph.head(arc);
+      if (residual_graph.capacity(arc) > 0 && !reachable_from_source[u]) {
+        reachable_from_source[u] = true;
+        bfs_queue.push_back(u);
+      }
+    }
+  }
+  return reachable_from_source;
+}
+
+}  // namespace
+
+GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink,
+                            MaxFlowAlgorithm algorithm) {
+  std::vector<bool> reachable_from_source =
+      algorithm == MaxFlowAlgorithm::kPushRelabel
+          ? PushRelabelSourcePartition(graph, source, sink)
+          : AugmentingPathSourcePartition(graph, source, sink);
+  CHECK(!reachable_from_source[int64_t{sink}]);
 
   GraphCut min_cut;
   min_cut.weight = 0;
   for (NodeId node_id = NodeId(0); node_id <= graph.max_node_id(); ++node_id) {
-    if (reachable_from_source.contains(node_id)) {
+    if (reachable_from_source[int64_t{node_id}]) {
       min_cut.source_partition.push_back(node_id);
     } else {
       min_cut.sink_partition.push_back(node_id);
     }
     for (EdgeId edge_id : graph.successors(node_id)) {
       const Edge& edge = graph.edge(edge_id);
-      if (reachable_from_source.contains(edge.from) &&
-          !reachable_from_source.contains(edge.to)) {
+      if (reachable_from_source[int64_t{edge.from}] &&
+          !reachable_from_source[int64_t{edge.to}]) {
         min_cut.weight += edge.weight;
       }
     }
@@ -15,6 +15,7 @@
 #ifndef XLS_DATA_STRUCTURES_MIN_CUT_H_
 #define XLS_DATA_STRUCTURES_MIN_CUT_H_
 
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
@@ -95,12 +96,26 @@ struct GraphCut {
   std::string ToString(const Graph& graph) const;
 };
 
+// The algorithm used to compute the maximum flow from which a min cut is
+// derived. Both algorithms produce the same cut.
+enum class MaxFlowAlgorithm : int8_t {
+  // The Ford-Fulkerson method using shortest augmenting paths found by BFS
+  // (Edmonds-Karp). Worst case run time of O(V * E^2).
+  kAugmentingPath,
+
+  // FIFO push-relabel with periodic global relabeling on a graph stored in
+  // compressed sparse row form. Worst case run time of O(V^3) and much faster
+  // than kAugmentingPath in practice on large graphs.
+  kPushRelabel,
+};
+
 // Computes a minimum cut of the given graph where source and sink are in
 // different partitions. The cut is returned as a partitioning of the nodes of
-// the graph into two sets of nodes on either side of the cut. The min cut is
-// found via the Ford-Fulkerson method using Dinic's algorithm. This results in
-// a worst case run time of O(V^2 * E).
-GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink);
+// the graph into two sets of nodes on either side of the cut. Of all minimum
+// cuts, the one with the smallest source partition is returned.
+GraphCut MinCutBetweenNodes(
+    const Graph& graph, NodeId source, NodeId sink,
+    MaxFlowAlgorithm algorithm = MaxFlowAlgorithm::kPushRelabel);
 
 }  // namespace min_cut
 }  // namespace xls
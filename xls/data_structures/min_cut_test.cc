@@ -19,6 +19,7 @@
 #include <random>
 #include <vector>
 
+#include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
@@ -284,6 +285,46 @@ TEST(MinCutTest, LargeDirectedGraphs) {
   }
 }
 
+TEST(MinCutTest, AlgorithmsProduceSameCut) {
+  for (bool acyclic : {false, true}) {
+    for (int64_t layer_count = 5; layer_count < 20; layer_count += 2) {
+      for (int64_t nodes_in_layer = 5; nodes_in_layer < 20;
+           nodes_in_layer += 2) {
+        NodeId source;
+        NodeId sink;
+        Graph graph = MakeLargeGraph(acyclic, &source, &sink, layer_count,
+                                     nodes_in_layer);
+        GraphCut augmenting_path = MinCutBetweenNodes(
+            graph, source, sink, MaxFlowAlgorithm::kAugmentingPath);
+        GraphCut push_relabel = MinCutBetweenNodes(
+            graph, source, sink, MaxFlowAlgorithm::kPushRelabel);
+        EXPECT_EQ(augmenting_path.weight, push_relabel.weight);
+        EXPECT_EQ(augmenting_path.source_partition,
+                  push_relabel.source_partition);
+        EXPECT_EQ(augmenting_path.sink_partition, push_relabel.sink_partition);
+      }
+    }
+  }
+}
+
+TEST(MinCutTest, PushRelabelWithUnreachableSink) {
+  Graph graph;
+  auto source = graph.AddNode("source");
+  auto a = graph.AddNode("a");
+  auto b = graph.AddNode("b");
+  auto sink = graph.AddNode("sink");
+  graph.AddEdge(source, a, std::numeric_limits<int64_t>::max());
+  graph.AddEdge(a, b, 3);
+  graph.AddEdge(b, a, 5);
+  graph.AddEdge(sink, b, 1);
+
+  GraphCut min_cut =
+      MinCutBetweenNodes(graph, source, sink, MaxFlowAlgorithm::kPushRelabel);
+  EXPECT_EQ(min_cut.weight, 0);
+  EXPECT_THAT(min_cut.source_partition, UnorderedElementsAre(source, a, b));
+  EXPECT_THAT(min_cut.sink_partition, UnorderedElementsAre(sink));
+}
+
 TEST(MinCutTest, MaxFlowToMinCutTraversalTest) {
   // Test a fix for b/155115565 where the residual graph was not properly
   // traversed to identify the partitions after max flow was computed.
@@ -363,6 +404,52 @@ TEST(MinCutTest, ResidualGraphTraversalTest) {
   EXPECT_EQ(min_cut.weight, 2);
 }
 
+// Benchmarks computing the min cut of a layered graph resembling those built
+// by the min-cut scheduler: each edge has an opposing edge of maximum weight.
+void BM_MinCut(benchmark::State& state, MaxFlowAlgorithm algorithm) {
+  const int64_t layer_count = state.range(0);
+  const int64_t nodes_in_layer = state.range(1);
+  const int64_t kFanOut = 3;
+  constexpr int64_t kMaxWeight = std::numeric_limits<int64_t>::max();
+  Graph graph;
+  NodeId source = graph.AddNode("source");
+  NodeId sink = graph.AddNode("sink");
+  std::vector<std::vector<NodeId>> layers(layer_count);
+  for (std::vector<NodeId>& layer : layers) {
+    for (int64_t j = 0; j < nodes_in_layer; ++j) {
+      layer.push_back(graph.AddNode());
+    }
+  }
+  for (NodeId node : layers.front()) {
+    graph.AddEdge(source, node, kMaxWeight);
+  }
+  std::mt19937_64 bit_gen;
+  for (int64_t i = 0; i + 1 < layer_count; ++i) {
+    for (NodeId from : layers[i]) {
+      for (int64_t j = 0; j < kFanOut; ++j) {
+        NodeId to = RandomChoice(layers[i + 1], bit_gen);
+        graph.AddEdge(from, to,
+                      absl::Uniform(absl::IntervalClosed, bit_gen, 1, 100));
+        graph.AddEdge(to, from, kMaxWeight);
+      }
+    }
+  }
+  for (NodeId node : layers.back()) {
+    graph.AddEdge(node, sink, kMaxWeight);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        MinCutBetweenNodes(graph, source, sink, algorithm));
+  }
+}
+BENCHMARK_CAPTURE(BM_MinCut, augmenting_path, MaxFlowAlgorithm::kAugmentingPath)
+    ->ArgPair(10, 100)
+    ->ArgPair(50, 200);
+BENCHMARK_CAPTURE(BM_MinCut, push_relabel, MaxFlowAlgorithm::kPushRelabel)
+    ->ArgPair(10, 100)
+    ->ArgPair(50, 200)
+    ->ArgPair(200, 500);
+
 }  // namespace
 }  // namespace min_cut
 }  // namespace xls
@@ -14,7 +14,9 @@
 
 #include "xls/data_structures/transitive_closure.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -43,5 +45,70 @@ TEST(TransitiveClosureTest, Simple) {
   EXPECT_FALSE(tc.contains("qux"));
 }
 
+TEST(TransitiveClosureTest, Cycle) {
+  HashRelation<V> rel;
+  rel["a"].insert("b");
+  rel["b"].insert("a");
+  HashRelation<V> tc = TransitiveClosure<V>(rel);
+  EXPECT_THAT(tc.at("a"), UnorderedElementsAre("a", "b"));
+  EXPECT_THAT(tc.at("b"), UnorderedElementsAre("a", "b"));
+}
+
+TEST(DagTransitiveClosureTest, Diamond) {
+  // 0 -> 1 -> 3, 0 -> 2 -> 3, 4 is disconnected.
+  std::vector<std::vector<int64_t>> predecessors = {{}, {0}, {0}, {1, 2}, {}};
+  DagTransitiveClosure tc = DagTransitiveClosure::Create(
+      predecessors.size(), [&](int64_t i) { return predecessors[i]; });
+  EXPECT_EQ(tc.node_count(), 5);
+  EXPECT_TRUE(tc.IsReachable(0, 1));
+  EXPECT_TRUE(tc.IsReachable(0, 2));
+  EXPECT_TRUE(tc.IsReachable(0, 3));
+  EXPECT_TRUE(tc.IsReachable(1, 3));
+  EXPECT_TRUE(tc.IsReachable(2, 3));
+  EXPECT_FALSE(tc.IsReachable(1, 2));
+  EXPECT_FALSE(tc.IsReachable(3, 0));
+  EXPECT_FALSE(tc.IsReachable(0, 0));
+  EXPECT_FALSE(tc.IsReachable(0, 4));
+  EXPECT_FALSE(tc.IsReachable(4, 3));
+}
+
+TEST(DagTransitiveClosureTest, Sources) {
+  // A chain 0 -> 1 -> 2 -> 3 tracking reachability only from 1 and 3.
+  std::vector<int64_t> sources = {3, 1};
+  DagTransitiveClosure tc =
+      DagTransitiveClosure::Create(4, sources, [](int64_t i) {
+        return i == 0 ? std::vector<int64_t>() : std::vector<int64_t>{i - 1};
+      });
+  EXPECT_FALSE(tc.IsSource(0));
+  EXPECT_TRUE(tc.IsSource(1));
+  EXPECT_FALSE(tc.IsSource(2));
+  EXPECT_TRUE(tc.IsSource(3));
+  EXPECT_FALSE(tc.IsReachable(1, 0));
+  EXPECT_FALSE(tc.IsReachable(1, 1));
+  EXPECT_TRUE(tc.IsReachable(1, 2));
+  EXPECT_TRUE(tc.IsReachable(1, 3));
+  EXPECT_FALSE(tc.IsReachable(3, 0));
+  EXPECT_FALSE(tc.IsReachable(3, 3));
+}
+
+TEST(DagTransitiveClosureTest, WideGraph) {
+  // Many sources feeding a single sink, spanning several words per row.
+  constexpr int64_t kWidth = 200;
+  DagTransitiveClosure tc =
+      DagTransitiveClosure::Create(kWidth + 1, [&](int64_t i) {
+        std::vector<int64_t> predecessors;
+        if (i == kWidth) {
+          for (int64_t j = 0; j < kWidth; ++j) {
+            predecessors.push_back(j);
+          }
+        }
+        return predecessors;
+      });
+  for (int64_t i = 0; i < kWidth; ++i) {
+    EXPECT_TRUE(tc.IsReachable(i, kWidth));
+    EXPECT_FALSE(tc.IsReachable(i, (i + 1) % kWidth));
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -73,6 +73,78 @@ class UnionFind {
   UnionFindMap<T, absl::monostate> union_find_map_;
 };
 
+// A union-find data structure over the integers [0, size()), for elements
+// which already have dense indices. Parents and ranks are held in contiguous
+// vectors so, unlike UnionFind, no operation hashes.
+//
+// Size is limited to roughly 2^32 elements, so that the parents can be 32 bits
+// rather than 64.
+class DenseUnionFind {
+ public:
+  // Creates the union-find with elements [0, size), each in its own
+  // equivalence class.
+  explicit DenseUnionFind(int64_t size = 0) {
+    parents_.reserve(size);
+    ranks_.reserve(size);
+    for (int64_t i = 0; i < size; ++i) {
+      Add();
+    }
+  }
+
+  // Adds a new element in its own equivalence class and returns it.
+  int64_t Add() {
+    int64_t element = parents_.size();
+    parents_.push_back(element);
+    ranks_.push_back(0);
+    ++class_count_;
+    return element;
+  }
+
+  // Union together the equivalence classes of two elements. Returns true if
+  // they were in different classes.
+  bool Union(int64_t x, int64_t y) {
+    uint32_t x_root = Find(x);
+    uint32_t y_root = Find(y);
+    if (x_root == y_root) {
+      return false;
+    }
+    if (ranks_[x_root] < ranks_[y_root]) {
+      std::swap(x_root, y_root);
+    }
+    parents_[y_root] = x_root;
+    if (ranks_[x_root] == ranks_[y_root]) {
+      ++ranks_[x_root];
+    }
+    --class_count_;
+    return true;
+  }
+
+  // Returns the representative element in the given element's equivalence
+  // class. Uses the path-halving algorithm.
+  int64_t Find(int64_t element) {
+    DCHECK_GE(element, 0);
+    DCHECK_LT(element, size());
+    uint32_t x = element;
+    while (parents_[x] != x) {
+      parents_[x] = parents_[parents_[x]];
+      x = parents_[x];
+    }
+    return x;
+  }
+
+  // Returns the number of elements in the data structure.
+  int64_t size() const { return parents_.size(); }
+
+  // Returns the number of equivalence classes.
+  int64_t class_count() const { return class_count_; }
+
+ private:
+  std::vector<uint32_t> parents_;
+  // Ranks are bounded by log2 of the number of elements.
+  std::vector<uint8_t> ranks_;
+  int64_t class_count_ = 0;
+};
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_UNION_FIND_H_
@@ -14,14 +14,23 @@
 
 #include "xls/delay_model/analyze_critical_path.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <numeric>
 #include <optional>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/function.h"
@@ -112,6 +121,173 @@ absl::StatusOr<std::vector<CriticalPathEntry>> AnalyzeCriticalPath(
   return std::move(critical_path);
 }
 
+/* static */ absl::StatusOr<std::unique_ptr<IncrementalCriticalPath>>
+IncrementalCriticalPath::Create(FunctionBase* f,
+                                const DelayEstimator& delay_estimator) {
+  std::unique_ptr<IncrementalCriticalPath> analysis(
+      new IncrementalCriticalPath());
+  analysis->topo_sort_ = TopoSort(f);
+  int64_t node_count = analysis->topo_sort_.size();
+  analysis->delay_ps_.resize(node_count);
+  analysis->stage_.resize(node_count, 0);
+  analysis->arrival_ps_.resize(node_count, 0);
+  analysis->predecessor_.resize(node_count, -1);
+  std::set<ArrivalKey>& arrivals = analysis->stage_arrivals_[0];
+  for (int64_t i = 0; i < node_count; ++i) {
+    Node* node = analysis->topo_sort_[i];
+    analysis->index_[node] = i;
+    XLS_ASSIGN_OR_RETURN(analysis->delay_ps_[i],
+                         delay_estimator.GetOperationDelayInPs(node));
+    arrivals.insert({0, i});
+  }
+  std::vector<int64_t> all_nodes(node_count);
+  std::iota(all_nodes.begin(), all_nodes.end(), 0);
+  analysis->Propagate(all_nodes, /*changed=*/{});
+  return std::move(analysis);
+}
+
+absl::StatusOr<int64_t> IncrementalCriticalPath::GetIndex(Node* node) const {
+  auto it = index_.find(node);
+  XLS_RET_CHECK(it != index_.end())
+      << node->GetName() << " is not a node of the analyzed function";
+  return it->second;
+}
+
+absl::Status IncrementalCriticalPath::SetNodeDelay(Node* node,
+                                                   int64_t delay_ps) {
+  XLS_ASSIGN_OR_RETURN(int64_t index, GetIndex(node));
+  if (delay_ps_[index] != delay_ps) {
+    delay_ps_[index] = delay_ps;
+    Propagate({index}, /*changed=*/{});
+  }
+  return absl::OkStatus();
+}
+
+absl::Status IncrementalCriticalPath::SetNodeStage(Node* node, int64_t stage) {
+  return SetNodeStages({{node, stage}});
+}
+
+absl::Status IncrementalCriticalPath::SetNodeStages(
+    const absl::flat_hash_map<Node*, int64_t>& stages) {
+  std::vector<int64_t> changed;
+  for (const auto& [node, stage] : stages) {
+    XLS_ASSIGN_OR_RETURN(int64_t index, GetIndex(node));
+    if (stage_[index] == stage) {
+      continue;
+    }
+    auto old_arrivals = stage_arrivals_.find(stage_[index]);
+    old_arrivals->second.erase({arrival_ps_[index], index});
+    if (old_arrivals->second.empty()) {
+      stage_arrivals_.erase(old_arrivals);
+    }
+    stage_[index] = stage;
+    stage_arrivals_[stage].insert({arrival_ps_[index], index});
+    changed.push_back(index);
+  }
+  Propagate(changed, changed);
+  return absl::OkStatus();
+}
+
+void IncrementalCriticalPath::Propagate(absl::Span<const int64_t> seeds,
+                                        absl::Span<const int64_t> changed) {
+  // Users always have a larger topological index than their operands so
+  // processing the worklist in index order computes each node at most once.
+  std::set<int64_t> worklist(seeds.begin(), seeds.end());
+  auto add_users = [&](int64_t index, bool same_stage_only) {
+    for (Node* user : topo_sort_[index]->users()) {
+      int64_t user_index = index_.at(user);
+      if (!same_stage_only || stage_[user_index] == stage_[index]) {
+        worklist.insert(user_index);
+      }
+    }
+  };
+  for (int64_t index : changed) {
+    add_users(index, /*same_stage_only=*/false);
+  }
+  while (!worklist.empty()) {
+    int64_t index = *worklist.begin();
+    worklist.erase(worklist.begin());
+    if (Recompute(index)) {
+      add_users(index, /*same_stage_only=*/true);
+    }
+  }
+}
+
+bool IncrementalCriticalPath::Recompute(int64_t index) {
+  ++recomputed_node_count_;
+  // As in AnalyzeCriticalPath, ties are broken in favor of the last operand.
+  int64_t max_path_delay = 0;
+  int64_t predecessor = -1;
+  for (Node* operand : topo_sort_[index]->operands()) {
+    int64_t operand_index = index_.at(operand);
+    if (stage_[operand_index] != stage_[index]) {
+      continue;
+    }
+    if (arrival_ps_[operand_index] >= max_path_delay) {
+      max_path_delay = arrival_ps_[operand_index];
+      predecessor = operand_index;
+    }
+  }
+  predecessor_[index] = predecessor;
+  int64_t arrival_ps = max_path_delay + delay_ps_[index];
+  if (arrival_ps == arrival_ps_[index]) {
+    return false;
+  }
+  std::set<ArrivalKey>& arrivals = stage_arrivals_.at(stage_[index]);
+  arrivals.erase({arrival_ps_[index], index});
+  arrival_ps_[index] = arrival_ps;
+  arrivals.insert({arrival_ps, index});
+  return true;
+}
+
+int64_t IncrementalCriticalPath::CriticalPathDelay() const {
+  int64_t delay = 0;
+  for (const auto& [stage, arrivals] : stage_arrivals_) {
+    delay = std::max(delay, arrivals.rbegin()->first);
+  }
+  return delay;
+}
+
+int64_t IncrementalCriticalPath::CriticalPathDelay(int64_t stage) const {
+  auto it = stage_arrivals_.find(stage);
+  return it == stage_arrivals_.end() ? 0 : it->second.rbegin()->first;
+}
+
+std::vector<CriticalPathEntry> IncrementalCriticalPath::CriticalPath() const {
+  std::optional<ArrivalKey> latest;
+  for (const auto& [stage, arrivals] : stage_arrivals_) {
+    if (!latest.has_value() || *latest < *arrivals.rbegin()) {
+      latest = *arrivals.rbegin();
+    }
+  }
+  if (!latest.has_value()) {
+    return {};
+  }
+  return PathEndingAt(latest->second);
+}
+
+std::vector<CriticalPathEntry> IncrementalCriticalPath::CriticalPath(
+    int64_t stage) const {
+  auto it = stage_arrivals_.find(stage);
+  if (it == stage_arrivals_.end()) {
+    return {};
+  }
+  return PathEndingAt(it->second.rbegin()->second);
+}
+
+std::vector<CriticalPathEntry> IncrementalCriticalPath::PathEndingAt(
+    int64_t index) const {
+  std::vector<CriticalPathEntry> critical_path;
+  for (; index != -1; index = predecessor_[index]) {
+    critical_path.push_back(
+        CriticalPathEntry{.node = topo_sort_[index],
+                          .node_delay_ps = delay_ps_[index],
+                          .path_delay_ps = arrival_ps_[index],
+                          .delayed_by_cycle_boundary = false});
+  }
+  return critical_path;
+}
+
 std::string CriticalPathToString(
     absl::Span<const CriticalPathEntry> critical_path,
     std::optional<std::function<std::string(Node*)>> extra_info) {
@@ -17,11 +17,17 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
@@ -60,6 +66,98 @@ absl::StatusOr<std::vector<CriticalPathEntry>> AnalyzeCriticalPath(
     FunctionBase* f, std::optional<int64_t> clock_period_ps,
     const DelayEstimator& delay_estimator);
 
+// Maintains the critical path through a function or proc as node delays and
+// pipeline stage assignments change. Each node is assigned to a stage
+// (initially all nodes are in stage 0) and paths only run between nodes in the
+// same stage; an operand in a different stage is a register output available
+// at time zero.
+//
+// The arrival time of each node (the critical-path delay up to and including
+// the node) is stored along with, for each stage, the nodes ordered by arrival
+// time. When a node's delay or stage changes only the nodes in its fan-out
+// cone whose arrival times actually change are recomputed, in topological
+// order.
+//
+// With all nodes in a single stage, CriticalPath() returns the same path as
+// AnalyzeCriticalPath without a clock period. The function must not be
+// modified while the analysis is in use.
+class IncrementalCriticalPath {
+ public:
+  // Creates an analysis of `f` using `delay_estimator` for the initial node
+  // delays. All nodes are placed in stage 0.
+  static absl::StatusOr<std::unique_ptr<IncrementalCriticalPath>> Create(
+      FunctionBase* f, const DelayEstimator& delay_estimator);
+
+  // Sets the delay of `node` and updates the arrival times of its fan-out.
+  absl::Status SetNodeDelay(Node* node, int64_t delay_ps);
+
+  // Sets the stage of `node` and updates the arrival times of it and its
+  // fan-out.
+  absl::Status SetNodeStage(Node* node, int64_t stage);
+
+  // Sets the stages of multiple nodes at once, e.g., from a pipeline schedule.
+  // The update is performed in a single pass over the affected nodes.
+  absl::Status SetNodeStages(
+      const absl::flat_hash_map<Node*, int64_t>& stages);
+
+  int64_t node_delay_ps(Node* node) const {
+    return delay_ps_[index_.at(node)];
+  }
+  int64_t stage(Node* node) const { return stage_[index_.at(node)]; }
+
+  // Returns the delay of the critical path ending at `node`, including the
+  // delay of `node` itself.
+  int64_t arrival_time_ps(Node* node) const {
+    return arrival_ps_[index_.at(node)];
+  }
+
+  // Returns the delay of the critical path through all stages or through the
+  // given stage. Returns zero if there are no such nodes.
+  int64_t CriticalPathDelay() const;
+  int64_t CriticalPathDelay(int64_t stage) const;
+
+  // Returns the critical path through all stages or through the given stage in
+  // the same form as AnalyzeCriticalPath: the last node on the path is at the
+  // front of the returned vector.
+  std::vector<CriticalPathEntry> CriticalPath() const;
+  std::vector<CriticalPathEntry> CriticalPath(int64_t stage) const;
+
+  // Returns the total number of node arrival times computed so far, including
+  // during construction. Useful for measuring the cost of updates.
+  int64_t recomputed_node_count() const { return recomputed_node_count_; }
+
+ private:
+  // Arrival time and topological index of a node; ordered by arrival time with
+  // ties broken in favor of the later node in topological order.
+  using ArrivalKey = std::pair<int64_t, int64_t>;
+
+  IncrementalCriticalPath() = default;
+
+  absl::StatusOr<int64_t> GetIndex(Node* node) const;
+
+  // Recomputes the arrival times of the nodes with the given topological
+  // indices and, transitively, of the users of any node whose arrival time
+  // changes. The users of the nodes in `changed` are always recomputed.
+  void Propagate(absl::Span<const int64_t> seeds,
+                 absl::Span<const int64_t> changed);
+
+  // Recomputes the arrival time of the node with the given index. Returns
+  // whether it changed.
+  bool Recompute(int64_t index);
+
+  std::vector<CriticalPathEntry> PathEndingAt(int64_t index) const;
+
+  std::vector<Node*> topo_sort_;
+  absl::flat_hash_map<Node*, int64_t> index_;
+  std::vector<int64_t> delay_ps_;
+  std::vector<int64_t> stage_;
+  std::vector<int64_t> arrival_ps_;
+  // Index of the predecessor on the critical path to each node, or -1.
+  std::vector<int64_t> predecessor_;
+  absl::flat_hash_map<int64_t, std::set<ArrivalKey>> stage_arrivals_;
+  int64_t recomputed_node_count_ = 0;
+};
+
 // Returns a string representation of the critical-path. Includes delay
 // information for each node as well as cumulative delay.
 //
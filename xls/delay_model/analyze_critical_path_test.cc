@@ -14,10 +14,16 @@
 
 #include "xls/delay_model/analyze_critical_path.h"
 
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/delay_model/delay_estimators.h"
@@ -31,6 +37,10 @@
 namespace xls {
 namespace {
 
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
 class AnalyzeCriticalPathTest : public IrTestBase {
  protected:
   const DelayEstimator* delay_estimator_ = GetDelayEstimator("unit").value();
@@ -151,5 +161,129 @@ TEST_F(AnalyzeCriticalPathTest, ProcWithSendReceive) {
   EXPECT_EQ(cp[5].node, proc->TokenParam());
 }
 
+// Returns the nodes and path delays of a critical path for comparison.
+std::vector<std::pair<Node*, int64_t>> PathSummary(
+    absl::Span<const CriticalPathEntry> critical_path) {
+  std::vector<std::pair<Node*, int64_t>> summary;
+  for (const CriticalPathEntry& entry : critical_path) {
+    summary.push_back({entry.node, entry.path_delay_ps});
+  }
+  return summary;
+}
+
+TEST_F(AnalyzeCriticalPathTest, IncrementalMatchesFullAnalysis) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto neg_x = fb.Negate(x);
+  auto rev_neg_x = fb.Reverse(neg_x);
+  auto neg_y = fb.Negate(y);
+  auto sum = fb.Add(rev_neg_x, neg_y);
+  fb.UMul(sum, neg_y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<CriticalPathEntry> cp,
+      AnalyzeCriticalPath(f, /*clock_period_ps=*/std::nullopt,
+                          *delay_estimator_));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalCriticalPath> incremental,
+      IncrementalCriticalPath::Create(f, *delay_estimator_));
+  EXPECT_EQ(PathSummary(incremental->CriticalPath()), PathSummary(cp));
+  EXPECT_EQ(incremental->CriticalPathDelay(), 4);
+  EXPECT_EQ(incremental->CriticalPathDelay(/*stage=*/0), 4);
+  EXPECT_EQ(incremental->CriticalPathDelay(/*stage=*/1), 0);
+  EXPECT_TRUE(incremental->CriticalPath(/*stage=*/1).empty());
+}
+
+TEST_F(AnalyzeCriticalPathTest, IncrementalNodeDelayUpdate) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto neg_x = fb.Negate(x);
+  auto rev_neg_x = fb.Reverse(neg_x);
+  auto neg_y = fb.Negate(y);
+  auto not_y = fb.Not(neg_y);
+  auto sum = fb.Add(rev_neg_x, not_y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalCriticalPath> incremental,
+      IncrementalCriticalPath::Create(f, *delay_estimator_));
+  EXPECT_EQ(incremental->CriticalPathDelay(), 3);
+  EXPECT_EQ(incremental->CriticalPath()[1].node, not_y.node());
+
+  // Lengthening neg(x) moves the critical path onto the x side. Only neg(x)
+  // and its fan-out are recomputed.
+  int64_t count_before = incremental->recomputed_node_count();
+  XLS_ASSERT_OK(incremental->SetNodeDelay(neg_x.node(), 5));
+  EXPECT_EQ(incremental->recomputed_node_count() - count_before, 3);
+  EXPECT_EQ(incremental->arrival_time_ps(rev_neg_x.node()), 6);
+  EXPECT_EQ(incremental->arrival_time_ps(not_y.node()), 2);
+  EXPECT_EQ(incremental->CriticalPathDelay(), 7);
+  EXPECT_THAT(PathSummary(incremental->CriticalPath()),
+              ElementsAre(Pair(sum.node(), 7), Pair(rev_neg_x.node(), 6),
+                          Pair(neg_x.node(), 5), Pair(x.node(), 0)));
+
+  // A change which does not alter arrival times does not propagate past the
+  // changed node.
+  count_before = incremental->recomputed_node_count();
+  XLS_ASSERT_OK(incremental->SetNodeDelay(y.node(), 0));
+  XLS_ASSERT_OK(incremental->SetNodeDelay(neg_y.node(), 2));
+  EXPECT_EQ(incremental->recomputed_node_count() - count_before, 3);
+  EXPECT_EQ(incremental->CriticalPathDelay(), 7);
+}
+
+TEST_F(AnalyzeCriticalPathTest, IncrementalStageUpdate) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto n1 = fb.Negate(x);
+  auto n2 = fb.Negate(n1);
+  auto n3 = fb.Negate(n2);
+  auto n4 = fb.Negate(n3);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalCriticalPath> incremental,
+      IncrementalCriticalPath::Create(f, *delay_estimator_));
+  EXPECT_EQ(incremental->CriticalPathDelay(), 4);
+
+  XLS_ASSERT_OK(incremental->SetNodeStages({{n3.node(), 1}, {n4.node(), 1}}));
+  EXPECT_EQ(incremental->stage(n3.node()), 1);
+  EXPECT_EQ(incremental->CriticalPathDelay(), 2);
+  EXPECT_EQ(incremental->CriticalPathDelay(/*stage=*/0), 2);
+  EXPECT_EQ(incremental->CriticalPathDelay(/*stage=*/1), 2);
+  EXPECT_THAT(PathSummary(incremental->CriticalPath(/*stage=*/1)),
+              ElementsAre(Pair(n4.node(), 2), Pair(n3.node(), 1)));
+
+  XLS_ASSERT_OK(incremental->SetNodeStage(n2.node(), 1));
+  EXPECT_EQ(incremental->CriticalPathDelay(/*stage=*/0), 1);
+  EXPECT_EQ(incremental->CriticalPathDelay(/*stage=*/1), 3);
+  EXPECT_THAT(PathSummary(incremental->CriticalPath()),
+              ElementsAre(Pair(n4.node(), 3), Pair(n3.node(), 2),
+                          Pair(n2.node(), 1)));
+
+  // Moving everything back into one stage restores the original path.
+  XLS_ASSERT_OK(incremental->SetNodeStages(
+      {{n2.node(), 0}, {n3.node(), 0}, {n4.node(), 0}}));
+  EXPECT_EQ(incremental->CriticalPathDelay(), 4);
+  EXPECT_TRUE(incremental->CriticalPath(/*stage=*/1).empty());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<CriticalPathEntry> cp,
+      AnalyzeCriticalPath(f, /*clock_period_ps=*/std::nullopt,
+                          *delay_estimator_));
+  EXPECT_EQ(PathSummary(incremental->CriticalPath()), PathSummary(cp));
+
+  auto other = CreatePackage();
+  FunctionBuilder other_fb("other", other.get());
+  other_fb.Param("z", other->GetBitsType(1));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * other_f, other_fb.Build());
+  EXPECT_THAT(incremental->SetNodeStage(other_f->param(0), 1),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
 }  // namespace
 }  // namespace xls
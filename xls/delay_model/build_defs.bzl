@@ -67,6 +67,7 @@ def delay_model(
             "//xls/common:module_initializer",
             "@com_google_absl//absl/status:statusor",
             "//xls/delay_model:delay_estimator",
+            "//xls/delay_model:delay_lookup_table",
             "//xls/ir",
         ],
         **kwargs
@@ -19,21 +19,27 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
 #include "absl/base/no_destructor.h"
+#include "absl/hash/hash.h"
 #include "absl/log/die_if_null.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
+#include "xls/ir/type.h"
 #include "xls/netlist/cell_library.h"
 #include "xls/netlist/logical_effort.h"
 
@@ -249,14 +255,63 @@ absl::StatusOr<int64_t> FirstMatchDelayEstimator::GetOperationDelayInPs(
   return result;
 }
 
+/* static */ DelaySignature DelaySignature::Of(Node* node) {
+  DelaySignature signature{
+      .op = node->op(),
+      .result_bit_count = node->GetType()->GetFlatBitCount(),
+      .operands_identical = true};
+  signature.operands.reserve(node->operand_count());
+  for (Node* operand : node->operands()) {
+    Type* type = operand->GetType();
+    Operand& entry = signature.operands.emplace_back(
+        Operand{.bit_count = type->GetFlatBitCount(),
+                .element_count = 0,
+                .element_bit_count = 0,
+                .is_literal = operand->Is<Literal>()});
+    if (type->IsArray()) {
+      entry.element_count = type->AsArrayOrDie()->size();
+      entry.element_bit_count =
+          type->AsArrayOrDie()->element_type()->GetFlatBitCount();
+    }
+    if (operand != node->operand(0)) {
+      signature.operands_identical = false;
+    }
+  }
+  return signature;
+}
+
+absl::StatusOr<int64_t> SignatureCachingDelayEstimator::GetOperationDelayInPs(
+    Node* node) const {
+  if (!IsSignatureCacheable(node->op())) {
+    return ComputeOperationDelayInPs(node);
+  }
+  DelaySignature signature = DelaySignature::Of(node);
+  Shard& shard = shards_[absl::HashOf(signature) % kShardCount];
+  {
+    absl::ReaderMutexLock lock(&shard.mutex);
+    auto it = shard.delays.find(signature);
+    if (it != shard.delays.end()) {
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      return it->second;
+    }
+  }
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  // Errors are not cached; they are returned for every lookup.
+  XLS_ASSIGN_OR_RETURN(int64_t delay, ComputeOperationDelayInPs(node));
+  absl::WriterMutexLock lock(&shard.mutex);
+  shard.delays.emplace(std::move(signature), delay);
+  return delay;
+}
+
 CachingDelayEstimator::CachingDelayEstimator(std::string_view name,
                                              const DelayEstimator& cached)
     : DelayEstimator(name), cached_(cached) {}
 
 absl::StatusOr<int64_t> CachingDelayEstimator::GetOperationDelayInPs(
     Node* node) const {
-  if (ContainsNodeDelay(node)) {
-    return GetNodeDelay(node);
+  if (std::optional<int64_t> delay = LookUpNodeDelay(node);
+      delay.has_value()) {
+    return *delay;
   }
 
   XLS_ASSIGN_OR_RETURN(int64_t delay, cached_.GetOperationDelayInPs(node));
@@ -264,6 +319,40 @@ absl::StatusOr<int64_t> CachingDelayEstimator::GetOperationDelayInPs(
   return delay;
 }
 
+absl::Status CachingDelayEstimator::PopulateCache(FunctionBase* f,
+                                                  int64_t thread_count) const {
+  std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
+  thread_count = std::clamp(thread_count, int64_t{1},
+                            std::max(int64_t{1}, int64_t(nodes.size())));
+  std::vector<absl::Status> statuses(thread_count);
+  auto populate = [&](int64_t worker) {
+    for (int64_t i = worker; i < nodes.size(); i += thread_count) {
+      absl::StatusOr<int64_t> delay = GetOperationDelayInPs(nodes[i]);
+      if (!delay.ok()) {
+        statuses[worker] = delay.status();
+        return;
+      }
+    }
+  };
+  if (thread_count == 1) {
+    populate(0);
+  } else {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t worker = 0; worker < thread_count; ++worker) {
+      threads.push_back(
+          std::make_unique<Thread>([&, worker]() { populate(worker); }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
 /* static */ absl::StatusOr<int64_t> DelayEstimator::GetLogicalEffortDelayInPs(
     Node* node, int64_t tau_in_ps) {
   XLS_ASSIGN_OR_RETURN(int64_t delay_in_tau, GetLogicalEffortDelayInTau(node));
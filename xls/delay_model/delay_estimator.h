@@ -15,9 +15,12 @@
 #ifndef XLS_DELAY_MODEL_DELAY_ESTIMATOR_H_
 #define XLS_DELAY_MODEL_DELAY_ESTIMATOR_H_
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -25,15 +28,30 @@
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/test_macros.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
+#include "xls/ir/op.h"
 
 namespace xls {
 
+// Lookup counts of a cache of delays.
+struct DelayCacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+
+  double hit_rate() const {
+    int64_t lookups = hits + misses;
+    return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+  }
+};
+
 // Abstraction describing a timing model for XLS operations.
 class DelayEstimator {
  public:
@@ -51,10 +69,97 @@ class DelayEstimator {
   static absl::StatusOr<int64_t> GetLogicalEffortDelayInPs(Node* node,
                                                            int64_t tau_in_ps);
 
+  // Returns the lookup counts of the estimator's cache of delays by operation
+  // signature, or std::nullopt if it has none (see
+  // SignatureCachingDelayEstimator).
+  virtual std::optional<DelayCacheStats> cache_stats() const {
+    return std::nullopt;
+  }
+
  private:
   std::string name_;
 };
 
+// Everything about a node which the generated delay models read: its op, the
+// shapes of its result and operand types, which operands are literals (for
+// HAS_LITERAL_OPERAND specializations) and whether all operands are the same
+// node (for OPERANDS_IDENTICAL specializations). Nodes with equal signatures
+// have equal delays under such a model.
+struct DelaySignature {
+  struct Operand {
+    int64_t bit_count;
+    // The size and element bit count of an array operand, otherwise zero.
+    int64_t element_count;
+    int64_t element_bit_count;
+    bool is_literal;
+
+    bool operator==(const Operand& other) const = default;
+
+    template <typename H>
+    friend H AbslHashValue(H h, const Operand& operand) {
+      return H::combine(std::move(h), operand.bit_count, operand.element_count,
+                        operand.element_bit_count, operand.is_literal);
+    }
+  };
+
+  Op op;
+  int64_t result_bit_count;
+  bool operands_identical;
+  absl::InlinedVector<Operand, 4> operands;
+
+  static DelaySignature Of(Node* node);
+
+  bool operator==(const DelaySignature& other) const = default;
+
+  template <typename H>
+  friend H AbslHashValue(H h, const DelaySignature& signature) {
+    return H::combine(std::move(h), signature.op, signature.result_bit_count,
+                      signature.operands_identical, signature.operands);
+  }
+};
+
+// Base class for delay estimators, like the generated delay models, whose
+// delays are mostly a function of the DelaySignature of a node. Delays are
+// memoized by signature so that estimating the delays of a large design
+// computes the delay of each distinct signature once; most nodes of large
+// designs share the signatures of a few (op, width) combinations. The cache
+// is never cleared, it is bounded by the number of distinct signatures seen.
+// This class is thread-safe.
+class SignatureCachingDelayEstimator : public DelayEstimator {
+ public:
+  explicit SignatureCachingDelayEstimator(std::string_view name)
+      : DelayEstimator(name) {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const final;
+
+  std::optional<DelayCacheStats> cache_stats() const override {
+    return DelayCacheStats{.hits = hits_.load(std::memory_order_relaxed),
+                           .misses = misses_.load(std::memory_order_relaxed)};
+  }
+
+ protected:
+  // Returns the delay of `node`, which is cached for all nodes with the same
+  // signature if IsSignatureCacheable(node->op()).
+  virtual absl::StatusOr<int64_t> ComputeOperationDelayInPs(
+      Node* node) const = 0;
+
+  // Returns whether the delay of every node with the op `op` is a function of
+  // its DelaySignature. Lookups of other ops are not counted in cache_stats.
+  virtual bool IsSignatureCacheable(Op op) const = 0;
+
+ private:
+  static constexpr int64_t kShardCount = 16;
+
+  struct Shard {
+    mutable absl::Mutex mutex;
+    absl::flat_hash_map<DelaySignature, int64_t> delays ABSL_GUARDED_BY(mutex);
+  };
+
+  mutable std::array<Shard, kShardCount> shards_;
+  mutable std::atomic<int64_t> hits_ = 0;
+  mutable std::atomic<int64_t> misses_ = 0;
+};
+
 // Decorates an underlying delay estimator with an overriding modifier function.
 class DecoratingDelayEstimator : public DelayEstimator {
  public:
@@ -66,6 +171,10 @@ class DecoratingDelayEstimator : public DelayEstimator {
 
   absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override;
 
+  std::optional<DelayCacheStats> cache_stats() const override {
+    return decorated_.cache_stats();
+  }
+
  private:
   const DelayEstimator& decorated_;
   std::function<int64_t(Node*, int64_t)> modifier_;
@@ -89,7 +198,9 @@ class FirstMatchDelayEstimator : public DelayEstimator {
 };
 
 // Cache the delay of an underlying delay estimator. This class is safe for
-// concurrent access.
+// concurrent access provided the underlying estimator is. The cache is split
+// into shards, each with its own lock, so that concurrent lookups of different
+// nodes rarely contend.
 class CachingDelayEstimator : public DelayEstimator {
  public:
   CachingDelayEstimator(std::string_view name, const DelayEstimator& cached);
@@ -98,28 +209,56 @@ class CachingDelayEstimator : public DelayEstimator {
 
   absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override;
 
+  // Computes and caches the delays of all nodes in `f` up front, spreading
+  // the work over `thread_count` threads. Later lookups of these nodes only
+  // take a reader lock.
+  absl::Status PopulateCache(FunctionBase* f, int64_t thread_count) const;
+
+  // The stats of the cached estimator's own cache, if it has one.
+  std::optional<DelayCacheStats> cache_stats() const override {
+    return cached_.cache_stats();
+  }
+
  private:
+  static constexpr int64_t kShardCount = 16;
+
+  struct Shard {
+    mutable absl::Mutex mutex;
+    absl::flat_hash_map<Node*, int64_t> delays ABSL_GUARDED_BY(mutex);
+  };
+
+  Shard& GetShard(Node* node) const {
+    return shards_[absl::Hash<Node*>()(node) % kShardCount];
+  }
+
+  std::optional<int64_t> LookUpNodeDelay(Node* node) const {
+    Shard& shard = GetShard(node);
+    absl::ReaderMutexLock lock(&shard.mutex);
+    auto it = shard.delays.find(node);
+    if (it == shard.delays.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
   bool ContainsNodeDelay(Node* node) const {
-    absl::ReaderMutexLock lock(&cache_mutex_);
-    return cache_.contains(node);
+    return LookUpNodeDelay(node).has_value();
   }
 
   int64_t GetNodeDelay(Node* node) const {
-    absl::ReaderMutexLock lock(&cache_mutex_);
-    return cache_.at(node);
+    return LookUpNodeDelay(node).value();
   }
 
   void AddNodeDelay(Node* node, int64_t delay) const {
-    absl::WriterMutexLock lock(&cache_mutex_);
-    cache_.emplace(node, delay);
+    Shard& shard = GetShard(node);
+    absl::WriterMutexLock lock(&shard.mutex);
+    shard.delays.emplace(node, delay);
   }
 
   XLS_FRIEND_TEST(DelayEstimatorTest, CachingDelayEstimator);
 
   const DelayEstimator& cached_;
-  mutable absl::Mutex cache_mutex_;
-  mutable absl::flat_hash_map<Node*, int64_t> cache_
-      ABSL_GUARDED_BY(cache_mutex_);
+  mutable std::array<Shard, kShardCount> shards_;
 };
 
 enum class DelayEstimatorPrecedence {
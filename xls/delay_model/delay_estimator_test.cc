@@ -14,6 +14,7 @@
 
 #include "xls/delay_model/delay_estimator.h"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string_view>
@@ -354,4 +355,152 @@ TEST_F(DelayEstimatorTest, FirstMatchDelegationEstimator) {
   }
 }
 
+// A delay estimator which counts the number of delays computed.
+class CountingDelayEstimator : public DelayEstimator {
+ public:
+  CountingDelayEstimator() : DelayEstimator("counting") {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    ++count_;
+    return node->id();
+  }
+
+  int64_t count() const { return count_; }
+
+ private:
+  mutable std::atomic<int64_t> count_ = 0;
+};
+
+TEST_F(DelayEstimatorTest, PopulateCachingDelayEstimator) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  for (int64_t i = 0; i < 100; ++i) {
+    x = fb.Add(x, fb.Literal(UBits(i, 32)));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(x));
+
+  CountingDelayEstimator counting;
+  CachingDelayEstimator caching("caching", counting);
+  XLS_ASSERT_OK(caching.PopulateCache(f, /*thread_count=*/4));
+  EXPECT_EQ(counting.count(), f->node_count());
+  for (Node* node : f->nodes()) {
+    EXPECT_THAT(caching.GetOperationDelayInPs(node), IsOkAndHolds(node->id()));
+  }
+  EXPECT_EQ(counting.count(), f->node_count());
+
+  // Errors from the underlying estimator are propagated.
+  TestNodeMatchEstimator only_add(Op::kAdd, 20, "only_add");
+  CachingDelayEstimator caching_add("caching_add", only_add);
+  EXPECT_THAT(caching_add.PopulateCache(f, /*thread_count=*/4),
+              StatusIs(absl::StatusCode::kUnimplemented));
+}
+
+// A signature-caching estimator which counts the delay computations and
+// returns the flat bit count of the first operand. Multiplies are not cached.
+class CountingSignatureEstimator : public SignatureCachingDelayEstimator {
+ public:
+  CountingSignatureEstimator()
+      : SignatureCachingDelayEstimator("counting_signature") {}
+
+  int64_t count() const { return count_; }
+
+ protected:
+  absl::StatusOr<int64_t> ComputeOperationDelayInPs(
+      Node* node) const override {
+    ++count_;
+    if (node->op() == Op::kNot) {
+      return absl::UnimplementedError("not is unsupported");
+    }
+    if (node->operand_count() == 0) {
+      return 0;
+    }
+    return node->operand(0)->GetType()->GetFlatBitCount();
+  }
+
+  bool IsSignatureCacheable(Op op) const override { return op != Op::kUMul; }
+
+ private:
+  mutable std::atomic<int64_t> count_ = 0;
+};
+
+TEST_F(DelayEstimatorTest, SignatureCachingDelayEstimator) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue z = fb.Param("z", p->GetBitsType(8));
+  BValue x_plus_y = fb.Add(x, y);
+  BValue y_plus_x = fb.Add(y, x);
+  BValue x_plus_x = fb.Add(x, x);
+  BValue x_plus_literal = fb.Add(x, fb.Literal(UBits(1, 32)));
+  BValue z_plus_z = fb.Add(z, z);
+  BValue x_times_y = fb.UMul(x, y);
+  BValue not_x = fb.Not(x);
+  XLS_ASSERT_OK(fb.Build().status());
+
+  CountingSignatureEstimator estimator;
+  EXPECT_THAT(estimator.GetOperationDelayInPs(x_plus_y.node()),
+              IsOkAndHolds(32));
+  EXPECT_EQ(estimator.count(), 1);
+  // Same op, widths and operand kinds.
+  EXPECT_THAT(estimator.GetOperationDelayInPs(y_plus_x.node()),
+              IsOkAndHolds(32));
+  EXPECT_EQ(estimator.count(), 1);
+  // Identical operands, a literal operand and a different width each have a
+  // signature of their own.
+  XLS_EXPECT_OK(estimator.GetOperationDelayInPs(x_plus_x.node()));
+  XLS_EXPECT_OK(estimator.GetOperationDelayInPs(x_plus_literal.node()));
+  EXPECT_THAT(estimator.GetOperationDelayInPs(z_plus_z.node()),
+              IsOkAndHolds(8));
+  EXPECT_EQ(estimator.count(), 4);
+  XLS_EXPECT_OK(estimator.GetOperationDelayInPs(x_plus_x.node()));
+  EXPECT_EQ(estimator.count(), 4);
+
+  // Uncacheable ops are computed every time and not counted.
+  XLS_EXPECT_OK(estimator.GetOperationDelayInPs(x_times_y.node()));
+  XLS_EXPECT_OK(estimator.GetOperationDelayInPs(x_times_y.node()));
+  EXPECT_EQ(estimator.count(), 6);
+
+  // Errors are not cached.
+  EXPECT_THAT(estimator.GetOperationDelayInPs(not_x.node()),
+              StatusIs(absl::StatusCode::kUnimplemented));
+  EXPECT_THAT(estimator.GetOperationDelayInPs(not_x.node()),
+              StatusIs(absl::StatusCode::kUnimplemented));
+  EXPECT_EQ(estimator.count(), 8);
+
+  ASSERT_TRUE(estimator.cache_stats().has_value());
+  EXPECT_EQ(estimator.cache_stats()->hits, 2);
+  EXPECT_EQ(estimator.cache_stats()->misses, 6);
+  EXPECT_DOUBLE_EQ(estimator.cache_stats()->hit_rate(), 0.25);
+
+  // Decorating estimators report the stats of the estimator they wrap.
+  CachingDelayEstimator caching("caching", estimator);
+  EXPECT_EQ(caching.cache_stats()->hits, 2);
+  FakeDelayEstimator fake(1, "one");
+  EXPECT_FALSE(fake.cache_stats().has_value());
+}
+
+TEST_F(DelayEstimatorTest, DelaySignatureOfArrayOperands) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue a = fb.Param("a", p->GetArrayType(4, p->GetBitsType(8)));
+  BValue b = fb.Param("b", p->GetArrayType(2, p->GetBitsType(16)));
+  BValue i = fb.Param("i", p->GetBitsType(2));
+  BValue index_a = fb.ArrayIndex(a, {i});
+  BValue index_b = fb.ArrayIndex(b, {i});
+  XLS_ASSERT_OK(fb.Build().status());
+
+  // Both arrays are 32 bits but their elements differ.
+  DelaySignature signature_a = DelaySignature::Of(index_a.node());
+  DelaySignature signature_b = DelaySignature::Of(index_b.node());
+  EXPECT_EQ(signature_a.operands[0].bit_count, 32);
+  EXPECT_EQ(signature_a.operands[0].element_count, 4);
+  EXPECT_EQ(signature_a.operands[0].element_bit_count, 8);
+  EXPECT_EQ(signature_a.operands[1].element_count, 0);
+  EXPECT_FALSE(signature_a.operands_identical);
+  EXPECT_FALSE(signature_a == signature_b);
+  EXPECT_TRUE(signature_a == DelaySignature::Of(index_a.node()));
+}
+
 }  // namespace xls
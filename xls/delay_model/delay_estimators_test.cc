@@ -14,12 +14,26 @@
 
 #include "xls/delay_model/delay_estimators.h"
 
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
 #include "xls/common/status/matchers.h"
 #include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
 
 namespace xls {
 namespace {
@@ -48,5 +62,105 @@ TEST_F(DelayEstimatorsTest, UnitDelayModel) {
   EXPECT_THAT(estimator->GetOperationDelayInPs(tuple.node()), IsOkAndHolds(1));
 }
 
+// Builds a function with `node_count` operations of assorted kinds and widths.
+Function* BuildMixedFunction(Package* p, int64_t node_count,
+                             const std::vector<int64_t>& widths) {
+  FunctionBuilder fb("mixed", p);
+  std::vector<BValue> params;
+  for (int64_t width : widths) {
+    params.push_back(
+        fb.Param(absl::StrCat("p", width), p->GetBitsType(width)));
+  }
+  BValue last;
+  for (int64_t i = 0; i < node_count; ++i) {
+    BValue x = params[i % params.size()];
+    switch (i % 6) {
+      case 0:
+        last = fb.Add(x, x);
+        break;
+      case 1:
+        last = fb.UMul(x, x);
+        break;
+      case 2:
+        last = fb.Shll(x, x);
+        break;
+      case 3:
+        last = fb.Eq(x, x);
+        break;
+      case 4:
+        last = fb.And({x, x, x});
+        break;
+      default:
+        last = fb.Concat({x, x});
+        break;
+    }
+  }
+  return fb.BuildWithReturnValue(last).value();
+}
+
+TEST_F(DelayEstimatorsTest, TableDelayModelMatchesDirectModel) {
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * direct,
+                           GetDelayEstimator("asap7"));
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * table,
+                           GetDelayEstimator("asap7_table"));
+  auto p = CreatePackage();
+  Function* f = BuildMixedFunction(p.get(), /*node_count=*/600,
+                                   {1, 3, 8, 17, 32, 64, 100, 128, 256});
+  for (Node* node : f->nodes()) {
+    absl::StatusOr<int64_t> direct_delay = direct->GetOperationDelayInPs(node);
+    absl::StatusOr<int64_t> table_delay = table->GetOperationDelayInPs(node);
+    ASSERT_EQ(direct_delay.ok(), table_delay.ok()) << node->ToString();
+    if (direct_delay.ok()) {
+      // Table entries at these widths are exact up to floating-point rounding.
+      EXPECT_NEAR(*table_delay, *direct_delay, 1) << node->ToString();
+    }
+  }
+}
+
+TEST_F(DelayEstimatorsTest, GeneratedModelCachesBySignature) {
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * estimator,
+                           GetDelayEstimator("asap7"));
+  ASSERT_TRUE(estimator->cache_stats().has_value());
+  auto p = CreatePackage();
+  Function* f = BuildMixedFunction(p.get(), /*node_count=*/2000,
+                                   {8, 16, 32, 64});
+  // The estimator is a shared singleton so only look at the change in stats.
+  DelayCacheStats before = *estimator->cache_stats();
+  for (Node* node : f->nodes()) {
+    XLS_ASSERT_OK(estimator->GetOperationDelayInPs(node).status());
+  }
+  DelayCacheStats after = *estimator->cache_stats();
+  int64_t hits = after.hits - before.hits;
+  int64_t misses = after.misses - before.misses;
+  EXPECT_GT(hits + misses, 0);
+  // Only a few hundred signatures exist among the thousands of nodes.
+  EXPECT_GT(hits, 4 * misses);
+}
+
+void BM_EstimateDelays(benchmark::State& state, const std::string& model) {
+  DelayEstimator* estimator = GetDelayEstimator(model).value();
+  Package p("benchmark");
+  Function* f = BuildMixedFunction(&p, /*node_count=*/100'000,
+                                   {8, 16, 32, 64, 128, 256});
+  for (auto _ : state) {
+    int64_t total = 0;
+    for (Node* node : f->nodes()) {
+      absl::StatusOr<int64_t> delay = estimator->GetOperationDelayInPs(node);
+      CHECK_OK(delay.status());
+      total += *delay;
+    }
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetItemsProcessed(state.iterations() * f->node_count());
+  if (std::optional<DelayCacheStats> stats = estimator->cache_stats();
+      stats.has_value()) {
+    state.counters["cache_hit_rate"] = stats->hit_rate();
+  }
+}
+BENCHMARK_CAPTURE(BM_EstimateDelays, asap7, "asap7");
+BENCHMARK_CAPTURE(BM_EstimateDelays, asap7_table, "asap7_table");
+BENCHMARK_CAPTURE(BM_EstimateDelays, sky130, "sky130");
+BENCHMARK_CAPTURE(BM_EstimateDelays, sky130_table, "sky130_table");
+
 }  // namespace
 }  // namespace xls
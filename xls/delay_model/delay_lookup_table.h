@@ -0,0 +1,79 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DELAY_MODEL_DELAY_LOOKUP_TABLE_H_
+#define XLS_DELAY_MODEL_DELAY_LOOKUP_TABLE_H_
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#include "absl/numeric/bits.h"
+
+namespace xls {
+
+// A precomputed table of a single term of a regression delay model:
+//
+//   term(x) = linear * x + log * log2(max(x, 1))
+//
+// where `x` is an integer delay factor such as a bit count or operand count.
+// The table is generated by generate_delay_lookup.py and replaces the
+// evaluation of the regression expression (in particular the log2) with a
+// table read.
+//
+// Values are held exactly for x < kDenseSize. For larger x up to
+// kMaxTabulated, values are held at power-of-two boundaries and linearly
+// interpolated between them. Interpolating the log2 component is off by at
+// most 0.09 times its coefficient. Beyond kMaxTabulated the term is evaluated
+// directly.
+class DelayLookupTable {
+ public:
+  static constexpr int64_t kDenseLog2 = 7;
+  static constexpr int64_t kDenseSize = int64_t{1} << kDenseLog2;
+  static constexpr int64_t kMaxLog2 = 16;
+  static constexpr int64_t kMaxTabulated = int64_t{1} << kMaxLog2;
+  // Boundaries are at 2^kDenseLog2, ..., 2^kMaxLog2 inclusive.
+  static constexpr int64_t kBoundaryCount = kMaxLog2 - kDenseLog2 + 1;
+
+  constexpr DelayLookupTable(
+      double linear, double log, const std::array<double, kDenseSize>& dense,
+      const std::array<double, kBoundaryCount>& boundaries)
+      : linear_(linear), log_(log), dense_(dense), boundaries_(boundaries) {}
+
+  double Evaluate(int64_t x) const {
+    if (x < kDenseSize) {
+      return dense_[x < 0 ? 0 : x];
+    }
+    if (x >= kMaxTabulated) {
+      return linear_ * static_cast<double>(x) +
+             log_ * std::log2(static_cast<double>(x));
+    }
+    int64_t k = absl::bit_width(static_cast<uint64_t>(x)) - 1;
+    int64_t lower = int64_t{1} << k;
+    int64_t i = k - kDenseLog2;
+    double fraction =
+        static_cast<double>(x - lower) / static_cast<double>(lower);
+    return boundaries_[i] + fraction * (boundaries_[i + 1] - boundaries_[i]);
+  }
+
+ private:
+  double linear_;
+  double log_;
+  std::array<double, kDenseSize> dense_;
+  std::array<double, kBoundaryCount> boundaries_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_DELAY_MODEL_DELAY_LOOKUP_TABLE_H_
@@ -22,6 +22,7 @@ well as provide delay estimates in Python.
 
 import abc
 import dataclasses
+import math
 import random
 from typing import Callable, List, Optional, Sequence, Tuple
 
@@ -30,6 +31,11 @@ from scipy import optimize as opt
 
 from xls.delay_model import delay_model_pb2
 
+# Layout of the tables generated for xls::DelayLookupTable; these must match
+# the constants in delay_lookup_table.h.
+DELAY_TABLE_DENSE_LOG2 = 7
+DELAY_TABLE_MAX_LOG2 = 16
+
 
 class Error(Exception):
   pass
@@ -74,6 +80,19 @@ class Estimator(metaclass=abc.ABCMeta):
     """
     raise NotImplementedError
 
+  def cpp_table_delay_code(self, node_identifier: str) -> str:
+    """Returns C++ statements which compute the delay using lookup tables.
+
+    The returned code is used by the table-based variant of the generated
+    estimator and may only call the table-based delay functions of other ops.
+    By default this is the same as cpp_delay_code.
+
+    Args:
+      node_identifier: The string identifier of the Node* value whose delay is
+        being estimated.
+    """
+    return self.cpp_delay_code(node_identifier)
+
   @abc.abstractmethod
   def operation_delay(self, operation: delay_model_pb2.Operation) -> int:
     """Returns the estimated delay for the given operation."""
@@ -111,6 +130,11 @@ class AliasEstimator(Estimator):
         self.aliased_op.lstrip('k'), node_identifier
     )
 
+  def cpp_table_delay_code(self, node_identifier: str) -> str:
+    return 'return {}TableDelay({});'.format(
+        self.aliased_op.lstrip('k'), node_identifier
+    )
+
   def operation_delay(self, operation: delay_model_pb2.Operation) -> int:
     raise NotImplementedError
 
@@ -294,6 +318,11 @@ def _delay_expression_cpp_expression(
   return 'static_cast<float>({})'.format(expression.constant)
 
 
+def _regression_term(linear: float, log: float, x: int) -> float:
+  """Returns the value of a single regression term for delay factor `x`."""
+  return linear * x + log * math.log2(max(x, 1))
+
+
 class RegressionEstimator(Estimator):
   """An estimator which uses curve fitting of measured data points.
 
@@ -540,6 +569,58 @@ class RegressionEstimator(Estimator):
       )
     return 'return std::round({});'.format(' + '.join(terms))
 
+  def cpp_table_delay_code(self, node_identifier: str) -> str:
+    """Returns C++ code computing the delay using xls::DelayLookupTable.
+
+    Each term of an expression which is a single (integer) delay factor is
+    read from a precomputed table rather than evaluated. Other expressions are
+    evaluated as in cpp_delay_code.
+
+    Args:
+      node_identifier: The string identifier of the Node* value whose delay is
+        being estimated.
+    """
+    lines = []
+    terms = [repr(self.params[0])]
+    for i, expression in enumerate(self.delay_expressions):
+      linear = self.params[2 * i + 1]
+      log = self.params[2 * i + 2]
+      if expression.HasField('factor'):
+        dense = [
+            _regression_term(linear, log, x)
+            for x in range(1 << DELAY_TABLE_DENSE_LOG2)
+        ]
+        boundaries = [
+            _regression_term(linear, log, 1 << k)
+            for k in range(DELAY_TABLE_DENSE_LOG2, DELAY_TABLE_MAX_LOG2 + 1)
+        ]
+        lines.append(
+            'static constexpr DelayLookupTable kTerm{i}({linear!r}, {log!r}, '
+            '{{{dense}}}, {{{boundaries}}});'.format(
+                i=i,
+                linear=linear,
+                log=log,
+                dense=', '.join(repr(v) for v in dense),
+                boundaries=', '.join(repr(v) for v in boundaries),
+            )
+        )
+        terms.append(
+            'kTerm{}.Evaluate({})'.format(
+                i,
+                _delay_factor_cpp_expression(
+                    expression.factor, node_identifier
+                ),
+            )
+        )
+      else:
+        e_str = _delay_expression_cpp_expression(expression, node_identifier)
+        terms.append('{!r} * {}'.format(linear, e_str))
+        terms.append(
+            '{w!r} * std::log2({e} < 1.0 ? 1.0 : {e})'.format(w=log, e=e_str)
+        )
+    lines.append('return std::round({});'.format(' + '.join(terms)))
+    return '\n'.join(lines)
+
 
 class BoundingBoxEstimator(Estimator):
   """Bounding box estimator."""
@@ -763,13 +844,24 @@ class OpModel:
         self.op, proto.estimator, data_points
     )
 
-  def cpp_delay_function(self) -> str:
-    """Return a C++ function which computes delay for an operation."""
+  def cpp_delay_function(self, use_tables: bool = False) -> str:
+    """Return a C++ function which computes delay for an operation.
+
+    Args:
+      use_tables: Whether to generate the table-based variant of the function
+        which uses cpp_table_delay_code of the estimators.
+    """
     lines = []
     lines.append(
         'absl::StatusOr<int64_t> %s(Node* node) {'
-        % self.cpp_delay_function_name()
+        % self.cpp_delay_function_name(use_tables)
     )
+
+    def estimator_code(estimator: Estimator) -> str:
+      if use_tables:
+        return estimator.cpp_table_delay_code('node')
+      return estimator.cpp_delay_code('node')
+
     nonliteral_operands_tracked = False
     for ((kind, details), estimator) in self.specializations.items():
       if kind == delay_model_pb2.SpecializationKind.OPERANDS_IDENTICAL:
@@ -816,18 +908,22 @@ class OpModel:
       else:
         raise NotImplementedError
       lines.append('if (%s) {' % cond)
-      lines.append(estimator.cpp_delay_code('node'))
+      lines.append(estimator_code(estimator))
       lines.append('}')
-    lines.append(self.estimator.cpp_delay_code('node'))
+    lines.append(estimator_code(self.estimator))
     lines.append('}')
     return '\n'.join(lines)
 
-  def cpp_delay_function_name(self) -> str:
-    return self.op.lstrip('k') + 'Delay'
+  def estimators(self) -> Sequence[Estimator]:
+    """Returns the general estimator and those of all specializations."""
+    return [self.estimator] + list(self.specializations.values())
+
+  def cpp_delay_function_name(self, use_tables: bool = False) -> str:
+    return self.op.lstrip('k') + ('TableDelay' if use_tables else 'Delay')
 
-  def cpp_delay_function_declaration(self) -> str:
+  def cpp_delay_function_declaration(self, use_tables: bool = False) -> str:
     return 'absl::StatusOr<int64_t> {}(Node* node);'.format(
-        self.cpp_delay_function_name()
+        self.cpp_delay_function_name(use_tables)
     )
 
 
@@ -855,3 +951,29 @@ class DelayModel:
 
   def op_model(self, op: str) -> OpModel:
     return self.op_models[op]
+
+  def is_signature_cacheable(self, op: str) -> bool:
+    """Returns whether the delay of `op` depends only on its signature.
+
+    The signature of a node is its op, the shapes of its result and operand
+    types, which of its operands are literals and whether all of its operands
+    are the same node (see xls::DelaySignature). Every delay factor and
+    specialization is a function of the signature. The logical effort
+    estimator is not, e.g., it reads the value of a literal selector.
+
+    Args:
+      op: The op to check, following aliases to other ops.
+    """
+    visited = set()
+    pending = [op]
+    while pending:
+      current = pending.pop()
+      if current in visited or current not in self.op_models:
+        continue
+      visited.add(current)
+      for estimator in self.op_models[current].estimators():
+        if isinstance(estimator, LogicalEffortEstimator):
+          return False
+        if isinstance(estimator, AliasEstimator):
+          pending.append(estimator.aliased_op)
+    return True
@@ -180,6 +180,44 @@ class DelayModelTest(absltest.TestCase):
             );
         """)
 
+  def test_one_factor_regression_estimator_table(self):
+    data_points_str = [
+        'operation { op: "kFoo" bit_count: 2 } delay: 210 delay_offset: 10',
+        'operation { op: "kFoo" bit_count: 4 } delay: 410 delay_offset: 10',
+        'operation { op: "kFoo" bit_count: 6 } delay: 610 delay_offset: 10',
+        'operation { op: "kFoo" bit_count: 8 } delay: 810 delay_offset: 10',
+        'operation { op: "kFoo" bit_count: 10 } delay: 1010 delay_offset: 10',
+    ]
+    result_bit_count = delay_model_pb2.DelayExpression()
+    result_bit_count.factor.source = delay_model_pb2.DelayFactor.Source.RESULT_BIT_COUNT
+    foo = delay_model.RegressionEstimator(
+        'kFoo', (result_bit_count,),
+        tuple(_parse_data_point(s) for s in data_points_str))
+    table_line, return_line = foo.cpp_table_delay_code('node').split('\n')
+    self.assertTrue(
+        table_line.startswith('static constexpr DelayLookupTable kTerm0('))
+    # The table holds the two coefficients, the dense entries and the
+    # power-of-two boundaries.
+    dense_size = 1 << delay_model.DELAY_TABLE_DENSE_LOG2
+    boundary_count = (
+        delay_model.DELAY_TABLE_MAX_LOG2 - delay_model.DELAY_TABLE_DENSE_LOG2 +
+        1)
+    self.assertLen(table_line.split(','), 2 + dense_size + boundary_count)
+    self.assertEqualIgnoringWhitespaceAndFloats(
+        return_line, r"""
+          return std::round(
+              0.0 + kTerm0.Evaluate(node->GetType()->GetFlatBitCount()));
+        """)
+    # Entries are the regression term at each bit count.
+    entries = [float(v) for v in re.findall(r'-?[0-9.]+(?:e[+-]?[0-9]+)?',
+                                             table_line.split('{')[1])]
+    self.assertAlmostEqual(entries[42], foo.raw_delay((42,)) - foo.params[0])
+
+  def test_alias_estimator_table(self):
+    foo = delay_model.AliasEstimator('kFoo', 'kBar')
+    self.assertEqual(
+        foo.cpp_table_delay_code('node'), 'return BarTableDelay(node);')
+
   def test_one_regression_estimator_operand_count(self):
 
     def gen_operation(operand_count):
@@ -278,6 +316,34 @@ class DelayModelTest(absltest.TestCase):
              return 42;
            }""")
 
+  def test_is_signature_cacheable(self):
+    model = delay_model.DelayModel(
+        text_format.Parse(
+            """
+            op_models { op: "kFoo" estimator { fixed: 42 } }
+            op_models { op: "kBar" estimator { alias_op: "kFoo" } }
+            op_models {
+              op: "kBaz" estimator { logical_effort { tau_in_ps: 10 } }
+            }
+            op_models { op: "kQux" estimator { alias_op: "kBaz" } }
+            op_models {
+              op: "kQuux"
+              estimator { fixed: 1 }
+              specializations {
+                kind: OPERANDS_IDENTICAL
+                estimator { logical_effort { tau_in_ps: 10 } }
+              }
+            }
+            """,
+            delay_model_pb2.DelayModel(),
+        )
+    )
+    self.assertTrue(model.is_signature_cacheable('kFoo'))
+    self.assertTrue(model.is_signature_cacheable('kBar'))
+    self.assertFalse(model.is_signature_cacheable('kBaz'))
+    self.assertFalse(model.is_signature_cacheable('kQux'))
+    self.assertFalse(model.is_signature_cacheable('kQuux'))
+
   def test_fixed_op_model_with_specialization(self):
     op_model = delay_model.OpModel(
         text_format.Parse(
@@ -207,6 +207,15 @@ absl::StatusOr<Bytecode::Op> OpFromString(std::string_view s) {
   if (s == "xor") {
     return Bytecode::Op::kXor;
   }
+  if (s == "load_load_binop") {
+    return Bytecode::Op::kLoadLoadBinop;
+  }
+  if (s == "literal_compare_jump_rel_if") {
+    return Bytecode::Op::kLiteralCompareJumpRelIf;
+  }
+  if (s == "literal_index_chain") {
+    return Bytecode::Op::kLiteralIndexChain;
+  }
   return absl::InvalidArgumentError(
       absl::StrCat("String was not a bytecode op: `", s, "`"));
 }
@@ -319,6 +328,12 @@ std::string OpToString(Bytecode::Op op) {
       return "width_slice";
     case Bytecode::Op::kXor:
       return "xor";
+    case Bytecode::Op::kLoadLoadBinop:
+      return "load_load_binop";
+    case Bytecode::Op::kLiteralCompareJumpRelIf:
+      return "literal_compare_jump_rel_if";
+    case Bytecode::Op::kLiteralIndexChain:
+      return "literal_index_chain";
   }
   return absl::StrCat("<invalid: ", static_cast<int>(op), ">");
 }
@@ -565,6 +580,27 @@ absl::StatusOr<InterpValue> Bytecode::value_data() const {
   return std::get<InterpValue>(data_.value());
 }
 
+absl::StatusOr<const Bytecode::LoadLoadBinopData*>
+Bytecode::load_load_binop_data() const {
+  XLS_RET_CHECK(data_.has_value());
+  XLS_RET_CHECK(std::holds_alternative<LoadLoadBinopData>(data_.value()));
+  return &std::get<LoadLoadBinopData>(data_.value());
+}
+
+absl::StatusOr<const Bytecode::CompareJumpData*> Bytecode::compare_jump_data()
+    const {
+  XLS_RET_CHECK(data_.has_value());
+  XLS_RET_CHECK(std::holds_alternative<CompareJumpData>(data_.value()));
+  return &std::get<CompareJumpData>(data_.value());
+}
+
+absl::StatusOr<const Bytecode::IndexChainData*> Bytecode::index_chain_data()
+    const {
+  XLS_RET_CHECK(data_.has_value());
+  XLS_RET_CHECK(std::holds_alternative<IndexChainData>(data_.value()));
+  return &std::get<IndexChainData>(data_.value());
+}
+
 absl::StatusOr<const Type*> Bytecode::type_data() const {
   XLS_RET_CHECK(data_.has_value());
   XLS_RET_CHECK(std::holds_alternative<std::unique_ptr<Type>>(data_.value()));
@@ -654,6 +690,23 @@ std::string Bytecode::ToString(bool source_locs) const {
       std::string operator()(const SpawnData& spawn_data) {
         return spawn_data.spawn()->ToString();
       }
+
+      std::string operator()(const LoadLoadBinopData& v) {
+        return absl::StrFormat("%d %d %s", v.lhs.value(), v.rhs.value(),
+                               OpToString(v.binop));
+      }
+
+      std::string operator()(const CompareJumpData& v) {
+        return absl::StrFormat("%s %s %+d", OpToString(v.comparison),
+                               v.rhs.ToString(), v.target.value());
+      }
+
+      std::string operator()(const IndexChainData& v) {
+        return absl::StrJoin(v.indices, " ",
+                             [](std::string* out, const InterpValue& index) {
+                               absl::StrAppend(out, index.ToString());
+                             });
+      }
     };
 
     std::string data_string = absl::visit(DataVisitor(), data_.value());
@@ -181,6 +181,23 @@ class Bytecode {
     kWidthSlice,
     // Performs a bitwise XOR of the top two values on the stack.
     kXor,
+
+    // Superinstructions: these are never emitted directly but are formed from
+    // common sequences of the ops above by FuseSuperinstructions() to reduce
+    // dispatch overhead in the interpreter.
+
+    // Applies the binary op in the `LoadLoadBinopData` data member to the
+    // values of the two slots it names, reading them in place, and pushes the
+    // result. Equivalent to `load lhs; load rhs; <binop>`.
+    kLoadLoadBinop,
+    // Pops TOS0, compares it to the literal in the `CompareJumpData` data
+    // member and jumps (relative) if the comparison is true. Equivalent to
+    // `literal; <comparison>; jump_rel_if`.
+    kLiteralCompareJumpRelIf,
+    // Successively indexes the array- or tuple-typed value at TOS0 by each of
+    // the literals in the `IndexChainData` data member. Equivalent to a
+    // sequence of `literal; index` or `literal; tuple_index` pairs.
+    kLiteralIndexChain,
   };
 
   // Indicates the amount by which the PC should be adjusted.
@@ -369,9 +386,31 @@ class Bytecode {
     std::unique_ptr<ValueFormatDescriptor> value_fmt_desc_;
   };
 
+  // Data for kLoadLoadBinop: the slots holding the operands and the binary op
+  // applied to them.
+  struct LoadLoadBinopData {
+    SlotIndex lhs;
+    SlotIndex rhs;
+    Op binop;
+  };
+
+  // Data for kLiteralCompareJumpRelIf: the comparison op, its right-hand side
+  // and the jump amount (relative to the PC of the superinstruction).
+  struct CompareJumpData {
+    Op comparison;
+    InterpValue rhs;
+    JumpTarget target;
+  };
+
+  // Data for kLiteralIndexChain: the indices to apply, outermost first.
+  struct IndexChainData {
+    std::vector<InterpValue> indices;
+  };
+
   using Data = std::variant<InterpValue, JumpTarget, NumElements, SlotIndex,
                             std::unique_ptr<Type>, InvocationData, MatchArmItem,
-                            SpawnData, TraceData, ChannelData>;
+                            SpawnData, TraceData, ChannelData,
+                            LoadLoadBinopData, CompareJumpData, IndexChainData>;
 
   static Bytecode MakeDup(Span span);
   static Bytecode MakeIndex(Span span);
@@ -425,6 +464,9 @@ class Bytecode {
   absl::StatusOr<const ChannelData*> channel_data() const;
   absl::StatusOr<const Type*> type_data() const;
   absl::StatusOr<InterpValue> value_data() const;
+  absl::StatusOr<const LoadLoadBinopData*> load_load_binop_data() const;
+  absl::StatusOr<const CompareJumpData*> compare_jump_data() const;
+  absl::StatusOr<const IndexChainData*> index_chain_data() const;
 
   std::string ToString(bool source_locs = true) const;
 
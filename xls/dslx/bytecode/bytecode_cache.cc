@@ -20,6 +20,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/bytecode/bytecode.h"
@@ -38,11 +39,30 @@ absl::StatusOr<BytecodeFunction*> BytecodeCache::GetOrCreateBytecodeFunction(
     const Function& f, const TypeInfo* type_info,
     const std::optional<ParametricEnv>& caller_bindings) {
   XLS_RET_CHECK(type_info != nullptr);
+
+  // Bytecode for functions of a borrowed module is shared with the ImportData
+  // which owns the module. This is limited to functions typed by the root type
+  // information of the module, which lives as long as the module does:
+  // parametric instances may be typed by information owned by this ImportData.
+  if (BytecodeCacheInterface* owner_cache =
+          import_data_->GetBorrowedBytecodeCache(f.owner());
+      owner_cache != nullptr && owner_cache != this) {
+    XLS_ASSIGN_OR_RETURN(TypeInfo * root_type_info,
+                         import_data_->GetRootTypeInfo(f.owner()));
+    if (type_info == root_type_info) {
+      return owner_cache->GetOrCreateBytecodeFunction(f, type_info,
+                                                      caller_bindings);
+    }
+  }
+
   Key key = std::make_tuple(&f, type_info, caller_bindings);
+  absl::MutexLock lock(&mutex_);
   if (!cache_.contains(key)) {
     XLS_ASSIGN_OR_RETURN(
         std::unique_ptr<BytecodeFunction> bf,
-        BytecodeEmitter::Emit(import_data_, type_info, f, caller_bindings));
+        BytecodeEmitter::Emit(
+            import_data_, type_info, f, caller_bindings,
+            BytecodeEmitterOptions{.fuse_superinstructions = true}));
     cache_.emplace(key, std::move(bf));
   }
 
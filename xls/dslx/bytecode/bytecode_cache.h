@@ -18,8 +18,10 @@
 #include <optional>
 #include <tuple>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/dslx/bytecode/bytecode.h"
 #include "xls/dslx/bytecode/bytecode_cache_interface.h"
 #include "xls/dslx/frontend/ast.h"
@@ -29,6 +31,13 @@
 
 namespace xls::dslx {
 
+// Thread-safe so that a single cache may be shared by interpreters running
+// concurrently on the same ImportData (e.g., tests run on several threads).
+//
+// Requests for functions of modules borrowed from an import cache are
+// forwarded to the cache of the ImportData which typechecked the module (see
+// ImportData::PutBorrowed), so that their bytecode is emitted once for all of
+// the ImportData objects sharing the module.
 class BytecodeCache : public BytecodeCacheInterface {
  public:
   explicit BytecodeCache(ImportData* import_data);
@@ -42,7 +51,9 @@ class BytecodeCache : public BytecodeCacheInterface {
                          std::optional<ParametricEnv>>;
 
   ImportData* import_data_;
-  absl::flat_hash_map<Key, std::unique_ptr<BytecodeFunction>> cache_;
+  absl::Mutex mutex_;
+  absl::flat_hash_map<Key, std::unique_ptr<BytecodeFunction>> cache_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace xls::dslx
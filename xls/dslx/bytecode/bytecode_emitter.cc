@@ -14,6 +14,7 @@
 
 #include "xls/dslx/bytecode/bytecode_emitter.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -115,8 +116,160 @@ ExprToValueFormatDescriptor(const Expr* expr, const TypeInfo* type_info,
   return MakeValueFormatDescriptor(*maybe_type.value(), field_preference);
 }
 
+bool IsFusibleBinop(Bytecode::Op op) {
+  switch (op) {
+    case Bytecode::Op::kUAdd:
+    case Bytecode::Op::kSAdd:
+    case Bytecode::Op::kUSub:
+    case Bytecode::Op::kSSub:
+    case Bytecode::Op::kUMul:
+    case Bytecode::Op::kSMul:
+    case Bytecode::Op::kAnd:
+    case Bytecode::Op::kConcat:
+    case Bytecode::Op::kDiv:
+    case Bytecode::Op::kEq:
+    case Bytecode::Op::kGe:
+    case Bytecode::Op::kGt:
+    case Bytecode::Op::kLe:
+    case Bytecode::Op::kLt:
+    case Bytecode::Op::kMod:
+    case Bytecode::Op::kNe:
+    case Bytecode::Op::kOr:
+    case Bytecode::Op::kShl:
+    case Bytecode::Op::kShr:
+    case Bytecode::Op::kXor:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsComparison(Bytecode::Op op) {
+  switch (op) {
+    case Bytecode::Op::kEq:
+    case Bytecode::Op::kGe:
+    case Bytecode::Op::kGt:
+    case Bytecode::Op::kLe:
+    case Bytecode::Op::kLt:
+    case Bytecode::Op::kNe:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsJump(Bytecode::Op op) {
+  return op == Bytecode::Op::kJumpRel || op == Bytecode::Op::kJumpRelIf;
+}
+
+// Returns the number of bytecodes starting at `pc` which are replaced by a
+// single superinstruction, or 1 if the bytecode at `pc` is not fused.
+int64_t GetFusedLength(absl::Span<const Bytecode> bytecodes, int64_t pc) {
+  auto op_at = [&](int64_t i) -> std::optional<Bytecode::Op> {
+    if (i >= bytecodes.size()) {
+      return std::nullopt;
+    }
+    return bytecodes[i].op();
+  };
+  if (op_at(pc) == Bytecode::Op::kLoad &&
+      op_at(pc + 1) == Bytecode::Op::kLoad && op_at(pc + 2).has_value() &&
+      IsFusibleBinop(*op_at(pc + 2))) {
+    return 3;
+  }
+  if (op_at(pc) == Bytecode::Op::kLiteral && op_at(pc + 1).has_value() &&
+      IsComparison(*op_at(pc + 1)) &&
+      op_at(pc + 2) == Bytecode::Op::kJumpRelIf) {
+    return 3;
+  }
+  int64_t length = 0;
+  while (op_at(pc + length) == Bytecode::Op::kLiteral &&
+         (op_at(pc + length + 1) == Bytecode::Op::kIndex ||
+          op_at(pc + length + 1) == Bytecode::Op::kTupleIndex)) {
+    length += 2;
+  }
+  return std::max<int64_t>(length, 1);
+}
+
 }  // namespace
 
+absl::StatusOr<std::vector<Bytecode>> FuseSuperinstructions(
+    std::vector<Bytecode> bytecodes) {
+  // First determine the new PC of each bytecode so that jump amounts can be
+  // rewritten as the fused sequence is built. Bytecodes which are fused away
+  // map to the PC of their superinstruction.
+  std::vector<int64_t> new_pcs(bytecodes.size() + 1);
+  int64_t new_pc = 0;
+  for (int64_t pc = 0; pc < bytecodes.size(); ++new_pc) {
+    int64_t length = GetFusedLength(bytecodes, pc);
+    for (int64_t i = 0; i < length; ++i) {
+      new_pcs[pc + i] = new_pc;
+    }
+    pc += length;
+  }
+  new_pcs[bytecodes.size()] = new_pc;
+
+  // Returns the jump amount, relative to the new PC of the jump, of the jump
+  // with the given (original) PC and amount.
+  auto retarget = [&](int64_t pc, Bytecode::JumpTarget target)
+      -> absl::StatusOr<Bytecode::JumpTarget> {
+    XLS_RET_CHECK_NE(target, Bytecode::kPlaceholderJumpAmount);
+    int64_t dest = pc + target.value();
+    XLS_RET_CHECK(dest >= 0 && dest <= bytecodes.size());
+    return Bytecode::JumpTarget(new_pcs[dest] - new_pcs[pc]);
+  };
+
+  std::vector<Bytecode> fused;
+  fused.reserve(new_pc);
+  for (int64_t pc = 0; pc < bytecodes.size();) {
+    int64_t length = GetFusedLength(bytecodes, pc);
+    Bytecode& bytecode = bytecodes[pc];
+    if (length == 1) {
+      if (IsJump(bytecode.op())) {
+        XLS_ASSIGN_OR_RETURN(Bytecode::JumpTarget target,
+                             bytecode.jump_target());
+        XLS_ASSIGN_OR_RETURN(target, retarget(pc, target));
+        fused.push_back(
+            Bytecode(bytecode.source_span(), bytecode.op(), target));
+      } else {
+        fused.push_back(std::move(bytecode));
+      }
+    } else if (bytecode.op() == Bytecode::Op::kLoad) {
+      const Bytecode& binop = bytecodes[pc + 2];
+      XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex lhs, bytecode.slot_index());
+      XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex rhs,
+                           bytecodes[pc + 1].slot_index());
+      fused.push_back(Bytecode(
+          binop.source_span(), Bytecode::Op::kLoadLoadBinop,
+          Bytecode::LoadLoadBinopData{
+              .lhs = lhs, .rhs = rhs, .binop = binop.op()}));
+    } else if (IsComparison(bytecodes[pc + 1].op()) &&
+               bytecodes[pc + 2].op() == Bytecode::Op::kJumpRelIf) {
+      const Bytecode& comparison = bytecodes[pc + 1];
+      XLS_ASSIGN_OR_RETURN(InterpValue rhs, bytecode.value_data());
+      XLS_ASSIGN_OR_RETURN(Bytecode::JumpTarget target,
+                           bytecodes[pc + 2].jump_target());
+      XLS_ASSIGN_OR_RETURN(target, retarget(pc + 2, target));
+      fused.push_back(Bytecode(comparison.source_span(),
+                               Bytecode::Op::kLiteralCompareJumpRelIf,
+                               Bytecode::CompareJumpData{
+                                   .comparison = comparison.op(),
+                                   .rhs = std::move(rhs),
+                                   .target = target}));
+    } else {
+      std::vector<InterpValue> indices;
+      for (int64_t i = 0; i < length; i += 2) {
+        XLS_ASSIGN_OR_RETURN(InterpValue index, bytecodes[pc + i].value_data());
+        indices.push_back(std::move(index));
+      }
+      fused.push_back(Bytecode(bytecodes[pc + length - 1].source_span(),
+                               Bytecode::Op::kLiteralIndexChain,
+                               Bytecode::IndexChainData{std::move(indices)}));
+    }
+    pc += length;
+  }
+  return fused;
+}
+
 BytecodeEmitter::BytecodeEmitter(
     ImportData* import_data, const TypeInfo* type_info,
     const std::optional<ParametricEnv>& caller_bindings,
@@ -128,6 +281,14 @@ BytecodeEmitter::BytecodeEmitter(
 
 BytecodeEmitter::~BytecodeEmitter() = default;
 
+absl::Status BytecodeEmitter::Finalize() {
+  if (options_.fuse_superinstructions) {
+    XLS_ASSIGN_OR_RETURN(bytecode_,
+                         FuseSuperinstructions(std::move(bytecode_)));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status BytecodeEmitter::Init(const Function& f) {
   for (const auto* param : f.params()) {
     namedef_to_slot_[param->name_def()] = next_slotno_++;
@@ -159,6 +320,7 @@ BytecodeEmitter::EmitProcNext(
   }
   XLS_RETURN_IF_ERROR(emitter.Init(f));
   XLS_RETURN_IF_ERROR(f.body()->AcceptExpr(&emitter));
+  XLS_RETURN_IF_ERROR(emitter.Finalize());
 
   return BytecodeFunction::Create(f.owner(), &f, type_info,
                                   std::move(emitter.bytecode_));
@@ -198,6 +360,7 @@ BytecodeEmitter::EmitExpression(
   }
 
   XLS_RETURN_IF_ERROR(expr->AcceptExpr(&emitter));
+  XLS_RETURN_IF_ERROR(emitter.Finalize());
 
   return BytecodeFunction::Create(expr->owner(), /*source_fn=*/nullptr,
                                   type_info, std::move(emitter.bytecode_));
@@ -37,8 +37,18 @@ namespace xls::dslx {
 struct BytecodeEmitterOptions {
   // The format preference to use when one is not otherwise specified.
   FormatPreference format_preference;
+
+  // Whether to run FuseSuperinstructions() over the emitted bytecode.
+  bool fuse_superinstructions = false;
 };
 
+// Peephole pass which replaces common sequences of bytecodes with the
+// equivalent superinstructions (see the end of Bytecode::Op), rewriting jump
+// amounts to account for the removed bytecodes. Jump destinations are never
+// fused away so control flow is unaffected.
+absl::StatusOr<std::vector<Bytecode>> FuseSuperinstructions(
+    std::vector<Bytecode> bytecodes);
+
 // Translates a DSLX expression tree into a linear sequence of bytecodes.
 class BytecodeEmitter : public ExprVisitor {
  public:
@@ -74,6 +84,9 @@ class BytecodeEmitter : public ExprVisitor {
   // Initializes namedef-to-slot mapping.
   absl::Status Init(const Function& f);
 
+  // Applies any post-emission passes requested in the options.
+  absl::Status Finalize();
+
   // Precondition: node must be Bits typed.
   absl::StatusOr<bool> IsBitsTypeNodeSigned(const AstNode* node) const;
 
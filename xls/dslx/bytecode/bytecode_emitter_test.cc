@@ -1469,5 +1469,38 @@ fn main() -> u32 {
   }
 }
 
+
+TEST(BytecodeEmitterTest, FuseSuperinstructions) {
+  const Span span = Span::Fake();
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(Bytecode::MakeLoad(span, Bytecode::SlotIndex(0)));
+  bytecodes.push_back(Bytecode::MakeLoad(span, Bytecode::SlotIndex(1)));
+  bytecodes.push_back(Bytecode(span, Bytecode::Op::kUAdd));
+  bytecodes.push_back(Bytecode::MakeJumpDest(span));
+  bytecodes.push_back(Bytecode::MakeLoad(span, Bytecode::SlotIndex(0)));
+  bytecodes.push_back(Bytecode::MakeLiteral(span, InterpValue::MakeU32(4)));
+  bytecodes.push_back(Bytecode(span, Bytecode::Op::kEq));
+  bytecodes.push_back(Bytecode::MakeJumpRelIf(span, Bytecode::JumpTarget(7)));
+  bytecodes.push_back(Bytecode::MakeLoad(span, Bytecode::SlotIndex(2)));
+  bytecodes.push_back(Bytecode::MakeLiteral(span, InterpValue::MakeU64(0)));
+  bytecodes.push_back(Bytecode::MakeTupleIndex(span));
+  bytecodes.push_back(Bytecode::MakeLiteral(span, InterpValue::MakeU64(1)));
+  bytecodes.push_back(Bytecode::MakeIndex(span));
+  bytecodes.push_back(Bytecode::MakeJumpRel(span, Bytecode::JumpTarget(-10)));
+  bytecodes.push_back(Bytecode::MakeJumpDest(span));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bytecode> fused,
+                           FuseSuperinstructions(std::move(bytecodes)));
+  EXPECT_EQ(BytecodesToString(fused, /*source_locs=*/false),
+            R"(000 load_load_binop 0 1 uadd
+001 jump_dest
+002 load 0
+003 literal_compare_jump_rel_if eq u32:4 +4
+004 load 2
+005 literal_index_chain u64:0 u64:1
+006 jump_rel -5
+007 jump_dest)");
+}
+
 }  // namespace
 }  // namespace xls::dslx
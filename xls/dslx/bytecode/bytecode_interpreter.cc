@@ -17,7 +17,6 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
-#include <functional>
 #include <ios>
 #include <memory>
 #include <optional>
@@ -26,6 +25,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
@@ -407,14 +407,45 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       XLS_RETURN_IF_ERROR(EvalXor(bytecode));
       break;
     }
+    case Bytecode::Op::kLoadLoadBinop: {
+      XLS_RETURN_IF_ERROR(EvalLoadLoadBinop(bytecode));
+      break;
+    }
+    case Bytecode::Op::kLiteralCompareJumpRelIf: {
+      XLS_ASSIGN_OR_RETURN(std::optional<int64_t> new_pc,
+                           EvalLiteralCompareJumpRelIf(frame->pc(), bytecode));
+      if (new_pc.has_value()) {
+        frame->set_pc(new_pc.value());
+        return absl::OkStatus();
+      }
+      break;
+    }
+    case Bytecode::Op::kLiteralIndexChain: {
+      XLS_RETURN_IF_ERROR(EvalLiteralIndexChain(bytecode));
+      break;
+    }
   }
   frame->IncrementPc();
   return absl::OkStatus();
 }
 
 absl::Status BytecodeInterpreter::EvalBinop(
-    const std::function<absl::StatusOr<InterpValue>(
-        const InterpValue& lhs, const InterpValue& rhs)>& op) {
+    const Bytecode& bytecode,
+    absl::FunctionRef<absl::StatusOr<InterpValue>(const InterpValue& lhs,
+                                                  const InterpValue& rhs)>
+        op) {
+  if (bytecode.op() == Bytecode::Op::kLoadLoadBinop) {
+    // The operands of the superinstruction are read in place from their slots
+    // rather than being copied onto the stack.
+    XLS_ASSIGN_OR_RETURN(const Bytecode::LoadLoadBinopData* data,
+                         bytecode.load_load_binop_data());
+    XLS_ASSIGN_OR_RETURN(const InterpValue* lhs, GetSlot(data->lhs));
+    XLS_ASSIGN_OR_RETURN(const InterpValue* rhs, GetSlot(data->rhs));
+    XLS_ASSIGN_OR_RETURN(InterpValue result, op(*lhs, *rhs));
+    stack_.Push(std::move(result));
+    return absl::OkStatus();
+  }
+
   XLS_RET_CHECK_GE(stack_.size(), 2);
   XLS_ASSIGN_OR_RETURN(InterpValue rhs, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue lhs, Pop());
@@ -425,32 +456,35 @@ absl::Status BytecodeInterpreter::EvalBinop(
 
 absl::Status BytecodeInterpreter::EvalAdd(const Bytecode& bytecode,
                                           bool is_signed) {
-  return EvalBinop([&](const InterpValue& lhs,
-                       const InterpValue& rhs) -> absl::StatusOr<InterpValue> {
-    XLS_ASSIGN_OR_RETURN(InterpValue output, lhs.Add(rhs));
-
-    // Slow path: when rollover warning hook is enabled.
-    if (options_.rollover_hook() != nullptr) {
-      auto make_big_int = [is_signed](const Bits& bits) {
-        return is_signed ? BigInt::MakeSigned(bits)
-                         : BigInt::MakeUnsigned(bits);
-      };
-      bool rollover =
-          make_big_int(lhs.GetBitsOrDie()) + make_big_int(rhs.GetBitsOrDie()) !=
-          make_big_int(output.GetBitsOrDie());
-      if (rollover) {
-        options_.rollover_hook()(bytecode.source_span());
-      }
-    }
+  return EvalBinop(
+      bytecode,
+      [&](const InterpValue& lhs,
+          const InterpValue& rhs) -> absl::StatusOr<InterpValue> {
+        XLS_ASSIGN_OR_RETURN(InterpValue output, lhs.Add(rhs));
+
+        // Slow path: when rollover warning hook is enabled.
+        if (options_.rollover_hook() != nullptr) {
+          auto make_big_int = [is_signed](const Bits& bits) {
+            return is_signed ? BigInt::MakeSigned(bits)
+                             : BigInt::MakeUnsigned(bits);
+          };
+          bool rollover = make_big_int(lhs.GetBitsOrDie()) +
+                              make_big_int(rhs.GetBitsOrDie()) !=
+                          make_big_int(output.GetBitsOrDie());
+          if (rollover) {
+            options_.rollover_hook()(bytecode.source_span());
+          }
+        }
 
-    return output;
-  });
+        return output;
+      });
 }
 
 absl::Status BytecodeInterpreter::EvalAnd(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.BitwiseAnd(rhs);
-  });
+  return EvalBinop(bytecode,
+                   [](const InterpValue& lhs, const InterpValue& rhs) {
+                     return lhs.BitwiseAnd(rhs);
+                   });
 }
 
 absl::StatusOr<BytecodeFunction*> BytecodeInterpreter::GetBytecodeFn(
@@ -656,9 +690,10 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
 }
 
 absl::Status BytecodeInterpreter::EvalConcat(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Concat(rhs);
-  });
+  return EvalBinop(bytecode,
+                   [](const InterpValue& lhs, const InterpValue& rhs) {
+                     return lhs.Concat(rhs);
+                   });
 }
 
 absl::Status BytecodeInterpreter::EvalCreateArray(const Bytecode& bytecode) {
@@ -723,15 +758,17 @@ absl::Status BytecodeInterpreter::EvalDecode(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalDiv(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.FloorDiv(rhs);
-  });
+  return EvalBinop(bytecode,
+                   [](const InterpValue& lhs, const InterpValue& rhs) {
+                     return lhs.FloorDiv(rhs);
+                   });
 }
 
 absl::Status BytecodeInterpreter::EvalMod(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.FloorMod(rhs);
-  });
+  return EvalBinop(bytecode,
+                   [](const InterpValue& lhs, const InterpValue& rhs) {
+                     return lhs.FloorMod(rhs);
+                   });
 }
 
 absl::Status BytecodeInterpreter::EvalDup(const Bytecode& bytecode) {
@@ -741,9 +778,10 @@ absl::Status BytecodeInterpreter::EvalDup(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalEq(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return InterpValue::MakeBool(lhs.Eq(rhs));
-  });
+  return EvalBinop(bytecode,
+                   [](const InterpValue& lhs, const InterpValue& rhs) {
+                     return InterpValue::MakeBool(lhs.Eq(rhs));
+                   });
 }
 
 absl::Status BytecodeInterpreter::EvalExpandTuple(const Bytecode& bytecode) {
@@ -776,15 +814,17 @@ absl::Status BytecodeInterpreter::EvalFail(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalGe(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Ge(rhs);
-  });
+  return EvalBinop(bytecode,
+                   [](const InterpValue& lhs, const InterpValue& rhs) {
+                     return lhs.Ge(rhs);
+                   });
 }
 
 absl::Status BytecodeInterpreter::EvalGt(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Gt(rhs);
-  });
+  return EvalBinop(bytecode,
+                   [](const InterpValue& lhs, const InterpValue& rhs) {
+                     return lhs.Gt(rhs);
+                   });
 }
 
 absl::Status BytecodeInterpreter::EvalTupleIndex(const Bytecode& bytecode) {
@@ -829,9 +869,10 @@ absl::Status BytecodeInterpreter::EvalInvert(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalLe(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Le(rhs);
-  });
+  return EvalBinop(bytecode,
+                   [](const InterpValue& lhs, const InterpValue& rhs) {
+                     return lhs.Le(rhs);
+                   });
 }
 
 absl::Status BytecodeInterpreter::EvalLiteral(const Bytecode& bytecode) {
@@ -840,17 +881,76 @@ absl::Status BytecodeInterpreter::EvalLiteral(const Bytecode& bytecode) {
   return absl::OkStatus();
 }
 
-absl::Status BytecodeInterpreter::EvalLoad(const Bytecode& bytecode) {
-  XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex slot, bytecode.slot_index());
+absl::StatusOr<const InterpValue*> BytecodeInterpreter::GetSlot(
+    Bytecode::SlotIndex slot) {
   if (frames_.back().slots().size() <= slot.value()) {
     return absl::InternalError(absl::StrFormat(
         "Attempted to access local data in slot %d, which is out of range.",
         slot.value()));
   }
-  stack_.Push(frames_.back().slots().at(slot.value()));
+  return &frames_.back().slots().at(slot.value());
+}
+
+absl::Status BytecodeInterpreter::EvalLoad(const Bytecode& bytecode) {
+  XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex slot, bytecode.slot_index());
+  XLS_ASSIGN_OR_RETURN(const InterpValue* value, GetSlot(slot));
+  stack_.Push(*value);
   return absl::OkStatus();
 }
 
+absl::Status BytecodeInterpreter::EvalLoadLoadBinop(const Bytecode& bytecode) {
+  XLS_ASSIGN_OR_RETURN(const Bytecode::LoadLoadBinopData* data,
+                       bytecode.load_load_binop_data());
+  // Each of these reads its operands from the slots named by `bytecode`; see
+  // EvalBinop().
+  switch (data->binop) {
+    case Bytecode::Op::kUAdd:
+      return EvalAdd(bytecode, /*is_signed=*/false);
+    case Bytecode::Op::kSAdd:
+      return EvalAdd(bytecode, /*is_signed=*/true);
+    case Bytecode::Op::kUSub:
+      return EvalSub(bytecode, /*is_signed=*/false);
+    case Bytecode::Op::kSSub:
+      return EvalSub(bytecode, /*is_signed=*/true);
+    case Bytecode::Op::kUMul:
+      return EvalMul(bytecode, /*is_signed=*/false);
+    case Bytecode::Op::kSMul:
+      return EvalMul(bytecode, /*is_signed=*/true);
+    case Bytecode::Op::kAnd:
+      return EvalAnd(bytecode);
+    case Bytecode::Op::kConcat:
+      return EvalConcat(bytecode);
+    case Bytecode::Op::kDiv:
+      return EvalDiv(bytecode);
+    case Bytecode::Op::kEq:
+      return EvalEq(bytecode);
+    case Bytecode::Op::kGe:
+      return EvalGe(bytecode);
+    case Bytecode::Op::kGt:
+      return EvalGt(bytecode);
+    case Bytecode::Op::kLe:
+      return EvalLe(bytecode);
+    case Bytecode::Op::kLt:
+      return EvalLt(bytecode);
+    case Bytecode::Op::kMod:
+      return EvalMod(bytecode);
+    case Bytecode::Op::kNe:
+      return EvalNe(bytecode);
+    case Bytecode::Op::kOr:
+      return EvalOr(bytecode);
+    case Bytecode::Op::kShl:
+      return EvalShl(bytecode);
+    case Bytecode::Op::kShr:
+      return EvalShr(bytecode);
+    case Bytecode::Op::kXor:
+      return EvalXor(bytecode);
+    default:
+      return absl::InternalError(
+          absl::StrCat("Invalid binop for load_load_binop: ",
+                       OpToString(data->binop)));
+  }
+}
+
 absl::Status BytecodeInterpreter::EvalLogicalAnd(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(InterpValue rhs, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue lhs, Pop());
@@ -894,9 +994,10 @@ absl::Status BytecodeInterpreter::EvalLogicalOr(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalLt(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Lt(rhs);
-  });
+  return EvalBinop(bytecode,
+                   [](const InterpValue& lhs, const InterpValue& rhs) {
+                     return lhs.Lt(rhs);
+                   });
 }
 
 absl::StatusOr<bool> BytecodeInterpreter::MatchArmEqualsInterpValue(
@@ -981,32 +1082,35 @@ absl::Status BytecodeInterpreter::EvalMatchArm(const Bytecode& bytecode) {
 
 absl::Status BytecodeInterpreter::EvalMul(const Bytecode& bytecode,
                                           bool is_signed) {
-  return EvalBinop([&](const InterpValue& lhs,
-                       const InterpValue& rhs) -> absl::StatusOr<InterpValue> {
-    XLS_ASSIGN_OR_RETURN(InterpValue output, lhs.Mul(rhs));
-
-    // Slow path: when rollover warning hook is enabled.
-    if (options_.rollover_hook() != nullptr) {
-      auto make_big_int = [is_signed](const Bits& bits) {
-        return is_signed ? BigInt::MakeSigned(bits)
-                         : BigInt::MakeUnsigned(bits);
-      };
-      bool rollover =
-          make_big_int(lhs.GetBitsOrDie()) * make_big_int(rhs.GetBitsOrDie()) !=
-          make_big_int(output.GetBitsOrDie());
-      if (rollover) {
-        options_.rollover_hook()(bytecode.source_span());
-      }
-    }
+  return EvalBinop(
+      bytecode,
+      [&](const InterpValue& lhs,
+          const InterpValue& rhs) -> absl::StatusOr<InterpValue> {
+        XLS_ASSIGN_OR_RETURN(InterpValue output, lhs.Mul(rhs));
+
+        // Slow path: when rollover warning hook is enabled.
+        if (options_.rollover_hook() != nullptr) {
+          auto make_big_int = [is_signed](const Bits& bits) {
+            return is_signed ? BigInt::MakeSigned(bits)
+                             : BigInt::MakeUnsigned(bits);
+          };
+          bool rollover = make_big_int(lhs.GetBitsOrDie()) *
+                              make_big_int(rhs.GetBitsOrDie()) !=
+                          make_big_int(output.GetBitsOrDie());
+          if (rollover) {
+            options_.rollover_hook()(bytecode.source_span());
+          }
+        }
 
-    return output;
-  });
+        return output;
+      });
 }
 
 absl::Status BytecodeInterpreter::EvalNe(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return InterpValue::MakeBool(lhs.Ne(rhs));
-  });
+  return EvalBinop(bytecode,
+                   [](const InterpValue& lhs, const InterpValue& rhs) {
+                     return InterpValue::MakeBool(lhs.Ne(rhs));
+                   });
 }
 
 absl::Status BytecodeInterpreter::EvalNegate(const Bytecode& bytecode) {
@@ -1017,9 +1121,10 @@ absl::Status BytecodeInterpreter::EvalNegate(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalOr(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.BitwiseOr(rhs);
-  });
+  return EvalBinop(bytecode,
+                   [](const InterpValue& lhs, const InterpValue& rhs) {
+                     return lhs.BitwiseOr(rhs);
+                   });
 }
 
 absl::Status BytecodeInterpreter::EvalPop(const Bytecode& bytecode) {
@@ -1125,18 +1230,20 @@ absl::Status BytecodeInterpreter::EvalSend(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalShl(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Shl(rhs);
-  });
+  return EvalBinop(bytecode,
+                   [](const InterpValue& lhs, const InterpValue& rhs) {
+                     return lhs.Shl(rhs);
+                   });
 }
 
 absl::Status BytecodeInterpreter::EvalShr(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    if (lhs.IsSigned()) {
-      return lhs.Shra(rhs);
-    }
-    return lhs.Shrl(rhs);
-  });
+  return EvalBinop(bytecode,
+                   [](const InterpValue& lhs, const InterpValue& rhs) {
+                     if (lhs.IsSigned()) {
+                       return lhs.Shra(rhs);
+                     }
+                     return lhs.Shrl(rhs);
+                   });
 }
 
 absl::Status BytecodeInterpreter::EvalSlice(const Bytecode& bytecode) {
@@ -1216,28 +1323,94 @@ absl::StatusOr<std::optional<int64_t>> BytecodeInterpreter::EvalJumpRelIf(
   return std::nullopt;
 }
 
+absl::StatusOr<std::optional<int64_t>>
+BytecodeInterpreter::EvalLiteralCompareJumpRelIf(int64_t pc,
+                                                 const Bytecode& bytecode) {
+  XLS_ASSIGN_OR_RETURN(const Bytecode::CompareJumpData* data,
+                       bytecode.compare_jump_data());
+  XLS_ASSIGN_OR_RETURN(InterpValue lhs, Pop());
+  bool condition;
+  switch (data->comparison) {
+    case Bytecode::Op::kEq:
+      condition = lhs.Eq(data->rhs);
+      break;
+    case Bytecode::Op::kNe:
+      condition = lhs.Ne(data->rhs);
+      break;
+    case Bytecode::Op::kGe: {
+      XLS_ASSIGN_OR_RETURN(InterpValue result, lhs.Ge(data->rhs));
+      condition = result.IsTrue();
+      break;
+    }
+    case Bytecode::Op::kGt: {
+      XLS_ASSIGN_OR_RETURN(InterpValue result, lhs.Gt(data->rhs));
+      condition = result.IsTrue();
+      break;
+    }
+    case Bytecode::Op::kLe: {
+      XLS_ASSIGN_OR_RETURN(InterpValue result, lhs.Le(data->rhs));
+      condition = result.IsTrue();
+      break;
+    }
+    case Bytecode::Op::kLt: {
+      XLS_ASSIGN_OR_RETURN(InterpValue result, lhs.Lt(data->rhs));
+      condition = result.IsTrue();
+      break;
+    }
+    default:
+      return absl::InternalError(absl::StrCat(
+          "Invalid comparison for literal_compare_jump_rel_if: ",
+          OpToString(data->comparison)));
+  }
+  if (condition) {
+    return pc + data->target.value();
+  }
+  return std::nullopt;
+}
+
+absl::Status BytecodeInterpreter::EvalLiteralIndexChain(
+    const Bytecode& bytecode) {
+  XLS_ASSIGN_OR_RETURN(const Bytecode::IndexChainData* data,
+                       bytecode.index_chain_data());
+  XLS_ASSIGN_OR_RETURN(InterpValue value, Pop());
+  for (const InterpValue& index : data->indices) {
+    if (!value.IsArray() && !value.IsTuple()) {
+      return absl::InternalError(
+          "BytecodeInterpreter type error: can only index on array or tuple "
+          "values; got: " +
+          value.ToString());
+    }
+    XLS_ASSIGN_OR_RETURN(value, value.Index(index),
+                         _ << " while processing " << bytecode.ToString());
+  }
+  stack_.Push(std::move(value));
+  return absl::OkStatus();
+}
+
 absl::Status BytecodeInterpreter::EvalSub(const Bytecode& bytecode,
                                           bool is_signed) {
-  return EvalBinop([&](const InterpValue& lhs,
-                       const InterpValue& rhs) -> absl::StatusOr<InterpValue> {
-    XLS_ASSIGN_OR_RETURN(InterpValue output, lhs.Sub(rhs));
-
-    // Slow path: when rollover warning hook is enabled.
-    if (options_.rollover_hook() != nullptr) {
-      auto make_big_int = [is_signed](const Bits& bits) {
-        return is_signed ? BigInt::MakeSigned(bits)
-                         : BigInt::MakeUnsigned(bits);
-      };
-      bool rollover =
-          make_big_int(lhs.GetBitsOrDie()) - make_big_int(rhs.GetBitsOrDie()) !=
-          make_big_int(output.GetBitsOrDie());
-      if (rollover) {
-        options_.rollover_hook()(bytecode.source_span());
-      }
-    }
+  return EvalBinop(
+      bytecode,
+      [&](const InterpValue& lhs,
+          const InterpValue& rhs) -> absl::StatusOr<InterpValue> {
+        XLS_ASSIGN_OR_RETURN(InterpValue output, lhs.Sub(rhs));
+
+        // Slow path: when rollover warning hook is enabled.
+        if (options_.rollover_hook() != nullptr) {
+          auto make_big_int = [is_signed](const Bits& bits) {
+            return is_signed ? BigInt::MakeSigned(bits)
+                             : BigInt::MakeUnsigned(bits);
+          };
+          bool rollover = make_big_int(lhs.GetBitsOrDie()) -
+                              make_big_int(rhs.GetBitsOrDie()) !=
+                          make_big_int(output.GetBitsOrDie());
+          if (rollover) {
+            options_.rollover_hook()(bytecode.source_span());
+          }
+        }
 
-    return output;
-  });
+        return output;
+      });
 }
 
 absl::Status BytecodeInterpreter::EvalSwap(const Bytecode& bytecode) {
@@ -1349,9 +1522,10 @@ absl::Status BytecodeInterpreter::EvalWidthSlice(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalXor(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.BitwiseXor(rhs);
-  });
+  return EvalBinop(bytecode,
+                   [](const InterpValue& lhs, const InterpValue& rhs) {
+                     return lhs.BitwiseXor(rhs);
+                   });
 }
 
 absl::Status BytecodeInterpreter::RunBuiltinFn(const Bytecode& bytecode,
@@ -1591,8 +1765,9 @@ absl::Status ProcConfigBytecodeInterpreter::EvalSpawn(
       std::unique_ptr<BytecodeFunction> config_bf,
       BytecodeEmitter::Emit(
           import_data, type_info, proc->config(), callee_bindings,
-          BytecodeEmitterOptions{.format_preference =
-                                     options.format_preference()}));
+          BytecodeEmitterOptions{
+              .format_preference = options.format_preference(),
+              .fuse_superinstructions = true}));
 
   ProcConfigBytecodeInterpreter cbi(import_data, proc_instances, options);
   XLS_RETURN_IF_ERROR(cbi.InitFrame(config_bf.get(), config_args, type_info));
@@ -1640,8 +1815,9 @@ absl::Status ProcConfigBytecodeInterpreter::EvalSpawn(
       std::unique_ptr<BytecodeFunction> next_bf,
       BytecodeEmitter::EmitProcNext(
           import_data, type_info, proc->next(), callee_bindings, member_defs,
-          BytecodeEmitterOptions{.format_preference =
-                                     options.format_preference()}));
+          BytecodeEmitterOptions{
+              .format_preference = options.format_preference(),
+              .fuse_superinstructions = true}));
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeInterpreter> next_interpreter,
       CreateUnique(import_data, next_bf.get(), full_next_args, options));
@@ -23,6 +23,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
@@ -160,9 +161,22 @@ class BytecodeInterpreter {
   absl::Status EvalWidthSlice(const Bytecode& bytecode);
   absl::Status EvalXor(const Bytecode& bytecode);
 
+  // Superinstructions; see Bytecode::Op.
+  absl::Status EvalLoadLoadBinop(const Bytecode& bytecode);
+  absl::StatusOr<std::optional<int64_t>> EvalLiteralCompareJumpRelIf(
+      int64_t pc, const Bytecode& bytecode);
+  absl::Status EvalLiteralIndexChain(const Bytecode& bytecode);
+
+  // Applies `op` to the top two values on the stack, or to the values of the
+  // slots named by `bytecode` if it is a kLoadLoadBinop, and pushes the result.
   absl::Status EvalBinop(
-      const std::function<absl::StatusOr<InterpValue>(
-          const InterpValue& lhs, const InterpValue& rhs)>& op);
+      const Bytecode& bytecode,
+      absl::FunctionRef<absl::StatusOr<InterpValue>(const InterpValue& lhs,
+                                                    const InterpValue& rhs)>
+          op);
+
+  // Returns the value in the given slot of the current frame.
+  absl::StatusOr<const InterpValue*> GetSlot(Bytecode::SlotIndex slot);
 
   absl::StatusOr<BytecodeFunction*> GetBytecodeFn(
       Function& function, const Invocation* invocation,
@@ -19,6 +19,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -111,6 +112,49 @@ static absl::StatusOr<InterpValue> Interpret(
 static const Pos kFakePos("fake.x", 0, 0);
 static const Span kFakeSpan = Span(kFakePos, kFakePos);
 
+TEST(BytecodeInterpreterTest, SuperinstructionsMatchUnfused) {
+  constexpr std::string_view kProgram = R"(
+fn main(x: u32, y: u32) -> u32 {
+  let t = ((x, y), u32:7);
+  let sum = for (i, acc): (u32, u32) in u32:0..u32:4 {
+    acc + x * i
+  }(x + y);
+  if sum == u32:19 { t.0.1 } else { sum + t.1 }
+}
+)";
+  ImportData import_data(CreateImportDataForTest());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheckOrPrintError(kProgram, &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           tm.module->GetMemberOrError<Function>("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BytecodeFunction> unfused,
+      BytecodeEmitter::Emit(&import_data, tm.type_info, *f, ParametricEnv()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BytecodeFunction> fused,
+      BytecodeEmitter::Emit(
+          &import_data, tm.type_info, *f, ParametricEnv(),
+          BytecodeEmitterOptions{.fuse_superinstructions = true}));
+  std::string fused_text =
+      BytecodesToString(fused->bytecodes(), /*source_locs=*/false);
+  EXPECT_THAT(fused_text, HasSubstr("load_load_binop"));
+  EXPECT_THAT(fused_text, HasSubstr("literal_compare_jump_rel_if"));
+  EXPECT_THAT(fused_text, HasSubstr("literal_index_chain"));
+  EXPECT_LT(fused->bytecodes().size(), unfused->bytecodes().size());
+
+  for (auto [x, y, expected] : std::vector<std::tuple<int, int, int>>{
+           {1, 2, 16}, {2, 5, 5}}) {
+    std::vector<InterpValue> args = {InterpValue::MakeU32(x),
+                                     InterpValue::MakeU32(y)};
+    EXPECT_THAT(
+        BytecodeInterpreter::Interpret(&import_data, unfused.get(), args),
+        IsOkAndHolds(InterpValue::MakeU32(expected)));
+    EXPECT_THAT(BytecodeInterpreter::Interpret(&import_data, fused.get(), args),
+                IsOkAndHolds(InterpValue::MakeU32(expected)));
+  }
+}
+
 TEST(BytecodeInterpreterTest, DupLiteral) {
   std::vector<Bytecode> bytecodes;
   bytecodes.emplace_back(kFakeSpan, Bytecode::Op::kLiteral,
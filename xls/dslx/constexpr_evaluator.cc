@@ -82,6 +82,47 @@ absl::StatusOr<std::unique_ptr<BitsType>> InstantiateParametricNumberType(
       std::get<InterpValue>(e).GetBitValueViaSign().value());
 }
 
+// Folds the binary operation `kind` on bits values the way the bytecode
+// interpreter evaluates it, or returns std::nullopt if `kind` is not one that
+// is folded here.
+absl::StatusOr<std::optional<InterpValue>> FoldBitsBinop(
+    BinopKind kind, const InterpValue& lhs, const InterpValue& rhs) {
+  switch (kind) {
+    case BinopKind::kAdd:
+      return lhs.Add(rhs);
+    case BinopKind::kSub:
+      return lhs.Sub(rhs);
+    case BinopKind::kMul:
+      return lhs.Mul(rhs);
+    case BinopKind::kShl:
+      return lhs.Shl(rhs);
+    case BinopKind::kShr:
+      return lhs.IsSigned() ? lhs.Shra(rhs) : lhs.Shrl(rhs);
+    case BinopKind::kAnd:
+      return lhs.BitwiseAnd(rhs);
+    case BinopKind::kOr:
+      return lhs.BitwiseOr(rhs);
+    case BinopKind::kXor:
+      return lhs.BitwiseXor(rhs);
+    case BinopKind::kConcat:
+      return lhs.Concat(rhs);
+    case BinopKind::kEq:
+      return InterpValue::MakeBool(lhs.Eq(rhs));
+    case BinopKind::kNe:
+      return InterpValue::MakeBool(lhs.Ne(rhs));
+    case BinopKind::kLt:
+      return lhs.Lt(rhs);
+    case BinopKind::kLe:
+      return lhs.Le(rhs);
+    case BinopKind::kGt:
+      return lhs.Gt(rhs);
+    case BinopKind::kGe:
+      return lhs.Ge(rhs);
+    default:
+      return std::nullopt;
+  }
+}
+
 }  // namespace
 
 /* static */ absl::Status ConstexprEvaluator::Evaluate(
@@ -210,8 +251,19 @@ absl::Status ConstexprEvaluator::HandleArray(const Array* expr) {
 
 absl::Status ConstexprEvaluator::HandleBinop(const Binop* expr) {
   VLOG(3) << "ConstexprEvaluator::HandleBinop : " << expr->ToString();
-  EVAL_AS_CONSTEXPR_OR_RETURN(expr->lhs());
-  EVAL_AS_CONSTEXPR_OR_RETURN(expr->rhs());
+  GET_CONSTEXPR_OR_RETURN(InterpValue lhs, expr->lhs());
+  GET_CONSTEXPR_OR_RETURN(InterpValue rhs, expr->rhs());
+
+  // Arithmetic on bits, e.g. in array sizes and parametric bounds, is common
+  // enough that it's worth not firing up the interpreter for.
+  if (lhs.IsBits() && rhs.IsBits()) {
+    XLS_ASSIGN_OR_RETURN(std::optional<InterpValue> folded,
+                         FoldBitsBinop(expr->binop_kind(), lhs, rhs));
+    if (folded.has_value()) {
+      type_info_->NoteConstExpr(expr, *std::move(folded));
+      return absl::OkStatus();
+    }
+  }
   return InterpretExpr(expr);
 }
 
@@ -604,8 +656,17 @@ absl::Status ConstexprEvaluator::HandleConditional(const Conditional* expr) {
 }
 
 absl::Status ConstexprEvaluator::HandleUnop(const Unop* expr) {
-  EVAL_AS_CONSTEXPR_OR_RETURN(expr->operand());
-
+  GET_CONSTEXPR_OR_RETURN(InterpValue operand, expr->operand());
+
+  // No need to fire up the interpreter for bits operands.
+  if (operand.IsBits()) {
+    XLS_ASSIGN_OR_RETURN(InterpValue result,
+                         expr->unop_kind() == UnopKind::kInvert
+                             ? operand.BitwiseNegate()
+                             : operand.ArithmeticNegate());
+    type_info_->NoteConstExpr(expr, result);
+    return absl::OkStatus();
+  }
   return InterpretExpr(expr);
 }
 
@@ -648,6 +709,17 @@ absl::Status ConstexprEvaluator::InterpretExpr(const Expr* expr) {
       env, MakeConstexprEnv(import_data_, type_info_, warning_collector_, expr,
                             bindings_));
 
+  // The value is determined by the expression and the values of the names it
+  // refers to, so evaluations in other type information contexts (e.g. other
+  // instantiations with the same parametrics) can be reused.
+  ParametricEnv env_key(env);
+  if (std::optional<InterpValue> memoized =
+          import_data_->GetMemoizedConstexpr(expr, env_key);
+      memoized.has_value()) {
+    type_info_->NoteConstExpr(expr, *std::move(memoized));
+    return absl::OkStatus();
+  }
+
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<BytecodeFunction> bf,
                        BytecodeEmitter::EmitExpression(import_data_, type_info_,
                                                        expr, env, bindings_));
@@ -665,6 +737,7 @@ absl::Status ConstexprEvaluator::InterpretExpr(const Expr* expr) {
           "constexpr evaluation detected rollover in operation");
     }
   }
+  import_data_->MemoizeConstexpr(expr, std::move(env_key), constexpr_value);
   type_info_->NoteConstExpr(expr, constexpr_value);
 
   return absl::OkStatus();
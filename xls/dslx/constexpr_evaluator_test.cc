@@ -477,6 +477,56 @@ fn main() -> s32 {
   EXPECT_EQ(value.GetBitValueViaSign().value(), -1337);
 }
 
+TEST(ConstexprEvaluatorTest, HandleBinopFoldsBits) {
+  constexpr std::string_view kProgram = R"(
+fn main() -> u32 {
+  (u32:6 + u32:2) << u32:1
+}
+)";
+
+  ImportData import_data(CreateImportDataForTest());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kProgram, "test.x", "test", &import_data));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           tm.module->GetMemberOrError<Function>("main"));
+  Binop* binop = down_cast<Binop*>(GetSingleBodyExpr(f));
+  WarningCollector warnings(kAllWarningsSet);
+  XLS_ASSERT_OK(ConstexprEvaluator::Evaluate(
+      &import_data, tm.type_info, &warnings, ParametricEnv(), binop, nullptr));
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue value,
+                           tm.type_info->GetConstExpr(binop));
+  EXPECT_EQ(value, InterpValue::MakeU32(16));
+  // Folded operations don't need the interpreter and so aren't memoized.
+  EXPECT_FALSE(
+      import_data.GetMemoizedConstexpr(binop, ParametricEnv()).has_value());
+}
+
+TEST(ConstexprEvaluatorTest, InterpretedValuesAreMemoized) {
+  constexpr std::string_view kProgram = R"(
+fn main() -> u32 {
+  u8:42 as u32
+}
+)";
+
+  ImportData import_data(CreateImportDataForTest());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kProgram, "test.x", "test", &import_data));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           tm.module->GetMemberOrError<Function>("main"));
+  Cast* cast = down_cast<Cast*>(GetSingleBodyExpr(f));
+  WarningCollector warnings(kAllWarningsSet);
+  XLS_ASSERT_OK(ConstexprEvaluator::Evaluate(
+      &import_data, tm.type_info, &warnings, ParametricEnv(), cast, nullptr));
+  std::optional<InterpValue> memoized =
+      import_data.GetMemoizedConstexpr(cast, ParametricEnv());
+  ASSERT_TRUE(memoized.has_value());
+  EXPECT_EQ(*memoized, InterpValue::MakeU32(42));
+}
+
 TEST(ConstexprEvaluatorTest, BasicTupleIndex) {
   constexpr std::string_view kProgram = R"(
 fn main() -> u32 {
@@ -189,6 +189,31 @@ class BitVectorCppEmitter : public CppEmitter {
     return absl::StrJoin(pieces, "\n");
   }
 
+  std::string AssignToPacked(std::string_view buffer,
+                             std::string_view bit_offset, std::string_view rhs,
+                             int64_t nesting) const override {
+    return absl::StrFormat("PackBits(static_cast<uint64_t>(%s), %d, %s, %s);",
+                           rhs, dslx_bit_count(), buffer, bit_offset);
+  }
+
+  std::string AssignFromPacked(std::string_view lhs, std::string_view buffer,
+                               std::string_view bit_offset,
+                               int64_t nesting) const override {
+    std::string bits = absl::StrFormat("UnpackBits(%s, %s, %d)", buffer,
+                                       bit_offset, dslx_bit_count());
+    if (cpp_type() == "bool") {
+      return absl::StrFormat("%s = %s != 0;", lhs, bits);
+    }
+    if (is_signed()) {
+      bits = absl::StrFormat("SignExtendBits(%s, %d)", bits, dslx_bit_count());
+    }
+    return absl::StrFormat("%s = static_cast<%s>(%s);", lhs, cpp_type(), bits);
+  }
+
+  std::string PackedBitCount() const override {
+    return absl::StrCat(dslx_bit_count());
+  }
+
   std::string Verify(std::string_view identifier, std::string_view name,
                      int64_t nesting) const override {
     std::vector<std::string> pieces;
@@ -298,6 +323,30 @@ class TypeRefCppEmitter : public CppEmitter {
                          : absl::StrFormat("%sFromValue(%s)", cpp_type(), rhs));
   }
 
+  std::string AssignToPacked(std::string_view buffer,
+                             std::string_view bit_offset, std::string_view rhs,
+                             int64_t nesting) const override {
+    if (TypeHasMethods()) {
+      return absl::StrFormat("%s.ToPacked(%s, %s);", rhs, buffer, bit_offset);
+    }
+    return absl::StrFormat("%sToPacked(%s, %s, %s);", cpp_type(), rhs, buffer,
+                           bit_offset);
+  }
+
+  std::string AssignFromPacked(std::string_view lhs, std::string_view buffer,
+                               std::string_view bit_offset,
+                               int64_t nesting) const override {
+    return absl::StrFormat("%s = %s%sFromPacked(%s, %s);", lhs, cpp_type(),
+                           TypeHasMethods() ? "::" : "", buffer, bit_offset);
+  }
+
+  std::string PackedBitCount() const override {
+    if (TypeHasMethods()) {
+      return absl::StrFormat("%s::kPackedBitCount", cpp_type());
+    }
+    return absl::StrFormat("k%sPackedBitCount", cpp_type());
+  }
+
   std::string Verify(std::string_view identifier, std::string_view name,
                      int64_t nesting) const override {
     return absl::StrFormat(
@@ -428,6 +477,41 @@ class ArrayCppEmitter : public CppEmitter {
     return absl::StrJoin(pieces, "\n");
   }
 
+  std::string AssignToPacked(std::string_view buffer,
+                             std::string_view bit_offset, std::string_view rhs,
+                             int64_t nesting) const override {
+    std::string ind_var = absl::StrCat("i", nesting);
+    std::vector<std::string> pieces;
+    pieces.push_back(absl::StrFormat("for (int64_t %s = 0; %s < %d; ++%s) {",
+                                     ind_var, ind_var, array_size(), ind_var));
+    std::string element_assignment = element_emitter_->AssignToPacked(
+        buffer, ElementBitOffset(bit_offset, ind_var),
+        absl::StrFormat("%s[%s]", rhs, ind_var), nesting + 1);
+    pieces.push_back(Indent(element_assignment, 2));
+    pieces.push_back("}");
+    return absl::StrJoin(pieces, "\n");
+  }
+
+  std::string AssignFromPacked(std::string_view lhs, std::string_view buffer,
+                               std::string_view bit_offset,
+                               int64_t nesting) const override {
+    std::string ind_var = absl::StrCat("i", nesting);
+    std::vector<std::string> pieces;
+    pieces.push_back(absl::StrFormat("for (int64_t %s = 0; %s < %d; ++%s) {",
+                                     ind_var, ind_var, array_size(), ind_var));
+    std::string element_assignment = element_emitter_->AssignFromPacked(
+        absl::StrFormat("%s[%s]", lhs, ind_var), buffer,
+        ElementBitOffset(bit_offset, ind_var), nesting + 1);
+    pieces.push_back(Indent(element_assignment, 2));
+    pieces.push_back("}");
+    return absl::StrJoin(pieces, "\n");
+  }
+
+  std::string PackedBitCount() const override {
+    return absl::StrFormat("%d * (%s)", array_size(),
+                           element_emitter_->PackedBitCount());
+  }
+
   std::string Verify(std::string_view identifier, std::string_view name,
                      int64_t nesting) const override {
     std::string ind_var = absl::StrCat("i", nesting);
@@ -468,6 +552,14 @@ class ArrayCppEmitter : public CppEmitter {
   int64_t array_size() const { return array_size_; }
 
  protected:
+  // Returns the bit offset of the element with index `ind_var` of an array
+  // packed at `bit_offset`. Element 0 is at the lowest offset.
+  std::string ElementBitOffset(std::string_view bit_offset,
+                               std::string_view ind_var) const {
+    return absl::StrFormat("%s + %s * (%s)", bit_offset, ind_var,
+                           element_emitter_->PackedBitCount());
+  }
+
   // Emits the C++ code for printing the array using the specified emitter
   // function.
   std::string EmitToString(
@@ -566,6 +658,40 @@ class TupleCppEmitter : public CppEmitter {
     return absl::StrJoin(pieces, "\n");
   }
 
+  std::string AssignToPacked(std::string_view buffer,
+                             std::string_view bit_offset, std::string_view rhs,
+                             int64_t nesting) const override {
+    std::vector<std::string> pieces;
+    for (int64_t i = 0; i < size(); ++i) {
+      pieces.push_back(element_emitters_[i]->AssignToPacked(
+          buffer, ElementBitOffset(bit_offset, i),
+          absl::StrFormat("std::get<%d>(%s)", i, rhs), nesting + 1));
+    }
+    return absl::StrJoin(pieces, "\n");
+  }
+
+  std::string AssignFromPacked(std::string_view lhs, std::string_view buffer,
+                               std::string_view bit_offset,
+                               int64_t nesting) const override {
+    std::vector<std::string> pieces;
+    for (int64_t i = 0; i < size(); ++i) {
+      pieces.push_back(element_emitters_[i]->AssignFromPacked(
+          absl::StrFormat("std::get<%d>(%s)", i, lhs), buffer,
+          ElementBitOffset(bit_offset, i), nesting + 1));
+    }
+    return absl::StrJoin(pieces, "\n");
+  }
+
+  std::string PackedBitCount() const override {
+    if (element_emitters_.empty()) {
+      return "0";
+    }
+    return absl::StrJoin(element_emitters_, " + ",
+                         [](std::string* out, const auto& emitter) {
+                           absl::StrAppend(out, emitter->PackedBitCount());
+                         });
+  }
+
   std::string Verify(std::string_view identifier, std::string_view name,
                      int64_t nesting) const override {
     std::vector<std::string> pieces;
@@ -621,6 +747,17 @@ class TupleCppEmitter : public CppEmitter {
   int64_t size() const { return element_emitters_.size(); }
 
  protected:
+  // Returns the bit offset of element `index` of a tuple packed at
+  // `bit_offset`. The last element is at the lowest offset.
+  std::string ElementBitOffset(std::string_view bit_offset,
+                               int64_t index) const {
+    std::string offset(bit_offset);
+    for (int64_t i = index + 1; i < size(); ++i) {
+      absl::StrAppend(&offset, " + ", element_emitters_[i]->PackedBitCount());
+    }
+    return offset;
+  }
+
   std::vector<std::unique_ptr<CppEmitter>> element_emitters_;
 };
 
@@ -55,6 +55,29 @@ class CppEmitter {
                                       std::string_view rhs,
                                       int64_t nesting) const = 0;
 
+  // Emits and returns c++ code which writes `rhs` of `cpp_type()` in the packed
+  // layout used by the JIT's packed views (see xls/ir/value_view.h) to the
+  // `uint8_t*` named `buffer`, starting `bit_offset` bits in. In this layout
+  // values are tightly packed little-endian bit strings: array element 0 is at
+  // the lowest offset and tuple (or struct) element 0 at the highest.
+  // `bit_offset` is a C++ expression.
+  virtual std::string AssignToPacked(std::string_view buffer,
+                                     std::string_view bit_offset,
+                                     std::string_view rhs,
+                                     int64_t nesting) const = 0;
+
+  // Emits and returns c++ code which reads the packed value starting
+  // `bit_offset` bits into `buffer` (see AssignToPacked) and assigns it to
+  // `lhs` of `cpp_type()`.
+  virtual std::string AssignFromPacked(std::string_view lhs,
+                                       std::string_view buffer,
+                                       std::string_view bit_offset,
+                                       int64_t nesting) const = 0;
+
+  // Returns a C++ constant expression for the number of bits in the packed
+  // layout of the underlying DSLX type.
+  virtual std::string PackedBitCount() const = 0;
+
   // Emits and returns c++ code which verifies that `identifier` of type
   // `cpp_type()` is properly formed. `name` is a descriptive string (e.g., type
   // or field name) which can be used in an error message. The code will raise
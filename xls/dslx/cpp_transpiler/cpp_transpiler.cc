@@ -36,7 +36,8 @@ namespace xls::dslx {
 absl::StatusOr<CppSource> TranspileToCpp(Module* module,
                                          ImportData* import_data,
                                          std::string_view output_header_path,
-                                         std::string_view namespaces) {
+                                         std::string_view namespaces,
+                                         bool emit_packed_conversions) {
   constexpr std::string_view kHeaderTemplate =
       R"(// AUTOMATICALLY GENERATED FILE FROM `xls/dslx/cpp_transpiler`. DO NOT EDIT!
 #ifndef $0
@@ -92,8 +93,52 @@ static bool FitsInNBitsUnsigned(uint64_t value, int64_t n) {
 static std::string __indent(int64_t amount) {
   return std::string(amount * 2, ' ');
 }
-
+%s
 %s%s%s
+)";
+  // Helpers for the packed layout conversions, see CppEmitter::AssignToPacked.
+  constexpr std::string_view kPackedHelpers = R"(
+// Writes the low `bit_count` bits of `value` to `buffer` starting
+// `bit_offset` bits in, least significant bit first.
+static void PackBits(uint64_t value, int64_t bit_count, uint8_t* buffer,
+                     int64_t bit_offset) {
+  while (bit_count > 0) {
+    int64_t shift = bit_offset & 7;
+    int64_t chunk = 8 - shift < bit_count ? 8 - shift : bit_count;
+    uint8_t mask = static_cast<uint8_t>(((1 << chunk) - 1) << shift);
+    uint8_t& byte = buffer[bit_offset / 8];
+    byte = (byte & ~mask) | (static_cast<uint8_t>(value << shift) & mask);
+    value >>= chunk;
+    bit_offset += chunk;
+    bit_count -= chunk;
+  }
+}
+
+// Reads `bit_count` bits written by PackBits. Bits past the 64th are dropped.
+static uint64_t UnpackBits(const uint8_t* buffer, int64_t bit_offset,
+                           int64_t bit_count) {
+  uint64_t value = 0;
+  for (int64_t done = 0; done < bit_count;) {
+    int64_t shift = bit_offset & 7;
+    int64_t chunk = 8 - shift < bit_count - done ? 8 - shift : bit_count - done;
+    if (done < 64) {
+      uint64_t bits = (buffer[bit_offset / 8] >> shift) & ((1 << chunk) - 1);
+      value |= bits << done;
+    }
+    bit_offset += chunk;
+    done += chunk;
+  }
+  return value;
+}
+
+// Sign-extends the `bit_count`-bit value `value` to 64 bits.
+static int64_t SignExtendBits(uint64_t value, int64_t bit_count) {
+  if (bit_count >= 64) {
+    return static_cast<int64_t>(value);
+  }
+  uint64_t sign = uint64_t{1} << (bit_count - 1);
+  return static_cast<int64_t>((value ^ sign) - sign);
+}
 )";
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
                        import_data->GetRootTypeInfo(module));
@@ -101,7 +146,8 @@ static std::string __indent(int64_t amount) {
   std::vector<std::string> source;
   for (const TypeDefinition& def : module->GetTypeDefinitions()) {
     XLS_ASSIGN_OR_RETURN(std::unique_ptr<CppTypeGenerator> generator,
-                         CppTypeGenerator::Create(def, type_info, import_data));
+                         CppTypeGenerator::Create(def, type_info, import_data,
+                                                  emit_packed_conversions));
     XLS_ASSIGN_OR_RETURN(CppSource result, generator->GetCppSource());
     header.push_back(result.header);
     source.push_back(result.source);
@@ -128,8 +174,10 @@ static std::string __indent(int64_t amount) {
       absl::Substitute(kHeaderTemplate, header_guard,
                        absl::StrJoin(header, "\n\n"), namespace_begin,
                        namespace_end),
-      absl::StrFormat(kSourceTemplate, output_header_path, namespace_begin,
-                      absl::StrJoin(source, "\n\n"), namespace_end)};
+      absl::StrFormat(kSourceTemplate, output_header_path,
+                      emit_packed_conversions ? kPackedHelpers : "",
+                      namespace_begin, absl::StrJoin(source, "\n\n"),
+                      namespace_end)};
 }
 
 }  // namespace xls::dslx
@@ -38,10 +38,16 @@ namespace xls::dslx {
 // should be infrequent, so users should feel comfortable using these
 // interfaces, but should also be aware of the potential for change in the
 // future.
+//
+// If `emit_packed_conversions` is true the generated types can also be
+// converted directly to and from the packed layout taken by the JIT's packed
+// views (e.g. `FunctionJit::RunWithPackedViews`), without going through
+// ::xls::Value.
 absl::StatusOr<CppSource> TranspileToCpp(Module* module,
                                          ImportData* import_data,
                                          std::string_view output_header_path,
-                                         std::string_view namespaces = "");
+                                         std::string_view namespaces = "",
+                                         bool emit_packed_conversions = false);
 
 }  // namespace xls::dslx
 
@@ -43,6 +43,9 @@ ABSL_FLAG(std::string, namespaces, "",
           "\"::my::explicitly::top::level::namespace\".");
 ABSL_FLAG(std::string, dslx_stdlib_path, xls::kDefaultDslxStdlibPath,
           "Path to DSLX standard library");
+ABSL_FLAG(bool, emit_packed_conversions, false,
+          "Whether to also emit conversions of the generated types to and from "
+          "the packed layout taken by the JIT's packed views.");
 
 namespace xls {
 namespace dslx {
@@ -61,7 +64,8 @@ absl::Status RealMain(const std::filesystem::path& module_path,
                       const std::filesystem::path& dslx_stdlib_path,
                       std::string_view output_header_path,
                       std::string_view output_source_path,
-                      std::string_view namespaces) {
+                      std::string_view namespaces,
+                      bool emit_packed_conversions) {
   XLS_ASSIGN_OR_RETURN(std::string module_text, GetFileContents(module_path));
 
   ImportData import_data(CreateImportData(
@@ -72,7 +76,7 @@ absl::Status RealMain(const std::filesystem::path& module_path,
   XLS_ASSIGN_OR_RETURN(
       CppSource sources,
       TranspileToCpp(module.module, &import_data, output_header_path,
-                     std::string(namespaces)));
+                     std::string(namespaces), emit_packed_conversions));
 
   XLS_RETURN_IF_ERROR(SetFileContents(output_header_path, sources.header));
   XLS_RETURN_IF_ERROR(SetFileContents(output_source_path, sources.source));
@@ -98,7 +102,8 @@ int main(int argc, char* argv[]) {
       << "--output_source_path must be specified.";
   return xls::ExitStatus(xls::dslx::RealMain(
       args[0], absl::GetFlag(FLAGS_dslx_stdlib_path), output_header_path,
-      output_source_path, absl::GetFlag(FLAGS_namespaces)));
+      output_source_path, absl::GetFlag(FLAGS_namespaces),
+      absl::GetFlag(FLAGS_emit_packed_conversions)));
 
   return 0;
 }
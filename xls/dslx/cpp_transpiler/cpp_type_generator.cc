@@ -54,6 +54,48 @@ absl::StatusOr<InterpValue> InterpretExpr(
   return BytecodeInterpreter::Interpret(import_data, bf.get(), /*args=*/{});
 }
 
+// Returns the definition of the constant holding the packed bit count of a
+// non-struct type, which CppEmitters refer to for type refs.
+std::string PackedBitCountDef(std::string_view cpp_type,
+                              const CppEmitter& emitter) {
+  return absl::StrFormat("constexpr int64_t k%sPackedBitCount = %s;", cpp_type,
+                         emitter.PackedBitCount());
+}
+
+// Returns the free functions converting values of the non-struct type
+// `cpp_type`, passed as `value_parameter`, to and from the packed layout.
+// `emitter` handles the underlying C++ type; `value` is the expression
+// converting the parameter to it.
+std::vector<CppSource> PackedFunctions(std::string_view cpp_type,
+                                       std::string_view value_parameter,
+                                       const CppEmitter& emitter,
+                                       std::string_view value) {
+  std::string to_signature =
+      absl::StrFormat("void %sToPacked(%s, uint8_t* buffer, int64_t bit_offset",
+                      cpp_type, value_parameter);
+  std::string from_signature = absl::StrFormat(
+      "%s %sFromPacked(const uint8_t* buffer, int64_t bit_offset", cpp_type,
+      cpp_type);
+  std::string to_body = emitter.AssignToPacked("buffer", "bit_offset", value,
+                                               /*nesting=*/0);
+  std::vector<std::string> from_pieces;
+  from_pieces.push_back(absl::StrFormat("%s result;", emitter.cpp_type()));
+  from_pieces.push_back(emitter.AssignFromPacked("result", "buffer",
+                                                 "bit_offset", /*nesting=*/0));
+  from_pieces.push_back(
+      emitter.cpp_type() == cpp_type
+          ? "return result;"
+          : absl::StrFormat("return static_cast<%s>(result);", cpp_type));
+  std::string from_body = absl::StrJoin(from_pieces, "\n");
+  return {
+      CppSource{.header = absl::StrCat(to_signature, " = 0);"),
+                .source = absl::StrFormat("%s) {\n%s\n}", to_signature,
+                                          Indent(to_body, 2))},
+      CppSource{.header = absl::StrCat(from_signature, " = 0);"),
+                .source = absl::StrFormat("%s) {\n%s\n}", from_signature,
+                                          Indent(from_body, 2))}};
+}
+
 // A type generator for emitting a C++ enum representing a dslx::EnumDef.
 class EnumCppTypeGenerator : public CppTypeGenerator {
  public:
@@ -96,15 +138,31 @@ class EnumCppTypeGenerator : public CppTypeGenerator {
     CppSource from_value = FromValueFunction();
     CppSource verify = VerifyFunction();
 
-    return CppSource{.header = absl::StrJoin(
-                         {enum_decl, num_elements_def, width_def,
-                          to_string.header, to_dslx_string.header,
-                          to_value.header, from_value.header, verify.header},
-                         "\n"),
-                     .source = absl::StrJoin(
-                         {to_string.source, to_dslx_string.source,
-                          to_value.source, from_value.source, verify.source},
-                         "\n\n")};
+    std::vector<std::string> hdr_pieces = {
+        enum_decl,
+        num_elements_def,
+        width_def,
+        to_string.header,
+        to_dslx_string.header,
+        to_value.header,
+        from_value.header,
+        verify.header,
+    };
+    std::vector<std::string> src_pieces = {
+        to_string.source,  to_dslx_string.source, to_value.source,
+        from_value.source, verify.source,
+    };
+    if (emit_packed_conversions_) {
+      hdr_pieces.push_back(PackedBitCountDef(cpp_type(), *emitter_));
+      for (const CppSource& packed :
+           PackedFunctions(cpp_type(), absl::StrCat(cpp_type(), " value"),
+                           *emitter_, CastToCppBaseType("value"))) {
+        hdr_pieces.push_back(packed.header);
+        src_pieces.push_back(packed.source);
+      }
+    }
+    return CppSource{.header = absl::StrJoin(hdr_pieces, "\n"),
+                     .source = absl::StrJoin(src_pieces, "\n\n")};
   }
 
   int64_t dslx_bit_count() const {
@@ -301,12 +359,21 @@ class TypeAliasCppTypeGenerator : public CppTypeGenerator {
     hdr_pieces.push_back(to_dslx_string_src.header);
     hdr_pieces.push_back(to_value_src.header);
     hdr_pieces.push_back(from_value_src.header);
-    return CppSource{
-        .header = absl::StrJoin(hdr_pieces, "\n"),
-        .source = absl::StrJoin(
-            {verify_src.source, to_string_src.source, to_dslx_string_src.source,
-             to_value_src.source, from_value_src.source},
-            "\n\n")};
+    std::vector<std::string> src_pieces = {
+        verify_src.source,   to_string_src.source,  to_dslx_string_src.source,
+        to_value_src.source, from_value_src.source,
+    };
+    if (emit_packed_conversions_) {
+      hdr_pieces.push_back(PackedBitCountDef(cpp_type(), *emitter_));
+      for (const CppSource& packed :
+           PackedFunctions(cpp_type(), GetValueParameter("value"), *emitter_,
+                           "value")) {
+        hdr_pieces.push_back(packed.header);
+        src_pieces.push_back(packed.source);
+      }
+    }
+    return CppSource{.header = absl::StrJoin(hdr_pieces, "\n"),
+                     .source = absl::StrJoin(src_pieces, "\n\n")};
   }
 
  protected:
@@ -479,21 +546,95 @@ class StructCppTypeGenerator : public CppTypeGenerator {
         "bool operator!=(const %s& other) const { return !(*this == other); }",
         cpp_type()));
     hdr_pieces.push_back(operator_stream_method.header);
+    std::vector<std::string> src_pieces = {
+        from_value_method.source,      to_value_method.source,
+        to_string_method.source,       to_dslx_string_method.source,
+        verify_method.source,          operator_eq_method.source,
+        operator_stream_method.source,
+    };
+    if (emit_packed_conversions_) {
+      CppSource to_packed_method = ToPackedMethod();
+      CppSource from_packed_method = FromPackedMethod();
+      hdr_pieces.push_back("");
+      hdr_pieces.push_back(absl::StrFormat(
+          "static constexpr int64_t kPackedBitCount = %s;", PackedBitCount()));
+      hdr_pieces.push_back(
+          "static constexpr int64_t kPackedByteCount = (kPackedBitCount + 7) / "
+          "8;");
+      hdr_pieces.push_back(to_packed_method.header);
+      hdr_pieces.push_back(from_packed_method.header);
+      src_pieces.push_back(to_packed_method.source);
+      src_pieces.push_back(from_packed_method.source);
+    }
 
     std::string members = absl::StrJoin(hdr_pieces, "\n");
 
     std::string header =
         absl::StrFormat("struct %s {\n%s\n};", cpp_type(), Indent(members, 2));
-    std::string source =
-        absl::StrJoin({from_value_method.source, to_value_method.source,
-                       to_string_method.source, to_dslx_string_method.source,
-                       verify_method.source, operator_eq_method.source,
-                       operator_stream_method.source},
-                      "\n\n");
+    std::string source = absl::StrJoin(src_pieces, "\n\n");
     return CppSource{.header = header, .source = source};
   }
 
  protected:
+  std::string PackedBitCount() const {
+    if (member_emitters_.empty()) {
+      return "0";
+    }
+    return absl::StrJoin(member_emitters_, " + ",
+                         [](std::string* out, const auto& emitter) {
+                           absl::StrAppend(out, emitter->PackedBitCount());
+                         });
+  }
+
+  // Returns the bit offset of member `index` relative to the start of the
+  // packed struct. As with tuples the last member is at the lowest offset.
+  std::string MemberBitOffset(int64_t index) const {
+    std::string offset = "bit_offset";
+    for (int64_t i = index + 1; i < member_emitters_.size(); ++i) {
+      absl::StrAppend(&offset, " + ", member_emitters_[i]->PackedBitCount());
+    }
+    return offset;
+  }
+
+  CppSource ToPackedMethod() const {
+    std::vector<std::string> pieces;
+    for (int i = 0; i < struct_def_->members().size(); i++) {
+      pieces.push_back(member_emitters_[i]->AssignToPacked(
+          "buffer", MemberBitOffset(i), struct_def_->GetMemberName(i),
+          /*nesting=*/0));
+    }
+    std::string body = absl::StrJoin(pieces, "\n");
+
+    return CppSource{
+        .header = "void ToPacked(uint8_t* buffer, int64_t bit_offset = 0) "
+                  "const;",
+        .source = absl::StrFormat(
+            "void %s::ToPacked(uint8_t* buffer, int64_t bit_offset) const "
+            "{\n%s\n}",
+            cpp_type(), Indent(body, 2))};
+  }
+
+  CppSource FromPackedMethod() const {
+    std::vector<std::string> pieces;
+    pieces.push_back(absl::StrFormat("%s result;", cpp_type()));
+    for (int i = 0; i < struct_def_->members().size(); i++) {
+      pieces.push_back(member_emitters_[i]->AssignFromPacked(
+          absl::StrFormat("result.%s", struct_def_->GetMemberName(i)),
+          "buffer", MemberBitOffset(i), /*nesting=*/0));
+    }
+    pieces.push_back("return result;");
+    std::string body = absl::StrJoin(pieces, "\n");
+
+    return CppSource{
+        .header = absl::StrFormat("static %s FromPacked(const uint8_t* buffer, "
+                                  "int64_t bit_offset = 0);",
+                                  cpp_type()),
+        .source = absl::StrFormat(
+            "%s %s::FromPacked(const uint8_t* buffer, int64_t bit_offset) "
+            "{\n%s\n}",
+            cpp_type(), cpp_type(), Indent(body, 2))};
+  }
+
   CppSource FromValueMethod() const {
     std::vector<std::string> pieces;
     pieces.push_back(absl::StrFormat(
@@ -656,29 +797,34 @@ class StructCppTypeGenerator : public CppTypeGenerator {
 
 /* static */ absl::StatusOr<std::unique_ptr<CppTypeGenerator>>
 CppTypeGenerator::Create(const TypeDefinition& type_definition,
-                         TypeInfo* type_info, ImportData* import_data) {
-  return absl::visit(
-      Visitor{[&](const TypeAlias* type_alias)
-                  -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
-                return TypeAliasCppTypeGenerator::Create(type_alias, type_info,
-                                                         import_data);
-              },
-              [&](const StructDef* struct_def)
-                  -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
-                return StructCppTypeGenerator::Create(struct_def, type_info,
-                                                      import_data);
-              },
-              [&](const EnumDef* enum_def)
-                  -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
-                return EnumCppTypeGenerator::Create(enum_def, type_info,
-                                                    import_data);
-              },
-              [&](const ColonRef* colon_ref)
-                  -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
-                return absl::UnimplementedError(absl::StrFormat(
-                    "Unsupported type: %s", colon_ref->ToString()));
-              }},
-      type_definition);
+                         TypeInfo* type_info, ImportData* import_data,
+                         bool emit_packed_conversions) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<CppTypeGenerator> generator,
+      absl::visit(
+          Visitor{[&](const TypeAlias* type_alias)
+                      -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
+                    return TypeAliasCppTypeGenerator::Create(
+                        type_alias, type_info, import_data);
+                  },
+                  [&](const StructDef* struct_def)
+                      -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
+                    return StructCppTypeGenerator::Create(struct_def, type_info,
+                                                          import_data);
+                  },
+                  [&](const EnumDef* enum_def)
+                      -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
+                    return EnumCppTypeGenerator::Create(enum_def, type_info,
+                                                        import_data);
+                  },
+                  [&](const ColonRef* colon_ref)
+                      -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
+                    return absl::UnimplementedError(absl::StrFormat(
+                        "Unsupported type: %s", colon_ref->ToString()));
+                  }},
+          type_definition));
+  generator->emit_packed_conversions_ = emit_packed_conversions;
+  return generator;
 }
 
 }  // namespace xls::dslx
@@ -52,14 +52,18 @@ class CppTypeGenerator {
   // not a tuple or array).
   std::string dslx_type() const { return dslx_type_; }
 
-  // Returns a type generator for the given TypeDefinition.
+  // Returns a type generator for the given TypeDefinition. If
+  // `emit_packed_conversions` is true the generated code also converts to and
+  // from the packed layout taken by the JIT's packed views, which avoids
+  // building ::xls::Value objects (see CppEmitter::AssignToPacked).
   static absl::StatusOr<std::unique_ptr<CppTypeGenerator>> Create(
       const TypeDefinition& type_definition, TypeInfo* type_info,
-      ImportData* import_data);
+      ImportData* import_data, bool emit_packed_conversions = false);
 
  protected:
   std::string cpp_type_;
   std::string dslx_type_;
+  bool emit_packed_conversions_ = false;
 };
 
 }  // namespace xls::dslx
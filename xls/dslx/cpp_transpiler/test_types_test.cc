@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <array>
+#include <cstdint>
+
 #include "absl/status/status.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -618,5 +621,55 @@ TEST(TestTypesTest, SnakeCaseToString) {
 })");
 }
 
+TEST(TestTypesTest, StructToPacked) {
+  test::InnerStruct s{.x = 0x12345, .y = test::MyEnum::kC};
+  static_assert(test::InnerStruct::kPackedBitCount == 24);
+  std::array<uint8_t, test::InnerStruct::kPackedByteCount> buffer;
+  s.ToPacked(buffer.data());
+  // The last member is in the least significant bits.
+  EXPECT_EQ(buffer, (std::array<uint8_t, 3>{0xaa, 0xa2, 0x91}));
+  EXPECT_EQ(test::InnerStruct::FromPacked(buffer.data()), s);
+}
+
+TEST(TestTypesTest, PackedRoundTrip) {
+  test::InnerStruct a{.x = 42, .y = test::MyEnum::kB};
+  test::InnerStruct b{.x = 0x1ffff, .y = test::MyEnum::kC};
+  test::OuterStruct o{.a = a, .b = b, .c = 0xdead, .v = test::MyEnum::kA};
+  test::OuterOuterStruct s{
+      .q = test::EmptyStruct(), .some_array = {1, 2, 3}, .s = o};
+  // Pack at an unaligned offset into a buffer of ones to check that only the
+  // value's own bits are written.
+  std::array<uint8_t, test::OuterOuterStruct::kPackedByteCount + 1> buffer;
+  buffer.fill(0xff);
+  s.ToPacked(buffer.data(), /*bit_offset=*/3);
+  EXPECT_EQ(buffer[0] & 0x7, 0x7);
+  EXPECT_EQ(test::OuterOuterStruct::FromPacked(buffer.data(), 3), s);
+
+  test::StructWithLotsOfTypes t{
+      .v = true, .w = 5, .x = false, .y = 0xabcdef12345, .z = -5};
+  std::array<uint8_t, test::StructWithLotsOfTypes::kPackedByteCount> t_buffer;
+  t.ToPacked(t_buffer.data());
+  EXPECT_EQ(test::StructWithLotsOfTypes::FromPacked(t_buffer.data()), t);
+}
+
+TEST(TestTypesTest, AliasToPacked) {
+  static_assert(test::kMySignedTypePackedBitCount == 20);
+  std::array<uint8_t, 3> buffer = {};
+  test::MySignedTypeToPacked(-3, buffer.data());
+  EXPECT_EQ(buffer, (std::array<uint8_t, 3>{0xfd, 0xff, 0x0f}));
+  EXPECT_EQ(test::MySignedTypeFromPacked(buffer.data()), -3);
+
+  test::MyTuple tuple = {0x123456789, -2, 0x1deadbeef, -1000};
+  std::array<uint8_t, (test::kMyTuplePackedBitCount + 7) / 8> tuple_buffer;
+  test::MyTupleToPacked(tuple, tuple_buffer.data());
+  EXPECT_EQ(test::MyTupleFromPacked(tuple_buffer.data()), tuple);
+
+  test::MyArrayOfArrays arrays = {{{1, 2}, {3, 4}, {5, 31}}};
+  std::array<uint8_t, (test::kMyArrayOfArraysPackedBitCount + 7) / 8>
+      arrays_buffer;
+  test::MyArrayOfArraysToPacked(arrays, arrays_buffer.data());
+  EXPECT_EQ(test::MyArrayOfArraysFromPacked(arrays_buffer.data()), arrays);
+}
+
 }  // namespace
 }  // namespace xls
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <iostream>
 #include <memory>
@@ -55,6 +56,9 @@ ABSL_FLAG(
     "somewhat slower) -- note that this can flag false positive, e.g. in cases "
     "such as doubled parentheses that cannot be checked via regexp "
     "equivalence");
+ABSL_FLAG(int64_t, threads, 1,
+          "Number of threads used to format the module members in autofmt "
+          "mode. Each member is formatted by a single thread.");
 
 namespace xls::dslx {
 namespace {
@@ -66,7 +70,7 @@ Formats the DSLX source code present inside of a `.x` file.
 absl::Status RealMain(std::string_view input_path,
                       absl::Span<const std::filesystem::path> dslx_paths,
                       bool in_place, bool opportunistic_postcondition,
-                      const std::string& mode) {
+                      const std::string& mode, int64_t thread_count) {
   if (input_path == "-") {
     input_path = "/dev/stdin";
   }
@@ -81,7 +85,8 @@ absl::Status RealMain(std::string_view input_path,
     XLS_ASSIGN_OR_RETURN(
         std::unique_ptr<Module> module,
         ParseModule(contents, path.c_str(), module_name, &comments));
-    formatted = AutoFmt(*module, Comments::Create(comments));
+    formatted = AutoFmt(*module, Comments::Create(comments),
+                        kDslxDefaultTextWidth, thread_count);
   } else if (mode == "typecheck") {
     // Note: we don't flag any warnings in this binary as we're just formatting
     // the text.
@@ -148,6 +153,7 @@ int main(int argc, char* argv[]) {
                           /*in_place=*/absl::GetFlag(FLAGS_i),
                           /*opportunistic_postcondition=*/
                           absl::GetFlag(FLAGS_opportunistic_postcondition),
-                          /*mode=*/absl::GetFlag(FLAGS_mode));
+                          /*mode=*/absl::GetFlag(FLAGS_mode),
+                          /*thread_count=*/absl::GetFlag(FLAGS_threads));
   return xls::ExitStatus(status);
 }
@@ -15,11 +15,13 @@
 #include "xls/dslx/fmt/ast_fmt.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <initializer_list>
 #include <limits>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -27,7 +29,7 @@
 #include <variant>
 #include <vector>
 
-#include "absl/container/flat_hash_map.h"
+#include "absl/container/btree_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -35,8 +37,10 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
+#include "xls/common/thread.h"
 #include "xls/common/visitor.h"
 #include "xls/dslx/channel_direction.h"
 #include "xls/dslx/fmt/pretty_print.h"
@@ -358,17 +362,26 @@ DocRef Fmt(const WildcardPattern& n, const Comments& comments,
   return arena.underscore();
 }
 
+static DocRef FmtDocRef(const DocRef& n, const Comments& comments,
+                        DocArena& arena) {
+  return n;
+}
+
+// Note: the type annotation and member docs are shared with the non-flat
+// version; formatting them separately for each would make the cost of nested
+// arrays exponential in their depth.
 static DocRef FmtFlat(const Array& n, const Comments& comments,
-                      DocArena& arena) {
+                      std::optional<DocRef> type_doc,
+                      absl::Span<const DocRef> member_docs, DocArena& arena) {
   std::vector<DocRef> flat_pieces;
-  if (TypeAnnotation* t = n.type_annotation()) {
-    flat_pieces.push_back(Fmt(*t, comments, arena));
+  if (type_doc.has_value()) {
+    flat_pieces.push_back(type_doc.value());
     flat_pieces.push_back(arena.colon());
   }
 
   flat_pieces.push_back(arena.obracket());
-  flat_pieces.push_back(FmtJoin<const Expr*>(n.members(), Joiner::kCommaSpace,
-                                             FmtExprPtr, comments, arena));
+  flat_pieces.push_back(FmtJoin<DocRef>(member_docs, Joiner::kCommaSpace,
+                                        FmtDocRef, comments, arena));
   if (n.has_ellipsis()) {
     // Note: while zero members with ellipsis is invalid at type checking, we
     // may choose not to flag it as a parse-time error, in which case we could
@@ -385,9 +398,11 @@ static DocRef FmtFlat(const Array& n, const Comments& comments,
 }
 
 DocRef Fmt(const Array& n, const Comments& comments, DocArena& arena) {
+  std::optional<DocRef> type_doc;
   std::vector<DocRef> leader_pieces;
   if (TypeAnnotation* t = n.type_annotation()) {
-    leader_pieces.push_back(Fmt(*t, comments, arena));
+    type_doc = Fmt(*t, comments, arena);
+    leader_pieces.push_back(type_doc.value());
     leader_pieces.push_back(arena.colon());
   }
   leader_pieces.push_back(arena.obracket());
@@ -396,9 +411,15 @@ DocRef Fmt(const Array& n, const Comments& comments, DocArena& arena) {
   pieces.push_back(ConcatNGroup(arena, leader_pieces));
   pieces.push_back(arena.break0());
 
+  std::vector<DocRef> member_docs;
+  member_docs.reserve(n.members().size());
+  for (const Expr* member : n.members()) {
+    member_docs.push_back(FmtExprPtr(member, comments, arena));
+  }
+
   std::vector<DocRef> member_pieces;
-  member_pieces.push_back(FmtJoin<const Expr*>(
-      n.members(), Joiner::kCommaBreak1AsGroupTrailingCommaAlways, FmtExprPtr,
+  member_pieces.push_back(FmtJoin<DocRef>(
+      member_docs, Joiner::kCommaBreak1AsGroupTrailingCommaAlways, FmtDocRef,
       comments, arena));
 
   if (n.has_ellipsis()) {
@@ -412,7 +433,7 @@ DocRef Fmt(const Array& n, const Comments& comments, DocArena& arena) {
   pieces.push_back(arena.cbracket());
 
   DocRef non_flat = ConcatN(arena, pieces);
-  DocRef flat = FmtFlat(n, comments, arena);
+  DocRef flat = FmtFlat(n, comments, type_doc, member_docs, arena);
 
   return arena.MakeFlatChoice(/*on_flat=*/flat, /*on_break=*/non_flat);
 }
@@ -1461,7 +1482,7 @@ DocRef FmtLetWithSemi(const Let& n, const Comments& comments, DocArena& arena,
 
 /* static */ Comments Comments::Create(absl::Span<const CommentData> comments) {
   std::optional<Pos> last_data_limit;
-  absl::flat_hash_map<int64_t, CommentData> line_to_comment;
+  absl::btree_map<int64_t, CommentData> line_to_comment;
   for (const CommentData& cd : comments) {
     VLOG(3) << "comment on line: " << cd.span.start().lineno();
     // Note: we don't have multi-line comments for now, so we just note the
@@ -1477,33 +1498,29 @@ DocRef FmtLetWithSemi(const Let& n, const Comments& comments, DocArena& arena,
 }
 
 bool Comments::HasComments(const Span& in_span) const {
-  for (int64_t i = in_span.start().lineno(); i <= in_span.limit().lineno();
-       ++i) {
-    if (auto it = line_to_comment_.find(i); it != line_to_comment_.end()) {
-      return true;
-    }
-  }
-  return false;
+  auto it = line_to_comment_.lower_bound(in_span.start().lineno());
+  return it != line_to_comment_.end() &&
+         it->first <= in_span.limit().lineno();
 }
 
 std::vector<const CommentData*> Comments::GetComments(
     const Span& node_span) const {
   VLOG(3) << "GetComments; node_span: " << node_span;
 
-  // Implementation note: this will typically be a single access (as most things
-  // will be on a single line), so we prefer a flat hash map to a btree map.
+  // Implementation note: we only visit the lines that have comments, so the
+  // cost doesn't depend on the number of lines the (possibly very large) span
+  // covers.
   std::vector<const CommentData*> results;
-  for (int64_t i = node_span.start().lineno(); i <= node_span.limit().lineno();
-       ++i) {
-    if (auto it = line_to_comment_.find(i); it != line_to_comment_.end()) {
-      // Check that the comment is properly contained within the given
-      // "node_span" we were targeting. E.g. the user might be requesting a
-      // subspan of a line, we don't want to give a comment that came
-      // afterwards.
-      const CommentData& cd = it->second;
-      if (node_span.Contains(cd.span)) {
-        results.push_back(&cd);
-      }
+  for (auto it = line_to_comment_.lower_bound(node_span.start().lineno());
+       it != line_to_comment_.end() && it->first <= node_span.limit().lineno();
+       ++it) {
+    // Check that the comment is properly contained within the given
+    // "node_span" we were targeting. E.g. the user might be requesting a
+    // subspan of a line, we don't want to give a comment that came
+    // afterwards.
+    const CommentData& cd = it->second;
+    if (node_span.Contains(cd.span)) {
+      results.push_back(&cd);
     }
   }
   return results;
@@ -2117,7 +2134,18 @@ static bool AreGroupedMembers(const ModuleMember& above,
   return above_effective_lineno + 1 == below_member->span().start().lineno();
 }
 
-DocRef Fmt(const Module& n, const Comments& comments, DocArena& arena) {
+// Returns whether "member" is a function desugared from a proc, which is
+// formatted as part of the proc rather than on its own.
+static bool IsProcFunction(const ModuleMember& member) {
+  const Function* f = dynamic_cast<const Function*>(ToAstNode(member));
+  return f != nullptr && f->tag() != FunctionTag::kNormal;
+}
+
+// Formats module "n", using "fmt_member" to produce the doc for the i-th
+// member of the module (as given by its index into `n.top()`).
+static DocRef FmtModule(const Module& n, const Comments& comments,
+                        DocArena& arena,
+                        const std::function<DocRef(size_t)>& fmt_member) {
   std::vector<DocRef> pieces;
 
   if (!n.annotations().empty()) {
@@ -2146,8 +2174,7 @@ DocRef Fmt(const Module& n, const Comments& comments, DocArena& arena) {
 
     // If this is a desugared proc function, we skip it, and handle formatting
     // it when we get to the proc node.
-    if (const Function* f = dynamic_cast<const Function*>(node);
-        f != nullptr && f->tag() != FunctionTag::kNormal) {
+    if (IsProcFunction(member)) {
       continue;
     }
 
@@ -2189,7 +2216,7 @@ DocRef Fmt(const Module& n, const Comments& comments, DocArena& arena) {
     }
 
     // Here we actually emit the formatted member.
-    pieces.push_back(Fmt(member, comments, arena));
+    pieces.push_back(fmt_member(i));
 
     // Now we reflect the emission of the member.
     last_entity_pos = member_span->limit();
@@ -2240,10 +2267,65 @@ DocRef Fmt(const Module& n, const Comments& comments, DocArena& arena) {
   return ConcatN(arena, pieces);
 }
 
+DocRef Fmt(const Module& n, const Comments& comments, DocArena& arena) {
+  return FmtModule(n, comments, arena, [&](size_t i) {
+    return Fmt(n.top()[i], comments, arena);
+  });
+}
+
+// Returns a doc that emits "text", which was pretty printed starting at column
+// zero, as is. Each line becomes its own text doc so that the output column is
+// tracked correctly for whatever follows (e.g. an inline comment).
+static DocRef MakePreformatted(std::string_view text, DocArena& arena) {
+  std::vector<DocRef> pieces;
+  for (std::string_view line : absl::StrSplit(text, '\n')) {
+    if (!pieces.empty()) {
+      pieces.push_back(arena.hard_line());
+    }
+    pieces.push_back(arena.MakeText(std::string{line}));
+  }
+  return ConcatN(arena, pieces);
+}
+
 std::string AutoFmt(const Module& m, const Comments& comments,
-                    int64_t text_width) {
+                    int64_t text_width, int64_t thread_count) {
+  const size_t member_count = m.top().size();
+  int64_t worker_count =
+      std::min(thread_count, static_cast<int64_t>(member_count));
+  if (worker_count <= 1) {
+    DocArena arena;
+    DocRef ref = Fmt(m, comments, arena);
+    return PrettyPrint(arena, ref, text_width);
+  }
+
+  // Every module member starts at column zero, so its layout doesn't depend on
+  // its surroundings and can be done in a separate arena on its own thread.
+  // The module is then laid out around the already formatted members.
+  std::vector<std::string> member_texts(member_count);
+  std::atomic<size_t> next_index = 0;
+  auto worker = [&]() {
+    for (size_t i = next_index++; i < member_count; i = next_index++) {
+      if (IsProcFunction(m.top()[i])) {
+        continue;
+      }
+      DocArena arena;
+      DocRef ref = Fmt(m.top()[i], comments, arena);
+      member_texts[i] = PrettyPrint(arena, ref, text_width);
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(worker_count);
+  for (int64_t i = 0; i < worker_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
   DocArena arena;
-  DocRef ref = Fmt(m, comments, arena);
+  DocRef ref = FmtModule(m, comments, arena, [&](size_t i) {
+    return MakePreformatted(member_texts[i], arena);
+  });
   return PrettyPrint(arena, ref, text_width);
 }
 
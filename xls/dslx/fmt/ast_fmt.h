@@ -22,7 +22,7 @@
 #include <utility>
 #include <vector>
 
-#include "absl/container/flat_hash_map.h"
+#include "absl/container/btree_map.h"
 #include "absl/types/span.h"
 #include "xls/dslx/fmt/pretty_print.h"
 #include "xls/dslx/frontend/ast.h"
@@ -51,12 +51,14 @@ class Comments {
   const std::optional<Pos>& last_data_limit() const { return last_data_limit_; }
 
  private:
-  Comments(absl::flat_hash_map<int64_t, CommentData> line_to_comment,
+  Comments(absl::btree_map<int64_t, CommentData> line_to_comment,
            std::optional<Pos> last_data_limit)
       : line_to_comment_(std::move(line_to_comment)),
         last_data_limit_(std::move(last_data_limit)) {}
 
-  absl::flat_hash_map<int64_t, CommentData> line_to_comment_;
+  // Ordered so that the comments within a span can be found without visiting
+  // every line of the span.
+  absl::btree_map<int64_t, CommentData> line_to_comment_;
   std::optional<Pos> last_data_limit_;
 };
 
@@ -80,8 +82,12 @@ inline constexpr int64_t kDslxDefaultTextWidth = 100;
 // Auto-formatting entry point.
 //
 // Performs a reflow-capable formatting of module "m" with standard line width.
+//
+// With a "thread_count" greater than one the module members are formatted
+// concurrently on that many threads; the result is the same either way.
 std::string AutoFmt(const Module& m, const Comments& comments,
-                    int64_t text_width = kDslxDefaultTextWidth);
+                    int64_t text_width = kDslxDefaultTextWidth,
+                    int64_t thread_count = 1);
 
 // If we fail the postcondition we return back the data we used to detect that
 // the postcondition was violated.
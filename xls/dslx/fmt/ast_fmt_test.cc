@@ -27,6 +27,7 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
@@ -935,6 +936,11 @@ class ModuleFmtTest : public testing::Test {
                              ParseModule(input, "fake.x", "fake", &comments));
     std::string got = AutoFmt(*m, Comments::Create(comments), text_width);
 
+    // Formatting the members concurrently must not change the result.
+    EXPECT_EQ(AutoFmt(*m, Comments::Create(comments), text_width,
+                      /*thread_count=*/4),
+              got);
+
     if (opportunistic_postcondition) {
       std::optional<AutoFmtPostconditionViolation> maybe_violation =
           ObeysAutoFmtOpportunisticPostcondition(input, got);
@@ -1075,6 +1081,14 @@ pub const A0 = sN[W_A0][NUM_PIECES]:[
 )");
 }
 
+// Formatting an array should take time linear in its size even when the
+// arrays are deeply nested.
+TEST_F(ModuleFmtTest, ConstantDefDeeplyNestedArray) {
+  constexpr int64_t kDepth = 32;
+  Run(absl::StrCat("const A = ", std::string(kDepth, '['), "u32:1",
+                   std::string(kDepth, ']'), ";\n"));
+}
+
 TEST_F(ModuleFmtTest, EnumDefTwoValues) {
   Run("pub enum MyEnum:u32{A=1,B=2}\n",
       R"(pub enum MyEnum : u32 {
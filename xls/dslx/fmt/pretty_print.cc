@@ -28,7 +28,6 @@
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
-#include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
@@ -119,9 +118,11 @@ bool operator<=(Requirement lhs, Requirement rhs) {
   return !gt;
 }
 
+// Emits "doc" into "out". This is a single pass over the doc: whether a group
+// fits flat is decided from the flat requirement precomputed when the doc was
+// made, so no sub-doc is ever laid out more than once.
 void PrettyPrintInternal(const DocArena& arena, const Doc& doc,
-                         const int64_t default_text_width,
-                         std::vector<std::string>& pieces) {
+                         const int64_t default_text_width, std::string& out) {
   VLOG(1) << "PrettyPrintInternal; default text width: " << default_text_width;
 
   // We maintain a stack to keep track of doc emission we still need to perform.
@@ -141,15 +142,15 @@ void PrettyPrintInternal(const DocArena& arena, const Doc& doc,
 
   auto emit = [&](std::string_view s) {
     if (real_outcol < virtual_outcol) {
-      pieces.push_back(std::string(virtual_outcol - real_outcol, ' '));
+      out.append(virtual_outcol - real_outcol, ' ');
       real_outcol = virtual_outcol;
     }
-    pieces.push_back(std::string{s});
+    out.append(s);
     real_outcol += s.size();
     virtual_outcol += s.size();
   };
   auto emit_cr = [&](int64_t indent) {
-    pieces.push_back("\n");
+    out.push_back('\n');
     real_outcol = 0;
     virtual_outcol = indent;
   };
@@ -451,7 +452,7 @@ DocArena::DocArena() {
 
 DocRef DocArena::MakeText(std::string s) {
   int64_t size = items_.size();
-  items_.push_back(Doc{static_cast<int64_t>(s.size()), s});
+  items_.push_back(Doc{static_cast<int64_t>(s.size()), std::move(s)});
   return DocRef{size};
 }
 
@@ -525,9 +526,9 @@ DocRef DocArena::Make(Keyword kw) {
 }
 
 std::string PrettyPrint(const DocArena& arena, DocRef ref, int64_t text_width) {
-  std::vector<std::string> pieces;
-  PrettyPrintInternal(arena, arena.Deref(ref), text_width, pieces);
-  return absl::StrJoin(pieces, "");
+  std::string out;
+  PrettyPrintInternal(arena, arena.Deref(ref), text_width, out);
+  return out;
 }
 
 DocRef ConcatN(DocArena& arena, absl::Span<DocRef const> docs) {
@@ -0,0 +1,53 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/frontend/ast_arena.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/log/check.h"
+#include "xls/dslx/frontend/ast_node.h"
+
+namespace xls::dslx {
+
+AstArena::~AstArena() {
+  for (auto it = nodes_.rbegin(); it != nodes_.rend(); ++it) {
+    (*it)->~AstNode();
+  }
+}
+
+void* AstArena::Allocate(int64_t size) {
+  CHECK_GT(size, 0);
+  size = (size + kAlignment - 1) & ~(kAlignment - 1);
+  if (size > remaining_) {
+    // Oversized allocations get a block of their own so the current block is
+    // not abandoned.
+    if (size > kBlockSize / 4) {
+      blocks_.push_back(std::make_unique_for_overwrite<char[]>(size));
+      bytes_reserved_ += size;
+      return blocks_.back().get();
+    }
+    blocks_.push_back(std::make_unique_for_overwrite<char[]>(kBlockSize));
+    bytes_reserved_ += kBlockSize;
+    next_ = blocks_.back().get();
+    remaining_ = kBlockSize;
+  }
+  void* ptr = next_;
+  next_ += size;
+  remaining_ -= size;
+  return ptr;
+}
+
+}  // namespace xls::dslx
@@ -0,0 +1,85 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_FRONTEND_AST_ARENA_H_
+#define XLS_DSLX_FRONTEND_AST_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "xls/dslx/frontend/ast_node.h"
+
+namespace xls::dslx {
+
+// A bump allocator owning the AST nodes of a single Module. Nodes are carved
+// out of large blocks rather than allocated individually, so creating nodes
+// (when parsing or cloning) is a pointer bump, nodes created together are
+// laid out contiguously, and the whole AST is released by freeing a handful of
+// blocks. AST nodes are never removed from a module so storage is not reused.
+//
+// Not thread-safe.
+class AstArena {
+ public:
+  // Alignment of every allocation.
+  static constexpr int64_t kAlignment = alignof(std::max_align_t);
+
+  AstArena() = default;
+  AstArena(const AstArena&) = delete;
+  AstArena& operator=(const AstArena&) = delete;
+
+  // Destroys the nodes in the reverse of the order they were created.
+  ~AstArena();
+
+  // Creates a node of type T in the arena from the given constructor
+  // arguments. The node lives until the arena is destroyed.
+  template <typename T, typename... Args>
+  T* New(Args&&... args) {
+    static_assert(std::is_base_of_v<AstNode, T>);
+    static_assert(alignof(T) <= kAlignment);
+    T* node = new (Allocate(sizeof(T))) T(std::forward<Args>(args)...);
+    nodes_.push_back(node);
+    return node;
+  }
+
+  // Reserves space to track `count` nodes in total.
+  void Reserve(int64_t count) { nodes_.reserve(count); }
+
+  // Returns the nodes in the order they were created.
+  absl::Span<AstNode* const> nodes() const { return nodes_; }
+
+  // Returns the number of bytes obtained from the system.
+  int64_t bytes_reserved() const { return bytes_reserved_; }
+
+ private:
+  // Size of each block of storage carved up by the bump allocator.
+  static constexpr int64_t kBlockSize = 64 * 1024;
+
+  void* Allocate(int64_t size);
+
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char* next_ = nullptr;
+  int64_t remaining_ = 0;
+  int64_t bytes_reserved_ = 0;
+  std::vector<AstNode*> nodes_;
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_FRONTEND_AST_ARENA_H_
@@ -0,0 +1,57 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/frontend/ast_arena.h"
+
+#include <cstdint>
+#include <optional>
+
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/module.h"
+#include "xls/dslx/frontend/pos.h"
+
+namespace xls::dslx {
+namespace {
+
+TEST(AstArenaTest, NodesAreTrackedInCreationOrder) {
+  Module module("test", /*fs_path=*/std::nullopt);
+  NameDef* x = module.Make<NameDef>(FakeSpan(), "x", nullptr);
+  NameDef* y = module.Make<NameDef>(FakeSpan(), "y", nullptr);
+  NameRef* x_ref = module.Make<NameRef>(FakeSpan(), "x", x);
+  EXPECT_EQ(module.node_count(), 3);
+  EXPECT_EQ(module.FindNode(AstNodeKind::kNameRef, FakeSpan()), x_ref);
+  EXPECT_EQ(module.FindNode(AstNodeKind::kNameDef, FakeSpan()), x);
+  EXPECT_NE(x, y);
+}
+
+TEST(AstArenaTest, ManyNodesSpanSeveralBlocks) {
+  Module module("test", /*fs_path=*/std::nullopt);
+  AstArena arena;
+  constexpr int64_t kCount = 10000;
+  arena.Reserve(kCount);
+  for (int64_t i = 0; i < kCount; ++i) {
+    NameDef* name_def =
+        arena.New<NameDef>(&module, FakeSpan(), absl::StrCat("x", i), nullptr);
+    EXPECT_EQ(
+        reinterpret_cast<std::uintptr_t>(name_def) % AstArena::kAlignment, 0);
+  }
+  ASSERT_EQ(arena.nodes().size(), kCount);
+  EXPECT_EQ(arena.nodes()[42]->ToString(), "x42");
+  EXPECT_GE(arena.bytes_reserved(), kCount * sizeof(NameDef));
+}
+
+}  // namespace
+}  // namespace xls::dslx
@@ -13,6 +13,7 @@
 // limitations under the License.
 #include "xls/dslx/frontend/ast_cloner.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -45,6 +46,9 @@ class AstCloner : public AstNodeVisitor {
   explicit AstCloner(Module* module, bool clone_type_definitions = true)
       : module_(module), clone_type_definitions_(clone_type_definitions) {}
 
+  // Reserves space for mapping `count` nodes.
+  void Reserve(int64_t count) { old_to_new_.reserve(count); }
+
   absl::Status HandleArray(const Array* n) override {
     XLS_RETURN_IF_ERROR(VisitChildren(n));
 
@@ -918,7 +922,9 @@ absl::StatusOr<AstNode*> CloneAstSansTypeDefinitions(AstNode* root) {
 
 absl::StatusOr<std::unique_ptr<Module>> CloneModule(Module* module) {
   auto new_module = std::make_unique<Module>(module->name(), module->fs_path());
+  new_module->ReserveNodes(module->node_count());
   AstCloner cloner(new_module.get());
+  cloner.Reserve(module->node_count());
   for (const ModuleMember member : module->top()) {
     ModuleMember new_member;
     XLS_RETURN_IF_ERROR(absl::visit(
@@ -88,10 +88,10 @@ std::string Module::ToString() const {
 }
 
 const AstNode* Module::FindNode(AstNodeKind kind, const Span& target) const {
-  for (const auto& node : nodes_) {
+  for (const AstNode* node : arena_.nodes()) {
     if (node->kind() == kind && node->GetSpan().has_value() &&
         node->GetSpan().value() == target) {
-      return node.get();
+      return node;
     }
   }
   return nullptr;
@@ -99,9 +99,9 @@ const AstNode* Module::FindNode(AstNodeKind kind, const Span& target) const {
 
 std::vector<const AstNode*> Module::FindIntercepting(const Pos& target) const {
   std::vector<const AstNode*> found;
-  for (const auto& node : nodes_) {
+  for (const AstNode* node : arena_.nodes()) {
     if (node->GetSpan().has_value() && node->GetSpan()->Contains(target)) {
-      found.push_back(node.get());
+      found.push_back(node);
     }
   }
   return found;
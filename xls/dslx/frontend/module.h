@@ -34,6 +34,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/ast_arena.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/frontend/proc.h"
 
@@ -126,6 +127,13 @@ class Module : public AstNode {
     return GetOrCreateBuiltinNameDef(BuiltinTypeToString(builtin_type));
   }
 
+  // Returns the number of AST nodes owned by this module.
+  int64_t node_count() const { return arena_.nodes().size(); }
+
+  // Reserves space for `count` AST nodes in total, e.g., before cloning another
+  // module into this one.
+  void ReserveNodes(int64_t count) { arena_.Reserve(count); }
+
   using MakeCollisionError = std::function<absl::Status(
       std::string_view module_name, std::string_view member_name,
       const Span& existing_span, const AstNode* existing_node,
@@ -240,12 +248,9 @@ class Module : public AstNode {
  private:
   template <typename T, typename... Args>
   T* MakeInternal(Args&&... args) {
-    std::unique_ptr<T> node =
-        std::make_unique<T>(this, std::forward<Args>(args)...);
-    T* ptr = node.get();
-    ptr->SetParentage();
-    nodes_.push_back(std::move(node));
-    return ptr;
+    T* node = arena_.New<T>(this, std::forward<Args>(args)...);
+    node->SetParentage();
+    return node;
   }
 
   // Returns all of the elements of top_ that have the given variant type T.
@@ -281,7 +286,7 @@ class Module : public AstNode {
   std::optional<std::filesystem::path> fs_path_;
 
   std::vector<ModuleMember> top_;  // Top-level members of this module.
-  std::vector<std::unique_ptr<AstNode>> nodes_;  // Lifetime-owned AST nodes.
+  AstArena arena_;  // Owns the AST nodes of this module.
 
   // Map of top-level module member name to the member itself.
   absl::flat_hash_map<std::string, ModuleMember> top_by_name_;
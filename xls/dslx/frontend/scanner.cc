@@ -15,12 +15,14 @@
 #include "xls/dslx/frontend/scanner.h"
 
 #include <cctype>
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 
+#include "absl/algorithm/container.h"
 #include "absl/base/no_destructor.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -41,6 +43,22 @@
 #include "xls/dslx/frontend/token.h"
 
 namespace xls::dslx {
+namespace {
+
+bool IsWhitespace(char c) {
+  switch (c) {
+    case ' ':
+    case '\r':
+    case '\n':
+    case '\t':
+    case '\xa0':
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
 
 absl::Status ScanErrorStatus(const Span& span, std::string_view message) {
   return absl::InvalidArgumentError(
@@ -60,6 +78,29 @@ char Scanner::PopChar() {
   return c;
 }
 
+void Scanner::AdvanceTo(int64_t end) {
+  CHECK_GE(end, index_);
+  CHECK_LE(end, text_.size());
+  std::string_view skipped =
+      std::string_view(text_).substr(index_, end - index_);
+  int64_t newlines = absl::c_count(skipped, '\n');
+  if (newlines == 0) {
+    colno_ += skipped.size();
+  } else {
+    lineno_ += newlines;
+    colno_ = skipped.size() - skipped.rfind('\n') - 1;
+  }
+  index_ = end;
+}
+
+int64_t Scanner::FindWhitespaceEnd(int64_t start) const {
+  int64_t end = start;
+  while (end < text_.size() && IsWhitespace(text_[end])) {
+    ++end;
+  }
+  return end;
+}
+
 void Scanner::DropChar(int64_t count) {
   for (int64_t i = 0; i < count; ++i) {
     (void)PopChar();
@@ -75,24 +116,22 @@ bool Scanner::TryDropChar(char target) {
 }
 
 Token Scanner::PopComment(const Pos& start_pos) {
-  std::string chars;
-  while (!AtCharEof()) {
-    char c = PopChar();
-    chars.append(1, c);
-    if (c == '\n') {
-      break;
-    }
-  }
-  return Token(TokenKind::kComment, Span(start_pos, GetPos()), chars);
+  // The comment runs through the end of the line, including the newline.
+  size_t newline = text_.find('\n', index_);
+  int64_t end = newline == std::string::npos ? text_.size() : newline + 1;
+  std::string chars = text_.substr(index_, end - index_);
+  AdvanceTo(end);
+  return Token(TokenKind::kComment, Span(start_pos, GetPos()),
+               std::move(chars));
 }
 
 absl::StatusOr<Token> Scanner::PopWhitespace(const Pos& start_pos) {
   CHECK(AtWhitespace());
-  std::string chars;
-  while (!AtCharEof() && AtWhitespace()) {
-    chars.append(1, PopChar());
-  }
-  return Token(TokenKind::kWhitespace, Span(start_pos, GetPos()), chars);
+  int64_t end = FindWhitespaceEnd(index_);
+  std::string chars = text_.substr(index_, end - index_);
+  AdvanceTo(end);
+  return Token(TokenKind::kWhitespace, Span(start_pos, GetPos()),
+               std::move(chars));
 }
 
 // This is too simple to need to return absl::Status. Just never call it
@@ -288,17 +327,26 @@ absl::StatusOr<std::string> Scanner::ScanUntilDoubleQuote() {
 
 absl::StatusOr<Token> Scanner::ScanIdentifierOrKeyword(char startc,
                                                        const Pos& start_pos) {
-  // The leading character is `startc` so we scan out trailing identifiers.
-  auto is_trailing_identifier_char = [](char c) {
-    return std::isalpha(c) != 0 || std::isdigit(c) != 0 || c == '_' ||
-           c == '!' || c == '\'';
-  };
-  std::string s = ScanWhile(startc, is_trailing_identifier_char);
+  // The leading character is `startc` (just popped) so we scan out trailing
+  // identifier characters. The text is only copied for identifiers; keywords
+  // are looked up in place.
+  DCHECK_EQ(text_[index_ - 1], startc);
+  const int64_t start = index_ - 1;
+  int64_t end = index_;
+  while (end < text_.size()) {
+    char c = text_[end];
+    if (!absl::ascii_isalnum(c) && c != '_' && c != '!' && c != '\'') {
+      break;
+    }
+    ++end;
+  }
+  std::string_view s = std::string_view(text_).substr(start, end - start);
+  AdvanceTo(end);
   Span span(start_pos, GetPos());
   if (std::optional<Keyword> keyword = GetKeyword(s)) {
     return Token(span, *keyword);
   }
-  return Token(TokenKind::kIdentifier, span, std::move(s));
+  return Token(TokenKind::kIdentifier, span, std::string(s));
 }
 
 std::optional<CommentData> Scanner::TryPopComment() {
@@ -369,7 +417,7 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, const Pos& start_pos) {
           absl::StrFormat("Invalid digit for binary number: '%c'", PeekChar()));
     }
   } else {
-    s = ScanWhile(startc, [](char c) { return std::isdigit(c) != 0; });
+    s = ScanWhile(startc, [](char c) { return absl::ascii_isdigit(c); });
     if (absl::StartsWith(s, "0") && s.size() != 1) {
       return ScanErrorStatus(
           Span(GetPos(), GetPos()),
@@ -381,43 +429,21 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, const Pos& start_pos) {
   if (negative) {
     s = "-" + s;
   }
-  return Token(TokenKind::kNumber, Span(start_pos, GetPos()), s);
+  return Token(TokenKind::kNumber, Span(start_pos, GetPos()), std::move(s));
 }
 
-bool Scanner::AtWhitespace() const {
-  switch (PeekChar()) {
-    case ' ':
-    case '\r':
-    case '\n':
-    case '\t':
-    case '\xa0':
-      return true;
-    default:
-      return false;
-  }
-}
+bool Scanner::AtWhitespace() const { return IsWhitespace(PeekChar()); }
 
-void Scanner::DropLeadingWhitespace() {
-  while (!AtCharEof()) {
-    if (AtWhitespace()) {
-      DropChar();
-    } else {
-      break;
-    }
-  }
-}
+void Scanner::DropLeadingWhitespace() { AdvanceTo(FindWhitespaceEnd(index_)); }
 
 void Scanner::DropCommentsAndLeadingWhitespace() {
   while (!AtCharEof()) {
     if (AtWhitespace()) {
-      DropChar();
+      DropLeadingWhitespace();
     } else if (PeekChar() == '/' && PeekChar2OrNull() == '/') {
-      DropChar(2);  // Get rid of leading "//"
-      while (!AtCharEof()) {
-        if (PopChar() == '\n') {
-          break;
-        }
-      }
+      // Drop through the end of the line.
+      size_t newline = text_.find('\n', index_);
+      AdvanceTo(newline == std::string::npos ? text_.size() : newline + 1);
     } else {
       break;
     }
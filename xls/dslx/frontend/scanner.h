@@ -16,7 +16,6 @@
 #define XLS_DSLX_FRONTEND_SCANNER_H_
 
 #include <cstdint>
-#include <functional>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -146,19 +145,20 @@ class Scanner {
   absl::StatusOr<Token> ScanChar(const Pos& start_pos);
 
   // Scans from the current position until ftake returns false or EOF is
-  // reached.
-  std::string ScanWhile(std::string s, const std::function<bool(char)>& ftake) {
-    while (!AtCharEof()) {
-      char peek = PeekChar();
-      if (!ftake(peek)) {
-        break;
-      }
-      s.append(1, PopChar());
+  // reached, appending the scanned characters to `s`.
+  template <typename F>
+  std::string ScanWhile(std::string s, F ftake) {
+    int64_t end = index_;
+    while (end < text_.size() && ftake(text_[end])) {
+      ++end;
     }
+    s.append(text_, index_, end - index_);
+    AdvanceTo(end);
     return s;
   }
-  std::string ScanWhile(char c, const std::function<bool(char)>& ftake) {
-    return ScanWhile(std::string(1, c), ftake);
+  template <typename F>
+  std::string ScanWhile(char c, F ftake) {
+    return ScanWhile(std::string(1, c), std::move(ftake));
   }
 
   // Scans the identifier-looping entity beginning with startc.
@@ -219,6 +219,15 @@ class Scanner {
   // routine will check-fail).
   ABSL_MUST_USE_RESULT char PopChar();
 
+  // Moves the head of the character stream forward to `end`, updating the
+  // line and column for the characters skipped. This avoids popping long runs
+  // (e.g. of whitespace or comment text) one character at a time.
+  void AdvanceTo(int64_t end);
+
+  // Returns the index of the first non-whitespace character at or after
+  // `start`, or the size of the text if there is none.
+  int64_t FindWhitespaceEnd(int64_t start) const;
+
   // Drops "count" characters from the head of the character stream.
   //
   // Note: As with PopChar() if the character stream is extinguished when a
@@ -19,11 +19,14 @@
 #include <utility>
 #include <vector>
 
+#include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/log/check.h"
 #include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/error_test_utils.h"
 #include "xls/dslx/frontend/comment_data.h"
@@ -252,6 +255,26 @@ TEST(ScannerTest, WhitespaceAndCommentsMode) {
   EXPECT_EQ(tokens[4].kind(), TokenKind::kComment);
 }
 
+TEST(ScannerTest, WhitespaceAndCommentsModeSpans) {
+  Scanner s("fake_file.x", "// a\n\n  \tfoo // b\n0x1_f",
+            /*include_whitespace_and_comments=*/true);
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Token> tokens, s.PopAll());
+  ASSERT_EQ(tokens.size(), 6);
+  auto span = [](int64_t start_line, int64_t start_col, int64_t limit_line,
+                 int64_t limit_col) {
+    return Span(Pos("fake_file.x", start_line, start_col),
+                Pos("fake_file.x", limit_line, limit_col));
+  };
+  EXPECT_EQ(tokens[0], Token(TokenKind::kComment, span(0, 0, 1, 0), "// a\n"));
+  EXPECT_EQ(tokens[1],
+            Token(TokenKind::kWhitespace, span(1, 0, 2, 3), "\n  \t"));
+  EXPECT_EQ(tokens[2], Token(TokenKind::kIdentifier, span(2, 3, 2, 6), "foo"));
+  EXPECT_EQ(tokens[3], Token(TokenKind::kWhitespace, span(2, 6, 2, 7), " "));
+  EXPECT_EQ(tokens[4],
+            Token(TokenKind::kComment, span(2, 7, 3, 0), "// b\n"));
+  EXPECT_EQ(tokens[5], Token(TokenKind::kNumber, span(3, 0, 3, 5), "0x1_f"));
+}
+
 TEST(ScannerTest, PopSeveral) {
   Scanner s("fake_file.x", "[!](-)");
   std::vector<TokenKind> expected = {
@@ -481,4 +504,31 @@ bar  // another thing
   }
 }
 
+namespace {
+
+// Scans a generated module of `state.range(0)` functions, each with comments,
+// keywords, identifiers and numbers.
+void BM_ScanGeneratedModule(benchmark::State& state) {
+  std::string text;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    absl::StrAppendFormat(&text,
+                          "// Function number %d.\n"
+                          "pub fn f%d(x: u32, y: u32) -> u32 {\n"
+                          "    let z = x + y * u32:0x%x;  // Trailing.\n"
+                          "    if z > u32:%d { z - y } else { z ^ x }\n"
+                          "}\n\n",
+                          i, i, i, i);
+  }
+  for (auto _ : state) {
+    Scanner s("fake_file.x", text);
+    absl::StatusOr<std::vector<Token>> tokens = s.PopAll();
+    CHECK_OK(tokens.status());
+    benchmark::DoNotOptimize(tokens);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK(BM_ScanGeneratedModule)->Range(16, 16384);
+
+}  // namespace
 }  // namespace xls::dslx
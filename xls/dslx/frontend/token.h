@@ -109,7 +109,7 @@ class Token {
  public:
   Token(TokenKind kind, Span span,
         std::optional<std::string> value = std::nullopt)
-      : kind_(kind), span_(std::move(span)), payload_(value) {}
+      : kind_(kind), span_(std::move(span)), payload_(std::move(value)) {}
 
   Token(Span span, Keyword keyword)
       : kind_(TokenKind::kKeyword), span_(std::move(span)), payload_(keyword) {}
@@ -0,0 +1,264 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/import_cache.h"
+
+#include <cstddef>
+#include <filesystem>  // NOLINT
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/bytecode/bytecode_cache_interface.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/module.h"
+#include "xls/dslx/frontend/pos.h"
+#include "xls/dslx/import_cache_interface.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/import_routines.h"
+#include "xls/dslx/warning_collector.h"
+#include "xls/dslx/warning_kind.h"
+
+namespace xls::dslx {
+namespace {
+
+// Returns a fingerprint of the current contents of the file at `path`, or
+// nullopt if it cannot be read.
+std::optional<size_t> FingerprintFile(const std::filesystem::path& path) {
+  absl::StatusOr<std::string> contents = GetFileContents(path);
+  if (!contents.ok()) {
+    return std::nullopt;
+  }
+  return absl::Hash<std::string_view>{}(*contents);
+}
+
+std::vector<ImportTokens> GetImportSubjects(const Module& module) {
+  std::vector<ImportTokens> subjects;
+  for (const ModuleMember& member : module.top()) {
+    if (std::holds_alternative<Import*>(member)) {
+      subjects.push_back(ImportTokens(std::get<Import*>(member)->subject()));
+    }
+  }
+  return subjects;
+}
+
+}  // namespace
+
+// One version of the contents of an ImportCache. Modules are parsed and
+// typechecked into the generation's own ImportData, except for those carried
+// over unchanged from an earlier generation, which are borrowed from the
+// generation which owns them.
+class ImportCacheGeneration final : public ImportCacheInterface {
+ public:
+  struct CachedModule {
+    ModuleInfo* module_info;
+    // Fingerprint of the module's file when it was cached, or nullopt if the
+    // file could not be read back (in which case the module is always stale).
+    std::optional<size_t> fingerprint;
+    std::vector<ImportTokens> imports;
+    // The generation which owns the module, or nullptr if it is this one.
+    std::shared_ptr<const ImportCacheGeneration> owner;
+  };
+
+  ImportCacheGeneration(
+      const std::filesystem::path& stdlib_path,
+      std::vector<std::filesystem::path> additional_search_paths,
+      WarningKindSet enabled_warnings, ImportCache::TypecheckModuleFn typecheck)
+      : additional_search_paths_(std::move(additional_search_paths)),
+        warnings_(enabled_warnings),
+        typecheck_(std::move(typecheck)),
+        import_data_(CreateImportDataPtr(
+            stdlib_path, additional_search_paths_, enabled_warnings)) {}
+
+  absl::Status Import(const ImportTokens& subject, const Span& import_span,
+                      ImportData* importer) override {
+    if (!modules_.contains(subject)) {
+      auto typecheck = [this](Module* module) {
+        return typecheck_(module, import_data_.get(), &warnings_);
+      };
+      absl::Status status =
+          DoImport(typecheck, subject, import_data_.get(), import_span)
+              .status();
+      if (!status.ok()) {
+        // Modules imported by the failing one may have been added to
+        // `import_data_` without being recorded, and so without being checked
+        // for staleness. Make sure the next snapshot does not reuse them.
+        has_unrecorded_modules_ = true;
+        return status;
+      }
+      XLS_RETURN_IF_ERROR(Record(subject));
+    }
+    absl::flat_hash_set<ImportTokens> lent;
+    return Lend(subject, importer, lent);
+  }
+
+  // Adds a module cached by an earlier generation, which is kept alive by
+  // `owner`. The modules it imports must be adopted as well.
+  absl::Status Adopt(const ImportTokens& subject, const CachedModule& cached,
+                     std::shared_ptr<const ImportCacheGeneration> owner) {
+    XLS_RETURN_IF_ERROR(import_data_
+                            ->PutBorrowed(subject, cached.module_info,
+                                          owner->bytecode_cache())
+                            .status());
+    if (!absl::c_linear_search(borrowed_from_, owner)) {
+      borrowed_from_.push_back(owner);
+    }
+    CachedModule adopted = cached;
+    adopted.owner = std::move(owner);
+    modules_.emplace(subject, std::move(adopted));
+    return absl::OkStatus();
+  }
+
+  const absl::flat_hash_map<ImportTokens, CachedModule>& modules() const {
+    return modules_;
+  }
+  bool has_unrecorded_modules() const { return has_unrecorded_modules_; }
+
+  // The cache of bytecode for the functions of the modules owned by this
+  // generation.
+  BytecodeCacheInterface* bytecode_cache() const {
+    return import_data_->bytecode_cache();
+  }
+
+ private:
+  // Records `subject`, which has been imported into `import_data_`, and the
+  // modules it transitively imports.
+  absl::Status Record(const ImportTokens& subject) {
+    if (modules_.contains(subject)) {
+      return absl::OkStatus();
+    }
+    XLS_ASSIGN_OR_RETURN(ModuleInfo * module_info, import_data_->Get(subject));
+    std::vector<ImportTokens> imports =
+        GetImportSubjects(module_info->module());
+    for (const ImportTokens& import : imports) {
+      XLS_RETURN_IF_ERROR(Record(import));
+    }
+    VLOG(3) << "Caching typechecked module: " << subject.ToString();
+    modules_.emplace(subject,
+                     CachedModule{.module_info = module_info,
+                                  .fingerprint =
+                                      FingerprintFile(module_info->path()),
+                                  .imports = std::move(imports)});
+    return absl::OkStatus();
+  }
+
+  // Borrows `subject` and the modules it transitively imports into
+  // `importer`.
+  absl::Status Lend(const ImportTokens& subject, ImportData* importer,
+                    absl::flat_hash_set<ImportTokens>& lent) const {
+    if (!lent.insert(subject).second) {
+      return absl::OkStatus();
+    }
+    auto it = modules_.find(subject);
+    XLS_RET_CHECK(it != modules_.end()) << subject.ToString();
+    for (const ImportTokens& import : it->second.imports) {
+      XLS_RETURN_IF_ERROR(Lend(import, importer, lent));
+    }
+    const CachedModule& cached = it->second;
+    BytecodeCacheInterface* owner_cache = cached.owner != nullptr
+                                              ? cached.owner->bytecode_cache()
+                                              : bytecode_cache();
+    return importer->PutBorrowed(subject, cached.module_info, owner_cache)
+        .status();
+  }
+
+  // Declared before `import_data_` so that borrowed modules outlive the type
+  // information in `import_data_` which refers to them.
+  std::vector<std::shared_ptr<const ImportCacheGeneration>> borrowed_from_;
+  // Referred to by `import_data_`.
+  std::vector<std::filesystem::path> additional_search_paths_;
+  WarningCollector warnings_;
+  ImportCache::TypecheckModuleFn typecheck_;
+  std::unique_ptr<ImportData> import_data_;
+  absl::flat_hash_map<ImportTokens, CachedModule> modules_;
+  bool has_unrecorded_modules_ = false;
+};
+
+ImportCache::ImportCache(
+    std::filesystem::path stdlib_path,
+    std::vector<std::filesystem::path> additional_search_paths,
+    WarningKindSet enabled_warnings, TypecheckModuleFn typecheck)
+    : stdlib_path_(std::move(stdlib_path)),
+      additional_search_paths_(std::move(additional_search_paths)),
+      enabled_warnings_(enabled_warnings),
+      typecheck_(std::move(typecheck)) {}
+
+ImportCache::~ImportCache() = default;
+
+std::shared_ptr<ImportCacheInterface> ImportCache::GetSnapshot() {
+  if (current_ == nullptr) {
+    current_ = std::make_shared<ImportCacheGeneration>(
+        stdlib_path_, additional_search_paths_, enabled_warnings_, typecheck_);
+    return current_;
+  }
+
+  // A module is fresh if its file is unchanged and all of the modules it
+  // imports are fresh.
+  const auto& modules = current_->modules();
+  absl::flat_hash_map<ImportTokens, bool> fresh;
+  std::function<bool(const ImportTokens&)> is_fresh =
+      [&](const ImportTokens& subject) {
+        if (auto it = fresh.find(subject); it != fresh.end()) {
+          return it->second;
+        }
+        const ImportCacheGeneration::CachedModule& cached =
+            modules.at(subject);
+        bool result =
+            cached.fingerprint.has_value() &&
+            FingerprintFile(cached.module_info->path()) == cached.fingerprint &&
+            absl::c_all_of(cached.imports, is_fresh);
+        fresh[subject] = result;
+        return result;
+      };
+  bool all_fresh = true;
+  for (const auto& [subject, cached] : modules) {
+    all_fresh = is_fresh(subject) && all_fresh;
+  }
+  if (all_fresh && !current_->has_unrecorded_modules()) {
+    return current_;
+  }
+
+  auto next = std::make_shared<ImportCacheGeneration>(
+      stdlib_path_, additional_search_paths_, enabled_warnings_, typecheck_);
+  for (const auto& [subject, cached] : modules) {
+    if (!fresh.at(subject)) {
+      VLOG(3) << "Dropping stale cached module: " << subject.ToString();
+      continue;
+    }
+    CHECK_OK(next->Adopt(
+        subject, cached,
+        cached.owner != nullptr ? cached.owner : current_));
+  }
+  current_ = std::move(next);
+  return current_;
+}
+
+}  // namespace xls::dslx
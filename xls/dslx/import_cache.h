@@ -0,0 +1,82 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_IMPORT_CACHE_H_
+#define XLS_DSLX_IMPORT_CACHE_H_
+
+#include <filesystem>  // NOLINT
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "xls/dslx/frontend/module.h"
+#include "xls/dslx/import_cache_interface.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/type_system/type_info.h"
+#include "xls/dslx/warning_collector.h"
+#include "xls/dslx/warning_kind.h"
+
+namespace xls::dslx {
+
+class ImportCacheGeneration;
+
+// A cache of parsed and typechecked modules shared by ImportData objects which
+// are created over time, e.g. one for each edit of a buffer in the language
+// server, so that their import closures (including the standard library) are
+// not parsed and typechecked again for every one of them.
+//
+// Cached modules are keyed by import subject and are validated against the
+// content of their file and, transitively, of the modules they import: each
+// GetSnapshot() call re-reads the cached files and drops every module whose
+// file or import closure changed. Modules are only ever reused together with
+// their entire import closure, since the type information of a module points
+// at that of the modules it imports.
+//
+// Warnings in cached modules are collected by the cache and are not reported
+// to the importing modules.
+//
+// Note: this is thread-compatible but not thread-safe, and neither are the
+// snapshots it returns.
+class ImportCache {
+ public:
+  // Typechecks the given module within the given ImportData; e.g.
+  // TypecheckModule.
+  using TypecheckModuleFn = std::function<absl::StatusOr<TypeInfo*>(
+      Module*, ImportData*, WarningCollector*)>;
+
+  ImportCache(std::filesystem::path stdlib_path,
+              std::vector<std::filesystem::path> additional_search_paths,
+              WarningKindSet enabled_warnings, TypecheckModuleFn typecheck);
+  ~ImportCache();
+
+  // Returns the current contents of the cache having first dropped any stale
+  // modules, for use with ImportData::SetImportCache. The ImportData should
+  // have been created with the same stdlib and search paths as the cache.
+  //
+  // The snapshot remains valid, and keeps all modules borrowed from it alive,
+  // even after later calls replace it as the current contents of the cache.
+  std::shared_ptr<ImportCacheInterface> GetSnapshot();
+
+ private:
+  std::filesystem::path stdlib_path_;
+  std::vector<std::filesystem::path> additional_search_paths_;
+  WarningKindSet enabled_warnings_;
+  TypecheckModuleFn typecheck_;
+  std::shared_ptr<ImportCacheGeneration> current_;
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_IMPORT_CACHE_H_
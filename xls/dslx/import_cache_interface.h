@@ -0,0 +1,47 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_IMPORT_CACHE_INTERFACE_H_
+#define XLS_DSLX_IMPORT_CACHE_INTERFACE_H_
+
+#include "absl/status/status.h"
+#include "xls/dslx/frontend/pos.h"
+
+namespace xls::dslx {
+
+class ImportData;
+class ImportTokens;
+
+// Defines the interface a type must provide in order to serve as a cache of
+// typechecked modules which may be shared by several ImportData objects. As
+// with BytecodeCacheInterface, this type exists to avoid attaching the
+// concrete cache's dependencies (which include the type checker) onto
+// ImportData.
+class ImportCacheInterface {
+ public:
+  virtual ~ImportCacheInterface() = default;
+
+  // Makes the module for `subject` available in `importer`, parsing and
+  // typechecking it into the cache if it is not already present. The module
+  // and all modules it transitively imports are added to `importer` via
+  // ImportData::PutBorrowed, so they remain owned by the cache. `import_span`
+  // is the span of the import statement, used for error reporting.
+  virtual absl::Status Import(const ImportTokens& subject,
+                              const Span& import_span,
+                              ImportData* importer) = 0;
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_IMPORT_CACHE_INTERFACE_H_
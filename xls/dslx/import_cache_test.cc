@@ -0,0 +1,176 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/import_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/bytecode/bytecode_cache_interface.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/module.h"
+#include "xls/dslx/import_cache_interface.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/type_system/type_info.h"
+#include "xls/dslx/type_system/typecheck_module.h"
+#include "xls/dslx/warning_collector.h"
+#include "xls/dslx/warning_kind.h"
+
+namespace xls::dslx {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::Not;
+
+constexpr std::string_view kMainProgram = R"(
+import a;
+import c;
+fn main() -> u32 { a::f() + c::h() }
+)";
+
+class ImportCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(temp_dir_, TempDirectory::Create());
+    search_paths_ = {temp_dir_->path()};
+    XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "a.x",
+                                  "import b;\n"
+                                  "pub fn f() -> u32 { b::g<u32:2>() }\n"));
+    XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "b.x",
+                                  "pub fn g<N: u32>() -> u32 { N }\n"));
+    XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "c.x",
+                                  "import std;\n"
+                                  "pub fn h() -> u32 { std::umax(u32:1, "
+                                  "u32:3) }\n"));
+    cache_ = std::make_unique<ImportCache>(
+        kDefaultDslxStdlibPath, search_paths_, kDefaultWarningsSet,
+        [](Module* module, ImportData* import_data,
+           WarningCollector* warnings) {
+          return TypecheckModule(module, import_data, warnings);
+        });
+  }
+
+  // Typechecks the main program in a new ImportData using a snapshot of the
+  // cache, returning the module imported for `subject`.
+  absl::StatusOr<const Module*> TypecheckMain(std::string_view subject) {
+    import_datas_.push_back(CreateImportDataPtr(
+        kDefaultDslxStdlibPath, search_paths_, kDefaultWarningsSet));
+    ImportData& import_data = *import_datas_.back();
+    import_data.SetImportCache(cache_->GetSnapshot());
+    XLS_RETURN_IF_ERROR(ParseAndTypecheck(kMainProgram, "main.x", "main",
+                                          &import_data)
+                            .status());
+    XLS_ASSIGN_OR_RETURN(ModuleInfo * module_info,
+                         import_data.Get(ImportTokens({std::string(subject)})));
+    return &module_info->module();
+  }
+
+  std::optional<TempDirectory> temp_dir_;
+  std::vector<std::filesystem::path> search_paths_;
+  std::unique_ptr<ImportCache> cache_;
+  std::vector<std::unique_ptr<ImportData>> import_datas_;
+};
+
+TEST_F(ImportCacheTest, ReusesUnchangedModules) {
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* a1, TypecheckMain("a"));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* b1, TypecheckMain("b"));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* std1, TypecheckMain("std"));
+
+  EXPECT_THAT(TypecheckMain("a"), IsOkAndHolds(a1));
+  EXPECT_THAT(TypecheckMain("b"), IsOkAndHolds(b1));
+  EXPECT_THAT(TypecheckMain("std"), IsOkAndHolds(std1));
+}
+
+TEST_F(ImportCacheTest, ChangedModuleInvalidatesImporters) {
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* a1, TypecheckMain("a"));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* b1, TypecheckMain("b"));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* c1, TypecheckMain("c"));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* std1, TypecheckMain("std"));
+
+  XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "b.x",
+                                "pub fn g<N: u32>() -> u32 { N + u32:1 }\n"));
+
+  // `b` and `a`, which imports it, are typechecked again; `c` and the stdlib
+  // are reused from the earlier snapshot.
+  EXPECT_THAT(TypecheckMain("a"), IsOkAndHolds(Not(a1)));
+  EXPECT_THAT(TypecheckMain("b"), IsOkAndHolds(Not(b1)));
+  EXPECT_THAT(TypecheckMain("c"), IsOkAndHolds(c1));
+  EXPECT_THAT(TypecheckMain("std"), IsOkAndHolds(std1));
+}
+
+TEST_F(ImportCacheTest, SnapshotOutlivesInvalidation) {
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* b1, TypecheckMain("b"));
+  XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "b.x",
+                                "pub fn g<N: u32>() -> u32 { N + u32:1 }\n"));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* b2, TypecheckMain("b"));
+  EXPECT_NE(b1, b2);
+
+  // The first ImportData still holds the module from its own snapshot.
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleInfo * first_b,
+                           import_datas_.front()->Get(ImportTokens({"b"})));
+  EXPECT_EQ(&first_b->module(), b1);
+}
+
+TEST_F(ImportCacheTest, SharesBytecodeOfBorrowedModules) {
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* c1, TypecheckMain("c"));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* c2, TypecheckMain("c"));
+  ASSERT_EQ(c1, c2);
+
+  // Bytecode for `c::h` is emitted once, into the cache of the ImportData
+  // owning `c`, and shared by both importers.
+  std::vector<BytecodeFunction*> bytecode_fns;
+  for (std::unique_ptr<ImportData>& import_data : import_datas_) {
+    XLS_ASSERT_OK_AND_ASSIGN(ModuleInfo * c,
+                             import_data->Get(ImportTokens({"c"})));
+    XLS_ASSERT_OK_AND_ASSIGN(Function * h,
+                             c->module().GetMemberOrError<Function>("h"));
+    XLS_ASSERT_OK_AND_ASSIGN(TypeInfo * type_info,
+                             import_data->GetRootTypeInfo(&c->module()));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        BytecodeFunction * bytecode_fn,
+        import_data->bytecode_cache()->GetOrCreateBytecodeFunction(
+            *h, type_info, /*caller_bindings=*/std::nullopt));
+    bytecode_fns.push_back(bytecode_fn);
+  }
+  EXPECT_EQ(bytecode_fns[0], bytecode_fns[1]);
+}
+
+TEST_F(ImportCacheTest, TypeErrorInImportIsReported) {
+  XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "b.x",
+                                "pub fn g<N: u32>() -> u32 { u8:1 }\n"));
+  EXPECT_THAT(TypecheckMain("b"), StatusIs(Not(absl::StatusCode::kOk)));
+
+  XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "b.x",
+                                "pub fn g<N: u32>() -> u32 { N }\n"));
+  XLS_EXPECT_OK(TypecheckMain("b"));
+}
+
+}  // namespace
+}  // namespace xls::dslx
@@ -16,6 +16,7 @@
 
 #include <filesystem>  // NOLINT
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -49,25 +50,63 @@ absl::StatusOr<ModuleInfo*> ImportData::Get(const ImportTokens& subject) const {
     return absl::NotFoundError("Module information was not found for import " +
                                subject.ToString());
   }
-  return it->second.get();
+  return it->second;
 }
 
 absl::StatusOr<ModuleInfo*> ImportData::Put(
     const ImportTokens& subject, std::unique_ptr<ModuleInfo> module_info) {
   auto* pmodule_info = module_info.get();
-  auto [it, inserted] = modules_.emplace(subject, std::move(module_info));
+  auto [it, inserted] = modules_.emplace(subject, pmodule_info);
   if (!inserted) {
     return absl::InvalidArgumentError(
         "Module is already loaded for import of " + subject.ToString());
   }
+  owned_modules_.push_back(std::move(module_info));
   path_to_module_info_[std::string{pmodule_info->path()}] = pmodule_info;
   return pmodule_info;
 }
 
+absl::StatusOr<ModuleInfo*> ImportData::PutBorrowed(
+    const ImportTokens& subject, ModuleInfo* module_info,
+    BytecodeCacheInterface* bytecode_cache) {
+  XLS_RET_CHECK(module_info != nullptr);
+  auto [it, inserted] = modules_.emplace(subject, module_info);
+  if (!inserted) {
+    if (it->second == module_info) {
+      return module_info;
+    }
+    return absl::InvalidArgumentError(
+        "Module is already loaded for import of " + subject.ToString());
+  }
+  path_to_module_info_[std::string{module_info->path()}] = module_info;
+  borrowed_root_type_infos_[&module_info->module()] = module_info->type_info();
+  if (bytecode_cache != nullptr) {
+    borrowed_bytecode_caches_[&module_info->module()] = bytecode_cache;
+  }
+  return module_info;
+}
+
+BytecodeCacheInterface* ImportData::GetBorrowedBytecodeCache(
+    const Module* module) const {
+  auto it = borrowed_bytecode_caches_.find(module);
+  return it == borrowed_bytecode_caches_.end() ? nullptr : it->second;
+}
+
+std::optional<PreparsedModule> ImportData::TakePreparsedModule(
+    const ImportTokens& subject) {
+  auto it = preparsed_modules_.find(subject);
+  if (it == preparsed_modules_.end()) {
+    return std::nullopt;
+  }
+  PreparsedModule preparsed = std::move(it->second);
+  preparsed_modules_.erase(it);
+  return preparsed;
+}
+
 absl::StatusOr<TypeInfo*> ImportData::GetRootTypeInfoForNode(
     const AstNode* node) {
   XLS_RET_CHECK(node != nullptr);
-  return type_info_owner().GetRootTypeInfo(node->owner());
+  return GetRootTypeInfo(node->owner());
 }
 
 absl::StatusOr<const TypeInfo*> ImportData::GetRootTypeInfoForNode(
@@ -79,6 +118,10 @@ absl::StatusOr<const TypeInfo*> ImportData::GetRootTypeInfoForNode(
 }
 
 absl::StatusOr<TypeInfo*> ImportData::GetRootTypeInfo(const Module* module) {
+  if (auto it = borrowed_root_type_infos_.find(module);
+      it != borrowed_root_type_infos_.end()) {
+    return it->second;
+  }
   return type_info_owner().GetRootTypeInfo(module);
 }
 
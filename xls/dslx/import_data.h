@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -33,8 +34,11 @@
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/module.h"
 #include "xls/dslx/frontend/pos.h"
+#include "xls/dslx/import_cache_interface.h"
 #include "xls/dslx/import_record.h"
 #include "xls/dslx/interp_bindings.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/dslx/type_system/parametric_env.h"
 #include "xls/dslx/type_system/type_info.h"
 #include "xls/dslx/warning_kind.h"
 
@@ -61,6 +65,12 @@ class ModuleInfo {
   std::filesystem::path path_;
 };
 
+// A module which has been parsed ahead of being imported; see PreparseImports.
+struct PreparsedModule {
+  std::unique_ptr<Module> module;
+  std::filesystem::path path;
+};
+
 // Immutable "tuple" of tokens that name an absolute import location.
 //
 // e.g. ("std",) or ("xls", "examples", "foo")
@@ -133,6 +143,55 @@ class ImportData {
   absl::StatusOr<ModuleInfo*> Put(const ImportTokens& subject,
                                   std::unique_ptr<ModuleInfo> module_info);
 
+  // Makes `module_info`, which is owned elsewhere (e.g. by the import cache),
+  // available for import of `subject`. The module and its type information
+  // must outlive this object. Borrowing the same module for the same subject
+  // more than once is a no-op.
+  //
+  // If given, `bytecode_cache` is the cache of the ImportData which typechecked
+  // the module; it must also outlive this object. Bytecode for the functions
+  // of the module is then emitted into it so that it is shared by everything
+  // borrowing the module.
+  absl::StatusOr<ModuleInfo*> PutBorrowed(
+      const ImportTokens& subject, ModuleInfo* module_info,
+      BytecodeCacheInterface* bytecode_cache = nullptr);
+
+  // Returns the bytecode cache given when `module` was borrowed, or nullptr if
+  // the module is not borrowed or none was given.
+  BytecodeCacheInterface* GetBorrowedBytecodeCache(const Module* module) const;
+
+  // Sets the cache through which modules imported into this object are
+  // resolved; modules found there are borrowed rather than parsed and
+  // typechecked again. This object shares ownership of the cache so that
+  // borrowed modules stay alive as long as it does.
+  void SetImportCache(std::shared_ptr<ImportCacheInterface> import_cache) {
+    import_cache_ = std::move(import_cache);
+  }
+  ImportCacheInterface* import_cache() const { return import_cache_.get(); }
+
+  // Notes `preparsed` as the result of parsing the module for a later import
+  // of `subject`, which then only needs to typecheck it.
+  void AddPreparsedModule(const ImportTokens& subject,
+                          PreparsedModule preparsed) {
+    preparsed_modules_.insert_or_assign(subject, std::move(preparsed));
+  }
+  bool HasPreparsedModule(const ImportTokens& subject) const {
+    return preparsed_modules_.contains(subject);
+  }
+
+  // Removes and returns the preparsed module for `subject`, if any.
+  std::optional<PreparsedModule> TakePreparsedModule(
+      const ImportTokens& subject);
+
+  // The number of threads ParseAndTypecheck uses to parse the modules
+  // imported (transitively) by the module it typechecks before typechecking
+  // begins; see PreparseImports. One (the default) parses each module only
+  // when it is imported.
+  int64_t import_parse_threads() const { return import_parse_threads_; }
+  void set_import_parse_threads(int64_t threads) {
+    import_parse_threads_ = threads;
+  }
+
   TypeInfoOwner& type_info_owner() { return type_info_owner_; }
 
   // Helper that gets the "root" type information for the module of the given
@@ -143,6 +202,37 @@ class ImportData {
       const AstNode* node) const;
   absl::StatusOr<TypeInfo*> GetRootTypeInfo(const Module* module);
 
+  // Memoized instantiations of functions: the derived type information from
+  // deducing `f`'s body under the parametric environment `env`, which any
+  // invocation of `f` with that environment may share regardless of its call
+  // site or module. Returns nullptr if there is none.
+  TypeInfo* GetMemoizedInstantiation(const Function* f,
+                                     const ParametricEnv& env) const {
+    auto it = memoized_instantiations_.find(std::make_pair(f, env));
+    return it == memoized_instantiations_.end() ? nullptr : it->second;
+  }
+  void MemoizeInstantiation(const Function* f, const ParametricEnv& env,
+                            TypeInfo* type_info) {
+    memoized_instantiations_.emplace(std::make_pair(f, env), type_info);
+  }
+
+  // Memoized constexpr values of expressions interpreted by the
+  // ConstexprEvaluator, keyed by the expression and the values of the names
+  // (parametrics and constexpr free variables) visible to it.
+  std::optional<InterpValue> GetMemoizedConstexpr(
+      const Expr* expr, const ParametricEnv& env) const {
+    auto it = memoized_constexprs_.find(std::make_pair(expr, env));
+    if (it == memoized_constexprs_.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+  void MemoizeConstexpr(const Expr* expr, ParametricEnv env,
+                        InterpValue value) {
+    memoized_constexprs_.emplace(std::make_pair(expr, std::move(env)),
+                                 std::move(value));
+  }
+
   // The "top level bindings" for a given module are the values that get
   // resolved at module scope on import. Keeping these on the ImportData avoids
   // recomputing them.
@@ -224,13 +314,32 @@ class ImportData {
   // module is not available.
   absl::StatusOr<const Module*> FindModule(const Span& span) const;
 
-  absl::flat_hash_map<ImportTokens, std::unique_ptr<ModuleInfo>> modules_;
+  // Declared first so that the borrowed modules outlive the type information
+  // owned by this object, which may refer to them.
+  std::shared_ptr<ImportCacheInterface> import_cache_;
+
+  absl::flat_hash_map<ImportTokens, ModuleInfo*> modules_;
+  std::vector<std::unique_ptr<ModuleInfo>> owned_modules_;
   absl::flat_hash_map<std::string, ModuleInfo*> path_to_module_info_;
+  // Root type information of borrowed modules, which is not held by
+  // `type_info_owner_`.
+  absl::flat_hash_map<const Module*, TypeInfo*> borrowed_root_type_infos_;
+  absl::flat_hash_map<const Module*, BytecodeCacheInterface*>
+      borrowed_bytecode_caches_;
   absl::flat_hash_map<Module*, std::unique_ptr<InterpBindings>>
       top_level_bindings_;
   absl::flat_hash_set<Module*> top_level_bindings_done_;
   absl::flat_hash_map<Module*, AstNode*> typecheck_wip_;
+  absl::flat_hash_map<ImportTokens, PreparsedModule> preparsed_modules_;
+  int64_t import_parse_threads_ = 1;
   TypeInfoOwner type_info_owner_;
+  // See GetMemoizedInstantiation(); the type information is owned by
+  // `type_info_owner_`.
+  absl::flat_hash_map<std::pair<const Function*, ParametricEnv>, TypeInfo*>
+      memoized_instantiations_;
+  // See GetMemoizedConstexpr().
+  absl::flat_hash_map<std::pair<const Expr*, ParametricEnv>, InterpValue>
+      memoized_constexprs_;
   const std::filesystem::path stdlib_path_;
   absl::Span<const std::filesystem::path> additional_search_paths_;
   WarningKindSet enabled_warnings_;
@@ -14,12 +14,16 @@
 
 #include "xls/dslx/import_routines.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/cleanup/cleanup.h"
@@ -37,10 +41,13 @@
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/module.h"
 #include "xls/dslx/frontend/parser.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/frontend/scanner.h"
+#include "xls/dslx/import_cache_interface.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/type_system/type_info.h"
 
@@ -142,6 +149,17 @@ static absl::StatusOr<std::filesystem::path> FindExistingPath(
                       GetCurrentDirectory().value(), stdlib_path));
 }
 
+// Reads and parses the module for `subject` from `path`.
+static absl::StatusOr<std::unique_ptr<Module>> ParseImportedModule(
+    const ImportTokens& subject, const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+
+  std::string fully_qualified_name = absl::StrJoin(subject.pieces(), ".");
+  Scanner scanner(path, contents);
+  Parser parser(/*module_name=*/fully_qualified_name, &scanner);
+  return parser.ParseModule();
+}
+
 absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                      const ImportTokens& subject,
                                      ImportData* import_data,
@@ -152,30 +170,123 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
     return import_data->Get(subject);
   }
 
+  if (ImportCacheInterface* import_cache = import_data->import_cache();
+      import_cache != nullptr) {
+    VLOG(3) << "DoImport (via import cache) subject: " << subject.ToString();
+    XLS_RETURN_IF_ERROR(
+        import_cache->Import(subject, import_span, import_data));
+    return import_data->Get(subject);
+  }
+
   VLOG(3) << "DoImport (uncached) subject: " << subject.ToString();
 
-  XLS_ASSIGN_OR_RETURN(
-      std::filesystem::path found_path,
-      FindExistingPath(subject, import_data->stdlib_path(),
-                       import_data->additional_search_paths(), import_span));
+  std::optional<PreparsedModule> preparsed =
+      import_data->TakePreparsedModule(subject);
+  std::filesystem::path found_path;
+  if (preparsed.has_value()) {
+    found_path = preparsed->path;
+  } else {
+    XLS_ASSIGN_OR_RETURN(
+        found_path,
+        FindExistingPath(subject, import_data->stdlib_path(),
+                         import_data->additional_search_paths(), import_span));
+  }
 
   XLS_RETURN_IF_ERROR(import_data->AddToImporterStack(import_span, found_path));
   absl::Cleanup cleanup = absl::MakeCleanup(
       [&] { CHECK_OK(import_data->PopFromImporterStack(import_span)); });
 
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(found_path));
-
-  absl::Span<std::string const> pieces = subject.pieces();
-  std::string fully_qualified_name = absl::StrJoin(pieces, ".");
-  VLOG(3) << "Parsing and typechecking " << fully_qualified_name << ": start";
-
-  Scanner scanner(found_path, contents);
-  Parser parser(/*module_name=*/fully_qualified_name, &scanner);
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module, parser.ParseModule());
+  std::unique_ptr<Module> module;
+  if (preparsed.has_value()) {
+    VLOG(3) << "Typechecking preparsed " << subject.ToString() << ": start";
+    module = std::move(preparsed->module);
+  } else {
+    VLOG(3) << "Parsing and typechecking " << subject.ToString() << ": start";
+    XLS_ASSIGN_OR_RETURN(module, ParseImportedModule(subject, found_path));
+  }
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info, ftypecheck(module.get()));
   return import_data->Put(
       subject, std::make_unique<ModuleInfo>(std::move(module), type_info,
                                             std::move(found_path)));
 }
 
+absl::Status PreparseImports(const Module& module, ImportData* import_data,
+                             int64_t threads) {
+  XLS_RET_CHECK(import_data != nullptr);
+  if (threads <= 1 || import_data->import_cache() != nullptr) {
+    return absl::OkStatus();
+  }
+
+  struct PendingImport {
+    ImportTokens subject;
+    Span import_span;
+  };
+  absl::flat_hash_set<ImportTokens> seen;
+  std::vector<PendingImport> frontier;
+  auto add_imports_of = [&](const Module& importer) {
+    for (const ModuleMember& member : importer.top()) {
+      if (!std::holds_alternative<Import*>(member)) {
+        continue;
+      }
+      const Import* import = std::get<Import*>(member);
+      ImportTokens subject(import->subject());
+      if (import_data->Contains(subject) ||
+          import_data->HasPreparsedModule(subject) ||
+          !seen.insert(subject).second) {
+        continue;
+      }
+      frontier.push_back(PendingImport{std::move(subject), import->span()});
+    }
+  };
+  add_imports_of(module);
+
+  // Parse the import graph a level at a time; all modules of a level are
+  // independent of each other.
+  while (!frontier.empty()) {
+    std::vector<PendingImport> level = std::move(frontier);
+    frontier.clear();
+    std::vector<absl::StatusOr<PreparsedModule>> parsed(level.size());
+    std::atomic<int64_t> next_index = 0;
+    auto parse_pending = [&]() {
+      for (int64_t i = next_index++; i < level.size(); i = next_index++) {
+        parsed[i] = [&]() -> absl::StatusOr<PreparsedModule> {
+          XLS_ASSIGN_OR_RETURN(
+              std::filesystem::path path,
+              FindExistingPath(level[i].subject, import_data->stdlib_path(),
+                               import_data->additional_search_paths(),
+                               level[i].import_span));
+          XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> parsed_module,
+                               ParseImportedModule(level[i].subject, path));
+          return PreparsedModule{std::move(parsed_module), std::move(path)};
+        }();
+      }
+    };
+    std::vector<std::unique_ptr<Thread>> workers;
+    int64_t worker_count = std::min<int64_t>(threads, level.size()) - 1;
+    workers.reserve(worker_count);
+    for (int64_t i = 0; i < worker_count; ++i) {
+      workers.push_back(std::make_unique<Thread>(parse_pending));
+    }
+    parse_pending();
+    for (std::unique_ptr<Thread>& worker : workers) {
+      worker->Join();
+    }
+
+    for (int64_t i = 0; i < level.size(); ++i) {
+      // Failures are dropped here: the import is parsed again by DoImport,
+      // which reports the error when typechecking reaches it, just as it
+      // would have without preparsing.
+      if (!parsed[i].ok()) {
+        VLOG(3) << "Could not preparse " << level[i].subject.ToString() << ": "
+                << parsed[i].status();
+        continue;
+      }
+      add_imports_of(*parsed[i]->module);
+      import_data->AddPreparsedModule(level[i].subject,
+                                      std::move(parsed[i]).value());
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace xls::dslx
@@ -15,8 +15,10 @@
 #ifndef XLS_DSLX_IMPORT_ROUTINES_H_
 #define XLS_DSLX_IMPORT_ROUTINES_H_
 
+#include <cstdint>
 #include <functional>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/import_data.h"
@@ -49,6 +51,18 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                      ImportData* import_data,
                                      const Span& import_span);
 
+// Finds and parses the modules transitively imported by `module` which are not
+// yet known to `import_data`, using up to `threads` threads, and notes them as
+// preparsed modules in `import_data` so that DoImport only has to typecheck
+// them. Typechecking still happens depth-first in import order, so results
+// and error reporting are unchanged: an import which fails to be found or
+// parsed here is simply parsed again, and its error reported, by DoImport.
+//
+// Does nothing if `threads` is at most one or `import_data` has an import
+// cache.
+absl::Status PreparseImports(const Module& module, ImportData* import_data,
+                             int64_t threads);
+
 }  // namespace xls::dslx
 
 #endif  // XLS_DSLX_IMPORT_ROUTINES_H_
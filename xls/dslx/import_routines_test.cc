@@ -0,0 +1,118 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/import_routines.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/warning_kind.h"
+
+namespace xls::dslx {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+// Typechecks a module importing `dep_count` modules which each import `std`
+// and a shared `leaf` module, parsing the imports on `threads` threads.
+absl::StatusOr<std::vector<std::string>> TypecheckWideImports(
+    const std::filesystem::path& dir, int64_t dep_count, int64_t threads) {
+  std::vector<std::filesystem::path> search_paths = {dir};
+  std::unique_ptr<ImportData> import_data = CreateImportDataPtr(
+      kDefaultDslxStdlibPath, search_paths, kDefaultWarningsSet);
+  import_data->set_import_parse_threads(threads);
+  std::string program;
+  std::string body = "u32:0";
+  for (int64_t i = 0; i < dep_count; ++i) {
+    absl::StrAppend(&program, "import dep", i, ";\n");
+    absl::StrAppend(&body, " + dep", i, "::f()");
+  }
+  absl::StrAppend(&program, "fn main() -> u32 { ", body, " }\n");
+  XLS_RETURN_IF_ERROR(
+      ParseAndTypecheck(program, "main.x", "main", import_data.get())
+          .status());
+
+  std::vector<std::string> paths;
+  for (int64_t i = 0; i < dep_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(
+        ModuleInfo * info,
+        import_data->Get(ImportTokens({absl::StrCat("dep", i)})));
+    paths.push_back(info->path());
+  }
+  return paths;
+}
+
+class PreparseImportsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(temp_dir_, TempDirectory::Create());
+    XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "leaf.x",
+                                  "pub const K = u32:7;\n"));
+    for (int64_t i = 0; i < kDepCount; ++i) {
+      XLS_ASSERT_OK(SetFileContents(
+          temp_dir_->path() / absl::StrCat("dep", i, ".x"),
+          absl::StrCat("import std;\nimport leaf;\n",
+                       "pub fn f() -> u32 { std::umax(leaf::K, u32:", i,
+                       ") }\n")));
+    }
+  }
+
+  static constexpr int64_t kDepCount = 16;
+  std::optional<TempDirectory> temp_dir_;
+};
+
+TEST_F(PreparseImportsTest, ConcurrentParseMatchesSequential) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> sequential,
+      TypecheckWideImports(temp_dir_->path(), kDepCount, /*threads=*/1));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> concurrent,
+      TypecheckWideImports(temp_dir_->path(), kDepCount, /*threads=*/4));
+  EXPECT_EQ(sequential, concurrent);
+}
+
+TEST_F(PreparseImportsTest, ErrorsAreReportedInImportOrder) {
+  // Two broken imports: the error must come from the first one imported, no
+  // matter which is parsed first.
+  XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "dep3.x",
+                                "pub fn f() -> u32 { dep3_broken }\n"));
+  XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "dep9.x",
+                                "pub fn f() -> u32 {\n"));
+  for (int64_t threads : {1, 8}) {
+    EXPECT_THAT(TypecheckWideImports(temp_dir_->path(), kDepCount, threads),
+                StatusIs(absl::StatusCode::kInvalidArgument,
+                         HasSubstr("dep3_broken")))
+        << "threads: " << threads;
+  }
+}
+
+}  // namespace
+}  // namespace xls::dslx
@@ -37,6 +37,7 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/command_line_utils.h"
 #include "xls/dslx/run_routines/run_comparator.h"
 #include "xls/dslx/run_routines/run_routines.h"
@@ -79,6 +80,9 @@ ABSL_FLAG(bool, trace_channels, false,
 ABSL_FLAG(int64_t, max_ticks, 100000,
           "If non-zero, the maximum number of ticks to execute on any proc. If "
           "exceeded an error is returned.");
+ABSL_FLAG(int64_t, test_threads, 1,
+          "Number of threads on which to run tests and quickchecks; 0 to use "
+          "all available CPUs. Results are reported in module order.");
 // LINT.ThenChange(//xls/build_rules/xls_dslx_rules.bzl)
 
 namespace xls::dslx {
@@ -100,7 +104,7 @@ absl::StatusOr<TestResult> RealMain(
     const std::optional<std::string>& test_filter,
     FormatPreference format_preference, CompareFlag compare_flag, bool execute,
     bool warnings_as_errors, std::optional<int64_t> seed, bool trace_channels,
-    std::optional<int64_t> max_ticks,
+    std::optional<int64_t> max_ticks, int64_t test_threads,
     std::optional<std::string_view> xml_output_file) {
   XLS_ASSIGN_OR_RETURN(
       WarningKindSet warnings,
@@ -150,7 +154,8 @@ absl::StatusOr<TestResult> RealMain(
                                  .warnings_as_errors = warnings_as_errors,
                                  .warnings = warnings,
                                  .trace_channels = trace_channels,
-                                 .max_ticks = max_ticks};
+                                 .max_ticks = max_ticks,
+                                 .test_threads = test_threads};
 
   XLS_ASSIGN_OR_RETURN(
       TestResultData test_result,
@@ -194,6 +199,10 @@ int main(int argc, char* argv[]) {
       absl::GetFlag(FLAGS_max_ticks) == 0
           ? std::nullopt
           : std::optional<int64_t>(absl::GetFlag(FLAGS_max_ticks));
+  int64_t test_threads = absl::GetFlag(FLAGS_test_threads);
+  if (test_threads <= 0) {
+    test_threads = xls::AvailableCPUs();
+  }
 
   xls::dslx::CompareFlag compare_flag;
   if (compare_flag_str == "none") {
@@ -257,7 +266,8 @@ int main(int argc, char* argv[]) {
 
   absl::StatusOr<xls::dslx::TestResult> test_result = xls::dslx::RealMain(
       args[0], dslx_paths, test_filter, preference, compare_flag, execute,
-      warnings_as_errors, seed, trace_channels, max_ticks, xml_output_file);
+      warnings_as_errors, seed, trace_channels, max_ticks, test_threads,
+      xml_output_file);
   if (!test_result.ok()) {
     return xls::ExitStatus(test_result.status());
   }
@@ -34,6 +34,11 @@ struct ConvertOptions {
   // Should the generated IR be verified?
   bool verify_ir = true;
 
+  // Should the function builders fold operations on literals and forward tuple
+  // elements as the IR is emitted? This yields smaller IR, which is cheaper to
+  // verify and optimize, but strays further from the structure of the DSLX.
+  bool simplify_ir = false;
+
   // Should warnings be treated as errors?
   bool warnings_as_errors = true;
 
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <optional>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -553,43 +554,25 @@ absl::StatusOr<std::vector<Proc*>> GetTopLevelProcs(Module* module,
 // DSLX functions from a list. A non-derived non-parametric function is not an
 // inferred function (e.g. derived from a proc spawn/invocation or a parametric
 // function). The 'ready' input list is modified and cannot be nullptr.
+//
+// The first record of each function (and parametric environment, for
+// parametric functions) is kept.
 static void RemoveFunctionDuplicates(std::vector<ConversionRecord>* ready) {
-  for (auto iter_func = ready->begin(); iter_func != ready->end();
-       iter_func++) {
-    const ConversionRecord& function_cr = *iter_func;
-    for (auto iter_subject = iter_func + 1; iter_subject != ready->end();) {
-      const ConversionRecord& subject_cr = *iter_subject;
-
-      bool same_fns = function_cr.f() == subject_cr.f();
-      bool either_is_proc_instance_fn =
-          function_cr.f()->tag() == FunctionTag::kProcConfig ||
-          function_cr.f()->tag() == FunctionTag::kProcNext ||
-          subject_cr.f()->tag() == FunctionTag::kProcConfig ||
-          subject_cr.f()->tag() == FunctionTag::kProcNext;
-      bool either_is_parametric =
-          function_cr.f()->IsParametric() || subject_cr.f()->IsParametric();
-      bool both_are_parametric =
-          function_cr.f()->IsParametric() && subject_cr.f()->IsParametric();
-
-      if (same_fns && !either_is_proc_instance_fn) {
-        // If neither are parametric, then function identity comparison is
-        // a sufficient test to eliminate detected duplicates.
-        if (!either_is_parametric) {
-          iter_subject = ready->erase(iter_subject);
-          continue;
-        }
-
-        // If the functions are the same and they have the same parametric
-        // environment, eliminate any duplicates.
-        if (both_are_parametric &&
-            function_cr.parametric_env() == subject_cr.parametric_env()) {
-          iter_subject = ready->erase(iter_subject);
-          continue;
-        }
-      }
-      iter_subject++;
+  absl::flat_hash_set<std::pair<const Function*, ParametricEnv>> seen;
+  auto is_duplicate = [&](const ConversionRecord& cr) {
+    if (cr.f()->tag() == FunctionTag::kProcConfig ||
+        cr.f()->tag() == FunctionTag::kProcNext) {
+      return false;
     }
-  }
+    // If the function is not parametric then function identity is a
+    // sufficient test.
+    return !seen
+                .insert({cr.f(), cr.f()->IsParametric() ? cr.parametric_env()
+                                                         : ParametricEnv()})
+                .second;
+  };
+  ready->erase(std::remove_if(ready->begin(), ready->end(), is_duplicate),
+               ready->end());
 }
 
 // Traverses the definition of a node to find callees.
@@ -614,38 +597,55 @@ static absl::StatusOr<std::vector<Callee>> GetCallees(
   return std::move(visitor.callees());
 }
 
+namespace {
+
+// The conversion order as it is being built, along with an index of the
+// functions it contains which are not proc functions. With thousands of
+// parametric instantiations, scanning the order for every callee to determine
+// whether it is already present dominates.
+class ReadyList {
+ public:
+  bool Contains(Function* f, Module* m, const ParametricEnv& bindings) const {
+    return functions_.contains(std::make_tuple(f, m, bindings));
+  }
+
+  void Add(ConversionRecord cr) {
+    if (!cr.proc_id().has_value()) {
+      functions_.insert(
+          std::make_tuple(cr.f(), cr.module(), cr.parametric_env()));
+    }
+    records_.push_back(std::move(cr));
+  }
+
+  std::vector<ConversionRecord>& records() { return records_; }
+
+ private:
+  std::vector<ConversionRecord> records_;
+  absl::flat_hash_set<std::tuple<Function*, Module*, ParametricEnv>>
+      functions_;
+};
+
+}  // namespace
+
 static bool IsReady(std::variant<Function*, TestFunction*> f, Module* m,
-                    const ParametricEnv& bindings,
-                    const std::vector<ConversionRecord>* ready) {
+                    const ParametricEnv& bindings, const ReadyList* ready) {
   // Test functions are always the root and non-parametric, so they're always
   // ready.
   if (std::holds_alternative<TestFunction*>(f)) {
     return true;
   }
-
-  auto matches_fn = [&](const ConversionRecord& cr, Function* f) {
-    return cr.f() == f && cr.module() == m && cr.parametric_env() == bindings &&
-           !cr.proc_id().has_value();
-  };
-
-  for (const ConversionRecord& cr : *ready) {
-    if (matches_fn(cr, std::get<Function*>(f))) {
-      return true;
-    }
-  }
-  return false;
+  return ready->Contains(std::get<Function*>(f), m, bindings);
 }
 
 // Forward decl.
 static absl::Status ProcessCallees(absl::Span<const Callee> orig_callees,
-                                   std::vector<ConversionRecord>* ready);
+                                   ReadyList* ready);
 
 // Adds (f, bindings) to conversion order after deps have been added.
 static absl::Status AddToReady(std::variant<Function*, TestFunction*> f,
                                const Invocation* invocation, Module* m,
                                TypeInfo* type_info,
-                               const ParametricEnv& bindings,
-                               std::vector<ConversionRecord>* ready,
+                               const ParametricEnv& bindings, ReadyList* ready,
                                const std::optional<ProcId>& proc_id,
                                bool is_top = false) {
   CHECK_EQ(type_info->module(), m);
@@ -674,12 +674,12 @@ static absl::Status AddToReady(std::variant<Function*, TestFunction*> f,
       ConversionRecord cr,
       ConversionRecord::Make(fn, invocation, m, type_info, bindings,
                              orig_callees, proc_id, is_top));
-  ready->push_back(std::move(cr));
+  ready->Add(std::move(cr));
   return absl::OkStatus();
 }
 
 static absl::Status ProcessCallees(absl::Span<const Callee> orig_callees,
-                                   std::vector<ConversionRecord>* ready) {
+                                   ReadyList* ready) {
   // Knock out all callees that are already in the (ready) order.
   std::vector<Callee> non_ready;
   {
@@ -703,7 +703,7 @@ static absl::Status ProcessCallees(absl::Span<const Callee> orig_callees,
 
 static absl::StatusOr<std::vector<ConversionRecord>> GetOrderForProc(
     std::variant<Proc*, TestProc*> entry, TypeInfo* type_info, bool is_top) {
-  std::vector<ConversionRecord> ready;
+  ReadyList ready;
   Proc* p;
   if (std::holds_alternative<TestProc*>(entry)) {
     p = std::get<TestProc*>(entry)->proc();
@@ -728,7 +728,7 @@ static absl::StatusOr<std::vector<ConversionRecord>> GetOrderForProc(
   std::vector<ConversionRecord> final_order;
   std::vector<ConversionRecord> config_fns;
   std::vector<ConversionRecord> next_fns;
-  for (const auto& record : ready) {
+  for (const auto& record : ready.records()) {
     if (record.f()->tag() == FunctionTag::kProcConfig) {
       config_fns.push_back(record);
     } else if (record.f()->tag() == FunctionTag::kProcNext) {
@@ -748,7 +748,7 @@ static absl::StatusOr<std::vector<ConversionRecord>> GetOrderForProc(
 absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
                                                        TypeInfo* type_info) {
   CHECK_EQ(type_info->module(), module);
-  std::vector<ConversionRecord> ready;
+  ReadyList ready_list;
 
   for (ModuleMember member : module->top()) {
     absl::Status status = absl::visit(
@@ -758,7 +758,7 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
               XLS_RET_CHECK(!function->IsParametric()) << function->ToString();
 
               return AddToReady(function, /*invocation=*/nullptr, module,
-                                type_info, ParametricEnv(), &ready, {});
+                                type_info, ParametricEnv(), &ready_list, {});
             },
             [&](Function* f) -> absl::Status {
               // NOTE: Proc creation is driven by Spawn instantiations - the
@@ -769,13 +769,13 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
               }
 
               return AddToReady(f, /*invocation=*/nullptr, module, type_info,
-                                ParametricEnv(), &ready, {});
+                                ParametricEnv(), &ready_list, {});
             },
             [&](ConstantDef* constant_def) -> absl::Status {
               XLS_ASSIGN_OR_RETURN(const std::vector<Callee> callees,
                                    GetCallees(constant_def->value(), module,
                                               type_info, ParametricEnv(), {}));
-              return ProcessCallees(callees, &ready);
+              return ProcessCallees(callees, &ready_list);
             },
             // See note above: proc creation is driven by spawn()
             // instantiations.
@@ -793,6 +793,8 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
     XLS_RETURN_IF_ERROR(status);
   }
 
+  std::vector<ConversionRecord> ready = std::move(ready_list.records());
+
   // Collect the top level procs.
   XLS_ASSIGN_OR_RETURN(std::vector<Proc*> top_level_procs,
                        GetTopLevelProcs(module, type_info));
@@ -820,17 +822,18 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
 
 absl::StatusOr<std::vector<ConversionRecord>> GetOrderForEntry(
     std::variant<Function*, Proc*> entry, TypeInfo* type_info) {
-  std::vector<ConversionRecord> ready;
   if (std::holds_alternative<Function*>(entry)) {
     Function* f = std::get<Function*>(entry);
     if (f->proc().has_value()) {
       XLS_ASSIGN_OR_RETURN(
           type_info, type_info->GetTopLevelProcTypeInfo(f->proc().value()));
     }
+    ReadyList ready_list;
     XLS_RETURN_IF_ERROR(AddToReady(f,
                                    /*invocation=*/nullptr, f->owner(),
-                                   type_info, ParametricEnv(), &ready, {},
+                                   type_info, ParametricEnv(), &ready_list, {},
                                    /*is_top=*/true));
+    std::vector<ConversionRecord> ready = std::move(ready_list.records());
     RemoveFunctionDuplicates(&ready);
     return ready;
   }
@@ -838,7 +841,8 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrderForEntry(
   Proc* p = std::get<Proc*>(entry);
   XLS_ASSIGN_OR_RETURN(TypeInfo * new_ti,
                        type_info->GetTopLevelProcTypeInfo(p));
-  XLS_ASSIGN_OR_RETURN(ready, GetOrderForProc(p, new_ti, /*is_top=*/true));
+  XLS_ASSIGN_OR_RETURN(std::vector<ConversionRecord> ready,
+                       GetOrderForProc(p, new_ti, /*is_top=*/true));
   RemoveFunctionDuplicates(&ready);
   return ready;
 }
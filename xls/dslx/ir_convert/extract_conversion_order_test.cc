@@ -14,6 +14,7 @@
 
 #include "xls/dslx/ir_convert/extract_conversion_order.h"
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -94,6 +95,40 @@ fn main() -> u32 { f(u2:0) }
   EXPECT_EQ(order[2].parametric_env(), ParametricEnv());
 }
 
+// Each instantiation appears once, before its first caller, however many
+// functions call it.
+TEST(ExtractConversionOrderTest, SharedParametricInstantiations) {
+  constexpr std::string_view kProgram = R"(
+fn g<M: u32>(x: bits[M]) -> u32 { M }
+fn f<N: u32>(x: bits[N]) -> u32 { g(x) + g(u3:0) }
+fn a() -> u32 { f(u2:0) + g(u2:0) }
+fn b() -> u32 { f(u4:0) + f(u2:0) + g(u3:0) }
+)";
+  auto import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kProgram, "test.x", "test", &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<ConversionRecord> order,
+                           GetOrder(tm.module, tm.type_info));
+  auto env = [](std::string_view name, int64_t value) {
+    return ParametricEnv(absl::flat_hash_map<std::string, InterpValue>{
+        {std::string(name), InterpValue::MakeUBits(/*bit_count=*/32, value)}});
+  };
+  ASSERT_EQ(order.size(), 7);
+  EXPECT_EQ(order[0].f()->identifier(), "g");
+  EXPECT_EQ(order[0].parametric_env(), env("M", 2));
+  EXPECT_EQ(order[1].f()->identifier(), "g");
+  EXPECT_EQ(order[1].parametric_env(), env("M", 3));
+  EXPECT_EQ(order[2].f()->identifier(), "f");
+  EXPECT_EQ(order[2].parametric_env(), env("N", 2));
+  EXPECT_EQ(order[3].f()->identifier(), "a");
+  EXPECT_EQ(order[4].f()->identifier(), "g");
+  EXPECT_EQ(order[4].parametric_env(), env("M", 4));
+  EXPECT_EQ(order[5].f()->identifier(), "f");
+  EXPECT_EQ(order[5].parametric_env(), env("N", 4));
+  EXPECT_EQ(order[6].f()->identifier(), "b");
+}
+
 TEST(ExtractConversionOrderTest, BuiltinIsElided) {
   constexpr std::string_view kProgram = R"(
 fn main() -> u32 { fail!("failure", u32:0) }
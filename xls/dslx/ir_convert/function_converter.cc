@@ -399,6 +399,7 @@ void FunctionConverter::SetFunctionBuilder(
     std::unique_ptr<BuilderBase> builder) {
   CHECK(function_builder_ == nullptr);
   function_builder_ = std::move(builder);
+  function_builder_->set_simplify(options_.simplify_ir);
 }
 
 void FunctionConverter::AddConstantDep(ConstantDef* constant_def) {
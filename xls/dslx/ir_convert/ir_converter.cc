@@ -44,6 +44,7 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/trace.h"
 #include "xls/dslx/channel_direction.h"
 #include "xls/dslx/command_line_utils.h"
 #include "xls/dslx/constexpr_evaluator.h"
@@ -52,6 +53,7 @@
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/parser.h"
 #include "xls/dslx/frontend/scanner.h"
+#include "xls/dslx/import_cache_interface.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/interp_value.h"
 #include "xls/dslx/ir_convert/convert_options.h"
@@ -324,6 +326,8 @@ absl::Status ConvertCallGraph(absl::Span<const ConversionRecord> order,
 absl::Status ConvertModuleIntoPackage(Module* module, ImportData* import_data,
                                       const ConvertOptions& options,
                                       Package* package) {
+  TraceSpan span("ir_convert");
+  span.AddArg("module", module->name());
   XLS_ASSIGN_OR_RETURN(TypeInfo * root_type_info,
                        import_data->GetRootTypeInfo(module));
   XLS_ASSIGN_OR_RETURN(std::vector<ConversionRecord> order,
@@ -491,7 +495,8 @@ absl::StatusOr<std::unique_ptr<Package>> ConvertFilesToPackage(
     absl::Span<const std::string_view> paths, const std::string& stdlib_path,
     absl::Span<const std::filesystem::path> dslx_paths,
     const ConvertOptions& convert_options, std::optional<std::string_view> top,
-    std::optional<std::string_view> package_name, bool* printed_error) {
+    std::optional<std::string_view> package_name, bool* printed_error,
+    std::shared_ptr<ImportCacheInterface> import_cache) {
   std::string resolved_package_name;
   if (package_name.has_value()) {
     resolved_package_name = package_name.value();
@@ -516,6 +521,7 @@ absl::StatusOr<std::unique_ptr<Package>> ConvertFilesToPackage(
   for (std::string_view path : paths) {
     ImportData import_data(CreateImportData(stdlib_path, dslx_paths,
                                             convert_options.enabled_warnings));
+    import_data.SetImportCache(import_cache);
     XLS_ASSIGN_OR_RETURN(std::string text, GetFileContents(path));
     XLS_ASSIGN_OR_RETURN(std::string module_name, PathToName(path));
     XLS_RETURN_IF_ERROR(AddContentsToPackage(
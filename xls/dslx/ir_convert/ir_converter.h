@@ -25,6 +25,7 @@
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/import_cache_interface.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/ir_convert/convert_options.h"
 #include "xls/dslx/type_system/parametric_env.h"
@@ -111,13 +112,17 @@ absl::Status ConvertOneFunctionIntoPackage(Module* module, Function* fn,
 //   package_name: Optionally, the name of the package.
 //   printed_error: If a non-null pointer is passes, sets the contents to a
 //     boolean value indicating if an error was printed during conversion.
+//   import_cache: Optionally, a cache of typechecked modules (see
+//     ImportCache) from which the imports of the files are taken, so that they
+//     are not parsed and typechecked again by every conversion.
 absl::StatusOr<std::unique_ptr<Package>> ConvertFilesToPackage(
     absl::Span<const std::string_view> paths, const std::string& stdlib_path,
     absl::Span<const std::filesystem::path> dslx_paths,
     const ConvertOptions& convert_options,
     std::optional<std::string_view> top = std::nullopt,
     std::optional<std::string_view> package_name = std::nullopt,
-    bool* printed_error = nullptr);
+    bool* printed_error = nullptr,
+    std::shared_ptr<ImportCacheInterface> import_cache = nullptr);
 
 }  // namespace xls::dslx
 
@@ -0,0 +1,59 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/dslx/ir_convert/ir_converter_client.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "grpcpp/channel.h"
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/security/credentials.h"
+#include "grpcpp/support/status.h"
+#include "grpcpp/support/time.h"
+#include "xls/dslx/ir_convert/ir_converter_service.grpc.pb.h"
+#include "xls/dslx/ir_convert/ir_converter_service.pb.h"
+
+namespace xls::dslx {
+
+absl::StatusOr<std::string> ConvertToIrViaServer(
+    std::string_view server, const ConvertToIrRequest& request,
+    absl::Duration deadline) {
+  std::shared_ptr<grpc::Channel> channel =
+      grpc::CreateChannel(std::string(server),
+                          grpc::experimental::LocalCredentials(LOCAL_TCP));
+  std::unique_ptr<IrConverterService::Stub> stub =
+      IrConverterService::NewStub(channel);
+
+  grpc::ClientContext context;
+  context.set_deadline(absl::ToChronoTime(absl::Now() + deadline));
+  ConvertToIrResponse response;
+  grpc::Status status = stub->ConvertToIr(&context, request, &response);
+  if (!status.ok()) {
+    // This assumes that the status code enums match up.
+    return absl::Status(static_cast<absl::StatusCode>(status.error_code()),
+                        status.error_message());
+  }
+  return std::move(*response.mutable_ir());
+}
+
+}  // namespace xls::dslx
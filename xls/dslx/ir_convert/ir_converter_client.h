@@ -0,0 +1,37 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_DSLX_IR_CONVERT_IR_CONVERTER_CLIENT_H_
+#define XLS_DSLX_IR_CONVERT_IR_CONVERTER_CLIENT_H_
+
+#include <string>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "xls/dslx/ir_convert/ir_converter_service.pb.h"
+
+namespace xls::dslx {
+
+// Converts DSLX files to IR via the IrConverterService at `server` (e.g.
+// "localhost:10000"; see ir_converter_server_main) and returns the IR text.
+// Fails if the server does not respond within `deadline`.
+absl::StatusOr<std::string> ConvertToIrViaServer(
+    std::string_view server, const ConvertToIrRequest& request,
+    absl::Duration deadline = absl::Seconds(60));
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_IR_CONVERT_IR_CONVERTER_CLIENT_H_
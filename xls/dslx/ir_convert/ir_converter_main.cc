@@ -19,11 +19,14 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <system_error>  // NOLINT
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/flags/flag.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
@@ -33,6 +36,8 @@
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/ir_convert/convert_options.h"
 #include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/dslx/ir_convert/ir_converter_client.h"
+#include "xls/dslx/ir_convert/ir_converter_service.pb.h"
 #include "xls/dslx/warning_kind.h"
 #include "xls/ir/package.h"
 
@@ -55,12 +60,21 @@ ABSL_FLAG(bool, emit_fail_as_assert, true,
           "Feature flag for emitting fail!() in the DSL as an assert IR op.");
 ABSL_FLAG(bool, verify, true,
           "If true, verifies the generated IR for correctness.");
+ABSL_FLAG(bool, simplify_ir, false,
+          "If true, folds operations on literals and forwards tuple elements "
+          "as the IR is emitted, yielding smaller IR.");
 
 ABSL_FLAG(std::string, disable_warnings, "",
           "Comma-delimited list of warnings to disable -- not generally "
           "recommended, but can be used in exceptional circumstances");
 ABSL_FLAG(bool, warnings_as_errors, true,
           "Whether to fail early, as an error, if warnings are detected");
+ABSL_FLAG(std::string, compile_server, "",
+          "Address (e.g. localhost:10000) of an ir_converter_server_main to "
+          "convert with. The server keeps imported modules, including the "
+          "standard library, parsed and typechecked between invocations. If "
+          "the server is unreachable or the conversion fails the input is "
+          "converted locally, which also reports any errors.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
 namespace xls::dslx {
@@ -81,13 +95,59 @@ If no entry point is given all functions within the module are converted:
   ir_converter_main path/to/frobulator.x
 )";
 
+// Converts the input via the server given by --compile_server, returning
+// whether it succeeded (in which case the IR has been printed).
+bool ConvertViaServer(absl::Span<const std::string_view> paths,
+                      std::optional<std::string_view> top,
+                      std::optional<std::string_view> package_name,
+                      const std::string& stdlib_path,
+                      absl::Span<const std::filesystem::path> dslx_paths,
+                      bool emit_fail_as_assert, bool verify_ir,
+                      bool simplify_ir, bool warnings_as_errors) {
+  std::string server = absl::GetFlag(FLAGS_compile_server);
+  if (server.empty() || absl::c_linear_search(paths, "/dev/stdin")) {
+    return false;
+  }
+  std::error_code ec;
+  std::filesystem::path working_directory = std::filesystem::current_path(ec);
+  if (ec) {
+    return false;
+  }
+  ConvertToIrRequest request;
+  request.set_working_directory(working_directory.string());
+  for (std::string_view path : paths) {
+    request.add_paths(std::string(path));
+  }
+  request.set_top(std::string(top.value_or("")));
+  request.set_package_name(std::string(package_name.value_or("")));
+  request.set_stdlib_path(stdlib_path);
+  for (const std::filesystem::path& path : dslx_paths) {
+    request.add_dslx_paths(path.string());
+  }
+  request.set_emit_fail_as_assert(emit_fail_as_assert);
+  request.set_verify_ir(verify_ir);
+  request.set_simplify_ir(simplify_ir);
+  request.set_warnings_as_errors(warnings_as_errors);
+  request.set_disable_warnings(absl::GetFlag(FLAGS_disable_warnings));
+
+  absl::StatusOr<std::string> ir = ConvertToIrViaServer(server, request);
+  if (!ir.ok()) {
+    VLOG(1) << "Conversion via " << server
+            << " failed, converting locally: " << ir.status();
+    return false;
+  }
+  std::cout << *ir;
+  return true;
+}
+
 absl::Status RealMain(absl::Span<const std::string_view> paths,
                       std::optional<std::string_view> top,
                       std::optional<std::string_view> package_name,
                       const std::string& stdlib_path,
                       absl::Span<const std::filesystem::path> dslx_paths,
                       bool emit_fail_as_assert, bool verify_ir,
-                      bool warnings_as_errors, bool* printed_error) {
+                      bool simplify_ir, bool warnings_as_errors,
+                      bool* printed_error) {
   XLS_ASSIGN_OR_RETURN(
       WarningKindSet enabled_warnings,
       WarningKindSetFromDisabledString(absl::GetFlag(FLAGS_disable_warnings)));
@@ -95,6 +155,7 @@ absl::Status RealMain(absl::Span<const std::string_view> paths,
       .emit_positions = true,
       .emit_fail_as_assert = emit_fail_as_assert,
       .verify_ir = verify_ir,
+      .simplify_ir = simplify_ir,
       .warnings_as_errors = warnings_as_errors,
       .enabled_warnings = enabled_warnings,
   };
@@ -163,11 +224,17 @@ int main(int argc, char* argv[]) {
 
   bool emit_fail_as_assert = absl::GetFlag(FLAGS_emit_fail_as_assert);
   bool verify_ir = absl::GetFlag(FLAGS_verify);
+  bool simplify_ir = absl::GetFlag(FLAGS_simplify_ir);
   bool warnings_as_errors = absl::GetFlag(FLAGS_warnings_as_errors);
+  if (xls::dslx::ConvertViaServer(args, top, package_name, stdlib_path,
+                                 dslx_paths, emit_fail_as_assert, verify_ir,
+                                 simplify_ir, warnings_as_errors)) {
+    return EXIT_SUCCESS;
+  }
   bool printed_error = false;
   absl::Status status = xls::dslx::RealMain(
       args, top, package_name, stdlib_path, dslx_paths, emit_fail_as_assert,
-      verify_ir, warnings_as_errors, &printed_error);
+      verify_ir, simplify_ir, warnings_as_errors, &printed_error);
   if (printed_error) {
     return EXIT_FAILURE;
   }
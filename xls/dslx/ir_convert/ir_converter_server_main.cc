@@ -0,0 +1,102 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/status.h"
+#include "xls/common/init_xls.h"
+#include "xls/dslx/ir_convert/ir_converter_service.grpc.pb.h"
+#include "xls/dslx/ir_convert/ir_converter_service.pb.h"
+#include "xls/dslx/ir_convert/resident_ir_converter.h"
+
+const char kUsage[] = R"(
+Launches a server which converts DSLX to IR for ir_converter_main invocations
+given --compile_server=localhost:<port>. The server keeps the standard library
+and other imported modules parsed and typechecked between conversions, so that
+short conversions need not pay to process them again. The server must see the
+same files at the same paths as its clients.
+
+Invocation:
+
+  ir_converter_server_main --port=10000
+)";
+
+ABSL_FLAG(int32_t, port, 10000, "Port to listen on.");
+ABSL_FLAG(int64_t, max_cache_count, 8,
+          "Maximum number of import caches to keep; there is one for each "
+          "combination of working directory, search paths and warnings.");
+
+namespace xls::dslx {
+namespace {
+
+class IrConverterServiceImpl : public IrConverterService::Service {
+ public:
+  explicit IrConverterServiceImpl(int64_t max_cache_count)
+      : converter_(max_cache_count) {}
+
+  ::grpc::Status ConvertToIr(::grpc::ServerContext* server_context,
+                             const ConvertToIrRequest* request,
+                             ConvertToIrResponse* response) override {
+    absl::StatusOr<std::string> ir = converter_.Convert(*request);
+    if (!ir.ok()) {
+      // This assumes that the status code enums match up.
+      return ::grpc::Status(
+          static_cast<::grpc::StatusCode>(ir.status().code()),
+          std::string(ir.status().message()));
+    }
+    response->set_ir(*std::move(ir));
+    return ::grpc::Status::OK;
+  }
+
+ private:
+  ResidentIrConverter converter_;
+};
+
+void RealMain() {
+  int port = absl::GetFlag(FLAGS_port);
+  std::string server_address = absl::StrCat("localhost:", port);
+  IrConverterServiceImpl service(absl::GetFlag(FLAGS_max_cache_count));
+
+  ::grpc::ServerBuilder builder;
+  builder.AddListeningPort(
+      server_address, ::grpc::experimental::LocalServerCredentials(LOCAL_TCP));
+  builder.RegisterService(&service);
+  std::unique_ptr<::grpc::Server> server(builder.BuildAndStart());
+  LOG(INFO) << "Serving on port: " << port;
+  server->Wait();
+}
+
+}  // namespace
+}  // namespace xls::dslx
+
+int main(int argc, char** argv) {
+  xls::InitXls(kUsage, argc, argv);
+
+  xls::dslx::RealMain();
+
+  return EXIT_SUCCESS;
+}
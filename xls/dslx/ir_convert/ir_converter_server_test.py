@@ -0,0 +1,98 @@
+#
+# Copyright 2024 The XLS Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Tests of ir_converter_main converting via ir_converter_server_main."""
+
+import os
+import subprocess
+import time
+
+import portpicker
+
+from absl.testing import absltest
+from xls.common import runfiles
+
+IR_CONVERTER_MAIN_PATH = runfiles.get_path(
+    'xls/dslx/ir_convert/ir_converter_main'
+)
+SERVER_PATH = runfiles.get_path('xls/dslx/ir_convert/ir_converter_server_main')
+
+MAIN_DOT_X = """
+import std;
+import helper;
+
+fn main(x: u32) -> u32 { std::umax(x, helper::LIMIT) }
+"""
+
+
+class IrConverterServerTest(absltest.TestCase):
+
+  def setUp(self):
+    super().setUp()
+    self.tempdir = self.create_tempdir().full_path
+    self._write('main.x', MAIN_DOT_X)
+    self._write('helper.x', 'pub const LIMIT = u32:42;')
+
+  def _write(self, filename, contents):
+    with open(os.path.join(self.tempdir, filename), 'w') as f:
+      f.write(contents)
+
+  def _start_server(self):
+    port = portpicker.pick_unused_port()
+    proc = subprocess.Popen([SERVER_PATH, f'--port={port}'])
+    self.addCleanup(proc.wait)
+    self.addCleanup(proc.terminate)
+
+    # allow some time for the server to open the port before continuing
+    time.sleep(1)
+    return port
+
+  def _ir_convert(self, *flags, check=True):
+    return subprocess.run(
+        [IR_CONVERTER_MAIN_PATH, 'main.x', '--top=main'] + list(flags),
+        encoding='utf-8',
+        cwd=self.tempdir,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        check=check,
+    )
+
+  def test_same_ir_as_local_conversion(self):
+    local_ir = self._ir_convert().stdout
+    port = self._start_server()
+    flag = f'--compile_server=localhost:{port}'
+    self.assertEqual(self._ir_convert(flag).stdout, local_ir)
+    # The second conversion reuses the imports typechecked by the first.
+    self.assertEqual(self._ir_convert(flag).stdout, local_ir)
+
+    self._write('helper.x', 'pub const LIMIT = u32:43;')
+    self.assertEqual(self._ir_convert(flag).stdout, self._ir_convert().stdout)
+
+  def test_errors_are_reported_locally(self):
+    port = self._start_server()
+    self._write('main.x', 'fn main(x: u32) -> u8 { x }')
+    result = self._ir_convert(f'--compile_server=localhost:{port}', check=False)
+    self.assertNotEqual(result.returncode, 0)
+    self.assertIn('main.x', result.stderr)
+
+  def test_falls_back_without_server(self):
+    local_ir = self._ir_convert().stdout
+    port = portpicker.pick_unused_port()
+    self.assertEqual(
+        self._ir_convert(f'--compile_server=localhost:{port}').stdout, local_ir
+    )
+
+
+if __name__ == '__main__':
+  absltest.main()
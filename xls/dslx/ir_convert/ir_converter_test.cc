@@ -43,6 +43,7 @@ namespace {
 
 using status_testing::StatusIs;
 using ::testing::HasSubstr;
+using ::testing::Not;
 
 constexpr ConvertOptions kFailNoPos = {
     .emit_positions = false,
@@ -128,6 +129,22 @@ TEST(IrConverterTest, TwoPlusTwo) {
   ExpectIr(converted, TestName());
 }
 
+TEST(IrConverterTest, TwoPlusTwoPlusThreeSimplified) {
+  const char* program =
+      R"(fn f() -> u32 {
+  u32:2 + u32:2 + u32:3
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string converted,
+      ConvertOneFunctionForTest(
+          program, "f",
+          ConvertOptions{.emit_positions = false, .simplify_ir = true}));
+  EXPECT_THAT(converted,
+              HasSubstr("ret literal.4: bits[32] = literal(value=7, id=4)"));
+  EXPECT_THAT(converted, Not(HasSubstr("add(")));
+}
+
 TEST(IrConverterTest, SignedDiv) {
   const char* program =
       R"(fn signed_div(x: s32, y: s32) -> s32 {
@@ -0,0 +1,141 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/dslx/ir_convert/resident_ir_converter.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/cleanup/cleanup.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/frontend/module.h"
+#include "xls/dslx/import_cache.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/ir_convert/convert_options.h"
+#include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/dslx/ir_convert/ir_converter_service.pb.h"
+#include "xls/dslx/type_system/type_info.h"
+#include "xls/dslx/type_system/typecheck_module.h"
+#include "xls/dslx/warning_collector.h"
+#include "xls/dslx/warning_kind.h"
+#include "xls/ir/package.h"
+
+namespace xls::dslx {
+
+absl::StatusOr<std::string> ResidentIrConverter::Convert(
+    const ConvertToIrRequest& request) {
+  XLS_ASSIGN_OR_RETURN(
+      WarningKindSet enabled_warnings,
+      WarningKindSetFromDisabledString(request.disable_warnings()));
+  const ConvertOptions convert_options = {
+      .emit_positions = true,
+      .emit_fail_as_assert = request.emit_fail_as_assert(),
+      .verify_ir = request.verify_ir(),
+      .simplify_ir = request.simplify_ir(),
+      .warnings_as_errors = request.warnings_as_errors(),
+      .enabled_warnings = enabled_warnings,
+  };
+  std::vector<std::string_view> paths(request.paths().begin(),
+                                      request.paths().end());
+  std::vector<std::filesystem::path> dslx_paths(request.dslx_paths().begin(),
+                                                request.dslx_paths().end());
+  std::optional<std::string_view> top;
+  if (!request.top().empty()) {
+    top = request.top();
+  }
+  std::optional<std::string_view> package_name;
+  if (!request.package_name().empty()) {
+    package_name = request.package_name();
+  }
+
+  absl::MutexLock lock(&mutex_);
+  std::optional<std::filesystem::path> original_directory;
+  if (!request.working_directory().empty()) {
+    std::error_code ec;
+    original_directory = std::filesystem::current_path(ec);
+    if (!ec) {
+      std::filesystem::current_path(request.working_directory(), ec);
+    }
+    if (ec) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Unable to change to working directory `%s`: %s",
+                          request.working_directory(), ec.message()));
+    }
+  }
+  absl::Cleanup restore_directory = [&] {
+    if (original_directory.has_value()) {
+      std::error_code ec;
+      std::filesystem::current_path(*original_directory, ec);
+      LOG_IF(ERROR, ec) << "Unable to restore working directory "
+                        << *original_directory << ": " << ec.message();
+    }
+  };
+
+  std::string key = absl::StrCat(
+      request.working_directory(), "\n", request.stdlib_path(), "\n",
+      absl::StrJoin(request.dslx_paths(), ":"), "\n", enabled_warnings.value());
+  auto it = caches_.find(key);
+  if (it == caches_.end()) {
+    if (caches_.size() >= max_cache_count_) {
+      auto lru = caches_.begin();
+      for (auto entry = caches_.begin(); entry != caches_.end(); ++entry) {
+        if (entry->second.last_use < lru->second.last_use) {
+          lru = entry;
+        }
+      }
+      VLOG(1) << "Dropping import cache for " << lru->first;
+      caches_.erase(lru);
+    }
+    CacheEntry entry{.cache = std::make_unique<ImportCache>(
+                         request.stdlib_path(), dslx_paths, enabled_warnings,
+                         [](Module* module, ImportData* import_data,
+                            WarningCollector* warnings)
+                             -> absl::StatusOr<TypeInfo*> {
+                           return TypecheckModule(module, import_data,
+                                                  warnings);
+                         })};
+    it = caches_.emplace(std::move(key), std::move(entry)).first;
+  }
+  it->second.last_use = ++conversion_count_;
+
+  bool printed_error = false;
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Package> package,
+      ConvertFilesToPackage(paths, request.stdlib_path(), dslx_paths,
+                            convert_options, top, package_name, &printed_error,
+                            it->second.cache->GetSnapshot()));
+  return package->DumpIr();
+}
+
+int64_t ResidentIrConverter::cache_count() const {
+  absl::MutexLock lock(&mutex_);
+  return caches_.size();
+}
+
+}  // namespace xls::dslx
@@ -0,0 +1,71 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_DSLX_IR_CONVERT_RESIDENT_IR_CONVERTER_H_
+#define XLS_DSLX_IR_CONVERT_RESIDENT_IR_CONVERTER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/dslx/import_cache.h"
+#include "xls/dslx/ir_convert/ir_converter_service.pb.h"
+
+namespace xls::dslx {
+
+// Converts DSLX files to IR for a long-lived process such as
+// ir_converter_server_main. The modules imported by the converted files,
+// including the standard library, are kept parsed and typechecked in an
+// ImportCache between conversions, so a conversion only parses and typechecks
+// the files themselves and whichever imports changed since the last one.
+//
+// There is one cache for each combination of working directory, search paths
+// and enabled warnings seen, since these determine what an import resolves
+// to; the least recently used caches are dropped beyond `max_cache_count`.
+// As with ImportCache, warnings in cached modules are not reported.
+//
+// Conversions resolve relative paths against the working directory of their
+// request, which requires changing the working directory of the process, so
+// they are run one at a time. Thread-safe.
+class ResidentIrConverter {
+ public:
+  explicit ResidentIrConverter(int64_t max_cache_count = 8)
+      : max_cache_count_(max_cache_count) {}
+
+  // Returns the IR text which ir_converter_main would print for the given
+  // arguments. Errors are printed to stderr as ir_converter_main does.
+  absl::StatusOr<std::string> Convert(const ConvertToIrRequest& request);
+
+  int64_t cache_count() const;
+
+ private:
+  struct CacheEntry {
+    std::unique_ptr<ImportCache> cache;
+    int64_t last_use = 0;
+  };
+
+  const int64_t max_cache_count_;
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, CacheEntry> caches_ ABSL_GUARDED_BY(mutex_);
+  int64_t conversion_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_IR_CONVERT_RESIDENT_IR_CONVERTER_H_
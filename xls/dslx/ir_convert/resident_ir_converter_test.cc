@@ -0,0 +1,118 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/dslx/ir_convert/resident_ir_converter.h"
+
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/ir_convert/ir_converter_service.pb.h"
+
+namespace xls::dslx {
+namespace {
+
+using status_testing::IsOk;
+using status_testing::IsOkAndHolds;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+class ResidentIrConverterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(temp_dir_, TempDirectory::Create());
+    XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "main.x",
+                                  "import std;\n"
+                                  "import helper;\n"
+                                  "fn main(x: u32) -> u32 {\n"
+                                  "  std::umax(x, helper::LIMIT)\n"
+                                  "}\n"));
+    XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "helper.x",
+                                  "pub const LIMIT = u32:42;\n"));
+  }
+
+  // Returns a request converting main.x with relative paths, as a build
+  // action would issue it.
+  ConvertToIrRequest MakeRequest(const std::filesystem::path& dir) {
+    ConvertToIrRequest request;
+    request.set_working_directory(dir.string());
+    request.add_paths("main.x");
+    request.set_top("main");
+    request.set_stdlib_path(kDefaultDslxStdlibPath);
+    request.set_emit_fail_as_assert(true);
+    request.set_verify_ir(true);
+    request.set_warnings_as_errors(true);
+    return request;
+  }
+
+  std::optional<TempDirectory> temp_dir_;
+};
+
+TEST_F(ResidentIrConverterTest, ConvertsRepeatedly) {
+  ResidentIrConverter converter;
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir,
+                           converter.Convert(MakeRequest(temp_dir_->path())));
+  EXPECT_THAT(ir, HasSubstr("fn __main__main(x: bits[32]"));
+  EXPECT_THAT(ir, HasSubstr("value=42"));
+  EXPECT_THAT(converter.Convert(MakeRequest(temp_dir_->path())),
+              IsOkAndHolds(ir));
+  EXPECT_EQ(converter.cache_count(), 1);
+}
+
+TEST_F(ResidentIrConverterTest, SeesChangedImports) {
+  ResidentIrConverter converter;
+  XLS_ASSERT_OK(converter.Convert(MakeRequest(temp_dir_->path())).status());
+  XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "helper.x",
+                                "pub const LIMIT = u32:43;\n"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir,
+                           converter.Convert(MakeRequest(temp_dir_->path())));
+  EXPECT_THAT(ir, HasSubstr("value=43"));
+  EXPECT_THAT(ir, Not(HasSubstr("value=42")));
+}
+
+TEST_F(ResidentIrConverterTest, ReturnsConversionErrors) {
+  ResidentIrConverter converter;
+  XLS_ASSERT_OK(SetFileContents(temp_dir_->path() / "main.x",
+                                "fn main(x: u32) -> u8 { x }\n"));
+  EXPECT_THAT(converter.Convert(MakeRequest(temp_dir_->path())),
+              Not(IsOk()));
+
+  ConvertToIrRequest request = MakeRequest(temp_dir_->path());
+  request.set_working_directory(
+      (temp_dir_->path() / "does_not_exist").string());
+  EXPECT_THAT(converter.Convert(request), Not(IsOk()));
+}
+
+TEST_F(ResidentIrConverterTest, DropsLeastRecentlyUsedCaches) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory other_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(SetFileContents(other_dir.path() / "main.x",
+                                "fn main(x: u32) -> u32 { x }\n"));
+  ResidentIrConverter converter(/*max_cache_count=*/1);
+  XLS_ASSERT_OK(converter.Convert(MakeRequest(temp_dir_->path())).status());
+  XLS_ASSERT_OK(converter.Convert(MakeRequest(other_dir.path())).status());
+  EXPECT_EQ(converter.cache_count(), 1);
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir,
+                           converter.Convert(MakeRequest(temp_dir_->path())));
+  EXPECT_THAT(ir, HasSubstr("value=42"));
+}
+
+}  // namespace
+}  // namespace xls::dslx
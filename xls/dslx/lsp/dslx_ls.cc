@@ -15,13 +15,16 @@
 // Very simple language server for dslx that
 //  - keeps track of open files and updates them whenever they are
 //    changed in the editor (hidden under the hood).
-//  - On every change, attempts to parse and send back diagnostics
-//    on errors/warnings.
+//  - Once the editor has been quiet for a short while after changes (or before
+//    answering a request), attempts to parse the changed buffers and send back
+//    diagnostics on errors/warnings.
 //
 // Heavily commented below as this serves as a sample.
 
+#include <poll.h>
 #include <unistd.h>
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <iostream>
 #include <ostream>
@@ -30,6 +33,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "nlohmann/json.hpp"
@@ -49,6 +53,10 @@ static constexpr char kDslxPath[] = "DSLX_PATH";
 ABSL_FLAG(std::string, dslx_path,
           getenv(kDslxPath) != nullptr ? getenv(kDslxPath) : "",
           "Additional paths to search for modules (colon delimited).");
+ABSL_FLAG(int64_t, update_delay_ms, 100,
+          "Time in milliseconds without input from the editor after which "
+          "changed buffers are parsed. Changes arriving within this time "
+          "of each other are parsed together.");
 
 namespace xls::dslx {
 namespace {
@@ -88,15 +96,13 @@ InitializeResult InitializeServer(const nlohmann::json& params) {
   };
 }
 
-// On text change: attempt to parse the buffer and emit diagnostics if needed.
+// Parses a changed buffer and emits diagnostics if needed.
 void TextChangeHandler(const std::string& file_uri,
-                       const EditTextBuffer& text_buffer,
+                       std::string_view file_content,
                        verible::lsp::JsonRpcDispatcher& dispatcher,
                        LanguageServerAdapter& adapter) {
-  text_buffer.RequestContent([&](std::string_view file_content) {
-    // Note: this returns a status, but we don't need to surface it from here.
-    adapter.Update(file_uri, file_content).IgnoreError();
-  });
+  // Note: this returns a status, but we don't need to surface it from here.
+  adapter.Update(file_uri, file_content).IgnoreError();
   verible::lsp::PublishDiagnosticsParams params{
       .uri = file_uri,
       .diagnostics = adapter.GenerateParseDiagnostics(file_uri),
@@ -104,6 +110,12 @@ void TextChangeHandler(const std::string& file_uri,
   dispatcher.SendNotification("textDocument/publishDiagnostics", params);
 }
 
+// Returns whether input from the editor arrives within `timeout_ms`.
+bool InputPending(int64_t timeout_ms) {
+  pollfd stdin_poll{.fd = STDIN_FILENO, .events = POLLIN, .revents = 0};
+  return poll(&stdin_poll, 1, static_cast<int>(timeout_ms)) != 0;
+}
+
 absl::Status RealMain() {
   const std::string stdlib_path = absl::GetFlag(FLAGS_stdlib_path);
   const std::string dslx_path = absl::GetFlag(FLAGS_dslx_path);
@@ -161,17 +173,35 @@ absl::Status RealMain() {
   // The text buffer collection can call a callback whenever there is a change.
   // We're using this to hook up our parser that then can send diagnostic
   // messages back.
+  //
+  // Parsing a large buffer takes much longer than the time between
+  // keystrokes, so changes are not parsed as they arrive. Instead the latest
+  // content of each changed buffer is recorded (replacing any content already
+  // pending for it, which is then never parsed) and the pending buffers are
+  // parsed once the editor goes quiet, or before a request needs them.
+  absl::flat_hash_map<std::string, std::string> pending_changes;
   buffers.SetChangeListener(
       [&](const std::string& uri, const EditTextBuffer* buffer) {
         if (buffer == nullptr) {
+          pending_changes.erase(uri);
           return;  // buffer got deleted. No interest.
         }
-        TextChangeHandler(uri, *buffer, dispatcher, language_server_adapter);
+        buffer->RequestContent([&](std::string_view file_content) {
+          pending_changes[uri] = std::string(file_content);
+        });
       });
+  auto process_pending_changes = [&]() {
+    for (const auto& [uri, file_content] : pending_changes) {
+      TextChangeHandler(uri, file_content, dispatcher,
+                        language_server_adapter);
+    }
+    pending_changes.clear();
+  };
 
   dispatcher.AddRequestHandler(
       "textDocument/documentSymbol",
       [&](const verible::lsp::DocumentSymbolParams& params) {
+        process_pending_changes();
         return language_server_adapter.GenerateDocumentSymbols(
             params.textDocument.uri);
       });
@@ -179,6 +209,7 @@ absl::Status RealMain() {
   dispatcher.AddRequestHandler(
       "textDocument/definition",
       [&](const verible::lsp::DefinitionParams& params) {
+        process_pending_changes();
         return language_server_adapter.FindDefinitions(params.textDocument.uri,
                                                        params.position);
       });
@@ -186,6 +217,7 @@ absl::Status RealMain() {
   dispatcher.AddRequestHandler(
       "textDocument/formatting",
       [&](const verible::lsp::DocumentFormattingParams& params) {
+        process_pending_changes();
         auto text_edits_or =
             language_server_adapter.FormatDocument(params.textDocument.uri);
         if (text_edits_or.ok()) {
@@ -199,14 +231,21 @@ absl::Status RealMain() {
   dispatcher.AddRequestHandler(
       "textDocument/documentLink",
       [&](const verible::lsp::DocumentLinkParams& params) {
+        process_pending_changes();
         return language_server_adapter.ProvideImportLinks(
             params.textDocument.uri);
       });
 
   // Main loop. Feeding the stream-splitter that then calls the dispatcher.
+  // Before blocking for more input, pending changes are parsed if the editor
+  // has nothing more to send for a while.
+  const int64_t update_delay_ms = absl::GetFlag(FLAGS_update_delay_ms);
   absl::Status status = absl::OkStatus();
   while (status.ok() && !shutdown_requested) {
-    status = stream_splitter.PullFrom([](char* buf, int size) -> int {  //
+    status = stream_splitter.PullFrom([&](char* buf, int size) -> int {
+      if (!pending_changes.empty() && !InputPending(update_delay_ms)) {
+        process_pending_changes();
+      }
       return static_cast<int>(read(STDIN_FILENO, buf, size));
     });
   }
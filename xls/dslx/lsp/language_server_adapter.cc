@@ -41,11 +41,13 @@
 #include "xls/dslx/frontend/bindings.h"
 #include "xls/dslx/frontend/comment_data.h"
 #include "xls/dslx/frontend/pos.h"
+#include "xls/dslx/import_cache.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/lsp/document_symbols.h"
 #include "xls/dslx/lsp/find_definition.h"
 #include "xls/dslx/lsp/lsp_type_utils.h"
 #include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/type_system/typecheck_module.h"
 #include "xls/dslx/warning_collector.h"
 #include "xls/dslx/warning_kind.h"
 
@@ -91,7 +93,13 @@ void AppendDiagnosticFromTypecheck(
 LanguageServerAdapter::LanguageServerAdapter(
     std::string_view stdlib,
     const std::vector<std::filesystem::path>& dslx_paths)
-    : stdlib_(stdlib), dslx_paths_(dslx_paths) {}
+    : stdlib_(stdlib),
+      dslx_paths_(dslx_paths),
+      import_cache_(stdlib_, dslx_paths_, kAllWarningsSet,
+                    [](Module* module, ImportData* import_data,
+                       WarningCollector* warnings) {
+                      return TypecheckModule(module, import_data, warnings);
+                    }) {}
 
 const LanguageServerAdapter::ParseData* LanguageServerAdapter::FindParsedForUri(
     std::string_view uri) const {
@@ -114,8 +122,18 @@ absl::Status LanguageServerAdapter::Update(std::string_view file_uri,
   auto inserted = uri_parse_data_.emplace(file_uri, nullptr);
   std::unique_ptr<ParseData>& insert_value = inserted.first->second;
 
+  std::shared_ptr<ImportCacheInterface> import_cache =
+      import_cache_.GetSnapshot();
+  if (insert_value != nullptr && insert_value->ok() &&
+      insert_value->dslx_code == dslx_code &&
+      insert_value->import_cache == import_cache) {
+    // E.g. the buffer was saved or an edit was undone.
+    return absl::OkStatus();
+  }
+
   ImportData import_data =
       CreateImportData(stdlib_, dslx_paths_, kAllWarningsSet);
+  import_data.SetImportCache(import_cache);
   const std::string& module_name = module_name_or.value();
 
   std::vector<CommentData> comments;
@@ -133,6 +151,8 @@ absl::Status LanguageServerAdapter::Update(std::string_view file_uri,
     insert_value.reset(
         new ParseData{std::move(import_data), typechecked_module.status()});
   }
+  insert_value->dslx_code = std::string(dslx_code);
+  insert_value->import_cache = std::move(import_cache);
 
   const absl::Duration duration = absl::Now() - start;
   if (duration > absl::Milliseconds(200)) {
@@ -30,6 +30,8 @@
 #include "external/verible/common/lsp/lsp-protocol.h"
 #include "xls/dslx/fmt/ast_fmt.h"
 #include "xls/dslx/frontend/module.h"
+#include "xls/dslx/import_cache.h"
+#include "xls/dslx/import_cache_interface.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/parse_and_typecheck.h"
 
@@ -50,7 +52,9 @@ class LanguageServerAdapter {
 
   // Note: this is parsing is triggered for every keystroke. Fine for now.
   // Successful and unsuccessful parses are memoized so that their status
-  // and can be queried.
+  // and can be queried. An update with the same text as the last successful
+  // parse of the buffer is not parsed again unless one of the modules the
+  // buffer imports has changed.
   // Implementation note: since we currently do not react to buffer closed
   // events in the buffer change listener, we keep track of every file ever
   // opened and never delete.
@@ -92,12 +96,18 @@ class LanguageServerAdapter {
   };
 
   // Everything relevant for a parsed editor buffer.
-  // Note, each buffer independently currently keeps track of its import data.
-  // This could maybe be considered to be put in a single place.
+  // Note, each buffer keeps track of its own import data, but the modules it
+  // imports are borrowed from `import_cache_`.
   struct ParseData {
     ImportData import_data;
     absl::StatusOr<TypecheckedModuleWithComments> tmc;
 
+    // The text which was parsed and the import cache snapshot it was
+    // typechecked against. While the cache returns the same snapshot none of
+    // the imported modules has changed.
+    std::string dslx_code;
+    std::shared_ptr<ImportCacheInterface> import_cache;
+
     bool ok() const { return tmc.ok(); }
     absl::Status status() const { return tmc.status(); }
 
@@ -117,6 +127,9 @@ class LanguageServerAdapter {
 
   const std::string stdlib_;
   const std::vector<std::filesystem::path> dslx_paths_;
+  // Typechecked imported modules shared by all buffers, so an edit does not
+  // typecheck the buffer's whole import closure again.
+  ImportCache import_cache_;
   absl::flat_hash_map<std::string, std::unique_ptr<ParseData>> uri_parse_data_;
 };
 
@@ -87,6 +87,27 @@ TEST(LanguageServerAdapterTest, LanguageServerRetainsParseResultForAllBuffers) {
   EXPECT_EQ(adapter.GenerateDocumentSymbols("non-existent.x").size(), 0);
 }
 
+TEST(LanguageServerAdapterTest, RepeatedUpdatesWithSameText) {
+  LanguageServerAdapter adapter(kDefaultDslxStdlibPath, /*dslx_paths=*/{"."});
+  constexpr std::string_view kUri = "memfile://test.x";
+  constexpr std::string_view kValid = "fn f() { () }\nfn g() { () }";
+  for (int i = 0; i < 3; ++i) {
+    XLS_ASSERT_OK(adapter.Update(kUri, kValid));
+    EXPECT_EQ(adapter.GenerateParseDiagnostics(kUri).size(), 0);
+    EXPECT_EQ(adapter.GenerateDocumentSymbols(kUri).size(), 2);
+  }
+
+  // Edits are still picked up after an unchanged update, and an edit which
+  // restores earlier text is parsed again.
+  EXPECT_FALSE(adapter.Update(kUri, "fn f() {").ok());
+  EXPECT_EQ(adapter.GenerateParseDiagnostics(kUri).size(), 1);
+  EXPECT_FALSE(adapter.Update(kUri, "fn f() {").ok());
+  EXPECT_EQ(adapter.GenerateParseDiagnostics(kUri).size(), 1);
+  XLS_ASSERT_OK(adapter.Update(kUri, kValid));
+  EXPECT_EQ(adapter.GenerateParseDiagnostics(kUri).size(), 0);
+  EXPECT_EQ(adapter.GenerateDocumentSymbols(kUri).size(), 2);
+}
+
 TEST(LanguageServerAdapterTest, TestFindDefinitionsFunctionRef) {
   LanguageServerAdapter adapter(kDefaultDslxStdlibPath, /*dslx_paths=*/{"."});
   constexpr std::string_view kUri = "memfile://test.x";
@@ -28,12 +28,14 @@
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/trace.h"
 #include "xls/dslx/frontend/comment_data.h"
 #include "xls/dslx/frontend/module.h"
 #include "xls/dslx/frontend/parser.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/frontend/scanner.h"
 #include "xls/dslx/import_data.h"
+#include "xls/dslx/import_routines.h"
 #include "xls/dslx/type_system/type_info.h"
 #include "xls/dslx/type_system/typecheck_module.h"
 #include "xls/dslx/warning_collector.h"
@@ -56,12 +58,16 @@ absl::StatusOr<TypecheckedModule> ParseAndTypecheck(
 
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module,
                        ParseModule(text, path, module_name, comments));
+  XLS_RETURN_IF_ERROR(PreparseImports(*module, import_data,
+                                      import_data->import_parse_threads()));
   return TypecheckModule(std::move(module), path, import_data);
 }
 
 absl::StatusOr<std::unique_ptr<Module>> ParseModule(
     std::string_view text, std::string_view path, std::string_view module_name,
     std::vector<CommentData>* comments) {
+  TraceSpan span("parse");
+  span.AddArg("path", path);
   Scanner scanner{std::string{path}, std::string{text}};
   Parser parser(std::string{module_name}, &scanner);
   XLS_ASSIGN_OR_RETURN(auto module, parser.ParseModule());
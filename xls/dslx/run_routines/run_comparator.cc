@@ -14,19 +14,25 @@
 
 #include "xls/dslx/run_routines/run_comparator.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/base/call_once.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/module.h"
 #include "xls/dslx/interp_value.h"
@@ -43,15 +49,52 @@ namespace xls::dslx {
 
 absl::StatusOr<FunctionJit*> RunComparator::GetOrCompileJitFunction(
     std::string_view ir_name, xls::Function* ir_function) {
-  auto it = jit_cache_.find(ir_name);
-  if (it != jit_cache_.end()) {
-    return it->second.get();
+  JitCacheEntry* entry;
+  {
+    absl::MutexLock lock(&mutex_);
+    std::unique_ptr<JitCacheEntry>& slot = jit_cache_[ir_name];
+    if (slot == nullptr) {
+      slot = std::make_unique<JitCacheEntry>();
+    }
+    entry = slot.get();
+  }
+  absl::call_once(entry->compiled, [&]() {
+    entry->jit = FunctionJit::Create(ir_function);
+  });
+  XLS_RETURN_IF_ERROR(entry->jit.status());
+  return entry->jit->get();
+}
+
+void RunComparator::PrecompileIrFunctions(
+    absl::Span<const std::pair<std::string, xls::Function*>> ir_functions,
+    int64_t threads) {
+  // Failures are cached and reported when the function is first run.
+  auto compile = [&](int64_t i) {
+    GetOrCompileJitFunction(ir_functions[i].first, ir_functions[i].second)
+        .IgnoreError();
+  };
+  int64_t thread_count =
+      std::min<int64_t>(threads, static_cast<int64_t>(ir_functions.size()));
+  if (thread_count <= 1) {
+    for (int64_t i = 0; i < ir_functions.size(); ++i) {
+      compile(i);
+    }
+    return;
+  }
+  std::atomic<int64_t> next_index = 0;
+  std::vector<std::unique_ptr<Thread>> compile_threads;
+  compile_threads.reserve(thread_count);
+  for (int64_t t = 0; t < thread_count; ++t) {
+    compile_threads.push_back(std::make_unique<Thread>([&]() {
+      for (int64_t i = next_index++; i < ir_functions.size();
+           i = next_index++) {
+        compile(i);
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : compile_threads) {
+    thread->Join();
   }
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
-                       FunctionJit::Create(ir_function));
-  FunctionJit* result = jit.get();
-  jit_cache_[ir_name] = std::move(jit);
-  return result;
 }
 
 absl::Status RunComparator::RunComparison(Package* ir_package,
@@ -147,4 +190,13 @@ absl::StatusOr<InterpreterResult<xls::Value>> RunComparator::RunIrFunction(
   return jit->Run(ir_args);
 }
 
+absl::StatusOr<InterpreterResult<std::vector<xls::Value>>>
+RunComparator::RunIrFunctionBatched(
+    std::string_view ir_name, xls::Function* ir_function,
+    absl::Span<const std::vector<xls::Value>> ir_arg_sets) {
+  XLS_ASSIGN_OR_RETURN(FunctionJit * jit,
+                       GetOrCompileJitFunction(ir_name, ir_function));
+  return jit->RunBatched(ir_arg_sets);
+}
+
 }  // namespace xls::dslx
@@ -18,10 +18,14 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
+#include "absl/base/call_once.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/test_macros.h"
 #include "xls/dslx/frontend/ast.h"
@@ -62,12 +66,25 @@ class RunComparator : public AbstractRunComparator {
       std::string_view ir_name, xls::Function* ir_function,
       absl::Span<const xls::Value> ir_args) override;
 
+  // Evaluates the whole batch with a single FunctionJit::RunBatched call.
+  absl::StatusOr<InterpreterResult<std::vector<xls::Value>>>
+  RunIrFunctionBatched(
+      std::string_view ir_name, xls::Function* ir_function,
+      absl::Span<const std::vector<xls::Value>> ir_arg_sets) override;
+
+  // Compiles each of `ir_functions` on up to `threads` threads.
+  void PrecompileIrFunctions(
+      absl::Span<const std::pair<std::string, xls::Function*>> ir_functions,
+      int64_t threads) override;
+
   // Returns the cached or newly-compiled jit function for ir_name.  ir_name has
   // already been mangled (see MangleDslxName) so it should be unique in the
   // program and is used as the cache key.
   //
-  // Note: There is no locking in jit compilation or on the jit function cache
-  // so this function is *not* thread-safe.
+  // Thread-safe; compilation happens at most once per function. Distinct
+  // functions may be compiled concurrently, and callers asking for a function
+  // which is being compiled wait for that compilation rather than starting
+  // another. A failed compilation is cached like a successful one.
   absl::StatusOr<FunctionJit*> GetOrCompileJitFunction(
       std::string_view ir_name, xls::Function* ir_function);
 
@@ -75,8 +92,19 @@ class RunComparator : public AbstractRunComparator {
   XLS_FRIEND_TEST(RunRoutinesTest, TestInvokedFunctionDoesJit);
   XLS_FRIEND_TEST(RunRoutinesTest, QuickcheckInvokedFunctionDoesJit);
   XLS_FRIEND_TEST(RunRoutinesTest, NoSeedStillQuickChecks);
+  XLS_FRIEND_TEST(RunRoutinesTest, QuickchecksArePrecompiled);
+
+  // A compiled function. The entry is inserted into the cache before it is
+  // compiled so that the mutex need not be held during compilation.
+  struct JitCacheEntry {
+    absl::once_flag compiled;
+    absl::StatusOr<std::unique_ptr<FunctionJit>> jit;
+  };
 
-  absl::flat_hash_map<std::string, std::unique_ptr<FunctionJit>> jit_cache_;
+  // Guards the map `jit_cache_` but not its entries, which are initialized at
+  // most once through `JitCacheEntry::compiled`.
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::unique_ptr<JitCacheEntry>> jit_cache_;
   CompareMode mode_;
 };
 
@@ -17,10 +17,12 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <ctime>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <random>
@@ -30,6 +32,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -43,6 +46,7 @@
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/bytecode/bytecode.h"
 #include "xls/dslx/bytecode/bytecode_cache.h"
 #include "xls/dslx/bytecode/bytecode_emitter.h"
@@ -87,14 +91,13 @@ constexpr int kQuickcheckSpaces = 15;
 absl::Status RunTestFunction(ImportData* import_data, TypeInfo* type_info,
                              Module* module, TestFunction* tf,
                              const BytecodeInterpreterOptions& options) {
-  auto cache = std::make_unique<BytecodeCache>(import_data);
-  import_data->SetBytecodeCache(std::move(cache));
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeFunction> bf,
       BytecodeEmitter::Emit(
           import_data, type_info, tf->fn(), std::nullopt,
-          BytecodeEmitterOptions{.format_preference =
-                                     options.format_preference()}));
+          BytecodeEmitterOptions{
+              .format_preference = options.format_preference(),
+              .fuse_superinstructions = true}));
   return BytecodeInterpreter::Interpret(import_data, bf.get(), /*args=*/{},
                                         options)
       .status();
@@ -103,9 +106,6 @@ absl::Status RunTestFunction(ImportData* import_data, TypeInfo* type_info,
 absl::Status RunTestProc(ImportData* import_data, TypeInfo* type_info,
                          Module* module, TestProc* tp,
                          const BytecodeInterpreterOptions& options) {
-  auto cache = std::make_unique<BytecodeCache>(import_data);
-  import_data->SetBytecodeCache(std::move(cache));
-
   XLS_ASSIGN_OR_RETURN(TypeInfo * ti,
                        type_info->GetTopLevelProcTypeInfo(tp->proc()));
 
@@ -154,6 +154,50 @@ absl::Status RunTestProc(ImportData* import_data, TypeInfo* type_info,
   return absl::OkStatus();
 }
 
+// Runs `run(i)` for each i in [0, count) and then calls `report(i)` for each i
+// in order, so output and results do not depend on the order in which runs
+// complete. `announce(i)` is called before `report(i)` and, when running on a
+// single thread, before `run(i)` so that progress is visible as tests run.
+void RunAndReport(int64_t count, int64_t thread_count,
+                  const std::function<void(int64_t)>& announce,
+                  const std::function<void(int64_t)>& run,
+                  const std::function<void(int64_t)>& report) {
+  if (thread_count <= 1 || count <= 1) {
+    for (int64_t i = 0; i < count; ++i) {
+      announce(i);
+      run(i);
+      report(i);
+    }
+    return;
+  }
+  std::atomic<int64_t> next_index = 0;
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(std::min(thread_count, count));
+    for (int64_t t = 0; t < std::min(thread_count, count); ++t) {
+      threads.push_back(std::make_unique<Thread>([&]() {
+        for (int64_t i = next_index++; i < count; i = next_index++) {
+          run(i);
+        }
+      }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  for (int64_t i = 0; i < count; ++i) {
+    announce(i);
+    report(i);
+  }
+}
+
+// The outcome of a single test or quickcheck.
+struct TestOutcome {
+  absl::Status status;
+  absl::Time start;
+  absl::Duration duration;
+};
+
 }  // namespace
 
 TestResultData::TestResultData(absl::Time start_time,
@@ -221,36 +265,95 @@ static bool TestMatchesFilter(std::string_view test_name,
   return RE2::FullMatch(test_name, *test_filter);
 }
 
+absl::StatusOr<InterpreterResult<std::vector<xls::Value>>>
+AbstractRunComparator::RunIrFunctionBatched(
+    std::string_view ir_name, xls::Function* ir_function,
+    absl::Span<const std::vector<xls::Value>> ir_arg_sets) {
+  InterpreterResult<std::vector<xls::Value>> result;
+  result.value.reserve(ir_arg_sets.size());
+  for (const std::vector<xls::Value>& ir_args : ir_arg_sets) {
+    XLS_ASSIGN_OR_RETURN(InterpreterResult<xls::Value> single,
+                         RunIrFunction(ir_name, ir_function, ir_args));
+    result.value.push_back(std::move(single.value));
+    absl::c_move(single.events.trace_msgs,
+                 std::back_inserter(result.events.trace_msgs));
+    absl::c_move(single.events.assert_msgs,
+                 std::back_inserter(result.events.assert_msgs));
+  }
+  return result;
+}
+
 absl::StatusOr<QuickCheckResults> DoQuickCheck(
     xls::Function* xls_function, std::string_view ir_name,
-    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests) {
+    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests,
+    const QuickCheckEvaluationOptions& evaluation_options) {
+  XLS_RET_CHECK_GT(evaluation_options.batch_size, 0);
   QuickCheckResults results;
   std::minstd_rand rng_engine(seed);
 
-  for (int i = 0; i < num_tests; i++) {
-    results.arg_sets.push_back(
-        RandomFunctionArguments(xls_function, rng_engine));
-    // TODO(https://github.com/google/xls/issues/506): 2021-10-15
-    // Assertion failures should work out, but we should consciously decide
-    // if/how we want to dump traces when running QuickChecks (always, for
-    // failures, flag-controlled, ...).
-    XLS_ASSIGN_OR_RETURN(xls::Value result,
-                         DropInterpreterEvents(run_comparator->RunIrFunction(
-                             ir_name, xls_function, results.arg_sets.back())));
-
-    // In the case of an implicit token signature we get (token, bool) as the
-    // result of the quickcheck'd function, so we unbox the boolean here.
-    if (result.IsTuple()) {
-      result = result.elements()[1];
-      XLS_RET_CHECK(result.IsBits());
+  while (results.arg_sets.size() < num_tests) {
+    // Samples are always generated sequentially from the one engine so they
+    // are independent of the batch size and thread count.
+    int64_t batch_start = results.arg_sets.size();
+    int64_t batch_size = std::min<int64_t>(evaluation_options.batch_size,
+                                           num_tests - batch_start);
+    for (int64_t i = 0; i < batch_size; ++i) {
+      results.arg_sets.push_back(
+          RandomFunctionArguments(xls_function, rng_engine));
+    }
+    absl::Span<const std::vector<Value>> batch =
+        absl::MakeConstSpan(results.arg_sets).subspan(batch_start);
+
+    // Split the batch into contiguous shares, one per thread.
+    int64_t share_count =
+        std::clamp<int64_t>(evaluation_options.threads, 1, batch_size);
+    std::vector<absl::StatusOr<std::vector<Value>>> share_results(share_count);
+    auto evaluate_share = [&](int64_t share) {
+      int64_t begin = share * batch_size / share_count;
+      int64_t end = (share + 1) * batch_size / share_count;
+      // TODO(https://github.com/google/xls/issues/506): 2021-10-15
+      // Assertion failures should work out, but we should consciously decide
+      // if/how we want to dump traces when running QuickChecks (always, for
+      // failures, flag-controlled, ...).
+      share_results[share] =
+          DropInterpreterEvents(run_comparator->RunIrFunctionBatched(
+              ir_name, xls_function, batch.subspan(begin, end - begin)));
+    };
+    if (share_count == 1) {
+      evaluate_share(0);
+    } else {
+      std::vector<std::unique_ptr<Thread>> threads;
+      threads.reserve(share_count);
+      for (int64_t share = 0; share < share_count; ++share) {
+        threads.push_back(
+            std::make_unique<Thread>([&, share]() { evaluate_share(share); }));
+      }
+      for (std::unique_ptr<Thread>& thread : threads) {
+        thread->Join();
+      }
     }
 
-    results.results.push_back(result);
-
-    if (result.IsAllZeros()) {
-      // We were able to falsify the xls_function (predicate), bail out early
-      // and present this evidence.
-      break;
+    for (absl::StatusOr<std::vector<Value>>& share_result : share_results) {
+      XLS_RETURN_IF_ERROR(share_result.status());
+      for (Value& result : *share_result) {
+        // In the case of an implicit token signature we get (token, bool) as
+        // the result of the quickcheck'd function, so we unbox the boolean
+        // here.
+        if (result.IsTuple()) {
+          Value unboxed = result.elements()[1];
+          result = std::move(unboxed);
+          XLS_RET_CHECK(result.IsBits());
+        }
+
+        results.results.push_back(std::move(result));
+
+        if (results.results.back().IsAllZeros()) {
+          // We were able to falsify the xls_function (predicate), bail out
+          // early and present this evidence.
+          results.arg_sets.resize(results.results.size());
+          return results;
+        }
+      }
     }
   }
 
@@ -290,9 +393,10 @@ static absl::StatusOr<QuickcheckIrFn> FindQuickcheckIrFn(Function* fn,
                       absl::StrJoin(ir_package->GetFunctionNames(), ", ")));
 }
 
-static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
-                                  Package* ir_package, QuickCheck* quickcheck,
-                                  TypeInfo* type_info, int64_t seed) {
+static absl::Status RunQuickCheck(
+    AbstractRunComparator* run_comparator, Package* ir_package,
+    QuickCheck* quickcheck, TypeInfo* type_info, int64_t seed,
+    const QuickCheckEvaluationOptions& evaluation_options) {
   // Note: DSLX function.
   Function* fn = quickcheck->f();
 
@@ -302,7 +406,7 @@ static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
   XLS_ASSIGN_OR_RETURN(
       QuickCheckResults qc_results,
       DoQuickCheck(qc_fn.ir_function, qc_fn.ir_name, run_comparator, seed,
-                   quickcheck->GetTestCountOrDefault()));
+                   quickcheck->GetTestCountOrDefault(), evaluation_options));
   const auto& [arg_sets, results] = qc_results;
   XLS_ASSIGN_OR_RETURN(Bits last_result, results.back().GetBitsWithStatus());
   if (!last_result.IsZero()) {
@@ -340,8 +444,9 @@ using HandleError = const std::function<void(
 static absl::Status RunQuickChecksIfJitEnabled(
     Module* entry_module, TypeInfo* type_info,
     AbstractRunComparator* run_comparator, Package* ir_package,
-    std::optional<int64_t> seed, const HandleError& handle_error,
-    TestResultData& result) {
+    std::optional<int64_t> seed,
+    const QuickCheckEvaluationOptions& evaluation_options,
+    const HandleError& handle_error, TestResultData& result) {
   if (run_comparator == nullptr) {
     // TODO(leary): 2024-02-08 Note that this skips /all/ the quickchecks so we
     // don't make an entry for it right now in the test XML.
@@ -357,27 +462,58 @@ static absl::Status RunQuickChecksIfJitEnabled(
   }
   std::cerr << absl::StreamFormat("[ SEED %*d ]", kQuickcheckSpaces + 1, *seed)
             << "\n";
-  for (QuickCheck* quickcheck : entry_module->GetQuickChecks()) {
-    const std::string& test_name = quickcheck->identifier();
-    std::cerr << "[ RUN QUICKCHECK        ] " << test_name
-              << " count: " << quickcheck->GetTestCountOrDefault() << "\n";
-    auto start = absl::Now();
-    absl::Status status =
-        RunQuickCheck(run_comparator, ir_package, quickcheck, type_info, *seed);
-    auto end = absl::Now();
-    auto duration = end - start;
-    const Pos& start_pos = quickcheck->span().start();
-    if (!status.ok()) {
-      handle_error(status, test_name, start_pos, start, duration,
-                   /*is_quickcheck=*/true);
-    } else {
-      result.AddTestCase(test_xml::TestCase{
-          test_name, start_pos.filename(), start_pos.GetHumanLineno(),
-          test_xml::RunStatus::kRun, test_xml::RunResult::kCompleted, duration,
-          start});
-      std::cerr << "[                    OK ] " << test_name << "\n";
+  const std::vector<QuickCheck*>& quickchecks = entry_module->GetQuickChecks();
+
+  // Quickchecks run one at a time, so compile all of their functions up front
+  // where the compilations can proceed in parallel. Functions which cannot be
+  // found are reported when their quickcheck runs.
+  std::vector<std::pair<std::string, xls::Function*>> ir_functions;
+  for (QuickCheck* quickcheck : quickchecks) {
+    absl::StatusOr<QuickcheckIrFn> qc_fn =
+        FindQuickcheckIrFn(quickcheck->f(), ir_package);
+    if (qc_fn.ok()) {
+      ir_functions.push_back({qc_fn->ir_name, qc_fn->ir_function});
     }
   }
+  run_comparator->PrecompileIrFunctions(ir_functions,
+                                        evaluation_options.threads);
+
+  std::vector<TestOutcome> outcomes(quickchecks.size());
+  // Quickchecks run one at a time; the samples of each are spread over the
+  // threads instead, which balances better when one quickcheck dominates.
+  RunAndReport(
+      quickchecks.size(), /*thread_count=*/1,
+      /*announce=*/
+      [&](int64_t i) {
+        std::cerr << "[ RUN QUICKCHECK        ] "
+                  << quickchecks[i]->identifier()
+                  << " count: " << quickchecks[i]->GetTestCountOrDefault()
+                  << "\n";
+      },
+      /*run=*/
+      [&](int64_t i) {
+        outcomes[i].start = absl::Now();
+        outcomes[i].status =
+            RunQuickCheck(run_comparator, ir_package, quickchecks[i],
+                          type_info, *seed, evaluation_options);
+        outcomes[i].duration = absl::Now() - outcomes[i].start;
+      },
+      /*report=*/
+      [&](int64_t i) {
+        const std::string& test_name = quickchecks[i]->identifier();
+        const TestOutcome& outcome = outcomes[i];
+        const Pos& start_pos = quickchecks[i]->span().start();
+        if (!outcome.status.ok()) {
+          handle_error(outcome.status, test_name, start_pos, outcome.start,
+                       outcome.duration, /*is_quickcheck=*/true);
+        } else {
+          result.AddTestCase(test_xml::TestCase{
+              test_name, start_pos.filename(), start_pos.GetHumanLineno(),
+              test_xml::RunStatus::kRun, test_xml::RunResult::kCompleted,
+              outcome.duration, outcome.start});
+          std::cerr << "[                    OK ] " << test_name << "\n";
+        }
+      });
   std::cerr << absl::StreamFormat(
                    "[=======================] %d quickcheck(s) ran.",
                    entry_module->GetQuickChecks().size())
@@ -594,55 +730,98 @@ absl::StatusOr<TestResultData> ParseAndTest(
     };
   }
 
-  // Run unit tests.
+  // All tests share one bytecode cache; it is thread-safe so tests can run
+  // concurrently.
+  import_data.SetBytecodeCache(std::make_unique<BytecodeCache>(&import_data));
+
+  // Gather the unit tests so they can be run in any order but reported in
+  // module order.
+  struct UnitTest {
+    std::string name;
+    Pos start_pos;
+    // Exactly one of these is non-null unless the test is filtered out.
+    TestFunction* test_function = nullptr;
+    TestProc* test_proc = nullptr;
+    TestOutcome outcome;
+  };
+  std::vector<UnitTest> unit_tests;
   for (const std::string& test_name : entry_module->GetTestNames()) {
-    auto test_case_start = absl::Now();
     ModuleMember* member = entry_module->FindMemberWithName(test_name).value();
-    const Pos start_pos = GetPos(*member);
-
+    UnitTest& unit_test = unit_tests.emplace_back(
+        UnitTest{.name = test_name, .start_pos = GetPos(*member)});
     if (!TestMatchesFilter(test_name, options.test_filter)) {
-      auto test_case_end = absl::Now();
-      result.AddTestCase(test_xml::TestCase{
-          test_name, start_pos.filename(), start_pos.GetHumanLineno(),
-          test_xml::RunStatus::kRun, test_xml::RunResult::kFiltered,
-          test_case_end - test_case_start, test_case_start});
       continue;
     }
-
-    std::cerr << "[ RUN UNITTEST  ] " << test_name << '\n';
-    absl::Status status;
-    BytecodeInterpreterOptions interpreter_options;
-    interpreter_options.post_fn_eval_hook(post_fn_eval_hook)
-        .trace_hook(InfoLoggingTraceHook)
-        .trace_channels(options.trace_channels)
-        .max_ticks(options.max_ticks)
-        .format_preference(options.format_preference);
     if (std::holds_alternative<TestFunction*>(*member)) {
-      XLS_ASSIGN_OR_RETURN(TestFunction * tf, entry_module->GetTest(test_name));
-      status = RunTestFunction(&import_data, tm_or.value().type_info,
-                               entry_module, tf, interpreter_options);
-    } else {
-      XLS_ASSIGN_OR_RETURN(TestProc * tp, entry_module->GetTestProc(test_name));
-      status = RunTestProc(&import_data, tm_or.value().type_info, entry_module,
-                           tp, interpreter_options);
-    }
-    auto test_case_end = absl::Now();
-
-    if (status.ok()) {
-      // Add to the tracking data.
-      result.AddTestCase(test_xml::TestCase{
-          test_name, start_pos.filename(), start_pos.GetHumanLineno(),
-          test_xml::RunStatus::kRun, test_xml::RunResult::kCompleted,
-          test_case_end - test_case_start, test_case_start});
-
-      std::cerr << "[            OK ]" << '\n';
+      XLS_ASSIGN_OR_RETURN(unit_test.test_function,
+                           entry_module->GetTest(test_name));
     } else {
-      handle_error(status, test_name, start_pos, test_case_start,
-                   test_case_end - test_case_start,
-                   /*is_quickcheck=*/false);
+      XLS_ASSIGN_OR_RETURN(unit_test.test_proc,
+                           entry_module->GetTestProc(test_name));
     }
   }
 
+  // Run unit tests.
+  TypeInfo* type_info = tm_or.value().type_info;
+  auto is_filtered = [](const UnitTest& unit_test) {
+    return unit_test.test_function == nullptr && unit_test.test_proc == nullptr;
+  };
+  RunAndReport(
+      unit_tests.size(), options.test_threads,
+      /*announce=*/
+      [&](int64_t i) {
+        if (!is_filtered(unit_tests[i])) {
+          std::cerr << "[ RUN UNITTEST  ] " << unit_tests[i].name << '\n';
+        }
+      },
+      /*run=*/
+      [&](int64_t i) {
+        UnitTest& unit_test = unit_tests[i];
+        unit_test.outcome.start = absl::Now();
+        if (!is_filtered(unit_test)) {
+          BytecodeInterpreterOptions interpreter_options;
+          interpreter_options.post_fn_eval_hook(post_fn_eval_hook)
+              .trace_hook(InfoLoggingTraceHook)
+              .trace_channels(options.trace_channels)
+              .max_ticks(options.max_ticks)
+              .format_preference(options.format_preference);
+          unit_test.outcome.status =
+              unit_test.test_function != nullptr
+                  ? RunTestFunction(&import_data, type_info, entry_module,
+                                    unit_test.test_function,
+                                    interpreter_options)
+                  : RunTestProc(&import_data, type_info, entry_module,
+                                unit_test.test_proc, interpreter_options);
+        }
+        unit_test.outcome.duration = absl::Now() - unit_test.outcome.start;
+      },
+      /*report=*/
+      [&](int64_t i) {
+        const UnitTest& unit_test = unit_tests[i];
+        const TestOutcome& outcome = unit_test.outcome;
+        const Pos& start_pos = unit_test.start_pos;
+        if (is_filtered(unit_test)) {
+          result.AddTestCase(test_xml::TestCase{
+              unit_test.name, start_pos.filename(),
+              start_pos.GetHumanLineno(), test_xml::RunStatus::kRun,
+              test_xml::RunResult::kFiltered, outcome.duration,
+              outcome.start});
+        } else if (outcome.status.ok()) {
+          // Add to the tracking data.
+          result.AddTestCase(test_xml::TestCase{
+              unit_test.name, start_pos.filename(),
+              start_pos.GetHumanLineno(), test_xml::RunStatus::kRun,
+              test_xml::RunResult::kCompleted, outcome.duration,
+              outcome.start});
+
+          std::cerr << "[            OK ]" << '\n';
+        } else {
+          handle_error(outcome.status, unit_test.name, start_pos,
+                       outcome.start, outcome.duration,
+                       /*is_quickcheck=*/false);
+        }
+      });
+
   std::cerr << absl::StreamFormat(
                    "[===============] %d test(s) ran; %d failed; %d skipped.",
                    result.GetRanCount(), result.GetFailedCount(),
@@ -653,7 +832,10 @@ absl::StatusOr<TestResultData> ParseAndTest(
   if (!entry_module->GetQuickChecks().empty()) {
     XLS_RETURN_IF_ERROR(RunQuickChecksIfJitEnabled(
         entry_module, tm_or.value().type_info, options.run_comparator,
-        ir_package.get(), options.seed, handle_error, result));
+        ir_package.get(), options.seed,
+        QuickCheckEvaluationOptions{.batch_size = options.quickcheck_batch_size,
+                                    .threads = options.test_threads},
+        handle_error, result));
   }
 
   result.Finish(
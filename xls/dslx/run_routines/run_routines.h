@@ -77,6 +77,24 @@ class AbstractRunComparator {
   virtual absl::StatusOr<InterpreterResult<xls::Value>> RunIrFunction(
       std::string_view ir_name, xls::Function* ir_function,
       absl::Span<const xls::Value> ir_args) = 0;
+
+  // As above but runs the IR function on each of `ir_arg_sets`, accumulating
+  // the events of all runs. Subclasses may override this to evaluate the whole
+  // batch at once (e.g. with FunctionJit::RunBatched); the default calls
+  // RunIrFunction for each argument set. Must be thread-safe for use by
+  // DoQuickCheck with more than one thread.
+  virtual absl::StatusOr<InterpreterResult<std::vector<xls::Value>>>
+  RunIrFunctionBatched(std::string_view ir_name, xls::Function* ir_function,
+                       absl::Span<const std::vector<xls::Value>> ir_arg_sets);
+
+  // Prepares each of `ir_functions`, given as (already-mangled name, IR
+  // function) pairs, to be run by RunIrFunction, using up to `threads`
+  // threads; e.g. a JIT-backed comparator compiles them all up front rather
+  // than one at a time as they are first run. Errors are not reported here
+  // but by the subsequent runs of the function. The default does nothing.
+  virtual void PrecompileIrFunctions(
+      absl::Span<const std::pair<std::string, xls::Function*>> ir_functions,
+      int64_t threads) {}
 };
 
 // Optional arguments to ParseAndTest (that have sensible defaults).
@@ -92,6 +110,14 @@ class AbstractRunComparator {
 //   warnings_as_errors: Whether warnings should be reported as errors (i.e.
 //    cause the run routine to report failure when a warning is encountered).
 //   warnings: Set of warnings to enable for reporting.
+//   test_threads: Number of threads on which to run unit tests, and over which
+//    the samples of each quickcheck are evaluated. Tests share the module's
+//    ImportData and TypeInfo and each runs in its own interpreter;
+//    `run_comparator` must be thread-safe if this is greater than one.
+//    Results and output are reported in module order regardless of the number
+//    of threads, though trace output is not.
+//   quickcheck_batch_size: Number of quickcheck samples generated and
+//    evaluated together; see QuickCheckEvaluationOptions.
 struct ParseAndTestOptions {
   std::string stdlib_path = xls::kDefaultDslxStdlibPath;
   absl::Span<const std::filesystem::path> dslx_paths;
@@ -105,6 +131,8 @@ struct ParseAndTestOptions {
   WarningKindSet warnings = kDefaultWarningsSet;
   bool trace_channels = false;
   std::optional<int64_t> max_ticks;
+  int64_t test_threads = 1;
+  int64_t quickcheck_batch_size = 4096;
 };
 
 // As above, but a subset of the options required for the ParseAndProve()
@@ -212,16 +240,29 @@ struct QuickCheckResults {
   std::vector<Value> results;
 };
 
+// Controls how DoQuickCheck evaluates samples. Samples are generated in
+// batches of `batch_size` and each batch is split across `threads` threads,
+// each of which evaluates its share with a single
+// AbstractRunComparator::RunIrFunctionBatched call. The samples (and so
+// the results) do not depend on either setting.
+struct QuickCheckEvaluationOptions {
+  int64_t batch_size = 4096;
+  int64_t threads = 1;
+};
+
 // JIT-compiles the given xls_function and invokes it with num_tests randomly
 // generated arguments -- returns `([argset, ...], [results, ...])` (i.e. in
 // structure-of-array style).
 //
 // xls_function is a predicate we're trying to find evidence to falsify, so if
 // this finds an example that falsifies the predicate, we early-return (i.e. the
-// length of the returned vectors may be < 1000).
+// length of the returned vectors may be < num_tests). Evaluation stops at the
+// end of the batch containing the first falsifying example, and the returned
+// vectors end with that example.
 absl::StatusOr<QuickCheckResults> DoQuickCheck(
     xls::Function* xls_function, std::string_view ir_name,
-    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests);
+    AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests,
+    const QuickCheckEvaluationOptions& evaluation_options = {});
 
 }  // namespace xls::dslx
 
@@ -25,6 +25,7 @@
 #include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/run_routines/run_comparator.h"
+#include "xls/dslx/run_routines/test_xml.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
@@ -130,6 +131,41 @@ fn trivial(x: u5) -> bool { id(true) }
   EXPECT_EQ(jit_comparator.jit_cache_.begin()->first, "__test__trivial");
 }
 
+TEST(RunRoutinesTest, QuickchecksArePrecompiled) {
+  constexpr const char* kProgram = R"(
+fn id(x: bool) -> bool { x }
+
+#[quickcheck(test_count=16)]
+fn first(x: u5) -> bool { id(true) }
+
+#[quickcheck(test_count=16)]
+fn second(x: u7) -> bool { x == x }
+
+#[quickcheck(test_count=16)]
+fn third(x: u3, y: u3) -> bool { x + y == y + x }
+)";
+  constexpr const char* kModuleName = "test";
+  constexpr const char* kFilename = "test.x";
+  RunComparator jit_comparator(CompareMode::kJit);
+  ParseAndTestOptions options;
+  options.run_comparator = &jit_comparator;
+  options.seed = int64_t{2};
+  options.test_threads = 4;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TestResultData result,
+      ParseAndTest(kProgram, kModuleName, kFilename, options));
+
+  EXPECT_THAT(result, IsTestResult(TestResult::kAllPassed, 3, 0, 0));
+
+  // Each quickcheck function is compiled once and reused by its run.
+  ASSERT_EQ(jit_comparator.jit_cache_.size(), 3);
+  for (std::string_view name :
+       {"__test__first", "__test__second", "__test__third"}) {
+    ASSERT_TRUE(jit_comparator.jit_cache_.contains(name)) << name;
+    XLS_EXPECT_OK(jit_comparator.jit_cache_.at(name)->jit.status());
+  }
+}
+
 TEST(RunRoutinesTest, FallibleFunctionQuickChecks) {
   constexpr const char* kProgram = R"(
 fn do_fail(x: bool) -> bool { fail!("oh_no", x) }
@@ -315,6 +351,62 @@ TEST(QuickcheckTest, Seeding) {
   EXPECT_EQ(results1, results2);
 }
 
+// The samples, results and the point at which a falsifying example stops the
+// run must not depend on how the samples are batched or spread over threads.
+TEST(QuickcheckTest, BatchedAndThreadedMatchSequential) {
+  Package package("rarely_false");
+  std::string ir_text = R"(
+  fn ne_seven(x: bits[10]) -> bits[1] {
+    literal.2: bits[10] = literal(value=7)
+    ret ne.3: bits[1] = ne(x, literal.2)
+  }
+  )";
+  int64_t seed = 42;
+  int64_t num_tests = 100000;
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator jit_comparator(CompareMode::kJit);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckResults sequential,
+      DoQuickCheck(function, kFakeIrName, &jit_comparator, seed, num_tests,
+                   QuickCheckEvaluationOptions{.batch_size = 1, .threads = 1}));
+  ASSERT_LT(sequential.results.size(), num_tests);
+  EXPECT_EQ(sequential.results.back(), Value(UBits(0, 1)));
+  EXPECT_EQ(sequential.arg_sets.size(), sequential.results.size());
+
+  for (QuickCheckEvaluationOptions options :
+       {QuickCheckEvaluationOptions{.batch_size = 100, .threads = 1},
+        QuickCheckEvaluationOptions{.batch_size = 100, .threads = 4},
+        QuickCheckEvaluationOptions{.batch_size = 4096, .threads = 3}}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        QuickCheckResults batched,
+        DoQuickCheck(function, kFakeIrName, &jit_comparator, seed, num_tests,
+                     options));
+    EXPECT_EQ(batched.arg_sets, sequential.arg_sets);
+    EXPECT_EQ(batched.results, sequential.results);
+  }
+}
+
+TEST(QuickcheckTest, ThreadedNumTests) {
+  Package package("always_true");
+  std::string ir_text = R"(
+  fn ret_true(x: bits[32]) -> bits[1] {
+    ret eq_value: bits[1] = eq(x, x)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator jit_comparator(CompareMode::kJit);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckResults quickcheck_info,
+      DoQuickCheck(function, kFakeIrName, &jit_comparator, /*seed=*/0,
+                   /*num_tests=*/5050,
+                   QuickCheckEvaluationOptions{.batch_size = 1000,
+                                               .threads = 8}));
+  EXPECT_EQ(quickcheck_info.arg_sets.size(), 5050);
+  EXPECT_EQ(quickcheck_info.results.size(), 5050);
+}
+
 TEST(ParseAndTestTest, DeadlockedProc) {
   // Test proc never sends to the subproc, so network is deadlocked.
   constexpr std::string_view kProgram = R"(
@@ -450,4 +542,56 @@ TEST(ParseAndTestTest, TestFilterSelectBoth) {
   EXPECT_THAT(result, IsTestResult(TestResult::kAllPassed, 2, 0, 0));
 }
 
+TEST(ParseAndTestTest, ParallelTestsReportInModuleOrder) {
+  constexpr std::string_view kProgram = R"(
+fn square(x: u32) -> u32 { x * x }
+
+#[test] fn test_a() { assert_eq(square(u32:3), u32:9) }
+#[test] fn test_b() { assert_eq(square(u32:4), u32:15) }
+#[test] fn test_c() { assert_eq(square(u32:5), u32:25) }
+#[test] fn skipped() {}
+#[test] fn test_d() { assert_eq(square(u32:6), u32:36) }
+
+#[quickcheck(test_count=100)]
+fn qc_nonneg(x: u16) -> bool { square(x as u32) >= u32:0 }
+#[quickcheck(test_count=100)]
+fn qc_identity(x: u8) -> bool { square(x as u32) == (x as u32) * (x as u32) }
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto temp_file,
+                           TempFile::CreateWithContent(kProgram, "_test.x"));
+  const RE2 test_filter("test_.*|qc_.*");
+  auto test_case_names = [](const TestResultData& result) {
+    std::vector<std::string> names;
+    for (const test_xml::TestCase& test_case :
+         result.ToXmlSuites("test").test_suites.front().test_cases) {
+      names.push_back(test_case.name);
+    }
+    return names;
+  };
+
+  std::vector<std::string> sequential_names;
+  for (int64_t test_threads : {1, 4}) {
+    RunComparator jit_comparator(CompareMode::kJit);
+    ParseAndTestOptions options;
+    options.test_filter = &test_filter;
+    options.run_comparator = &jit_comparator;
+    options.seed = int64_t{42};
+    options.test_threads = test_threads;
+    XLS_ASSERT_OK_AND_ASSIGN(
+        TestResultData result,
+        ParseAndTest(kProgram, "test", std::string(temp_file.path()),
+                     options));
+    EXPECT_THAT(result, IsTestResult(TestResult::kSomeFailed, 7, 1, 1))
+        << test_threads;
+    if (test_threads == 1) {
+      sequential_names = test_case_names(result);
+      EXPECT_THAT(sequential_names,
+                  testing::ElementsAre("test_a", "test_b", "test_c", "skipped",
+                                       "test_d", "qc_nonneg", "qc_identity"));
+    } else {
+      EXPECT_EQ(test_case_names(result), sequential_names);
+    }
+  }
+}
+
 }  // namespace xls::dslx
@@ -56,7 +56,7 @@ Type::~Type() = default;
     return false;
   }
   for (int64_t i = 0; i < a.size(); ++i) {
-    if (*a[i] != *b[i]) {
+    if (a[i] != b[i] && *a[i] != *b[i]) {
       return false;
     }
   }
@@ -191,7 +191,11 @@ class Type {
   // Note that this is type equivalence; e.g. types are equivalent and
   // substitutable if this equality holds.
   virtual bool operator==(const Type& other) const = 0;
-  bool operator!=(const Type& other) const { return !(*this == other); }
+  // Interned types (see TypeInterner) are identical objects, so this checks
+  // identity first.
+  bool operator!=(const Type& other) const {
+    return this != &other && !(*this == other);
+  }
 
   virtual std::string ToString() const = 0;
 
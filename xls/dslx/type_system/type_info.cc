@@ -39,6 +39,7 @@
 #include "xls/dslx/interp_value.h"
 #include "xls/dslx/type_system/parametric_env.h"
 #include "xls/dslx/type_system/type.h"
+#include "xls/dslx/type_system/type_interner.h"
 
 namespace xls::dslx {
 
@@ -123,7 +124,8 @@ absl::Status InvocationData::ValidateEnvForCaller(
 
 absl::StatusOr<TypeInfo*> TypeInfoOwner::New(Module* module, TypeInfo* parent) {
   // Note: private constructor so not using make_unique.
-  type_infos_.push_back(absl::WrapUnique(new TypeInfo(module, parent)));
+  type_infos_.push_back(
+      absl::WrapUnique(new TypeInfo(module, parent, interner_.get())));
   TypeInfo* result = type_infos_.back().get();
   if (parent == nullptr) {
     // Check we only have a single nullptr-parent TypeInfo for a given module.
@@ -264,7 +266,7 @@ std::optional<Type*> TypeInfo::GetItem(const AstNode* key) const {
       << " key: " << key->ToString();
   auto it = dict_.find(key);
   if (it != dict_.end()) {
-    return it->second.get();
+    return it->second;
   }
   if (parent_ != nullptr) {
     return parent_->GetItem(key);
@@ -509,8 +511,8 @@ std::optional<TypeInfo*> TypeInfo::GetImportedTypeInfo(Module* m) {
   return std::nullopt;
 }
 
-TypeInfo::TypeInfo(Module* module, TypeInfo* parent)
-    : module_(module), parent_(parent) {
+TypeInfo::TypeInfo(Module* module, TypeInfo* parent, TypeInterner* interner)
+    : module_(module), parent_(parent), interner_(interner) {
   VLOG(6) << "Created type info for module \"" << module_->name() << "\" @ "
           << this << " parent " << parent << " root " << GetRoot();
 }
@@ -33,6 +33,7 @@
 #include "xls/dslx/interp_value.h"
 #include "xls/dslx/type_system/parametric_env.h"
 #include "xls/dslx/type_system/type.h"
+#include "xls/dslx/type_system/type_interner.h"
 
 namespace xls::dslx {
 
@@ -124,6 +125,9 @@ struct InvocationData {
 // the program at type checking time, we place all type info objects into this
 // owned pool (arena style ownership to avoid circular references or leaks or
 // any other sort of lifetime issues).
+//
+// The owner also interns the types recorded in its type info objects, so each
+// distinct type is allocated once however many nodes have it.
 class TypeInfoOwner {
  public:
   // Returns an error status iff parent is nullptr and "module" already has a
@@ -134,6 +138,8 @@ class TypeInfoOwner {
   // status error if it is not present.
   absl::StatusOr<TypeInfo*> GetRootTypeInfo(const Module* module);
 
+  const TypeInterner& interner() const { return *interner_; }
+
  private:
   // Mapping from module to the "root" (or "parentmost") type info -- these have
   // nullptr as their parent. There should only be one of these for any given
@@ -143,6 +149,9 @@ class TypeInfoOwner {
   // Owned type information objects -- TypeInfoOwner is the lifetime owner for
   // these.
   std::vector<std::unique_ptr<TypeInfo>> type_infos_;
+
+  // Held by pointer so that it stays put if the owner is moved.
+  std::unique_ptr<TypeInterner> interner_ = std::make_unique<TypeInterner>();
 };
 
 class TypeInfo {
@@ -204,10 +213,11 @@ class TypeInfo {
   // called on the module root TypeInfo.
   absl::StatusOr<TypeInfo*> GetTopLevelProcTypeInfo(const Proc* p);
 
-  // Sets the type associated with the given AST node.
+  // Sets the type associated with the given AST node. The type is interned,
+  // so nodes with identical types share (and must not modify) one object.
   void SetItem(const AstNode* key, const Type& value) {
     CHECK_EQ(key->owner(), module_);
-    dict_[key] = value.CloneToUnique();
+    dict_[key] = interner_->Intern(value);
   }
 
   // Attempts to resolve AST node 'key' in the node-to-type dictionary.
@@ -300,9 +310,8 @@ class TypeInfo {
   }
 
   // Returns a reference to the underlying mapping that associates an AST node
-  // with its deduced type.
-  const absl::flat_hash_map<const AstNode*, std::unique_ptr<Type>>& dict()
-      const {
+  // with its deduced (interned) type.
+  const absl::flat_hash_map<const AstNode*, Type*>& dict() const {
     return dict_;
   }
 
@@ -321,7 +330,8 @@ class TypeInfo {
   //  parent: Type information that should be queried from the same scope (i.e.
   //    if an AST node is not resolved in the local member maps, the lookup is
   //    then performed in the parent, and so on transitively).
-  explicit TypeInfo(Module* module, TypeInfo* parent = nullptr);
+  //  interner: Interns the types of the AST nodes; owned by the TypeInfoOwner.
+  TypeInfo(Module* module, TypeInfo* parent, TypeInterner* interner);
 
   // Traverses to the 'root' (AKA 'most parent') TypeInfo. This is a place to
   // stash context-free information (e.g. that is found in a parametric
@@ -346,8 +356,8 @@ class TypeInfo {
 
   // Node to type mapping -- this is present on "derived" type info (i.e. for
   // instantiated parametric type info) as well as the root type information for
-  // a module.
-  absl::flat_hash_map<const AstNode*, std::unique_ptr<Type>> dict_;
+  // a module. The types are owned by `interner_`.
+  absl::flat_hash_map<const AstNode*, Type*> dict_;
 
   // Node to constexpr-value mapping -- this is also present on "derived" type
   // info as constexprs take on different values in different parametric
@@ -364,6 +374,7 @@ class TypeInfo {
   absl::flat_hash_map<const Proc*, TypeInfo*> top_level_proc_type_info_;
 
   TypeInfo* parent_;  // Note: may be nullptr.
+  TypeInterner* interner_;
 };
 
 // -- Inlines
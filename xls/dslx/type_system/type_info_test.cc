@@ -16,6 +16,7 @@
 
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -87,5 +88,57 @@ fn main() -> u32 {
                                  "present in parametric keys: {}")));
 }
 
+// Invocations of a function with the same parametric environment share the
+// derived type information of their instantiation.
+TEST(TypeInfoTest, IdenticalInstantiationsShareTypeInfo) {
+  ImportData import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(TypecheckedModule tm,
+                           ParseAndTypecheck(R"(
+fn p<X: u32>() -> u32 { X + u32:1 }
+
+fn q<Y: u32>() -> u32 { p<Y>() }
+
+fn main() -> u32 {
+  p<u32:2>() + p<u32:2>() + q<u32:2>() + p<u32:3>()
+})",
+                                             "test.x", "test", &import_data));
+
+  Function* main = tm.module->GetFunctionByName().at("main");
+  Function* q = tm.module->GetFunctionByName().at("q");
+  std::vector<const Invocation*> main_invocations;
+  auto collect = [&](const Expr* expr, auto&& self) -> void {
+    if (const auto* binop = dynamic_cast<const Binop*>(expr)) {
+      self(binop->lhs(), self);
+      self(binop->rhs(), self);
+      return;
+    }
+    main_invocations.push_back(down_cast<const Invocation*>(expr));
+  };
+  collect(down_cast<const Expr*>(
+              ToAstNode(main->body()->statements().at(0)->wrapped())),
+          collect);
+  ASSERT_EQ(main_invocations.size(), 4);
+
+  auto get_callee_ti = [&](const Invocation* invocation,
+                           const ParametricEnv& caller_env) {
+    std::optional<TypeInfo*> ti =
+        tm.type_info->GetInvocationTypeInfo(invocation, caller_env);
+    EXPECT_TRUE(ti.has_value());
+    return ti.value_or(nullptr);
+  };
+  TypeInfo* p2_first = get_callee_ti(main_invocations[0], ParametricEnv());
+  TypeInfo* p2_second = get_callee_ti(main_invocations[1], ParametricEnv());
+  TypeInfo* p3 = get_callee_ti(main_invocations[3], ParametricEnv());
+  EXPECT_EQ(p2_first, p2_second);
+  EXPECT_NE(p2_first, p3);
+
+  // The invocation of `p<Y>` within `q<u32:2>` is the same instantiation.
+  const Invocation* invoke_p_in_q = down_cast<const Invocation*>(
+      ToAstNode(q->body()->statements().at(0)->wrapped()));
+  const ParametricEnv q_env(absl::flat_hash_map<std::string, InterpValue>{
+      {"Y", InterpValue::MakeU32(2)}});
+  EXPECT_EQ(get_callee_ti(invoke_p_in_q, q_env), p2_first);
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -748,8 +748,7 @@ absl::StatusOr<TypeInfoProto> TypeInfoToProto(const TypeInfo& type_info) {
   };
   std::vector<Item> items;
   for (const auto& [node, type] : type_info.dict()) {
-    items.push_back(
-        Item{node->GetSpan().value(), node->kind(), node, type.get()});
+    items.push_back(Item{node->GetSpan().value(), node->kind(), node, type});
   }
   std::sort(items.begin(), items.end(), [](const Item& lhs, const Item& rhs) {
     return std::make_tuple(lhs.span.start(), lhs.span.limit(),
@@ -0,0 +1,42 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/dslx/type_system/type_interner.h"
+
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include "absl/hash/hash.h"
+#include "xls/dslx/type_system/type.h"
+
+namespace xls::dslx {
+
+Type* TypeInterner::Intern(const Type& type) {
+  std::string repr = type.ToString();
+  std::vector<std::unique_ptr<Type>>& candidates =
+      types_[absl::HashOf(repr, type.GetDebugTypeName())];
+  for (const std::unique_ptr<Type>& candidate : candidates) {
+    if (typeid(*candidate) == typeid(type) && *candidate == type &&
+        candidate->ToString() == repr) {
+      return candidate.get();
+    }
+  }
+  ++size_;
+  return candidates.emplace_back(type.CloneToUnique()).get();
+}
+
+}  // namespace xls::dslx
@@ -0,0 +1,58 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_DSLX_TYPE_SYSTEM_TYPE_INTERNER_H_
+#define XLS_DSLX_TYPE_SYSTEM_TYPE_INTERNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "xls/dslx/type_system/type.h"
+
+namespace xls::dslx {
+
+// Hash-conses DSLX types: interning two identical types yields the same
+// (owned, immutable) object, so the many copies of e.g. `u32` recorded for the
+// nodes of a module share one allocation and compare equal by pointer.
+//
+// Types are identical if they have the same dynamic type, are equal according
+// to `Type::operator==` and have the same string representation; the last
+// keeps apart e.g. `uN[32]` and its equal bits-constructor array form.
+class TypeInterner {
+ public:
+  TypeInterner() = default;
+
+  // Not copyable or movable, as interned types are referred to by pointer.
+  TypeInterner(const TypeInterner&) = delete;
+  TypeInterner& operator=(const TypeInterner&) = delete;
+
+  // Returns the interned type identical to `type`, creating it if necessary.
+  // The result lives as long as this interner and must not be modified.
+  Type* Intern(const Type& type);
+
+  // Returns the number of distinct types interned.
+  int64_t size() const { return size_; }
+
+ private:
+  absl::flat_hash_map<size_t, std::vector<std::unique_ptr<Type>>> types_;
+  int64_t size_ = 0;
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_TYPE_SYSTEM_TYPE_INTERNER_H_
@@ -0,0 +1,66 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/dslx/type_system/type_interner.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xls/dslx/type_system/type.h"
+
+namespace xls::dslx {
+namespace {
+
+TEST(TypeInternerTest, IdenticalTypesAreShared) {
+  TypeInterner interner;
+  Type* u32 = interner.Intern(BitsType(false, 32));
+  EXPECT_EQ(interner.Intern(*BitsType::MakeU32()), u32);
+  EXPECT_NE(interner.Intern(BitsType(true, 32)), u32);
+  EXPECT_EQ(*u32, BitsType(false, 32));
+  EXPECT_EQ(interner.size(), 2);
+}
+
+TEST(TypeInternerTest, AggregatesAreInternedStructurally) {
+  TypeInterner interner;
+  auto make_tuple = [](int64_t width) {
+    std::vector<std::unique_ptr<Type>> members;
+    members.push_back(BitsType::MakeU32());
+    members.push_back(std::make_unique<BitsType>(false, width));
+    return TupleType(std::move(members));
+  };
+  Type* t = interner.Intern(make_tuple(8));
+  EXPECT_EQ(interner.Intern(make_tuple(8)), t);
+  EXPECT_NE(interner.Intern(make_tuple(16)), t);
+  EXPECT_EQ(interner.size(), 2);
+}
+
+TEST(TypeInternerTest, EqualTypesOfDifferentKindsAreKeptApart) {
+  TypeInterner interner;
+  BitsType bits(false, 32);
+  ArrayType array(
+      std::make_unique<BitsConstructorType>(TypeDim::CreateBool(false)),
+      TypeDim::CreateU32(32));
+  ASSERT_EQ(bits, array);
+  Type* interned_bits = interner.Intern(bits);
+  Type* interned_array = interner.Intern(array);
+  EXPECT_NE(interned_bits, interned_array);
+  EXPECT_NE(dynamic_cast<ArrayType*>(interned_array), nullptr);
+}
+
+}  // namespace
+}  // namespace xls::dslx
@@ -429,6 +429,26 @@ absl::StatusOr<TypeAndParametricEnv> TypecheckInvocation(
   parent_ctx->type_info()->SetItem(invocation->callee(), instantiated_ft);
   ctx->type_info()->SetItem(callee_fn.name_def(), instantiated_ft);
 
+  // Deducing the body of a function depends only on the function and its
+  // parametric environment, so all invocations with the same environment can
+  // share the type information of the first one. This does not hold for
+  // procs, which need separate constexpr data for every instantiation (see
+  // below).
+  const bool memoizable =
+      !callee_fn.proc().has_value() && constexpr_env.empty();
+  if (memoizable) {
+    if (TypeInfo* memoized = ctx->import_data()->GetMemoizedInstantiation(
+            &callee_fn, callee_tab.parametric_env);
+        memoized != nullptr) {
+      VLOG(5) << "Reusing instantiation of " << callee_fn.identifier()
+              << " with " << callee_tab.parametric_env.ToString();
+      XLS_RETURN_IF_ERROR(parent_ctx->type_info()->AddInvocationTypeInfo(
+          *invocation, caller, caller_parametric_env,
+          callee_tab.parametric_env, memoized));
+      return callee_tab;
+    }
+  }
+
   // We need to deduce fn body, so we're going to call Deduce, which means we'll
   // need a new stack entry w/the new symbolic bindings.
   TypeInfo* const original_ti = parent_ctx->type_info();
@@ -524,6 +544,10 @@ absl::StatusOr<TypeAndParametricEnv> TypecheckInvocation(
 
   XLS_RETURN_IF_ERROR(ctx->PopDerivedTypeInfo(derived_type_info));
   ctx->PopFnStackEntry();
+  if (memoizable) {
+    ctx->import_data()->MemoizeInstantiation(
+        &callee_fn, callee_tab.parametric_env, derived_type_info);
+  }
 
   // Implementation note: though we could have all functions have
   // NoteRequiresImplicitToken() be false unless otherwise noted, this helps
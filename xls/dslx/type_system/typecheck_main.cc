@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <iostream>
 #include <optional>
@@ -31,6 +32,7 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/dslx/command_line_utils.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
@@ -46,6 +48,9 @@ ABSL_FLAG(std::string, dslx_stdlib_path, xls::kDefaultDslxStdlibPath,
 ABSL_FLAG(std::string, output_path, "",
           "Path to dump the type information to as a protobin -- if not "
           "provided textual proto is given on stdout.");
+ABSL_FLAG(int64_t, import_parse_threads, 0,
+          "Number of threads on which to parse imported modules before "
+          "typechecking; 0 means the number of available CPUs.");
 
 namespace xls::dslx {
 namespace {
@@ -58,10 +63,13 @@ was deduced.
 absl::Status RealMain(absl::Span<const std::filesystem::path> dslx_paths,
                       const std::filesystem::path& dslx_stdlib_path,
                       const std::filesystem::path& input_path,
-                      std::optional<std::filesystem::path> output_path) {
+                      std::optional<std::filesystem::path> output_path,
+                      int64_t import_parse_threads) {
   ImportData import_data(CreateImportData(
       dslx_stdlib_path,
       /*additional_search_paths=*/dslx_paths, kDefaultWarningsSet));
+  import_data.set_import_parse_threads(
+      import_parse_threads == 0 ? AvailableCPUs() : import_parse_threads);
   XLS_ASSIGN_OR_RETURN(std::string input_contents, GetFileContents(input_path));
   XLS_ASSIGN_OR_RETURN(std::string module_name, PathToName(input_path.c_str()));
   absl::StatusOr<TypecheckedModule> tm_or = ParseAndTypecheck(
@@ -112,6 +120,7 @@ int main(int argc, char* argv[]) {
 
   std::filesystem::path dslx_stdlib_path(absl::GetFlag(FLAGS_dslx_stdlib_path));
 
-  return xls::ExitStatus(xls::dslx::RealMain(dslx_paths, dslx_stdlib_path,
-                                             input_path, output_path));
+  return xls::ExitStatus(xls::dslx::RealMain(
+      dslx_paths, dslx_stdlib_path, input_path, output_path,
+      absl::GetFlag(FLAGS_import_parse_threads)));
 }
@@ -29,6 +29,7 @@
 #include "absl/types/variant.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/trace.h"
 #include "xls/common/visitor.h"
 #include "xls/dslx/channel_direction.h"
 #include "xls/dslx/errors.h"
@@ -325,6 +326,8 @@ absl::Status MaybeExpandTypeErrorData(absl::Status orig, const DeduceCtx& ctx) {
 absl::StatusOr<TypeInfo*> TypecheckModule(Module* module,
                                           ImportData* import_data,
                                           WarningCollector* warnings) {
+  TraceSpan span("typecheck");
+  span.AddArg("module", module->name());
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
                        import_data->type_info_owner().New(module));
 
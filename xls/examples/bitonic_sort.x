@@ -59,6 +59,10 @@ fn bitonic_sort<N: u32, LOG_N: u32 = { std::clog2(N) }>(array: u32[N]) -> u32[N]
     result
 }
 
+// A concrete instantiation of bitonic_sort to convert to IR, e.g. for
+// benchmarking.
+fn bitonic_sort_128(array: u32[128]) -> u32[128] { bitonic_sort(array) }
+
 ////////////////////////////////////////////////////////////////////////////////
 // Tests
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,211 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of the runtime performance of jitted examples: calls per second
+// for functions and ticks per second for proc networks. Compilation happens
+// outside of the timed loop; see toolchain_benchmark.cc for the cost of the
+// compile flow itself.
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/examples/proc_fir_filter.h"
+#include "xls/examples/sample_packages.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_proc_runtime.h"
+
+namespace xls {
+namespace {
+
+// The number of distinct random inputs cycled through by each benchmark, so
+// that the results are not dominated by a single (possibly trivial) input.
+constexpr int64_t kInputPoolSize = 256;
+
+constexpr int64_t kSeed = 0x5eed;
+
+void BM_Function(benchmark::State& state, std::string_view name) {
+  absl::StatusOr<std::unique_ptr<Package>> package =
+      sample_packages::GetBenchmark(name, /*optimized=*/true);
+  if (!package.ok()) {
+    state.SkipWithError(package.status().ToString().c_str());
+    return;
+  }
+  absl::StatusOr<Function*> function = (*package)->GetTopAsFunction();
+  if (!function.ok()) {
+    state.SkipWithError(function.status().ToString().c_str());
+    return;
+  }
+  absl::StatusOr<std::unique_ptr<FunctionJit>> jit =
+      FunctionJit::Create(*function);
+  if (!jit.ok()) {
+    state.SkipWithError(jit.status().ToString().c_str());
+    return;
+  }
+
+  std::minstd_rand rng(kSeed);
+  std::vector<std::vector<Value>> arg_sets(kInputPoolSize);
+  for (std::vector<Value>& args : arg_sets) {
+    for (Param* param : (*function)->params()) {
+      args.push_back(RandomValue(param->GetType(), rng));
+    }
+  }
+
+  int64_t i = 0;
+  for (auto _ : state) {
+    auto result = (*jit)->Run(arg_sets[i]);
+    benchmark::DoNotOptimize(result);
+    if (++i == kInputPoolSize) {
+      i = 0;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["calls_per_s"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+
+// Ticks the proc network of `package` once per iteration, feeding every input
+// channel one value from a pregenerated pool beforehand and draining every
+// output channel afterwards so the queues stay bounded.
+void RunProcBenchmark(benchmark::State& state, Package* package) {
+  for (const std::unique_ptr<Proc>& proc : package->procs()) {
+    if (proc->is_new_style_proc()) {
+      state.SkipWithError("New-style procs are not supported");
+      return;
+    }
+  }
+  absl::StatusOr<std::unique_ptr<SerialProcRuntime>> runtime =
+      CreateJitSerialProcRuntime(package);
+  if (!runtime.ok()) {
+    state.SkipWithError(runtime.status().ToString().c_str());
+    return;
+  }
+
+  std::minstd_rand rng(kSeed);
+  std::vector<ChannelQueue*> input_queues;
+  std::vector<std::vector<Value>> input_pools;
+  std::vector<ChannelQueue*> output_queues;
+  for (Channel* channel : package->channels()) {
+    ChannelQueue* queue = &(*runtime)->queue_manager().GetQueue(channel);
+    if (channel->supported_ops() == ChannelOps::kReceiveOnly) {
+      input_queues.push_back(queue);
+      std::vector<Value>& pool = input_pools.emplace_back();
+      for (int64_t i = 0; i < kInputPoolSize; ++i) {
+        pool.push_back(RandomValue(channel->type(), rng));
+      }
+    } else if (channel->supported_ops() == ChannelOps::kSendOnly) {
+      output_queues.push_back(queue);
+    }
+  }
+
+  int64_t i = 0;
+  for (auto _ : state) {
+    for (int64_t q = 0; q < input_queues.size(); ++q) {
+      absl::Status status = input_queues[q]->Write(input_pools[q][i]);
+      if (!status.ok()) {
+        state.SkipWithError(status.ToString().c_str());
+        return;
+      }
+    }
+    absl::Status status = (*runtime)->Tick();
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+    for (ChannelQueue* queue : output_queues) {
+      while (!queue->IsEmpty()) {
+        std::optional<Value> value = queue->Read();
+        benchmark::DoNotOptimize(value);
+      }
+    }
+    if (++i == kInputPoolSize) {
+      i = 0;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["ticks_per_s"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+
+void BM_Proc(benchmark::State& state, std::string_view name) {
+  absl::StatusOr<std::unique_ptr<Package>> package =
+      sample_packages::GetBenchmark(name, /*optimized=*/true);
+  if (!package.ok()) {
+    state.SkipWithError(package.status().ToString().c_str());
+    return;
+  }
+  RunProcBenchmark(state, package->get());
+}
+
+absl::StatusOr<std::unique_ptr<Package>> BuildFirFilter(int64_t taps) {
+  auto package = std::make_unique<Package>("fir_filter");
+  std::vector<uint64_t> coefficients;
+  for (int64_t i = 0; i < taps; ++i) {
+    coefficients.push_back(i + 1);
+  }
+  XLS_ASSIGN_OR_RETURN(Value kernel, Value::UBitsArray(coefficients, 32));
+  Type* element_type = package->GetTypeForValue(kernel.element(0));
+  XLS_ASSIGN_OR_RETURN(
+      StreamingChannel * x_in,
+      package->CreateStreamingChannel("fir_x_in", ChannelOps::kReceiveOnly,
+                                      element_type));
+  XLS_ASSIGN_OR_RETURN(
+      StreamingChannel * filter_out,
+      package->CreateStreamingChannel("fir_out", ChannelOps::kSendOnly,
+                                      element_type));
+  XLS_RETURN_IF_ERROR(
+      CreateFirFilter("fir", kernel, x_in, filter_out, package.get())
+          .status());
+  return package;
+}
+
+void BM_FirFilter(benchmark::State& state) {
+  absl::StatusOr<std::unique_ptr<Package>> package =
+      BuildFirFilter(state.range(0));
+  if (!package.ok()) {
+    state.SkipWithError(package.status().ToString().c_str());
+    return;
+  }
+  RunProcBenchmark(state, package->get());
+}
+
+BENCHMARK_CAPTURE(BM_Function, sha256, "examples/sha256");
+BENCHMARK_CAPTURE(BM_Function, crc32, "examples/crc32/crc32");
+BENCHMARK_CAPTURE(BM_Function, adler32, "examples/adler32/adler32");
+BENCHMARK_CAPTURE(BM_Function, bitonic_sort, "examples/bitonic_sort");
+
+BENCHMARK_CAPTURE(BM_Proc, fp32_fmac, "examples/fp32_fmac");
+BENCHMARK_CAPTURE(BM_Proc, lfsr_proc, "examples/lfsr_proc");
+BENCHMARK(BM_FirFilter)->Arg(4)->Arg(16)->Arg(64);
+
+}  // namespace
+}  // namespace xls
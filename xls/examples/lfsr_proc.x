@@ -43,6 +43,20 @@ proc user_module<BIT_WIDTH: u32> {
   }
 }
 
+// A 32-bit instantiation of user_module to convert to IR, e.g. for
+// benchmarking.
+proc user_module_32 {
+  init { () }
+
+  config(output_s: chan<u32> out, seed_and_mask_r: chan<(u32, u32)> in) {
+    spawn user_module<u32:32>(output_s, seed_and_mask_r);
+    ()
+  }
+
+  // Nothing to do here - the spawned user_module does all the work.
+  next(tok: token, state: ()) { () }
+}
+
 #[test_proc]
 proc test {
   value_r: chan<u8> in;
@@ -0,0 +1,306 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// End-to-end benchmarks of the toolchain over a curated set of examples. Each
+// iteration runs the whole flow on one design:
+//
+//   parse_typecheck: parsing and typechecking the DSLX module and its imports.
+//   ir_convert: converting the top entity to IR.
+//   opt: the standard optimization pipeline.
+//   jit_compile: compiling the optimized IR with the JIT.
+//   schedule: pipeline scheduling.
+//   codegen: generating Verilog from the schedule.
+//
+// For each stage the benchmark reports `<stage>_s`, the time per iteration,
+// and `<stage>_peak_rss_mb`, the peak resident set size of the process during
+// the stage. Where the kernel does not support resetting the peak (see
+// /proc/self/clear_refs) the latter is the high-water mark of the process up to
+// the end of the stage. Designs which are only available as IR skip the DSLX
+// stages.
+//
+// Run with --benchmark_format=json (or --benchmark_out=FILE
+// --benchmark_out_format=json) for machine-readable results which can be
+// tracked across releases.
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/delay_model/delay_estimators.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/ir_convert/convert_options.h"
+#include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/warning_kind.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_proc_runtime.h"
+#include "xls/passes/optimization_pass_pipeline.h"
+#include "xls/scheduling/scheduling_options.h"
+#include "xls/tools/codegen.h"
+
+namespace xls {
+namespace {
+
+constexpr std::string_view kDelayModel = "asap7";
+
+struct DesignSpec {
+  // Path to a DSLX or IR file relative to the root of the XLS source tree.
+  std::string_view path;
+  // Name of the top function or proc.
+  std::string_view top;
+  int64_t pipeline_stages;
+};
+
+// Resets the peak resident set size of the process to its current resident
+// set size. Has no effect if the kernel does not support it.
+void ResetPeakRss() {
+  // Writing "5" to clear_refs resets the VmHWM of the process (Linux 4.0+).
+  SetFileContents("/proc/self/clear_refs", "5").IgnoreError();
+}
+
+// Returns the peak resident set size of the process in megabytes.
+double PeakRssMb() {
+  absl::StatusOr<std::string> status = GetFileContents("/proc/self/status");
+  if (status.ok()) {
+    for (std::string_view line : absl::StrSplit(*status, '\n')) {
+      int64_t kb;
+      if (absl::ConsumePrefix(&line, "VmHWM:") &&
+          absl::ConsumeSuffix(&line, "kB") &&
+          absl::SimpleAtoi(absl::StripAsciiWhitespace(line), &kb)) {
+        return static_cast<double>(kb) / 1024.0;
+      }
+    }
+  }
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    // ru_maxrss is in kilobytes on Linux.
+    return static_cast<double>(usage.ru_maxrss) / 1024.0;
+  }
+  return 0.0;
+}
+
+// Accumulates the time and peak memory of each stage across iterations.
+class StageTimer {
+ public:
+  explicit StageTimer(std::string_view name) : name_(name) {}
+
+  void Start() {
+    ResetPeakRss();
+    start_ = absl::Now();
+  }
+  void Stop() {
+    total_ += absl::Now() - start_;
+    peak_rss_mb_ = std::max(peak_rss_mb_, PeakRssMb());
+  }
+
+  void SetCounters(benchmark::State& state) const {
+    state.counters[absl::StrCat(name_, "_s")] = benchmark::Counter(
+        absl::ToDoubleSeconds(total_), benchmark::Counter::kAvgIterations);
+    state.counters[absl::StrCat(name_, "_peak_rss_mb")] = peak_rss_mb_;
+  }
+
+ private:
+  std::string name_;
+  absl::Time start_;
+  absl::Duration total_;
+  double peak_rss_mb_ = 0.0;
+};
+
+struct FlowTimers {
+  StageTimer parse_typecheck{"parse_typecheck"};
+  StageTimer ir_convert{"ir_convert"};
+  StageTimer opt{"opt"};
+  StageTimer jit_compile{"jit_compile"};
+  StageTimer schedule{"schedule"};
+  StageTimer codegen{"codegen"};
+};
+
+// Parses, typechecks and converts the DSLX file at `path` to IR.
+absl::StatusOr<std::unique_ptr<Package>> DslxToIr(const DesignSpec& spec,
+                                                  FlowTimers& timers) {
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path path,
+                       GetXlsRunfilePath(spec.path));
+  XLS_ASSIGN_OR_RETURN(std::string text, GetFileContents(path));
+  std::string module_name = path.stem().string();
+
+  timers.parse_typecheck.Start();
+  dslx::ImportData import_data = dslx::CreateImportData(
+      dslx::kDefaultDslxStdlibPath, /*additional_search_paths=*/{},
+      dslx::kDefaultWarningsSet);
+  XLS_ASSIGN_OR_RETURN(
+      dslx::TypecheckedModule module,
+      dslx::ParseAndTypecheck(text, path.string(), module_name, &import_data));
+  timers.parse_typecheck.Stop();
+
+  timers.ir_convert.Start();
+  auto package = std::make_unique<Package>(module_name);
+  XLS_RETURN_IF_ERROR(dslx::ConvertOneFunctionIntoPackage(
+      module.module, spec.top, &import_data, /*parametric_env=*/nullptr,
+      dslx::ConvertOptions{}, package.get()));
+  timers.ir_convert.Stop();
+  return package;
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ReadIr(const DesignSpec& spec) {
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path path,
+                       GetXlsRunfilePath(spec.path));
+  XLS_ASSIGN_OR_RETURN(std::string text, GetFileContents(path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(text, path.string()));
+  XLS_RETURN_IF_ERROR(package->SetTopByName(spec.top));
+  return package;
+}
+
+// Runs the whole flow once, accumulating the time of each stage in `timers`.
+absl::Status RunFlow(const DesignSpec& spec,
+                     const DelayEstimator& delay_estimator,
+                     FlowTimers& timers) {
+  std::unique_ptr<Package> package;
+  if (absl::EndsWith(spec.path, ".ir")) {
+    XLS_ASSIGN_OR_RETURN(package, ReadIr(spec));
+  } else {
+    XLS_ASSIGN_OR_RETURN(package, DslxToIr(spec, timers));
+  }
+
+  timers.opt.Start();
+  XLS_RETURN_IF_ERROR(RunOptimizationPassPipeline(package.get()).status());
+  timers.opt.Stop();
+
+  std::optional<FunctionBase*> top = package->GetTop();
+  if (!top.has_value()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Package has no top after conversion: ", spec.path));
+  }
+
+  // Compile the optimized IR before scheduling and codegen, which may modify
+  // the package.
+  timers.jit_compile.Start();
+  if ((*top)->IsFunction()) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                         FunctionJit::Create((*top)->AsFunctionOrDie()));
+    benchmark::DoNotOptimize(jit);
+  } else {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> runtime,
+                         CreateJitSerialProcRuntime(package.get()));
+    benchmark::DoNotOptimize(runtime);
+  }
+  timers.jit_compile.Stop();
+
+  timers.schedule.Start();
+  XLS_ASSIGN_OR_RETURN(
+      PipelineScheduleOrGroup schedules,
+      Schedule(package.get(),
+               SchedulingOptions().pipeline_stages(spec.pipeline_stages),
+               &delay_estimator));
+  timers.schedule.Stop();
+
+  timers.codegen.Start();
+  XLS_ASSIGN_OR_RETURN(
+      CodegenResult result,
+      CodegenPipeline(package.get(), std::move(schedules),
+                      verilog::CodegenOptions(), &delay_estimator));
+  timers.codegen.Stop();
+  benchmark::DoNotOptimize(result);
+  return absl::OkStatus();
+}
+
+void BM_Flow(benchmark::State& state, DesignSpec spec) {
+  const DelayEstimator& delay_estimator =
+      *GetDelayEstimator(kDelayModel).value();
+  FlowTimers timers;
+  for (auto _ : state) {
+    absl::Status status = RunFlow(spec, delay_estimator, timers);
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+  }
+  for (const StageTimer* timer :
+       {&timers.parse_typecheck, &timers.ir_convert, &timers.opt,
+        &timers.jit_compile, &timers.schedule, &timers.codegen}) {
+    timer->SetCounters(state);
+  }
+}
+
+BENCHMARK_CAPTURE(BM_Flow, sha256,
+                  DesignSpec{.path = "xls/examples/sha256.x",
+                             .top = "main",
+                             .pipeline_stages = 8})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Flow, riscv_simple,
+                  DesignSpec{.path = "xls/examples/riscv_simple.x",
+                             .top = "run_instruction",
+                             .pipeline_stages = 4})
+    ->Unit(benchmark::kMillisecond);
+// The DSLX version of matmul_4x4 does not lower to IR (it needs arrays of
+// channels) so start from the checked-in IR.
+BENCHMARK_CAPTURE(BM_Flow, matmul_4x4,
+                  DesignSpec{.path = "xls/examples/matmul_4x4/matmul_4x4.ir",
+                             .top = "tile_0_0",
+                             .pipeline_stages = 1})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Flow, jpeg_idct_chen,
+                  DesignSpec{.path = "xls/examples/jpeg/idct_chen.x",
+                             .top = "idct",
+                             .pipeline_stages = 4})
+    ->Unit(benchmark::kMillisecond);
+// apfloat_fmac.x is parametric; fp32_fmac.x instantiates it for float32.
+BENCHMARK_CAPTURE(BM_Flow, fp32_fmac,
+                  DesignSpec{.path = "xls/examples/fp32_fmac.x",
+                             .top = "fp32_fmac",
+                             .pipeline_stages = 4})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Flow, large_array,
+                  DesignSpec{.path = "xls/examples/large_array.x",
+                             .top = "large_array",
+                             .pipeline_stages = 2})
+    ->Unit(benchmark::kMillisecond);
+// sobel_filter.x is parametric; sobel_filter_benchmark.x instantiates it.
+BENCHMARK_CAPTURE(BM_Flow, sobel_filter,
+                  DesignSpec{.path = "xls/examples/sobel_filter_benchmark.x",
+                             .top = "apply_stencil_float32_8x8",
+                             .pipeline_stages = 4})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace xls
@@ -42,8 +42,9 @@ class IterativeSDCSchedulingModel : public SDCSchedulingModel {
 
   // Overrides the original timing constraints builder. This method directly
   // call delay manager to extract the paths longer than the given clock period
-  // instead of recalculating them.
-  absl::Status AddTimingConstraints(int64_t clock_period_ps);
+  // instead of recalculating them. Only the constraints which changed since the
+  // previous call are added to or removed from the model.
+  absl::Status UpdateTimingConstraints(int64_t clock_period_ps);
 
  private:
   const DelayManager& delay_manager_;
@@ -14,7 +14,12 @@
 
 #include "xls/fdo/synthesizer.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <filesystem>  // NOLINT
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -23,12 +28,21 @@
 #include <vector>
 
 #include "absl/base/no_destructor.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "openssl/sha.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/thread.h"
 #include "xls/fdo/extract_nodes.h"
@@ -38,28 +52,290 @@
 
 namespace xls {
 namespace synthesis {
+namespace {
+
+// Calls `fn(i)` for each `i` in [0, `count`) on up to `max_threads` threads.
+// Each thread takes the next unclaimed index until none remain, which balances
+// the load when the calls vary widely in cost.
+void RunOnWorkers(int64_t count, int64_t max_threads,
+                  const std::function<void(int64_t)>& fn) {
+  int64_t thread_count = std::min(max_threads, count);
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index++; i < count; i = next_index++) {
+      fn(i);
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (auto &t : threads) {
+    t->Join();
+  }
+}
+
+}  // namespace
+
+Synthesizer::Synthesizer(std::string_view name)
+    : name_(name), max_concurrency_(std::max(1, AvailableCPUs())) {}
+
+absl::StatusOr<int64_t> Synthesizer::SynthesizeVerilogAndGetDelayCached(
+    std::string_view verilog_text, std::string_view top_module_name) const {
+  std::string key = CacheKey(verilog_text, top_module_name);
+  std::shared_ptr<CacheEntry> entry;
+  bool is_owner = false;
+  {
+    absl::MutexLock lock(&cache_mutex_);
+    std::shared_ptr<CacheEntry> &cached = cache_[key];
+    if (cached == nullptr) {
+      cached = std::make_shared<CacheEntry>();
+      is_owner = true;
+    } else {
+      ++cache_hit_count_;
+    }
+    entry = cached;
+  }
+  if (!is_owner) {
+    // Another request for the same Verilog is (or was) in flight.
+    absl::MutexLock lock(&entry->mutex);
+    entry->mutex.Await(absl::Condition(&entry->done));
+    return entry->delay;
+  }
+
+  absl::StatusOr<int64_t> delay;
+  if (std::optional<int64_t> persisted = ReadCacheFile(key);
+      persisted.has_value()) {
+    absl::MutexLock lock(&cache_mutex_);
+    ++cache_hit_count_;
+    delay = *persisted;
+  } else {
+    delay = SynthesizeVerilogAndGetDelay(verilog_text, top_module_name);
+    if (delay.ok()) {
+      WriteCacheFile(key, *delay);
+    } else {
+      absl::MutexLock lock(&cache_mutex_);
+      cache_.erase(key);
+    }
+  }
+  absl::MutexLock lock(&entry->mutex);
+  entry->delay = delay;
+  entry->done = true;
+  return delay;
+}
+
+absl::StatusOr<std::vector<int64_t>>
+Synthesizer::SynthesizeVerilogModulesAndGetDelays(
+    absl::Span<const std::string> verilog_texts,
+    std::string_view top_module_name) const {
+  std::vector<int64_t> delays(verilog_texts.size());
+  // The distinct uncached modules, and for each module the index of its
+  // uncached module if it has no cached result.
+  std::vector<std::string> pending_keys;
+  std::vector<std::string> pending_texts;
+  std::vector<std::optional<int64_t>> pending_index(verilog_texts.size());
+  absl::flat_hash_map<std::string, int64_t> key_to_pending;
+  for (int64_t i = 0; i < verilog_texts.size(); ++i) {
+    std::string key = CacheKey(verilog_texts[i], top_module_name);
+    if (std::optional<int64_t> cached = LookUpCachedDelay(key);
+        cached.has_value()) {
+      delays[i] = *cached;
+      continue;
+    }
+    auto [it, inserted] = key_to_pending.try_emplace(key, pending_keys.size());
+    if (inserted) {
+      pending_keys.push_back(std::move(key));
+      pending_texts.push_back(verilog_texts[i]);
+    } else {
+      absl::MutexLock lock(&cache_mutex_);
+      ++cache_hit_count_;
+    }
+    pending_index[i] = it->second;
+  }
+
+  const int64_t pending_count = pending_texts.size();
+  const int64_t batch_size = std::max(batch_size_, int64_t{1});
+  const int64_t batch_count = (pending_count + batch_size - 1) / batch_size;
+  auto batch_span = [&](int64_t batch) {
+    return absl::MakeConstSpan(pending_texts)
+        .subspan(batch * batch_size, batch_size);
+  };
+  std::vector<absl::StatusOr<std::vector<int64_t>>> batch_delays(
+      batch_count, std::vector<int64_t>());
+  RunOnWorkers(batch_count, max_concurrency_, [&](int64_t batch) {
+    batch_delays[batch] =
+        SynthesizeVerilogBatchAndGetDelays(batch_span(batch), top_module_name);
+  });
+
+  std::vector<int64_t> pending_delays(pending_count);
+  for (int64_t batch = 0; batch < batch_count; ++batch) {
+    XLS_RETURN_IF_ERROR(batch_delays[batch].status());
+    const std::vector<int64_t>& batch_result = batch_delays[batch].value();
+    XLS_RET_CHECK_EQ(batch_result.size(), batch_span(batch).size());
+    for (int64_t j = 0; j < batch_result.size(); ++j) {
+      int64_t index = batch * batch_size + j;
+      pending_delays[index] = batch_result[j];
+      InsertCachedDelay(pending_keys[index], batch_result[j]);
+    }
+  }
+  for (int64_t i = 0; i < verilog_texts.size(); ++i) {
+    if (pending_index[i].has_value()) {
+      delays[i] = pending_delays[*pending_index[i]];
+    }
+  }
+  return delays;
+}
+
+absl::StatusOr<std::vector<int64_t>>
+Synthesizer::SynthesizeVerilogBatchAndGetDelays(
+    absl::Span<const std::string> verilog_texts,
+    std::string_view top_module_name) const {
+  std::vector<int64_t> delays;
+  delays.reserve(verilog_texts.size());
+  for (const std::string& verilog_text : verilog_texts) {
+    XLS_ASSIGN_OR_RETURN(
+        int64_t delay,
+        SynthesizeVerilogAndGetDelay(verilog_text, top_module_name));
+    delays.push_back(delay);
+  }
+  return delays;
+}
+
+std::string Synthesizer::CacheKey(std::string_view verilog_text,
+                                  std::string_view top_module_name) const {
+  return absl::StrCat(CacheFingerprint(), "\n", top_module_name, "\n",
+                      verilog_text);
+}
+
+std::optional<int64_t> Synthesizer::LookUpCachedDelay(
+    const std::string& key) const {
+  std::shared_ptr<CacheEntry> entry;
+  {
+    absl::MutexLock lock(&cache_mutex_);
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+      entry = it->second;
+    }
+  }
+  std::optional<int64_t> memoized;
+  if (entry != nullptr) {
+    absl::MutexLock lock(&entry->mutex);
+    if (entry->done && entry->delay.ok()) {
+      memoized = *entry->delay;
+    }
+  }
+  if (memoized.has_value()) {
+    absl::MutexLock lock(&cache_mutex_);
+    ++cache_hit_count_;
+    return memoized;
+  }
+  std::optional<int64_t> persisted = ReadCacheFile(key);
+  if (persisted.has_value()) {
+    InsertCachedDelay(key, *persisted);
+    absl::MutexLock lock(&cache_mutex_);
+    ++cache_hit_count_;
+  }
+  return persisted;
+}
+
+void Synthesizer::InsertCachedDelay(const std::string& key,
+                                    int64_t delay) const {
+  bool inserted = false;
+  {
+    absl::MutexLock lock(&cache_mutex_);
+    std::shared_ptr<CacheEntry>& cached = cache_[key];
+    if (cached == nullptr) {
+      cached = std::make_shared<CacheEntry>();
+      absl::MutexLock entry_lock(&cached->mutex);
+      cached->delay = delay;
+      cached->done = true;
+      inserted = true;
+    }
+  }
+  if (inserted) {
+    WriteCacheFile(key, delay);
+  }
+}
+
+std::optional<std::filesystem::path> Synthesizer::CacheFilePath(
+    std::string_view key) const {
+  if (!cache_directory_.has_value()) {
+    return std::nullopt;
+  }
+  std::array<char, SHA256_DIGEST_LENGTH> digest;
+  SHA256(reinterpret_cast<const uint8_t *>(key.data()), key.size(),
+         reinterpret_cast<uint8_t *>(digest.data()));
+  return *cache_directory_ /
+         absl::StrCat(absl::BytesToHexString({digest.data(), digest.size()}),
+                      ".delay");
+}
+
+// A cache file holds the delay on the first line followed by the full key,
+// which is compared on lookup to guard against hash collisions.
+std::optional<int64_t> Synthesizer::ReadCacheFile(std::string_view key) const {
+  std::optional<std::filesystem::path> path = CacheFilePath(key);
+  if (!path.has_value() || !FileExists(*path).ok()) {
+    return std::nullopt;
+  }
+  absl::StatusOr<std::string> contents = GetFileContents(*path);
+  if (!contents.ok()) {
+    return std::nullopt;
+  }
+  std::string_view contents_view = *contents;
+  size_t newline = contents_view.find('\n');
+  int64_t delay;
+  if (newline == std::string_view::npos ||
+      contents_view.substr(newline + 1) != key ||
+      !absl::SimpleAtoi(contents_view.substr(0, newline), &delay)) {
+    return std::nullopt;
+  }
+  return delay;
+}
+
+void Synthesizer::WriteCacheFile(std::string_view key, int64_t delay) const {
+  std::optional<std::filesystem::path> path = CacheFilePath(key);
+  if (!path.has_value()) {
+    return;
+  }
+  // Write to a temporary file and rename so that concurrent readers never see
+  // a partially written file.
+  std::filesystem::path temp_path = *path;
+  temp_path += ".tmp";
+  absl::Status status = RecursivelyCreateDir(*cache_directory_);
+  if (status.ok()) {
+    status = SetFileContents(temp_path, absl::StrCat(delay, "\n", key));
+  }
+  if (status.ok()) {
+    std::error_code error;
+    std::filesystem::rename(temp_path, *path, error);
+    if (error) {
+      status = absl::InternalError(error.message());
+    }
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Unable to write synthesis cache file " << *path << ": "
+                 << status;
+  }
+}
 
 absl::StatusOr<std::vector<int64_t>>
 Synthesizer::SynthesizeNodesConcurrentlyAndGetDelays(
     absl::Span<const absl::flat_hash_set<Node *>> nodes_list) const {
-  // Launches multi-threading delay estimation.
-  std::vector<absl::StatusOr<int64_t>> results;
-  std::vector<std::unique_ptr<Thread>> threads;
-  results.reserve(nodes_list.size());
-  absl::StatusOr<int64_t> init_val = 0;
-  for (const absl::flat_hash_set<Node *> &nodes : nodes_list) {
-    results.push_back(init_val);
-    absl::StatusOr<int64_t> &dest = results.back();
-    // TODO(hanchenye): 2023-08-14 Use a thread pool structure that we can
-    // schedule on.
-    threads.push_back(std::make_unique<Thread>(
-        [&]() { dest = SynthesizeNodesAndGetDelay(nodes); }));
+  int64_t count = nodes_list.size();
+  if (batch_size_ > 1) {
+    return SynthesizeNodesInBatchesAndGetDelays(nodes_list);
   }
 
+  // Launches multi-threading delay estimation on a bounded number of threads,
+  // each of which synthesizes the next unclaimed set of nodes until none
+  // remain.
+  std::vector<absl::StatusOr<int64_t>> results(count, 0);
+  RunOnWorkers(count, max_concurrency_, [&](int64_t i) {
+    results[i] = SynthesizeNodesAndGetDelay(nodes_list[i]);
+  });
+
   // Records the estimated delays.
-  for (auto &t : threads) {
-    t->Join();
-  }
   std::vector<int64_t> delay_list;
   delay_list.reserve(results.size());
   for (absl::StatusOr<int64_t> result : results) {
@@ -69,6 +345,41 @@ Synthesizer::SynthesizeNodesConcurrentlyAndGetDelays(
   return delay_list;
 }
 
+absl::StatusOr<std::vector<int64_t>>
+Synthesizer::SynthesizeNodesInBatchesAndGetDelays(
+    absl::Span<const absl::flat_hash_set<Node *>> nodes_list) const {
+  // Generating the Verilog is independent per set so it is done concurrently
+  // as well; the synthesis of the distinct modules is then batched.
+  const std::string top_name = "tmp_module";
+  int64_t count = nodes_list.size();
+  std::vector<absl::StatusOr<std::optional<std::string>>> verilog_texts(
+      count, std::nullopt);
+  RunOnWorkers(count, max_concurrency_, [&](int64_t i) {
+    verilog_texts[i] = ExtractNodesAndGetVerilog(nodes_list[i], top_name,
+                                                 /*flop_inputs_outputs=*/true);
+  });
+
+  // Sets of nodes which produce no Verilog have zero delay.
+  std::vector<std::string> modules;
+  std::vector<std::optional<int64_t>> module_index(count);
+  for (int64_t i = 0; i < count; ++i) {
+    XLS_RETURN_IF_ERROR(verilog_texts[i].status());
+    if (verilog_texts[i]->has_value()) {
+      module_index[i] = modules.size();
+      modules.push_back(std::move(verilog_texts[i]->value()));
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<int64_t> module_delays,
+                       SynthesizeVerilogModulesAndGetDelays(modules, top_name));
+  std::vector<int64_t> delay_list(count, 0);
+  for (int64_t i = 0; i < count; ++i) {
+    if (module_index[i].has_value()) {
+      delay_list[i] = module_delays[*module_index[i]];
+    }
+  }
+  return delay_list;
+}
+
 absl::StatusOr<int64_t> Synthesizer::SynthesizeNodesAndGetDelay(
     const absl::flat_hash_set<Node *> &nodes) const {
   std::string top_name = "tmp_module";
@@ -80,7 +391,7 @@ absl::StatusOr<int64_t> Synthesizer::SynthesizeNodesAndGetDelay(
   }
   XLS_ASSIGN_OR_RETURN(
       int64_t nodes_delay,
-      SynthesizeVerilogAndGetDelay(verilog_text.value(), top_name));
+      SynthesizeVerilogAndGetDelayCached(verilog_text.value(), top_name));
   return nodes_delay;
 }
 
@@ -114,7 +425,14 @@ SynthesizerManager::MakeSynthesizer(
     std::string_view name, const SchedulingOptions &scheduling_options) {
   XLS_ASSIGN_OR_RETURN(SynthesizerFactory * factory,
                        GetSynthesizerFactory(name));
-  return factory->CreateSynthesizer(scheduling_options);
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Synthesizer> synthesizer,
+                       factory->CreateSynthesizer(scheduling_options));
+  if (!scheduling_options.fdo_synthesis_cache_dir().empty()) {
+    synthesizer->set_cache_directory(
+        scheduling_options.fdo_synthesis_cache_dir());
+  }
+  synthesizer->set_batch_size(scheduling_options.fdo_synthesis_batch_size());
+  return std::move(synthesizer);
 };
 
 absl::Status SynthesizerManager::RegisterSynthesizer(
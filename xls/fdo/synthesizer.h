@@ -16,17 +16,21 @@
 #define XLS_FDO_SYNTHESIZER_H_
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/ir/node.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -35,19 +39,81 @@ namespace xls {
 namespace synthesis {
 
 // An abstract class of a synthesis service.
+//
+// Synthesis results of the Verilog generated by SynthesizeNodesAndGetDelay are
+// memoized by the Verilog text (see SynthesizeVerilogAndGetDelayCached), so
+// identical node sets are only synthesized once per synthesizer, e.g., across
+// iterations of iterative SDC scheduling. Optionally the results are also
+// persisted in a cache directory and reused across runs.
 class Synthesizer {
  public:
-  explicit Synthesizer(std::string_view name) : name_(name) {}
+  explicit Synthesizer(std::string_view name);
   virtual ~Synthesizer() = default;
 
   const std::string &name() const { return name_; }
 
+  // Returns a string identifying the configuration of this synthesizer (tool,
+  // libraries, etc.). Results are only shared between synthesizers with the
+  // same fingerprint, so this must include everything which may affect the
+  // synthesized delay.
+  virtual std::string CacheFingerprint() const { return name_; }
+
+  // Sets the directory in which synthesis results are persisted. The directory
+  // is created if it does not exist.
+  void set_cache_directory(std::filesystem::path cache_directory) {
+    cache_directory_ = std::move(cache_directory);
+  }
+
+  // Sets the maximum number of synthesis runs launched concurrently by
+  // SynthesizeNodesConcurrentlyAndGetDelays. Defaults to the number of
+  // available CPUs.
+  void set_max_concurrency(int64_t max_concurrency) {
+    max_concurrency_ = max_concurrency;
+  }
+  int64_t max_concurrency() const { return max_concurrency_; }
+
+  // Sets the maximum number of modules synthesized by one call to
+  // SynthesizeVerilogBatchAndGetDelays. With a batch size of one (the default)
+  // each module is synthesized by SynthesizeVerilogAndGetDelay.
+  void set_batch_size(int64_t batch_size) { batch_size_ = batch_size; }
+  int64_t batch_size() const { return batch_size_; }
+
+  // Returns the number of requests to SynthesizeVerilogAndGetDelayCached which
+  // did not run synthesis because the result was cached or in flight.
+  int64_t cache_hit_count() const {
+    absl::MutexLock lock(&cache_mutex_);
+    return cache_hit_count_;
+  }
+
+  // As SynthesizeVerilogAndGetDelay but returns the memoized result if the
+  // same Verilog has been synthesized before. Concurrent requests for the same
+  // Verilog wait for a single synthesis run. Failed runs are not cached.
+  absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelayCached(
+      std::string_view verilog_text, std::string_view top_module_name) const;
+
+  // Returns the delays of the given Verilog modules, all of which have the top
+  // module `top_module_name`. Modules whose results are cached are not
+  // synthesized again; the others are deduplicated and synthesized in batches
+  // of batch_size(), up to max_concurrency() batches at a time.
+  absl::StatusOr<std::vector<int64_t>> SynthesizeVerilogModulesAndGetDelays(
+      absl::Span<const std::string> verilog_texts,
+      std::string_view top_module_name) const;
+
   // Synthesizes the given Verilog module with a synthesis tool and return its
   // overall delay.
   virtual absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
       std::string_view verilog_text,
       std::string_view top_module_name) const = 0;
 
+  // Synthesizes each of the given Verilog modules and returns their delays in
+  // order. Synthesizers whose tools are expensive to start may override this
+  // to synthesize all of the modules in a single tool invocation. The default
+  // calls SynthesizeVerilogAndGetDelay for each module.
+  virtual absl::StatusOr<std::vector<int64_t>>
+  SynthesizeVerilogBatchAndGetDelays(
+      absl::Span<const std::string> verilog_texts,
+      std::string_view top_module_name) const;
+
   // Wraps the given set of nodes into a module, synthesize the module with a
   // synthesis tool, and return its overall delay. The nodes set can be an
   // arbitrary subgraph or multiple disjointed subgraphs from a function or
@@ -58,14 +124,53 @@ class Synthesizer {
       const absl::flat_hash_set<Node *> &nodes) const;
 
   // Launches "SynthesizeNodesAndGetDelay" concurrently for each set of nodes
-  // listed in "nodes_list" and get their delays.
+  // listed in "nodes_list" and get their delays. At most max_concurrency()
+  // sets are synthesized at a time.
   absl::StatusOr<std::vector<int64_t>> SynthesizeNodesConcurrentlyAndGetDelays(
       absl::Span<const absl::flat_hash_set<Node *>> nodes_list) const;
 
  private:
+  // A synthesis result which may still be being computed.
+  struct CacheEntry {
+    absl::Mutex mutex;
+    bool done ABSL_GUARDED_BY(mutex) = false;
+    absl::StatusOr<int64_t> delay ABSL_GUARDED_BY(mutex);
+  };
+
+  // SynthesizeNodesConcurrentlyAndGetDelays for batch sizes greater than one.
+  absl::StatusOr<std::vector<int64_t>> SynthesizeNodesInBatchesAndGetDelays(
+      absl::Span<const absl::flat_hash_set<Node *>> nodes_list) const;
+
+  std::string CacheKey(std::string_view verilog_text,
+                       std::string_view top_module_name) const;
+
+  // Returns the delay for `key` if it has been computed by this synthesizer or
+  // is in the persistent cache. Requests which are still in flight are not
+  // waited for.
+  std::optional<int64_t> LookUpCachedDelay(const std::string& key) const;
+
+  // Records a successfully computed delay in the memo and persistent cache.
+  void InsertCachedDelay(const std::string& key, int64_t delay) const;
+
+  // Returns the path of the persistent cache file for `key`, if a cache
+  // directory is set.
+  std::optional<std::filesystem::path> CacheFilePath(
+      std::string_view key) const;
+  std::optional<int64_t> ReadCacheFile(std::string_view key) const;
+  void WriteCacheFile(std::string_view key, int64_t delay) const;
+
   // Records the name of the concreate synthesizer, e.g., yosys, for management
   // and debugging purpose.
   std::string name_;
+
+  std::optional<std::filesystem::path> cache_directory_;
+  int64_t max_concurrency_;
+  int64_t batch_size_ = 1;
+
+  mutable absl::Mutex cache_mutex_;
+  mutable absl::flat_hash_map<std::string, std::shared_ptr<CacheEntry>> cache_
+      ABSL_GUARDED_BY(cache_mutex_);
+  mutable int64_t cache_hit_count_ ABSL_GUARDED_BY(cache_mutex_) = 0;
 };
 
 // An abstract class of a synthesis service.
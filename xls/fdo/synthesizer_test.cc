@@ -0,0 +1,182 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fdo/synthesizer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+
+// A synthesizer which returns the length of the Verilog text as its delay and
+// counts the number of synthesis runs. Verilog containing "fail" fails to
+// synthesize.
+class CountingSynthesizer : public Synthesizer {
+ public:
+  CountingSynthesizer() : Synthesizer("CountingSynthesizer") {}
+
+  absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
+      std::string_view verilog_text,
+      std::string_view top_module_name) const override {
+    ++synthesis_count_;
+    if (verilog_text.find("fail") != std::string_view::npos) {
+      return absl::InternalError("synthesis failed");
+    }
+    return verilog_text.size();
+  }
+
+  absl::StatusOr<std::vector<int64_t>> SynthesizeVerilogBatchAndGetDelays(
+      absl::Span<const std::string> verilog_texts,
+      std::string_view top_module_name) const override {
+    ++batch_count_;
+    return Synthesizer::SynthesizeVerilogBatchAndGetDelays(verilog_texts,
+                                                           top_module_name);
+  }
+
+  int64_t synthesis_count() const { return synthesis_count_; }
+  int64_t batch_count() const { return batch_count_; }
+
+ private:
+  mutable std::atomic<int64_t> synthesis_count_ = 0;
+  mutable std::atomic<int64_t> batch_count_ = 0;
+};
+
+TEST(SynthesizerTest, CachesIdenticalVerilog) {
+  CountingSynthesizer synthesizer;
+  EXPECT_THAT(synthesizer.SynthesizeVerilogAndGetDelayCached("abc", "top"),
+              IsOkAndHolds(3));
+  EXPECT_THAT(synthesizer.SynthesizeVerilogAndGetDelayCached("abc", "top"),
+              IsOkAndHolds(3));
+  EXPECT_EQ(synthesizer.synthesis_count(), 1);
+  EXPECT_EQ(synthesizer.cache_hit_count(), 1);
+
+  // A different top module or Verilog text is synthesized again.
+  XLS_EXPECT_OK(
+      synthesizer.SynthesizeVerilogAndGetDelayCached("abc", "other").status());
+  XLS_EXPECT_OK(
+      synthesizer.SynthesizeVerilogAndGetDelayCached("abcd", "top").status());
+  EXPECT_EQ(synthesizer.synthesis_count(), 3);
+  EXPECT_EQ(synthesizer.cache_hit_count(), 1);
+}
+
+TEST(SynthesizerTest, DoesNotCacheFailures) {
+  CountingSynthesizer synthesizer;
+  EXPECT_THAT(synthesizer.SynthesizeVerilogAndGetDelayCached("fail", "top"),
+              StatusIs(absl::StatusCode::kInternal));
+  EXPECT_THAT(synthesizer.SynthesizeVerilogAndGetDelayCached("fail", "top"),
+              StatusIs(absl::StatusCode::kInternal));
+  EXPECT_EQ(synthesizer.synthesis_count(), 2);
+}
+
+TEST(SynthesizerTest, ConcurrentRequestsAreDeduplicated) {
+  constexpr int64_t kThreadCount = 8;
+  CountingSynthesizer synthesizer;
+  std::vector<absl::StatusOr<int64_t>> results(kThreadCount, 0);
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 0; i < kThreadCount; ++i) {
+      threads.push_back(std::make_unique<Thread>([&, i]() {
+        results[i] =
+            synthesizer.SynthesizeVerilogAndGetDelayCached("module", "top");
+      }));
+    }
+  }
+  for (const absl::StatusOr<int64_t>& result : results) {
+    EXPECT_THAT(result, IsOkAndHolds(6));
+  }
+  EXPECT_EQ(synthesizer.synthesis_count(), 1);
+  EXPECT_EQ(synthesizer.cache_hit_count(), kThreadCount - 1);
+}
+
+TEST(SynthesizerTest, PersistsResultsInCacheDirectory) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path cache_dir = temp_dir.path() / "cache";
+  {
+    CountingSynthesizer synthesizer;
+    synthesizer.set_cache_directory(cache_dir);
+    EXPECT_THAT(synthesizer.SynthesizeVerilogAndGetDelayCached("abc", "top"),
+                IsOkAndHolds(3));
+    EXPECT_EQ(synthesizer.synthesis_count(), 1);
+  }
+
+  // A new synthesizer with the same cache directory reuses the result.
+  CountingSynthesizer synthesizer;
+  synthesizer.set_cache_directory(cache_dir);
+  EXPECT_THAT(synthesizer.SynthesizeVerilogAndGetDelayCached("abc", "top"),
+              IsOkAndHolds(3));
+  EXPECT_EQ(synthesizer.synthesis_count(), 0);
+  EXPECT_EQ(synthesizer.cache_hit_count(), 1);
+
+  // Without the cache directory the result is not reused.
+  CountingSynthesizer uncached;
+  XLS_EXPECT_OK(
+      uncached.SynthesizeVerilogAndGetDelayCached("abc", "top").status());
+  EXPECT_EQ(uncached.synthesis_count(), 1);
+}
+
+TEST(SynthesizerTest, SynthesizesModulesInBatches) {
+  CountingSynthesizer synthesizer;
+  synthesizer.set_batch_size(2);
+  XLS_ASSERT_OK(
+      synthesizer.SynthesizeVerilogAndGetDelayCached("e", "top").status());
+  EXPECT_EQ(synthesizer.synthesis_count(), 1);
+
+  // "e" is cached and the second "a" is a duplicate, leaving three modules to
+  // synthesize in two batches.
+  std::vector<std::string> modules = {"a", "bb", "a", "e", "ccc"};
+  EXPECT_THAT(synthesizer.SynthesizeVerilogModulesAndGetDelays(modules, "top"),
+              IsOkAndHolds(ElementsAre(1, 2, 1, 1, 3)));
+  EXPECT_EQ(synthesizer.synthesis_count(), 4);
+  EXPECT_EQ(synthesizer.batch_count(), 2);
+  EXPECT_EQ(synthesizer.cache_hit_count(), 2);
+
+  // Everything is now cached, including for single requests.
+  EXPECT_THAT(synthesizer.SynthesizeVerilogModulesAndGetDelays(modules, "top"),
+              IsOkAndHolds(ElementsAre(1, 2, 1, 1, 3)));
+  EXPECT_THAT(synthesizer.SynthesizeVerilogAndGetDelayCached("ccc", "top"),
+              IsOkAndHolds(3));
+  EXPECT_EQ(synthesizer.synthesis_count(), 4);
+  EXPECT_EQ(synthesizer.batch_count(), 2);
+
+  // A failure in a batch fails the request and is not cached.
+  EXPECT_THAT(synthesizer.SynthesizeVerilogModulesAndGetDelays(
+                  {"fail", "dddd"}, "top"),
+              StatusIs(absl::StatusCode::kInternal));
+  EXPECT_THAT(synthesizer.SynthesizeVerilogModulesAndGetDelays({"dddd"}, "top"),
+              IsOkAndHolds(ElementsAre(4)));
+}
+
+}  // namespace
+}  // namespace synthesis
+}  // namespace xls
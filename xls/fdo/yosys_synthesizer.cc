@@ -19,11 +19,13 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/casts.h"
 #include "xls/common/module_initializer.h"
 #include "xls/common/status/status_macros.h"
@@ -47,6 +49,29 @@ absl::StatusOr<int64_t> YosysSynthesizer::SynthesizeVerilogAndGetDelay(
   return response.slack_ps() == 0 ? 0 : kClockPeriodPs - response.slack_ps();
 }
 
+absl::StatusOr<std::vector<int64_t>>
+YosysSynthesizer::SynthesizeVerilogBatchAndGetDelays(
+    absl::Span<const std::string> verilog_texts,
+    std::string_view top_module_name) const {
+  std::vector<synthesis::CompileRequest> requests(verilog_texts.size());
+  for (int64_t i = 0; i < verilog_texts.size(); ++i) {
+    requests[i].set_module_text(verilog_texts[i]);
+    requests[i].set_top_module_name(top_module_name);
+    requests[i].set_target_frequency_hz(kFrequencyHz);
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::vector<synthesis::CompileResponse> responses,
+                       service_.RunSynthesisBatch(requests));
+  std::vector<int64_t> delays;
+  delays.reserve(responses.size());
+  for (const synthesis::CompileResponse& response : responses) {
+    delays.push_back(response.slack_ps() == 0
+                         ? 0
+                         : kClockPeriodPs - response.slack_ps());
+  }
+  return delays;
+}
+
 absl::StatusOr<std::unique_ptr<Synthesizer>>
 YosysSynthesizerFactory::CreateSynthesizer(
     const SynthesizerParameters &parameters) {
@@ -19,9 +19,12 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/fdo/synthesizer.h"
 #include "xls/ir/node.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -41,16 +44,28 @@ class YosysSynthesizer : public Synthesizer {
                             std::string_view sta_path,
                             std::string_view synthesis_libraries)
       : Synthesizer("yosys"),
+        fingerprint_(absl::StrJoin(
+            {std::string_view("yosys"), yosys_path, sta_path,
+             synthesis_libraries},
+            "\n")),
         service_(yosys_path, /*nextpnr_path=*/"", /*synthesis_target=*/"",
                  sta_path, synthesis_libraries, synthesis_libraries,
                  /*save_temps=*/false, /*return_netlist=*/false,
                  /*synthesis_only=*/false) {}
 
+  std::string CacheFingerprint() const override { return fingerprint_; }
+
   absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
       std::string_view verilog_text,
       std::string_view top_module_name) const override;
 
+  // Synthesizes all of the modules with one yosys and one OpenSTA invocation.
+  absl::StatusOr<std::vector<int64_t>> SynthesizeVerilogBatchAndGetDelays(
+      absl::Span<const std::string> verilog_texts,
+      std::string_view top_module_name) const override;
+
  private:
+  std::string fingerprint_;
   YosysSynthesisServiceImpl service_;
 };
 
@@ -32,6 +32,8 @@
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
@@ -105,6 +107,19 @@ LastDelayingOp ComposeDelayingOps(LastDelayingOp op1, LastDelayingOp op2,
 
 /* static */ absl::StatusOr<AstGeneratorOptions> AstGeneratorOptions::FromProto(
     const AstGeneratorOptionsProto& proto) {
+  std::vector<std::string> expr_kinds = GetAstGeneratorExprKinds();
+  absl::btree_map<std::string, double> expr_weight_scales;
+  for (const auto& [kind, scale] : proto.expr_weight_scales()) {
+    if (!absl::c_linear_search(expr_kinds, kind)) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Unknown expression kind: %s", kind));
+    }
+    if (scale < 0.0) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Negative weight scale for expression kind %s: %f", kind, scale));
+    }
+    expr_weight_scales[kind] = scale;
+  }
   return AstGeneratorOptions{
       .emit_signed_types = proto.emit_signed_types(),
       .max_width_bits_types = proto.max_width_bits_types(),
@@ -114,6 +129,7 @@ LastDelayingOp ComposeDelayingOps(LastDelayingOp op1, LastDelayingOp op2,
       .generate_proc = proto.generate_proc(),
       .emit_stateless_proc = proto.emit_stateless_proc(),
       .emit_zero_width_bits_types = proto.emit_zero_width_bits_types(),
+      .expr_weight_scales = std::move(expr_weight_scales),
   };
 }
 
@@ -127,6 +143,9 @@ AstGeneratorOptionsProto AstGeneratorOptions::ToProto() const {
   proto.set_generate_proc(generate_proc);
   proto.set_emit_stateless_proc(emit_stateless_proc);
   proto.set_emit_zero_width_bits_types(emit_zero_width_bits_types);
+  for (const auto& [kind, scale] : expr_weight_scales) {
+    (*proto.mutable_expr_weight_scales())[kind] = scale;
+  }
   return proto;
 }
 
@@ -2377,21 +2396,103 @@ int OpProbability(OpChoice op) {
   LOG(FATAL) << "Invalid op choice: " << static_cast<int64_t>(op);
 }
 
+std::string_view OpChoiceName(OpChoice op) {
+  switch (op) {
+    case kArray:
+      return "array";
+    case kArrayIndex:
+      return "array_index";
+    case kArrayUpdate:
+      return "array_update";
+    case kArraySlice:
+      return "array_slice";
+    case kBinop:
+      return "binop";
+    case kBitSlice:
+      return "bit_slice";
+    case kBitSliceUpdate:
+      return "bit_slice_update";
+    case kBitwiseReduction:
+      return "bitwise_reduction";
+    case kCastToBitsArray:
+      return "cast_to_bits_array";
+    case kChannelOp:
+      return "channel_op";
+    case kCompareOp:
+      return "compare";
+    case kCompareArrayOp:
+      return "compare_array";
+    case kCompareTupleOp:
+      return "compare_tuple";
+    case kMatchOp:
+      return "match";
+    case kConcat:
+      return "concat";
+    case kCountedFor:
+      return "counted_for";
+    case kGate:
+      return "gate";
+    case kInvoke:
+      return "invoke";
+    case kJoinOp:
+      return "join";
+    case kLogical:
+      return "logical";
+    case kMap:
+      return "map";
+    case kNumber:
+      return "number";
+    case kOneHotSelectBuiltin:
+      return "one_hot_select";
+    case kPartialProduct:
+      return "partial_product";
+    case kPrioritySelectBuiltin:
+      return "priority_select";
+    case kSignExtendBuiltin:
+      return "sign_extend";
+    case kShiftOp:
+      return "shift";
+    case kTupleOrIndex:
+      return "tuple_or_index";
+    case kUnop:
+      return "unop";
+    case kUnopBuiltin:
+      return "unop_builtin";
+    case kEndSentinel:
+      break;
+  }
+  LOG(FATAL) << "Invalid op choice: " << static_cast<int64_t>(op);
+}
+
+// Returns the relative probabilities of generating each op, scaled by
+// `scales` which is keyed by op name.
+std::vector<double> OpWeights(
+    bool generate_proc, const absl::btree_map<std::string, double>& scales) {
+  static const std::set<int> proc_ops = {int{kChannelOp}, int{kJoinOp}};
+  std::vector<double> weights;
+  weights.reserve(int{kEndSentinel});
+  for (int i = 0; i < int{kEndSentinel}; ++i) {
+    // When not generating a proc, do not generate proc operations by setting
+    // its probability to zero.
+    if (!generate_proc && proc_ops.find(i) != proc_ops.end()) {
+      weights.push_back(0);
+      continue;
+    }
+    OpChoice op = static_cast<OpChoice>(i);
+    double weight = OpProbability(op);
+    if (auto it = scales.find(OpChoiceName(op)); it != scales.end()) {
+      weight *= it->second;
+    }
+    weights.push_back(weight);
+  }
+  return weights;
+}
+
 absl::discrete_distribution<int>& GetOpDistribution(bool generate_proc) {
   auto dist = [&](bool generate_proc) {
-    static const std::set<int> proc_ops = {int{kChannelOp}, int{kJoinOp}};
-    std::vector<int> tmp;
-    tmp.reserve(int{kEndSentinel});
-    for (int i = 0; i < int{kEndSentinel}; ++i) {
-      // When not generating a proc, do not generate proc operations by setting
-      // its probability to zero.
-      if (!generate_proc && proc_ops.find(i) != proc_ops.end()) {
-        tmp.push_back(0);
-        continue;
-      }
-      tmp.push_back(OpProbability(static_cast<OpChoice>(i)));
-    }
-    return new absl::discrete_distribution<int>(tmp.begin(), tmp.end());
+    std::vector<double> weights = OpWeights(generate_proc, /*scales=*/{});
+    return new absl::discrete_distribution<int>(weights.begin(),
+                                                weights.end());
   };
   static absl::discrete_distribution<int>& func_dist = *dist(false);
   static absl::discrete_distribution<int>& proc_dist = *dist(true);
@@ -2401,17 +2502,30 @@ absl::discrete_distribution<int>& GetOpDistribution(bool generate_proc) {
   return func_dist;
 }
 
-OpChoice ChooseOp(absl::BitGenRef bit_gen, bool generate_proc) {
-  return static_cast<OpChoice>(GetOpDistribution(generate_proc)(bit_gen));
-}
-
 }  // namespace
 
+std::vector<std::string> GetAstGeneratorExprKinds() {
+  std::vector<std::string> kinds;
+  kinds.reserve(int{kEndSentinel});
+  for (int i = 0; i < int{kEndSentinel}; ++i) {
+    kinds.push_back(std::string(OpChoiceName(static_cast<OpChoice>(i))));
+  }
+  return kinds;
+}
+
 absl::StatusOr<TypedExpr> AstGenerator::GenerateExpr(int64_t call_depth,
                                                      Context* ctx) {
   absl::StatusOr<TypedExpr> generated = RecoverableError("Not yet generated.");
+  std::optional<absl::discrete_distribution<int>>& scaled_distribution =
+      scaled_expr_distributions_[ctx->is_generating_proc ? 1 : 0];
+  absl::discrete_distribution<int>& distribution =
+      scaled_distribution.has_value()
+          ? *scaled_distribution
+          : GetOpDistribution(ctx->is_generating_proc);
+  OpChoice choice = kEndSentinel;
   while (IsRecoverableError(generated.status())) {
-    switch (ChooseOp(bit_gen_, ctx->is_generating_proc)) {
+    choice = static_cast<OpChoice>(distribution(bit_gen_));
+    switch (choice) {
       case kArray:
         generated = GenerateArray(ctx);
         break;
@@ -2511,6 +2625,7 @@ absl::StatusOr<TypedExpr> AstGenerator::GenerateExpr(int64_t call_depth,
   }
 
   if (generated.ok()) {
+    ++expr_kind_counts_[std::string(OpChoiceName(choice))];
     // Do some opportunistic checking that our result types are staying within
     // requested parameters.
     if (IsBits(generated->type)) {
@@ -2946,6 +3061,7 @@ absl::StatusOr<int64_t> AstGenerator::GenerateProcInModule(
 absl::StatusOr<AnnotatedModule> AstGenerator::Generate(
     const std::string& top_entity_name, const std::string& module_name) {
   module_ = std::make_unique<Module>(module_name, /*fs_path=*/std::nullopt);
+  expr_kind_counts_.clear();
   int64_t min_stages = 1;
   if (options_.generate_proc) {
     XLS_ASSIGN_OR_RETURN(min_stages, GenerateProcInModule(top_entity_name));
@@ -2953,13 +3069,23 @@ absl::StatusOr<AnnotatedModule> AstGenerator::Generate(
     XLS_ASSIGN_OR_RETURN(min_stages, GenerateFunctionInModule(top_entity_name));
   }
   return AnnotatedModule{.module = std::move(module_),
-                         .min_stages = min_stages};
+                         .min_stages = min_stages,
+                         .expr_kind_counts = std::move(expr_kind_counts_)};
 }
 
 AstGenerator::AstGenerator(AstGeneratorOptions options, absl::BitGenRef bit_gen)
     : bit_gen_(bit_gen),
       options_(options),
       fake_pos_("<fake>", 0, 0),
-      fake_span_(fake_pos_, fake_pos_) {}
+      fake_span_(fake_pos_, fake_pos_) {
+  if (!options_.expr_weight_scales.empty()) {
+    for (bool generate_proc : {false, true}) {
+      std::vector<double> weights =
+          OpWeights(generate_proc, options_.expr_weight_scales);
+      scaled_expr_distributions_[generate_proc ? 1 : 0].emplace(weights.begin(),
+                                                                weights.end());
+    }
+  }
+}
 
 }  // namespace xls::dslx
@@ -15,6 +15,7 @@
 #ifndef XLS_FUZZER_AST_GENERATOR_H_
 #define XLS_FUZZER_AST_GENERATOR_H_
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -31,6 +32,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/random/bit_gen_ref.h"
+#include "absl/random/discrete_distribution.h"
 #include "absl/random/distributions.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -99,6 +101,8 @@ struct AnnotatedProc {
 struct AnnotatedModule {
   std::unique_ptr<Module> module;
   int64_t min_stages = 1;
+  // Number of expressions generated of each kind, keyed by kind name.
+  absl::btree_map<std::string, int64_t> expr_kind_counts;
 };
 
 struct BitsAndSignedness {
@@ -120,6 +124,10 @@ struct AstGeneratorOptions {
   // TODO(https://github.com/google/xls/issues/1138): Switch this to default
   // true.
   bool emit_zero_width_bits_types = false;
+  // Factors by which the default relative probabilities of generating each
+  // kind of expression are scaled, keyed by kind name (see
+  // GetAstGeneratorExprKinds). Kinds which are not present are not scaled.
+  absl::btree_map<std::string, double> expr_weight_scales;
 
   static absl::StatusOr<AstGeneratorOptions> FromProto(
       const AstGeneratorOptionsProto& proto);
@@ -134,6 +142,10 @@ bool AbslParseFlag(std::string_view text,
                    std::string* error);
 std::string AbslUnparseFlag(const AstGeneratorOptions& ast_generator_options);
 
+// Returns the names of the kinds of expressions the AstGenerator chooses
+// between when generating an expression.
+std::vector<std::string> GetAstGeneratorExprKinds();
+
 // Type that generates a random module for use in fuzz testing; i.e.
 //
 //    std::mt19937_64 rng;
@@ -703,6 +715,14 @@ class AstGenerator {
 
   const AstGeneratorOptions options_;
 
+  // Distributions over the expression kinds scaled by
+  // `options_.expr_weight_scales` when generating functions and procs
+  // respectively. Unset if there are no scales.
+  std::array<std::optional<absl::discrete_distribution<int>>, 2>
+      scaled_expr_distributions_;
+
+  absl::btree_map<std::string, int64_t> expr_kind_counts_;
+
   const Pos fake_pos_;
   const Span fake_span_;
 
@@ -38,11 +38,14 @@
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/parse_and_typecheck.h"
+#include "xls/fuzzer/ast_generator_options.pb.h"
 
 namespace xls::dslx {
 namespace {
 
+using status_testing::StatusIs;
 using ::testing::ContainsRegex;
+using ::testing::HasSubstr;
 using ::testing::MatchesRegex;
 
 // Parses and typechecks the given text to ensure it's valid -- prints errors to
@@ -222,6 +225,41 @@ TEST(AstGeneratorTest, GeneratesZeroWidthValues) {
       "Generated %d samples and did not see a zero-width type", kNumSamples);
 }
 
+TEST(AstGeneratorTest, ExprWeightScales) {
+  std::mt19937_64 rng{0};
+  AstGeneratorOptions options;
+  options.expr_weight_scales = {{"binop", 0.0}, {"concat", 10.0}};
+  int64_t concats = 0;
+  for (int64_t i = 0; i < 32; ++i) {
+    AstGenerator g(options, rng);
+    std::string module_name = absl::StrFormat("sample_%d", i);
+    XLS_ASSERT_OK_AND_ASSIGN(AnnotatedModule module,
+                             g.Generate("main", module_name));
+    XLS_ASSERT_OK(
+        ParseAndTypecheck<Function>(module.module->ToString(), module_name));
+    EXPECT_FALSE(module.expr_kind_counts.contains("binop"));
+    if (auto it = module.expr_kind_counts.find("concat");
+        it != module.expr_kind_counts.end()) {
+      concats += it->second;
+    }
+  }
+  EXPECT_GT(concats, 0);
+}
+
+TEST(AstGeneratorTest, ExprWeightScalesFromProto) {
+  AstGeneratorOptionsProto proto = AstGeneratorOptions::DefaultOptionsProto();
+  (*proto.mutable_expr_weight_scales())["shift"] = 2.0;
+  XLS_ASSERT_OK_AND_ASSIGN(AstGeneratorOptions options,
+                           AstGeneratorOptions::FromProto(proto));
+  EXPECT_EQ(options.expr_weight_scales.at("shift"), 2.0);
+  EXPECT_EQ(options.ToProto().expr_weight_scales().at("shift"), 2.0);
+
+  (*proto.mutable_expr_weight_scales())["not_a_kind"] = 2.0;
+  EXPECT_THAT(AstGeneratorOptions::FromProto(proto),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Unknown expression kind")));
+}
+
 class AstGeneratorRepeatableTest : public testing::TestWithParam<uint64_t> {};
 
 TEST_P(AstGeneratorRepeatableTest, GenerationRepeatableAtSeed) {
@@ -0,0 +1,248 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/fuzzer/crasher_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "re2/re2.h"
+
+namespace xls {
+namespace {
+
+// Normalized messages are truncated to this many characters so that failures
+// differing only deep in a long message are still considered the same bug.
+constexpr int64_t kMaxMessageLength = 512;
+
+constexpr std::string_view kMiscompareStage = "miscompare";
+constexpr std::string_view kSampleStage = "sample";
+
+// Returns the line of `stderr_text` which reports the error: the first fatal
+// log line if there is one, as a crash is followed by a stack trace, otherwise
+// the last line which looks like an error. Returns std::nullopt if there is
+// none.
+std::optional<std::string_view> ErrorLine(std::string_view stderr_text) {
+  static const LazyRE2 kFatalLogLine = {R"(^F\d{4} )"};
+  static const LazyRE2 kErrorLine = {
+      R"((?i)check failed|error|fatal|terminate|unimplemented)"};
+  std::vector<std::string_view> lines =
+      absl::StrSplit(stderr_text, '\n', absl::SkipWhitespace());
+  for (std::string_view line : lines) {
+    if (RE2::PartialMatch(line, *kFatalLogLine)) {
+      return line;
+    }
+  }
+  for (auto it = lines.rbegin(); it != lines.rend(); ++it) {
+    if (RE2::PartialMatch(*it, *kErrorLine)) {
+      return *it;
+    }
+  }
+  return std::nullopt;
+}
+
+std::string Basename(std::string_view path) {
+  return std::filesystem::path(path).filename().string();
+}
+
+}  // namespace
+
+std::string NormalizeErrorMessage(std::string_view message) {
+  // Prefix of the lines logged by absl and glog, e.g.
+  // "F1014 12:34:56.789012  1234 file.cc:56] ".
+  static const LazyRE2 kLogPrefix = {R"(^[FEWI]\d{4} [\d:.]+\s+\d+ )"};
+  static const LazyRE2 kPath = {R"((?:[\w.\-]*/)+([\w.\-]+))"};
+  static const LazyRE2 kHex = {R"(0x[0-9a-fA-F_]+)"};
+  static const LazyRE2 kNumber = {R"(\d+)"};
+  static const LazyRE2 kWhitespace = {R"(\s+)"};
+
+  std::vector<std::string> lines;
+  for (std::string_view line : absl::StrSplit(message, '\n')) {
+    // Indented lines hold the values of miscompares and the args line their
+    // inputs, neither of which says anything about the bug.
+    if (line.empty() || absl::ascii_isspace(line.front()) ||
+        absl::StartsWith(line, "args:")) {
+      continue;
+    }
+    std::string normalized(line);
+    RE2::Replace(&normalized, *kLogPrefix, "");
+    RE2::GlobalReplace(&normalized, *kPath, R"(\1)");
+    RE2::GlobalReplace(&normalized, *kHex, "0xN");
+    RE2::GlobalReplace(&normalized, *kNumber, "N");
+    RE2::GlobalReplace(&normalized, *kWhitespace, " ");
+    normalized = std::string(absl::StripAsciiWhitespace(normalized));
+    if (!normalized.empty()) {
+      lines.push_back(std::move(normalized));
+    }
+  }
+  std::string result = absl::StrJoin(lines, " | ");
+  if (result.size() > kMaxMessageLength) {
+    result.resize(kMaxMessageLength);
+  }
+  return result;
+}
+
+std::string GetFailingStage(std::string_view message) {
+  static const LazyRE2 kNonZeroExit = {
+      R"((\S+) returned (?:a )?non-zero exit status)"};
+  static const LazyRE2 kSubprocess = {
+      R"(Subprocess call (?:failed|timed out)[^:]*: (\S+))"};
+  if (absl::StrContains(message, "Result miscompare")) {
+    return std::string(kMiscompareStage);
+  }
+  std::string executable;
+  if (RE2::PartialMatch(message, *kNonZeroExit, &executable) ||
+      RE2::PartialMatch(message, *kSubprocess, &executable)) {
+    return Basename(executable);
+  }
+  return std::string(kSampleStage);
+}
+
+absl::StatusOr<absl::btree_set<std::string>> GetIrOps(
+    const std::filesystem::path& ir_path) {
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text, ir_path.string()));
+  absl::btree_set<std::string> ops;
+  for (FunctionBase* fb : package->GetFunctionBases()) {
+    for (Node* node : fb->nodes()) {
+      ops.insert(OpToString(node->op()));
+    }
+  }
+  return ops;
+}
+
+absl::StatusOr<CrasherSignature> GetCrasherSignature(
+    const absl::Status& error, const std::filesystem::path& run_dir) {
+  CrasherSignature signature;
+  std::string_view message = error.message();
+  signature.stage = GetFailingStage(message);
+
+  std::string detail(message);
+  if (signature.stage != kMiscompareStage && signature.stage != kSampleStage) {
+    // The error holds the tool's command line, which is specific to the
+    // sample; the tool's own error report is what identifies the bug.
+    detail = std::string(
+        message.substr(0, std::min(message.find(": "), message.find('\n'))));
+    std::filesystem::path stderr_path =
+        run_dir / absl::StrCat(signature.stage, ".stderr");
+    if (FileExists(stderr_path).ok()) {
+      XLS_ASSIGN_OR_RETURN(std::string stderr_text,
+                           GetFileContents(stderr_path));
+      if (std::optional<std::string_view> line = ErrorLine(stderr_text);
+          line.has_value()) {
+        detail = std::string(*line);
+      }
+    }
+  }
+  signature.message = NormalizeErrorMessage(detail);
+
+  for (std::string_view ir_file_name : {"sample.opt.ir", "sample.ir"}) {
+    std::filesystem::path ir_path = run_dir / ir_file_name;
+    if (!FileExists(ir_path).ok()) {
+      continue;
+    }
+    absl::StatusOr<absl::btree_set<std::string>> ops = GetIrOps(ir_path);
+    if (ops.ok()) {
+      signature.ops = *std::move(ops);
+      break;
+    }
+    LOG(WARNING) << "Unable to get the ops of " << ir_path << ": "
+                 << ops.status();
+  }
+  return signature;
+}
+
+absl::StatusOr<CrasherIndex> CrasherIndex::Load(
+    const std::filesystem::path& crasher_dir) {
+  CrasherIndex index(crasher_dir / kFileName);
+  if (!FileExists(index.path_).ok()) {
+    return index;
+  }
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(index.path_));
+  for (std::string_view line : absl::StrSplit(contents, '\n')) {
+    if (line.empty()) {
+      continue;
+    }
+    // Each line is "<name>\t<stage>\t<comma-separated ops>\t<message>".
+    std::vector<std::string_view> fields =
+        absl::StrSplit(line, absl::MaxSplits('\t', 3));
+    if (fields.size() != 4) {
+      LOG(WARNING) << "Ignoring malformed line of " << index.path_ << ": "
+                   << line;
+      continue;
+    }
+    Entry& entry = index.entries_.emplace_back();
+    entry.crasher_name = std::string(fields[0]);
+    entry.signature.stage = std::string(fields[1]);
+    for (std::string_view op :
+         absl::StrSplit(fields[2], ',', absl::SkipEmpty())) {
+      entry.signature.ops.insert(std::string(op));
+    }
+    entry.signature.message = std::string(fields[3]);
+  }
+  return index;
+}
+
+std::optional<std::string> CrasherIndex::FindDuplicate(
+    const CrasherSignature& signature) const {
+  for (const Entry& entry : entries_) {
+    if (entry.signature.stage == signature.stage &&
+        entry.signature.message == signature.message &&
+        std::includes(signature.ops.begin(), signature.ops.end(),
+                      entry.signature.ops.begin(),
+                      entry.signature.ops.end())) {
+      return entry.crasher_name;
+    }
+  }
+  return std::nullopt;
+}
+
+absl::Status CrasherIndex::Add(std::string_view crasher_name,
+                               const CrasherSignature& signature) {
+  XLS_RETURN_IF_ERROR(AppendStringToFile(
+      path_, absl::StrCat(crasher_name, "\t", signature.stage, "\t",
+                          absl::StrJoin(signature.ops, ","), "\t",
+                          signature.message, "\n")));
+  entries_.push_back(Entry{.crasher_name = std::string(crasher_name),
+                           .signature = signature});
+  return absl::OkStatus();
+}
+
+}  // namespace xls
@@ -0,0 +1,110 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_FUZZER_CRASHER_INDEX_H_
+#define XLS_FUZZER_CRASHER_INDEX_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+namespace xls {
+
+// Identifies the bug behind a fuzzer failure so that samples which hit an
+// already saved bug need not be saved and minimized again.
+struct CrasherSignature {
+  // The tool which failed (e.g. "opt_main"), or "miscompare" for result
+  // miscompares and "sample" for failures of the sample runner itself.
+  std::string stage;
+  // The error message with the sample-specific details (numbers, paths, node
+  // ids, values) removed; see NormalizeErrorMessage.
+  std::string message;
+  // The names of the ops in the failing IR, preferably the minimized IR.
+  absl::btree_set<std::string> ops;
+
+  bool operator==(const CrasherSignature& other) const = default;
+};
+
+// Returns `message` with the details which vary between samples hitting the
+// same bug removed: log prefixes, directories of paths, numbers and the
+// argument and value lines of miscompares. Lines are joined with " | " and the
+// result is truncated to a bounded length.
+std::string NormalizeErrorMessage(std::string_view message);
+
+// Returns the stage of a failure given its error message; see
+// CrasherSignature::stage.
+std::string GetFailingStage(std::string_view message);
+
+// Returns the sorted names of the ops in the IR at `ir_path`.
+absl::StatusOr<absl::btree_set<std::string>> GetIrOps(
+    const std::filesystem::path& ir_path);
+
+// Returns the signature of the sample failure `error` in `run_dir`. For tool
+// failures the last error line of the tool's stderr is used as the message, as
+// the error itself only names the tool and its command line. The ops are those
+// of the optimized IR if present, otherwise of the unoptimized IR; if neither
+// exists or parses (e.g. the failure precedes IR conversion) ops is empty.
+absl::StatusOr<CrasherSignature> GetCrasherSignature(
+    const absl::Status& error, const std::filesystem::path& run_dir);
+
+// The signatures of the crashers saved in a crasher directory, stored one per
+// line in the file kFileName in the directory. Not thread-safe; concurrent
+// workers sharing a crasher directory each load their own index, and may
+// occasionally both save a crasher for the same new bug.
+class CrasherIndex {
+ public:
+  static constexpr std::string_view kFileName = "signatures.txt";
+
+  // Loads the index of `crasher_dir`, which is empty if the directory has no
+  // index file yet.
+  static absl::StatusOr<CrasherIndex> Load(
+      const std::filesystem::path& crasher_dir);
+
+  // Returns the name of an indexed crasher which `signature` duplicates, if
+  // any. A crasher is duplicated by a failure in the same stage with the same
+  // normalized message whose IR contains all the ops of the crasher's IR.
+  std::optional<std::string> FindDuplicate(
+      const CrasherSignature& signature) const;
+
+  // Adds the crasher `crasher_name` with the given signature to the index and
+  // appends it to the index file.
+  absl::Status Add(std::string_view crasher_name,
+                   const CrasherSignature& signature);
+
+  int64_t size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    std::string crasher_name;
+    CrasherSignature signature;
+  };
+
+  explicit CrasherIndex(std::filesystem::path path) : path_(std::move(path)) {}
+
+  std::filesystem::path path_;
+  std::vector<Entry> entries_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_CRASHER_INDEX_H_
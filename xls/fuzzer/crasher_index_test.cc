@@ -0,0 +1,158 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/fuzzer/crasher_index.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Optional;
+
+constexpr std::string_view kSampleIr = R"(
+package sample
+
+top fn main(x: bits[8], y: bits[8]) -> bits[8] {
+  add.3: bits[8] = add(x, y, id=3)
+  ret neg.4: bits[8] = neg(add.3, id=4)
+}
+)";
+
+TEST(CrasherIndexTest, NormalizeErrorMessage) {
+  EXPECT_EQ(NormalizeErrorMessage(
+                "F1014 12:34:56.789012  1234 /tmp/xls/ir/node.cc:56] Check "
+                "failed: add.123 has width 8\n"),
+            "node.cc:N] Check failed: add.N has width N");
+  EXPECT_EQ(NormalizeErrorMessage("value  0x1f\tis   bad"), "value 0xN is bad");
+  EXPECT_EQ(NormalizeErrorMessage(
+                "SampleError: Result miscompare for sample 3:\n"
+                "args: bits[8]:0x1; bits[8]:0x2\n"
+                "evaluated opt IR (JIT) =\n   bits[8]:0x3\n"
+                "interpreted DSLX =\n   bits[8]:0x4"),
+            "SampleError: Result miscompare for sample N: | "
+            "evaluated opt IR (JIT) = | interpreted DSLX =");
+  EXPECT_EQ(NormalizeErrorMessage(std::string(4096, 'x')).size(), 512);
+}
+
+TEST(CrasherIndexTest, GetFailingStage) {
+  EXPECT_EQ(GetFailingStage("/runfiles/xls/tools/opt_main returned non-zero "
+                            "exit status (1): opt_main sample.ir"),
+            "opt_main");
+  EXPECT_EQ(GetFailingStage("Subprocess call failed: /path/to/codegen_main "
+                            "--delay_model=unit sample.opt.ir"),
+            "codegen_main");
+  EXPECT_EQ(GetFailingStage("Subprocess call timed out after 30 seconds: "
+                            "/path/to/eval_ir_main sample.ir"),
+            "eval_ir_main");
+  EXPECT_EQ(GetFailingStage("SampleError: Result miscompare for sample 0:"),
+            "miscompare");
+  EXPECT_EQ(GetFailingStage("Unable to parse args batch"), "sample");
+}
+
+TEST(CrasherIndexTest, GetCrasherSignatureOfToolFailure) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / "sample.ir", kSampleIr));
+  XLS_ASSERT_OK(SetFileContents(
+      temp_dir.path() / "opt_main.stderr",
+      "I1014 12:00:00.000000  42 opt_main.cc:10] Running passes\n"
+      "F1014 12:00:01.000000  42 bdd_cse_pass.cc:77] Check failed: "
+      "node.2 != nullptr\n"
+      "*** Check failure stack trace: ***\n"
+      "    @     0x55d0c1000000  xls::Foo()\n"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CrasherSignature signature,
+      GetCrasherSignature(
+          absl::InternalError("/runfiles/opt_main returned non-zero exit "
+                              "status (134): /runfiles/opt_main sample.ir"),
+          temp_dir.path()));
+  EXPECT_EQ(signature.stage, "opt_main");
+  EXPECT_EQ(signature.message,
+            "bdd_cse_pass.cc:N] Check failed: node.N != nullptr");
+  EXPECT_THAT(signature.ops, ElementsAre("add", "neg", "param"));
+}
+
+TEST(CrasherIndexTest, GetCrasherSignatureWithoutIr) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CrasherSignature signature,
+      GetCrasherSignature(
+          absl::InternalError("/runfiles/ir_converter_main returned non-zero "
+                              "exit status (1): ir_converter_main sample.x"),
+          temp_dir.path()));
+  EXPECT_EQ(signature.stage, "ir_converter_main");
+  EXPECT_EQ(signature.message,
+            "ir_converter_main returned non-zero exit status (N)");
+  EXPECT_TRUE(signature.ops.empty());
+}
+
+TEST(CrasherIndexTest, FindsDuplicatesAcrossLoads) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  CrasherSignature minimized{.stage = "opt_main",
+                             .message = "Check failed: node.N != nullptr",
+                             .ops = {"add", "param"}};
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(CrasherIndex index,
+                             CrasherIndex::Load(temp_dir.path()));
+    EXPECT_EQ(index.size(), 0);
+    XLS_ASSERT_OK(index.Add("0123abcd", minimized));
+    EXPECT_EQ(index.size(), 1);
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(CrasherIndex index,
+                           CrasherIndex::Load(temp_dir.path()));
+  ASSERT_EQ(index.size(), 1);
+  CrasherSignature sample = minimized;
+  sample.ops.insert("neg");
+  EXPECT_THAT(index.FindDuplicate(minimized),
+              Optional(std::string("0123abcd")));
+  EXPECT_THAT(index.FindDuplicate(sample), Optional(std::string("0123abcd")));
+
+  CrasherSignature missing_op = sample;
+  missing_op.ops.erase("add");
+  EXPECT_EQ(index.FindDuplicate(missing_op), std::nullopt);
+  CrasherSignature other_stage = sample;
+  other_stage.stage = "codegen_main";
+  EXPECT_EQ(index.FindDuplicate(other_stage), std::nullopt);
+  CrasherSignature other_message = sample;
+  other_message.message = "Check failed: width > N";
+  EXPECT_EQ(index.FindDuplicate(other_message), std::nullopt);
+}
+
+TEST(CrasherIndexTest, IgnoresMalformedLines) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / CrasherIndex::kFileName,
+                                "garbage\n"
+                                "0123abcd\tmiscompare\t\tResult miscompare\n"));
+  XLS_ASSERT_OK_AND_ASSIGN(CrasherIndex index,
+                           CrasherIndex::Load(temp_dir.path()));
+  EXPECT_EQ(index.size(), 1);
+  EXPECT_THAT(index.FindDuplicate(CrasherSignature{
+                  .stage = "miscompare", .message = "Result miscompare"}),
+              Optional(std::string("0123abcd")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -22,8 +22,10 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/container/btree_set.h"
 #include "absl/log/log.h"
 #include "absl/random/bit_gen_ref.h"
 #include "absl/status/status.h"
@@ -44,6 +46,7 @@
 #include "xls/common/subprocess.h"
 #include "xls/fuzzer/ast_generator.h"
 #include "xls/fuzzer/cpp_run_fuzz.h"
+#include "xls/fuzzer/crasher_index.h"
 #include "xls/fuzzer/sample.h"
 #include "xls/fuzzer/sample_generator.h"
 #include "xls/fuzzer/sample_runner.h"
@@ -248,37 +251,48 @@ absl::Status RunSample(const Sample& smp, const std::filesystem::path& run_dir,
   return absl::OkStatus();
 }
 
-absl::StatusOr<Sample> GenerateSampleAndRun(
-    absl::BitGenRef bit_gen,
-    const dslx::AstGeneratorOptions& ast_generator_options,
-    const SampleOptions& sample_options, const std::filesystem::path& run_dir,
+absl::Status RunSampleAndSaveCrasher(
+    const Sample& smp, const std::filesystem::path& run_dir,
     const std::optional<std::filesystem::path>& crasher_dir,
     const std::optional<std::filesystem::path>& summary_file,
+    std::optional<absl::Duration> generate_sample_elapsed,
     bool force_failure) {
-  Stopwatch stopwatch;
-  XLS_ASSIGN_OR_RETURN(Sample smp, GenerateSample(ast_generator_options,
-                                                  sample_options, bit_gen));
-  absl::Duration generate_sample_elapsed = stopwatch.GetElapsedTime();
-
   absl::Status status =
       RunSample(smp, run_dir, summary_file, generate_sample_elapsed);
   if (force_failure) {
     status = absl::InternalError("Forced sample failure.");
   }
   if (status.ok()) {
-    return smp;
+    return status;
   }
 
   LOG(ERROR) << "Sample failed: " << status;
   if (crasher_dir.has_value()) {
+    // Failures matching an already saved crasher are most likely the same bug,
+    // so they are neither saved nor minimized again. Forced failures are not
+    // bugs and are always saved without being indexed.
+    std::optional<CrasherIndex> index;
+    std::optional<CrasherSignature> signature;
+    if (!force_failure) {
+      XLS_ASSIGN_OR_RETURN(index, CrasherIndex::Load(*crasher_dir));
+      XLS_ASSIGN_OR_RETURN(signature, GetCrasherSignature(status, run_dir));
+      if (std::optional<std::string> duplicate =
+              index->FindDuplicate(*signature);
+          duplicate.has_value()) {
+        LOG(INFO) << "Sample failure matches saved crasher " << *duplicate
+                  << "; not saving it.";
+        return status;
+      }
+    }
+
     XLS_ASSIGN_OR_RETURN(std::filesystem::path sample_crasher_dir,
                          SaveCrasher(run_dir, smp, status, *crasher_dir));
     if (!absl::IsDeadlineExceeded(status)) {
       LOG(INFO) << "Attempting to minimize IR...";
       std::optional<absl::Duration> timeout =
-          sample_options.timeout_seconds().has_value()
+          smp.options().timeout_seconds().has_value()
               ? std::optional<absl::Duration>(
-                    absl::Seconds(*sample_options.timeout_seconds()))
+                    absl::Seconds(*smp.options().timeout_seconds()))
               : std::nullopt;
       XLS_ASSIGN_OR_RETURN(
           std::optional<std::filesystem::path> minimized_path,
@@ -288,12 +302,47 @@ absl::StatusOr<Sample> GenerateSampleAndRun(
         LOG(INFO) << "...minimization successful; output at "
                   << *minimized_path;
         std::filesystem::copy(*minimized_path, sample_crasher_dir);
+        // Index the crasher by the ops needed to reproduce it so that later
+        // samples with the same failure match it whatever else they contain.
+        if (signature.has_value()) {
+          absl::StatusOr<absl::btree_set<std::string>> ops =
+              GetIrOps(*minimized_path);
+          if (ops.ok()) {
+            signature->ops = *std::move(ops);
+          } else {
+            LOG(WARNING) << "Unable to get the ops of the minimized IR: "
+                         << ops.status();
+          }
+        }
       } else {
         LOG(INFO) << "...minimization failed.";
       }
     }
+    if (index.has_value()) {
+      XLS_RETURN_IF_ERROR(
+          index->Add(sample_crasher_dir.filename().string(), *signature));
+    }
   }
   return status;
 }
 
+absl::StatusOr<Sample> GenerateSampleAndRun(
+    absl::BitGenRef bit_gen,
+    const dslx::AstGeneratorOptions& ast_generator_options,
+    const SampleOptions& sample_options, const std::filesystem::path& run_dir,
+    const std::optional<std::filesystem::path>& crasher_dir,
+    const std::optional<std::filesystem::path>& summary_file,
+    bool force_failure) {
+  Stopwatch stopwatch;
+  XLS_ASSIGN_OR_RETURN(Sample smp, GenerateSample(ast_generator_options,
+                                                  sample_options, bit_gen));
+  absl::Duration generate_sample_elapsed = stopwatch.GetElapsedTime();
+
+  XLS_RETURN_IF_ERROR(RunSampleAndSaveCrasher(smp, run_dir, crasher_dir,
+                                              summary_file,
+                                              generate_sample_elapsed,
+                                              force_failure));
+  return smp;
+}
+
 }  // namespace xls
@@ -37,6 +37,19 @@ absl::Status RunSample(
     const std::optional<std::filesystem::path>& summary_file = std::nullopt,
     std::optional<absl::Duration> generate_sample_elapsed = std::nullopt);
 
+// Runs the given sample as RunSample does. If the sample fails (or
+// `force_failure` is true) and `crasher_dir` is given, the run directory is
+// saved as a crasher in `crasher_dir` along with a minimized IR reproducer.
+// Failures whose signature (see CrasherSignature) matches a crasher already
+// indexed in `crasher_dir` are not saved again. Returns the status of the
+// sample run.
+absl::Status RunSampleAndSaveCrasher(
+    const Sample& smp, const std::filesystem::path& run_dir,
+    const std::optional<std::filesystem::path>& crasher_dir = std::nullopt,
+    const std::optional<std::filesystem::path>& summary_file = std::nullopt,
+    std::optional<absl::Duration> generate_sample_elapsed = std::nullopt,
+    bool force_failure = false);
+
 absl::StatusOr<Sample> GenerateSampleAndRun(
     absl::BitGenRef bit_gen,
     const dslx::AstGeneratorOptions& ast_generator_options,
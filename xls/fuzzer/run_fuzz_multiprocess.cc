@@ -14,16 +14,23 @@
 
 #include "xls/fuzzer/run_fuzz_multiprocess.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <deque>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <random>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
+#include "absl/container/btree_set.h"
 #include "absl/log/log.h"
+#include "absl/random/bit_gen_ref.h"
 #include "absl/random/distributions.h"
 #include "absl/random/random.h"
 #include "absl/status/status.h"
@@ -31,7 +38,9 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/temp_directory.h"
 #include "xls/common/status/status_macros.h"
@@ -39,7 +48,11 @@
 #include "xls/common/thread.h"
 #include "xls/fuzzer/ast_generator.h"
 #include "xls/fuzzer/run_fuzz.h"
+#include "xls/fuzzer/dslx_mutator.h"
 #include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_feedback.h"
+#include "xls/fuzzer/sample_generator.h"
+#include "xls/fuzzer/sample_summary.pb.h"
 
 namespace xls {
 namespace {
@@ -48,78 +61,302 @@ static constexpr std::string_view kBlueText = "\033[34m";
 static constexpr std::string_view kRedText = "\033[31m";
 static constexpr std::string_view kDefaultColor = "\033[0m";
 
-absl::Status GenerateAndRunSamples(
-    int64_t worker_number,
+// Number of samples a generator produces between updates of the expression
+// weights from coverage feedback.
+constexpr int64_t kFeedbackUpdateInterval = 16;
+
+// Probability that a generator mutates a sample from the feedback corpus rather
+// than generating a new sample.
+constexpr double kMutationProbability = 0.25;
+
+// Number of attempts at mutating a corpus sample into a valid sample before
+// generating a new sample instead.
+constexpr int64_t kMutationAttempts = 8;
+
+struct GeneratedSample {
+  Sample sample;
+  // Name of the sample's run directory if run directories are kept.
+  std::string name;
+  absl::Duration generate_elapsed;
+  absl::btree_map<std::string, int64_t> expr_kind_counts;
+};
+
+// Mutates a random sample from the corpus of `feedback`. Returns std::nullopt
+// if the corpus is empty or no valid mutation was found.
+std::optional<std::pair<Sample, absl::btree_map<std::string, int64_t>>>
+MutateCorpusSample(const SampleFeedback& feedback, absl::BitGenRef bit_gen) {
+  std::optional<SampleFeedback::CorpusEntry> entry =
+      feedback.ChooseCorpusEntry(bit_gen);
+  if (!entry.has_value()) {
+    return std::nullopt;
+  }
+  for (int64_t i = 0; i < kMutationAttempts; ++i) {
+    absl::StatusOr<std::string> mutated =
+        dslx::RemoveDslxToken(entry->sample.input_text(), bit_gen);
+    if (!mutated.ok()) {
+      return std::nullopt;
+    }
+    absl::StatusOr<Sample> sample =
+        GenerateSampleForDslx(*mutated, entry->sample.options(), bit_gen);
+    if (sample.ok()) {
+      return std::make_pair(*std::move(sample),
+                            std::move(entry->expr_kind_counts));
+    }
+  }
+  return std::nullopt;
+}
+
+// A bounded queue of generated samples waiting to be run. Runner threads take
+// the next sample as soon as they are free so slow samples (e.g., those which
+// spend a long time in simulation) never leave other runners idle.
+class SampleQueue {
+ public:
+  explicit SampleQueue(int64_t capacity) : capacity_(capacity) {}
+
+  // Blocks until there is room in the queue. Returns false if the queue was
+  // closed, in which case the sample is dropped.
+  bool Push(GeneratedSample sample) {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(this, &SampleQueue::CanPush));
+    if (closed_) {
+      return false;
+    }
+    samples_.push_back(std::move(sample));
+    return true;
+  }
+
+  // Blocks until a sample is available. Returns std::nullopt once the queue is
+  // closed and empty.
+  std::optional<GeneratedSample> Pop() {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(this, &SampleQueue::CanPop));
+    if (samples_.empty()) {
+      return std::nullopt;
+    }
+    GeneratedSample sample = std::move(samples_.front());
+    samples_.pop_front();
+    return sample;
+  }
+
+  // Rejects further samples. Samples already in the queue can still be popped.
+  void Close() {
+    absl::MutexLock lock(&mutex_);
+    closed_ = true;
+  }
+
+ private:
+  bool CanPush() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return closed_ || samples_.size() < capacity_;
+  }
+  bool CanPop() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return closed_ || !samples_.empty();
+  }
+
+  const int64_t capacity_;
+  mutable absl::Mutex mutex_;
+  std::deque<GeneratedSample> samples_ ABSL_GUARDED_BY(mutex_);
+  bool closed_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+// Time accounting for a single thread of a pipeline stage.
+struct StageThreadStats {
+  int64_t samples = 0;
+  absl::Duration busy;
+  absl::Duration blocked;
+};
+
+fuzzer::PipelineStageSummaryProto SummarizeStage(
+    std::string_view stage, absl::Span<const StageThreadStats> stats,
+    absl::Duration wall) {
+  fuzzer::PipelineStageSummaryProto summary;
+  summary.set_stage(stage);
+  summary.set_worker_count(stats.size());
+  int64_t samples = 0;
+  absl::Duration busy;
+  absl::Duration blocked;
+  for (const StageThreadStats& thread_stats : stats) {
+    samples += thread_stats.samples;
+    busy += thread_stats.busy;
+    blocked += thread_stats.blocked;
+  }
+  summary.set_samples(samples);
+  summary.set_busy_ns(absl::ToInt64Nanoseconds(busy));
+  summary.set_blocked_ns(absl::ToInt64Nanoseconds(blocked));
+  summary.set_wall_ns(absl::ToInt64Nanoseconds(wall));
+  LOG(INFO) << absl::StreamFormat(
+      "--- Stage %s: %d samples on %d threads; %.2f samples/s; %.1f%% busy, "
+      "%.1f%% blocked",
+      stage, samples, stats.size(),
+      static_cast<double>(samples) / absl::ToDoubleSeconds(wall),
+      100.0 * absl::FDivDuration(busy, wall * stats.size()),
+      100.0 * absl::FDivDuration(blocked, wall * stats.size()));
+  return summary;
+}
+
+// Generates up to `sample_count` samples (unbounded if unspecified) and pushes
+// them onto `queue` until `duration` has elapsed or the queue is closed.
+//
+// If `feedback` is given, the expression weights of the generator are
+// periodically updated from it and some samples are mutations of samples in
+// its corpus.
+absl::Status GenerateSamples(
+    int64_t generator_number,
     const dslx::AstGeneratorOptions& ast_generator_options,
     const SampleOptions& sample_options, const std::optional<uint64_t>& seed,
-    const std::optional<std::filesystem::path>& top_run_dir,
-    const std::optional<std::filesystem::path>& crasher_dir,
-    const std::optional<std::filesystem::path>& summary_dir,
     std::optional<int64_t> sample_count,
-    const std::optional<absl::Duration>& duration, bool force_failure) {
-  int64_t crashers = 0;
-  LOG(INFO) << "--- Started worker " << worker_number;
+    const std::optional<absl::Duration>& duration,
+    const SampleFeedback* feedback, SampleQueue& queue,
+    StageThreadStats& stats) {
   Stopwatch stopwatch;
-
-  std::optional<std::filesystem::path> summary_file;
-  if (summary_dir.has_value()) {
-    summary_file =
-        *summary_dir / absl::StrCat("summary_", worker_number, ".binarypb");
-  }
-
   uint64_t rng_seed;
   if (seed.has_value()) {
-    // Set seed deterministically based on the worker number so different
-    // workers generate different samples.
-    rng_seed = *seed + worker_number;
+    // Set seed deterministically based on the generator number so different
+    // generators generate different samples.
+    rng_seed = *seed + generator_number;
   } else {
     // Choose a nondeterministic seed.
     rng_seed = absl::Uniform<uint64_t>(absl::BitGen());
-    LOG(INFO) << kBlueText << "--- NOTE: Worker #" << worker_number
+    LOG(INFO) << kBlueText << "--- NOTE: Generator #" << generator_number
               << " chose a nondeterministic seed for value generation: "
               << absl::StreamFormat("0x%16X", rng_seed) << kDefaultColor;
   }
   std::mt19937_64 rng{rng_seed};
 
-  int64_t sample = 0;
+  dslx::AstGeneratorOptions generator_options = ast_generator_options;
+  for (int64_t sample = 0;
+       !sample_count.has_value() || sample < *sample_count; ++sample) {
+    if (duration.has_value() && stopwatch.GetElapsedTime() >= *duration) {
+      break;
+    }
+    Stopwatch generate_stopwatch;
+    absl::btree_map<std::string, int64_t> expr_kind_counts;
+    std::optional<absl::StatusOr<Sample>> smp;
+    if (feedback != nullptr) {
+      if (sample % kFeedbackUpdateInterval == 0) {
+        generator_options.expr_weight_scales = feedback->GetExprWeightScales();
+        VLOG(1) << absl::StreamFormat(
+            "--- Generator #%d: expression weight scales: %s",
+            generator_number,
+            absl::StrJoin(generator_options.expr_weight_scales, ", ",
+                          absl::PairFormatter("=")));
+      }
+      if (absl::Bernoulli(rng, kMutationProbability)) {
+        if (auto mutated = MutateCorpusSample(*feedback, rng);
+            mutated.has_value()) {
+          smp = std::move(mutated->first);
+          expr_kind_counts = std::move(mutated->second);
+        }
+      }
+    }
+    if (!smp.has_value()) {
+      smp = GenerateSample(generator_options, sample_options, rng,
+                           feedback == nullptr ? nullptr : &expr_kind_counts);
+    }
+    absl::Duration generate_elapsed = generate_stopwatch.GetElapsedTime();
+    stats.busy += generate_elapsed;
+    if (!smp->ok()) {
+      LOG(ERROR) << kRedText
+                 << absl::StreamFormat(
+                        "--- Generator #%d failed to generate sample %d: %s",
+                        generator_number, sample, smp->status().ToString())
+                 << kDefaultColor;
+      continue;
+    }
+    Stopwatch push_stopwatch;
+    bool pushed = queue.Push(GeneratedSample{
+        .sample = **std::move(smp),
+        .name = absl::StrFormat("worker%d-sample%d", generator_number, sample),
+        .generate_elapsed = generate_elapsed,
+        .expr_kind_counts = std::move(expr_kind_counts),
+    });
+    stats.blocked += push_stopwatch.GetElapsedTime();
+    if (!pushed) {
+      break;
+    }
+    ++stats.samples;
+  }
+  return absl::OkStatus();
+}
+
+// Runs samples taken from `queue` until the queue is exhausted or `duration`
+// has elapsed. If `feedback` is given, the features exercised by each passing
+// sample are recorded in it.
+absl::Status RunSamples(int64_t runner_number,
+                        const std::optional<std::filesystem::path>& top_run_dir,
+                        const std::optional<std::filesystem::path>& crasher_dir,
+                        const std::optional<std::filesystem::path>& summary_dir,
+                        const std::optional<absl::Duration>& duration,
+                        bool force_failure, SampleFeedback* feedback,
+                        SampleQueue& queue, StageThreadStats& stats) {
+  int64_t crashers = 0;
+  LOG(INFO) << "--- Started runner " << runner_number;
+  Stopwatch stopwatch;
+
+  std::optional<std::filesystem::path> summary_file;
+  if (summary_dir.has_value()) {
+    summary_file =
+        *summary_dir / absl::StrCat("summary_", runner_number, ".binarypb");
+  }
+
   while (true) {
+    absl::Duration elapsed = stopwatch.GetElapsedTime();
+    if (duration.has_value() && elapsed >= *duration) {
+      LOG(INFO) << absl::StreamFormat("--- Runner #%d: Ran for %s. Exiting.",
+                                      runner_number,
+                                      absl::FormatDuration(elapsed));
+      // Release any generators waiting for room in the queue.
+      queue.Close();
+      break;
+    }
+    Stopwatch pop_stopwatch;
+    std::optional<GeneratedSample> generated = queue.Pop();
+    stats.blocked += pop_stopwatch.GetElapsedTime();
+    if (!generated.has_value()) {
+      break;
+    }
+
+    Stopwatch run_stopwatch;
     std::filesystem::path run_dir;
     std::optional<TempDirectory> temp_run_dir;
     if (top_run_dir.has_value()) {
-      run_dir = *top_run_dir /
-                absl::StrFormat("worker%d-sample%d", worker_number, sample);
+      run_dir = *top_run_dir / generated->name;
       XLS_RETURN_IF_ERROR(RecursivelyCreateDir(run_dir));
     } else {
       XLS_ASSIGN_OR_RETURN(temp_run_dir, TempDirectory::Create());
       run_dir = temp_run_dir->path();
     }
 
-    absl::Status sample_status =
-        GenerateSampleAndRun(rng, ast_generator_options, sample_options,
-                             run_dir, crasher_dir, summary_file, force_failure)
-            .status();
+    absl::Status sample_status = RunSampleAndSaveCrasher(
+        generated->sample, run_dir, crasher_dir, summary_file,
+        generated->generate_elapsed, force_failure);
     if (!sample_status.ok()) {
       LOG(INFO) << kRedText
                 << absl::StreamFormat(
-                       "--- Worker #%d noted crasher #%d for sample number %d",
-                       worker_number, crashers, sample)
+                       "--- Runner #%d noted crasher #%d for sample %s",
+                       runner_number, crashers, generated->name)
                 << kDefaultColor;
       crashers++;
+    } else if (feedback != nullptr) {
+      absl::StatusOr<absl::btree_set<std::string>> features =
+          GetSampleFeatures(run_dir);
+      if (features.ok()) {
+        feedback->Record(generated->sample, generated->expr_kind_counts,
+                         *features);
+      } else {
+        LOG(ERROR) << "Failed to get coverage features of sample "
+                   << generated->name << ": " << features.status();
+      }
     }
+    stats.busy += run_stopwatch.GetElapsedTime();
+    ++stats.samples;
 
-    absl::Duration elapsed = stopwatch.GetElapsedTime();
-    if (sample > 0 && sample % 16 == 0) {
+    if (stats.samples % 16 == 0) {
+      elapsed = stopwatch.GetElapsedTime();
       std::vector<std::string> metrics;
-      metrics.reserve(3);
-      if (sample_count.has_value()) {
-        metrics.push_back(
-            absl::StrFormat("%d/%d samples", sample, *sample_count));
-      } else {
-        metrics.push_back(absl::StrCat(sample, " samples"));
-      }
+      metrics.reserve(2);
       metrics.push_back(absl::StrFormat(
-          "%.2f samples/s",
-          static_cast<double>(sample) / absl::ToDoubleSeconds(elapsed)));
+          "%d samples, %.2f samples/s", stats.samples,
+          static_cast<double>(stats.samples) / absl::ToDoubleSeconds(elapsed)));
       if (duration.has_value()) {
         metrics.push_back(absl::StrFormat("running for %s (limit %s)",
                                           absl::FormatDuration(elapsed),
@@ -128,30 +365,17 @@ absl::Status GenerateAndRunSamples(
         metrics.push_back(
             absl::StrFormat("running for %s", absl::FormatDuration(elapsed)));
       }
-      LOG(INFO) << absl::StreamFormat("--- Worker #%d: %s", worker_number,
+      LOG(INFO) << absl::StreamFormat("--- Runner #%d: %s", runner_number,
                                       absl::StrJoin(metrics, ", "));
     }
-
-    if (duration.has_value() && elapsed >= *duration) {
-      LOG(INFO) << absl::StreamFormat("--- Worker #%d: Ran for %s. Exiting.",
-                                      worker_number,
-                                      absl::FormatDuration(elapsed));
-      break;
-    }
-    ++sample;
-    if (sample_count.has_value() && sample >= *sample_count) {
-      LOG(INFO) << absl::StreamFormat(
-          "--- Worker #%d: Ran %d samples. Exiting.", worker_number, sample);
-      break;
-    }
   }
 
   absl::Duration elapsed = stopwatch.GetElapsedTime();
   LOG(INFO) << absl::StreamFormat(
-      "--- Worker #%d finished! %d samples; %d crashers; %.2f samples/s; ran "
+      "--- Runner #%d finished! %d samples; %d crashers; %.2f samples/s; ran "
       "for %s",
-      worker_number, sample, crashers,
-      static_cast<double>(sample) / absl::ToDoubleSeconds(elapsed),
+      runner_number, stats.samples, crashers,
+      static_cast<double>(stats.samples) / absl::ToDoubleSeconds(elapsed),
       absl::FormatDuration(elapsed));
   return absl::OkStatus();
 }
@@ -166,32 +390,86 @@ absl::Status ParallelGenerateAndRunSamples(
     const std::optional<std::filesystem::path>& crasher_dir,
     const std::optional<std::filesystem::path>& summary_dir,
     std::optional<int64_t> sample_count, std::optional<absl::Duration> duration,
-    bool force_failure) {
-  std::vector<std::unique_ptr<Thread>> workers;
-  workers.resize(worker_count);
-  std::vector<absl::Status> worker_status;
-  worker_status.resize(workers.size(),
-                       absl::InternalError("worker did not terminate."));
-  for (int64_t i = 0; i < workers.size(); ++i) {
-    std::optional<int64_t> worker_sample_count =
+    bool force_failure, std::optional<int64_t> generator_count,
+    bool coverage_feedback) {
+  int64_t generators =
+      generator_count.value_or(std::max<int64_t>(1, (worker_count + 7) / 8));
+  SampleQueue queue(/*capacity=*/2 * worker_count);
+  std::optional<SampleFeedback> feedback;
+  SampleOptions generator_sample_options = sample_options;
+  if (coverage_feedback) {
+    feedback.emplace();
+    generator_sample_options.set_record_pass_profile(true);
+  }
+  SampleFeedback* feedback_ptr = feedback.has_value() ? &*feedback : nullptr;
+
+  struct Stage {
+    std::vector<std::unique_ptr<Thread>> threads;
+    std::vector<absl::Status> status;
+    std::vector<StageThreadStats> stats;
+    Stopwatch stopwatch;
+    absl::Duration wall;
+
+    explicit Stage(int64_t thread_count)
+        : threads(thread_count),
+          status(thread_count,
+                 absl::InternalError("worker did not terminate.")),
+          stats(thread_count) {}
+
+    void Join(std::string_view name) {
+      for (int64_t i = 0; i < threads.size(); ++i) {
+        LOG(INFO) << "-- Waiting on " << name << " " << i;
+        threads[i]->Join();
+        if (!status[i].ok()) {
+          LOG(ERROR) << kRedText << "-- " << name << " #" << i
+                     << " failed: " << status[i] << kDefaultColor;
+        }
+      }
+      wall = stopwatch.GetElapsedTime();
+    }
+  };
+
+  Stage run_stage(worker_count);
+  for (int64_t i = 0; i < worker_count; ++i) {
+    run_stage.threads[i] = std::make_unique<Thread>([&, i] {
+      run_stage.status[i] =
+          RunSamples(i, top_run_dir, crasher_dir, summary_dir, duration,
+                     force_failure, feedback_ptr, queue, run_stage.stats[i]);
+    });
+  }
+  Stage generate_stage(generators);
+  for (int64_t i = 0; i < generators; ++i) {
+    std::optional<int64_t> generator_sample_count =
         sample_count.has_value()
-            ? std::make_optional((*sample_count + i) / worker_count)
+            ? std::make_optional((*sample_count + i) / generators)
             : std::nullopt;
-    workers[i] = std::make_unique<Thread>([&, i, worker_sample_count,
-                                           status = &worker_status[i]] {
-      *status =
-          GenerateAndRunSamples(i, ast_generator_options, sample_options, seed,
-                                top_run_dir, crasher_dir, summary_dir,
-                                worker_sample_count, duration, force_failure);
-    });
+    generate_stage.threads[i] =
+        std::make_unique<Thread>([&, i, generator_sample_count] {
+          generate_stage.status[i] = GenerateSamples(
+              i, ast_generator_options, generator_sample_options, seed,
+              generator_sample_count, duration, feedback_ptr, queue,
+              generate_stage.stats[i]);
+        });
   }
-  for (int64_t i = 0; i < workers.size(); ++i) {
-    LOG(INFO) << "-- Waiting on worker " << i;
-    workers[i]->Join();
-    if (!worker_status[i].ok()) {
-      LOG(ERROR) << kRedText << "-- Worker #" << i
-                 << " failed: " << worker_status[i] << kDefaultColor;
-    }
+
+  generate_stage.Join("generator");
+  // All samples have been generated; let the runners drain the queue.
+  queue.Close();
+  run_stage.Join("runner");
+
+  fuzzer::PipelineSummaryProto pipeline_summary;
+  *pipeline_summary.add_stages() =
+      SummarizeStage("generate", generate_stage.stats, generate_stage.wall);
+  *pipeline_summary.add_stages() =
+      SummarizeStage("run", run_stage.stats, run_stage.wall);
+  if (feedback.has_value()) {
+    LOG(INFO) << absl::StreamFormat(
+        "--- Coverage feedback: %d distinct features; %d samples in corpus",
+        feedback->feature_count(), feedback->corpus_size());
+  }
+  if (summary_dir.has_value()) {
+    XLS_RETURN_IF_ERROR(SetTextProtoFile(
+        *summary_dir / "pipeline_summary.pbtxt", pipeline_summary));
   }
   return absl::OkStatus();
 }
@@ -29,6 +29,18 @@ namespace xls {
 // Generate and run fuzzer samples on `worker_count` threads; runs up to
 // `sample_count` samples (unbounded if unspecified) for up to `duration` time.
 //
+// Samples are generated by `generator_count` separate threads (by default one
+// per eight workers) into a bounded queue from which each worker takes the
+// next sample as soon as it is free, so workers stuck on expensive samples
+// (e.g., long simulations) do not hold up the others. If `summary_dir` is
+// given, the throughput of each stage is written to
+// `pipeline_summary.pbtxt` in that directory as a PipelineSummaryProto.
+//
+// If `coverage_feedback` is true, the IR ops and optimization passes exercised
+// by each sample are tracked. Generation is biased toward the kinds of
+// expressions in samples which exercised rarely seen features, and some
+// samples are mutations of such samples (see SampleFeedback).
+//
 // Generates samples according to `ast_generator_options`, and runs them
 // according to `sample_options`. Uses a nondeterministic seed if `seed` is not
 // specified. Creates run directories in `top_run_dir` if specified; otherwise
@@ -47,7 +59,9 @@ absl::Status ParallelGenerateAndRunSamples(
     const std::optional<std::filesystem::path>& summary_dir = std::nullopt,
     std::optional<int64_t> sample_count = std::nullopt,
     std::optional<absl::Duration> duration = std::nullopt,
-    bool force_failure = false);
+    bool force_failure = false,
+    std::optional<int64_t> generator_count = std::nullopt,
+    bool coverage_feedback = false);
 
 }  // namespace xls
 
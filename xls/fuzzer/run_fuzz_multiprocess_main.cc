@@ -41,11 +41,18 @@ ABSL_FLAG(int64_t, calls_per_sample, 128, "Arguments to generate per sample.");
 ABSL_FLAG(std::optional<std::string>, crash_path, std::nullopt,
           "Path at which to place crash data.");
 ABSL_FLAG(bool, codegen, false, "Run code generation.");
+ABSL_FLAG(bool, coverage_feedback, false,
+          "Bias sample generation toward the kinds of expressions which "
+          "exercise rarely seen IR ops and optimization passes, and mutate "
+          "samples which exercised them.");
 ABSL_FLAG(bool, emit_loops, true, "Emit loops in generator.");
 ABSL_FLAG(
     bool, force_failure, false,
     "Forces the samples to fail. Can be used to test failure code paths.");
 ABSL_FLAG(bool, generate_proc, false, "Generate a proc sample.");
+ABSL_FLAG(std::optional<int64_t>, generator_count, std::nullopt,
+          "Number of threads generating samples for the workers to run; "
+          "defaults to one per eight workers.");
 ABSL_FLAG(int64_t, max_width_aggregate_types, 1024,
           "The maximum width of aggregate types (tuples and arrays) in the "
           "generated samples.");
@@ -53,6 +60,11 @@ ABSL_FLAG(int64_t, max_width_bits_types, 64,
           "The maximum width of bits types in the generated samples.");
 ABSL_FLAG(int64_t, proc_ticks, 100,
           "Number of ticks to execute the generated procs.");
+ABSL_FLAG(bool, run_in_process, false,
+          "Run IR conversion, optimization and IR function evaluation within "
+          "the worker processes rather than as subprocesses. Avoids process "
+          "startup cost but a crash in these stages takes down the worker "
+          "and timeouts are not enforced for them.");
 ABSL_FLAG(std::optional<int64_t>, sample_count, std::nullopt,
           "Number of samples to generate.");
 ABSL_FLAG(std::optional<std::string>, save_temps_path, std::nullopt,
@@ -91,12 +103,15 @@ struct Options {
   int64_t calls_per_sample;
   std::optional<std::filesystem::path> crash_path;
   bool codegen;
+  bool coverage_feedback;
   bool emit_loops;
   bool force_failure;
   bool generate_proc;
+  std::optional<int64_t> generator_count;
   int64_t max_width_aggregate_types;
   int64_t max_width_bits_types;
   int64_t proc_ticks;
+  bool run_in_process;
   std::optional<int64_t> sample_count;
   std::optional<std::filesystem::path> save_temps_path;
   std::optional<int64_t> seed;
@@ -158,6 +173,7 @@ absl::Status RealMain(const Options& options) {
   sample_options.set_sample_type(options.generate_proc
                                      ? fuzzer::SAMPLE_TYPE_PROC
                                      : fuzzer::SAMPLE_TYPE_FUNCTION);
+  sample_options.set_run_in_process(options.run_in_process);
   sample_options.set_simulate(options.simulate);
   if (options.simulator.has_value()) {
     sample_options.set_simulator(*options.simulator);
@@ -172,7 +188,8 @@ absl::Status RealMain(const Options& options) {
       worker_count, ast_generator_options, sample_options, options.seed,
       /*top_run_dir=*/options.save_temps_path,
       /*crasher_dir=*/options.crash_path, /*summary_dir=*/options.summary_path,
-      options.sample_count, options.duration, options.force_failure);
+      options.sample_count, options.duration, options.force_failure,
+      options.generator_count, options.coverage_feedback);
 }
 
 }  // namespace
@@ -198,13 +215,16 @@ int main(int argc, char** argv) {
       .calls_per_sample = absl::GetFlag(FLAGS_calls_per_sample),
       .crash_path = absl::GetFlag(FLAGS_crash_path),
       .codegen = absl::GetFlag(FLAGS_codegen),
+      .coverage_feedback = absl::GetFlag(FLAGS_coverage_feedback),
       .emit_loops = absl::GetFlag(FLAGS_emit_loops),
       .force_failure = absl::GetFlag(FLAGS_force_failure),
       .generate_proc = absl::GetFlag(FLAGS_generate_proc),
+      .generator_count = absl::GetFlag(FLAGS_generator_count),
       .max_width_aggregate_types =
           absl::GetFlag(FLAGS_max_width_aggregate_types),
       .max_width_bits_types = absl::GetFlag(FLAGS_max_width_bits_types),
       .proc_ticks = absl::GetFlag(FLAGS_proc_ticks),
+      .run_in_process = absl::GetFlag(FLAGS_run_in_process),
       .sample_count = absl::GetFlag(FLAGS_sample_count),
       .save_temps_path = absl::GetFlag(FLAGS_save_temps_path),
       .seed = absl::GetFlag(FLAGS_seed),
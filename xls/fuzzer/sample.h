@@ -138,6 +138,14 @@ class SampleOptions {
   int64_t proc_ticks() const { return proto_.proc_ticks(); }
   void set_proc_ticks(int64_t value) { proto_.set_proc_ticks(value); }
 
+  bool run_in_process() const { return proto_.run_in_process(); }
+  void set_run_in_process(bool value) { proto_.set_run_in_process(value); }
+
+  bool record_pass_profile() const { return proto_.record_pass_profile(); }
+  void set_record_pass_profile(bool value) {
+    proto_.set_record_pass_profile(value);
+  }
+
   const std::vector<KnownFailure>& known_failures() const {
     if (known_failures_.empty() && proto_.known_failure_size() > 0) {
       known_failures_.reserve(proto_.known_failure_size());
@@ -0,0 +1,181 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/sample_feedback.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/container/btree_map.h"
+#include "absl/container/btree_set.h"
+#include "absl/random/bit_gen_ref.h"
+#include "absl/random/distributions.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_runner.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/passes/pass_metrics.pb.h"
+
+namespace xls {
+namespace {
+
+// Weight of the newest sample in the moving averages of novelty.
+constexpr double kNoveltyDecay = 0.05;
+
+std::string TypeFeature(Type* type) {
+  if (!type->IsBits()) {
+    return TypeKindToString(type->kind());
+  }
+  int64_t width = type->GetFlatBitCount();
+  for (int64_t bucket : {0, 1, 8, 32, 64}) {
+    if (width <= bucket) {
+      return absl::StrCat("bits", bucket);
+    }
+  }
+  return "bits_wide";
+}
+
+absl::Status AddIrFeatures(const std::filesystem::path& ir_path,
+                           std::string_view prefix,
+                           absl::btree_set<std::string>& features) {
+  if (!FileExists(ir_path).ok()) {
+    return absl::OkStatus();
+  }
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text, ir_path.string()));
+  for (FunctionBase* fb : package->GetFunctionBases()) {
+    for (Node* node : fb->nodes()) {
+      features.insert(absl::StrCat(prefix, ":", OpToString(node->op()), ":",
+                                   TypeFeature(node->GetType())));
+    }
+  }
+  return absl::OkStatus();
+}
+
+void UpdateNovelty(double novelty, int64_t& samples, double& average) {
+  average = samples == 0 ? novelty
+                         : (1.0 - kNoveltyDecay) * average +
+                               kNoveltyDecay * novelty;
+  ++samples;
+}
+
+}  // namespace
+
+absl::StatusOr<absl::btree_set<std::string>> GetSampleFeatures(
+    const std::filesystem::path& run_dir) {
+  absl::btree_set<std::string> features;
+  XLS_RETURN_IF_ERROR(AddIrFeatures(run_dir / "sample.ir", "ir", features));
+  XLS_RETURN_IF_ERROR(
+      AddIrFeatures(run_dir / "sample.opt.ir", "opt_ir", features));
+  std::filesystem::path profile_path =
+      run_dir / SampleRunner::kPassProfileFileName;
+  if (FileExists(profile_path).ok()) {
+    PassPipelineProfileProto profile;
+    XLS_RETURN_IF_ERROR(ParseTextProtoFile(profile_path, &profile));
+    for (const PassProfileProto& pass : profile.passes()) {
+      if (pass.changed_count() > 0) {
+        features.insert(absl::StrCat("pass:", pass.pass_name()));
+      }
+    }
+  }
+  return features;
+}
+
+bool SampleFeedback::Record(
+    const Sample& sample,
+    const absl::btree_map<std::string, int64_t>& expr_kind_counts,
+    const absl::btree_set<std::string>& features) {
+  absl::MutexLock lock(&mutex_);
+  // Features seen n times before contribute 1/(n+1) to the novelty of the
+  // sample.
+  double novelty = 0.0;
+  bool rare = false;
+  for (const std::string& feature : features) {
+    int64_t& count = feature_counts_[feature];
+    novelty += 1.0 / static_cast<double>(count + 1);
+    rare |= count < kRareFeatureCount;
+    ++count;
+  }
+  UpdateNovelty(novelty, all_stats_.samples, all_stats_.novelty);
+  for (const auto& [kind, count] : expr_kind_counts) {
+    if (count > 0) {
+      KindStats& stats = kind_stats_[kind];
+      UpdateNovelty(novelty, stats.samples, stats.novelty);
+    }
+  }
+  if (!rare) {
+    return false;
+  }
+  if (corpus_.size() >= max_corpus_size_) {
+    corpus_.pop_front();
+  }
+  corpus_.push_back(CorpusEntry{.sample = sample,
+                                .expr_kind_counts = expr_kind_counts});
+  return true;
+}
+
+absl::btree_map<std::string, double> SampleFeedback::GetExprWeightScales()
+    const {
+  absl::MutexLock lock(&mutex_);
+  absl::btree_map<std::string, double> scales;
+  if (all_stats_.novelty <= 0.0) {
+    return scales;
+  }
+  for (const auto& [kind, stats] : kind_stats_) {
+    if (stats.samples < kMinKindSamples) {
+      continue;
+    }
+    scales[kind] = std::clamp(stats.novelty / all_stats_.novelty,
+                              kMinWeightScale, kMaxWeightScale);
+  }
+  return scales;
+}
+
+std::optional<SampleFeedback::CorpusEntry> SampleFeedback::ChooseCorpusEntry(
+    absl::BitGenRef bit_gen) const {
+  absl::MutexLock lock(&mutex_);
+  if (corpus_.empty()) {
+    return std::nullopt;
+  }
+  return corpus_[absl::Uniform<size_t>(bit_gen, 0, corpus_.size())];
+}
+
+int64_t SampleFeedback::corpus_size() const {
+  absl::MutexLock lock(&mutex_);
+  return corpus_.size();
+}
+
+int64_t SampleFeedback::feature_count() const {
+  absl::MutexLock lock(&mutex_);
+  return feature_counts_.size();
+}
+
+}  // namespace xls
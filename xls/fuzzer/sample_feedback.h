@@ -0,0 +1,110 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_SAMPLE_FEEDBACK_H_
+#define XLS_FUZZER_SAMPLE_FEEDBACK_H_
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
+#include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/random/bit_gen_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/fuzzer/sample.h"
+
+namespace xls {
+
+// Returns the coverage features exercised by the sample run in `run_dir`:
+//   * "ir:<op>:<type>" for each kind of node in the unoptimized IR,
+//   * "opt_ir:<op>:<type>" for each kind of node in the optimized IR, and
+//   * "pass:<name>" for each optimization pass which changed the IR, if the
+//     sample was run with a pass profile.
+// <type> is "bits<N>" with N bucketed by size, "array", "tuple" or "token".
+absl::StatusOr<absl::btree_set<std::string>> GetSampleFeatures(
+    const std::filesystem::path& run_dir);
+
+// Coverage feedback accumulated over the samples of a fuzzing run. Samples
+// which exercise rarely seen features are kept in a corpus for mutation, and
+// the expression kinds of the AST generator are weighted by how often samples
+// containing them exercised rare features. Thread-safe.
+class SampleFeedback {
+ public:
+  struct CorpusEntry {
+    Sample sample;
+    // Number of expressions of each kind generated in the sample (or in the
+    // sample it was mutated from).
+    absl::btree_map<std::string, int64_t> expr_kind_counts;
+  };
+
+  // A sample exercising a feature which was seen fewer than this many times
+  // before is added to the corpus.
+  static constexpr int64_t kRareFeatureCount = 2;
+
+  // Minimum number of samples containing an expression kind before its weight
+  // is scaled.
+  static constexpr int64_t kMinKindSamples = 8;
+
+  // Bounds of the weight scales returned by GetExprWeightScales.
+  static constexpr double kMinWeightScale = 0.25;
+  static constexpr double kMaxWeightScale = 4.0;
+
+  explicit SampleFeedback(int64_t max_corpus_size = 256)
+      : max_corpus_size_(max_corpus_size) {}
+
+  // Records the features exercised by a run of `sample`. If the sample
+  // exercised a rare feature it is added to the corpus, evicting the oldest
+  // entry if the corpus is full. Returns whether the sample was added.
+  bool Record(const Sample& sample,
+              const absl::btree_map<std::string, int64_t>& expr_kind_counts,
+              const absl::btree_set<std::string>& features);
+
+  // Returns scales for AstGeneratorOptions::expr_weight_scales which favor the
+  // expression kinds of samples which recently exercised rare features.
+  absl::btree_map<std::string, double> GetExprWeightScales() const;
+
+  // Returns a random entry of the corpus, or std::nullopt if it is empty.
+  std::optional<CorpusEntry> ChooseCorpusEntry(absl::BitGenRef bit_gen) const;
+
+  int64_t corpus_size() const;
+  int64_t feature_count() const;
+
+ private:
+  // Exponential moving average of the novelty of samples containing an
+  // expression kind.
+  struct KindStats {
+    int64_t samples = 0;
+    double novelty = 0.0;
+  };
+
+  const int64_t max_corpus_size_;
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, int64_t> feature_counts_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, KindStats> kind_stats_
+      ABSL_GUARDED_BY(mutex_);
+  // Moving average of the novelty of all samples.
+  KindStats all_stats_ ABSL_GUARDED_BY(mutex_);
+  std::deque<CorpusEntry> corpus_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_SAMPLE_FEEDBACK_H_
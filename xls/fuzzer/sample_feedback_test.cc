@@ -0,0 +1,116 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/sample_feedback.h"
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/btree_map.h"
+#include "absl/container/btree_set.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_runner.h"
+
+namespace xls {
+namespace {
+
+using ::testing::Contains;
+using ::testing::Key;
+using ::testing::Not;
+
+Sample MakeSample(std::string text) {
+  return Sample(std::move(text), SampleOptions(), /*args_batch=*/{});
+}
+
+TEST(SampleFeedbackTest, GetSampleFeatures) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(SetFileContents(temp_dir.path() / "sample.ir", R"(
+package sample
+
+top fn main(x: bits[8], y: bits[8]) -> bits[8] {
+  ret add.3: bits[8] = add(x, y, id=3)
+}
+)"));
+  XLS_ASSERT_OK(SetFileContents(
+      temp_dir.path() / SampleRunner::kPassProfileFileName,
+      R"(passes { pass_name: "dce" run_count: 2 changed_count: 1 }
+         passes { pass_name: "cse" run_count: 2 changed_count: 0 })"));
+  XLS_ASSERT_OK_AND_ASSIGN(absl::btree_set<std::string> features,
+                           GetSampleFeatures(temp_dir.path()));
+  EXPECT_THAT(features, Contains("ir:add:bits8"));
+  EXPECT_THAT(features, Contains("ir:param:bits8"));
+  EXPECT_THAT(features, Contains("pass:dce"));
+  EXPECT_THAT(features, Not(Contains("pass:cse")));
+}
+
+TEST(SampleFeedbackTest, CorpusKeepsSamplesWithRareFeatures) {
+  SampleFeedback feedback;
+  for (int64_t i = 0; i < SampleFeedback::kRareFeatureCount; ++i) {
+    EXPECT_TRUE(feedback.Record(MakeSample("a"), {}, {"ir:add:bits8"}));
+  }
+  EXPECT_FALSE(feedback.Record(MakeSample("b"), {}, {"ir:add:bits8"}));
+  EXPECT_TRUE(feedback.Record(MakeSample("c"), {}, {"ir:add:bits8", "x"}));
+  EXPECT_EQ(feedback.corpus_size(), SampleFeedback::kRareFeatureCount + 1);
+  EXPECT_EQ(feedback.feature_count(), 2);
+
+  std::mt19937_64 rng{0};
+  std::optional<SampleFeedback::CorpusEntry> entry =
+      feedback.ChooseCorpusEntry(rng);
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_NE(entry->sample.input_text(), "b");
+}
+
+TEST(SampleFeedbackTest, CorpusIsBounded) {
+  SampleFeedback feedback(/*max_corpus_size=*/2);
+  for (int64_t i = 0; i < 4; ++i) {
+    feedback.Record(MakeSample("a"), {}, {absl::StrCat("feature", i)});
+  }
+  EXPECT_EQ(feedback.corpus_size(), 2);
+}
+
+TEST(SampleFeedbackTest, ExprWeightScalesFavorNovelKinds) {
+  SampleFeedback feedback;
+  const absl::btree_map<std::string, int64_t> boring = {{"binop", 3}};
+  const absl::btree_map<std::string, int64_t> novel = {{"array_update", 1},
+                                                       {"binop", 1}};
+  for (int64_t i = 0; i < 2 * SampleFeedback::kMinKindSamples; ++i) {
+    feedback.Record(MakeSample("a"), boring, {"ir:add:bits8"});
+    feedback.Record(MakeSample("b"), novel,
+                    {absl::StrCat("ir:array_update:", i)});
+  }
+  absl::btree_map<std::string, double> scales = feedback.GetExprWeightScales();
+  ASSERT_THAT(scales, Contains(Key("array_update")));
+  ASSERT_THAT(scales, Contains(Key("binop")));
+  EXPECT_GT(scales.at("array_update"), 1.0);
+  EXPECT_GT(scales.at("array_update"), scales.at("binop"));
+  EXPECT_LE(scales.at("array_update"), SampleFeedback::kMaxWeightScale);
+}
+
+TEST(SampleFeedbackTest, NoScalesWithoutEnoughSamples) {
+  SampleFeedback feedback;
+  feedback.Record(MakeSample("a"), {{"binop", 1}}, {"ir:add:bits8"});
+  EXPECT_TRUE(feedback.GetExprWeightScales().empty());
+}
+
+}  // namespace
+}  // namespace xls
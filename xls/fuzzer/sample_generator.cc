@@ -25,6 +25,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/container/btree_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/random/bit_gen_ref.h"
@@ -217,12 +218,17 @@ static std::vector<std::string> GenerateCodegenArgs(
 
 // This function generates a module satisfying `ast_options`, and returns the
 // DSLX for that module and the minimum number of stages it can be safely
-// scheduled in.
+// scheduled in. If `expr_kind_counts` is given it is set to the number of
+// expressions generated of each kind.
 static absl::StatusOr<std::pair<std::string, int64_t>> Generate(
-    const AstGeneratorOptions& ast_options, absl::BitGenRef bit_gen) {
+    const AstGeneratorOptions& ast_options, absl::BitGenRef bit_gen,
+    absl::btree_map<std::string, int64_t>* expr_kind_counts) {
   AstGenerator g(ast_options, bit_gen);
   XLS_ASSIGN_OR_RETURN(dslx::AnnotatedModule module,
                        g.Generate("main", "test"));
+  if (expr_kind_counts != nullptr) {
+    *expr_kind_counts = std::move(module.expr_kind_counts);
+  }
   return std::make_pair(module.module->ToString(), module.min_stages);
 }
 
@@ -344,9 +350,48 @@ static absl::StatusOr<Sample> GenerateProcSample(
                 std::move(ir_channel_names));
 }
 
+absl::StatusOr<Sample> GenerateSampleForDslx(
+    const std::string& dslx_text, const SampleOptions& sample_options,
+    absl::BitGenRef bit_gen) {
+  constexpr std::string_view top_name = "main";
+  // Parse and type check the DSLX input to retrieve the top entity. The top
+  // member must be a proc or a function.
+  ImportData import_data(
+      dslx::CreateImportData(/*stdlib_path=*/"",
+                             /*additional_search_paths=*/{},
+                             /*enabled_warnings=*/dslx::kAllWarningsSet));
+  XLS_ASSIGN_OR_RETURN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(dslx_text, "sample.x", "sample", &import_data));
+
+  std::optional<ModuleMember*> module_member =
+      tm.module->FindMemberWithName(top_name);
+  if (!module_member.has_value()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("No top entity named `%s` in sample", top_name));
+  }
+  ModuleMember* member = module_member.value();
+
+  SampleOptions sample_options_copy = sample_options;
+  sample_options_copy.set_input_is_dslx(true);
+  if (std::holds_alternative<dslx::Proc*>(*member)) {
+    sample_options_copy.set_sample_type(fuzzer::SAMPLE_TYPE_PROC);
+    return GenerateProcSample(std::get<dslx::Proc*>(*member), tm,
+                              sample_options_copy, bit_gen, dslx_text);
+  }
+  if (std::holds_alternative<dslx::Function*>(*member)) {
+    sample_options_copy.set_sample_type(fuzzer::SAMPLE_TYPE_FUNCTION);
+    return GenerateFunctionSample(std::get<dslx::Function*>(*member), tm,
+                                  sample_options_copy, bit_gen, dslx_text);
+  }
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "Top entity `%s` of sample is not a function or proc", top_name));
+}
+
 absl::StatusOr<Sample> GenerateSample(
     const AstGeneratorOptions& generator_options,
-    const SampleOptions& sample_options, absl::BitGenRef bit_gen) {
+    const SampleOptions& sample_options, absl::BitGenRef bit_gen,
+    absl::btree_map<std::string, int64_t>* expr_kind_counts) {
   constexpr std::string_view top_name = "main";
   if (generator_options.generate_proc) {
     CHECK_EQ(sample_options.calls_per_sample(), 0)
@@ -363,8 +408,9 @@ absl::StatusOr<Sample> GenerateSample(
   bool has_nb_recv = false;
   int64_t min_stages = 1;
   do {
-    XLS_ASSIGN_OR_RETURN(std::tie(dslx_text, min_stages),
-                         Generate(generator_options, bit_gen));
+    XLS_ASSIGN_OR_RETURN(
+        std::tie(dslx_text, min_stages),
+        Generate(generator_options, bit_gen, expr_kind_counts));
     XLS_ASSIGN_OR_RETURN(has_nb_recv, HasNonBlockingRecv(dslx_text));
     // If this sample is going through codegen, regenerate the sample until it's
     // legal; we currently can't verify latency-sensitive samples, which means
@@ -15,6 +15,10 @@
 #ifndef XLS_FUZZER_SAMPLE_GENERATOR_H_
 #define XLS_FUZZER_SAMPLE_GENERATOR_H_
 
+#include <cstdint>
+#include <string>
+
+#include "absl/container/btree_map.h"
 #include "absl/random/bit_gen_ref.h"
 #include "absl/status/statusor.h"
 #include "xls/fuzzer/ast_generator.h"
@@ -22,10 +26,21 @@
 
 namespace xls {
 
-// Generates and returns a random Sample with the given options.
+// Generates and returns a random Sample with the given options. If
+// `expr_kind_counts` is given it is set to the number of expressions of each
+// kind (see dslx::GetAstGeneratorExprKinds) in the generated sample.
 absl::StatusOr<Sample> GenerateSample(
     const dslx::AstGeneratorOptions& generator_options,
-    const SampleOptions& sample_options, absl::BitGenRef bit_gen);
+    const SampleOptions& sample_options, absl::BitGenRef bit_gen,
+    absl::btree_map<std::string, int64_t>* expr_kind_counts = nullptr);
+
+// Returns a Sample which runs the given DSLX with `sample_options` and randomly
+// generated arguments. The DSLX must contain a function or proc named `main`
+// which is the top of the sample. Returns an error if the DSLX does not parse
+// or type check; e.g., after mutation of a generated sample.
+absl::StatusOr<Sample> GenerateSampleForDslx(
+    const std::string& dslx_text, const SampleOptions& sample_options,
+    absl::BitGenRef bit_gen);
 
 }  // namespace xls
 
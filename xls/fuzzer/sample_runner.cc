@@ -42,6 +42,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
@@ -62,6 +63,8 @@
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/interp_value.h"
 #include "xls/dslx/interp_value_utils.h"
+#include "xls/dslx/ir_convert/convert_options.h"
+#include "xls/dslx/ir_convert/ir_converter.h"
 #include "xls/dslx/parse_and_typecheck.h"
 #include "xls/dslx/type_system/type.h"
 #include "xls/dslx/type_system/type_info.h"
@@ -69,12 +72,19 @@
 #include "xls/fuzzer/cpp_sample_runner.h"
 #include "xls/fuzzer/sample.h"
 #include "xls/fuzzer/sample.pb.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/events.h"
 #include "xls/ir/format_preference.h"
+#include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
 #include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/passes/optimization_pass.h"
 #include "xls/public/runtime_build_actions.h"
 #include "xls/simulation/check_simulator.h"
 #include "xls/tools/eval_utils.h"
+#include "xls/tools/opt.h"
 #include "re2/re2.h"
 
 // These are used to forward, but also see comment below.
@@ -250,25 +260,206 @@ absl::StatusOr<std::string> RunCommand(
   return result.stdout;
 }
 
+// A tool which can be run within this process. Returns the tool's stdout if
+// successful, or std::nullopt if the tool does not support the given
+// arguments in-process, in which case it should be run as a subprocess.
+using InProcessTool = std::optional<absl::StatusOr<std::string>> (*)(
+    absl::Span<const std::string> args, const std::filesystem::path& run_dir);
+
+std::filesystem::path ResolvePath(std::string_view path,
+                                  const std::filesystem::path& run_dir) {
+  std::filesystem::path result(path);
+  return result.is_absolute() ? result : run_dir / result;
+}
+
+// Equivalent to ir_converter_main with only the `--top` and
+// `--warnings_as_errors=false` flags supported.
+std::optional<absl::StatusOr<std::string>> IrConverterInProcess(
+    absl::Span<const std::string> args, const std::filesystem::path& run_dir) {
+  std::optional<std::string_view> top;
+  std::optional<std::string_view> input_path;
+  for (std::string_view arg : args) {
+    if (absl::ConsumePrefix(&arg, "--top=")) {
+      top = arg;
+    } else if (arg == "--warnings_as_errors=false") {
+      continue;
+    } else if (!arg.starts_with("-") && !input_path.has_value()) {
+      input_path = arg;
+    } else {
+      return std::nullopt;
+    }
+  }
+  if (!input_path.has_value()) {
+    return std::nullopt;
+  }
+  std::string path = ResolvePath(*input_path, run_dir).string();
+  absl::StatusOr<std::unique_ptr<Package>> package =
+      dslx::ConvertFilesToPackage(
+          {path}, std::string(GetDefaultDslxStdlibPath()),
+          /*dslx_paths=*/{},
+          dslx::ConvertOptions{
+              .emit_positions = true,
+              .emit_fail_as_assert = true,
+              .verify_ir = true,
+              .simplify_ir = false,
+              .warnings_as_errors = false,
+              .enabled_warnings = dslx::kAllWarningsSet,
+          },
+          top);
+  if (!package.ok()) {
+    return package.status();
+  }
+  return (*package)->DumpIr();
+}
+
+// Equivalent to opt_main with only the `--pass_profile_path` flag supported.
+std::optional<absl::StatusOr<std::string>> OptMainInProcess(
+    absl::Span<const std::string> args, const std::filesystem::path& run_dir) {
+  std::optional<std::string> pass_profile_path;
+  std::optional<std::string_view> ir_path;
+  for (std::string_view arg : args) {
+    if (absl::ConsumePrefix(&arg, "--pass_profile_path=")) {
+      pass_profile_path = ResolvePath(arg, run_dir).string();
+    } else if (!arg.starts_with("-") && !ir_path.has_value()) {
+      ir_path = arg;
+    } else {
+      return std::nullopt;
+    }
+  }
+  if (!ir_path.has_value()) {
+    return std::nullopt;
+  }
+  // Arguments match the defaults of opt_main's flags.
+  return tools::OptimizeIrForTop(
+      ResolvePath(*ir_path, run_dir).string(), kMaxOptLevel, /*top=*/"",
+      /*ir_dump_path=*/"", /*skip_passes=*/{},
+      /*convert_array_index_to_select=*/-1, /*split_next_value_selects=*/4,
+      /*inline_procs=*/false, /*ram_rewrites_pb=*/"",
+      /*use_context_narrowing_analysis=*/false, /*pass_list=*/std::nullopt,
+      /*bisect_limit=*/std::nullopt, /*opt_threads=*/1, pass_profile_path);
+}
+
+absl::StatusOr<std::string> EvalIrFunction(std::string_view ir_path,
+                                           std::string_view input_path,
+                                           bool use_jit) {
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text, ir_path));
+  XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
+  XLS_ASSIGN_OR_RETURN(std::string input_text, GetFileContents(input_path));
+
+  std::unique_ptr<FunctionJit> jit;
+  if (use_jit) {
+    XLS_ASSIGN_OR_RETURN(jit, FunctionJit::Create(f));
+  }
+  std::string results;
+  for (std::string_view line :
+       absl::StrSplit(input_text, '\n', absl::SkipWhitespace())) {
+    std::vector<Value> args;
+    for (std::string_view arg : absl::StrSplit(line, ';')) {
+      XLS_ASSIGN_OR_RETURN(Value value, Parser::ParseTypedValue(arg));
+      args.push_back(std::move(value));
+    }
+    Value result;
+    if (use_jit) {
+      XLS_ASSIGN_OR_RETURN(result, DropInterpreterEvents(jit->Run(args)));
+    } else {
+      XLS_ASSIGN_OR_RETURN(result,
+                           DropInterpreterEvents(InterpretFunction(f, args)));
+    }
+    absl::StrAppend(&results, result.ToString(FormatPreference::kHex), "\n");
+  }
+  return results;
+}
+
+// Equivalent to eval_ir_main with only the `--input_file` and
+// `--[no]use_llvm_jit` flags supported.
+std::optional<absl::StatusOr<std::string>> EvalIrMainInProcess(
+    absl::Span<const std::string> args, const std::filesystem::path& run_dir) {
+  std::optional<std::string_view> input_path;
+  std::optional<std::string_view> ir_path;
+  bool use_jit = true;
+  for (std::string_view arg : args) {
+    if (absl::ConsumePrefix(&arg, "--input_file=")) {
+      input_path = arg;
+    } else if (arg == "--use_llvm_jit" || arg == "--nouse_llvm_jit") {
+      use_jit = arg == "--use_llvm_jit";
+    } else if (!arg.starts_with("-") && !ir_path.has_value()) {
+      ir_path = arg;
+    } else {
+      return std::nullopt;
+    }
+  }
+  if (!input_path.has_value() || !ir_path.has_value()) {
+    return std::nullopt;
+  }
+  return EvalIrFunction(ResolvePath(*ir_path, run_dir).string(),
+                        ResolvePath(*input_path, run_dir).string(), use_jit);
+}
+
+// Runs the tool for a stage of the sample. If no command was given for the
+// stage and the options request it, `in_process_tool` is run within this
+// process; otherwise the command, defaulting to the runfile at `runfile_path`,
+// is run as a subprocess.
+absl::StatusOr<std::string> RunTool(
+    std::string_view desc,
+    const std::optional<SampleRunner::Commands::Command>& command,
+    std::string_view runfile_path, InProcessTool in_process_tool,
+    std::vector<std::string> args, const std::filesystem::path& run_dir,
+    const SampleOptions& options) {
+  if (!command.has_value() && options.run_in_process()) {
+    VLOG(1) << "Running in-process: " << desc;
+    Stopwatch timer;
+    std::optional<absl::StatusOr<std::string>> result =
+        in_process_tool(args, run_dir);
+    if (result.has_value()) {
+      std::string basename = std::filesystem::path(runfile_path).filename();
+      std::string error =
+          result->ok() ? "" : std::string(result->status().message());
+      XLS_RETURN_IF_ERROR(
+          SetFileContents(run_dir / absl::StrCat(basename, ".stderr"), error));
+      VLOG(1) << desc << " complete, elapsed " << timer.GetElapsedTime();
+      if (result->ok()) {
+        return *std::move(result);
+      }
+      for (const KnownFailure& filter : options.known_failures()) {
+        if ((filter.tool == nullptr ||
+             RE2::FullMatch(basename, *filter.tool)) &&
+            RE2::PartialMatch(error, *filter.stderr_regex)) {
+          return absl::FailedPreconditionError(absl::StrFormat(
+              "%s failed in-process but failure was suppressed due to stderr "
+              "regexp: %s",
+              basename, error));
+        }
+      }
+      return result->status();
+    }
+    VLOG(1) << "Arguments not supported in-process, running subprocess: "
+            << absl::StrJoin(args, " ");
+  }
+  if (command.has_value()) {
+    return RunCommand(desc, *command, std::move(args), run_dir, options);
+  }
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path executable,
+                       GetXlsRunfilePath(runfile_path));
+  return RunCommand(desc, executable, std::move(args), run_dir, options);
+}
+
 // Converts the DSLX file to an IR file with a function as the top whose
 // filename is returned.
 absl::StatusOr<std::filesystem::path> DslxToIrFunction(
     const std::filesystem::path& input_path, const SampleOptions& options,
     const std::filesystem::path& run_dir,
     const SampleRunner::Commands& commands) {
-  std::optional<SampleRunner::Commands::Command> command =
-      commands.ir_converter_main;
-  if (!command.has_value()) {
-    XLS_ASSIGN_OR_RETURN(command, GetXlsRunfilePath(kIrConverterMainPath));
-  }
-
   std::vector<std::string> args;
   absl::c_copy(options.ir_converter_args(), std::back_inserter(args));
   args.push_back("--warnings_as_errors=false");
   args.push_back(input_path.string());
   XLS_ASSIGN_OR_RETURN(
       std::string ir_text,
-      RunCommand("Converting DSLX to IR", *command, args, run_dir, options));
+      RunTool("Converting DSLX to IR", commands.ir_converter_main,
+              kIrConverterMainPath, IrConverterInProcess, args, run_dir,
+              options));
   VLOG(3) << "Unoptimized IR:\n" << ir_text;
 
   std::filesystem::path ir_path = run_dir / "sample.ir";
@@ -302,23 +493,17 @@ absl::StatusOr<std::vector<dslx::InterpValue>> EvaluateIrFunction(
     const std::filesystem::path& args_path, bool use_jit,
     const SampleOptions& options, const std::filesystem::path& run_dir,
     const SampleRunner::Commands& commands) {
-  std::optional<SampleRunner::Commands::Command> command =
-      commands.eval_ir_main;
-  if (!command.has_value()) {
-    XLS_ASSIGN_OR_RETURN(command, GetXlsRunfilePath(kEvalIrMainPath));
-  }
-
   XLS_ASSIGN_OR_RETURN(
       std::string results_text,
-      RunCommand(absl::StrFormat("Evaluating IR file (%s): %s",
-                                 (use_jit ? "JIT" : "interpreter"), ir_path),
-                 *command,
-                 {
-                     absl::StrCat("--input_file=", args_path.string()),
-                     absl::StrFormat("--%suse_llvm_jit", use_jit ? "" : "no"),
-                     ir_path,
-                 },
-                 run_dir, options));
+      RunTool(absl::StrFormat("Evaluating IR file (%s): %s",
+                              (use_jit ? "JIT" : "interpreter"), ir_path),
+              commands.eval_ir_main, kEvalIrMainPath, EvalIrMainInProcess,
+              {
+                  absl::StrCat("--input_file=", args_path.string()),
+                  absl::StrFormat("--%suse_llvm_jit", use_jit ? "" : "no"),
+                  ir_path,
+              },
+              run_dir, options));
   XLS_RETURN_IF_ERROR(SetFileContents(
       absl::StrCat(ir_path.string(), ".results"), results_text));
   return ParseValues(results_text);
@@ -356,14 +541,16 @@ absl::StatusOr<std::filesystem::path> OptimizeIr(
     const std::filesystem::path& ir_path, const SampleOptions& options,
     const std::filesystem::path& run_dir,
     const SampleRunner::Commands& commands) {
-  std::optional<SampleRunner::Commands::Command> command = commands.ir_opt_main;
-  if (!command.has_value()) {
-    XLS_ASSIGN_OR_RETURN(command, GetXlsRunfilePath(kIrOptMainPath));
+  std::vector<std::string> args;
+  if (options.record_pass_profile()) {
+    args.push_back(absl::StrCat("--pass_profile_path=",
+                                SampleRunner::kPassProfileFileName));
   }
-
+  args.push_back(ir_path);
   XLS_ASSIGN_OR_RETURN(
       std::string opt_ir_text,
-      RunCommand("Optimizing IR", *command, {ir_path}, run_dir, options));
+      RunTool("Optimizing IR", commands.ir_opt_main, kIrOptMainPath,
+              OptMainInProcess, args, run_dir, options));
   VLOG(3) << "Optimized IR:\n" << opt_ir_text;
   std::filesystem::path opt_ir_path = run_dir / "sample.opt.ir";
   XLS_RETURN_IF_ERROR(SetFileContents(opt_ir_path, opt_ir_text));
@@ -659,19 +846,15 @@ absl::StatusOr<std::filesystem::path> DslxToIrProc(
     const std::filesystem::path& dslx_path, const SampleOptions& options,
     const std::filesystem::path& run_dir,
     const SampleRunner::Commands& commands) {
-  std::optional<SampleRunner::Commands::Command> command =
-      commands.ir_converter_main;
-  if (!command.has_value()) {
-    XLS_ASSIGN_OR_RETURN(command, GetXlsRunfilePath(kIrConverterMainPath));
-  }
-
   std::vector<std::string> args;
   absl::c_copy(options.ir_converter_args(), std::back_inserter(args));
   args.push_back("--warnings_as_errors=false");
   args.push_back(dslx_path);
   XLS_ASSIGN_OR_RETURN(
       std::string ir_text,
-      RunCommand("Converting DSLX to IR", *command, args, run_dir, options));
+      RunTool("Converting DSLX to IR", commands.ir_converter_main,
+              kIrConverterMainPath, IrConverterInProcess, args, run_dir,
+              options));
   VLOG(3) << "Unoptimized IR:\n" << ir_text;
   std::filesystem::path ir_path = run_dir / "sample.ir";
   XLS_RETURN_IF_ERROR(SetFileContents(ir_path, ir_text));
@@ -19,6 +19,7 @@
 #include <functional>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -68,6 +69,12 @@ class SampleRunner {
     std::optional<Command> simulate_module_main;
   };
 
+  // Name of the file in the run directory to which the optimizer's
+  // PassPipelineProfileProto is written when the sample options request a pass
+  // profile.
+  static constexpr std::string_view kPassProfileFileName =
+      "sample.opt.profile.pbtxt";
+
   explicit SampleRunner(std::filesystem::path run_dir)
       : run_dir_(std::move(run_dir)) {}
   SampleRunner(std::filesystem::path run_dir, Commands commands)
@@ -536,6 +536,35 @@ TEST_F(SampleRunnerTest, InterpretOptIR) {
               ElementsAre("bits[8]:0x8e"));
 }
 
+TEST_F(SampleRunnerTest, InterpretOptIRInProcess) {
+  SampleRunner runner(GetTempPath());
+  constexpr std::string_view dslx_text =
+      "fn main(x: u8, y: u8) -> u8 { x + y }";
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  options.set_ir_converter_args({"--top=main"});
+  options.set_run_in_process(true);
+  XLS_ASSERT_OK_AND_ASSIGN(ArgsBatch args_batch, ToArgsBatch({
+                                                     {
+                                                         "bits[8]:42",
+                                                         "bits[8]:100",
+                                                     },
+                                                 }));
+  XLS_ASSERT_OK(
+      runner.Run(Sample(std::string(dslx_text), options, args_batch)));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string opt_ir,
+                           GetFileContents(GetTempPath() / "sample.opt.ir"));
+  EXPECT_THAT(opt_ir, HasSubstr("package sample"));
+  for (std::string_view results_file :
+       {"sample.ir.results", "sample.opt.ir.results"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::string results,
+                             GetFileContents(GetTempPath() / results_file));
+    EXPECT_THAT(absl::StrSplit(absl::StripAsciiWhitespace(results), "\n",
+                               absl::SkipEmpty()),
+                ElementsAre("bits[8]:0x8e"));
+  }
+}
+
 TEST_F(SampleRunnerTest, InterpretOptIRMiscompare) {
   SampleRunner runner(
       GetTempPath(),
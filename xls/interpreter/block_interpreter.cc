@@ -14,15 +14,19 @@
 
 #include "xls/interpreter/block_interpreter.h"
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -40,7 +44,9 @@
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/register.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
 
 namespace xls {
 namespace {
@@ -126,14 +132,15 @@ class ElaboratedBlockInterpreter final : public ElaboratedBlockDfsVisitor {
       : inputs_(inputs), reg_state_(reg_state) {
     next_reg_state_.reserve(reg_state_.size());
 
+    // Interpreters are indexed by instance id.
+    interpreters_.resize(elaboration.instances().size());
     for (BlockInstance* instance : elaboration.instances()) {
       if (!instance->block().has_value()) {
         continue;
       }
-      interpreters_.insert(
-          {instance, BlockInterpreter(*instance->block(), &interpreter_events_,
-                                      instance->RegisterPrefix(), reg_state_,
-                                      next_reg_state_)});
+      interpreters_[instance->id()].emplace(
+          *instance->block(), &interpreter_events_, instance->RegisterPrefix(),
+          reg_state_, next_reg_state_);
     }
     CHECK_OK(SetInstance(elaboration.top()));
   }
@@ -149,14 +156,13 @@ class ElaboratedBlockInterpreter final : public ElaboratedBlockDfsVisitor {
       XLS_RET_CHECK(predecessor.has_value() &&
                     predecessor->node->Is<InstantiationInput>());
 
-      auto parent_interpreter_iter = interpreters_.find(parent_instance);
-      if (parent_interpreter_iter == interpreters_.end()) {
+      if (!HasInterpreter(parent_instance)) {
         return absl::InvalidArgumentError(
             absl::StrFormat("Missing parent interpreter for instance '%s'",
                             parent_instance->ToString()));
       }
       const BlockInterpreter& parent_interpreter =
-          parent_interpreter_iter->second;
+          GetInterpreter(parent_instance);
       return current_interpreter_->SetValueResult(
           input_port, parent_interpreter.ResolveAsValue(
                           predecessor->node->As<InstantiationInput>()->data()));
@@ -186,14 +192,13 @@ class ElaboratedBlockInterpreter final : public ElaboratedBlockDfsVisitor {
     XLS_RET_CHECK(predecessor.has_value() &&
                   predecessor->node->Is<OutputPort>());
     Node* child_output_data = predecessor->node->As<OutputPort>()->operand(0);
-    auto child_interpreter_iter = interpreters_.find(child_instance);
-    if (child_interpreter_iter == interpreters_.end()) {
+    if (!HasInterpreter(child_instance)) {
       return absl::InvalidArgumentError(
           absl::StrFormat("Missing child interpreter for instance '%s'",
                           child_instance->ToString()));
     }
     const Value& child_value =
-        child_interpreter_iter->second.ResolveAsValue(child_output_data);
+        GetInterpreter(child_instance).ResolveAsValue(child_output_data);
     return current_interpreter_->SetValueResult(instantiation_output,
                                                 child_value);
   }
@@ -520,23 +525,27 @@ class ElaboratedBlockInterpreter final : public ElaboratedBlockDfsVisitor {
 
   absl::Status SetInstance(BlockInstance* instance) {
     if (current_instance_ == instance) {
-      XLS_RET_CHECK(interpreters_.contains(instance) &&
-                    current_interpreter_ == &interpreters_.at(instance));
+      XLS_RET_CHECK(HasInterpreter(instance) &&
+                    current_interpreter_ == &GetInterpreter(instance));
       return absl::OkStatus();
     }
     current_instance_ = instance;
-    auto it = interpreters_.find(instance);
-    XLS_RET_CHECK(it != interpreters_.end());
-    current_interpreter_ = &it->second;
+    XLS_RET_CHECK(HasInterpreter(instance));
+    current_interpreter_ = &GetInterpreter(instance);
     return absl::OkStatus();
   }
 
+  bool HasInterpreter(BlockInstance* instance) const {
+    return instance->id() < interpreters_.size() &&
+           interpreters_[instance->id()].has_value();
+  }
+
   BlockInterpreter& GetInterpreter(BlockInstance* instance) {
-    return interpreters_.at(instance);
+    return interpreters_.at(instance->id()).value();
   }
 
   const BlockInterpreter& GetInterpreter(BlockInstance* instance) const {
-    return interpreters_.at(instance);
+    return interpreters_.at(instance->id()).value();
   }
 
   absl::flat_hash_map<std::string, Value>&& MoveRegState() {
@@ -552,13 +561,251 @@ class ElaboratedBlockInterpreter final : public ElaboratedBlockDfsVisitor {
   const absl::flat_hash_map<std::string, Value>& reg_state_;
   absl::flat_hash_map<std::string, Value> next_reg_state_;
   InterpreterEvents interpreter_events_;
-  absl::flat_hash_map<BlockInstance*, BlockInterpreter> interpreters_;
+  std::vector<std::optional<BlockInterpreter>> interpreters_;
   // SetInstance() compares current_instance_ to its argument, so initialize
   // first.
   BlockInstance* current_instance_ = nullptr;
   BlockInterpreter* current_interpreter_ = nullptr;
 };
 
+// Returns the value of `reg_write` for the next cycle given the current value
+// of its register.
+Value NextRegisterValue(RegisterWrite* reg_write, bool reset_signal,
+                        bool load_enable, const Value& current_value,
+                        const Value& data) {
+  if (reg_write->reset().has_value()) {
+    const Reset& reset = reg_write->GetRegister()->reset().value();
+    if (reset_signal != reset.active_low) {
+      return reset.reset_value;
+    }
+  }
+  return load_enable ? data : current_value;
+}
+
+// An interpreter for blocks without instantiations which evaluates cycles from
+// a plan computed once: the nodes of the block in topological order with
+// dense slot indices for the ports and registers they access. Reusing the plan
+// avoids the graph traversal and name-keyed register lookups which
+// ElaboratedBlockInterpreter performs each cycle.
+class CompiledBlockInterpreter final : public IrInterpreter {
+ public:
+  explicit CompiledBlockInterpreter(Block* block) {
+    absl::flat_hash_map<Node*, int64_t> port_slots;
+    for (int64_t i = 0; i < block->GetInputPorts().size(); ++i) {
+      port_slots[block->GetInputPorts()[i]] = i;
+    }
+    absl::flat_hash_map<Register*, int64_t> register_slots;
+    for (int64_t i = 0; i < block->GetRegisters().size(); ++i) {
+      register_slots[block->GetRegisters()[i]] = i;
+    }
+    next_registers_.resize(block->GetRegisters().size());
+    std::vector<Node*> order = TopoSort(block);
+    instructions_.reserve(order.size());
+    for (Node* node : order) {
+      if (node->Is<InputPort>()) {
+        instructions_.push_back({node, Kind::kInputPort, port_slots.at(node)});
+      } else if (node->Is<RegisterRead>()) {
+        instructions_.push_back(
+            {node, Kind::kRegisterRead,
+             register_slots.at(node->As<RegisterRead>()->GetRegister())});
+      } else if (node->Is<RegisterWrite>()) {
+        int64_t slot =
+            register_slots.at(node->As<RegisterWrite>()->GetRegister());
+        instructions_.push_back({node, Kind::kRegisterWrite, slot});
+        written_registers_.push_back(slot);
+      } else if (node->Is<OutputPort>()) {
+        instructions_.push_back({node, Kind::kOutputPort, -1});
+      } else {
+        instructions_.push_back({node, Kind::kNode, -1});
+      }
+    }
+    NodeValuesMap().reserve(order.size());
+  }
+
+  // Evaluates one cycle. `inputs` and `registers` point to the values of the
+  // input ports and registers in the order of the block's ports and
+  // registers. The registers are updated in place at the end of the cycle.
+  absl::Status RunCycle(absl::Span<const Value* const> inputs,
+                        absl::Span<Value* const> registers) {
+    GetInterpreterEvents().Clear();
+    for (const Instruction& instruction : instructions_) {
+      Node* node = instruction.node;
+      // Erasing values one at a time rather than clearing the map keeps its
+      // storage allocated across cycles.
+      NodeValuesMap().erase(node);
+      switch (instruction.kind) {
+        case Kind::kInputPort:
+          XLS_RETURN_IF_ERROR(
+              SetValueResult(node, *inputs[instruction.slot]));
+          break;
+        case Kind::kRegisterRead:
+          XLS_RETURN_IF_ERROR(
+              SetValueResult(node, *registers[instruction.slot]));
+          break;
+        case Kind::kRegisterWrite: {
+          RegisterWrite* reg_write = node->As<RegisterWrite>();
+          next_registers_[instruction.slot] = NextRegisterValue(
+              reg_write,
+              reg_write->reset().has_value() &&
+                  ResolveAsBool(*reg_write->reset()),
+              !reg_write->load_enable().has_value() ||
+                  ResolveAsBool(*reg_write->load_enable()),
+              *registers[instruction.slot],
+              ResolveAsValue(reg_write->data()));
+          // Register writes and output ports have empty tuple types.
+          XLS_RETURN_IF_ERROR(SetValueResult(node, Value::Tuple({})));
+          break;
+        }
+        case Kind::kOutputPort:
+          XLS_RETURN_IF_ERROR(SetValueResult(node, Value::Tuple({})));
+          break;
+        case Kind::kNode:
+          XLS_RETURN_IF_ERROR(node->VisitSingleNode(this));
+          break;
+      }
+    }
+    for (int64_t slot : written_registers_) {
+      *registers[slot] = std::move(next_registers_[slot]);
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  enum class Kind : uint8_t {
+    kInputPort,
+    kRegisterRead,
+    kRegisterWrite,
+    kOutputPort,
+    kNode,
+  };
+  struct Instruction {
+    Node* node;
+    Kind kind;
+    // Index of the input port or register accessed by the node.
+    int64_t slot;
+  };
+
+  std::vector<Instruction> instructions_;
+  std::vector<int64_t> written_registers_;
+  std::vector<Value> next_registers_;
+};
+
+// A block continuation evaluated with a CompiledBlockInterpreter. The
+// name-keyed maps of the BlockContinuation interface are built once and
+// updated through pointers to their values.
+class CompiledBlockContinuation final : public BlockContinuation {
+ public:
+  static absl::StatusOr<std::unique_ptr<BlockContinuation>> Create(
+      BlockElaboration&& elaboration,
+      const absl::flat_hash_map<std::string, Value>& initial_registers) {
+    auto continuation = absl::WrapUnique(
+        new CompiledBlockContinuation(std::move(elaboration)));
+    XLS_RETURN_IF_ERROR(continuation->SetRegisters(initial_registers));
+    return continuation;
+  }
+
+  const absl::flat_hash_map<std::string, Value>& output_ports() final {
+    return outputs_;
+  }
+  const absl::flat_hash_map<std::string, Value>& registers() final {
+    return registers_;
+  }
+  const InterpreterEvents& events() final {
+    return interpreter_.GetInterpreterEvents();
+  }
+
+  absl::Status RunOneCycle(
+      const absl::flat_hash_map<std::string, Value>& inputs) final {
+    int64_t found = 0;
+    for (int64_t i = 0; i < block_->GetInputPorts().size(); ++i) {
+      InputPort* port = block_->GetInputPorts()[i];
+      auto it = inputs.find(port->GetName());
+      if (it == inputs.end()) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Missing input for port '%s'", port->GetName()));
+      }
+      input_values_[i] = &it->second;
+      ++found;
+    }
+    if (found != inputs.size()) {
+      for (const auto& [name, value] : inputs) {
+        // Empty tuples don't have data
+        if (value.GetFlatBitCount() != 0 && !block_->GetInputPort(name).ok()) {
+          return absl::InvalidArgumentError(
+              absl::StrFormat("Block has no input port '%s'", name));
+        }
+      }
+    }
+    XLS_RETURN_IF_ERROR(
+        interpreter_.RunCycle(input_values_, register_values_));
+    for (int64_t i = 0; i < block_->GetOutputPorts().size(); ++i) {
+      *output_values_[i] = interpreter_.ResolveAsValue(
+          block_->GetOutputPorts()[i]->operand(0));
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status SetRegisters(
+      const absl::flat_hash_map<std::string, Value>& regs) final {
+    for (const auto& [name, value] : regs) {
+      if (!registers_.contains(name)) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Block has no register '%s'", name));
+      }
+    }
+    for (auto& [name, value] : registers_) {
+      auto it = regs.find(name);
+      if (it == regs.end()) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Missing value for register '%s'", name));
+      }
+      value = it->second;
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  explicit CompiledBlockContinuation(BlockElaboration&& elaboration)
+      : elaboration_(std::move(elaboration)),
+        block_(*elaboration_.top()->block()),
+        interpreter_(block_),
+        input_values_(block_->GetInputPorts().size()) {
+    std::string_view prefix = elaboration_.top()->RegisterPrefix();
+    for (Register* reg : block_->GetRegisters()) {
+      registers_[absl::StrCat(prefix, reg->name())] = ZeroOfType(reg->type());
+    }
+    for (OutputPort* port : block_->GetOutputPorts()) {
+      outputs_[port->GetName()] = Value();
+    }
+    // The maps are not modified after this point so pointers to their values
+    // remain valid.
+    for (Register* reg : block_->GetRegisters()) {
+      register_values_.push_back(
+          &registers_.at(absl::StrCat(prefix, reg->name())));
+    }
+    for (OutputPort* port : block_->GetOutputPorts()) {
+      output_values_.push_back(&outputs_.at(port->GetName()));
+    }
+  }
+
+  BlockElaboration elaboration_;
+  Block* block_;
+  CompiledBlockInterpreter interpreter_;
+  absl::flat_hash_map<std::string, Value> registers_;
+  absl::flat_hash_map<std::string, Value> outputs_;
+  std::vector<const Value*> input_values_;
+  std::vector<Value*> register_values_;
+  std::vector<Value*> output_values_;
+};
+
+// Returns whether the compiled interpreter supports `elaboration`, i.e., it is
+// a single block without instantiations.
+bool CanUseCompiledInterpreter(const BlockElaboration& elaboration) {
+  return elaboration.instances().size() == 1 &&
+         elaboration.top()->block().has_value() &&
+         (*elaboration.top()->block())->GetInstantiations().empty();
+}
+
 }  // namespace
 
 absl::StatusOr<BlockRunResult> BlockRun(
@@ -622,4 +869,31 @@ absl::StatusOr<BlockRunResult> BlockRun(
   return result;
 }
 
+absl::StatusOr<std::vector<absl::flat_hash_map<std::string, Value>>>
+InterpreterBlockEvaluator::EvaluateSequentialBlock(
+    Block* block,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<BlockContinuation> continuation,
+                       NewContinuation(block));
+  std::vector<absl::flat_hash_map<std::string, Value>> outputs;
+  outputs.reserve(inputs.size());
+  for (const absl::flat_hash_map<std::string, Value>& input_set : inputs) {
+    XLS_RETURN_IF_ERROR(continuation->RunOneCycle(input_set));
+    outputs.push_back(continuation->output_ports());
+  }
+  return outputs;
+}
+
+absl::StatusOr<std::unique_ptr<BlockContinuation>>
+InterpreterBlockEvaluator::NewContinuation(
+    BlockElaboration&& elaboration,
+    const absl::flat_hash_map<std::string, Value>& initial_registers) const {
+  if (!CanUseCompiledInterpreter(elaboration)) {
+    return BlockEvaluator::NewContinuation(std::move(elaboration),
+                                           initial_registers);
+  }
+  return CompiledBlockContinuation::Create(std::move(elaboration),
+                                           initial_registers);
+}
+
 }  // namespace xls
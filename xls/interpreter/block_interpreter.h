@@ -16,6 +16,7 @@
 #define XLS_INTERPRETER_BLOCK_INTERPRETER_H_
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -48,6 +49,23 @@ class InterpreterBlockEvaluator final : public BlockEvaluator {
       const BlockElaboration& elaboration) const final {
     return BlockRun(inputs, registers, elaboration);
   }
+
+  using BlockEvaluator::NewContinuation;
+  using BlockEvaluator::EvaluateSequentialBlock;
+  absl::StatusOr<std::vector<absl::flat_hash_map<std::string, Value>>>
+  EvaluateSequentialBlock(
+      Block* block,
+      absl::Span<const absl::flat_hash_map<std::string, Value>> inputs)
+      const final;
+
+ protected:
+  // Blocks without instantiations are evaluated from a plan computed once
+  // when the continuation is created rather than by elaborating the block
+  // each cycle.
+  absl::StatusOr<std::unique_ptr<BlockContinuation>> NewContinuation(
+      BlockElaboration&& elaboration,
+      const absl::flat_hash_map<std::string, Value>& initial_registers)
+      const final;
 };
 
 // Runs the interpreter on a combinational block. `inputs` must contain a
@@ -14,11 +14,26 @@
 
 #include "xls/interpreter/block_interpreter.h"
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "xls/codegen/module_signature.pb.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/block_evaluator.h"
 #include "xls/interpreter/block_evaluator_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/block_elaboration.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/register.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 namespace {
@@ -31,5 +46,77 @@ INSTANTIATE_TEST_SUITE_P(BlockInterpreterTest, BlockEvaluatorTest,
                            return std::string(v.param.evaluator->name());
                          });
 
+using ::testing::HasSubstr;
+using ::xls::status_testing::StatusIs;
+
+class BlockInterpreterTest : public IrTestBase {};
+
+// Blocks without instantiations are evaluated by a precompiled plan; check it
+// against the elaborating interpreter.
+TEST_F(BlockInterpreterTest, ContinuationMatchesBlockRun) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue rst = b.InputPort("rst", package->GetBitsType(1));
+  BValue le = b.InputPort("le", package->GetBitsType(1));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Register * accum,
+      b.block()->AddRegister("accum", package->GetBitsType(32),
+                             Reset{.reset_value = Value(UBits(7, 32)),
+                                   .asynchronous = false,
+                                   .active_low = false}));
+  BValue sum = b.Add(x, b.RegisterRead(accum));
+  b.RegisterWrite(accum, sum, /*load_enable=*/le, /*reset=*/rst);
+  BValue x_d = b.InsertRegister("x_d", x);
+  b.OutputPort("sum", sum);
+  b.OutputPort("x_d", x_d);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BlockContinuation> continuation,
+      kInterpreterBlockEvaluator.NewContinuation(block));
+  XLS_ASSERT_OK_AND_ASSIGN(BlockElaboration elaboration,
+                           BlockElaboration::Elaborate(block));
+  absl::flat_hash_map<std::string, Value> registers =
+      continuation->registers();
+  std::vector<absl::flat_hash_map<std::string, uint64_t>> inputs = {
+      {{"x", 1}, {"rst", 1}, {"le", 0}}, {{"x", 2}, {"rst", 0}, {"le", 1}},
+      {{"x", 3}, {"rst", 0}, {"le", 0}}, {{"x", 4}, {"rst", 0}, {"le", 1}},
+      {{"x", 5}, {"rst", 1}, {"le", 1}}, {{"x", 6}, {"rst", 0}, {"le", 1}}};
+  for (const auto& input_set : inputs) {
+    absl::flat_hash_map<std::string, Value> input_values;
+    for (const auto& [name, value] : input_set) {
+      input_values[name] = Value(UBits(value, name == "x" ? 32 : 1));
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(BlockRunResult expected,
+                             BlockRun(input_values, registers, elaboration));
+    XLS_ASSERT_OK(continuation->RunOneCycle(input_values));
+    EXPECT_EQ(continuation->output_ports(), expected.outputs);
+    EXPECT_EQ(continuation->registers(), expected.reg_state);
+    registers = expected.reg_state;
+  }
+
+  XLS_ASSERT_OK(continuation->SetRegisters(
+      {{"accum", Value(UBits(100, 32))}, {"x_d", Value(UBits(0, 32))}}));
+  XLS_ASSERT_OK(continuation->RunOneCycle({{"x", Value(UBits(1, 32))},
+                                           {"rst", Value(UBits(0, 1))},
+                                           {"le", Value(UBits(1, 1))}}));
+  EXPECT_EQ(continuation->output_ports().at("sum"), Value(UBits(101, 32)));
+
+  EXPECT_THAT(continuation->RunOneCycle({{"x", Value(UBits(1, 32))}}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Missing input for port")));
+  EXPECT_THAT(continuation->RunOneCycle({{"x", Value(UBits(1, 32))},
+                                         {"rst", Value(UBits(0, 1))},
+                                         {"le", Value(UBits(1, 1))},
+                                         {"y", Value(UBits(1, 1))}}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Block has no input port 'y'")));
+  EXPECT_THAT(continuation->SetRegisters({{"accum", Value(UBits(0, 32))}}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Missing value for register 'x_d'")));
+}
+
 }  // namespace
 }  // namespace xls
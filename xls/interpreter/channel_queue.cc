@@ -40,7 +40,7 @@
 namespace xls {
 
 absl::Status ChannelQueue::AttachGenerator(GeneratorFn generator) {
-  absl::MutexLock lock(&mutex_);
+  absl::MutexLockMaybe lock(thread_safe_ ? &mutex_ : nullptr);
   if (generator_.has_value()) {
     return absl::InternalError("ChannelQueue already has a generator attached");
   }
@@ -58,7 +58,7 @@ absl::Status ChannelQueue::Write(const Value& value) {
   VLOG(4) << absl::StreamFormat(
       "Writing value to channel instance `%s`: { %s }",
       channel_instance()->ToString(), value.ToString());
-  absl::MutexLock lock(&mutex_);
+  absl::MutexLockMaybe lock(thread_safe_ ? &mutex_ : nullptr);
   if (generator_.has_value()) {
     return absl::InternalError(
         "Cannot write to ChannelQueue because it has a generator function.");
@@ -70,7 +70,8 @@ absl::Status ChannelQueue::Write(const Value& value) {
   }
 
   WriteInternal(value);
-  VLOG(4) << absl::StreamFormat("Channel now has %d elements", queue_.size());
+  VLOG(4) << absl::StreamFormat("Channel now has %d elements",
+                                GetSizeInternal());
   return absl::OkStatus();
 }
 
@@ -89,7 +90,7 @@ void ChannelQueue::WriteInternal(const Value& value) {
 }
 
 std::optional<Value> ChannelQueue::Read() {
-  absl::MutexLock lock(&mutex_);
+  absl::MutexLockMaybe lock(thread_safe_ ? &mutex_ : nullptr);
   if (generator_.has_value()) {
     // Write/ReadInternal are virtual and may have other side-effects so rather
     // than directly returning the generated value, write then read it.
@@ -103,7 +104,8 @@ std::optional<Value> ChannelQueue::Read() {
       "Reading data from channel instance %s: %s",
       channel_instance()->ToString(),
       value.has_value() ? value->ToString() : "(none)");
-  VLOG(4) << absl::StreamFormat("Channel now has %d elements", queue_.size());
+  VLOG(4) << absl::StreamFormat("Channel now has %d elements",
+                                GetSizeInternal());
   return value;
 }
 
@@ -113,10 +115,82 @@ std::optional<Value> ChannelQueue::ReadInternal() {
   if (queue_.empty()) {
     return std::nullopt;
   }
-  Value value = queue_.front();
-  if (channel()->kind() != ChannelKind::kSingleValue) {
-    queue_.pop_front();
+  if (channel()->kind() == ChannelKind::kSingleValue) {
+    return queue_.front();
+  }
+  Value value = std::move(queue_.front());
+  queue_.pop_front();
+  return std::move(value);
+}
+
+namespace {
+
+int64_t GetRingCapacity(Channel* channel) {
+  int64_t capacity = RingBufferChannelQueue::kMinCapacity;
+  if (StreamingChannel* streaming_channel =
+          dynamic_cast<StreamingChannel*>(channel)) {
+    std::optional<int64_t> fifo_depth = streaming_channel->GetFifoDepth();
+    if (fifo_depth.has_value()) {
+      capacity = std::max(capacity, *fifo_depth);
+    }
+  }
+  return capacity;
+}
+
+absl::Status CheckChannelKinds(const ProcElaboration& elaboration) {
+  for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
+    if (channel_instance->channel->kind() != ChannelKind::kStreaming &&
+        channel_instance->channel->kind() != ChannelKind::kSingleValue) {
+      return absl::UnimplementedError(
+          "Only streaming and single-value channels are supported.");
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+RingBufferChannelQueue::RingBufferChannelQueue(
+    ChannelInstance* channel_instance)
+    : ChannelQueue(channel_instance, /*thread_safe=*/false),
+      ring_(channel_instance->channel->kind() == ChannelKind::kSingleValue
+                ? 1
+                : GetRingCapacity(channel_instance->channel)) {}
+
+void RingBufferChannelQueue::Grow() {
+  std::vector<Value> ring(ring_.size() * 2);
+  for (int64_t i = 0; i < size_; ++i) {
+    ring[i] = std::move(ring_[(head_ + i) % ring_.size()]);
+  }
+  ring_ = std::move(ring);
+  head_ = 0;
+}
+
+void RingBufferChannelQueue::WriteInternal(const Value& value) {
+  if (channel()->kind() == ChannelKind::kSingleValue) {
+    ring_.front() = value;
+    size_ = 1;
+    return;
   }
+
+  CHECK_EQ(channel()->kind(), ChannelKind::kStreaming);
+  if (size_ == ring_.size()) {
+    Grow();
+  }
+  ring_[(head_ + size_) % ring_.size()] = value;
+  ++size_;
+}
+
+std::optional<Value> RingBufferChannelQueue::ReadInternal() {
+  if (size_ == 0) {
+    return std::nullopt;
+  }
+  if (channel()->kind() == ChannelKind::kSingleValue) {
+    return ring_.front();
+  }
+  Value value = std::move(ring_[head_]);
+  head_ = (head_ + 1) % ring_.size();
+  --size_;
   return std::move(value);
 }
 
@@ -164,15 +238,11 @@ ChannelQueueManager::Create(std::vector<std::unique_ptr<ChannelQueue>>&& queues,
 
 /* static */ absl::StatusOr<std::unique_ptr<ChannelQueueManager>>
 ChannelQueueManager::Create(ProcElaboration elaboration) {
+  XLS_RETURN_IF_ERROR(CheckChannelKinds(elaboration));
   std::vector<std::unique_ptr<ChannelQueue>> queues;
 
   // Create a queue per channel instance in the elaboration.
   for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
-    if (channel_instance->channel->kind() != ChannelKind::kStreaming &&
-        channel_instance->channel->kind() != ChannelKind::kSingleValue) {
-      return absl::UnimplementedError(
-          "Only streaming and single-value channels are supported.");
-    }
     queues.push_back(std::make_unique<ChannelQueue>(channel_instance));
   }
 
@@ -180,6 +250,19 @@ ChannelQueueManager::Create(ProcElaboration elaboration) {
       new ChannelQueueManager(std::move(elaboration), std::move(queues)));
 }
 
+/* static */ absl::StatusOr<std::unique_ptr<ChannelQueueManager>>
+ChannelQueueManager::CreateThreadUnsafe(ProcElaboration elaboration) {
+  XLS_RETURN_IF_ERROR(CheckChannelKinds(elaboration));
+  std::vector<std::unique_ptr<ChannelQueue>> queues;
+  for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
+    queues.push_back(
+        std::make_unique<RingBufferChannelQueue>(channel_instance));
+  }
+
+  return absl::WrapUnique(
+      new ChannelQueueManager(std::move(elaboration), std::move(queues)));
+}
+
 ChannelQueueManager::ChannelQueueManager(
     ProcElaboration elaboration,
     std::vector<std::unique_ptr<ChannelQueue>>&& queues)
@@ -40,11 +40,11 @@ namespace xls {
 // Abstract base class for queues which represent channels during IR
 // interpretation. During interpretation of a network of procs each channel
 // instance is backed by exactly one ChannelQueue. ChannelQueues are
-// thread-safe.
+// thread-safe unless constructed otherwise by a derived class.
 class ChannelQueue {
  public:
   explicit ChannelQueue(ChannelInstance* channel_instance)
-      : channel_instance_(channel_instance) {}
+      : ChannelQueue(channel_instance, /*thread_safe=*/true) {}
 
   // Channel queues should not be copyable. There should be no reason to as
   // there is a one-to-one correspondence between channels (which are not
@@ -62,7 +62,7 @@ class ChannelQueue {
 
   // Returns the number of elements currently in the channel queue.
   int64_t GetSize() const {
-    absl::MutexLock lock(&mutex_);
+    absl::MutexLockMaybe lock(thread_safe_ ? &mutex_ : nullptr);
     return GetSizeInternal();
   }
 
@@ -82,7 +82,19 @@ class ChannelQueue {
   using GeneratorFn = std::function<std::optional<Value>()>;
   absl::Status AttachGenerator(GeneratorFn generator);
 
+  // Returns whether a generator is attached to the queue.
+  bool HasGenerator() const {
+    absl::MutexLockMaybe lock(thread_safe_ ? &mutex_ : nullptr);
+    return generator_.has_value();
+  }
+
  protected:
+  // If `thread_safe` is false the queue takes no locks and may only be used
+  // from one thread at a time.
+  ChannelQueue(ChannelInstance* channel_instance, bool thread_safe)
+      : thread_safe_(thread_safe), channel_instance_(channel_instance) {}
+
+  const bool thread_safe_;
   mutable absl::Mutex mutex_;
 
   virtual int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_);
@@ -99,6 +111,37 @@ class ChannelQueue {
   std::optional<GeneratorFn> generator_ ABSL_GUARDED_BY_FIXME(mutex_);
 };
 
+// A single-threaded channel queue for use by runtimes which evaluate every proc
+// on one thread, e.g. the SerialProcRuntime. No locks are taken and values are
+// held in a ring buffer which is sized from the FIFO depth of the channel (if
+// known) and grows when full, as FIFO depths are not enforced by the proc
+// runtimes. Values are moved rather than copied out of the queue on reads.
+class RingBufferChannelQueue : public ChannelQueue {
+ public:
+  // Minimum number of values held in the ring buffer before it grows.
+  static constexpr int64_t kMinCapacity = 16;
+
+  explicit RingBufferChannelQueue(ChannelInstance* channel_instance);
+  ~RingBufferChannelQueue() override = default;
+
+  int64_t capacity() const { return ring_.size(); }
+
+ protected:
+  int64_t GetSizeInternal() const override { return size_; }
+  void WriteInternal(const Value& value) override;
+  std::optional<Value> ReadInternal() override;
+
+ private:
+  // Doubles the capacity of the ring buffer.
+  void Grow();
+
+  std::vector<Value> ring_;
+  // Index in `ring_` of the oldest value.
+  int64_t head_ = 0;
+  // Number of values in the queue.
+  int64_t size_ = 0;
+};
+
 // A functor which returns a sequence of Values when called. Maybe be attached
 // to a ChannelQueue as a generator.
 class FixedValueGenerator {
@@ -141,6 +184,13 @@ class ChannelQueueManager {
       std::vector<std::unique_ptr<ChannelQueue>>&& queues,
       ProcElaboration elaboration);
 
+  // Creates and returns a queue manager from the given elaboration whose
+  // queues are RingBufferChannelQueues. The queues are not thread-safe so the
+  // manager may only be used by runtimes which evaluate all procs on a single
+  // thread.
+  static absl::StatusOr<std::unique_ptr<ChannelQueueManager>>
+  CreateThreadUnsafe(ProcElaboration elaboration);
+
   // Get the channel queue associated with the channel with the given id/name.
   ChannelQueue& GetQueue(ChannelInstance* channel_instance) {
     return *queues_.at(channel_instance);
@@ -0,0 +1,93 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "include/benchmark/benchmark.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/elaboration.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+
+namespace xls {
+namespace {
+
+// Benchmark evaluating writing to the channel then reading from the channel.
+// The number of writes are followed by an equal amount of number of reads.
+// The channel carries a tuple of an array of `state.range(0)` 32-bit elements
+// and a 32-bit scalar so the cost of copying nested Values is included.
+template <typename QueueT>
+static void BM_QueueWriteThenRead(benchmark::State& state) {
+  int64_t array_size = state.range(0);
+
+  Package package("benchmark");
+  Type* type = package.GetTupleType(
+      {package.GetArrayType(array_size, package.GetBitsType(32)),
+       package.GetBitsType(32)});
+  Channel* channel =
+      package
+          .CreateStreamingChannel("my_channel", ChannelOps::kSendReceive, type)
+          .value();
+  ProcElaboration elaboration =
+      ProcElaboration::ElaborateOldStylePackage(&package).value();
+
+  QueueT queue(elaboration.GetUniqueInstance(channel).value());
+
+  int64_t send_count = state.range(1);
+  CHECK(queue.IsEmpty());
+  Value value = ZeroOfType(type);
+  for (auto _ : state) {
+    for (int64_t i = 0; i < send_count; ++i) {
+      CHECK_OK(queue.Write(value));
+    }
+    for (int64_t i = 0; i < send_count; ++i) {
+      std::optional<Value> received = queue.Read();
+      benchmark::DoNotOptimize(received);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * send_count);
+}
+
+// For the following benchmarks, the first element in the pair denotes the
+// number of array elements in each value written/read from the channel queue.
+// The second element in the pair denotes the number of writes and/or reads to
+// the channel queue.
+BENCHMARK(BM_QueueWriteThenRead<ChannelQueue>)
+    ->ArgPair(1, 1)
+    ->ArgPair(1, 128)
+    ->ArgPair(8, 1)
+    ->ArgPair(8, 128)
+    ->ArgPair(64, 1)
+    ->ArgPair(64, 128);
+
+BENCHMARK(BM_QueueWriteThenRead<RingBufferChannelQueue>)
+    ->ArgPair(1, 1)
+    ->ArgPair(1, 128)
+    ->ArgPair(8, 1)
+    ->ArgPair(8, 128)
+    ->ArgPair(64, 1)
+    ->ArgPair(64, 128);
+
+}  // namespace
+}  // namespace xls
+
+BENCHMARK_MAIN();
@@ -14,7 +14,9 @@
 
 #include "xls/interpreter/channel_queue.h"
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -26,17 +28,20 @@
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue_test_base.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/elaboration.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/package.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 namespace {
 
 using status_testing::StatusIs;
 using ::testing::HasSubstr;
+using ::testing::Optional;
 
 // Instantiate and run all the tests in channel_queue_test_base.cc.
 INSTANTIATE_TEST_SUITE_P(ChannelQueueTest, ChannelQueueTestBase,
@@ -46,6 +51,49 @@ INSTANTIATE_TEST_SUITE_P(ChannelQueueTest, ChannelQueueTestBase,
                                    channel_instance);
                              })));
 
+INSTANTIATE_TEST_SUITE_P(RingBufferChannelQueueTest, ChannelQueueTestBase,
+                         testing::Values(ChannelQueueTestParam(
+                             [](ChannelInstance* channel_instance) {
+                               return std::make_unique<RingBufferChannelQueue>(
+                                   channel_instance);
+                             })));
+
+class RingBufferChannelQueueTest : public IrTestBase {};
+
+TEST_F(RingBufferChannelQueueTest, GrowsPastFifoDepth) {
+  Package package(TestName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel(
+          "my_channel", ChannelOps::kSendReceive, package.GetBitsType(32),
+          /*initial_values=*/{}, FifoConfig{.depth = 100, .bypass = false}));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+  RingBufferChannelQueue queue(elaboration.GetUniqueInstance(channel).value());
+  EXPECT_EQ(queue.capacity(), 100);
+
+  // Interleave reads and writes so the values wrap around the ring before it
+  // grows.
+  int64_t next_write = 0;
+  int64_t next_read = 0;
+  for (int64_t i = 0; i < 50; ++i) {
+    XLS_ASSERT_OK(queue.Write(Value(UBits(next_write++, 32))));
+  }
+  for (int64_t i = 0; i < 40; ++i) {
+    EXPECT_THAT(queue.Read(), Optional(Value(UBits(next_read++, 32))));
+  }
+  for (int64_t i = 0; i < 200; ++i) {
+    XLS_ASSERT_OK(queue.Write(Value(UBits(next_write++, 32))));
+  }
+  EXPECT_EQ(queue.GetSize(), 210);
+  EXPECT_GE(queue.capacity(), 210);
+  while (next_read < next_write) {
+    EXPECT_THAT(queue.Read(), Optional(Value(UBits(next_read++, 32))));
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+  EXPECT_EQ(queue.Read(), std::nullopt);
+}
+
 // Separate tests for queue managers.
 class ChannelQueueManagerTest : public IrTestBase {
  protected:
@@ -94,6 +142,30 @@ TEST_F(ChannelQueueManagerTest, ChannelQueueManagerNoChannels) {
   EXPECT_EQ(manager->queues().size(), 0);
 }
 
+TEST_F(ChannelQueueManagerTest, ThreadUnsafeChannelQueueManager) {
+  Package package(TestName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel_a,
+      package.CreateStreamingChannel("a", ChannelOps::kReceiveOnly,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel_b,
+      package.CreateSingleValueChannel("b", ChannelOps::kSendReceive,
+                                       package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ChannelQueueManager> manager,
+      ChannelQueueManager::CreateThreadUnsafe(std::move(elaboration)));
+  EXPECT_EQ(manager->queues().size(), 2);
+  for (Channel* channel : {channel_a, channel_b}) {
+    EXPECT_NE(
+        dynamic_cast<RingBufferChannelQueue*>(&manager->GetQueue(channel)),
+        nullptr);
+  }
+}
+
 TEST_F(ChannelQueueManagerTest, ChannelQueueManagerCustomQueues) {
   Package package(TestName());
   XLS_ASSERT_OK_AND_ASSIGN(
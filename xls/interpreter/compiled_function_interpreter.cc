@@ -0,0 +1,547 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/compiled_function_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/keyword_args.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+
+namespace xls {
+namespace {
+
+// Returns the given bits value as a uint64_t value. If the value exceeds
+// upper_limit, then upper_limit is returned.
+uint64_t BitsToBoundedUint64(const Bits& bits, uint64_t upper_limit) {
+  if (Bits::MinBitCountUnsigned(upper_limit) <= bits.bit_count() &&
+      bits_ops::UGreaterThan(bits, UBits(upper_limit, bits.bit_count()))) {
+    return upper_limit;
+  }
+  // Necessarily the bits value fits in a uint64_t so the value() call is safe.
+  return bits.ToUint64().value();
+}
+
+// Truncates or extends the full-width product `result` of a multiply to the
+// width of the multiply node.
+Bits FitProduct(Bits result, int64_t width, bool is_signed) {
+  if (result.bit_count() > width) {
+    return result.Slice(0, width);
+  }
+  if (result.bit_count() < width) {
+    return is_signed ? bits_ops::SignExtend(result, width)
+                     : bits_ops::ZeroExtend(result, width);
+  }
+  return result;
+}
+
+}  // namespace
+
+// A single lowered function. Each node is assigned a slot in `values_` by its
+// position in a topological sort. Literal slots are filled in at compile time
+// and parameter slots by the caller; every other node has an instruction which
+// writes its slot.
+class CompiledFunctionInterpreter::Program {
+ public:
+  // Lowers `function`, and the functions it calls, into `programs` if not
+  // already present and returns the program for `function`.
+  static absl::StatusOr<Program*> Compile(
+      Function* function,
+      absl::flat_hash_map<Function*, std::unique_ptr<Program>>* programs) {
+    auto [it, inserted] = programs->try_emplace(function);
+    if (!inserted) {
+      XLS_RET_CHECK(it->second != nullptr)
+          << "Recursive call of function " << function->name();
+      return it->second.get();
+    }
+    auto program = std::unique_ptr<Program>(new Program(function));
+    XLS_RETURN_IF_ERROR(program->Lower(programs));
+    Program* result = program.get();
+    (*programs)[function] = std::move(program);
+    return result;
+  }
+
+  // Sets parameter `i` for the next call to Execute. Parameter slots are never
+  // written by the program itself so they retain their values between calls.
+  void SetArg(int64_t i, Value value) {
+    values_[param_slots_[i]] = std::move(value);
+  }
+
+  // Evaluates the function with the currently set arguments, appending any
+  // events to `events`.
+  absl::Status Execute(InterpreterEvents* events);
+
+  // The return value of the most recent call to Execute.
+  const Value& result() const { return values_[return_slot_]; }
+
+ private:
+  struct Instruction {
+    Node* node;
+    Op op;
+    int64_t slot;
+    // The operand slots are operand_slots_[first_operand, first_operand +
+    // operand_count).
+    int64_t first_operand;
+    int64_t operand_count;
+    // The program of the function applied by an invoke, counted_for or map.
+    Program* callee = nullptr;
+  };
+
+  explicit Program(Function* function) : function_(function) {}
+
+  absl::Status Lower(
+      absl::flat_hash_map<Function*, std::unique_ptr<Program>>* programs);
+
+  absl::Status ExecuteInstruction(const Instruction& inst,
+                                  InterpreterEvents* events);
+
+  // Evaluates the instruction with an IrInterpreter. Used for operations
+  // which are uncommon or expensive enough that the cost of populating a
+  // node-to-value map does not matter.
+  absl::Status ExecuteWithIrInterpreter(const Instruction& inst,
+                                        InterpreterEvents* events);
+
+  absl::Status ExecuteCountedFor(const Instruction& inst,
+                                 InterpreterEvents* events);
+
+  const Value& operand(const Instruction& inst, int64_t i) const {
+    return values_[operand_slots_[inst.first_operand + i]];
+  }
+  const Bits& bits_operand(const Instruction& inst, int64_t i) const {
+    return operand(inst, i).bits();
+  }
+  std::vector<Value> operand_values(const Instruction& inst,
+                                    int64_t first = 0) const {
+    std::vector<Value> result;
+    result.reserve(inst.operand_count - first);
+    for (int64_t i = first; i < inst.operand_count; ++i) {
+      result.push_back(operand(inst, i));
+    }
+    return result;
+  }
+
+  Function* function_;
+  std::vector<Instruction> instructions_;
+  std::vector<int64_t> operand_slots_;
+  std::vector<int64_t> param_slots_;
+  int64_t return_slot_ = 0;
+
+  // The value of each node, indexed by slot.
+  std::vector<Value> values_;
+};
+
+absl::Status CompiledFunctionInterpreter::Program::Lower(
+    absl::flat_hash_map<Function*, std::unique_ptr<Program>>* programs) {
+  std::vector<Node*> topo_sort = TopoSort(function_);
+  absl::flat_hash_map<Node*, int64_t> slots;
+  slots.reserve(topo_sort.size());
+  for (Node* node : topo_sort) {
+    int64_t slot = slots.size();
+    slots[node] = slot;
+  }
+  values_.resize(topo_sort.size());
+  for (Param* param : function_->params()) {
+    param_slots_.push_back(slots.at(param));
+  }
+  return_slot_ = slots.at(function_->return_value());
+
+  for (Node* node : topo_sort) {
+    if (node->Is<Param>()) {
+      continue;
+    }
+    if (node->Is<Literal>()) {
+      values_[slots.at(node)] = node->As<Literal>()->value();
+      continue;
+    }
+    Instruction inst{.node = node,
+                     .op = node->op(),
+                     .slot = slots.at(node),
+                     .first_operand =
+                         static_cast<int64_t>(operand_slots_.size()),
+                     .operand_count = node->operand_count()};
+    for (Node* operand : node->operands()) {
+      operand_slots_.push_back(slots.at(operand));
+    }
+    if (node->Is<Invoke>()) {
+      XLS_ASSIGN_OR_RETURN(
+          inst.callee, Compile(node->As<Invoke>()->to_apply(), programs));
+    } else if (node->Is<CountedFor>()) {
+      XLS_ASSIGN_OR_RETURN(inst.callee,
+                           Compile(node->As<CountedFor>()->body(), programs));
+    } else if (node->Is<Map>()) {
+      XLS_ASSIGN_OR_RETURN(inst.callee,
+                           Compile(node->As<Map>()->to_apply(), programs));
+    }
+    instructions_.push_back(inst);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CompiledFunctionInterpreter::Program::Execute(
+    InterpreterEvents* events) {
+  for (const Instruction& inst : instructions_) {
+    XLS_RETURN_IF_ERROR(ExecuteInstruction(inst, events));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CompiledFunctionInterpreter::Program::ExecuteInstruction(
+    const Instruction& inst, InterpreterEvents* events) {
+  Value& result = values_[inst.slot];
+  switch (inst.op) {
+    case Op::kAdd:
+      result =
+          Value(bits_ops::Add(bits_operand(inst, 0), bits_operand(inst, 1)));
+      return absl::OkStatus();
+    case Op::kSub:
+      result =
+          Value(bits_ops::Sub(bits_operand(inst, 0), bits_operand(inst, 1)));
+      return absl::OkStatus();
+    case Op::kNeg:
+      result = Value(bits_ops::Negate(bits_operand(inst, 0)));
+      return absl::OkStatus();
+    case Op::kNot:
+      result = Value(bits_ops::Not(bits_operand(inst, 0)));
+      return absl::OkStatus();
+    case Op::kUMul:
+    case Op::kSMul: {
+      bool is_signed = inst.op == Op::kSMul;
+      Bits product =
+          is_signed
+              ? bits_ops::SMul(bits_operand(inst, 0), bits_operand(inst, 1))
+              : bits_ops::UMul(bits_operand(inst, 0), bits_operand(inst, 1));
+      result = Value(FitProduct(std::move(product),
+                                inst.node->BitCountOrDie(), is_signed));
+      return absl::OkStatus();
+    }
+    case Op::kAnd:
+    case Op::kNand:
+    case Op::kOr:
+    case Op::kNor:
+    case Op::kXor: {
+      Bits accum = bits_operand(inst, 0);
+      for (int64_t i = 1; i < inst.operand_count; ++i) {
+        const Bits& value = bits_operand(inst, i);
+        if (inst.op == Op::kAnd || inst.op == Op::kNand) {
+          accum = bits_ops::And(accum, value);
+        } else if (inst.op == Op::kOr || inst.op == Op::kNor) {
+          accum = bits_ops::Or(accum, value);
+        } else {
+          accum = bits_ops::Xor(accum, value);
+        }
+      }
+      if (inst.op == Op::kNand || inst.op == Op::kNor) {
+        accum = bits_ops::Not(accum);
+      }
+      result = Value(std::move(accum));
+      return absl::OkStatus();
+    }
+    case Op::kAndReduce:
+      result = Value(bits_ops::AndReduce(bits_operand(inst, 0)));
+      return absl::OkStatus();
+    case Op::kOrReduce:
+      result = Value(bits_ops::OrReduce(bits_operand(inst, 0)));
+      return absl::OkStatus();
+    case Op::kXorReduce:
+      result = Value(bits_ops::XorReduce(bits_operand(inst, 0)));
+      return absl::OkStatus();
+    case Op::kEq:
+      result = Value::Bool(operand(inst, 0) == operand(inst, 1));
+      return absl::OkStatus();
+    case Op::kNe:
+      result = Value::Bool(operand(inst, 0) != operand(inst, 1));
+      return absl::OkStatus();
+    case Op::kULt:
+      result = Value::Bool(
+          bits_ops::ULessThan(bits_operand(inst, 0), bits_operand(inst, 1)));
+      return absl::OkStatus();
+    case Op::kULe:
+      result = Value::Bool(bits_ops::ULessThanOrEqual(bits_operand(inst, 0),
+                                                      bits_operand(inst, 1)));
+      return absl::OkStatus();
+    case Op::kUGt:
+      result = Value::Bool(
+          bits_ops::UGreaterThan(bits_operand(inst, 0), bits_operand(inst, 1)));
+      return absl::OkStatus();
+    case Op::kUGe:
+      result = Value::Bool(bits_ops::UGreaterThanOrEqual(
+          bits_operand(inst, 0), bits_operand(inst, 1)));
+      return absl::OkStatus();
+    case Op::kSLt:
+      result = Value::Bool(
+          bits_ops::SLessThan(bits_operand(inst, 0), bits_operand(inst, 1)));
+      return absl::OkStatus();
+    case Op::kSLe:
+      result = Value::Bool(bits_ops::SLessThanOrEqual(bits_operand(inst, 0),
+                                                      bits_operand(inst, 1)));
+      return absl::OkStatus();
+    case Op::kSGt:
+      result = Value::Bool(
+          bits_ops::SGreaterThan(bits_operand(inst, 0), bits_operand(inst, 1)));
+      return absl::OkStatus();
+    case Op::kSGe:
+      result = Value::Bool(bits_ops::SGreaterThanOrEqual(
+          bits_operand(inst, 0), bits_operand(inst, 1)));
+      return absl::OkStatus();
+    case Op::kShll:
+    case Op::kShrl:
+    case Op::kShra: {
+      const Bits& input = bits_operand(inst, 0);
+      int64_t amount =
+          BitsToBoundedUint64(bits_operand(inst, 1), input.bit_count());
+      if (inst.op == Op::kShll) {
+        result = Value(bits_ops::ShiftLeftLogical(input, amount));
+      } else if (inst.op == Op::kShrl) {
+        result = Value(bits_ops::ShiftRightLogical(input, amount));
+      } else {
+        result = Value(bits_ops::ShiftRightArith(input, amount));
+      }
+      return absl::OkStatus();
+    }
+    case Op::kConcat: {
+      std::vector<Bits> pieces;
+      pieces.reserve(inst.operand_count);
+      for (int64_t i = 0; i < inst.operand_count; ++i) {
+        pieces.push_back(bits_operand(inst, i));
+      }
+      result = Value(bits_ops::Concat(pieces));
+      return absl::OkStatus();
+    }
+    case Op::kBitSlice: {
+      BitSlice* bit_slice = inst.node->As<BitSlice>();
+      result = Value(
+          bits_operand(inst, 0).Slice(bit_slice->start(), bit_slice->width()));
+      return absl::OkStatus();
+    }
+    case Op::kDynamicBitSlice: {
+      int64_t width = inst.node->As<DynamicBitSlice>()->width();
+      const Bits& to_slice = bits_operand(inst, 0);
+      const Bits& start = bits_operand(inst, 1);
+      if (bits_ops::UGreaterThanOrEqual(start, to_slice.bit_count())) {
+        // Slice is entirely out-of-bounds. Return value should be all zero
+        // bits.
+        result = Value(Bits(width));
+        return absl::OkStatus();
+      }
+      result = Value(
+          bits_ops::ShiftRightLogical(to_slice, start.ToUint64().value())
+              .Slice(0, width));
+      return absl::OkStatus();
+    }
+    case Op::kZeroExt:
+      result = Value(
+          bits_ops::ZeroExtend(bits_operand(inst, 0),
+                               inst.node->As<ExtendOp>()->new_bit_count()));
+      return absl::OkStatus();
+    case Op::kSignExt:
+      result = Value(
+          bits_ops::SignExtend(bits_operand(inst, 0),
+                               inst.node->As<ExtendOp>()->new_bit_count()));
+      return absl::OkStatus();
+    case Op::kSel: {
+      Select* sel = inst.node->As<Select>();
+      uint64_t case_count = sel->cases().size();
+      // The cases are operands 1 through case_count, followed by the default
+      // value if present.
+      uint64_t selector =
+          BitsToBoundedUint64(bits_operand(inst, 0), case_count);
+      if (selector == case_count) {
+        XLS_RET_CHECK(sel->default_value().has_value());
+      }
+      result = operand(inst, selector + 1);
+      return absl::OkStatus();
+    }
+    case Op::kPrioritySel: {
+      const Bits& selector = bits_operand(inst, 0);
+      for (int64_t i = 0; i < selector.bit_count(); ++i) {
+        if (selector.Get(i)) {
+          result = operand(inst, i + 1);
+          return absl::OkStatus();
+        }
+      }
+      result = ZeroOfType(inst.node->GetType());
+      return absl::OkStatus();
+    }
+    case Op::kGate:
+      if (bits_operand(inst, 0).IsOne()) {
+        result = operand(inst, 1);
+      } else {
+        result = ZeroOfType(inst.node->GetType());
+      }
+      return absl::OkStatus();
+    case Op::kIdentity:
+      result = operand(inst, 0);
+      return absl::OkStatus();
+    case Op::kTuple:
+      result = Value::TupleOwned(operand_values(inst));
+      return absl::OkStatus();
+    case Op::kTupleIndex:
+      result =
+          operand(inst, 0).element(inst.node->As<TupleIndex>()->index());
+      return absl::OkStatus();
+    case Op::kArray:
+      result = Value::ArrayOwned(operand_values(inst));
+      return absl::OkStatus();
+    case Op::kArrayIndex: {
+      const Value* array = &operand(inst, 0);
+      for (int64_t i = 1; i < inst.operand_count; ++i) {
+        array = &array->element(
+            BitsToBoundedUint64(bits_operand(inst, i), array->size() - 1));
+      }
+      result = *array;
+      return absl::OkStatus();
+    }
+    case Op::kAfterAll:
+    case Op::kMinDelay:
+      // These are only meaningful to the compiler and do not actually perform
+      // any computation.
+      result = Value::Token();
+      return absl::OkStatus();
+    case Op::kInvoke: {
+      for (int64_t i = 0; i < inst.operand_count; ++i) {
+        inst.callee->SetArg(i, operand(inst, i));
+      }
+      XLS_RETURN_IF_ERROR(inst.callee->Execute(events));
+      result = inst.callee->result();
+      return absl::OkStatus();
+    }
+    case Op::kCountedFor:
+      return ExecuteCountedFor(inst, events);
+    case Op::kMap: {
+      const Value& input = operand(inst, 0);
+      std::vector<Value> elements;
+      elements.reserve(input.size());
+      for (const Value& element : input.elements()) {
+        inst.callee->SetArg(0, element);
+        XLS_RETURN_IF_ERROR(inst.callee->Execute(events));
+        elements.push_back(inst.callee->result());
+      }
+      XLS_ASSIGN_OR_RETURN(result, Value::Array(elements));
+      return absl::OkStatus();
+    }
+    default:
+      return ExecuteWithIrInterpreter(inst, events);
+  }
+}
+
+absl::Status CompiledFunctionInterpreter::Program::ExecuteCountedFor(
+    const Instruction& inst, InterpreterEvents* events) {
+  CountedFor* counted_for = inst.node->As<CountedFor>();
+  Program* body = inst.callee;
+  int64_t index_width =
+      counted_for->body()->param(0)->GetType()->AsBitsOrDie()->bit_count();
+  // The n-th operand of the counted for feeds the (n+1)-th parameter of the
+  // body as the first two are the induction variable and the loop state. The
+  // loop invariant parameters are untouched by the body so they only need to
+  // be set once.
+  for (int64_t i = 1; i < inst.operand_count; ++i) {
+    body->SetArg(i + 1, operand(inst, i));
+  }
+  Value loop_state = operand(inst, 0);
+  for (int64_t i = 0, iv = 0; i < counted_for->trip_count();
+       ++i, iv += counted_for->stride()) {
+    body->SetArg(0, Value(UBits(iv, index_width)));
+    body->SetArg(1, std::move(loop_state));
+    XLS_RETURN_IF_ERROR(body->Execute(events));
+    loop_state = body->result();
+  }
+  values_[inst.slot] = std::move(loop_state);
+  return absl::OkStatus();
+}
+
+absl::Status CompiledFunctionInterpreter::Program::ExecuteWithIrInterpreter(
+    const Instruction& inst, InterpreterEvents* events) {
+  absl::flat_hash_map<Node*, Value> node_values;
+  node_values.reserve(inst.operand_count + 1);
+  for (int64_t i = 0; i < inst.operand_count; ++i) {
+    // Operands may be duplicated.
+    node_values.try_emplace(inst.node->operand(i), operand(inst, i));
+  }
+  IrInterpreter visitor(&node_values, events);
+  XLS_RETURN_IF_ERROR(inst.node->VisitSingleNode(&visitor));
+  values_[inst.slot] = std::move(node_values.at(inst.node));
+  return absl::OkStatus();
+}
+
+CompiledFunctionInterpreter::CompiledFunctionInterpreter(Function* function)
+    : function_(function) {}
+
+CompiledFunctionInterpreter::~CompiledFunctionInterpreter() = default;
+
+/* static */ absl::StatusOr<std::unique_ptr<CompiledFunctionInterpreter>>
+CompiledFunctionInterpreter::Create(Function* function) {
+  auto interpreter =
+      absl::WrapUnique(new CompiledFunctionInterpreter(function));
+  XLS_ASSIGN_OR_RETURN(interpreter->top_,
+                       Program::Compile(function, &interpreter->programs_));
+  return interpreter;
+}
+
+absl::StatusOr<InterpreterResult<Value>> CompiledFunctionInterpreter::Run(
+    absl::Span<const Value> args) {
+  VLOG(3) << "Interpreting compiled function " << function_->name();
+  if (args.size() != function_->params().size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Function %s wants %d arguments, got %d.", function_->name(),
+        function_->params().size(), args.size()));
+  }
+  for (int64_t argno = 0; argno < args.size(); ++argno) {
+    Type* param_type = function_->param(argno)->GetType();
+    Type* value_type = function_->package()->GetTypeForValue(args[argno]);
+    if (value_type != param_type) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Got argument %s for parameter %d which is not of type %s",
+          args[argno].ToString(), argno, param_type->ToString()));
+    }
+    top_->SetArg(argno, args[argno]);
+  }
+  InterpreterEvents events;
+  XLS_RETURN_IF_ERROR(top_->Execute(&events));
+  VLOG(2) << "Result = " << top_->result();
+  return InterpreterResult<Value>{top_->result(), std::move(events)};
+}
+
+absl::StatusOr<InterpreterResult<Value>>
+CompiledFunctionInterpreter::RunWithKwargs(
+    const absl::flat_hash_map<std::string, Value>& kwargs) {
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> positional_args,
+                       KeywordArgsToPositional(*function_, kwargs));
+  return Run(positional_args);
+}
+
+}  // namespace xls
@@ -0,0 +1,73 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_COMPILED_FUNCTION_INTERPRETER_H_
+#define XLS_INTERPRETER_COMPILED_FUNCTION_INTERPRETER_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// An interpreter for XLS functions which lowers the function once into a
+// topologically ordered array of instructions and then evaluates it in a
+// loop. Operands are referenced by dense slot indices into a value arena which
+// is reused between runs, so unlike InterpretFunction no node-to-value map is
+// built or probed during evaluation. Functions called through invoke,
+// counted_for and map are lowered as well.
+//
+// Produces the same results and events as InterpretFunction. Useful when a
+// function is evaluated many times and the JIT is unavailable.
+//
+// Not thread-safe: each instance must be run by one thread at a time.
+class CompiledFunctionInterpreter {
+ public:
+  static absl::StatusOr<std::unique_ptr<CompiledFunctionInterpreter>> Create(
+      Function* function);
+
+  ~CompiledFunctionInterpreter();
+
+  Function* function() const { return function_; }
+
+  // Runs the function with the given positional arguments. Returns both the
+  // value and any events that happened while running.
+  absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
+
+  // As Run but with the arguments given by name.
+  absl::StatusOr<InterpreterResult<Value>> RunWithKwargs(
+      const absl::flat_hash_map<std::string, Value>& kwargs);
+
+ private:
+  class Program;
+
+  explicit CompiledFunctionInterpreter(Function* function);
+
+  Function* function_;
+
+  // The lowered form of `function_` and of every function it calls,
+  // transitively.
+  absl::flat_hash_map<Function*, std::unique_ptr<Program>> programs_;
+  Program* top_ = nullptr;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_COMPILED_FUNCTION_INTERPRETER_H_
@@ -0,0 +1,152 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/compiled_function_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/ir_evaluator_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FieldsAre;
+using ::testing::HasSubstr;
+using ::xls::status_testing::StatusIs;
+
+absl::StatusOr<InterpreterResult<Value>> CompileAndRun(
+    Function* function, absl::Span<const Value> args) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledFunctionInterpreter> compiled,
+                       CompiledFunctionInterpreter::Create(function));
+  return compiled->Run(args);
+}
+
+absl::StatusOr<InterpreterResult<Value>> CompileAndRunWithKwargs(
+    Function* function, const absl::flat_hash_map<std::string, Value>& kwargs) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledFunctionInterpreter> compiled,
+                       CompiledFunctionInterpreter::Create(function));
+  return compiled->RunWithKwargs(kwargs);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    CompiledFunctionInterpreterTest, IrEvaluatorTestBase,
+    testing::Values(IrEvaluatorTestParam(CompileAndRun,
+                                         CompileAndRunWithKwargs)));
+
+class CompiledFunctionInterpreterTest : public IrTestBase {};
+
+TEST_F(CompiledFunctionInterpreterTest, RunRepeatedly) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+    fn f(x: bits[8], y: bits[8]) -> (bits[8], bits[1]) {
+      literal.1: bits[8] = literal(value=3)
+      add.2: bits[8] = add(x, literal.1)
+      ult.3: bits[1] = ult(add.2, y)
+      sel.4: bits[8] = sel(ult.3, cases=[y, add.2])
+      ret tuple.5: (bits[8], bits[1]) = tuple(sel.4, ult.3)
+    }
+  )",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CompiledFunctionInterpreter> compiled,
+      CompiledFunctionInterpreter::Create(f));
+  for (int64_t x = 0; x < 256; x += 15) {
+    for (int64_t y = 0; y < 256; y += 17) {
+      std::vector<Value> args = {Value(UBits(x, 8)), Value(UBits(y, 8))};
+      XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                               InterpretFunction(f, args));
+      XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> actual,
+                               compiled->Run(args));
+      EXPECT_EQ(actual.value, expected.value) << "x=" << x << " y=" << y;
+    }
+  }
+}
+
+TEST_F(CompiledFunctionInterpreterTest, EventsFromCalledFunctions) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK(ParseFunction(R"(
+    fn body(i: bits[8], accum: bits[8], bump: bits[8]) -> bits[8] {
+      after_all.1: token = after_all()
+      literal.2: bits[1] = literal(value=1)
+      trace.3: token = trace(after_all.1, literal.2, format="accum is {}", data_operands=[accum])
+      add.4: bits[8] = add(accum, i)
+      ret add.5: bits[8] = add(add.4, bump)
+    }
+  )",
+                              p.get())
+                    .status());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+    fn f(init: bits[8], bump: bits[8]) -> bits[8] {
+      counted_for.6: bits[8] = counted_for(init, trip_count=3, stride=2, body=body, invariant_args=[bump])
+      literal.7: bits[8] = literal(value=0)
+      ret invoke.8: bits[8] = invoke(literal.7, counted_for.6, bump, to_apply=body)
+    }
+  )",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CompiledFunctionInterpreter> compiled,
+      CompiledFunctionInterpreter::Create(f));
+  for (int64_t run = 0; run < 2; ++run) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        InterpreterResult<Value> result,
+        compiled->Run({Value(UBits(1, 8)), Value(UBits(10, 8))}));
+    // 1 -> 11 -> 23 -> 37 from the loop then 47 from the invoke.
+    EXPECT_EQ(result.value, Value(UBits(47, 8)));
+    EXPECT_THAT(result.events.trace_msgs,
+                ElementsAre(FieldsAre("accum is 1", 0),
+                            FieldsAre("accum is 11", 0),
+                            FieldsAre("accum is 23", 0),
+                            FieldsAre("accum is 37", 0)));
+  }
+}
+
+TEST_F(CompiledFunctionInterpreterTest, WrongArgumentType) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+    fn f(x: bits[8]) -> bits[8] {
+      ret neg.1: bits[8] = neg(x)
+    }
+  )",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CompiledFunctionInterpreter> compiled,
+      CompiledFunctionInterpreter::Create(f));
+  EXPECT_THAT(compiled->Run({Value(UBits(1, 4))}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("which is not of type bits[8]")));
+  EXPECT_THAT(compiled->Run({}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("wants 1 arguments, got 0")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -34,9 +34,11 @@ namespace {
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
     ProcElaboration elaboration) {
   // Create a queue manager for the queues. This factory verifies that there an
-  // receive only queue for every receive only channel.
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<ChannelQueueManager> queue_manager,
-                       ChannelQueueManager::Create(std::move(elaboration)));
+  // receive only queue for every receive only channel. All procs are
+  // interpreted on one thread so the queues need no locking.
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ChannelQueueManager> queue_manager,
+      ChannelQueueManager::CreateThreadUnsafe(std::move(elaboration)));
 
   // Create a ProcInterpreter for each Proc.
   std::vector<std::unique_ptr<ProcEvaluator>> proc_interpreters;
@@ -3199,6 +3199,26 @@ TEST_P(IrEvaluatorTestBase, WideEncode) {
       IsOkAndHolds(Value(UBits(0x3f, 7))));
 }
 
+TEST_P(IrEvaluatorTestBase, VeryWideEncode) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(R"(
+  package test
+
+  top fn main(x: bits[512]) -> bits[9] {
+    ret encode.1: bits[9] = encode(x)
+  }
+  )"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, package->GetTopAsFunction());
+  for (int64_t i : {0, 1, 63, 64, 255, 300, 511}) {
+    EXPECT_THAT(RunWithNoEvents(function, {Value(Bits::PowerOfTwo(i, 512))}),
+                IsOkAndHolds(Value(UBits(i, 9))))
+        << i;
+  }
+  Bits two_bits =
+      bits_ops::Or(Bits::PowerOfTwo(3, 512), Bits::PowerOfTwo(384, 512));
+  EXPECT_THAT(RunWithNoEvents(function, {Value(two_bits)}),
+              IsOkAndHolds(Value(UBits(387, 9))));
+}
+
 TEST_P(IrEvaluatorTestBase, RunMismatchedType) {
   XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(R"(
   package test
@@ -84,7 +84,7 @@ absl::StatusOr<Value> InterpretNode(Node* node,
 absl::Status IrInterpreter::AddInterpreterEvents(
     const InterpreterEvents& events) {
   for (const TraceMessage& trace_msg : events.trace_msgs) {
-    GetInterpreterEvents().trace_msgs.push_back(trace_msg);
+    GetInterpreterEvents().AddTrace(trace_msg.message, trace_msg.verbosity);
   }
 
   for (const std::string& assert_msg : events.assert_msgs) {
@@ -177,11 +177,11 @@ absl::Status IrInterpreter::HandleSend(Send* send) {
 
 absl::Status IrInterpreter::HandleArray(Array* array) {
   std::vector<Value> operand_values;
+  operand_values.reserve(array->operand_count());
   for (Node* operand : array->operands()) {
     operand_values.push_back(ResolveAsValue(operand));
   }
-  XLS_ASSIGN_OR_RETURN(Value result, Value::Array(operand_values));
-  return SetValueResult(array, result);
+  return SetValueResult(array, Value::ArrayOwned(std::move(operand_values)));
 }
 
 absl::Status IrInterpreter::HandleInputPort(InputPort* input_port) {
@@ -473,8 +473,7 @@ absl::Status IrInterpreter::HandleArrayUpdate(ArrayUpdate* update) {
   }
   XLS_RETURN_IF_ERROR(
       SetArrayElement(index_vector, update_value, &array_elements));
-  XLS_ASSIGN_OR_RETURN(Value result, Value::Array(array_elements));
-  return SetValueResult(update, result);
+  return SetValueResult(update, Value::ArrayOwned(std::move(array_elements)));
 }
 
 absl::Status IrInterpreter::HandleArrayConcat(ArrayConcat* concat) {
@@ -502,7 +501,9 @@ absl::Status IrInterpreter::HandleAssert(Assert* assert_op) {
 }
 
 absl::Status IrInterpreter::HandleTrace(Trace* trace_op) {
-  if (ResolveAsBool(trace_op->condition())) {
+  // Traces which would be dropped are not formatted.
+  if (ResolveAsBool(trace_op->condition()) &&
+      GetInterpreterEvents().ShouldRecordTrace(trace_op->verbosity())) {
     absl::Span<Node* const> arg_nodes = trace_op->args();
     auto arg_node = arg_nodes.begin();
 
@@ -539,10 +540,8 @@ absl::Status IrInterpreter::HandleTrace(Trace* trace_op) {
 
     VLOG(3) << "Trace output: " << trace_output;
 
-    GetInterpreterEvents().trace_msgs.push_back(TraceMessage{
-        .message = trace_output,
-        .verbosity = trace_op->verbosity(),
-    });
+    GetInterpreterEvents().AddTrace(std::move(trace_output),
+                                    trace_op->verbosity());
   }
   return SetValueResult(trace_op, Value::Token());
 }
@@ -790,10 +789,11 @@ absl::Status IrInterpreter::HandleSub(BinOp* sub) {
 
 absl::Status IrInterpreter::HandleTuple(Tuple* tuple) {
   std::vector<Value> tuple_values;
+  tuple_values.reserve(tuple->operand_count());
   for (Node* operand : tuple->operands()) {
     tuple_values.push_back(ResolveAsValue(operand));
   }
-  return SetValueResult(tuple, Value::Tuple(tuple_values));
+  return SetValueResult(tuple, Value::TupleOwned(std::move(tuple_values)));
 }
 
 absl::Status IrInterpreter::HandleTupleIndex(TupleIndex* index) {
@@ -0,0 +1,349 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/parallel_proc_runtime.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/elaboration.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+// Returns the channel instance a send or receive node of the given proc
+// instance communicates on.
+std::optional<ChannelInstance*> GetIoChannelInstance(
+    ProcInstance* proc_instance, Node* node) {
+  std::string_view channel_name = node->Is<Send>()
+                                      ? node->As<Send>()->channel_name()
+                                      : node->As<Receive>()->channel_name();
+  absl::StatusOr<ChannelInstance*> channel_instance =
+      proc_instance->GetChannelInstance(channel_name);
+  if (!channel_instance.ok()) {
+    return std::nullopt;
+  }
+  return *channel_instance;
+}
+
+// Returns true if the network can be partitioned across workers without
+// changing the results. See ParallelProcRuntime for the conditions.
+bool IsDeterministicUnderPartitioning(const ProcElaboration& elaboration) {
+  absl::flat_hash_map<ChannelInstance*, ProcInstance*> sender;
+  absl::flat_hash_map<ChannelInstance*, ProcInstance*> receiver;
+  for (ProcInstance* proc_instance : elaboration.proc_instances()) {
+    for (Node* node : proc_instance->proc()->nodes()) {
+      if (!node->Is<Send>() && !node->Is<Receive>()) {
+        continue;
+      }
+      if (node->Is<Receive>() && !node->As<Receive>()->is_blocking()) {
+        return false;
+      }
+      std::optional<ChannelInstance*> channel_instance =
+          GetIoChannelInstance(proc_instance, node);
+      if (!channel_instance.has_value() ||
+          (*channel_instance)->channel->kind() != ChannelKind::kStreaming) {
+        return false;
+      }
+      auto& endpoint = node->Is<Send>() ? sender : receiver;
+      auto [it, inserted] = endpoint.insert({*channel_instance, proc_instance});
+      if (!inserted && it->second != proc_instance) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+ParallelProcRuntime::Create(
+    std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+    std::unique_ptr<ChannelQueueManager>&& queue_manager,
+    std::optional<int64_t> worker_count) {
+  XLS_RET_CHECK(!worker_count.has_value() || *worker_count >= 1)
+      << "Worker count must be positive.";
+  // Verify there exists exactly one evaluator per proc in the package.
+  absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>> evaluator_map;
+  for (std::unique_ptr<ProcEvaluator>& evaluator : evaluators) {
+    Proc* proc = evaluator->proc();
+    auto [it, inserted] = evaluator_map.insert({proc, std::move(evaluator)});
+    XLS_RET_CHECK(inserted) << absl::StreamFormat(
+        "More than one evaluator given for proc `%s`", proc->name());
+  }
+  for (Proc* proc : queue_manager->elaboration().procs()) {
+    XLS_RET_CHECK(evaluator_map.contains(proc))
+        << absl::StreamFormat("No evaluator given for proc `%s`", proc->name());
+  }
+  XLS_RET_CHECK_EQ(evaluator_map.size(),
+                   queue_manager->elaboration().procs().size())
+      << "More evaluators than procs given.";
+  auto runtime = absl::WrapUnique(new ParallelProcRuntime(
+      std::move(evaluator_map), std::move(queue_manager)));
+  runtime->Initialize(worker_count.value_or(AvailableCPUs()));
+  return std::move(runtime);
+}
+
+void ParallelProcRuntime::Initialize(int64_t worker_count) {
+  absl::Span<ProcInstance* const> instances = elaboration().proc_instances();
+  if (!IsDeterministicUnderPartitioning(elaboration())) {
+    VLOG(1) << absl::StreamFormat(
+        "Proc network in package `%s` cannot be partitioned "
+        "deterministically; evaluating with a single worker",
+        package()->name());
+    worker_count = 1;
+  }
+  worker_count = std::max<int64_t>(
+      1, std::min<int64_t>(worker_count, instances.size()));
+  for (int64_t i = 0; i < worker_count; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  // Distribute the proc instances round-robin across the workers.
+  for (int64_t i = 0; i < instances.size(); ++i) {
+    workers_[i % worker_count]->instances.push_back(instances[i]);
+  }
+  if (worker_count > 1) {
+    for (int64_t i = 0; i < worker_count; ++i) {
+      for (ProcInstance* instance : workers_[i]->instances) {
+        for (Node* node : instance->proc()->nodes()) {
+          if (!node->Is<Receive>()) {
+            continue;
+          }
+          std::optional<ChannelInstance*> channel_instance =
+              GetIoChannelInstance(instance, node);
+          if (channel_instance.has_value()) {
+            receiver_worker_[*channel_instance] = i;
+          }
+        }
+      }
+    }
+  }
+  // The first worker runs on the thread calling TickInternal.
+  for (int64_t i = 1; i < worker_count; ++i) {
+    threads_.push_back(
+        std::make_unique<Thread>([this, i]() { WorkerThreadLoop(i); }));
+  }
+}
+
+ParallelProcRuntime::~ParallelProcRuntime() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+    tick_start_.SignalAll();
+  }
+  // Joins the threads.
+  threads_.clear();
+}
+
+void ParallelProcRuntime::WorkerThreadLoop(int64_t worker_index) {
+  int64_t seen_generation = 0;
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      while (!shutdown_ && tick_generation_ == seen_generation) {
+        tick_start_.Wait(&mutex_);
+      }
+      if (shutdown_) {
+        return;
+      }
+      seen_generation = tick_generation_;
+    }
+    RunWorkerTick(worker_index);
+    absl::MutexLock lock(&mutex_);
+    ++finished_threads_;
+    tick_finished_.Signal();
+  }
+}
+
+void ParallelProcRuntime::NotifyReceiver(ChannelInstance* channel_instance,
+                                         int64_t sender_index) {
+  auto it = receiver_worker_.find(channel_instance);
+  if (it == receiver_worker_.end() || it->second == sender_index) {
+    return;
+  }
+  Worker& receiver = *workers_[it->second];
+  absl::MutexLock lock(&mutex_);
+  receiver.inbox.push_back(channel_instance);
+  if (receiver.idle) {
+    receiver.idle = false;
+    ++active_workers_;
+    receiver.wake.Signal();
+  }
+}
+
+void ParallelProcRuntime::Abort() {
+  absl::MutexLock lock(&mutex_);
+  aborted_ = true;
+  tick_done_ = true;
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    worker->wake.Signal();
+  }
+}
+
+void ParallelProcRuntime::RunWorkerTick(int64_t worker_index) {
+  Worker& worker = *workers_[worker_index];
+  worker.progress_made = false;
+  worker.progress_made_on_io_procs = false;
+  worker.blocked_instances.clear();
+  worker.status = absl::OkStatus();
+
+  std::deque<ProcInstance*> ready_instances(worker.instances.begin(),
+                                            worker.instances.end());
+  while (true) {
+    while (!ready_instances.empty()) {
+      ProcInstance* instance = ready_instances.front();
+      ready_instances.pop_front();
+      ProcEvaluator* evaluator = evaluators_.at(instance->proc()).get();
+
+      VLOG(3) << absl::StreamFormat("Worker %d ticking proc instance `%s`",
+                                    worker_index, instance->GetName());
+      absl::StatusOr<TickResult> tick_result =
+          evaluator->Tick(*continuations_.at(instance));
+      if (!tick_result.ok()) {
+        worker.status = tick_result.status();
+        Abort();
+        return;
+      }
+      VLOG(3) << "Tick result: " << *tick_result;
+
+      worker.progress_made |= tick_result->progress_made;
+      worker.progress_made_on_io_procs |=
+          (tick_result->progress_made && evaluator->ProcHasIoOperations());
+      if (tick_result->execution_state == TickExecutionState::kSentOnChannel) {
+        ChannelInstance* channel_instance = *tick_result->channel_instance;
+        auto blocked_it = worker.blocked_instances.find(channel_instance);
+        if (blocked_it != worker.blocked_instances.end()) {
+          ready_instances.push_back(blocked_it->second);
+          worker.blocked_instances.erase(blocked_it);
+        } else {
+          NotifyReceiver(channel_instance, worker_index);
+        }
+        // This proc instance can go back on the ready queue.
+        ready_instances.push_back(instance);
+      } else if (tick_result->execution_state ==
+                 TickExecutionState::kBlockedOnReceive) {
+        worker.blocked_instances[*tick_result->channel_instance] = instance;
+      }
+    }
+
+    absl::MutexLock lock(&mutex_);
+    if (aborted_) {
+      return;
+    }
+    // Unblock proc instances whose channels were sent on by other workers.
+    // Sends which arrived for proc instances which were not blocked at the
+    // time are observed directly by the proc instance when it is next ticked.
+    for (ChannelInstance* channel_instance : worker.inbox) {
+      auto blocked_it = worker.blocked_instances.find(channel_instance);
+      if (blocked_it != worker.blocked_instances.end()) {
+        ready_instances.push_back(blocked_it->second);
+        worker.blocked_instances.erase(blocked_it);
+      }
+    }
+    worker.inbox.clear();
+    if (!ready_instances.empty()) {
+      continue;
+    }
+
+    // Nothing to do. Go idle until another worker sends to one of our blocked
+    // proc instances or until all workers are idle.
+    worker.idle = true;
+    --active_workers_;
+    if (active_workers_ == 0) {
+      tick_done_ = true;
+      for (std::unique_ptr<Worker>& other : workers_) {
+        other->wake.Signal();
+      }
+    }
+    while (!tick_done_ && worker.inbox.empty()) {
+      worker.wake.Wait(&mutex_);
+    }
+    if (tick_done_) {
+      return;
+    }
+    // The sender marked this worker as active again.
+  }
+}
+
+absl::StatusOr<ParallelProcRuntime::NetworkTickResult>
+ParallelProcRuntime::TickInternal() {
+  VLOG(3) << absl::StreamFormat("TickInternal on package %s with %d workers",
+                                package()->name(), workers_.size());
+  {
+    absl::MutexLock lock(&mutex_);
+    for (std::unique_ptr<Worker>& worker : workers_) {
+      worker->inbox.clear();
+      worker->idle = false;
+    }
+    active_workers_ = workers_.size();
+    tick_done_ = false;
+    aborted_ = false;
+    finished_threads_ = 0;
+    ++tick_generation_;
+    tick_start_.SignalAll();
+  }
+  RunWorkerTick(0);
+  {
+    absl::MutexLock lock(&mutex_);
+    while (finished_threads_ < threads_.size()) {
+      tick_finished_.Wait(&mutex_);
+    }
+  }
+
+  NetworkTickResult result{.progress_made = false,
+                           .progress_made_on_io_procs = false,
+                           .blocked_channel_instances = {}};
+  absl::flat_hash_set<ChannelInstance*> blocked;
+  for (std::unique_ptr<Worker>& worker : workers_) {
+    XLS_RETURN_IF_ERROR(worker->status);
+    result.progress_made |= worker->progress_made;
+    result.progress_made_on_io_procs |= worker->progress_made_on_io_procs;
+    for (const auto& [channel_instance, _] : worker->blocked_instances) {
+      blocked.insert(channel_instance);
+    }
+  }
+  for (ChannelInstance* instance : elaboration().channel_instances()) {
+    if (blocked.contains(instance)) {
+      result.blocked_channel_instances.push_back(instance);
+    }
+  }
+  return result;
+}
+
+}  // namespace xls
@@ -0,0 +1,144 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
+#define XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/elaboration.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// Class for interpreting a network of procs using multiple threads. The proc
+// instances are partitioned across a set of workers and each worker runs on its
+// own thread. Within a network tick a worker evaluates its proc instances until
+// each has completed an iteration or is blocked on a receive. A worker with no
+// runnable proc instances sleeps until a proc instance on another worker sends
+// on a channel one of its proc instances is blocked on. The tick ends when all
+// workers are idle.
+//
+// Results are identical to SerialProcRuntime. This is guaranteed by only
+// partitioning networks which behave as Kahn process networks: every channel
+// is a streaming channel with at most one sending and at most one receiving
+// proc instance, and every receive is blocking. In such networks the state at
+// the end of a tick does not depend on the evaluation order. Other networks
+// are evaluated by a single worker on the calling thread using the same
+// scheduling as SerialProcRuntime.
+//
+// The evaluators must be safe to tick concurrently on different
+// continuations, and the channel queues must be thread-safe.
+class ParallelProcRuntime : public ProcRuntime {
+ public:
+  // Creates and returns a parallel proc network interpreter for the given
+  // evaluators. `worker_count` is the maximum number of workers (threads) used
+  // to evaluate the network. If not specified, the number of available CPUs is
+  // used.
+  static absl::StatusOr<std::unique_ptr<ParallelProcRuntime>> Create(
+      std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      std::optional<int64_t> worker_count = std::nullopt);
+
+  ~ParallelProcRuntime() override;
+
+  // Returns the number of workers the proc instances are partitioned across.
+  int64_t worker_count() const { return workers_.size(); }
+
+ private:
+  struct Worker {
+    // The proc instances evaluated by this worker.
+    std::vector<ProcInstance*> instances;
+
+    // Channel instances with a receiving proc instance in this worker which
+    // have been sent on by other workers since the inbox was last drained.
+    std::vector<ChannelInstance*> inbox;
+
+    // Whether the worker has no runnable proc instances and is waiting on
+    // `wake`.
+    bool idle = false;
+    absl::CondVar wake;
+
+    // Results of the most recent tick. Only accessed by the thread running
+    // the worker during a tick.
+    bool progress_made = false;
+    bool progress_made_on_io_procs = false;
+    absl::flat_hash_map<ChannelInstance*, ProcInstance*> blocked_instances;
+    absl::Status status;
+  };
+
+  ParallelProcRuntime(
+      absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager)
+      : ProcRuntime(std::move(evaluators), std::move(queue_manager)) {}
+
+  // Partitions the proc instances across at most `worker_count` workers and
+  // starts the worker threads.
+  void Initialize(int64_t worker_count);
+
+  absl::StatusOr<NetworkTickResult> TickInternal() override;
+
+  // Body of the threads running workers other than the first. The first
+  // worker runs on the thread calling TickInternal.
+  void WorkerThreadLoop(int64_t worker_index);
+
+  // Evaluates a single tick of the proc instances of the given worker.
+  void RunWorkerTick(int64_t worker_index);
+
+  // Notifies the worker holding the receiving proc instance of
+  // `channel_instance` of a send from the worker `sender_index`.
+  void NotifyReceiver(ChannelInstance* channel_instance, int64_t sender_index);
+
+  // Ends the current tick early because a worker encountered an error.
+  void Abort();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  // Index of the worker holding the receiving proc instance of each channel
+  // instance. Only populated when there is more than one worker.
+  absl::flat_hash_map<ChannelInstance*, int64_t> receiver_worker_;
+
+  absl::Mutex mutex_;
+  // The number of workers which are not idle in the current tick.
+  int64_t active_workers_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Whether the current tick has finished (all workers idle or aborted).
+  bool tick_done_ ABSL_GUARDED_BY(mutex_) = false;
+  bool aborted_ ABSL_GUARDED_BY(mutex_) = false;
+  // Incremented at the start of each tick to start the worker threads.
+  int64_t tick_generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  // The number of worker threads which have finished the current tick.
+  int64_t finished_threads_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::CondVar tick_start_;
+  absl::CondVar tick_finished_;
+
+  std::vector<std::unique_ptr<Thread>> threads_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
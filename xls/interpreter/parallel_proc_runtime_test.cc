@@ -0,0 +1,167 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/parallel_proc_runtime.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/interpreter/proc_runtime_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_proc_runtime.h"
+
+namespace xls {
+namespace {
+
+// Instantiate and run all the tests in proc_runtime_test_base.cc using
+// the parallel JIT runtime.
+INSTANTIATE_TEST_SUITE_P(
+    ParallelProcRuntimeTest, ProcRuntimeTestBase,
+    testing::Values(ProcRuntimeTestParam(
+        "jit_parallel",
+        [](Package* package) -> std::unique_ptr<ProcRuntime> {
+          return CreateJitParallelProcRuntime(package, /*worker_count=*/4)
+              .value();
+        },
+        [](Proc* top) -> std::unique_ptr<ProcRuntime> {
+          return CreateJitParallelProcRuntime(top, /*worker_count=*/4).value();
+        })),
+    [](const testing::TestParamInfo<ProcRuntimeTestBase::ParamType>& info) {
+      return info.param.name();
+    });
+
+class ParallelProcRuntimeTest : public IrTestBase {
+ protected:
+  // Builds a pipeline of `stage_count` procs. Each stage receives a value,
+  // multiplies it by its stage index plus one and adds its running iteration
+  // count, and sends the result to the next stage.
+  void BuildPipeline(Package* package, int64_t stage_count) {
+    std::vector<Channel*> channels;
+    for (int64_t i = 0; i <= stage_count; ++i) {
+      channels.push_back(
+          package
+              ->CreateStreamingChannel(
+                  absl::StrFormat("ch%d", i),
+                  i == 0 ? ChannelOps::kReceiveOnly
+                  : i == stage_count ? ChannelOps::kSendOnly
+                                     : ChannelOps::kSendReceive,
+                  package->GetBitsType(32))
+              .value());
+    }
+    for (int64_t i = 0; i < stage_count; ++i) {
+      ProcBuilder pb(absl::StrFormat("stage%d", i), /*token_name=*/"tok",
+                     package);
+      BValue count = pb.StateElement("count", Value(UBits(0, 32)));
+      BValue receive = pb.Receive(channels[i], pb.GetTokenParam());
+      BValue value = pb.Add(
+          pb.UMul(pb.TupleIndex(receive, 1), pb.Literal(UBits(i + 1, 32))),
+          count);
+      BValue send = pb.Send(channels[i + 1], pb.TupleIndex(receive, 0), value);
+      XLS_ASSERT_OK(
+          pb.Build(send, {pb.Add(count, pb.Literal(UBits(1, 32)))}).status());
+    }
+  }
+
+  std::vector<Value> Run(ProcRuntime* runtime, Package* package,
+                         int64_t input_count) {
+    Channel* input = package->GetChannel("ch0").value();
+    Channel* output =
+        package->GetChannel(absl::StrFormat("ch%d", kStageCount)).value();
+    for (int64_t i = 0; i < input_count; ++i) {
+      CHECK_OK(runtime->queue_manager().GetQueue(input).Write(
+          Value(UBits(i * 7 + 3, 32))));
+    }
+    absl::flat_hash_map<Channel*, int64_t> output_counts = {
+        {output, input_count}};
+    CHECK_OK(runtime->TickUntilOutput(output_counts).status());
+    std::vector<Value> result;
+    while (std::optional<Value> value =
+               runtime->queue_manager().GetQueue(output).Read()) {
+      result.push_back(*value);
+    }
+    return result;
+  }
+
+  static constexpr int64_t kStageCount = 16;
+};
+
+TEST_F(ParallelProcRuntimeTest, PipelineMatchesSerialRuntime) {
+  auto serial_package = CreatePackage();
+  BuildPipeline(serial_package.get(), kStageCount);
+  auto parallel_package = CreatePackage();
+  BuildPipeline(parallel_package.get(), kStageCount);
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto serial_runtime,
+                           CreateJitSerialProcRuntime(serial_package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto parallel_runtime,
+      CreateJitParallelProcRuntime(parallel_package.get(),
+                                   /*worker_count=*/4));
+  EXPECT_EQ(parallel_runtime->worker_count(), 4);
+
+  std::vector<Value> expected =
+      Run(serial_runtime.get(), serial_package.get(), 100);
+  EXPECT_EQ(expected.size(), 100);
+  EXPECT_EQ(Run(parallel_runtime.get(), parallel_package.get(), 100),
+            expected);
+  for (int64_t i = 0; i < kStageCount; ++i) {
+    std::string proc_name = absl::StrFormat("stage%d", i);
+    EXPECT_EQ(parallel_runtime->ResolveState(
+                  parallel_package->GetProc(proc_name).value()),
+              serial_runtime->ResolveState(
+                  serial_package->GetProc(proc_name).value()));
+  }
+}
+
+TEST_F(ParallelProcRuntimeTest, NonBlockingReceiveUsesSingleWorker) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in_ch, p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly,
+                                                 p->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out_ch, p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                                  p->GetBitsType(32)));
+  {
+    ProcBuilder pb("nb", /*token_name=*/"tok", p.get());
+    BValue receive = pb.ReceiveNonBlocking(in_ch, pb.GetTokenParam());
+    BValue send = pb.Send(out_ch, pb.TupleIndex(receive, 0),
+                          pb.TupleIndex(receive, 1));
+    XLS_ASSERT_OK(pb.Build(send, {}).status());
+  }
+  {
+    ProcBuilder pb("other", /*token_name=*/"tok", p.get());
+    XLS_ASSERT_OK(pb.Build(pb.GetTokenParam(), {}).status());
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto runtime, CreateJitParallelProcRuntime(p.get(), /*worker_count=*/4));
+  EXPECT_EQ(runtime->worker_count(), 1);
+}
+
+}  // namespace
+}  // namespace xls
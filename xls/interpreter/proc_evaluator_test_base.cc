@@ -14,6 +14,7 @@
 
 #include "xls/interpreter/proc_evaluator_test_base.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -22,6 +23,7 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
@@ -716,6 +718,46 @@ TEST_P(ProcEvaluatorTestBase, ConditionalNextProc) {
   EXPECT_THAT(queue.Read(), Optional(Value(UBits(2, 32))));
 }
 
+TEST_P(ProcEvaluatorTestBase, ElementwiseArrayStateUpdateProc) {
+  // Create a proc which writes one element of an array state element each
+  // iteration and separately records the previous value of element 0.
+  Package package(TestName());
+  XLS_ASSERT_OK_AND_ASSIGN(Value zeros, Value::UBitsArray({0, 0, 0, 0}, 32));
+  ProcBuilder pb("elementwise", /*token_name=*/"tok", &package);
+  BValue counter = pb.StateElement("counter", Value(UBits(0, 32)));
+  BValue mem = pb.StateElement("mem", zeros);
+  BValue prev = pb.StateElement("prev", Value(UBits(0, 32)));
+  BValue incremented_counter = pb.Add(counter, pb.Literal(UBits(1, 32)));
+  pb.Next(/*param=*/counter, /*value=*/incremented_counter);
+  pb.Next(/*param=*/mem,
+          /*value=*/pb.ArrayUpdate(mem, incremented_counter, {counter}));
+  pb.Next(/*param=*/prev,
+          /*value=*/pb.ArrayIndex(mem, {pb.Literal(UBits(0, 32))}));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build(pb.GetTokenParam()));
+
+  std::unique_ptr<ChannelQueueManager> queue_manager =
+      GetParam().CreateQueueManager(&package);
+  std::unique_ptr<ProcEvaluator> evaluator =
+      GetParam().CreateEvaluator(proc, queue_manager.get());
+  std::unique_ptr<ProcContinuation> continuation = evaluator->NewContinuation(
+      queue_manager->elaboration().GetUniqueInstance(proc).value());
+
+  auto expect_state = [&](int64_t count, absl::Span<const uint64_t> elements,
+                          int64_t prev_value) {
+    EXPECT_THAT(continuation->GetState(),
+                ElementsAre(Value(UBits(count, 32)),
+                            Value::UBitsArray(elements, 32).value(),
+                            Value(UBits(prev_value, 32))));
+  };
+  for (int64_t i = 0; i < 4; ++i) {
+    XLS_ASSERT_OK(evaluator->Tick(*continuation).status());
+  }
+  expect_state(4, {1, 2, 3, 4}, 1);
+  // Out-of-bounds updates leave the array unchanged.
+  XLS_ASSERT_OK(evaluator->Tick(*continuation).status());
+  expect_state(5, {1, 2, 3, 4}, 1);
+}
+
 TEST_P(ProcEvaluatorTestBase, CollidingNextValuesProc) {
   // Create an output-only proc which increments its counter value only every
   // other iteration - but also tries to set the counter value to a different
@@ -151,12 +151,15 @@ class ProcIrInterpreter : public IrInterpreter {
       return SetValueResult(receive, ZeroOfType(receive->GetType()));
     }
 
-    if (receive->is_blocking()) {
-      return SetValueResult(receive, Value::Tuple({Value::Token(), *value}));
+    // Move the received value into the result rather than copying it.
+    std::vector<Value> elements;
+    elements.reserve(3);
+    elements.push_back(Value::Token());
+    elements.push_back(std::move(*value));
+    if (!receive->is_blocking()) {
+      elements.push_back(Value(UBits(1, 1)));
     }
-
-    return SetValueResult(
-        receive, Value::Tuple({Value::Token(), *value, Value(UBits(1, 1))}));
+    return SetValueResult(receive, Value::TupleOwned(std::move(elements)));
   }
 
   absl::Status HandleSend(Send* send) override {
@@ -221,10 +224,10 @@ class ProcIrInterpreter : public IrInterpreter {
   // name.
   absl::StatusOr<ChannelQueue*> GetChannelQueue(std::string_view name) {
     if (proc_instance_->path().has_value()) {
-      // New-style proc-scoped channel.
+      // New-style proc-scoped channel. The channel reference is resolved
+      // through the proc instance rather than by path.
       XLS_ASSIGN_OR_RETURN(ChannelInstance * channel_instance,
-                           queue_manager_->elaboration().GetChannelInstance(
-                               name, *proc_instance_->path()));
+                           proc_instance_->GetChannelInstance(name));
       return &queue_manager_->GetQueue(channel_instance);
     }
     // Old-style global channel.
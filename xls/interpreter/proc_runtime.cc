@@ -34,6 +34,7 @@
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/elaboration.h"
+#include "xls/ir/events.h"
 #include "xls/ir/package.h"
 #include "xls/jit/jit_channel_queue.h"
 
@@ -158,6 +159,14 @@ void ProcRuntime::ResetState() {
   for (ProcInstance* instance : elaboration().proc_instances()) {
     continuations_[instance] =
         evaluators_.at(instance->proc())->NewContinuation(instance);
+    continuations_[instance]->GetEvents().trace_options = trace_options_;
+  }
+}
+
+void ProcRuntime::SetTraceOptions(const TraceOptions& options) {
+  trace_options_ = options;
+  for (auto& [_, continuation] : continuations_) {
+    continuation->GetEvents().trace_options = trace_options_;
   }
 }
 
@@ -109,6 +109,10 @@ class ProcRuntime {
     }
   }
 
+  // Sets how traces are recorded in the events of every proc. The options are
+  // kept across ResetState().
+  void SetTraceOptions(const TraceOptions& options);
+
   const ProcElaboration& elaboration() const {
     return queue_manager_->elaboration();
   }
@@ -132,6 +136,7 @@ class ProcRuntime {
   absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>> evaluators_;
   absl::flat_hash_map<ProcInstance*, std::unique_ptr<ProcContinuation>>
       continuations_;
+  TraceOptions trace_options_;
 };
 
 }  // namespace xls
@@ -25,6 +25,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
@@ -33,6 +34,7 @@
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/elaboration.h"
+#include "xls/ir/events.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/ir_test_base.h"
@@ -44,6 +46,8 @@ namespace {
 
 using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::FieldsAre;
 using ::testing::HasSubstr;
 using ::testing::Optional;
 
@@ -972,5 +976,39 @@ TEST_P(ProcRuntimeTestBase, MultipleNewStyleProcs) {
   EXPECT_THAT(out_queue.Read(), Optional(Value(UBits(10, 32))));
 }
 
+TEST_P(ProcRuntimeTestBase, TraceOptions) {
+  auto package = CreatePackage();
+  ProcBuilder pb(TestName(), /*token_name=*/"tok", package.get());
+  BValue st = pb.StateElement("st", Value(UBits(0, 32)));
+  BValue always = pb.Literal(UBits(1, 1));
+  BValue tok = pb.Trace(pb.GetTokenParam(), always, {st}, "st = {}",
+                        /*verbosity=*/0);
+  tok = pb.Trace(tok, always, {st}, "verbose st = {}", /*verbosity=*/2);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc, pb.Build(tok, {pb.Add(st, pb.Literal(UBits(1, 32)))}));
+
+  std::unique_ptr<ProcRuntime> runtime =
+      GetParam().CreateRuntime(package.get());
+
+  // Traces above the maximum verbosity are dropped.
+  runtime->SetTraceOptions(TraceOptions{.max_verbosity = 1});
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_THAT(runtime->GetInterpreterEvents(proc).trace_msgs,
+              ElementsAre(FieldsAre("st = 0", 0)));
+
+  // Traces passed to a sink are not accumulated. The options survive a reset.
+  std::vector<std::string> streamed;
+  runtime->SetTraceOptions(
+      TraceOptions{.sink = [&](std::string_view message, int64_t verbosity) {
+        streamed.push_back(absl::StrCat(message, "@", verbosity));
+      }});
+  runtime->ResetState();
+  XLS_ASSERT_OK(runtime->Tick());
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_TRUE(runtime->GetInterpreterEvents(proc).trace_msgs.empty());
+  EXPECT_THAT(streamed, ElementsAre("st = 0@0", "verbose st = 0@2", "st = 1@0",
+                                    "verbose st = 1@2"));
+}
+
 }  // namespace
 }  // namespace xls
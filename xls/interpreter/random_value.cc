@@ -15,14 +15,18 @@
 #include "xls/interpreter/random_value.h"
 
 #include <cstdint>
+#include <cstring>
 #include <vector>
 
+#include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/random/bit_gen_ref.h"
 #include "absl/random/distributions.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/ir/bits.h"
@@ -31,8 +35,55 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
+namespace {
+
+// Writes a random value of `type` into `buffer` using the layouts of the
+// leaves of `type` starting at `elements[*leaf_index]`. Leaves are visited
+// and bytes are drawn in the same order as RandomValue.
+void RandomLeavesToNativeLayout(Type* type,
+                                absl::Span<const ElementLayout> elements,
+                                absl::BitGenRef rng, uint8_t* buffer,
+                                int64_t* leaf_index) {
+  if (type->IsTuple()) {
+    TupleType* tuple_type = type->AsTupleOrDie();
+    for (int64_t i = 0; i < tuple_type->size(); ++i) {
+      RandomLeavesToNativeLayout(tuple_type->element_type(i), elements, rng,
+                                 buffer, leaf_index);
+    }
+    return;
+  }
+  if (type->IsArray()) {
+    ArrayType* array_type = type->AsArrayOrDie();
+    for (int64_t i = 0; i < array_type->size(); ++i) {
+      RandomLeavesToNativeLayout(array_type->element_type(), elements, rng,
+                                 buffer, leaf_index);
+    }
+    return;
+  }
+  const ElementLayout& element_layout = elements[(*leaf_index)++];
+  uint8_t* element_buffer = buffer + element_layout.offset;
+  if (type->IsToken()) {
+    std::memset(element_buffer, 0, element_layout.padded_size);
+    return;
+  }
+  // The native layout of bits is little-endian so the i-th random byte is
+  // stored at offset i, as Bits::FromBytes would store it.
+  int64_t bit_count = type->AsBitsOrDie()->bit_count();
+  int64_t byte_count = CeilOfRatio(bit_count, int64_t{8});
+  for (int64_t i = 0; i < byte_count; ++i) {
+    element_buffer[i] = absl::Uniform<uint8_t>(rng);
+  }
+  if (bit_count % 8 != 0) {
+    element_buffer[byte_count - 1] &= (uint8_t{1} << (bit_count % 8)) - 1;
+  }
+  std::memset(element_buffer + byte_count, 0,
+              element_layout.padded_size - byte_count);
+}
+
+}  // namespace
 
 Value RandomValue(Type* type, absl::BitGenRef rng) {
   if (type->IsTuple()) {
@@ -108,4 +159,23 @@ absl::StatusOr<std::vector<Value>> RandomFunctionArguments(
       "or the limit should be increased."));
 }
 
+void RandomValueToNativeLayout(const TypeLayout& layout, absl::BitGenRef rng,
+                               uint8_t* buffer) {
+  int64_t leaf_index = 0;
+  RandomLeavesToNativeLayout(layout.type(), layout.elements(), rng, buffer,
+                             &leaf_index);
+}
+
+void RandomFunctionArgumentsToNativeLayout(
+    absl::Span<const TypeLayout* const> param_layouts, int64_t batch_size,
+    absl::BitGenRef rng, absl::Span<uint8_t* const> buffers) {
+  CHECK_EQ(param_layouts.size(), buffers.size());
+  for (int64_t b = 0; b < batch_size; ++b) {
+    for (int64_t i = 0; i < param_layouts.size(); ++i) {
+      RandomValueToNativeLayout(*param_layouts[i], rng,
+                                buffers[i] + b * param_layouts[i]->size());
+    }
+  }
+}
+
 }  // namespace xls
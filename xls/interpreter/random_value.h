@@ -15,12 +15,16 @@
 #ifndef XLS_INTERPRETER_RANDOM_VALUE_H_
 #define XLS_INTERPRETER_RANDOM_VALUE_H_
 
+#include <cstdint>
 #include <vector>
 
 #include "absl/random/bit_gen_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/function.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -36,6 +40,24 @@ absl::StatusOr<std::vector<Value>> RandomFunctionArguments(
     Function* f, absl::BitGenRef rng, Function* validator,
     int64_t max_attempts);
 
+// Writes a random value of type `layout.type()` directly into `buffer` in the
+// native layout used by the JIT without constructing a Value. The engine is
+// consumed exactly as by RandomValue(layout.type(), rng) so, for the same
+// engine state, the buffer holds the native layout of the value RandomValue
+// would have returned. `buffer` must have room for `layout.size()` bytes.
+void RandomValueToNativeLayout(const TypeLayout& layout, absl::BitGenRef rng,
+                               uint8_t* buffer);
+
+// Writes the arguments of `batch_size` random evaluations of a function whose
+// parameters have the given native layouts, in the form expected by
+// FunctionJit::RunBatchedWithViews: `buffers[i]` receives `batch_size`
+// contiguous values of the i-th parameter, each occupying
+// `param_layouts[i]->size()` bytes. The engine is consumed as by `batch_size`
+// successive calls to RandomFunctionArguments.
+void RandomFunctionArgumentsToNativeLayout(
+    absl::Span<const TypeLayout* const> param_layouts, int64_t batch_size,
+    absl::BitGenRef rng, absl::Span<uint8_t* const> buffers);
+
 }  // namespace xls
 
 #endif  // XLS_INTERPRETER_RANDOM_VALUE_H_
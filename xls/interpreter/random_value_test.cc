@@ -15,6 +15,7 @@
 #include "xls/interpreter/random_value.h"
 
 #include <cstdint>
+#include <memory>
 #include <random>
 #include <vector>
 
@@ -22,8 +23,14 @@
 #include "absl/container/flat_hash_set.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits_ops.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/package.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 namespace {
@@ -112,5 +119,67 @@ TEST(RandomValueTest, RandomOtherTypes) {
   }
 }
 
+TEST(RandomValueTest, NativeLayoutMatchesRandomValue) {
+  Package p("test_package");
+  FunctionBuilder fb("f", &p);
+  fb.Param("x", p.GetBitsType(13));
+  fb.Param("y", p.GetTupleType({p.GetBitsType(1), p.GetTokenType(),
+                                p.GetArrayType(7, p.GetBitsType(65))}));
+  fb.Param("z", p.GetBitsType(0));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+
+  for (Param* param : f->params()) {
+    TypeLayout layout = jit->runtime()->CreateTypeLayout(param->GetType());
+    std::minstd_rand rng_engine0;
+    std::minstd_rand rng_engine1;
+    for (int64_t i = 0; i < 16; ++i) {
+      std::vector<uint8_t> expected(layout.size(), 0xff);
+      layout.ValueToNativeLayout(RandomValue(param->GetType(), rng_engine0),
+                                 expected.data());
+      std::vector<uint8_t> actual(layout.size(), 0xff);
+      RandomValueToNativeLayout(layout, rng_engine1, actual.data());
+      EXPECT_EQ(actual, expected) << param->GetName();
+    }
+  }
+}
+
+TEST(RandomValueTest, NativeLayoutArgumentBatch) {
+  Package p("test_package");
+  FunctionBuilder fb("f", &p);
+  fb.Add(fb.Param("x", p.GetBitsType(24)), fb.Param("y", p.GetBitsType(24)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+
+  constexpr int64_t kBatchSize = 100;
+  std::shared_ptr<const TypeLayout> layout =
+      jit->runtime()->GetTypeLayout(p.GetBitsType(24));
+  ASSERT_EQ(layout->size(), sizeof(uint32_t));
+  std::vector<uint32_t> x(kBatchSize);
+  std::vector<uint32_t> y(kBatchSize);
+  std::vector<uint32_t> result(kBatchSize);
+  std::minstd_rand rng_engine0;
+  RandomFunctionArgumentsToNativeLayout(
+      {layout.get(), layout.get()}, kBatchSize, rng_engine0,
+      {reinterpret_cast<uint8_t*>(x.data()),
+       reinterpret_cast<uint8_t*>(y.data())});
+  InterpreterEvents events;
+  XLS_ASSERT_OK(jit->RunBatchedWithViews(
+      kBatchSize,
+      {reinterpret_cast<uint8_t*>(x.data()),
+       reinterpret_cast<uint8_t*>(y.data())},
+      absl::MakeSpan(reinterpret_cast<uint8_t*>(result.data()),
+                     kBatchSize * sizeof(uint32_t)),
+      &events));
+
+  std::minstd_rand rng_engine1;
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    std::vector<Value> args = RandomFunctionArguments(f, rng_engine1);
+    EXPECT_EQ(x[i], args[0].bits().ToUint64().value()) << i;
+    EXPECT_EQ(y[i], args[1].bits().ToUint64().value()) << i;
+    EXPECT_EQ(result[i], (x[i] + y[i]) & 0xffffff) << i;
+  }
+}
+
 }  // namespace
 }  // namespace xls
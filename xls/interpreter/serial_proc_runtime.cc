@@ -72,8 +72,23 @@ SerialProcRuntime::TickInternal() {
   };
   std::deque<QueueElement> ready_instances;
 
-  // Put all proc instances on the ready list.
+  // Put all proc instances on the ready list except those which are still
+  // blocked on a receive from the previous tick on a channel which has not
+  // received data since. Ticking them again would make no progress.
   for (ProcInstance* instance : elaboration().proc_instances()) {
+    auto blocked_it = blocked_on_.find(instance);
+    if (blocked_it != blocked_on_.end() &&
+        !continuations_.at(instance)->AtStartOfTick()) {
+      ChannelInstance* channel_instance = blocked_it->second;
+      const ChannelQueue& queue = queue_manager().GetQueue(channel_instance);
+      if (queue.IsEmpty() && !queue.HasGenerator()) {
+        VLOG(3) << absl::StreamFormat(
+            "Proc instance `%s` remains blocked on channel instance `%s`",
+            instance->GetName(), channel_instance->ToString());
+        blocked_instances[channel_instance] = instance;
+        continue;
+      }
+    }
     VLOG(3) << absl::StreamFormat("Proc instance `%s` added to ready list",
                                   instance->GetName());
     ready_instances.push_back(
@@ -121,6 +136,10 @@ SerialProcRuntime::TickInternal() {
       blocked_instances[channel_instance] = element.instance;
     }
   }
+  blocked_on_.clear();
+  for (const auto& [channel_instance, instance] : blocked_instances) {
+    blocked_on_[instance] = channel_instance;
+  }
   auto get_blocked_channel_instances = [&]() {
     std::vector<ChannelInstance*> instances;
     for (ChannelInstance* instance : elaboration().channel_instances()) {
@@ -47,6 +47,12 @@ class SerialProcRuntime : public ProcRuntime {
       : ProcRuntime(std::move(evaluators), std::move(queue_manager)) {}
 
   absl::StatusOr<SerialProcRuntime::NetworkTickResult> TickInternal() override;
+
+  // The proc instances which were blocked on a receive at the end of the last
+  // call to TickInternal and the channel instance each is blocked on. Procs
+  // are only resumed once data arrives on that channel instance so idle procs
+  // cost nothing per tick.
+  absl::flat_hash_map<ProcInstance*, ChannelInstance*> blocked_on_;
 };
 
 }  // namespace xls
@@ -14,6 +14,7 @@
 
 #include "xls/interpreter/serial_proc_runtime.h"
 
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -21,6 +22,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/interpreter_proc_runtime.h"
@@ -28,8 +30,11 @@
 #include "xls/interpreter/proc_interpreter.h"
 #include "xls/interpreter/proc_runtime.h"
 #include "xls/interpreter/proc_runtime_test_base.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/elaboration.h"
+#include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
 #include "xls/ir/value.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_proc_runtime.h"
@@ -38,6 +43,8 @@
 namespace xls {
 namespace {
 
+using ::testing::Optional;
+
 // Create a SerialProcRuntime composed of a mix of ProcInterpreters and
 // ProcJits.
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateMixedSerialProcRuntime(
@@ -131,5 +138,112 @@ INSTANTIATE_TEST_SUITE_P(
       return info.param.name();
     });
 
+// Wraps a ProcEvaluator and counts the calls to Tick.
+class CountingProcEvaluator : public ProcEvaluator {
+ public:
+  explicit CountingProcEvaluator(std::unique_ptr<ProcEvaluator> evaluator)
+      : ProcEvaluator(evaluator->proc()), evaluator_(std::move(evaluator)) {}
+
+  std::unique_ptr<ProcContinuation> NewContinuation(
+      ProcInstance* proc_instance) const override {
+    return evaluator_->NewContinuation(proc_instance);
+  }
+
+  absl::StatusOr<TickResult> Tick(
+      ProcContinuation& continuation) const override {
+    ++tick_count_;
+    return evaluator_->Tick(continuation);
+  }
+
+  int64_t tick_count() const { return tick_count_; }
+
+ private:
+  std::unique_ptr<ProcEvaluator> evaluator_;
+  mutable int64_t tick_count_ = 0;
+};
+
+TEST(SerialProcRuntimeTest, BlockedProcsAreOnlyResumedWhenDataArrives) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(
+package test
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="""""")
+chan out(bits[32], id=1, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="""""")
+chan count(bits[32], id=2, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="""""")
+
+proc idle(tok: token, st: bits[32], init={0}) {
+  receive.1: (token, bits[32]) = receive(tok, channel=in)
+  tuple_index.2: token = tuple_index(receive.1, index=0)
+  tuple_index.3: bits[32] = tuple_index(receive.1, index=1)
+  send.4: token = send(tuple_index.2, tuple_index.3, channel=out)
+  next (send.4, st)
+}
+
+proc counter(tok: token, st: bits[32], init={0}) {
+  send.5: token = send(tok, st, channel=count)
+  literal.6: bits[32] = literal(value=1)
+  add.7: bits[32] = add(st, literal.6)
+  next (send.5, add.7)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * idle, package->GetProc("idle"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ProcElaboration elaboration,
+      ProcElaboration::ElaborateOldStylePackage(package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ChannelQueueManager> queue_manager,
+      ChannelQueueManager::CreateThreadUnsafe(std::move(elaboration)));
+  std::vector<std::unique_ptr<ProcEvaluator>> evaluators;
+  CountingProcEvaluator* idle_evaluator = nullptr;
+  for (Proc* proc : queue_manager->elaboration().procs()) {
+    auto evaluator =
+        std::make_unique<ProcInterpreter>(proc, queue_manager.get());
+    if (proc == idle) {
+      auto counting_evaluator =
+          std::make_unique<CountingProcEvaluator>(std::move(evaluator));
+      idle_evaluator = counting_evaluator.get();
+      evaluators.push_back(std::move(counting_evaluator));
+    } else {
+      evaluators.push_back(std::move(evaluator));
+    }
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SerialProcRuntime> runtime,
+      SerialProcRuntime::Create(std::move(evaluators),
+                                std::move(queue_manager)));
+
+  // The idle proc blocks on its receive in the first tick and is not ticked
+  // again while its input channel stays empty.
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_EQ(idle_evaluator->tick_count(), 1);
+  for (int64_t i = 0; i < 10; ++i) {
+    XLS_ASSERT_OK(runtime->Tick());
+  }
+  EXPECT_EQ(idle_evaluator->tick_count(), 1);
+
+  // Data arriving on the channel resumes the proc.
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * in_queue,
+                           runtime->queue_manager().GetQueueByName("in"));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelQueue * out_queue,
+                           runtime->queue_manager().GetQueueByName("out"));
+  XLS_ASSERT_OK(in_queue->Write(Value(UBits(42, 32))));
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_GT(idle_evaluator->tick_count(), 1);
+  EXPECT_THAT(out_queue->Read(), Optional(Value(UBits(42, 32))));
+
+  // Once blocked again the proc is skipped by subsequent ticks.
+  XLS_ASSERT_OK(runtime->Tick());
+  int64_t tick_count = idle_evaluator->tick_count();
+  for (int64_t i = 0; i < 10; ++i) {
+    XLS_ASSERT_OK(runtime->Tick());
+  }
+  EXPECT_EQ(idle_evaluator->tick_count(), tick_count);
+
+  // Resetting the runtime restarts every proc.
+  runtime->ResetState();
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_EQ(idle_evaluator->tick_count(), tick_count + 1);
+}
+
 }  // namespace
 }  // namespace xls
@@ -211,14 +211,11 @@ class AbstractNodeEvaluator : public DfsVisitorWithDefault {
   }
 
   absl::Status HandleIdentity(UnOp* identity) override {
-    XLS_ASSIGN_OR_RETURN(LeafTypeTreeView<LeafValueT> v,
-                         GetCompoundValue(identity->operand(0)));
-    auto elements = v.elements();
-    return SetValue(identity,
-                    LeafTypeTree<LeafValueT>::CreateFromVector(
-                        identity->GetType(),
-                        typename LeafTypeTree<LeafValueT>::DataContainerT(
-                            elements.begin(), elements.end())));
+    XLS_RET_CHECK(values_.contains(identity->operand(0)))
+        << identity->operand(0);
+    // Copying the tree shares its elements rather than duplicating them.
+    LeafTypeTree<LeafValueT> v = values_.at(identity->operand(0));
+    return SetValue(identity, std::move(v));
   }
   absl::Status HandleLiteral(Literal* literal) override {
     XLS_ASSIGN_OR_RETURN(
@@ -454,10 +451,9 @@ class AbstractNodeEvaluator : public DfsVisitorWithDefault {
   }
 
   absl::Status HandleTupleIndex(TupleIndex* index) override {
-    XLS_ASSIGN_OR_RETURN(auto tup, GetCompoundValue(index->operand(0)));
-    auto ltt = tup.AsView({index->index()});
+    XLS_RET_CHECK(values_.contains(index->operand(0))) << index->operand(0);
     return SetValue(index,
-                    LeafTypeTree<LeafValueT>(ltt.type(), ltt.elements()));
+                    values_.at(index->operand(0)).Subtree({index->index()}));
   }
 
   absl::Status HandleUDiv(BinOp* div) override {
@@ -14,17 +14,29 @@
 
 #include "xls/ir/benchmark_support.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <string>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 namespace benchmark_support {
@@ -170,5 +182,179 @@ absl::StatusOr<BValue> GenerateFullyConnectedLayerGraph(
                            fb, absl::MakeSpan(current_layer)));
   return return_value;
 }
+
+namespace {
+
+// Returns the number of bits needed to index `size` elements.
+int64_t IndexWidth(int64_t size) {
+  return std::max(int64_t{1}, Bits::MinBitCountUnsigned(size - 1));
+}
+
+}  // namespace
+
+absl::StatusOr<Function*> GenerateLadder(Package* package, int64_t rungs,
+                                         int64_t bit_width) {
+  XLS_RET_CHECK_GE(rungs, 1);
+  FunctionBuilder fb("ladder", package);
+  BValue a = fb.Param("a", package->GetBitsType(bit_width));
+  BValue b = fb.Param("b", package->GetBitsType(bit_width));
+  for (int64_t i = 0; i < rungs; ++i) {
+    BValue next_a = fb.Add(a, b);
+    BValue next_b = fb.Xor(a, b);
+    a = next_a;
+    b = next_b;
+  }
+  return fb.BuildWithReturnValue(fb.Add(a, b));
+}
+
+absl::StatusOr<Function*> GenerateLargeSelect(Package* package,
+                                              int64_t case_count,
+                                              int64_t bit_width) {
+  XLS_RET_CHECK_GE(case_count, 1);
+  XLS_RET_CHECK_LE(Bits::MinBitCountUnsigned(case_count - 1), bit_width);
+  FunctionBuilder fb("large_select", package);
+  int64_t selector_width = IndexWidth(case_count);
+  BValue selector =
+      fb.Param("selector", package->GetBitsType(selector_width));
+  BValue x = fb.Param("x", package->GetBitsType(bit_width));
+  std::vector<BValue> cases;
+  cases.reserve(case_count);
+  for (int64_t i = 0; i < case_count; ++i) {
+    cases.push_back(fb.Add(x, fb.Literal(UBits(i, bit_width))));
+  }
+  if (case_count == int64_t{1} << selector_width) {
+    return fb.BuildWithReturnValue(fb.Select(selector, cases));
+  }
+  return fb.BuildWithReturnValue(
+      fb.Select(selector, cases, /*default_value=*/x));
+}
+
+absl::StatusOr<Function*> GenerateDynamicArrayAccesses(
+    Package* package, int64_t array_size, int64_t access_count,
+    int64_t element_width) {
+  XLS_RET_CHECK_GE(array_size, 1);
+  XLS_RET_CHECK_GE(access_count, 1);
+  XLS_RET_CHECK_LE(Bits::MinBitCountUnsigned(access_count - 1), element_width);
+  FunctionBuilder fb("dynamic_array_accesses", package);
+  Type* element_type = package->GetBitsType(element_width);
+  int64_t index_width = IndexWidth(array_size);
+  BValue array =
+      fb.Param("array", package->GetArrayType(array_size, element_type));
+  BValue index = fb.Param("index", package->GetBitsType(index_width));
+  BValue v = fb.Param("v", element_type);
+  std::vector<BValue> indices;
+  indices.reserve(access_count);
+  for (int64_t i = 0; i < access_count; ++i) {
+    indices.push_back(
+        fb.Add(index, fb.Literal(UBits(i % array_size, index_width))));
+  }
+  for (int64_t i = 0; i < access_count; ++i) {
+    BValue value = fb.Add(v, fb.Literal(UBits(i, element_width)));
+    array = fb.ArrayUpdate(array, value, {indices[i]});
+  }
+  BValue result = fb.ArrayIndex(array, {indices[0]});
+  for (int64_t i = 1; i < access_count; ++i) {
+    result = fb.Xor(result, fb.ArrayIndex(array, {indices[i]}));
+  }
+  return fb.BuildWithReturnValue(result);
+}
+
+absl::StatusOr<Proc*> GenerateWideStateProc(Package* package,
+                                            int64_t state_element_count,
+                                            int64_t bit_width) {
+  XLS_RET_CHECK_GE(state_element_count, 1);
+  XLS_RET_CHECK_LE(Bits::MinBitCountUnsigned(state_element_count - 1),
+                   bit_width);
+  Type* type = package->GetBitsType(bit_width);
+  XLS_ASSIGN_OR_RETURN(
+      StreamingChannel * out,
+      package->CreateStreamingChannel("wide_state_out", ChannelOps::kSendOnly,
+                                      type));
+  TokenlessProcBuilder pb("wide_state", "tkn", package);
+  std::vector<BValue> state;
+  state.reserve(state_element_count);
+  for (int64_t i = 0; i < state_element_count; ++i) {
+    state.push_back(pb.StateElement(absl::StrCat("s", i),
+                                    Value(UBits(i, bit_width))));
+  }
+  std::vector<BValue> next_state;
+  next_state.reserve(state_element_count);
+  for (int64_t i = 0; i < state_element_count; ++i) {
+    BValue prev = state[(i + state_element_count - 1) % state_element_count];
+    BValue next = state[(i + 1) % state_element_count];
+    next_state.push_back(pb.Add(state[i], pb.Xor(prev, next)));
+  }
+  pb.Send(out, pb.Xor(state));
+  return pb.Build(next_state);
+}
+
+absl::StatusOr<std::vector<Proc*>> GenerateProcNetwork(Package* package,
+                                                       int64_t stage_count,
+                                                       int64_t bit_width) {
+  XLS_RET_CHECK_GE(stage_count, 1);
+  Type* type = package->GetBitsType(bit_width);
+  std::vector<StreamingChannel*> channels;
+  channels.reserve(stage_count + 1);
+  for (int64_t i = 0; i <= stage_count; ++i) {
+    std::string name;
+    ChannelOps ops = ChannelOps::kSendReceive;
+    if (i == 0) {
+      name = "proc_network_in";
+      ops = ChannelOps::kReceiveOnly;
+    } else if (i == stage_count) {
+      name = "proc_network_out";
+      ops = ChannelOps::kSendOnly;
+    } else {
+      name = absl::StrCat("proc_network_", i);
+    }
+    XLS_ASSIGN_OR_RETURN(StreamingChannel * channel,
+                         package->CreateStreamingChannel(name, ops, type));
+    channels.push_back(channel);
+  }
+  std::vector<Proc*> procs;
+  procs.reserve(stage_count);
+  for (int64_t i = 0; i < stage_count; ++i) {
+    TokenlessProcBuilder pb(absl::StrCat("stage_", i), "tkn", package);
+    BValue count = pb.StateElement("count", Value(UBits(0, bit_width)));
+    BValue data = pb.Receive(channels[i]);
+    pb.Send(channels[i + 1], pb.Add(data, count));
+    XLS_ASSIGN_OR_RETURN(
+        Proc * proc,
+        pb.Build({pb.Add(count, pb.Literal(UBits(1, bit_width)))}));
+    procs.push_back(proc);
+  }
+  return procs;
+}
+
+absl::StatusOr<FunctionBase*> GenerateScalingDesign(ScalingDesign design,
+                                                    Package* package,
+                                                    int64_t size) {
+  XLS_RET_CHECK_GE(size, 1);
+  switch (design) {
+    case ScalingDesign::kChain:
+      return GenerateChain(package, size, /*num_children=*/2,
+                           strategy::BinaryAdd(), strategy::DistinctParam(32));
+    case ScalingDesign::kBalancedTree:
+      return GenerateBalancedTree(
+          package, /*depth=*/std::max(int64_t{1}, CeilOfLog2(size)),
+          /*fan_out=*/2, strategy::BinaryAdd(), strategy::DistinctParam(32));
+    case ScalingDesign::kLadder:
+      return GenerateLadder(package, size);
+    case ScalingDesign::kLargeSelect:
+      return GenerateLargeSelect(package, size);
+    case ScalingDesign::kDynamicArray:
+      return GenerateDynamicArrayAccesses(package, /*array_size=*/size,
+                                          /*access_count=*/size);
+    case ScalingDesign::kWideStateProc:
+      return GenerateWideStateProc(package, size);
+    case ScalingDesign::kProcNetwork: {
+      XLS_ASSIGN_OR_RETURN(std::vector<Proc*> procs,
+                           GenerateProcNetwork(package, size));
+      return procs.front();
+    }
+  }
+  return absl::InvalidArgumentError("Unknown scaling design");
+}
+
 }  // namespace benchmark_support
 }  // namespace xls
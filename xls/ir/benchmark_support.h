@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -30,6 +31,7 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/node.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
 
 namespace xls {
 namespace benchmark_support {
@@ -84,6 +86,23 @@ class SharedLiteral final : public NullaryNode {
   mutable std::optional<BValue> inst_;
 };
 
+// A leaf strategy for any location type that always returns a new parameter, so
+// that the generated graph cannot be constant-folded.
+class DistinctParam final : public NullaryNode {
+ public:
+  explicit DistinctParam(int64_t bit_width = 8) : bit_width_(bit_width) {}
+
+  absl::StatusOr<BValue> GenerateNullaryNode(
+      FunctionBuilder& builder) const final {
+    return builder.Param(absl::StrCat("leaf_", count_++),
+                         builder.package()->GetBitsType(bit_width_));
+  }
+
+ private:
+  int64_t bit_width_;
+  mutable int64_t count_ = 0;
+};
+
 // Strategy that determines how to create a node with given inputs in the graph.
 //
 // This is called to generate all non-terminal nodes in the graph.
@@ -307,6 +326,93 @@ absl::StatusOr<BValue> ChainReduce(
     const strategy::NaryNode& interior_node_strategy,
     const strategy::NullaryNode& leaf_strategy, BValue previous_layer);
 
+// The generators below build complete designs whose size grows linearly with
+// their size parameter, for measuring how the cost of an analysis, pass or
+// backend scales with design size. All of them take their inputs from
+// parameters (or channels) so nothing is constant-folded away.
+
+// Generates a 'ladder' of `rungs` rungs between two rails of `bit_width` bits.
+// Each rung computes both rails from both of the previous values so, unlike a
+// chain, the number of paths through the graph grows exponentially with its
+// depth.
+//
+// a_0 = param(a)
+// b_0 = param(b)
+// a_1 = add(a_0, b_0)
+// b_1 = xor(a_0, b_0)
+// ...
+// a_<rungs> = add(a_<rungs - 1>, b_<rungs - 1>)
+// b_<rungs> = xor(a_<rungs - 1>, b_<rungs - 1>)
+// ret = add(a_<rungs>, b_<rungs>)
+absl::StatusOr<Function*> GenerateLadder(Package* package, int64_t rungs,
+                                         int64_t bit_width = 32);
+
+// Generates a function with a single select of `case_count` cases, each a
+// distinct function of the parameter `x`, chosen by the parameter `selector`.
+// The select has a default value if `case_count` is not a power of two.
+//
+// ret = sel(selector, cases=[add(x, 0), add(x, 1), ...,
+//                            add(x, <case_count - 1>)])
+absl::StatusOr<Function*> GenerateLargeSelect(Package* package,
+                                              int64_t case_count,
+                                              int64_t bit_width = 32);
+
+// Generates a function which applies a chain of `access_count` updates at
+// dynamic indices to an array parameter of `array_size` elements of
+// `element_width` bits, then reads `access_count` elements of the result at
+// dynamic indices and returns the xor of the elements read.
+//
+// u_0 = param(array)
+// u_1 = array_update(u_0, add(v, 0), indices=[add(index, 0)])
+// ...
+// u_<access_count> = array_update(u_<access_count - 1>, ...)
+// ret = xor(array_index(u_<access_count>, indices=[add(index, 0)]), ...)
+absl::StatusOr<Function*> GenerateDynamicArrayAccesses(
+    Package* package, int64_t array_size, int64_t access_count,
+    int64_t element_width = 32);
+
+// Generates a proc with `state_element_count` state elements of `bit_width`
+// bits. Each element is updated from itself and its neighbors and the xor of
+// all of the elements is sent on the channel "wide_state_out" each
+// activation.
+absl::StatusOr<Proc*> GenerateWideStateProc(Package* package,
+                                            int64_t state_element_count,
+                                            int64_t bit_width = 32);
+
+// Generates a pipeline of `stage_count` procs connected by streaming channels
+// of `bit_width` bits. The first proc receives from the channel
+// "proc_network_in" and the last sends on "proc_network_out". Each proc adds a
+// running count of its activations to the value it forwards. Returns the procs
+// in pipeline order.
+absl::StatusOr<std::vector<Proc*>> GenerateProcNetwork(Package* package,
+                                                       int64_t stage_count,
+                                                       int64_t bit_width = 32);
+
+// The shapes of design which GenerateScalingDesign can build.
+enum class ScalingDesign : int8_t {
+  // GenerateChain of binary adds of parameters with depth `size`.
+  kChain,
+  // GenerateBalancedTree of binary adds of at least `size` parameters.
+  kBalancedTree,
+  // GenerateLadder with `size` rungs.
+  kLadder,
+  // GenerateLargeSelect with `size` cases.
+  kLargeSelect,
+  // GenerateDynamicArrayAccesses of `size` accesses to a `size`-element array.
+  kDynamicArray,
+  // GenerateWideStateProc with `size` state elements.
+  kWideStateProc,
+  // GenerateProcNetwork with `size` stages. The first proc is returned.
+  kProcNetwork,
+};
+
+// Generates a design of the given shape whose node count is linear in `size`,
+// so that benchmarks can sweep `size` to show how a pass, analysis or backend
+// scales. See the individual generators for details.
+absl::StatusOr<FunctionBase*> GenerateScalingDesign(ScalingDesign design,
+                                                    Package* package,
+                                                    int64_t size);
+
 }  // namespace benchmark_support
 }  // namespace xls
 
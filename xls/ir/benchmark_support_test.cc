@@ -15,6 +15,7 @@
 #include "xls/ir/benchmark_support.h"
 
 #include <array>
+#include <cstdint>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -22,11 +23,16 @@
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
 
 namespace m = ::xls::op_matchers;
 
@@ -34,6 +40,7 @@ namespace xls {
 namespace benchmark_support {
 
 namespace {
+using status_testing::IsOk;
 using status_testing::IsOkAndHolds;
 using testing::Not;
 
@@ -64,6 +71,16 @@ TEST(NullaryNodeStrategy, Distinct) {
               IsOkAndHolds(Not(SameNode(v1))));
   EXPECT_THAT(v1.node(), m::Literal());
 }
+TEST(NullaryNodeStrategy, DistinctParam) {
+  Package p("p");
+  FunctionBuilder fb("test", &p);
+  strategy::DistinctParam strategy(16);
+  XLS_ASSERT_OK_AND_ASSIGN(BValue v1, strategy.GenerateNullaryNode(fb));
+  XLS_ASSERT_OK_AND_ASSIGN(BValue v2, strategy.GenerateNullaryNode(fb));
+  EXPECT_THAT(v1.node(), m::Param("leaf_0"));
+  EXPECT_THAT(v2.node(), m::Param("leaf_1"));
+  EXPECT_EQ(v2.node()->GetType()->GetFlatBitCount(), 16);
+}
 TEST(LayerGraph, GenerateFullSelect) {
   Package p("p");
   // 1 bit leaf so no else branch.
@@ -248,6 +265,125 @@ TEST(Chain, Reduce) {
                          m::Literal(UBits(42, 8)), m::Literal(UBits(42, 8))},
                         m::Literal(UBits(42, 8))));
 }
+
+int64_t CountOps(FunctionBase* f, Op op) {
+  int64_t count = 0;
+  for (Node* node : f->nodes()) {
+    if (node->op() == op) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+TEST(Ladder, Rungs) {
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           GenerateLadder(&p, /*rungs=*/3, /*bit_width=*/8));
+  auto a_1 = m::Add(m::Param("a"), m::Param("b"));
+  auto b_1 = m::Xor(m::Param("a"), m::Param("b"));
+  auto a_2 = m::Add(a_1, b_1);
+  auto b_2 = m::Xor(a_1, b_1);
+  EXPECT_THAT(f->return_value(),
+              m::Add(m::Add(a_2, b_2), m::Xor(a_2, b_2)));
+  EXPECT_EQ(f->node_count(), 2 + 2 * 3 + 1);
+  EXPECT_EQ(f->return_value()->GetType()->GetFlatBitCount(), 8);
+}
+
+TEST(LargeSelect, PowerOfTwoCases) {
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           GenerateLargeSelect(&p, /*case_count=*/4));
+  auto add = m::Add(m::Param("x"), m::Literal());
+  EXPECT_THAT(f->return_value(),
+              m::Select(m::Param("selector"), {add, add, add, add}));
+  EXPECT_EQ(f->param(0)->GetType()->GetFlatBitCount(), 2);
+}
+
+TEST(LargeSelect, DefaultValue) {
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           GenerateLargeSelect(&p, /*case_count=*/5));
+  auto add = m::Add(m::Param("x"), m::Literal());
+  EXPECT_THAT(f->return_value(),
+              m::Select(m::Param("selector"), {add, add, add, add, add},
+                        m::Param("x")));
+  EXPECT_EQ(f->param(0)->GetType()->GetFlatBitCount(), 3);
+  EXPECT_THAT(GenerateLargeSelect(&p, /*case_count=*/512, /*bit_width=*/8),
+              Not(IsOk()));
+}
+
+TEST(DynamicArrayAccesses, Accesses) {
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f,
+      GenerateDynamicArrayAccesses(&p, /*array_size=*/10, /*access_count=*/4,
+                                   /*element_width=*/16));
+  EXPECT_EQ(CountOps(f, Op::kArrayUpdate), 4);
+  EXPECT_EQ(CountOps(f, Op::kArrayIndex), 4);
+  EXPECT_EQ(f->param(0)->GetType()->ToString(), "bits[16][10]");
+  EXPECT_EQ(f->param(1)->GetType()->GetFlatBitCount(), 4);
+  EXPECT_EQ(f->return_value()->GetType()->GetFlatBitCount(), 16);
+}
+
+TEST(WideStateProc, StateElements) {
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc, GenerateWideStateProc(&p, /*state_element_count=*/6,
+                                         /*bit_width=*/16));
+  EXPECT_EQ(proc->GetStateElementCount(), 6);
+  EXPECT_EQ(CountOps(proc, Op::kSend), 1);
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * out, p.GetChannel("wide_state_out"));
+  EXPECT_EQ(out->supported_ops(), ChannelOps::kSendOnly);
+  EXPECT_EQ(out->type()->GetFlatBitCount(), 16);
+}
+
+TEST(ProcNetwork, Stages) {
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Proc*> procs,
+                           GenerateProcNetwork(&p, /*stage_count=*/3));
+  ASSERT_EQ(procs.size(), 3);
+  EXPECT_EQ(p.procs().size(), 3);
+  EXPECT_EQ(p.channels().size(), 4);
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * in, p.GetChannel("proc_network_in"));
+  EXPECT_EQ(in->supported_ops(), ChannelOps::kReceiveOnly);
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * out, p.GetChannel("proc_network_out"));
+  EXPECT_EQ(out->supported_ops(), ChannelOps::kSendOnly);
+  for (Proc* proc : procs) {
+    EXPECT_EQ(CountOps(proc, Op::kReceive), 1);
+    EXPECT_EQ(CountOps(proc, Op::kSend), 1);
+    EXPECT_EQ(proc->GetStateElementCount(), 1);
+  }
+}
+
+TEST(ScalingDesign, NodeCountIsLinearInSize) {
+  for (ScalingDesign design :
+       {ScalingDesign::kChain, ScalingDesign::kBalancedTree,
+        ScalingDesign::kLadder, ScalingDesign::kLargeSelect,
+        ScalingDesign::kDynamicArray, ScalingDesign::kWideStateProc,
+        ScalingDesign::kProcNetwork}) {
+    Package small_package("small");
+    XLS_ASSERT_OK_AND_ASSIGN(
+        FunctionBase * small,
+        GenerateScalingDesign(design, &small_package, /*size=*/16));
+    Package large_package("large");
+    XLS_ASSERT_OK_AND_ASSIGN(
+        FunctionBase * large,
+        GenerateScalingDesign(design, &large_package, /*size=*/64));
+    // Count the nodes of every function base as a proc network grows by adding
+    // procs rather than nodes.
+    int64_t small_count = 0;
+    for (FunctionBase* fb : small_package.GetFunctionBases()) {
+      small_count += fb->node_count();
+    }
+    int64_t large_count = 0;
+    for (FunctionBase* fb : large_package.GetFunctionBases()) {
+      large_count += fb->node_count();
+    }
+    EXPECT_GT(large_count, 3 * small_count) << small->name();
+    EXPECT_LT(large_count, 5 * small_count) << large->name();
+  }
+}
 }  // namespace
 }  // namespace benchmark_support
 }  // namespace xls
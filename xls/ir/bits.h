@@ -299,6 +299,13 @@ inline Bits SBits(int64_t value, int64_t bit_count) {
   return SBitsWithStatus(value, bit_count).value();
 }
 
+// Returns an estimate of the heap memory in bytes held by `bits`. Values of up
+// to 64 bits are stored inline.
+inline int64_t EstimateHeapBytes(const Bits& bits) {
+  int64_t word_count = bits.bitmap().word_count();
+  return word_count > 1 ? word_count * sizeof(uint64_t) : 0;
+}
+
 }  // namespace xls
 
 #endif  // XLS_IR_BITS_H_
@@ -21,6 +21,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/casts.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -51,20 +52,100 @@ Bits TruncateOrSignExtend(Bits bits, int64_t bit_count) {
   return Truncate(std::move(bits), bit_count);
 }
 
+constexpr int64_t kWordBits = 64;
+
+// Fast paths for values which fit in a single word. These avoid the StatusOr
+// overhead of Bits::ToUint64 and UBits as well as any heap allocation.
+
+// Returns the value of `bits` which must have at most 64 bits.
+uint64_t ToWord(const Bits& bits) { return bits.bitmap().GetWord(0); }
+
+// Returns the value of `bits` which must have at most 64 bits interpreted as a
+// two's complement number.
+int64_t ToSignedWord(const Bits& bits) {
+  if (bits.bit_count() == 0) {
+    return 0;
+  }
+  int64_t shift = kWordBits - bits.bit_count();
+  return absl::bit_cast<int64_t>(ToWord(bits) << shift) >> shift;
+}
+
+// Returns a Bits value of width `bit_count` (at most 64) holding the low bits
+// of `word`.
+Bits FromWord(uint64_t word, int64_t bit_count) {
+  return Bits::FromBitmap(InlineBitmap::FromWord(word, bit_count));
+}
+
+// Returns the result of applying `op` to each pair of words of `lhs` and
+// `rhs`. Bits beyond the width of the operands are masked off in the result.
+template <typename F>
+Bits WordwiseOp(const Bits& lhs, const Bits& rhs, F op) {
+  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
+  InlineBitmap result(lhs.bit_count());
+  for (int64_t i = 0; i < result.word_count(); ++i) {
+    result.SetWord(i, op(lhs.bitmap().GetWord(i), rhs.bitmap().GetWord(i)));
+  }
+  return Bits::FromBitmap(std::move(result));
+}
+
+// Returns `bits` shifted towards the MSb by `shift_amount` bits which must be
+// less than the width of `bits`.
+Bits ShiftWordsLeft(const Bits& bits, int64_t shift_amount) {
+  const InlineBitmap& source = bits.bitmap();
+  InlineBitmap result(bits.bit_count());
+  int64_t word_shift = shift_amount / kWordBits;
+  int64_t bit_shift = shift_amount % kWordBits;
+  for (int64_t i = word_shift; i < result.word_count(); ++i) {
+    uint64_t word = source.GetWord(i - word_shift) << bit_shift;
+    if (bit_shift != 0 && i - word_shift > 0) {
+      word |= source.GetWord(i - word_shift - 1) >> (kWordBits - bit_shift);
+    }
+    result.SetWord(i, word);
+  }
+  return Bits::FromBitmap(std::move(result));
+}
+
+// Returns `bits` shifted towards the LSb by `shift_amount` bits which must be
+// less than the width of `bits`. Vacated bits are set to `fill`.
+Bits ShiftWordsRight(const Bits& bits, int64_t shift_amount, bool fill) {
+  const InlineBitmap& source = bits.bitmap();
+  const int64_t word_count = source.word_count();
+  const uint64_t fill_word = fill ? ~uint64_t{0} : uint64_t{0};
+  const int64_t last_word_bits =
+      bits.bit_count() - (word_count - 1) * kWordBits;
+  // Returns the source word `i` with the bits beyond the width of `bits` set
+  // to `fill`.
+  auto source_word = [&](int64_t i) -> uint64_t {
+    if (i >= word_count) {
+      return fill_word;
+    }
+    uint64_t word = source.GetWord(i);
+    if (i == word_count - 1 && last_word_bits < kWordBits) {
+      word |= fill_word & ~Mask(last_word_bits);
+    }
+    return word;
+  };
+  InlineBitmap result(bits.bit_count());
+  int64_t word_shift = shift_amount / kWordBits;
+  int64_t bit_shift = shift_amount % kWordBits;
+  for (int64_t i = 0; i < word_count; ++i) {
+    uint64_t word = source_word(i + word_shift) >> bit_shift;
+    if (bit_shift != 0) {
+      word |= source_word(i + word_shift + 1) << (kWordBits - bit_shift);
+    }
+    result.SetWord(i, word);
+  }
+  return Bits::FromBitmap(std::move(result));
+}
+
 }  // namespace
 
 Bits And(const Bits& lhs, const Bits& rhs) {
   CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    return UBits(lhs.ToUint64().value() & rhs.ToUint64().value(),
-                 lhs.bit_count());
+  if (lhs.bit_count() <= kWordBits) {
+    return FromWord(ToWord(lhs) & ToWord(rhs), lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] & rhs_bytes[i];
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return WordwiseOp(lhs, rhs, [](uint64_t a, uint64_t b) { return a & b; });
 }
 
 Bits NaryAnd(absl::Span<const Bits> operands) {
@@ -77,18 +158,10 @@ Bits NaryAnd(absl::Span<const Bits> operands) {
 
 Bits Or(const Bits& lhs, const Bits& rhs) {
   CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int | rhs_int);
-    return UBits(result, lhs.bit_count());
-  }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] | rhs_bytes[i];
+  if (lhs.bit_count() <= kWordBits) {
+    return FromWord(ToWord(lhs) | ToWord(rhs), lhs.bit_count());
   }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return WordwiseOp(lhs, rhs, [](uint64_t a, uint64_t b) { return a | b; });
 }
 
 Bits NaryOr(absl::Span<const Bits> operands) {
@@ -101,18 +174,10 @@ Bits NaryOr(absl::Span<const Bits> operands) {
 
 Bits Xor(const Bits& lhs, const Bits& rhs) {
   CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int ^ rhs_int);
-    return UBits(result, lhs.bit_count());
-  }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] ^ rhs_bytes[i];
+  if (lhs.bit_count() <= kWordBits) {
+    return FromWord(ToWord(lhs) ^ ToWord(rhs), lhs.bit_count());
   }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return WordwiseOp(lhs, rhs, [](uint64_t a, uint64_t b) { return a ^ b; });
 }
 
 Bits NaryXor(absl::Span<const Bits> operands) {
@@ -125,17 +190,10 @@ Bits NaryXor(absl::Span<const Bits> operands) {
 
 Bits Nand(const Bits& lhs, const Bits& rhs) {
   CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    return UBits(~(lhs.ToUint64().value() & rhs.ToUint64().value()) &
-                     Mask(lhs.bit_count()),
-                 lhs.bit_count());
+  if (lhs.bit_count() <= kWordBits) {
+    return FromWord(~(ToWord(lhs) & ToWord(rhs)), lhs.bit_count());
   }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = ~(bytes[i] & rhs_bytes[i]);
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return WordwiseOp(lhs, rhs, [](uint64_t a, uint64_t b) { return ~(a & b); });
 }
 
 Bits NaryNand(absl::Span<const Bits> operands) {
@@ -148,17 +206,10 @@ Bits NaryNand(absl::Span<const Bits> operands) {
 
 Bits Nor(const Bits& lhs, const Bits& rhs) {
   CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    return UBits(~(lhs.ToUint64().value() | rhs.ToUint64().value()) &
-                     Mask(lhs.bit_count()),
-                 lhs.bit_count());
-  }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = ~(bytes[i] | rhs_bytes[i]);
+  if (lhs.bit_count() <= kWordBits) {
+    return FromWord(~(ToWord(lhs) | ToWord(rhs)), lhs.bit_count());
   }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  return WordwiseOp(lhs, rhs, [](uint64_t a, uint64_t b) { return ~(a | b); });
 }
 
 Bits NaryNor(absl::Span<const Bits> operands) {
@@ -170,15 +221,10 @@ Bits NaryNor(absl::Span<const Bits> operands) {
 }
 
 Bits Not(const Bits& bits) {
-  if (bits.bit_count() <= 64) {
-    return UBits((~bits.ToUint64().value()) & Mask(bits.bit_count()),
-                 bits.bit_count());
+  if (bits.bit_count() <= kWordBits) {
+    return FromWord(~ToWord(bits), bits.bit_count());
   }
-  std::vector<uint8_t> bytes = bits.ToBytes();
-  for (uint8_t& byte : bytes) {
-    byte = ~byte;
-  }
-  return Bits::FromBytes(bytes, bits.bit_count());
+  return WordwiseOp(bits, bits, [](uint64_t a, uint64_t) { return ~a; });
 }
 
 Bits AndReduce(const Bits& operand) {
@@ -198,29 +244,40 @@ Bits XorReduce(const Bits& operand) {
 
 Bits Add(const Bits& lhs, const Bits& rhs) {
   CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int + rhs_int) & Mask(lhs.bit_count());
-    return UBits(result, lhs.bit_count());
+  if (lhs.bit_count() <= kWordBits) {
+    return FromWord(ToWord(lhs) + ToWord(rhs), lhs.bit_count());
   }
-
-  Bits sum = BigInt::Add(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
-                 .ToSignedBits();
-  return TruncateOrSignExtend(std::move(sum), lhs.bit_count());
+  // Ripple the carry through the words. The sum wraps around because the final
+  // word is masked to the width of the operands.
+  InlineBitmap result(lhs.bit_count());
+  uint64_t carry = 0;
+  for (int64_t i = 0; i < result.word_count(); ++i) {
+    uint64_t lhs_word = lhs.bitmap().GetWord(i);
+    uint64_t partial = lhs_word + rhs.bitmap().GetWord(i);
+    uint64_t sum = partial + carry;
+    carry = (partial < lhs_word || sum < partial) ? 1 : 0;
+    result.SetWord(i, sum);
+  }
+  return Bits::FromBitmap(std::move(result));
 }
 
 Bits Sub(const Bits& lhs, const Bits& rhs) {
   CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int - rhs_int) & Mask(lhs.bit_count());
-    return UBits(result, lhs.bit_count());
+  if (lhs.bit_count() <= kWordBits) {
+    return FromWord(ToWord(lhs) - ToWord(rhs), lhs.bit_count());
   }
-  Bits diff = BigInt::Sub(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
-                  .ToSignedBits();
-  return TruncateOrSignExtend(std::move(diff), lhs.bit_count());
+  // Ripple the borrow through the words.
+  InlineBitmap result(lhs.bit_count());
+  uint64_t borrow = 0;
+  for (int64_t i = 0; i < result.word_count(); ++i) {
+    uint64_t lhs_word = lhs.bitmap().GetWord(i);
+    uint64_t rhs_word = rhs.bitmap().GetWord(i);
+    uint64_t partial = lhs_word - rhs_word;
+    uint64_t diff = partial - borrow;
+    borrow = (lhs_word < rhs_word || partial < borrow) ? 1 : 0;
+    result.SetWord(i, diff);
+  }
+  return Bits::FromBitmap(std::move(result));
 }
 
 Bits Increment(const Bits& x) {
@@ -251,11 +308,12 @@ Bits Decrement(const Bits& x) {
 
 Bits SMul(const Bits& lhs, const Bits& rhs) {
   const int64_t result_width = lhs.bit_count() + rhs.bit_count();
-  if (result_width <= 64) {
-    int64_t lhs_int = lhs.ToInt64().value();
-    int64_t rhs_int = rhs.ToInt64().value();
-    int64_t result = lhs_int * rhs_int;
-    return SBits(result, result_width);
+  if (result_width <= kWordBits) {
+    // Multiply as unsigned to avoid signed overflow. The low `result_width`
+    // bits of the product are the same.
+    uint64_t result = absl::bit_cast<uint64_t>(ToSignedWord(lhs)) *
+                      absl::bit_cast<uint64_t>(ToSignedWord(rhs));
+    return FromWord(result, result_width);
   }
 
   BigInt product =
@@ -265,11 +323,8 @@ Bits SMul(const Bits& lhs, const Bits& rhs) {
 
 Bits UMul(const Bits& lhs, const Bits& rhs) {
   const int64_t result_width = lhs.bit_count() + rhs.bit_count();
-  if (result_width <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = lhs_int * rhs_int;
-    return UBits(result, result_width);
+  if (result_width <= kWordBits) {
+    return FromWord(ToWord(lhs) * ToWord(rhs), result_width);
   }
 
   BigInt product =
@@ -281,6 +336,9 @@ Bits UDiv(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits::AllOnes(lhs.bit_count());
   }
+  if (lhs.bit_count() <= kWordBits && rhs.bit_count() <= kWordBits) {
+    return FromWord(ToWord(lhs) / ToWord(rhs), lhs.bit_count());
+  }
   BigInt quotient =
       BigInt::Div(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
   return ZeroExtend(quotient.ToUnsignedBits(), lhs.bit_count());
@@ -290,6 +348,9 @@ Bits UMod(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits(rhs.bit_count());
   }
+  if (lhs.bit_count() <= kWordBits && rhs.bit_count() <= kWordBits) {
+    return FromWord(ToWord(lhs) % ToWord(rhs), rhs.bit_count());
+  }
   BigInt modulo =
       BigInt::Mod(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
   return ZeroExtend(modulo.ToUnsignedBits(), rhs.bit_count());
@@ -309,6 +370,17 @@ Bits SDiv(const Bits& lhs, const Bits& rhs) {
     // 0b0111...111.
     return ZeroExtend(Bits::AllOnes(lhs.bit_count() - 1), lhs.bit_count());
   }
+  if (lhs.bit_count() <= kWordBits && rhs.bit_count() <= kWordBits) {
+    int64_t lhs_int = ToSignedWord(lhs);
+    int64_t rhs_int = ToSignedWord(rhs);
+    // Dividing the minimum int64_t by -1 overflows so negate instead. The
+    // result is truncated to the width of `lhs` which matches the behavior of
+    // the general case.
+    uint64_t quotient =
+        rhs_int == -1 ? uint64_t{0} - absl::bit_cast<uint64_t>(lhs_int)
+                      : absl::bit_cast<uint64_t>(lhs_int / rhs_int);
+    return FromWord(quotient, lhs.bit_count());
+  }
   BigInt quotient =
       BigInt::Div(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
   return TruncateOrSignExtend(quotient.ToSignedBits(), lhs.bit_count());
@@ -318,6 +390,14 @@ Bits SMod(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits(rhs.bit_count());
   }
+  if (lhs.bit_count() <= kWordBits && rhs.bit_count() <= kWordBits) {
+    int64_t lhs_int = ToSignedWord(lhs);
+    int64_t rhs_int = ToSignedWord(rhs);
+    // The remainder of a division by -1 is always zero, and computing it
+    // directly overflows for the minimum int64_t.
+    int64_t modulo = rhs_int == -1 ? 0 : lhs_int % rhs_int;
+    return FromWord(absl::bit_cast<uint64_t>(modulo), rhs.bit_count());
+  }
   BigInt modulo = BigInt::Mod(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
   return TruncateOrSignExtend(modulo.ToSignedBits(), rhs.bit_count());
 }
@@ -344,6 +424,11 @@ bool ULessThanOrEqual(const Bits& lhs, const Bits& rhs) {
 bool ULessThan(const Bits& lhs, const Bits& rhs) { return UCmp(lhs, rhs) < 0; }
 
 int64_t UCmp(const Bits& lhs, const Bits& rhs) {
+  if (lhs.bit_count() <= kWordBits && rhs.bit_count() <= kWordBits) {
+    uint64_t lhs_word = ToWord(lhs);
+    uint64_t rhs_word = ToWord(rhs);
+    return lhs_word < rhs_word ? -1 : (lhs_word == rhs_word ? 0 : 1);
+  }
   return lhs.bitmap().UCmp(rhs.bitmap());
 }
 
@@ -376,6 +461,9 @@ bool ULessThan(const Bits& lhs, int64_t rhs) {
 }
 
 bool SEqual(const Bits& lhs, const Bits& rhs) {
+  if (lhs.bit_count() <= kWordBits && rhs.bit_count() <= kWordBits) {
+    return ToSignedWord(lhs) == ToSignedWord(rhs);
+  }
   return BigInt::MakeSigned(lhs) == BigInt::MakeSigned(rhs);
 }
 
@@ -392,12 +480,15 @@ bool SGreaterThan(const Bits& lhs, const Bits& rhs) {
 }
 
 bool SLessThanOrEqual(const Bits& lhs, const Bits& rhs) {
+  if (lhs.bit_count() <= kWordBits && rhs.bit_count() <= kWordBits) {
+    return ToSignedWord(lhs) <= ToSignedWord(rhs);
+  }
   return SEqual(lhs, rhs) || SLessThan(lhs, rhs);
 }
 
 bool SLessThan(const Bits& lhs, const Bits& rhs) {
-  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
-    return lhs.ToInt64().value() < rhs.ToInt64().value();
+  if (lhs.bit_count() <= kWordBits && rhs.bit_count() <= kWordBits) {
+    return ToSignedWord(lhs) < ToSignedWord(rhs);
   }
   return BigInt::LessThan(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
 }
@@ -447,9 +538,8 @@ Bits Concat(absl::Span<const Bits> inputs) {
 }
 
 Bits Negate(const Bits& bits) {
-  if (bits.bit_count() < 64) {
-    return UBits((-bits.ToInt64().value()) & Mask(bits.bit_count()),
-                 bits.bit_count());
+  if (bits.bit_count() <= kWordBits) {
+    return FromWord(uint64_t{0} - ToWord(bits), bits.bit_count());
   }
   Bits negated = BigInt::Negate(BigInt::MakeSigned(bits)).ToSignedBits();
   return TruncateOrSignExtend(std::move(negated), bits.bit_count());
@@ -461,24 +551,40 @@ Bits Abs(const Bits& bits) {
 
 Bits ShiftLeftLogical(const Bits& bits, int64_t shift_amount) {
   CHECK_GE(shift_amount, 0);
-  shift_amount = std::min(shift_amount, bits.bit_count());
-  return Concat(
-      {bits.Slice(0, bits.bit_count() - shift_amount), UBits(0, shift_amount)});
+  if (shift_amount >= bits.bit_count()) {
+    return Bits(bits.bit_count());
+  }
+  if (bits.bit_count() <= kWordBits) {
+    return FromWord(ToWord(bits) << shift_amount, bits.bit_count());
+  }
+  return ShiftWordsLeft(bits, shift_amount);
 }
 
 Bits ShiftRightLogical(const Bits& bits, int64_t shift_amount) {
   CHECK_GE(shift_amount, 0);
-  shift_amount = std::min(shift_amount, bits.bit_count());
-  return Concat({UBits(0, shift_amount),
-                 bits.Slice(shift_amount, bits.bit_count() - shift_amount)});
+  if (shift_amount >= bits.bit_count()) {
+    return Bits(bits.bit_count());
+  }
+  if (bits.bit_count() <= kWordBits) {
+    return FromWord(ToWord(bits) >> shift_amount, bits.bit_count());
+  }
+  return ShiftWordsRight(bits, shift_amount, /*fill=*/false);
 }
 
 Bits ShiftRightArith(const Bits& bits, int64_t shift_amount) {
   CHECK_GE(shift_amount, 0);
-  shift_amount = std::min(shift_amount, bits.bit_count());
-  return Concat(
-      {bits.msb() ? Bits::AllOnes(shift_amount) : UBits(0, shift_amount),
-       bits.Slice(shift_amount, bits.bit_count() - shift_amount)});
+  if (bits.bit_count() == 0) {
+    return bits;
+  }
+  if (shift_amount >= bits.bit_count()) {
+    return bits.msb() ? Bits::AllOnes(bits.bit_count())
+                      : Bits(bits.bit_count());
+  }
+  if (bits.bit_count() <= kWordBits) {
+    return FromWord(absl::bit_cast<uint64_t>(ToSignedWord(bits) >> shift_amount),
+                    bits.bit_count());
+  }
+  return ShiftWordsRight(bits, shift_amount, /*fill=*/bits.msb());
 }
 
 Bits OneHotLsbToMsb(const Bits& bits) {
@@ -642,8 +748,10 @@ Bits MulpOffsetForSimulation(int64_t result_size, int64_t shift_size) {
   return offset_bits;
 }
 
-std::string BitsToRawDigits(const Bits& bits, FormatPreference preference,
-                            bool emit_leading_zeros) {
+namespace {
+
+void AppendRawDigits(const Bits& bits, FormatPreference preference,
+                     bool emit_leading_zeros, std::string* out) {
   CHECK_NE(preference, FormatPreference::kDefault);
   if (preference == FormatPreference::kSignedDecimal) {
     // Leading zeros don't make a lot of sense in decimal format as there is no
@@ -651,7 +759,12 @@ std::string BitsToRawDigits(const Bits& bits, FormatPreference preference,
     CHECK(!emit_leading_zeros)
         << "emit_leading_zeros not supported for decimal format.";
 
-    return BigInt::MakeSigned(bits).ToDecimalString();
+    if (bits.bit_count() <= 64) {
+      absl::StrAppend(out, bits.ToInt64().value());
+      return;
+    }
+    absl::StrAppend(out, BigInt::MakeSigned(bits).ToDecimalString());
+    return;
   }
 
   if (preference == FormatPreference::kUnsignedDecimal) {
@@ -660,10 +773,16 @@ std::string BitsToRawDigits(const Bits& bits, FormatPreference preference,
     CHECK(!emit_leading_zeros)
         << "emit_leading_zeros not supported for decimal format.";
 
-    return BigInt::MakeUnsigned(bits).ToDecimalString();
+    if (bits.bit_count() <= 64) {
+      absl::StrAppend(out, bits.ToUint64().value());
+      return;
+    }
+    absl::StrAppend(out, BigInt::MakeUnsigned(bits).ToDecimalString());
+    return;
   }
   if (bits.bit_count() == 0) {
-    return "0";
+    out->push_back('0');
+    return;
   }
 
   const bool binary_format = (preference == FormatPreference::kBinary) ||
@@ -682,30 +801,49 @@ std::string BitsToRawDigits(const Bits& bits, FormatPreference preference,
   const bool include_separators = !plain_format;
   const int64_t kSeparatorPeriod = 4;
 
-  std::string result;
+  out->reserve(out->size() + digit_count + digit_count / kSeparatorPeriod);
+  const int64_t start_size = out->size();
   bool eliding_leading_zeros = !emit_leading_zeros;
   for (int64_t digit_no = digit_count - 1; digit_no >= 0; --digit_no) {
     // If including separators, add one every kSeparatorPeriod digits.
     if (include_separators && ((digit_no + 1) % kSeparatorPeriod == 0) &&
-        !result.empty()) {
-      absl::StrAppend(&result, "_");
+        out->size() != start_size) {
+      out->push_back('_');
     }
-    // Slice out a Bits which contains 1 digit.
+    // Digits are 1 or 4 bits wide so they never straddle a word boundary.
     int64_t start = digit_no * digit_width;
     int64_t width = std::min(digit_width, bits.bit_count() - start);
-    // As single digit necessarily fits in a uint64_t, so the value() is safe.
-    uint64_t digit_value = bits.Slice(start, width).ToUint64().value();
+    uint64_t digit_value =
+        (bits.bitmap().GetWord(start / 64) >> (start % 64)) & Mask(width);
     if (digit_value == 0 && eliding_leading_zeros && digit_no != 0) {
       continue;
     }
     eliding_leading_zeros = false;
-    absl::StrAppend(&result, absl::StrFormat("%x", digit_value));
+    out->push_back("0123456789abcdef"[digit_value]);
   }
+}
+
+}  // namespace
+
+std::string BitsToRawDigits(const Bits& bits, FormatPreference preference,
+                            bool emit_leading_zeros) {
+  std::string result;
+  AppendRawDigits(bits, preference, emit_leading_zeros, &result);
   return result;
 }
 
 std::string BitsToString(const Bits& bits, FormatPreference preference,
                          bool include_bit_count) {
+  std::string result;
+  AppendBitsToString(bits, preference, &result);
+  if (include_bit_count) {
+    absl::StrAppendFormat(&result, " [%d bits]", bits.bit_count());
+  }
+  return result;
+}
+
+void AppendBitsToString(const Bits& bits, FormatPreference preference,
+                        std::string* out) {
   if (preference == FormatPreference::kDefault) {
     if (bits.bit_count() <= 64) {
       preference = FormatPreference::kUnsignedDecimal;
@@ -713,17 +851,12 @@ std::string BitsToString(const Bits& bits, FormatPreference preference,
       preference = FormatPreference::kHex;
     }
   }
-  std::string result;
   if (preference == FormatPreference::kBinary) {
-    result = "0b";
+    absl::StrAppend(out, "0b");
   } else if (preference == FormatPreference::kHex) {
-    result = "0x";
+    absl::StrAppend(out, "0x");
   }
-  absl::StrAppend(&result, BitsToRawDigits(bits, preference));
-  if (include_bit_count) {
-    absl::StrAppendFormat(&result, " [%d bits]", bits.bit_count());
-  }
-  return result;
+  AppendRawDigits(bits, preference, /*emit_leading_zeros=*/false, out);
 }
 
 }  // namespace xls
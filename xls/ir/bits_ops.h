@@ -248,6 +248,12 @@ std::string BitsToString(
     const Bits& bits, FormatPreference preference = FormatPreference::kDefault,
     bool include_bit_count = false);
 
+// Appends the BitsToString representation of `bits` (without the bit count) to
+// `out`. Useful for building up the representation of many values without
+// creating a temporary string for each.
+void AppendBitsToString(const Bits& bits, FormatPreference preference,
+                        std::string* out);
+
 // Implementation note: the operator<< and AbslStringify definitions for the
 // Bits datatype are defined here so that we can layer on top of BigNum
 // functionality, which avoids having a massive translation unit for all
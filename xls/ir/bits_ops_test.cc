@@ -14,6 +14,7 @@
 
 #include "xls/ir/bits_ops.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <limits>
@@ -29,6 +30,7 @@
 #include "absl/strings/str_split.h"
 #include "xls/common/status/matchers.h"
 #include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/big_int.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_test_utils.h"
 #include "xls/ir/format_preference.h"
@@ -686,6 +688,99 @@ TEST(BitsOpsTest, ShiftRightArith) {
   EXPECT_EQ(b6_shifted, SBits(-1, 2));
 }
 
+TEST(BitsOpsTest, OneWordSignedDivisionOverflow) {
+  Bits min64 = SBits(std::numeric_limits<int64_t>::min(), 64);
+  EXPECT_EQ(bits_ops::SDiv(min64, SBits(-1, 64)), min64);
+  EXPECT_EQ(bits_ops::SMod(min64, SBits(-1, 64)), Bits(64));
+  EXPECT_EQ(bits_ops::SDiv(SBits(-8, 4), SBits(-1, 4)), SBits(-8, 4));
+  EXPECT_EQ(bits_ops::SMod(SBits(-8, 4), SBits(-1, 4)), Bits(4));
+  EXPECT_EQ(bits_ops::SDiv(SBits(-8, 4), SBits(-1, 64)), SBits(-8, 4));
+}
+
+TEST(BitsOpsTest, MultiWordShifts) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Bits wide_value,
+      ParseNumber("0x8000_0000_0000_0000_0000_0000_0000_0000_1234"));
+  EXPECT_EQ(BitsToString(bits_ops::ShiftLeftLogical(wide_value, 68),
+                         FormatPreference::kHex),
+            "0x1_2340_0000_0000_0000_0000");
+  EXPECT_EQ(BitsToString(bits_ops::ShiftRightLogical(wide_value, 140),
+                         FormatPreference::kHex),
+            "0x8");
+  EXPECT_EQ(BitsToString(bits_ops::ShiftRightArith(wide_value, 140),
+                         FormatPreference::kHex),
+            "0xffff_ffff_ffff_ffff_ffff_ffff_ffff_ffff_fff8");
+  EXPECT_EQ(bits_ops::ShiftRightArith(wide_value, 144),
+            Bits::AllOnes(wide_value.bit_count()));
+  EXPECT_EQ(bits_ops::ShiftLeftLogical(wide_value, 144),
+            Bits(wide_value.bit_count()));
+}
+
+// The word-level implementations of the operations below are checked against
+// BigInt and Concat/Slice based reference implementations.
+Bits TruncateOrSignExtend(const Bits& bits, int64_t bit_count) {
+  if (bits.bit_count() >= bit_count) {
+    return bits.Slice(0, bit_count);
+  }
+  return bits_ops::SignExtend(bits, bit_count);
+}
+
+void AddSubMatchBigInt(const Bits& lhs, const Bits& rhs_unsized) {
+  Bits rhs = bits_ops::ZeroExtend(
+      rhs_unsized.Slice(0, std::min(rhs_unsized.bit_count(), lhs.bit_count())),
+      lhs.bit_count());
+  EXPECT_EQ(bits_ops::Add(lhs, rhs),
+            TruncateOrSignExtend(
+                BigInt::Add(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
+                    .ToSignedBits(),
+                lhs.bit_count()));
+  EXPECT_EQ(bits_ops::Sub(lhs, rhs),
+            TruncateOrSignExtend(
+                BigInt::Sub(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
+                    .ToSignedBits(),
+                lhs.bit_count()));
+}
+FUZZ_TEST(BitsOpsFuzzTest, AddSubMatchBigInt)
+    .WithDomains(ArbitraryBits(), ArbitraryBits());
+
+void SignedDivModMatchBigInt(const Bits& lhs, const Bits& rhs) {
+  if (rhs.IsZero()) {
+    return;
+  }
+  EXPECT_EQ(bits_ops::SDiv(lhs, rhs),
+            TruncateOrSignExtend(
+                BigInt::Div(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
+                    .ToSignedBits(),
+                lhs.bit_count()));
+  EXPECT_EQ(bits_ops::SMod(lhs, rhs),
+            TruncateOrSignExtend(
+                BigInt::Mod(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
+                    .ToSignedBits(),
+                rhs.bit_count()));
+  EXPECT_EQ(bits_ops::SLessThan(lhs, rhs),
+            BigInt::LessThan(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs)));
+  EXPECT_EQ(bits_ops::SEqual(lhs, rhs),
+            BigInt::MakeSigned(lhs) == BigInt::MakeSigned(rhs));
+}
+FUZZ_TEST(BitsOpsFuzzTest, SignedDivModMatchBigInt)
+    .WithDomains(NonemptyBits(), NonemptyBits());
+
+void ShiftsMatchConcat(const Bits& bits, uint8_t shift_amount) {
+  int64_t amount = std::min<int64_t>(shift_amount, bits.bit_count());
+  int64_t remaining = bits.bit_count() - amount;
+  EXPECT_EQ(bits_ops::ShiftLeftLogical(bits, shift_amount),
+            bits_ops::Concat({bits.Slice(0, remaining), Bits(amount)}));
+  EXPECT_EQ(bits_ops::ShiftRightLogical(bits, shift_amount),
+            bits_ops::Concat({Bits(amount), bits.Slice(amount, remaining)}));
+  EXPECT_EQ(bits_ops::ShiftRightArith(bits, shift_amount),
+            bits_ops::Concat(
+                {bits.bit_count() > 0 && bits.msb() ? Bits::AllOnes(amount)
+                                                    : Bits(amount),
+                 bits.Slice(amount, remaining)}));
+}
+FUZZ_TEST(BitsOpsFuzzTest, ShiftsMatchConcat)
+    .WithDomains(ArbitraryBits(), fuzztest::Arbitrary<uint8_t>());
+
 TEST(BitsOpsTest, Negate) {
   EXPECT_EQ(bits_ops::Negate(Bits(0)), Bits(0));
   EXPECT_EQ(bits_ops::Negate(UBits(0, 1)), UBits(0, 1));
@@ -1187,5 +1282,68 @@ void BM_ZeroExtendMove(benchmark::State& state) {
 }
 BENCHMARK(BM_ZeroExtendMove)->Range(33, 1 << 20);
 
+// Benchmarks of the basic operations at widths which exercise both the
+// single-word fast paths and the multi-word implementations.
+void SingleAndMultiWordWidths(benchmark::internal::Benchmark* b) {
+  for (int64_t bit_count : {1, 8, 32, 64, 128, 1024}) {
+    b->Arg(bit_count);
+  }
+}
+
+// Returns a nonzero value of the given width with an irregular bit pattern.
+Bits BenchmarkOperand(int64_t bit_count) {
+  return bits_ops::Or(PrimeBits(bit_count),
+                      bits_ops::ZeroExtend(UBits(1, 1), bit_count));
+}
+
+template <typename F>
+void BM_BinaryOp(benchmark::State& state, F op) {
+  Bits lhs = bits_ops::Not(BenchmarkOperand(state.range(0)));
+  Bits rhs = BenchmarkOperand(state.range(0));
+  for (auto _ : state) {
+    auto v = op(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+
+template <typename F>
+void BM_UnaryOp(benchmark::State& state, F op) {
+  Bits bits = BenchmarkOperand(state.range(0));
+  for (auto _ : state) {
+    auto v = op(bits);
+    benchmark::DoNotOptimize(v);
+  }
+}
+
+#define XLS_BITS_OPS_BINARY_BENCHMARK(name, expr)                         \
+  BENCHMARK_CAPTURE(BM_BinaryOp, name,                                    \
+                    [](const Bits& lhs, const Bits& rhs) { return expr; }) \
+      ->Apply(SingleAndMultiWordWidths)
+#define XLS_BITS_OPS_UNARY_BENCHMARK(name, expr)                             \
+  BENCHMARK_CAPTURE(BM_UnaryOp, name, [](const Bits& bits) { return expr; }) \
+      ->Apply(SingleAndMultiWordWidths)
+
+XLS_BITS_OPS_BINARY_BENCHMARK(And, bits_ops::And(lhs, rhs));
+XLS_BITS_OPS_BINARY_BENCHMARK(Xor, bits_ops::Xor(lhs, rhs));
+XLS_BITS_OPS_BINARY_BENCHMARK(Add, bits_ops::Add(lhs, rhs));
+XLS_BITS_OPS_BINARY_BENCHMARK(Sub, bits_ops::Sub(lhs, rhs));
+XLS_BITS_OPS_BINARY_BENCHMARK(UMul, bits_ops::UMul(lhs, rhs));
+XLS_BITS_OPS_BINARY_BENCHMARK(SMul, bits_ops::SMul(lhs, rhs));
+XLS_BITS_OPS_BINARY_BENCHMARK(UDiv, bits_ops::UDiv(lhs, rhs));
+XLS_BITS_OPS_BINARY_BENCHMARK(SDiv, bits_ops::SDiv(lhs, rhs));
+XLS_BITS_OPS_BINARY_BENCHMARK(SMod, bits_ops::SMod(lhs, rhs));
+XLS_BITS_OPS_BINARY_BENCHMARK(ULessThan, bits_ops::ULessThan(lhs, rhs));
+XLS_BITS_OPS_BINARY_BENCHMARK(SLessThan, bits_ops::SLessThan(lhs, rhs));
+XLS_BITS_OPS_BINARY_BENCHMARK(SEqual, bits_ops::SEqual(lhs, rhs));
+XLS_BITS_OPS_UNARY_BENCHMARK(Not, bits_ops::Not(bits));
+XLS_BITS_OPS_UNARY_BENCHMARK(Negate, bits_ops::Negate(bits));
+XLS_BITS_OPS_UNARY_BENCHMARK(ShiftLeftLogical,
+                             bits_ops::ShiftLeftLogical(bits, 3));
+XLS_BITS_OPS_UNARY_BENCHMARK(ShiftRightArith,
+                             bits_ops::ShiftRightArith(bits, 3));
+
+#undef XLS_BITS_OPS_BINARY_BENCHMARK
+#undef XLS_BITS_OPS_UNARY_BENCHMARK
+
 }  // namespace
 }  // namespace xls
@@ -17,18 +17,17 @@
 #include <algorithm>
 #include <cstdint>
 #include <deque>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <ostream>
 #include <string>
 #include <string_view>
 #include <utility>
-#include <variant>
 #include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/base/nullability.h"
-#include "absl/base/optimization.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
@@ -75,30 +74,20 @@ std::optional<ElaboratedNode> InterInstancePredecessor(
     Instantiation* instantiation = *instance->instantiation();
     CHECK(instance->parent_instance().has_value() &&
           instance->parent_instance().value()->block().has_value());
-    Block* parent_block = *instance->parent_instance().value()->block();
-
-    absl::Span<InstantiationInput* const> inputs =
-        parent_block->GetInstantiationInputs(instantiation);
-    auto iter =
-        absl::c_find_if(inputs, [&node](const InstantiationInput* input) {
-          return input->port_name() == node->As<InputPort>()->name();
-        });
-    if (iter != inputs.end()) {
-      return ElaboratedNode{.node = *iter,
-                            .instance = *instance->parent_instance()};
+    BlockInstance* parent_instance = *instance->parent_instance();
+    Node* input = parent_instance->shared_data()->GetInstantiationNode(
+        instantiation, node);
+    if (input != nullptr) {
+      return ElaboratedNode{.node = input, .instance = parent_instance};
     }
   }
   if (node->Is<InstantiationOutput>()) {
-    InstantiationOutput* instantiation_output = node->As<InstantiationOutput>();
-    BlockInstance* child_instance = instance->instantiation_to_instance().at(
-        instantiation_output->instantiation());
-    if (child_instance->block().has_value()) {
-      Block* child_block = *child_instance->block();
-      absl::StatusOr<OutputPort*> port =
-          child_block->GetOutputPort(instantiation_output->port_name());
-      if (port.ok()) {
-        return ElaboratedNode{.node = *port, .instance = child_instance};
-      }
+    Node* port = instance->shared_data()->GetInstantiatedPort(node);
+    if (port != nullptr) {
+      return ElaboratedNode{
+          .node = port,
+          .instance = instance->instantiation_to_instance().at(
+              node->As<InstantiationOutput>()->instantiation())};
     }
   }
 
@@ -116,16 +105,11 @@ std::optional<ElaboratedNode> InterInstanceSuccessor(
     switch (instantiation->kind()) {
       case InstantiationKind::kBlock: {
         CHECK(instance->parent_instance().value()->block().has_value());
-        Block* parent_block = *instance->parent_instance().value()->block();
-        absl::Span<InstantiationOutput* const> outputs =
-            parent_block->GetInstantiationOutputs(instantiation);
-        auto iter = absl::c_find_if(
-            outputs, [&node](const InstantiationOutput* output) {
-              return output->port_name() == node->As<OutputPort>()->name();
-            });
-        if (iter != outputs.end()) {
-          return ElaboratedNode{.node = *iter,
-                                .instance = *instance->parent_instance()};
+        BlockInstance* parent_instance = *instance->parent_instance();
+        Node* output = parent_instance->shared_data()->GetInstantiationNode(
+            instantiation, node);
+        if (output != nullptr) {
+          return ElaboratedNode{.node = output, .instance = parent_instance};
         }
         return std::nullopt;
       }
@@ -134,16 +118,12 @@ std::optional<ElaboratedNode> InterInstanceSuccessor(
     }
   }
   if (node->Is<InstantiationInput>()) {
-    InstantiationInput* instantiation_input = node->As<InstantiationInput>();
-    BlockInstance* child_instance = instance->instantiation_to_instance().at(
-        instantiation_input->instantiation());
-    if (child_instance->block().has_value()) {
-      Block* child_block = *child_instance->block();
-      absl::StatusOr<InputPort*> port =
-          child_block->GetInputPort(instantiation_input->port_name());
-      if (port.ok()) {
-        return ElaboratedNode{.node = *port, .instance = child_instance};
-      }
+    Node* port = instance->shared_data()->GetInstantiatedPort(node);
+    if (port != nullptr) {
+      return ElaboratedNode{
+          .node = port,
+          .instance = instance->instantiation_to_instance().at(
+              node->As<InstantiationInput>()->instantiation())};
     }
   }
   return std::nullopt;
@@ -455,16 +435,61 @@ std::ostream& operator<<(std::ostream& os,
   return os;
 }
 
+SharedBlockData::SharedBlockData(Block* block)
+    : block_(block), instantiated_ports_(block->node_index_bound(), nullptr) {
+  for (Instantiation* inst : block->GetInstantiations()) {
+    if (inst->kind() != InstantiationKind::kBlock) {
+      continue;
+    }
+    Block* inst_block =
+        down_cast<BlockInstantiation*>(inst)->instantiated_block();
+    std::vector<Node*>& instantiation_nodes = instantiation_nodes_[inst];
+    instantiation_nodes.resize(inst_block->node_index_bound(), nullptr);
+    // If several instantiation nodes refer to the same port the first one is
+    // the one connected to it.
+    auto connect = [&](Node* instantiation_node, Node* port) {
+      instantiated_ports_[instantiation_node->node_index()] = port;
+      Node*& connected = instantiation_nodes[port->node_index()];
+      if (connected == nullptr) {
+        connected = instantiation_node;
+      }
+    };
+    for (InstantiationInput* input : block->GetInstantiationInputs(inst)) {
+      absl::StatusOr<InputPort*> port =
+          inst_block->GetInputPort(input->port_name());
+      if (port.ok()) {
+        connect(input, *port);
+      }
+    }
+    for (InstantiationOutput* output : block->GetInstantiationOutputs(inst)) {
+      absl::StatusOr<OutputPort*> port =
+          inst_block->GetOutputPort(output->port_name());
+      if (port.ok()) {
+        connect(output, *port);
+      }
+    }
+  }
+}
+
+Node* SharedBlockData::GetInstantiationNode(Instantiation* instantiation,
+                                            Node* port) const {
+  auto it = instantiation_nodes_.find(instantiation);
+  if (it == instantiation_nodes_.end()) {
+    return nullptr;
+  }
+  return it->second[port->node_index()];
+}
+
 BlockInstance::BlockInstance(
-    std::optional<Block*> block, std::optional<Instantiation*> instantiation,
-    BlockInstantiationPath&& path,
+    const SharedBlockData* shared_data,
+    std::optional<Instantiation*> instantiation, BlockInstantiationPath&& path,
     std::vector<std::unique_ptr<BlockInstance>> instantiated_blocks)
-    : block_(block),
+    : shared_data_(shared_data),
       instantiation_(instantiation),
       path_(std::move(path)),
       register_prefix_(MakeRegisterPrefix(path_)),
       child_instances_(std::move(instantiated_blocks)) {
-  if (!block.has_value()) {
+  if (shared_data == nullptr) {
     return;
   }
   instantiation_to_instance_.reserve(child_instances_.size());
@@ -477,26 +502,6 @@ BlockInstance::BlockInstance(
     instantiation_to_instance_.insert(
         {*child_instance->instantiation(), child_instance.get()});
   }
-  for (Instantiation* inst : block.value()->GetInstantiations()) {
-    if (inst->kind() != InstantiationKind::kBlock) {
-      continue;
-    }
-    Block* inst_block =
-        down_cast<BlockInstantiation*>(inst)->instantiated_block();
-    for (const Block::Port& port : inst_block->GetPorts()) {
-      if (std::holds_alternative<Block::ClockPort*>(port)) {
-        continue;
-      }
-      Node* node;
-      if (std::holds_alternative<InputPort*>(port)) {
-        node = std::get<InputPort*>(port);
-      } else if (std::holds_alternative<OutputPort*>(port)) {
-        node = std::get<OutputPort*>(port);
-      } else {
-        ABSL_UNREACHABLE();
-      }
-    }
-  }
 }
 
 std::string BlockInstance::ToString() const {
@@ -510,7 +515,9 @@ std::string BlockInstance::ToString() const {
 
 static absl::StatusOr<std::unique_ptr<BlockInstance>> ElaborateBlock(
     Block* block, std::optional<Instantiation*> instantiation,
-    BlockInstantiationPath&& path) {
+    BlockInstantiationPath&& path,
+    absl::flat_hash_map<Block*, std::unique_ptr<SharedBlockData>>&
+        shared_data) {
   std::vector<std::unique_ptr<BlockInstance>> instantiated_blocks;
   for (Instantiation* inst : block->GetInstantiations()) {
     BlockInstantiationPath instantiation_path = path;
@@ -538,20 +545,25 @@ static absl::StatusOr<std::unique_ptr<BlockInstance>> ElaborateBlock(
     if (inst_block != nullptr) {
       XLS_ASSIGN_OR_RETURN(
           std::unique_ptr<BlockInstance> subblock_instance,
-          ElaborateBlock(inst_block, inst, std::move(instantiation_path)));
+          ElaborateBlock(inst_block, inst, std::move(instantiation_path),
+                         shared_data));
       instantiated_blocks.push_back(std::move(subblock_instance));
     } else {
       // No need to elaborate further, this is a non-block instance.
       // Just add an instance and continue.
       instantiated_blocks.push_back(std::make_unique<BlockInstance>(
-          std::nullopt, inst, std::move(instantiation_path),
+          nullptr, inst, std::move(instantiation_path),
           std::vector<std::unique_ptr<BlockInstance>>{}));
     }
   }
 
-  return std::make_unique<BlockInstance>(
-      block == nullptr ? std::nullopt : std::make_optional(block),
-      instantiation, std::move(path), std::move(instantiated_blocks));
+  std::unique_ptr<SharedBlockData>& block_data = shared_data[block];
+  if (block_data == nullptr) {
+    block_data = std::make_unique<SharedBlockData>(block);
+  }
+  return std::make_unique<BlockInstance>(block_data.get(), instantiation,
+                                         std::move(path),
+                                         std::move(instantiated_blocks));
 }
 
 /* static */ absl::StatusOr<BlockElaboration> BlockElaboration::Elaborate(
@@ -561,7 +573,8 @@ static absl::StatusOr<std::unique_ptr<BlockInstance>> ElaborateBlock(
   BlockInstantiationPath path;
   path.top = top;
   XLS_ASSIGN_OR_RETURN(elaboration.top_,
-                       ElaborateBlock(top, std::nullopt, std::move(path)));
+                       ElaborateBlock(top, std::nullopt, std::move(path),
+                                      elaboration.shared_data_));
   elaboration.instance_ptrs_.push_back(elaboration.top_.get());
   elaboration.instances_by_path_[elaboration.top_->path()] =
       elaboration.top_.get();
@@ -583,8 +596,13 @@ static absl::StatusOr<std::unique_ptr<BlockInstance>> ElaborateBlock(
   }
   absl::flat_hash_set<Block*> block_set;
   block_set.reserve(elaboration.instance_ptrs_.size());
-  for (BlockInstance* block_instance : elaboration.instance_ptrs_) {
+  for (int64_t id = 0; id < elaboration.instance_ptrs_.size(); ++id) {
+    BlockInstance* block_instance = elaboration.instance_ptrs_[id];
+    block_instance->id_ = id;
+    block_instance->node_index_offset_ = elaboration.node_index_bound_;
     if (block_instance->block().has_value()) {
+      elaboration.node_index_bound_ +=
+          (*block_instance->block())->node_index_bound();
       auto [_, inserted] = block_set.insert(*block_instance->block());
       if (inserted) {
         elaboration.blocks_.push_back(*block_instance->block());
@@ -755,13 +773,25 @@ std::vector<ElaboratedNode> ElaboratedReverseTopoSort(
   //
   // NOTE: sorts reverse-topologically.  To sort topologically, reverse the
   // result.
-  absl::flat_hash_map<ElaboratedNode, int64_t> pending_to_remaining_successors;
+  //
+  // The mapping is indexed by ElaboratedNode::index(). Nodes which are not yet
+  // pending hold kNotPending.
+  constexpr int64_t kNotPending = std::numeric_limits<int64_t>::min();
+  std::vector<int64_t> pending_to_remaining_successors(
+      elaboration.node_index_bound(), kNotPending);
   std::vector<ElaboratedNode> ordered;
   std::deque<ElaboratedNode> ready;
 
   auto seed_ready = [&](ElaboratedNode n) {
     ready.push_front(n);
-    CHECK(pending_to_remaining_successors.insert({n, -1}).second);
+    int64_t& remaining_successors = pending_to_remaining_successors[n.index()];
+    CHECK_EQ(remaining_successors, kNotPending);
+    remaining_successors = -1;
+  };
+  // Returns whether `n` is pending and all of its successors are scheduled.
+  auto is_scheduled = [&](const ElaboratedNode& n) {
+    int64_t remaining_successors = pending_to_remaining_successors[n.index()];
+    return remaining_successors != kNotPending && remaining_successors < 0;
   };
 
   int64_t node_count = 0;
@@ -788,36 +818,30 @@ std::vector<ElaboratedNode> ElaboratedReverseTopoSort(
   auto all_successors_scheduled = [&](const ElaboratedNode& n) {
     if (std::optional<ElaboratedNode> inter_instance_user =
             InterInstanceSuccessor(n);
-        inter_instance_user.has_value()) {
-      auto it = pending_to_remaining_successors.find(*inter_instance_user);
-      if (it == pending_to_remaining_successors.end() || it->second >= 0) {
-        return false;
-      }
+        inter_instance_user.has_value() &&
+        !is_scheduled(*inter_instance_user)) {
+      return false;
     }
     return absl::c_all_of(n.node->users(), [&](Node* user) {
-      auto it = pending_to_remaining_successors.find(
-          ElaboratedNode{.node = user, .instance = n.instance});
-      if (it == pending_to_remaining_successors.end()) {
-        return false;
-      }
-      return it->second < 0;
+      return is_scheduled(ElaboratedNode{.node = user, .instance = n.instance});
     });
   };
   auto bump_down_remaining_successors = [&](const ElaboratedNode& n) {
     CHECK(!n.node->users().empty() || InterInstanceSuccessor(n).has_value());
-    auto [it, inserted] =
-        pending_to_remaining_successors.insert({n, n.node->users().size()});
-    int64_t& remaining_successors = it->second;
-    // If we inserted, check if there's an inter-instance user.
-    if (inserted && InterInstanceSuccessor(n).has_value()) {
-      ++remaining_successors;
+    int64_t& remaining_successors = pending_to_remaining_successors[n.index()];
+    if (remaining_successors == kNotPending) {
+      remaining_successors = n.node->users().size();
+      // Check if there's an inter-instance user.
+      if (InterInstanceSuccessor(n).has_value()) {
+        ++remaining_successors;
+      }
     }
     CHECK_GT(remaining_successors, 0);
     remaining_successors -= 1;
     VLOG(5) << "Bumped down remaining successors for: " << n
             << "; now: " << remaining_successors;
     if (remaining_successors == 0) {
-      ready.push_back(it->first);
+      ready.push_back(n);
       remaining_successors -= 1;
     }
   };
@@ -15,6 +15,7 @@
 #ifndef XLS_IR_BLOCK_ELABORATION_H_
 #define XLS_IR_BLOCK_ELABORATION_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -48,6 +49,11 @@ struct ElaboratedNode {
     return !(*this == other);
   }
 
+  // Returns an index of the node which is unique within the elaboration and
+  // less than BlockElaboration::node_index_bound(). Indices are dense so they
+  // are suitable for indexing vectors of per-node data.
+  int64_t index() const;
+
   std::string ToString() const;
   absl::Status Accept(ElaboratedBlockDfsVisitor& visitor) const;
   absl::Status VisitSingleNode(ElaboratedBlockDfsVisitor& visitor) const;
@@ -80,20 +86,70 @@ std::optional<ElaboratedNode> InterInstancePredecessor(
 std::optional<ElaboratedNode> InterInstanceSuccessor(
     const ElaboratedNode& node_and_instance);
 
+// Data about a block which does not depend on where the block is instantiated.
+// It is computed once per block and shared by all instances of the block in an
+// elaboration.
+class SharedBlockData {
+ public:
+  explicit SharedBlockData(Block* block);
+
+  Block* block() const { return block_; }
+
+  // Returns the port of an instantiated block which is connected to `node`, a
+  // node of block(). For an InstantiationInput (InstantiationOutput) this is
+  // the InputPort (OutputPort) of the same name in the instantiated block.
+  // Returns nullptr for other nodes and for nodes of non-block instantiations.
+  Node* GetInstantiatedPort(Node* node) const {
+    return instantiated_ports_[node->node_index()];
+  }
+
+  // The inverse of GetInstantiatedPort: returns the InstantiationInput or
+  // InstantiationOutput in block() which is connected to `port` of the block
+  // instantiated by `instantiation`, or nullptr if there is none.
+  Node* GetInstantiationNode(Instantiation* instantiation, Node* port) const;
+
+ private:
+  Block* block_;
+  // Indexed by the node index of the nodes in block().
+  std::vector<Node*> instantiated_ports_;
+  // For each block instantiation in block(), the instantiation nodes indexed by
+  // the node index of the ports of the instantiated block.
+  absl::flat_hash_map<Instantiation*, std::vector<Node*>> instantiation_nodes_;
+};
+
 // Representation of an instance of a block. This is a recursive data structure
 // which also owns all block instances instantiated by this block (and
 // transitively their instances).
 class BlockInstance {
  public:
+  // `shared_data` is the data of the instantiated block. It is nullptr for
+  // instantiations which have no associated block.
   BlockInstance(
-      std::optional<Block*> block, std::optional<Instantiation*> instantiation,
+      const SharedBlockData* shared_data,
+      std::optional<Instantiation*> instantiation,
       BlockInstantiationPath&& path,
       std::vector<std::unique_ptr<BlockInstance>> instantiated_blocks);
 
   // Returns the block associated with this instance if it exists. Some
   // instantiations (e.g. fifo) do not have an associated block and will
   // return std::nullopt.
-  std::optional<Block*> block() const { return block_; }
+  std::optional<Block*> block() const {
+    if (shared_data_ == nullptr) {
+      return std::nullopt;
+    }
+    return shared_data_->block();
+  }
+
+  // Data shared by all instances of block(). nullptr if there is no associated
+  // block.
+  const SharedBlockData* shared_data() const { return shared_data_; }
+
+  // The index of this instance in BlockElaboration::instances().
+  int64_t id() const { return id_; }
+
+  // The index of the first node of this instance in the elaboration (see
+  // ElaboratedNode::index()).
+  int64_t node_index_offset() const { return node_index_offset_; }
 
   // Prefix for referencing entities hierarchically.
   //
@@ -124,7 +180,9 @@ class BlockInstance {
   }
 
  private:
-  std::optional<Block*> block_;
+  friend class BlockElaboration;
+
+  const SharedBlockData* shared_data_;
   std::optional<Instantiation*> instantiation_;
   BlockInstantiationPath path_;
   std::string register_prefix_;
@@ -139,8 +197,15 @@ class BlockInstance {
   // Each pointer (keys and values!) must be non-null.
   absl::flat_hash_map<Instantiation*, BlockInstance*>
       instantiation_to_instance_;
+  // Set by BlockElaboration::Elaborate once all instances have been created.
+  int64_t id_ = 0;
+  int64_t node_index_offset_ = 0;
 };
 
+inline int64_t ElaboratedNode::index() const {
+  return instance->node_index_offset() + node->node_index();
+}
+
 // Data structure representing the elaboration tree starting from a root block.
 class BlockElaboration {
  public:
@@ -157,6 +222,10 @@ class BlockElaboration {
   absl::Span<BlockInstance* const> instances() const { return instance_ptrs_; }
   absl::Span<Block* const> blocks() const { return blocks_; }
 
+  // Returns an upper bound on ElaboratedNode::index() of the nodes in the
+  // elaboration.
+  int64_t node_index_bound() const { return node_index_bound_; }
+
   // Return all instances of a particular `FunctionT`.
   absl::Span<BlockInstance* const> GetInstances(Block* block) const;
 
@@ -190,6 +259,10 @@ class BlockElaboration {
   std::vector<BlockInstance*> instance_ptrs_;
   // List of all blocks that are instantiated.
   std::vector<Block*> blocks_;
+  // The data shared by the instances of each block. Unique pointers are used
+  // for pointer stability as the instances hold pointers to these objects.
+  absl::flat_hash_map<Block*, std::unique_ptr<SharedBlockData>> shared_data_;
+  int64_t node_index_bound_ = 0;
 
   // All proc instances in the elaboration indexed by instantiation path.
   absl::flat_hash_map<BlockInstantiationPath, BlockInstance*>
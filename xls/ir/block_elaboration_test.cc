@@ -15,6 +15,7 @@
 #include "xls/ir/block_elaboration.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <optional>
 #include <string_view>
 #include <vector>
@@ -51,7 +52,10 @@ using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::HasSubstr;
 using ::testing::IsEmpty;
+using ::testing::Optional;
 using ::testing::Pair;
+using ::testing::Pointee;
+using ::testing::Property;
 using ::testing::UnorderedElementsAre;
 
 namespace m = xls::op_matchers;
@@ -224,6 +228,61 @@ TEST_F(ElaborationTest, ElaborateMultipleBlockInstantiations) {
                           "instance count: 3")));
 }
 
+TEST_F(ElaborationTest, InstanceIdsAndNodeIndices) {
+  auto p = CreatePackage();
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, MultipleAddInstantiations(*p));
+
+  XLS_ASSERT_OK_AND_ASSIGN(BlockElaboration elab,
+                           BlockElaboration::Elaborate(block));
+
+  ASSERT_EQ(elab.instances().size(), 4);
+  for (int64_t i = 0; i < elab.instances().size(); ++i) {
+    EXPECT_EQ(elab.instances()[i]->id(), i);
+  }
+
+  // The instances of the adder share their block data.
+  BlockInstance* adder0 = elab.top()->child_instances()[0].get();
+  EXPECT_NE(adder0->shared_data(), elab.top()->shared_data());
+  EXPECT_THAT(elab.top()->child_instances(),
+              Each(Pointee(Property(&BlockInstance::shared_data,
+                                    Eq(adder0->shared_data())))));
+
+  // Every node of every instance has a distinct index.
+  std::vector<bool> seen(elab.node_index_bound(), false);
+  int64_t node_count = 0;
+  for (BlockInstance* instance : elab.instances()) {
+    for (Node* node : (*instance->block())->nodes()) {
+      int64_t index =
+          ElaboratedNode{.node = node, .instance = instance}.index();
+      ASSERT_GE(index, 0);
+      ASSERT_LT(index, elab.node_index_bound());
+      EXPECT_FALSE(seen[index]);
+      seen[index] = true;
+      ++node_count;
+    }
+  }
+  EXPECT_EQ(node_count, elab.node_index_bound());
+
+  // Ports are connected through the shared data.
+  XLS_ASSERT_OK_AND_ASSIGN(InputPort * adder_a,
+                           (*adder0->block())->GetInputPort("a"));
+  XLS_ASSERT_OK_AND_ASSIGN(OutputPort * adder_c,
+                           (*adder0->block())->GetOutputPort("c"));
+  EXPECT_THAT(
+      InterInstancePredecessor(ElaboratedNode{.node = adder_a,
+                                              .instance = adder0}),
+      Optional(NodeAndInst(m::InstantiationInput(m::InputPort("a"), "a"),
+                           HasSubstr("multi_adder "))));
+  std::optional<ElaboratedNode> output = InterInstanceSuccessor(
+      ElaboratedNode{.node = adder_c, .instance = adder0});
+  EXPECT_THAT(output, Optional(NodeAndInst(m::InstantiationOutput("c"),
+                                           HasSubstr("multi_adder "))));
+  ASSERT_TRUE(output.has_value());
+  EXPECT_EQ(InterInstancePredecessor(*output),
+            (ElaboratedNode{.node = adder_c, .instance = adder0}));
+}
+
 absl::StatusOr<Block*> BlockWithFifoInstantiation(Package& p) {
   Type* u32 = p.GetBitsType(32);
   BlockBuilder bb("adder_with_fifo", &p);
@@ -0,0 +1,59 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_CHANGE_LISTENER_H_
+#define XLS_IR_CHANGE_LISTENER_H_
+
+namespace xls {
+
+class FunctionBase;
+class Node;
+
+// Interface for objects which are notified of changes to the nodes of a
+// FunctionBase. Listeners are registered with
+// FunctionBase::RegisterChangeListener. This is used to keep analyses up to
+// date as the IR is transformed without re-analyzing the entire function.
+//
+// Notifications are delivered synchronously after the change has been made
+// (with the exception of NodeDeleted which is delivered just before the node
+// is destroyed). Listeners must not modify the IR from within a notification.
+class ChangeListener {
+ public:
+  virtual ~ChangeListener() = default;
+
+  // Called after `node` has been added to its function.
+  virtual void NodeAdded(Node* node) {}
+
+  // Called just before `node` is removed from its function and destroyed.
+  virtual void NodeDeleted(Node* node) {}
+
+  // Called after one or more operands of `node` which previously referred to
+  // `old_operand` have been changed to refer to a different node. This is also
+  // called when operands are swapped.
+  virtual void OperandChanged(Node* node, Node* old_operand) {}
+
+  // Called after an operand has been appended to a node which is already part
+  // of a function. Operands added while constructing a node are not reported;
+  // the node is reported by NodeAdded instead.
+  virtual void OperandAdded(Node* node) {}
+
+  // Called from the destructor of `function_base`. The listener is
+  // automatically unregistered and must not call any methods on
+  // `function_base`.
+  virtual void FunctionBaseDeleted(FunctionBase* function_base) {}
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_CHANGE_LISTENER_H_
@@ -0,0 +1,289 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_DENSE_NODE_MAP_H_
+#define XLS_IR_DENSE_NODE_MAP_H_
+
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+class FunctionBase;
+
+namespace internal {
+
+// The index structure shared by DenseNodeMap and DenseNodeSet. Entries are
+// stored contiguously and located through a vector indexed by
+// Node::node_index(), so lookups do not hash the node pointer.
+class DenseNodeIndex {
+ public:
+  // Returns the position of the entry of `node` or -1 if there is none. The
+  // key of each entry is held in `keys`.
+  int64_t Find(const Node* node, const std::vector<Node*>& keys) const {
+    int64_t index = node->node_index();
+    if (index >= slots_.size()) {
+      return -1;
+    }
+    int64_t position = slots_[index] - 1;
+    if (position < 0 || keys[position] != node) {
+      return -1;
+    }
+    return position;
+  }
+
+  // Returns the position of the entry of the node index of `node` if one
+  // exists, which may belong to a node which has been removed from the
+  // function and whose index has been reused. Otherwise returns -1.
+  int64_t FindSlot(const Node* node) const {
+    int64_t index = node->node_index();
+    return index < slots_.size() ? slots_[index] - 1 : -1;
+  }
+
+  // Records that the entry of `node` is at `position`, which must be at the
+  // end of the entries.
+  void Add(Node* node, int64_t position) {
+    CHECK(function_base_ == nullptr || function_base_ == node->function_base())
+        << "All nodes in a dense node map must be in the same function base: "
+        << node->GetName();
+    function_base_ = node->function_base();
+    int64_t index = node->node_index();
+    CHECK_GE(index, 0) << "Node has not been added to a function base: "
+                       << node->GetName();
+    if (index >= slots_.size()) {
+      slots_.resize(index + 1, 0);
+    }
+    slots_[index] = position + 1;
+    entry_indices_.push_back(index);
+  }
+
+  // Removes the entry at `position` by moving the last entry into its place.
+  // The caller must move the keys and values in the same way.
+  void Remove(int64_t position) {
+    slots_[entry_indices_[position]] = 0;
+    if (position != entry_indices_.size() - 1) {
+      entry_indices_[position] = entry_indices_.back();
+      slots_[entry_indices_[position]] = position + 1;
+    }
+    entry_indices_.pop_back();
+  }
+
+  void Clear() {
+    for (int64_t index : entry_indices_) {
+      slots_[index] = 0;
+    }
+    entry_indices_.clear();
+    function_base_ = nullptr;
+  }
+
+ private:
+  // One plus the position of the entry for each node index, or zero if there
+  // is no entry.
+  std::vector<int64_t> slots_;
+
+  // The node index of each entry.
+  std::vector<int64_t> entry_indices_;
+
+  FunctionBase* function_base_ = nullptr;
+};
+
+}  // namespace internal
+
+// A map keyed by the nodes of a single FunctionBase. This is a replacement for
+// absl::flat_hash_map<Node*, T> which locates entries by the dense index of
+// each node (Node::node_index) rather than by hashing the node pointer.
+//
+// Like a hash map keyed by pointer, an entry for a node which is removed from
+// the function remains until it is erased or its node index is reused by a new
+// node, at which point the entry is dropped. Unlike a hash map, lookups read
+// the node index so they must only be passed live nodes.
+//
+// Entries are iterated in insertion order, except that erasing an entry moves
+// the last entry into its place. Inserting or erasing invalidates iterators.
+template <typename T>
+class DenseNodeMap {
+ public:
+  using value_type = std::pair<Node*, T>;
+  using iterator = typename std::vector<value_type>::iterator;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  bool empty() const { return entries_.empty(); }
+  int64_t size() const { return entries_.size(); }
+
+  iterator begin() { return entries_.begin(); }
+  iterator end() { return entries_.end(); }
+  const_iterator begin() const { return entries_.begin(); }
+  const_iterator end() const { return entries_.end(); }
+
+  bool contains(const Node* node) const {
+    return index_.Find(node, keys_) >= 0;
+  }
+
+  iterator find(const Node* node) {
+    int64_t position = index_.Find(node, keys_);
+    return position < 0 ? end() : begin() + position;
+  }
+  const_iterator find(const Node* node) const {
+    int64_t position = index_.Find(node, keys_);
+    return position < 0 ? end() : begin() + position;
+  }
+
+  T& at(const Node* node) {
+    int64_t position = index_.Find(node, keys_);
+    CHECK_GE(position, 0) << "Node not in map: " << node->GetName();
+    return entries_[position].second;
+  }
+  const T& at(const Node* node) const {
+    int64_t position = index_.Find(node, keys_);
+    CHECK_GE(position, 0) << "Node not in map: " << node->GetName();
+    return entries_[position].second;
+  }
+
+  T& operator[](Node* node) { return try_emplace(node).first->second; }
+
+  // Inserts a value constructed from `args` for `node` if there is none.
+  // Returns the entry for `node` and whether it was inserted.
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Node* node, Args&&... args) {
+    int64_t position = index_.FindSlot(node);
+    if (position >= 0) {
+      if (keys_[position] == node) {
+        return {begin() + position, false};
+      }
+      // The entry belongs to a removed node whose index has been reused.
+      keys_[position] = node;
+      entries_[position] = value_type(
+          std::piecewise_construct, std::forward_as_tuple(node),
+          std::forward_as_tuple(std::forward<Args>(args)...));
+      return {begin() + position, true};
+    }
+    position = entries_.size();
+    index_.Add(node, position);
+    keys_.push_back(node);
+    entries_.emplace_back(std::piecewise_construct,
+                          std::forward_as_tuple(node),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+    return {begin() + position, true};
+  }
+
+  template <typename V>
+  std::pair<iterator, bool> insert_or_assign(Node* node, V&& value) {
+    auto [it, inserted] = try_emplace(node, std::forward<V>(value));
+    if (!inserted) {
+      it->second = std::forward<V>(value);
+    }
+    return {it, inserted};
+  }
+
+  // Erases the entry for `node` if any. Returns the number of entries erased.
+  int64_t erase(const Node* node) {
+    int64_t position = index_.Find(node, keys_);
+    if (position < 0) {
+      return 0;
+    }
+    index_.Remove(position);
+    if (position != entries_.size() - 1) {
+      keys_[position] = keys_.back();
+      entries_[position] = std::move(entries_.back());
+    }
+    keys_.pop_back();
+    entries_.pop_back();
+    return 1;
+  }
+
+  void clear() {
+    index_.Clear();
+    keys_.clear();
+    entries_.clear();
+  }
+
+  void reserve(int64_t size) {
+    keys_.reserve(size);
+    entries_.reserve(size);
+  }
+
+ private:
+  internal::DenseNodeIndex index_;
+  // The key of each entry, duplicated from `entries_` so that lookups touch
+  // only densely packed pointers.
+  std::vector<Node*> keys_;
+  std::vector<value_type> entries_;
+};
+
+// A set of the nodes of a single FunctionBase. This is a replacement for
+// absl::flat_hash_set<Node*> with the same properties as DenseNodeMap.
+// Clearing the set takes time proportional to its size, not to the number of
+// nodes in the function.
+class DenseNodeSet {
+ public:
+  using const_iterator = std::vector<Node*>::const_iterator;
+
+  bool empty() const { return nodes_.empty(); }
+  int64_t size() const { return nodes_.size(); }
+
+  const_iterator begin() const { return nodes_.begin(); }
+  const_iterator end() const { return nodes_.end(); }
+
+  bool contains(const Node* node) const {
+    return index_.Find(node, nodes_) >= 0;
+  }
+
+  // Inserts `node` if not present. Returns whether it was inserted.
+  bool insert(Node* node) {
+    int64_t position = index_.FindSlot(node);
+    if (position >= 0) {
+      if (nodes_[position] == node) {
+        return false;
+      }
+      // The entry belongs to a removed node whose index has been reused.
+      nodes_[position] = node;
+      return true;
+    }
+    index_.Add(node, nodes_.size());
+    nodes_.push_back(node);
+    return true;
+  }
+
+  // Erases `node` if present. Returns the number of nodes erased.
+  int64_t erase(const Node* node) {
+    int64_t position = index_.Find(node, nodes_);
+    if (position < 0) {
+      return 0;
+    }
+    index_.Remove(position);
+    nodes_[position] = nodes_.back();
+    nodes_.pop_back();
+    return 1;
+  }
+
+  void clear() {
+    index_.Clear();
+    nodes_.clear();
+  }
+
+  void reserve(int64_t size) { nodes_.reserve(size); }
+
+ private:
+  internal::DenseNodeIndex index_;
+  std::vector<Node*> nodes_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_DENSE_NODE_MAP_H_
@@ -0,0 +1,186 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/dense_node_map.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+class DenseNodeMapTest : public IrTestBase {};
+
+TEST_F(DenseNodeMapTest, NodeIndicesAreDenseAndReused) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue dead = fb.Not(x);
+  BValue add = fb.Add(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(add));
+
+  EXPECT_EQ(f->node_index_bound(), 4);
+  std::vector<bool> seen(f->node_index_bound(), false);
+  for (Node* node : f->nodes()) {
+    ASSERT_GE(node->node_index(), 0);
+    ASSERT_LT(node->node_index(), f->node_index_bound());
+    EXPECT_FALSE(seen[node->node_index()]);
+    seen[node->node_index()] = true;
+  }
+
+  int64_t dead_index = dead.node()->node_index();
+  XLS_ASSERT_OK(f->RemoveNode(dead.node()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * neg, f->MakeNode<UnOp>(SourceInfo(), y.node(), Op::kNeg));
+  EXPECT_EQ(neg->node_index(), dead_index);
+  EXPECT_EQ(f->node_index_bound(), 4);
+}
+
+TEST_F(DenseNodeMapTest, InsertFindErase) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue add = fb.Add(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(add));
+
+  DenseNodeMap<std::string> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.contains(x.node()));
+  EXPECT_EQ(map.find(x.node()), map.end());
+
+  EXPECT_TRUE(map.try_emplace(x.node(), "x").second);
+  EXPECT_FALSE(map.try_emplace(x.node(), "other").second);
+  map[add.node()] = "add";
+  EXPECT_FALSE(map.insert_or_assign(add.node(), "sum").second);
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(map.at(x.node()), "x");
+  EXPECT_EQ(map.at(add.node()), "sum");
+  EXPECT_FALSE(map.contains(y.node()));
+  EXPECT_THAT(map, UnorderedElementsAre(Pair(x.node(), "x"),
+                                        Pair(add.node(), "sum")));
+
+  EXPECT_EQ(map.erase(x.node()), 1);
+  EXPECT_EQ(map.erase(x.node()), 0);
+  EXPECT_FALSE(map.contains(x.node()));
+  EXPECT_EQ(map.at(add.node()), "sum");
+  EXPECT_THAT(map, UnorderedElementsAre(Pair(add.node(), "sum")));
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.contains(add.node()));
+  for (Node* node : f->nodes()) {
+    map[node] = node->GetName();
+  }
+  EXPECT_EQ(map.size(), f->node_count());
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(map.at(node), node->GetName());
+  }
+}
+
+TEST_F(DenseNodeMapTest, EntryOfRemovedNodeIsDroppedOnReuse) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue dead = fb.Not(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(x));
+
+  DenseNodeMap<int64_t> map;
+  map[x.node()] = 1;
+  map[dead.node()] = 2;
+  DenseNodeSet set;
+  EXPECT_TRUE(set.insert(dead.node()));
+
+  XLS_ASSERT_OK(f->RemoveNode(dead.node()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * literal,
+      f->MakeNode<Literal>(SourceInfo(), Value(UBits(42, 8))));
+  ASSERT_EQ(literal->node_index(), 1);
+  EXPECT_FALSE(map.contains(literal));
+  EXPECT_FALSE(set.contains(literal));
+
+  EXPECT_TRUE(map.try_emplace(literal, 3).second);
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(map.at(literal), 3);
+  EXPECT_EQ(map.at(x.node()), 1);
+  EXPECT_TRUE(set.insert(literal));
+  EXPECT_EQ(set.size(), 1);
+  EXPECT_TRUE(set.contains(literal));
+}
+
+TEST_F(DenseNodeMapTest, Set) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue add = fb.Add(x, y);
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(add).status());
+
+  DenseNodeSet set;
+  EXPECT_TRUE(set.insert(add.node()));
+  EXPECT_TRUE(set.insert(x.node()));
+  EXPECT_FALSE(set.insert(add.node()));
+  EXPECT_EQ(set.size(), 2);
+  EXPECT_TRUE(set.contains(x.node()));
+  EXPECT_FALSE(set.contains(y.node()));
+  EXPECT_THAT(set, UnorderedElementsAre(x.node(), add.node()));
+
+  EXPECT_EQ(set.erase(add.node()), 1);
+  EXPECT_EQ(set.erase(y.node()), 0);
+  EXPECT_THAT(set, UnorderedElementsAre(x.node()));
+
+  set.clear();
+  EXPECT_TRUE(set.empty());
+  EXPECT_FALSE(set.contains(x.node()));
+}
+
+TEST_F(DenseNodeMapTest, NodesOfOtherFunctionsAreNotFound) {
+  auto p = CreatePackage();
+  FunctionBuilder fb1("f1", p.get());
+  BValue x1 = fb1.Param("x", p->GetBitsType(8));
+  XLS_ASSERT_OK(fb1.BuildWithReturnValue(x1).status());
+  FunctionBuilder fb2("f2", p.get());
+  BValue x2 = fb2.Param("x", p->GetBitsType(8));
+  XLS_ASSERT_OK(fb2.BuildWithReturnValue(x2).status());
+  ASSERT_EQ(x1.node()->node_index(), x2.node()->node_index());
+
+  DenseNodeMap<int64_t> map;
+  map[x1.node()] = 1;
+  EXPECT_TRUE(map.contains(x1.node()));
+  EXPECT_FALSE(map.contains(x2.node()));
+}
+
+}  // namespace
+}  // namespace xls
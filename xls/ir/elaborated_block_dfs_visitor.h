@@ -15,7 +15,9 @@
 #ifndef XLS_IR_ELABORATED_BLOCK_DFS_VISITOR_H_
 #define XLS_IR_ELABORATED_BLOCK_DFS_VISITOR_H_
 
-#include "absl/container/flat_hash_set.h"
+#include <cstdint>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "xls/ir/block_elaboration.h"
 #include "xls/ir/node.h"
@@ -149,21 +151,30 @@ class ElaboratedBlockDfsVisitor {
 
   // Returns true if the given node has been visited.
   bool IsVisited(const ElaboratedNode& node) const {
-    return visited_.contains(node);
+    return IsSet(visited_, node);
   }
 
   // Marks the given node as visited.
-  void MarkVisited(const ElaboratedNode& node) { visited_.insert(node); }
+  void MarkVisited(const ElaboratedNode& node) {
+    if (!IsSet(visited_, node)) {
+      Set(visited_, node, true);
+      ++visited_count_;
+    }
+  }
 
   // Returns whether the given node is on path from the root of the traversal
   // to the currently visited node. Used to identify cycles in the graph.
   bool IsTraversing(const ElaboratedNode& node) const {
-    return traversing_.contains(node);
+    return IsSet(traversing_, node);
   }
 
   // Sets/unsets whether this node is being traversed through.
-  void SetTraversing(const ElaboratedNode& node) { traversing_.insert(node); }
-  void UnsetTraversing(const ElaboratedNode& node) { traversing_.erase(node); }
+  void SetTraversing(const ElaboratedNode& node) {
+    Set(traversing_, node, true);
+  }
+  void UnsetTraversing(const ElaboratedNode& node) {
+    Set(traversing_, node, false);
+  }
 
   // Resets traversal state.
   // This is for cases where creating a new DfsVisitor is not feasible or
@@ -174,17 +185,37 @@ class ElaboratedBlockDfsVisitor {
   void ResetVisitedState() {
     visited_.clear();
     traversing_.clear();
+    visited_count_ = 0;
   }
 
   // Return the total number of nodes visited.
-  int64_t GetVisitedCount() const { return visited_.size(); }
+  int64_t GetVisitedCount() const { return visited_count_; }
 
  private:
-  // Set of nodes which have been visited.
-  absl::flat_hash_set<ElaboratedNode> visited_;
+  static bool IsSet(const std::vector<bool>& flags,
+                    const ElaboratedNode& node) {
+    int64_t index = node.index();
+    return index < flags.size() && flags[index];
+  }
+  static void Set(std::vector<bool>& flags, const ElaboratedNode& node,
+                  bool value) {
+    int64_t index = node.index();
+    if (index >= flags.size()) {
+      if (!value) {
+        return;
+      }
+      flags.resize(index + 1, false);
+    }
+    flags[index] = value;
+  }
+
+  // The nodes which have been visited, indexed by ElaboratedNode::index(). The
+  // vectors are grown as nodes are marked.
+  std::vector<bool> visited_;
+  int64_t visited_count_ = 0;
 
-  // Set of nodes which are being traversed through.
-  absl::flat_hash_set<ElaboratedNode> traversing_;
+  // The nodes which are being traversed through.
+  std::vector<bool> traversing_;
 };
 
 // Visitor with a default action. If the Handle<Op> method is not overridden
@@ -14,8 +14,24 @@
 
 #include "xls/ir/events.h"
 
+#include <cstdint>
+#include <string>
+#include <utility>
+
 namespace xls {
 
+void InterpreterEvents::AddTrace(std::string message, int64_t verbosity) {
+  if (!ShouldRecordTrace(verbosity)) {
+    return;
+  }
+  if (trace_options.sink) {
+    trace_options.sink(message, verbosity);
+    return;
+  }
+  trace_msgs.push_back(
+      TraceMessage{.message = std::move(message), .verbosity = verbosity});
+}
+
 absl::Status InterpreterEventsToStatus(const InterpreterEvents& events) {
   if (events.assert_msgs.empty()) {
     return absl::OkStatus();
@@ -17,7 +17,10 @@
 
 #include <compare>
 #include <cstdint>
+#include <functional>
+#include <limits>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "absl/status/status.h"
@@ -43,17 +46,42 @@ struct TraceMessage {
   }
 };
 
+// Options controlling how trace messages are recorded by an interpreter.
+struct TraceOptions {
+  // Traces with a verbosity above this are dropped. Interpreters check this
+  // before formatting the trace so dropped traces cost only the check.
+  int64_t max_verbosity = std::numeric_limits<int64_t>::max();
+
+  // If set, recorded traces are passed to this function as they are produced
+  // rather than accumulated in InterpreterEvents::trace_msgs. This bounds the
+  // memory used by long-running simulations which emit many traces. With a
+  // parallel proc runtime the sink may be called from several threads.
+  std::function<void(std::string_view message, int64_t verbosity)> sink;
+};
+
 // Common structure capturing events that can be produced by any XLS interpreter
 // (DSLX, IR, JIT, etc.)
 struct InterpreterEvents {
   std::vector<TraceMessage> trace_msgs;
   std::vector<std::string> assert_msgs;
 
+  // How traces are recorded. Not cleared by Clear() and not considered in
+  // comparisons.
+  TraceOptions trace_options;
+
   void Clear() {
     trace_msgs.clear();
     assert_msgs.clear();
   }
 
+  // Returns whether a trace with the given verbosity would be recorded.
+  bool ShouldRecordTrace(int64_t verbosity) const {
+    return verbosity <= trace_options.max_verbosity;
+  }
+
+  // Records a formatted trace message according to `trace_options`.
+  void AddTrace(std::string message, int64_t verbosity);
+
   bool operator==(const InterpreterEvents& other) const {
     return trace_msgs == other.trace_msgs && assert_msgs == other.assert_msgs;
   }
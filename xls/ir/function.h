@@ -50,7 +50,10 @@ class Function : public FunctionBase {
     XLS_RET_CHECK_EQ(n->function_base(), this) << absl::StreamFormat(
         "Return value node %s is not in this function %s (is in function %s)",
         n->GetName(), name(), n->function_base()->name());
-    return_value_ = n;
+    if (return_value_ != n) {
+      return_value_ = n;
+      MarkGraphChanged();
+    }
     return absl::OkStatus();
   }
 
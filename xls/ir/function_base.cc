@@ -25,12 +25,14 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "google/protobuf/text_format.h"
 #include "xls/common/casts.h"
 #include "xls/common/status/ret_check.h"
@@ -46,6 +48,26 @@
 
 namespace xls {
 
+FunctionBase::~FunctionBase() {
+  // Copy the listeners as they may unregister themselves when notified.
+  std::vector<ChangeListener*> listeners = std::move(change_listeners_);
+  change_listeners_.clear();
+  for (ChangeListener* listener : listeners) {
+    listener->FunctionBaseDeleted(this);
+  }
+}
+
+void FunctionBase::RegisterChangeListener(ChangeListener* listener) {
+  CHECK(!absl::c_linear_search(change_listeners_, listener));
+  change_listeners_.push_back(listener);
+}
+
+void FunctionBase::UnregisterChangeListener(ChangeListener* listener) {
+  auto it = absl::c_find(change_listeners_, listener);
+  CHECK(it != change_listeners_.end());
+  change_listeners_.erase(it);
+}
+
 std::vector<std::string> FunctionBase::AttributeIrStrings() const {
   std::vector<std::string> attribute_strings;
   if (ForeignFunctionData().has_value()) {
@@ -119,7 +141,7 @@ absl::Status FunctionBase::RemoveNode(Node* node) {
   XLS_RET_CHECK(!HasImplicitUse(node)) << node->GetName();
   VLOG(4) << absl::StrFormat("Removing node from FunctionBase %s: %s", name(),
                              node->ToString());
-  ++package()->transform_metrics().nodes_removed;
+  package()->RecordNodeRemoved();
   std::vector<Node*> unique_operands;
   for (Node* operand : node->operands()) {
     if (!absl::c_linear_search(unique_operands, operand)) {
@@ -144,8 +166,13 @@ absl::Status FunctionBase::RemoveNode(Node* node) {
   }
   auto node_it = node_iterators_.find(node);
   XLS_RET_CHECK(node_it != node_iterators_.end());
+  for (ChangeListener* listener : change_listeners_) {
+    listener->NodeDeleted(node);
+  }
+  free_node_indices_.push_back(node->node_index_);
   nodes_.erase(node_it->second);
   node_iterators_.erase(node_it);
+  MarkGraphChanged();
   return absl::OkStatus();
 }
 
@@ -204,10 +231,20 @@ Block* FunctionBase::AsBlockOrDie() {
   return down_cast<Block*>(this);
 }
 
+std::vector<Node*> FunctionBase::GetCachedReverseTopoOrder(
+    absl::FunctionRef<std::vector<Node*>()> compute) const {
+  absl::MutexLock lock(&topo_order_mutex_);
+  if (topo_order_version_ != graph_version_) {
+    reverse_topo_order_ = compute();
+    topo_order_version_ = graph_version_;
+  }
+  return reverse_topo_order_;
+}
+
 Node* FunctionBase::AddNodeInternal(std::unique_ptr<Node> node) {
   VLOG(4) << absl::StrFormat("Adding node to FunctionBase %s: %s", name(),
                              node->ToString());
-  ++package()->transform_metrics().nodes_added;
+  package()->RecordNodeAdded();
   if (node->Is<Param>()) {
     params_.push_back(node->As<Param>());
     next_values_by_param_[node->As<Param>()];
@@ -219,7 +256,17 @@ Node* FunctionBase::AddNodeInternal(std::unique_ptr<Node> node) {
     next_values_by_param_.at(param).insert(next);
   }
   Node* ptr = node.get();
+  if (free_node_indices_.empty()) {
+    ptr->node_index_ = node_index_bound_++;
+  } else {
+    ptr->node_index_ = free_node_indices_.back();
+    free_node_indices_.pop_back();
+  }
   node_iterators_[ptr] = nodes_.insert(nodes_.end(), std::move(node));
+  MarkGraphChanged();
+  for (ChangeListener* listener : change_listeners_) {
+    listener->NodeAdded(ptr);
+  }
   return ptr;
 }
 
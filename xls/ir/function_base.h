@@ -18,24 +18,33 @@
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <new>
 #include <optional>
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/iterator_range.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/foreign_function_data.pb.h"
 #include "xls/ir/name_uniquer.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_arena.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/unwrapping_iterator.h"
@@ -57,7 +66,7 @@ class FunctionBase {
   FunctionBase(const FunctionBase& other) = delete;
   void operator=(const FunctionBase& other) = delete;
 
-  virtual ~FunctionBase() = default;
+  virtual ~FunctionBase();
 
   Package* package() const { return package_; }
   const std::string& name() const { return name_; }
@@ -103,6 +112,10 @@ class FunctionBase {
 
   int64_t node_count() const { return nodes_.size(); }
 
+  // Returns the arena from which the nodes of this function base are
+  // allocated.
+  const NodeArena& node_arena() const { return node_arena_; }
+
   // Expose Nodes, so that transformation passes can operate
   // on this function.
   xabsl::iterator_range<UnwrappingIterator<NodeList::iterator>> nodes() {
@@ -124,6 +137,20 @@ class FunctionBase {
     return ptr;
   }
 
+  // Constructs a node of type NodeT from `args` with storage allocated from the
+  // node arena of this function base. The node is not added to the function.
+  // `args` must include the final FunctionBase* argument, which must be this.
+  template <typename NodeT, typename... Args>
+    requires(std::is_base_of_v<Node, NodeT>)
+  std::unique_ptr<NodeT> NewNode(Args&&... args) {
+    static_assert(alignof(NodeT) <= NodeArena::kAlignment);
+    void* storage = node_arena_.Allocate(sizeof(NodeT));
+    NodeT* node = new (storage) NodeT(std::forward<Args>(args)...);
+    DCHECK_EQ(node->function_base(), this);
+    node->arena_size_ = sizeof(NodeT);
+    return std::unique_ptr<NodeT>(node);
+  }
+
   // Creates a new node and adds it to the function. NodeT is the node subclass
   // (e.g., 'Param') and the variadic args are the constructor arguments with
   // the exception of the final FunctionBase* argument. This method verifies the
@@ -132,8 +159,8 @@ class FunctionBase {
   template <typename NodeT, typename... Args>
     requires(std::is_base_of_v<Node, NodeT>)
   absl::StatusOr<NodeT*> MakeNode(Args&&... args) {
-    NodeT* new_node = AddNode(std::make_unique<NodeT>(
-        std::forward<Args>(args)..., /*name=*/"", this));
+    NodeT* new_node =
+        AddNode(NewNode<NodeT>(std::forward<Args>(args)..., /*name=*/"", this));
     XLS_RETURN_IF_ERROR(VerifyNode(new_node));
     return new_node;
   }
@@ -142,7 +169,7 @@ class FunctionBase {
     requires(std::is_base_of_v<Node, NodeT>)
   absl::StatusOr<NodeT*> MakeNodeWithName(Args&&... args) {
     NodeT* new_node =
-        AddNode(std::make_unique<NodeT>(std::forward<Args>(args)..., this));
+        AddNode(NewNode<NodeT>(std::forward<Args>(args)..., this));
     XLS_RETURN_IF_ERROR(VerifyNode(new_node));
     return new_node;
   }
@@ -155,10 +182,38 @@ class FunctionBase {
   // function type signature.
   virtual absl::Status RemoveNode(Node* n);
 
+  // Returns an upper bound on Node::node_index of the nodes of this function.
+  int64_t node_index_bound() const { return node_index_bound_; }
+
+  // Returns whether `node` is owned by this function.
+  bool HasNode(const Node* node) const {
+    return node_iterators_.contains(node);
+  }
+
+  // Registers a listener which is notified of changes to the nodes of this
+  // function. The listener is not owned and must be unregistered before it is
+  // destroyed unless it outlives the function.
+  void RegisterChangeListener(ChangeListener* listener);
+  void UnregisterChangeListener(ChangeListener* listener);
+  absl::Span<ChangeListener* const> change_listeners() const {
+    return change_listeners_;
+  }
+
   // Visit all nodes (including nodes not reachable from the root) in the
   // function using the given visitor.
   absl::Status Accept(DfsVisitor* visitor);
 
+  // Returns a counter which is incremented by every change to the graph which
+  // can affect its topological order: adding or removing nodes, changing
+  // operands or users, and changing the return value of a function.
+  int64_t graph_version() const { return graph_version_; }
+
+  // Returns the reverse topological order of the nodes, as computed by
+  // `compute`, caching it until the graph next changes. Used by
+  // ReverseTopoSort and TopoSort.
+  std::vector<Node*> GetCachedReverseTopoOrder(
+      absl::FunctionRef<std::vector<Node*>()> compute) const;
+
   // Sanitizes and uniquifies the given name using the function's name
   // uniquer. Registers the uniquified name in the uniquer so it is not handed
   // out again.
@@ -204,6 +259,9 @@ class FunctionBase {
   };
 
  protected:
+  // Node needs to be a friend to release its storage to `node_arena_`.
+  friend class Node;
+
   // Internal virtual helper for adding a node. Returns a pointer to the newly
   // added node.
   virtual Node* AddNodeInternal(std::unique_ptr<Node> node);
@@ -211,16 +269,28 @@ class FunctionBase {
   // Returns a vector containing the reserved words in the IR.
   static std::vector<std::string> GetIrReservedWords();
 
+  // Records a change of the graph which invalidates the cached topological
+  // order.
+  void MarkGraphChanged() { ++graph_version_; }
+
   std::string name_;
   Package* package_;
   std::optional<int64_t> initiation_interval_;
 
+  // Storage for nodes created by NewNode. Declared before `nodes_` so it
+  // outlives the nodes.
+  NodeArena node_arena_;
+
   // Store Nodes in std::list as they can be added and removed arbitrarily and
   // we want a stable iteration order. Keep a map from instruction pointer to
   // location in the list for fast lookup.
   NodeList nodes_;
   absl::flat_hash_map<const Node*, NodeList::iterator> node_iterators_;
 
+  // Node indices below the bound which are not used by any node.
+  std::vector<int64_t> free_node_indices_;
+  int64_t node_index_bound_ = 0;
+
   std::vector<Param*> params_;
   std::vector<Next*> next_values_;
   absl::flat_hash_map<Param*, absl::btree_set<Next*, Node::NodeIdLessThan>>
@@ -230,6 +300,17 @@ class FunctionBase {
       NameUniquer(/*separator=*/"__", GetIrReservedWords());
 
   std::optional<xls::ForeignFunctionData> foreign_function_;
+
+  std::vector<ChangeListener*> change_listeners_;
+
+  int64_t graph_version_ = 0;
+
+  // The reverse topological order at `topo_order_version_`. Guarded by a mutex
+  // as analyses may sort an unchanging function from several threads.
+  mutable absl::Mutex topo_order_mutex_;
+  mutable int64_t topo_order_version_ ABSL_GUARDED_BY(topo_order_mutex_) = -1;
+  mutable std::vector<Node*> reverse_topo_order_
+      ABSL_GUARDED_BY(topo_order_mutex_);
 };
 
 std::ostream& operator<<(std::ostream& os, const FunctionBase& function);
@@ -15,6 +15,7 @@
 #include "xls/ir/function_builder.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -25,6 +26,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
@@ -37,6 +39,8 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/symbolized_stacktrace.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/format_strings.h"
@@ -108,6 +112,112 @@ BValue BuilderBase::CreateBValue(Node* node, const SourceInfo& loc) {
   return BValue(last_node_, this);
 }
 
+BValue BuilderBase::Simplified(Node* node) {
+  last_node_ = node;
+  return BValue(node, this);
+}
+
+BValue BuilderBase::HashCons(Node* node) {
+  if (OpIsSideEffecting(node->op())) {
+    return BValue(node, this);
+  }
+  size_t hash = absl::HashOf(node->op(), node->GetType());
+  for (Node* operand : node->operands()) {
+    hash = absl::HashOf(hash, operand->id());
+  }
+  // Literals have no operands; hash bits values so that literals of the same
+  // type don't all land in one bucket.
+  if (node->Is<xls::Literal>() && node->As<xls::Literal>()->value().IsBits()) {
+    hash = absl::HashOf(hash, node->As<xls::Literal>()->value().bits());
+  }
+  std::vector<Node*>& bucket = hash_consed_nodes_[hash];
+  for (Node* candidate : bucket) {
+    if (candidate->operands() == node->operands() &&
+        candidate->IsDefinitelyEqualTo(node)) {
+      if (node->HasAssignedName()) {
+        return BValue(node, this);
+      }
+      // The node was just added so it has no users.
+      CHECK_OK(function_->RemoveNode(node));
+      return Simplified(candidate);
+    }
+  }
+  bucket.push_back(node);
+  return BValue(node, this);
+}
+
+std::optional<Bits> BuilderBase::TryFold(Op op,
+                                         absl::Span<const BValue> operands,
+                                         std::string_view name) const {
+  if (!simplify_ || !name.empty() || operands.empty()) {
+    return std::nullopt;
+  }
+  std::vector<Bits> values;
+  values.reserve(operands.size());
+  for (const BValue& operand : operands) {
+    if (!operand.node()->Is<xls::Literal>() ||
+        !operand.node()->As<xls::Literal>()->value().IsBits()) {
+      return std::nullopt;
+    }
+    values.push_back(operand.node()->As<xls::Literal>()->value().bits());
+  }
+  // Binary operations require operands of the same width; leave mismatches to
+  // the verifier.
+  for (const Bits& value : values) {
+    if (value.bit_count() != values.front().bit_count()) {
+      return std::nullopt;
+    }
+  }
+  auto compare = [&](bool (*f)(const Bits&, const Bits&)) -> Bits {
+    return UBits(f(values[0], values[1]) ? 1 : 0, 1);
+  };
+  switch (op) {
+    case Op::kNeg:
+      return bits_ops::Negate(values[0]);
+    case Op::kNot:
+      return bits_ops::Not(values[0]);
+    case Op::kAnd:
+      return bits_ops::NaryAnd(values);
+    case Op::kOr:
+      return bits_ops::NaryOr(values);
+    case Op::kXor:
+      return bits_ops::NaryXor(values);
+    default:
+      break;
+  }
+  if (values.size() != 2) {
+    return std::nullopt;
+  }
+  switch (op) {
+    case Op::kAdd:
+      return bits_ops::Add(values[0], values[1]);
+    case Op::kSub:
+      return bits_ops::Sub(values[0], values[1]);
+    case Op::kEq:
+      return compare(bits_ops::UEqual);
+    case Op::kNe:
+      return UBits(bits_ops::UEqual(values[0], values[1]) ? 0 : 1, 1);
+    case Op::kULt:
+      return compare(bits_ops::ULessThan);
+    case Op::kULe:
+      return compare(bits_ops::ULessThanOrEqual);
+    case Op::kUGt:
+      return compare(bits_ops::UGreaterThan);
+    case Op::kUGe:
+      return compare(bits_ops::UGreaterThanOrEqual);
+    case Op::kSLt:
+      return compare(bits_ops::SLessThan);
+    case Op::kSLe:
+      return compare(bits_ops::SLessThanOrEqual);
+    case Op::kSGt:
+      return compare(bits_ops::SGreaterThan);
+    case Op::kSGe:
+      return compare(bits_ops::SGreaterThanOrEqual);
+    default:
+      return std::nullopt;
+  }
+}
+
 void BuilderBase::SetForeignFunctionData(
     const std::optional<ForeignFunctionData>& ff) {
   function_->SetForeignFunctionData(ff);
@@ -115,9 +225,13 @@ void BuilderBase::SetForeignFunctionData(
 
 template <typename NodeT, typename... Args>
 BValue BuilderBase::AddNode(const SourceInfo& loc, Args&&... args) {
-  last_node_ = function_->AddNode<NodeT>(std::make_unique<NodeT>(
+  last_node_ = function_->AddNode<NodeT>(function_->NewNode<NodeT>(
       loc, std::forward<Args>(args)..., function_.get()));
-  return CreateBValue(last_node_, loc);
+  BValue result = CreateBValue(last_node_, loc);
+  if (hash_cons_ && result.valid()) {
+    return HashCons(result.node());
+  }
+  return result;
 }
 
 const std::string& BuilderBase::name() const { return function_->name(); }
@@ -160,6 +274,15 @@ BValue BuilderBase::Literal(Value value, const SourceInfo& loc,
   if (ErrorPending()) {
     return BValue();
   }
+  if (simplify_ && name.empty() && value.IsBits()) {
+    auto [it, inserted] = literals_.try_emplace(value.bits(), nullptr);
+    if (!inserted) {
+      return Simplified(it->second);
+    }
+    BValue literal = AddNode<xls::Literal>(loc, value, name);
+    it->second = literal.node();
+    return literal;
+  }
   return AddNode<xls::Literal>(loc, value, name);
 }
 
@@ -381,6 +504,21 @@ BValue BuilderBase::Tuple(absl::Span<const BValue> elements,
   for (const BValue& value : elements) {
     nodes.push_back(value.node());
   }
+  if (simplify_ && name.empty() && !nodes.empty() &&
+      nodes.front()->Is<xls::TupleIndex>()) {
+    // A tuple of the elements of another tuple in order is that tuple.
+    Node* source = nodes.front()->operand(0);
+    bool is_identity =
+        source->GetType()->AsTupleOrDie()->size() == nodes.size();
+    for (int64_t i = 0; is_identity && i < nodes.size(); ++i) {
+      is_identity = nodes[i]->Is<xls::TupleIndex>() &&
+                    nodes[i]->operand(0) == source &&
+                    nodes[i]->As<xls::TupleIndex>()->index() == i;
+    }
+    if (is_identity && !source->Is<xls::Param>()) {
+      return Simplified(source);
+    }
+  }
   return AddNode<xls::Tuple>(loc, nodes, name);
 }
 
@@ -416,6 +554,11 @@ BValue BuilderBase::TupleIndex(BValue arg, int64_t idx, const SourceInfo& loc,
             GetType(arg)->ToString()),
         loc);
   }
+  if (simplify_ && name.empty() && arg.node()->Is<xls::Tuple>() && idx >= 0 &&
+      idx < arg.node()->operand_count() &&
+      !arg.node()->operand(idx)->Is<xls::Param>()) {
+    return Simplified(arg.node()->operand(idx));
+  }
   return AddNode<xls::TupleIndex>(loc, arg.node(), idx, name);
 }
 
@@ -1316,6 +1459,9 @@ BValue BuilderBase::AddUnOp(Op op, BValue x, const SourceInfo& loc,
                                     OpToString(op)),
                     loc);
   }
+  if (std::optional<Bits> folded = TryFold(op, {x}, name)) {
+    return Literal(Value(*std::move(folded)), loc);
+  }
   return AddNode<UnOp>(loc, x.node(), op, name);
 }
 
@@ -1330,6 +1476,9 @@ BValue BuilderBase::AddBinOp(Op op, BValue lhs, BValue rhs,
                                     OpToString(op)),
                     loc);
   }
+  if (std::optional<Bits> folded = TryFold(op, {lhs, rhs}, name)) {
+    return Literal(Value(*std::move(folded)), loc);
+  }
   return AddNode<BinOp>(loc, lhs.node(), rhs.node(), op, name);
 }
 
@@ -1346,6 +1495,9 @@ BValue BuilderBase::AddCompareOp(Op op, BValue lhs, BValue rhs,
                         OpToString(op)),
         loc);
   }
+  if (std::optional<Bits> folded = TryFold(op, {lhs, rhs}, name)) {
+    return Literal(Value(*std::move(folded)), loc);
+  }
   return AddNode<CompareOp>(loc, lhs.node(), rhs.node(), op, name);
 }
 
@@ -1359,6 +1511,9 @@ BValue BuilderBase::AddNaryOp(Op op, absl::Span<const BValue> args,
                                     OpToString(op)),
                     loc);
   }
+  if (std::optional<Bits> folded = TryFold(op, args, name)) {
+    return Literal(Value(*std::move(folded)), loc);
+  }
   std::vector<Node*> nodes;
   for (const BValue& bvalue : args) {
     nodes.push_back(bvalue.node());
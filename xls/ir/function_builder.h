@@ -21,6 +21,7 @@
 //
 // To this end, DO NOT add node/function headers here.
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -30,12 +31,14 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/casts.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/block.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/function.h"
@@ -153,6 +156,31 @@ class BuilderBase {
   // Get access to currently built up function (or proc).
   FunctionBase* function() const { return function_.get(); }
 
+  // Sets whether the builder simplifies nodes as they are added rather than
+  // leaving the cleanup to the optimizer. When enabled:
+  //
+  //  * operations on bits literals (add, sub, neg, not, and, or, xor and
+  //    comparisons) are folded into a literal,
+  //  * bits literals with the same value share a single node,
+  //  * tuple-index of a tuple node forwards the element, and
+  //  * a tuple of all the elements of another tuple, in order, is that tuple.
+  //
+  // The returned BValue may then refer to a previously added node. Only nodes
+  // for which no name is given are simplified, and never to a parameter, so
+  // names given to the builder and parameter names are preserved. Disabled by
+  // default.
+  void set_simplify(bool value) { simplify_ = value; }
+
+  // Sets whether the builder hash-conses nodes: when enabled, a request for a
+  // side-effect-free node with the same op, type, attributes and operands (in
+  // the same order) as a node added earlier returns the earlier node rather
+  // than adding a duplicate. Named requests always add a new node but nodes
+  // added by named requests are returned for later identical unnamed ones.
+  // This removes at construction the duplicate literals and operations that
+  // front ends commonly emit and CSE would otherwise remove. Disabled by
+  // default.
+  void set_hash_cons(bool value) { hash_cons_ = value; }
+
   // Declares a parameter to the function being built of type "type".
   virtual BValue Param(std::string_view name, Type* type,
                        const SourceInfo& loc = SourceInfo()) = 0;
@@ -635,6 +663,21 @@ class BuilderBase {
 
   BValue CreateBValue(Node* node, const SourceInfo& loc);
 
+  // Returns a BValue for `node`, an existing node which is the simplified
+  // form of a node the caller would otherwise add.
+  BValue Simplified(Node* node);
+
+  // Returns a BValue for `node`, a node just added to the function, or for an
+  // earlier identical node if there is one and `node` is unnamed, in which case
+  // `node` is removed.
+  BValue HashCons(Node* node);
+
+  // Returns the result of applying `op` to `operands` if simplification is
+  // enabled, no name is given and all of the operands are bits literals which
+  // the op can be folded over.
+  std::optional<Bits> TryFold(Op op, absl::Span<const BValue> operands,
+                              std::string_view name) const;
+
   // The most recently added node to the function.
   Node* last_node_ = nullptr;
 
@@ -647,6 +690,19 @@ class BuilderBase {
   // tests.
   bool should_verify_;
 
+  // Whether nodes are simplified as they are added; see set_simplify().
+  bool simplify_ = false;
+
+  // The unnamed bits literals added while simplifying, by value.
+  absl::flat_hash_map<Bits, Node*> literals_;
+
+  // Whether nodes are hash-consed as they are added; see set_hash_cons().
+  bool hash_cons_ = false;
+
+  // The nodes which may be returned for identical requests, bucketed by a hash
+  // of their op, type and operands.
+  absl::flat_hash_map<size_t, std::vector<Node*>> hash_consed_nodes_;
+
   std::string error_msg_;
   std::string error_stacktrace_;
   SourceInfo error_loc_;
@@ -121,6 +121,103 @@ TEST(FunctionBuilderTest, NonTupleValueToTupleIndex) {
                HasSubstr("Operand of tuple-index must be tuple-typed")));
 }
 
+TEST(FunctionBuilderTest, SimplifyFoldsLiteralOperations) {
+  Package p("p");
+  FunctionBuilder b("f", &p);
+  b.set_simplify(true);
+  BValue x = b.Param("x", p.GetBitsType(8));
+  BValue three = b.Literal(UBits(3, 8));
+  BValue sum = b.Add(three, b.Literal(UBits(4, 8)));
+  EXPECT_THAT(sum.node(), m::Literal(UBits(7, 8)));
+  EXPECT_THAT(b.Not(b.And(sum, three)).node(), m::Literal(UBits(0xfc, 8)));
+  EXPECT_THAT(b.ULt(three, sum).node(), m::Literal(UBits(1, 1)));
+  EXPECT_THAT(b.SGt(b.Negate(three), three).node(), m::Literal(UBits(0, 1)));
+
+  // Literals of the same value are shared unless named.
+  EXPECT_EQ(b.Literal(UBits(3, 8)).node(), three.node());
+  EXPECT_NE(b.Literal(UBits(3, 16)).node(), three.node());
+  EXPECT_NE(b.Literal(UBits(3, 8), SourceInfo(), "three").node(),
+            three.node());
+
+  // Operations with non-literal operands or a name are not folded.
+  EXPECT_THAT(b.Add(x, three).node(), m::Add(m::Param("x"), m::Literal(3)));
+  EXPECT_THAT(b.Add(three, three, SourceInfo(), "six").node(),
+              m::Add(m::Literal(3), m::Literal(3)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, b.BuildWithReturnValue(sum));
+  EXPECT_THAT(func->return_value(), m::Literal(UBits(7, 8)));
+}
+
+TEST(FunctionBuilderTest, SimplifyForwardsTupleElements) {
+  Package p("p");
+  FunctionBuilder b("f", &p);
+  b.set_simplify(true);
+  BValue x = b.Param("x", p.GetBitsType(8));
+  TupleType* pair_type = p.GetTupleType({p.GetBitsType(8), p.GetBitsType(8)});
+  BValue t = b.Param("t", p.GetTupleType({pair_type, p.GetBitsType(1)}));
+  BValue neg_x = b.Negate(x);
+  BValue tuple = b.Tuple({neg_x, x});
+  EXPECT_EQ(b.TupleIndex(tuple, 0).node(), neg_x.node());
+  // Parameters are not forwarded so that they are never renamed.
+  EXPECT_THAT(b.TupleIndex(tuple, 1).node(), m::TupleIndex(tuple.node(), 1));
+
+  // Rebuilding a tuple from all of its elements in order yields the tuple.
+  BValue inner = b.TupleIndex(t, 0);
+  BValue identity = b.Tuple({b.TupleIndex(inner, 0), b.TupleIndex(inner, 1)});
+  EXPECT_EQ(identity.node(), inner.node());
+  BValue swapped = b.Tuple({b.TupleIndex(inner, 1), b.TupleIndex(inner, 0)});
+  EXPECT_THAT(swapped.node(), m::Tuple(m::TupleIndex(inner.node(), 1),
+                                       m::TupleIndex(inner.node(), 0)));
+  // A tuple parameter is not substituted for a rebuilt tuple.
+  BValue t_copy = b.Tuple({inner, b.TupleIndex(t, 1)});
+  EXPECT_THAT(t_copy.node(), m::Tuple(inner.node(), m::TupleIndex()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, b.BuildWithReturnValue(identity));
+  EXPECT_EQ(func->return_value(), inner.node());
+}
+
+TEST(FunctionBuilderTest, HashConsSharesIdenticalNodes) {
+  Package p("p");
+  FunctionBuilder b("f", &p);
+  b.set_hash_cons(true);
+  BValue x = b.Param("x", p.GetBitsType(8));
+  BValue y = b.Param("y", p.GetBitsType(8));
+  BValue one = b.Literal(UBits(1, 8));
+  BValue sum = b.Add(x, one);
+  EXPECT_EQ(b.Literal(UBits(1, 8)).node(), one.node());
+  EXPECT_EQ(b.Add(x, b.Literal(UBits(1, 8))).node(), sum.node());
+  EXPECT_EQ(b.BitSlice(sum, 0, 4).node(), b.BitSlice(sum, 0, 4).node());
+
+  // Different operands, operand order or attributes are not shared.
+  EXPECT_NE(b.Literal(UBits(1, 16)).node(), one.node());
+  EXPECT_NE(b.Add(one, x).node(), sum.node());
+  EXPECT_NE(b.Add(y, one).node(), sum.node());
+  EXPECT_NE(b.BitSlice(sum, 0, 4).node(), b.BitSlice(sum, 1, 4).node());
+
+  // Named requests add a new node, which later unnamed requests may share.
+  BValue named = b.Add(x, y, SourceInfo(), "named");
+  EXPECT_EQ(named.node()->GetName(), "named");
+  EXPECT_NE(b.Add(x, one, SourceInfo(), "sum").node(), sum.node());
+  EXPECT_EQ(b.Add(x, y).node(), named.node());
+
+  XLS_ASSERT_OK(b.BuildWithReturnValue(b.Tuple({sum, named})).status());
+}
+
+TEST(FunctionBuilderTest, HashConsDoesNotShareSideEffects) {
+  Package p("p");
+  FunctionBuilder b("f", &p);
+  b.set_hash_cons(true);
+  BValue tok = b.Param("tok", p.GetTokenType());
+  BValue cond = b.Param("cond", p.GetBitsType(1));
+  BValue assert_a = b.Assert(tok, cond, "message");
+  BValue assert_b = b.Assert(tok, cond, "message");
+  EXPECT_NE(assert_a.node(), assert_b.node());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * func,
+      b.BuildWithReturnValue(b.AfterAll({assert_a, assert_b})));
+  EXPECT_EQ(func->node_count(), 5);
+}
+
 TEST(FunctionBuilderTest, LiteralArrayTest) {
   Package p("p");
   FunctionBuilder b("literal_array", &p);
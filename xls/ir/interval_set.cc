@@ -17,11 +17,14 @@
 #include <algorithm>
 #include <cstdint>
 #include <functional>
-#include <list>
+#include <limits>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -79,33 +82,86 @@ void IntervalSet::Normalize() {
     return;
   }
 
+  if (BitCount() <= 64) {
+    NormalizeSmall();
+    is_normalized_ = true;
+    return;
+  }
+
+  // Split improper intervals in place, appending their upper halves.
   Bits zero(BitCount());
   Bits max = Bits::AllOnes(BitCount());
-  std::vector<Interval> expand_improper;
+  int64_t original_size = intervals_.size();
+  for (int64_t i = 0; i < original_size; ++i) {
+    if (intervals_[i].IsImproper()) {
+      Interval upper(intervals_[i].LowerBound(), max);
+      intervals_[i] = Interval(zero, intervals_[i].UpperBound());
+      intervals_.push_back(std::move(upper));
+    }
+  }
+
+  std::sort(intervals_.begin(), intervals_.end());
+
+  // Merge overlapping and abutting intervals in place.
+  int64_t merged = 0;
+  for (int64_t i = 0; i < intervals_.size();) {
+    Interval interval = std::move(intervals_[i++]);
+    while ((i < intervals_.size()) &&
+           (Interval::Overlaps(interval, intervals_[i]) ||
+            Interval::Abuts(interval, intervals_[i]))) {
+      interval = Interval::ConvexHull(interval, intervals_[i]);
+      ++i;
+    }
+    intervals_[merged++] = std::move(interval);
+  }
+  intervals_.erase(intervals_.begin() + merged, intervals_.end());
+
+  is_normalized_ = true;
+}
+
+void IntervalSet::NormalizeSmall() {
+  CHECK_LE(BitCount(), 64);
+  const uint64_t max = BitCount() == 64 ? std::numeric_limits<uint64_t>::max()
+                                        : (uint64_t{1} << BitCount()) - 1;
+  absl::InlinedVector<std::pair<uint64_t, uint64_t>, 8> packed;
+  packed.reserve(intervals_.size());
   for (const Interval& interval : intervals_) {
-    if (interval.IsImproper()) {
-      expand_improper.push_back(Interval(zero, interval.UpperBound()));
-      expand_improper.push_back(Interval(interval.LowerBound(), max));
+    uint64_t lower = interval.LowerBound().bitmap().GetWord(0);
+    uint64_t upper = interval.UpperBound().bitmap().GetWord(0);
+    if (lower > upper) {
+      packed.push_back({0, upper});
+      packed.push_back({lower, max});
     } else {
-      expand_improper.push_back(interval);
+      packed.push_back({lower, upper});
     }
   }
 
-  std::sort(expand_improper.begin(), expand_improper.end());
+  absl::c_sort(packed);
 
-  intervals_.clear();
-  for (int32_t i = 0; i < expand_improper.size();) {
-    Interval interval = expand_improper[i++];
-    while ((i < expand_improper.size()) &&
-           (Interval::Overlaps(interval, expand_improper[i]) ||
-            Interval::Abuts(interval, expand_improper[i]))) {
-      interval = Interval::ConvexHull(interval, expand_improper[i]);
+  int64_t merged = 0;
+  for (int64_t i = 0; i < packed.size();) {
+    auto [lower, upper] = packed[i++];
+    // Abutting intervals are merged too. If `upper + 1` wraps around then
+    // `upper` is the maximum value and the first comparison already holds.
+    while (i < packed.size() &&
+           (packed[i].first <= upper || packed[i].first == upper + 1)) {
+      upper = std::max(upper, packed[i].second);
       ++i;
     }
-    intervals_.push_back(interval);
+    packed[merged++] = {lower, upper};
   }
 
-  is_normalized_ = true;
+  // Overwrite the existing intervals rather than clearing them so any heap
+  // storage is reused. Bits of at most 64 bits are stored inline.
+  if (merged < intervals_.size()) {
+    intervals_.erase(intervals_.begin() + merged, intervals_.end());
+  } else {
+    intervals_.resize(merged);
+  }
+  for (int64_t i = 0; i < merged; ++i) {
+    intervals_[i] = Interval(UBits(packed[i].first, BitCount()),
+                             UBits(packed[i].second, BitCount()));
+  }
 }
 
 std::optional<Interval> IntervalSet::ConvexHull() const {
@@ -218,74 +274,68 @@ bool IntervalSet::ForEachElement(
 
 IntervalSet IntervalSet::Combine(const IntervalSet& lhs,
                                  const IntervalSet& rhs) {
-  CHECK_EQ(lhs.BitCount(), rhs.BitCount());
-  IntervalSet combined(lhs.BitCount());
-  for (const Interval& interval : lhs.intervals_) {
-    combined.AddInterval(interval);
-  }
-  for (const Interval& interval : rhs.intervals_) {
-    combined.AddInterval(interval);
-  }
-  combined.Normalize();
+  IntervalSet combined = lhs;
+  combined.CombineWith(rhs);
   return combined;
 }
 
+void IntervalSet::CombineWith(const IntervalSet& other) {
+  CHECK_EQ(BitCount(), other.BitCount());
+  if (!other.intervals_.empty()) {
+    intervals_.insert(intervals_.end(), other.intervals_.begin(),
+                      other.intervals_.end());
+    is_normalized_ = false;
+  }
+  Normalize();
+}
+
 IntervalSet IntervalSet::Intersect(const IntervalSet& lhs,
                                    const IntervalSet& rhs) {
-  CHECK_EQ(lhs.BitCount(), rhs.BitCount());
-  CHECK(lhs.is_normalized_);
-  CHECK(rhs.is_normalized_);
-  IntervalSet result(lhs.BitCount());
-  std::list<Interval> lhs_intervals(lhs.Intervals().begin(),
-                                    lhs.Intervals().end());
-  std::list<Interval> rhs_intervals(rhs.Intervals().begin(),
-                                    rhs.Intervals().end());
-  auto left = lhs_intervals.begin();
-  auto right = rhs_intervals.begin();
-  // lhs/rhs_intervals should be sorted in increasing lexicographic order
-  // (i.e.: compare on lower bound, then upper bound if lower bounds are equal)
-  // at this point, since we CHECK that they are normalized.
-  while ((left != lhs_intervals.end()) && (right != rhs_intervals.end())) {
+  IntervalSet result = lhs;
+  result.IntersectWith(rhs);
+  return result;
+}
+
+void IntervalSet::IntersectWith(const IntervalSet& other) {
+  CHECK_EQ(BitCount(), other.BitCount());
+  CHECK(is_normalized_);
+  CHECK(other.is_normalized_);
+  if (other.IsMaximal()) {
+    return;
+  }
+  if (IsMaximal()) {
+    intervals_ = other.intervals_;
+    return;
+  }
+  // Both lists are sorted and disjoint, so a single sweep which advances past
+  // whichever interval ends first finds every overlap in order. The pieces are
+  // already normalized: two pieces within the same interval of one set come
+  // from different, hence non-abutting, intervals of the other.
+  IntervalVector result;
+  auto left = intervals_.begin();
+  auto right = other.intervals_.begin();
+  while (left != intervals_.end() && right != other.intervals_.end()) {
+    const Bits& lower =
+        bits_ops::UGreaterThan(left->LowerBound(), right->LowerBound())
+            ? left->LowerBound()
+            : right->LowerBound();
+    const Bits& upper =
+        bits_ops::ULessThan(left->UpperBound(), right->UpperBound())
+            ? left->UpperBound()
+            : right->UpperBound();
+    if (bits_ops::ULessThanOrEqual(lower, upper)) {
+      result.push_back(Interval(lower, upper));
+    }
     if (bits_ops::ULessThan(left->UpperBound(), right->UpperBound())) {
-      if (std::optional<Interval> intersection =
-              Interval::Intersect(*left, *right)) {
-        result.AddInterval(*intersection);
-        // The difference should only ever contain 0 or 1 interval.
-        std::vector<Interval> difference = Interval::Difference(*right, *left);
-        std::reverse(difference.begin(), difference.end());
-        for (const Interval& remainder : difference) {
-          right = rhs_intervals.insert(right, remainder);
-        }
-      }
       ++left;
-      continue;
-    }
-    if (bits_ops::ULessThan(right->UpperBound(), left->UpperBound())) {
-      if (std::optional<Interval> intersection =
-              Interval::Intersect(*left, *right)) {
-        result.AddInterval(*intersection);
-        // The difference should only ever contain 0 or 1 interval.
-        std::vector<Interval> difference = Interval::Difference(*left, *right);
-        std::reverse(difference.begin(), difference.end());
-        for (const Interval& remainder : difference) {
-          left = lhs_intervals.insert(left, remainder);
-        }
-      }
+    } else if (bits_ops::ULessThan(right->UpperBound(), left->UpperBound())) {
       ++right;
-      continue;
-    }
-    if (bits_ops::UEqual(left->UpperBound(), right->UpperBound())) {
-      if (std::optional<Interval> intersection =
-              Interval::Intersect(*left, *right)) {
-        result.AddInterval(*intersection);
-      }
+    } else {
       ++left;
       ++right;
-      continue;
     }
   }
-  result.Normalize();
-  return result;
+  intervals_ = std::move(result);
 }
 
 /* static */ IntervalSet IntervalSet::Of(absl::Span<Interval const> intervals) {
@@ -420,4 +470,16 @@ std::string IntervalSet::ToString() const {
   return absl::StrFormat("[%s]", absl::StrJoin(strings, ", "));
 }
 
+int64_t EstimateHeapBytes(const IntervalSet& set) {
+  int64_t bytes =
+      set.intervals_.capacity() > IntervalSet::kInlineIntervalCount
+          ? set.intervals_.capacity() * sizeof(Interval)
+          : 0;
+  for (const Interval& interval : set.intervals_) {
+    bytes += EstimateHeapBytes(interval.LowerBound()) +
+             EstimateHeapBytes(interval.UpperBound());
+  }
+  return bytes;
+}
+
 }  // namespace xls
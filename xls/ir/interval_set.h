@@ -19,9 +19,11 @@
 #include <functional>
 #include <iosfwd>
 #include <optional>
+#include <iterator>
 #include <string>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/types/span.h"
 #include "xls/ir/bits.h"
@@ -71,7 +73,8 @@ class IntervalSet {
 
   std::vector<Interval> Intervals() && {
     CHECK(is_normalized_);
-    return intervals_;
+    return std::vector<Interval>(std::make_move_iterator(intervals_.begin()),
+                                 std::make_move_iterator(intervals_.end()));
   }
 
   // Returns the `BitCount()` of all intervals in the interval set.
@@ -131,10 +134,18 @@ class IntervalSet {
   // interval sets.
   static IntervalSet Combine(const IntervalSet& lhs, const IntervalSet& rhs);
 
+  // Replaces this interval set with its union with `other`. The result is
+  // normalized.
+  void CombineWith(const IntervalSet& other);
+
   // Returns a normalized set of intervals comprising the intersection of the
   // two given interval sets.
   static IntervalSet Intersect(const IntervalSet& lhs, const IntervalSet& rhs);
 
+  // Replaces this interval set with its intersection with `other`. Both sets
+  // must be normalized.
+  void IntersectWith(const IntervalSet& other);
+
   // Returns the normalized set of intervals comprising the complemet of the
   // given interval set.
   static IntervalSet Complement(const IntervalSet& set);
@@ -229,10 +240,22 @@ class IntervalSet {
     absl::Format(&sink, "%s", set.ToString());
   }
 
+  // Returns an estimate of the heap memory in bytes held by `set`.
+  friend int64_t EstimateHeapBytes(const IntervalSet& set);
+
  private:
+  // Most interval sets hold only a few intervals so these are stored inline to
+  // avoid allocating when interval sets are created and combined.
+  static constexpr int64_t kInlineIntervalCount = 2;
+  using IntervalVector = absl::InlinedVector<Interval, kInlineIntervalCount>;
+
+  // Normalize() for sets at most 64 bits wide, which sorts and merges the
+  // bounds as packed integers rather than as `Bits`.
+  void NormalizeSmall();
+
   bool is_normalized_;
   int64_t bit_count_;
-  std::vector<Interval> intervals_;
+  IntervalVector intervals_;
 };
 
 inline std::ostream& operator<<(std::ostream& os,
@@ -84,6 +84,25 @@ TEST(IntervalTest, Normalize) {
                 MakeInterval(20, std::numeric_limits<uint32_t>::max(), 32)}));
 }
 
+TEST(IntervalTest, NormalizeWide) {
+  // Sets wider than 64 bits are normalized without packing the bounds.
+  IntervalSet wide(100);
+  wide.AddInterval(MakeInterval(21, 30, 100));
+  wide.AddInterval(MakeInterval(5, 20, 100));
+  wide.AddInterval(MakeInterval(40, 10, 100));
+  wide.Normalize();
+  EXPECT_EQ(wide.Intervals(),
+            (std::vector<Interval>{
+                MakeInterval(0, 30, 100),
+                Interval(UBits(40, 100), Bits::AllOnes(100))}));
+
+  IntervalSet full(64);
+  full.AddInterval(MakeInterval(10, 5, 64));
+  full.AddInterval(MakeInterval(6, 9, 64));
+  full.Normalize();
+  EXPECT_TRUE(full.IsMaximal());
+}
+
 TEST(IntervalTest, ConvexHull) {
   IntervalSet example(32);
   example.AddInterval(MakeInterval(10, 20, 32));
@@ -178,6 +197,54 @@ TEST(IntervalTest, Combine) {
                                    MakeInterval(25, 35, 32)}));
 }
 
+TEST(IntervalTest, CombineWith) {
+  IntervalSet x(32);
+  x.AddInterval(MakeInterval(5, 10, 32));
+  x.Normalize();
+
+  IntervalSet y(32);
+  y.AddInterval(MakeInterval(25, 30, 32));
+  y.AddInterval(MakeInterval(11, 12, 32));
+
+  x.CombineWith(y);
+  EXPECT_TRUE(x.IsNormalized());
+  EXPECT_EQ(x.Intervals(), (std::vector<Interval>{MakeInterval(5, 12, 32),
+                                                  MakeInterval(25, 30, 32)}));
+
+  x.CombineWith(IntervalSet(32));
+  EXPECT_EQ(x.Intervals(), (std::vector<Interval>{MakeInterval(5, 12, 32),
+                                                  MakeInterval(25, 30, 32)}));
+}
+
+TEST(IntervalTest, IntersectWith) {
+  IntervalSet x(32);
+  x.AddInterval(MakeInterval(0, 10, 32));
+  x.AddInterval(MakeInterval(20, 30, 32));
+  x.Normalize();
+
+  IntervalSet y(32);
+  y.AddInterval(MakeInterval(5, 22, 32));
+  y.AddInterval(MakeInterval(24, 40, 32));
+  y.Normalize();
+
+  x.IntersectWith(y);
+  EXPECT_TRUE(x.IsNormalized());
+  EXPECT_EQ(x.Intervals(),
+            (std::vector<Interval>{MakeInterval(5, 10, 32),
+                                   MakeInterval(20, 22, 32),
+                                   MakeInterval(24, 30, 32)}));
+
+  x.IntersectWith(IntervalSet::Maximal(32));
+  EXPECT_EQ(x.Intervals(),
+            (std::vector<Interval>{MakeInterval(5, 10, 32),
+                                   MakeInterval(20, 22, 32),
+                                   MakeInterval(24, 30, 32)}));
+
+  IntervalSet maximal = IntervalSet::Maximal(32);
+  maximal.IntersectWith(y);
+  EXPECT_EQ(maximal, y);
+}
+
 void IntersectMatchesSetIntersection(const IntervalSet& lhs,
                                      const IntervalSet& rhs) {
   IntervalSet intersection = IntervalSet::Intersect(lhs, rhs);
@@ -477,9 +477,18 @@ absl::StatusOr<Value> Parser::ParseValueInternal(std::optional<Type*> type) {
       }
       XLS_ASSIGN_OR_RETURN(Value element_value,
                            ParseValueInternal(element_type));
+      if (!values.empty() && !values.front().SameTypeAs(element_value)) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Array element %s does not have the same type as %s @ %s",
+            element_value.ToString(), values.front().ToString(),
+            start_pos.ToHumanString()));
+      }
       values.push_back(std::move(element_value));
     }
-    return Value::Array(values);
+    if (values.empty()) {
+      return absl::UnimplementedError("Empty array Values are not supported.");
+    }
+    return Value::ArrayOwned(std::move(values));
   }
   if (type_kind == TypeKind::kTuple) {
     XLS_RETURN_IF_ERROR(
@@ -502,7 +511,7 @@ absl::StatusOr<Value> Parser::ParseValueInternal(std::optional<Type*> type) {
                            ParseValueInternal(element_type));
       values.push_back(std::move(element_value));
     }
-    return Value::Tuple(values);
+    return Value::TupleOwned(std::move(values));
   }
   if (type_kind == TypeKind::kToken) {
     XLS_RETURN_IF_ERROR(scanner_.DropKeywordOrError("token"));
@@ -517,7 +526,7 @@ absl::StatusOr<std::vector<Value>> Parser::ParseCommaSeparatedValues(
   std::vector<Value> values;
   do {
     XLS_ASSIGN_OR_RETURN(Value value, ParseValueInternal(type));
-    values.push_back(value);
+    values.push_back(std::move(value));
   } while (scanner_.TryDropToken(LexicalTokenType::kComma));
   return values;
 }
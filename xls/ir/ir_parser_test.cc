@@ -2328,6 +2328,15 @@ TEST(IrParserTest, ParsesComplexValueWithEmbeddedTypes) {
   EXPECT_EQ(expected, v);
 }
 
+TEST(IrParserTest, ParseArrayValueWithMixedTypes) {
+  EXPECT_THAT(Parser::ParseTypedValue("[bits[12]:0xba5, bits[11]:0x7]"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("does not have the same type")));
+  EXPECT_THAT(Parser::ParseTypedValue("[]"),
+              StatusIs(absl::StatusCode::kUnimplemented,
+                       HasSubstr("Empty array")));
+}
+
 TEST(IrParserTest, ParsesTokenType) {
   const std::string input = "token";
   XLS_ASSERT_OK_AND_ASSIGN(Value v, Parser::ParseTypedValue(input));
@@ -17,6 +17,7 @@
 #include <cctype>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -124,19 +125,14 @@ std::string Token::ToString() const {
                          pos_.ToHumanString());
 }
 
-namespace {
-
-// Helper class for tokenizing a string.
-// TODO(meheff): This could be combined into Scanner class and made lazy at the
-// same time.
+// Helper class for tokenizing a string on demand.
 class Tokenizer {
  public:
-  // Tokenizes the given string and returns the vector of Tokens.
-  static absl::StatusOr<std::vector<Token>> TokenizeString(
-      std::string_view str) {
-    Tokenizer tokenizer(str);
-    return tokenizer.Tokenize();
-  }
+  explicit Tokenizer(std::string_view str) : str_(str) {}
+
+  // Returns the next token in the string, or std::nullopt at the end of the
+  // string.
+  absl::StatusOr<std::optional<Token>> Next();
 
  private:
   // Drops all whitespace starting at current index. Returns true if any
@@ -234,132 +230,6 @@ class Tokenizer {
     return std::string_view(str_.data() + start, index_ - start);
   }
 
-  // Tokenizes the internal string.
-  absl::StatusOr<std::vector<Token>> Tokenize() {
-    std::vector<Token> tokens;
-    while (!EndOfString()) {
-      if (DropWhiteSpace() || DropEndOfLineComment()) {
-        continue;
-      }
-
-      const int64_t start_lineno = lineno();
-      const int64_t start_colno = colno();
-
-      // Literal numbers can decimal, binary (eg, 0b0101) or hexadecimal (eg,
-      // 0xbeef) so capture all alphanumeric characters after the initial
-      // digit. Literal numbers can also contain '_'s after the first
-      // character which are used to improve readability (example:
-      // '0xabcd_ef00').
-      if (isdigit(current()) ||
-          (current() == '-' && next().has_value() && isdigit(*next()))) {
-        std::string_view value = CaptureWhile(
-            [](char c) { return absl::ascii_isalnum(c) || c == '_'; },
-            /*min_chars=*/1);
-        tokens.push_back(Token(LexicalTokenType::kLiteral, value, start_lineno,
-                               start_colno));
-        continue;
-      }
-
-      if (isalpha(current()) != 0 || current() == '_') {
-        std::string_view value = CaptureWhile([](char c) {
-          return isalpha(c) != 0 || c == '_' || c == '.' || isdigit(c) != 0;
-        });
-        tokens.push_back(
-            Token::MakeIdentOrKeyword(value, start_lineno, start_colno));
-        continue;
-      }
-
-      // Look for multi-character tokens.
-      if (MatchSubstring("->")) {
-        tokens.push_back(Token(LexicalTokenType::kRightArrow, "->",
-                               start_lineno, start_colno));
-        Advance(2);
-        continue;
-      }
-
-      // Match quoted strings. Double-quoted strings (e.g., "foo") and
-      // triple-double-quoted strings (e.g., """foo""") are allowed. Only
-      // triple-double-quoted strings can contain new lines.
-      std::optional<std::string_view> content;
-      XLS_ASSIGN_OR_RETURN(
-          content, MatchQuotedString("\"\"\"", /*allow_multiline=*/true));
-      if (content.has_value()) {
-        tokens.push_back(Token(LexicalTokenType::kQuotedString, content.value(),
-                               start_lineno, start_colno));
-        continue;
-      }
-      XLS_ASSIGN_OR_RETURN(content,
-                           MatchQuotedString("\"", /*allow_multiline=*/false));
-      if (content.has_value()) {
-        tokens.push_back(Token(LexicalTokenType::kQuotedString, content.value(),
-                               start_lineno, start_colno));
-        continue;
-      }
-
-      // Handle single-character tokens.
-      LexicalTokenType token_type;
-
-      switch (current()) {
-        case '-':
-          token_type = LexicalTokenType::kMinus;
-          break;
-        case '+':
-          token_type = LexicalTokenType::kAdd;
-          break;
-        case '.':
-          token_type = LexicalTokenType::kDot;
-          break;
-        case ':':
-          token_type = LexicalTokenType::kColon;
-          break;
-        case ',':
-          token_type = LexicalTokenType::kComma;
-          break;
-        case '=':
-          token_type = LexicalTokenType::kEquals;
-          break;
-        case '[':
-          token_type = LexicalTokenType::kBracketOpen;
-          break;
-        case ']':
-          token_type = LexicalTokenType::kBracketClose;
-          break;
-        case '{':
-          token_type = LexicalTokenType::kCurlOpen;
-          break;
-        case '}':
-          token_type = LexicalTokenType::kCurlClose;
-          break;
-        case '(':
-          token_type = LexicalTokenType::kParenOpen;
-          break;
-        case ')':
-          token_type = LexicalTokenType::kParenClose;
-          break;
-        case '>':
-          token_type = LexicalTokenType::kGt;
-          break;
-        case '<':
-          token_type = LexicalTokenType::kLt;
-          break;
-        case '#':
-          token_type = LexicalTokenType::kHash;
-          break;
-        default:
-          std::string char_str = absl::ascii_iscntrl(current())
-                                     ? absl::StrFormat("\\x%02x", current())
-                                     : std::string(1, current());
-          LOG(ERROR) << "IR text with error: " << str_;
-          return absl::InvalidArgumentError(absl::StrFormat(
-              "Invalid character in IR text \"%s\" @ %s", char_str,
-              TokenPos{lineno(), colno()}.ToHumanString()));
-      }
-      tokens.push_back(Token(token_type, lineno(), colno()));
-      Advance();
-    }
-    return tokens;
-  }
-
   // Returns the character at the current index.
   char current() const { return str_.at(index_); }
 
@@ -379,9 +249,6 @@ class Tokenizer {
   int64_t lineno() const { return lineno_; }
   int64_t colno() const { return colno_; }
 
- private:
-  explicit Tokenizer(std::string_view str) : str_(str) {}
-
   // The string being tokenized.
   std::string_view str_;
 
@@ -393,30 +260,183 @@ class Tokenizer {
   int64_t colno_ = 0;
 };
 
-}  // namespace
+absl::StatusOr<std::optional<Token>> Tokenizer::Next() {
+  while (!EndOfString()) {
+    if (DropWhiteSpace() || DropEndOfLineComment()) {
+      continue;
+    }
+
+    const int64_t start_lineno = lineno();
+    const int64_t start_colno = colno();
+
+    // Literal numbers can decimal, binary (eg, 0b0101) or hexadecimal (eg,
+    // 0xbeef) so capture all alphanumeric characters after the initial
+    // digit. Literal numbers can also contain '_'s after the first
+    // character which are used to improve readability (example:
+    // '0xabcd_ef00').
+    if (isdigit(current()) ||
+        (current() == '-' && next().has_value() && isdigit(*next()))) {
+      std::string_view value = CaptureWhile(
+          [](char c) { return absl::ascii_isalnum(c) || c == '_'; },
+          /*min_chars=*/1);
+      return Token(LexicalTokenType::kLiteral, value, start_lineno,
+                   start_colno);
+    }
+
+    if (isalpha(current()) != 0 || current() == '_') {
+      std::string_view value = CaptureWhile([](char c) {
+        return isalpha(c) != 0 || c == '_' || c == '.' || isdigit(c) != 0;
+      });
+      return Token::MakeIdentOrKeyword(value, start_lineno, start_colno);
+    }
+
+    // Look for multi-character tokens.
+    if (MatchSubstring("->")) {
+      Advance(2);
+      return Token(LexicalTokenType::kRightArrow, "->", start_lineno,
+                   start_colno);
+    }
+
+    // Match quoted strings. Double-quoted strings (e.g., "foo") and
+    // triple-double-quoted strings (e.g., """foo""") are allowed. Only
+    // triple-double-quoted strings can contain new lines.
+    std::optional<std::string_view> content;
+    XLS_ASSIGN_OR_RETURN(
+        content, MatchQuotedString("\"\"\"", /*allow_multiline=*/true));
+    if (content.has_value()) {
+      return Token(LexicalTokenType::kQuotedString, content.value(),
+                   start_lineno, start_colno);
+    }
+    XLS_ASSIGN_OR_RETURN(content,
+                         MatchQuotedString("\"", /*allow_multiline=*/false));
+    if (content.has_value()) {
+      return Token(LexicalTokenType::kQuotedString, content.value(),
+                   start_lineno, start_colno);
+    }
+
+    // Handle single-character tokens.
+    LexicalTokenType token_type;
+
+    switch (current()) {
+      case '-':
+        token_type = LexicalTokenType::kMinus;
+        break;
+      case '+':
+        token_type = LexicalTokenType::kAdd;
+        break;
+      case '.':
+        token_type = LexicalTokenType::kDot;
+        break;
+      case ':':
+        token_type = LexicalTokenType::kColon;
+        break;
+      case ',':
+        token_type = LexicalTokenType::kComma;
+        break;
+      case '=':
+        token_type = LexicalTokenType::kEquals;
+        break;
+      case '[':
+        token_type = LexicalTokenType::kBracketOpen;
+        break;
+      case ']':
+        token_type = LexicalTokenType::kBracketClose;
+        break;
+      case '{':
+        token_type = LexicalTokenType::kCurlOpen;
+        break;
+      case '}':
+        token_type = LexicalTokenType::kCurlClose;
+        break;
+      case '(':
+        token_type = LexicalTokenType::kParenOpen;
+        break;
+      case ')':
+        token_type = LexicalTokenType::kParenClose;
+        break;
+      case '>':
+        token_type = LexicalTokenType::kGt;
+        break;
+      case '<':
+        token_type = LexicalTokenType::kLt;
+        break;
+      case '#':
+        token_type = LexicalTokenType::kHash;
+        break;
+      default:
+        std::string char_str = absl::ascii_iscntrl(current())
+                                   ? absl::StrFormat("\\x%02x", current())
+                                   : std::string(1, current());
+        LOG(ERROR) << "IR text with error: " << str_;
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Invalid character in IR text \"%s\" @ %s", char_str,
+            TokenPos{lineno(), colno()}.ToHumanString()));
+    }
+    Token token(token_type, lineno(), colno());
+    Advance();
+    return token;
+  }
+  return std::nullopt;
+}
 
 absl::StatusOr<std::vector<Token>> TokenizeString(std::string_view str) {
-  return Tokenizer::TokenizeString(str);
+  Tokenizer tokenizer(str);
+  std::vector<Token> tokens;
+  while (true) {
+    XLS_ASSIGN_OR_RETURN(std::optional<Token> token, tokenizer.Next());
+    if (!token.has_value()) {
+      return tokens;
+    }
+    tokens.push_back(*std::move(token));
+  }
 }
 
+Scanner::Scanner(std::string_view text)
+    : tokenizer_(std::make_unique<Tokenizer>(text)) {}
+
+Scanner::Scanner(Scanner&& other) = default;
+Scanner& Scanner::operator=(Scanner&& other) = default;
+Scanner::~Scanner() = default;
+
 absl::StatusOr<Scanner> Scanner::Create(std::string_view text) {
-  XLS_ASSIGN_OR_RETURN(auto tokens, TokenizeString(text));
-  return Scanner(std::move(tokens));
+  return Scanner(text);
+}
+
+bool Scanner::FillSlow(int64_t count) const {
+  while (lookahead_.size() < count) {
+    if (tokenizer_ == nullptr) {
+      return false;
+    }
+    absl::StatusOr<std::optional<Token>> token = tokenizer_->Next();
+    if (!token.ok() || !token->has_value()) {
+      status_ = token.status();
+      tokenizer_.reset();
+      return false;
+    }
+    lookahead_.push_back(**std::move(token));
+  }
+  return true;
+}
+
+absl::Status Scanner::NoTokenError(std::string_view message) const {
+  if (!status_.ok()) {
+    return status_;
+  }
+  return absl::InvalidArgumentError(message);
 }
 
 absl::StatusOr<Token> Scanner::PeekToken() const {
-  if (AtEof()) {
-    return absl::InvalidArgumentError("Expected token, but found EOF.");
+  if (!Fill(1)) {
+    return NoTokenError("Expected token, but found EOF.");
   }
-  return tokens_[token_idx_];
+  return lookahead_.front();
 }
 
 absl::StatusOr<Token> Scanner::PopTokenOrError(std::string_view context) {
-  if (AtEof()) {
+  if (!Fill(1)) {
     std::string context_str =
         context.empty() ? std::string("") : absl::StrCat(" in ", context);
-    return absl::InvalidArgumentError("Expected token" + context_str +
-                                      ", but found EOF.");
+    return NoTokenError("Expected token" + context_str + ", but found EOF.");
   }
   return PopToken();
 }
@@ -431,10 +451,10 @@ bool Scanner::TryDropToken(LexicalTokenType target) {
 
 absl::Status Scanner::DropTokenOrError(LexicalTokenType target,
                                        std::string_view context) {
-  if (AtEof()) {
+  if (!Fill(1)) {
     std::string context_str =
         context.empty() ? std::string("") : absl::StrCat(" in ", context);
-    return absl::InvalidArgumentError(
+    return NoTokenError(
         absl::StrFormat("Expected token of type %s%s; found EOF.",
                         LexicalTokenTypeToString(target), context_str));
   }
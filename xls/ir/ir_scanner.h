@@ -16,9 +16,12 @@
 #define XLS_IR_IR_SCANNER_H_
 
 #include <cstdint>
+#include <deque>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/base/no_destructor.h"
@@ -131,41 +134,56 @@ inline std::ostream& operator<<(std::ostream& os, const Token& token) {
 }
 
 // Tokenizes the given string and returns the tokens. It maintains precise
-// source location information.  Right now this is a eager implementation - it
-// tokenizes the whole input. This can be easily changed later to a more demand
-// driven tokenization.
+// source location information.
 absl::StatusOr<std::vector<Token>> TokenizeString(std::string_view str);
 
+class Tokenizer;
+
+// A stream of tokens over IR text. Tokens are produced on demand and only the
+// lookahead requested by the caller is buffered, so memory use does not grow
+// with the size of the text. The text is not copied and must outlive the
+// scanner.
+//
+// A tokenization error is returned by the first PeekToken or *OrError call
+// which reaches the offending text. The boolean peek queries (PeekTokenIs,
+// TryDropToken, etc.) return false at that point, while AtEof returns false so
+// that callers go on to a call which reports the error.
 class Scanner {
  public:
   static absl::StatusOr<Scanner> Create(std::string_view text);
 
+  Scanner(Scanner&& other);
+  Scanner& operator=(Scanner&& other);
+  ~Scanner();
+
   // Peeks at the next token in the token stream, or returns an error if we're
   // at EOF and no more tokens are available.
   absl::StatusOr<Token> PeekToken() const;
 
   // Return the current token.
   const Token& PeekTokenOrDie() const {
-    CHECK(!AtEof());
-    return tokens_[token_idx_];
+    CHECK(Fill(1)) << "Expected token: " << status_;
+    return lookahead_.front();
   }
 
   // Returns true if the next token is the given type.
   bool PeekTokenIs(LexicalTokenType target) const {
-    return !AtEof() && PeekTokenOrDie().type() == target;
+    return Fill(1) && lookahead_.front().type() == target;
   }
 
   // Returns true if the nth next token is the given type. If `n` is zero this
   // peeks at the immediate next token.
   bool PeekNthTokenIs(int64_t n, LexicalTokenType target) const {
-    return (token_idx_ + n < tokens_.size()) &&
-           tokens_[token_idx_ + n].type() == target;
+    return Fill(n + 1) && lookahead_[n].type() == target;
   }
 
   // Pop the current token, advance token pointer to next token.
   Token PopToken() {
-    VLOG(6) << "Popping token: " << tokens_[token_idx_];
-    return tokens_.at(token_idx_++);
+    CHECK(Fill(1)) << "Expected token: " << status_;
+    Token token = std::move(lookahead_.front());
+    lookahead_.pop_front();
+    VLOG(6) << "Popping token: " << token;
+    return token;
   }
 
   // Same as PopToken() but returns a status error if we are at EOF (in which
@@ -217,13 +235,26 @@ class Scanner {
   absl::Status DropKeywordOrError(std::string_view keyword);
 
   // Check if more tokens are available.
-  bool AtEof() const { return token_idx_ >= tokens_.size(); }
+  bool AtEof() const { return !Fill(1) && status_.ok(); }
 
  private:
-  explicit Scanner(std::vector<Token> tokens) : tokens_(tokens) {}
+  explicit Scanner(std::string_view text);
+
+  // Tokenizes ahead until at least `count` tokens are buffered. Returns false
+  // if the text ends first or a tokenization error occurs, in which case the
+  // error is held in `status_`.
+  bool Fill(int64_t count) const {
+    return lookahead_.size() >= count || FillSlow(count);
+  }
+  bool FillSlow(int64_t count) const;
+
+  // Returns the error to report when a token is required but not available.
+  absl::Status NoTokenError(std::string_view message) const;
 
-  int64_t token_idx_ = 0;
-  std::vector<Token> tokens_;
+  // Tokenization happens lazily from const peek methods.
+  mutable std::unique_ptr<Tokenizer> tokenizer_;
+  mutable std::deque<Token> lookahead_;
+  mutable absl::Status status_;
 };
 
 }  // namespace xls
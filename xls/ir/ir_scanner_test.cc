@@ -178,5 +178,20 @@ TEST(IrScannerTest, UnterminatedTripleQuotedStrings) {
                HasSubstr("Unterminated quoted string starting at 1:1")));
 }
 
+TEST(IrScannerTest, ScannerTokenizesLazily) {
+  XLS_ASSERT_OK_AND_ASSIGN(Scanner scanner, Scanner::Create("fn f ( $"));
+  EXPECT_TRUE(scanner.PeekNthTokenIs(2, LexicalTokenType::kParenOpen));
+  XLS_ASSERT_OK_AND_ASSIGN(Token fn, scanner.PopTokenOrError());
+  EXPECT_EQ(fn.value(), "fn");
+  XLS_ASSERT_OK(scanner.DropTokenOrError());
+  XLS_ASSERT_OK(scanner.DropTokenOrError());
+  // The invalid character is only reported once a token past it is requested.
+  EXPECT_FALSE(scanner.AtEof());
+  EXPECT_FALSE(scanner.PeekTokenIs(LexicalTokenType::kIdent));
+  EXPECT_THAT(scanner.PopTokenOrError().status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Invalid character in IR text \"$\"")));
+}
+
 }  // namespace
 }  // namespace xls
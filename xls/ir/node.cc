@@ -18,10 +18,12 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <new>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/log/check.h"
@@ -34,8 +36,10 @@
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/common/casts.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/format_strings.h"
 #include "xls/ir/function.h"
@@ -66,8 +70,17 @@ void Node::AddOperand(Node* operand) {
           << operands_.size() << " operand of " << GetName();
   operands_.push_back(operand);
   operand->AddUser(this);
+  function_base()->MarkGraphChanged();
   VLOG(3) << " " << operand->GetName()
           << " user now: " << operand->GetUsersString();
+  // Operands added during construction are covered by the NodeAdded
+  // notification sent when the node is added to the function.
+  if (!function_base()->change_listeners().empty() &&
+      function_base()->HasNode(this)) {
+    for (ChangeListener* listener : function_base()->change_listeners()) {
+      listener->OperandAdded(this);
+    }
+  }
 }
 
 void Node::AddOperands(absl::Span<Node* const> operands) {
@@ -91,10 +104,40 @@ absl::Status Node::AddNodeToFunctionAndReplace(
   return ReplaceUsesWith(replacement_ptr);
 }
 
-void Node::AddUser(Node* user) { users_.insert(user); }
+void Node::operator delete(Node* node, std::destroying_delete_t) {
+  // Read everything needed to release the storage before the node is
+  // destroyed. The most-derived object might not start at `node`.
+  void* storage = dynamic_cast<void*>(node);
+  int64_t arena_size = node->arena_size_;
+  FunctionBase* function_base = node->function_base_;
+  node->~Node();
+  if (arena_size == 0) {
+    ::operator delete(storage);
+  } else {
+    function_base->node_arena_.Free(storage, arena_size);
+  }
+}
+
+void Node::AddUser(Node* user) {
+  if (users_.empty() || NodeIdLessThan()(users_.back(), user)) {
+    users_.push_back(user);
+    function_base()->MarkGraphChanged();
+    return;
+  }
+  auto it = std::lower_bound(users_.begin(), users_.end(), user,
+                             NodeIdLessThan());
+  if (*it != user) {
+    users_.insert(it, user);
+    function_base()->MarkGraphChanged();
+  }
+}
 
 void Node::RemoveUser(Node* user) {
-  CHECK_EQ(users_.erase(user), 1) << GetName();
+  auto it = std::lower_bound(users_.begin(), users_.end(), user,
+                             NodeIdLessThan());
+  CHECK(it != users_.end() && *it == user) << GetName();
+  users_.erase(it);
+  function_base()->MarkGraphChanged();
 }
 
 absl::Status Node::VisitSingleNode(DfsVisitor* visitor) {
@@ -418,6 +461,46 @@ std::string Node::GetName() const {
   return absl::StrFormat("%s.%d", OpToString(op()), id());
 }
 
+NodeMemoryUsage Node::EstimateMemoryUsage() const {
+  NodeMemoryUsage usage;
+  usage.node_count = 1;
+  usage.node_bytes = arena_size_ != 0 ? arena_size_ : sizeof(Node);
+  int64_t& payload = usage.payload_bytes;
+  payload += EstimateHeapBytes(name_) + EstimateHeapBytes(operands_) +
+             EstimateHeapBytes(users_) + EstimateHeapBytes(loc_.locations);
+  switch (op()) {
+    case Op::kLiteral:
+      payload += EstimateHeapBytes(As<Literal>()->value());
+      break;
+    case Op::kAssert: {
+      const Assert* assert_op = As<Assert>();
+      payload += EstimateHeapBytes(assert_op->message());
+      payload += EstimateHeapBytes(assert_op->label().value_or(""));
+      break;
+    }
+    case Op::kCover:
+      payload += EstimateHeapBytes(As<Cover>()->label());
+      break;
+    case Op::kTrace:
+      for (const FormatStep& step : As<Trace>()->format()) {
+        payload += sizeof(FormatStep);
+        if (const std::string* s = std::get_if<std::string>(&step)) {
+          payload += EstimateHeapBytes(*s);
+        }
+      }
+      break;
+    case Op::kReceive:
+      payload += EstimateHeapBytes(As<Receive>()->channel_name());
+      break;
+    case Op::kSend:
+      payload += EstimateHeapBytes(As<Send>()->channel_name());
+      break;
+    default:
+      break;
+  }
+  return usage;
+}
+
 void Node::SetName(std::string_view name) {
   name_ = function_base()->UniquifyNodeName(name);
 }
@@ -670,7 +753,8 @@ std::string Node::GetUsersString() const {
 }
 
 bool Node::HasUser(const Node* target) const {
-  return users_.contains(const_cast<Node*>(target));
+  return std::binary_search(users_.begin(), users_.end(), target,
+                            NodeIdLessThan());
 }
 
 bool Node::IsDead() const {
@@ -698,15 +782,17 @@ int64_t Node::OperandInstanceCount(const Node* target) const {
 }
 
 void Node::SetId(int64_t id) {
-  // The data structure (btree) containing the users of each node is sorted by
-  // node id. To avoid violating invariants of the data structure, remove this
-  // node from all users lists, change id, then read to users list.
+  // The users of each node are sorted by node id. To avoid violating this
+  // invariant, remove this node from all users lists, change id, then re-add
+  // it to the users lists.
   for (Node* operand : operands()) {
-    operand->users_.erase(this);
+    if (operand->HasUser(this)) {
+      operand->RemoveUser(this);
+    }
   }
   id_ = id;
   for (Node* operand : operands()) {
-    operand->users_.insert(this);
+    operand->AddUser(this);
   }
   package()->set_next_node_id(std::max(id + 1, package()->next_node_id()));
 }
@@ -724,8 +810,9 @@ bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
   if (this == new_operand) {
     return true;
   }
-  ++package()->transform_metrics().operands_replaced;
+  package()->RecordOperandReplaced();
   bool did_replace = false;
+  function_base()->MarkGraphChanged();
   for (int64_t i = 0; i < operand_count(); ++i) {
     if (operands_[i] == old_operand) {
       if (!did_replace && new_operand != nullptr) {
@@ -737,9 +824,27 @@ bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
     }
   }
   old_operand->RemoveUser(this);
+  if (did_replace) {
+    NotifyOperandChanged(old_operand);
+  }
   return did_replace;
 }
 
+void Node::SwapOperands(int64_t a, int64_t b) {
+  // Operand/user chains already set up properly.
+  std::swap(operands_[a], operands_[b]);
+  if (operands_[a] != operands_[b]) {
+    function_base()->MarkGraphChanged();
+    NotifyOperandChanged(operands_[b]);
+  }
+}
+
+void Node::NotifyOperandChanged(Node* old_operand) {
+  for (ChangeListener* listener : function_base()->change_listeners()) {
+    listener->OperandChanged(this, old_operand);
+  }
+}
+
 absl::Status Node::ReplaceOperandNumber(int64_t operand_no, Node* new_operand,
                                         bool type_must_match) {
   Node* old_operand = operands_[operand_no];
@@ -748,12 +853,14 @@ absl::Status Node::ReplaceOperandNumber(int64_t operand_no, Node* new_operand,
         << "old operand type: " << old_operand->GetType()->ToString()
         << " new operand type: " << new_operand->GetType()->ToString();
   }
-  ++package()->transform_metrics().operands_replaced;
+  package()->RecordOperandReplaced();
 
   // AddUser is idempotent so even if the new operand is already used by this
   // node in another operand slot, it is safe to call.
   new_operand->AddUser(this);
   operands_[operand_no] = new_operand;
+  function_base()->MarkGraphChanged();
+  NotifyOperandChanged(old_operand);
 
   for (Node* operand : operands()) {
     if (operand == old_operand) {
@@ -772,7 +879,7 @@ absl::Status Node::ReplaceUsesWith(Node* replacement,
   XLS_RET_CHECK(GetType() == replacement->GetType())
       << "type was: " << GetType()->ToString()
       << " replacement: " << replacement->GetType()->ToString();
-  ++package()->transform_metrics().nodes_replaced;
+  package()->RecordNodeReplaced();
   bool all_replaced = true;
   std::vector<Node*> orig_users(users().begin(), users().end());
   for (Node* user : orig_users) {
@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <new>
 #include <optional>
 #include <ostream>
 #include <string>
@@ -24,7 +25,7 @@
 #include <utility>
 #include <vector>
 
-#include "absl/container/btree_set.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -45,6 +46,28 @@ class FunctionBase;
 // Forward decaration to avoid circular dependency.
 class DfsVisitor;
 
+// An estimate of the memory used by a set of IR nodes.
+struct NodeMemoryUsage {
+  int64_t node_count = 0;
+
+  // Bytes of the node objects themselves.
+  int64_t node_bytes = 0;
+
+  // Bytes held by the nodes outside of the node objects: operand and user
+  // lists which do not fit in their inline storage, names, source locations
+  // and op-specific data such as literal values and assert messages.
+  int64_t payload_bytes = 0;
+
+  int64_t total_bytes() const { return node_bytes + payload_bytes; }
+
+  NodeMemoryUsage& operator+=(const NodeMemoryUsage& other) {
+    node_count += other.node_count;
+    node_bytes += other.node_bytes;
+    payload_bytes += other.payload_bytes;
+    return *this;
+  }
+};
+
 // Abstract type for a node (representing an expression) in the high level IR.
 //
 // Node is subtyped and can be checked-converted via the As* methods below.
@@ -52,6 +75,11 @@ class Node {
  public:
   virtual ~Node() = default;
 
+  // Nodes may be allocated from the NodeArena of their function base (see
+  // FunctionBase::NewNode) or from the heap. Deleting a node destroys it and
+  // returns its storage to wherever it came from.
+  void operator delete(Node* node, std::destroying_delete_t);
+
   // Accepts the visitor, instructing it to visit this node.
   //
   // The visitor is instructed to visit this node with:
@@ -141,10 +169,7 @@ class Node {
   absl::StatusOr<bool> ReplaceImplicitUsesWith(Node* replacement);
 
   // Swaps the operands at indices 'a' and 'b' in the operands sequence.
-  void SwapOperands(int64_t a, int64_t b) {
-    // Operand/user chains already set up properly.
-    std::swap(operands_[a], operands_[b]);
-  }
+  void SwapOperands(int64_t a, int64_t b);
 
   // Returns true if analysis indicates that this node always produces the
   // same value as 'other' when run with the same operands. The analysis is
@@ -180,6 +205,11 @@ class Node {
   // is generated from the opcode and unique id (e.g. "add.2");
   std::string GetName() const;
 
+  // Returns an estimate of the memory used by this node. Nodes not allocated
+  // from the node arena of their function base are counted as sizeof(Node)
+  // because the size of their subclass is not recorded.
+  NodeMemoryUsage EstimateMemoryUsage() const;
+
   // Sets the name of this node. After this method is called. HasAssignedName
   // will return true.
   void SetName(std::string_view name);
@@ -224,8 +254,9 @@ class Node {
     }
   };
 
-  // Returns the unique set of users of this node sorted by id.
-  const absl::btree_set<Node*, NodeIdLessThan>& users() const { return users_; }
+  // Returns the unique set of users of this node sorted by id. The span is
+  // invalidated when users are added to or removed from this node.
+  absl::Span<Node* const> users() const { return users_; }
 
   // Helper for querying whether "target" is a user of this node.
   bool HasUser(const Node* target) const;
@@ -252,9 +283,16 @@ class Node {
 
   int64_t id() const { return id_; }
 
+  // Returns the index of the node within its function base. Indices are dense:
+  // they are less than function_base()->node_index_bound() and the index of a
+  // removed node is reused by a later node. Unlike id(), indices are suitable
+  // for indexing vectors of per-node data (see DenseNodeMap).
+  int64_t node_index() const { return node_index_; }
+
   // Sets the id of the node. Mutates the user sets of the operands of the node
   // because user sets are sorted by id.  Note: this should only be used by the
-  // parser and ideally not even there.
+  // parser and ideally not even there. It is also used to renumber nodes after
+  // passes run concurrently on different FunctionBases.
   // TODO(meheff): 2021/05/05 Remove this method.
   void SetId(int64_t id);
 
@@ -309,17 +347,27 @@ class Node {
   void AddUser(Node* user);
   void RemoveUser(Node* user);
 
+  // Notifies the change listeners of the function that an operand of this
+  // node referring to `old_operand` has changed.
+  void NotifyOperandChanged(Node* old_operand);
+
   FunctionBase* function_base_;
   int64_t id_;
+  int64_t node_index_ = -1;
+  // The size of the storage of this node if allocated from the node arena of
+  // its function base, or zero if allocated from the heap.
+  int64_t arena_size_ = 0;
   Op op_;
   Type* type_;
   SourceInfo loc_;
   std::string name_;
 
-  std::vector<Node*> operands_;
+  absl::InlinedVector<Node*, 3> operands_;
 
-  // Set of users sorted by node_id for stability.
-  absl::btree_set<Node*, NodeIdLessThan> users_;
+  // Set of users sorted by node_id for stability. Stored as a sorted vector as
+  // most nodes have only a few users; the common case of adding a user newer
+  // than all existing users is an append.
+  absl::InlinedVector<Node*, 2> users_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Node& node) {
@@ -0,0 +1,61 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/node_arena.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/log/check.h"
+
+namespace xls {
+
+void* NodeArena::Allocate(int64_t size) {
+  CHECK_GT(size, 0);
+  size = RoundUp(size);
+  bytes_allocated_ += size;
+  auto it = free_lists_.find(size);
+  if (it != free_lists_.end() && it->second != nullptr) {
+    void* ptr = it->second;
+    it->second = *static_cast<void**>(ptr);
+    return ptr;
+  }
+  if (size > remaining_) {
+    // Oversized allocations get a block of their own so the current block is
+    // not abandoned.
+    if (size > kBlockSize / 4) {
+      blocks_.push_back(std::make_unique<char[]>(size));
+      bytes_reserved_ += size;
+      return blocks_.back().get();
+    }
+    blocks_.push_back(std::make_unique<char[]>(kBlockSize));
+    bytes_reserved_ += kBlockSize;
+    next_ = blocks_.back().get();
+    remaining_ = kBlockSize;
+  }
+  void* ptr = next_;
+  next_ += size;
+  remaining_ -= size;
+  return ptr;
+}
+
+void NodeArena::Free(void* ptr, int64_t size) {
+  size = RoundUp(size);
+  bytes_allocated_ -= size;
+  void*& head = free_lists_[size];
+  *static_cast<void**>(ptr) = head;
+  head = ptr;
+}
+
+}  // namespace xls
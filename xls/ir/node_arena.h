@@ -0,0 +1,81 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_NODE_ARENA_H_
+#define XLS_IR_NODE_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+
+namespace xls {
+
+// A bump allocator for the storage of the nodes of a single FunctionBase.
+// Nodes allocated together are laid out contiguously which improves the
+// locality of walks over the function, and allocation is a pointer bump rather
+// than a call into the system allocator.
+//
+// Storage released by removed nodes is kept on a free list per allocation size
+// and reused by later nodes of the same size. All storage is returned to the
+// system when the arena is destroyed.
+//
+// Not thread-safe. The arena is only used by operations which mutate its
+// function base.
+class NodeArena {
+ public:
+  // Alignment of every allocation.
+  static constexpr int64_t kAlignment = alignof(std::max_align_t);
+
+  NodeArena() = default;
+  NodeArena(const NodeArena&) = delete;
+  NodeArena& operator=(const NodeArena&) = delete;
+
+  // Returns storage for an object of `size` bytes.
+  void* Allocate(int64_t size);
+
+  // Returns storage obtained from Allocate with the same `size` to the arena.
+  void Free(void* ptr, int64_t size);
+
+  // Returns the number of bytes obtained from the system.
+  int64_t bytes_reserved() const { return bytes_reserved_; }
+
+  // Returns the number of bytes occupied by live allocations, each rounded up
+  // to a multiple of kAlignment.
+  int64_t bytes_allocated() const { return bytes_allocated_; }
+
+ private:
+  // Size of each block of storage carved up by the bump allocator.
+  static constexpr int64_t kBlockSize = 64 * 1024;
+
+  static int64_t RoundUp(int64_t size) {
+    return (size + kAlignment - 1) & ~(kAlignment - 1);
+  }
+
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char* next_ = nullptr;
+  int64_t remaining_ = 0;
+  int64_t bytes_reserved_ = 0;
+  int64_t bytes_allocated_ = 0;
+
+  // The head of the free list for each (rounded) allocation size. The next
+  // pointer of the list is stored in the first word of each freed allocation.
+  absl::flat_hash_map<int64_t, void*> free_lists_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_NODE_ARENA_H_
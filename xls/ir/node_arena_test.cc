@@ -0,0 +1,80 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/node_arena.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace {
+
+TEST(NodeArenaTest, AllocationsAreAlignedAndDisjoint) {
+  NodeArena arena;
+  char* a = static_cast<char*>(arena.Allocate(24));
+  char* b = static_cast<char*>(arena.Allocate(100));
+  char* c = static_cast<char*>(arena.Allocate(1));
+  for (char* ptr : {a, b, c}) {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % NodeArena::kAlignment, 0);
+  }
+  std::memset(a, 1, 24);
+  std::memset(b, 2, 100);
+  std::memset(c, 3, 1);
+  EXPECT_EQ(a[23], 1);
+  EXPECT_EQ(b[0], 2);
+  EXPECT_EQ(b[99], 2);
+  EXPECT_EQ(c[0], 3);
+}
+
+TEST(NodeArenaTest, FreedStorageIsReusedBySameSize) {
+  NodeArena arena;
+  void* a = arena.Allocate(64);
+  void* b = arena.Allocate(128);
+  arena.Free(a, 64);
+  EXPECT_NE(arena.Allocate(128), a);
+  EXPECT_EQ(arena.Allocate(64), a);
+  arena.Free(b, 128);
+  EXPECT_EQ(arena.Allocate(128), b);
+}
+
+TEST(NodeArenaTest, OversizedAllocations) {
+  NodeArena arena;
+  void* small = arena.Allocate(32);
+  int64_t reserved = arena.bytes_reserved();
+  void* large = arena.Allocate(1 << 20);
+  EXPECT_EQ(arena.bytes_reserved(), reserved + (1 << 20));
+  std::memset(large, 0, 1 << 20);
+  // Small allocations continue to come from the existing block.
+  void* next = arena.Allocate(32);
+  EXPECT_EQ(static_cast<char*>(next), static_cast<char*>(small) + 32);
+  EXPECT_EQ(arena.bytes_reserved(), reserved + (1 << 20));
+}
+
+TEST(NodeArenaTest, BytesAllocated) {
+  NodeArena arena;
+  EXPECT_EQ(arena.bytes_allocated(), 0);
+  void* a = arena.Allocate(NodeArena::kAlignment);
+  void* b = arena.Allocate(3 * NodeArena::kAlignment - 1);
+  EXPECT_EQ(arena.bytes_allocated(), 4 * NodeArena::kAlignment);
+  EXPECT_GE(arena.bytes_reserved(), arena.bytes_allocated());
+  arena.Free(b, 3 * NodeArena::kAlignment - 1);
+  EXPECT_EQ(arena.bytes_allocated(), NodeArena::kAlignment);
+  arena.Free(a, NodeArena::kAlignment);
+  EXPECT_EQ(arena.bytes_allocated(), 0);
+}
+
+}  // namespace
+}  // namespace xls
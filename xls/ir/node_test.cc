@@ -41,6 +41,7 @@ namespace {
 
 using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::UnorderedElementsAre;
 
@@ -579,6 +580,38 @@ fn ReplaceUses(x: bits[8], y: bits[8]) -> bits[8] {
   EXPECT_TRUE(FindNode("y", f)->IsDead());
 }
 
+TEST_F(NodeTest, UsersSortedById) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  and.9: bits[8] = and(x, x)
+  neg.2: bits[8] = neg(x)
+  or.5: bits[8] = or(x, y)
+  ret add.7: bits[8] = add(and.9, or.5)
+}
+)",
+                                                       p.get()));
+  Node* x = FindNode("x", f);
+  Node* neg = FindNode("neg.2", f);
+  EXPECT_THAT(x->users(),
+              ElementsAre(neg, FindNode("or.5", f), FindNode("and.9", f)));
+
+  neg->SetId(20);
+  EXPECT_THAT(x->users(),
+              ElementsAre(FindNode("or.5", f), FindNode("and.9", f), neg));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * sub, f->MakeNode<BinOp>(SourceInfo(), x, x, Op::kSub));
+  EXPECT_THAT(x->users(), ElementsAre(FindNode("or.5", f),
+                                      FindNode("and.9", f), neg, sub));
+
+  FindNode("and.9", f)->ReplaceOperand(x, FindNode("y", f));
+  EXPECT_FALSE(x->HasUser(FindNode("and.9", f)));
+  EXPECT_THAT(x->users(), ElementsAre(FindNode("or.5", f), neg, sub));
+  EXPECT_THAT(FindNode("y", f)->users(),
+              ElementsAre(FindNode("or.5", f), FindNode("and.9", f)));
+}
+
 TEST_F(NodeTest, IncorrectOpClass) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
@@ -0,0 +1,92 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_NODE_UNION_FIND_H_
+#define XLS_IR_NODE_UNION_FIND_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "xls/data_structures/union_find.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// A union-find over the nodes of a single FunctionBase. This is a replacement
+// for UnionFind<Node*> which maps each node to a DenseUnionFind element through
+// a vector indexed by Node::node_index() rather than by hashing the node
+// pointer.
+//
+// Nodes must not be removed from the function while they are in the
+// union-find, as their node indices may be reused.
+class NodeUnionFind {
+ public:
+  NodeUnionFind() = default;
+
+  // Insert the node. Has no effect if the node has been inserted before.
+  // Otherwise, the node is inserted in its own equivalence class.
+  void Insert(Node* node) {
+    int64_t index = node->node_index();
+    CHECK_GE(index, 0) << "Node has not been added to a function base: "
+                       << node->GetName();
+    if (index >= elements_.size()) {
+      elements_.resize(index + 1, -1);
+    }
+    if (elements_[index] >= 0) {
+      return;
+    }
+    elements_[index] = union_find_.Add();
+    nodes_.push_back(node);
+  }
+
+  // Union together the equivalence classes of two nodes. Returns true if they
+  // were in different classes.
+  bool Union(Node* x, Node* y) {
+    return union_find_.Union(GetElement(x), GetElement(y));
+  }
+
+  // Returns the representative node in the given node's equivalence class.
+  Node* Find(Node* node) { return nodes_[union_find_.Find(GetElement(node))]; }
+
+  // Returns every node inserted, in insertion order.
+  const std::vector<Node*>& GetElements() const { return nodes_; }
+
+  // Returns the number of nodes in the data structure.
+  int64_t size() const { return nodes_.size(); }
+
+  // Returns the number of equivalence classes.
+  int64_t class_count() const { return union_find_.class_count(); }
+
+ private:
+  int64_t GetElement(Node* node) const {
+    int64_t index = node->node_index();
+    CHECK(index >= 0 && index < elements_.size() && elements_[index] >= 0 &&
+          nodes_[elements_[index]] == node)
+        << "Node has not been inserted: " << node->GetName();
+    return elements_[index];
+  }
+
+  DenseUnionFind union_find_;
+
+  // The union-find element of each node index, or -1 if there is none.
+  std::vector<int64_t> elements_;
+
+  // The node of each union-find element.
+  std::vector<Node*> nodes_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_NODE_UNION_FIND_H_
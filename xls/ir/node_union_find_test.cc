@@ -0,0 +1,66 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/node_union_find.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using ::testing::AnyOf;
+using ::testing::ElementsAre;
+
+class NodeUnionFindTest : public IrTestBase {};
+
+TEST_F(NodeUnionFindTest, UnionAndFind) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue z = fb.Param("z", p->GetBitsType(8));
+  BValue add = fb.Add(x, y);
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(add).status());
+
+  NodeUnionFind uf;
+  uf.Insert(add.node());
+  uf.Insert(x.node());
+  uf.Insert(y.node());
+  uf.Insert(z.node());
+  // Inserting a node a second time should have no effect.
+  uf.Insert(x.node());
+  EXPECT_THAT(uf.GetElements(),
+              ElementsAre(add.node(), x.node(), y.node(), z.node()));
+  EXPECT_EQ(uf.class_count(), 4);
+  EXPECT_EQ(uf.Find(x.node()), x.node());
+
+  EXPECT_TRUE(uf.Union(add.node(), x.node()));
+  EXPECT_TRUE(uf.Union(add.node(), y.node()));
+  EXPECT_FALSE(uf.Union(x.node(), y.node()));
+  EXPECT_EQ(uf.Find(x.node()), uf.Find(y.node()));
+  EXPECT_EQ(uf.Find(x.node()), uf.Find(add.node()));
+  EXPECT_THAT(uf.Find(x.node()), AnyOf(x.node(), y.node(), add.node()));
+  EXPECT_EQ(uf.Find(z.node()), z.node());
+  EXPECT_EQ(uf.class_count(), 2);
+}
+
+}  // namespace
+}  // namespace xls
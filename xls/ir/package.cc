@@ -15,6 +15,7 @@
 #include "xls/ir/package.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <list>
 #include <memory>
@@ -34,7 +35,9 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/block.h"
@@ -48,6 +51,7 @@
 #include "xls/ir/name_uniquer.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
@@ -63,6 +67,15 @@ Package::Package(std::string_view name) : name_(name) {
 
 Package::~Package() = default;
 
+TransformMetrics Package::transform_metrics() const {
+  return TransformMetrics{
+      .nodes_added = nodes_added_.load(std::memory_order_relaxed),
+      .nodes_removed = nodes_removed_.load(std::memory_order_relaxed),
+      .nodes_replaced = nodes_replaced_.load(std::memory_order_relaxed),
+      .operands_replaced = operands_replaced_.load(std::memory_order_relaxed),
+  };
+}
+
 std::optional<FunctionBase*> Package::GetTop() const { return top_; }
 
 absl::Status Package::SetTop(std::optional<FunctionBase*> top) {
@@ -516,22 +529,34 @@ absl::StatusOr<Type*> Package::MapTypeFromOtherPackage(
   return absl::InternalError("Unsupported type.");
 }
 
+bool Package::IsOwnedType(const Type* type) const {
+  absl::MutexLock lock(&types_mutex_);
+  return owned_types_.find(type) != owned_types_.end();
+}
+
+bool Package::IsOwnedFunctionType(const FunctionType* function_type) const {
+  absl::MutexLock lock(&types_mutex_);
+  return owned_function_types_.find(function_type) !=
+         owned_function_types_.end();
+}
+
 BitsType* Package::GetBitsType(int64_t bit_count) {
-  if (bit_count_to_type_.find(bit_count) != bit_count_to_type_.end()) {
-    return &bit_count_to_type_.at(bit_count);
+  absl::MutexLock lock(&types_mutex_);
+  auto [it, inserted] = bit_count_to_type_.try_emplace(bit_count, bit_count);
+  BitsType* type = &it->second;
+  if (inserted) {
+    owned_types_.insert(type);
   }
-  auto it = bit_count_to_type_.emplace(bit_count, BitsType(bit_count));
-  BitsType* new_type = &(it.first->second);
-  owned_types_.insert(new_type);
-  return new_type;
+  return type;
 }
 
 ArrayType* Package::GetArrayType(int64_t size, Type* element_type) {
   ArrayKey key{size, element_type};
-  if (array_types_.find(key) != array_types_.end()) {
-    return &array_types_.at(key);
+  absl::MutexLock lock(&types_mutex_);
+  if (auto it = array_types_.find(key); it != array_types_.end()) {
+    return &it->second;
   }
-  CHECK(IsOwnedType(element_type))
+  CHECK(owned_types_.contains(element_type))
       << "Type is not owned by package: " << *element_type;
   auto it = array_types_.emplace(key, ArrayType(size, element_type));
   ArrayType* new_type = &(it.first->second);
@@ -541,11 +566,12 @@ ArrayType* Package::GetArrayType(int64_t size, Type* element_type) {
 
 TupleType* Package::GetTupleType(absl::Span<Type* const> element_types) {
   TypeVec key(element_types.begin(), element_types.end());
-  if (tuple_types_.find(key) != tuple_types_.end()) {
-    return &tuple_types_.at(key);
+  absl::MutexLock lock(&types_mutex_);
+  if (auto it = tuple_types_.find(key); it != tuple_types_.end()) {
+    return &it->second;
   }
   for (const Type* element_type : element_types) {
-    CHECK(IsOwnedType(element_type))
+    CHECK(owned_types_.contains(element_type))
         << "Type is not owned by package: " << *element_type;
   }
   auto it = tuple_types_.emplace(key, TupleType(element_types));
@@ -559,11 +585,12 @@ TokenType* Package::GetTokenType() { return &token_type_; }
 FunctionType* Package::GetFunctionType(absl::Span<Type* const> args_types,
                                        Type* return_type) {
   std::string key = FunctionType(args_types, return_type).ToString();
+  absl::MutexLock lock(&types_mutex_);
   if (function_types_.find(key) != function_types_.end()) {
     return &function_types_.at(key);
   }
   for (Type* t : args_types) {
-    CHECK(IsOwnedType(t)) << "Parameter type is not owned by package: "
+    CHECK(owned_types_.contains(t)) << "Parameter type is not owned by package: "
                           << t->ToString();
   }
   auto it = function_types_.emplace(key, FunctionType(args_types, return_type));
@@ -871,11 +898,20 @@ absl::StatusOr<SingleValueChannel*> Package::CreateSingleValueChannelInProc(
 }
 
 absl::Status Package::RemoveChannel(Channel* channel) {
-  // First check that the channel is owned by this package.
-  auto it = std::find(channel_vec_.begin(), channel_vec_.end(), channel);
-  XLS_RET_CHECK(it != channel_vec_.end()) << "Channel not owned by package";
+  return RemoveChannels({channel});
+}
 
-  // Check that no send/receive nodes are associated with the channel.
+absl::Status Package::RemoveChannels(absl::Span<Channel* const> channels) {
+  // First check that the channels are owned by this package.
+  absl::flat_hash_map<std::string_view, Channel*> to_remove;
+  for (Channel* channel : channels) {
+    auto it = channels_.find(channel->name());
+    XLS_RET_CHECK(it != channels_.end() && it->second.get() == channel)
+        << "Channel not owned by package";
+    to_remove[channel->name()] = channel;
+  }
+
+  // Check that no send/receive nodes are associated with the channels.
   // TODO(https://github.com/google/xls/issues/411) 2012/04/24 Avoid iterating
   // through all the nodes after channels are mapped to send/receive nodes.
   for (const auto& proc : procs()) {
@@ -883,24 +919,35 @@ absl::Status Package::RemoveChannel(Channel* channel) {
       continue;
     }
     for (Node* node : proc->nodes()) {
-      if ((node->Is<Send>() &&
-           node->As<Send>()->channel_name() == channel->name()) ||
-          (node->Is<Receive>() &&
-           node->As<Receive>()->channel_name() == channel->name())) {
+      std::optional<std::string_view> channel_name;
+      if (node->Is<Send>()) {
+        channel_name = node->As<Send>()->channel_name();
+      } else if (node->Is<Receive>()) {
+        channel_name = node->As<Receive>()->channel_name();
+      }
+      if (!channel_name.has_value()) {
+        continue;
+      }
+      auto it = to_remove.find(*channel_name);
+      if (it != to_remove.end()) {
         return absl::InternalError(absl::StrFormat(
             "Channel %s (id=%d) cannot be removed because it "
             "is used by node %v in %v",
-            channel->name(), channel->id(), *node, *node->function_base()));
+            it->second->name(), it->second->id(), *node,
+            *node->function_base()));
       }
     }
   }
 
   // Remove from channel vector.
-  channel_vec_.erase(it);
+  std::erase_if(channel_vec_, [&](Channel* channel) {
+    return to_remove.contains(channel->name());
+  });
 
   // Remove from channel map.
-  XLS_RET_CHECK(channels_.contains(channel->name()));
-  channels_.erase(channel->name());
+  for (const auto& [name, channel] : to_remove) {
+    channels_.erase(name);
+  }
 
   return absl::OkStatus();
 }
@@ -1065,6 +1112,71 @@ TransformMetrics TransformMetrics::operator-(
   };
 }
 
+PackageMemoryUsage Package::EstimateMemoryUsage() const {
+  PackageMemoryUsage usage;
+  for (FunctionBase* fb : GetFunctionBases()) {
+    for (Node* node : fb->nodes()) {
+      usage.nodes_by_op[node->op()] += node->EstimateMemoryUsage();
+    }
+    usage.unused_arena_bytes += fb->node_arena().bytes_reserved() -
+                                fb->node_arena().bytes_allocated();
+  }
+
+  absl::MutexLock lock(&types_mutex_);
+  int64_t& bytes = usage.type_bytes;
+  bytes += EstimateHeapBytes(owned_types_) +
+           EstimateHeapBytes(owned_function_types_) +
+           EstimateHeapBytes(bit_count_to_type_) +
+           EstimateHeapBytes(array_types_) + EstimateHeapBytes(tuple_types_) +
+           EstimateHeapBytes(function_types_);
+  for (const auto& [elements, tuple_type] : tuple_types_) {
+    bytes += EstimateHeapBytes(elements) +
+             tuple_type.element_types().size() * sizeof(Type*);
+  }
+  for (const auto& [type_string, function_type] : function_types_) {
+    bytes += EstimateHeapBytes(type_string) +
+             function_type.parameters().size() * sizeof(Type*);
+  }
+  return usage;
+}
+
+NodeMemoryUsage PackageMemoryUsage::TotalNodeMemoryUsage() const {
+  NodeMemoryUsage total;
+  for (const auto& [op, op_usage] : nodes_by_op) {
+    total += op_usage;
+  }
+  return total;
+}
+
+int64_t PackageMemoryUsage::TotalBytes() const {
+  return TotalNodeMemoryUsage().total_bytes() + unused_arena_bytes +
+         type_bytes;
+}
+
+std::string PackageMemoryUsage::ToString() const {
+  NodeMemoryUsage nodes = TotalNodeMemoryUsage();
+  std::string result = absl::StrFormat(
+      "total: %d bytes\n"
+      "  nodes: %d bytes (%d nodes, %d node bytes, %d payload bytes)\n"
+      "  unused arena: %d bytes\n"
+      "  types: %d bytes\n",
+      TotalBytes(), nodes.total_bytes(), nodes.node_count, nodes.node_bytes,
+      nodes.payload_bytes, unused_arena_bytes, type_bytes);
+  std::vector<std::pair<Op, NodeMemoryUsage>> ops(nodes_by_op.begin(),
+                                                  nodes_by_op.end());
+  std::stable_sort(ops.begin(), ops.end(), [](const auto& a, const auto& b) {
+    return a.second.total_bytes() > b.second.total_bytes();
+  });
+  for (const auto& [op, op_usage] : ops) {
+    absl::StrAppendFormat(
+        &result,
+        "    %s: %d bytes (%d nodes, %d node bytes, %d payload bytes)\n",
+        OpToString(op), op_usage.total_bytes(), op_usage.node_count,
+        op_usage.node_bytes, op_usage.payload_bytes);
+  }
+  return result;
+}
+
 std::string TransformMetrics::ToString() const {
   return absl::StrFormat(
       "{ nodes added: %d, nodes removed: %d, nodes replaced: %d, operands "
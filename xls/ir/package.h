@@ -15,6 +15,7 @@
 #ifndef XLS_IR_PACKAGE_H_
 #define XLS_IR_PACKAGE_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -24,17 +25,21 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/container/node_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel.pb.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/fileno.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
@@ -73,6 +78,29 @@ struct TransformMetrics {
   std::string ToString() const;
 };
 
+// An estimate of the memory used by the IR of a package, see
+// Package::EstimateMemoryUsage. Estimates count the storage owned by each data
+// structure and ignore allocator overhead.
+struct PackageMemoryUsage {
+  // Memory of the nodes of all function bases broken down by op.
+  absl::btree_map<Op, NodeMemoryUsage> nodes_by_op;
+
+  // Bytes reserved by the node arenas of the function bases which are not
+  // occupied by live nodes, e.g., the storage of removed nodes awaiting reuse.
+  int64_t unused_arena_bytes = 0;
+
+  // Bytes of the types owned by the package.
+  int64_t type_bytes = 0;
+
+  // Returns the memory of the nodes of all ops.
+  NodeMemoryUsage TotalNodeMemoryUsage() const;
+
+  int64_t TotalBytes() const;
+
+  // Returns a multi-line breakdown with ops sorted by decreasing memory.
+  std::string ToString() const;
+};
+
 class Package {
  public:
   explicit Package(std::string_view name);
@@ -104,14 +132,12 @@ class Package {
       std::string_view name) const;
 
   // Returns whether the given type is one of the types owned by this package.
-  bool IsOwnedType(const Type* type) const {
-    return owned_types_.find(type) != owned_types_.end();
-  }
-  bool IsOwnedFunctionType(const FunctionType* function_type) const {
-    return owned_function_types_.find(function_type) !=
-           owned_function_types_.end();
-  }
+  bool IsOwnedType(const Type* type) const;
+  bool IsOwnedFunctionType(const FunctionType* function_type) const;
 
+  // Returns the owned type with the given structure, creating it if
+  // necessary. These methods (and IsOwned*Type) are thread-safe so that
+  // different FunctionBases of the package may be transformed concurrently.
   BitsType* GetBitsType(int64_t bit_count);
   ArrayType* GetArrayType(int64_t size, Type* element_type);
   TupleType* GetTupleType(absl::Span<Type* const> element_types);
@@ -195,8 +221,11 @@ class Package {
   std::string SourceLocationToString(const SourceLocation& loc);
 
   // Retrieves the next node ID to assign to a node in the package and
-  // increments the next node counter. For use in node construction.
-  int64_t GetNextNodeId() { return next_node_id_++; }
+  // increments the next node counter. For use in node construction. This is
+  // thread-safe.
+  int64_t GetNextNodeId() {
+    return next_node_id_.fetch_add(1, std::memory_order_relaxed);
+  }
 
   // Adds a file to the file-number table and returns its corresponding number.
   // If it already exists, returns the existing file-number entry.
@@ -262,10 +291,14 @@ class Package {
   std::vector<std::string> GetFunctionNames() const;
 
 
-  int64_t next_node_id() const { return next_node_id_; }
+  int64_t next_node_id() const {
+    return next_node_id_.load(std::memory_order_relaxed);
+  }
 
   // Intended for use by the parser when node ids are suggested by the IR text.
-  void set_next_node_id(int64_t value) { next_node_id_ = value; }
+  void set_next_node_id(int64_t value) {
+    next_node_id_.store(value, std::memory_order_relaxed);
+  }
 
   // Create a channel. Channels are used with send/receive nodes in communicate
   // between procs or between procs and external (to XLS) components. If no
@@ -329,6 +362,13 @@ class Package {
   // nodes an error is returned.
   absl::Status RemoveChannel(Channel* channel);
 
+  // Removes the given channels. Equivalent to calling RemoveChannel on each
+  // channel but the nodes of the package are only scanned once so removing
+  // many channels is linear rather than quadratic in the size of the package.
+  // If any channel has associated send/receive nodes an error is returned and
+  // no channel is removed.
+  absl::Status RemoveChannels(absl::Span<Channel* const> channels);
+
   // Builder to collect overrides when cloning channels.
   // Each field is optional where std::nullopt indicates that the cloned channel
   // should share the same value as the original. If a field contains a value,
@@ -400,10 +440,26 @@ class Package {
       const CloneChannelOverrides& overrides = CloneChannelOverrides());
 
   // Returns the transform metrics aggregated across all FunctionBases.
-  const TransformMetrics& transform_metrics() const {
-    return transform_metrics_;
+  TransformMetrics transform_metrics() const;
+
+  // Returns an estimate of the memory used by the nodes and types of this
+  // package. Takes time linear in the number of nodes.
+  PackageMemoryUsage EstimateMemoryUsage() const;
+
+  // Methods for recording transformations in the transform metrics. These are
+  // thread-safe.
+  void RecordNodeAdded() {
+    nodes_added_.fetch_add(1, std::memory_order_relaxed);
+  }
+  void RecordNodeRemoved() {
+    nodes_removed_.fetch_add(1, std::memory_order_relaxed);
+  }
+  void RecordNodeReplaced() {
+    nodes_replaced_.fetch_add(1, std::memory_order_relaxed);
+  }
+  void RecordOperandReplaced() {
+    operands_replaced_.fetch_add(1, std::memory_order_relaxed);
   }
-  TransformMetrics& transform_metrics() { return transform_metrics_; }
 
  private:
   std::vector<std::string> GetChannelNames() const;
@@ -423,39 +479,47 @@ class Package {
   std::string name_;
 
   // Ordinal to assign to the next node created in this package.
-  int64_t next_node_id_ = 1;
+  std::atomic<int64_t> next_node_id_ = 1;
 
   std::vector<std::unique_ptr<Function>> functions_;
   std::vector<std::unique_ptr<Proc>> procs_;
   std::vector<std::unique_ptr<Block>> blocks_;
 
+  // Guards the owned type data structures below.
+  mutable absl::Mutex types_mutex_;
+
   // Set of owned types in this package.
-  absl::flat_hash_set<const Type*> owned_types_;
+  absl::flat_hash_set<const Type*> owned_types_ ABSL_GUARDED_BY(types_mutex_);
 
   // Set of owned function types in this package.
-  absl::flat_hash_set<const FunctionType*> owned_function_types_;
+  absl::flat_hash_set<const FunctionType*> owned_function_types_
+      ABSL_GUARDED_BY(types_mutex_);
 
   // Mapping from bit count to the owned "bits" type with that many bits. Use
   // node_hash_map for pointer stability.
-  absl::node_hash_map<int64_t, BitsType> bit_count_to_type_;
+  absl::node_hash_map<int64_t, BitsType> bit_count_to_type_
+      ABSL_GUARDED_BY(types_mutex_);
 
   // Mapping from the size and element type of an array type to the owned
   // ArrayType. Use node_hash_map for pointer stability.
   using ArrayKey = std::pair<int64_t, const Type*>;
-  absl::node_hash_map<ArrayKey, ArrayType> array_types_;
+  absl::node_hash_map<ArrayKey, ArrayType> array_types_
+      ABSL_GUARDED_BY(types_mutex_);
 
   // Mapping from elements to the owned tuple type.
   //
   // Uses node_hash_map for pointer stability.
   using TypeVec = absl::InlinedVector<const Type*, 4>;
-  absl::node_hash_map<TypeVec, TupleType> tuple_types_;
+  absl::node_hash_map<TypeVec, TupleType> tuple_types_
+      ABSL_GUARDED_BY(types_mutex_);
 
   // Owned token type.
   TokenType token_type_;
 
   // Mapping from Type:ToString to the owned function type. Use
   // node_hash_map for pointer stability.
-  absl::node_hash_map<std::string, FunctionType> function_types_;
+  absl::node_hash_map<std::string, FunctionType> function_types_
+      ABSL_GUARDED_BY(types_mutex_);
 
   // The largest `Fileno` used in this `Package`.
   std::optional<Fileno> maximum_fileno_;
@@ -478,7 +542,12 @@ class Package {
   int64_t next_channel_id_ = 0;
 
   // Metrics which record the total number of transformations to the package.
-  TransformMetrics transform_metrics_ = {0};
+  // Atomic as the FunctionBases of the package may be transformed
+  // concurrently. See TransformMetrics for the meaning of each metric.
+  std::atomic<int64_t> nodes_added_ = 0;
+  std::atomic<int64_t> nodes_removed_ = 0;
+  std::atomic<int64_t> nodes_replaced_ = 0;
+  std::atomic<int64_t> operands_replaced_ = 0;
 };
 
 std::ostream& operator<<(std::ostream& os, const Package& package);
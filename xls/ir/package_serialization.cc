@@ -0,0 +1,527 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/package_serialization.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/dense_node_map.h"
+#include "xls/ir/fileno.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/lsb_or_msb.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/verifier.h"
+#include "xls/ir/xls_package.pb.h"
+
+namespace xls {
+namespace {
+
+class PackageWriter {
+ public:
+  explicit PackageWriter(PackageProto* proto) : proto_(proto) {}
+
+  absl::Status WriteFunction(Function* function) {
+    FunctionProto* function_proto = proto_->add_functions();
+    function_proto->set_name(function->name());
+    function_proto->set_param_count(function->params().size());
+
+    std::vector<Node*> order(function->params().begin(),
+                             function->params().end());
+    order.reserve(function->node_count());
+    for (Node* node : TopoSort(function)) {
+      if (!node->Is<Param>()) {
+        order.push_back(node);
+      }
+    }
+
+    DenseNodeMap<int64_t> node_indices;
+    node_indices.reserve(order.size());
+    for (Node* node : order) {
+      int64_t index = function_proto->nodes_size();
+      XLS_RETURN_IF_ERROR(
+          WriteNode(node, node_indices, function_proto->add_nodes()));
+      node_indices[node] = index;
+    }
+    function_proto->set_return_value(node_indices.at(function->return_value()));
+
+    if (function->GetInitiationInterval().has_value()) {
+      function_proto->set_initiation_interval(
+          *function->GetInitiationInterval());
+    }
+    if (function->ForeignFunctionData().has_value()) {
+      *function_proto->mutable_ffi() = *function->ForeignFunctionData();
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  int64_t TypeIndex(Type* type) {
+    auto [it, inserted] = type_indices_.try_emplace(type, type_indices_.size());
+    if (inserted) {
+      *proto_->add_types() = type->ToProto();
+    }
+    return it->second;
+  }
+
+  absl::Status WriteNode(Node* node,
+                         const DenseNodeMap<int64_t>& node_indices,
+                         NodeProto* proto) {
+    proto->set_op(ToOpProto(node->op()));
+    proto->set_id(node->id());
+    proto->set_type(TypeIndex(node->GetType()));
+    for (Node* operand : node->operands()) {
+      proto->add_operands(node_indices.at(operand));
+    }
+    if (node->HasAssignedName()) {
+      proto->set_name(node->GetName());
+    }
+    for (const SourceLocation& location : node->loc().locations) {
+      SourceLocationProto* loc = proto->add_loc();
+      loc->set_fileno(location.fileno().value());
+      loc->set_lineno(location.lineno().value());
+      loc->set_colno(location.colno().value());
+    }
+
+    switch (node->op()) {
+      case Op::kLiteral: {
+        XLS_ASSIGN_OR_RETURN(*proto->mutable_value(),
+                             node->As<Literal>()->value().AsProto());
+        break;
+      }
+      case Op::kBitSlice:
+        proto->set_start(node->As<BitSlice>()->start());
+        proto->set_width(node->As<BitSlice>()->width());
+        break;
+      case Op::kDynamicBitSlice:
+        proto->set_width(node->As<DynamicBitSlice>()->width());
+        break;
+      case Op::kArraySlice:
+        proto->set_width(node->As<ArraySlice>()->width());
+        break;
+      case Op::kDecode:
+        proto->set_width(node->As<Decode>()->width());
+        break;
+      case Op::kTupleIndex:
+        proto->set_index(node->As<TupleIndex>()->index());
+        break;
+      case Op::kMinDelay:
+        proto->set_delay(node->As<MinDelay>()->delay());
+        break;
+      case Op::kOneHot:
+        proto->set_lsb_prio(node->As<OneHot>()->priority() == LsbOrMsb::kLsb);
+        break;
+      case Op::kSel:
+        proto->set_has_default_value(
+            node->As<Select>()->default_value().has_value());
+        break;
+      case Op::kInvoke:
+        proto->set_function(node->As<Invoke>()->to_apply()->name());
+        break;
+      case Op::kMap:
+        proto->set_function(node->As<Map>()->to_apply()->name());
+        break;
+      case Op::kCountedFor: {
+        CountedFor* counted_for = node->As<CountedFor>();
+        proto->set_trip_count(counted_for->trip_count());
+        proto->set_stride(counted_for->stride());
+        proto->set_function(counted_for->body()->name());
+        break;
+      }
+      case Op::kDynamicCountedFor:
+        proto->set_function(node->As<DynamicCountedFor>()->body()->name());
+        break;
+      case Op::kAssert: {
+        Assert* assert_node = node->As<Assert>();
+        proto->set_message(assert_node->message());
+        if (assert_node->label().has_value()) {
+          proto->set_label(*assert_node->label());
+        }
+        break;
+      }
+      case Op::kCover:
+        proto->set_label(node->As<Cover>()->label());
+        break;
+      case Op::kTrace:
+        proto->set_format(StepsToXlsFormatString(node->As<Trace>()->format()));
+        proto->set_verbosity(node->As<Trace>()->verbosity());
+        break;
+      default:
+        // The remaining attributes of function ops are determined by the type
+        // of the node.
+        break;
+    }
+    return absl::OkStatus();
+  }
+
+  PackageProto* proto_;
+  absl::flat_hash_map<Type*, int64_t> type_indices_;
+};
+
+absl::StatusOr<BValue> BuildNode(FunctionBuilder& fb, const NodeProto& proto,
+                                 Type* type, absl::Span<const BValue> operands,
+                                 const SourceInfo& loc, Package* package) {
+  Op op = FromOpProto(proto.op());
+  std::string_view name = proto.name();
+  auto check_operand_count = [&](int64_t count) -> absl::Status {
+    if (operands.size() != count) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Expected %d operands for %s node, got %d", count,
+                          OpToString(op), operands.size()));
+    }
+    return absl::OkStatus();
+  };
+  auto check_min_operand_count = [&](int64_t count) -> absl::Status {
+    if (operands.size() < count) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Expected at least %d operands for %s node, got %d",
+                          count, OpToString(op), operands.size()));
+    }
+    return absl::OkStatus();
+  };
+
+  if (IsOpClass<BinOp>(op)) {
+    XLS_RETURN_IF_ERROR(check_operand_count(2));
+    return fb.AddBinOp(op, operands[0], operands[1], loc, name);
+  }
+  if (IsOpClass<UnOp>(op)) {
+    XLS_RETURN_IF_ERROR(check_operand_count(1));
+    return fb.AddUnOp(op, operands[0], loc, name);
+  }
+  if (IsOpClass<CompareOp>(op)) {
+    XLS_RETURN_IF_ERROR(check_operand_count(2));
+    return fb.AddCompareOp(op, operands[0], operands[1], loc, name);
+  }
+  if (IsOpClass<NaryOp>(op)) {
+    return fb.AddNaryOp(op, operands, loc, name);
+  }
+  if (IsOpClass<BitwiseReductionOp>(op)) {
+    XLS_RETURN_IF_ERROR(check_operand_count(1));
+    return fb.AddBitwiseReductionOp(op, operands[0], loc, name);
+  }
+
+  auto get_function = [&]() -> absl::StatusOr<Function*> {
+    return package->GetFunction(proto.function());
+  };
+  switch (op) {
+    case Op::kLiteral: {
+      XLS_RETURN_IF_ERROR(check_operand_count(0));
+      XLS_ASSIGN_OR_RETURN(Value value, Value::FromProto(proto.value()));
+      return fb.Literal(value, loc, name);
+    }
+    case Op::kBitSlice:
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      return fb.BitSlice(operands[0], proto.start(), proto.width(), loc, name);
+    case Op::kDynamicBitSlice:
+      XLS_RETURN_IF_ERROR(check_operand_count(2));
+      return fb.DynamicBitSlice(operands[0], operands[1], proto.width(), loc,
+                                name);
+    case Op::kBitSliceUpdate:
+      XLS_RETURN_IF_ERROR(check_operand_count(3));
+      return fb.BitSliceUpdate(operands[0], operands[1], operands[2], loc,
+                               name);
+    case Op::kConcat:
+      return fb.Concat(operands, loc, name);
+    case Op::kTuple:
+      return fb.Tuple(operands, loc, name);
+    case Op::kTupleIndex:
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      return fb.TupleIndex(operands[0], proto.index(), loc, name);
+    case Op::kAfterAll:
+      return fb.AfterAll(operands, loc, name);
+    case Op::kMinDelay:
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      return fb.MinDelay(operands[0], proto.delay(), loc, name);
+    case Op::kArray:
+      XLS_RET_CHECK(type->IsArray()) << type->ToString();
+      return fb.Array(operands, type->AsArrayOrDie()->element_type(), loc,
+                      name);
+    case Op::kArrayIndex:
+      XLS_RETURN_IF_ERROR(check_min_operand_count(1));
+      return fb.ArrayIndex(operands[0], operands.subspan(1), loc, name);
+    case Op::kArrayUpdate:
+      XLS_RETURN_IF_ERROR(check_min_operand_count(2));
+      return fb.ArrayUpdate(operands[0], operands[1], operands.subspan(2), loc,
+                            name);
+    case Op::kArraySlice:
+      XLS_RETURN_IF_ERROR(check_operand_count(2));
+      return fb.ArraySlice(operands[0], operands[1], proto.width(), loc, name);
+    case Op::kArrayConcat:
+      return fb.ArrayConcat(operands, loc, name);
+    case Op::kSignExt:
+    case Op::kZeroExt:
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      XLS_RET_CHECK(type->IsBits()) << type->ToString();
+      return op == Op::kSignExt
+                 ? fb.SignExtend(operands[0], type->GetFlatBitCount(), loc,
+                                 name)
+                 : fb.ZeroExtend(operands[0], type->GetFlatBitCount(), loc,
+                                 name);
+    case Op::kEncode:
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      return fb.Encode(operands[0], loc, name);
+    case Op::kDecode:
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      return fb.Decode(operands[0], proto.width(), loc, name);
+    case Op::kOneHot:
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      return fb.OneHot(operands[0],
+                       proto.lsb_prio() ? LsbOrMsb::kLsb : LsbOrMsb::kMsb, loc,
+                       name);
+    case Op::kSel: {
+      XLS_RETURN_IF_ERROR(
+          check_min_operand_count(proto.has_default_value() ? 2 : 1));
+      absl::Span<const BValue> cases = operands.subspan(1);
+      std::optional<BValue> default_value;
+      if (proto.has_default_value()) {
+        default_value = cases.back();
+        cases.remove_suffix(1);
+      }
+      return fb.Select(operands[0], cases, default_value, loc, name);
+    }
+    case Op::kOneHotSel:
+      XLS_RETURN_IF_ERROR(check_min_operand_count(1));
+      return fb.OneHotSelect(operands[0], operands.subspan(1), loc, name);
+    case Op::kPrioritySel:
+      XLS_RETURN_IF_ERROR(check_min_operand_count(1));
+      return fb.PrioritySelect(operands[0], operands.subspan(1), loc, name);
+    case Op::kSMul:
+    case Op::kUMul:
+      XLS_RETURN_IF_ERROR(check_operand_count(2));
+      XLS_RET_CHECK(type->IsBits()) << type->ToString();
+      return fb.AddArithOp(op, operands[0], operands[1],
+                           type->GetFlatBitCount(), loc, name);
+    case Op::kSMulp:
+    case Op::kUMulp:
+      XLS_RETURN_IF_ERROR(check_operand_count(2));
+      XLS_RET_CHECK(type->IsTuple() && type->AsTupleOrDie()->size() == 2)
+          << type->ToString();
+      return fb.AddPartialProductOp(
+          op, operands[0], operands[1],
+          type->AsTupleOrDie()->element_type(0)->GetFlatBitCount(), loc, name);
+    case Op::kInvoke: {
+      XLS_ASSIGN_OR_RETURN(Function * to_apply, get_function());
+      return fb.Invoke(operands, to_apply, loc, name);
+    }
+    case Op::kMap: {
+      XLS_RETURN_IF_ERROR(check_operand_count(1));
+      XLS_ASSIGN_OR_RETURN(Function * to_apply, get_function());
+      return fb.Map(operands[0], to_apply, loc, name);
+    }
+    case Op::kCountedFor: {
+      XLS_RETURN_IF_ERROR(check_min_operand_count(1));
+      XLS_ASSIGN_OR_RETURN(Function * body, get_function());
+      return fb.CountedFor(operands[0], proto.trip_count(), proto.stride(),
+                           body, operands.subspan(1), loc, name);
+    }
+    case Op::kDynamicCountedFor: {
+      XLS_RETURN_IF_ERROR(check_min_operand_count(3));
+      XLS_ASSIGN_OR_RETURN(Function * body, get_function());
+      return fb.DynamicCountedFor(operands[0], operands[1], operands[2], body,
+                                  operands.subspan(3), loc, name);
+    }
+    case Op::kAssert: {
+      XLS_RETURN_IF_ERROR(check_operand_count(2));
+      std::optional<std::string> label;
+      if (proto.has_label()) {
+        label = proto.label();
+      }
+      return fb.Assert(operands[0], operands[1], proto.message(), label, loc,
+                       name);
+    }
+    case Op::kCover:
+      XLS_RETURN_IF_ERROR(check_operand_count(2));
+      return fb.Cover(operands[0], operands[1], proto.label(), loc, name);
+    case Op::kTrace: {
+      XLS_RETURN_IF_ERROR(check_min_operand_count(2));
+      XLS_ASSIGN_OR_RETURN(std::vector<FormatStep> format,
+                           ParseFormatString(proto.format()));
+      return fb.Trace(operands[0], operands[1], operands.subspan(2), format,
+                      proto.verbosity(), loc, name);
+    }
+    case Op::kGate:
+      XLS_RETURN_IF_ERROR(check_operand_count(2));
+      return fb.Gate(operands[0], operands[1], loc, name);
+    default:
+      return absl::UnimplementedError(absl::StrFormat(
+          "Op %s is not supported in serialized functions", OpToString(op)));
+  }
+}
+
+absl::StatusOr<Function*> ReadFunction(const FunctionProto& proto,
+                                       absl::Span<Type* const> types,
+                                       Package* package) {
+  // As in the IR parser, verification is done once the package is complete.
+  FunctionBuilder fb(proto.name(), package, /*should_verify=*/false);
+  std::vector<BValue> values;
+  values.reserve(proto.nodes_size());
+  for (const NodeProto& node_proto : proto.nodes()) {
+    XLS_RET_CHECK(node_proto.type() >= 0 && node_proto.type() < types.size())
+        << "Invalid type index " << node_proto.type();
+    Type* type = types[node_proto.type()];
+    std::vector<BValue> operands;
+    operands.reserve(node_proto.operands_size());
+    for (int64_t operand : node_proto.operands()) {
+      XLS_RET_CHECK(operand >= 0 && operand < values.size())
+          << "Invalid operand index " << operand;
+      operands.push_back(values[operand]);
+    }
+    SourceInfo loc;
+    loc.locations.reserve(node_proto.loc_size());
+    for (const SourceLocationProto& location : node_proto.loc()) {
+      loc.locations.push_back(SourceLocation(Fileno(location.fileno()),
+                                             Lineno(location.lineno()),
+                                             Colno(location.colno())));
+    }
+
+    BValue value;
+    if (values.size() < proto.param_count()) {
+      XLS_RET_CHECK_EQ(node_proto.op(), OP_PARAM);
+      value = fb.Param(node_proto.name(), type, loc);
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          value, BuildNode(fb, node_proto, type, operands, loc, package));
+    }
+    if (!value.valid()) {
+      XLS_RETURN_IF_ERROR(fb.GetError());
+      return absl::InternalError(absl::StrFormat(
+          "Unable to build %s node in function %s",
+          OpToString(FromOpProto(node_proto.op())), proto.name()));
+    }
+    if (value.node()->GetType() != type) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Declared type %s of node %s does not match expected type %s",
+          type->ToString(), value.node()->GetName(),
+          value.node()->GetType()->ToString()));
+    }
+    value.node()->SetId(node_proto.id());
+    values.push_back(value);
+  }
+
+  XLS_RET_CHECK(proto.return_value() >= 0 &&
+                proto.return_value() < values.size())
+      << "Invalid return value index " << proto.return_value();
+  XLS_ASSIGN_OR_RETURN(Function * function,
+                       fb.BuildWithReturnValue(values[proto.return_value()]));
+  if (proto.has_initiation_interval()) {
+    function->SetInitiationInterval(proto.initiation_interval());
+  }
+  if (proto.has_ffi()) {
+    function->SetForeignFunctionData(proto.ffi());
+  }
+  return function;
+}
+
+}  // namespace
+
+absl::StatusOr<PackageProto> PackageToProto(Package* package) {
+  if (!package->procs().empty() || !package->blocks().empty() ||
+      !package->channels().empty()) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "Package %s contains procs, blocks or channels which are not supported "
+        "by the binary package format",
+        package->name()));
+  }
+
+  PackageProto proto;
+  proto.set_name(package->name());
+
+  std::vector<std::pair<Fileno, std::string>> files(
+      package->fileno_to_name().begin(), package->fileno_to_name().end());
+  std::sort(files.begin(), files.end());
+  for (const auto& [fileno, path] : files) {
+    FileNameProto* file = proto.add_files();
+    file->set_fileno(fileno.value());
+    file->set_path(path);
+  }
+
+  PackageWriter writer(&proto);
+  for (FunctionBase* function_base : FunctionsInPostOrder(package)) {
+    XLS_RETURN_IF_ERROR(writer.WriteFunction(function_base->AsFunctionOrDie()));
+  }
+
+  std::optional<FunctionBase*> top = package->GetTop();
+  if (top.has_value()) {
+    proto.set_top((*top)->name());
+  }
+  return proto;
+}
+
+absl::StatusOr<std::unique_ptr<Package>> PackageFromProto(
+    const PackageProto& proto) {
+  auto package = std::make_unique<Package>(proto.name());
+  for (const FileNameProto& file : proto.files()) {
+    package->SetFileno(Fileno(file.fileno()), file.path());
+  }
+
+  std::vector<Type*> types;
+  types.reserve(proto.types_size());
+  for (const TypeProto& type_proto : proto.types()) {
+    XLS_ASSIGN_OR_RETURN(Type * type, package->GetTypeFromProto(type_proto));
+    types.push_back(type);
+  }
+
+  for (const FunctionProto& function_proto : proto.functions()) {
+    XLS_RETURN_IF_ERROR(
+        ReadFunction(function_proto, types, package.get()).status());
+  }
+
+  if (proto.has_top()) {
+    XLS_RETURN_IF_ERROR(package->SetTopByName(proto.top()));
+  }
+  XLS_RETURN_IF_ERROR(VerifyPackage(package.get()));
+  return package;
+}
+
+absl::StatusOr<std::string> SerializePackage(Package* package) {
+  XLS_ASSIGN_OR_RETURN(PackageProto proto, PackageToProto(package));
+  std::string bytes;
+  XLS_RET_CHECK(proto.SerializeToString(&bytes));
+  return bytes;
+}
+
+absl::StatusOr<std::unique_ptr<Package>> DeserializePackage(
+    std::string_view bytes) {
+  PackageProto proto;
+  if (!proto.ParseFromArray(bytes.data(), bytes.size())) {
+    return absl::InvalidArgumentError("Unable to parse binary package proto");
+  }
+  return PackageFromProto(proto);
+}
+
+}  // namespace xls
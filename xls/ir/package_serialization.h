@@ -0,0 +1,48 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_PACKAGE_SERIALIZATION_H_
+#define XLS_IR_PACKAGE_SERIALIZATION_H_
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/package.h"
+#include "xls/ir/xls_package.pb.h"
+
+namespace xls {
+
+// Converts the package into its binary proto form. Node ids, names, source
+// locations and the top entity are preserved, so the package returned by
+// PackageFromProto dumps to the same IR text as `package`.
+//
+// Only functions are supported; returns an UnimplementedError if the package
+// contains procs, blocks or channels.
+absl::StatusOr<PackageProto> PackageToProto(Package* package);
+
+// Builds a package from its binary proto form and verifies it.
+absl::StatusOr<std::unique_ptr<Package>> PackageFromProto(
+    const PackageProto& proto);
+
+// As above but to and from the serialized bytes of the proto. This is much
+// faster to write and read than IR text for large packages.
+absl::StatusOr<std::string> SerializePackage(Package* package);
+absl::StatusOr<std::unique_ptr<Package>> DeserializePackage(
+    std::string_view bytes);
+
+}  // namespace xls
+
+#endif  // XLS_IR_PACKAGE_SERIALIZATION_H_
@@ -0,0 +1,122 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/package_serialization.h"
+
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+class PackageSerializationTest : public IrTestBase {
+ protected:
+  void ExpectRoundTrip(std::string_view text) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                             ParsePackage(text));
+    XLS_ASSERT_OK_AND_ASSIGN(std::string bytes,
+                             SerializePackage(package.get()));
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> result,
+                             DeserializePackage(bytes));
+    EXPECT_EQ(result->DumpIr(), package->DumpIr());
+  }
+};
+
+TEST_F(PackageSerializationTest, SimpleFunction) {
+  ExpectRoundTrip(R"(
+package simple
+
+top fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.3: bits[32] = add(x, y, id=3)
+}
+)");
+}
+
+TEST_F(PackageSerializationTest, NamesAndSourceLocations) {
+  ExpectRoundTrip(R"(
+package locations
+
+file_number 0 "a.x"
+file_number 1 "b.x"
+
+top fn f(x: bits[8]) -> bits[8] {
+  sum: bits[8] = add(x, x, id=2, pos=[(0,1,2), (1,3,4)])
+  ret neg.3: bits[8] = neg(sum, id=3, pos=[(1,5,6)])
+}
+)");
+}
+
+TEST_F(PackageSerializationTest, OpAttributes) {
+  ExpectRoundTrip(R"(
+package attributes
+
+fn body(i: bits[8], accum: bits[8], k: bits[8]) -> bits[8] {
+  add.5: bits[8] = add(accum, i, id=5)
+  ret add.6: bits[8] = add(add.5, k, id=6)
+}
+
+fn double(x: bits[8]) -> bits[8] {
+  ret umul.8: bits[8] = umul(x, x, id=8)
+}
+
+top fn f(x: bits[8], s: bits[2], t: token) -> (bits[8], bits[9], bits[3], bits[8][2], bits[16], token) {
+  literal.12: bits[8] = literal(value=42, id=12)
+  bit_slice.13: bits[3] = bit_slice(x, start=2, width=3, id=13)
+  one_hot.14: bits[9] = one_hot(x, lsb_prio=true, id=14)
+  sel.15: bits[8] = sel(s, cases=[x, literal.12], default=x, id=15)
+  counted_for.16: bits[8] = counted_for(sel.15, trip_count=4, stride=2, body=body, invariant_args=[literal.12], id=16)
+  invoke.17: bits[8] = invoke(counted_for.16, to_apply=double, id=17)
+  array.18: bits[8][2] = array(x, invoke.17, id=18)
+  array_index.19: bits[8] = array_index(array.18, indices=[s], id=19)
+  literal.20: bits[1] = literal(value=1, id=20)
+  sign_ext.25: bits[16] = sign_ext(x, new_bit_count=16, id=25)
+  trace.21: token = trace(t, literal.20, format="x is {:x}", data_operands=[x], verbosity=1, id=21)
+  assert.22: token = assert(trace.21, literal.20, message="oops", label="my_label", id=22)
+  cover.23: token = cover(assert.22, literal.20, label="my_cover", id=23)
+  ret tuple.24: (bits[8], bits[9], bits[3], bits[8][2], bits[16], token) = tuple(array_index.19, one_hot.14, bit_slice.13, array.18, sign_ext.25, cover.23, id=24)
+}
+)");
+}
+
+TEST_F(PackageSerializationTest, ProcsAreUnsupported) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           ParsePackage(R"(
+package with_proc
+
+proc p(tkn: token, st: bits[32], init={0}) {
+  next (tkn, st)
+}
+)"));
+  EXPECT_THAT(SerializePackage(package.get()),
+              StatusIs(absl::StatusCode::kUnimplemented,
+                       HasSubstr("not supported")));
+}
+
+TEST_F(PackageSerializationTest, InvalidBytes) {
+  EXPECT_THAT(DeserializePackage("not a package proto"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace xls
@@ -393,6 +393,34 @@ TEST_F(PackageTest, ChannelRemoval) {
                        HasSubstr("cannot be removed because it is used")));
 }
 
+TEST_F(PackageTest, MultipleChannelRemoval) {
+  Package p(TestName());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch0, p.CreateStreamingChannel("ch0", ChannelOps::kSendOnly,
+                                              p.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch1, p.CreateStreamingChannel("ch1", ChannelOps::kSendOnly,
+                                              p.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch2, p.CreateStreamingChannel("ch2", ChannelOps::kSendOnly,
+                                              p.GetBitsType(32)));
+  TokenlessProcBuilder b(TestName(), "tkn", &p);
+  b.Send(ch0, b.Literal(Value(UBits(42, 32))));
+  XLS_ASSERT_OK(b.Build({}).status());
+
+  // Nothing is removed if any of the channels is in use.
+  EXPECT_THAT(p.RemoveChannels({ch2, ch0}),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Channel ch0 (id=0) cannot be removed")));
+  EXPECT_THAT(p.channels(), ElementsAre(ch0, ch1, ch2));
+
+  XLS_ASSERT_OK(p.RemoveChannels({ch2, ch1}));
+  EXPECT_THAT(p.channels(), ElementsAre(ch0));
+  EXPECT_FALSE(p.HasChannelWithName("ch1"));
+  EXPECT_FALSE(p.HasChannelWithName("ch2"));
+}
+
 TEST_F(PackageTest, CloneSingleValueChannelSamePackage) {
   Package p(TestName());
 
@@ -1182,5 +1210,37 @@ TEST_F(PackageTest, TransformMetrics) {
   EXPECT_EQ(p->transform_metrics().operands_replaced, 2);
 }
 
+TEST_F(PackageTest, EstimateMemoryUsage) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue small = fb.Literal(UBits(1, 32));
+  BValue wide = fb.Literal(Value(Bits(4096)));
+  BValue add = fb.Add(x, small);
+  BValue sub = fb.Subtract(x, small);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * f, fb.BuildWithReturnValue(fb.Tuple({add, wide})));
+
+  PackageMemoryUsage usage = p->EstimateMemoryUsage();
+  EXPECT_EQ(usage.TotalNodeMemoryUsage().node_count, f->node_count());
+  EXPECT_EQ(usage.nodes_by_op.at(Op::kLiteral).node_count, 2);
+  EXPECT_EQ(usage.nodes_by_op.at(Op::kAdd).node_count, 1);
+  EXPECT_FALSE(usage.nodes_by_op.contains(Op::kUMul));
+  // The wide literal holds its bits on the heap.
+  EXPECT_GE(usage.nodes_by_op.at(Op::kLiteral).payload_bytes, 4096 / 8);
+  EXPECT_GT(usage.type_bytes, 0);
+  EXPECT_EQ(usage.TotalBytes(), usage.TotalNodeMemoryUsage().total_bytes() +
+                                    usage.unused_arena_bytes +
+                                    usage.type_bytes);
+  EXPECT_THAT(usage.ToString(), HasSubstr("literal: "));
+
+  // The storage of a removed node remains reserved by the arena.
+  int64_t node_bytes = usage.TotalNodeMemoryUsage().node_bytes;
+  XLS_ASSERT_OK(f->RemoveNode(sub.node()));
+  PackageMemoryUsage after = p->EstimateMemoryUsage();
+  EXPECT_LT(after.TotalNodeMemoryUsage().node_bytes, node_bytes);
+  EXPECT_GT(after.unused_arena_bytes, usage.unused_arena_bytes);
+}
+
 }  // namespace
 }  // namespace xls
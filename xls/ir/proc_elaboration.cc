@@ -25,6 +25,8 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -46,40 +48,53 @@
 namespace xls {
 namespace {
 
+absl::StatusOr<const SharedProcData*> GetSharedProcData(
+    Proc* proc,
+    absl::flat_hash_map<Proc*, std::unique_ptr<SharedProcData>>& shared_data) {
+  std::unique_ptr<SharedProcData>& data = shared_data[proc];
+  if (data == nullptr) {
+    XLS_ASSIGN_OR_RETURN(data, SharedProcData::Create(proc));
+  }
+  return data.get();
+}
+
 absl::StatusOr<std::unique_ptr<ProcInstance>> CreateNewStyleProcInstance(
     Proc* proc, std::optional<ProcInstantiation*> proc_instantiation,
     const ProcInstantiationPath& path,
-    absl::Span<const ChannelBinding> interface_bindings) {
+    absl::Span<const ChannelBinding> interface_bindings,
+    absl::flat_hash_map<Proc*, std::unique_ptr<SharedProcData>>& shared_data) {
   XLS_RET_CHECK(proc->is_new_style_proc());
+  XLS_ASSIGN_OR_RETURN(const SharedProcData* proc_data,
+                       GetSharedProcData(proc, shared_data));
 
-  // Map from channel reference name to ChannelInstance.
-  absl::flat_hash_map<ChannelRef, ChannelBinding> channel_bindings;
+  std::vector<ChannelBinding> channel_bindings(proc_data->binding_count());
   XLS_RET_CHECK_EQ(interface_bindings.size(), proc->interface().size());
   for (int64_t i = 0; i < interface_bindings.size(); ++i) {
-    channel_bindings[proc->interface()[i]] = interface_bindings[i];
+    channel_bindings[proc_data->GetBindingIndex(proc->interface()[i])] =
+        interface_bindings[i];
   }
   std::vector<std::unique_ptr<ChannelInstance>> declared_channels;
-  for (Channel* channel : proc->channels()) {
+  declared_channels.reserve(proc->channels().size());
+  for (int64_t i = 0; i < proc->channels().size(); ++i) {
     declared_channels.push_back(std::make_unique<ChannelInstance>(
-        ChannelInstance{.channel = channel, .path = path}));
+        ChannelInstance{.channel = proc->channels()[i], .path = path}));
     ChannelInstance* channel_instance = declared_channels.back().get();
-    XLS_ASSIGN_OR_RETURN(ChannelReference * send_reference,
-                         proc->GetSendChannelReference(channel->name()));
-    XLS_ASSIGN_OR_RETURN(ChannelReference * receive_reference,
-                         proc->GetReceiveChannelReference(channel->name()));
+    const auto& [send_index, receive_index] =
+        proc_data->declared_channel_bindings()[i];
     // Channel bindings for channels declared in this proc do not themselves
     // bind to another reference, so the parent reference field is empty.
-    channel_bindings[send_reference] = ChannelBinding{
+    channel_bindings[send_index] = ChannelBinding{
         .instance = channel_instance, .parent_reference = std::nullopt};
-    channel_bindings[receive_reference] = ChannelBinding{
+    channel_bindings[receive_index] = ChannelBinding{
         .instance = channel_instance, .parent_reference = std::nullopt};
   }
 
   std::vector<std::unique_ptr<ProcInstance>> instantiated_procs;
-  for (const std::unique_ptr<ProcInstantiation>& instantiation :
-       proc->proc_instantiations()) {
+  instantiated_procs.reserve(proc->proc_instantiations().size());
+  for (int64_t i = 0; i < proc->proc_instantiations().size(); ++i) {
+    ProcInstantiation* instantiation = proc->proc_instantiations()[i].get();
     ProcInstantiationPath instantiation_path = path;
-    instantiation_path.path.push_back(instantiation.get());
+    instantiation_path.path.push_back(instantiation);
 
     // Check for circular dependencies. Walk the original path and see if
     // `instantiation->proc()` appears any where.
@@ -93,21 +108,27 @@ absl::StatusOr<std::unique_ptr<ProcInstance>> CreateNewStyleProcInstance(
                           instantiation_path.ToString()));
     }
 
+    absl::Span<ChannelReference* const> channel_args =
+        instantiation->channel_args();
+    absl::Span<const int64_t> arg_bindings =
+        proc_data->instantiation_arg_bindings()[i];
     std::vector<ChannelBinding> subproc_interface_bindings;
-    for (ChannelReference* channel_ref : instantiation->channel_args()) {
+    subproc_interface_bindings.reserve(channel_args.size());
+    for (int64_t j = 0; j < channel_args.size(); ++j) {
       subproc_interface_bindings.push_back(
-          ChannelBinding{.instance = channel_bindings.at(channel_ref).instance,
-                         .parent_reference = channel_ref});
+          ChannelBinding{.instance = channel_bindings[arg_bindings[j]].instance,
+                         .parent_reference = channel_args[j]});
     }
-    XLS_ASSIGN_OR_RETURN(std::unique_ptr<ProcInstance> instantiation_instance,
-                         CreateNewStyleProcInstance(
-                             instantiation->proc(), instantiation.get(),
-                             instantiation_path, subproc_interface_bindings));
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<ProcInstance> instantiation_instance,
+        CreateNewStyleProcInstance(instantiation->proc(), instantiation,
+                                   instantiation_path,
+                                   subproc_interface_bindings, shared_data));
     instantiated_procs.push_back(std::move(instantiation_instance));
   }
 
   return std::make_unique<ProcInstance>(
-      proc, proc_instantiation, path, std::move(declared_channels),
+      proc_data, proc_instantiation, path, std::move(declared_channels),
       std::move(instantiated_procs), std::move(channel_bindings));
 }
 
@@ -120,36 +141,86 @@ std::string ChannelInstance::ToString() const {
   return std::string{channel->name()};
 }
 
+/* static */ absl::StatusOr<std::unique_ptr<SharedProcData>>
+SharedProcData::Create(Proc* proc) {
+  auto data = absl::WrapUnique(new SharedProcData(proc));
+  auto add_binding = [&](ChannelRef channel_ref, std::string_view name) {
+    int64_t index = data->binding_count_++;
+    data->binding_indices_[channel_ref] = index;
+    data->binding_indices_by_name_[name] = index;
+  };
+  if (!proc->is_new_style_proc()) {
+    for (Channel* channel : proc->package()->channels()) {
+      add_binding(channel, channel->name());
+    }
+    return data;
+  }
+
+  for (const std::unique_ptr<ChannelReference>& channel_reference :
+       proc->channel_references()) {
+    add_binding(channel_reference.get(), channel_reference->name());
+  }
+  auto binding_index =
+      [&](ChannelReference* channel_reference) -> absl::StatusOr<int64_t> {
+    auto it = data->binding_indices_.find(channel_reference);
+    XLS_RET_CHECK(it != data->binding_indices_.end())
+        << "Channel reference `" << channel_reference->name()
+        << "` is not in proc `" << proc->name() << "`";
+    return it->second;
+  };
+  for (Channel* channel : proc->channels()) {
+    XLS_ASSIGN_OR_RETURN(ChannelReference * send_reference,
+                         proc->GetSendChannelReference(channel->name()));
+    XLS_ASSIGN_OR_RETURN(ChannelReference * receive_reference,
+                         proc->GetReceiveChannelReference(channel->name()));
+    XLS_ASSIGN_OR_RETURN(int64_t send_index, binding_index(send_reference));
+    XLS_ASSIGN_OR_RETURN(int64_t receive_index,
+                         binding_index(receive_reference));
+    data->declared_channel_bindings_.push_back({send_index, receive_index});
+  }
+  for (const std::unique_ptr<ProcInstantiation>& instantiation :
+       proc->proc_instantiations()) {
+    std::vector<int64_t>& arg_bindings =
+        data->instantiation_arg_bindings_.emplace_back();
+    for (ChannelReference* channel_ref : instantiation->channel_args()) {
+      XLS_ASSIGN_OR_RETURN(int64_t index, binding_index(channel_ref));
+      arg_bindings.push_back(index);
+    }
+  }
+  return data;
+}
+
+std::optional<int64_t> SharedProcData::FindBindingIndex(
+    std::string_view name) const {
+  auto it = binding_indices_by_name_.find(name);
+  if (it == binding_indices_by_name_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
 ProcInstance::ProcInstance(
-    Proc* proc, std::optional<ProcInstantiation*> proc_instantiation,
+    const SharedProcData* shared_data,
+    std::optional<ProcInstantiation*> proc_instantiation,
     std::optional<ProcInstantiationPath> path,
     std::vector<std::unique_ptr<ChannelInstance>> channel_instances,
     std::vector<std::unique_ptr<ProcInstance>> instantiated_procs,
-    absl::flat_hash_map<ChannelRef, ChannelBinding> channel_bindings)
-    : proc_(proc),
+    std::vector<ChannelBinding> channel_bindings)
+    : shared_data_(shared_data),
       proc_instantiation_(proc_instantiation),
       path_(std::move(path)),
       channel_instances_(std::move(channel_instances)),
       instantiated_procs_(std::move(instantiated_procs)),
       channel_bindings_(std::move(channel_bindings)) {
-  if (proc->is_new_style_proc()) {
-    for (const std::unique_ptr<ChannelReference>& channel_reference :
-         proc->channel_references()) {
-      channel_name_map_[channel_reference->name()] =
-          channel_bindings_.at(channel_reference.get()).instance;
-    }
-  } else {
-    for (Channel* channel : proc->package()->channels()) {
-      channel_name_map_[channel->name()] =
-          channel_bindings_.at(channel).instance;
-    }
-  }
+  CHECK_EQ(channel_bindings_.size(), shared_data_->binding_count());
 }
 
 absl::StatusOr<ChannelInstance*> ProcInstance::GetChannelInstance(
     std::string_view channel_reference_name) const {
-  if (channel_name_map_.contains(channel_reference_name)) {
-    return channel_name_map_.at(channel_reference_name);
+  std::optional<int64_t> index =
+      shared_data_->FindBindingIndex(channel_reference_name);
+  if (index.has_value()) {
+    return channel_bindings_[*index].instance;
   }
   return absl::NotFoundError(
       absl::StrFormat("No channel reference named `%s` in proc `%s`",
@@ -216,14 +287,8 @@ absl::Status ProcElaboration::BuildInstanceMaps(ProcInstance* proc_instance) {
 
   for (const std::unique_ptr<ChannelReference>& channel_reference :
        proc_instance->proc()->channel_references()) {
-    XLS_ASSIGN_OR_RETURN(
-        ChannelInstance * channel_instance,
-        proc_instance->GetChannelInstance(channel_reference->name()));
-    channel_instances_by_path_[{std::string{channel_reference->name()},
-                                proc_instance->path().value()}] =
-        channel_instance;
     instances_of_channel_reference_[channel_reference.get()].push_back(
-        channel_instance);
+        proc_instance->GetChannelBinding(channel_reference.get()).instance);
   }
 
   for (const std::unique_ptr<ProcInstance>& subinstance :
@@ -285,7 +350,7 @@ absl::Status ProcElaboration::BuildInstanceMaps(ProcInstance* proc_instance) {
   XLS_ASSIGN_OR_RETURN(
       elaboration.top_,
       CreateNewStyleProcInstance(top, /*proc_instantiation=*/std::nullopt, path,
-                                 interface_bindings));
+                                 interface_bindings, elaboration.shared_data_));
 
   for (const std::unique_ptr<ChannelInstance>& channel_instance :
        elaboration.interface_channel_instances_) {
@@ -301,10 +366,20 @@ absl::Status ProcElaboration::BuildInstanceMaps(ProcInstance* proc_instance) {
       elaboration.procs_.push_back(proc_instance->proc());
     }
   }
+  elaboration.AssignInstanceIds();
 
   return elaboration;
 }
 
+void ProcElaboration::AssignInstanceIds() {
+  for (int64_t i = 0; i < proc_instance_ptrs_.size(); ++i) {
+    proc_instance_ptrs_[i]->id_ = i;
+  }
+  for (int64_t i = 0; i < channel_instance_ptrs_.size(); ++i) {
+    channel_instance_ptrs_[i]->id = i;
+  }
+}
+
 std::string ProcElaboration::ToString() const {
   if (top_ != nullptr) {
     // New-style procs.
@@ -338,14 +413,18 @@ absl::StatusOr<ProcInstance*> ProcElaboration::GetProcInstance(
 
 absl::StatusOr<ChannelInstance*> ProcElaboration::GetChannelInstance(
     std::string_view channel_name, const ProcInstantiationPath& path) const {
-  auto it = channel_instances_by_path_.find({std::string{channel_name}, path});
-  if (it == channel_instances_by_path_.end()) {
-    return absl::NotFoundError(
-        absl::StrFormat("No channel `%s` at instantiation path `%s` in "
-                        "elaboration from proc `%s`",
-                        channel_name, path.ToString(), top()->proc()->name()));
+  if (auto it = proc_instances_by_path_.find(path);
+      it != proc_instances_by_path_.end()) {
+    absl::StatusOr<ChannelInstance*> channel_instance =
+        it->second->GetChannelInstance(channel_name);
+    if (channel_instance.ok()) {
+      return channel_instance;
+    }
   }
-  return it->second;
+  return absl::NotFoundError(
+      absl::StrFormat("No channel `%s` at instantiation path `%s` in "
+                      "elaboration from proc `%s`",
+                      channel_name, path.ToString(), top()->proc()->name()));
 }
 
 absl::StatusOr<ChannelInstance*> ProcElaboration::GetChannelInstance(
@@ -373,10 +452,11 @@ ProcElaboration::ElaborateOldStylePackage(Package* package) {
   ProcElaboration elaboration;
   elaboration.package_ = package;
 
-  // All channels are available in all procs. Create a global map from channel
-  // name to channel instance and pass it to the constructor of every proc
+  // All channels are available in all procs. Create the bindings of every
+  // channel, in package order, and pass them to the constructor of every proc
   // instance.
-  absl::flat_hash_map<ChannelRef, ChannelBinding> channel_bindings;
+  std::vector<ChannelBinding> channel_bindings;
+  channel_bindings.reserve(package->channels().size());
   for (Channel* channel : package->channels()) {
     elaboration.channel_instances_.push_back(std::make_unique<ChannelInstance>(
         ChannelInstance{.channel = channel, .path = std::nullopt}));
@@ -385,14 +465,17 @@ ProcElaboration::ElaborateOldStylePackage(Package* package) {
 
     elaboration.channel_instance_ptrs_.push_back(channel_instance);
     elaboration.instances_of_channel_[channel] = {channel_instance};
-    channel_bindings[channel] = ChannelBinding{
-        .instance = channel_instance, .parent_reference = std::nullopt};
+    channel_bindings.push_back(ChannelBinding{
+        .instance = channel_instance, .parent_reference = std::nullopt});
   }
 
   for (const std::unique_ptr<Proc>& proc : package->procs()) {
     XLS_RET_CHECK(!proc->is_new_style_proc());
+    XLS_ASSIGN_OR_RETURN(
+        const SharedProcData* proc_data,
+        GetSharedProcData(proc.get(), elaboration.shared_data_));
     elaboration.proc_instances_.push_back(std::make_unique<ProcInstance>(
-        proc.get(), /*proc_instantiation=*/std::nullopt,
+        proc_data, /*proc_instantiation=*/std::nullopt,
         /*path=*/std::nullopt,
         /*channel_instances=*/std::vector<std::unique_ptr<ChannelInstance>>(),
         /*instantiated_procs=*/std::vector<std::unique_ptr<ProcInstance>>(),
@@ -405,6 +488,7 @@ ProcElaboration::ElaborateOldStylePackage(Package* package) {
 
     elaboration.procs_.push_back(proc.get());
   }
+  elaboration.AssignInstanceIds();
 
   return std::move(elaboration);
 }
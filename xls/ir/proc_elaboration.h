@@ -92,6 +92,10 @@ struct ChannelInstance {
   // defined. Is nullopt for old-style channels.
   std::optional<ProcInstantiationPath> path;
 
+  // The index of this channel instance in
+  // ProcElaboration::channel_instances().
+  int64_t id = 0;
+
   std::string ToString() const;
 };
 
@@ -111,19 +115,77 @@ struct ChannelBinding {
   std::optional<ChannelReference*> parent_reference;
 };
 
+// Structure of a proc which does not depend on where the proc is
+// instantiated. It is computed once per proc and shared by all instances of the
+// proc in an elaboration.
+//
+// Each proc instance holds one channel binding per channel reference of the
+// proc (new style) or per channel in the package (old style). This class maps
+// channel references and channels to the index of their binding.
+class SharedProcData {
+ public:
+  static absl::StatusOr<std::unique_ptr<SharedProcData>> Create(Proc* proc);
+
+  Proc* proc() const { return proc_; }
+
+  // The number of channel bindings in each instance of the proc.
+  int64_t binding_count() const { return binding_count_; }
+
+  // Returns the index of the binding of the given channel reference (new
+  // style) or channel (old style).
+  int64_t GetBindingIndex(ChannelRef channel_ref) const {
+    return binding_indices_.at(channel_ref);
+  }
+
+  // Returns the index of the binding of the channel reference (new style) or
+  // channel (old style) with the given name.
+  std::optional<int64_t> FindBindingIndex(std::string_view name) const;
+
+  // For each channel declared in the proc, the binding indices of its send and
+  // receive channel references. Only for new-style procs.
+  absl::Span<const std::pair<int64_t, int64_t>> declared_channel_bindings()
+      const {
+    return declared_channel_bindings_;
+  }
+
+  // For each proc instantiation in the proc, the binding indices of the
+  // channel arguments of the instantiation. Only for new-style procs.
+  absl::Span<const std::vector<int64_t>> instantiation_arg_bindings() const {
+    return instantiation_arg_bindings_;
+  }
+
+ private:
+  explicit SharedProcData(Proc* proc) : proc_(proc) {}
+
+  Proc* proc_;
+  int64_t binding_count_ = 0;
+  absl::flat_hash_map<ChannelRef, int64_t> binding_indices_;
+  absl::flat_hash_map<std::string, int64_t> binding_indices_by_name_;
+  std::vector<std::pair<int64_t, int64_t>> declared_channel_bindings_;
+  std::vector<std::vector<int64_t>> instantiation_arg_bindings_;
+};
+
 // Representation of an instance of a proc. This is a recursive data structure
 // which also holds all channel and proc instances instantiated by this proc
 // instance including recursively.
 class ProcInstance {
  public:
-  ProcInstance(
-      Proc* proc, std::optional<ProcInstantiation*> proc_instantiation,
-      std::optional<ProcInstantiationPath> path,
-      std::vector<std::unique_ptr<ChannelInstance>> channel_instances,
-      std::vector<std::unique_ptr<ProcInstance>> instantiated_procs,
-      absl::flat_hash_map<ChannelRef, ChannelBinding> channel_bindings);
+  // `channel_bindings` holds the binding of each channel reference (or
+  // channel) indexed as described by `shared_data`.
+  ProcInstance(const SharedProcData* shared_data,
+               std::optional<ProcInstantiation*> proc_instantiation,
+               std::optional<ProcInstantiationPath> path,
+               std::vector<std::unique_ptr<ChannelInstance>> channel_instances,
+               std::vector<std::unique_ptr<ProcInstance>> instantiated_procs,
+               std::vector<ChannelBinding> channel_bindings);
 
-  Proc* proc() const { return proc_; }
+  Proc* proc() const { return shared_data_->proc(); }
+
+  // Data shared by all instances of proc().
+  const SharedProcData* shared_data() const { return shared_data_; }
+
+  // The index of this proc instance in ProcElaboration::proc_instances().
+  int64_t id() const { return id_; }
 
   // The ProcInstantiation IR construct which instantiates this proc
   // instance. This is std::nullopt if the proc corresponding to this
@@ -159,13 +221,13 @@ class ProcInstance {
   // only.
   ChannelBinding GetChannelBinding(ChannelReference* channel_reference) const {
     CHECK(proc()->is_new_style_proc());
-    return channel_bindings_.at(channel_reference);
+    return channel_bindings_[shared_data_->GetBindingIndex(channel_reference)];
   }
 
   // Return the binding for the given channel. For old-style procs only.
   ChannelBinding GetChannelBinding(Channel* channel) const {
     CHECK(!proc()->is_new_style_proc());
-    return channel_bindings_.at(channel);
+    return channel_bindings_[shared_data_->GetBindingIndex(channel)];
   }
 
   // Returns a unique name for this proc instantiation. For new-style procs this
@@ -177,7 +239,9 @@ class ProcInstance {
   std::string ToString(int64_t indent_amount = 0) const;
 
  private:
-  Proc* proc_;
+  friend class ProcElaboration;
+
+  const SharedProcData* shared_data_;
   std::optional<ProcInstantiation*> proc_instantiation_;
   std::optional<ProcInstantiationPath> path_;
 
@@ -186,15 +250,14 @@ class ProcInstance {
   std::vector<std::unique_ptr<ChannelInstance>> channel_instances_;
   std::vector<std::unique_ptr<ProcInstance>> instantiated_procs_;
 
-  // Map from ChannelRef (variant of ChannelReference and Channel) to the
-  // channel binding. For old-style procs this contains *all* channels as all
-  // channels are referenceable in all procs. For new-style procs this contains
-  // only the channel references in this proc.
-  absl::flat_hash_map<ChannelRef, ChannelBinding> channel_bindings_;
+  // The channel bindings indexed as described by shared_data_. For old-style
+  // procs this contains *all* channels as all channels are referenceable in
+  // all procs. For new-style procs this contains only the channel references
+  // in this proc.
+  std::vector<ChannelBinding> channel_bindings_;
 
-  // Map from channel reference name to channel instance for all channel
-  // references in the proc.
-  absl::flat_hash_map<std::string, ChannelInstance*> channel_name_map_;
+  // Set by the elaboration once all instances have been created.
+  int64_t id_ = 0;
 };
 
 // Data structure representing the elaboration tree.
@@ -272,6 +335,9 @@ class ProcElaboration {
   // should be called for new-style procs.
   absl::Status BuildInstanceMaps(ProcInstance* proc_instance);
 
+  // Assigns the ids of the proc and channel instances.
+  void AssignInstanceIds();
+
   Package* package_;
 
   // For a new-style proc, this is the top-level instantiation. All other
@@ -300,16 +366,16 @@ class ProcElaboration {
   // Channel instances for the interface channels.
   std::vector<std::unique_ptr<ChannelInstance>> interface_channel_instances_;
 
+  // The structure shared by the instances of each proc. Unique pointers are
+  // used for pointer stability as the instances hold pointers to these objects.
+  absl::flat_hash_map<Proc*, std::unique_ptr<SharedProcData>> shared_data_;
+
   // All proc instances in the elaboration indexed by instantiation path.
+  // Channel instances are resolved through the proc instance holding the
+  // channel reference.
   absl::flat_hash_map<ProcInstantiationPath, ProcInstance*>
       proc_instances_by_path_;
 
-  // All channel instances in the elaboration indexed by channel reference name
-  // (new style) or channel name (old style) and instantiation path.
-  absl::flat_hash_map<std::pair<std::string, ProcInstantiationPath>,
-                      ChannelInstance*>
-      channel_instances_by_path_;
-
   // List of instances of each Proc/Channel.
   absl::flat_hash_map<Proc*, std::vector<ProcInstance*>> instances_of_proc_;
   absl::flat_hash_map<Channel*, std::vector<ChannelInstance*>>
@@ -320,6 +320,59 @@ TEST_F(ElaborationTest, MultipleInstantiations) {
   leaf<leaf_ch0=ch0, leaf_ch1=ch1> [top_proc_inst2])");
 }
 
+TEST_F(ElaborationTest, InstanceIdsAndSharedProcData) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * leaf_proc,
+      CreateLeafProc("leaf", /*input_channel_count=*/2, p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * top,
+      CreateMultipleInstantiationProc(
+          "top_proc", /*input_channel_count=*/2,
+          /*instantiated_channel_count=*/2, {leaf_proc, leaf_proc}, p.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elab,
+                           ProcElaboration::Elaborate(top));
+
+  for (int64_t i = 0; i < elab.proc_instances().size(); ++i) {
+    EXPECT_EQ(elab.proc_instances()[i]->id(), i);
+  }
+  for (int64_t i = 0; i < elab.channel_instances().size(); ++i) {
+    EXPECT_EQ(elab.channel_instances()[i]->id, i);
+  }
+
+  // Both instances of the leaf proc share its structure but have their own
+  // channel bindings.
+  absl::Span<ProcInstance* const> leaf_instances =
+      elab.GetInstances(leaf_proc);
+  ASSERT_EQ(leaf_instances.size(), 2);
+  EXPECT_EQ(leaf_instances[0]->shared_data(), leaf_instances[1]->shared_data());
+  EXPECT_NE(leaf_instances[0]->shared_data(), elab.top()->shared_data());
+  EXPECT_EQ(leaf_instances[0]->shared_data()->binding_count(), 2);
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelInstance * channel0,
+                           leaf_instances[0]->GetChannelInstance("leaf_ch0"));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelInstance * channel1,
+                           leaf_instances[1]->GetChannelInstance("leaf_ch0"));
+  EXPECT_EQ(channel0->channel->name(), "ch0");
+  EXPECT_EQ(channel0, channel1);
+  EXPECT_EQ(leaf_instances[0]->GetChannelBinding(leaf_proc->interface()[0])
+                .parent_reference.value()
+                ->name(),
+            "ch0");
+
+  // Channel instances are resolved through the proc instance at the path.
+  EXPECT_THAT(elab.GetChannelInstance("leaf_ch0", *leaf_instances[1]->path()),
+              IsOkAndHolds(channel1));
+  ChannelInstance* leaf_ch1 =
+      leaf_instances[1]->GetChannelBinding(leaf_proc->interface()[1]).instance;
+  EXPECT_THAT(
+      elab.GetChannelInstance("leaf_ch1", "top_proc::top_proc_inst1->leaf"),
+      IsOkAndHolds(leaf_ch1));
+  EXPECT_THAT(elab.GetChannelInstance("nope", *leaf_instances[1]->path()),
+              StatusIs(absl::StatusCode::kNotFound,
+                       HasSubstr("No channel `nope` at instantiation path")));
+}
+
 TEST_F(ElaborationTest, ProcInstantiatingProcWithNoChannels) {
   auto p = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(
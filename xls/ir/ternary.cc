@@ -102,6 +102,43 @@ absl::StatusOr<TernaryVector> StringToTernaryVector(std::string_view s) {
   return result;
 }
 
+PackedTernaryVector::PackedTernaryVector(InlineBitmap known,
+                                         InlineBitmap known_one)
+    : known_(std::move(known)), known_one_(std::move(known_one)) {
+  CHECK_EQ(known_.bit_count(), known_one_.bit_count());
+  for (int64_t i = 0; i < known_.word_count(); ++i) {
+    DCHECK_EQ(known_one_.GetWord(i) & ~known_.GetWord(i), 0)
+        << "Known-one bits must be a subset of known bits";
+  }
+}
+
+/* static */ PackedTernaryVector PackedTernaryVector::FromTernary(
+    TernarySpan ternary) {
+  InlineBitmap known(ternary.size());
+  InlineBitmap known_one(ternary.size());
+  for (int64_t i = 0; i < ternary.size(); ++i) {
+    if (ternary[i] != TernaryValue::kUnknown) {
+      known.Set(i, true);
+      known_one.Set(i, ternary[i] == TernaryValue::kKnownOne);
+    }
+  }
+  return PackedTernaryVector(std::move(known), std::move(known_one));
+}
+
+/* static */ PackedTernaryVector PackedTernaryVector::FromBits(
+    const Bits& bits) {
+  return PackedTernaryVector(InlineBitmap(bits.bit_count(), /*fill=*/true),
+                             bits.bitmap());
+}
+
+TernaryVector PackedTernaryVector::ToTernary() const {
+  TernaryVector result(bit_count());
+  for (int64_t i = 0; i < bit_count(); ++i) {
+    result[i] = Get(i);
+  }
+  return result;
+}
+
 namespace ternary_ops {
 
 TernaryVector FromKnownBits(const Bits& known_bits,
@@ -264,6 +301,105 @@ TernaryVector BitsToTernary(const Bits& bits) {
   return result;
 }
 
+namespace {
+
+// Builds a packed vector word by word from the known-zero and known-one masks
+// computed by `f(wordno)`.
+template <typename F>
+PackedTernaryVector BuildPacked(int64_t bit_count, F f) {
+  InlineBitmap known(bit_count);
+  InlineBitmap known_one(bit_count);
+  for (int64_t i = 0; i < known.word_count(); ++i) {
+    auto [zero, one] = f(i);
+    known.SetWord(i, zero | one);
+    known_one.SetWord(i, one);
+  }
+  return PackedTernaryVector(std::move(known), std::move(known_one));
+}
+
+uint64_t KnownZeroWord(const PackedTernaryVector& v, int64_t wordno) {
+  return v.known().GetWord(wordno) & ~v.known_one().GetWord(wordno);
+}
+
+}  // namespace
+
+PackedTernaryVector And(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b) {
+  CHECK_EQ(a.bit_count(), b.bit_count());
+  return BuildPacked(a.bit_count(), [&](int64_t i) {
+    return std::make_pair(KnownZeroWord(a, i) | KnownZeroWord(b, i),
+                          a.known_one().GetWord(i) & b.known_one().GetWord(i));
+  });
+}
+
+PackedTernaryVector Or(const PackedTernaryVector& a,
+                       const PackedTernaryVector& b) {
+  CHECK_EQ(a.bit_count(), b.bit_count());
+  return BuildPacked(a.bit_count(), [&](int64_t i) {
+    return std::make_pair(KnownZeroWord(a, i) & KnownZeroWord(b, i),
+                          a.known_one().GetWord(i) | b.known_one().GetWord(i));
+  });
+}
+
+PackedTernaryVector Xor(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b) {
+  CHECK_EQ(a.bit_count(), b.bit_count());
+  return BuildPacked(a.bit_count(), [&](int64_t i) {
+    uint64_t known = a.known().GetWord(i) & b.known().GetWord(i);
+    uint64_t one =
+        (a.known_one().GetWord(i) ^ b.known_one().GetWord(i)) & known;
+    return std::make_pair(known & ~one, one);
+  });
+}
+
+PackedTernaryVector Not(const PackedTernaryVector& a) {
+  return BuildPacked(a.bit_count(), [&](int64_t i) {
+    return std::make_pair(a.known_one().GetWord(i), KnownZeroWord(a, i));
+  });
+}
+
+PackedTernaryVector Add(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b) {
+  CHECK_EQ(a.bit_count(), b.bit_count());
+  // Every realization of an operand lies between its minimum (unknown bits
+  // zero) and its maximum (unknown bits one). The carry into a bit is
+  // monotonic in the operands, so it is known exactly when the minimal and
+  // maximal sums agree on it. A sum bit is then known when both operand bits
+  // and the carry into it are known.
+  uint64_t carry_min = 0;
+  uint64_t carry_max = 0;
+  return BuildPacked(a.bit_count(), [&](int64_t i) {
+    uint64_t min_a = a.known_one().GetWord(i);
+    uint64_t min_b = b.known_one().GetWord(i);
+    uint64_t max_a = min_a | ~a.known().GetWord(i);
+    uint64_t max_b = min_b | ~b.known().GetWord(i);
+    uint64_t sum_min = min_a + min_b + carry_min;
+    uint64_t sum_max = max_a + max_b + carry_max;
+    uint64_t carries_min = sum_min ^ min_a ^ min_b;
+    uint64_t carries_max = sum_max ^ max_a ^ max_b;
+    carry_min = (sum_min < min_a || (carry_min != 0 && sum_min == min_a));
+    carry_max = (sum_max < max_a || (carry_max != 0 && sum_max == max_a));
+    uint64_t known = a.known().GetWord(i) & b.known().GetWord(i) &
+                     ~(carries_min ^ carries_max);
+    return std::make_pair(known & ~sum_min, known & sum_min);
+  });
+}
+
+TernaryValue Equals(const PackedTernaryVector& a,
+                    const PackedTernaryVector& b) {
+  CHECK_EQ(a.bit_count(), b.bit_count());
+  for (int64_t i = 0; i < a.word_count(); ++i) {
+    uint64_t known = a.known().GetWord(i) & b.known().GetWord(i);
+    if (((a.known_one().GetWord(i) ^ b.known_one().GetWord(i)) & known) !=
+        0) {
+      return TernaryValue::kKnownZero;
+    }
+  }
+  return a.known().IsAllOnes() && b.known().IsAllOnes()
+             ? TernaryValue::kKnownOne
+             : TernaryValue::kUnknown;
+}
+
 /* static */ std::vector<int64_t> RealizedTernaryIterator::FindUnknownOffsets(
     TernarySpan span) {
   std::vector<int64_t> result;
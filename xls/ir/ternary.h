@@ -32,6 +32,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/common/iterator_range.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/ir/bits.h"
 
 namespace xls {
@@ -66,6 +67,51 @@ inline std::ostream& operator<<(std::ostream& os, TernarySpan vector) {
   return os;
 }
 
+// A ternary vector packed into two bitmaps rather than one byte per element:
+// `known` has a bit set for each known element and `known_one` has a bit set
+// for each element known to be one (always a subset of `known`). Operations on
+// packed vectors process 64 elements at a time, which is much faster than
+// TernaryVector for wide values.
+class PackedTernaryVector {
+ public:
+  // Creates a vector of `bit_count` unknown elements.
+  explicit PackedTernaryVector(int64_t bit_count)
+      : known_(bit_count), known_one_(bit_count) {}
+
+  // `known_one` must be a subset of `known`.
+  PackedTernaryVector(InlineBitmap known, InlineBitmap known_one);
+
+  static PackedTernaryVector FromTernary(TernarySpan ternary);
+  static PackedTernaryVector FromBits(const Bits& bits);
+
+  TernaryVector ToTernary() const;
+
+  int64_t bit_count() const { return known_.bit_count(); }
+  int64_t word_count() const { return known_.word_count(); }
+
+  TernaryValue Get(int64_t index) const {
+    if (!known_.Get(index)) {
+      return TernaryValue::kUnknown;
+    }
+    return known_one_.Get(index) ? TernaryValue::kKnownOne
+                                 : TernaryValue::kKnownZero;
+  }
+
+  const InlineBitmap& known() const { return known_; }
+  const InlineBitmap& known_one() const { return known_one_; }
+
+  bool operator==(const PackedTernaryVector& other) const {
+    return known_ == other.known_ && known_one_ == other.known_one_;
+  }
+  bool operator!=(const PackedTernaryVector& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  InlineBitmap known_;
+  InlineBitmap known_one_;
+};
+
 namespace ternary_ops {
 
 // Returns a vector with known bits as represented in `known_bits`, with values
@@ -164,6 +210,24 @@ inline TernaryValue Or(const TernaryValue& a, const TernaryValue& b) {
 
 TernaryVector BitsToTernary(const Bits& bits);
 
+// Word-at-a-time ternary operations on packed vectors. The results are exactly
+// those of applying the element-wise ternary operations (or, for Add, a ripple
+// carry adder built from them). CHECK fails if the operands have different
+// lengths.
+PackedTernaryVector And(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b);
+PackedTernaryVector Or(const PackedTernaryVector& a,
+                       const PackedTernaryVector& b);
+PackedTernaryVector Xor(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b);
+PackedTernaryVector Not(const PackedTernaryVector& a);
+PackedTernaryVector Add(const PackedTernaryVector& a,
+                        const PackedTernaryVector& b);
+
+// Returns whether `a` and `b` are known to be equal (kKnownOne), known to
+// differ (kKnownZero), or neither.
+TernaryValue Equals(const PackedTernaryVector& a, const PackedTernaryVector& b);
+
 // An iterator of possible ternary values.
 class RealizedTernaryIterator {
  public:
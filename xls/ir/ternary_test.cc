@@ -15,6 +15,7 @@
 #include "xls/ir/ternary.h"
 
 #include <optional>
+#include <string_view>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -63,6 +64,53 @@ TEST(Ternary, NumberOfKnownBits) {
   EXPECT_EQ(ternary_ops::NumberOfKnownBits(TernaryVector()), 0);
 }
 
+TEST(Ternary, PackedTernaryVector) {
+  TernaryVector vector = *StringToTernaryVector("0b1101X1X001");
+  PackedTernaryVector packed = PackedTernaryVector::FromTernary(vector);
+  EXPECT_EQ(packed.bit_count(), 10);
+  EXPECT_EQ(packed.ToTernary(), vector);
+  EXPECT_EQ(packed.Get(0), TernaryValue::kKnownOne);
+  EXPECT_EQ(packed.Get(1), TernaryValue::kKnownZero);
+  EXPECT_EQ(packed.Get(3), TernaryValue::kUnknown);
+  EXPECT_EQ(packed.known(), UBits(0b1111010111, 10).bitmap());
+  EXPECT_EQ(packed.known_one(), UBits(0b1101010001, 10).bitmap());
+
+  EXPECT_EQ(PackedTernaryVector(3).ToTernary(),
+            *StringToTernaryVector("0bXXX"));
+  EXPECT_EQ(PackedTernaryVector::FromBits(UBits(0b10, 2)).ToTernary(),
+            *StringToTernaryVector("0b10"));
+  EXPECT_EQ(PackedTernaryVector::FromTernary(TernaryVector()).bit_count(), 0);
+}
+
+TEST(Ternary, PackedOps) {
+  auto packed = [](std::string_view s) {
+    return PackedTernaryVector::FromTernary(*StringToTernaryVector(s));
+  };
+  EXPECT_EQ(ternary_ops::And(packed("0b01X01X01X"), packed("0b000111XXX")),
+            packed("0b00001X0XX"));
+  EXPECT_EQ(ternary_ops::Or(packed("0b01X01X01X"), packed("0b000111XXX")),
+            packed("0b01X111X1X"));
+  EXPECT_EQ(ternary_ops::Xor(packed("0b01X01X01X"), packed("0b000111XXX")),
+            packed("0b01X10XXXX"));
+  EXPECT_EQ(ternary_ops::Not(packed("0b01X")), packed("0b10X"));
+
+  // Unknown bits only make the bits above them unknown as far as a carry can
+  // propagate.
+  EXPECT_EQ(ternary_ops::Add(packed("0b0000X"), packed("0b00001")),
+            packed("0b000XX"));
+  EXPECT_EQ(ternary_ops::Add(packed("0b0111"), packed("0b00X1")),
+            packed("0b10X0"));
+  EXPECT_EQ(ternary_ops::Add(packed("0b0X01"), packed("0b0001")),
+            packed("0b0X10"));
+
+  EXPECT_EQ(ternary_ops::Equals(packed("0b1X0"), packed("0b0X0")),
+            TernaryValue::kKnownZero);
+  EXPECT_EQ(ternary_ops::Equals(packed("0b1X0"), packed("0b1X0")),
+            TernaryValue::kUnknown);
+  EXPECT_EQ(ternary_ops::Equals(packed("0b110"), packed("0b110")),
+            TernaryValue::kKnownOne);
+}
+
 MATCHER_P(ToVector, m,
           testing::DescribeMatcher<std::vector<Bits>>(m, negation)) {
   return testing::ExplainMatchResult(
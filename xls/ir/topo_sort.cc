@@ -17,22 +17,27 @@
 #include <algorithm>
 #include <cstdint>
 #include <deque>
+#include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "xls/ir/dense_node_map.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 
 namespace xls {
+namespace {
 
-std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
+std::vector<Node*> ComputeReverseTopoSort(FunctionBase* f) {
   // For topological traversal we only add nodes to the order when all of its
   // users have been scheduled.
   //
@@ -48,7 +53,7 @@ std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
   //
   // NOTE: sorts reverse-topologically.  To sort topologically, reverse the
   // result.
-  absl::flat_hash_map<Node*, int64_t> pending_to_remaining_users;
+  DenseNodeMap<int64_t> pending_to_remaining_users;
   pending_to_remaining_users.reserve(f->node_count());
   std::deque<Node*> ready;
 
@@ -67,7 +72,8 @@ std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
   };
   auto bump_down_remaining_users = [&](Node* n) {
     CHECK(!n->users().empty());
-    auto result = pending_to_remaining_users.insert({n, n->users().size()});
+    auto result =
+        pending_to_remaining_users.try_emplace(n, n->users().size());
     auto it = result.first;
     int64_t& remaining_users = it->second;
     CHECK_GT(remaining_users, 0);
@@ -80,7 +86,7 @@ std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
     }
   };
 
-  absl::flat_hash_set<Node*> seen_operands;
+  DenseNodeSet seen_operands;
   auto add_to_order = [&](Node* r) {
     VLOG(5) << "Adding node to order: " << r;
     DCHECK(all_users_scheduled(r)) << r << " users size: " << r->users().size();
@@ -96,7 +102,7 @@ std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
     // operands sequence.
     for (auto it = r->operands().rbegin(); it != r->operands().rend(); ++it) {
       Node* operand = *it;
-      if (auto [_, inserted] = seen_operands.insert(operand); inserted) {
+      if (seen_operands.insert(operand)) {
         bump_down_remaining_users(operand);
       }
     }
@@ -104,7 +110,7 @@ std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
 
   auto seed_ready = [&](Node* n) {
     ready.push_front(n);
-    CHECK(pending_to_remaining_users.insert({n, -1}).second);
+    CHECK(pending_to_remaining_users.try_emplace(n, -1).second);
   };
 
   auto is_return_value = [&](Node* n) {
@@ -155,10 +161,103 @@ std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
   return ordered;
 }
 
+}  // namespace
+
+std::vector<Node*> ReverseTopoSort(FunctionBase* f) {
+  return f->GetCachedReverseTopoOrder(
+      [f]() { return ComputeReverseTopoSort(f); });
+}
+
 std::vector<Node*> TopoSort(FunctionBase* f) {
   std::vector<Node*> ordered = ReverseTopoSort(f);
   std::reverse(ordered.begin(), ordered.end());
   return ordered;
 }
 
+std::vector<Node*> TopoSortTransitiveUsers(absl::Span<Node* const> nodes) {
+  // Gather the transitive users. The value of the map is the number of
+  // (unique) operands of the node which are in the subgraph and have not yet
+  // been placed in the order.
+  absl::flat_hash_map<Node*, int64_t> remaining_operands;
+  std::vector<Node*> worklist(nodes.begin(), nodes.end());
+  for (Node* node : nodes) {
+    remaining_operands.insert({node, 0});
+  }
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    for (Node* user : node->users()) {
+      if (remaining_operands.insert({user, 0}).second) {
+        worklist.push_back(user);
+      }
+    }
+  }
+  absl::flat_hash_set<Node*> seen_operands;
+  for (auto& [node, count] : remaining_operands) {
+    seen_operands.clear();
+    for (Node* operand : node->operands()) {
+      if (remaining_operands.contains(operand) &&
+          seen_operands.insert(operand).second) {
+        ++count;
+      }
+    }
+  }
+
+  // Kahn's algorithm over the subgraph. Ready nodes are visited in order of
+  // node id for stability.
+  std::vector<Node*> ready;
+  for (const auto& [node, count] : remaining_operands) {
+    if (count == 0) {
+      ready.push_back(node);
+    }
+  }
+  std::sort(ready.begin(), ready.end(), Node::NodeIdLessThan());
+  std::reverse(ready.begin(), ready.end());
+
+  std::vector<Node*> ordered;
+  ordered.reserve(remaining_operands.size());
+  while (!ready.empty()) {
+    Node* node = ready.back();
+    ready.pop_back();
+    ordered.push_back(node);
+    // Users are sorted by node id. Push in reverse so the lowest id is visited
+    // first.
+    for (auto it = node->users().rbegin(); it != node->users().rend(); ++it) {
+      int64_t& count = remaining_operands.at(*it);
+      CHECK_GT(count, 0);
+      if (--count == 0) {
+        ready.push_back(*it);
+      }
+    }
+  }
+  CHECK_EQ(ordered.size(), remaining_operands.size())
+      << "Expected acyclic graph";
+  return ordered;
+}
+
+std::vector<Node*> TopoSortTransitiveOperands(
+    Node* node, absl::FunctionRef<bool(Node*)> exclude) {
+  std::vector<Node*> ordered;
+  if (exclude(node)) {
+    return ordered;
+  }
+  // Iterative post-order DFS. Each stack entry holds a node and the index of
+  // the next operand to visit.
+  absl::flat_hash_set<Node*> visited = {node};
+  std::vector<std::pair<Node*, int64_t>> stack = {{node, 0}};
+  while (!stack.empty()) {
+    auto& [current, operand_index] = stack.back();
+    if (operand_index == current->operand_count()) {
+      ordered.push_back(current);
+      stack.pop_back();
+      continue;
+    }
+    Node* operand = current->operand(operand_index++);
+    if (!exclude(operand) && visited.insert(operand).second) {
+      stack.push_back({operand, 0});
+    }
+  }
+  return ordered;
+}
+
 }  // namespace xls
@@ -17,6 +17,8 @@
 
 #include <vector>
 
+#include "absl/functional/function_ref.h"
+#include "absl/types/span.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 
@@ -32,12 +34,26 @@ namespace xls {
 // satisfied).
 //
 // Note that the ordering for all nodes is computed up front, *not*
-// incrementally as iteration proceeds.
+// incrementally as iteration proceeds. The order is cached on the function and
+// reused until the graph is next modified (see FunctionBase::graph_version).
 std::vector<Node*> TopoSort(FunctionBase* f);
 
 // As above, but returns a reverse topo order.
 std::vector<Node*> ReverseTopoSort(FunctionBase* f);
 
+// Returns the given nodes and all of their transitive users in a stable
+// topological order. This is the set of nodes whose values may depend on the
+// given nodes. Only this subgraph is traversed so this is cheap relative to
+// TopoSort when the nodes have few users.
+std::vector<Node*> TopoSortTransitiveUsers(absl::Span<Node* const> nodes);
+
+// Returns `node` and its transitive operands in a topological order, omitting
+// the nodes for which `exclude` returns true. The operands of omitted nodes are
+// not traversed. This is the set of nodes which must be evaluated to compute
+// the value of `node` when the values of the omitted nodes are known.
+std::vector<Node*> TopoSortTransitiveOperands(
+    Node* node, absl::FunctionRef<bool(Node*)> exclude);
+
 }  // namespace xls
 
 #endif  // XLS_IR_NODE_ITERATOR_H_
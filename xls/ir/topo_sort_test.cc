@@ -290,6 +290,120 @@ TEST(NodeIteratorTest, RpoVsTopo) {
 
 // LINT.ThenChange(//xls/ir/block_elaboration_test.cc)
 
+TEST(NodeIteratorTest, TransitiveUsers) {
+  std::string program = R"(
+  fn f(x: bits[32], y: bits[32]) -> bits[32] {
+    neg.1: bits[32] = neg(x)
+    not.2: bits[32] = not(y)
+    add.3: bits[32] = add(neg.1, not.2)
+    umul.4: bits[32] = umul(add.3, neg.1)
+    ret sub.5: bits[32] = sub(umul.4, umul.4)
+  })";
+
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, Parser::ParseFunction(program, &p));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * neg, f->GetNode("neg.1"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * not_node, f->GetNode("not.2"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * add, f->GetNode("add.3"));
+
+  auto names = [](absl::Span<Node* const> nodes) {
+    std::vector<std::string> result;
+    for (Node* node : nodes) {
+      result.push_back(node->GetName());
+    }
+    return result;
+  };
+  EXPECT_EQ(names(TopoSortTransitiveUsers({neg})),
+            (std::vector<std::string>{"neg.1", "add.3", "umul.4", "sub.5"}));
+  EXPECT_EQ(names(TopoSortTransitiveUsers({add, not_node})),
+            (std::vector<std::string>{"not.2", "add.3", "umul.4", "sub.5"}));
+  EXPECT_TRUE(TopoSortTransitiveUsers({}).empty());
+}
+
+TEST(NodeIteratorTest, TransitiveOperands) {
+  std::string program = R"(
+  fn f(x: bits[32], y: bits[32]) -> bits[32] {
+    neg.1: bits[32] = neg(x)
+    not.2: bits[32] = not(y)
+    add.3: bits[32] = add(neg.1, not.2)
+    umul.4: bits[32] = umul(add.3, neg.1)
+    ret sub.5: bits[32] = sub(umul.4, umul.4)
+  })";
+
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, Parser::ParseFunction(program, &p));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * neg, f->GetNode("neg.1"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * add, f->GetNode("add.3"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * sub, f->GetNode("sub.5"));
+
+  auto names = [](absl::Span<Node* const> nodes) {
+    std::vector<std::string> result;
+    for (Node* node : nodes) {
+      result.push_back(node->GetName());
+    }
+    return result;
+  };
+  auto exclude_none = [](Node*) { return false; };
+  EXPECT_EQ(names(TopoSortTransitiveOperands(add, exclude_none)),
+            (std::vector<std::string>{"x", "neg.1", "y", "not.2", "add.3"}));
+  EXPECT_EQ(names(TopoSortTransitiveOperands(sub, exclude_none)),
+            (std::vector<std::string>{"x", "neg.1", "y", "not.2", "add.3",
+                                      "umul.4", "sub.5"}));
+  EXPECT_EQ(
+      names(TopoSortTransitiveOperands(sub, [&](Node* n) { return n == add; })),
+      (std::vector<std::string>{"x", "neg.1", "umul.4", "sub.5"}));
+  EXPECT_TRUE(
+      TopoSortTransitiveOperands(neg, [&](Node* n) { return n == neg; })
+          .empty());
+}
+
+TEST(NodeIteratorTest, CachedOrderFollowsGraphChanges) {
+  std::string program = R"(
+  fn computation(a: bits[32]) -> bits[32] {
+    t: bits[32] = neg(a)
+    b: bits[32] = neg(a)
+    c: bits[32] = neg(b)
+    ret d: bits[32] = add(c, t)
+  })";
+
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, Parser::ParseFunction(program, &p));
+  auto names = [](absl::Span<Node* const> nodes) {
+    std::vector<std::string> result;
+    for (Node* node : nodes) {
+      result.push_back(node->GetName());
+    }
+    return result;
+  };
+
+  int64_t version = f->graph_version();
+  EXPECT_EQ(names(TopoSort(f)),
+            (std::vector<std::string>{"a", "b", "c", "t", "d"}));
+  EXPECT_EQ(names(TopoSort(f)),
+            (std::vector<std::string>{"a", "b", "c", "t", "d"}));
+  EXPECT_EQ(names(ReverseTopoSort(f)),
+            (std::vector<std::string>{"d", "t", "c", "b", "a"}));
+  EXPECT_EQ(f->graph_version(), version);
+
+  // Swapping operands changes the order without adding or removing nodes.
+  Node* d = f->return_value();
+  d->SwapOperands(0, 1);
+  EXPECT_NE(f->graph_version(), version);
+  EXPECT_EQ(names(TopoSort(f)),
+            (std::vector<std::string>{"a", "b", "t", "c", "d"}));
+
+  // New nodes and a new return value are reflected in the order.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * e, f->MakeNodeWithName<UnOp>(SourceInfo(), d, Op::kNeg, "e"));
+  EXPECT_EQ(names(TopoSort(f)),
+            (std::vector<std::string>{"a", "b", "t", "c", "d", "e"}));
+  XLS_ASSERT_OK(f->set_return_value(e));
+  XLS_ASSERT_OK(d->ReplaceUsesWith(f->param(0)));
+  XLS_ASSERT_OK(f->RemoveNode(d));
+  EXPECT_EQ(names(TopoSort(f)),
+            (std::vector<std::string>{"a", "b", "t", "c", "e"}));
+}
+
 void BM_TopoSortBinaryTree(benchmark::State& state) {
   std::unique_ptr<VerifiedPackage> p =
       std::make_unique<VerifiedPackage>("balanced_tree_pkg");
@@ -14,6 +14,7 @@
 
 #include "xls/ir/type.h"
 
+#include <atomic>
 #include <cstdint>
 #include <ostream>
 #include <string>
@@ -25,9 +26,55 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 
 namespace xls {
 
+namespace {
+
+int64_t SumFlatBitCounts(absl::Span<Type* const> types) {
+  int64_t total = 0;
+  for (const Type* type : types) {
+    total += type->GetFlatBitCount();
+  }
+  return total;
+}
+
+int64_t SumLeafCounts(absl::Span<Type* const> types) {
+  int64_t total = 0;
+  for (const Type* type : types) {
+    total += type->leaf_count();
+  }
+  return total;
+}
+
+uint64_t NextTypeUniqueId() {
+  static std::atomic<uint64_t> next_id = 0;
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+Type::Type(TypeKind kind, int64_t flat_bit_count, int64_t leaf_count)
+    : kind_(kind),
+      flat_bit_count_(flat_bit_count),
+      leaf_count_(leaf_count),
+      unique_id_(NextTypeUniqueId()) {}
+
+Type::Type(const Type& other)
+    : kind_(other.kind_),
+      flat_bit_count_(other.flat_bit_count_),
+      leaf_count_(other.leaf_count_),
+      unique_id_(NextTypeUniqueId()) {}
+
+Type& Type::operator=(const Type& other) {
+  kind_ = other.kind_;
+  flat_bit_count_ = other.flat_bit_count_;
+  leaf_count_ = other.leaf_count_;
+  unique_id_ = NextTypeUniqueId();
+  return *this;
+}
+
 std::string TypeKindToString(TypeKind type_kind) {
   switch (type_kind) {
     case TypeKind::kTuple:
@@ -102,7 +149,11 @@ bool TupleType::IsEqualTo(const Type* other) const {
     return false;
   }
   const TupleType* other_tuple = other->AsTupleOrDie();
-  if (size() != other_tuple->size()) {
+  // The cached sizes reject most structurally different tuples without
+  // recursing into the element types.
+  if (size() != other_tuple->size() ||
+      GetFlatBitCount() != other_tuple->GetFlatBitCount() ||
+      leaf_count() != other_tuple->leaf_count()) {
     return false;
   }
   for (int64_t i = 0; i < size(); ++i) {
@@ -130,6 +181,7 @@ bool ArrayType::IsEqualTo(const Type* other) const {
   }
   const ArrayType* other_array = other->AsArrayOrDie();
   return size() == other_array->size() &&
+         GetFlatBitCount() == other_array->GetFlatBitCount() &&
          element_type()->IsEqualTo(other_array->element_type());
 }
 
@@ -161,10 +213,15 @@ std::string TupleType::ToString() const {
 }
 
 BitsType::BitsType(int64_t bit_count)
-    : Type(TypeKind::kBits), bit_count_(bit_count) {
+    : Type(TypeKind::kBits, bit_count, /*leaf_count=*/1),
+      bit_count_(bit_count) {
   CHECK_GE(bit_count_, 0);
 }
 
+TupleType::TupleType(absl::Span<Type* const> members)
+    : Type(TypeKind::kTuple, SumFlatBitCounts(members), SumLeafCounts(members)),
+      members_(members.begin(), members.end()) {}
+
 std::string BitsType::ToString() const {
   return absl::StrFormat("bits[%d]", bit_count());
 }
@@ -53,6 +53,12 @@ class Type {
 
   TypeKind kind() const { return kind_; }
 
+  // Returns an identifier for this type object which is unique across the
+  // process for its lifetime and never reused, even after the type is
+  // destroyed. Caches keyed by type pointer can store it to detect that a
+  // pointer now refers to a different type.
+  uint64_t unique_id() const { return unique_id_; }
+
   // Returns true if this type and 'other' represent the same type.
   virtual bool IsEqualTo(const Type* other) const = 0;
 
@@ -78,11 +84,12 @@ class Type {
 
   // Returns the count of bits required to represent the underlying type; e.g.
   // for tuples this will be the sum of the bit count from all its members, for
-  // a "bits" type it will be the count of bits.
-  virtual int64_t GetFlatBitCount() const = 0;
+  // a "bits" type it will be the count of bits. Computed when the type is
+  // constructed so this is a constant-time query.
+  int64_t GetFlatBitCount() const { return flat_bit_count_; }
 
   // Returns the number of leaf Bits types in this object.
-  virtual int64_t leaf_count() const = 0;
+  int64_t leaf_count() const { return leaf_count_; }
 
   virtual std::string ToString() const = 0;
 
@@ -92,10 +99,16 @@ class Type {
   }
 
  protected:
-  explicit Type(TypeKind kind) : kind_(kind) {}
+  Type(TypeKind kind, int64_t flat_bit_count, int64_t leaf_count);
+  // Copies receive a fresh unique id.
+  Type(const Type& other);
+  Type& operator=(const Type& other);
 
  private:
   TypeKind kind_;
+  int64_t flat_bit_count_;
+  int64_t leaf_count_;
+  uint64_t unique_id_;
 };
 
 std::ostream& operator<<(std::ostream& os, const Type& type);
@@ -110,9 +123,6 @@ class BitsType : public Type {
 
   TypeProto ToProto() const override;
   bool IsEqualTo(const Type* other) const override;
-  int64_t GetFlatBitCount() const override { return bit_count(); }
-
-  int64_t leaf_count() const override { return 1; }
 
   // Returns a string like "bits[32]".
   std::string ToString() const override;
@@ -127,13 +137,7 @@ class BitsType : public Type {
 // Note that tuples can be empty.
 class TupleType : public Type {
  public:
-  explicit TupleType(absl::Span<Type* const> members)
-      : Type(TypeKind::kTuple), members_(members.begin(), members.end()) {
-    leaf_count_ = 0;
-    for (Type* t : members) {
-      leaf_count_ += t->leaf_count();
-    }
-  }
+  explicit TupleType(absl::Span<Type* const> members);
   ~TupleType() override = default;
   std::string ToString() const override;
 
@@ -149,18 +153,7 @@ class TupleType : public Type {
   // Returns the element types of the tuple.
   absl::Span<Type* const> element_types() const { return members_; }
 
-  int64_t leaf_count() const override { return leaf_count_; }
-
-  int64_t GetFlatBitCount() const override {
-    int64_t total = 0;
-    for (const Type* type : members_) {
-      total += type->GetFlatBitCount();
-    }
-    return total;
-  }
-
  private:
-  int64_t leaf_count_;
   std::vector<Type*> members_;
 };
 
@@ -170,7 +163,10 @@ class TupleType : public Type {
 class ArrayType : public Type {
  public:
   explicit ArrayType(int64_t size, Type* element_type)
-      : Type(TypeKind::kArray), size_(size), element_type_(element_type) {}
+      : Type(TypeKind::kArray, element_type->GetFlatBitCount() * size,
+             element_type->leaf_count() * size),
+        size_(size),
+        element_type_(element_type) {}
   ~ArrayType() override = default;
   std::string ToString() const override;
 
@@ -180,14 +176,6 @@ class ArrayType : public Type {
   Type* element_type() const { return element_type_; }
   int64_t size() const { return size_; }
 
-  int64_t GetFlatBitCount() const override {
-    return element_type_->GetFlatBitCount() * size_;
-  }
-
-  int64_t leaf_count() const override {
-    return size_ * element_type()->leaf_count();
-  }
-
  private:
   int64_t size_;
   Type* element_type_;
@@ -196,16 +184,14 @@ class ArrayType : public Type {
 // Represents a token type used for ordering channel accesses.
 class TokenType : public Type {
  public:
-  explicit TokenType() : Type(TypeKind::kToken) {}
+  // Tokens contain no bits.
+  explicit TokenType()
+      : Type(TypeKind::kToken, /*flat_bit_count=*/0, /*leaf_count=*/1) {}
   ~TokenType() override = default;
   std::string ToString() const override;
 
   TypeProto ToProto() const override;
   bool IsEqualTo(const Type* other) const override;
-
-  // Tokens contain no bits.
-  int64_t GetFlatBitCount() const override { return 0; }
-  int64_t leaf_count() const override { return 1; }
 };
 
 // Represents a type that is a function with parameters and return type.
@@ -207,5 +207,35 @@ TEST(TypeTest, AsXTypeCallsWork) {
                        HasSubstr("Type is not a tuple: bits[32][7]")));
 }
 
+TEST(TypeTest, CachedSizes) {
+  BitsType b3(3);
+  BitsType b5(5);
+  TokenType token;
+  TupleType t({&b3, &b5, &token});
+  ArrayType a(4, &t);
+  TupleType nested({&a, &b3});
+
+  EXPECT_EQ(t.GetFlatBitCount(), 8);
+  EXPECT_EQ(t.leaf_count(), 3);
+  EXPECT_EQ(a.GetFlatBitCount(), 32);
+  EXPECT_EQ(a.leaf_count(), 12);
+  EXPECT_EQ(nested.GetFlatBitCount(), 35);
+  EXPECT_EQ(nested.leaf_count(), 13);
+
+  // Tuples with the same number of elements but different sizes are not
+  // equal.
+  TupleType t_other({&b5, &b5, &token});
+  EXPECT_FALSE(t.IsEqualTo(&t_other));
+}
+
+TEST(TypeTest, UniqueIds) {
+  BitsType b1(32);
+  BitsType b2(32);
+  BitsType b1_copy(b1);
+  EXPECT_NE(b1.unique_id(), b2.unique_id());
+  EXPECT_NE(b1.unique_id(), b1_copy.unique_id());
+  EXPECT_TRUE(b1.IsEqualTo(&b1_copy));
+}
+
 }  // namespace
 }  // namespace xls
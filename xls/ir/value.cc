@@ -16,18 +16,19 @@
 
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <string>
 #include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/no_destructor.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
-#include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
@@ -204,33 +205,53 @@ bool Value::IsAllOnes() const {
   return true;
 }
 
-std::string Value::ToString(FormatPreference preference) const {
-  switch (kind_) {
+namespace {
+
+// Appends the representation of `value` to `out`. If `typed` is true then the
+// representation is as in Value::ToString, otherwise as in
+// Value::ToHumanString. The whole representation is built up in `out` rather
+// than by concatenating the representations of the elements; this matters for
+// large arrays.
+void AppendValueString(const Value& value, FormatPreference preference,
+                       bool typed, std::string* out) {
+  switch (value.kind()) {
     case ValueKind::kInvalid:
-      return "<invalid value>";
+      absl::StrAppend(out, "<invalid value>");
+      return;
     case ValueKind::kBits:
-      return absl::StrFormat("bits[%d]:%s", bits().bit_count(),
-                             BitsToString(bits(), preference));
+      if (typed) {
+        absl::StrAppend(out, "bits[", value.bits().bit_count(), "]:");
+      }
+      AppendBitsToString(value.bits(), preference, out);
+      return;
     case ValueKind::kTuple:
-      return absl::StrCat(
-          "(",
-          absl::StrJoin(elements(), ", ",
-                        [&](std::string* out, const Value& element) {
-                          absl::StrAppend(out, element.ToString(preference));
-                        }),
-          ")");
-    case ValueKind::kArray:
-      return absl::StrCat(
-          "[",
-          absl::StrJoin(elements(), ", ",
-                        [&](std::string* out, const Value& element) {
-                          absl::StrAppend(out, element.ToString(preference));
-                        }),
-          "]");
+    case ValueKind::kArray: {
+      bool is_tuple = value.kind() == ValueKind::kTuple;
+      out->push_back(is_tuple ? '(' : '[');
+      bool first = true;
+      for (const Value& element : value.elements()) {
+        if (!first) {
+          absl::StrAppend(out, ", ");
+        }
+        first = false;
+        AppendValueString(element, preference, typed, out);
+      }
+      out->push_back(is_tuple ? ')' : ']');
+      return;
+    }
     case ValueKind::kToken:
-      return "token";
+      absl::StrAppend(out, "token");
+      return;
   }
-  LOG(FATAL) << "Value has invalid kind: " << static_cast<int>(kind_);
+  LOG(FATAL) << "Value has invalid kind: " << static_cast<int>(value.kind());
+}
+
+}  // namespace
+
+std::string Value::ToString(FormatPreference preference) const {
+  std::string result;
+  AppendValueString(*this, preference, /*typed=*/true, &result);
+  return result;
 }
 
 void Value::FlattenTo(BitPushBuffer* buffer) const {
@@ -251,8 +272,14 @@ void Value::FlattenTo(BitPushBuffer* buffer) const {
   LOG(FATAL) << "Invalid value kind: " << ValueKindToString(kind_);
 }
 
+/* static */ const Value::Elements& Value::EmptyElements() {
+  static const absl::NoDestructor<Elements> kEmpty(
+      std::make_shared<const std::vector<Value>>());
+  return *kEmpty;
+}
+
 absl::StatusOr<std::vector<Value>> Value::GetElements() const {
-  if (!std::holds_alternative<std::vector<Value>>(payload_)) {
+  if (!std::holds_alternative<Elements>(payload_)) {
     return absl::InvalidArgumentError("Value does not hold elements.");
   }
   return std::vector<Value>(elements().begin(), elements().end());
@@ -267,31 +294,9 @@ absl::StatusOr<Bits> Value::GetBitsWithStatus() const {
 }
 
 std::string Value::ToHumanString(FormatPreference preference) const {
-  switch (kind_) {
-    case ValueKind::kInvalid:
-      return "<invalid value>";
-    case ValueKind::kBits:
-      return BitsToString(bits(), preference);
-    case ValueKind::kArray:
-      return absl::StrCat("[",
-                          absl::StrJoin(elements(), ", ",
-                                        [&](std::string* out, const Value& v) {
-                                          absl::StrAppend(
-                                              out, v.ToHumanString(preference));
-                                        }),
-                          "]");
-    case ValueKind::kTuple:
-      return absl::StrCat("(",
-                          absl::StrJoin(elements(), ", ",
-                                        [&](std::string* out, const Value& v) {
-                                          return absl::StrAppend(
-                                              out, v.ToHumanString(preference));
-                                        }),
-                          ")");
-    case ValueKind::kToken:
-      return "token";
-  }
-  LOG(FATAL) << "Invalid value kind: " << ValueKindToString(kind_);
+  std::string result;
+  AppendValueString(*this, preference, /*typed=*/false, &result);
+  return result;
 }
 
 bool Value::SameTypeAs(const Value& other) const {
@@ -393,7 +398,7 @@ absl::StatusOr<Value> Value::FromProto(const ValueProto& proto,
       values.reserve(proto.tuple().elements_size());
       for (const ValueProto& e : proto.tuple().elements()) {
         XLS_ASSIGN_OR_RETURN(Value element, Value::FromProto(e));
-        values.push_back(element);
+        values.push_back(std::move(element));
       }
       return Value::TupleOwned(std::move(values));
     }
@@ -408,7 +413,7 @@ absl::StatusOr<Value> Value::FromProto(const ValueProto& proto,
       values.reserve(proto.array().elements_size());
       for (const ValueProto& e : proto.array().elements()) {
         XLS_ASSIGN_OR_RETURN(Value element, Value::FromProto(e));
-        values.push_back(element);
+        values.push_back(std::move(element));
         if (values.size() != 1 && !values.front().SameTypeAs(values.back())) {
           return absl::InvalidArgumentError(absl::StrFormat(
               "Multiple different value types in array. Value %s does not "
@@ -467,6 +472,10 @@ bool Value::operator==(const Value& other) const {
   }
 
   // All non-Bits types are container types -- should have a size attribute.
+  // Copies of a value share their elements.
+  if (std::get<Elements>(payload_) == std::get<Elements>(other.payload_)) {
+    return true;
+  }
   if (size() != other.size()) {
     return false;
   }
@@ -474,4 +483,21 @@ bool Value::operator==(const Value& other) const {
   return absl::c_equal(elements(), other.elements());
 }
 
+int64_t EstimateHeapBytes(const Value& value) {
+  if (value.IsBits()) {
+    return EstimateHeapBytes(value.bits());
+  }
+  if ((!value.IsTuple() && !value.IsArray()) || value.elements().empty()) {
+    return 0;
+  }
+  // The elements are held in a vector allocated along with the control block
+  // of a shared_ptr.
+  int64_t bytes = sizeof(std::vector<Value>) + 2 * sizeof(void*) +
+                  value.elements().size() * sizeof(Value);
+  for (const Value& element : value.elements()) {
+    bytes += EstimateHeapBytes(element);
+  }
+  return bytes;
+}
+
 }  // namespace xls
@@ -17,6 +17,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -68,7 +69,7 @@ class Value {
     return Value(ValueKind::kTuple, elements);
   }
   static Value TupleOwned(std::vector<Value>&& elements) {
-    return Value(ValueKind::kTuple, elements);
+    return Value(ValueKind::kTuple, std::move(elements));
   }
 
   // All members of "elements" must be of the same type, or an error status will
@@ -106,9 +107,7 @@ class Value {
     return Value(ValueKind::kArray, std::move(elements));
   }
 
-  static Value Token() {
-    return Value(ValueKind::kToken, std::vector<Value>({}));
-  }
+  static Value Token() { return Value(ValueKind::kToken, EmptyElements()); }
   static Value Bool(bool enabled) {
     return Value(UBits(/*value=*/enabled, /*bit_count=*/1));
   }
@@ -144,7 +143,7 @@ class Value {
   absl::StatusOr<std::vector<Value>> GetElements() const;
 
   absl::Span<const Value> elements() const {
-    return std::get<std::vector<Value>>(payload_);
+    return *std::get<Elements>(payload_);
   }
   const Value& element(int64_t i) const { return elements().at(i); }
   int64_t size() const { return elements().size(); }
@@ -190,15 +189,30 @@ class Value {
   }
 
  private:
+  // The elements of a tuple, array or token. Values are immutable so the
+  // elements are shared between copies of a Value. This makes copying
+  // aggregate values (e.g., in the IR interpreter) cheap and avoids a deep copy
+  // of the element tree.
+  using Elements = std::shared_ptr<const std::vector<Value>>;
+
   Value(ValueKind kind, absl::Span<const Value> elements)
       : kind_(kind),
-        payload_(std::vector<Value>(elements.begin(), elements.end())) {}
+        payload_(std::make_shared<const std::vector<Value>>(elements.begin(),
+                                                            elements.end())) {}
 
   Value(ValueKind kind, std::vector<Value>&& elements)
+      : kind_(kind),
+        payload_(std::make_shared<const std::vector<Value>>(
+            std::move(elements))) {}
+
+  Value(ValueKind kind, Elements elements)
       : kind_(kind), payload_(std::move(elements)) {}
 
+  // Returns a shared empty element vector.
+  static const Elements& EmptyElements();
+
   ValueKind kind_;
-  std::variant<std::nullptr_t, std::vector<Value>, Bits> payload_;
+  std::variant<std::nullptr_t, Elements, Bits> payload_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Value& value) {
@@ -206,6 +220,10 @@ inline std::ostream& operator<<(std::ostream& os, const Value& value) {
   return os;
 }
 
+// Returns an estimate of the heap memory in bytes held by `value`. Elements
+// shared between copies of an aggregate value are counted in full.
+int64_t EstimateHeapBytes(const Value& value);
+
 }  // namespace xls
 
 #endif  // XLS_IR_VALUE_H_
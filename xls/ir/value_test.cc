@@ -15,17 +15,23 @@
 #include "xls/ir/value.h"
 
 #include <cstdint>
+#include <limits>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "fuzztest/fuzztest.h"
+#include "benchmark/benchmark.h"
 #include "absl/status/status.h"
 #include "absl/types/span.h"
 #include "google/protobuf/text_format.h"
 #include "google/protobuf/util/message_differencer.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/format_preference.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/xls_value.pb.h"
 
@@ -83,6 +89,43 @@ TEST(ValueTest, ToString) {
   EXPECT_EQ(token_value.ToHumanString(), "token");
 }
 
+TEST(ValueTest, ToStringWithFormatPreference) {
+  Value wide(bits_ops::Concat({UBits(0x2a, 6), UBits(0x123456789abcdef0, 64)}));
+  EXPECT_EQ(wide.ToString(), "bits[70]:0x2a_1234_5678_9abc_def0");
+  EXPECT_EQ(wide.ToHumanString(FormatPreference::kPlainHex),
+            "2a123456789abcdef0");
+  EXPECT_EQ(Value(UBits(0b1011001, 7)).ToString(FormatPreference::kBinary),
+            "bits[7]:0b101_1001");
+  EXPECT_EQ(Value(UBits(0, 65)).ToString(FormatPreference::kBinary),
+            "bits[65]:0b0");
+  EXPECT_EQ(Value(SBits(-5, 8)).ToString(FormatPreference::kSignedDecimal),
+            "bits[8]:-5");
+  EXPECT_EQ(Value(SBits(std::numeric_limits<int64_t>::min(), 64))
+                .ToHumanString(FormatPreference::kSignedDecimal),
+            "-9223372036854775808");
+  EXPECT_EQ(Value(UBits(std::numeric_limits<uint64_t>::max(), 64))
+                .ToHumanString(FormatPreference::kUnsignedDecimal),
+            "18446744073709551615");
+}
+
+TEST(ValueTest, LargeArrayToStringRoundTrips) {
+  std::vector<Value> rows;
+  for (int64_t i = 0; i < 100; ++i) {
+    std::vector<uint64_t> row;
+    for (int64_t j = 0; j < 100; ++j) {
+      row.push_back(i * 1000 + j);
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(rows.emplace_back(), Value::UBitsArray(row, 32));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Value array, Value::Array(rows));
+  for (FormatPreference preference :
+       {FormatPreference::kDefault, FormatPreference::kHex,
+        FormatPreference::kBinary}) {
+    EXPECT_THAT(Parser::ParseTypedValue(array.ToString(preference)),
+                IsOkAndHolds(array));
+  }
+}
+
 TEST(ValueTest, SameTypeAs) {
   Value b1(UBits(42, 33));
   Value b2(UBits(42, 10));
@@ -644,6 +687,28 @@ TEST(ValueTest, FromProtoArray) {
   }
 }
 
+TEST(ValueTest, CopiesShareElements) {
+  Value tuple = Value::TupleOwned(
+      {Value(UBits(1, 8)), Value::Tuple({Value(UBits(2, 16))}), Value::Token()});
+  Value copy = tuple;
+  EXPECT_EQ(copy.elements().data(), tuple.elements().data());
+  EXPECT_EQ(copy, tuple);
+
+  // Extracting an aggregate element does not copy its elements.
+  Value element = tuple.element(1);
+  EXPECT_EQ(element.elements().data(), tuple.element(1).elements().data());
+
+  // Structurally equal values with distinct storage still compare equal.
+  Value other = Value::Tuple(
+      {Value(UBits(1, 8)), Value::Tuple({Value(UBits(2, 16))}), Value::Token()});
+  EXPECT_NE(other.elements().data(), tuple.elements().data());
+  EXPECT_EQ(other, tuple);
+  EXPECT_NE(Value::Tuple({Value(UBits(1, 8))}), tuple);
+
+  EXPECT_EQ(Value::Token(), Value::Token());
+  EXPECT_TRUE(Value::Token().empty());
+}
+
 void ProtoValueRoundTripWorks(const ValueProto& v) {
   auto value = Value::FromProto(v, /*max_bit_size=*/1 << 16);
   if (!value.ok()) {
@@ -660,6 +725,39 @@ void ProtoValueRoundTripWorks(const ValueProto& v) {
 
 FUZZ_TEST(ValueProto, ProtoValueRoundTripWorks)
     .WithDomains(fuzztest::Arbitrary<ValueProto>());
+
+Value MakeLargeArray(int64_t element_count) {
+  std::vector<uint64_t> elements(element_count);
+  for (int64_t i = 0; i < element_count; ++i) {
+    elements[i] = i * 0x9e3779b9;
+  }
+  return Value::UBitsArray(elements, 64).value();
+}
+
+void BM_LargeArrayToString(benchmark::State& state) {
+  Value array = MakeLargeArray(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(array.ToString(FormatPreference::kHex));
+  }
+}
+BENCHMARK(BM_LargeArrayToString)->Range(64, 1 << 16);
+
+void BM_LargeArrayParse(benchmark::State& state) {
+  std::string text =
+      MakeLargeArray(state.range(0)).ToString(FormatPreference::kHex);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Parser::ParseTypedValue(text));
+  }
+}
+BENCHMARK(BM_LargeArrayParse)->Range(64, 1 << 16);
+
+void BM_LargeArrayFromProto(benchmark::State& state) {
+  ValueProto proto = MakeLargeArray(state.range(0)).AsProto().value();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Value::FromProto(proto));
+  }
+}
+BENCHMARK(BM_LargeArrayFromProto)->Range(64, 1 << 16);
 }  // namespace
 
 }  // namespace xls
@@ -67,6 +67,7 @@
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
+#include "xls/ir/verify_node.h"
 #include "re2/re2.h"
 
 namespace xls {
@@ -450,6 +451,30 @@ absl::Status VerifyPackage(Package* package, bool codegen) {
   return absl::OkStatus();
 }
 
+absl::Status VerifyChangedNodes(FunctionBase* function_base,
+                                absl::Span<Node* const> nodes) {
+  XLS_RETURN_IF_ERROR(VerifyName(function_base));
+  Package* package = function_base->package();
+  for (Node* node : nodes) {
+    XLS_RET_CHECK(node->function_base() == function_base);
+    XLS_RET_CHECK(package->IsOwnedType(node->GetType()));
+    XLS_RET_CHECK_LT(node->id(), package->next_node_id());
+    XLS_RETURN_IF_ERROR(VerifyNode(node));
+    if (node->Is<Param>()) {
+      XLS_RET_CHECK(absl::c_linear_search(function_base->params(), node))
+          << "Param " << node->GetName() << " is not in the parameter list of "
+          << function_base->name();
+    }
+    if (function_base->IsFunction() &&
+        (node->Is<Send>() || node->Is<Receive>())) {
+      return absl::InternalError(absl::StrFormat(
+          "Send and receive nodes can only be in procs, not functions (%s)",
+          node->GetName()));
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status VerifyFunction(Function* function, bool codegen) {
   VLOG(4) << "Verifying function:\n";
   XLS_VLOG_LINES(4, function->DumpIr());
@@ -16,11 +16,13 @@
 #define XLS_IR_VERIFIER_H_
 
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 
 namespace xls {
 
 class Node;
 class Function;
+class FunctionBase;
 class Proc;
 class Block;
 class Package;
@@ -32,6 +34,17 @@ absl::Status VerifyFunction(Function* function, bool codegen = false);
 absl::Status VerifyProc(Proc* Proc, bool codegen = false);
 absl::Status VerifyBlock(Block* Block, bool codegen = false);
 
+// Verifies the invariants of the given nodes of `function_base` which can be
+// checked without examining the rest of the IR: those checked by VerifyNode
+// along with type ownership, the range of node IDs, membership of parameters
+// in the parameter list and, for functions, the absence of sends and
+// receives. Cycles, the uniqueness of IDs and invariants spanning the function
+// base or package (such as token connectivity and channel usage) are not
+// checked. Used to verify the nodes changed by a pass between full
+// verifications.
+absl::Status VerifyChangedNodes(FunctionBase* function_base,
+                                absl::Span<Node* const> nodes);
+
 }  // namespace xls
 
 #endif  // XLS_IR_VERIFIER_H_
@@ -0,0 +1,31 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Proc used to test ahead-of-time compilation of proc networks.
+pub proc accumulator {
+    data_in: chan<u32> in;
+    data_out: chan<u32> out;
+
+    config(data_in: chan<u32> in, data_out: chan<u32> out) { (data_in, data_out) }
+
+    init { u32:0 }
+
+    next(tok: token, acc: u32) {
+        let (tok, x) = recv(tok, data_in);
+        let acc = acc + x;
+        send(tok, data_out, acc);
+        acc
+    }
+}
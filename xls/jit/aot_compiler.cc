@@ -17,7 +17,9 @@
 // wrap (i.e., simplify) execution of the generated code, and writes the trio to
 // disk.
 
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -32,20 +34,29 @@
 #include "absl/strings/str_replace.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/strip.h"
+#include "absl/types/span.h"
 #include "google/protobuf/text_format.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/jit/aot_entrypoint.pb.h"
+#include "xls/jit/function_base_jit.h"
 #include "xls/jit/function_jit.h"
 #include "xls/jit/llvm_type_converter.h"
 #include "xls/jit/orc_jit.h"
 
 ABSL_FLAG(std::string, input, "", "Path to the IR to compile.");
 ABSL_FLAG(std::string, top, "",
-          "IR function to compile. "
-          "If unspecified, the package top function will be used - "
+          "IR function or proc to compile. If a proc is given, the whole "
+          "proc network elaborated from it is compiled. "
+          "If unspecified, the package top will be used - "
           "in that case, the package-scoping mangling will be removed.");
 ABSL_FLAG(std::string, namespaces, "",
           "Comma-separated list of namespaces into which to place the "
@@ -283,6 +294,236 @@ absl::StatusOr<::xls::Value> {{wrapper_fn_name}}({{wrapper_params}}) {
   return absl::StrReplaceAll(kTemplate, substitution_map);
 }
 
+// Adds the namespace-opening and -closing substitutions for the given
+// namespaces.
+void AddNamespaceSubstitutions(
+    const std::vector<std::string>& namespaces,
+    absl::flat_hash_map<std::string, std::string>& substitution_map) {
+  if (namespaces.empty()) {
+    substitution_map["{{open_ns}}"] = "";
+    substitution_map["{{close_ns}}"] = "";
+  } else {
+    substitution_map["{{open_ns}}"] =
+        absl::StrFormat("namespace %s {", absl::StrJoin(namespaces, "::"));
+    substitution_map["{{close_ns}}"] =
+        absl::StrFormat("}  // namespace %s", absl::StrJoin(namespaces, "::"));
+  }
+}
+
+// Produces a header file declaring a class which wraps the compiled proc
+// network. The class is named after the top proc (with the package name prefix
+// removed).
+std::string GenerateProcHeader(Package* p, Proc* top,
+                               const std::vector<std::string>& namespaces) {
+  constexpr std::string_view kTemplate =
+      R"(// AUTO-GENERATED FILE! DO NOT EDIT!
+#include <memory>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/package.h"
+#include "xls/jit/jit_channel_queue.h"
+
+{{open_ns}}
+
+// Ahead-of-time compiled model of the proc network elaborated from
+// `{{top_name}}`.
+class {{class_name}} {
+ public:
+  static absl::StatusOr<std::unique_ptr<{{class_name}}>> Create();
+
+  // Executes a single tick of every proc in the network.
+  absl::Status Tick() { return runtime_->Tick(); }
+
+  // Returns the queue of the channel with the given name. Values can be
+  // written and read either as xls::Values or in the native layout of the
+  // compiled code.
+  absl::StatusOr<::xls::JitChannelQueue*> GetQueue(
+      std::string_view channel_name);
+
+  ::xls::SerialProcRuntime& runtime() { return *runtime_; }
+
+ private:
+  {{class_name}}(std::unique_ptr<::xls::Package> package,
+      std::unique_ptr<::xls::SerialProcRuntime> runtime)
+      : package_(std::move(package)), runtime_(std::move(runtime)) {}
+
+  // The runtime refers to the package so it must be destroyed first.
+  std::unique_ptr<::xls::Package> package_;
+  std::unique_ptr<::xls::SerialProcRuntime> runtime_;
+};
+
+{{close_ns}}
+)";
+
+  absl::flat_hash_map<std::string, std::string> substitution_map;
+  std::string package_prefix = absl::StrCat("__", p->name(), "__");
+  substitution_map["{{top_name}}"] = top->name();
+  substitution_map["{{class_name}}"] =
+      absl::StripPrefix(top->name(), package_prefix);
+  AddNamespaceSubstitutions(namespaces, substitution_map);
+  return absl::StrReplaceAll(kTemplate, substitution_map);
+}
+
+// Generates a source file which constructs a SerialProcRuntime from the
+// compiled procs. The IR of the package is embedded in the source as the
+// runtime needs the procs and channels to build its queues and interpret
+// results. The node ids in the embedded IR match the ids recorded in the
+// entrypoint metadata because both come from the same parsed package.
+absl::StatusOr<std::string> GenerateProcWrapperSource(
+    Package* p, Proc* top, absl::Span<const JittedFunctionBase> procs,
+    const std::string& header_path, const std::vector<std::string>& namespaces,
+    bool include_msan) {
+  constexpr std::string_view kTemplate =
+      R"~(// AUTO-GENERATED FILE! DO NOT EDIT!
+#include "{{header_path}}"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "google/protobuf/text_format.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/jit/aot_entrypoint.pb.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_proc_runtime.h"
+
+extern "C" {
+{{extern_fns}}
+}
+{{open_ns}}
+
+namespace {
+
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+static constexpr bool kTargetHasSanitizer = true;
+#else
+static constexpr bool kTargetHasSanitizer = false;
+#endif
+static constexpr bool kExternHasSanitizer = {{extern_sanitizer}};
+
+static_assert(kTargetHasSanitizer == kExternHasSanitizer,
+              "sanitizer states do not match!");
+
+const char* kPackageIr = R"|({{package_ir}})|";
+const char* kEntrypoints = R"|({{entrypoints_proto}})|";
+
+}  //  namespace
+
+absl::StatusOr<std::unique_ptr<{{class_name}}>> {{class_name}}::Create() {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<::xls::Package> package,
+                       ::xls::Parser::ParsePackage(kPackageIr));
+  ::xls::AotPackageEntrypointsProto entrypoints;
+  if (!google::protobuf::TextFormat::ParseFromString(kEntrypoints,
+                                                     &entrypoints)) {
+    return absl::InternalError("Unable to parse AOT entrypoints.");
+  }
+  ::xls::JitFunctionType functions[] = {{{function_symbols}}};
+{{runtime_creation}}
+  return absl::WrapUnique(
+      new {{class_name}}(std::move(package), std::move(runtime)));
+}
+
+absl::StatusOr<::xls::JitChannelQueue*> {{class_name}}::GetQueue(
+    std::string_view channel_name) {
+  XLS_ASSIGN_OR_RETURN(::xls::ChannelQueue* queue,
+                       runtime_->queue_manager().GetQueueByName(channel_name));
+  return dynamic_cast<::xls::JitChannelQueue*>(queue);
+}
+
+{{close_ns}}
+)~";
+  absl::flat_hash_map<std::string, std::string> substitution_map;
+  substitution_map["{{extern_sanitizer}}"] = include_msan ? "true" : "false";
+  substitution_map["{{header_path}}"] = header_path;
+  std::string package_prefix = absl::StrCat("__", p->name(), "__");
+  substitution_map["{{class_name}}"] =
+      absl::StripPrefix(top->name(), package_prefix);
+  AddNamespaceSubstitutions(namespaces, substitution_map);
+
+  std::vector<std::string> extern_fns;
+  std::vector<std::string> function_symbols;
+  AotPackageEntrypointsProto entrypoints;
+  for (const JittedFunctionBase& proc : procs) {
+    extern_fns.push_back(absl::StrFormat(
+        "int64_t %s(const uint8_t* const* inputs, uint8_t* const* outputs,\n"
+        "    void* temp_buffer, ::xls::InterpreterEvents* events,\n"
+        "    ::xls::InstanceContext* instance_context,\n"
+        "    ::xls::JitRuntime* jit_runtime, int64_t continuation_point);",
+        proc.function_name()));
+    function_symbols.push_back(absl::StrCat("&", proc.function_name()));
+    *entrypoints.add_entrypoint() = proc.ToAotEntrypoint();
+  }
+  substitution_map["{{extern_fns}}"] = absl::StrJoin(extern_fns, "\n");
+  substitution_map["{{function_symbols}}"] =
+      absl::StrJoin(function_symbols, ", ");
+
+  std::string entrypoints_text;
+  XLS_RET_CHECK(google::protobuf::TextFormat::PrintToString(entrypoints,
+                                                           &entrypoints_text));
+  substitution_map["{{entrypoints_proto}}"] = entrypoints_text;
+  substitution_map["{{package_ir}}"] = p->DumpIr();
+
+  if (top->is_new_style_proc()) {
+    substitution_map["{{runtime_creation}}"] = absl::StrFormat(
+        R"(  XLS_ASSIGN_OR_RETURN(::xls::Proc * top, package->GetProc("%s"));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<::xls::SerialProcRuntime> runtime,
+      ::xls::CreateAotSerialProcRuntime(top, entrypoints, functions));)",
+        top->name());
+  } else {
+    substitution_map["{{runtime_creation}}"] =
+        R"(  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<::xls::SerialProcRuntime> runtime,
+      ::xls::CreateAotSerialProcRuntime(package.get(), entrypoints,
+                                        functions));)";
+  }
+  return absl::StrReplaceAll(kTemplate, substitution_map);
+}
+
+// Compiles the proc network elaborated from `top` and writes the object code,
+// header and source files.
+absl::Status CompileProcNetwork(Package* package, Proc* top,
+                                const std::string& output_object_path,
+                                const std::string& output_header_path,
+                                const std::string& output_source_path,
+                                const std::string& header_include_path,
+                                const std::vector<std::string>& namespaces,
+                                bool include_msan) {
+  XLS_ASSIGN_OR_RETURN(
+      ProcElaboration elaboration,
+      top->is_new_style_proc()
+          ? ProcElaboration::Elaborate(top)
+          : ProcElaboration::ElaborateOldStylePackage(package));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit,
+                       OrcJit::Create(/*opt_level=*/OrcJit::kDefaultOptLevel,
+                                      /*emit_object_code=*/true,
+                                      /*emit_msan=*/include_msan));
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<JittedFunctionBase> procs,
+      JittedFunctionBase::BuildProcs(elaboration.procs(), *orc_jit));
+  const std::vector<uint8_t>& object_code = orc_jit->GetObjectCode();
+  XLS_RETURN_IF_ERROR(SetFileContents(
+      output_object_path, std::string(object_code.begin(), object_code.end())));
+
+  XLS_RETURN_IF_ERROR(SetFileContents(
+      output_header_path, GenerateProcHeader(package, top, namespaces)));
+
+  XLS_ASSIGN_OR_RETURN(
+      std::string source_text,
+      GenerateProcWrapperSource(package, top, procs, header_include_path,
+                                namespaces, include_msan));
+  return SetFileContents(output_source_path, source_text);
+}
+
 absl::Status RealMain(const std::string& input_ir_path, const std::string& top,
                       const std::string& output_object_path,
                       const std::string& output_header_path,
@@ -294,13 +535,22 @@ absl::Status RealMain(const std::string& input_ir_path, const std::string& top,
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        Parser::ParsePackage(input_ir, input_ir_path));
 
-  Function* f;
-  std::string package_prefix = absl::StrCat("__", package->name(), "__");
+  FunctionBase* top_fb;
   if (top.empty()) {
-    XLS_ASSIGN_OR_RETURN(f, package->GetTopAsFunction());
+    XLS_RET_CHECK(package->GetTop().has_value()) << "Package has no top.";
+    top_fb = *package->GetTop();
   } else {
-    XLS_ASSIGN_OR_RETURN(f, package->GetFunction(top));
+    XLS_ASSIGN_OR_RETURN(top_fb, package->GetFunctionBaseByName(top));
+  }
+  if (top_fb->IsProc()) {
+    return CompileProcNetwork(package.get(), top_fb->AsProcOrDie(),
+                              output_object_path, output_header_path,
+                              output_source_path, header_include_path,
+                              namespaces, include_msan);
   }
+  XLS_RET_CHECK(top_fb->IsFunction())
+      << "Only functions and procs can be compiled ahead-of-time.";
+  Function* f = top_fb->AsFunctionOrDie();
   XLS_ASSIGN_OR_RETURN(JitObjectCode object_code,
                        FunctionJit::CreateObjectCode(f));
   XLS_RETURN_IF_ERROR(SetFileContents(
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include <cstdint>
+#include <memory>
+#include <optional>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -22,7 +24,9 @@
 #include "xls/ir/bits.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value.h"
+#include "xls/jit/accumulator_proc_cc.h"
 #include "xls/jit/compound_type_cc.h"
+#include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/null_function_cc.h"
 
 // Rather than do a pattern-matching unit test of aot_compile.cc's output, this
@@ -73,6 +77,25 @@ TEST(AotCompileTest, CompoundType) {
   EXPECT_EQ(result, Value::Tuple({b, Value(UBits(43, 32)), c}));
 }
 
+TEST(AotCompileTest, ProcNetwork) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<foo::accumulator_0_next> network,
+                           foo::accumulator_0_next::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(JitChannelQueue * input,
+                           network->GetQueue("accumulator_proc__data_in"));
+  XLS_ASSERT_OK_AND_ASSIGN(JitChannelQueue * output,
+                           network->GetQueue("accumulator_proc__data_out"));
+  for (int64_t i = 1; i <= 3; ++i) {
+    XLS_ASSERT_OK(input->Write(Value(UBits(i, 32))));
+  }
+  for (int64_t i = 0; i < 3; ++i) {
+    XLS_ASSERT_OK(network->Tick());
+  }
+  EXPECT_EQ(output->Read(), Value(UBits(1, 32)));
+  EXPECT_EQ(output->Read(), Value(UBits(3, 32)));
+  EXPECT_EQ(output->Read(), Value(UBits(6, 32)));
+  EXPECT_EQ(output->Read(), std::nullopt);
+}
+
 #ifndef NDEBUG
 // In non-opt mode, argument values are type-checked using DCHECK.
 TEST(AotCompileTest, InvalidTypes) {
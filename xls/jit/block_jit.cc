@@ -14,24 +14,45 @@
 
 #include "xls/jit/block_jit.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <random>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/base/casts.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "llvm/include/llvm/ADT/APInt.h"
+#include "llvm/include/llvm/IR/BasicBlock.h"
+#include "llvm/include/llvm/IR/Constants.h"
+#include "llvm/include/llvm/IR/DerivedTypes.h"
+#include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/IRBuilder.h"
+#include "llvm/include/llvm/IR/Instructions.h"
+#include "llvm/include/llvm/IR/LLVMContext.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "llvm/include/llvm/IR/Type.h"
+#include "llvm/include/llvm/IR/Value.h"
+#include "llvm/include/llvm/Support/Alignment.h"
+#include "llvm/include/llvm/Support/Casting.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/block_evaluator.h"
 #include "xls/ir/block.h"
 #include "xls/ir/elaboration.h"
@@ -76,6 +97,444 @@ absl::Status BlockJit::RunOneCycle(BlockJitContinuation& continuation) {
   return absl::OkStatus();
 }
 
+absl::Status BlockJit::RunCycles(
+    absl::Span<BlockJitContinuation* const> continuations, int64_t cycle_count,
+    CycleCallback set_inputs, CycleCallback read_outputs,
+    int64_t thread_count) {
+  for (BlockJitContinuation* continuation : continuations) {
+    XLS_RET_CHECK_EQ(continuation->block_jit_, this)
+        << "Continuation was not created by this jit.";
+  }
+  thread_count = std::clamp(
+      thread_count, int64_t{1},
+      std::max(int64_t{1}, static_cast<int64_t>(continuations.size())));
+  std::vector<absl::Status> statuses(thread_count);
+  auto run = [&](int64_t worker) -> absl::Status {
+    for (int64_t cycle = 0; cycle < cycle_count; ++cycle) {
+      for (int64_t i = worker; i < continuations.size(); i += thread_count) {
+        XLS_RETURN_IF_ERROR(set_inputs(i, cycle, *continuations[i]));
+        XLS_RETURN_IF_ERROR(RunOneCycle(*continuations[i]));
+        XLS_RETURN_IF_ERROR(read_outputs(i, cycle, *continuations[i]));
+      }
+    }
+    return absl::OkStatus();
+  };
+  if (thread_count == 1) {
+    return run(0);
+  }
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count);
+  for (int64_t worker = 0; worker < thread_count; ++worker) {
+    threads.push_back(std::make_unique<Thread>(
+        [&, worker]() { statuses[worker] = run(worker); }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+/* static */ BlockJit::StreamLayout BlockJit::ComputeStreamLayout(
+    const JittedFunctionBase& function, Block* block) {
+  auto layout_records = [](absl::Span<const int64_t> sizes,
+                           absl::Span<const int64_t> alignments,
+                           std::vector<int64_t>& offsets) {
+    int64_t offset = 0;
+    int64_t max_alignment = 1;
+    for (int64_t i = 0; i < sizes.size(); ++i) {
+      offset = RoundUpToNearest(offset, alignments[i]);
+      offsets.push_back(offset);
+      offset += sizes[i];
+      max_alignment = std::max(max_alignment, alignments[i]);
+    }
+    return RoundUpToNearest(offset, max_alignment);
+  };
+  int64_t input_count = block->GetInputPorts().size();
+  int64_t output_count = block->GetOutputPorts().size();
+  StreamLayout layout;
+  layout.input_record_size = layout_records(
+      absl::MakeConstSpan(function.input_buffer_sizes())
+          .subspan(0, input_count),
+      absl::MakeConstSpan(function.input_buffer_preferred_alignments())
+          .subspan(0, input_count),
+      layout.input_port_offsets);
+  layout.output_record_size = layout_records(
+      absl::MakeConstSpan(function.output_buffer_sizes())
+          .subspan(0, output_count),
+      absl::MakeConstSpan(function.output_buffer_preferred_alignments())
+          .subspan(0, output_count),
+      layout.output_port_offsets);
+  return layout;
+}
+
+// Builds a function which runs the block function in a loop. For a block with
+// one input and one output port the function looks like:
+//
+//   int64_t __block__multi_cycle(input_sets, output_sets, input_stream,
+//                                output_stream, cycle_count, temp_buffer,
+//                                events, jit_runtime) {
+//     for (int64_t cycle = 0; cycle < cycle_count; ++cycle) {
+//       inputs = input_sets[cycle % 2];
+//       outputs = output_sets[cycle % 2];
+//       memcpy(inputs[0], input_stream + cycle * input_record_size, ...);
+//       __block(inputs, outputs, temp_buffer, events, nullptr, jit_runtime, 0);
+//       memcpy(output_stream + cycle * output_record_size, outputs[0], ...);
+//       if (stop_port != 0) {
+//         return cycle + 1;
+//       }
+//     }
+//     return cycle_count;
+//   }
+absl::StatusOr<BlockJit::MultiCycleFunctionType>
+BlockJit::GetMultiCycleFunction(std::string_view stop_port) {
+  absl::MutexLock lock(&multi_cycle_mutex_);
+  auto it = multi_cycle_functions_.find(stop_port);
+  if (it != multi_cycle_functions_.end()) {
+    return it->second;
+  }
+
+  std::optional<int64_t> stop_port_index;
+  const BitsType* stop_port_type = nullptr;
+  if (!stop_port.empty()) {
+    XLS_ASSIGN_OR_RETURN(OutputPort * port, block_->GetOutputPort(stop_port));
+    if (!port->operand(0)->GetType()->IsBits()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Stop port `%s` must be of bits type, is %s", stop_port,
+          port->operand(0)->GetType()->ToString()));
+    }
+    stop_port_type = port->operand(0)->GetType()->AsBitsOrDie();
+    absl::Span<OutputPort* const> output_ports = block_->GetOutputPorts();
+    stop_port_index = std::distance(output_ports.begin(),
+                                    absl::c_find(output_ports, port));
+  }
+
+  llvm::LLVMContext& context = *jit_->GetContext();
+  std::string name =
+      absl::StrFormat("%s__multi_cycle_%d", function_.function_name(),
+                      multi_cycle_functions_.size());
+  std::unique_ptr<llvm::Module> module = jit_->NewModule(name);
+  module->setTargetTriple(jit_->target_triple());
+  llvm::Type* ptr_type = llvm::PointerType::get(context, 0);
+  llvm::Type* i64_type = llvm::Type::getInt64Ty(context);
+  llvm::FunctionType* block_function_type = llvm::FunctionType::get(
+      i64_type,
+      {ptr_type, ptr_type, ptr_type, ptr_type, ptr_type, ptr_type, i64_type},
+      /*isVarArg=*/false);
+  llvm::FunctionCallee block_function =
+      module->getOrInsertFunction(function_.function_name(),
+                                  block_function_type);
+  llvm::FunctionType* function_type = llvm::FunctionType::get(
+      i64_type,
+      {ptr_type, ptr_type, ptr_type, ptr_type, i64_type, ptr_type, ptr_type,
+       ptr_type},
+      /*isVarArg=*/false);
+  llvm::Function* function = llvm::Function::Create(
+      function_type, llvm::GlobalValue::ExternalLinkage, name, module.get());
+  llvm::Value* input_sets = function->getArg(0);
+  llvm::Value* output_sets = function->getArg(1);
+  llvm::Value* input_stream = function->getArg(2);
+  llvm::Value* output_stream = function->getArg(3);
+  llvm::Value* cycle_count = function->getArg(4);
+  llvm::Value* temp_buffer = function->getArg(5);
+  llvm::Value* events = function->getArg(6);
+  llvm::Value* jit_runtime = function->getArg(7);
+
+  llvm::BasicBlock* entry =
+      llvm::BasicBlock::Create(context, "entry", function);
+  llvm::BasicBlock* header =
+      llvm::BasicBlock::Create(context, "header", function);
+  llvm::BasicBlock* body = llvm::BasicBlock::Create(context, "body", function);
+  llvm::BasicBlock* exit = llvm::BasicBlock::Create(context, "exit", function);
+
+  llvm::IRBuilder<> b(entry);
+  b.CreateBr(header);
+
+  b.SetInsertPoint(header);
+  llvm::PHINode* cycle = b.CreatePHI(i64_type, 2, "cycle");
+  cycle->addIncoming(b.getInt64(0), entry);
+  b.CreateCondBr(b.CreateICmpSLT(cycle, cycle_count), body, exit);
+
+  b.SetInsertPoint(body);
+  llvm::Value* parity = b.CreateAnd(cycle, b.getInt64(1));
+  llvm::Value* inputs =
+      b.CreateLoad(ptr_type, b.CreateGEP(ptr_type, input_sets, parity));
+  llvm::Value* outputs =
+      b.CreateLoad(ptr_type, b.CreateGEP(ptr_type, output_sets, parity));
+  auto port_buffer = [&](llvm::Value* pointers, int64_t index) {
+    return b.CreateLoad(ptr_type,
+                        b.CreateGEP(ptr_type, pointers, b.getInt64(index)));
+  };
+  llvm::Value* input_record = b.CreateGEP(
+      b.getInt8Ty(), input_stream,
+      b.CreateMul(cycle, b.getInt64(stream_layout_.input_record_size)));
+  for (int64_t i = 0; i < stream_layout_.input_port_offsets.size(); ++i) {
+    b.CreateMemCpy(
+        port_buffer(inputs, i), llvm::MaybeAlign(1),
+        b.CreateGEP(b.getInt8Ty(), input_record,
+                    b.getInt64(stream_layout_.input_port_offsets[i])),
+        llvm::MaybeAlign(1), input_port_sizes()[i]);
+  }
+  b.CreateCall(block_function,
+               {inputs, outputs, temp_buffer, events,
+                llvm::ConstantPointerNull::get(
+                    llvm::cast<llvm::PointerType>(ptr_type)),
+                jit_runtime, b.getInt64(0)});
+  llvm::Value* output_record = b.CreateGEP(
+      b.getInt8Ty(), output_stream,
+      b.CreateMul(cycle, b.getInt64(stream_layout_.output_record_size)));
+  for (int64_t i = 0; i < stream_layout_.output_port_offsets.size(); ++i) {
+    b.CreateMemCpy(
+        b.CreateGEP(b.getInt8Ty(), output_record,
+                    b.getInt64(stream_layout_.output_port_offsets[i])),
+        llvm::MaybeAlign(1), port_buffer(outputs, i), llvm::MaybeAlign(1),
+        function_.output_buffer_sizes()[i]);
+  }
+  llvm::Value* next_cycle = b.CreateAdd(cycle, b.getInt64(1));
+  cycle->addIncoming(next_cycle, body);
+  if (stop_port_index.has_value()) {
+    // Load the port value as an integer of the full buffer width and mask off
+    // any padding bits.
+    int64_t buffer_bits =
+        function_.output_buffer_sizes()[*stop_port_index] * 8;
+    llvm::Type* buffer_type = b.getIntNTy(buffer_bits);
+    llvm::Value* value =
+        b.CreateLoad(buffer_type, port_buffer(outputs, *stop_port_index));
+    llvm::Value* masked = b.CreateAnd(
+        value, llvm::ConstantInt::get(
+                   buffer_type, llvm::APInt::getLowBitsSet(
+                                    buffer_bits, stop_port_type->bit_count())));
+    b.CreateCondBr(
+        b.CreateICmpNE(masked, llvm::ConstantInt::get(buffer_type, 0)), exit,
+        header);
+  } else {
+    b.CreateBr(header);
+  }
+
+  b.SetInsertPoint(exit);
+  llvm::PHINode* result = b.CreatePHI(i64_type, 2, "result");
+  result->addIncoming(cycle, header);
+  if (stop_port_index.has_value()) {
+    result->addIncoming(next_cycle, body);
+  }
+  b.CreateRet(result);
+
+  XLS_RETURN_IF_ERROR(jit_->CompileModule(std::move(module)));
+  XLS_ASSIGN_OR_RETURN(auto fn_address, jit_->LoadSymbol(name));
+  auto multi_cycle_function =
+      absl::bit_cast<MultiCycleFunctionType>(fn_address);
+  multi_cycle_functions_[std::string(stop_port)] = multi_cycle_function;
+  return multi_cycle_function;
+}
+
+absl::StatusOr<int64_t> BlockJit::RunCyclesInJit(
+    BlockJitContinuation& continuation, int64_t cycle_count,
+    absl::Span<const uint8_t> input_stream, absl::Span<uint8_t> output_stream,
+    std::optional<std::string_view> stop_port) {
+  XLS_RET_CHECK_EQ(continuation.block_jit_, this)
+      << "Continuation was not created by this jit.";
+  XLS_RET_CHECK_GE(cycle_count, 0);
+  XLS_RET_CHECK_GE(input_stream.size(),
+                   cycle_count * stream_layout_.input_record_size);
+  XLS_RET_CHECK_GE(output_stream.size(),
+                   cycle_count * stream_layout_.output_record_size);
+  XLS_ASSIGN_OR_RETURN(MultiCycleFunctionType function,
+                       GetMultiCycleFunction(stop_port.value_or("")));
+  uint8_t* const* input_pointer_sets[] = {
+      continuation.input_buffers_.current().pointers().data(),
+      continuation.input_buffers_.alternate().pointers().data()};
+  uint8_t* const* output_pointer_sets[] = {
+      continuation.output_buffers_.current().pointers().data(),
+      continuation.output_buffers_.alternate().pointers().data()};
+  int64_t cycles_run =
+      function(input_pointer_sets, output_pointer_sets, input_stream.data(),
+               output_stream.data(), cycle_count,
+               continuation.temp_buffer_.get(), &continuation.GetEvents(),
+               runtime_);
+  // The current register space alternates each cycle.
+  if (cycles_run % 2 == 1) {
+    continuation.SwapRegisters();
+  }
+  return cycles_run;
+}
+
+namespace {
+
+// Returns the index of `name` in `ports`, or an error naming `kind`.
+template <typename PortT>
+absl::StatusOr<int64_t> PortIndex(absl::Span<PortT* const> ports,
+                                  std::string_view name,
+                                  std::string_view kind) {
+  auto it = absl::c_find_if(
+      ports, [&](PortT* port) { return port->GetName() == name; });
+  if (it == ports.end()) {
+    return absl::NotFoundError(
+        absl::StrFormat("No %s port named `%s`", kind, name));
+  }
+  return std::distance(ports.begin(), it);
+}
+
+// The resolved ports of a StreamingChannel. `data` and `valid` index the
+// input ports (output ports) of an input (output) channel and `ready` the
+// other direction.
+struct StreamingChannelPorts {
+  int64_t data;
+  int64_t valid;
+  int64_t ready;
+  int64_t stride;
+  int64_t count;
+};
+
+bool PatternAllows(const BlockJit::StreamingChannel& channel, int64_t cycle) {
+  return channel.pattern.empty() ||
+         channel.pattern[cycle % channel.pattern.size()];
+}
+
+}  // namespace
+
+absl::StatusOr<int64_t> BlockJit::GetPortBufferSize(
+    std::string_view port) const {
+  if (absl::StatusOr<int64_t> index =
+          PortIndex(block_->GetInputPorts(), port, "input");
+      index.ok()) {
+    return input_port_sizes()[*index];
+  }
+  XLS_ASSIGN_OR_RETURN(
+      int64_t index,
+      PortIndex(block_->GetOutputPorts(), port, "input or output"));
+  return function_.output_buffer_sizes()[index];
+}
+
+absl::StatusOr<int64_t> BlockJit::RunStreamingCycles(
+    BlockJitContinuation& continuation, absl::Span<StreamingChannel> inputs,
+    absl::Span<StreamingChannel> outputs, int64_t max_cycle_count) {
+  XLS_RET_CHECK_EQ(continuation.block_jit_, this)
+      << "Continuation was not created by this jit.";
+  absl::Span<InputPort* const> input_ports = block_->GetInputPorts();
+  absl::Span<OutputPort* const> output_ports = block_->GetOutputPorts();
+  auto check_control = [](Type* type, std::string_view name) -> absl::Status {
+    if (!type->IsBits() || type->GetFlatBitCount() != 1) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Port `%s` must be a single bit, is %s", name, type->ToString()));
+    }
+    return absl::OkStatus();
+  };
+  auto resolve = [&](const StreamingChannel& channel,
+                     bool is_input) -> absl::StatusOr<StreamingChannelPorts> {
+    StreamingChannelPorts ports;
+    if (is_input) {
+      XLS_ASSIGN_OR_RETURN(
+          ports.data, PortIndex(input_ports, channel.data_port, "input"));
+      XLS_ASSIGN_OR_RETURN(
+          ports.valid, PortIndex(input_ports, channel.valid_port, "input"));
+      XLS_ASSIGN_OR_RETURN(
+          ports.ready, PortIndex(output_ports, channel.ready_port, "output"));
+      XLS_RETURN_IF_ERROR(check_control(
+          input_ports[ports.valid]->GetType(), channel.valid_port));
+      XLS_RETURN_IF_ERROR(check_control(
+          output_ports[ports.ready]->operand(0)->GetType(),
+          channel.ready_port));
+      ports.stride = input_port_sizes()[ports.data];
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          ports.data, PortIndex(output_ports, channel.data_port, "output"));
+      XLS_ASSIGN_OR_RETURN(
+          ports.valid, PortIndex(output_ports, channel.valid_port, "output"));
+      XLS_ASSIGN_OR_RETURN(
+          ports.ready, PortIndex(input_ports, channel.ready_port, "input"));
+      XLS_RETURN_IF_ERROR(check_control(
+          output_ports[ports.valid]->operand(0)->GetType(),
+          channel.valid_port));
+      XLS_RETURN_IF_ERROR(check_control(input_ports[ports.ready]->GetType(),
+                                        channel.ready_port));
+      ports.stride = function_.output_buffer_sizes()[ports.data];
+    }
+    if (ports.stride == 0 || channel.values.size() % ports.stride != 0) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Buffer of channel `%s` holds %d bytes which is not a multiple of "
+          "the %d byte port buffer",
+          channel.data_port, channel.values.size(), ports.stride));
+    }
+    ports.count = channel.values.size() / ports.stride;
+    XLS_RET_CHECK_LE(channel.transferred, ports.count);
+    return ports;
+  };
+  std::vector<StreamingChannelPorts> input_channel_ports;
+  input_channel_ports.reserve(inputs.size());
+  for (const StreamingChannel& channel : inputs) {
+    XLS_ASSIGN_OR_RETURN(input_channel_ports.emplace_back(),
+                         resolve(channel, /*is_input=*/true));
+  }
+  std::vector<StreamingChannelPorts> output_channel_ports;
+  output_channel_ports.reserve(outputs.size());
+  for (const StreamingChannel& channel : outputs) {
+    XLS_ASSIGN_OR_RETURN(output_channel_ports.emplace_back(),
+                         resolve(channel, /*is_input=*/false));
+  }
+
+  // The port buffers are shared by both register spaces of the continuation
+  // so the pointers stay valid as the registers are swapped each cycle.
+  absl::Span<uint8_t* const> input_buffers = continuation.input_port_pointers();
+  absl::Span<uint8_t const* const> output_buffers =
+      continuation.output_port_pointers();
+  std::vector<bool> ready(outputs.size());
+  auto done = [&]() {
+    for (int64_t i = 0; i < inputs.size(); ++i) {
+      if (inputs[i].transferred < input_channel_ports[i].count) {
+        return false;
+      }
+    }
+    for (int64_t i = 0; i < outputs.size(); ++i) {
+      if (outputs[i].transferred < output_channel_ports[i].count) {
+        return false;
+      }
+    }
+    return true;
+  };
+  int64_t cycle = 0;
+  for (; cycle < max_cycle_count && !done(); ++cycle) {
+    for (int64_t i = 0; i < inputs.size(); ++i) {
+      StreamingChannel& channel = inputs[i];
+      const StreamingChannelPorts& ports = input_channel_ports[i];
+      channel.holding_valid =
+          channel.holding_valid ||
+          (channel.transferred < ports.count && PatternAllows(channel, cycle));
+      *input_buffers[ports.valid] = channel.holding_valid ? 1 : 0;
+      if (channel.holding_valid) {
+        memcpy(input_buffers[ports.data],
+               channel.values.data() + channel.transferred * ports.stride,
+               ports.stride);
+      }
+    }
+    for (int64_t i = 0; i < outputs.size(); ++i) {
+      ready[i] = outputs[i].transferred < output_channel_ports[i].count &&
+                 PatternAllows(outputs[i], cycle);
+      *input_buffers[output_channel_ports[i].ready] = ready[i] ? 1 : 0;
+    }
+    XLS_RETURN_IF_ERROR(RunOneCycle(continuation));
+    for (int64_t i = 0; i < inputs.size(); ++i) {
+      StreamingChannel& channel = inputs[i];
+      if (channel.holding_valid &&
+          (*output_buffers[input_channel_ports[i].ready] & 1) != 0) {
+        ++channel.transferred;
+        channel.holding_valid = false;
+      }
+    }
+    for (int64_t i = 0; i < outputs.size(); ++i) {
+      StreamingChannel& channel = outputs[i];
+      const StreamingChannelPorts& ports = output_channel_ports[i];
+      if (ready[i] && (*output_buffers[ports.valid] & 1) != 0) {
+        memcpy(channel.values.data() + channel.transferred * ports.stride,
+               output_buffers[ports.data], ports.stride);
+        ++channel.transferred;
+      }
+    }
+  }
+  return cycle;
+}
+
 absl::StatusOr<JitArgumentSet> BlockJitContinuation::CombineBuffers(
     const JittedFunctionBase& jit_func, const JitArgumentSet& left,
     int64_t left_count, const JitArgumentSet& rest, int64_t rest_start,
@@ -348,8 +807,8 @@ absl::StatusOr<BlockRunResult> JitBlockEvaluator::EvaluateBlock(
   XLS_RET_CHECK_EQ(elaboration.instances().size(), 1)
       << "StreamingJitBlockEvaluator does not support instantiations";
 
-  XLS_ASSIGN_OR_RETURN(auto runtime, JitRuntime::Create());
-  XLS_ASSIGN_OR_RETURN(auto jit, BlockJit::Create(top_block, runtime.get()));
+  XLS_ASSIGN_OR_RETURN(JitRuntime * runtime, JitRuntime::GetShared());
+  XLS_ASSIGN_OR_RETURN(auto jit, BlockJit::Create(top_block, runtime));
   auto continuation = jit->NewContinuation();
   XLS_RETURN_IF_ERROR(continuation->SetInputPorts(inputs));
   XLS_RETURN_IF_ERROR(continuation->SetRegisters(reg_state));
@@ -370,8 +829,8 @@ StreamingJitBlockEvaluator::EvaluateSequentialBlock(
   for (Register* reg : block->GetRegisters()) {
     reg_state[reg->name()] = ZeroOfType(reg->type());
   }
-  XLS_ASSIGN_OR_RETURN(auto runtime, JitRuntime::Create());
-  XLS_ASSIGN_OR_RETURN(auto jit, BlockJit::Create(block, runtime.get()));
+  XLS_ASSIGN_OR_RETURN(JitRuntime * runtime, JitRuntime::GetShared());
+  XLS_ASSIGN_OR_RETURN(auto jit, BlockJit::Create(block, runtime));
   auto continuation = jit->NewContinuation();
   XLS_RETURN_IF_ERROR(continuation->SetRegisters(reg_state));
 
@@ -399,8 +858,8 @@ StreamingJitBlockEvaluator::EvaluateChannelizedSequentialBlock(
     reg_state[reg->name()] = ZeroOfType(reg->type());
   }
 
-  XLS_ASSIGN_OR_RETURN(auto runtime, JitRuntime::Create());
-  XLS_ASSIGN_OR_RETURN(auto jit, BlockJit::Create(block, runtime.get()));
+  XLS_ASSIGN_OR_RETURN(JitRuntime * runtime, JitRuntime::GetShared());
+  XLS_ASSIGN_OR_RETURN(auto jit, BlockJit::Create(block, runtime));
   auto continuation = jit->NewContinuation();
   XLS_RETURN_IF_ERROR(continuation->SetRegisters(reg_state));
 
@@ -464,11 +923,8 @@ namespace {
 class BlockContinuationJitWrapper final : public BlockContinuation {
  public:
   BlockContinuationJitWrapper(std::unique_ptr<BlockJitContinuation>&& cont,
-                              std::unique_ptr<BlockJit>&& jit,
-                              std::unique_ptr<JitRuntime>&& runtime)
-      : continuation_(std::move(cont)),
-        jit_(std::move(jit)),
-        runtime_(std::move(runtime)) {}
+                              std::unique_ptr<BlockJit>&& jit)
+      : continuation_(std::move(cont)), jit_(std::move(jit)) {}
   const absl::flat_hash_map<std::string, Value>& output_ports() final {
     if (!temporary_outputs_) {
       temporary_outputs_.emplace(continuation_->GetOutputPortsMap());
@@ -498,7 +954,6 @@ class BlockContinuationJitWrapper final : public BlockContinuation {
  private:
   std::unique_ptr<BlockJitContinuation> continuation_;
   std::unique_ptr<BlockJit> jit_;
-  std::unique_ptr<JitRuntime> runtime_;
   // Holder for the data we return out of output_ports so that we can reduce
   // copying.
   std::optional<absl::flat_hash_map<std::string, Value>> temporary_outputs_;
@@ -515,12 +970,12 @@ StreamingJitBlockEvaluator::NewContinuation(
   Block* top_block = *elaboration.top()->block();
   XLS_RET_CHECK_EQ(elaboration.instances().size(), 1)
       << "StreamingJitBlockEvaluator does not support instantiations";
-  XLS_ASSIGN_OR_RETURN(auto runtime, JitRuntime::Create());
-  XLS_ASSIGN_OR_RETURN(auto jit, BlockJit::Create(top_block, runtime.get()));
+  XLS_ASSIGN_OR_RETURN(JitRuntime * runtime, JitRuntime::GetShared());
+  XLS_ASSIGN_OR_RETURN(auto jit, BlockJit::Create(top_block, runtime));
   auto jit_cont = jit->NewContinuation();
   XLS_RETURN_IF_ERROR(jit_cont->SetRegisters(initial_registers));
   return std::make_unique<BlockContinuationJitWrapper>(
-      std::move(jit_cont), std::move(jit), std::move(runtime));
+      std::move(jit_cont), std::move(jit));
 }
 
 }  // namespace xls
@@ -29,9 +29,12 @@
 #include <vector>
 
 #include "absl/base/attributes.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/block_evaluator.h"
@@ -59,6 +62,94 @@ class BlockJit {
   // Runs a single cycle of a block with the given continuation.
   absl::Status RunOneCycle(BlockJitContinuation& continuation);
 
+  // Called by RunCycles with the index of a continuation in the batch, the
+  // cycle number and the continuation.
+  using CycleCallback = absl::FunctionRef<absl::Status(
+      int64_t index, int64_t cycle, BlockJitContinuation& continuation)>;
+
+  // Runs `cycle_count` cycles of each of `continuations`, which must have been
+  // created by this jit and are simulated independently of each other. Before
+  // each cycle `set_inputs` is called to set the input ports of the
+  // continuation and after each cycle `read_outputs` is called to consume its
+  // outputs. The continuations are split over up to `thread_count` threads,
+  // each of which advances its share of the batch in lock step so that the
+  // compiled code is shared. The callbacks must therefore be safe to call
+  // concurrently for different continuations. Returns the first error
+  // returned by a callback; on error the continuations are left in an
+  // unspecified cycle.
+  absl::Status RunCycles(
+      absl::Span<BlockJitContinuation* const> continuations,
+      int64_t cycle_count, CycleCallback set_inputs, CycleCallback read_outputs,
+      int64_t thread_count = 1);
+
+  // The layout of the streams read and written by RunCyclesInJit. Each cycle
+  // has a record holding the native value of every input (or output) port at
+  // the given offset within the record. Offsets respect the preferred
+  // alignment of each port but the streams themselves need not be aligned.
+  struct StreamLayout {
+    int64_t input_record_size = 0;
+    std::vector<int64_t> input_port_offsets;
+    int64_t output_record_size = 0;
+    std::vector<int64_t> output_port_offsets;
+  };
+  const StreamLayout& stream_layout() const { return stream_layout_; }
+
+  // Runs up to `cycle_count` cycles of `continuation` inside jitted code
+  // without returning between cycles. Before each cycle the input ports are
+  // set from the cycle's record in `input_stream` and after each cycle the
+  // output ports are written to the cycle's record in `output_stream`. Both
+  // streams must hold `cycle_count` records laid out as in `stream_layout()`.
+  // If `stop_port` is given, execution stops after the first cycle in which
+  // that output port (which must be of bits type) is non-zero. Returns the
+  // number of cycles run. The code for each `stop_port` is compiled on first
+  // use.
+  absl::StatusOr<int64_t> RunCyclesInJit(
+      BlockJitContinuation& continuation, int64_t cycle_count,
+      absl::Span<const uint8_t> input_stream, absl::Span<uint8_t> output_stream,
+      std::optional<std::string_view> stop_port = std::nullopt);
+
+  // A ready/valid channel whose values are moved between a buffer and the
+  // ports of the block by RunStreamingCycles. The data and valid ports of an
+  // input channel are input ports of the block and its ready port is an output
+  // port; the directions are reversed for an output channel.
+  struct StreamingChannel {
+    std::string data_port;
+    std::string valid_port;
+    std::string ready_port;
+
+    // Values in the native layout of the data port stored contiguously with a
+    // stride of the size of its buffer (see `GetPortBufferSize`). An input
+    // channel sends all of them and an output channel receives as many as
+    // fit.
+    absl::Span<uint8_t> values;
+
+    // Throttling pattern indexed cyclically by the cycle number within a call.
+    // An input channel only starts presenting a value, and an output channel
+    // only asserts ready, in cycles whose entry is true. Empty means every
+    // cycle. Once valid is asserted it is held until the value is accepted.
+    std::vector<bool> pattern;
+
+    // The number of values transferred so far and whether an input channel is
+    // holding valid. Updated by RunStreamingCycles so that a channel can be
+    // passed to successive calls.
+    int64_t transferred = 0;
+    bool holding_valid = false;
+  };
+
+  // Runs up to `max_cycle_count` cycles of `continuation`, driving the ports
+  // of `inputs` and `outputs` from their buffers each cycle without going
+  // through xls::Value. Other input ports keep the values last set on the
+  // continuation. Stops early once every input channel has sent all of its
+  // values and every output channel buffer is full. Returns the number of
+  // cycles run.
+  absl::StatusOr<int64_t> RunStreamingCycles(
+      BlockJitContinuation& continuation,
+      absl::Span<StreamingChannel> inputs,
+      absl::Span<StreamingChannel> outputs, int64_t max_cycle_count);
+
+  // Returns the size of the native buffer of the given input or output port.
+  absl::StatusOr<int64_t> GetPortBufferSize(std::string_view port) const;
+
   OrcJit& orc_jit() const { return *jit_; }
 
   // Get how large each pointer buffer for the input ports are.
@@ -74,17 +165,42 @@ class BlockJit {
   }
 
  private:
+  // Signature of the jitted functions used by RunCyclesInJit. The register
+  // buffers alternate between two sets of input and output pointers so
+  // `input_pointer_sets` and `output_pointer_sets` each hold two pointer
+  // arrays; cycle `i` uses the arrays at index `i % 2`. Returns the number of
+  // cycles run.
+  using MultiCycleFunctionType = int64_t (*)(
+      uint8_t* const* const* input_pointer_sets,
+      uint8_t* const* const* output_pointer_sets, const uint8_t* input_stream,
+      uint8_t* output_stream, int64_t cycle_count, void* temp_buffer,
+      InterpreterEvents* events, JitRuntime* jit_runtime);
+
   BlockJit(Block* block, JitRuntime* runtime, std::unique_ptr<OrcJit> jit,
            JittedFunctionBase function)
       : block_(block),
         runtime_(runtime),
         jit_(std::move(jit)),
-        function_(std::move(function)) {}
+        function_(std::move(function)),
+        stream_layout_(ComputeStreamLayout(function_, block_)) {}
+
+  static StreamLayout ComputeStreamLayout(const JittedFunctionBase& function,
+                                          Block* block);
+
+  // Returns the multi-cycle function stopping on `stop_port` (or never if
+  // `stop_port` is empty), building and compiling it if needed.
+  absl::StatusOr<MultiCycleFunctionType> GetMultiCycleFunction(
+      std::string_view stop_port);
 
   Block* block_;
   JitRuntime* runtime_;
   std::unique_ptr<OrcJit> jit_;
   JittedFunctionBase function_;
+  StreamLayout stream_layout_;
+
+  absl::Mutex multi_cycle_mutex_;
+  absl::flat_hash_map<std::string, MultiCycleFunctionType>
+      multi_cycle_functions_ ABSL_GUARDED_BY(multi_cycle_mutex_);
 };
 
 class BlockJitContinuation {
@@ -126,6 +242,16 @@ class BlockJitContinuation {
       }
     }
 
+    // Returns the currently inactive space.
+    const JitArgumentSet& alternate() const {
+      switch (current_side_) {
+        case RegisterSpace::kLeft:
+          return right_;
+        case RegisterSpace::kRight:
+          return left_;
+      }
+    }
+
     const JitArgumentSet& left() const { return left_; }
 
     const JitArgumentSet& right() const { return right_; }
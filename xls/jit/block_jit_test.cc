@@ -15,10 +15,13 @@
 #include "xls/jit/block_jit.h"
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/interpreter/block_evaluator_test_base.h"
@@ -34,6 +37,8 @@ namespace xls {
 namespace {
 
 using testing::ElementsAre;
+using testing::HasSubstr;
+using ::xls::status_testing::StatusIs;
 
 class BlockJitTest : public IrTestBase {};
 TEST_F(BlockJitTest, ConstantToPort) {
@@ -115,6 +120,229 @@ TEST_F(BlockJitTest, DelaySlot) {
   EXPECT_THAT(cont->GetOutputPorts(), ElementsAre(Value(UBits(42, 8))));
 }
 
+TEST_F(BlockJitTest, RunCyclesOfManyContinuations) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK_AND_ASSIGN(auto r,
+                           bb.block()->AddRegister("acc", p->GetBitsType(32)));
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  auto input = bb.InputPort("input", p->GetBitsType(32));
+  auto sum = bb.Add(bb.RegisterRead(r), input);
+  bb.RegisterWrite(r, sum);
+  bb.OutputPort("sum", sum);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, bb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto runtime, JitRuntime::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b, runtime.get()));
+
+  // Each continuation accumulates its own index every cycle.
+  constexpr int64_t kInstances = 17;
+  constexpr int64_t kCycles = 10;
+  for (int64_t thread_count : {1, 4}) {
+    std::vector<std::unique_ptr<BlockJitContinuation>> owned;
+    std::vector<BlockJitContinuation*> continuations;
+    for (int64_t i = 0; i < kInstances; ++i) {
+      owned.push_back(jit->NewContinuation());
+      XLS_ASSERT_OK(owned.back()->SetRegisters({Value(UBits(0, 32))}));
+      continuations.push_back(owned.back().get());
+    }
+    std::vector<std::vector<Value>> outputs(kInstances);
+    XLS_ASSERT_OK(jit->RunCycles(
+        continuations, kCycles,
+        [](int64_t index, int64_t cycle, BlockJitContinuation& continuation) {
+          return continuation.SetInputPorts({Value(UBits(index, 32))});
+        },
+        [&](int64_t index, int64_t cycle, BlockJitContinuation& continuation) {
+          outputs[index].push_back(continuation.GetOutputPorts()[0]);
+          return absl::OkStatus();
+        },
+        thread_count));
+    for (int64_t i = 0; i < kInstances; ++i) {
+      ASSERT_EQ(outputs[i].size(), kCycles);
+      for (int64_t cycle = 0; cycle < kCycles; ++cycle) {
+        EXPECT_EQ(outputs[i][cycle], Value(UBits(i * (cycle + 1), 32)))
+            << "instance " << i << " cycle " << cycle;
+      }
+      EXPECT_THAT(continuations[i]->GetRegisters(),
+                  ElementsAre(Value(UBits(i * kCycles, 32))));
+    }
+  }
+}
+
+TEST_F(BlockJitTest, RunCyclesReturnsCallbackError) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  bb.OutputPort("answer", bb.InputPort("question", p->GetBitsType(8)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, bb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto runtime, JitRuntime::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b, runtime.get()));
+  auto cont = jit->NewContinuation();
+  std::vector<BlockJitContinuation*> continuations = {cont.get()};
+  EXPECT_THAT(
+      jit->RunCycles(
+          continuations, /*cycle_count=*/3,
+          [](int64_t, int64_t cycle, BlockJitContinuation& continuation) {
+            if (cycle == 1) {
+              return absl::InvalidArgumentError("no more stimulus");
+            }
+            return continuation.SetInputPorts({Value(UBits(cycle, 8))});
+          },
+          [](int64_t, int64_t, BlockJitContinuation&) {
+            return absl::OkStatus();
+          }),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("no more stimulus")));
+}
+
+TEST_F(BlockJitTest, RunCyclesInJit) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK_AND_ASSIGN(auto r,
+                           bb.block()->AddRegister("acc", p->GetBitsType(32)));
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  auto input = bb.InputPort("input", p->GetBitsType(32));
+  auto sum = bb.Add(bb.RegisterRead(r), input);
+  bb.RegisterWrite(r, sum);
+  bb.OutputPort("sum", sum);
+  bb.OutputPort("big", bb.UGt(sum, bb.Literal(UBits(20, 32))));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, bb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto runtime, JitRuntime::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b, runtime.get()));
+  const BlockJit::StreamLayout& layout = jit->stream_layout();
+
+  // Cycle `i` adds `i + 1` to the accumulator.
+  constexpr int64_t kCycles = 10;
+  std::vector<uint8_t> input_stream(kCycles * layout.input_record_size);
+  for (int64_t cycle = 0; cycle < kCycles; ++cycle) {
+    runtime->BlitValueToBuffer(
+        Value(UBits(cycle + 1, 32)), p->GetBitsType(32),
+        absl::MakeSpan(input_stream)
+            .subspan(cycle * layout.input_record_size +
+                     layout.input_port_offsets[0]));
+  }
+  auto sum_at = [&](absl::Span<const uint8_t> output_stream, int64_t cycle) {
+    return runtime->UnpackBuffer(
+        output_stream.data() + cycle * layout.output_record_size +
+            layout.output_port_offsets[0],
+        p->GetBitsType(32));
+  };
+
+  {
+    auto cont = jit->NewContinuation();
+    XLS_ASSERT_OK(cont->SetRegisters({Value(UBits(0, 32))}));
+    std::vector<uint8_t> output_stream(kCycles * layout.output_record_size);
+    XLS_ASSERT_OK_AND_ASSIGN(
+        int64_t cycles_run,
+        jit->RunCyclesInJit(*cont, /*cycle_count=*/5, input_stream,
+                            absl::MakeSpan(output_stream)));
+    EXPECT_EQ(cycles_run, 5);
+    EXPECT_EQ(sum_at(output_stream, 0), Value(UBits(1, 32)));
+    EXPECT_EQ(sum_at(output_stream, 4), Value(UBits(15, 32)));
+    EXPECT_THAT(cont->GetRegisters(), ElementsAre(Value(UBits(15, 32))));
+    EXPECT_THAT(cont->GetOutputPorts(),
+                ElementsAre(Value(UBits(15, 32)), Value(UBits(0, 1))));
+
+    // Execution continues from the state left by the jitted loop.
+    XLS_ASSERT_OK(cont->SetInputPorts({Value(UBits(100, 32))}));
+    XLS_ASSERT_OK(jit->RunOneCycle(*cont));
+    EXPECT_THAT(cont->GetRegisters(), ElementsAre(Value(UBits(115, 32))));
+  }
+
+  {
+    auto cont = jit->NewContinuation();
+    XLS_ASSERT_OK(cont->SetRegisters({Value(UBits(0, 32))}));
+    std::vector<uint8_t> output_stream(kCycles * layout.output_record_size);
+    XLS_ASSERT_OK_AND_ASSIGN(
+        int64_t cycles_run,
+        jit->RunCyclesInJit(*cont, kCycles, input_stream,
+                            absl::MakeSpan(output_stream), "big"));
+    // 1 + 2 + ... + 6 = 21 is the first sum greater than 20.
+    EXPECT_EQ(cycles_run, 6);
+    EXPECT_EQ(sum_at(output_stream, 5), Value(UBits(21, 32)));
+    EXPECT_THAT(cont->GetRegisters(), ElementsAre(Value(UBits(21, 32))));
+  }
+
+  auto cont = jit->NewContinuation();
+  std::vector<uint8_t> output_stream(kCycles * layout.output_record_size);
+  EXPECT_THAT(jit->RunCyclesInJit(*cont, kCycles, input_stream,
+                                  absl::MakeSpan(output_stream), "nope"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_F(BlockJitTest, RunStreamingCycles) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  auto in_data = bb.InputPort("in", p->GetBitsType(32));
+  auto in_vld = bb.InputPort("in_vld", p->GetBitsType(1));
+  auto out_rdy = bb.InputPort("out_rdy", p->GetBitsType(1));
+  bb.OutputPort("in_rdy", out_rdy);
+  bb.OutputPort("out", bb.Add(in_data, bb.Literal(UBits(1, 32))));
+  bb.OutputPort("out_vld", in_vld);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, bb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto runtime, JitRuntime::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b, runtime.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t stride, jit->GetPortBufferSize("in"));
+
+  constexpr int64_t kCount = 5;
+  std::vector<uint8_t> input_values(kCount * stride);
+  for (int64_t i = 0; i < kCount; ++i) {
+    runtime->BlitValueToBuffer(
+        Value(UBits(i + 1, 32)), p->GetBitsType(32),
+        absl::MakeSpan(input_values).subspan(i * stride, stride));
+  }
+  std::vector<uint8_t> output_values(kCount * stride);
+  std::vector<BlockJit::StreamingChannel> inputs = {
+      {.data_port = "in",
+       .valid_port = "in_vld",
+       .ready_port = "in_rdy",
+       .values = absl::MakeSpan(input_values)}};
+  // The sink is only ready every other cycle.
+  std::vector<BlockJit::StreamingChannel> outputs = {
+      {.data_port = "out",
+       .valid_port = "out_vld",
+       .ready_port = "out_rdy",
+       .values = absl::MakeSpan(output_values),
+       .pattern = {true, false}}};
+
+  auto cont = jit->NewContinuation();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      int64_t cycles_run,
+      jit->RunStreamingCycles(*cont, absl::MakeSpan(inputs),
+                              absl::MakeSpan(outputs), /*max_cycle_count=*/2));
+  EXPECT_EQ(cycles_run, 2);
+  EXPECT_EQ(inputs[0].transferred, 1);
+  EXPECT_TRUE(inputs[0].holding_valid);
+  EXPECT_EQ(outputs[0].transferred, 1);
+
+  // The remaining four values go through in cycles 0, 2, 4 and 6.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      cycles_run,
+      jit->RunStreamingCycles(*cont, absl::MakeSpan(inputs),
+                              absl::MakeSpan(outputs),
+                              /*max_cycle_count=*/100));
+  EXPECT_EQ(cycles_run, 7);
+  EXPECT_EQ(inputs[0].transferred, kCount);
+  EXPECT_EQ(outputs[0].transferred, kCount);
+  for (int64_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(runtime->UnpackBuffer(output_values.data() + i * stride,
+                                    p->GetBitsType(32)),
+              Value(UBits(i + 2, 32)));
+  }
+
+  outputs[0].valid_port = "nope";
+  EXPECT_THAT(jit->RunStreamingCycles(*cont, absl::MakeSpan(inputs),
+                                      absl::MakeSpan(outputs), 1),
+              StatusIs(absl::StatusCode::kNotFound, HasSubstr("nope")));
+  outputs[0].valid_port = "out";
+  EXPECT_THAT(jit->RunStreamingCycles(*cont, absl::MakeSpan(inputs),
+                                      absl::MakeSpan(outputs), 1),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("must be a single bit")));
+}
+
 TEST_F(BlockJitTest, SetInputsWithViews) {
   auto p = CreatePackage();
   BlockBuilder bb(TestName(), p.get());
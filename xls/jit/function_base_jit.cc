@@ -35,6 +35,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/Constants.h"
 #include "llvm/include/llvm/IR/DerivedTypes.h"
@@ -49,6 +50,7 @@
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/trace.h"
 #include "xls/ir/block.h"
 #include "xls/ir/call_graph.h"
 #include "xls/ir/events.h"
@@ -59,11 +61,14 @@
 #include "xls/ir/register.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
+#include "xls/jit/aot_entrypoint.pb.h"
 #include "xls/jit/ir_builder_visitor.h"
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_node_profile.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
 
 namespace xls {
@@ -492,6 +497,27 @@ Type* OutputType(const Node* node) {
   return node->GetType();
 }
 
+// Returns the profile in which the jitted code should count node evaluations,
+// or nullptr if node evaluations should not be counted. Counters are addressed
+// by absolute host addresses so object code is never instrumented.
+JitNodeProfile* GetNodeProfile(JitBuilderContext& jit_context) {
+  JitObserver* observer = jit_context.orc_jit().jit_observer();
+  if (observer == nullptr || jit_context.orc_jit().emit_object_code() ||
+      !observer->GetNotificationOptions().node_profile) {
+    return nullptr;
+  }
+  return observer->GetNodeProfile();
+}
+
+// Emits an increment of the 64-bit counter at `counter`.
+void EmitCounterIncrement(int64_t* counter, llvm::IRBuilder<>& b) {
+  llvm::Value* counter_ptr = b.CreateIntToPtr(
+      b.getInt64(absl::bit_cast<uint64_t>(counter)),
+      llvm::PointerType::get(b.getInt64Ty(), 0));
+  llvm::Value* count = b.CreateLoad(b.getInt64Ty(), counter_ptr);
+  b.CreateStore(b.CreateAdd(count, b.getInt64(1)), counter_ptr);
+}
+
 // Builds an LLVM function of the given `name` which executes the given set of
 // nodes. The signature of the partition function is the same as the jitted
 // function implementing a FunctionBase (i.e., `JitFunctionType`). A partition
@@ -545,6 +571,8 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
   // partitions which are early exit points (e.g., have a blocking receive).
   llvm::Value* interrupt_execution = nullptr;
 
+  JitNodeProfile* node_profile = GetNodeProfile(jit_context);
+
   // The pointers to the buffers of nodes in the partition.
   absl::flat_hash_map<Node*, llvm::Value*> value_buffers;
   for (Node* node : partition.nodes) {
@@ -576,6 +604,12 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
       XLS_RET_CHECK(allocator.GetAllocationKind(param) ==
                     AllocationKind::kNone);
       output_buffers = wrapper.GetOutputBuffers(param, b);
+    } else if (IsInPlaceStateUpdate(node)) {
+      // The update is written directly into the next-state buffer of the state
+      // element. The buffer already holds the current value of the state
+      // element which was copied there when the param was visited.
+      Param* param = node->As<ArrayUpdate>()->array_to_update()->As<Param>();
+      output_buffers = wrapper.GetOutputBuffers(param, b);
     } else if (wrapper.IsOutputNode(node)) {
       XLS_RET_CHECK(allocator.GetAllocationKind(node) == AllocationKind::kNone);
       output_buffers = wrapper.GetOutputBuffers(node, b);
@@ -649,6 +683,9 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
       args.push_back(wrapper.GetInstanceContextArg());
       args.push_back(wrapper.GetJitRuntimeArg());
     }
+    if (node_profile != nullptr) {
+      EmitCounterIncrement(node_profile->GetCounter(node), b);
+    }
     llvm::CallInst* node_blocked = b.CreateCall(node_function.function, args);
 
     if (partition.early_exit_point.has_value()) {
@@ -812,6 +849,9 @@ absl::StatusOr<PartitionedFunction> BuildFunctionInternal(
       LlvmFunctionWrapper::FunctionArg{
           .name = "continuation_point",
           .type = llvm::Type::getInt64Ty(jit_context.context())});
+  // Each XLS function is compiled separately when compiling lazily, so calls
+  // to functions which are never executed do not cost compile time.
+  wrapper.function()->addFnAttr(OrcJit::kCompileUnitAttribute);
 
   XLS_RETURN_IF_ERROR(AllocateBuffers(partitions, wrapper, allocator));
 
@@ -1215,6 +1255,101 @@ absl::StatusOr<llvm::Function*> BuildPackedWrapper(
   return wrapper.function();
 }
 
+// Builds a wrapper around the jitted function `callee` which evaluates `callee`
+// on a batch of arguments. The wrapper has the same signature as `callee` with
+// the continuation point argument replaced by the batch size. Each pointer in
+// the inputs (outputs) array points to contiguous storage for the batch of
+// values of the respective input (output) in the native data layout.
+absl::StatusOr<llvm::Function*> BuildBatchedWrapper(
+    FunctionBase* xls_function, llvm::Function* callee,
+    JitBuilderContext& jit_context) {
+  llvm::LLVMContext* context = &jit_context.context();
+  llvm::Type* i64 = llvm::Type::getInt64Ty(*context);
+  llvm::Type* i8 = llvm::Type::getInt8Ty(*context);
+  std::vector<Node*> inputs = GetJittedFunctionInputs(xls_function);
+  std::vector<Node*> outputs = GetJittedFunctionOutputs(xls_function);
+  LlvmFunctionWrapper wrapper = LlvmFunctionWrapper::Create(
+      absl::StrFormat("%s_batched", xls_function->name()), inputs, outputs,
+      i64, jit_context,
+      LlvmFunctionWrapper::FunctionArg{.name = "batch_size", .type = i64});
+  llvm::IRBuilder<>& entry_builder = wrapper.entry_builder();
+
+  // Arrays of pointers to the inputs and outputs of a single evaluation which
+  // are passed on to the wrapped function.
+  llvm::Type* pointer_type = llvm::PointerType::get(*context, 0);
+  llvm::Value* input_arg_array = entry_builder.CreateAlloca(
+      llvm::ArrayType::get(pointer_type, inputs.size()));
+  llvm::Value* output_arg_array = entry_builder.CreateAlloca(
+      llvm::ArrayType::get(pointer_type, outputs.size()));
+  std::vector<llvm::Value*> input_bases;
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    input_bases.push_back(
+        LoadPointerFromPointerArray(i, wrapper.GetInputsArg(), &entry_builder));
+  }
+  std::vector<llvm::Value*> output_bases;
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    output_bases.push_back(LoadPointerFromPointerArray(
+        i, wrapper.GetOutputsArg(), &entry_builder));
+  }
+
+  llvm::BasicBlock* entry_block = entry_builder.GetInsertBlock();
+  llvm::BasicBlock* loop_block =
+      llvm::BasicBlock::Create(*context, "loop", wrapper.function());
+  llvm::BasicBlock* body_block =
+      llvm::BasicBlock::Create(*context, "body", wrapper.function());
+  llvm::BasicBlock* exit_block =
+      llvm::BasicBlock::Create(*context, "exit", wrapper.function());
+  entry_builder.CreateBr(loop_block);
+
+  llvm::IRBuilder<> loop_builder(loop_block);
+  llvm::PHINode* index = loop_builder.CreatePHI(i64, 2, "index");
+  index->addIncoming(llvm::ConstantInt::get(i64, 0), entry_block);
+  loop_builder.CreateCondBr(
+      loop_builder.CreateICmpSLT(index, wrapper.GetExtraArg().value()),
+      body_block, exit_block);
+
+  llvm::IRBuilder<> body_builder(body_block);
+  auto set_element_pointers = [&](absl::Span<Node* const> nodes,
+                                  absl::Span<llvm::Value* const> bases,
+                                  llvm::Value* arg_array, bool is_input) {
+    for (int64_t i = 0; i < nodes.size(); ++i) {
+      Type* type = is_input ? InputType(nodes[i]) : OutputType(nodes[i]);
+      int64_t stride = jit_context.type_converter().GetTypeByteSize(type);
+      llvm::Value* element = body_builder.CreateGEP(
+          i8, bases[i],
+          body_builder.CreateMul(index, llvm::ConstantInt::get(i64, stride)));
+      llvm::Value* gep = body_builder.CreateGEP(
+          pointer_type, arg_array,
+          {llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), i)});
+      body_builder.CreateStore(element, gep);
+    }
+  };
+  set_element_pointers(inputs, input_bases, input_arg_array,
+                       /*is_input=*/true);
+  set_element_pointers(outputs, output_bases, output_arg_array,
+                       /*is_input=*/false);
+
+  std::vector<llvm::Value*> args;
+  args.push_back(input_arg_array);
+  args.push_back(output_arg_array);
+  args.push_back(wrapper.GetTempBufferArg());
+  args.push_back(wrapper.GetInterpreterEventsArg());
+  args.push_back(wrapper.GetInstanceContextArg());
+  args.push_back(wrapper.GetJitRuntimeArg());
+  args.push_back(llvm::ConstantInt::get(i64, 0));
+  body_builder.CreateCall(callee, args);
+  llvm::Value* next_index =
+      body_builder.CreateAdd(index, llvm::ConstantInt::get(i64, 1));
+  index->addIncoming(next_index, body_block);
+  body_builder.CreateBr(loop_block);
+
+  // Functions always run to completion so the continuation point is zero.
+  llvm::IRBuilder<> exit_builder(exit_block);
+  exit_builder.CreateRet(llvm::ConstantInt::get(i64, 0));
+
+  return wrapper.function();
+}
+
 }  // namespace
 
 JitArgumentSet JittedFunctionBase::CreateInputBuffer() const {
@@ -1239,111 +1374,273 @@ JitTempBuffer JittedFunctionBase::CreateTempBuffer() const {
   return JitTempBuffer(this, temp_buffer_alignment(), temp_buffer_size());
 }
 
-// Jits a function implementing `xls_function`. Also jits all transitively
-// dependent xls::Functions which may be called by `xls_function`.
-absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
-    FunctionBase* xls_function, JitBuilderContext& jit_context,
-    bool build_packed_wrapper) {
-  std::vector<FunctionBase*> functions = GetDependentFunctions(xls_function);
-  BufferAllocator allocator(&jit_context.type_converter());
-  llvm::Function* top_function = nullptr;
-  std::vector<Partition> top_partitions;
-  for (FunctionBase* f : functions) {
-    XLS_ASSIGN_OR_RETURN(PartitionedFunction partitioned_function,
-                         BuildFunctionInternal(f, allocator, jit_context));
-    jit_context.SetLlvmFunction(f, partitioned_function.function);
-    if (f == xls_function) {
-      top_function = partitioned_function.function;
-      top_partitions = std::move(partitioned_function.partitions);
-    }
+namespace {
+std::vector<int64_t> BatchedSizes(absl::Span<int64_t const> sizes,
+                                  int64_t batch_size) {
+  std::vector<int64_t> batched_sizes;
+  batched_sizes.reserve(sizes.size());
+  for (int64_t size : sizes) {
+    batched_sizes.push_back(size * batch_size);
   }
-  XLS_RET_CHECK(top_function != nullptr);
+  return batched_sizes;
+}
+}  // namespace
 
-  std::string function_name = MangleForLLVM(top_function->getName().str());
-  std::string packed_wrapper_name;
-  if (build_packed_wrapper) {
-    XLS_ASSIGN_OR_RETURN(
-        llvm::Function * packed_wrapper_function,
-        BuildPackedWrapper(xls_function, top_function, jit_context));
-    packed_wrapper_name = packed_wrapper_function->getName().str();
+JitArgumentSet JittedFunctionBase::CreateBatchedInputBuffer(
+    int64_t batch_size) const {
+  return JitArgumentSet::CreateInput(
+      this, input_buffer_preferred_alignments(),
+      BatchedSizes(input_buffer_sizes(), batch_size));
+}
+
+JitArgumentSet JittedFunctionBase::CreateBatchedOutputBuffer(
+    int64_t batch_size) const {
+  return JitArgumentSet::CreateOutput(
+      this, output_buffer_preferred_alignments(),
+      BatchedSizes(output_buffer_sizes(), batch_size));
+}
+
+// Jits functions implementing each of `xls_functions` into a single module.
+// Also jits all transitively dependent xls::Functions which may be called by
+// `xls_functions`. Dependent functions shared by several of `xls_functions` are
+// built once so every returned function uses the same temporary buffer layout.
+absl::StatusOr<std::vector<JittedFunctionBase>>
+JittedFunctionBase::BuildInternal(absl::Span<FunctionBase* const> xls_functions,
+                                  JitBuilderContext& jit_context,
+                                  bool build_packed_wrapper,
+                                  bool build_batched_wrapper) {
+  TraceSpan span("jit_build");
+  if (span.active()) {
+    span.AddArg("function", xls_functions.empty()
+                                ? std::string_view()
+                                : std::string_view(xls_functions[0]->name()));
+    span.AddArg("function_count", xls_functions.size());
+  }
+  struct TopFunction {
+    FunctionBase* xls_function;
+    std::string function_name;
+    std::string packed_wrapper_name;
+    std::string batched_wrapper_name;
+    std::vector<Partition> partitions;
+    absl::btree_map<std::string, int64_t> queue_indices;
+  };
+  BufferAllocator allocator(&jit_context.type_converter());
+  std::vector<TopFunction> tops;
+  for (FunctionBase* xls_function : xls_functions) {
+    jit_context.ClearQueueIndices();
+    TopFunction top{.xls_function = xls_function};
+    llvm::Function* top_function = nullptr;
+    for (FunctionBase* f : GetDependentFunctions(xls_function)) {
+      if (f != xls_function && jit_context.HasLlvmFunction(f)) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(PartitionedFunction partitioned_function,
+                           BuildFunctionInternal(f, allocator, jit_context));
+      jit_context.SetLlvmFunction(f, partitioned_function.function);
+      if (f == xls_function) {
+        top_function = partitioned_function.function;
+        top.partitions = std::move(partitioned_function.partitions);
+      }
+    }
+    XLS_RET_CHECK(top_function != nullptr);
+
+    top.function_name = MangleForLLVM(top_function->getName().str());
+    if (build_packed_wrapper) {
+      XLS_ASSIGN_OR_RETURN(
+          llvm::Function * packed_wrapper_function,
+          BuildPackedWrapper(xls_function, top_function, jit_context));
+      top.packed_wrapper_name = packed_wrapper_function->getName().str();
+    }
+    if (build_batched_wrapper) {
+      XLS_ASSIGN_OR_RETURN(
+          llvm::Function * batched_wrapper_function,
+          BuildBatchedWrapper(xls_function, top_function, jit_context));
+      top.batched_wrapper_name = batched_wrapper_function->getName().str();
+    }
+    top.queue_indices = jit_context.queue_indices();
+    tops.push_back(std::move(top));
   }
 
   XLS_RETURN_IF_ERROR(
       jit_context.orc_jit().CompileModule(jit_context.ConsumeModule()));
 
-  JittedFunctionBase jitted_function;
-
-  jitted_function.function_name_ = function_name;
-  XLS_ASSIGN_OR_RETURN(auto fn_address,
-                       jit_context.orc_jit().LoadSymbol(function_name));
-  jitted_function.function_ = absl::bit_cast<JitFunctionType>(fn_address);
-
-  if (build_packed_wrapper) {
-    jitted_function.packed_function_name_ = packed_wrapper_name;
-    XLS_ASSIGN_OR_RETURN(auto packed_fn_address,
-                         jit_context.orc_jit().LoadSymbol(packed_wrapper_name));
-    jitted_function.packed_function_ =
-        absl::bit_cast<JitFunctionType>(packed_fn_address);
-  }
+  std::vector<JittedFunctionBase> jitted_functions;
+  for (TopFunction& top : tops) {
+    JittedFunctionBase jitted_function;
+    jitted_function.function_base_ = top.xls_function;
+
+    jitted_function.function_name_ = top.function_name;
+    XLS_ASSIGN_OR_RETURN(auto fn_address,
+                         jit_context.orc_jit().LoadSymbol(top.function_name));
+    jitted_function.function_ = absl::bit_cast<JitFunctionType>(fn_address);
+
+    if (build_packed_wrapper) {
+      jitted_function.packed_function_name_ = top.packed_wrapper_name;
+      XLS_ASSIGN_OR_RETURN(
+          auto packed_fn_address,
+          jit_context.orc_jit().LoadSymbol(top.packed_wrapper_name));
+      jitted_function.packed_function_ =
+          absl::bit_cast<JitFunctionType>(packed_fn_address);
+    }
 
-  for (const Node* input : GetJittedFunctionInputs(xls_function)) {
-    Type* input_type = InputType(input);
-    jitted_function.input_buffer_sizes_.push_back(
-        jit_context.type_converter().GetTypeByteSize(input_type));
-    jitted_function.input_buffer_prefered_alignments_.push_back(
-        jit_context.type_converter().GetTypePreferredAlignment(input_type));
-    jitted_function.input_buffer_abi_alignments_.push_back(
-        jit_context.type_converter().GetTypeAbiAlignment(input_type));
-    jitted_function.packed_input_buffer_sizes_.push_back(
-        jit_context.type_converter().GetPackedTypeByteSize(input_type));
-  }
-  for (const Node* output : GetJittedFunctionOutputs(xls_function)) {
-    Type* output_type = OutputType(output);
-    jitted_function.output_buffer_sizes_.push_back(
-        jit_context.type_converter().GetTypeByteSize(output_type));
-    jitted_function.output_buffer_prefered_alignments_.push_back(
-        jit_context.type_converter().GetTypePreferredAlignment(output_type));
-    jitted_function.output_buffer_abi_alignments_.push_back(
-        jit_context.type_converter().GetTypeAbiAlignment(output_type));
-    jitted_function.packed_output_buffer_sizes_.push_back(
-        jit_context.type_converter().GetPackedTypeByteSize(output_type));
-  }
-  jitted_function.temp_buffer_size_ = allocator.size();
-  jitted_function.temp_buffer_alignment_ = allocator.alignment();
+    if (build_batched_wrapper) {
+      jitted_function.batched_function_name_ = top.batched_wrapper_name;
+      XLS_ASSIGN_OR_RETURN(
+          auto batched_fn_address,
+          jit_context.orc_jit().LoadSymbol(top.batched_wrapper_name));
+      jitted_function.batched_function_ =
+          absl::bit_cast<JitFunctionType>(batched_fn_address);
+    }
 
-  // Indicate which nodes correspond to which early exit points.
-  for (const Partition& partition : top_partitions) {
-    if (partition.early_exit_point.has_value()) {
-      XLS_RET_CHECK_EQ(partition.nodes.size(), 1);
-      jitted_function.continuation_points_[partition.early_exit_point->id] =
-          partition.nodes.front();
+    for (const Node* input : GetJittedFunctionInputs(top.xls_function)) {
+      Type* input_type = InputType(input);
+      jitted_function.input_buffer_sizes_.push_back(
+          jit_context.type_converter().GetTypeByteSize(input_type));
+      jitted_function.input_buffer_prefered_alignments_.push_back(
+          jit_context.type_converter().GetTypePreferredAlignment(input_type));
+      jitted_function.input_buffer_abi_alignments_.push_back(
+          jit_context.type_converter().GetTypeAbiAlignment(input_type));
+      jitted_function.packed_input_buffer_sizes_.push_back(
+          jit_context.type_converter().GetPackedTypeByteSize(input_type));
     }
-  }
+    for (const Node* output : GetJittedFunctionOutputs(top.xls_function)) {
+      Type* output_type = OutputType(output);
+      jitted_function.output_buffer_sizes_.push_back(
+          jit_context.type_converter().GetTypeByteSize(output_type));
+      jitted_function.output_buffer_prefered_alignments_.push_back(
+          jit_context.type_converter().GetTypePreferredAlignment(output_type));
+      jitted_function.output_buffer_abi_alignments_.push_back(
+          jit_context.type_converter().GetTypeAbiAlignment(output_type));
+      jitted_function.packed_output_buffer_sizes_.push_back(
+          jit_context.type_converter().GetPackedTypeByteSize(output_type));
+    }
+    jitted_function.temp_buffer_size_ = allocator.size();
+    jitted_function.temp_buffer_alignment_ = allocator.alignment();
 
-  jitted_function.queue_indices_ = jit_context.queue_indices();
+    // Indicate which nodes correspond to which early exit points.
+    for (const Partition& partition : top.partitions) {
+      if (partition.early_exit_point.has_value()) {
+        XLS_RET_CHECK_EQ(partition.nodes.size(), 1);
+        jitted_function.continuation_points_[partition.early_exit_point->id] =
+            partition.nodes.front();
+      }
+    }
 
-  return std::move(jitted_function);
+    jitted_function.queue_indices_ = std::move(top.queue_indices);
+    jitted_functions.push_back(std::move(jitted_function));
+  }
+  return std::move(jitted_functions);
 }
 
 absl::StatusOr<JittedFunctionBase> JittedFunctionBase::Build(
     Function* xls_function, OrcJit& orc_jit) {
   JitBuilderContext jit_context(orc_jit);
-  return JittedFunctionBase::BuildInternal(xls_function, jit_context,
-                                           /*build_packed_wrapper=*/true);
+  XLS_ASSIGN_OR_RETURN(std::vector<JittedFunctionBase> jitted_functions,
+                       JittedFunctionBase::BuildInternal(
+                           {xls_function}, jit_context,
+                           /*build_packed_wrapper=*/true,
+                           /*build_batched_wrapper=*/true));
+  return std::move(jitted_functions.front());
 }
 
 absl::StatusOr<JittedFunctionBase> JittedFunctionBase::Build(Proc* proc,
                                                              OrcJit& orc_jit) {
+  XLS_ASSIGN_OR_RETURN(std::vector<JittedFunctionBase> jitted_functions,
+                       BuildProcs({proc}, orc_jit));
+  return std::move(jitted_functions.front());
+}
+
+absl::StatusOr<std::vector<JittedFunctionBase>> JittedFunctionBase::BuildProcs(
+    absl::Span<Proc* const> procs, OrcJit& orc_jit) {
   JitBuilderContext jit_context(orc_jit);
-  return JittedFunctionBase::BuildInternal(proc, jit_context,
-                                           /*build_packed_wrapper=*/false);
+  std::vector<FunctionBase*> function_bases(procs.begin(), procs.end());
+  return JittedFunctionBase::BuildInternal(function_bases, jit_context,
+                                           /*build_packed_wrapper=*/false,
+                                           /*build_batched_wrapper=*/false);
 }
 
 absl::StatusOr<JittedFunctionBase> JittedFunctionBase::Build(Block* block,
                                                              OrcJit& jit) {
   JitBuilderContext jit_context(jit);
-  return JittedFunctionBase::BuildInternal(block, jit_context,
-                                           /*build_packed_wrapper=*/false);
+  XLS_ASSIGN_OR_RETURN(std::vector<JittedFunctionBase> jitted_functions,
+                       JittedFunctionBase::BuildInternal(
+                           {block}, jit_context,
+                           /*build_packed_wrapper=*/false,
+                           /*build_batched_wrapper=*/false));
+  return std::move(jitted_functions.front());
+}
+
+absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildFromAot(
+    FunctionBase* function_base, const AotEntrypointProto& entrypoint,
+    JitFunctionType function) {
+  XLS_RET_CHECK_EQ(function_base->name(), entrypoint.function_base_name());
+  JittedFunctionBase jitted_function;
+  jitted_function.function_base_ = function_base;
+  jitted_function.function_name_ = entrypoint.function_symbol();
+  jitted_function.function_ = function;
+  auto to_vector = [](const auto& field) {
+    return std::vector<int64_t>(field.begin(), field.end());
+  };
+  jitted_function.input_buffer_sizes_ =
+      to_vector(entrypoint.input_buffer_sizes());
+  jitted_function.input_buffer_prefered_alignments_ =
+      to_vector(entrypoint.input_buffer_preferred_alignments());
+  jitted_function.input_buffer_abi_alignments_ =
+      to_vector(entrypoint.input_buffer_abi_alignments());
+  jitted_function.output_buffer_sizes_ =
+      to_vector(entrypoint.output_buffer_sizes());
+  jitted_function.output_buffer_prefered_alignments_ =
+      to_vector(entrypoint.output_buffer_preferred_alignments());
+  jitted_function.output_buffer_abi_alignments_ =
+      to_vector(entrypoint.output_buffer_abi_alignments());
+  jitted_function.temp_buffer_size_ = entrypoint.temp_buffer_size();
+  jitted_function.temp_buffer_alignment_ = entrypoint.temp_buffer_alignment();
+  absl::flat_hash_map<int64_t, Node*> nodes_by_id;
+  for (Node* node : function_base->nodes()) {
+    nodes_by_id[node->id()] = node;
+  }
+  for (const auto& [continuation_point, node_id] :
+       entrypoint.continuation_point_node_ids()) {
+    auto it = nodes_by_id.find(node_id);
+    XLS_RET_CHECK(it != nodes_by_id.end())
+        << "No node with id " << node_id << " in " << function_base->name();
+    jitted_function.continuation_points_[continuation_point] = it->second;
+  }
+  jitted_function.queue_indices_.insert(
+      entrypoint.channel_queue_indices().begin(),
+      entrypoint.channel_queue_indices().end());
+  return jitted_function;
+}
+
+AotEntrypointProto JittedFunctionBase::ToAotEntrypoint() const {
+  AotEntrypointProto entrypoint;
+  entrypoint.set_function_base_name(function_base_->name());
+  entrypoint.set_function_symbol(function_name_);
+  entrypoint.mutable_input_buffer_sizes()->Add(input_buffer_sizes_.begin(),
+                                               input_buffer_sizes_.end());
+  entrypoint.mutable_input_buffer_preferred_alignments()->Add(
+      input_buffer_prefered_alignments_.begin(),
+      input_buffer_prefered_alignments_.end());
+  entrypoint.mutable_input_buffer_abi_alignments()->Add(
+      input_buffer_abi_alignments_.begin(), input_buffer_abi_alignments_.end());
+  entrypoint.mutable_output_buffer_sizes()->Add(output_buffer_sizes_.begin(),
+                                                output_buffer_sizes_.end());
+  entrypoint.mutable_output_buffer_preferred_alignments()->Add(
+      output_buffer_prefered_alignments_.begin(),
+      output_buffer_prefered_alignments_.end());
+  entrypoint.mutable_output_buffer_abi_alignments()->Add(
+      output_buffer_abi_alignments_.begin(),
+      output_buffer_abi_alignments_.end());
+  entrypoint.set_temp_buffer_size(temp_buffer_size_);
+  entrypoint.set_temp_buffer_alignment(temp_buffer_alignment_);
+  for (const auto& [continuation_point, node] : continuation_points_) {
+    (*entrypoint.mutable_continuation_point_node_ids())[continuation_point] =
+        node->id();
+  }
+  for (const auto& [channel_name, index] : queue_indices_) {
+    (*entrypoint.mutable_channel_queue_indices())[channel_name] = index;
+  }
+  return entrypoint;
 }
 
 int64_t JittedFunctionBase::RunJittedFunction(
@@ -1438,4 +1735,71 @@ std::optional<int64_t> JittedFunctionBase::RunPackedJittedFunction(
   }
   return std::nullopt;
 }
+
+std::optional<int64_t> JittedFunctionBase::RunBatchedJittedFunction(
+    const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+    InterpreterEvents* events, JitRuntime* jit_runtime,
+    int64_t batch_size) const {
+  if (batched_function_) {
+    DCHECK_OK(VerifyOffsetAlignments(inputs, input_buffer_abi_alignments()));
+    DCHECK_OK(VerifyOffsetAlignments(outputs, output_buffer_abi_alignments()));
+    DCHECK(IsAligned(temp_buffer, temp_buffer_alignment_));
+    return (*batched_function_)(inputs, outputs, temp_buffer, events,
+                                /*instance_context=*/nullptr, jit_runtime,
+                                batch_size);
+  }
+  return std::nullopt;
+}
+
+JitBufferPool::Lease JitBufferPool::Acquire() {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!free_.empty()) {
+      std::unique_ptr<Buffers> buffers = std::move(free_.back());
+      free_.pop_back();
+      return Lease(this, std::move(buffers), /*batched=*/false);
+    }
+  }
+  return Lease(this,
+               std::make_unique<Buffers>(
+                   Buffers{.inputs = function_->CreateInputBuffer(),
+                           .outputs = function_->CreateOutputBuffer(),
+                           .temp = function_->CreateTempBuffer(),
+                           .batch_capacity = 1}),
+               /*batched=*/false);
+}
+
+JitBufferPool::Lease JitBufferPool::AcquireBatched(int64_t batch_size) {
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = absl::c_find_if(
+        free_batched_, [&](const std::unique_ptr<Buffers>& buffers) {
+          return buffers->batch_capacity >= batch_size;
+        });
+    if (it != free_batched_.end()) {
+      std::unique_ptr<Buffers> buffers = std::move(*it);
+      free_batched_.erase(it);
+      return Lease(this, std::move(buffers), /*batched=*/true);
+    }
+    // None of the free buffers is large enough. Drop one so that the number of
+    // pooled buffers stays bounded by the number of concurrent leases.
+    if (!free_batched_.empty()) {
+      free_batched_.pop_back();
+    }
+  }
+  return Lease(
+      this,
+      std::make_unique<Buffers>(Buffers{
+          .inputs = function_->CreateBatchedInputBuffer(batch_size),
+          .outputs = function_->CreateBatchedOutputBuffer(batch_size),
+          .temp = function_->CreateTempBuffer(),
+          .batch_capacity = batch_size}),
+      /*batched=*/true);
+}
+
+void JitBufferPool::Release(std::unique_ptr<Buffers> buffers, bool batched) {
+  absl::MutexLock lock(&mutex_);
+  (batched ? free_batched_ : free_).push_back(std::move(buffers));
+}
+
 }  // namespace xls
@@ -15,21 +15,25 @@
 #define XLS_JIT_FUNCTION_BASE_JIT_H_
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/proc.h"
+#include "xls/jit/aot_entrypoint.pb.h"
 #include "xls/jit/ir_builder_visitor.h"
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_runtime.h"
@@ -81,6 +85,24 @@ class JittedFunctionBase {
   // proc.
   static absl::StatusOr<JittedFunctionBase> Build(Proc* proc, OrcJit& orc_jit);
 
+  // Builds LLVM IR functions implementing each of the given procs into a
+  // single module and compiles it. This is used for ahead-of-time compilation
+  // of proc networks where the object code of all procs must be in one object
+  // file. The returned functions share a temporary buffer layout.
+  static absl::StatusOr<std::vector<JittedFunctionBase>> BuildProcs(
+      absl::Span<Proc* const> procs, OrcJit& orc_jit);
+
+  // Creates a JittedFunctionBase for `function_base` which calls the
+  // ahead-of-time compiled `function` described by `entrypoint`. Node ids are
+  // resolved against `function_base`, which must be the FunctionBase the code
+  // was compiled from.
+  static absl::StatusOr<JittedFunctionBase> BuildFromAot(
+      FunctionBase* function_base, const AotEntrypointProto& entrypoint,
+      JitFunctionType function);
+
+  // Returns the metadata needed to call the compiled function ahead-of-time.
+  AotEntrypointProto ToAotEntrypoint() const;
+
   // Builds and returns an LLVM IR function implementing the given XLS
   // block.
   static absl::StatusOr<JittedFunctionBase> Build(Block* block, OrcJit& jit);
@@ -108,6 +130,13 @@ class JittedFunctionBase {
   // Create a buffer usable as the temporary storage, correctly aligned.
   JitTempBuffer CreateTempBuffer() const;
 
+  // Create buffers with space for `batch_size` sets of inputs (outputs) for
+  // use with `RunBatchedJittedFunction`. The i-th pointer points to
+  // `batch_size` contiguous values of the i-th input (output), each occupying
+  // `input_buffer_sizes()[i]` (`output_buffer_sizes()[i]`) bytes.
+  JitArgumentSet CreateBatchedInputBuffer(int64_t batch_size) const;
+  JitArgumentSet CreateBatchedOutputBuffer(int64_t batch_size) const;
+
   // Execute the actual function (after verifying some invariants)
   int64_t RunJittedFunction(const JitArgumentSet& inputs,
                             JitArgumentSet& outputs, JitTempBuffer& temp_buffer,
@@ -136,6 +165,21 @@ class JittedFunctionBase {
   // Checks if we have a packed version of the function.
   bool HasPackedFunction() const { return packed_function_.has_value(); }
 
+  // Executes the function on `batch_size` sets of arguments in a single call.
+  // The i-th element of `inputs` (`outputs`) points to `batch_size` values of
+  // the i-th input (output) in the native LLVM data layout stored contiguously
+  // with a stride of `input_buffer_sizes()[i]` (`output_buffer_sizes()[i]`)
+  // bytes. Each pointer must satisfy the ABI alignment of the respective
+  // input or output. Events from all evaluations are accumulated in `events`.
+  // Returns std::nullopt if there is no batched version of the function.
+  std::optional<int64_t> RunBatchedJittedFunction(
+      const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+      InterpreterEvents* events, JitRuntime* jit_runtime,
+      int64_t batch_size) const;
+
+  // Checks if we have a batched version of the function.
+  bool HasBatchedFunction() const { return batched_function_.has_value(); }
+
   std::string_view function_name() const { return function_name_; }
 
   absl::Span<int64_t const> input_buffer_sizes() const {
@@ -185,9 +229,9 @@ class JittedFunctionBase {
   }
 
  private:
-  static absl::StatusOr<JittedFunctionBase> BuildInternal(
-      FunctionBase* function, JitBuilderContext& jit_context,
-      bool build_packed_wrapper);
+  static absl::StatusOr<std::vector<JittedFunctionBase>> BuildInternal(
+      absl::Span<FunctionBase* const> functions, JitBuilderContext& jit_context,
+      bool build_packed_wrapper, bool build_batched_wrapper);
 
   // The XLS FunctionBase this jitted function implements.
   FunctionBase* function_base_;
@@ -203,6 +247,12 @@ class JittedFunctionBase {
   std::optional<std::string> packed_function_name_;
   std::optional<JitFunctionType> packed_function_;
 
+  // Name and function pointer for the jitted function which evaluates the
+  // function on a batch of arguments. The batch size is passed as the final
+  // (continuation point) argument. Only exists for JITted xls::Functions.
+  std::optional<std::string> batched_function_name_;
+  std::optional<JitFunctionType> batched_function_;
+
   // Sizes of the inputs/outputs in native LLVM format for `function_base`.
   std::vector<int64_t> input_buffer_sizes_;
   std::vector<int64_t> output_buffer_sizes_;
@@ -233,6 +283,67 @@ class JittedFunctionBase {
   absl::btree_map<std::string, int64_t> queue_indices_;
 };
 
+// A thread-safe pool of the input, output and temporary buffers needed to call
+// a jitted function. Buffers are returned to the pool when the lease holding
+// them is destroyed so repeated calls reuse the same aligned allocations
+// instead of allocating new buffers for each call. The pool holds as many
+// buffer sets as there have been concurrent leases.
+class JitBufferPool {
+ public:
+  struct Buffers {
+    JitArgumentSet inputs;
+    JitArgumentSet outputs;
+    JitTempBuffer temp;
+    // The number of evaluations `inputs` and `outputs` have room for. One for
+    // buffers created by `Acquire`.
+    int64_t batch_capacity;
+  };
+
+  // Exclusive use of a set of buffers until destruction.
+  class Lease {
+   public:
+    Lease(Lease&& other) = default;
+    Lease& operator=(Lease&& other) = delete;
+    ~Lease() {
+      if (buffers_ != nullptr) {
+        pool_->Release(std::move(buffers_), batched_);
+      }
+    }
+
+    Buffers& operator*() const { return *buffers_; }
+    Buffers* operator->() const { return buffers_.get(); }
+
+   private:
+    Lease(JitBufferPool* pool, std::unique_ptr<Buffers> buffers, bool batched)
+        : pool_(pool), buffers_(std::move(buffers)), batched_(batched) {}
+
+    JitBufferPool* pool_;
+    std::unique_ptr<Buffers> buffers_;
+    bool batched_;
+
+    friend class JitBufferPool;
+  };
+
+  // `function` must outlive the pool.
+  explicit JitBufferPool(const JittedFunctionBase* function)
+      : function_(function) {}
+
+  // Returns buffers for a single call of the function.
+  Lease Acquire();
+
+  // Returns buffers for a call of the batched function with at most
+  // `batch_size` evaluations, as created by CreateBatchedInputBuffer etc.
+  Lease AcquireBatched(int64_t batch_size);
+
+ private:
+  void Release(std::unique_ptr<Buffers> buffers, bool batched);
+
+  const JittedFunctionBase* function_;
+  absl::Mutex mutex_;
+  std::vector<std::unique_ptr<Buffers>> free_ ABSL_GUARDED_BY(mutex_);
+  std::vector<std::unique_ptr<Buffers>> free_batched_ ABSL_GUARDED_BY(mutex_);
+};
+
 }  // namespace xls
 
 #endif  // XLS_JIT_FUNCTION_BASE_JIT_H_
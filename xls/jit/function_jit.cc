@@ -15,11 +15,13 @@
 #include "xls/jit/function_jit.h"
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/base/casts.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -27,6 +29,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
@@ -36,22 +39,37 @@
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
 #include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
 
 namespace xls {
+namespace {
+
+bool IsAligned(const void* ptr, int64_t alignment) {
+  return absl::bit_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+}  // namespace
 
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::Create(
     Function* xls_function, int64_t opt_level, JitObserver* observer) {
-  return CreateInternal(xls_function, opt_level, /*emit_object_code=*/false,
+  return CreateInternal(xls_function, JitOptions{.opt_level = opt_level},
+                        /*emit_object_code=*/false, observer);
+}
+
+absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::Create(
+    Function* xls_function, const JitOptions& options, JitObserver* observer) {
+  return CreateInternal(xls_function, options, /*emit_object_code=*/false,
                         observer);
 }
 
 absl::StatusOr<JitObjectCode> FunctionJit::CreateObjectCode(
     Function* xls_function, int64_t opt_level, JitObserver* observer) {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
-                       CreateInternal(xls_function, opt_level,
+                       CreateInternal(xls_function,
+                                      JitOptions{.opt_level = opt_level},
                                       /*emit_object_code=*/true, observer));
   return JitObjectCode{
       .function_name = std::string{jit->GetJittedFunctionName()},
@@ -71,23 +89,39 @@ absl::StatusOr<JitObjectCode> FunctionJit::CreateObjectCode(
 }
 
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateInternal(
-    Function* xls_function, int64_t opt_level, bool emit_object_code,
+    Function* xls_function, const JitOptions& options, bool emit_object_code,
     JitObserver* observer) {
   XLS_ASSIGN_OR_RETURN(auto orc_jit,
-                       OrcJit::Create(opt_level, emit_object_code, observer));
-  XLS_ASSIGN_OR_RETURN(
-      llvm::DataLayout data_layout,
-      OrcJit::CreateDataLayout(/*aot_specification=*/emit_object_code));
+                       OrcJit::Create(options, emit_object_code, observer));
+  // The host runtime is shared by all jits. Only the AOT data layout, which
+  // may differ from the host's, needs a runtime of its own.
+  std::unique_ptr<JitRuntime> owned_runtime;
+  JitRuntime* runtime;
+  if (emit_object_code) {
+    XLS_ASSIGN_OR_RETURN(
+        llvm::DataLayout data_layout,
+        OrcJit::CreateDataLayout(/*aot_specification=*/true));
+    owned_runtime = std::make_unique<JitRuntime>(data_layout);
+    runtime = owned_runtime.get();
+  } else {
+    XLS_ASSIGN_OR_RETURN(runtime, JitRuntime::GetShared());
+  }
   XLS_ASSIGN_OR_RETURN(auto function_base,
                        JittedFunctionBase::Build(xls_function, *orc_jit));
+  if (options.release_llvm_context) {
+    orc_jit->ReleaseLlvmContext();
+  }
+  if (observer != nullptr && observer->GetNotificationOptions().memory_usage) {
+    observer->CompiledMemoryUsage(xls_function, orc_jit->GetMemoryUsage());
+  }
 
   return std::unique_ptr<FunctionJit>(new FunctionJit(
-      xls_function, std::move(orc_jit), std::move(function_base),
-      std::make_unique<JitRuntime>(data_layout)));
+      xls_function, std::move(orc_jit), std::move(function_base), runtime,
+      std::move(owned_runtime)));
 }
 
-absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
-    absl::Span<const Value> args) {
+absl::Status FunctionJit::WriteArgs(absl::Span<const Value> args,
+                                    JitArgumentSet& inputs) {
   absl::Span<Param* const> params = xls_function_->params();
   if (args.size() != params.size()) {
     return absl::InvalidArgumentError(absl::StrFormat(
@@ -103,26 +137,51 @@ absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
     }
   }
 
-  std::vector<Type*> param_types;
-  for (const Param* param : xls_function_->params()) {
-    param_types.push_back(param->GetType());
+  for (int64_t i = 0; i < params.size(); ++i) {
+    jit_runtime_->BlitValueToBuffer(
+        args[i], params[i]->GetType(),
+        absl::MakeSpan(inputs.pointers()[i], GetArgTypeSize(i)));
   }
+  return absl::OkStatus();
+}
 
-  // Allocate argument buffers and copy in arg Values.
-  XLS_RETURN_IF_ERROR(
-      jit_runtime_->PackArgs(args, param_types, arg_buffers_.pointers()));
-
+InterpreterResult<Value> FunctionJit::RunAndUnpack(const JitArgumentSet& inputs,
+                                                   JitArgumentSet& outputs,
+                                                   JitTempBuffer& temp_buffer) {
   InterpreterEvents events;
   jitted_function_base_.RunJittedFunction(
-      arg_buffers_, result_buffers_, temp_buffer_, &events,
+      inputs, outputs, temp_buffer, &events,
       /*instance_context=*/nullptr, /*jit_runtime=*/runtime(),
       /*continuation_point=*/0);
   Value result = jit_runtime_->UnpackBuffer(
-      result_buffers_.pointers()[0], xls_function_->return_value()->GetType());
-
+      outputs.pointers()[0], xls_function_->return_value()->GetType());
   return InterpreterResult<Value>{std::move(result), std::move(events)};
 }
 
+absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
+    absl::Span<const Value> args) {
+  // Copy the arg Values into pooled argument buffers.
+  JitBufferPool::Lease buffers = buffer_pool_.Acquire();
+  XLS_RETURN_IF_ERROR(WriteArgs(args, buffers->inputs));
+  return RunAndUnpack(buffers->inputs, buffers->outputs, buffers->temp);
+}
+
+FunctionJitContext FunctionJit::CreateContext() {
+  return FunctionJitContext(this);
+}
+
+absl::StatusOr<InterpreterResult<Value>> FunctionJitContext::Run(
+    absl::Span<const Value> args) {
+  XLS_RETURN_IF_ERROR(jit_->WriteArgs(args, inputs_));
+  return jit_->RunAndUnpack(inputs_, outputs_, temp_);
+}
+
+void FunctionJitContext::RunInPlace(InterpreterEvents* events) {
+  jit_->jitted_function_base_.RunJittedFunction(
+      inputs_, outputs_, temp_, events, /*instance_context=*/nullptr,
+      jit_->runtime(), /*continuation_point=*/0);
+}
+
 absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
     const absl::flat_hash_map<std::string, Value>& kwargs) {
   XLS_ASSIGN_OR_RETURN(std::vector<Value> positional_args,
@@ -130,6 +189,113 @@ absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
   return Run(positional_args);
 }
 
+absl::StatusOr<InterpreterResult<std::vector<Value>>> FunctionJit::RunBatched(
+    absl::Span<const std::vector<Value>> args) {
+  absl::Span<Param* const> params = xls_function_->params();
+  for (const std::vector<Value>& arg_set : args) {
+    if (arg_set.size() != params.size()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Arg list to '%s' has the wrong size: %d vs expected %d.",
+          xls_function_->name(), arg_set.size(), params.size()));
+    }
+    for (int i = 0; i < params.size(); i++) {
+      if (!ValueConformsToType(arg_set[i], params[i]->GetType())) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Got argument %s for parameter %d which is not of type %s",
+            arg_set[i].ToString(), i, params[i]->GetType()->ToString()));
+      }
+    }
+  }
+
+  int64_t batch_size = args.size();
+  JitBufferPool::Lease buffers = buffer_pool_.AcquireBatched(batch_size);
+  JitArgumentSet& batched_args = buffers->inputs;
+  JitArgumentSet& batched_results = buffers->outputs;
+  for (int64_t i = 0; i < params.size(); ++i) {
+    int64_t arg_size = GetArgTypeSize(i);
+    for (int64_t j = 0; j < batch_size; ++j) {
+      jit_runtime_->BlitValueToBuffer(
+          args[j][i], params[i]->GetType(),
+          absl::MakeSpan(batched_args.pointers()[i] + j * arg_size, arg_size));
+    }
+  }
+
+  InterpreterEvents events;
+  XLS_RET_CHECK(jitted_function_base_
+                    .RunBatchedJittedFunction(
+                        batched_args.get(), batched_results.get(),
+                        buffers->temp.get(), &events, runtime(), batch_size)
+                    .has_value());
+
+  std::vector<Value> results;
+  results.reserve(batch_size);
+  Type* return_type = xls_function_->return_value()->GetType();
+  for (int64_t j = 0; j < batch_size; ++j) {
+    results.push_back(jit_runtime_->UnpackBuffer(
+        batched_results.pointers()[0] + j * GetReturnTypeSize(), return_type));
+  }
+  return InterpreterResult<std::vector<Value>>{std::move(results),
+                                               std::move(events)};
+}
+
+absl::Status FunctionJit::RunBatchedWithViews(int64_t batch_size,
+                                              absl::Span<uint8_t* const> args,
+                                              absl::Span<uint8_t> result_buffer,
+                                              InterpreterEvents* events) {
+  absl::Span<Param* const> params = xls_function_->params();
+  if (args.size() != params.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Arg list has the wrong size: %d vs expected %d.",
+                        args.size(), xls_function_->params().size()));
+  }
+  if (result_buffer.size() < GetReturnTypeSize() * batch_size) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Result buffer too small - must be at least %d bytes!",
+        GetReturnTypeSize() * batch_size));
+  }
+  for (int64_t i = 0; i < args.size(); ++i) {
+    if (absl::bit_cast<uintptr_t>(args[i]) % GetArgTypeAlignment(i) != 0) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Argument %d buffer is not aligned to %d bytes", i,
+                          GetArgTypeAlignment(i)));
+    }
+  }
+  if (absl::bit_cast<uintptr_t>(result_buffer.data()) %
+          GetReturnTypeAlignment() !=
+      0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Result buffer is not aligned to %d bytes",
+                        GetReturnTypeAlignment()));
+  }
+
+  uint8_t* output_buffers[1] = {result_buffer.data()};
+  JitBufferPool::Lease buffers = buffer_pool_.Acquire();
+  XLS_RET_CHECK(jitted_function_base_
+                    .RunBatchedJittedFunction(args.data(), output_buffers,
+                                              buffers->temp.get(), events,
+                                              runtime(), batch_size)
+                    .has_value());
+  return absl::OkStatus();
+}
+
+absl::Status FunctionJit::RunWithBuffers(const JitArgumentSet& inputs,
+                                         JitArgumentSet& outputs,
+                                         JitTempBuffer& temp_buffer,
+                                         InterpreterEvents* events) {
+  XLS_RET_CHECK_EQ(inputs.source(), &jitted_function_base_)
+      << "Input buffer was not created for this function";
+  XLS_RET_CHECK_EQ(outputs.source(), &jitted_function_base_)
+      << "Output buffer was not created for this function";
+  XLS_RET_CHECK_EQ(temp_buffer.source(), &jitted_function_base_)
+      << "Temporary buffer was not created for this function";
+  XLS_RET_CHECK(inputs.is_inputs());
+  XLS_RET_CHECK(outputs.is_outputs());
+  jitted_function_base_.RunJittedFunction(
+      inputs, outputs, temp_buffer, events, /*instance_context=*/nullptr,
+      runtime(), /*continuation_point=*/0);
+  return absl::OkStatus();
+}
+
 template <bool kForceZeroCopy>
 absl::Status FunctionJit::RunWithViews(absl::Span<uint8_t* const> args,
                                        absl::Span<uint8_t> result_buffer,
@@ -163,9 +329,30 @@ template <bool kForceZeroCopy>
 void FunctionJit::InvokeUnalignedJitFunction(
     absl::Span<const uint8_t* const> arg_buffers, uint8_t* output_buffer,
     InterpreterEvents* events) {
+  JitBufferPool::Lease buffers = buffer_pool_.Acquire();
   uint8_t* output_buffers[1] = {output_buffer};
-  jitted_function_base_.RunUnalignedJittedFunction<kForceZeroCopy>(
-      arg_buffers.data(), output_buffers, temp_buffer_.get(), events,
+  if constexpr (!kForceZeroCopy) {
+    // Copy misaligned arguments and results through the pooled buffers rather
+    // than letting the jitted function base allocate aligned copies.
+    bool aligned = IsAligned(output_buffer, GetReturnTypeAlignment());
+    for (int64_t i = 0; aligned && i < arg_buffers.size(); ++i) {
+      aligned = IsAligned(arg_buffers[i], GetArgTypeAlignment(i));
+    }
+    if (!aligned) {
+      for (int64_t i = 0; i < arg_buffers.size(); ++i) {
+        memcpy(buffers->inputs.pointers()[i], arg_buffers[i],
+               GetArgTypeSize(i));
+      }
+      jitted_function_base_.RunJittedFunction(
+          buffers->inputs, buffers->outputs, buffers->temp, events,
+          /*instance_context=*/nullptr, runtime(), /*continuation_point=*/0);
+      memcpy(output_buffer, buffers->outputs.pointers()[0],
+             GetReturnTypeSize());
+      return;
+    }
+  }
+  jitted_function_base_.RunUnalignedJittedFunction</*kForceZeroCopy=*/true>(
+      arg_buffers.data(), output_buffers, buffers->temp.get(), events,
       /*instance_context=*/nullptr, runtime(), /*continuation=*/0);
 }
 
@@ -57,10 +57,14 @@ struct JitObjectCode {
   int64_t temp_buffer_alignment;
 };
 
+class FunctionJitContext;
+
 // This class provides a facility to execute XLS functions (on the host) by
-// converting it to LLVM IR, compiling it, and finally executing it. Not
-// thread-safe due to sharing of result and temporary buffers between
-// invocations of Run.
+// converting it to LLVM IR, compiling it, and finally executing it. The Run
+// methods may be called concurrently; each call takes its argument, result and
+// temporary buffers from a pool so that repeated calls do not allocate.
+// Threads which call the function many times can instead each run it through
+// their own FunctionJitContext, which avoids the pool.
 class FunctionJit {
  public:
   // Returns an object containing a host-compiled version of the specified XLS
@@ -69,6 +73,12 @@ class FunctionJit {
       Function* xls_function, int64_t opt_level = 3,
       JitObserver* observer = nullptr);
 
+  // As above with the compilation given by `options`, e.g., to select a
+  // quick-compiling pipeline for short runs.
+  static absl::StatusOr<std::unique_ptr<FunctionJit>> Create(
+      Function* xls_function, const JitOptions& options,
+      JitObserver* observer = nullptr);
+
   // Returns the bytes of an object file containing the compiled XLS function.
   static absl::StatusOr<JitObjectCode> CreateObjectCode(
       Function* xls_function, int64_t opt_level = 3,
@@ -77,6 +87,10 @@ class FunctionJit {
   // Executes the compiled function with the specified arguments.
   absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
 
+  // Returns a new execution context for calling the function from one thread.
+  // See FunctionJitContext.
+  FunctionJitContext CreateContext();
+
   // As above, buth with arguments as key-value pairs.
   absl::StatusOr<InterpreterResult<Value>> Run(
       const absl::flat_hash_map<std::string, Value>& kwargs);
@@ -98,6 +112,36 @@ class FunctionJit {
                             absl::Span<uint8_t> result_buffer,
                             InterpreterEvents* events);
 
+  // Executes the compiled function with caller-owned buffers created with
+  // jitted_function_base().CreateInputBuffer(), CreateOutputBuffer() and
+  // CreateTempBuffer(). The arguments must already be in the native LLVM data
+  // layout (e.g., written with runtime()->BlitValueToBuffer()). Nothing is
+  // allocated or copied, so this is the cheapest way to call the function
+  // repeatedly from a single thread.
+  absl::Status RunWithBuffers(const JitArgumentSet& inputs,
+                              JitArgumentSet& outputs,
+                              JitTempBuffer& temp_buffer,
+                              InterpreterEvents* events);
+
+  // Executes the compiled function on each of the given argument sets with a
+  // single call into the jitted code. The jitted code loops over the batch
+  // which avoids the per-call overhead of `Run` and lets LLVM optimize (e.g.,
+  // vectorize) across evaluations. Events from all evaluations are accumulated
+  // in the returned result.
+  absl::StatusOr<InterpreterResult<std::vector<Value>>> RunBatched(
+      absl::Span<const std::vector<Value>> args);
+
+  // Batched version of RunWithViews(). `args[i]` points to `batch_size`
+  // contiguous values of the i-th argument in the native LLVM data layout, each
+  // occupying GetArgTypeSize(i) bytes. `result_buffer` receives `batch_size`
+  // return values, each occupying GetReturnTypeSize() bytes. Buffers must be
+  // aligned to GetArgTypeAlignment(i) and GetReturnTypeAlignment()
+  // respectively.
+  absl::Status RunBatchedWithViews(int64_t batch_size,
+                                   absl::Span<uint8_t* const> args,
+                                   absl::Span<uint8_t> result_buffer,
+                                   InterpreterEvents* events);
+
   // Similar to RunWithViews(), except the arguments here are _packed_views_ -
   // views whose data elements are tightly packed, with no padding bits or bytes
   // between them. The function return value is specified as the last arg - its
@@ -126,8 +170,9 @@ class FunctionJit {
 
     InterpreterEvents events;
     uint8_t* output_buffers[1] = {result_buffer};
+    JitBufferPool::Lease buffers = buffer_pool_.Acquire();
     jitted_function_base_.RunPackedJittedFunction(
-        arg_buffers, output_buffers, temp_buffer_.get(), &events,
+        arg_buffers, output_buffers, buffers->temp.get(), &events,
         /*instance_context=*/nullptr, runtime(), /*continuation_point=*/0);
 
     return InterpreterEventsToStatus(events);
@@ -198,23 +243,31 @@ class FunctionJit {
     return jitted_function_base_.function_name();
   }
 
-  JitRuntime* runtime() const { return jit_runtime_.get(); }
+  JitRuntime* runtime() const { return jit_runtime_; }
 
  private:
   FunctionJit(Function* xls_function, std::unique_ptr<OrcJit>&& orc_jit,
-              JittedFunctionBase&& jitted_function_base,
-              std::unique_ptr<JitRuntime>&& runtime)
+              JittedFunctionBase&& jitted_function_base, JitRuntime* runtime,
+              std::unique_ptr<JitRuntime>&& owned_runtime)
       : xls_function_(xls_function),
         orc_jit_(std::move(orc_jit)),
         jitted_function_base_(std::move(jitted_function_base)),
-        arg_buffers_(jitted_function_base_.CreateInputBuffer()),
-        result_buffers_(jitted_function_base_.CreateOutputBuffer()),
-        temp_buffer_(jitted_function_base_.CreateTempBuffer()),
-        jit_runtime_(std::move(runtime)) {}
+        buffer_pool_(&jitted_function_base_),
+        jit_runtime_(runtime),
+        owned_runtime_(std::move(owned_runtime)) {}
 
   static absl::StatusOr<std::unique_ptr<FunctionJit>> CreateInternal(
-      Function* xls_function, int64_t opt_level, bool emit_object_code,
-      JitObserver* observer);
+      Function* xls_function, const JitOptions& options,
+      bool emit_object_code, JitObserver* observer);
+
+  // Checks that `args` match the parameters of the function and writes them to
+  // `inputs` in the native layout.
+  absl::Status WriteArgs(absl::Span<const Value> args, JitArgumentSet& inputs);
+
+  // Runs the function on `inputs` and returns the result with the events.
+  InterpreterResult<Value> RunAndUnpack(const JitArgumentSet& inputs,
+                                        JitArgumentSet& outputs,
+                                        JitTempBuffer& temp_buffer);
 
   template <bool kForceZeroCopy, typename... ArgsT>
   absl::Status RunWithUnpackedViewsCommon(ArgsT... args) {
@@ -279,15 +332,56 @@ class FunctionJit {
 
   JittedFunctionBase jitted_function_base_;
 
-  // Pre-allocated & aligned storage for a set of arguments. Not thread safe.
-  JitArgumentSet arg_buffers_;
-  // Pre-allocated & aligned storage for a result. Not thread safe.
-  JitArgumentSet result_buffers_;
-  // Pre-allocated & aligned storage for required temporary storage. NB Not
-  // thread safe.
-  JitTempBuffer temp_buffer_;
+  // Aligned argument, result and temporary storage reused across calls.
+  JitBufferPool buffer_pool_;
+
+  // Either the shared host runtime or `owned_runtime_`.
+  JitRuntime* jit_runtime_;
+  std::unique_ptr<JitRuntime> owned_runtime_;
+
+  friend class FunctionJitContext;
+};
 
-  std::unique_ptr<JitRuntime> jit_runtime_;
+// The buffers for calling a FunctionJit from a single thread. Any number of
+// threads may share one FunctionJit, each running it through its own context,
+// so the function is compiled only once. A context holds its own argument,
+// result and temporary buffers, so running through it takes no lock and does
+// not allocate beyond the construction of the result Value.
+//
+// A context must not be used by two threads at once and must not outlive the
+// FunctionJit which created it.
+class FunctionJitContext {
+ public:
+  FunctionJitContext(FunctionJitContext&&) = default;
+  FunctionJitContext& operator=(FunctionJitContext&&) = default;
+
+  // Executes the compiled function with the specified arguments.
+  absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
+
+  // Executes the compiled function on the arguments in arg_buffers(), which
+  // the caller writes in the native LLVM data layout (see
+  // FunctionJit::GetArgTypeSize), leaving the return value in result_buffer().
+  // Neither the arguments nor the result are converted to or from Values.
+  void RunInPlace(InterpreterEvents* events);
+
+  absl::Span<uint8_t* const> arg_buffers() const { return inputs_.pointers(); }
+  const uint8_t* result_buffer() const { return outputs_.pointers()[0]; }
+
+  FunctionJit* jit() const { return jit_; }
+
+ private:
+  explicit FunctionJitContext(FunctionJit* jit)
+      : jit_(jit),
+        inputs_(jit->jitted_function_base_.CreateInputBuffer()),
+        outputs_(jit->jitted_function_base_.CreateOutputBuffer()),
+        temp_(jit->jitted_function_base_.CreateTempBuffer()) {}
+
+  FunctionJit* jit_;
+  JitArgumentSet inputs_;
+  JitArgumentSet outputs_;
+  JitTempBuffer temp_;
+
+  friend class FunctionJit;
 };
 
 }  // namespace xls
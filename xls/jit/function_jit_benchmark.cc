@@ -0,0 +1,215 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/types/span.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/benchmark_support.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_buffer.h"
+
+namespace xls {
+namespace {
+
+// Measure the throughput of evaluating a function on many argument sets one
+// call at a time versus with the batched entry point.
+constexpr int kNumFunctions = 3;
+const char* kFunctions[] = {
+    R"(
+fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  add.1: bits[32] = add(x, y)
+  ret umul.2: bits[32] = umul(add.1, y)
+}
+)",
+    R"(
+fn f(x: bits[64], y: bits[64]) -> bits[64] {
+  xor.1: bits[64] = xor(x, y)
+  literal.2: bits[64] = literal(value=13)
+  shll.3: bits[64] = shll(xor.1, literal.2)
+  ret add.4: bits[64] = add(shll.3, x)
+}
+)",
+    R"(
+fn f(x: (bits[8], bits[16], bits[32]), y: bits[32]) -> (bits[32], bits[1]) {
+  tuple_index.1: bits[8] = tuple_index(x, index=0)
+  tuple_index.2: bits[16] = tuple_index(x, index=1)
+  tuple_index.3: bits[32] = tuple_index(x, index=2)
+  zero_ext.4: bits[32] = zero_ext(tuple_index.1, new_bit_count=32)
+  sign_ext.5: bits[32] = sign_ext(tuple_index.2, new_bit_count=32)
+  add.6: bits[32] = add(zero_ext.4, sign_ext.5)
+  sub.7: bits[32] = sub(tuple_index.3, y)
+  umul.8: bits[32] = umul(add.6, sub.7)
+  ult.9: bits[1] = ult(umul.8, y)
+  ret tuple.10: (bits[32], bits[1]) = tuple(umul.8, ult.9)
+}
+)",
+};
+
+struct BenchmarkFunction {
+  std::unique_ptr<Package> package;
+  std::unique_ptr<FunctionJit> jit;
+  std::vector<std::vector<Value>> args;
+};
+
+BenchmarkFunction CreateBenchmarkFunction(int64_t index, int64_t batch_size) {
+  BenchmarkFunction result;
+  result.package = std::make_unique<Package>("BM");
+  Function* function =
+      Parser::ParseFunction(kFunctions[index], result.package.get()).value();
+  result.jit = FunctionJit::Create(function).value();
+  std::minstd_rand bitgen;
+  for (int64_t i = 0; i < batch_size; ++i) {
+    std::vector<Value> arg_set;
+    for (Param* param : function->params()) {
+      arg_set.push_back(RandomValue(param->GetType(), bitgen));
+    }
+    result.args.push_back(std::move(arg_set));
+  }
+  return result;
+}
+
+// Evaluates each argument set with a separate call to Run.
+static void BM_Run(benchmark::State& state) {
+  int64_t batch_size = state.range(1);
+  BenchmarkFunction f = CreateBenchmarkFunction(state.range(0), batch_size);
+  for (auto _ : state) {
+    for (const std::vector<Value>& arg_set : f.args) {
+      benchmark::DoNotOptimize(f.jit->Run(arg_set).value());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+// Evaluates all argument sets with a single call to RunBatched.
+static void BM_RunBatched(benchmark::State& state) {
+  int64_t batch_size = state.range(1);
+  BenchmarkFunction f = CreateBenchmarkFunction(state.range(0), batch_size);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(f.jit->RunBatched(f.args).value());
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+// Evaluates argument sets already in the native layout with a separate call to
+// RunWithViews for each argument set.
+static void BM_RunWithViews(benchmark::State& state) {
+  int64_t batch_size = state.range(1);
+  BenchmarkFunction f = CreateBenchmarkFunction(state.range(0), batch_size);
+  const JittedFunctionBase& base = f.jit->jitted_function_base();
+  JitArgumentSet inputs = base.CreateBatchedInputBuffer(batch_size);
+  JitArgumentSet outputs = base.CreateBatchedOutputBuffer(batch_size);
+  int64_t arg_count = base.input_buffer_sizes().size();
+  std::vector<uint8_t*> args(arg_count);
+  InterpreterEvents events;
+  for (auto _ : state) {
+    for (int64_t i = 0; i < batch_size; ++i) {
+      for (int64_t j = 0; j < arg_count; ++j) {
+        args[j] = inputs.pointers()[j] + i * base.input_buffer_sizes()[j];
+      }
+      CHECK_OK(f.jit->RunWithViews</*kForceZeroCopy=*/true>(
+          args,
+          absl::MakeSpan(
+              outputs.pointers()[0] + i * base.output_buffer_sizes()[0],
+              base.output_buffer_sizes()[0]),
+          &events));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+// Evaluates argument sets already in the native layout with a single call to
+// RunBatchedWithViews.
+static void BM_RunBatchedWithViews(benchmark::State& state) {
+  int64_t batch_size = state.range(1);
+  BenchmarkFunction f = CreateBenchmarkFunction(state.range(0), batch_size);
+  const JittedFunctionBase& base = f.jit->jitted_function_base();
+  JitArgumentSet inputs = base.CreateBatchedInputBuffer(batch_size);
+  JitArgumentSet outputs = base.CreateBatchedOutputBuffer(batch_size);
+  InterpreterEvents events;
+  for (auto _ : state) {
+    CHECK_OK(f.jit->RunBatchedWithViews(
+        batch_size, inputs.pointers(),
+        absl::MakeSpan(outputs.pointers()[0],
+                       base.output_buffer_sizes()[0] * batch_size),
+        &events));
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+// Measures the time to compile generated functions of increasing size, and
+// reports its complexity in the size.
+static void BM_Compile(benchmark::State& state,
+                       benchmark_support::ScalingDesign design) {
+  Package package("BM");
+  FunctionBase* f = benchmark_support::GenerateScalingDesign(
+                        design, &package, state.range(0))
+                        .value();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        FunctionJit::Create(f->AsFunctionOrDie()).value());
+  }
+  state.counters["nodes"] = f->node_count();
+  state.SetComplexityN(state.range(0));
+}
+
+void BatchArgs(benchmark::internal::Benchmark* b) {
+  for (int64_t f = 0; f < kNumFunctions; ++f) {
+    for (int64_t batch_size : {1, 64, 4096}) {
+      b->Args({f, batch_size});
+    }
+  }
+}
+
+BENCHMARK(BM_Run)->Apply(BatchArgs);
+BENCHMARK(BM_RunBatched)->Apply(BatchArgs);
+BENCHMARK(BM_RunWithViews)->Apply(BatchArgs);
+BENCHMARK(BM_RunBatchedWithViews)->Apply(BatchArgs);
+
+void ScalingArgs(benchmark::internal::Benchmark* b) {
+  b->RangeMultiplier(4)
+      ->Range(16, 1024)
+      ->Complexity()
+      ->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_CAPTURE(BM_Compile, chain, benchmark_support::ScalingDesign::kChain)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_Compile, balanced_tree,
+                  benchmark_support::ScalingDesign::kBalancedTree)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_Compile, ladder, benchmark_support::ScalingDesign::kLadder)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_Compile, large_select,
+                  benchmark_support::ScalingDesign::kLargeSelect)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_Compile, dynamic_array,
+                  benchmark_support::ScalingDesign::kDynamicArray)
+    ->Apply(ScalingArgs);
+
+}  // namespace
+}  // namespace xls
+
+BENCHMARK_MAIN();
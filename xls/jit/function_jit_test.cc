@@ -31,6 +31,8 @@
 #include "gtest/gtest.h"
 #include "fuzztest/fuzztest.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/random/bit_gen_ref.h"
@@ -47,6 +49,7 @@
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/ir_evaluator_test_base.h"
 #include "xls/interpreter/random_value.h"
 #include "xls/ir/bits.h"
@@ -62,6 +65,7 @@
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
 
 namespace xls {
@@ -1032,6 +1036,365 @@ TEST(FunctionJitDeathTest, MisalignedPointerCaught) {
 #endif
 }
 
+TEST(FunctionJitTest, RunBatchedMatchesRun) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn f(x: bits[37], y: (bits[8], bits[3][4])) -> (bits[37], bits[3]) {
+    tuple_index.1: bits[8] = tuple_index(y, index=0)
+    tuple_index.2: bits[3][4] = tuple_index(y, index=1)
+    zero_ext.3: bits[37] = zero_ext(tuple_index.1, new_bit_count=37)
+    umul.4: bits[37] = umul(x, zero_ext.3)
+    bit_slice.5: bits[2] = bit_slice(x, start=0, width=2)
+    array_index.6: bits[3] = array_index(tuple_index.2, indices=[bit_slice.5])
+    ret tuple.7: (bits[37], bits[3]) = tuple(umul.4, array_index.6)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  std::minstd_rand bitgen;
+  std::vector<std::vector<Value>> args;
+  std::vector<Value> expected;
+  for (int64_t i = 0; i < 100; ++i) {
+    std::vector<Value> arg_set;
+    for (Param* param : function->params()) {
+      arg_set.push_back(RandomValue(param->GetType(), bitgen));
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(Value result, RunJitNoEvents(jit.get(), arg_set));
+    expected.push_back(result);
+    args.push_back(std::move(arg_set));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<std::vector<Value>> results,
+                           jit->RunBatched(args));
+  EXPECT_THAT(results.value, ElementsAreArray(expected));
+  EXPECT_TRUE(results.events.trace_msgs.empty());
+
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<std::vector<Value>> empty,
+                           jit->RunBatched({}));
+  EXPECT_TRUE(empty.value.empty());
+}
+
+TEST(FunctionJitTest, RunBatchedAccumulatesEvents) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn f(tkn: token, x: bits[8]) -> bits[8] {
+    literal.1: bits[8] = literal(value=3)
+    ult.2: bits[1] = ult(x, literal.1)
+    trace.3: token = trace(tkn, ult.2, format="small {}", data_operands=[x], id=3)
+    ret add.4: bits[8] = add(x, literal.1)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  std::vector<std::vector<Value>> args;
+  for (int64_t i = 0; i < 5; ++i) {
+    args.push_back({Value::Token(), Value(UBits(i, 8))});
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<std::vector<Value>> results,
+                           jit->RunBatched(args));
+  EXPECT_THAT(results.value,
+              ElementsAre(Value(UBits(3, 8)), Value(UBits(4, 8)),
+                          Value(UBits(5, 8)), Value(UBits(6, 8)),
+                          Value(UBits(7, 8))));
+  std::vector<std::string> trace_msgs;
+  for (const TraceMessage& trace : results.events.trace_msgs) {
+    trace_msgs.push_back(trace.message);
+  }
+  EXPECT_THAT(trace_msgs, ElementsAre("small 0", "small 1", "small 2"));
+}
+
+TEST(FunctionJitTest, Pipelines) {
+  Package package("my_package");
+  FunctionBuilder fb("f", &package);
+  BValue x = fb.Param("x", package.GetBitsType(32));
+  BValue y = fb.Param("y", package.GetBitsType(32));
+  fb.UMul(fb.Add(x, y), y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  for (JitPipeline pipeline : {JitPipeline::kDefault, JitPipeline::kStandard,
+                               JitPipeline::kQuick, JitPipeline::kThroughput}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        auto jit,
+        FunctionJit::Create(function, JitOptions{.pipeline = pipeline}));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        InterpreterResult<Value> result,
+        jit->Run({Value(UBits(3, 32)), Value(UBits(5, 32))}));
+    EXPECT_EQ(result.value, Value(UBits(40, 32)))
+        << JitPipelineToString(pipeline);
+  }
+}
+
+TEST(FunctionJitTest, JitPipelineFromString) {
+  EXPECT_THAT(JitPipelineFromString("standard"),
+              IsOkAndHolds(JitPipeline::kStandard));
+  EXPECT_THAT(JitPipelineFromString("quick"),
+              IsOkAndHolds(JitPipeline::kQuick));
+  EXPECT_THAT(JitPipelineFromString("throughput"),
+              IsOkAndHolds(JitPipeline::kThroughput));
+  EXPECT_THAT(JitPipelineFromString("fastest"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Unknown JIT pipeline")));
+}
+
+TEST(FunctionJitTest, InvalidPipelineFlag) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_jit_pipeline, "fastest");
+  Package package("my_package");
+  FunctionBuilder fb("f", &package);
+  fb.Param("x", package.GetBitsType(32));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  EXPECT_THAT(FunctionJit::Create(function),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Unknown JIT pipeline `fastest`")));
+}
+
+TEST(FunctionJitTest, CompileLargeFunctionOnManyThreads) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_jit_compile_threads, 4);
+  Package package("my_package");
+  FunctionBuilder fb("f", &package);
+  BValue x = fb.Param("x", package.GetBitsType(64));
+  BValue acc = x;
+  uint64_t x_value = 0x123456789abcdefull;
+  uint64_t expected = x_value;
+  // Large enough to be split into several parts.
+  for (int64_t i = 0; i < 1500; ++i) {
+    acc = fb.Xor(fb.Add(acc, fb.Literal(UBits(i, 64))), x);
+    expected = (expected + i) ^ x_value;
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit,
+                           FunctionJit::Create(function, /*opt_level=*/1));
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                           jit->Run({Value(UBits(x_value, 64))}));
+  EXPECT_EQ(result.value, Value(UBits(expected, 64)));
+}
+
+TEST(FunctionJitTest, LazyCompilationOfInvokedFunctions) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_jit_lazy_compilation, true);
+  Package package("my_package");
+  BitsType* u32 = package.GetBitsType(32);
+  FunctionBuilder increment_builder("increment", &package);
+  increment_builder.Add(increment_builder.Param("x", u32),
+                        increment_builder.Literal(UBits(1, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * increment, increment_builder.Build());
+  FunctionBuilder twice_builder("twice", &package);
+  BValue y = twice_builder.Param("y", u32);
+  twice_builder.Add(y, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * twice, twice_builder.Build());
+
+  FunctionBuilder fb("f", &package);
+  BValue x = fb.Param("x", u32);
+  BValue s = fb.Param("s", package.GetBitsType(1));
+  BValue incremented = fb.Invoke({x}, increment);
+  fb.Select(s, {incremented, fb.Invoke({incremented}, twice)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpreterResult<Value> result,
+      jit->Run({Value(UBits(20, 32)), Value(UBits(0, 1))}));
+  EXPECT_EQ(result.value, Value(UBits(21, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      result, jit->Run({Value(UBits(20, 32)), Value(UBits(1, 1))}));
+  EXPECT_EQ(result.value, Value(UBits(42, 32)));
+}
+
+class MemoryUsageObserver final : public JitObserver {
+ public:
+  JitObserverRequests GetNotificationOptions() const final {
+    return JitObserverRequests{.memory_usage = true};
+  }
+  void CompiledMemoryUsage(const FunctionBase* function,
+                           const JitMemoryUsage& usage) final {
+    usages_.push_back({function, usage});
+  }
+
+  const std::vector<std::pair<const FunctionBase*, JitMemoryUsage>>& usages()
+      const {
+    return usages_;
+  }
+
+ private:
+  std::vector<std::pair<const FunctionBase*, JitMemoryUsage>> usages_;
+};
+
+TEST(FunctionJitTest, ReleaseLlvmContextAndReportMemoryUsage) {
+  Package package("my_package");
+  FunctionBuilder fb("f", &package);
+  fb.Add(fb.Param("x", package.GetBitsType(32)),
+         fb.Param("y", package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  MemoryUsageObserver observer;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto jit, FunctionJit::Create(
+                    function, JitOptions{.release_llvm_context = true},
+                    &observer));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpreterResult<Value> result,
+      jit->Run({Value(UBits(20, 32)), Value(UBits(22, 32))}));
+  EXPECT_EQ(result.value, Value(UBits(42, 32)));
+
+  ASSERT_EQ(observer.usages().size(), 1);
+  EXPECT_EQ(observer.usages()[0].first, function);
+  EXPECT_GT(observer.usages()[0].second.code_bytes, 0);
+
+  // Jits for the host share one runtime.
+  XLS_ASSERT_OK_AND_ASSIGN(auto other_jit, FunctionJit::Create(function));
+  EXPECT_EQ(jit->runtime(), other_jit->runtime());
+}
+
+TEST(FunctionJitTest, RunBatchedWithViews) {
+  Package package("my_package");
+  FunctionBuilder fb("test", &package);
+  fb.Add(fb.Param("x", package.GetBitsType(32)),
+         fb.Param("y", package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  ASSERT_EQ(jit->GetArgTypeSize(0), sizeof(uint32_t));
+  ASSERT_EQ(jit->GetReturnTypeSize(), sizeof(uint32_t));
+
+  constexpr int64_t kBatchSize = 1000;
+  std::vector<uint32_t> x(kBatchSize);
+  std::vector<uint32_t> y(kBatchSize);
+  std::vector<uint32_t> result(kBatchSize);
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    x[i] = i * 12345;
+    y[i] = i + 0xfffffff0;
+  }
+  InterpreterEvents events;
+  XLS_ASSERT_OK(jit->RunBatchedWithViews(
+      kBatchSize,
+      {reinterpret_cast<uint8_t*>(x.data()),
+       reinterpret_cast<uint8_t*>(y.data())},
+      absl::MakeSpan(reinterpret_cast<uint8_t*>(result.data()),
+                     kBatchSize * sizeof(uint32_t)),
+      &events));
+  for (int64_t i = 0; i < kBatchSize; ++i) {
+    EXPECT_EQ(result[i], static_cast<uint32_t>(x[i] + y[i])) << i;
+  }
+
+  EXPECT_THAT(jit->RunBatchedWithViews(
+                  kBatchSize,
+                  {reinterpret_cast<uint8_t*>(x.data()),
+                   reinterpret_cast<uint8_t*>(y.data())},
+                  absl::MakeSpan(reinterpret_cast<uint8_t*>(result.data()),
+                                 kBatchSize),
+                  &events),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("too small")));
+}
+
+TEST(FunctionJitTest, RunWithBuffers) {
+  Package package("my_package");
+  FunctionBuilder fb("test", &package);
+  fb.UMul(fb.Param("x", package.GetBitsType(32)),
+          fb.Param("y", package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  JitArgumentSet inputs = jit->jitted_function_base().CreateInputBuffer();
+  JitArgumentSet outputs = jit->jitted_function_base().CreateOutputBuffer();
+  JitTempBuffer temp = jit->jitted_function_base().CreateTempBuffer();
+  for (uint32_t i = 0; i < 10; ++i) {
+    uint32_t x = i * 7;
+    uint32_t y = i + 3;
+    memcpy(inputs.pointers()[0], &x, sizeof(x));
+    memcpy(inputs.pointers()[1], &y, sizeof(y));
+    InterpreterEvents events;
+    XLS_ASSERT_OK(jit->RunWithBuffers(inputs, outputs, temp, &events));
+    uint32_t result;
+    memcpy(&result, outputs.pointers()[0], sizeof(result));
+    EXPECT_EQ(result, x * y);
+  }
+
+  // Buffers of another function are rejected.
+  XLS_ASSERT_OK_AND_ASSIGN(auto other_jit, FunctionJit::Create(function));
+  InterpreterEvents events;
+  EXPECT_THAT(other_jit->RunWithBuffers(inputs, outputs, temp, &events),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("not created for this function")));
+}
+
+TEST(FunctionJitTest, RunOnManyThreads) {
+  Package package("my_package");
+  FunctionBuilder fb("test", &package);
+  BValue x = fb.Param("x", package.GetBitsType(64));
+  fb.Add(fb.UMul(x, x), fb.Literal(UBits(1, 64)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  constexpr int64_t kThreadCount = 4;
+  constexpr uint64_t kIterations = 1000;
+  std::vector<std::unique_ptr<Thread>> threads;
+  std::vector<int64_t> mismatches(kThreadCount, 0);
+  for (int64_t t = 0; t < kThreadCount; ++t) {
+    threads.push_back(std::make_unique<Thread>([&, t]() {
+      for (uint64_t i = 0; i < kIterations; ++i) {
+        uint64_t value = t * kIterations + i;
+        std::vector<Value> args = {Value(UBits(value, 64))};
+        absl::StatusOr<InterpreterResult<Value>> result = jit->Run(args);
+        if (!result.ok() ||
+            result->value != Value(UBits(value * value + 1, 64))) {
+          ++mismatches[t];
+        }
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  EXPECT_THAT(mismatches, testing::Each(0));
+}
+
+TEST(FunctionJitTest, RunWithContextsOnManyThreads) {
+  Package package("my_package");
+  FunctionBuilder fb("test", &package);
+  BValue x = fb.Param("x", package.GetBitsType(64));
+  fb.Add(fb.UMul(x, x), fb.Literal(UBits(1, 64)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  constexpr int64_t kThreadCount = 4;
+  constexpr uint64_t kIterations = 1000;
+  std::vector<std::unique_ptr<Thread>> threads;
+  std::vector<int64_t> mismatches(kThreadCount, 0);
+  for (int64_t t = 0; t < kThreadCount; ++t) {
+    threads.push_back(std::make_unique<Thread>([&, t]() {
+      FunctionJitContext context = jit->CreateContext();
+      for (uint64_t i = 0; i < kIterations; ++i) {
+        uint64_t value = t * kIterations + i;
+        uint64_t expected = value * value + 1;
+        if (i % 2 == 0) {
+          std::vector<Value> args = {Value(UBits(value, 64))};
+          absl::StatusOr<InterpreterResult<Value>> result = context.Run(args);
+          if (!result.ok() || result->value != Value(UBits(expected, 64))) {
+            ++mismatches[t];
+          }
+        } else {
+          memcpy(context.arg_buffers()[0], &value, sizeof(value));
+          InterpreterEvents events;
+          context.RunInPlace(&events);
+          uint64_t result;
+          memcpy(&result, context.result_buffer(), sizeof(result));
+          if (result != expected) {
+            ++mismatches[t];
+          }
+        }
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  EXPECT_THAT(mismatches, testing::Each(0));
+
+  FunctionJitContext context = jit->CreateContext();
+  EXPECT_THAT(context.Run({}), StatusIs(absl::StatusCode::kInvalidArgument,
+                                        HasSubstr("wrong size")));
+}
+
 // Check that expected_data matched output_data.
 // Log values of expected_data, output_data, and whatever entries are in
 // extra_data.
@@ -35,6 +35,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "llvm/include/llvm/ADT/APInt.h"
 #include "llvm/include/llvm/IR/BasicBlock.h"
 #include "llvm/include/llvm/IR/Constants.h"
 #include "llvm/include/llvm/IR/DerivedTypes.h"
@@ -59,6 +60,7 @@
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
+#include "xls/ir/proc.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
@@ -68,6 +70,19 @@
 
 namespace xls {
 
+// Shims which let JITted procs read from and write to channel queues. These
+// have C linkage and external visibility so ahead-of-time compiled procs can
+// reference them by name.
+extern "C" bool xls_jit_queue_receive(InstanceContext* instance_context,
+                                      int64_t queue_index, uint8_t* buffer) {
+  return instance_context->channel_queues[queue_index]->ReadRaw(buffer);
+}
+
+extern "C" void xls_jit_queue_send(InstanceContext* instance_context,
+                                   int64_t queue_index, const uint8_t* data) {
+  instance_context->channel_queues[queue_index]->WriteRaw(data);
+}
+
 bool ShouldMaterializeAtUse(Node* node) {
   // Only materialize Bits typed literals at their use. Array and tuple typed
   // literals are typically manipulated via pointer in the JITted code so these
@@ -76,6 +91,29 @@ bool ShouldMaterializeAtUse(Node* node) {
   return node->Is<Literal>() && node->GetType()->IsBits();
 }
 
+bool IsInPlaceStateUpdate(Node* node) {
+  if (!node->Is<ArrayUpdate>() || !node->function_base()->IsProc() ||
+      node->users().size() != 1) {
+    return false;
+  }
+  Node* array = node->As<ArrayUpdate>()->array_to_update();
+  if (!array->Is<Param>()) {
+    return false;
+  }
+  Proc* proc = node->function_base()->AsProcOrDie();
+  Param* param = array->As<Param>();
+  if (!proc->GetStateParamIndex(param).ok() || proc->next_values().empty()) {
+    return false;
+  }
+  const auto& next_values = proc->next_values(param);
+  if (next_values.size() != 1) {
+    return false;
+  }
+  Next* next = *next_values.begin();
+  return next->value() == node && !next->predicate().has_value() &&
+         node->users().front() == next;
+}
+
 namespace {
 
 // Abstraction representing a value carried across iterations of the loop.
@@ -638,11 +676,39 @@ absl::Status InvokeFormatStepCallback(llvm::IRBuilder<>* builder,
 // This a shim to let JIT code record a completed trace as an interpreter event.
 void RecordTrace(std::string* buffer, int64_t verbosity,
                  xls::InterpreterEvents* events) {
-  events->trace_msgs.push_back(
-      TraceMessage{.message = *buffer, .verbosity = verbosity});
+  events->AddTrace(std::move(*buffer), verbosity);
   delete buffer;
 }
 
+// This is a shim to let JIT code check whether a trace would be recorded before
+// formatting it.
+bool ShouldRecordTrace(int64_t verbosity, xls::InterpreterEvents* events) {
+  return events->ShouldRecordTrace(verbosity);
+}
+
+// Build the LLVM IR to invoke the callback that checks whether a trace of the
+// given verbosity would be recorded. Returns an i1 value.
+llvm::Value* InvokeShouldRecordTraceCallback(
+    llvm::IRBuilder<>* builder, int64_t verbosity,
+    llvm::Value* interpreter_events_ptr) {
+  llvm::Type* int64_type = llvm::Type::getInt64Ty(builder->getContext());
+  llvm::Type* ptr_type = llvm::PointerType::get(builder->getContext(), 0);
+
+  std::vector<llvm::Type*> params = {int64_type, ptr_type};
+
+  llvm::FunctionType* fn_type = llvm::FunctionType::get(
+      builder->getInt1Ty(), params, /*isVarArg=*/false);
+
+  std::vector<llvm::Value*> args = {builder->getInt64(verbosity),
+                                    interpreter_events_ptr};
+
+  llvm::ConstantInt* fn_addr = llvm::ConstantInt::get(
+      int64_type, absl::bit_cast<uint64_t>(&ShouldRecordTrace));
+  llvm::Value* fn_ptr =
+      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
+  return builder->CreateCall(fn_type, fn_ptr, args);
+}
+
 // Build the LLVM IR to invoke the callback that records traces.
 absl::Status InvokeRecordTraceCallback(llvm::IRBuilder<>* builder,
                                        int64_t verbosity,
@@ -1194,6 +1260,7 @@ class IrBuilderVisitor : public DfsVisitorWithDefault {
  protected:
   llvm::LLVMContext& ctx() { return jit_context_.context(); }
   llvm::Module* module() { return jit_context_.module(); }
+  bool emit_object_code() { return jit_context_.orc_jit().emit_object_code(); }
 
   // Returns the top-level builder for the function. This builder is initialized
   // to the entry block of `dispatch_function()`.
@@ -1597,7 +1664,16 @@ absl::Status IrBuilderVisitor::HandleTrace(Trace* trace_op) {
 
   print_builder.CreateBr(after_block);
 
-  b.CreateCondBr(condition, print_block, skip_block);
+  // Traces whose condition holds are checked against the verbosity filter
+  // before any formatting is done.
+  llvm::BasicBlock* check_block = llvm::BasicBlock::Create(
+      ctx(), absl::StrCat(trace_name, "_check"), node_context.llvm_function());
+  llvm::IRBuilder<> check_builder(check_block);
+  llvm::Value* should_record = InvokeShouldRecordTraceCallback(
+      &check_builder, trace_op->verbosity(), events_ptr);
+  check_builder.CreateCondBr(should_record, print_block, skip_block);
+
+  b.CreateCondBr(condition, check_block, skip_block);
 
   auto after_builder = std::make_unique<llvm::IRBuilder<>>(after_block);
   llvm::Value* token = type_converter()->GetToken();
@@ -1709,9 +1785,13 @@ absl::Status IrBuilderVisitor::HandleArrayUpdate(ArrayUpdate* update) {
   llvm::IRBuilder<>& b = node_context.entry_builder();
 
   // First, copy the entire array to update (operand 0) to the output buffer.
+  // An in-place state update writes to the next-state buffer of the state
+  // element which already holds the array so no copy is needed.
   llvm::Value* output_buffer = node_context.GetOutputPtr(0);
-  LlvmMemcpy(output_buffer, node_context.GetOperandPtr(0),
-             type_converter()->GetTypeByteSize(update->GetType()), b);
+  if (!IsInPlaceStateUpdate(update)) {
+    LlvmMemcpy(output_buffer, node_context.GetOperandPtr(0),
+               type_converter()->GetTypeByteSize(update->GetType()), b);
+  }
 
   // Determine whether the indices are all inbounds. If any are out of bounds
   // then the array update operation is a NOP. Also, gather the GEP indices for
@@ -2222,39 +2302,33 @@ absl::Status IrBuilderVisitor::HandleEncode(Encode* encode) {
   llvm::IRBuilder<>& b = node_context.entry_builder();
   llvm::Value* input = node_context.LoadOperand(0);
   llvm::Type* input_type = input->getType();
-  llvm::Value* input_one = llvm::ConstantInt::get(input_type, 1);
+  llvm::Value* input_zero = llvm::ConstantInt::get(input_type, 0);
+  int64_t input_width = encode->operand(0)->BitCountOrDie();
+  int64_t llvm_input_width = input_type->getIntegerBitWidth();
 
   llvm::Type* result_type =
       type_converter()->ConvertToLlvmType(encode->GetType());
-  llvm::Value* result_zero = llvm::ConstantInt::get(result_type, 0);
-
-  const std::string kResultName = "result";
-  LlvmIrLoop loop(encode->operand(0)->BitCountOrDie(), b, /*stride=*/1,
-                  /*insert_before=*/nullptr,
-                  {LoopCarriedValue{kResultName, result_zero}});
-  llvm::Value* result = loop.GetLoopCarriedValue(kResultName);
-
-  // For each bit in the input, if it's set, bitwise-OR its [numeric] value
-  // with the result.
-  llvm::Value* index_as_input_type = loop.body_builder().CreateZExtOrTrunc(
-      loop.index(), input_type, "index_as_input_type");
-  llvm::Value* index_as_result_type = loop.body_builder().CreateZExtOrTrunc(
-      loop.index(), result_type, "index_as_result_type");
-
-  llvm::Value* one_hot_mask = loop.body_builder().CreateShl(
-      input_one, index_as_input_type, "one_hot_mask");
-  llvm::Value* bit_set = loop.body_builder().CreateICmpEQ(
-      loop.body_builder().CreateAnd(input, one_hot_mask), one_hot_mask,
-      "bit_is_set");
-  llvm::Value* or_value = loop.body_builder().CreateSelect(
-      bit_set, index_as_result_type, result_zero);
-  llvm::Value* next_result =
-      loop.body_builder().CreateOr(result, or_value, "next_result");
-
-  loop.Finalize(/*final_body_block_builder=*/std::nullopt,
-                {{kResultName, next_result}});
-  return FinalizeNodeIrContextWithValue(std::move(node_context), result,
-                                        &loop.exit_builder());
+  llvm::Value* result = llvm::ConstantInt::get(result_type, 0);
+
+  // Bit `j` of the result is the OR of every input bit whose index has bit `j`
+  // set, so each result bit is a masked compare against zero. This takes
+  // log2(width) wide operations rather than a loop over each input bit, which
+  // matters for wide inputs where every loop iteration is itself a chain of
+  // word operations.
+  for (int64_t j = 0; j < encode->BitCountOrDie(); ++j) {
+    llvm::APInt mask(llvm_input_width, 0);
+    for (int64_t i = 0; i < input_width; ++i) {
+      if ((i >> j) & 1) {
+        mask.setBit(i);
+      }
+    }
+    llvm::Value* any_set = b.CreateICmpNE(
+        b.CreateAnd(input, llvm::ConstantInt::get(input_type, mask)),
+        input_zero, absl::StrCat("encode_bit_", j));
+    result = b.CreateOr(
+        result, b.CreateShl(b.CreateZExt(any_set, result_type), j));
+  }
+  return FinalizeNodeIrContextWithValue(std::move(node_context), result);
 }
 
 absl::Status IrBuilderVisitor::HandleEq(CompareOp* eq) {
@@ -2585,12 +2659,21 @@ absl::Status IrBuilderVisitor::HandleNext(Next* next) {
   llvm::Value* value_ptr = node_context.GetOperandPtr(Next::kValueOperand);
 
   if (!next->predicate().has_value()) {
-    LlvmMemcpy(node_context.GetOutputPtr(0), value_ptr,
-               type_converter()->GetTypeByteSize(next->value()->GetType()), b);
+    // An in-place update has already written the value to the output buffer.
+    if (!IsInPlaceStateUpdate(next->value())) {
+      LlvmMemcpy(node_context.GetOutputPtr(0), value_ptr,
+                 type_converter()->GetTypeByteSize(next->value()->GetType()),
+                 b);
+    }
 
-    // Record that this Next node was activated.
-    XLS_RETURN_IF_ERROR(InvokeNextValueCallback(
-        &b, next, node_context.GetInstanceContextArg()));
+    // Record that this Next node was activated. The callback is passed the
+    // address of the Next node which is not known ahead of time, so it is
+    // omitted from object code; it only serves to diagnose multiple active
+    // next values for a single state element.
+    if (!emit_object_code()) {
+      XLS_RETURN_IF_ERROR(InvokeNextValueCallback(
+          &b, next, node_context.GetInstanceContextArg()));
+    }
 
     return FinalizeNodeIrContextWithPointerToValue(
         std::move(node_context), node_context.GetOutputPtr(0), &b);
@@ -2605,8 +2688,11 @@ absl::Status IrBuilderVisitor::HandleNext(Next* next) {
              *if_then.then_builder);
 
   // Record that this Next node was activated.
-  XLS_RETURN_IF_ERROR(InvokeNextValueCallback(
-      if_then.then_builder.get(), next, node_context.GetInstanceContextArg()));
+  if (!emit_object_code()) {
+    XLS_RETURN_IF_ERROR(
+        InvokeNextValueCallback(if_then.then_builder.get(), next,
+                                node_context.GetInstanceContextArg()));
+  }
 
   std::unique_ptr<llvm::IRBuilder<>> exit_builder = if_then.Finalize();
   return FinalizeNodeIrContextWithPointerToValue(std::move(node_context),
@@ -3227,11 +3313,25 @@ absl::StatusOr<llvm::Value*> IrBuilderVisitor::CallFunction(
   return builder.CreateCall(f, args);
 }
 
-bool QueueReceiveWrapper(InstanceContext* instance_context, int64_t queue_index,
-                         uint8_t* buffer) {
-  return instance_context->channel_queues[queue_index]->ReadRaw(buffer);
+// Returns a callable pointer to the runtime function `fn_address`. Absolute
+// addresses in this process are meaningless in object code emitted for
+// ahead-of-time compilation, so in that case the function is referenced by its
+// C-linkage `symbol_name` and resolved when the object file is linked.
+llvm::Value* GetRuntimeFunctionPointer(llvm::IRBuilder<>* builder,
+                                       llvm::Module* module,
+                                       llvm::FunctionType* fn_type,
+                                       std::string_view symbol_name,
+                                       uint64_t fn_address,
+                                       bool emit_object_code) {
+  if (emit_object_code) {
+    return module->getOrInsertFunction(symbol_name, fn_type).getCallee();
+  }
+  llvm::ConstantInt* fn_addr = llvm::ConstantInt::get(
+      llvm::Type::getInt64Ty(builder->getContext()), fn_address);
+  return builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
 }
 
+
 absl::StatusOr<llvm::Value*> IrBuilderVisitor::ReceiveFromQueue(
     llvm::IRBuilder<>* builder, int64_t queue_index, Receive* receive,
     llvm::Value* output_ptr, llvm::Value* instance_context) {
@@ -3253,11 +3353,9 @@ absl::StatusOr<llvm::Value*> IrBuilderVisitor::ReceiveFromQueue(
       builder->CreateIntToPtr(instance_context, ptr_type), queue_index_value,
       output_ptr};
 
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()),
-                             absl::bit_cast<uint64_t>(&QueueReceiveWrapper));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
+  llvm::Value* fn_ptr = GetRuntimeFunctionPointer(
+      builder, module(), fn_type, "xls_jit_queue_receive",
+      absl::bit_cast<uint64_t>(&xls_jit_queue_receive), emit_object_code());
   llvm::Value* receive_fired = builder->CreateCall(fn_type, fn_ptr, args);
   return receive_fired;
 }
@@ -3368,10 +3466,6 @@ absl::Status IrBuilderVisitor::HandleReceive(Receive* recv) {
           : node_context.entry_builder().getFalse());
 }
 
-void QueueSendWrapper(InstanceContext* instance_context, int64_t queue_index,
-                      const uint8_t* data) {
-  instance_context->channel_queues[queue_index]->WriteRaw(data);
-}
 
 absl::Status IrBuilderVisitor::SendToQueue(llvm::IRBuilder<>* builder,
                                            int64_t queue_index, Send* send,
@@ -3393,11 +3487,9 @@ absl::Status IrBuilderVisitor::SendToQueue(llvm::IRBuilder<>* builder,
       builder->CreateIntToPtr(instance_context, ptr_type), queue_index_value,
       send_data_ptr};
 
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()),
-                             absl::bit_cast<uint64_t>(&QueueSendWrapper));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
+  llvm::Value* fn_ptr = GetRuntimeFunctionPointer(
+      builder, module(), fn_type, "xls_jit_queue_send",
+      absl::bit_cast<uint64_t>(&xls_jit_queue_send), emit_object_code());
   builder->CreateCall(fn_type, fn_ptr, args);
   return absl::OkStatus();
 }
@@ -58,6 +58,12 @@ struct InstanceContext {
 // for nodes whose value is known at compile time (e.g., Literals).
 bool ShouldMaterializeAtUse(Node* node);
 
+// Returns whether `node` is an array update of a proc state element whose only
+// use is the sole, unpredicated next_value of that state element. Such an
+// update is written directly into the next-state buffer of the state element,
+// which already holds the current value, instead of copying the entire array.
+bool IsInPlaceStateUpdate(Node* node);
+
 // An object gathering necessary information for jitting XLS functions, procs,
 // etc.
 class JitBuilderContext {
@@ -84,6 +90,12 @@ class JitBuilderContext {
     return llvm_functions_.at(xls_fn);
   }
 
+  // Returns whether an llvm::Function implementing the given FunctionBase has
+  // been built.
+  bool HasLlvmFunction(FunctionBase* xls_fn) const {
+    return llvm_functions_.contains(xls_fn);
+  }
+
   // Sets the llvm::Function implementing the given FunctionBase to
   // `llvm_function`.
   void SetLlvmFunction(FunctionBase* xls_fn, llvm::Function* llvm_function) {
@@ -109,6 +121,10 @@ class JitBuilderContext {
     return queue_indices_;
   }
 
+  // Clears the queue index assignment. Used when building several procs into
+  // one module as each proc has its own set of queues.
+  void ClearQueueIndices() { queue_indices_.clear(); }
+
  private:
   std::unique_ptr<llvm::Module> module_;
   OrcJit& orc_jit_;
@@ -19,18 +19,28 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/memory/memory.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/math_util.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/ir/channel.h"
 #include "xls/ir/elaboration.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
 #include "xls/jit/jit_runtime.h"
@@ -38,16 +48,18 @@
 namespace xls {
 namespace {
 
+template <typename QueueT>
 void WriteValueOnQueue(const Value& value, Type* type, JitRuntime& runtime,
-                       ByteQueue& queue) {
+                       QueueT& queue) {
   absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
       queue.element_size());
   runtime.BlitValueToBuffer(value, type, absl::MakeSpan(buffer));
   queue.Write(buffer.data());
 }
 
+template <typename QueueT>
 std::optional<Value> ReadValueFromQueue(Type* type, JitRuntime& runtime,
-                                        ByteQueue& queue) {
+                                        QueueT& queue) {
   std::vector<uint8_t> buffer(queue.element_size());
   if (!queue.Read(buffer.data())) {
     return std::nullopt;
@@ -55,6 +67,63 @@ std::optional<Value> ReadValueFromQueue(Type* type, JitRuntime& runtime,
   return runtime.UnpackBuffer(buffer.data(), type);
 }
 
+int64_t GetSpscCapacity(Channel* channel) {
+  int64_t capacity = SpscJitChannelQueue::kMinCapacity;
+  if (StreamingChannel* streaming_channel =
+          dynamic_cast<StreamingChannel*>(channel)) {
+    std::optional<int64_t> fifo_depth = streaming_channel->GetFifoDepth();
+    if (fifo_depth.has_value()) {
+      capacity = std::max(capacity, *fifo_depth);
+    }
+  }
+  return capacity;
+}
+
+// Returns the channel instances which are sent on by exactly one proc instance
+// and received on by exactly one proc instance. Each proc instance is
+// evaluated by a single thread so queues for these channel instances have a
+// single producer and a single consumer.
+absl::flat_hash_set<ChannelInstance*> GetSpscChannelInstances(
+    const ProcElaboration& elaboration) {
+  absl::flat_hash_map<ChannelInstance*, absl::flat_hash_set<ProcInstance*>>
+      senders;
+  absl::flat_hash_map<ChannelInstance*, absl::flat_hash_set<ProcInstance*>>
+      receivers;
+  for (ProcInstance* proc_instance : elaboration.proc_instances()) {
+    for (Node* node : proc_instance->proc()->nodes()) {
+      if (!node->Is<Send>() && !node->Is<Receive>()) {
+        continue;
+      }
+      std::string_view channel_name = node->Is<Send>()
+                                          ? node->As<Send>()->channel_name()
+                                          : node->As<Receive>()->channel_name();
+      absl::StatusOr<ChannelInstance*> channel_instance =
+          proc_instance->GetChannelInstance(channel_name);
+      if (!channel_instance.ok()) {
+        continue;
+      }
+      if (node->Is<Send>()) {
+        senders[*channel_instance].insert(proc_instance);
+      } else {
+        receivers[*channel_instance].insert(proc_instance);
+      }
+    }
+  }
+  absl::flat_hash_set<ChannelInstance*> result;
+  for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
+    if (channel_instance->channel->kind() != ChannelKind::kStreaming) {
+      continue;
+    }
+    auto send_it = senders.find(channel_instance);
+    auto receive_it = receivers.find(channel_instance);
+    if (send_it != senders.end() && send_it->second.size() == 1 &&
+        receive_it != receivers.end() && receive_it->second.size() == 1) {
+      result.insert(channel_instance);
+    }
+  }
+  return result;
+}
+
 }  // namespace
 
 ByteQueue::ByteQueue(int64_t channel_element_size, bool is_single_value)
@@ -101,6 +170,55 @@ void ByteQueue::Resize() {
   }
 }
 
+SpscByteQueue::SpscByteQueue(int64_t channel_element_size, int64_t capacity)
+    : channel_element_size_(channel_element_size),
+      allocated_element_size_(std::max(
+          RoundUpToNearest(channel_element_size,
+                           static_cast<int64_t>(alignof(std::max_align_t))),
+          int64_t{1})),
+      capacity_(int64_t{1} << CeilOfLog2(std::max(capacity, int64_t{1}))),
+      index_mask_(capacity_ - 1),
+      ring_(capacity_ * allocated_element_size_),
+      overflow_(channel_element_size, /*is_single_value=*/false) {}
+
+void SpscByteQueue::WriteOverflow(const uint8_t* data) {
+  absl::MutexLock lock(&overflow_mutex_);
+  overflow_.Write(data);
+  overflow_count_.fetch_add(1, std::memory_order_release);
+}
+
+bool SpscByteQueue::ReadOverflow(uint8_t* buffer) {
+  absl::MutexLock lock(&overflow_mutex_);
+  if (!overflow_.Read(buffer)) {
+    return false;
+  }
+  overflow_count_.fetch_sub(1, std::memory_order_release);
+  return true;
+}
+
+absl::Status JitChannelQueue::WriteNative(absl::Span<const uint8_t> data) {
+  if (data.size() != GetNativeSize()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Channel `%s` expects native values of %d bytes, got %d bytes",
+        channel()->name(), GetNativeSize(), data.size()));
+  }
+  if (generator_.has_value()) {
+    return absl::InternalError(
+        "Cannot write to ChannelQueue because it has a generator function.");
+  }
+  WriteRaw(data.data());
+  return absl::OkStatus();
+}
+
+absl::StatusOr<bool> JitChannelQueue::ReadNative(absl::Span<uint8_t> buffer) {
+  if (buffer.size() != GetNativeSize()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Channel `%s` expects native buffers of %d bytes, got %d bytes",
+        channel()->name(), GetNativeSize(), buffer.size()));
+  }
+  return ReadRaw(buffer.data());
+}
+
 int64_t ThreadSafeJitChannelQueue::GetSizeInternal() const {
   return byte_queue_.size();
 }
@@ -125,6 +243,27 @@ std::optional<Value> ThreadUnsafeJitChannelQueue::ReadInternal() {
   return ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
 }
 
+SpscJitChannelQueue::SpscJitChannelQueue(ChannelInstance* channel_instance,
+                                         JitRuntime* jit_runtime)
+    : JitChannelQueue(channel_instance, jit_runtime),
+      byte_queue_(
+          jit_runtime->GetTypeByteSize(channel_instance->channel->type()),
+          GetSpscCapacity(channel_instance->channel)) {
+  CHECK_EQ(channel_instance->channel->kind(), ChannelKind::kStreaming);
+}
+
+int64_t SpscJitChannelQueue::GetSizeInternal() const {
+  return byte_queue_.size();
+}
+
+void SpscJitChannelQueue::WriteInternal(const Value& value) {
+  WriteValueOnQueue(value, channel()->type(), *jit_runtime_, byte_queue_);
+}
+
+std::optional<Value> SpscJitChannelQueue::ReadInternal() {
+  return ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
+}
+
 /* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
 JitChannelQueueManager::CreateThreadSafe(Package* package) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
@@ -136,10 +275,17 @@ JitChannelQueueManager::CreateThreadSafe(Package* package) {
 JitChannelQueueManager::CreateThreadSafe(ProcElaboration&& elaboration) {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitRuntime> runtime,
                        JitRuntime::Create());
+  absl::flat_hash_set<ChannelInstance*> spsc_channel_instances =
+      GetSpscChannelInstances(elaboration);
   std::vector<std::unique_ptr<ChannelQueue>> queues;
   for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
-    queues.push_back(std::make_unique<ThreadSafeJitChannelQueue>(
-        channel_instance, runtime.get()));
+    if (spsc_channel_instances.contains(channel_instance)) {
+      queues.push_back(std::make_unique<SpscJitChannelQueue>(channel_instance,
+                                                             runtime.get()));
+    } else {
+      queues.push_back(std::make_unique<ThreadSafeJitChannelQueue>(
+          channel_instance, runtime.get()));
+    }
   }
   return absl::WrapUnique(new JitChannelQueueManager(
       std::move(elaboration), std::move(queues), std::move(runtime)));
@@ -165,6 +311,14 @@ JitChannelQueueManager::CreateThreadUnsafe(ProcElaboration&& elaboration) {
       std::move(elaboration), std::move(queues), std::move(runtime)));
 }
 
+absl::StatusOr<JitChannelQueue*> JitChannelQueueManager::GetJitQueueByName(
+    std::string_view name) {
+  XLS_ASSIGN_OR_RETURN(ChannelQueue * queue, GetQueueByName(name));
+  JitChannelQueue* jit_queue = dynamic_cast<JitChannelQueue*>(queue);
+  XLS_RET_CHECK_NE(jit_queue, nullptr);
+  return jit_queue;
+}
+
 JitChannelQueue& JitChannelQueueManager::GetJitQueue(Channel* channel) {
   JitChannelQueue* queue = dynamic_cast<JitChannelQueue*>(&GetQueue(channel));
   CHECK_NE(queue, nullptr);
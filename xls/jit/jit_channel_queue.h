@@ -14,23 +14,29 @@
 #ifndef XLS_JIT_JIT_CHANNEL_QUEUE_H_
 #define XLS_JIT_JIT_CHANNEL_QUEUE_H_
 
+#include <atomic>
 #include <cstdint>
 #include <cstring>
 #include <memory>
 #include <optional>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/base/optimization.h"
 #include "absl/base/thread_annotations.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/elaboration.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -112,6 +118,112 @@ class ByteQueue {
   bool is_single_value_;
 };
 
+// A lock-free queue of raw bytes which is safe to use with exactly one
+// producer thread and exactly one consumer thread. Elements are stored in a
+// fixed-capacity ring buffer. If the producer outruns the consumer and the ring
+// fills up, elements spill into a mutex-guarded overflow ByteQueue so writes
+// never fail; the fast path of both Write and Read takes no lock. FIFO order is
+// preserved across the spill: once an element has spilled, subsequent writes
+// also go to the overflow queue until the consumer has drained it.
+class SpscByteQueue {
+ public:
+  // `capacity` is the number of elements held in the ring buffer and is
+  // rounded up to a power of two.
+  SpscByteQueue(int64_t channel_element_size, int64_t capacity);
+
+  int64_t element_size() const { return channel_element_size_; }
+  int64_t capacity() const { return capacity_; }
+
+  // May only be called from the producer thread.
+  void Write(const uint8_t* data) {
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+    __msan_unpoison(data, channel_element_size_);
+#endif
+    if (overflow_count_.load(std::memory_order_acquire) == 0) {
+      int64_t tail = tail_.load(std::memory_order_relaxed);
+      if (tail - producer_cached_head_ == capacity_) {
+        producer_cached_head_ = head_.load(std::memory_order_acquire);
+      }
+      if (tail - producer_cached_head_ < capacity_) {
+        memcpy(SlotData(tail), data, channel_element_size_);
+        tail_.store(tail + 1, std::memory_order_release);
+        return;
+      }
+    }
+    WriteOverflow(data);
+  }
+
+  // May only be called from the consumer thread. Returns false if the queue is
+  // empty.
+  bool Read(uint8_t* buffer) {
+    if (ReadRing(buffer)) {
+      return true;
+    }
+    if (overflow_count_.load(std::memory_order_acquire) == 0) {
+      return false;
+    }
+    // Elements in the ring are always older than elements in the overflow
+    // queue. The producer may have written to the ring after the check above
+    // and before spilling so check the ring once more.
+    if (ReadRing(buffer)) {
+      return true;
+    }
+    return ReadOverflow(buffer);
+  }
+
+  // Returns the number of elements in the queue. The value is exact only
+  // when neither the producer nor the consumer is concurrently active.
+  int64_t size() const {
+    return tail_.load(std::memory_order_acquire) -
+           head_.load(std::memory_order_acquire) +
+           overflow_count_.load(std::memory_order_acquire);
+  }
+
+ private:
+  uint8_t* SlotData(int64_t index) {
+    return ring_.data() + (index & index_mask_) * allocated_element_size_;
+  }
+
+  bool ReadRing(uint8_t* buffer) {
+    int64_t head = head_.load(std::memory_order_relaxed);
+    if (head == consumer_cached_tail_) {
+      consumer_cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == consumer_cached_tail_) {
+        return false;
+      }
+    }
+    memcpy(buffer, SlotData(head), channel_element_size_);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  void WriteOverflow(const uint8_t* data);
+  bool ReadOverflow(uint8_t* buffer);
+
+  int64_t channel_element_size_;
+  // Size of a slot in the ring buffer in bytes. Slots are aligned to the
+  // largest scalar type.
+  int64_t allocated_element_size_;
+  int64_t capacity_;
+  int64_t index_mask_;
+  std::vector<uint8_t> ring_;
+
+  // The consumer-owned and producer-owned indices live on separate cache lines
+  // to avoid false sharing. Indices increase monotonically and are masked when
+  // addressing the ring. Each side keeps a cached copy of the other side's
+  // index which is only refreshed when the ring appears empty or full.
+  alignas(ABSL_CACHELINE_SIZE) std::atomic<int64_t> head_ = 0;
+  int64_t consumer_cached_tail_ = 0;
+  alignas(ABSL_CACHELINE_SIZE) std::atomic<int64_t> tail_ = 0;
+  int64_t producer_cached_head_ = 0;
+
+  // Number of elements in `overflow_`. Incremented after a push and
+  // decremented after a pop while holding `overflow_mutex_`.
+  alignas(ABSL_CACHELINE_SIZE) std::atomic<int64_t> overflow_count_ = 0;
+  absl::Mutex overflow_mutex_;
+  ByteQueue overflow_ ABSL_GUARDED_BY(overflow_mutex_);
+};
+
 // Abstract base class for channel queues which may be used by the JIT. These
 // queues support reading and writing raw bytes to the queue rather the just
 // xls::Values.
@@ -124,6 +236,29 @@ class JitChannelQueue : public ChannelQueue {
   virtual void WriteRaw(const uint8_t* data) = 0;
   virtual bool ReadRaw(uint8_t* buffer) = 0;
 
+  // Returns the number of bytes of a value of the channel's type in the JIT's
+  // native layout.
+  int64_t GetNativeSize() const {
+    return jit_runtime_->GetTypeByteSize(channel()->type());
+  }
+
+  // Returns the native layout of values of the channel's type. This can be used
+  // to construct and decode the buffers passed to WriteNative and ReadNative.
+  TypeLayout GetTypeLayout() const {
+    return jit_runtime_->CreateTypeLayout(channel()->type());
+  }
+
+  // Writes a single value held in the native layout described by
+  // GetTypeLayout(). Unlike Write(const Value&) no Value is constructed or
+  // converted, so this is the fast path for streaming data into a JIT-compiled
+  // proc network. `data` must be exactly GetNativeSize() bytes and need not be
+  // aligned.
+  absl::Status WriteNative(absl::Span<const uint8_t> data);
+
+  // Reads a single value in native layout into `buffer`, which must be
+  // exactly GetNativeSize() bytes. Returns false if the queue is empty.
+  absl::StatusOr<bool> ReadNative(absl::Span<uint8_t> buffer);
+
  protected:
   JitRuntime* jit_runtime_;
 };
@@ -199,13 +334,54 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
   ByteQueue byte_queue_;
 };
 
+// A lock-free version of the JIT channel queue for streaming channels which
+// have a single producer and a single consumer, e.g., a channel connecting
+// exactly one sending proc instance to exactly one receiving proc instance.
+// WriteRaw and ReadRaw may be called concurrently from one producer thread and
+// one consumer thread respectively without any locking. The ring buffer
+// capacity is derived from the FIFO depth of the channel.
+class SpscJitChannelQueue : public JitChannelQueue {
+ public:
+  // Minimum number of elements held in the ring buffer. FIFO depths in the IR
+  // are not enforced by the proc runtimes so shallow FIFOs still get a ring
+  // large enough to avoid spilling in the common case.
+  static constexpr int64_t kMinCapacity = 64;
+
+  SpscJitChannelQueue(ChannelInstance* channel_instance,
+                      JitRuntime* jit_runtime);
+  ~SpscJitChannelQueue() override = default;
+
+  void WriteRaw(const uint8_t* data) override { byte_queue_.Write(data); }
+  bool ReadRaw(uint8_t* buffer) override {
+    if (generator_.has_value()) {
+      std::optional<Value> generated_value = (*generator_)();
+      if (generated_value.has_value()) {
+        WriteInternal(generated_value.value());
+      }
+    }
+    return byte_queue_.Read(buffer);
+  }
+
+  int64_t capacity() const { return byte_queue_.capacity(); }
+
+ protected:
+  int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  void WriteInternal(const Value& value) override;
+  std::optional<Value> ReadInternal() override;
+
+  SpscByteQueue byte_queue_;
+};
+
 // A Channel manager which holds exclusively JitChannelQueues.
 class JitChannelQueueManager : public ChannelQueueManager {
  public:
   ~JitChannelQueueManager() override = default;
 
-  // Factories which create a queue manager with exclusively ThreadSafe/Unsafe
-  // queues.
+  // Factories which create a queue manager with thread-safe or thread-unsafe
+  // queues. The thread-safe factories use a lock-free SpscJitChannelQueue for
+  // every streaming channel instance which the elaboration proves is sent on
+  // by exactly one proc instance and received on by exactly one proc
+  // instance; all other channel instances use a ThreadSafeJitChannelQueue.
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
   CreateThreadSafe(Package* package);
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
@@ -218,6 +394,11 @@ class JitChannelQueueManager : public ChannelQueueManager {
   JitChannelQueue& GetJitQueue(Channel* channel);
   JitChannelQueue& GetJitQueue(ChannelInstance* channel_instance);
 
+  // Returns the queue of the channel with the given name, which must have a
+  // single instance. The native-layout WriteNative and ReadNative methods of
+  // the returned queue avoid constructing Values.
+  absl::StatusOr<JitChannelQueue*> GetJitQueueByName(std::string_view name);
+
   JitRuntime& runtime() { return *runtime_; }
 
  protected:
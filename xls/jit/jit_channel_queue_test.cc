@@ -18,26 +18,33 @@
 #include <cstring>
 #include <memory>
 #include <optional>
+#include <string_view>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/channel_queue_test_base.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/elaboration.h"
+#include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 namespace {
 
+using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
 using ::testing::HasSubstr;
 
@@ -67,7 +74,8 @@ template <typename QueueT>
 class JitChannelQueueTest : public ::testing::Test {};
 
 using QueueTypes =
-    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue>;
+    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue,
+                     SpscJitChannelQueue>;
 TYPED_TEST_SUITE(JitChannelQueueTest, QueueTypes);
 
 // An empty tuple represents a zero width.
@@ -180,5 +188,195 @@ TYPED_TEST(JitChannelQueueTest, IotaGeneratorWithRawApi) {
                                  "a generator function")));
 }
 
+TYPED_TEST(JitChannelQueueTest, NativeLayoutApi) {
+  Package package("test");
+  Type* type = package.GetTupleType(
+      {package.GetBitsType(32), package.GetBitsType(8)});
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     type));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  TypeParam queue(elaboration.GetUniqueInstance(channel).value(),
+                  GetJitRuntime());
+  TypeLayout layout = queue.GetTypeLayout();
+  EXPECT_EQ(layout.size(), queue.GetNativeSize());
+
+  std::vector<uint8_t> buffer(queue.GetNativeSize());
+  for (int64_t i = 0; i < 10; i++) {
+    layout.ValueToNativeLayout(
+        Value::Tuple({Value(UBits(1000 + i, 32)), Value(UBits(i, 8))}),
+        buffer.data());
+    XLS_ASSERT_OK(queue.WriteNative(buffer));
+  }
+  // Values written in native layout may be read as Values and vice versa.
+  EXPECT_EQ(queue.Read(),
+            Value::Tuple({Value(UBits(1000, 32)), Value(UBits(0, 8))}));
+  for (int64_t i = 1; i < 10; i++) {
+    EXPECT_THAT(queue.ReadNative(absl::MakeSpan(buffer)), IsOkAndHolds(true));
+    EXPECT_EQ(layout.NativeLayoutToValue(buffer.data()),
+              Value::Tuple({Value(UBits(1000 + i, 32)), Value(UBits(i, 8))}));
+  }
+  EXPECT_THAT(queue.ReadNative(absl::MakeSpan(buffer)), IsOkAndHolds(false));
+
+  std::vector<uint8_t> short_buffer(1);
+  EXPECT_THAT(queue.WriteNative(short_buffer),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("expects native values of")));
+  EXPECT_THAT(queue.ReadNative(absl::MakeSpan(short_buffer)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("expects native buffers of")));
+}
+
+TEST(SpscJitChannelQueueTest, CapacityFromFifoDepth) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * shallow_channel,
+      package.CreateStreamingChannel(
+          "shallow", ChannelOps::kSendReceive, package.GetBitsType(32),
+          /*initial_values=*/{}, FifoConfig{.depth = 2, .bypass = false}));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * deep_channel,
+      package.CreateStreamingChannel(
+          "deep", ChannelOps::kSendReceive, package.GetBitsType(32),
+          /*initial_values=*/{}, FifoConfig{.depth = 1000, .bypass = false}));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  SpscJitChannelQueue shallow_queue(
+      elaboration.GetUniqueInstance(shallow_channel).value(), GetJitRuntime());
+  SpscJitChannelQueue deep_queue(
+      elaboration.GetUniqueInstance(deep_channel).value(), GetJitRuntime());
+  EXPECT_EQ(shallow_queue.capacity(), SpscJitChannelQueue::kMinCapacity);
+  EXPECT_EQ(deep_queue.capacity(), 1024);
+}
+
+TEST(SpscJitChannelQueueTest, OverflowPreservesOrder) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  SpscJitChannelQueue queue(elaboration.GetUniqueInstance(channel).value(),
+                            GetJitRuntime());
+  int64_t count = 3 * queue.capacity() + 7;
+  uint32_t next_write = 0;
+  uint32_t next_read = 0;
+  auto write = [&]() {
+    queue.WriteRaw(reinterpret_cast<const uint8_t*>(&next_write));
+    ++next_write;
+  };
+  auto read = [&]() {
+    uint32_t value;
+    ASSERT_TRUE(queue.ReadRaw(reinterpret_cast<uint8_t*>(&value)));
+    EXPECT_EQ(value, next_read);
+    ++next_read;
+  };
+
+  // Overfill the ring then interleave reads and writes while elements remain
+  // in the overflow queue.
+  for (int64_t i = 0; i < count; ++i) {
+    write();
+  }
+  EXPECT_EQ(queue.GetSize(), count);
+  for (int64_t i = 0; i < count; ++i) {
+    read();
+    write();
+  }
+  for (int64_t i = 0; i < count; ++i) {
+    read();
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+  uint32_t value;
+  EXPECT_FALSE(queue.ReadRaw(reinterpret_cast<uint8_t*>(&value)));
+}
+
+TEST(SpscJitChannelQueueTest, ConcurrentProducerConsumer) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(64)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+
+  SpscJitChannelQueue queue(elaboration.GetUniqueInstance(channel).value(),
+                            GetJitRuntime());
+  constexpr uint64_t kCount = 100000;
+  Thread producer([&]() {
+    for (uint64_t i = 0; i < kCount; ++i) {
+      queue.WriteRaw(reinterpret_cast<const uint8_t*>(&i));
+    }
+  });
+  uint64_t expected = 0;
+  while (expected < kCount) {
+    uint64_t value;
+    if (queue.ReadRaw(reinterpret_cast<uint8_t*>(&value))) {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    }
+  }
+  producer.Join();
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(JitChannelQueueManagerTest, ThreadSafeManagerUsesSpscQueues) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(
+package test
+
+chan a(bits[32], id=0, kind=streaming, ops=send_receive, flow_control=ready_valid, metadata="""""")
+chan b(bits[32], id=1, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="""""")
+chan c(bits[32], id=2, kind=streaming, ops=send_receive, flow_control=ready_valid, metadata="""""")
+
+proc producer(tok: token, st: bits[32], init={0}) {
+  send.1: token = send(tok, st, channel=a)
+  send.2: token = send(send.1, st, channel=c)
+  next (send.2, st)
+}
+
+proc consumer(tok: token, st: bits[32], init={0}) {
+  receive.3: (token, bits[32]) = receive(tok, channel=a)
+  tuple_index.4: token = tuple_index(receive.3, index=0)
+  tuple_index.5: bits[32] = tuple_index(receive.3, index=1)
+  send.6: token = send(tuple_index.4, tuple_index.5, channel=b)
+  receive.7: (token, bits[32]) = receive(send.6, channel=c)
+  tuple_index.8: token = tuple_index(receive.7, index=0)
+  next (tuple_index.8, st)
+}
+
+proc other_producer(tok: token, st: bits[32], init={0}) {
+  send.9: token = send(tok, st, channel=c)
+  next (send.9, st)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      JitChannelQueueManager::CreateThreadSafe(package.get()));
+
+  auto is_spsc = [&](std::string_view name) {
+    Channel* channel = package->GetChannel(name).value();
+    return dynamic_cast<SpscJitChannelQueue*>(
+               &queue_manager->GetJitQueue(channel)) != nullptr;
+  };
+  // `a` has one sending and one receiving proc.
+  EXPECT_TRUE(is_spsc("a"));
+  // `b` has no receiving proc.
+  EXPECT_FALSE(is_spsc("b"));
+  // `c` has two sending procs.
+  EXPECT_FALSE(is_spsc("c"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(JitChannelQueue * a_queue,
+                           queue_manager->GetJitQueueByName("a"));
+  EXPECT_EQ(a_queue->channel()->name(), "a");
+  EXPECT_THAT(queue_manager->GetJitQueueByName("not_a_channel"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,116 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_node_profile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+
+namespace xls {
+namespace {
+
+std::string SourceLocationsToString(Node* node) {
+  std::vector<std::string> locations;
+  for (const SourceLocation& location : node->loc().locations) {
+    std::optional<std::string> filename =
+        node->package()->GetFilename(location.fileno());
+    locations.push_back(absl::StrFormat(
+        "%s:%d:%d",
+        filename.has_value() ? *filename
+                             : absl::StrCat(location.fileno().value()),
+        location.lineno().value(), location.colno().value()));
+  }
+  return absl::StrJoin(locations, ",");
+}
+
+}  // namespace
+
+int64_t* JitNodeProfile::GetCounter(Node* node) {
+  absl::MutexLock lock(&mutex_);
+  auto [it, inserted] = entry_map_.try_emplace(
+      std::make_pair(node->function_base()->name(), node->id()), nullptr);
+  if (inserted) {
+    it->second = &entries_.emplace_back(
+        Entry{.function_base = node->function_base()->name(),
+              .node = node->GetName(),
+              .op = node->op(),
+              .source_locations = SourceLocationsToString(node)});
+  }
+  return &it->second->count;
+}
+
+void JitNodeProfile::Reset() {
+  absl::MutexLock lock(&mutex_);
+  for (Entry& entry : entries_) {
+    entry.count = 0;
+  }
+}
+
+std::vector<JitNodeProfile::Entry> JitNodeProfile::GetEntries() const {
+  std::vector<Entry> entries;
+  {
+    absl::MutexLock lock(&mutex_);
+    for (const Entry& entry : entries_) {
+      if (entry.count != 0) {
+        entries.push_back(entry);
+      }
+    }
+  }
+  absl::c_stable_sort(entries, [](const Entry& a, const Entry& b) {
+    return a.count > b.count;
+  });
+  return entries;
+}
+
+std::string JitNodeProfile::Report(int64_t max_entries) const {
+  std::vector<Entry> entries = GetEntries();
+  int64_t total = 0;
+  for (const Entry& entry : entries) {
+    total += entry.count;
+  }
+  std::string report = absl::StrFormat(
+      "%d node evaluations in %d nodes\n%12s %7s  %-24s %-40s %s\n", total,
+      entries.size(), "count", "%", "op", "node", "source");
+  int64_t shown = std::min<int64_t>(max_entries, entries.size());
+  for (int64_t i = 0; i < shown; ++i) {
+    const Entry& entry = entries[i];
+    absl::StrAppendFormat(
+        &report, "%12d %6.2f%%  %-24s %-40s %s\n", entry.count,
+        100.0 * static_cast<double>(entry.count) / static_cast<double>(total),
+        OpToString(entry.op),
+        absl::StrCat(entry.function_base, "::", entry.node),
+        entry.source_locations);
+  }
+  if (shown < entries.size()) {
+    absl::StrAppendFormat(&report, "... %d more nodes\n",
+                          entries.size() - shown);
+  }
+  return report;
+}
+
+}  // namespace xls
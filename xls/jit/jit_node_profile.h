@@ -0,0 +1,97 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_NODE_PROFILE_H_
+#define XLS_JIT_JIT_NODE_PROFILE_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/jit/observer.h"
+
+namespace xls {
+
+// Counts of the evaluations of the nodes of jitted code. When a JitObserver
+// requests `node_profile`, the JIT emits an increment of a counter owned by the
+// profile before evaluating each node. The counters are plain (non-atomic)
+// memory so counts may be lost if the same jitted code runs on several threads
+// concurrently, and counts should only be read while no jitted code using the
+// profile is running.
+//
+// Counters live at fixed host addresses which are burned into the jitted code,
+// so the profile must outlive all code compiled with it. Object code emitted
+// for ahead-of-time compilation is never instrumented.
+class JitNodeProfile {
+ public:
+  struct Entry {
+    std::string function_base;
+    std::string node;
+    Op op;
+    // The source locations of the node as `file:line:column`, separated by
+    // commas. Empty if the node has no location.
+    std::string source_locations;
+    int64_t count = 0;
+  };
+
+  // Returns the counter of `node`, creating it if it does not exist. Nodes are
+  // identified by the name of their function base and their id so a profile
+  // may be shared by several compilations of the same package.
+  int64_t* GetCounter(Node* node);
+
+  // Sets all counts to zero. Must not be called while jitted code is running.
+  void Reset();
+
+  // Returns an entry for each node with a non-zero count sorted by decreasing
+  // count.
+  std::vector<Entry> GetEntries() const;
+
+  // Returns a human-readable table of the `max_entries` most frequently
+  // evaluated nodes along with the fraction of all node evaluations.
+  std::string Report(int64_t max_entries = 50) const;
+
+ private:
+  mutable absl::Mutex mutex_;
+  // The `count` field of each entry is the counter incremented by the jitted
+  // code. A deque is used so counter addresses remain stable as entries are
+  // added.
+  std::deque<Entry> entries_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::pair<std::string, int64_t>, Entry*> entry_map_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+// An observer which requests node profiling into the profile it owns.
+class JitNodeProfileObserver final : public JitObserver {
+ public:
+  JitObserverRequests GetNotificationOptions() const final {
+    return JitObserverRequests{.node_profile = true};
+  }
+  JitNodeProfile* GetNodeProfile() final { return &profile_; }
+
+  JitNodeProfile& profile() { return profile_; }
+
+ private:
+  JitNodeProfile profile_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_NODE_PROFILE_H_
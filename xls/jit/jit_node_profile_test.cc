@@ -0,0 +1,78 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_node_profile.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/op.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/orc_jit.h"
+
+namespace xls {
+namespace {
+
+using ::testing::AllOf;
+using ::testing::Contains;
+using ::testing::Field;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+
+class JitNodeProfileTest : public IrTestBase {};
+
+TEST_F(JitNodeProfileTest, CountsNodeEvaluations) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+    fn f(x: bits[8], y: bits[8]) -> bits[8] {
+      add.1: bits[8] = add(x, y)
+      ret umul.2: bits[8] = umul(add.1, y)
+    }
+  )",
+                                                       p.get()));
+  JitNodeProfileObserver observer;
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           FunctionJit::Create(f, JitOptions(), &observer));
+  for (int64_t i = 0; i < 5; ++i) {
+    std::vector<Value> args = {Value(UBits(i, 8)), Value(UBits(3, 8))};
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result, jit->Run(args));
+    EXPECT_EQ(result.value, Value(UBits((i + 3) * 3, 8)));
+  }
+
+  std::vector<JitNodeProfile::Entry> entries =
+      observer.profile().GetEntries();
+  EXPECT_THAT(entries, Contains(AllOf(
+                           Field(&JitNodeProfile::Entry::node, "add.1"),
+                           Field(&JitNodeProfile::Entry::op, Op::kAdd),
+                           Field(&JitNodeProfile::Entry::count, 5))));
+  EXPECT_THAT(entries, Contains(AllOf(
+                           Field(&JitNodeProfile::Entry::node, "umul.2"),
+                           Field(&JitNodeProfile::Entry::count, 5))));
+  EXPECT_THAT(observer.profile().Report(), HasSubstr("add.1"));
+
+  observer.profile().Reset();
+  EXPECT_THAT(observer.profile().GetEntries(), IsEmpty());
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,111 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <unistd.h>
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <utility>
+
+#include "absl/base/const_init.h"
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+
+ABSL_FLAG(std::string, jit_object_cache_dir, "",
+          "If non-empty, the directory in which the JIT caches compiled object "
+          "code across runs. Compilation of a module whose object code is "
+          "already in the cache skips the LLVM optimization and code "
+          "generation pipeline.");
+
+namespace xls {
+
+/* static */ absl::StatusOr<std::unique_ptr<JitObjectCache>>
+JitObjectCache::Create(const std::filesystem::path& directory) {
+  XLS_RET_CHECK(!directory.empty());
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory));
+  return absl::WrapUnique(new JitObjectCache(directory));
+}
+
+/* static */ JitObjectCache* JitObjectCache::GetDefault() {
+  static absl::Mutex mutex(absl::kConstInit);
+  static JitObjectCache* cache ABSL_GUARDED_BY(mutex) = nullptr;
+  std::string directory = absl::GetFlag(FLAGS_jit_object_cache_dir);
+  if (directory.empty()) {
+    return nullptr;
+  }
+  absl::MutexLock lock(&mutex);
+  if (cache == nullptr || cache->directory() != directory) {
+    absl::StatusOr<std::unique_ptr<JitObjectCache>> new_cache =
+        Create(directory);
+    if (!new_cache.ok()) {
+      LOG(WARNING) << "Unable to create JIT object cache in `" << directory
+                   << "`: " << new_cache.status();
+      return nullptr;
+    }
+    // Previous caches are intentionally leaked as callers may still hold
+    // pointers to them.
+    cache = new_cache->release();
+  }
+  return cache;
+}
+
+std::filesystem::path JitObjectCache::GetPath(std::string_view key) const {
+  return directory_ / absl::StrCat(key, ".o");
+}
+
+absl::StatusOr<std::optional<std::string>> JitObjectCache::Lookup(
+    std::string_view key) const {
+  std::filesystem::path path = GetPath(key);
+  if (!FileExists(path).ok()) {
+    return std::nullopt;
+  }
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+  return contents;
+}
+
+absl::Status JitObjectCache::Insert(std::string_view key,
+                                    std::string_view object_code) const {
+  std::filesystem::path path = GetPath(key);
+  std::filesystem::path temp_path = absl::StrFormat(
+      "%s.tmp.%d.%d", path.string(), getpid(), absl::ToUnixNanos(absl::Now()));
+  XLS_RETURN_IF_ERROR(SetFileContents(temp_path, object_code));
+  std::error_code ec;
+  std::filesystem::rename(temp_path, path, ec);
+  if (ec) {
+    std::filesystem::remove(temp_path, ec);
+    return absl::InternalError(
+        absl::StrFormat("Unable to install JIT object cache entry `%s`: %s",
+                        path.string(), ec.message()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls
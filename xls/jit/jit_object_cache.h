@@ -0,0 +1,69 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_OBJECT_CACHE_H_
+#define XLS_JIT_JIT_OBJECT_CACHE_H_
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/flags/declare.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+ABSL_DECLARE_FLAG(std::string, jit_object_cache_dir);
+
+namespace xls {
+
+// A persistent on-disk cache of object code produced by the JIT. Entries are
+// keyed by an opaque string (typically a content hash of the unoptimized LLVM
+// module along with the code generation options) and stored as one object
+// file per key in the cache directory. The cache may be shared between
+// processes: entries are written to a temporary file and atomically renamed
+// into place so readers never observe partially-written objects.
+class JitObjectCache {
+ public:
+  // Creates a cache rooted at `directory`, creating the directory if needed.
+  static absl::StatusOr<std::unique_ptr<JitObjectCache>> Create(
+      const std::filesystem::path& directory);
+
+  // Returns the process-wide cache rooted at the directory given by
+  // --jit_object_cache_dir or nullptr if the flag is empty.
+  static JitObjectCache* GetDefault();
+
+  // Returns the object code stored under `key`, or std::nullopt if there is
+  // no such entry.
+  absl::StatusOr<std::optional<std::string>> Lookup(std::string_view key) const;
+
+  // Stores `object_code` under `key`, replacing any existing entry.
+  absl::Status Insert(std::string_view key, std::string_view object_code) const;
+
+  const std::filesystem::path& directory() const { return directory_; }
+
+ private:
+  explicit JitObjectCache(std::filesystem::path directory)
+      : directory_(std::move(directory)) {}
+
+  std::filesystem::path GetPath(std::string_view key) const;
+
+  std::filesystem::path directory_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_OBJECT_CACHE_H_
@@ -0,0 +1,120 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::Optional;
+
+int64_t CountCacheEntries(const std::filesystem::path& directory) {
+  int64_t count = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+    if (entry.path().extension() == ".o") {
+      ++count;
+    }
+  }
+  return count;
+}
+
+class JitObjectCacheTest : public IrTestBase {};
+
+TEST_F(JitObjectCacheTest, LookupAndInsert) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitObjectCache> cache,
+                           JitObjectCache::Create(temp_dir.path() / "cache"));
+  EXPECT_THAT(cache->Lookup("abc"), IsOkAndHolds(std::nullopt));
+
+  XLS_ASSERT_OK(cache->Insert("abc", std::string("foo\0bar", 7)));
+  EXPECT_THAT(cache->Lookup("abc"),
+              IsOkAndHolds(Optional(std::string("foo\0bar", 7))));
+  EXPECT_THAT(cache->Lookup("def"), IsOkAndHolds(std::nullopt));
+
+  XLS_ASSERT_OK(cache->Insert("abc", "baz"));
+  EXPECT_THAT(cache->Lookup("abc"), IsOkAndHolds(Optional(std::string("baz"))));
+  EXPECT_EQ(CountCacheEntries(cache->directory()), 1);
+}
+
+TEST_F(JitObjectCacheTest, DefaultCacheDisabledWithoutFlag) {
+  absl::FlagSaver flag_saver;
+  absl::SetFlag(&FLAGS_jit_object_cache_dir, "");
+  EXPECT_EQ(JitObjectCache::GetDefault(), nullptr);
+}
+
+TEST_F(JitObjectCacheTest, FunctionJitUsesCache) {
+  absl::FlagSaver flag_saver;
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  absl::SetFlag(&FLAGS_jit_object_cache_dir, temp_dir.path().string());
+  ASSERT_NE(JitObjectCache::GetDefault(), nullptr);
+
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  fb.UMul(fb.Add(x, y), y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  std::vector<Value> args = {Value(UBits(3, 32)), Value(UBits(5, 32))};
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                           InterpretFunction(f, args));
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+    EXPECT_THAT(DropInterpreterEvents(jit->Run(args)),
+                IsOkAndHolds(expected.value));
+  }
+  int64_t entries = CountCacheEntries(temp_dir.path());
+  EXPECT_GT(entries, 0);
+
+  // A second compilation of the same function is served from the cache.
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+    EXPECT_THAT(DropInterpreterEvents(jit->Run(args)),
+                IsOkAndHolds(expected.value));
+  }
+  EXPECT_EQ(CountCacheEntries(temp_dir.path()), entries);
+
+  // A different optimization level produces a different entry.
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f, /*opt_level=*/1));
+    EXPECT_THAT(DropInterpreterEvents(jit->Run(args)),
+                IsOkAndHolds(expected.value));
+  }
+  EXPECT_GT(CountCacheEntries(temp_dir.path()), entries);
+}
+
+}  // namespace
+}  // namespace xls
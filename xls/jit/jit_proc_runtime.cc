@@ -14,16 +14,21 @@
 
 #include "xls/jit/jit_proc_runtime.h"
 
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/parallel_proc_runtime.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/proc_interpreter.h"
 #include "xls/interpreter/serial_proc_runtime.h"
@@ -32,14 +37,26 @@
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/value.h"
+#include "xls/jit/aot_entrypoint.pb.h"
+#include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/proc_jit.h"
 
 namespace xls {
 namespace {
 
-absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
-    ProcElaboration elaboration) {
+absl::StatusOr<std::unique_ptr<ProcJit>> CompileProcJit(
+    Proc* proc, JitChannelQueueManager* queue_manager) {
+  return ProcJit::Create(proc, &queue_manager->runtime(), queue_manager);
+}
+
+// Creates the ProcJits for the procs in the elaboration using `create_proc_jit`
+// and constructs a runtime from them using `create_runtime`.
+template <typename RuntimeT, typename CreateFn,
+          typename CreateProcJitFn = decltype(&CompileProcJit)>
+absl::StatusOr<std::unique_ptr<RuntimeT>> CreateRuntime(
+    ProcElaboration elaboration, CreateFn create_runtime,
+    CreateProcJitFn create_proc_jit = &CompileProcJit) {
   // Create a queue manager for the queues. This factory verifies that there an
   // receive only queue for every receive only channel.
   XLS_ASSIGN_OR_RETURN(
@@ -49,16 +66,15 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
   // Create a ProcJit for each Proc.
   std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
   for (Proc* proc : queue_manager->elaboration().procs()) {
-    XLS_ASSIGN_OR_RETURN(
-        std::unique_ptr<ProcJit> proc_jit,
-        ProcJit::Create(proc, &queue_manager->runtime(), queue_manager.get()));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<ProcJit> proc_jit,
+                         create_proc_jit(proc, queue_manager.get()));
     proc_jits.push_back(std::move(proc_jit));
   }
 
   // Create a runtime.
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> proc_runtime,
-                       SerialProcRuntime::Create(std::move(proc_jits),
-                                                 std::move(queue_manager)));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<RuntimeT> proc_runtime,
+      create_runtime(std::move(proc_jits), std::move(queue_manager)));
 
   // Inject initial values into channel queues.
   for (ChannelInstance* channel_instance :
@@ -74,20 +90,112 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
   return std::move(proc_runtime);
 }
 
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateSerialRuntime(
+    ProcElaboration elaboration) {
+  return CreateRuntime<SerialProcRuntime>(
+      std::move(elaboration),
+      [](std::vector<std::unique_ptr<ProcEvaluator>>&& proc_jits,
+         std::unique_ptr<JitChannelQueueManager>&& queue_manager) {
+        return SerialProcRuntime::Create(std::move(proc_jits),
+                                         std::move(queue_manager));
+      });
+}
+
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotSerialRuntime(
+    ProcElaboration elaboration, const AotPackageEntrypointsProto& entrypoints,
+    absl::Span<const JitFunctionType> functions) {
+  if (entrypoints.entrypoint_size() != functions.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Got %d AOT entrypoints but %d functions",
+        entrypoints.entrypoint_size(), functions.size()));
+  }
+  absl::flat_hash_map<std::string_view, int64_t> entrypoint_indices;
+  for (int64_t i = 0; i < entrypoints.entrypoint_size(); ++i) {
+    entrypoint_indices[entrypoints.entrypoint(i).function_base_name()] = i;
+  }
+  auto create_proc_jit = [&](Proc* proc, JitChannelQueueManager* queue_manager)
+      -> absl::StatusOr<std::unique_ptr<ProcJit>> {
+    auto it = entrypoint_indices.find(proc->name());
+    if (it == entrypoint_indices.end()) {
+      return absl::NotFoundError(absl::StrFormat(
+          "No AOT entrypoint for proc `%s`", proc->name()));
+    }
+    XLS_ASSIGN_OR_RETURN(
+        JittedFunctionBase jitted_function_base,
+        JittedFunctionBase::BuildFromAot(
+            proc, entrypoints.entrypoint(it->second), functions[it->second]));
+    return ProcJit::CreateFromAot(proc, &queue_manager->runtime(),
+                                  queue_manager,
+                                  std::move(jitted_function_base));
+  };
+  return CreateRuntime<SerialProcRuntime>(
+      std::move(elaboration),
+      [](std::vector<std::unique_ptr<ProcEvaluator>>&& proc_jits,
+         std::unique_ptr<JitChannelQueueManager>&& queue_manager) {
+        return SerialProcRuntime::Create(std::move(proc_jits),
+                                         std::move(queue_manager));
+      },
+      create_proc_jit);
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>> CreateParallelRuntime(
+    ProcElaboration elaboration, std::optional<int64_t> worker_count) {
+  return CreateRuntime<ParallelProcRuntime>(
+      std::move(elaboration),
+      [&](std::vector<std::unique_ptr<ProcEvaluator>>&& proc_jits,
+          std::unique_ptr<JitChannelQueueManager>&& queue_manager) {
+        return ParallelProcRuntime::Create(
+            std::move(proc_jits), std::move(queue_manager), worker_count);
+      });
+}
+
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
     Package* package) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
                        ProcElaboration::ElaborateOldStylePackage(package));
-  return CreateRuntime(std::move(elaboration));
+  return CreateSerialRuntime(std::move(elaboration));
 }
 
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
     Proc* top) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
                        ProcElaboration::Elaborate(top));
-  return CreateRuntime(std::move(elaboration));
+  return CreateSerialRuntime(std::move(elaboration));
+}
+
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotSerialProcRuntime(
+    Package* package, const AotPackageEntrypointsProto& entrypoints,
+    absl::Span<const JitFunctionType> functions) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::ElaborateOldStylePackage(package));
+  return CreateAotSerialRuntime(std::move(elaboration), entrypoints,
+                                functions);
+}
+
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotSerialProcRuntime(
+    Proc* top, const AotPackageEntrypointsProto& entrypoints,
+    absl::Span<const JitFunctionType> functions) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::Elaborate(top));
+  return CreateAotSerialRuntime(std::move(elaboration), entrypoints,
+                                functions);
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(Package* package,
+                             std::optional<int64_t> worker_count) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::ElaborateOldStylePackage(package));
+  return CreateParallelRuntime(std::move(elaboration), worker_count);
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(Proc* top, std::optional<int64_t> worker_count) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::Elaborate(top));
+  return CreateParallelRuntime(std::move(elaboration), worker_count);
 }
 
 }  // namespace xls
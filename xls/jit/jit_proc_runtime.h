@@ -15,11 +15,18 @@
 #ifndef XLS_JIT_JIT_PROC_RUNTIME_H_
 #define XLS_JIT_JIT_PROC_RUNTIME_H_
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/interpreter/parallel_proc_runtime.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/jit/aot_entrypoint.pb.h"
+#include "xls/jit/function_base_jit.h"
 
 namespace xls {
 
@@ -33,6 +40,33 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
     Proc* top);
 
+// Create a ParallelProcRuntime composed of ProcJits which evaluates the proc
+// instances on up to `worker_count` threads (by default the number of available
+// CPUs). Supports old-style procs.
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(
+    Package* package, std::optional<int64_t> worker_count = std::nullopt);
+
+// Create a ParallelProcRuntime composed of ProcJits. Constructed from the
+// elaboration of the given proc. Supports new-style procs.
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(
+    Proc* top, std::optional<int64_t> worker_count = std::nullopt);
+
+// Create a SerialProcRuntime composed of ahead-of-time compiled procs. No code
+// is compiled. `entrypoints` describes the compiled code of each proc in the
+// elaboration and `functions` holds the address of the corresponding compiled
+// function, in the same order. Supports old-style procs.
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotSerialProcRuntime(
+    Package* package, const AotPackageEntrypointsProto& entrypoints,
+    absl::Span<const JitFunctionType> functions);
+
+// As above but constructed from the elaboration of the given proc. Supports
+// new-style procs.
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotSerialProcRuntime(
+    Proc* top, const AotPackageEntrypointsProto& entrypoints,
+    absl::Span<const JitFunctionType> functions);
+
 }  // namespace xls
 
 #endif  // XLS_JIT_JIT_PROC_RUNTIME_H_
@@ -20,7 +20,11 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/no_destructor.h"
 #include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
@@ -31,6 +35,7 @@
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -47,6 +52,34 @@ JitRuntime::JitRuntime(llvm::DataLayout data_layout)
   return std::make_unique<JitRuntime>(data_layout);
 }
 
+/* static */ absl::StatusOr<JitRuntime*> JitRuntime::GetShared() {
+  static absl::NoDestructor<absl::StatusOr<std::unique_ptr<JitRuntime>>>
+      shared(Create());
+  XLS_RETURN_IF_ERROR(shared->status());
+  return shared->value().get();
+}
+
+JitRuntime::TypeSizeAndAlignment JitRuntime::GetTypeSizeAndAlignment(
+    const Type* type) {
+  {
+    absl::ReaderMutexLock lock(&layout_cache_mutex_);
+    auto it = layout_cache_.find(type);
+    if (it != layout_cache_.end() &&
+        it->second.type_unique_id == type->unique_id()) {
+      return it->second;
+    }
+  }
+  TypeSizeAndAlignment result{.type_unique_id = type->unique_id()};
+  {
+    absl::MutexLock lock(&mutex_);
+    result.byte_size = type_converter_->GetTypeByteSize(type);
+    result.alignment = type_converter_->GetTypePreferredAlignment(type);
+  }
+  absl::MutexLock lock(&layout_cache_mutex_);
+  layout_cache_.insert_or_assign(type, result);
+  return result;
+}
+
 absl::Status JitRuntime::PackArgs(absl::Span<const Value> args,
                                   absl::Span<Type* const> arg_types,
                                   absl::Span<uint8_t* const> arg_buffers) {
@@ -67,77 +100,80 @@ absl::Status JitRuntime::PackArgs(absl::Span<const Value> args,
 }
 
 Value JitRuntime::UnpackBuffer(const uint8_t* buffer, const Type* result_type) {
-  absl::MutexLock lock(&mutex_);
-  return UnpackBufferInternal(buffer, result_type);
+  return GetTypeLayout(result_type)->NativeLayoutToValue(buffer);
 }
 
-Value JitRuntime::UnpackBufferInternal(const uint8_t* buffer,
-                                       const Type* result_type) {
-  switch (result_type->kind()) {
-    case TypeKind::kBits: {
-      const BitsType* bits_type = result_type->AsBitsOrDie();
-      int64_t bit_count = bits_type->bit_count();
-      int64_t byte_count = CeilOfRatio(bit_count, kCharBit);
-      return Value(
-          Bits::FromBytes(absl::MakeSpan(buffer, byte_count), bit_count));
-    }
-    case TypeKind::kTuple: {
-      // Just as with arg packing, we need the DataLayout to tell us where each
-      // arg is placed in the output buffer.
-      const TupleType* tuple_type = result_type->AsTupleOrDie();
-      llvm::Type* llvm_type = type_converter_->ConvertToLlvmType(tuple_type);
-      const llvm::StructLayout* layout =
-          data_layout_.getStructLayout(llvm::cast<llvm::StructType>(llvm_type));
-
-      std::vector<Value> values;
-      values.reserve(tuple_type->size());
-      for (int i = 0; i < tuple_type->size(); ++i) {
-        Value value = UnpackBufferInternal(buffer + layout->getElementOffset(i),
-                                           tuple_type->element_type(i));
-        values.push_back(value);
-      }
-      return Value::TupleOwned(std::move(values));
-    }
-    case TypeKind::kArray: {
-      const ArrayType* array_type = result_type->AsArrayOrDie();
-      if (array_type->size() == 0) {
-        return Value::ArrayOrDie({});
-      }
-
-      const Type* element_type = array_type->element_type();
-      llvm::Type* llvm_element_type =
-          type_converter_->ConvertToLlvmType(array_type->element_type());
-      std::vector<Value> values;
-      values.reserve(array_type->size());
-      // This BitsType is only used inside the ToLlvmConstantCall() (and isn't
-      // stored), so it's safe for it to live on the stack.
-      BitsType bits_type(64);
-      for (int i = 0; i < array_type->size(); ++i) {
-        llvm::Constant* index =
-            type_converter_->ToLlvmConstant(&bits_type, Value(UBits(i, 64)))
-                .value();
-        int64_t offset =
-            data_layout_.getIndexedOffsetInType(llvm_element_type, index);
-        Value value = UnpackBufferInternal(buffer + offset, element_type);
-        values.push_back(value);
-      }
+TypeLayout JitRuntime::CreateTypeLayout(Type* xls_type) {
+  absl::MutexLock lock(&mutex_);
+  return type_converter_->CreateTypeLayout(xls_type);
+}
 
-      return Value::ArrayOrDie(values);
+std::shared_ptr<const TypeLayout> JitRuntime::GetTypeLayout(
+    const Type* xls_type) {
+  {
+    absl::ReaderMutexLock lock(&layout_cache_mutex_);
+    auto it = type_layout_cache_.find(xls_type);
+    if (it != type_layout_cache_.end() &&
+        it->second.type_unique_id == xls_type->unique_id()) {
+      return it->second.layout;
     }
-    case TypeKind::kToken:
-      return Value::Token();
-    default:
-      LOG(FATAL) << "Unsupported XLS Value kind: " << result_type->kind();
   }
+  // The type converter does not modify the type; it is non-const only because
+  // TypeLayout holds a mutable pointer to it.
+  auto layout = std::make_shared<const TypeLayout>(
+      CreateTypeLayout(const_cast<Type*>(xls_type)));
+  absl::MutexLock lock(&layout_cache_mutex_);
+  type_layout_cache_.insert_or_assign(
+      xls_type, CachedTypeLayout{.type_unique_id = xls_type->unique_id(),
+                                 .layout = layout});
+  return layout;
 }
 
 void JitRuntime::BlitValueToBuffer(const Value& value, const Type* type,
                                    absl::Span<uint8_t> buffer) {
-  absl::MutexLock lock(&mutex_);
+  std::shared_ptr<const TypeLayout> layout = GetTypeLayout(type);
+  CHECK_GE(buffer.size(), layout->size());
   // Zero the buffer before filling in values. This ensures all padding bytes
-  // are cleared.
-  memset(buffer.data(), 0, type_converter_->GetTypeByteSize(type));
-  BlitValueToBufferInternal(value, type, buffer);
+  // between elements are cleared; the layout clears padding within leaves.
+  memset(buffer.data(), 0, layout->size());
+  layout->ValueToNativeLayout(value, buffer.data());
+}
+
+absl::Status JitRuntime::ValuesToNativeLayout(absl::Span<const Value> values,
+                                              const Type* type,
+                                              absl::Span<uint8_t> buffer) {
+  std::shared_ptr<const TypeLayout> layout = GetTypeLayout(type);
+  int64_t byte_size = layout->size();
+  if (buffer.size() < values.size() * byte_size) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Buffer of %d bytes is too small to hold %d values of type %s (%d "
+        "bytes each)",
+        buffer.size(), values.size(), type->ToString(), byte_size));
+  }
+  memset(buffer.data(), 0, values.size() * byte_size);
+  for (int64_t i = 0; i < values.size(); ++i) {
+    layout->ValueToNativeLayout(values[i], buffer.data() + i * byte_size);
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<Value>> JitRuntime::NativeLayoutToValues(
+    absl::Span<const uint8_t> buffer, const Type* type, int64_t count) {
+  std::shared_ptr<const TypeLayout> layout = GetTypeLayout(type);
+  int64_t byte_size = layout->size();
+  if (count < 0 || buffer.size() < count * byte_size) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Buffer of %d bytes is too small to hold %d values of type %s (%d "
+        "bytes each)",
+        buffer.size(), count, type->ToString(), byte_size));
+  }
+  std::vector<Value> values;
+  values.reserve(count);
+  for (int64_t i = 0; i < count; ++i) {
+    values.push_back(
+        layout->NativeLayoutToValue(buffer.data() + i * byte_size));
+  }
+  return values;
 }
 
 absl::Span<uint8_t> JitRuntime::AsAligned(absl::Span<uint8_t> buffer,
@@ -146,55 +182,6 @@ absl::Span<uint8_t> JitRuntime::AsAligned(absl::Span<uint8_t> buffer,
       reinterpret_cast<uintptr_t>(buffer.data()), llvm::Align(alignment)));
 }
 
-void JitRuntime::BlitValueToBufferInternal(const Value& value, const Type* type,
-                                           absl::Span<uint8_t> buffer) {
-  if (value.IsBits()) {
-    const Bits& bits = value.bits();
-    int64_t byte_count = CeilOfRatio(bits.bit_count(), kCharBit);
-    // Underlying Bits object relies on little-endianness.
-    CHECK(data_layout_.isLittleEndian());
-    bits.ToBytes(absl::MakeSpan(buffer.data(), byte_count));
-
-    // Zero out any padding bits. Bits type are stored in the JIT as the next
-    // power of two size.  LLVM requires all padding bits to be zero for safe
-    // operation, e.g., for a 42 bit type (which is padded out to a 64-bit word
-    // in the jit) bits 42 through 64 must be zero. The entire buffer is zeroed
-    // prior to calling this function so we only need to handle the remainder
-    // bits in the most-significant byte of value data here.
-    int remainder_bits = bits.bit_count() % kCharBit;
-    if (remainder_bits != 0) {
-      buffer[byte_count - 1] &= static_cast<uint8_t>(Mask(remainder_bits));
-    }
-  } else if (value.IsArray()) {
-    const ArrayType* array_type = type->AsArrayOrDie();
-    int64_t element_size =
-        type_converter_->GetTypeByteSize(array_type->element_type());
-    for (int i = 0; i < value.size(); ++i) {
-      BlitValueToBufferInternal(value.element(i), array_type->element_type(),
-                                buffer);
-      buffer = buffer.subspan(element_size);
-    }
-  } else if (value.IsTuple()) {
-    // Due to per-target data packing (esp. as realized by the LLVM IR
-    // load/store instructions), we need to make sure we blit args into LLVM
-    // space as the underlying runtime expects, which means we need the
-    // DataLayout to tell us where each constituent element should be placed.
-    llvm::Type* llvm_type = type_converter_->ConvertToLlvmType(type);
-    const llvm::StructLayout* layout =
-        data_layout_.getStructLayout(llvm::cast<llvm::StructType>(llvm_type));
-
-    const TupleType* tuple_type = type->AsTupleOrDie();
-    for (int i = 0; i < value.size(); ++i) {
-      BlitValueToBufferInternal(value.element(i), tuple_type->element_type(i),
-                                buffer.subspan(layout->getElementOffset(i)));
-    }
-  } else if (value.IsToken()) {
-    // Tokens contain no data.
-  } else {
-    LOG(FATAL) << "Unsupported XLS Value kind: " << value.kind();
-  }
-}
-
 extern "C" {
 
 int64_t XlsJitGetArgBufferSize(int arg_count, const char** input_args) {
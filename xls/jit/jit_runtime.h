@@ -17,13 +17,19 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -35,6 +41,12 @@ class JitRuntime {
   explicit JitRuntime(llvm::DataLayout data_layout);
   static absl::StatusOr<std::unique_ptr<JitRuntime>> Create();
 
+  // Returns a runtime for the data layout of the host which is shared by all
+  // users in the process and never destroyed. JitRuntime is thread-safe, so
+  // jits can share it rather than each holding an LLVM context and type
+  // caches of its own.
+  static absl::StatusOr<JitRuntime*> GetShared();
+
   // Packs the specified values into a flat buffer with the data layout
   // expected by LLVM.
   // "arg_buffers" must contain an entry corresponding to each element in
@@ -53,6 +65,15 @@ class JitRuntime {
   void BlitValueToBuffer(const Value& value, const Type* type,
                          absl::Span<uint8_t> buffer);
 
+  // Bulk versions of BlitValueToBuffer and UnpackBuffer for many values of the
+  // same type. The values are stored consecutively in `buffer`, each occupying
+  // GetTypeByteSize(type) bytes.
+  absl::Status ValuesToNativeLayout(absl::Span<const Value> values,
+                                    const Type* type,
+                                    absl::Span<uint8_t> buffer);
+  absl::StatusOr<std::vector<Value>> NativeLayoutToValues(
+      absl::Span<const uint8_t> buffer, const Type* type, int64_t count);
+
   const llvm::DataLayout& data_layout() { return data_layout_; }
 
   // Returns the number of bytes that should be allocated for a native LLVM
@@ -95,28 +116,56 @@ class JitRuntime {
     return AsAligned(buffer, data_layout_.getStackAlignment().value());
   }
 
+  // The native size and preferred alignment of values of the given type. These
+  // are computed once per type and then served from a cache which only takes
+  // a shared lock.
   int64_t GetTypeByteSize(Type* xls_type) {
-    absl::MutexLock lock(&mutex_);
-    return type_converter_->GetTypeByteSize(xls_type);
+    return GetTypeSizeAndAlignment(xls_type).byte_size;
   }
 
   int64_t GetTypeAlignment(Type* xls_type) {
-    absl::MutexLock lock(&mutex_);
-    return type_converter_->GetTypePreferredAlignment(xls_type);
+    return GetTypeSizeAndAlignment(xls_type).alignment;
   }
 
- private:
-  Value UnpackBufferInternal(const uint8_t* buffer, const Type* result_type)
-      ABSL_SHARED_LOCKS_REQUIRED(mutex_);
-  void BlitValueToBufferInternal(const Value& value, const Type* type,
-                                 absl::Span<uint8_t> buffer)
-      ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+  // Returns the layout of values of the given type in the native format used
+  // by the JIT.
+  TypeLayout CreateTypeLayout(Type* xls_type);
 
+  // Returns the cached layout of values of the given type. The layout is
+  // computed once per type and is also used by the conversion routines above so
+  // that they do not walk the LLVM type or take the type converter lock.
+  std::shared_ptr<const TypeLayout> GetTypeLayout(const Type* xls_type);
+
+ private:
+  struct TypeSizeAndAlignment {
+    // The Type::unique_id of the type the entry was computed for. Guards
+    // against the type pointer having been reused by a different type.
+    uint64_t type_unique_id;
+    int64_t byte_size;
+    int64_t alignment;
+  };
+
+  TypeSizeAndAlignment GetTypeSizeAndAlignment(const Type* type);
+
+  struct CachedTypeLayout {
+    // As in TypeSizeAndAlignment.
+    uint64_t type_unique_id;
+    std::shared_ptr<const TypeLayout> layout;
+  };
+
+  // Guards the type converter, which is not thread-safe. Only taken when a new
+  // type is first encountered.
   mutable absl::Mutex mutex_;
 
   const llvm::DataLayout data_layout_;
   std::unique_ptr<llvm::LLVMContext> context_ ABSL_GUARDED_BY(mutex_);
   std::unique_ptr<LlvmTypeConverter> type_converter_ ABSL_GUARDED_BY(mutex_);
+
+  mutable absl::Mutex layout_cache_mutex_;
+  absl::flat_hash_map<const Type*, TypeSizeAndAlignment> layout_cache_
+      ABSL_GUARDED_BY(layout_cache_mutex_);
+  absl::flat_hash_map<const Type*, CachedTypeLayout> type_layout_cache_
+      ABSL_GUARDED_BY(layout_cache_mutex_);
 };
 
 }  // namespace xls
@@ -0,0 +1,97 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_runtime.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using testing::HasSubstr;
+
+class JitRuntimeTest : public IrTestBase {};
+
+TEST_F(JitRuntimeTest, RoundTrip) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitRuntime> runtime,
+                           JitRuntime::Create());
+  std::minstd_rand bitgen;
+  for (const char* type_str :
+       {"()", "bits[1]", "bits[42]", "bits[100]", "bits[7][5]",
+        "(bits[3], token, bits[65])", "(bits[1], (bits[17], bits[2][3]))[4]"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(Type * type,
+                             Parser::ParseType(type_str, package.get()));
+    Value value = RandomValue(type, bitgen);
+    // Fill with garbage to ensure padding is cleared.
+    std::vector<uint8_t> buffer(runtime->GetTypeByteSize(type), 0xff);
+    runtime->BlitValueToBuffer(value, type, absl::MakeSpan(buffer));
+    EXPECT_EQ(runtime->UnpackBuffer(buffer.data(), type), value) << type_str;
+  }
+}
+
+TEST_F(JitRuntimeTest, BulkConversion) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitRuntime> runtime,
+                           JitRuntime::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Type * type,
+      Parser::ParseType("(bits[3], bits[33][2], token)", package.get()));
+  std::minstd_rand bitgen;
+  std::vector<Value> values;
+  for (int64_t i = 0; i < 10; ++i) {
+    values.push_back(RandomValue(type, bitgen));
+  }
+  int64_t byte_size = runtime->GetTypeByteSize(type);
+  std::vector<uint8_t> buffer(values.size() * byte_size, 0xff);
+  XLS_ASSERT_OK(
+      runtime->ValuesToNativeLayout(values, type, absl::MakeSpan(buffer)));
+
+  // Each value is at the same place as it would be if converted alone.
+  for (int64_t i = 0; i < values.size(); ++i) {
+    std::vector<uint8_t> single(byte_size);
+    runtime->BlitValueToBuffer(values[i], type, absl::MakeSpan(single));
+    EXPECT_EQ(std::vector<uint8_t>(buffer.begin() + i * byte_size,
+                                   buffer.begin() + (i + 1) * byte_size),
+              single);
+  }
+
+  EXPECT_THAT(runtime->NativeLayoutToValues(buffer, type, values.size()),
+              IsOkAndHolds(values));
+  EXPECT_THAT(runtime->NativeLayoutToValues(buffer, type, values.size() + 1),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("too small")));
+  EXPECT_THAT(runtime->ValuesToNativeLayout(
+                  values, type, absl::MakeSpan(buffer).subspan(1)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("too small")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -40,6 +40,12 @@ JitObserverRequests CompoundObserver::GetNotificationOptions() const {
                          [](auto* o) {
                            return o->GetNotificationOptions().assembly_code_str;
                          }),
+      .node_profile = absl::c_any_of(
+          observers_,
+          [](auto* o) { return o->GetNotificationOptions().node_profile; }),
+      .memory_usage = absl::c_any_of(
+          observers_,
+          [](auto* o) { return o->GetNotificationOptions().memory_usage; }),
   };
 }
 void CompoundObserver::UnoptimizedModule(const llvm::Module* module) {
@@ -65,5 +71,23 @@ void CompoundObserver::AssemblyCodeString(const llvm::Module* module,
   }
 }
 
+JitNodeProfile* CompoundObserver::GetNodeProfile() {
+  for (auto* o : observers_) {
+    if (o->GetNotificationOptions().node_profile) {
+      return o->GetNodeProfile();
+    }
+  }
+  return nullptr;
+}
+
+void CompoundObserver::CompiledMemoryUsage(const FunctionBase* function,
+                                           const JitMemoryUsage& usage) {
+  for (auto* o : observers_) {
+    if (o->GetNotificationOptions().memory_usage) {
+      o->CompiledMemoryUsage(function, usage);
+    }
+  }
+}
+
 void CompoundObserver::AddObserver(JitObserver* o) { observers_.push_back(o); }
 }  // namespace xls
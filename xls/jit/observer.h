@@ -15,6 +15,7 @@
 #ifndef XLS_JIT_OBSERVER_H_
 #define XLS_JIT_OBSERVER_H_
 
+#include <cstdint>
 #include <string_view>
 #include <vector>
 
@@ -24,6 +25,9 @@
 
 namespace xls {
 
+class FunctionBase;
+class JitNodeProfile;
+
 // All the things an observer can handle. Setting these flags tells users that
 // they do not need to call the observer methods. They should be considered
 // purely advisory however.
@@ -34,6 +38,20 @@ struct JitObserverRequests {
   bool optimized_module = false;
   // Do we want to get called with optimized asm code.
   bool assembly_code_str = false;
+  // Do we want the jitted code to count the evaluations of each node in the
+  // profile returned by GetNodeProfile. This adds a memory increment per node
+  // evaluation.
+  bool node_profile = false;
+  // Do we want to get called with the memory held by each compiled function.
+  bool memory_usage = false;
+};
+
+// Memory held by a JIT for linked object code.
+struct JitMemoryUsage {
+  // Bytes allocated for executable code.
+  int64_t code_bytes = 0;
+  // Bytes allocated for data such as constants and relocation tables.
+  int64_t data_bytes = 0;
 };
 
 // Basic observer for JIT compilation events
@@ -49,6 +67,13 @@ class JitObserver {
   // Called when a LLVM module has been compiled with the module code.
   virtual void AssemblyCodeString(const llvm::Module* module,
                                   std::string_view asm_code) {}
+  // Returns the profile into which node evaluations are counted. Only called
+  // if `node_profile` is requested.
+  virtual JitNodeProfile* GetNodeProfile() { return nullptr; }
+  // Called when `function` has been compiled with the memory held by the JIT
+  // which compiled it.
+  virtual void CompiledMemoryUsage(const FunctionBase* function,
+                                   const JitMemoryUsage& usage) {}
 };
 
 // A compound observer that lets one trigger multiple observers at once.
@@ -61,6 +86,10 @@ class CompoundObserver final : public JitObserver {
   void OptimizedModule(const llvm::Module* module) final;
   void AssemblyCodeString(const llvm::Module* module,
                           std::string_view asm_code) final;
+  // Returns the profile of the first observer which requests one.
+  JitNodeProfile* GetNodeProfile() final;
+  void CompiledMemoryUsage(const FunctionBase* function,
+                           const JitMemoryUsage& usage) final;
 
   void AddObserver(JitObserver* o);
 
@@ -14,8 +14,13 @@
 
 #include "xls/jit/orc_jit.h"
 
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <cstdint>
+#include <cstdio>
 #include <memory>
 #include <optional>
 #include <string>
@@ -25,55 +30,106 @@
 #include <vector>
 
 #include "absl/base/call_once.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/flags/flag.h"
 #include "absl/log/log.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "llvm/include/llvm-c/Target.h"
 #include "llvm/include/llvm/ADT/SmallVector.h"
 #include "llvm/include/llvm/ADT/StringExtras.h"
 #include "llvm/include/llvm/Analysis/CGSCCPassManager.h"
+#include "llvm/include/llvm/Bitcode/BitcodeReader.h"
+#include "llvm/include/llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/include/llvm/Config/llvm-config.h"
 #include "llvm/include/llvm/Analysis/LoopAnalysisManager.h"
+#include "llvm/include/llvm/ExecutionEngine/JITEventListener.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ExecutionUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ExecutorProcessControl.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRCompileLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRTransformLayer.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/IndirectionUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Layer.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/LazyReexports.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Shared/ExecutorAddress.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Shared/ExecutorSymbolDef.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+#include "llvm/include/llvm/ExecutionEngine/RuntimeDyld.h"
 #include "llvm/include/llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/include/llvm/IR/Argument.h"
 #include "llvm/include/llvm/IR/BasicBlock.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
+#include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/GlobalValue.h"
+#include "llvm/include/llvm/IR/InstrTypes.h"
 #include "llvm/include/llvm/IR/Instruction.h"
+#include "llvm/include/llvm/IR/LLVMContext.h"
 #include "llvm/include/llvm/IR/LegacyPassManager.h"
 #include "llvm/include/llvm/IR/Module.h"
 #include "llvm/include/llvm/IR/PassManager.h"
 #include "llvm/include/llvm/IR/Use.h"
 #include "llvm/include/llvm/IRPrinter/IRPrintingPasses.h"
+#include "llvm/include/llvm/Object/ObjectFile.h"
+#include "llvm/include/llvm/Object/SymbolSize.h"
 #include "llvm/include/llvm/Passes/OptimizationLevel.h"
 #include "llvm/include/llvm/Passes/PassBuilder.h"
 #include "llvm/include/llvm/Support/Casting.h"
 #include "llvm/include/llvm/Support/CodeGen.h"
 #include "llvm/include/llvm/Support/Error.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
+#include "llvm/include/llvm/Support/SHA256.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "llvm/include/llvm/TargetParser/SubtargetFeature.h"
+#include "llvm/include/llvm/TargetParser/Triple.h"
 #include "llvm/include/llvm/TargetParser/X86TargetParser.h"
 #include "llvm/include/llvm/Transforms/Instrumentation/MemorySanitizer.h"
+#include "llvm/include/llvm/Transforms/Utils/SplitModule.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/common/trace.h"
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/observer.h"
 
+ABSL_FLAG(int64_t, jit_compile_threads, 0,
+          "Maximum number of threads the JIT uses to optimize and compile a "
+          "single large LLVM module. Zero uses all available CPUs. Modules are "
+          "only split when each part is large enough to be worth a thread.");
+ABSL_FLAG(std::string, jit_pipeline, "standard",
+          "The LLVM pipeline used by the JIT unless one is given explicitly. "
+          "One of: standard (optimize at the requested opt level), quick "
+          "(minimal optimization and fast instruction selection; best for "
+          "short runs such as tests) or throughput (O3 tuned for the host "
+          "CPU with vectorization; best for long runs).");
+ABSL_FLAG(bool, jit_lazy_compilation, false,
+          "Compile each function of a JIT module when it is first called "
+          "rather than when the module is added. Reduces the time to the first "
+          "result of large packages in which few functions are executed, at "
+          "the cost of inlining across XLS functions.");
+
+ABSL_FLAG(bool, jit_perf_map, false,
+          "Register the symbols of jitted code with perf by appending them to "
+          "/tmp/perf-<pid>.map. If LLVM is built with perf support a jitdump "
+          "file for `perf inject --jit` is written as well.");
+
 namespace xls {
 namespace {
 
+// Version of the object cache key format. Bump this when a change to the JIT
+// affects the generated object code without affecting the unoptimized module
+// (e.g., a change to the optimization pipeline).
+constexpr int64_t kObjectCacheKeyVersion = 1;
+
 absl::once_flag once;
 void OnceInit() {
   LLVMInitializeNativeTarget();
@@ -110,46 +166,131 @@ class BadOptLevelError : public llvm::ErrorInfo<BadOptLevelError> {
 
 char BadOptLevelError::ID;
 
-}  // namespace
+// Listener which appends the function symbols of each object loaded by the JIT
+// to the perf map file /tmp/perf-<pid>.map. This lets `perf report` attribute
+// samples in jitted code to the jitted function (and partition) names.
+class PerfMapListener final : public llvm::JITEventListener {
+ public:
+  void notifyObjectLoaded(
+      ObjectKey key, const llvm::object::ObjectFile& object,
+      const llvm::RuntimeDyld::LoadedObjectInfo& info) override {
+    // The debug object has its section addresses updated to the load
+    // addresses.
+    llvm::object::OwningBinary<llvm::object::ObjectFile> debug_object =
+        info.getObjectForDebug(object);
+    if (debug_object.getBinary() == nullptr) {
+      return;
+    }
+    std::string lines;
+    for (const auto& [symbol, size] :
+         llvm::object::computeSymbolSizes(*debug_object.getBinary())) {
+      llvm::Expected<llvm::object::SymbolRef::Type> type = symbol.getType();
+      if (!type) {
+        llvm::consumeError(type.takeError());
+        continue;
+      }
+      if (*type != llvm::object::SymbolRef::ST_Function) {
+        continue;
+      }
+      llvm::Expected<llvm::StringRef> name = symbol.getName();
+      if (!name) {
+        llvm::consumeError(name.takeError());
+        continue;
+      }
+      llvm::Expected<uint64_t> address = symbol.getAddress();
+      if (!address) {
+        llvm::consumeError(address.takeError());
+        continue;
+      }
+      absl::StrAppendFormat(&lines, "%x %x %s\n", *address, size,
+                            std::string_view(name->data(), name->size()));
+    }
 
-OrcJit::OrcJit(int64_t opt_level, bool emit_object_code, bool include_msan)
-    : context_(std::make_unique<llvm::LLVMContext>()),
-      execution_session_(
-          std::make_unique<llvm::orc::UnsupportedExecutorProcessControl>()),
-      object_layer_(
-          execution_session_,
-          []() { return std::make_unique<llvm::SectionMemoryManager>(); }),
-      dylib_(execution_session_.createBareJITDylib("main")),
-      opt_level_(opt_level),
-      emit_object_code_(emit_object_code),
-      data_layout_(""),
-      include_msan_(include_msan) {}
+    absl::MutexLock lock(&mutex_);
+    if (file_ == nullptr) {
+      std::string path = absl::StrFormat("/tmp/perf-%d.map", getpid());
+      file_ = fopen(path.c_str(), "a");
+      if (file_ == nullptr) {
+        LOG(WARNING) << "Unable to open perf map file " << path;
+        return;
+      }
+    }
+    fwrite(lines.data(), 1, lines.size(), file_);
+    fflush(file_);
+  }
 
-OrcJit::~OrcJit() {
-  if (auto err = execution_session_.endSession()) {
-    execution_session_.reportError(std::move(err));
+ private:
+  absl::Mutex mutex_;
+  FILE* file_ ABSL_GUARDED_BY(mutex_) = nullptr;
+};
+
+// Registers the perf listeners with `object_layer`. The listeners are shared
+// by all JITs in the process and are never destroyed.
+void RegisterPerfListeners(llvm::orc::RTDyldObjectLinkingLayer& object_layer) {
+  static PerfMapListener* perf_map_listener = new PerfMapListener();
+  object_layer.registerJITEventListener(*perf_map_listener);
+  // Writes a jitdump file for `perf inject --jit`. Only available if LLVM is
+  // built with perf support.
+  static llvm::JITEventListener* jitdump_listener =
+      llvm::JITEventListener::createPerfJITEventListener();
+  if (jitdump_listener != nullptr) {
+    object_layer.registerJITEventListener(*jitdump_listener);
   }
 }
 
-llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
-    llvm::orc::ThreadSafeModule module,
-    const llvm::orc::MaterializationResponsibility& responsibility) {
-  llvm::Module* bare_module = module.getModuleUnlocked();
+// A memory manager which counts the bytes it allocates for linked object code.
+class CountingMemoryManager final : public llvm::SectionMemoryManager {
+ public:
+  CountingMemoryManager(std::atomic<int64_t>* code_bytes,
+                        std::atomic<int64_t>* data_bytes)
+      : code_bytes_(code_bytes), data_bytes_(data_bytes) {}
 
-  VLOG(2) << "Unoptimized module IR:";
-  XLS_VLOG_LINES(2, DumpLlvmModuleToString(bare_module));
-  if (jit_observer_ != nullptr &&
-      jit_observer_->GetNotificationOptions().unoptimized_module) {
-    jit_observer_->UnoptimizedModule(bare_module);
+  uint8_t* allocateCodeSection(uintptr_t size, unsigned alignment,
+                               unsigned section_id,
+                               llvm::StringRef section_name) override {
+    *code_bytes_ += size;
+    return llvm::SectionMemoryManager::allocateCodeSection(
+        size, alignment, section_id, section_name);
   }
 
+  uint8_t* allocateDataSection(uintptr_t size, unsigned alignment,
+                               unsigned section_id,
+                               llvm::StringRef section_name,
+                               bool is_read_only) override {
+    *data_bytes_ += size;
+    return llvm::SectionMemoryManager::allocateDataSection(
+        size, alignment, section_id, section_name, is_read_only);
+  }
+
+ private:
+  std::atomic<int64_t>* code_bytes_;
+  std::atomic<int64_t>* data_bytes_;
+};
+
+// Runs the LLVM IR optimization pipeline for `pipeline` (and `opt_level` for
+// the standard pipeline) over `module`. `target_machine` is used to tune the
+// throughput pipeline for the target.
+llvm::Error OptimizeModule(llvm::Module& module, int64_t opt_level,
+                           JitPipeline pipeline, bool include_msan,
+                           llvm::TargetMachine* target_machine) {
   llvm::CGSCCAnalysisManager cgam;
   llvm::FunctionAnalysisManager fam;
   llvm::LoopAnalysisManager lam;
   llvm::ModuleAnalysisManager mam;
-  llvm::PassBuilder pass_builder;
+  llvm::PipelineTuningOptions tuning_options;
+  if (pipeline == JitPipeline::kThroughput) {
+    tuning_options.LoopVectorization = true;
+    tuning_options.SLPVectorization = true;
+    opt_level = 3;
+  } else {
+    target_machine = nullptr;
+    if (pipeline == JitPipeline::kQuick) {
+      opt_level = 0;
+    }
+  }
+  llvm::PassBuilder pass_builder(target_machine, tuning_options);
 
-  if (include_msan_) {
+  if (include_msan) {
     pass_builder.registerPipelineStartEPCallback(
         [](llvm::ModulePassManager& mpm, llvm::OptimizationLevel) -> void {
           mpm.addPass(
@@ -163,7 +304,7 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
   pass_builder.crossRegisterProxies(lam, fam, cgam, mam);
 
   llvm::OptimizationLevel llvm_opt_level;
-  switch (opt_level_) {
+  switch (opt_level) {
     case 0:
       llvm_opt_level = llvm::OptimizationLevel::O0;
       break;
@@ -177,8 +318,7 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
       llvm_opt_level = llvm::OptimizationLevel::O3;
       break;
     default:
-      return llvm::Expected<llvm::orc::ThreadSafeModule>(
-          llvm::Error(std::make_unique<BadOptLevelError>(opt_level_)));
+      return llvm::make_error<BadOptLevelError>(opt_level);
   }
   llvm::ModulePassManager mpm;
   if (llvm_opt_level == llvm::OptimizationLevel::O0) {
@@ -186,7 +326,98 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
   } else {
     mpm = pass_builder.buildPerModuleDefaultPipeline(llvm_opt_level);
   }
-  mpm.run(*bare_module, mam);
+  mpm.run(module, mam);
+  return llvm::Error::success();
+}
+
+// Configures the code generator of `target_machine` for `pipeline`.
+void ConfigureTargetMachine(JitPipeline pipeline,
+                            llvm::TargetMachine& target_machine) {
+  switch (pipeline) {
+    case JitPipeline::kQuick:
+      target_machine.setOptLevel(llvm::CodeGenOptLevel::None);
+      target_machine.setFastISel(true);
+      break;
+    case JitPipeline::kThroughput:
+      target_machine.setOptLevel(llvm::CodeGenOptLevel::Aggressive);
+      break;
+    case JitPipeline::kDefault:
+    case JitPipeline::kStandard:
+      break;
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<JitPipeline> JitPipelineFromString(std::string_view name) {
+  if (name == "standard") {
+    return JitPipeline::kStandard;
+  }
+  if (name == "quick") {
+    return JitPipeline::kQuick;
+  }
+  if (name == "throughput") {
+    return JitPipeline::kThroughput;
+  }
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "Unknown JIT pipeline `%s`; expected standard, quick or throughput",
+      name));
+}
+
+std::string JitPipelineToString(JitPipeline pipeline) {
+  switch (pipeline) {
+    case JitPipeline::kDefault:
+      return "default";
+    case JitPipeline::kStandard:
+      return "standard";
+    case JitPipeline::kQuick:
+      return "quick";
+    case JitPipeline::kThroughput:
+      return "throughput";
+  }
+  LOG(FATAL) << "Unknown JIT pipeline: " << static_cast<int>(pipeline);
+}
+
+OrcJit::OrcJit(int64_t opt_level, JitPipeline pipeline, bool emit_object_code,
+               bool include_msan)
+    : context_(std::make_unique<llvm::LLVMContext>()),
+      execution_session_(
+          std::make_unique<llvm::orc::UnsupportedExecutorProcessControl>()),
+      object_layer_(execution_session_,
+                    [this]() {
+                      return std::make_unique<CountingMemoryManager>(
+                          &code_bytes_, &data_bytes_);
+                    }),
+      dylib_(execution_session_.createBareJITDylib("main")),
+      opt_level_(opt_level),
+      pipeline_(pipeline),
+      emit_object_code_(emit_object_code),
+      data_layout_(""),
+      include_msan_(include_msan) {}
+
+OrcJit::~OrcJit() {
+  if (auto err = execution_session_.endSession()) {
+    execution_session_.reportError(std::move(err));
+  }
+}
+
+llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
+    llvm::orc::ThreadSafeModule module,
+    const llvm::orc::MaterializationResponsibility& responsibility) {
+  llvm::Module* bare_module = module.getModuleUnlocked();
+
+  VLOG(2) << "Unoptimized module IR:";
+  XLS_VLOG_LINES(2, DumpLlvmModuleToString(bare_module));
+  if (jit_observer_ != nullptr &&
+      jit_observer_->GetNotificationOptions().unoptimized_module) {
+    jit_observer_->UnoptimizedModule(bare_module);
+  }
+
+  if (llvm::Error error =
+          OptimizeModule(*bare_module, opt_level_, pipeline_, include_msan_,
+                         target_machine_.get())) {
+    return llvm::Expected<llvm::orc::ThreadSafeModule>(std::move(error));
+  }
 
   VLOG(2) << "Optimized module IR:";
   XLS_VLOG_LINES(2, DumpLlvmModuleToString(bare_module));
@@ -224,17 +455,30 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
 }
 
 absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(
-    int64_t opt_level, bool emit_object_code, std::optional<bool> emit_msan,
-    JitObserver* observer) {
+    const JitOptions& options, bool emit_object_code,
+    std::optional<bool> emit_msan, JitObserver* observer) {
   absl::call_once(once, OnceInit);
 #ifdef ABSL_HAVE_MEMORY_SANITIZER
   constexpr bool kHasMsan = true;
 #else
   constexpr bool kHasMsan = false;
 #endif
+  JitPipeline pipeline = options.pipeline;
+  if (pipeline == JitPipeline::kDefault) {
+    XLS_ASSIGN_OR_RETURN(
+        pipeline, JitPipelineFromString(absl::GetFlag(FLAGS_jit_pipeline)));
+  }
   std::unique_ptr<OrcJit> jit = absl::WrapUnique(
-      new OrcJit(opt_level, emit_object_code, emit_msan.value_or(kHasMsan)));
+      new OrcJit(options.opt_level, pipeline, emit_object_code,
+                 emit_msan.value_or(kHasMsan)));
   jit->SetJitObserver(observer);
+  int64_t compile_threads = absl::GetFlag(FLAGS_jit_compile_threads);
+  jit->SetCompileThreadCount(compile_threads > 0 ? compile_threads
+                                                 : AvailableCPUs());
+  jit->SetLazyCompilation(absl::GetFlag(FLAGS_jit_lazy_compilation));
+  if (!emit_object_code) {
+    jit->SetObjectCache(JitObjectCache::GetDefault());
+  }
   XLS_RETURN_IF_ERROR(jit->Init());
   return std::move(jit);
 }
@@ -372,6 +616,7 @@ class MsanHostEmuTls : public llvm::orc::DefinitionGenerator {
 
 absl::Status OrcJit::Init() {
   XLS_ASSIGN_OR_RETURN(target_machine_, CreateTargetMachine(emit_object_code_));
+  ConfigureTargetMachine(pipeline_, *target_machine_);
   if (VLOG_IS_ON(1)) {
     std::string triple = target_machine_->getTargetTriple().normalize();
     std::string cpu = target_machine_->getTargetCPU().str();
@@ -388,6 +633,10 @@ absl::Status OrcJit::Init() {
   }
   data_layout_ = target_machine_->createDataLayout();
 
+  if (absl::GetFlag(FLAGS_jit_perf_map)) {
+    RegisterPerfListeners(object_layer_);
+  }
+
   execution_session_.runSessionLocked([this]() {
     dylib_.addGenerator(std::make_unique<MsanHostEmuTls>());
     dylib_.addGenerator(
@@ -395,7 +644,9 @@ absl::Status OrcJit::Init() {
             data_layout_.getGlobalPrefix())));
   });
 
-  auto compiler = std::make_unique<llvm::orc::SimpleCompiler>(*target_machine_);
+  object_cache_writer_ = std::make_unique<ObjectCacheWriter>(this);
+  auto compiler = std::make_unique<llvm::orc::SimpleCompiler>(
+      *target_machine_, object_cache_writer_.get());
   compile_layer_ = std::make_unique<llvm::orc::IRCompileLayer>(
       execution_session_, object_layer_, std::move(compiler));
 
@@ -433,6 +684,11 @@ absl::Status OrcJit::Init() {
   return absl::OkStatus();
 }
 
+void OrcJit::ReleaseLlvmContext() {
+  context_ =
+      llvm::orc::ThreadSafeContext(std::make_unique<llvm::LLVMContext>());
+}
+
 std::unique_ptr<llvm::Module> OrcJit::NewModule(std::string_view name) {
   llvm::LLVMContext* bare_context = context_.getContext();
   auto module = std::make_unique<llvm::Module>(name, *bare_context);
@@ -482,8 +738,80 @@ absl::Status VerifyModule(const llvm::Module& module) {
 
 }  // namespace
 
+std::string OrcJit::GetObjectCacheKey(const llvm::Module& module) const {
+  std::string key_data = absl::StrFormat(
+      "version: %d\nllvm: %s\nopt_level: %d\npipeline: %s\nmsan: %d\n"
+      "triple: %s\ncpu: %s\nfeatures: %s\n",
+      kObjectCacheKeyVersion, LLVM_VERSION_STRING, opt_level_,
+      JitPipelineToString(pipeline_), include_msan_,
+      target_machine_->getTargetTriple().normalize(),
+      target_machine_->getTargetCPU().str(),
+      target_machine_->getTargetFeatureString().str());
+  absl::StrAppend(&key_data, DumpLlvmModuleToString(&module));
+  llvm::SHA256 sha;
+  sha.update(key_data);
+  return llvm::toHex(sha.final(), /*LowerCase=*/true);
+}
+
+bool OrcJit::ObserverRequiresCompilation() const {
+  if (jit_observer_ == nullptr) {
+    return false;
+  }
+  JitObserverRequests requests = jit_observer_->GetNotificationOptions();
+  return requests.unoptimized_module || requests.optimized_module ||
+         requests.assembly_code_str;
+}
+
+void OrcJit::ObjectCacheWriter::notifyObjectCompiled(
+    const llvm::Module* module, llvm::MemoryBufferRef object) {
+  std::string key;
+  {
+    absl::MutexLock lock(&jit_->pending_cache_keys_mutex_);
+    auto it = jit_->pending_cache_keys_.find(module);
+    if (it == jit_->pending_cache_keys_.end()) {
+      return;
+    }
+    key = std::move(it->second);
+    jit_->pending_cache_keys_.erase(it);
+  }
+  // Failing to populate the cache only costs a recompilation later so don't
+  // fail the compilation.
+  absl::Status status = jit_->object_cache_->Insert(
+      key, std::string_view(object.getBufferStart(), object.getBufferSize()));
+  if (!status.ok()) {
+    LOG(WARNING) << "Unable to write JIT object cache entry: " << status;
+  }
+}
+
 absl::Status OrcJit::CompileModule(std::unique_ptr<llvm::Module>&& module) {
+  TraceSpan span("llvm_compile");
   XLS_RETURN_IF_ERROR(VerifyModule(*module));
+  if (UseLazyCompilation()) {
+    return CompileModuleLazily(std::move(module));
+  }
+  if (object_cache_ != nullptr && !emit_object_code_ &&
+      !ObserverRequiresCompilation()) {
+    std::string key = GetObjectCacheKey(*module);
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> object,
+                         object_cache_->Lookup(key));
+    if (object.has_value()) {
+      VLOG(2) << "Using cached object code for module `"
+              << module->getModuleIdentifier() << "` (key " << key << ")";
+      llvm::Error error = object_layer_.add(
+          dylib_, llvm::MemoryBuffer::getMemBufferCopy(*object, key));
+      if (error) {
+        return absl::UnknownError(
+            absl::StrFormat("Error loading cached object code: %s",
+                            llvm::toString(std::move(error))));
+      }
+      return absl::OkStatus();
+    }
+    absl::MutexLock lock(&pending_cache_keys_mutex_);
+    pending_cache_keys_[module.get()] = std::move(key);
+  }
+  if (int64_t part_count = GetCompilePartCount(*module); part_count > 1) {
+    return CompileModuleInParts(*module, part_count);
+  }
   llvm::Error error = transform_layer_->add(
       dylib_, llvm::orc::ThreadSafeModule(std::move(module), context_));
   if (error) {
@@ -493,6 +821,193 @@ absl::Status OrcJit::CompileModule(std::unique_ptr<llvm::Module>&& module) {
   return absl::OkStatus();
 }
 
+namespace {
+
+// Called by a lazy compilation stub if compiling its function failed. The
+// failure itself is reported through the execution session.
+void LazyCompilationFailed() {
+  LOG(FATAL) << "Lazy compilation of a JIT function failed";
+}
+
+// Returns the functions compiled when the functions of `requested` are first
+// called: the requested functions and all functions transitively called by
+// them, stopping at functions which start compile units of their own.
+std::optional<llvm::orc::CompileOnDemandLayer::GlobalValueSet>
+PartitionByCompileUnit(
+    llvm::orc::CompileOnDemandLayer::GlobalValueSet requested) {
+  llvm::orc::CompileOnDemandLayer::GlobalValueSet partition = requested;
+  std::vector<const llvm::Function*> worklist;
+  for (const llvm::GlobalValue* value : requested) {
+    if (const auto* function = llvm::dyn_cast<llvm::Function>(value)) {
+      worklist.push_back(function);
+    }
+  }
+  while (!worklist.empty()) {
+    const llvm::Function* function = worklist.back();
+    worklist.pop_back();
+    for (const llvm::BasicBlock& basic_block : *function) {
+      for (const llvm::Instruction& inst : basic_block) {
+        const auto* call = llvm::dyn_cast<llvm::CallBase>(&inst);
+        if (call == nullptr) {
+          continue;
+        }
+        const llvm::Function* callee = call->getCalledFunction();
+        if (callee == nullptr || callee->isDeclaration() ||
+            callee->hasFnAttribute(OrcJit::kCompileUnitAttribute)) {
+          continue;
+        }
+        if (partition.insert(callee).second) {
+          worklist.push_back(callee);
+        }
+      }
+    }
+  }
+  return partition;
+}
+
+}  // namespace
+
+bool OrcJit::UseLazyCompilation() const {
+  return lazy_compilation_ && !emit_object_code_ &&
+         !ObserverRequiresCompilation();
+}
+
+absl::Status OrcJit::CompileModuleLazily(
+    std::unique_ptr<llvm::Module>&& module) {
+  if (compile_on_demand_layer_ == nullptr) {
+    const llvm::Triple& triple = target_machine_->getTargetTriple();
+    llvm::Expected<std::unique_ptr<llvm::orc::LazyCallThroughManager>>
+        call_through_manager = llvm::orc::createLocalLazyCallThroughManager(
+            triple, execution_session_,
+            llvm::orc::ExecutorAddr::fromPtr(&LazyCompilationFailed));
+    if (!call_through_manager) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "Lazy compilation is not supported on %s: %s", triple.str(),
+          llvm::toString(call_through_manager.takeError())));
+    }
+    lazy_call_through_manager_ = std::move(*call_through_manager);
+    compile_on_demand_layer_ =
+        std::make_unique<llvm::orc::CompileOnDemandLayer>(
+            execution_session_, *transform_layer_, *lazy_call_through_manager_,
+            llvm::orc::createLocalIndirectStubsManagerBuilder(triple));
+    compile_on_demand_layer_->setPartitionFunction(PartitionByCompileUnit);
+  }
+  llvm::Error error = compile_on_demand_layer_->add(
+      dylib_, llvm::orc::ThreadSafeModule(std::move(module), context_));
+  if (error) {
+    return absl::UnknownError(absl::StrFormat(
+        "Error compiling converted IR: %s", llvm::toString(std::move(error))));
+  }
+  return absl::OkStatus();
+}
+
+int64_t OrcJit::GetCompilePartCount(const llvm::Module& module) const {
+  // Object code is only produced (and cached) for whole modules and observers
+  // expect to see the whole module.
+  if (compile_thread_count_ <= 1 || emit_object_code_ ||
+      object_cache_ != nullptr || ObserverRequiresCompilation()) {
+    return 1;
+  }
+  int64_t instruction_count = 0;
+  for (const llvm::Function& function : module.functions()) {
+    instruction_count += function.getInstructionCount();
+  }
+  return std::clamp(instruction_count / kMinInstructionsPerCompilePart,
+                    int64_t{1}, compile_thread_count_);
+}
+
+absl::StatusOr<std::unique_ptr<llvm::MemoryBuffer>> OrcJit::CompileModulePart(
+    std::string_view bitcode, std::string_view name) const {
+  llvm::LLVMContext context;
+  llvm::Expected<std::unique_ptr<llvm::Module>> module = llvm::parseBitcodeFile(
+      llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()),
+                            llvm::StringRef(name.data(), name.size())),
+      context);
+  if (!module) {
+    return absl::InternalError(
+        absl::StrFormat("Unable to parse module part `%s`: %s", name,
+                        llvm::toString(module.takeError())));
+  }
+  // Target machines may not be shared between threads.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<llvm::TargetMachine> target_machine,
+                       CreateTargetMachine(/*aot_specification=*/false));
+  ConfigureTargetMachine(pipeline_, *target_machine);
+  if (llvm::Error error =
+          OptimizeModule(**module, opt_level_, pipeline_, include_msan_,
+                         target_machine.get())) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unable to optimize module part `%s`: %s", name,
+                        llvm::toString(std::move(error))));
+  }
+  VLOG(2) << "Optimized module IR of " << name << ":";
+  XLS_VLOG_LINES(2, DumpLlvmModuleToString(module->get()));
+
+  llvm::SmallVector<char, 0> object;
+  llvm::raw_svector_ostream ostream(object);
+  llvm::legacy::PassManager mpm;
+  if (target_machine->addPassesToEmitFile(mpm, ostream, nullptr,
+                                          llvm::CodeGenFileType::ObjectFile)) {
+    return absl::InternalError("Unable to create object code emission pass");
+  }
+  mpm.run(**module);
+  return llvm::MemoryBuffer::getMemBufferCopy(
+      llvm::StringRef(object.data(), object.size()),
+      llvm::StringRef(name.data(), name.size()));
+}
+
+absl::Status OrcJit::CompileModuleInParts(llvm::Module& module,
+                                          int64_t part_count) {
+  VLOG(2) << "Unoptimized module IR:";
+  XLS_VLOG_LINES(2, DumpLlvmModuleToString(&module));
+
+  // LLVM contexts are not thread safe, so each part is serialized to bitcode
+  // and parsed into a context of its own on the thread which compiles it.
+  // Locals are preserved so that symbols of different modules compiled into
+  // the same dylib cannot collide.
+  std::vector<std::string> parts;
+  llvm::SplitModule(
+      module, part_count,
+      [&](std::unique_ptr<llvm::Module> part) {
+        std::string bitcode;
+        llvm::raw_string_ostream ostream(bitcode);
+        llvm::WriteBitcodeToFile(*part, ostream);
+        ostream.flush();
+        parts.push_back(std::move(bitcode));
+      },
+      /*PreserveLocals=*/true);
+  VLOG(1) << absl::StreamFormat("Compiling module `%s` in %d parts",
+                                module.getModuleIdentifier(), parts.size());
+
+  std::vector<absl::StatusOr<std::unique_ptr<llvm::MemoryBuffer>>> objects(
+      parts.size());
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(parts.size());
+    for (int64_t i = 0; i < parts.size(); ++i) {
+      std::string name =
+          absl::StrFormat("%s.part%d", module.getModuleIdentifier(), i);
+      threads.push_back(std::make_unique<Thread>(
+          [this, &parts, &objects, i, name = std::move(name)]() {
+            objects[i] = CompileModulePart(parts[i], name);
+          }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+
+  for (absl::StatusOr<std::unique_ptr<llvm::MemoryBuffer>>& object : objects) {
+    XLS_RETURN_IF_ERROR(object.status());
+    llvm::Error error = object_layer_.add(dylib_, *std::move(object));
+    if (error) {
+      return absl::UnknownError(absl::StrFormat(
+          "Error loading compiled module part: %s",
+          llvm::toString(std::move(error))));
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<llvm::orc::ExecutorAddr> OrcJit::LoadSymbol(
     std::string_view function_name) {
 #ifdef __APPLE__
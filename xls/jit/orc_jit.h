@@ -15,6 +15,7 @@
 #ifndef XLS_JIT_ORC_JIT_H_
 #define XLS_JIT_ORC_JIT_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -22,22 +23,69 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/flags/declare.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/include/llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRCompileLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRTransformLayer.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/LazyReexports.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Shared/ExecutorAddress.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
 #include "llvm/include/llvm/Support/Error.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "llvm/include/llvm/Target/TargetMachine.h"
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/observer.h"
 
+ABSL_DECLARE_FLAG(int64_t, jit_compile_threads);
+ABSL_DECLARE_FLAG(std::string, jit_pipeline);
+ABSL_DECLARE_FLAG(bool, jit_lazy_compilation);
+
 namespace xls {
 
+// The LLVM pipeline used by the JIT to optimize and generate code.
+enum class JitPipeline : uint8_t {
+  // The pipeline given by --jit_pipeline.
+  kDefault,
+  // The IR optimization pipeline of the opt level followed by the default code
+  // generator.
+  kStandard,
+  // No IR optimization and fast instruction selection without code generator
+  // optimizations. Compiles quickly but produces slow code, which suits short
+  // runs such as tests.
+  kQuick,
+  // The O3 IR pipeline tuned for the host CPU with loop and SLP vectorization
+  // enabled followed by aggressive code generation. Compiles slowly but
+  // produces the fastest code for long runs.
+  kThroughput,
+};
+
+// Parses the name of a pipeline: "standard", "quick" or "throughput".
+absl::StatusOr<JitPipeline> JitPipelineFromString(std::string_view name);
+std::string JitPipelineToString(JitPipeline pipeline);
+
+// Options controlling how the JIT compiles code.
+struct JitOptions {
+  // The LLVM IR optimization level (0 to 3) of the standard pipeline. The
+  // other pipelines use fixed levels.
+  int64_t opt_level = 3;
+  JitPipeline pipeline = JitPipeline::kDefault;
+  // Whether jits which compile everything up front release the LLVM context
+  // holding the IR-level state of their modules once compilation is done.
+  // Long-running users holding many jits should set this to save memory.
+  bool release_llvm_context = false;
+};
+
 // A wrapper around ORC JIT which hides some of the internals of the LLVM
 // interface.
 class OrcJit {
@@ -52,7 +100,15 @@ class OrcJit {
   static absl::StatusOr<std::unique_ptr<OrcJit>> Create(
       int64_t opt_level = kDefaultOptLevel, bool emit_object_code = false,
       JitObserver* observer = nullptr) {
-    return Create(opt_level, emit_object_code, std::nullopt, observer);
+    return Create(JitOptions{.opt_level = opt_level}, emit_object_code,
+                  std::nullopt, observer);
+  }
+
+  // As above with the compilation given by `options`.
+  static absl::StatusOr<std::unique_ptr<OrcJit>> Create(
+      const JitOptions& options, bool emit_object_code = false,
+      JitObserver* observer = nullptr) {
+    return Create(options, emit_object_code, std::nullopt, observer);
   }
 
   // Create an LLVM orc jit. This can be used by the AOT generator to manually
@@ -60,22 +116,69 @@ class OrcJit {
   // compiler should use the 3-argument version above. Passing nullopt to
   // emit_msan directs the jit to use MSAN if the running binary is MSAN and
   // vice-versa.
+  static absl::StatusOr<std::unique_ptr<OrcJit>> Create(
+      const JitOptions& options, bool emit_object_code,
+      std::optional<bool> emit_msan, JitObserver* observer = nullptr);
   static absl::StatusOr<std::unique_ptr<OrcJit>> Create(
       int64_t opt_level, bool emit_object_code, std::optional<bool> emit_msan,
-      JitObserver* observer = nullptr);
+      JitObserver* observer = nullptr) {
+    return Create(JitOptions{.opt_level = opt_level}, emit_object_code,
+                  emit_msan, observer);
+  }
 
   void SetJitObserver(JitObserver* o) { jit_observer_ = o; }
 
+  // Sets the persistent cache of object code consulted by `CompileModule`. By
+  // default this is the cache given by --jit_object_cache_dir (if any) unless
+  // `emit_object_code` is true. Passing nullptr disables caching.
+  void SetObjectCache(JitObjectCache* cache) { object_cache_ = cache; }
+
+  JitObjectCache* object_cache() const { return object_cache_; }
+
+  // Sets the maximum number of threads used to optimize and compile a module
+  // in `CompileModule`. Modules with at least kMinInstructionsPerCompilePart
+  // instructions per thread are split into parts which are compiled
+  // concurrently, each in its own LLVM context. Splitting is not done when
+  // object code is emitted or cached, or when the observer requires the whole
+  // module. By default this is given by --jit_compile_threads.
+  void SetCompileThreadCount(int64_t count) { compile_thread_count_ = count; }
+  int64_t compile_thread_count() const { return compile_thread_count_; }
+
+  // The minimum size of a part of a module compiled on its own thread, in
+  // unoptimized LLVM instructions.
+  static constexpr int64_t kMinInstructionsPerCompilePart = 4096;
+
+  // Sets whether `CompileModule` defers compilation of each function until it
+  // is first called. Lazily compiled modules are partitioned into compile
+  // units: each function carrying the kCompileUnitAttribute attribute together
+  // with all functions it calls which do not carry the attribute. Calls across
+  // units go through stubs which compile the callee on first call, so units
+  // are optimized separately and are not inlined into each other. Lazy
+  // compilation is not done when object code is emitted or when the observer
+  // requires the whole module, and lazily compiled modules bypass the object
+  // cache. By default this is given by --jit_lazy_compilation.
+  void SetLazyCompilation(bool lazy) { lazy_compilation_ = lazy; }
+  bool lazy_compilation() const { return lazy_compilation_; }
+
+  // The LLVM function attribute which marks the first function of a compile
+  // unit for lazy compilation.
+  static constexpr std::string_view kCompileUnitAttribute = "xls-compile-unit";
+
   std::string target_triple() const {
     return this->target_machine_->getTargetTriple().getTriple();
   }
 
   JitObserver* jit_observer() const { return jit_observer_; }
 
+  JitPipeline pipeline() const { return pipeline_; }
+
   // Creates and returns a new LLVM module of the given name.
   std::unique_ptr<llvm::Module> NewModule(std::string_view name);
 
-  // Compiles the given LLVM module into the JIT's execution session.
+  // Compiles the given LLVM module into the JIT's execution session. If an
+  // object cache is set and contains object code for an identical module
+  // compiled with the same options, the cached object code is used and the
+  // optimization and code generation pipeline is skipped.
   absl::Status CompileModule(std::unique_ptr<llvm::Module>&& module);
 
   // Returns the address of the given JIT'ed function.
@@ -85,6 +188,19 @@ class OrcJit {
   // Return the underlying LLVM context.
   llvm::LLVMContext* GetContext() { return context_.getContext(); }
 
+  // Replaces the LLVM context in which modules are created with a new one.
+  // The old context, which holds every type and constant created for the
+  // modules compiled so far, is freed once no module awaiting compilation
+  // refers to it. Must not be called while a module created by `NewModule` is
+  // being built.
+  void ReleaseLlvmContext();
+
+  // Returns the memory allocated so far for object code linked into the JIT.
+  JitMemoryUsage GetMemoryUsage() const {
+    return JitMemoryUsage{.code_bytes = code_bytes_.load(),
+                          .data_bytes = data_bytes_.load()};
+  }
+
   // Returns the object code which was created in the previous CompileModule
   // call (if `emit_object_code` is true).
   const std::vector<uint8_t>& GetObjectCode() { return object_code_; }
@@ -99,7 +215,8 @@ class OrcJit {
   bool emit_object_code() const { return emit_object_code_; }
 
  private:
-  OrcJit(int64_t opt_level, bool emit_object_code, bool include_msan);
+  OrcJit(int64_t opt_level, JitPipeline pipeline, bool emit_object_code,
+         bool include_msan);
   absl::Status Init();
 
   // Method which optimizes the given module. Used within the JIT to form an IR
@@ -108,12 +225,64 @@ class OrcJit {
       llvm::orc::ThreadSafeModule module,
       const llvm::orc::MaterializationResponsibility& responsibility);
 
+  // Returns the key under which the object code of `module` is stored in the
+  // object cache. The key covers the unoptimized module and all options which
+  // affect code generation.
+  std::string GetObjectCacheKey(const llvm::Module& module) const;
+
+  // Whether the observer requires notifications which are only produced when
+  // the module is actually optimized and compiled.
+  bool ObserverRequiresCompilation() const;
+
+  // Whether `CompileModule` should compile lazily.
+  bool UseLazyCompilation() const;
+
+  // Adds `module` to the dylib through the compile-on-demand layer, creating
+  // the layer if this is the first lazily compiled module.
+  absl::Status CompileModuleLazily(std::unique_ptr<llvm::Module>&& module);
+
+  // Returns the number of parts `module` should be split into for concurrent
+  // compilation.
+  int64_t GetCompilePartCount(const llvm::Module& module) const;
+
+  // Splits `module` into `part_count` parts which are optimized and compiled
+  // concurrently and adds the resulting object code to the dylib.
+  absl::Status CompileModuleInParts(llvm::Module& module, int64_t part_count);
+
+  // Parses, optimizes and compiles a module part serialized as `bitcode` in a
+  // new LLVM context. Safe to call concurrently.
+  absl::StatusOr<std::unique_ptr<llvm::MemoryBuffer>> CompileModulePart(
+      std::string_view bitcode, std::string_view name) const;
+
+  // Adapter which receives the object code produced by the compile layer and
+  // stores it in the object cache.
+  class ObjectCacheWriter : public llvm::ObjectCache {
+   public:
+    explicit ObjectCacheWriter(OrcJit* jit) : jit_(jit) {}
+
+    void notifyObjectCompiled(const llvm::Module* module,
+                              llvm::MemoryBufferRef object) override;
+    std::unique_ptr<llvm::MemoryBuffer> getObject(
+        const llvm::Module* module) override {
+      // Lookups are done in CompileModule before optimization.
+      return nullptr;
+    }
+
+   private:
+    OrcJit* jit_;
+  };
+
+  // Updated by the memory managers of the object layer, so declared first.
+  std::atomic<int64_t> code_bytes_ = 0;
+  std::atomic<int64_t> data_bytes_ = 0;
+
   llvm::orc::ThreadSafeContext context_;
   llvm::orc::ExecutionSession execution_session_;
   llvm::orc::RTDyldObjectLinkingLayer object_layer_;
   llvm::orc::JITDylib& dylib_;
 
   int64_t opt_level_;
+  JitPipeline pipeline_;
   bool emit_object_code_;
 
   std::unique_ptr<llvm::TargetMachine> target_machine_;
@@ -123,6 +292,9 @@ class OrcJit {
   std::unique_ptr<llvm::orc::IRTransformLayer> transform_layer_;
   // If set, this contains the logic to emit object code.
   std::unique_ptr<llvm::orc::IRTransformLayer> object_code_layer_;
+  // Created on the first lazily compiled module.
+  std::unique_ptr<llvm::orc::LazyCallThroughManager> lazy_call_through_manager_;
+  std::unique_ptr<llvm::orc::CompileOnDemandLayer> compile_on_demand_layer_;
 
   // When `CompileModule` is called and `emit_object_code` is true, this vector
   // will be allocated and filled with the object code of the compiled module.
@@ -130,6 +302,16 @@ class OrcJit {
 
   JitObserver* jit_observer_ = nullptr;
 
+  JitObjectCache* object_cache_ = nullptr;
+  int64_t compile_thread_count_ = 1;
+  bool lazy_compilation_ = false;
+  std::unique_ptr<ObjectCacheWriter> object_cache_writer_;
+  // Cache keys of modules which missed in the object cache and are awaiting
+  // compilation. Compilation may happen on any thread executing a lookup.
+  absl::Mutex pending_cache_keys_mutex_;
+  absl::flat_hash_map<const llvm::Module*, std::string> pending_cache_keys_
+      ABSL_GUARDED_BY(pending_cache_keys_mutex_);
+
   // If the jitted code should include msan calls. Defaults to whatever 'this'
   // process is doing and should only be overridden for AOT generators.
   bool include_msan_;
@@ -15,7 +15,6 @@
 #include "xls/jit/proc_jit.h"
 
 #include <cstdint>
-#include <cstring>
 #include <memory>
 #include <optional>
 #include <string>
@@ -176,17 +175,9 @@ absl::Status ProcJitContinuation::NextTick() {
                              absl::StrAppend(out, value.ToString());
                            });
 
-  if (!proc()->next_values().empty()) {
-    // New-style state param evaluation; initialize the output state params to
-    // be unchanged by default.
-    for (int64_t state_index = 0; state_index < proc()->GetStateElementCount();
-         ++state_index) {
-      int64_t param_index = state_index + 1;
-      memcpy(output_.pointers()[param_index], input_.pointers()[param_index],
-             jit_runtime_->GetTypeByteSize(
-                 proc()->GetStateElementType(state_index)));
-    }
-  }
+  // With next_value nodes the output state buffers need not be initialized
+  // here: the jitted code copies each state param into its output buffer
+  // before any next_value (or in-place update) of that param is evaluated.
   return absl::OkStatus();
 }
 
@@ -217,22 +208,36 @@ absl::StatusOr<std::unique_ptr<ProcJit>> ProcJit::Create(
   XLS_ASSIGN_OR_RETURN(jit->jitted_function_base_,
                        JittedFunctionBase::Build(proc, jit->GetOrcJit()));
   XLS_RET_CHECK(jit->jitted_function_base_.InputsAndOutputsAreEquivalent());
+  XLS_RETURN_IF_ERROR(jit->InitializeChannelQueues());
+  return jit;
+}
+
+absl::StatusOr<std::unique_ptr<ProcJit>> ProcJit::CreateFromAot(
+    Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
+    JittedFunctionBase jitted_function_base) {
+  auto jit = absl::WrapUnique(new ProcJit(proc, jit_runtime, queue_mgr,
+                                          /*orc_jit=*/nullptr));
+  jit->jitted_function_base_ = std::move(jitted_function_base);
+  XLS_RET_CHECK(jit->jitted_function_base_.InputsAndOutputsAreEquivalent());
+  XLS_RETURN_IF_ERROR(jit->InitializeChannelQueues());
+  return jit;
+}
 
+absl::Status ProcJit::InitializeChannelQueues() {
   for (ProcInstance* proc_instance :
-       queue_mgr->elaboration().GetInstances(proc)) {
-    jit->channel_queues_[proc_instance].resize(
-        jit->jitted_function_base_.queue_indices().size());
+       queue_mgr_->elaboration().GetInstances(proc())) {
+    channel_queues_[proc_instance].resize(
+        jitted_function_base_.queue_indices().size());
     for (const auto& [channel_name, index] :
-         jit->jitted_function_base_.queue_indices()) {
+         jitted_function_base_.queue_indices()) {
       XLS_ASSIGN_OR_RETURN(
           ChannelInstance * channel_instance,
-          GetChannelInstance(proc_instance, channel_name, queue_mgr));
-      jit->channel_queues_[proc_instance][index] =
-          &queue_mgr->GetJitQueue(channel_instance);
+          GetChannelInstance(proc_instance, channel_name, queue_mgr_));
+      channel_queues_[proc_instance][index] =
+          &queue_mgr_->GetJitQueue(channel_instance);
     }
   }
-
-  return jit;
+  return absl::OkStatus();
 }
 
 std::unique_ptr<ProcContinuation> ProcJit::NewContinuation(
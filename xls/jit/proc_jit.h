@@ -47,6 +47,13 @@ class ProcJit : public ProcEvaluator {
       Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
       JitObserver* observer = nullptr);
 
+  // Returns an object which executes the specified proc using the given
+  // ahead-of-time compiled code (see JittedFunctionBase::BuildFromAot). No
+  // code is compiled.
+  static absl::StatusOr<std::unique_ptr<ProcJit>> CreateFromAot(
+      Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
+      JittedFunctionBase jitted_function_base);
+
   ~ProcJit() override = default;
 
   std::unique_ptr<ProcContinuation> NewContinuation(
@@ -56,6 +63,8 @@ class ProcJit : public ProcEvaluator {
 
   JitRuntime* runtime() const { return jit_runtime_; }
 
+  // Returns the OrcJit used to compile the proc. Must not be called on a
+  // ProcJit created from ahead-of-time compiled code.
   OrcJit& GetOrcJit() { return *orc_jit_; }
 
  private:
@@ -67,8 +76,12 @@ class ProcJit : public ProcEvaluator {
         queue_mgr_(queue_mgr),
         orc_jit_(std::move(orc_jit)) {}
 
+  // Resolves the channel queues of each instance of the proc.
+  absl::Status InitializeChannelQueues();
+
   JitRuntime* jit_runtime_;
   JitChannelQueueManager* queue_mgr_;
+  // Null if the proc is ahead-of-time compiled.
   std::unique_ptr<OrcJit> orc_jit_;
   JittedFunctionBase jitted_function_base_;
 
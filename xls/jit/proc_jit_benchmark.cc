@@ -0,0 +1,92 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Measures the tick rate of procs with wide array state. Each iteration
+// overwrites a single element of the state either in place (the array update
+// is the sole next value of the state element) or via a whole-array select
+// which forces the next state to be materialized separately.
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/proc_jit.h"
+
+namespace xls {
+namespace {
+
+// Builds a proc with a `size`-element u32 array state which writes element
+// `counter % size` each tick. If `in_place` is false the updated array is
+// passed through a select so that it is not eligible for in-place update.
+absl::StatusOr<Proc*> BuildWideStateProc(Package* package, int64_t size,
+                                         bool in_place) {
+  ProcBuilder pb("wide_state", /*token_name=*/"tok", package);
+  BValue counter = pb.StateElement("counter", Value(UBits(0, 32)));
+  BValue mem = pb.StateElement(
+      "mem", Value::UBitsArray(std::vector<uint64_t>(size, 0), 32).value());
+  BValue index = pb.UMod(counter, pb.Literal(UBits(size, 32)));
+  BValue element = pb.ArrayIndex(mem, {index});
+  BValue update = pb.ArrayUpdate(
+      mem, pb.Add(element, pb.Literal(UBits(1, 32))), {index});
+  pb.Next(counter, pb.Add(counter, pb.Literal(UBits(1, 32))));
+  if (in_place) {
+    pb.Next(mem, update);
+  } else {
+    BValue wrapped = pb.Eq(counter, pb.Literal(UBits(0xffffffff, 32)));
+    pb.Next(mem, pb.Select(wrapped, {update, mem}));
+  }
+  return pb.Build(pb.GetTokenParam());
+}
+
+void BM_WideStateTick(benchmark::State& state, bool in_place) {
+  Package package("wide_state");
+  Proc* proc = BuildWideStateProc(&package, state.range(0), in_place).value();
+  JitRuntime jit_runtime(
+      OrcJit::CreateDataLayout(/*aot_specification=*/false).value());
+  std::unique_ptr<JitChannelQueueManager> queue_manager =
+      JitChannelQueueManager::CreateThreadSafe(&package).value();
+  std::unique_ptr<ProcJit> jit =
+      ProcJit::Create(proc, &jit_runtime, queue_manager.get()).value();
+  std::unique_ptr<ProcContinuation> continuation = jit->NewContinuation(
+      queue_manager->elaboration().GetUniqueInstance(proc).value());
+  for (auto _ : state) {
+    absl::StatusOr<TickResult> result = jit->Tick(*continuation);
+    CHECK_OK(result.status());
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["ticks_per_s"] =
+      benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_CAPTURE(BM_WideStateTick, in_place, /*in_place=*/true)
+    ->Range(256, 1 << 16);
+BENCHMARK_CAPTURE(BM_WideStateTick, whole_array, /*in_place=*/false)
+    ->Range(256, 1 << 16);
+
+}  // namespace
+}  // namespace xls
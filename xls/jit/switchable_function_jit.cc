@@ -14,6 +14,7 @@
 
 #include "xls/jit/switchable_function_jit.h"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -26,6 +27,7 @@
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
@@ -63,6 +65,30 @@ SwitchableFunctionJit::CreateInterpreter(Function* xls_function) {
       new SwitchableFunctionJit(xls_function, /*use_jit=*/false, nullptr));
 }
 
+absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
+SwitchableFunctionJit::CreateTiered(Function* xls_function, int64_t opt_level,
+                                    JitObserver* observer) {
+  auto tiered = std::unique_ptr<SwitchableFunctionJit>(
+      new SwitchableFunctionJit(xls_function, /*use_jit=*/false, nullptr));
+  SwitchableFunctionJit* raw = tiered.get();
+  tiered->compile_thread_ =
+      std::make_unique<Thread>([raw, opt_level, observer]() {
+        absl::StatusOr<std::unique_ptr<FunctionJit>> jit =
+            FunctionJit::Create(raw->xls_function_, opt_level, observer);
+        if (!jit.ok()) {
+          LOG(WARNING) << "Unable to JIT function `"
+                       << raw->xls_function_->name()
+                       << "`, continuing with the interpreter: "
+                       << jit.status();
+          raw->compile_status_ = jit.status();
+          return;
+        }
+        raw->function_jit_ = *std::move(jit);
+        raw->use_jit_.store(true, std::memory_order_release);
+      });
+  return tiered;
+}
+
 absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
 SwitchableFunctionJit::Create(Function* xls_function, ExecutionType execution,
                               int64_t opt_level, JitObserver* observer) {
@@ -77,6 +103,9 @@ SwitchableFunctionJit::Create(Function* xls_function, ExecutionType execution,
     case ExecutionType::kJit:
       return SwitchableFunctionJit::CreateJit(xls_function, opt_level,
                                               observer);
+    case ExecutionType::kTiered:
+      return SwitchableFunctionJit::CreateTiered(xls_function, opt_level,
+                                                 observer);
     case ExecutionType::kDefault:
       LOG(FATAL) << "Unreachable";
   }
@@ -127,9 +156,17 @@ absl::StatusOr<InterpreterResult<Value>> Interpret(
 }
 }  // namespace
 
+absl::Status SwitchableFunctionJit::WaitForJit() {
+  if (compile_thread_ != nullptr) {
+    compile_thread_->Join();
+    compile_thread_.reset();
+  }
+  return compile_status_;
+}
+
 absl::StatusOr<InterpreterResult<Value>> SwitchableFunctionJit::Run(
     absl::Span<const Value> args) {
-  if (use_jit_) {
+  if (use_jit_.load(std::memory_order_acquire)) {
     return function_jit_->Run(args);
   }
   XLS_ASSIGN_OR_RETURN(auto node_args, ToValueMap(args, function()));
@@ -138,7 +175,7 @@ absl::StatusOr<InterpreterResult<Value>> SwitchableFunctionJit::Run(
 
 absl::StatusOr<InterpreterResult<Value>> SwitchableFunctionJit::Run(
     const absl::flat_hash_map<std::string, Value>& kwargs) {
-  if (use_jit_) {
+  if (use_jit_.load(std::memory_order_acquire)) {
     return function_jit_->Run(kwargs);
   }
   XLS_ASSIGN_OR_RETURN(auto node_args, ToValueMap(kwargs, function()));
@@ -15,6 +15,7 @@
 #ifndef XLS_JIT_SWITCHABLE_FUNCTION_JIT_H_
 #define XLS_JIT_SWITCHABLE_FUNCTION_JIT_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -26,6 +27,7 @@
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/thread.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/value.h"
@@ -38,6 +40,9 @@ enum class ExecutionType {
   kDefault,
   kJit,
   kInterpreter,
+  // Interpret the function while it is compiled on a background thread and
+  // switch to the JIT once compilation completes.
+  kTiered,
 };
 
 // A wrapper for the jit structures that can be turned off at build time if
@@ -53,6 +58,13 @@ class SwitchableFunctionJit {
       JitObserver* observer = nullptr);
   static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
   CreateInterpreter(Function* xls_function);
+  // Returns an object which interprets the function until a host-compiled
+  // version built on a background thread is ready. If compilation fails the
+  // interpreter continues to be used. The function must not be modified while
+  // the object exists and `observer` is called from the background thread.
+  static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>> CreateTiered(
+      Function* xls_function, int64_t opt_level = 3,
+      JitObserver* observer = nullptr);
   static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>> Create(
       Function* xls_function, ExecutionType execution = ExecutionType::kDefault,
       int64_t opt_level = 3, JitObserver* observer = nullptr);
@@ -70,12 +82,16 @@ class SwitchableFunctionJit {
   Function* function() { return xls_function_; }
 
   std::optional<FunctionJit*> function_jit() {
-    if (use_jit_) {
+    if (use_jit_.load(std::memory_order_acquire)) {
       return function_jit_.get();
     }
     return std::nullopt;
   }
 
+  // Blocks until the background compilation of a tiered object completes and
+  // returns its status. Returns OK immediately for other execution types.
+  absl::Status WaitForJit();
+
  private:
   explicit SwitchableFunctionJit(Function* xls_function, bool use_jit,
                                  std::unique_ptr<FunctionJit>&& jit)
@@ -84,8 +100,15 @@ class SwitchableFunctionJit {
         function_jit_(std::move(jit)) {}
 
   Function* xls_function_;
-  bool use_jit_;
+  // Whether to run `function_jit_`. In tiered mode this is set by the compile
+  // thread after it has written `function_jit_`.
+  std::atomic<bool> use_jit_;
   std::unique_ptr<FunctionJit> function_jit_;
+  // The status of the background compilation, written by the compile thread.
+  absl::Status compile_status_;
+  // Declared last so that the compile thread is joined before the members it
+  // writes are destroyed.
+  std::unique_ptr<Thread> compile_thread_;
 };
 }  // namespace xls
 
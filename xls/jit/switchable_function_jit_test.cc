@@ -79,5 +79,28 @@ TEST_F(SwitchableFunctionJitTest, CanExecuteDefault) {
             Value::Tuple({Value(UBits(12, 8)), Value(UBits(32, 8))}));
 }
 
+TEST_F(SwitchableFunctionJitTest, CanExecuteTiered) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(auto f, TestFunction(p.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto runner, SwitchableFunctionJit::Create(f, ExecutionType::kTiered));
+  // The first run may use either the interpreter or the JIT depending on how
+  // quickly compilation completes.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto result,
+      runner->Run(std::vector<Value>{Value(UBits(8, 8)), Value(UBits(4, 8))}));
+  EXPECT_EQ(result.value,
+            Value::Tuple({Value(UBits(12, 8)), Value(UBits(32, 8))}));
+
+  XLS_ASSERT_OK(runner->WaitForJit());
+  EXPECT_TRUE(runner->function_jit().has_value());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      result,
+      runner->Run(std::vector<Value>{Value(UBits(3, 8)), Value(UBits(5, 8))}));
+  EXPECT_EQ(result.value,
+            Value::Tuple({Value(UBits(8, 8)), Value(UBits(15, 8))}));
+}
+
 }  // namespace
 }  // namespace xls
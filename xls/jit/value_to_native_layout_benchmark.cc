@@ -18,10 +18,13 @@
 #include <vector>
 
 #include "include/benchmark/benchmark.h"
+#include "absl/log/check.h"
+#include "absl/types/span.h"
 #include "xls/interpreter/random_value.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
+#include "xls/jit/jit_runtime.h"
 #include "xls/jit/llvm_type_converter.h"
 #include "xls/jit/orc_jit.h"
 #include "xls/jit/type_layout.h"
@@ -75,8 +78,44 @@ static void BM_NativeLayoutToValue(benchmark::State& state) {
   }
 }
 
+// Bulk conversions through the JitRuntime, which caches the type layout.
+constexpr int64_t kBulkValueCount = 256;
+
+static void BM_ValuesToNativeLayoutBulk(benchmark::State& state) {
+  Package package("BM");
+  Type* type = Parser::ParseType(kValueTypes[state.range(0)], &package).value();
+  std::minstd_rand bitgen;
+  std::vector<Value> values;
+  for (int64_t i = 0; i < kBulkValueCount; ++i) {
+    values.push_back(RandomValue(type, bitgen));
+  }
+  std::unique_ptr<JitRuntime> runtime = JitRuntime::Create().value();
+  std::vector<uint8_t> buffer(kBulkValueCount *
+                              runtime->GetTypeByteSize(type));
+  for (auto _ : state) {
+    CHECK_OK(
+        runtime->ValuesToNativeLayout(values, type, absl::MakeSpan(buffer)));
+  }
+  state.SetItemsProcessed(state.iterations() * kBulkValueCount);
+}
+
+static void BM_NativeLayoutToValuesBulk(benchmark::State& state) {
+  Package package("BM");
+  Type* type = Parser::ParseType(kValueTypes[state.range(0)], &package).value();
+  std::unique_ptr<JitRuntime> runtime = JitRuntime::Create().value();
+  std::vector<uint8_t> buffer(
+      kBulkValueCount * runtime->GetTypeByteSize(type), 0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        runtime->NativeLayoutToValues(buffer, type, kBulkValueCount));
+  }
+  state.SetItemsProcessed(state.iterations() * kBulkValueCount);
+}
+
 BENCHMARK(BM_ValueToNativeLayout)->DenseRange(0, kNumTypes - 1);
 BENCHMARK(BM_NativeLayoutToValue)->DenseRange(0, kNumTypes - 1);
+BENCHMARK(BM_ValuesToNativeLayoutBulk)->DenseRange(0, kNumTypes - 1);
+BENCHMARK(BM_NativeLayoutToValuesBulk)->DenseRange(0, kNumTypes - 1);
 
 }  // namespace
 }  // namespace xls
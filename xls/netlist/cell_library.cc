@@ -15,11 +15,15 @@
 #include "xls/netlist/cell_library.h"
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
+#include <limits>
 #include <string>
+#include <string_view>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "xls/common/file/mapped_file.h"
 #include "google/protobuf/repeated_field.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -28,6 +32,24 @@
 namespace xls {
 namespace netlist {
 
+absl::StatusOr<CellLibraryProto> ReadCellLibraryProto(
+    const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(MappedFile file, MappedFile::Open(path));
+  std::string_view contents = file.contents();
+  if (contents.size() > std::numeric_limits<int>::max()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Cell library proto %s is too large: %d bytes", path.string(),
+        contents.size()));
+  }
+  CellLibraryProto proto;
+  if (!proto.ParseFromArray(contents.data(),
+                            static_cast<int>(contents.size()))) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Could not parse cell library proto: %s", path.string()));
+  }
+  return proto;
+}
+
 absl::StatusOr<CellKind> CellKindFromProto(CellKindProto proto) {
   switch (proto) {
     case FLOP:
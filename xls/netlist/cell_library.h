@@ -15,6 +15,8 @@
 #ifndef XLS_NETLIST_CELL_LIBRARY_H_
 #define XLS_NETLIST_CELL_LIBRARY_H_
 
+#include <cstdint>
+#include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
@@ -200,6 +202,20 @@ class AbstractCellLibraryEntry {
   }
   std::optional<std::string> clock_name() const { return clock_name_; }
 
+  // Returns the precomputed truth table of the function of the given output
+  // pin, if any. Bit `m` of the table is the value of the pin when input
+  // `input_names()[i]` has the value of bit `i` of `m`.
+  std::optional<uint64_t> GetTruthTable(std::string_view pin_name) const {
+    auto it = output_pin_to_truth_table_.find(pin_name);
+    if (it == output_pin_to_truth_table_.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+  void SetTruthTable(std::string_view pin_name, uint64_t truth_table) {
+    output_pin_to_truth_table_[pin_name] = truth_table;
+  }
+
   absl::StatusOr<CellLibraryEntryProto> ToProto() const;
 
  private:
@@ -207,6 +223,7 @@ class AbstractCellLibraryEntry {
   std::string name_;
   std::vector<std::string> input_names_;
   OutputPinToFunction output_pin_to_function_;
+  absl::flat_hash_map<std::string, uint64_t> output_pin_to_truth_table_;
   std::optional<AbstractStateTable<EvalT>> state_table_;
   std::optional<std::string> clock_name_;
 };
@@ -245,6 +262,13 @@ class AbstractCellLibrary {
 
 using CellLibrary = AbstractCellLibrary<>;
 
+// Reads a binary-serialized CellLibraryProto (as written by
+// function_extractor_main) from the file at `path`. The file is memory-mapped
+// and parsed in place, which is much faster than re-extracting the cell
+// functions from the original Liberty file.
+absl::StatusOr<CellLibraryProto> ReadCellLibraryProto(
+    const std::filesystem::path& path);
+
 absl::StatusOr<StateTableSignal> StateTableSignalFromProto(
     StateTableSignalProto proto);
 
@@ -498,8 +522,14 @@ AbstractCellLibraryEntry<EvalT>::FromProto(const CellLibraryEntryProto& proto,
                                           proto.state_table(), zero, one));
   }
 
-  return AbstractCellLibraryEntry(cell_kind, proto.name(), proto.input_names(),
-                                  pins, state_table);
+  AbstractCellLibraryEntry entry(cell_kind, proto.name(), proto.input_names(),
+                                 pins, state_table);
+  for (const auto& pin_proto : output_pin_list.pins()) {
+    if (pin_proto.has_truth_table()) {
+      entry.SetTruthTable(pin_proto.name(), pin_proto.truth_table());
+    }
+  }
+  return entry;
 }
 
 template <typename EvalT>
@@ -546,6 +576,9 @@ absl::StatusOr<CellLibraryEntryProto> AbstractCellLibraryEntry<EvalT>::ToProto()
     OutputPinProto* pin_proto = pin_list->add_pins();
     pin_proto->set_name(kv.first);
     pin_proto->set_function(kv.second);
+    if (std::optional<uint64_t> table = GetTruthTable(kv.first)) {
+      pin_proto->set_truth_table(*table);
+    }
   }
   return proto;
 }
@@ -58,6 +58,34 @@ TEST(CellLibraryTest, SerializeToProto) {
   EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(proto, expected_proto));
 }
 
+TEST(CellLibraryTest, TruthTableRoundTrip) {
+  CellLibraryProto proto;
+  ASSERT_TRUE(TextFormat::ParseFromString(R"pb(entries {
+  kind: NAND
+  name: "NAND"
+  input_names: "A"
+  input_names: "B"
+  output_pin_list {
+    pins {
+      name: "ZN"
+      function: "!(A&B)"
+      truth_table: 7
+    }
+  }
+})pb",
+                                          &proto));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library,
+                           CellLibrary::FromProto(proto));
+  XLS_ASSERT_OK_AND_ASSIGN(const CellLibraryEntry* entry,
+                           cell_library.GetEntry("NAND"));
+  EXPECT_EQ(entry->GetTruthTable("ZN"), 7);
+  EXPECT_FALSE(entry->GetTruthTable("Z").has_value());
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto round_trip, cell_library.ToProto());
+  EXPECT_TRUE(
+      google::protobuf::util::MessageDifferencer::Equals(proto, round_trip));
+}
+
 TEST(CellLibraryTest, EvaluateStateTable) {
   std::string proto_text = R"(input_names: "i0"
   input_names: "i1"
@@ -0,0 +1,683 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_interpreter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/function_parser.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+// Net indices of the constant nets. Every module's zero and one nets map to
+// these.
+constexpr int64_t kZeroNet = 0;
+constexpr int64_t kOneNet = 1;
+
+// Truth tables are held in a single word so they are limited to six inputs.
+constexpr int64_t kMaxTruthTableInputs = 6;
+
+// Limit on the depth of module instantiation, which guards against modules
+// which (indirectly) instantiate themselves.
+constexpr int64_t kMaxModuleDepth = 256;
+
+// Returns the value of the truth table `table` (see Program::truth_tables)
+// applied to the values of the given nets. The table is evaluated as a tree of
+// multiplexers selected by the inputs, starting from the last input.
+uint64_t EvaluateTruthTable(uint64_t table, absl::Span<const int64_t> inputs,
+                            absl::Span<const uint64_t> values) {
+  uint64_t words[int64_t{1} << kMaxTruthTableInputs];
+  int64_t word_count = int64_t{1} << inputs.size();
+  for (int64_t m = 0; m < word_count; ++m) {
+    words[m] = ((table >> m) & 1) ? ~uint64_t{0} : uint64_t{0};
+  }
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    uint64_t select = values[inputs[i]];
+    word_count /= 2;
+    for (int64_t k = 0; k < word_count; ++k) {
+      words[k] = (select & words[2 * k + 1]) | (~select & words[2 * k]);
+    }
+  }
+  return words[0];
+}
+
+}  // namespace
+
+// Flattens a module into gates and levelizes them.
+class CompiledInterpreter::Compiler {
+ public:
+  Compiler(const rtl::Netlist* netlist, CompiledInterpreter* result)
+      : netlist_(netlist), result_(result) {
+    auto copy_program = std::make_unique<Program>();
+    copy_program->instructions.push_back(
+        Instruction{.kind = Instruction::Kind::kInput, .operand = 0});
+    copy_program->max_stack_depth = 1;
+    copy_program_ = copy_program.get();
+    result_->programs_.push_back(std::move(copy_program));
+  }
+
+  absl::Status CompileTopModule(const rtl::Module* module,
+                                absl::Span<const rtl::NetRef> cut_nets,
+                                absl::Span<const rtl::NetRef> probe_nets) {
+    Scope scope{.module = module, .prefix = ""};
+    for (rtl::NetRef input : module->inputs()) {
+      int64_t index = NewNet();
+      scope.nets[input] = index;
+      result_->input_nets_.push_back(index);
+    }
+    for (rtl::NetRef output : module->outputs()) {
+      XLS_ASSIGN_OR_RETURN(int64_t index, BindOutput(scope, output));
+      result_->output_nets_.push_back(index);
+      output_names_.push_back(output->name());
+    }
+    XLS_RETURN_IF_ERROR(CompileModule(scope, /*depth=*/0));
+
+    absl::flat_hash_set<int64_t> cut_indices;
+    for (rtl::NetRef net : cut_nets) {
+      XLS_ASSIGN_OR_RETURN(int64_t index, GetNetIndex(scope, net));
+      if (index == kZeroNet || index == kOneNet) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Cannot cut constant net %s", net->name()));
+      }
+      result_->input_nets_.push_back(index);
+      cut_indices.insert(index);
+    }
+    for (rtl::NetRef net : probe_nets) {
+      XLS_ASSIGN_OR_RETURN(int64_t index, GetNetIndex(scope, net));
+      result_->output_nets_.push_back(index);
+      output_names_.push_back(net->name());
+    }
+
+    // The values of cut nets are given so drop the gates driving them.
+    int64_t kept = 0;
+    for (int64_t g = 0; g < gates_.size(); ++g) {
+      if (!cut_indices.contains(gates_[g].output)) {
+        gates_[kept] = std::move(gates_[g]);
+        gate_names_[kept] = std::move(gate_names_[g]);
+        ++kept;
+      }
+    }
+    gates_.resize(kept);
+    gate_names_.resize(kept);
+    return absl::OkStatus();
+  }
+
+  // Sorts the gates by level, checking that every gate input is driven.
+  absl::Status Levelize();
+
+ private:
+  // The mapping of the nets of one instance of a module to net indices.
+  struct Scope {
+    const rtl::Module* module;
+    // Hierarchical name of the instance used in error messages.
+    std::string prefix;
+    absl::flat_hash_map<rtl::NetRef, int64_t> nets;
+  };
+
+  int64_t NewNet() { return result_->net_count_++; }
+
+  // Returns the index of `net` in `scope`, following assignments to the net
+  // which ultimately drives it.
+  absl::StatusOr<int64_t> GetNetIndex(Scope& scope, rtl::NetRef net) {
+    if (net == scope.module->GetDummyRef()) {
+      // Unused outputs all connect to the dummy net; give each its own index
+      // so they do not appear to be multiply driven.
+      return NewNet();
+    }
+    auto it = scope.nets.find(net);
+    if (it != scope.nets.end()) {
+      return it->second;
+    }
+    XLS_ASSIGN_OR_RETURN(std::optional<int64_t> source,
+                         GetAssignedNetIndex(scope, net));
+    int64_t index = source.has_value() ? *source : NewNet();
+    scope.nets[net] = index;
+    return index;
+  }
+
+  // If `net` is assigned from another net in the module, returns the index of
+  // the net at the end of the chain of assignments.
+  absl::StatusOr<std::optional<int64_t>> GetAssignedNetIndex(Scope& scope,
+                                                             rtl::NetRef net) {
+    const auto& assigns = scope.module->assigns();
+    rtl::NetRef source = net;
+    int64_t steps = 0;
+    while (assigns.contains(source)) {
+      source = assigns.at(source);
+      if (++steps > assigns.size()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Cycle of assignments through net %s%s", scope.prefix,
+            net->name()));
+      }
+    }
+    if (source == scope.module->zero()) {
+      return kZeroNet;
+    }
+    if (source == scope.module->one()) {
+      return kOneNet;
+    }
+    if (source == net) {
+      return std::nullopt;
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t index, GetNetIndex(scope, source));
+    return index;
+  }
+
+  // Binds the module output `output` to a new net index, or to `index` if
+  // given, and returns the index.
+  absl::StatusOr<int64_t> BindOutput(Scope& scope, rtl::NetRef output,
+                                     std::optional<int64_t> index = {}) {
+    int64_t bound = index.has_value() ? *index : NewNet();
+    scope.nets[output] = bound;
+    return bound;
+  }
+
+  void AddGate(Gate gate, std::string name) {
+    gates_.push_back(std::move(gate));
+    gate_names_.push_back(std::move(name));
+  }
+
+  absl::Status CompileModule(Scope& scope, int64_t depth);
+  absl::Status CompileSubmodule(Scope& scope, const rtl::Cell& cell,
+                                const rtl::Module* submodule, int64_t depth);
+  absl::StatusOr<const Program*> GetProgram(const rtl::Cell& cell,
+                                            const std::string& pin_name);
+  absl::Status CompileFunction(const rtl::Cell& cell, const function::Ast& ast,
+                               Program& program, int64_t& depth);
+  absl::StatusOr<uint64_t> ComputeTruthTable(const rtl::Cell& cell,
+                                             const std::string& pin_name);
+
+  const rtl::Netlist* netlist_;
+  CompiledInterpreter* result_;
+  const Program* copy_program_;
+  absl::flat_hash_map<std::pair<const CellLibraryEntry*, std::string>,
+                      const Program*>
+      program_cache_;
+  std::vector<Gate> gates_;
+  std::vector<std::string> gate_names_;
+  std::vector<std::string> output_names_;
+};
+
+absl::Status CompiledInterpreter::Compiler::CompileModule(Scope& scope,
+                                                         int64_t depth) {
+  if (depth > kMaxModuleDepth) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Module instantiation is too deep (recursive instantiation?) at %s",
+        scope.prefix));
+  }
+  const rtl::Module* module = scope.module;
+  for (const std::unique_ptr<rtl::Cell>& cell : module->cells()) {
+    std::optional<const rtl::Module*> submodule =
+        netlist_->MaybeGetModule(cell->cell_library_entry()->name());
+    if (submodule.has_value()) {
+      XLS_RETURN_IF_ERROR(
+          CompileSubmodule(scope, *cell, submodule.value(), depth));
+      continue;
+    }
+    std::vector<int64_t> inputs;
+    inputs.reserve(cell->inputs().size());
+    for (const rtl::Cell::Pin& input : cell->inputs()) {
+      XLS_ASSIGN_OR_RETURN(int64_t index, GetNetIndex(scope, input.netref));
+      inputs.push_back(index);
+    }
+    for (int64_t i = 0; i < cell->outputs().size(); ++i) {
+      const rtl::Cell::OutputPin& output = cell->outputs()[i];
+      Gate gate;
+      if (output.eval != nullptr) {
+        gate.cell = cell.get();
+        gate.output_pin = i;
+      } else {
+        XLS_ASSIGN_OR_RETURN(gate.program, GetProgram(*cell, output.name));
+      }
+      gate.inputs = inputs;
+      XLS_ASSIGN_OR_RETURN(gate.output, GetNetIndex(scope, output.netref));
+      AddGate(std::move(gate), absl::StrCat(scope.prefix, cell->name()));
+    }
+  }
+
+  // Outputs are bound to fixed indices so assignments to them need explicit
+  // copies.
+  for (rtl::NetRef output : module->outputs()) {
+    XLS_ASSIGN_OR_RETURN(std::optional<int64_t> source,
+                         GetAssignedNetIndex(scope, output));
+    if (source.has_value()) {
+      AddGate(Gate{.program = copy_program_,
+                   .inputs = {*source},
+                   .output = scope.nets.at(output)},
+              absl::StrCat(scope.prefix, "assign ", output->name()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CompiledInterpreter::Compiler::CompileSubmodule(
+    Scope& scope, const rtl::Cell& cell, const rtl::Module* submodule,
+    int64_t depth) {
+  Scope child{.module = submodule,
+              .prefix = absl::StrCat(scope.prefix, cell.name(), ".")};
+  // As in Interpreter, the inputs of a module are in the same order as the
+  // input names of the module as a cell library entry.
+  absl::Span<const std::string> input_names =
+      submodule->AsCellLibraryEntry()->input_names();
+  for (const rtl::Cell::Pin& input : cell.inputs()) {
+    auto it = absl::c_find(input_names, input.name);
+    XLS_RET_CHECK(it != input_names.end()) << absl::StrFormat(
+        "Could not find input pin \"%s\" in module \"%s\", referenced in "
+        "cell \"%s\"!",
+        input.name, submodule->name(), cell.name());
+    XLS_ASSIGN_OR_RETURN(int64_t index, GetNetIndex(scope, input.netref));
+    child.nets[submodule->inputs()[it - input_names.begin()]] = index;
+  }
+  for (const rtl::Cell::OutputPin& output : cell.outputs()) {
+    auto it = absl::c_find_if(submodule->outputs(), [&](rtl::NetRef net) {
+      return net->name() == output.name;
+    });
+    XLS_RET_CHECK(it != submodule->outputs().end()) << absl::StrFormat(
+        "Could not find output pin \"%s\" in module \"%s\", referenced in "
+        "cell \"%s\"!",
+        output.name, submodule->name(), cell.name());
+    XLS_ASSIGN_OR_RETURN(int64_t index, GetNetIndex(scope, output.netref));
+    XLS_RETURN_IF_ERROR(BindOutput(child, *it, index).status());
+  }
+  for (rtl::NetRef output : submodule->outputs()) {
+    if (!child.nets.contains(output)) {
+      XLS_RETURN_IF_ERROR(BindOutput(child, output).status());
+    }
+  }
+  return CompileModule(child, depth + 1);
+}
+
+absl::StatusOr<const CompiledInterpreter::Program*>
+CompiledInterpreter::Compiler::GetProgram(const rtl::Cell& cell,
+                                          const std::string& pin_name) {
+  auto key = std::make_pair(cell.cell_library_entry(), pin_name);
+  auto it = program_cache_.find(key);
+  if (it != program_cache_.end()) {
+    return it->second;
+  }
+  const CellLibraryEntry* entry = cell.cell_library_entry();
+  auto program = std::make_unique<Program>();
+  std::optional<uint64_t> truth_table = entry->GetTruthTable(pin_name);
+  if (truth_table.has_value() &&
+      entry->input_names().size() <= kMaxTruthTableInputs) {
+    // Precomputed by function_extractor_main; no need to parse the function.
+    // Cell inputs are in the order of the entry's inputs, which the table is
+    // defined over.
+    program->instructions.push_back(
+        Instruction{.kind = Instruction::Kind::kTruthTable, .operand = 0});
+    program->truth_tables.push_back(*truth_table);
+    program->max_stack_depth = 1;
+  } else {
+    const CellLibraryEntry::OutputPinToFunction& pins =
+        entry->output_pin_to_function();
+    auto pin_it = pins.find(pin_name);
+    XLS_RET_CHECK(pin_it != pins.end());
+    XLS_ASSIGN_OR_RETURN(function::Ast ast,
+                         function::Parser::ParseFunction(pin_it->second));
+    int64_t depth = 0;
+    XLS_RETURN_IF_ERROR(CompileFunction(cell, ast, *program, depth));
+    XLS_RET_CHECK_EQ(depth, 1);
+  }
+  const Program* result = program.get();
+  result_->programs_.push_back(std::move(program));
+  program_cache_[key] = result;
+  return result;
+}
+
+absl::Status CompiledInterpreter::Compiler::CompileFunction(
+    const rtl::Cell& cell, const function::Ast& ast, Program& program,
+    int64_t& depth) {
+  auto push = [&](Instruction::Kind kind, int64_t operand = 0) {
+    program.instructions.push_back(
+        Instruction{.kind = kind, .operand = operand});
+  };
+  auto binary = [&](Instruction::Kind kind) -> absl::Status {
+    XLS_RETURN_IF_ERROR(
+        CompileFunction(cell, ast.children()[0], program, depth));
+    XLS_RETURN_IF_ERROR(
+        CompileFunction(cell, ast.children()[1], program, depth));
+    push(kind);
+    --depth;
+    return absl::OkStatus();
+  };
+  switch (ast.kind()) {
+    case function::Ast::Kind::kAnd:
+      return binary(Instruction::Kind::kAnd);
+    case function::Ast::Kind::kOr:
+      return binary(Instruction::Kind::kOr);
+    case function::Ast::Kind::kXor:
+      return binary(Instruction::Kind::kXor);
+    case function::Ast::Kind::kNot:
+      XLS_RETURN_IF_ERROR(
+          CompileFunction(cell, ast.children()[0], program, depth));
+      push(Instruction::Kind::kNot);
+      return absl::OkStatus();
+    case function::Ast::Kind::kLiteralZero:
+      push(Instruction::Kind::kZero);
+      break;
+    case function::Ast::Kind::kLiteralOne:
+      push(Instruction::Kind::kOne);
+      break;
+    case function::Ast::Kind::kIdentifier: {
+      // As in Interpreter, later inputs with the same name take precedence.
+      std::optional<int64_t> input_index;
+      for (int64_t i = 0; i < cell.inputs().size(); ++i) {
+        if (cell.inputs()[i].name == ast.name()) {
+          input_index = i;
+        }
+      }
+      if (input_index.has_value()) {
+        push(Instruction::Kind::kInput, *input_index);
+        break;
+      }
+      absl::Span<const rtl::Cell::Pin> internal_pins = cell.internal_pins();
+      auto internal = absl::c_find_if(internal_pins, [&](const auto& pin) {
+        return pin.name == ast.name();
+      });
+      if (internal == internal_pins.end()) {
+        return absl::NotFoundError(
+            absl::StrFormat("Identifier \"%s\" not found in cell %s's inputs "
+                            "or internal signals.",
+                            ast.name(), cell.name()));
+      }
+      XLS_ASSIGN_OR_RETURN(uint64_t table, ComputeTruthTable(cell, ast.name()));
+      push(Instruction::Kind::kTruthTable, program.truth_tables.size());
+      program.truth_tables.push_back(table);
+      break;
+    }
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown AST element type: ",
+                       static_cast<int>(ast.kind())));
+  }
+  // All remaining cases push a single value.
+  ++depth;
+  program.max_stack_depth = std::max(program.max_stack_depth, depth);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<uint64_t> CompiledInterpreter::Compiler::ComputeTruthTable(
+    const rtl::Cell& cell, const std::string& pin_name) {
+  XLS_RET_CHECK(cell.cell_library_entry()->state_table());
+  const StateTable& state_table =
+      cell.cell_library_entry()->state_table().value();
+  absl::Span<const rtl::Cell::Pin> inputs = cell.inputs();
+  if (inputs.size() > kMaxTruthTableInputs) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "Cell %s has a state table with %d inputs; at most %d are supported",
+        cell.name(), inputs.size(), kMaxTruthTableInputs));
+  }
+  uint64_t table = 0;
+  for (int64_t m = 0; m < (int64_t{1} << inputs.size()); ++m) {
+    StateTable::InputStimulus stimulus;
+    for (int64_t i = 0; i < inputs.size(); ++i) {
+      stimulus[inputs[i].name] = ((m >> i) & 1) != 0;
+    }
+    XLS_ASSIGN_OR_RETURN(bool value,
+                         state_table.GetSignalValue(stimulus, pin_name));
+    if (value) {
+      table |= uint64_t{1} << m;
+    }
+  }
+  return table;
+}
+
+absl::Status CompiledInterpreter::Compiler::Levelize() {
+  const int64_t net_count = result_->net_count_;
+  std::vector<int64_t> driver(net_count, -1);
+  std::vector<bool> is_source(net_count, false);
+  is_source[kZeroNet] = true;
+  is_source[kOneNet] = true;
+  for (int64_t index : result_->input_nets_) {
+    is_source[index] = true;
+  }
+  for (int64_t g = 0; g < gates_.size(); ++g) {
+    int64_t output = gates_[g].output;
+    if (is_source[output] || driver[output] != -1) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Net driven by %s is driven more than once (previously by %s)",
+          gate_names_[g],
+          driver[output] == -1 ? "a module input or constant"
+                               : gate_names_[driver[output]]));
+    }
+    driver[output] = g;
+  }
+
+  // Kahn's algorithm over the gates. A gate is ready once all of the gates
+  // driving its inputs are evaluated.
+  std::vector<std::vector<int64_t>> users(net_count);
+  std::vector<int64_t> pending_inputs(gates_.size(), 0);
+  std::deque<int64_t> ready;
+  for (int64_t g = 0; g < gates_.size(); ++g) {
+    for (int64_t input : gates_[g].inputs) {
+      if (driver[input] != -1) {
+        users[input].push_back(g);
+        ++pending_inputs[g];
+      } else if (!is_source[input]) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Netlist contains undriven nets and cannot be compiled. Example: "
+            "input of cell %s",
+            gate_names_[g]));
+      }
+    }
+    if (pending_inputs[g] == 0) {
+      ready.push_back(g);
+    }
+  }
+  std::vector<int64_t> net_level(net_count, 0);
+  std::vector<int64_t> gate_level(gates_.size(), -1);
+  int64_t level_count = 0;
+  while (!ready.empty()) {
+    int64_t g = ready.front();
+    ready.pop_front();
+    int64_t level = 1;
+    for (int64_t input : gates_[g].inputs) {
+      level = std::max(level, net_level[input] + 1);
+    }
+    gate_level[g] = level;
+    net_level[gates_[g].output] = level;
+    level_count = std::max(level_count, level);
+    for (int64_t user : users[gates_[g].output]) {
+      if (--pending_inputs[user] == 0) {
+        ready.push_back(user);
+      }
+    }
+  }
+  for (int64_t g = 0; g < gates_.size(); ++g) {
+    if (gate_level[g] == -1) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Netlist contains a combinational cycle and cannot be compiled. "
+          "Example: cell %s",
+          gate_names_[g]));
+    }
+  }
+  for (int64_t i = 0; i < result_->output_nets_.size(); ++i) {
+    int64_t output = result_->output_nets_[i];
+    if (!is_source[output] && driver[output] == -1) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Output %s is not driven", output_names_[i]));
+    }
+  }
+
+  std::vector<int64_t> order(gates_.size());
+  for (int64_t g = 0; g < gates_.size(); ++g) {
+    order[g] = g;
+  }
+  absl::c_stable_sort(order, [&](int64_t a, int64_t b) {
+    return gate_level[a] < gate_level[b];
+  });
+  result_->gates_.reserve(gates_.size());
+  for (int64_t g : order) {
+    result_->gates_.push_back(std::move(gates_[g]));
+  }
+  result_->level_count_ = level_count;
+  for (const std::unique_ptr<Program>& program : result_->programs_) {
+    result_->max_stack_depth_ =
+        std::max(result_->max_stack_depth_, program->max_stack_depth);
+  }
+  return absl::OkStatus();
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<CompiledInterpreter>>
+CompiledInterpreter::Create(const rtl::Netlist* netlist,
+                            const rtl::Module* module) {
+  return Create(netlist, module, /*cut_nets=*/{}, /*probe_nets=*/{});
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<CompiledInterpreter>>
+CompiledInterpreter::Create(const rtl::Netlist* netlist,
+                            const rtl::Module* module,
+                            absl::Span<const rtl::NetRef> cut_nets,
+                            absl::Span<const rtl::NetRef> probe_nets) {
+  auto result = absl::WrapUnique(new CompiledInterpreter());
+  result->module_ = module;
+  // Reserve the constant nets.
+  result->net_count_ = 2;
+  Compiler compiler(netlist, result.get());
+  XLS_RETURN_IF_ERROR(compiler.CompileTopModule(module, cut_nets, probe_nets));
+  XLS_RETURN_IF_ERROR(compiler.Levelize());
+  return result;
+}
+
+absl::StatusOr<uint64_t> CompiledInterpreter::EvaluateGate(
+    const Gate& gate, absl::Span<const uint64_t> values,
+    std::vector<uint64_t>& stack) const {
+  if (gate.program == nullptr) {
+    // Evaluation functions operate on single values so call them per lane.
+    const rtl::Cell::OutputPin& output = gate.cell->outputs()[gate.output_pin];
+    std::vector<bool> args(gate.inputs.size());
+    uint64_t result = 0;
+    for (int64_t lane = 0; lane < kLaneCount; ++lane) {
+      for (int64_t i = 0; i < gate.inputs.size(); ++i) {
+        args[i] = ((values[gate.inputs[i]] >> lane) & 1) != 0;
+      }
+      XLS_ASSIGN_OR_RETURN(bool value, output.eval(args));
+      if (value) {
+        result |= uint64_t{1} << lane;
+      }
+    }
+    return result;
+  }
+
+  stack.clear();
+  for (const Instruction& instruction : gate.program->instructions) {
+    switch (instruction.kind) {
+      case Instruction::Kind::kInput:
+        stack.push_back(values[gate.inputs[instruction.operand]]);
+        break;
+      case Instruction::Kind::kZero:
+        stack.push_back(0);
+        break;
+      case Instruction::Kind::kOne:
+        stack.push_back(~uint64_t{0});
+        break;
+      case Instruction::Kind::kAnd: {
+        uint64_t rhs = stack.back();
+        stack.pop_back();
+        stack.back() &= rhs;
+        break;
+      }
+      case Instruction::Kind::kOr: {
+        uint64_t rhs = stack.back();
+        stack.pop_back();
+        stack.back() |= rhs;
+        break;
+      }
+      case Instruction::Kind::kXor: {
+        uint64_t rhs = stack.back();
+        stack.pop_back();
+        stack.back() ^= rhs;
+        break;
+      }
+      case Instruction::Kind::kNot:
+        stack.back() = ~stack.back();
+        break;
+      case Instruction::Kind::kTruthTable:
+        stack.push_back(EvaluateTruthTable(
+            gate.program->truth_tables[instruction.operand], gate.inputs,
+            values));
+        break;
+    }
+  }
+  return stack.back();
+}
+
+absl::StatusOr<std::vector<uint64_t>> CompiledInterpreter::Run(
+    absl::Span<const uint64_t> inputs) const {
+  XLS_RET_CHECK_EQ(inputs.size(), input_nets_.size());
+  std::vector<uint64_t> values(net_count_, 0);
+  values[kOneNet] = ~uint64_t{0};
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    values[input_nets_[i]] = inputs[i];
+  }
+  std::vector<uint64_t> stack;
+  stack.reserve(max_stack_depth_);
+  for (const Gate& gate : gates_) {
+    XLS_ASSIGN_OR_RETURN(values[gate.output],
+                         EvaluateGate(gate, values, stack));
+  }
+  std::vector<uint64_t> outputs;
+  outputs.reserve(output_nets_.size());
+  for (int64_t index : output_nets_) {
+    outputs.push_back(values[index]);
+  }
+  return outputs;
+}
+
+absl::StatusOr<NetRef2Value> CompiledInterpreter::InterpretModule(
+    const NetRef2Value& inputs) const {
+  std::vector<uint64_t> input_words;
+  input_words.reserve(module_->inputs().size());
+  for (rtl::NetRef input : module_->inputs()) {
+    auto it = inputs.find(input);
+    if (it == inputs.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("No value given for input %s", input->name()));
+    }
+    input_words.push_back(it->second ? 1 : 0);
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<uint64_t> output_words, Run(input_words));
+  NetRef2Value outputs;
+  outputs.reserve(output_words.size());
+  for (int64_t i = 0; i < module_->outputs().size(); ++i) {
+    outputs[module_->outputs()[i]] = (output_words[i] & 1) != 0;
+  }
+  return outputs;
+}
+
+}  // namespace netlist
+}  // namespace xls
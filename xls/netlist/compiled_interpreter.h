@@ -0,0 +1,146 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NETLIST_COMPILED_INTERPRETER_H_
+#define XLS_NETLIST_COMPILED_INTERPRETER_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+
+// Evaluates a combinational netlist module much faster than Interpreter by
+// compiling it once up front:
+//  - Submodule instances are flattened into the top module and every net is
+//    mapped to a dense index.
+//  - The function of each cell output pin is compiled once per cell library
+//    entry into a short postfix program of bitwise operations. Internal pins
+//    defined by a state table are precomputed into truth tables.
+//  - Cells are levelized (topologically sorted by logic depth) so evaluation
+//    is a single pass over a flat array of gates.
+// Values are 64-bit words holding one bit per input vector so each pass
+// evaluates 64 input vectors at once.
+class CompiledInterpreter {
+ public:
+  // The number of input vectors evaluated by each call to Run().
+  static constexpr int64_t kLaneCount = 64;
+
+  // Compiles `module`, which must be a module of `netlist`. Returns an error if
+  // the module contains combinational cycles, undriven nets or cells which
+  // cannot be compiled (e.g., state tables with more than six inputs).
+  static absl::StatusOr<std::unique_ptr<CompiledInterpreter>> Create(
+      const rtl::Netlist* netlist, const rtl::Module* module);
+
+  // As above, but additionally treats the nets `cut_nets` of `module` as inputs
+  // and `probe_nets` as outputs. Run() takes the values of the cut nets after
+  // the values of the module inputs and returns the values of the probe nets
+  // after the values of the module outputs. The cells driving cut nets are not
+  // evaluated. This allows evaluating a slice of a netlist, e.g., the logic
+  // between two sets of pipeline registers.
+  static absl::StatusOr<std::unique_ptr<CompiledInterpreter>> Create(
+      const rtl::Netlist* netlist, const rtl::Module* module,
+      absl::Span<const rtl::NetRef> cut_nets,
+      absl::Span<const rtl::NetRef> probe_nets);
+
+  // Evaluates the module on kLaneCount input vectors. Bit `j` of `inputs[i]` is
+  // the value of `module->inputs()[i]` in the j-th vector, and bit `j` of the
+  // i-th returned word is the value of `module->outputs()[i]` for that vector.
+  // Safe to call concurrently.
+  absl::StatusOr<std::vector<uint64_t>> Run(
+      absl::Span<const uint64_t> inputs) const;
+
+  // Evaluates the module on a single input vector with the same interface as
+  // Interpreter::InterpretModule. Not supported if there are cut nets.
+  absl::StatusOr<NetRef2Value> InterpretModule(
+      const NetRef2Value& inputs) const;
+
+  const rtl::Module* module() const { return module_; }
+
+  // Returns the number of nets, gates and levels of the compiled netlist.
+  // Gates include cell output pins and the copies implementing assignments.
+  int64_t net_count() const { return net_count_; }
+  int64_t gate_count() const { return gates_.size(); }
+  int64_t level_count() const { return level_count_; }
+
+ private:
+  // A single operation of a pin function program. Programs are evaluated on a
+  // stack of words.
+  struct Instruction {
+    enum class Kind : uint8_t {
+      // Pushes the value of the `operand`-th input of the gate.
+      kInput,
+      kZero,
+      kOne,
+      kAnd,
+      kOr,
+      kXor,
+      kNot,
+      // Pushes the value of the truth table `truth_tables[operand]` applied to
+      // all inputs of the gate.
+      kTruthTable,
+    };
+    Kind kind;
+    int64_t operand = 0;
+  };
+
+  struct Program {
+    std::vector<Instruction> instructions;
+    // Truth tables over up to six inputs. Bit `m` is the value of the function
+    // when input `i` has the value of bit `i` of `m`.
+    std::vector<uint64_t> truth_tables;
+    int64_t max_stack_depth = 0;
+  };
+
+  struct Gate {
+    // Either `program` is non-null or `cell` is a cell whose output pin
+    // `output_pin` has an evaluation function which is called on each lane.
+    const Program* program = nullptr;
+    const rtl::Cell* cell = nullptr;
+    int64_t output_pin = 0;
+    // Net indices of the gate inputs, in the order of the cell inputs, and of
+    // the gate output.
+    std::vector<int64_t> inputs;
+    int64_t output;
+  };
+
+  class Compiler;
+
+  CompiledInterpreter() = default;
+
+  absl::StatusOr<uint64_t> EvaluateGate(const Gate& gate,
+                                        absl::Span<const uint64_t> values,
+                                        std::vector<uint64_t>& stack) const;
+
+  const rtl::Module* module_ = nullptr;
+  std::vector<std::unique_ptr<Program>> programs_;
+  // Gates in order of increasing level.
+  std::vector<Gate> gates_;
+  std::vector<int64_t> input_nets_;
+  std::vector<int64_t> output_nets_;
+  int64_t net_count_ = 0;
+  int64_t level_count_ = 0;
+  int64_t max_stack_depth_ = 0;
+};
+
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_COMPILED_INTERPRETER_H_
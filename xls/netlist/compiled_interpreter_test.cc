@@ -0,0 +1,347 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_interpreter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/algorithm/container.h"
+#include "absl/random/distributions.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/matchers.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/fake_cell_library.h"
+#include "xls/netlist/function_extractor.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist.pb.h"
+#include "xls/netlist/netlist_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+class CompiledInterpreterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(cell_library_, MakeFakeCellLibrary());
+  }
+
+  absl::StatusOr<std::unique_ptr<rtl::Netlist>> Parse(
+      const std::string& text) {
+    rtl::Scanner scanner(text);
+    return rtl::Parser::ParseNetlist(&cell_library_, &scanner);
+  }
+
+  // Checks that the compiled interpreter agrees with Interpreter on the given
+  // input vectors, each packed into the bits of a word.
+  void ExpectMatchesInterpreter(rtl::Netlist* netlist,
+                                const rtl::Module* module,
+                                const std::vector<uint64_t>& vectors) {
+    XLS_ASSERT_OK_AND_ASSIGN(auto compiled,
+                             CompiledInterpreter::Create(netlist, module));
+    int64_t input_count = module->inputs().size();
+    // Run the vectors in groups of 64, transposed to one word per input.
+    for (int64_t begin = 0; begin < vectors.size();
+         begin += CompiledInterpreter::kLaneCount) {
+      std::vector<uint64_t> input_words(input_count, 0);
+      int64_t lane_count = std::min<int64_t>(CompiledInterpreter::kLaneCount,
+                                             vectors.size() - begin);
+      for (int64_t lane = 0; lane < lane_count; ++lane) {
+        for (int64_t i = 0; i < input_count; ++i) {
+          input_words[i] |= ((vectors[begin + lane] >> i) & 1) << lane;
+        }
+      }
+      XLS_ASSERT_OK_AND_ASSIGN(std::vector<uint64_t> output_words,
+                               compiled->Run(input_words));
+      ASSERT_EQ(output_words.size(), module->outputs().size());
+
+      Interpreter interpreter(netlist);
+      for (int64_t lane = 0; lane < lane_count; ++lane) {
+        NetRef2Value inputs;
+        for (int64_t i = 0; i < input_count; ++i) {
+          inputs[module->inputs()[i]] = (vectors[begin + lane] >> i) & 1;
+        }
+        XLS_ASSERT_OK_AND_ASSIGN(NetRef2Value expected,
+                                 interpreter.InterpretModule(module, inputs));
+        for (int64_t o = 0; o < module->outputs().size(); ++o) {
+          EXPECT_EQ(((output_words[o] >> lane) & 1) != 0,
+                    expected.at(module->outputs()[o]))
+              << "output " << module->outputs()[o]->name() << " vector "
+              << vectors[begin + lane];
+        }
+        XLS_ASSERT_OK_AND_ASSIGN(NetRef2Value single,
+                                 compiled->InterpretModule(inputs));
+        EXPECT_EQ(single, expected);
+      }
+    }
+  }
+
+  // Returns all vectors of `input_count` bits.
+  static std::vector<uint64_t> AllVectors(int64_t input_count) {
+    std::vector<uint64_t> vectors;
+    for (uint64_t v = 0; v < (uint64_t{1} << input_count); ++v) {
+      vectors.push_back(v);
+    }
+    return vectors;
+  }
+
+  CellLibrary cell_library_;
+};
+
+TEST_F(CompiledInterpreterTest, Submodules) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist, Parse(R"(
+module submodule_0 (i2_0, i2_1, o2_0);
+  input i2_0, i2_1;
+  output o2_0;
+
+  AND and0( .A(i2_0), .B(i2_1), .Z(o2_0) );
+endmodule
+
+module submodule_1 (i2_2, i2_3, o2_1);
+  input i2_2, i2_3;
+  output o2_1;
+
+  OR or0( .A(i2_2), .B(i2_3), .Z(o2_1) );
+endmodule
+
+module submodule_2 (i1_0, i1_1, i1_2, i1_3, o1_0);
+  input i1_0, i1_1, i1_2, i1_3;
+  output o1_0;
+  wire res0, res1;
+
+  submodule_0 and0 ( .i2_0(i1_0), .i2_1(i1_1), .o2_0(res0) );
+  submodule_1 or0 ( .i2_2(i1_2), .i2_3(i1_3), .o2_1(res1) );
+  XOR xor0 ( .A(res0), .B(res1), .Z(o1_0) );
+endmodule
+
+module main (i0, i1, i2, i3, o0);
+  input i0, i1, i2, i3;
+  output o0;
+
+  submodule_2 bleh( .i1_0(i0), .i1_1(i1), .i1_2(i2), .i1_3(i3), .o1_0(o0) );
+endmodule
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto compiled, CompiledInterpreter::Create(netlist.get(), module));
+  EXPECT_EQ(compiled->gate_count(), 3);
+  EXPECT_EQ(compiled->level_count(), 2);
+  ExpectMatchesInterpreter(netlist.get(), module, AllVectors(4));
+}
+
+TEST_F(CompiledInterpreterTest, StateTables) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist, Parse(R"(
+module main(i0, i1, i2, i3, o0);
+  input i0, i1, i2, i3;
+  output o0;
+  wire and0_out, and1_out;
+
+  AND and0 ( .A(i0), .B(i1), .Z(and0_out) );
+  STATETABLE_AND and1 (.A(i2), .B(i3), .Z(and1_out) );
+  AND and2 ( .A(and0_out), .B(and1_out), .Z(o0) );
+endmodule
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  ExpectMatchesInterpreter(netlist.get(), module, AllVectors(4));
+}
+
+TEST_F(CompiledInterpreterTest, Assigns) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist, Parse(R"(
+module main (A, B, out);
+  input A;
+  input B;
+  wire [1:0] i0;
+  wire [2:0] i1;
+  wire [3:0] i2;
+  wire [4:0] i3;
+  output [15:0] out;
+  wire [15:0] out;
+
+  assign i0 = { A, B };
+  assign i1 = { 1'b1, i0 };
+  assign { i2, i3 }  = { i1, i1, i1, i1 };
+  assign out = { i3, i2, 7'h4a };
+endmodule
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  ExpectMatchesInterpreter(netlist.get(), module, AllVectors(2));
+}
+
+TEST_F(CompiledInterpreterTest, RandomNetlist) {
+  constexpr int64_t kInputCount = 12;
+  constexpr int64_t kCellCount = 500;
+  std::mt19937_64 rng;
+  std::vector<std::string> nets;
+  std::string text = "module main (";
+  for (int64_t i = 0; i < kInputCount; ++i) {
+    nets.push_back(absl::StrCat("i", i));
+    absl::StrAppend(&text, "i", i, ", ");
+  }
+  absl::StrAppend(&text, "out);\n");
+  for (int64_t i = 0; i < kInputCount; ++i) {
+    absl::StrAppend(&text, "  input i", i, ";\n");
+  }
+  absl::StrAppend(&text, "  output out;\n");
+  std::string cells;
+  for (int64_t c = 0; c < kCellCount; ++c) {
+    std::string out =
+        c == kCellCount - 1 ? "out" : absl::StrFormat("w%d", c);
+    if (c != kCellCount - 1) {
+      absl::StrAppend(&text, "  wire ", out, ";\n");
+    }
+    // Interpreter requires the inputs of a cell to be distinct nets.
+    std::vector<std::string> in;
+    while (in.size() < 3) {
+      std::string net = nets[absl::Uniform<size_t>(rng, 0, nets.size())];
+      if (absl::c_find(in, net) == in.end()) {
+        in.push_back(net);
+      }
+    }
+    switch (absl::Uniform(rng, 0, 5)) {
+      case 0:
+        absl::StrAppendFormat(&cells, "  AND c%d (.A(%s), .B(%s), .Z(%s));\n",
+                              c, in[0], in[1], out);
+        break;
+      case 1:
+        absl::StrAppendFormat(&cells, "  OR c%d (.A(%s), .B(%s), .Z(%s));\n",
+                              c, in[0], in[1], out);
+        break;
+      case 2:
+        absl::StrAppendFormat(&cells, "  XOR c%d (.A(%s), .B(%s), .Z(%s));\n",
+                              c, in[0], in[1], out);
+        break;
+      case 3:
+        absl::StrAppendFormat(&cells, "  INV c%d (.A(%s), .ZN(%s));\n", c,
+                              in[0], out);
+        break;
+      case 4:
+        absl::StrAppendFormat(
+            &cells, "  AOI21 c%d (.A(%s), .B(%s), .C(%s), .ZN(%s));\n", c,
+            in[0], in[1], in[2], out);
+        break;
+    }
+    nets.push_back(out);
+  }
+  absl::StrAppend(&text, cells, "endmodule\n");
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist, Parse(text));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  std::vector<uint64_t> vectors;
+  for (int64_t i = 0; i < 256; ++i) {
+    vectors.push_back(absl::Uniform<uint64_t>(rng) &
+                      ((uint64_t{1} << kInputCount) - 1));
+  }
+  ExpectMatchesInterpreter(netlist.get(), module, vectors);
+}
+
+TEST_F(CompiledInterpreterTest, PrecomputedTruthTables) {
+  // Round trip the library through a proto with truth tables, as written by
+  // function_extractor_main.
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto proto, cell_library_.ToProto());
+  function::AddTruthTables(&proto);
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary tabulated,
+                           CellLibrary::FromProto(proto));
+  XLS_ASSERT_OK_AND_ASSIGN(const CellLibraryEntry* aoi,
+                           tabulated.GetEntry("AOI21"));
+  ASSERT_TRUE(aoi->GetTruthTable("ZN").has_value());
+
+  std::string text = R"(
+module main (a, b, c, d, z0, z1);
+  input a, b, c, d;
+  output z0, z1;
+  wire w0, w1;
+
+  AOI21 aoi0 ( .A(a), .B(b), .C(c), .ZN(w0) );
+  AOI21 aoi1 ( .A(d), .B(w0), .C(a), .ZN(w1) );
+  XOR xor0 ( .A(w0), .B(d), .Z(z0) );
+  NAND nand0 ( .A(w1), .B(c), .ZN(z1) );
+endmodule
+)";
+  rtl::Scanner scanner(text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&tabulated, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  ExpectMatchesInterpreter(netlist.get(), module, AllVectors(4));
+}
+
+TEST_F(CompiledInterpreterTest, CombinationalCycle) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist, Parse(R"(
+module main (i0, o0);
+  input i0;
+  output o0;
+  wire a, b;
+
+  AND and0 ( .A(i0), .B(b), .Z(a) );
+  INV inv0 ( .A(a), .ZN(b) );
+  INV inv1 ( .A(b), .ZN(o0) );
+endmodule
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  EXPECT_THAT(CompiledInterpreter::Create(netlist.get(), module),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("combinational cycle")));
+}
+
+TEST_F(CompiledInterpreterTest, CutAndProbeNets) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist, Parse(R"(
+module main (i0, o0);
+  input i0;
+  output o0;
+  wire a, b;
+
+  AND and0 ( .A(i0), .B(b), .Z(a) );
+  INV inv0 ( .A(a), .ZN(b) );
+  INV inv1 ( .A(b), .ZN(o0) );
+endmodule
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(rtl::NetRef a, module->ResolveNet("a"));
+  XLS_ASSERT_OK_AND_ASSIGN(rtl::NetRef b, module->ResolveNet("b"));
+  // Cutting `b` breaks the cycle through inv0.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto compiled,
+      CompiledInterpreter::Create(netlist.get(), module, /*cut_nets=*/{b},
+                                  /*probe_nets=*/{a}));
+  uint64_t i0 = 0b1010;
+  uint64_t b_value = 0b1100;
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<uint64_t> outputs,
+                           compiled->Run({i0, b_value}));
+  ASSERT_EQ(outputs.size(), 2);
+  EXPECT_EQ(outputs[0], ~b_value);
+  EXPECT_EQ(outputs[1], i0 & b_value);
+}
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
@@ -15,14 +15,22 @@
 #include "xls/netlist/find_logic_clouds.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/data_structures/union_find.h"
+#include "xls/netlist/netlist.h"
 
 namespace xls {
 namespace netlist {
@@ -46,90 +54,86 @@ void Cluster::SortCells() {
 
 std::vector<Cluster> FindLogicClouds(const Module& module,
                                      bool include_vacuous) {
-  UnionFind<Cell*> cell_to_uf;
-
-  // Gets-or-adds the given cell to the UnionFind.
-  auto get_uf = [&cell_to_uf](Cell* c) -> Cell* {
-    cell_to_uf.Insert(c);
-    return cell_to_uf.Find(c);
-  };
-
-  // Helper for debugging that counts the number of equivalence classes in
-  // cell_to_uf.
-  auto count_equivalence_classes = [&cell_to_uf]() -> int64_t {
-    return cell_to_uf.GetRepresentatives().size();
+  // Cells are numbered by their position in the module so the equivalence
+  // classes can be held in a DenseUnionFind.
+  absl::Span<const std::unique_ptr<Cell>> cells = module.cells();
+  absl::flat_hash_map<const Cell*, int64_t> cell_ids;
+  cell_ids.reserve(cells.size());
+  for (int64_t i = 0; i < cells.size(); ++i) {
+    cell_ids[cells[i].get()] = i;
+  }
+  DenseUnionFind cell_uf(cells.size());
+
+  // Every non-flop cell is merged with the non-flop cells sharing any of its
+  // nets, and with the flops its outputs drive. Flop output connectivity is
+  // excluded from the equivalence classes so we get partitions along flop
+  // (output) boundaries.
+  //
+  // Merging all the non-flop cells of a net with the first of them once per
+  // net, rather than every pair of cells sharing the net, keeps this linear in
+  // the number of pins even for nets with very large fanout.
+  absl::flat_hash_set<const NetDef*> visited_nets;
+  auto merge_logic_on_net = [&](NetRef net) {
+    if (!visited_nets.insert(net).second) {
+      return;
+    }
+    std::optional<int64_t> first;
+    for (Cell* connected : net->connected_cells()) {
+      if (connected->kind() == CellKind::kFlop) {
+        continue;
+      }
+      int64_t id = cell_ids.at(connected);
+      if (first.has_value()) {
+        cell_uf.Union(*first, id);
+      } else {
+        first = id;
+      }
+    }
   };
-
-  for (auto& item : module.cells()) {
-    Cell* cell = item.get();
-    VLOG(4) << "Considering cell: " << cell->name();
-
-    // Flop output connectivity is excluded from the equivalence class, so we
-    // get partitions along flop (output) boundaries.
+  for (int64_t i = 0; i < cells.size(); ++i) {
+    const Cell* cell = cells[i].get();
     if (cell->kind() == CellKind::kFlop) {
-      // For flops we just make sure an equivalence class is present in the
-      // map, in case it doesn't have any cells on the input side.
-      get_uf(cell);
-      VLOG(4) << "--- Now " << count_equivalence_classes()
-              << " equivalence classes for " << cell_to_uf.size() << " cells.";
       continue;
     }
-
-    for (auto& input : cell->inputs()) {
-      VLOG(4) << "- Considering input net: " << input.netref->name();
-      for (Cell* connected : input.netref->connected_cells()) {
-        if (cell == connected) {
-          continue;
-        }
-        if (connected->kind() == CellKind::kFlop) {
-          VLOG(4) << absl::StreamFormat(
-              "-- Cell is connected to flop cell %s on an input pin; not "
-              "merging equivalence classes.",
-              connected->name());
-          continue;
-        }
-        VLOG(4) << absl::StreamFormat("-- Cell %s is connected to cell %s",
-                                      cell->name(), connected->name());
-        cell_to_uf.Union(get_uf(cell), get_uf(connected));
-        VLOG(4) << "--- Now " << count_equivalence_classes()
-                << " equivalence classes for " << cell_to_uf.size()
-                << " cells.";
-      }
+    VLOG(4) << "Considering cell: " << cell->name();
+    for (const Cell::Pin& input : cell->inputs()) {
+      merge_logic_on_net(input.netref);
     }
-
-    for (const auto& iter : cell->outputs()) {
-      NetRef output = iter.netref;
-      VLOG(4) << "- Considering output net: " << output->name();
-      for (Cell* connected : output->connected_cells()) {
-        if (cell == connected) {
-          continue;
+    for (const Cell::OutputPin& output : cell->outputs()) {
+      merge_logic_on_net(output.netref);
+      for (Cell* connected : output.netref->connected_cells()) {
+        if (connected->kind() == CellKind::kFlop) {
+          VLOG(4) << absl::StreamFormat("-- Cell %s drives flop %s",
+                                        cell->name(), connected->name());
+          cell_uf.Union(i, cell_ids.at(connected));
         }
-        VLOG(4) << absl::StreamFormat("-- Cell %s is connected to cell %s",
-                                      cell->name(), connected->name());
-        cell_to_uf.Union(get_uf(cell), get_uf(connected));
-        VLOG(4) << "--- Now " << count_equivalence_classes()
-                << " equivalence classes for " << cell_to_uf.size()
-                << " cells.";
       }
     }
   }
+  VLOG(3) << absl::StreamFormat("%d equivalence classes for %d cells",
+                                cell_uf.class_count(), cells.size());
 
   // Run through the cells and put them into clusters according to their
   // equivalence classes.
-  absl::flat_hash_map<Cell*, Cluster> equivalence_set_to_cluster;
-  for (auto& item : module.cells()) {
-    Cell* cell = item.get();
-    equivalence_set_to_cluster[get_uf(cell)].Add(cell);
+  std::vector<Cluster> all_clusters;
+  all_clusters.reserve(cell_uf.class_count());
+  std::vector<int64_t> cluster_of_root(cells.size(), -1);
+  for (int64_t i = 0; i < cells.size(); ++i) {
+    int64_t& cluster = cluster_of_root[cell_uf.Find(i)];
+    if (cluster == -1) {
+      cluster = all_clusters.size();
+      all_clusters.emplace_back();
+    }
+    all_clusters[cluster].Add(cells[i].get());
   }
 
-  // Put them into a vector and sort each cluster's internal cells for
-  // determinism.
+  // Sort each cluster's internal cells for determinism, dropping the vacuous
+  // 'just a flop' clusters if requested.
   std::vector<Cluster> clusters;
-  for (auto& item : equivalence_set_to_cluster) {
-    Cluster& cluster = item.second;
+  clusters.reserve(all_clusters.size());
+  for (Cluster& cluster : all_clusters) {
     if (!include_vacuous && (cluster.terminating_flops().size() == 1 &&
                              cluster.other_cells().empty())) {
-      // Vacuous 'just a flop' cluster.
       continue;
     }
     cluster.SortCells();
@@ -137,20 +141,29 @@ std::vector<Cluster> FindLogicClouds(const Module& module,
   }
 
   // For convenience (for now) we convert the cell names to a string and rely on
-  // string comparison for deterministic order.
+  // string comparison for deterministic order. The keys are computed once per
+  // cluster rather than once per comparison.
   auto cells_to_str = [](absl::Span<const Cell* const> cells) {
     return absl::StrJoin(cells, ", ", [](std::string* out, const Cell* cell) {
       absl::StrAppend(out, cell->name());
     });
   };
-  auto cluster_sort_lt = [cells_to_str](const Cluster& a, const Cluster& b) {
-    return std::make_pair(cells_to_str(a.terminating_flops()),
-                          cells_to_str(a.other_cells())) <
-           std::make_pair(cells_to_str(b.terminating_flops()),
-                          cells_to_str(b.other_cells()));
-  };
-  std::sort(clusters.begin(), clusters.end(), cluster_sort_lt);
-  return clusters;
+  std::vector<std::pair<std::string, std::string>> keys;
+  keys.reserve(clusters.size());
+  for (const Cluster& cluster : clusters) {
+    keys.push_back({cells_to_str(cluster.terminating_flops()),
+                    cells_to_str(cluster.other_cells())});
+  }
+  std::vector<int64_t> order(clusters.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&](int64_t a, int64_t b) { return keys[a] < keys[b]; });
+  std::vector<Cluster> sorted_clusters;
+  sorted_clusters.reserve(clusters.size());
+  for (int64_t i : order) {
+    sorted_clusters.push_back(std::move(clusters[i]));
+  }
+  return sorted_clusters;
 }
 
 std::string ClustersToString(absl::Span<const Cluster> clusters) {
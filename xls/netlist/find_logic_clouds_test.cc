@@ -14,6 +14,7 @@
 
 #include "xls/netlist/find_logic_clouds.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -21,6 +22,9 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "benchmark/benchmark.h"
 #include "xls/common/status/matchers.h"
 #include "xls/netlist/fake_cell_library.h"
 #include "xls/netlist/netlist_parser.h"
@@ -133,6 +137,92 @@ cluster {
             ClustersToString(clusters));
 }
 
+TEST(ClusterTest, HighFanoutNet) {
+  // Every inverter reads `x`, so they all land in one cloud along with the
+  // flops they drive.
+  std::string netlist = R"(module main(clk, x, o0, o1, o2);
+  input clk;
+  input x;
+  output o0, o1, o2;
+  wire n0, n1, n2;
+
+  INV inv_0(.A(x), .ZN(n0));
+  INV inv_1(.A(x), .ZN(n1));
+  INV inv_2(.A(x), .ZN(n2));
+  DFF dff_0(.D(n0), .Q(o0), .CLK(clk));
+  DFF dff_1(.D(n1), .Q(o1), .CLK(clk));
+  DFF dff_2(.D(n2), .Q(o2), .CLK(clk));
+endmodule)";
+  Scanner scanner(netlist);
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Netlist> n,
+                           Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* m, n->GetModule("main"));
+  std::vector<Cluster> clusters = FindLogicClouds(*m);
+  EXPECT_EQ(1, clusters.size());
+  EXPECT_EQ(R"(cluster {
+  terminating_flop: dff_0
+  terminating_flop: dff_1
+  terminating_flop: dff_2
+  other_cell: inv_0
+  other_cell: inv_1
+  other_cell: inv_2
+}
+)",
+            ClustersToString(clusters));
+}
+
+constexpr int64_t kBenchmarkLanes = 64;
+
+// Returns the text of a netlist with `stages` pipeline stages of
+// `kBenchmarkLanes` flops each, where each flop is fed by an AND of two
+// neighbouring lanes of the previous stage.
+std::string MakePipelineNetlist(int64_t stages) {
+  std::vector<std::string> inputs;
+  std::vector<std::string> wires;
+  std::string cells;
+  auto q = [](int64_t stage, int64_t lane) {
+    return absl::StrFormat("q_%d_%d", stage, lane);
+  };
+  for (int64_t lane = 0; lane < kBenchmarkLanes; ++lane) {
+    inputs.push_back(q(0, lane));
+  }
+  for (int64_t stage = 0; stage < stages; ++stage) {
+    for (int64_t lane = 0; lane < kBenchmarkLanes; ++lane) {
+      std::string d = absl::StrFormat("d_%d_%d", stage, lane);
+      wires.push_back(d);
+      wires.push_back(q(stage + 1, lane));
+      absl::StrAppendFormat(
+          &cells, "  AND and_%d_%d(.A(%s), .B(%s), .Z(%s));\n", stage, lane,
+          q(stage, lane), q(stage, (lane + 1) % kBenchmarkLanes), d);
+      absl::StrAppendFormat(&cells,
+                            "  DFF dff_%d_%d(.D(%s), .Q(%s), .CLK(clk));\n",
+                            stage, lane, d, q(stage + 1, lane));
+    }
+  }
+  return absl::StrFormat(
+      "module main(clk, %s);\n  input clk;\n  input %s;\n  wire %s;\n%s"
+      "endmodule",
+      absl::StrJoin(inputs, ", "), absl::StrJoin(inputs, ", "),
+      absl::StrJoin(wires, ", "), cells);
+}
+
+void BM_FindLogicClouds(benchmark::State& state) {
+  std::string netlist = MakePipelineNetlist(state.range(0));
+  Scanner scanner(netlist);
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Netlist> n,
+                           Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* m, n->GetModule("main"));
+  for (auto _ : state) {
+    std::vector<Cluster> clusters = FindLogicClouds(*m);
+    benchmark::DoNotOptimize(clusters);
+  }
+  state.SetItemsProcessed(state.iterations() * m->cells().size());
+}
+
+BENCHMARK(BM_FindLogicClouds)->Range(4, 4096);
+
 }  // namespace
 }  // namespace rtl
 }  // namespace netlist
@@ -14,21 +14,26 @@
 
 #include "xls/netlist/function_extractor.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/netlist/function_parser.h"
 #include "xls/netlist/lib_parser.h"
 #include "xls/netlist/netlist.pb.h"
 
@@ -272,8 +277,105 @@ absl::Status ExtractFromCell(const cell_lib::Block& cell,
   return absl::OkStatus();
 }
 
+// Truth tables are held in a single word so they are limited to six inputs.
+constexpr int64_t kMaxTruthTableInputs = 6;
+
+// The truth table of each of the first six variables: bit `m` of
+// kVariableMasks[i] is bit `i` of `m`.
+constexpr uint64_t kVariableMasks[kMaxTruthTableInputs] = {
+    0xaaaaaaaaaaaaaaaa, 0xcccccccccccccccc, 0xf0f0f0f0f0f0f0f0,
+    0xff00ff00ff00ff00, 0xffff0000ffff0000, 0xffffffff00000000};
+
+// Evaluates `ast` on all input combinations at once, one per bit. Returns
+// std::nullopt if the function refers to anything other than `inputs`.
+std::optional<uint64_t> EvaluateOnAllInputs(
+    const Ast& ast, const absl::flat_hash_map<std::string, uint64_t>& inputs) {
+  auto child = [&](int64_t i) {
+    return EvaluateOnAllInputs(ast.children()[i], inputs);
+  };
+  switch (ast.kind()) {
+    case Ast::Kind::kIdentifier: {
+      auto it = inputs.find(ast.name());
+      if (it == inputs.end()) {
+        return std::nullopt;
+      }
+      return it->second;
+    }
+    case Ast::Kind::kLiteralZero:
+      return uint64_t{0};
+    case Ast::Kind::kLiteralOne:
+      return ~uint64_t{0};
+    case Ast::Kind::kNot: {
+      std::optional<uint64_t> value = child(0);
+      if (!value.has_value()) {
+        return std::nullopt;
+      }
+      return ~*value;
+    }
+    case Ast::Kind::kAnd:
+    case Ast::Kind::kOr:
+    case Ast::Kind::kXor: {
+      std::optional<uint64_t> lhs = child(0);
+      std::optional<uint64_t> rhs = child(1);
+      if (!lhs.has_value() || !rhs.has_value()) {
+        return std::nullopt;
+      }
+      if (ast.kind() == Ast::Kind::kAnd) {
+        return *lhs & *rhs;
+      }
+      if (ast.kind() == Ast::Kind::kOr) {
+        return *lhs | *rhs;
+      }
+      return *lhs ^ *rhs;
+    }
+  }
+  return std::nullopt;
+}
+
 }  // namespace
 
+void AddTruthTables(CellLibraryProto* proto) {
+  // Libraries usually hold many variants of each cell (drive strengths,
+  // thresholds) with the same pins and functions, so the tables are memoized
+  // by the input names and function rather than parsed for every pin.
+  absl::flat_hash_map<std::pair<std::string, std::string>,
+                      std::optional<uint64_t>>
+      tables;
+  for (CellLibraryEntryProto& entry : *proto->mutable_entries()) {
+    if (entry.input_names_size() > kMaxTruthTableInputs) {
+      continue;
+    }
+    // As in the interpreters, later inputs with the same name take precedence.
+    absl::flat_hash_map<std::string, uint64_t> inputs;
+    for (int64_t i = 0; i < entry.input_names_size(); ++i) {
+      inputs[entry.input_names(i)] = kVariableMasks[i];
+    }
+    uint64_t used_bits =
+        entry.input_names_size() == kMaxTruthTableInputs
+            ? ~uint64_t{0}
+            : (uint64_t{1} << (int64_t{1} << entry.input_names_size())) - 1;
+    std::string input_key = absl::StrJoin(entry.input_names(), " ");
+    for (OutputPinProto& pin :
+         *entry.mutable_output_pin_list()->mutable_pins()) {
+      if (pin.function().empty()) {
+        continue;
+      }
+      auto [it, inserted] =
+          tables.try_emplace({input_key, pin.function()}, std::nullopt);
+      if (inserted) {
+        absl::StatusOr<Ast> ast = Parser::ParseFunction(pin.function());
+        if (ast.ok()) {
+          it->second = EvaluateOnAllInputs(*ast, inputs);
+        }
+      }
+      const std::optional<uint64_t>& table = it->second;
+      if (table.has_value()) {
+        pin.set_truth_table(*table & used_bits);
+      }
+    }
+  }
+}
+
 absl::StatusOr<CellLibraryProto> ExtractFunctions(
     cell_lib::CharStream* stream) {
   cell_lib::Scanner scanner(stream);
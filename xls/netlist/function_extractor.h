@@ -31,6 +31,12 @@ namespace function {
 // logical operation of the cell or pin (in the case of multiple output pins).
 absl::StatusOr<CellLibraryProto> ExtractFunctions(cell_lib::CharStream* stream);
 
+// Sets `OutputPinProto.truth_table` for each output pin function in `proto`
+// which can be tabulated: the function must parse, depend only on the input
+// pins of its cell, and the cell must have at most six inputs. Other pins are
+// left alone.
+void AddTruthTables(CellLibraryProto* proto);
+
 }  // namespace function
 }  // namespace netlist
 }  // namespace xls
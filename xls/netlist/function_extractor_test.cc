@@ -14,12 +14,18 @@
 
 #include "xls/netlist/function_extractor.h"
 
+#include <cstdint>
 #include <string>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "benchmark/benchmark.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
+#include "xls/netlist/cell_library.h"
 #include "xls/netlist/lib_parser.h"
 #include "xls/netlist/netlist.pb.h"
 
@@ -218,6 +224,134 @@ library (simple_statetable_cells) {
   EXPECT_EQ(row.next_internal_signals().at("X"), STATE_TABLE_SIGNAL_HIGH);
 }
 
+TEST(FunctionExtractorTest, AddTruthTables) {
+  std::string lib = R"lib(
+library (truth_tables) {
+  cell (aoi) {
+    pin (A) {
+      direction: input;
+    }
+    pin (B) {
+      direction: input;
+    }
+    pin (C) {
+      direction: input;
+    }
+    pin (ZN) {
+      direction: output;
+      function: "!((A&B)|C)";
+    }
+    pin (ONE) {
+      direction: output;
+      function: "1";
+    }
+  }
+  cell (latch) {
+    pin (D) {
+      direction: input;
+    }
+    pin (Q) {
+      direction: output;
+      function: "IQ";
+    }
+  }
+}
+  )lib";
+  XLS_ASSERT_OK_AND_ASSIGN(auto stream, cell_lib::CharStream::FromText(lib));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto proto, ExtractFunctions(&stream));
+  AddTruthTables(&proto);
+
+  const CellLibraryEntryProto& aoi = proto.entries(0);
+  ASSERT_EQ(aoi.input_names_size(), 3);
+  ASSERT_EQ(aoi.output_pin_list().pins_size(), 2);
+  const OutputPinProto& zn = aoi.output_pin_list().pins(0);
+  ASSERT_TRUE(zn.has_truth_table());
+  uint64_t expected = 0;
+  for (int64_t m = 0; m < 8; ++m) {
+    bool a = (m & 1) != 0;
+    bool b = (m & 2) != 0;
+    bool c = (m & 4) != 0;
+    if (!((a && b) || c)) {
+      expected |= uint64_t{1} << m;
+    }
+  }
+  EXPECT_EQ(zn.truth_table(), expected);
+  // Only the 2^3 entries of the table are used.
+  EXPECT_EQ(aoi.output_pin_list().pins(1).truth_table(), 0xff);
+
+  // Functions of internal signals cannot be tabulated.
+  EXPECT_FALSE(proto.entries(1).output_pin_list().pins(0).has_truth_table());
+}
+
+// Returns the text of a Liberty file with `cell_count` combinational cells.
+std::string MakeLibertyText(int64_t cell_count) {
+  std::string text = "library (benchmark) {\n";
+  for (int64_t i = 0; i < cell_count; ++i) {
+    absl::StrAppendFormat(&text, R"lib(  cell (cell_%d) {
+    pin (A) {
+      direction: input;
+    }
+    pin (B) {
+      direction: input;
+    }
+    pin (C) {
+      direction: input;
+    }
+    pin (D) {
+      direction: input;
+    }
+    pin (Z) {
+      direction: output;
+      function: "(A&B)|!(C^D)";
+    }
+  }
+)lib",
+                          i);
+  }
+  absl::StrAppend(&text, "}\n");
+  return text;
+}
+
+// Loads a cell library by extracting the functions from a Liberty file, as
+// tools do when given a raw library.
+void BM_LoadFromLiberty(benchmark::State& state) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TempFile lib_file,
+      TempFile::CreateWithContent(MakeLibertyText(state.range(0)), ".lib"));
+  for (auto _ : state) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        auto stream, cell_lib::CharStream::FromPath(lib_file.path().string()));
+    XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto proto, ExtractFunctions(&stream));
+    XLS_ASSERT_OK_AND_ASSIGN(CellLibrary library,
+                             CellLibrary::FromProto(proto));
+    benchmark::DoNotOptimize(library);
+  }
+}
+
+// Loads the same cell library from the preprocessed proto written by
+// function_extractor_main.
+void BM_LoadFromProto(benchmark::State& state) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto stream, cell_lib::CharStream::FromText(
+                       MakeLibertyText(state.range(0))));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto lib_proto,
+                           ExtractFunctions(&stream));
+  AddTruthTables(&lib_proto);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TempFile proto_file,
+      TempFile::CreateWithContent(lib_proto.SerializeAsString(), ".pb"));
+  for (auto _ : state) {
+    XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto proto,
+                             ReadCellLibraryProto(proto_file.path()));
+    XLS_ASSERT_OK_AND_ASSIGN(CellLibrary library,
+                             CellLibrary::FromProto(proto));
+    benchmark::DoNotOptimize(library);
+  }
+}
+
+BENCHMARK(BM_LoadFromLiberty)->Range(16, 4096);
+BENCHMARK(BM_LoadFromProto)->Range(16, 4096);
+
 }  // namespace
 }  // namespace function
 }  // namespace netlist
@@ -15,7 +15,6 @@
 #include "xls/netlist/lib_parser.h"
 
 #include <cctype>
-#include <fstream>
 #include <memory>
 #include <optional>
 #include <string>
@@ -25,8 +24,11 @@
 
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "xls/common/file/mapped_file.h"
 
 namespace xls {
 namespace netlist {
@@ -34,12 +36,12 @@ namespace cell_lib {
 
 /* static */ absl::StatusOr<CharStream> CharStream::FromPath(
     std::string_view path) {
-  std::ifstream file_stream{std::string(path)};
-  if (file_stream.is_open()) {
-    return CharStream(std::move(file_stream));
+  absl::StatusOr<MappedFile> file = MappedFile::Open(path);
+  if (!file.ok()) {
+    return absl::NotFoundError(absl::StrCat(
+        "Could not open file at path: ", path, ": ", file.status().message()));
   }
-  return absl::NotFoundError(
-      absl::StrCat("Could not open file at path: ", path));
+  return CharStream(*std::move(file));
 }
 
 /* static */ absl::StatusOr<CharStream> CharStream::FromText(std::string text) {
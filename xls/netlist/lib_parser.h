@@ -21,7 +21,6 @@
 #define XLS_NETLIST_LIB_PARSER_H_
 
 #include <cctype>
-#include <fstream>
 #include <memory>
 #include <optional>
 #include <string>
@@ -35,6 +34,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/status/status_macros.h"
 
 namespace xls {
@@ -55,31 +55,18 @@ struct Pos {
 // interface.
 class CharStream {
  public:
+  // Memory-maps the file at `path` rather than reading it onto the heap, so
+  // large libraries are scanned in place.
   static absl::StatusOr<CharStream> FromPath(std::string_view path);
   static absl::StatusOr<CharStream> FromText(std::string text);
 
-  ~CharStream() {
-    if (if_.has_value()) {
-      if_->close();
-    }
-  }
-
   CharStream(CharStream&& other) = default;
 
   Pos GetPos() const { return pos_; }
-  bool AtEof() const {
-    if (if_.has_value()) {
-      return if_->eof();
-    }
-    return cursor_ >= text_.size();
-  }
-  char PeekCharOrDie() {
-    if (if_.has_value()) {
-      DCHECK(!if_->eof());
-      return if_->peek();
-    }
-    DCHECK_LT(cursor_, text_.size());
-    return text_[cursor_];
+  bool AtEof() const { return cursor_ >= contents().size(); }
+  char PeekCharOrDie() const {
+    DCHECK_LT(cursor_, contents().size());
+    return contents()[cursor_];
   }
   char PopCharOrDie() {
     char c = PeekCharOrDie();
@@ -115,10 +102,14 @@ class CharStream {
   }
 
  private:
-  explicit CharStream(std::ifstream file_stream)
-      : if_(std::move(file_stream)) {}
+  explicit CharStream(MappedFile file)
+      : file_(std::make_unique<MappedFile>(std::move(file))) {}
   explicit CharStream(std::string text) : text_(std::move(text)) {}
 
+  std::string_view contents() const {
+    return file_ != nullptr ? file_->contents() : std::string_view(text_);
+  }
+
   void Unget(char c) {
     cursor_--;
     if (c == '\n') {
@@ -127,9 +118,6 @@ class CharStream {
     } else {
       pos_.colno--;
     }
-    if (if_.has_value()) {
-      if_->unget();
-    }
   }
 
   void BumpPos(char c) {
@@ -145,12 +133,8 @@ class CharStream {
 
   Pos pos_ = {0, 0};
 
-  // We have both ifstream mode and text mode data, we store both inline.
-
-  // ifstream mode
-  std::optional<std::ifstream> if_;
-
-  // text mode
+  // Exactly one of the mapped file or the text holds the contents.
+  std::unique_ptr<MappedFile> file_;
   std::string text_;
   int64_t cursor_ = 0;
   int64_t last_colno_ = 0;
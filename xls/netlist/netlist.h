@@ -27,6 +27,7 @@
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -476,9 +477,12 @@ class AbstractModule {
   absl::flat_hash_map<AbstractNetRef<EvalT>, AbstractNetRef<EvalT>>
       assign_nets_;
   std::vector<std::unique_ptr<AbstractNetDef<EvalT>>> nets_;
-  absl::flat_hash_map<std::string, AbstractNetRef<EvalT>> name_to_netref_;
+  // Name lookup tables. Keys refer to the names held by the (heap-allocated,
+  // and so address-stable) net and cell objects so each name is only stored
+  // once; large netlists have many millions of nets.
+  absl::flat_hash_map<std::string_view, AbstractNetRef<EvalT>> name_to_netref_;
   std::vector<std::unique_ptr<AbstractCell<EvalT>>> cells_;
-  absl::flat_hash_map<std::string, AbstractCell<EvalT>*> name_to_cell_;
+  absl::flat_hash_map<std::string_view, AbstractCell<EvalT>*> name_to_cell_;
   AbstractNetRef<EvalT> zero_;
   AbstractNetRef<EvalT> one_;
   AbstractNetRef<EvalT> dummy_;
@@ -595,9 +599,9 @@ absl::StatusOr<AbstractCell<EvalT>*> AbstractModule<EvalT>::AddCell(
         absl::StrCat("Module already has a cell with name: ", cell.name()));
   }
 
-  cells_.push_back(std::make_unique<AbstractCell<EvalT>>(cell));
+  cells_.push_back(std::make_unique<AbstractCell<EvalT>>(std::move(cell)));
   auto cell_ptr = cells_.back().get();
-  name_to_cell_[cell.name()] = cell_ptr;
+  name_to_cell_[cell_ptr->name()] = cell_ptr;
   return cell_ptr;
 }
 
@@ -616,7 +620,7 @@ absl::Status AbstractModule<EvalT>::AddNetDecl(NetDeclKind kind,
 
   nets_.emplace_back(std::make_unique<AbstractNetDef<EvalT>>(name, kind));
   AbstractNetRef<EvalT> ref = nets_.back().get();
-  name_to_netref_[name] = ref;
+  name_to_netref_[ref->name()] = ref;
   switch (kind) {
     case NetDeclKind::kInput:
       input_nets_.push_back(ref);
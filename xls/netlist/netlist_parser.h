@@ -17,14 +17,17 @@
 
 #include <sys/types.h>
 
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -135,13 +138,21 @@ class AbstractParser {
  public:
   // Parses a netlist with the given cell library and token scanner.
   // Returns a status on parse error.
+  //
+  // If `top_module` is given, only that module and the modules it
+  // (transitively) instantiates are built; the other modules are tokenized to
+  // find their extents but no nets or cells are created for them. This keeps
+  // memory proportional to the design of interest when a netlist holds many
+  // unrelated modules. Returns NotFoundError if there is no such module.
   static absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>> ParseNetlist(
       AbstractCellLibrary<EvalT>* cell_library, Scanner* scanner, EvalT zero,
-      EvalT one);
+      EvalT one, std::optional<std::string_view> top_module = std::nullopt);
   template <typename = std::is_constructible<EvalT, bool>>
   static absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>> ParseNetlist(
-      AbstractCellLibrary<EvalT>* cell_library, Scanner* scanner) {
-    return ParseNetlist(cell_library, scanner, EvalT{false}, EvalT{true});
+      AbstractCellLibrary<EvalT>* cell_library, Scanner* scanner,
+      std::optional<std::string_view> top_module = std::nullopt) {
+    return ParseNetlist(cell_library, scanner, EvalT{false}, EvalT{true},
+                        top_module);
   }
 
  private:
@@ -238,6 +249,21 @@ class AbstractParser {
   absl::StatusOr<std::unique_ptr<AbstractModule<EvalT>>> ParseModule(
       AbstractNetlist<EvalT>& netlist);
 
+  // The location of a module definition in the token stream along with the
+  // names of the cells and modules it instantiates.
+  struct ModuleExtent {
+    std::string name;
+    // Scanner state positioned at the module's "module" keyword.
+    Scanner start;
+    absl::flat_hash_set<std::string> instantiated;
+  };
+
+  // Scans all remaining module definitions without building them.
+  absl::StatusOr<std::vector<ModuleExtent>> ScanModules();
+
+  // Pops tokens up to and including the next semicolon.
+  absl::Status SkipPastSemicolon();
+
   // Parses a reference to an already- declared net.
   absl::StatusOr<AbstractNetRef<EvalT>> ParseNetRef(
       AbstractModule<EvalT>* module);
@@ -777,15 +803,90 @@ AbstractParser<EvalT>::ParseModule(AbstractNetlist<EvalT>& netlist) {
   return module;
 }
 
+template <typename EvalT>
+absl::Status AbstractParser<EvalT>::SkipPastSemicolon() {
+  while (true) {
+    XLS_ASSIGN_OR_RETURN(Token token, scanner_->Pop());
+    if (token.kind == TokenKind::kSemicolon) {
+      return absl::OkStatus();
+    }
+  }
+}
+
+template <typename EvalT>
+absl::StatusOr<std::vector<typename AbstractParser<EvalT>::ModuleExtent>>
+AbstractParser<EvalT>::ScanModules() {
+  std::vector<ModuleExtent> extents;
+  while (!scanner_->AtEof()) {
+    ModuleExtent extent{.start = *scanner_};
+    XLS_RETURN_IF_ERROR(DropKeywordOrError("module"));
+    XLS_ASSIGN_OR_RETURN(extent.name, PopNameOrError());
+    // Port list.
+    XLS_RETURN_IF_ERROR(SkipPastSemicolon());
+    // Every module statement is terminated by a semicolon; the ones which are
+    // not declarations start with the name of the instantiated cell.
+    while (!TryDropKeyword("endmodule")) {
+      XLS_ASSIGN_OR_RETURN(std::string name, PopNameOrError());
+      if (name != "input" && name != "output" && name != "wire" &&
+          name != "assign") {
+        extent.instantiated.insert(std::move(name));
+      }
+      XLS_RETURN_IF_ERROR(SkipPastSemicolon());
+    }
+    extents.push_back(std::move(extent));
+  }
+  return extents;
+}
+
 template <typename EvalT>
 absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>>
-AbstractParser<EvalT>::ParseNetlist(AbstractCellLibrary<EvalT>* cell_library,
-                                    Scanner* scanner, EvalT zero, EvalT one) {
+AbstractParser<EvalT>::ParseNetlist(
+    AbstractCellLibrary<EvalT>* cell_library, Scanner* scanner, EvalT zero,
+    EvalT one, std::optional<std::string_view> top_module) {
   auto netlist = std::make_unique<AbstractNetlist<EvalT>>();
   AbstractParser<EvalT> p(cell_library, scanner, zero, one);
-  while (!scanner->AtEof()) {
+  if (!top_module.has_value()) {
+    while (!scanner->AtEof()) {
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<AbstractModule<EvalT>> module,
+                           p.ParseModule(*netlist));
+      netlist->AddModule(std::move(module));
+    }
+    return std::move(netlist);
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::vector<ModuleExtent> extents, p.ScanModules());
+  absl::flat_hash_map<std::string_view, const ModuleExtent*> name_to_extent;
+  for (const ModuleExtent& extent : extents) {
+    name_to_extent.emplace(extent.name, &extent);
+  }
+  if (!name_to_extent.contains(*top_module)) {
+    return absl::NotFoundError(
+        absl::StrCat("Could not find top module: ", *top_module));
+  }
+  absl::flat_hash_set<std::string_view> reachable = {*top_module};
+  std::vector<std::string_view> worklist = {*top_module};
+  while (!worklist.empty()) {
+    const ModuleExtent* extent = name_to_extent.at(worklist.back());
+    worklist.pop_back();
+    for (const std::string& name : extent->instantiated) {
+      // Names without a module definition are cell library entries.
+      if (name_to_extent.contains(name) && reachable.insert(name).second) {
+        worklist.push_back(name);
+      }
+    }
+  }
+
+  // Modules are parsed in file order since a module must be defined before it
+  // is instantiated.
+  for (const ModuleExtent& extent : extents) {
+    if (!reachable.contains(extent.name)) {
+      continue;
+    }
+    Scanner module_scanner = extent.start;
+    AbstractParser<EvalT> module_parser(cell_library, &module_scanner, zero,
+                                        one);
     XLS_ASSIGN_OR_RETURN(std::unique_ptr<AbstractModule<EvalT>> module,
-                         p.ParseModule(*netlist));
+                         module_parser.ParseModule(*netlist));
     netlist->AddModule(std::move(module));
   }
   return std::move(netlist);
@@ -444,6 +444,55 @@ endmodule)";
   TestAssignHelper(m);
 }
 
+TEST(NetlistParserTest, ParseReachableFromTopModule) {
+  // `unused` instantiates a cell which is not in the library; it must not be
+  // built when parsing from `main`.
+  std::string netlist = R"(module inverter(a, z);
+  input a;
+  output z;
+  INV inv_0(.A(a), .ZN(z));
+endmodule
+module unused(a, z);
+  input a;
+  output z;
+  NOT_A_CELL c(.A(a), .Z(z));
+endmodule
+module main(a, z);
+  input a;
+  output z;
+  wire w;
+  inverter i0(.a(a), .z(w));
+  inverter i1(.a(w), .z(z));
+endmodule)";
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  {
+    Scanner scanner(netlist);
+    EXPECT_THAT(Parser::ParseNetlist(&cell_library, &scanner),
+                StatusIs(absl::StatusCode::kNotFound));
+  }
+
+  Scanner scanner(netlist);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Netlist> n,
+      Parser::ParseNetlist(&cell_library, &scanner, "main"));
+  EXPECT_EQ(n->modules().size(), 2);
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* m, n->GetModule("main"));
+  EXPECT_EQ(m->cells().size(), 2);
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* inverter, n->GetModule("inverter"));
+  XLS_ASSERT_OK_AND_ASSIGN(Cell * c, m->ResolveCell("i0"));
+  EXPECT_EQ(c->cell_library_entry(), inverter->AsCellLibraryEntry());
+  EXPECT_FALSE(n->MaybeGetModule("unused").has_value());
+}
+
+TEST(NetlistParserTest, ParseMissingTopModule) {
+  std::string netlist = R"(module main(); endmodule)";
+  Scanner scanner(netlist);
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  EXPECT_THAT(Parser::ParseNetlist(&cell_library, &scanner, "other"),
+              StatusIs(absl::StatusCode::kNotFound,
+                       HasSubstr("Could not find top module: other")));
+}
+
 }  // namespace
 }  // namespace rtl
 }  // namespace netlist
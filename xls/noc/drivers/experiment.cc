@@ -15,14 +15,28 @@
 #include "xls/noc/drivers/experiment.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "absl/types/variant.h"
+#include "google/protobuf/util/message_differencer.h"
+#include "xls/common/thread.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/global_routing_table.h"
 #include "xls/noc/simulation/network_graph.h"
@@ -133,29 +147,47 @@ absl::Status ExperimentMetrics::DebugDump() const {
   return absl::OkStatus();
 }
 
-absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
-    const ExperimentConfig& experiment_config,
-    DistributedRoutingTableBuilderBase&& distributed_routing_table_builder)
-    const {
+absl::StatusOr<std::unique_ptr<ExperimentNetwork>> ExperimentNetwork::Build(
+    const NetworkConfigProto& network_config,
+    DistributedRoutingTableBuilderBase& distributed_routing_table_builder) {
   // Build and assign simulation objects.
-  NetworkManager graph;
-  NocParameters params;
-
+  auto network = absl::WrapUnique(new ExperimentNetwork());
   XLS_RETURN_IF_ERROR(BuildNetworkGraphFromProto(
-      experiment_config.GetNetworkConfig(), &graph, &params));
+      network_config, &network->graph_, &network->params_));
 
   // Create global routing table.
   XLS_ASSIGN_OR_RETURN(
-      DistributedRoutingTable routing_table,
+      network->routing_table_,
       distributed_routing_table_builder.BuildNetworkRoutingTables(
-          graph.GetNetworkIds()[0], graph, params));
+          network->graph_.GetNetworkIds()[0], network->graph_,
+          network->params_));
+
+  return network;
+}
+
+absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
+    const ExperimentConfig& experiment_config,
+    DistributedRoutingTableBuilderBase&& distributed_routing_table_builder)
+    const {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ExperimentNetwork> network,
+      ExperimentNetwork::Build(experiment_config.GetNetworkConfig(),
+                               distributed_routing_table_builder));
+  return RunExperimentOnNetwork(*network,
+                                experiment_config.GetTrafficConfig());
+}
+
+absl::StatusOr<ExperimentData> ExperimentRunner::RunExperimentOnNetwork(
+    ExperimentNetwork& network,
+    const NocTrafficManager& traffic_manager) const {
+  NetworkManager& graph = network.GetGraph();
+  NocParameters& params = network.GetParams();
+  DistributedRoutingTable& routing_table = network.GetRoutingTable();
 
   // Build traffic model.
   RandomNumberInterface rnd;
   rnd.SetSeed(seed_);
 
-  const NocTrafficManager& traffic_manager =
-      experiment_config.GetTrafficConfig();
   XLS_ASSIGN_OR_RETURN(TrafficModeId mode_id,
                        traffic_manager.GetTrafficModeIdByName(mode_name_));
   XLS_ASSIGN_OR_RETURN(
@@ -201,14 +233,19 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
   for (int64_t i = 0; i < traffic_injector.FlowCount(); ++i) {
     TrafficFlowId flow_id = traffic_injector.GetTrafficFlows().at(i);
 
+    std::string_view flow_name =
+        traffic_manager.GetTrafficFlow(flow_id).GetName();
     std::string metric_name =
-        absl::StrFormat("Flow:%s:TrafficRateInMiBps",
-                        traffic_manager.GetTrafficFlow(flow_id).GetName());
+        absl::StrFormat("Flow:%s:TrafficRateInMiBps", flow_name);
 
     double traffic_rate =
         traffic_injector.MeasuredTrafficRateInMiBps(cycle_time_in_ps_, i);
 
     metrics.SetFloatMetric(metric_name, traffic_rate);
+    metrics.SetIntegerMetric(absl::StrFormat("Flow:%s:PacketCount", flow_name),
+                             traffic_injector.MeasuredPacketCount(i));
+    metrics.SetIntegerMetric(absl::StrFormat("Flow:%s:BitsSent", flow_name),
+                             traffic_injector.MeasuredBitsSent(i));
   }
 
   for (NetworkComponentId sink_id :
@@ -324,4 +361,111 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
   return experiment_data;
 }
 
+absl::StatusOr<std::vector<ExperimentData>> Experiment::RunPoints(
+    absl::Span<const ExperimentSweepPoint> points, int64_t thread_count,
+    DistributedRoutingTableBuilderBase&& distributed_routing_table_builder)
+    const {
+  XLS_RET_CHECK_GE(thread_count, 1);
+
+  // Create the config of each step and build a network for each distinct
+  // network config.
+  // Configs are kept in a node map as the networks refer to their protos.
+  absl::node_hash_map<int64_t, ExperimentConfig> step_configs;
+  absl::flat_hash_map<int64_t, ExperimentNetwork*> step_networks;
+  std::vector<std::pair<const NetworkConfigProto*, ExperimentNetwork*>>
+      distinct_networks;
+  std::vector<std::unique_ptr<ExperimentNetwork>> networks;
+  for (const ExperimentSweepPoint& point : points) {
+    if (step_configs.contains(point.step)) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(ExperimentConfig config, GetConfigForStep(point.step));
+    const ExperimentConfig& step_config =
+        step_configs.emplace(point.step, std::move(config)).first->second;
+
+    auto it = std::find_if(
+        distinct_networks.begin(), distinct_networks.end(),
+        [&](const std::pair<const NetworkConfigProto*, ExperimentNetwork*>&
+                entry) {
+          return google::protobuf::util::MessageDifferencer::Equals(
+              *entry.first, step_config.GetNetworkConfig());
+        });
+    if (it != distinct_networks.end()) {
+      step_networks[point.step] = it->second;
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        networks.emplace_back(),
+        ExperimentNetwork::Build(step_config.GetNetworkConfig(),
+                                 distributed_routing_table_builder));
+    step_networks[point.step] = networks.back().get();
+    distinct_networks.push_back(
+        {&step_config.GetNetworkConfig(), networks.back().get()});
+  }
+  VLOG(1) << absl::StreamFormat(
+      "Running %d points with %d distinct networks on %d threads",
+      points.size(), networks.size(), thread_count);
+
+  // Threads take the next point to run until all points have been run.
+  std::vector<absl::StatusOr<ExperimentData>> results(
+      points.size(), absl::UnknownError("Point was not run"));
+  std::atomic<int64_t> next_point = 0;
+  auto run_points = [&]() {
+    for (int64_t i = next_point++; i < points.size(); i = next_point++) {
+      const ExperimentSweepPoint& point = points[i];
+      ExperimentRunner runner = runner_;
+      if (point.seed.has_value()) {
+        runner.SetSimulationSeed(*point.seed);
+      }
+      results[i] = runner.RunExperimentOnNetwork(
+          *step_networks.at(point.step),
+          step_configs.at(point.step).GetTrafficConfig());
+    }
+  };
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 1; i < std::min<int64_t>(thread_count, points.size());
+         ++i) {
+      threads.push_back(std::make_unique<Thread>(run_points));
+    }
+    run_points();
+  }
+
+  std::vector<ExperimentData> data;
+  data.reserve(points.size());
+  for (absl::StatusOr<ExperimentData>& result : results) {
+    XLS_RETURN_IF_ERROR(result.status());
+    data.push_back(*std::move(result));
+  }
+  return data;
+}
+
+ExperimentMetrics AggregateFlowMetrics(absl::Span<const ExperimentData> data) {
+  ExperimentMetrics aggregate;
+  absl::btree_map<std::string, int64_t> integer_sums;
+  absl::btree_map<std::string, double> float_sums;
+  for (const ExperimentData& d : data) {
+    for (const auto& [name, value] : d.metrics.GetIntegerMetrics()) {
+      if (absl::StartsWith(name, "Flow:") &&
+          (absl::EndsWith(name, ":PacketCount") ||
+           absl::EndsWith(name, ":BitsSent"))) {
+        integer_sums[name] += value;
+      }
+    }
+    for (const auto& [name, value] : d.metrics.GetFloatMetrics()) {
+      if (absl::StartsWith(name, "Flow:") &&
+          absl::EndsWith(name, ":TrafficRateInMiBps")) {
+        float_sums[name] += value;
+      }
+    }
+  }
+  for (const auto& [name, sum] : integer_sums) {
+    aggregate.SetIntegerMetric(name, sum);
+  }
+  for (const auto& [name, sum] : float_sums) {
+    aggregate.SetFloatMetric(name, sum / static_cast<double>(data.size()));
+  }
+  return aggregate;
+}
+
 }  // namespace xls::noc
@@ -15,8 +15,11 @@
 #ifndef XLS_NOC_DRIVERS_EXPERIMENT_H_
 #define XLS_NOC_DRIVERS_EXPERIMENT_H_
 
+#include <cstdint>
 #include <functional>
 #include <limits>
+#include <memory>
+#include <optional>
 #include <queue>
 #include <string>
 #include <string_view>
@@ -27,12 +30,15 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/global_routing_table.h"
+#include "xls/noc/simulation/network_graph.h"
+#include "xls/noc/simulation/parameters.h"
 #include "xls/noc/simulation/traffic_description.h"
 
 // This file contains classes used to construct different
@@ -141,6 +147,14 @@ class ExperimentMetrics {
     return integer_integer_map_metrics_.at(metric);
   }
 
+  // Returns all integer and floating point metrics.
+  const absl::btree_map<std::string, int64_t>& GetIntegerMetrics() const {
+    return integer_metrics_;
+  }
+  const absl::btree_map<std::string, double>& GetFloatMetrics() const {
+    return float_metrics_;
+  }
+
   // Prints out the metrics and values stored.
   absl::Status DebugDump() const;
 
@@ -213,6 +227,33 @@ struct ExperimentData {
   ExperimentInfo info;
 };
 
+// The network graph, parameters, and routing table of a network config.
+//
+// Once built, the network is only read by the simulation so a single
+// network can be shared by simulations running concurrently.
+class ExperimentNetwork {
+ public:
+  static absl::StatusOr<std::unique_ptr<ExperimentNetwork>> Build(
+      const NetworkConfigProto& network_config,
+      DistributedRoutingTableBuilderBase& distributed_routing_table_builder);
+
+  NetworkManager& GetGraph() { return graph_; }
+  NocParameters& GetParams() { return params_; }
+  DistributedRoutingTable& GetRoutingTable() { return routing_table_; }
+
+ private:
+  ExperimentNetwork() = default;
+
+  // The routing table refers to the graph and parameters so a network is not
+  // movable.
+  ExperimentNetwork(const ExperimentNetwork&) = delete;
+  ExperimentNetwork& operator=(const ExperimentNetwork&) = delete;
+
+  NetworkManager graph_;
+  NocParameters params_;
+  DistributedRoutingTable routing_table_;
+};
+
 // Class to setup and run a single step of the experiment,
 // including the setup and initialization of the traffic model.
 class ExperimentRunner {
@@ -225,6 +266,14 @@ class ExperimentRunner {
       DistributedRoutingTableBuilderBase&& distributed_routing_table_builder =
           DistributedRoutingTableBuilderForTrees()) const;
 
+  // Runs the traffic of an experiment on an already built network.
+  //
+  // Does not modify the network so may be called concurrently with the same
+  // network.
+  absl::StatusOr<ExperimentData> RunExperimentOnNetwork(
+      ExperimentNetwork& network,
+      const NocTrafficManager& traffic_manager) const;
+
   ExperimentRunner& SetSimulationCycleCount(int64_t count) {
     CHECK_GE(count, 0);
     total_simulation_cycle_count_ = count;
@@ -265,6 +314,13 @@ class ExperimentRunner {
 
 class ExperimentBuilderBase;
 
+// A single simulation of an experiment sweep: the config of a step run with
+// a seed (or with the seed of the experiment runner if unset).
+struct ExperimentSweepPoint {
+  int64_t step;
+  std::optional<int16_t> seed;
+};
+
 // A description of an experiment.
 //
 // An experiment is a describes how to configure, run, and
@@ -291,6 +347,17 @@ class Experiment {
                                 std::move(distributed_routing_table_builder));
   }
 
+  // Runs the given points on up to thread_count threads and returns the data
+  // of each point in the order of points.
+  //
+  // The network and routing tables are built once for each distinct network
+  // config among the steps of points and shared by the points using it, so
+  // sweeps over traffic rates and seeds only simulate.
+  absl::StatusOr<std::vector<ExperimentData>> RunPoints(
+      absl::Span<const ExperimentSweepPoint> points, int64_t thread_count,
+      DistributedRoutingTableBuilderBase&& distributed_routing_table_builder =
+          DistributedRoutingTableBuilderForTrees()) const;
+
   // Get the configuration for step N.
   absl::StatusOr<ExperimentConfig> GetConfigForStep(int64_t step) const {
     XLS_RET_CHECK(step >= 0 && step < GetStepCount());
@@ -356,6 +423,13 @@ class ExperimentBuilderBase {
   virtual absl::StatusOr<ExperimentRunner> BuildExperimentRunner() = 0;
 };
 
+// Aggregates the traffic injected by each flow over several simulations
+// (i.e. the points of a sweep over seeds).
+//
+// Sums the Flow:<name>:PacketCount and Flow:<name>:BitsSent metrics and
+// averages the Flow:<name>:TrafficRateInMiBps metrics of data.
+ExperimentMetrics AggregateFlowMetrics(absl::Span<const ExperimentData> data);
+
 namespace internal {
 
 struct PacketInfo {
@@ -14,19 +14,30 @@
 
 #include "xls/noc/drivers/sample_experiments.h"
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "benchmark/benchmark.h"
 #include "xls/common/status/matchers.h"
+#include "xls/noc/drivers/experiment.h"
 #include "xls/noc/drivers/experiment_factory.h"
 
 namespace xls::noc {
 namespace {
 
+using ::xls::status_testing::IsOkAndHolds;
+using ::xls::status_testing::StatusIs;
+
 TEST(SampleExperimentsTest, SimpleVCExperiment) {
   ExperimentFactory experiment_factory;
   XLS_ASSERT_OK(RegisterSampleExperiments(experiment_factory));
@@ -215,5 +226,86 @@ TEST(SampleExperimentsTest, AggregateTreeTest) {
   }
 }
 
+TEST(SampleExperimentsTest, RunPointsInParallel) {
+  ExperimentFactory experiment_factory;
+  XLS_ASSERT_OK(RegisterSampleExperiments(experiment_factory));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Experiment experiment,
+      experiment_factory.BuildExperiment("SimpleVCExperiment"));
+
+  std::vector<ExperimentSweepPoint> points = {
+      {.step = 0}, {.step = 1}, {.step = 0, .seed = 7}};
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<ExperimentData> data,
+                           experiment.RunPoints(points, /*thread_count=*/3));
+  ASSERT_EQ(data.size(), 3);
+
+  // Points are simulated exactly as a step run on its own.
+  XLS_ASSERT_OK_AND_ASSIGN(ExperimentData step0, experiment.RunStep(0));
+  for (std::string_view metric :
+       {"Sink:RecvPort0:FlitCount", "Flow:flow_0:PacketCount",
+        "Flow:flow_1:BitsSent"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(int64_t expected,
+                             step0.metrics.GetIntegerMetric(metric));
+    EXPECT_THAT(data[0].metrics.GetIntegerMetric(metric),
+                IsOkAndHolds(expected));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(double step0_vc1_rate,
+                           step0.metrics.GetFloatMetric(
+                               "Sink:RecvPort0:VC:1:TrafficRateInMiBps"));
+  XLS_ASSERT_OK_AND_ASSIGN(double point1_vc1_rate,
+                           data[1].metrics.GetFloatMetric(
+                               "Sink:RecvPort0:VC:1:TrafficRateInMiBps"));
+  EXPECT_DOUBLE_EQ(step0_vc1_rate, 0.0);
+  EXPECT_EQ(static_cast<int64_t>(point1_vc1_rate) / 100, 20);
+
+  // A different seed injects different traffic.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      int64_t seed7_packets,
+      data[2].metrics.GetIntegerMetric("Flow:flow_0:PacketCount"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      int64_t step0_packets,
+      step0.metrics.GetIntegerMetric("Flow:flow_0:PacketCount"));
+  EXPECT_NE(seed7_packets, step0_packets);
+
+  ExperimentMetrics aggregate =
+      AggregateFlowMetrics(absl::MakeConstSpan(data).subspan(1));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      int64_t point1_packets,
+      data[1].metrics.GetIntegerMetric("Flow:flow_0:PacketCount"));
+  EXPECT_THAT(aggregate.GetIntegerMetric("Flow:flow_0:PacketCount"),
+              IsOkAndHolds(point1_packets + seed7_packets));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      double aggregate_rate,
+      aggregate.GetFloatMetric("Flow:flow_0:TrafficRateInMiBps"));
+  EXPECT_EQ(static_cast<int64_t>(aggregate_rate) / 100, 30);
+  EXPECT_THAT(aggregate.GetIntegerMetric("Sink:RecvPort0:FlitCount"),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
+// Measures the number of simulated cycles per second of the base
+// configuration of each sample experiment.
+void BM_SampleExperiment(benchmark::State& state) {
+  constexpr int64_t kCycleCount = 10'000;
+
+  ExperimentFactory experiment_factory;
+  CHECK_OK(RegisterSampleExperiments(experiment_factory));
+  std::string tag = experiment_factory.ListExperimentTags().at(state.range(0));
+  absl::StatusOr<Experiment> experiment =
+      experiment_factory.BuildExperiment(tag);
+  CHECK_OK(experiment.status());
+  absl::StatusOr<ExperimentConfig> config = experiment->GetConfigForStep(0);
+  CHECK_OK(config.status());
+
+  ExperimentRunner runner = experiment->GetRunner();
+  runner.SetSimulationCycleCount(kCycleCount);
+  for (auto _ : state) {
+    CHECK_OK(runner.RunExperiment(*config).status());
+  }
+  state.SetLabel(tag);
+  state.counters["cycles_per_second"] = benchmark::Counter(
+      kCycleCount, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_SampleExperiment)->DenseRange(0, 1)->Unit(benchmark::kMillisecond);
+
 }  // namespace
 }  // namespace xls::noc
@@ -14,6 +14,7 @@
 
 #include "xls/noc/simulation/global_routing_table.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <ostream>
 #include <queue>
@@ -682,5 +683,213 @@ absl::Status DistributedRoutingTableBuilderForMultiplePaths::AddRoutes(
   return absl::OkStatus();
 }
 
+// DistributedRoutingTableBuilderForShortestPaths
+namespace {
+
+// The connectivity of a network in compressed sparse row form.
+//
+// Components are numbered by their index in the network and the ports of
+// component c are numbered from port_start[c].
+struct UpstreamGraph {
+  // The k-th input port of component c is input_ports[input_start[c] + k]
+  // and is driven by the output port upstream_ports[input_start[c] + k], or
+  // PortId::kInvalid if the input port is not connected.
+  std::vector<int64_t> input_start;
+  std::vector<PortId> input_ports;
+  std::vector<PortId> upstream_ports;
+
+  std::vector<int64_t> port_start;
+  std::vector<int64_t> vc_count;
+
+  int64_t PortIndex(PortId port) const {
+    return port_start[port.GetNetworkComponentId().id()] + port.id();
+  }
+};
+
+absl::StatusOr<UpstreamGraph> BuildUpstreamGraph(
+    Network& network, const NocParameters& network_parameters) {
+  UpstreamGraph graph;
+  int64_t component_count = network.GetNetworkComponentCount();
+  graph.input_start.reserve(component_count + 1);
+  graph.port_start.reserve(component_count + 1);
+  for (int64_t c = 0; c < component_count; ++c) {
+    const NetworkComponent& nc = network.GetNetworkComponentByIndex(c);
+    graph.input_start.push_back(graph.input_ports.size());
+    graph.port_start.push_back(graph.vc_count.size());
+    for (int64_t i = 0; i < nc.GetPortCount(); ++i) {
+      const Port& port = nc.GetPortByIndex(i);
+      XLS_ASSIGN_OR_RETURN(PortParam port_param,
+                           network_parameters.GetPortParam(port.id()));
+      graph.vc_count.push_back(port_param.VirtualChannelCount());
+      if (port.direction() != PortDirection::kInput) {
+        continue;
+      }
+      graph.input_ports.push_back(port.id());
+      graph.upstream_ports.push_back(
+          port.connection().IsValid()
+              ? network.GetConnection(port.connection()).src()
+              : PortId::kInvalid);
+    }
+  }
+  graph.input_start.push_back(graph.input_ports.size());
+  graph.port_start.push_back(graph.vc_count.size());
+  return graph;
+}
+
+absl::Status InvalidPortError(NetworkComponentId nc_id,
+                              const NocParameters& network_parameters) {
+  XLS_ASSIGN_OR_RETURN(NetworkComponentParam nc_param,
+                       network_parameters.GetNetworkComponentParam(nc_id));
+  return absl::FailedPreconditionError(absl::StrFormat(
+      "%s has an invalid port.",
+      absl::visit([](const auto& nc) { return nc.GetName(); }, nc_param)));
+}
+
+}  // namespace
+
+absl::StatusOr<DistributedRoutingTable>
+DistributedRoutingTableBuilderForShortestPaths::BuildNetworkRoutingTables(
+    NetworkId network_id, NetworkManager& network_manager,
+    NocParameters& network_parameters) {
+  DistributedRoutingTable routing_table;
+
+  routing_table.network_manager_ = &network_manager;
+  routing_table.network_parameters_ = &network_parameters;
+
+  XLS_RET_CHECK_OK(BuildNetworkInterfaceIndices(network_id, &routing_table));
+  XLS_RET_CHECK_OK(
+      BuildPortAndVirtualChannelIndices(network_id, &routing_table));
+  XLS_RET_CHECK_OK(BuildRoutingTable(network_id, &routing_table));
+
+  return routing_table;
+}
+
+absl::Status DistributedRoutingTableBuilderForShortestPaths::BuildRoutingTable(
+    NetworkId network_id, DistributedRoutingTable* routing_table) {
+  NocParameters* network_parameters = routing_table->network_parameters_;
+  Network& network = routing_table->network_manager_->GetNetwork(network_id);
+  int64_t component_count = network.GetNetworkComponentCount();
+
+  routing_table->AllocateTableForNetwork(network_id, component_count);
+
+  XLS_ASSIGN_OR_RETURN(UpstreamGraph graph,
+                       BuildUpstreamGraph(network, *network_parameters));
+
+  // State of the search, valid for the ports and components whose stamp is
+  // the index of the current sink.
+  std::vector<int64_t> port_stamp(graph.vc_count.size(), -1);
+  std::vector<int64_t> component_stamp(component_count, -1);
+  std::vector<int64_t> component_level(component_count);
+  // The output ports through which a component reaches the sink with the
+  // fewest hops, in the order they were found.
+  std::vector<std::vector<PortId>> component_routes(component_count);
+  std::vector<int64_t> reached_components;
+  std::vector<PortId> frontier;
+  std::vector<PortId> next_frontier;
+
+  const NetworkComponentIndexMap& sink_indices =
+      routing_table->GetSinkIndices();
+
+  // Algorithm:
+  //  For each sink
+  //   Perform BFS to srcs, one level of output ports at a time
+  //   Route from each router reached through the ports of its first level
+  for (int64_t dest = 0; dest < sink_indices.NetworkComponentCount(); ++dest) {
+    XLS_ASSIGN_OR_RETURN(NetworkComponentId sink_id,
+                         sink_indices.GetNetworkComponentByIndex(dest));
+    reached_components.clear();
+    frontier.clear();
+    for (int64_t i = graph.input_start[sink_id.id()];
+         i < graph.input_start[sink_id.id() + 1]; ++i) {
+      if (graph.upstream_ports[i] == PortId::kInvalid) {
+        return InvalidPortError(sink_id, *network_parameters);
+      }
+      frontier.push_back(graph.upstream_ports[i]);
+    }
+
+    for (int64_t level = 1; !frontier.empty(); ++level) {
+      next_frontier.clear();
+      for (PortId port : frontier) {
+        int64_t& stamp = port_stamp[graph.PortIndex(port)];
+        if (stamp == dest) {
+          continue;
+        }
+        stamp = dest;
+
+        int64_t c = port.GetNetworkComponentId().id();
+        if (component_stamp[c] != dest) {
+          component_stamp[c] = dest;
+          component_level[c] = level;
+          component_routes[c].clear();
+          reached_components.push_back(c);
+        } else if (component_level[c] < level) {
+          continue;
+        }
+        component_routes[c].push_back(port);
+
+        for (int64_t i = graph.input_start[c]; i < graph.input_start[c + 1];
+             ++i) {
+          if (graph.upstream_ports[i] == PortId::kInvalid) {
+            return InvalidPortError(port.GetNetworkComponentId(),
+                                    *network_parameters);
+          }
+          next_frontier.push_back(graph.upstream_ports[i]);
+        }
+      }
+      std::swap(frontier, next_frontier);
+    }
+
+    // Assign the input ports of each router to its output ports round robin.
+    for (int64_t c : reached_components) {
+      const NetworkComponent& nc = network.GetNetworkComponentByIndex(c);
+      if (nc.kind() != NetworkComponentKind::kRouter) {
+        continue;
+      }
+      const std::vector<PortId>& output_port_ids = component_routes[c];
+      DistributedRoutingTable::RouterRoutingTable& table =
+          routing_table->GetRoutingTable(nc.id());
+      table.routes.resize(nc.GetPortCount());
+      for (int64_t i = graph.input_start[c]; i < graph.input_start[c + 1];
+           ++i) {
+        int64_t input_index = i - graph.input_start[c];
+        PortId input_port_id = graph.input_ports[i];
+        PortId output_port_id =
+            output_port_ids[input_index % output_port_ids.size()];
+        int64_t input_port_vc_count =
+            graph.vc_count[graph.PortIndex(input_port_id)];
+        int64_t output_port_vc_count =
+            graph.vc_count[graph.PortIndex(output_port_id)];
+
+        // TODO(vmirian): 2021-10-11 Support other VC mapping strategies.
+        if (input_port_vc_count != output_port_vc_count) {
+          XLS_ASSIGN_OR_RETURN(PortParam input_port_param,
+                               network_parameters->GetPortParam(input_port_id));
+          XLS_ASSIGN_OR_RETURN(
+              PortParam output_port_param,
+              network_parameters->GetPortParam(output_port_id));
+          return absl::UnimplementedError(absl::StrFormat(
+              "VC route inference is unimplemented "
+              " when vc count changes on path between"
+              " port %s and port %s",
+              input_port_param.GetName(), output_port_param.GetName()));
+        }
+
+        // VCs are mapped in-order, with a single default vc used for ports
+        // without vcs.
+        int64_t vc_count = std::max<int64_t>(input_port_vc_count, 1);
+        std::vector<DistributedRoutingTable::PortRoutingList>& port_routes =
+            table.routes[input_port_id.id()];
+        port_routes.resize(vc_count);
+        for (int64_t vc = 0; vc < vc_count; ++vc) {
+          port_routes[vc].emplace_back(dest,
+                                       PortAndVCIndex{output_port_id, vc});
+        }
+      }
+    }
+  }
+
+  return absl::OkStatus();
+}
+
 }  // namespace noc
 }  // namespace xls
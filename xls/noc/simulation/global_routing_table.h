@@ -127,6 +127,7 @@ class DistributedRoutingTable {
   friend class DistributedRoutingTableBuilderBase;
   friend class DistributedRoutingTableBuilderForTrees;
   friend class DistributedRoutingTableBuilderForMultiplePaths;
+  friend class DistributedRoutingTableBuilderForShortestPaths;
 
   // Resize routing_tables to accommodate the number of networks and
   // number of components in a network.
@@ -245,6 +246,29 @@ class DistributedRoutingTableBuilderForMultiplePaths
       DistributedRoutingTable* routing_table);
 };
 
+// Builds the same routing table as
+// DistributedRoutingTableBuilderForMultiplePaths but scales to networks with
+// thousands of routers.
+//
+// The connectivity of the network is first flattened into a compressed sparse
+// row (CSR) form along with the vc count of each port.  The breadth-first
+// search from each sink then runs over those arrays, marking visited ports and
+// components with the index of the current sink instead of filling hash sets,
+// so each search is linear in the size of the network and allocates nothing
+// once warm.
+class DistributedRoutingTableBuilderForShortestPaths
+    : public DistributedRoutingTableBuilderBase {
+ public:
+  absl::StatusOr<DistributedRoutingTable> BuildNetworkRoutingTables(
+      NetworkId network_id, NetworkManager& network_manager,
+      NocParameters& network_parameters) override;
+
+ private:
+  // Trace and setup routing table using a BFS from each sink.
+  absl::Status BuildRoutingTable(NetworkId network_id,
+                                 DistributedRoutingTable* routing_table);
+};
+
 }  // namespace noc
 }  // namespace xls
 
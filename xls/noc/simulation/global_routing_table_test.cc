@@ -14,16 +14,29 @@
 
 #include "xls/noc/simulation/global_routing_table.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "absl/types/variant.h"
+#include "benchmark/benchmark.h"
 #include "xls/common/status/matchers.h"
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/config/network_config_proto_builder.h"
+#include "xls/noc/simulation/common.h"
+#include "xls/noc/simulation/network_graph.h"
+#include "xls/noc/simulation/parameters.h"
 #include "xls/noc/simulation/network_graph_builder.h"
 #include "xls/noc/simulation/sample_network_graphs.h"
 
@@ -625,6 +638,203 @@ TEST(GlobalRoutingTableTest, MultiplePathsBetweenRoutersWithLoop1) {
                                               linkbo1_id, recvport3));
 }
 
+// Returns a k x k mesh where each router is connected to its neighbors as
+// well as to a send and a receive port.
+absl::StatusOr<NetworkConfigProto> BuildMeshNetworkConfig(int64_t k) {
+  NetworkConfigProtoBuilder builder("Mesh");
+  builder.WithVirtualChannel("VC0").WithFlitBitWidth(128).WithDepth(4);
+
+  auto router_name = [](int64_t x, int64_t y) {
+    return absl::StrFormat("Router_%d_%d", x, y);
+  };
+  auto add_link = [&](std::string_view src, std::string_view sink) {
+    builder.WithLink(absl::StrFormat("Link_%s_%s", src, sink))
+        .WithSourcePort(src)
+        .WithSinkPort(sink)
+        .WithPhitBitWidth(128)
+        .WithSourceSinkPipelineStage(1)
+        .WithSinkSourcePipelineStage(1);
+  };
+
+  for (int64_t x = 0; x < k; ++x) {
+    for (int64_t y = 0; y < k; ++y) {
+      std::string name = router_name(x, y);
+      std::string send_port = absl::StrFormat("SendPort_%d_%d", x, y);
+      std::string recv_port = absl::StrFormat("RecvPort_%d_%d", x, y);
+      builder.WithPort(send_port).AsInputDirection().WithVirtualChannel("VC0");
+      builder.WithPort(recv_port).AsOutputDirection().WithVirtualChannel(
+          "VC0");
+
+      auto router = builder.WithRouter(name);
+      router.WithInputPort(absl::StrCat(name, "_in")).WithVirtualChannel("VC0");
+      router.WithOutputPort(absl::StrCat(name, "_out"))
+          .WithVirtualChannel("VC0");
+      add_link(send_port, absl::StrCat(name, "_in"));
+      add_link(absl::StrCat(name, "_out"), recv_port);
+
+      // Ports towards and from each neighbor.
+      for (auto [dx, dy] : {std::pair{-1, 0}, {1, 0}, {0, -1}, {0, 1}}) {
+        int64_t nx = x + dx;
+        int64_t ny = y + dy;
+        if (nx < 0 || nx >= k || ny < 0 || ny >= k) {
+          continue;
+        }
+        std::string neighbor = router_name(nx, ny);
+        router.WithInputPort(absl::StrCat(name, "_from_", neighbor))
+            .WithVirtualChannel("VC0");
+        router.WithOutputPort(absl::StrCat(name, "_to_", neighbor))
+            .WithVirtualChannel("VC0");
+      }
+    }
+  }
+  for (int64_t x = 0; x < k; ++x) {
+    for (int64_t y = 0; y < k; ++y) {
+      std::string name = router_name(x, y);
+      if (x + 1 < k) {
+        std::string neighbor = router_name(x + 1, y);
+        add_link(absl::StrCat(name, "_to_", neighbor),
+                 absl::StrCat(neighbor, "_from_", name));
+        add_link(absl::StrCat(neighbor, "_to_", name),
+                 absl::StrCat(name, "_from_", neighbor));
+      }
+      if (y + 1 < k) {
+        std::string neighbor = router_name(x, y + 1);
+        add_link(absl::StrCat(name, "_to_", neighbor),
+                 absl::StrCat(neighbor, "_from_", name));
+        add_link(absl::StrCat(neighbor, "_to_", name),
+                 absl::StrCat(name, "_from_", neighbor));
+      }
+    }
+  }
+  return builder.Build();
+}
+
+// Expects that both tables route every vc of every router input port to the
+// same output port and vc for every destination.
+void ExpectSameRouterTables(NetworkId network_id, NetworkManager& graph,
+                            NocParameters& params,
+                            DistributedRoutingTable& expected,
+                            DistributedRoutingTable& actual) {
+  int64_t sink_count = expected.GetSinkIndices().NetworkComponentCount();
+  ASSERT_EQ(actual.GetSinkIndices().NetworkComponentCount(), sink_count);
+
+  Network& network = graph.GetNetwork(network_id);
+  for (const NetworkComponent& nc : network.GetNetworkComponents()) {
+    if (nc.kind() != NetworkComponentKind::kRouter) {
+      continue;
+    }
+    for (PortId input_port : nc.GetInputPortIds()) {
+      XLS_ASSERT_OK_AND_ASSIGN(PortParam port_param,
+                               params.GetPortParam(input_port));
+      int64_t vc_count = std::max<int64_t>(port_param.VirtualChannelCount(), 1);
+      for (int64_t vc = 0; vc < vc_count; ++vc) {
+        for (int64_t dest = 0; dest < sink_count; ++dest) {
+          absl::StatusOr<PortAndVCIndex> expected_hop =
+              expected.GetRouterOutputPortByIndex({input_port, vc}, dest);
+          absl::StatusOr<PortAndVCIndex> actual_hop =
+              actual.GetRouterOutputPortByIndex({input_port, vc}, dest);
+          ASSERT_EQ(actual_hop.ok(), expected_hop.ok())
+              << port_param.GetName() << " vc " << vc << " dest " << dest;
+          if (!expected_hop.ok()) {
+            continue;
+          }
+          EXPECT_EQ(actual_hop->port_id_, expected_hop->port_id_)
+              << port_param.GetName() << " vc " << vc << " dest " << dest;
+          EXPECT_EQ(actual_hop->vc_index_, expected_hop->vc_index_)
+              << port_param.GetName() << " vc " << vc << " dest " << dest;
+        }
+      }
+    }
+  }
+}
+
+void ExpectShortestPathsMatchMultiplePaths(NetworkManager& graph,
+                                           NocParameters& params) {
+  ASSERT_EQ(graph.GetNetworkIds().size(), 1);
+  NetworkId network_id = graph.GetNetworkIds()[0];
+
+  DistributedRoutingTableBuilderForMultiplePaths multiple_paths_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable expected,
+                           multiple_paths_builder.BuildNetworkRoutingTables(
+                               network_id, graph, params));
+  DistributedRoutingTableBuilderForShortestPaths shortest_paths_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable actual,
+                           shortest_paths_builder.BuildNetworkRoutingTables(
+                               network_id, graph, params));
+
+  ExpectSameRouterTables(network_id, graph, params, expected, actual);
+}
+
+TEST(GlobalRoutingTableTest, ShortestPathsMatchMultiplePaths) {
+  using BuildFn = absl::Status (*)(NetworkConfigProto*, NetworkManager*,
+                                   NocParameters*);
+  for (BuildFn build :
+       {BuildNetworkGraphLinear000, BuildNetworkGraphLinear001,
+        BuildNetworkGraphTree000, BuildNetworkGraphTree001,
+        BuildNetworkGraphLoop000, BuildNetworkGraphLoop001}) {
+    NetworkConfigProto proto;
+    NetworkManager graph;
+    NocParameters params;
+    XLS_ASSERT_OK(build(&proto, &graph, &params));
+    ExpectShortestPathsMatchMultiplePaths(graph, params);
+  }
+}
+
+TEST(GlobalRoutingTableTest, ShortestPathsMatchMultiplePathsOnMesh) {
+  XLS_ASSERT_OK_AND_ASSIGN(NetworkConfigProto proto, BuildMeshNetworkConfig(5));
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphFromProto(proto, &graph, &params));
+  ExpectShortestPathsMatchMultiplePaths(graph, params);
+
+  // Routes follow the mesh so cross the fewest links.
+  DistributedRoutingTableBuilderForShortestPaths route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                           route_builder.BuildNetworkRoutingTables(
+                               graph.GetNetworkIds()[0], graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId send_port,
+      FindNetworkComponentByName("SendPort_0_0", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId recv_port,
+      FindNetworkComponentByName("RecvPort_4_4", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<NetworkComponentId> route,
+                           routing_table.ComputeRoute(send_port, recv_port));
+  // The send port, 9 routers, 10 links and the recv port.
+  EXPECT_EQ(route.size(), 21);
+}
+
+template <typename RoutingTableBuilder>
+void BM_BuildMeshRoutingTable(benchmark::State& state) {
+  absl::StatusOr<NetworkConfigProto> proto =
+      BuildMeshNetworkConfig(state.range(0));
+  CHECK_OK(proto.status());
+  NetworkManager graph;
+  NocParameters params;
+  CHECK_OK(BuildNetworkGraphFromProto(*proto, &graph, &params));
+  NetworkId network_id = graph.GetNetworkIds()[0];
+
+  for (auto _ : state) {
+    RoutingTableBuilder route_builder;
+    absl::StatusOr<DistributedRoutingTable> routing_table =
+        route_builder.BuildNetworkRoutingTables(network_id, graph, params);
+    CHECK_OK(routing_table.status());
+    benchmark::DoNotOptimize(routing_table);
+  }
+  state.counters["routers"] = state.range(0) * state.range(0);
+}
+
+BENCHMARK_TEMPLATE(BM_BuildMeshRoutingTable,
+                   DistributedRoutingTableBuilderForMultiplePaths)
+    ->RangeMultiplier(2)
+    ->Range(4, 16)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_BuildMeshRoutingTable,
+                   DistributedRoutingTableBuilderForShortestPaths)
+    ->RangeMultiplier(2)
+    ->Range(4, 32)
+    ->Unit(benchmark::kMillisecond);
+
 }  // namespace
 }  // namespace noc
 }  // namespace xls
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <string_view>
 #include <utility>
 #include <variant>
@@ -27,6 +28,8 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/noc/simulation/flit.h"
+#include "xls/noc/simulation/replay_trace.h"
+#include "xls/noc/simulation/traffic_models.h"
 
 namespace xls::noc {
 
@@ -276,13 +279,19 @@ absl::Status NocTrafficInjectorBuilder::BuildPerFlowTrafficModels(
     int64_t vc_index = injector.flows_index_to_vc_index_map_.at(i);
 
     if (flow.IsReplay()) {
-      XLS_ASSIGN_OR_RETURN(
-          std::unique_ptr<ReplayTrafficModel> model,
-          ReplayTrafficModelBuilder(bits_per_packet, flow.GetClockCycleTimes())
-              .SetVCIndex(vc_index)
-              .SetSourceIndex(source_index)
-              .SetDestinationIndex(sink_index)
-              .Build());
+      std::optional<ReplayTrafficModelBuilder> builder;
+      if (flow.GetReplayTracePath().empty()) {
+        builder.emplace(bits_per_packet, flow.GetClockCycleTimes());
+      } else {
+        XLS_ASSIGN_OR_RETURN(std::shared_ptr<const ReplayTrace> trace,
+                             ReplayTrace::Open(flow.GetReplayTracePath()));
+        builder.emplace(bits_per_packet, std::move(trace));
+      }
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<ReplayTrafficModel> model,
+                           builder->SetVCIndex(vc_index)
+                               .SetSourceIndex(source_index)
+                               .SetDestinationIndex(sink_index)
+                               .Build());
       injector.traffic_models_.push_back(std::move(model));
     } else {
       double burst_prob = flow.GetBurstProb();
@@ -102,6 +102,11 @@ class NocTrafficInjector {
     return traffic_model_monitor_[flow_index].MeasuredBitsSent();
   }
 
+  // Get measured packets injected during simulation for a single flow.
+  int64_t MeasuredPacketCount(int64_t flow_index) const {
+    return traffic_model_monitor_[flow_index].MeasuredPacketCount();
+  }
+
  private:
   friend NocTrafficInjectorBuilder;
 
@@ -0,0 +1,89 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/noc/simulation/replay_trace.h"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/algorithm/container.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls::noc {
+
+// Entries are used in place, so the trace byte order must match the host.
+static_assert(std::endian::native == std::endian::little);
+
+absl::StatusOr<std::shared_ptr<const ReplayTrace>> ReplayTrace::Open(
+    const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(MappedFile file, MappedFile::Open(path));
+  std::string_view contents = file.contents();
+  if (contents.size() < kHeaderBytes ||
+      contents.substr(0, sizeof(kMagic)) !=
+          std::string_view(kMagic, sizeof(kMagic))) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("%s is not a replay trace", path.string()));
+  }
+  uint64_t count;
+  std::memcpy(&count, contents.data() + sizeof(kMagic), sizeof(count));
+  int64_t entry_bytes = contents.size() - kHeaderBytes;
+  if (entry_bytes % sizeof(int64_t) != 0 ||
+      entry_bytes / sizeof(int64_t) != count) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Replay trace %s has %d bytes of entries; expected %d entries",
+        path.string(), entry_bytes, count));
+  }
+  const char* entries = contents.data() + kHeaderBytes;
+  // Mappings are page aligned and heap buffers are at least 8-byte aligned.
+  XLS_RET_CHECK_EQ(reinterpret_cast<uintptr_t>(entries) % alignof(int64_t), 0);
+  absl::Span<const int64_t> clock_cycles(
+      reinterpret_cast<const int64_t*>(entries), count);
+  return std::shared_ptr<const ReplayTrace>(
+      new ReplayTrace(std::move(file), clock_cycles));
+}
+
+absl::Status WriteReplayTrace(const std::filesystem::path& path,
+                              absl::Span<const int64_t> clock_cycles) {
+  XLS_RET_CHECK(absl::c_is_sorted(clock_cycles))
+      << "Replay trace clock cycles must be sorted";
+  std::string contents(ReplayTrace::kHeaderBytes +
+                           clock_cycles.size() * sizeof(int64_t),
+                       '\0');
+  std::memcpy(contents.data(), ReplayTrace::kMagic,
+              sizeof(ReplayTrace::kMagic));
+  uint64_t count = clock_cycles.size();
+  std::memcpy(contents.data() + sizeof(ReplayTrace::kMagic), &count,
+              sizeof(count));
+  if (!clock_cycles.empty()) {
+    std::memcpy(contents.data() + ReplayTrace::kHeaderBytes,
+                clock_cycles.data(), clock_cycles.size() * sizeof(int64_t));
+  }
+  return SetFileContents(path, contents);
+}
+
+}  // namespace xls::noc
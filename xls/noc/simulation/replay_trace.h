@@ -0,0 +1,68 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_NOC_SIMULATION_REPLAY_TRACE_H_
+#define XLS_NOC_SIMULATION_REPLAY_TRACE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/file/mapped_file.h"
+
+// This file contains the binary trace format read by replay traffic models.
+
+namespace xls::noc {
+
+// A read-only, memory-mapped trace of the clock cycles at which a flow sends a
+// packet. Traces are mapped rather than read so that replaying a capture of
+// many gigabytes only keeps the pages around the current cycle resident.
+//
+// The format is a 16-byte header, the magic kMagic followed by the number of
+// entries as a uint64, and then that many int64 clock cycles in non-decreasing
+// order. All integers are little-endian.
+class ReplayTrace {
+ public:
+  static constexpr char kMagic[8] = {'X', 'L', 'S', 'N', 'O', 'C', 'R', 'T'};
+  static constexpr int64_t kHeaderBytes = 16;
+
+  // Maps the trace at `path` and checks its header. The order of the entries
+  // is not checked as that would touch every page of the trace.
+  static absl::StatusOr<std::shared_ptr<const ReplayTrace>> Open(
+      const std::filesystem::path& path);
+
+  // Returns the clock cycles of the trace. Valid for the lifetime of the
+  // trace.
+  absl::Span<const int64_t> clock_cycles() const { return clock_cycles_; }
+
+ private:
+  ReplayTrace(MappedFile file, absl::Span<const int64_t> clock_cycles)
+      : file_(std::move(file)), clock_cycles_(clock_cycles) {}
+
+  MappedFile file_;
+  absl::Span<const int64_t> clock_cycles_;
+};
+
+// Writes `clock_cycles`, which must be sorted, to `path` as a replay trace.
+absl::Status WriteReplayTrace(const std::filesystem::path& path,
+                              absl::Span<const int64_t> clock_cycles);
+
+}  // namespace xls::noc
+
+#endif  // XLS_NOC_SIMULATION_REPLAY_TRACE_H_
@@ -0,0 +1,80 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/noc/simulation/replay_trace.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls::noc {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+
+TEST(ReplayTraceTest, RoundTrip) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, TempFile::Create(".trace"));
+  XLS_ASSERT_OK(WriteReplayTrace(file.path(), {0, 3, 3, 7, 1'000'000'000'000}));
+  XLS_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const ReplayTrace> trace,
+                           ReplayTrace::Open(file.path()));
+  EXPECT_THAT(trace->clock_cycles(),
+              ElementsAre(0, 3, 3, 7, 1'000'000'000'000));
+}
+
+TEST(ReplayTraceTest, EmptyTrace) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, TempFile::Create(".trace"));
+  XLS_ASSERT_OK(WriteReplayTrace(file.path(), {}));
+  XLS_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const ReplayTrace> trace,
+                           ReplayTrace::Open(file.path()));
+  EXPECT_THAT(trace->clock_cycles(), IsEmpty());
+}
+
+TEST(ReplayTraceTest, UnsortedCyclesAreRejected) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, TempFile::Create(".trace"));
+  EXPECT_THAT(WriteReplayTrace(file.path(), {3, 1}),
+              StatusIs(absl::StatusCode::kInternal, HasSubstr("sorted")));
+}
+
+TEST(ReplayTraceTest, BadMagic) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, TempFile::CreateWithContent(
+                                               "not a replay trace", ".trace"));
+  EXPECT_THAT(ReplayTrace::Open(file.path()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("is not a replay trace")));
+}
+
+TEST(ReplayTraceTest, TruncatedTrace) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, TempFile::Create(".trace"));
+  XLS_ASSERT_OK(WriteReplayTrace(file.path(), {1, 2, 3}));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string contents, GetFileContents(file.path()));
+  contents.resize(contents.size() - 4);
+  XLS_ASSERT_OK(SetFileContents(file.path(), contents));
+  EXPECT_THAT(ReplayTrace::Open(file.path()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("expected 3 entries")));
+}
+
+}  // namespace
+}  // namespace xls::noc
@@ -0,0 +1,106 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_NOC_SIMULATION_RING_BUFFER_H_
+#define XLS_NOC_SIMULATION_RING_BUFFER_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+
+namespace xls {
+namespace noc {
+
+// A fifo backed by a fixed array of slots.
+//
+// Unlike std::queue, popping an element does not destroy it -- the slot
+// keeps its value (and any heap storage such as the words of a Bits
+// payload) and is reused by a later push which assigns over it.  Once every
+// slot has been used, pushing and popping flits whose payloads are no wider
+// than those previously stored does not allocate.
+//
+// The buffer is sized up front (i.e. from the depth of a virtual channel)
+// but grows if more elements than its capacity are pushed.
+template <typename T>
+class RingBuffer {
+ public:
+  RingBuffer() = default;
+  explicit RingBuffer(int64_t capacity) : slots_(capacity) {}
+
+  int64_t capacity() const { return slots_.size(); }
+  int64_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Returns the oldest element.
+  T& front() {
+    DCHECK(!empty());
+    return slots_[head_];
+  }
+  const T& front() const {
+    DCHECK(!empty());
+    return slots_[head_];
+  }
+
+  // Appends a copy of value.
+  void push(const T& value) { push_slot() = value; }
+
+  // Appends an element and returns a reference to it.  The element holds
+  // whatever value its slot last held so the caller must assign every field.
+  T& push_slot() {
+    if (size_ == capacity()) {
+      Grow();
+    }
+    int64_t index = head_ + size_;
+    if (index >= capacity()) {
+      index -= capacity();
+    }
+    ++size_;
+    return slots_[index];
+  }
+
+  // Removes the oldest element.
+  void pop() {
+    DCHECK(!empty());
+    if (++head_ == capacity()) {
+      head_ = 0;
+    }
+    --size_;
+  }
+
+ private:
+  void Grow() {
+    std::vector<T> slots(capacity() == 0 ? 1 : 2 * capacity());
+    for (int64_t i = 0; i < size_; ++i) {
+      int64_t index = head_ + i;
+      if (index >= capacity()) {
+        index -= capacity();
+      }
+      slots[i] = std::move(slots_[index]);
+    }
+    slots_ = std::move(slots);
+    head_ = 0;
+  }
+
+  std::vector<T> slots_;
+  int64_t head_ = 0;
+  int64_t size_ = 0;
+};
+
+}  // namespace noc
+}  // namespace xls
+
+#endif  // XLS_NOC_SIMULATION_RING_BUFFER_H_
@@ -0,0 +1,82 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/noc/simulation/ring_buffer.h"
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "xls/ir/bits.h"
+
+namespace xls::noc {
+namespace {
+
+TEST(RingBufferTest, PushAndPopInOrder) {
+  RingBuffer<int64_t> buffer(3);
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(buffer.capacity(), 3);
+
+  // Wrap around the end of the slots several times.
+  int64_t next_push = 0;
+  int64_t next_pop = 0;
+  for (int64_t i = 0; i < 10; ++i) {
+    buffer.push(next_push++);
+    buffer.push(next_push++);
+    EXPECT_EQ(buffer.size(), 2);
+    EXPECT_EQ(buffer.front(), next_pop++);
+    buffer.pop();
+    EXPECT_EQ(buffer.front(), next_pop++);
+    buffer.pop();
+    EXPECT_TRUE(buffer.empty());
+  }
+  EXPECT_EQ(buffer.capacity(), 3);
+}
+
+TEST(RingBufferTest, GrowsWhenFull) {
+  RingBuffer<int64_t> buffer(2);
+  buffer.push(0);
+  buffer.push(1);
+  buffer.pop();
+  // The head is now in the middle of the slots.
+  for (int64_t i = 2; i < 7; ++i) {
+    buffer.push(i);
+  }
+  EXPECT_EQ(buffer.size(), 6);
+  EXPECT_GE(buffer.capacity(), 6);
+  for (int64_t i = 1; i < 7; ++i) {
+    EXPECT_EQ(buffer.front(), i);
+    buffer.pop();
+  }
+  EXPECT_TRUE(buffer.empty());
+
+  RingBuffer<int64_t> empty;
+  empty.push(42);
+  EXPECT_EQ(empty.front(), 42);
+}
+
+TEST(RingBufferTest, SlotsAreReused) {
+  RingBuffer<Bits> buffer(1);
+  buffer.push(UBits(5, 128));
+  buffer.pop();
+
+  // A slot keeps the value it last held.
+  Bits& slot = buffer.push_slot();
+  EXPECT_EQ(slot, UBits(5, 128));
+  slot = UBits(7, 128);
+  EXPECT_EQ(buffer.front(), UBits(7, 128));
+}
+
+}  // namespace
+}  // namespace xls::noc
@@ -14,16 +14,23 @@
 
 #include "xls/noc/simulation/sim_objects.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <queue>
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/simulation/common.h"
@@ -45,7 +52,7 @@ class SimplePipelineImpl {
  public:
   SimplePipelineImpl(int64_t stage_count, DataTimePhitT& from_channel,
                      DataTimePhitT& to_channel,
-                     std::queue<DataTimePhitT>& state,
+                     RingBuffer<DataTimePhitT>& state,
                      int64_t& internal_propagated_cycle)
       : stage_count_(stage_count),
         from_(from_channel),
@@ -60,7 +67,7 @@ class SimplePipelineImpl {
   DataTimePhitT& from_;
   DataTimePhitT& to_;
   // TODO(vmirian) 09-07-21 Optimize to select flit data and its metadata
-  std::queue<DataTimePhitT>& state_;
+  RingBuffer<DataTimePhitT>& state_;
   int64_t& internal_propagated_cycle_;
 };
 
@@ -126,7 +133,162 @@ bool SimplePipelineImpl<DataTimePhitT>::TryPropagation(
 
 }  // namespace
 
+// Ticks the network components of a simulator on several threads.
+//
+// Components are greedily assigned, in the order they are ticked by the serial
+// simulator, to the first phase in which none of their connections are used by
+// another component.  Each connection is hence only accessed by a single
+// thread during a phase.  The components of a phase are split into contiguous
+// chunks, one per thread, and the calling thread works on the first chunk.
+class NocSimulator::ParallelTicker {
+ public:
+  ParallelTicker(NocSimulator& simulator, int64_t thread_count)
+      : simulator_(simulator), thread_count_(thread_count) {
+    std::vector<std::vector<bool>> phase_connections;
+    auto add_to_phase = [&](SimNetworkComponentBase& nc) {
+      std::vector<int64_t> indices = nc.GetConnectionIndices(simulator);
+      int64_t phase = 0;
+      while (phase < phases_.size() &&
+             std::any_of(indices.begin(), indices.end(), [&](int64_t i) {
+               return phase_connections[phase][i];
+             })) {
+        ++phase;
+      }
+      if (phase == phases_.size()) {
+        phases_.emplace_back();
+        phase_connections.emplace_back(simulator.connections_.size(), false);
+      }
+      phases_[phase].push_back(&nc);
+      for (int64_t i : indices) {
+        phase_connections[phase][i] = true;
+      }
+    };
+    for (SimNetworkInterfaceSrc& nc : simulator.network_interface_sources_) {
+      add_to_phase(nc);
+    }
+    for (SimLink& nc : simulator.links_) {
+      add_to_phase(nc);
+    }
+    for (SimInputBufferedVCRouter& nc : simulator.routers_) {
+      add_to_phase(nc);
+    }
+    for (SimNetworkInterfaceSink& nc : simulator.network_interface_sinks_) {
+      add_to_phase(nc);
+    }
+    VLOG(1) << absl::StreamFormat(
+        "Ticking network in %d phases on %d threads", phases_.size(),
+        thread_count_);
+
+    for (int64_t worker = 1; worker < thread_count_; ++worker) {
+      threads_.push_back(
+          std::make_unique<Thread>([this, worker]() { WorkerLoop(worker); }));
+    }
+  }
+
+  ~ParallelTicker() {
+    {
+      absl::MutexLock lock(&mutex_);
+      shutdown_ = true;
+    }
+    for (std::unique_ptr<Thread>& thread : threads_) {
+      thread->Join();
+    }
+  }
+
+  // Ticks each phase in turn, returns true if all components converged.
+  bool Tick() {
+    bool converged = true;
+    for (int64_t phase = 0; phase < phases_.size(); ++phase) {
+      {
+        absl::MutexLock lock(&mutex_);
+        phase_ = phase;
+        pending_workers_ = thread_count_ - 1;
+        converged_ = true;
+        ++generation_;
+      }
+      bool this_converged = TickChunk(phase, 0);
+
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(
+          +[](int64_t* pending) { return *pending == 0; }, &pending_workers_));
+      converged &= this_converged && converged_;
+    }
+    return converged;
+  }
+
+ private:
+  // Ticks the chunk of the components of phase assigned to worker.
+  bool TickChunk(int64_t phase, int64_t worker) {
+    const std::vector<SimNetworkComponentBase*>& components = phases_[phase];
+    int64_t size = components.size();
+    int64_t begin = size * worker / thread_count_;
+    int64_t end = size * (worker + 1) / thread_count_;
+
+    bool converged = true;
+    for (int64_t i = begin; i < end; ++i) {
+      converged &= components[i]->Tick(simulator_);
+    }
+    return converged;
+  }
+
+  void WorkerLoop(int64_t worker) {
+    int64_t seen_generation = 0;
+    while (true) {
+      int64_t phase;
+      {
+        absl::MutexLock lock(&mutex_);
+        auto ready = [&]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+          return shutdown_ || generation_ != seen_generation;
+        };
+        mutex_.Await(absl::Condition(&ready));
+        if (shutdown_) {
+          return;
+        }
+        seen_generation = generation_;
+        phase = phase_;
+      }
+
+      bool converged = TickChunk(phase, worker);
+
+      absl::MutexLock lock(&mutex_);
+      converged_ &= converged;
+      --pending_workers_;
+    }
+  }
+
+  NocSimulator& simulator_;
+  int64_t thread_count_;
+  std::vector<std::vector<SimNetworkComponentBase*>> phases_;
+  std::vector<std::unique_ptr<Thread>> threads_;
+
+  absl::Mutex mutex_;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+  // Incremented each time a phase is started.
+  int64_t generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t phase_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t pending_workers_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool converged_ ABSL_GUARDED_BY(mutex_) = true;
+};
+
+NocSimulator::NocSimulator()
+    : mgr_(nullptr),
+      params_(nullptr),
+      routing_(nullptr),
+      cycle_(-1),
+      thread_count_(1) {}
+
+NocSimulator::~NocSimulator() = default;
+
+absl::Status NocSimulator::SetThreadCount(int64_t thread_count) {
+  XLS_RET_CHECK_GE(thread_count, 1);
+  thread_count_ = thread_count;
+  parallel_ticker_.reset();
+  return absl::OkStatus();
+}
+
 absl::Status NocSimulator::CreateSimulationObjects(NetworkId network) {
+  parallel_ticker_.reset();
+
   Network& network_obj = mgr_->GetNetwork(network);
 
   // Create connection simulation objects.
@@ -261,6 +423,10 @@ absl::Status NocSimulator::RunCycle(int64_t max_ticks) {
     XLS_RET_CHECK_OK(svc->RunCycle());
   }
 
+  if (thread_count_ > 1 && parallel_ticker_ == nullptr) {
+    parallel_ticker_ = std::make_unique<ParallelTicker>(*this, thread_count_);
+  }
+
   bool converged = false;
   int64_t nticks = 0;
   while (!converged) {
@@ -297,6 +463,9 @@ absl::Status NocSimulator::RunCycle(int64_t max_ticks) {
 bool NocSimulator::Tick() {
   // Goes through each simulator object and run atick.
   // Converges when everyone returns True -- that determines new cycle
+  if (parallel_ticker_ != nullptr) {
+    return parallel_ticker_->Tick();
+  }
 
   bool converged = true;
 
@@ -364,6 +533,32 @@ int64_t SimLink::GetSourceConnectionIndex() const {
   return src_connection_index_;
 }
 
+std::vector<int64_t> SimLink::GetConnectionIndices(
+    NocSimulator& simulator) const {
+  return {src_connection_index_, sink_connection_index_};
+}
+
+std::vector<int64_t> SimNetworkInterfaceSrc::GetConnectionIndices(
+    NocSimulator& simulator) const {
+  return {sink_connection_index_};
+}
+
+std::vector<int64_t> SimNetworkInterfaceSink::GetConnectionIndices(
+    NocSimulator& simulator) const {
+  return {src_connection_index_};
+}
+
+std::vector<int64_t> SimInputBufferedVCRouter::GetConnectionIndices(
+    NocSimulator& simulator) const {
+  absl::Span<int64_t> inputs = simulator.GetConnectionIndicesStore(
+      input_connection_index_start_, input_connection_count_);
+  absl::Span<int64_t> outputs = simulator.GetConnectionIndicesStore(
+      output_connection_index_start_, output_connection_count_);
+  std::vector<int64_t> indices(inputs.begin(), inputs.end());
+  indices.insert(indices.end(), outputs.begin(), outputs.end());
+  return indices;
+}
+
 absl::Status SimLink::InitializeImpl(NocSimulator& simulator) {
   XLS_ASSIGN_OR_RETURN(
       NetworkComponentParam nc_param,
@@ -401,7 +596,10 @@ absl::Status SimLink::InitializeImpl(NocSimulator& simulator) {
       simulator.GetSimConnectionByIndex(sink_connection_index_);
 
   int64_t reverse_channel_count = sink.reverse_channels.size();
-  reverse_credit_stages_.resize(reverse_channel_count);
+  forward_data_stages_ = RingBuffer<TimedDataFlit>(forward_pipeline_stages_);
+  reverse_credit_stages_ = std::vector(
+      reverse_channel_count,
+      RingBuffer<TimedMetadataFlit>(reverse_pipeline_stages_));
   internal_reverse_propagated_cycle_ =
       std::vector(reverse_channel_count, simulator.GetCurrentCycle());
 
@@ -459,6 +657,8 @@ absl::Status SimNetworkInterfaceSink::InitializeImpl(NocSimulator& simulator) {
 
   for (int64_t vc = 0; vc < virtual_channel_count; ++vc) {
     input_buffers_[vc].max_queue_size = vc_params[vc].GetDepth();
+    input_buffers_[vc].queue =
+        RingBuffer<DataFlitQueueElement>(vc_params[vc].GetDepth());
   }
 
   NetworkManager* network_manager = simulator.GetNetworkManager();
@@ -507,6 +707,8 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
     input_buffers_[i].resize(port_param.VirtualChannelCount());
     for (int64_t vc = 0; vc < port_param.VirtualChannelCount(); ++vc) {
       input_buffers_[i][vc].max_queue_size = vc_params[vc].GetDepth();
+      input_buffers_[i][vc].queue =
+          RingBuffer<DataFlitQueueElement>(vc_params[vc].GetDepth());
     }
     input_credit_to_send_[i].resize(port_param.VirtualChannelCount());
     if (max_vc_ < port_param.VirtualChannelCount()) {
@@ -787,8 +989,9 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
 
     if (input.forward_channels.flit.type != FlitType::kInvalid) {
       int64_t vc = input.forward_channels.flit.vc;
-      input_buffers_[i][vc].queue.push(
-          {input.forward_channels.flit, input.forward_channels.metadata});
+      DataFlitQueueElement& element = input_buffers_[i][vc].queue.push_slot();
+      element.flit = input.forward_channels.flit;
+      element.metadata = input.forward_channels.metadata;
 
       VLOG(2) << absl::StrFormat(
           "... router %x from %x received data %s port %d vc %d",
@@ -810,8 +1013,8 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
         continue;
       }
 
-      DataFlit flit = input_buffers_[i][vc].queue.front().flit;
-      TimedDataFlitInfo metadata = input_buffers_[i][vc].queue.front().metadata;
+      const DataFlitQueueElement& head = input_buffers_[i][vc].queue.front();
+      const DataFlit& flit = head.flit;
       int64_t destination_index = flit.destination_index;
 
       PortIndexAndVCIndex input{i, vc};
@@ -843,7 +1046,7 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
       output_state.forward_channels.flit = flit;
       output_state.forward_channels.flit.vc = output.vc_index;
       output_state.forward_channels.cycle = current_cycle;
-      output_state.forward_channels.metadata = metadata;
+      output_state.forward_channels.metadata = head.metadata;
       output_state.forward_channels.metadata.timed_route_info.route.push_back(
           TimedRouteItem{id_, current_cycle});
 
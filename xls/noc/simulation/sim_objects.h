@@ -16,14 +16,18 @@
 #define XLS_NOC_SIMULATION_SIM_OBJECTS_H_
 
 #include <cstdint>
+#include <memory>
 #include <queue>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/global_routing_table.h"
 #include "xls/noc/simulation/parameters.h"
+#include "xls/noc/simulation/ring_buffer.h"
 #include "xls/noc/simulation/simulator_shims.h"
 
 // This file contains classes used to store, access, and define simulation
@@ -54,8 +58,10 @@ struct DataFlitQueueElement {
 };
 
 // Represents a fifo/buffer used to store phits.
+//
+// The queue is sized to max_queue_size so its slots are reused.
 struct DataFlitQueue {
-  std::queue<DataFlitQueueElement> queue;
+  RingBuffer<DataFlitQueueElement> queue;
   int64_t max_queue_size;
 };
 
@@ -80,6 +86,13 @@ class SimNetworkComponentBase {
   // Returns the associated NetworkComponentId.
   NetworkComponentId GetId() const { return id_; }
 
+  // Returns the indices of all SimConnectionState objects read or written
+  // by this component during a tick.
+  //
+  // Components which share no connection can be ticked concurrently.
+  virtual std::vector<int64_t> GetConnectionIndices(
+      NocSimulator& simulator) const = 0;
+
   virtual ~SimNetworkComponentBase() = default;
 
  protected:
@@ -151,6 +164,9 @@ class SimLink : public SimNetworkComponentBase {
 
   // Get the sink connection index that in used in the simulator.
 
+  std::vector<int64_t> GetConnectionIndices(
+      NocSimulator& simulator) const override;
+
  private:
   SimLink() = default;
 
@@ -168,10 +184,10 @@ class SimLink : public SimNetworkComponentBase {
   int64_t src_connection_index_;
   int64_t sink_connection_index_;
 
-  std::queue<TimedDataFlit> forward_data_stages_;
+  RingBuffer<TimedDataFlit> forward_data_stages_;
   int64_t internal_forward_propagated_cycle_;
 
-  std::vector<std::queue<TimedMetadataFlit>> reverse_credit_stages_;
+  std::vector<RingBuffer<TimedMetadataFlit>> reverse_credit_stages_;
   std::vector<int64_t> internal_reverse_propagated_cycle_;
 };
 
@@ -188,6 +204,9 @@ class SimNetworkInterfaceSrc : public SimNetworkComponentBase {
   // Register a flit to be sent at a specific time.
   absl::Status SendFlitAtTime(TimedDataFlit flit);
 
+  std::vector<int64_t> GetConnectionIndices(
+      NocSimulator& simulator) const override;
+
  private:
   SimNetworkInterfaceSrc() = default;
 
@@ -217,6 +236,9 @@ class SimNetworkInterfaceSink : public SimNetworkComponentBase {
     return received_traffic_;
   }
 
+  std::vector<int64_t> GetConnectionIndices(
+      NocSimulator& simulator) const override;
+
   // Returns the observed rate of traffic in MebiBytes Per Second from the
   // beginning of simulation to the last flit processed by this sink.
   //
@@ -291,6 +313,9 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
 
   int64_t GetUtilizationCycleCount() const;
 
+  std::vector<int64_t> GetConnectionIndices(
+      NocSimulator& simulator) const override;
+
  private:
   SimInputBufferedVCRouter() = default;
 
@@ -362,8 +387,8 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
 // state and objects.
 class NocSimulator {
  public:
-  NocSimulator()
-      : mgr_(nullptr), params_(nullptr), routing_(nullptr), cycle_(-1) {}
+  NocSimulator();
+  ~NocSimulator();
 
   // Creates all simulation objects for a given network.
   // NetworkManager, NocParameters, and DistributedRoutingTable should
@@ -435,6 +460,16 @@ class NocSimulator {
   // Runs a single tick of the simulator.
   bool Tick();
 
+  // Sets the number of threads used to tick the network components.
+  //
+  // With more than one thread, components are partitioned into phases of
+  // components which share no connection.  Each phase is ticked concurrently
+  // and phases are separated by barriers.  As components only propagate
+  // state once their inputs for the current cycle are available, the state
+  // of the network at the end of each cycle is identical to that of the
+  // serial simulator though the number of ticks needed to converge may differ.
+  absl::Status SetThreadCount(int64_t thread_count);
+
   // Register a service to run once at the beginning of each cycle.
   // TODO(tedhong): 2021-07-27 Add a scheme to provide a total order
   //                of services.
@@ -462,6 +497,8 @@ class NocSimulator {
   absl::Span<const SimLink> GetLinks() const;
 
  private:
+  class ParallelTicker;
+
   absl::Status CreateSimulationObjects(NetworkId network);
   absl::Status CreateConnection(ConnectionId connection_id);
   absl::Status CreateNetworkComponent(NetworkComponentId nc_id);
@@ -511,6 +548,11 @@ class NocSimulator {
 
   // Shims to services to run at the end of each cycle.
   std::vector<NocSimulatorServiceShim*> post_cycle_services_;
+
+  // Ticks the network on thread_count_ threads.  Created by RunCycle when
+  // thread_count_ is greater than one.
+  int64_t thread_count_;
+  std::unique_ptr<ParallelTicker> parallel_ticker_;
 };
 
 }  // namespace noc
@@ -12,10 +12,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/noc_traffic_injector.h"
 #include "xls/noc/simulation/sample_network_graphs.h"
 #include "xls/noc/simulation/sim_objects.h"
@@ -378,5 +385,121 @@ TEST(SimTrafficTest, NetworkWithMultiplePathsAndReplay) {
   EXPECT_EQ(simulator.GetRouters()[1].GetUtilizationCycleCount(), 10);
 }
 
+struct SimulationResult {
+  std::vector<int64_t> router_utilization;
+  std::vector<std::vector<TimedDataFlit>> received_traffic;
+};
+
+// Simulates random traffic on a network with multiple paths using the given
+// number of threads.
+absl::StatusOr<SimulationResult> SimulateNetworkWithMultiplePaths(
+    int64_t thread_count, int64_t cycle_count) {
+  NocTrafficManager traffic_mgr;
+  XLS_ASSIGN_OR_RETURN(TrafficFlowId flow0_id,
+                       traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow0_id)
+      .SetName("flow0")
+      .SetSource("SendPort0")
+      .SetDestination("RecvPort0")
+      .SetVC("VC0")
+      .SetTrafficRateInMiBps(3 * 1024)
+      .SetPacketSizeInBits(128)
+      .SetBurstProbInMils(7);
+  XLS_ASSIGN_OR_RETURN(TrafficFlowId flow1_id,
+                       traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow1_id)
+      .SetName("flow1")
+      .SetSource("SendPort1")
+      .SetDestination("RecvPort1")
+      .SetVC("VC0")
+      .SetTrafficRateInMiBps(2 * 1024)
+      .SetPacketSizeInBits(128)
+      .SetBurstProbInMils(7);
+  XLS_ASSIGN_OR_RETURN(TrafficModeId mode0_id,
+                       traffic_mgr.CreateTrafficMode());
+  traffic_mgr.GetTrafficMode(mode0_id)
+      .SetName("Mode 0")
+      .RegisterTrafficFlow(flow0_id)
+      .RegisterTrafficFlow(flow1_id);
+
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_RETURN_IF_ERROR(BuildNetworkGraphLinear001(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForMultiplePaths route_builder;
+  XLS_ASSIGN_OR_RETURN(DistributedRoutingTable routing_table,
+                       route_builder.BuildNetworkRoutingTables(
+                           graph.GetNetworkIds()[0], graph, params));
+
+  RandomNumberInterface rnd;
+  rnd.SetSeed(1000);
+  XLS_ASSIGN_OR_RETURN(
+      NocTrafficInjector traffic_injector,
+      NocTrafficInjectorBuilder().Build(
+          /*cycle_time_in_ps=*/400, mode0_id,
+          routing_table.GetSourceIndices().GetNetworkComponents(),
+          routing_table.GetSinkIndices().GetNetworkComponents(),
+          params.GetNetworkParam(graph.GetNetworkIds()[0])
+              ->GetVirtualChannels(),
+          traffic_mgr, graph, params, rnd));
+
+  NocSimulator simulator;
+  XLS_RETURN_IF_ERROR(simulator.Initialize(graph, params, routing_table,
+                                           graph.GetNetworkIds()[0]));
+  XLS_RETURN_IF_ERROR(simulator.SetThreadCount(thread_count));
+
+  NocSimulatorToNocTrafficInjectorShim injector_shim(simulator,
+                                                     traffic_injector);
+  traffic_injector.SetSimulatorShim(injector_shim);
+  simulator.RegisterPreCycleService(injector_shim);
+
+  for (int64_t i = 0; i < cycle_count; ++i) {
+    XLS_RETURN_IF_ERROR(simulator.RunCycle());
+  }
+
+  SimulationResult result;
+  for (const SimInputBufferedVCRouter& router : simulator.GetRouters()) {
+    result.router_utilization.push_back(router.GetUtilizationCycleCount());
+  }
+  for (NetworkComponentId sink :
+       routing_table.GetSinkIndices().GetNetworkComponents()) {
+    XLS_ASSIGN_OR_RETURN(SimNetworkInterfaceSink * sim_sink,
+                         simulator.GetSimNetworkInterfaceSink(sink));
+    absl::Span<const TimedDataFlit> traffic = sim_sink->GetReceivedTraffic();
+    result.received_traffic.emplace_back(traffic.begin(), traffic.end());
+  }
+  return result;
+}
+
+TEST(SimTrafficTest, ParallelTicksMatchSerialSimulation) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      SimulationResult serial,
+      SimulateNetworkWithMultiplePaths(/*thread_count=*/1,
+                                       /*cycle_count=*/2'000));
+
+  for (int64_t thread_count : {2, 3, 8}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        SimulationResult parallel,
+        SimulateNetworkWithMultiplePaths(thread_count,
+                                         /*cycle_count=*/2'000));
+    EXPECT_EQ(parallel.router_utilization, serial.router_utilization);
+
+    ASSERT_EQ(parallel.received_traffic.size(), serial.received_traffic.size());
+    for (int64_t i = 0; i < serial.received_traffic.size(); ++i) {
+      const std::vector<TimedDataFlit>& expected = serial.received_traffic[i];
+      const std::vector<TimedDataFlit>& actual = parallel.received_traffic[i];
+      EXPECT_FALSE(expected.empty());
+      ASSERT_EQ(actual.size(), expected.size());
+      for (int64_t j = 0; j < expected.size(); ++j) {
+        EXPECT_EQ(actual[j].cycle, expected[j].cycle);
+        EXPECT_EQ(actual[j].metadata.injection_cycle_time,
+                  expected[j].metadata.injection_cycle_time);
+        EXPECT_EQ(actual[j].flit.ToString(), expected[j].flit.ToString());
+      }
+    }
+  }
+}
+
 }  // namespace
 }  // namespace xls::noc
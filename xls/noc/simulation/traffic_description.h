@@ -183,7 +183,20 @@ class TrafficFlow {
     return *this;
   }
 
-  bool IsReplay() const { return !cycle_times_.empty(); }
+  // Set the path of a replay trace (see ReplayTrace) holding the clock cycle
+  // times. The trace is mapped, rather than read, when the traffic injector is
+  // built so that traces larger than memory can be replayed.
+  TrafficFlow& SetReplayTracePath(std::string_view path) {
+    replay_trace_path_ = path;
+    return *this;
+  }
+
+  // Get the replay trace path, empty if the flow is not replayed from a trace.
+  std::string_view GetReplayTracePath() const { return replay_trace_path_; }
+
+  bool IsReplay() const {
+    return !cycle_times_.empty() || !replay_trace_path_.empty();
+  }
 
  private:
   TrafficFlowId id_;
@@ -205,6 +218,9 @@ class TrafficFlow {
   // instances where the source sends a packet to the destination.
   // TODO(vmirian) Add support for clock cycle interval: 09-02-2021.
   std::vector<int64_t> cycle_times_;
+
+  // Path of a replay trace holding the clock cycle times instead.
+  std::string replay_trace_path_;
 };
 
 class NocTrafficManager;
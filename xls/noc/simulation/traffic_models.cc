@@ -15,11 +15,15 @@
 #include "xls/noc/simulation/traffic_models.h"
 
 #include <algorithm>
-#include <iterator>
+#include <cstdint>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/noc/simulation/replay_trace.h"
 
 namespace xls::noc {
 
@@ -104,11 +108,21 @@ ReplayTrafficModelBuilder::ReplayTrafficModelBuilder(
                        clock_cycles.end());
 }
 
+ReplayTrafficModelBuilder::ReplayTrafficModelBuilder(
+    int64_t packet_size_bits, std::shared_ptr<const ReplayTrace> trace)
+    : trace_(std::move(trace)) {
+  SetPacketSizeBits(packet_size_bits);
+}
+
 absl::StatusOr<std::unique_ptr<ReplayTrafficModel>>
 ReplayTrafficModelBuilder::Build() const {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<ReplayTrafficModel> model,
                        TrafficModelBuilder::Build());
-  model->SetClockCycles(clock_cycles_);
+  if (trace_ != nullptr) {
+    model->SetClockCycleTrace(trace_);
+  } else {
+    model->SetClockCycles(clock_cycles_);
+  }
   return model;
 }
 
@@ -116,7 +130,6 @@ ReplayTrafficModel::ReplayTrafficModel(int64_t packet_size_bits,
                                        absl::Span<const int64_t> clock_cycles)
     : TrafficModel(packet_size_bits) {
   SetClockCycles(clock_cycles);
-  clock_cycle_iter_ = clock_cycles_.cbegin();
 }
 
 std::vector<DataPacket> ReplayTrafficModel::GetNewCyclePackets(int64_t cycle) {
@@ -124,26 +137,23 @@ std::vector<DataPacket> ReplayTrafficModel::GetNewCyclePackets(int64_t cycle) {
     cycle_count_ = cycle;
   }
 
-  if ((clock_cycle_iter_ == clock_cycles_.end()) ||
-      (*clock_cycle_iter_ != cycle)) {
-    // No packets to be sent until next_packet_cycle_.
-    return std::vector<DataPacket>();
-  }
-
   std::vector<DataPacket> packets;
-
-  CHECK_EQ(cycle, *clock_cycle_iter_);
-
-  absl::StatusOr<DataPacket> packet = DataPacketBuilder()
-                                          .Valid(true)
-                                          .ZeroedData(packet_size_bits_)
-                                          .VirtualChannel(vc_)
-                                          .SourceIndex(source_index_)
-                                          .DestinationIndex(destination_index_)
-                                          .Build();
-  CHECK(packet.ok());
-  packets.push_back(packet.value());
-  clock_cycle_iter_++;
+  // Entries before `cycle` can only come from a trace which is not sorted;
+  // their packets are sent late rather than stalling the rest of the trace.
+  while (next_clock_cycle_index_ < clock_cycles_.size() &&
+         clock_cycles_[next_clock_cycle_index_] <= cycle) {
+    absl::StatusOr<DataPacket> packet =
+        DataPacketBuilder()
+            .Valid(true)
+            .ZeroedData(packet_size_bits_)
+            .VirtualChannel(vc_)
+            .SourceIndex(source_index_)
+            .DestinationIndex(destination_index_)
+            .Build();
+    CHECK(packet.ok());
+    packets.push_back(*std::move(packet));
+    ++next_clock_cycle_index_;
+  }
   return packets;
 }
 
@@ -151,7 +161,7 @@ double ReplayTrafficModel::ExpectedTrafficRateInMiBps(
     int64_t cycle_time_ps) const {
   double total_sec = static_cast<double>(cycle_count_ + 1) *
                      static_cast<double>(cycle_time_ps) * 1.0e-12;
-  int64_t num_packets = std::distance(clock_cycles_.begin(), clock_cycle_iter_);
+  int64_t num_packets = next_clock_cycle_index_;
   double bits_per_sec = static_cast<double>(packet_size_bits_) * num_packets;
   bits_per_sec = bits_per_sec / 1024.0 / 1024.0 / 8.0;
   return bits_per_sec / total_sec;
@@ -159,14 +169,20 @@ double ReplayTrafficModel::ExpectedTrafficRateInMiBps(
 
 void ReplayTrafficModel::SetClockCycles(
     absl::Span<const int64_t> clock_cycles) {
-  clock_cycles_ =
+  owned_clock_cycles_ =
       std::vector<int64_t>(clock_cycles.begin(), clock_cycles.end());
-  std::sort(clock_cycles_.begin(), clock_cycles_.end());
-  clock_cycle_iter_ = clock_cycles_.cbegin();
+  std::sort(owned_clock_cycles_.begin(), owned_clock_cycles_.end());
+  trace_ = nullptr;
+  clock_cycles_ = owned_clock_cycles_;
+  next_clock_cycle_index_ = 0;
 }
 
-absl::Span<const int64_t> ReplayTrafficModel::GetClockCycles() const {
-  return clock_cycles_;
+void ReplayTrafficModel::SetClockCycleTrace(
+    std::shared_ptr<const ReplayTrace> trace) {
+  owned_clock_cycles_.clear();
+  trace_ = std::move(trace);
+  clock_cycles_ = trace_->clock_cycles();
+  next_clock_cycle_index_ = 0;
 }
 
 }  // namespace xls::noc
@@ -21,10 +21,12 @@
 
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/packetizer.h"
 #include "xls/noc/simulation/random_number_interface.h"
+#include "xls/noc/simulation/replay_trace.h"
 #include "xls/noc/simulation/units.h"
 
 // This file contains classes used to model traffic of a NOC.
@@ -193,30 +195,40 @@ class GeneralizedGeometricTrafficModelBuilder
 
 // Models the traffic injected into a single source according at specified
 // cycle times.
+//
+// The cycle times are either held by the model or streamed from a
+// memory-mapped ReplayTrace, in which case packets are created as the trace is
+// read and the trace is never copied.
 class ReplayTrafficModel : public TrafficModel {
  public:
   explicit ReplayTrafficModel(int64_t packet_size_bits)
-      : TrafficModel(packet_size_bits),
-        clock_cycle_iter_{clock_cycles_.cend()} {}
+      : TrafficModel(packet_size_bits) {}
   // Assumes element in clock_cycles are valid.
   ReplayTrafficModel(int64_t packet_size_bits,
                      absl::Span<const int64_t> clock_cycles);
 
+  // Sends one packet for each entry of the trace at that cycle.
   std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) override;
 
   double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const override;
 
   // Sets clock cycles to list and sorts the complete list of clock cycle.
   void SetClockCycles(absl::Span<const int64_t> clock_cycles);
-  absl::Span<const int64_t> GetClockCycles() const;
+  // Replays the clock cycles of `trace`, which are already sorted.
+  void SetClockCycleTrace(std::shared_ptr<const ReplayTrace> trace);
+  absl::Span<const int64_t> GetClockCycles() const { return clock_cycles_; }
 
  private:
   // cycle count
   int64_t cycle_count_ = 0;
-  // clock cycles to inject a packet.
-  std::vector<int64_t> clock_cycles_;
-  // Iterator to next clock cycle.
-  std::vector<int64_t>::const_iterator clock_cycle_iter_;
+  // clock cycles to inject a packet, when held by the model.
+  std::vector<int64_t> owned_clock_cycles_;
+  // The trace holding the clock cycles, when they are streamed.
+  std::shared_ptr<const ReplayTrace> trace_;
+  // clock cycles to inject a packet: owned_clock_cycles_ or those of trace_.
+  absl::Span<const int64_t> clock_cycles_;
+  // Index of next clock cycle.
+  int64_t next_clock_cycle_index_ = 0;
 };
 
 class ReplayTrafficModelBuilder
@@ -225,11 +237,14 @@ class ReplayTrafficModelBuilder
  public:
   ReplayTrafficModelBuilder(int64_t packet_size_bits,
                             absl::Span<const int64_t> clock_cycles);
+  ReplayTrafficModelBuilder(int64_t packet_size_bits,
+                            std::shared_ptr<const ReplayTrace> trace);
 
   absl::StatusOr<std::unique_ptr<ReplayTrafficModel>> Build() const;
 
  private:
   std::vector<int64_t> clock_cycles_;
+  std::shared_ptr<const ReplayTrace> trace_;
 };
 
 // Measures the traffic injected and computes aggregate statistics.
@@ -14,12 +14,15 @@
 
 #include "xls/noc/simulation/traffic_models.h"
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
+#include "xls/noc/simulation/replay_trace.h"
 
 namespace xls::noc {
 namespace {
@@ -189,5 +192,39 @@ TEST(TrafficModelsTest, ReplayModelClockCycleClearTest) {
   EXPECT_EQ(model.GetClockCycles(), std::vector<int64_t>({6, 7, 8, 9, 10}));
 }
 
+TEST(TrafficModelsTest, ReplayModelDuplicateClockCyclesTest) {
+  ReplayTrafficModel model(128, {2, 0, 2});
+
+  EXPECT_EQ(model.GetNewCyclePackets(0).size(), 1);
+  EXPECT_EQ(model.GetNewCyclePackets(1).size(), 0);
+  EXPECT_EQ(model.GetNewCyclePackets(2).size(), 2);
+  EXPECT_EQ(model.GetNewCyclePackets(3).size(), 0);
+}
+
+TEST(TrafficModelsTest, ReplayModelFromTraceTest) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, TempFile::Create(".trace"));
+  XLS_ASSERT_OK(WriteReplayTrace(file.path(), {1, 3, 4}));
+  XLS_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const ReplayTrace> trace,
+                           ReplayTrace::Open(file.path()));
+
+  ReplayTrafficModelBuilder builder(64, trace);
+  builder.SetVCIndex(1).SetSourceIndex(10).SetDestinationIndex(3);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ReplayTrafficModel> model,
+                           builder.Build());
+  EXPECT_EQ(model->GetClockCycles(), std::vector<int64_t>({1, 3, 4}));
+
+  std::vector<int64_t> packet_cycles;
+  for (int64_t cycle = 0; cycle < 6; ++cycle) {
+    for (DataPacket& p : model->GetNewCyclePackets(cycle)) {
+      EXPECT_EQ(p.vc, 1);
+      EXPECT_EQ(p.source_index, 10);
+      EXPECT_EQ(p.destination_index, 3);
+      EXPECT_EQ(p.data.bit_count(), 64);
+      packet_cycles.push_back(cycle);
+    }
+  }
+  EXPECT_EQ(packet_cycles, std::vector<int64_t>({1, 3, 4}));
+}
+
 }  // namespace
 }  // namespace xls::noc
@@ -24,6 +24,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
@@ -36,15 +37,18 @@
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/stopwatch.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/binary_decision_diagram.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/abstract_evaluator.h"
 #include "xls/ir/abstract_node_evaluator.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_union_find.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
@@ -282,6 +286,76 @@ bool ShouldEvaluate(Node* node) {
   LOG(FATAL) << "Invalid op: " << static_cast<int64_t>(node->op());
 }
 
+// Returns whether the BDD value of the given bits-typed node is computed from
+// the values of its operands. Otherwise the node is modeled as new variables.
+bool IsEvaluatedFromOperands(
+    Node* node,
+    const std::optional<std::function<bool(const Node*)>>& node_filter) {
+  return ShouldEvaluate(node) &&
+         (!node_filter.has_value() || node_filter.value()(node)) &&
+         absl::c_all_of(node->operands(),
+                        [](Node* o) { return o->GetType()->IsBits(); });
+}
+
+// Partitions the bits-typed nodes of `topo_order` into at most
+// `max_partitions` groups of independent cones. The value of each node depends
+// only on the values of nodes in the same group. Cones are assigned to the
+// groups to balance the number of nodes per group. The nodes of each group are
+// in topological order.
+std::vector<std::vector<Node*>> PartitionIntoCones(
+    absl::Span<Node* const> topo_order,
+    const std::optional<std::function<bool(const Node*)>>& node_filter,
+    int64_t max_partitions) {
+  NodeUnionFind cones;
+  for (Node* node : topo_order) {
+    if (!node->GetType()->IsBits()) {
+      continue;
+    }
+    cones.Insert(node);
+    if (IsEvaluatedFromOperands(node, node_filter)) {
+      for (Node* operand : node->operands()) {
+        cones.Union(node, operand);
+      }
+    }
+  }
+
+  // Number the cones in order of first appearance so the partitioning is
+  // deterministic.
+  std::vector<Node*> representatives;
+  absl::flat_hash_map<Node*, int64_t> cone_size;
+  for (Node* node : topo_order) {
+    if (!node->GetType()->IsBits()) {
+      continue;
+    }
+    auto [it, inserted] = cone_size.try_emplace(cones.Find(node), 0);
+    if (inserted) {
+      representatives.push_back(it->first);
+    }
+    ++it->second;
+  }
+  absl::c_stable_sort(representatives, [&](Node* a, Node* b) {
+    return cone_size.at(a) > cone_size.at(b);
+  });
+
+  // Greedily assign the largest remaining cone to the smallest partition.
+  std::vector<int64_t> partition_size(
+      std::min<int64_t>(max_partitions, representatives.size()), 0);
+  absl::flat_hash_map<Node*, int64_t> cone_partition;
+  for (Node* representative : representatives) {
+    int64_t partition = std::distance(partition_size.begin(),
+                                      absl::c_min_element(partition_size));
+    cone_partition[representative] = partition;
+    partition_size[partition] += cone_size.at(representative);
+  }
+  std::vector<std::vector<Node*>> partitions(partition_size.size());
+  for (Node* node : topo_order) {
+    if (node->GetType()->IsBits()) {
+      partitions[cone_partition.at(cones.Find(node))].push_back(node);
+    }
+  }
+  return partitions;
+}
+
 // Data structure which aggregates BDD performance statistics across ops.
 class BddStatistics {
  public:
@@ -327,28 +401,87 @@ class BddStatistics {
 
 /* static */ absl::StatusOr<std::unique_ptr<BddFunction>> BddFunction::Run(
     FunctionBase* f, int64_t path_limit,
-    std::optional<std::function<bool(const Node*)>> node_filter) {
+    std::optional<std::function<bool(const Node*)>> node_filter,
+    int64_t max_threads) {
   VLOG(1) << absl::StreamFormat("BddFunction::Run(%s), %d nodes:", f->name(),
                                 f->node_count());
   XLS_VLOG_LINES(5, f->DumpIr());
 
-  auto bdd_function = absl::WrapUnique(new BddFunction(f));
-  SaturatingBddEvaluator evaluator(path_limit, &bdd_function->bdd());
+  std::vector<Node*> topo_order = TopoSort(f);
+  int64_t max_partitions = max_threads;
+  if (max_partitions <= 0) {
+    max_partitions =
+        std::min<int64_t>(std::max(1, AvailableCPUs()),
+                          f->node_count() / kMinNodesPerThread);
+  }
+  if (max_partitions <= 1) {
+    auto bdd_function = absl::WrapUnique(new BddFunction(f));
+    XLS_RETURN_IF_ERROR(
+        bdd_function->EvaluateNodes(topo_order, path_limit, node_filter));
+    return std::move(bdd_function);
+  }
+
+  // Evaluate the independent cones of the function concurrently in separate
+  // BDDs. Evaluation only reads the IR.
+  std::vector<std::vector<Node*>> partitions =
+      PartitionIntoCones(topo_order, node_filter, max_partitions);
+  VLOG(2) << absl::StreamFormat("Evaluating %d partitions concurrently",
+                                partitions.size());
+  std::vector<std::unique_ptr<BddFunction>> partition_functions;
+  std::vector<absl::Status> statuses(partitions.size());
+  partition_functions.reserve(partitions.size());
+  for (int64_t i = 0; i < partitions.size(); ++i) {
+    partition_functions.push_back(absl::WrapUnique(new BddFunction(f)));
+  }
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(partitions.size());
+    for (int64_t i = 0; i < partitions.size(); ++i) {
+      threads.push_back(std::make_unique<Thread>([&, i]() {
+        statuses[i] = partition_functions[i]->EvaluateNodes(
+            partitions[i], path_limit, node_filter);
+      }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+
+  // The cones share no BDD variables so the BDDs can be merged by giving each
+  // partition its own range of variables.
+  if (partition_functions.empty()) {
+    return absl::WrapUnique(new BddFunction(f));
+  }
+  std::unique_ptr<BddFunction> bdd_function =
+      std::move(partition_functions.front());
+  for (int64_t i = 1; i < partition_functions.size(); ++i) {
+    bdd_function->Absorb(*partition_functions[i]);
+  }
+  return std::move(bdd_function);
+}
+
+absl::Status BddFunction::EvaluateNodes(
+    absl::Span<Node* const> nodes, int64_t path_limit,
+    const std::optional<std::function<bool(const Node*)>>& node_filter) {
+  SaturatingBddEvaluator evaluator(path_limit, &bdd());
 
   // Create and return a vector containing newly defined BDD variables.
   auto create_new_node_vector = [&](Node* n) {
     SaturatingBddNodeVector v(n->BitCountOrDie());
     for (int64_t i = 0; i < n->BitCountOrDie(); ++i) {
-      v[i] = bdd_function->bdd().NewVariable();
+      v[i] = bdd().NewVariable();
     }
-    bdd_function->saturated_expressions_.insert(n);
+    saturated_expressions_.insert(n);
     return v;
   };
 
   VLOG(3) << "BDD expressions:";
   absl::flat_hash_map<Node*, SaturatingBddNodeVector> values;
   BddStatistics bdd_stats;
-  for (Node* node : TopoSort(f)) {
+  for (Node* node : nodes) {
     VLOG(3) << "node: " << node->ToString();
     if (!node->GetType()->IsBits()) {
       VLOG(3) << "  skipping node, type is not bits: "
@@ -364,10 +497,7 @@ class BddStatistics {
     // If we shouldn't evaluate this node, the node is to be modeled as
     // variables, or the node includes some non-bits-typed operands, then just
     // create a vector of new BDD variables for this node.
-    if (!ShouldEvaluate(node) ||
-        (node_filter.has_value() && !node_filter.value()(node)) ||
-        std::any_of(node->operands().begin(), node->operands().end(),
-                    [](Node* o) { return !o->GetType()->IsBits(); })) {
+    if (!IsEvaluatedFromOperands(node, node_filter)) {
       VLOG(3) << "  node filtered out.";
       values[node] = create_new_node_vector(node);
     } else {
@@ -386,8 +516,8 @@ class BddStatistics {
       // limit.
       for (SaturatingBddNodeIndex& value : values.at(node)) {
         if (std::holds_alternative<TooManyPaths>(value)) {
-          bdd_function->saturated_expressions_.insert(node);
-          value = bdd_function->bdd().NewVariable();
+          saturated_expressions_.insert(node);
+          value = bdd().NewVariable();
         }
       }
     }
@@ -396,14 +526,25 @@ class BddStatistics {
       for (int64_t i = 0; i < node->BitCountOrDie(); ++i) {
         VLOG(5) << absl::StreamFormat(
             "    bit %d : %s", i,
-            bdd_function->bdd().ToStringDnf(
-                std::get<BddNodeIndex>(values.at(node)[i]),
-                /*minterm_limit=*/15));
+            bdd().ToStringDnf(std::get<BddNodeIndex>(values.at(node)[i]),
+                              /*minterm_limit=*/15));
       }
     }
     if (stop_watch.has_value()) {
       bdd_stats.AddOp(node->op(), stop_watch->GetElapsedTime());
     }
+
+    // Free the intermediate BDD nodes created while evaluating previous nodes.
+    // All TooManyPaths values have been replaced at this point.
+    if (ShouldCollectGarbage()) {
+      std::vector<BddNodeIndex> roots;
+      for (const auto& [_, node_values] : values) {
+        for (const SaturatingBddNodeIndex& value : node_values) {
+          roots.push_back(std::get<BddNodeIndex>(value));
+        }
+      }
+      CollectGarbage(roots);
+    }
   }
   XLS_VLOG_LINES(2, bdd_stats.ToString());
 
@@ -411,9 +552,54 @@ class BddStatistics {
   // via the BddFunction interface. At this point any TooManyPaths sentinel
   // values have been replaced with new Bdd variables.
   for (const auto& pair : values) {
-    bdd_function->node_map_[pair.first] = ToBddNodeVector(pair.second);
+    node_map_[pair.first] = ToBddNodeVector(pair.second);
   }
-  return std::move(bdd_function);
+  return absl::OkStatus();
+}
+
+void BddFunction::Absorb(const BddFunction& other) {
+  std::vector<BddNodeIndex> roots;
+  for (const auto& [node, bdd_nodes] : other.node_map_) {
+    roots.insert(roots.end(), bdd_nodes.begin(), bdd_nodes.end());
+  }
+  std::vector<BddNodeIndex> imported = bdd_.Import(other.bdd_, roots);
+  auto imported_it = imported.begin();
+  for (const auto& [node, bdd_nodes] : other.node_map_) {
+    node_map_[node] =
+        BddNodeVector(imported_it, imported_it + bdd_nodes.size());
+    imported_it += bdd_nodes.size();
+  }
+  saturated_expressions_.insert(other.saturated_expressions_.begin(),
+                                other.saturated_expressions_.end());
+}
+
+void BddFunction::CollectGarbage(absl::Span<const BddNodeIndex> roots) {
+  int64_t freed = bdd_.GarbageCollect(roots);
+  garbage_collection_threshold_ =
+      std::max(kMinGarbageCollectionSize, 2 * bdd_.size());
+  VLOG(2) << absl::StreamFormat(
+      "BddFunction(%s): collected %d BDD nodes, %d remain", func_base_->name(),
+      freed, bdd_.size());
+}
+
+void BddFunction::MaybeCollectGarbage() {
+  if (!ShouldCollectGarbage()) {
+    return;
+  }
+  std::vector<BddNodeIndex> roots;
+  for (const auto& [node, bdd_nodes] : node_map_) {
+    roots.insert(roots.end(), bdd_nodes.begin(), bdd_nodes.end());
+  }
+  CollectGarbage(roots);
+}
+
+int64_t BddFunction::EstimateMemoryUsage() const {
+  int64_t bytes = bdd_.EstimateMemoryUsage() + EstimateHeapBytes(node_map_) +
+                  EstimateHeapBytes(saturated_expressions_);
+  for (const auto& [node, bdd_nodes] : node_map_) {
+    bytes += EstimateHeapBytes(bdd_nodes);
+  }
+  return bytes;
 }
 
 absl::StatusOr<Value> BddFunction::Evaluate(
@@ -65,10 +65,18 @@ class BddFunction {
   // for which no information is known. If `node_filter` returns true, the node
   // still might *not* be evaluated because some kinds of nodes are never
   // evaluated for various reasons including computation expense.
+  //
+  // Nodes are partitioned into independent cones (sets of nodes whose BDDs
+  // share no variables) which are evaluated concurrently in separate BDDs on
+  // up to `max_threads` threads and then merged into a single BDD. The result
+  // is the same regardless of the number of threads. If `max_threads` is zero
+  // the number of available CPUs is used and small functions are evaluated on
+  // the calling thread.
   static absl::StatusOr<std::unique_ptr<BddFunction>> Run(
       FunctionBase* f, int64_t path_limit = 0,
       std::optional<std::function<bool(const Node*)>> node_filter =
-          std::nullopt);
+          std::nullopt,
+      int64_t max_threads = 0);
 
   // Returns the underlying BDD.
   const BinaryDecisionDiagram& bdd() const { return bdd_; }
@@ -87,9 +95,42 @@ class BddFunction {
   // FunctionBase used to build the BddFunction must be a function not a proc.
   absl::StatusOr<Value> Evaluate(absl::Span<const Value> args) const;
 
+  // Returns an estimate of the heap memory in bytes used by the BDD and the
+  // mapping from XLS nodes to BDD nodes.
+  int64_t EstimateMemoryUsage() const;
+
+  // Frees the BDD nodes which are not reachable from the BDD nodes of the XLS
+  // nodes if the BDD has doubled in size since the last collection. Callers
+  // must not hold on to BDD nodes other than those returned by GetBddNode
+  // across this call.
+  void MaybeCollectGarbage();
+
  private:
+  // The minimum number of BDD nodes before garbage is collected.
+  static constexpr int64_t kMinGarbageCollectionSize = int64_t{1} << 16;
+
+  // The minimum number of XLS nodes evaluated by each thread when the number
+  // of threads is chosen automatically.
+  static constexpr int64_t kMinNodesPerThread = 1024;
+
   explicit BddFunction(FunctionBase* f) : func_base_(f) {}
 
+  // Evaluates `nodes` in the BDD. `nodes` must be in topological order and
+  // include the operands of every node whose value is computed from its
+  // operands.
+  absl::Status EvaluateNodes(
+      absl::Span<Node* const> nodes, int64_t path_limit,
+      const std::optional<std::function<bool(const Node*)>>& node_filter);
+
+  // Copies the BDD expressions of the nodes of `other`, which must be disjoint
+  // from the nodes of this BddFunction, into this BddFunction.
+  void Absorb(const BddFunction& other);
+
+  bool ShouldCollectGarbage() const {
+    return bdd_.size() >= garbage_collection_threshold_;
+  }
+  void CollectGarbage(absl::Span<const BddNodeIndex> roots);
+
   FunctionBase* func_base_;
   BinaryDecisionDiagram bdd_;
 
@@ -102,6 +143,9 @@ class BddFunction {
   // BDD. These are the XLS Nodes for which it was determined the precisely
   // computing the expression for the node using the BDD was too expensive.
   absl::flat_hash_set<Node*> saturated_expressions_;
+
+  // The size of the BDD at which garbage is next collected.
+  int64_t garbage_collection_threshold_ = kMinGarbageCollectionSize;
 };
 
 // Returns true if the given node is very cheap to evaluate using a
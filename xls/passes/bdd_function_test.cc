@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <random>
 #include <string>
 #include <vector>
@@ -23,6 +24,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
+#include "xls/data_structures/binary_decision_diagram.h"
 #include "xls/dslx/ir_convert/ir_converter.h"
 #include "xls/dslx/parse_and_typecheck.h"
 #include "xls/examples/sample_packages.h"
@@ -118,6 +120,45 @@ TEST_F(BddFunctionTest, Parity) {
   }
 }
 
+TEST_F(BddFunctionTest, IndependentCones) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* t = p->GetBitsType(8);
+  BValue x = fb.Param("x", t);
+  BValue y = fb.Param("y", t);
+  BValue z = fb.Param("z", t);
+  BValue w = fb.Param("w", t);
+  BValue x_and_y = fb.And(x, y);
+  BValue z_or_not_z = fb.Or(z, fb.Not(z));
+  BValue w_xor_w = fb.Xor(w, fb.Identity(w));
+  fb.Tuple({x_and_y, z_or_not_z, w_xor_w});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  std::minstd_rand engine;
+  for (int64_t max_threads : {1, 2, 3, 8}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<BddFunction> bdd_function,
+        BddFunction::Run(f, /*path_limit=*/0, /*node_filter=*/std::nullopt,
+                         max_threads));
+    const BinaryDecisionDiagram& bdd = bdd_function->bdd();
+    for (int64_t i = 0; i < 8; ++i) {
+      EXPECT_EQ(bdd_function->GetBddNode(z_or_not_z.node(), i), bdd.one());
+      EXPECT_EQ(bdd_function->GetBddNode(w_xor_w.node(), i), bdd.zero());
+      EXPECT_NE(bdd_function->GetBddNode(x_and_y.node(), i),
+                bdd_function->GetBddNode(x.node(), i));
+      EXPECT_NE(bdd_function->GetBddNode(x.node(), i),
+                bdd_function->GetBddNode(y.node(), i));
+    }
+    for (int64_t i = 0; i < 32; ++i) {
+      std::vector<Value> inputs = RandomFunctionArguments(f, engine);
+      XLS_ASSERT_OK_AND_ASSIGN(
+          Value expected, DropInterpreterEvents(InterpretFunction(f, inputs)));
+      XLS_ASSERT_OK_AND_ASSIGN(Value actual, bdd_function->Evaluate(inputs));
+      EXPECT_EQ(expected, actual);
+    }
+  }
+}
+
 TEST_F(BddFunctionTest, BenchmarkTest) {
   // Run samples through various benchmarks and verify against the interpreter.
   //
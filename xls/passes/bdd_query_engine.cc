@@ -21,6 +21,7 @@
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/data_structures/binary_decision_diagram.h"
 #include "xls/ir/bits.h"
@@ -72,6 +73,21 @@ absl::StatusOr<ReachedFixpoint> BddQueryEngine::Populate(FunctionBase* f) {
   return rf;
 }
 
+int64_t BddQueryEngine::EstimateMemoryUsage() const {
+  int64_t bytes =
+      EstimateHeapBytes(known_bits_) + EstimateHeapBytes(bits_values_);
+  for (const auto& [node, bits] : known_bits_) {
+    bytes += EstimateHeapBytes(bits);
+  }
+  for (const auto& [node, bits] : bits_values_) {
+    bytes += EstimateHeapBytes(bits);
+  }
+  if (bdd_function_ != nullptr) {
+    bytes += bdd_function_->EstimateMemoryUsage();
+  }
+  return bytes;
+}
+
 bool BddQueryEngine::AtMostOneTrue(
     absl::Span<TreeBitLocation const> bits) const {
   // Computing this property is quadratic (at least) so limit the width.
@@ -80,13 +96,15 @@ bool BddQueryEngine::AtMostOneTrue(
     return false;
   }
 
-  BddNodeIndex result = bdd().zero();
   for (const TreeBitLocation& loc : bits) {
     if (!IsTracked(loc.node())) {
       return false;
     }
   }
 
+  MaybeCollectGarbage();
+  BddNodeIndex result = bdd().zero();
+
   // Compute the OR-reduction of a pairwise AND of all bits. If this value is
   // zero then no two bits can be simultaneously true. Equivalently: at most one
   // bit is true.
@@ -105,6 +123,7 @@ bool BddQueryEngine::AtMostOneTrue(
 
 bool BddQueryEngine::AtLeastOneTrue(
     absl::Span<TreeBitLocation const> bits) const {
+  MaybeCollectGarbage();
   BddNodeIndex result = bdd().zero();
   // At least one bit is true is equivalent to an OR-reduction of all the bits.
   for (const TreeBitLocation& location : bits) {
@@ -131,6 +150,7 @@ bool BddQueryEngine::Implies(const TreeBitLocation& a,
   if (!IsTracked(a.node()) || !IsTracked(b.node())) {
     return false;
   }
+  MaybeCollectGarbage();
   return Implies(GetBddNode(a), GetBddNode(b));
 }
 
@@ -140,6 +160,7 @@ std::optional<Bits> BddQueryEngine::ImpliedNodeValue(
   if (!IsTracked(node) || !node->GetType()->IsBits()) {
     return std::nullopt;
   }
+  MaybeCollectGarbage();
 
   // Create a Bdd node for the predicate_bit_values.
   BddNodeIndex bdd_predicate_bit = bdd().one();
@@ -194,6 +215,7 @@ bool BddQueryEngine::KnownNotEquals(const TreeBitLocation& a,
   if (!IsTracked(a.node()) || !IsTracked(b.node())) {
     return false;
   }
+  MaybeCollectGarbage();
   return GetBddNode(a) == bdd().Not(GetBddNode(b));
 }
 
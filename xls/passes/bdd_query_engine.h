@@ -78,6 +78,8 @@ class BddQueryEngine : public QueryEngine {
   bool KnownNotEquals(const TreeBitLocation& a,
                       const TreeBitLocation& b) const override;
 
+  int64_t EstimateMemoryUsage() const override;
+
   // Returns the underlying BddFunction representing the XLS function.
   const BddFunction& bdd_function() const { return *bdd_function_; }
 
@@ -88,6 +90,11 @@ class BddQueryEngine : public QueryEngine {
   // TODO(meheff): Enable queries on a BDD with out mutating the BDD itself.
   BinaryDecisionDiagram& bdd() const { return bdd_function_->bdd(); }
 
+  // Frees the intermediate BDD nodes created by previous queries if the BDD has
+  // grown large. Queries which create BDD nodes call this on entry, when no
+  // intermediate nodes are live.
+  void MaybeCollectGarbage() const { bdd_function_->MaybeCollectGarbage(); }
+
   // Returns the BDD node associated with the given bit.
   BddNodeIndex GetBddNode(const TreeBitLocation& location) const {
     CHECK(location.tree_index().empty());
@@ -16,13 +16,16 @@
 
 #include <vector>
 
+#include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/inlined_vector.h"
 #include "xls/common/status/matchers.h"
 #include "xls/data_structures/binary_decision_diagram.h"
+#include "xls/ir/benchmark_support.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/package.h"
@@ -291,5 +294,44 @@ TEST_F(BddQueryEngineTest, BitValuesImplyNodeValuePredicateAlwaysFalse) {
   EXPECT_FALSE(result.has_value());
 }
 
+// Measures populating the query engine for generated designs of increasing
+// size, and reports its complexity in the size.
+void BM_PopulateScaling(benchmark::State& state,
+                        benchmark_support::ScalingDesign design) {
+  Package package("BM");
+  XLS_ASSERT_OK_AND_ASSIGN(FunctionBase * f,
+                           benchmark_support::GenerateScalingDesign(
+                               design, &package, state.range(0)));
+  for (auto _ : state) {
+    BddQueryEngine query_engine;
+    XLS_ASSERT_OK_AND_ASSIGN(auto r, query_engine.Populate(f));
+    benchmark::DoNotOptimize(r);
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+void ScalingArgs(benchmark::internal::Benchmark* b) {
+  b->RangeMultiplier(4)->Range(16, 1024)->Complexity();
+}
+
+BENCHMARK_CAPTURE(BM_PopulateScaling, chain,
+                  benchmark_support::ScalingDesign::kChain)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_PopulateScaling, balanced_tree,
+                  benchmark_support::ScalingDesign::kBalancedTree)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_PopulateScaling, ladder,
+                  benchmark_support::ScalingDesign::kLadder)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_PopulateScaling, large_select,
+                  benchmark_support::ScalingDesign::kLargeSelect)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_PopulateScaling, dynamic_array,
+                  benchmark_support::ScalingDesign::kDynamicArray)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_PopulateScaling, wide_state_proc,
+                  benchmark_support::ScalingDesign::kWideStateProc)
+    ->Apply(ScalingArgs);
+
 }  // namespace
 }  // namespace xls
@@ -348,6 +348,9 @@ absl::StatusOr<bool> BddSimplificationPass::RunOnFunctionBaseInternal(
 
   UnionQueryEngine query_engine(std::move(query_engines));
   XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
+  if (options.record_memory_usage) {
+    results->RecordAnalysisMemoryUsage(query_engine.EstimateMemoryUsage());
+  }
 
   bool modified = false;
   for (Node* node : TopoSort(f)) {
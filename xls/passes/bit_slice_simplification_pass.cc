@@ -49,21 +49,21 @@
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/query_engine.h"
-#include "xls/passes/range_query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/stateless_query_engine.h"
-#include "xls/passes/ternary_query_engine.h"
 #include "xls/passes/union_query_engine.h"
 
 namespace xls {
 namespace {
 
 static absl::StatusOr<std::unique_ptr<QueryEngine>> GetQueryEngine(
-    FunctionBase* f, int64_t opt_level) {
+    FunctionBase* f, int64_t opt_level,
+    const OptimizationPassOptions& options) {
   std::vector<std::unique_ptr<QueryEngine>> engines;
   engines.push_back(std::make_unique<StatelessQueryEngine>());
-  engines.push_back(std::make_unique<TernaryQueryEngine>());
+  engines.push_back(MakeTernaryQueryEngine(options));
   if (opt_level >= 3) {
-    engines.push_back(std::make_unique<RangeQueryEngine>());
+    engines.push_back(MakeRangeQueryEngine(options));
   }
   auto query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
 
@@ -818,7 +818,7 @@ absl::StatusOr<bool> BitSliceSimplificationPass::RunOnFunctionBaseInternal(
   bool changed = false;
 
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<QueryEngine> query_engine,
-                       GetQueryEngine(f, opt_level_));
+                       GetQueryEngine(f, opt_level_, options));
 
   // Iterating through these operations in reverse topological order makes sure
   // we don't need to re-populate the query engine between nodes.
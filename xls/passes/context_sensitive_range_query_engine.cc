@@ -28,9 +28,11 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/data_structures/inline_bitmap.h"
@@ -120,19 +122,16 @@ class InterestingNodeFinder final : public DfsVisitorWithDefault {
 
 // Class to hold givens extracted from select context.
 //
-// This also restricts the range analysis to end at the select we are
-// specializing on since nodes below it can only be specialized to this select
-// if we moved them into the selects branches. This sort of transform is not one
-// we currently perform.
+// This also restricts the range analysis to the given nodes. For a select
+// context these end before the select we are specializing on since nodes below
+// it can only be specialized to this select if we moved them into the selects
+// branches. This sort of transform is not one we currently perform.
 class ContextGivens final : public RangeDataProvider {
  public:
-  ContextGivens(const std::vector<Node*>& topo_sort, const Node* finish,
+  ContextGivens(absl::Span<Node* const> nodes,
                 const absl::flat_hash_map<Node*, RangeData>& data,
                 std::function<std::optional<RangeData>(Node*)> memoized_data)
-      : topo_sort_(topo_sort),
-        finish_(finish),
-        data_(data),
-        memoized_data_(std::move(memoized_data)) {}
+      : nodes_(nodes), data_(data), memoized_data_(std::move(memoized_data)) {}
 
   std::optional<RangeData> GetKnownIntervals(Node* node) final {
     if (data_.contains(node)) {
@@ -142,19 +141,15 @@ class ContextGivens final : public RangeDataProvider {
   }
 
   absl::Status IterateFunction(DfsVisitor* visitor) final {
-    for (Node* n : topo_sort_) {
-      if (n == finish_) {
-        break;
-      }
+    for (Node* n : nodes_) {
       XLS_RETURN_IF_ERROR(n->VisitSingleNode(visitor));
     }
     return absl::OkStatus();
   }
 
  private:
-  const std::vector<Node*>& topo_sort_;
-  const Node* finish_;
-  const absl::flat_hash_map<Node*, RangeData> data_;
+  absl::Span<Node* const> nodes_;
+  const absl::flat_hash_map<Node*, RangeData>& data_;
   std::function<std::optional<RangeData>(Node*)> memoized_data_;
 };
 
@@ -185,15 +180,17 @@ struct EquivalenceSet {
 // does not own the arena/map that it fills in.
 class Analysis {
  public:
-  struct InterestingStatesAndNodeList {
-    absl::flat_hash_map<Node*, int64_t> node_indices;
-    std::vector<std::pair<PredicateState, InlineBitmap>> state_and_nodes;
-  };
   Analysis(
       RangeQueryEngine& base_range,
       std::vector<std::unique_ptr<const RangeQueryEngine>>& arena,
-      absl::flat_hash_map<PredicateState, const RangeQueryEngine*>& engines)
-      : base_range_(base_range), arena_(arena), engines_(engines) {}
+      absl::flat_hash_map<PredicateState, const RangeQueryEngine*>& engines,
+      std::optional<int64_t> node_evaluation_budget,
+      ContextSensitiveRangeQueryEngine::Stats& stats)
+      : base_range_(base_range),
+        arena_(arena),
+        engines_(engines),
+        node_evaluation_budget_(node_evaluation_budget),
+        stats_(stats) {}
 
   absl::StatusOr<ReachedFixpoint> Execute(FunctionBase* f) {
     // Get the topological sort once so we don't recalculate it each time.
@@ -201,7 +198,7 @@ class Analysis {
     // Get the base case.
     absl::flat_hash_map<Node*, RangeData> empty;
     ContextGivens base_givens(
-        topo_sort_, /*finish=*/nullptr,
+        topo_sort_,
         /* data=*/empty,
         [](auto n) -> std::optional<RangeData> { return std::nullopt; });
     XLS_RETURN_IF_ERROR(base_range_.PopulateWithGivens(base_givens).status());
@@ -221,38 +218,55 @@ class Analysis {
         }
       }
     }
+    stats_.contexts += all_states.size();
     XLS_ASSIGN_OR_RETURN(auto interesting,
                          FilterUninterestingStates(f, all_states));
+    stats_.uninteresting_contexts += all_states.size() - interesting.size();
     // Bucket states into equivalence classes. Any predicate-states where the
-    // arm and selector are identical
-    absl::flat_hash_map<SelectorAndArm, EquivalenceSet> equivalences;
-    equivalences.reserve(interesting.state_and_nodes.size());
-    for (auto [state, interesting_nodes] : interesting.state_and_nodes) {
-      EquivalenceSet& cur =
-          equivalences
-              .try_emplace(
-                  SelectorAndArm{
-                      .selector = state.node()->As<Select>()->selector(),
-                      .arm = state.arm()},
-                  EquivalenceSet{
-                      .equivalent_states = {},
-                      .interesting_nodes = InlineBitmap(f->node_count())})
-              .first->second;
+    // arm and selector are identical. The classes are kept in the (topological)
+    // order of their first state so that the contexts which fit in the budget
+    // are deterministic.
+    absl::flat_hash_map<SelectorAndArm, int64_t> equivalence_indices;
+    std::vector<EquivalenceSet> equivalences;
+    equivalence_indices.reserve(interesting.size());
+    for (auto [state, interesting_nodes] : interesting) {
+      auto [it, inserted] = equivalence_indices.try_emplace(
+          SelectorAndArm{.selector = state.node()->As<Select>()->selector(),
+                         .arm = state.arm()},
+          equivalences.size());
+      if (inserted) {
+        equivalences.push_back(EquivalenceSet{
+            .equivalent_states = {},
+            .interesting_nodes = InlineBitmap(f->node_index_bound())});
+      }
+      EquivalenceSet& cur = equivalences[it->second];
       cur.equivalent_states.push_back(state);
       cur.interesting_nodes.Union(interesting_nodes);
     }
-    // NB We don't care what order we examine each equivalence (since all are
-    // disjoint).
-    for (const auto& [_, states] : equivalences) {
+    for (const EquivalenceSet& states : equivalences) {
       // Since the all_states_ is in topo the last equiv state is usable for
       // everything.
       // We don't care what order we calculate the equivalences because each is
       // fully disjoint from one another as we consider only a single condition
       // to be true at a time.
-      XLS_ASSIGN_OR_RETURN(auto tmp,
-                           CalculateRangeGiven(states.equivalent_states.back(),
-                                               states.interesting_nodes,
-                                               interesting.node_indices));
+      const PredicateState& state = states.equivalent_states.back();
+      XLS_ASSIGN_OR_RETURN((absl::flat_hash_map<Node*, RangeData> known_data),
+                           ExtractKnownData(state));
+      std::vector<Node*> nodes =
+          NodesToEvaluate(state, known_data, states.interesting_nodes);
+      if (node_evaluation_budget_.has_value() &&
+          stats_.evaluated_nodes + static_cast<int64_t>(nodes.size()) >
+              *node_evaluation_budget_) {
+        // Without an engine for these states queries fall back to the base
+        // ranges which are still correct, just less precise.
+        ++stats_.skipped_contexts;
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(
+          auto tmp,
+          CalculateRangeGiven(nodes, known_data, states.interesting_nodes));
+      ++stats_.analyzed_contexts;
+      stats_.evaluated_nodes += nodes.size();
       auto result =
           arena_
               .emplace_back(std::make_unique<RangeQueryEngine>(std::move(tmp)))
@@ -269,8 +283,12 @@ class Analysis {
   // anything. A predicate state where the values that impact the selector don't
   // impact the selected value in any meaningful way will not show any
   // differences in the calculated ranges so no need to calculate them at all.
-  absl::StatusOr<InterestingStatesAndNodeList> FilterUninterestingStates(
-      FunctionBase* f, const std::vector<PredicateState>& states) {
+  //
+  // Returns the remaining states along with the nodes affected by the known
+  // data of each as a bitmap indexed by Node::node_index().
+  absl::StatusOr<std::vector<std::pair<PredicateState, InlineBitmap>>>
+  FilterUninterestingStates(FunctionBase* f,
+                            const std::vector<PredicateState>& states) {
     std::vector<Node*> select_nodes;
     std::vector<Node*> selectee_nodes;
     // Calculate all nodes which depend on or are depended on by either selector
@@ -294,7 +312,7 @@ class Analysis {
       // If there's any node which is both an input into the select value and
       // affected by something the conditional specialization can discover we
       // consider it interesting.
-      InlineBitmap forward_bm(f->node_count(), false);
+      InlineBitmap forward_bm(f->node_index_bound(), false);
       // What nodes do we care about for this specific run. Since this basically
       // only depends on the input node no need to memoize it.
       XLS_ASSIGN_OR_RETURN(
@@ -315,20 +333,44 @@ class Analysis {
         interesting_states.push_back({ps, std::move(forward_bm)});
       }
     }
-    return InterestingStatesAndNodeList{
-        .node_indices = backwards_interesting.node_indices(),
-        .state_and_nodes = interesting_states};
+    return interesting_states;
+  }
+  // Returns the nodes, in topological order, which need to be evaluated to
+  // find the ranges given `s`. These are the nodes before the select of `s`
+  // which have known data or whose ranges might be changed by the known data
+  // along with the operands of the latter. The ranges of the operands are
+  // copied from the base ranges. Every other node keeps its base ranges, which
+  // the proxy engine falls back to, so the data of the unaffected parts of the
+  // function is shared with the base case rather than recomputed.
+  std::vector<Node*> NodesToEvaluate(
+      PredicateState s, const absl::flat_hash_map<Node*, RangeData>& known_data,
+      const InlineBitmap& interesting_nodes) const {
+    absl::flat_hash_set<Node*> needed;
+    auto finish = absl::c_find(topo_sort_, s.node());
+    for (auto it = topo_sort_.begin(); it != finish; ++it) {
+      Node* n = *it;
+      if (known_data.contains(n)) {
+        needed.insert(n);
+      } else if (interesting_nodes.Get(n->node_index())) {
+        needed.insert(n);
+        needed.insert(n->operands().begin(), n->operands().end());
+      }
+    }
+    std::vector<Node*> nodes;
+    nodes.reserve(needed.size());
+    std::copy_if(topo_sort_.begin(), finish, std::back_inserter(nodes),
+                 [&](Node* n) { return needed.contains(n); });
+    return nodes;
   }
+
   absl::StatusOr<RangeQueryEngine> CalculateRangeGiven(
-      PredicateState s, const InlineBitmap& interesting_nodes,
-      const absl::flat_hash_map<Node*, int64_t>& node_ids) const {
+      absl::Span<Node* const> nodes,
+      const absl::flat_hash_map<Node*, RangeData>& known_data,
+      const InlineBitmap& interesting_nodes) const {
     RangeQueryEngine result;
-    absl::flat_hash_map<Node*, RangeData> known_data;
-    XLS_ASSIGN_OR_RETURN(known_data, ExtractKnownData(s));
     ContextGivens givens(
-        topo_sort_, s.node(), known_data,
-        [&](Node* n) -> std::optional<RangeData> {
-          if (interesting_nodes.Get(node_ids.at(n))) {
+        nodes, known_data, [&](Node* n) -> std::optional<RangeData> {
+          if (interesting_nodes.Get(n->node_index())) {
             // Affected by known data.
             return std::nullopt;
           }
@@ -379,6 +421,8 @@ class Analysis {
   RangeQueryEngine& base_range_;
   std::vector<std::unique_ptr<const RangeQueryEngine>>& arena_;
   absl::flat_hash_map<PredicateState, const RangeQueryEngine*>& engines_;
+  std::optional<int64_t> node_evaluation_budget_;
+  ContextSensitiveRangeQueryEngine::Stats& stats_;
 };
 
 // A proxy query engine which specializes using select context.
@@ -484,8 +528,26 @@ class ProxyContextQueryEngine final : public QueryEngine {
 
 absl::StatusOr<ReachedFixpoint> ContextSensitiveRangeQueryEngine::Populate(
     FunctionBase* f) {
-  Analysis analysis(base_case_ranges_, arena_, one_hot_ranges_);
-  return analysis.Execute(f);
+  stats_ = Stats();
+  Analysis analysis(base_case_ranges_, arena_, one_hot_ranges_,
+                    node_evaluation_budget_, stats_);
+  XLS_ASSIGN_OR_RETURN(ReachedFixpoint rf, analysis.Execute(f));
+  VLOG(2) << "Context sensitive range analysis of " << f->name() << ": "
+          << stats_.analyzed_contexts << " contexts analyzed ("
+          << stats_.evaluated_nodes << " node evaluations), "
+          << stats_.skipped_contexts << " skipped over budget, "
+          << stats_.uninteresting_contexts << " of " << stats_.contexts
+          << " contexts uninteresting";
+  return rf;
+}
+
+int64_t ContextSensitiveRangeQueryEngine::EstimateMemoryUsage() const {
+  int64_t bytes = base_case_ranges_.EstimateMemoryUsage() +
+                  EstimateHeapBytes(arena_) + EstimateHeapBytes(one_hot_ranges_);
+  for (const std::unique_ptr<const RangeQueryEngine>& engine : arena_) {
+    bytes += sizeof(RangeQueryEngine) + engine->EstimateMemoryUsage();
+  }
+  return bytes;
 }
 
 std::unique_ptr<QueryEngine>
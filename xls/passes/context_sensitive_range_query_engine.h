@@ -15,6 +15,7 @@
 #ifndef XLS_PASSES_CONTEXT_SENSITIVE_RANGE_QUERY_ENGINE_H_
 #define XLS_PASSES_CONTEXT_SENSITIVE_RANGE_QUERY_ENGINE_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -46,9 +47,36 @@ namespace xls {
 // given their selector is at the appropriate value and propagating that down
 // for each single case. This means the engine is only able to provide
 // information for a single case at a time.
+//
+// Only the nodes whose ranges may be affected by a case are re-evaluated for
+// it; all other ranges are shared with the base case. The total number of node
+// evaluations across all cases may be bounded, in which case the cases which do
+// not fit in the budget (in topological order of their selects) get no
+// specialized information.
 class ContextSensitiveRangeQueryEngine final : public QueryEngine {
  public:
-  ContextSensitiveRangeQueryEngine() = default;
+  // Statistics about the cases analyzed by the last call to Populate.
+  struct Stats {
+    // Number of select cases (including default arms) in the function.
+    int64_t contexts = 0;
+    // Number of cases which can't affect the ranges of the selected values and
+    // so were not analyzed.
+    int64_t uninteresting_contexts = 0;
+    // Number of analyzed sets of cases. Cases of selects sharing a selector
+    // are analyzed together.
+    int64_t analyzed_contexts = 0;
+    // Number of sets of cases which were not analyzed because they did not fit
+    // in the node evaluation budget.
+    int64_t skipped_contexts = 0;
+    // Total number of nodes evaluated for the analyzed cases.
+    int64_t evaluated_nodes = 0;
+  };
+
+  // If `node_evaluation_budget` is set, it bounds the total number of nodes
+  // evaluated for all cases.
+  explicit ContextSensitiveRangeQueryEngine(
+      std::optional<int64_t> node_evaluation_budget = std::nullopt)
+      : node_evaluation_budget_(node_evaluation_budget) {}
 
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
@@ -102,6 +130,10 @@ class ContextSensitiveRangeQueryEngine final : public QueryEngine {
     return base_case_ranges_.ImpliedNodeValue(predicate_bit_values, node);
   }
 
+  int64_t EstimateMemoryUsage() const override;
+
+  const Stats& stats() const { return stats_; }
+
   // Specialize the query engine for the given predicate. For now only a state
   // set with a single element is supported. This is CHECK'd internally to avoid
   // surprising non-deterministic behavior. In the future we might relax this
@@ -110,6 +142,8 @@ class ContextSensitiveRangeQueryEngine final : public QueryEngine {
       const absl::flat_hash_set<PredicateState>& state) const override;
 
  private:
+  std::optional<int64_t> node_evaluation_budget_;
+  Stats stats_;
   RangeQueryEngine base_case_ranges_;
   std::vector<std::unique_ptr<const RangeQueryEngine>> arena_;
   absl::flat_hash_map<PredicateState, const RangeQueryEngine*>
@@ -1715,6 +1715,85 @@ TEST_F(ContextSensitiveRangeQueryEngineTest, HandlesAllArms) {
             add_ten_alternate_ist);
 }
 
+TEST_F(ContextSensitiveRangeQueryEngineTest, OnlyEvaluatesAffectedNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+
+  // if (x <= 8) { x + (y + 1 + 1 + 1 + 1) } else { x }
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue y_chain = y;
+  for (int64_t i = 0; i < 4; ++i) {
+    y_chain = fb.Add(y_chain, fb.Literal(UBits(1, 8)));
+  }
+  BValue x_plus_y = fb.Add(x, y_chain);
+  BValue cond = fb.ULe(x, fb.Literal(UBits(8, 8)));
+  BValue res = fb.Select(cond, {x, x_plus_y});
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  ContextSensitiveRangeQueryEngine engine;
+
+  XLS_ASSERT_OK(engine.Populate(f));
+
+  EXPECT_EQ(engine.stats().contexts, 2);
+  EXPECT_EQ(engine.stats().skipped_contexts, 0);
+  EXPECT_GT(engine.stats().analyzed_contexts, 0);
+  // The chain of adds on `y` is unaffected by the condition so only its result
+  // (as an operand of `x_plus_y`) is looked at for each context.
+  EXPECT_LT(engine.stats().evaluated_nodes,
+            engine.stats().analyzed_contexts * f->node_count() - 4);
+
+  auto consequent_arm_range = engine.SpecializeGivenPredicate(
+      {PredicateState(res.node()->As<Select>(), kConsequentArm)});
+  EXPECT_EQ(consequent_arm_range->GetIntervals(x.node()),
+            BitsLTT(x.node(), {Interval(UBits(0, 8), UBits(8, 8))}));
+  EXPECT_EQ(consequent_arm_range->GetIntervals(y_chain.node()),
+            engine.GetIntervals(y_chain.node()));
+}
+
+TEST_F(ContextSensitiveRangeQueryEngineTest, NodeEvaluationBudget) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+
+  // if (x <= 8) { 10 - x } else { x + 10 }
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue sub_ten = fb.Subtract(fb.Literal(UBits(10, 8)), x);
+  BValue add_ten = fb.Add(x, fb.Literal(UBits(10, 8)));
+  BValue cond = fb.ULe(x, fb.Literal(UBits(8, 8)));
+  BValue res = fb.Select(cond, {add_ten, sub_ten});
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  ContextSensitiveRangeQueryEngine unbounded;
+  XLS_ASSERT_OK(unbounded.Populate(f));
+  ASSERT_EQ(unbounded.stats().analyzed_contexts, 2);
+  ASSERT_GT(unbounded.stats().evaluated_nodes, 0);
+
+  ContextSensitiveRangeQueryEngine engine(
+      /*node_evaluation_budget=*/unbounded.stats().evaluated_nodes - 1);
+  XLS_ASSERT_OK(engine.Populate(f));
+  EXPECT_EQ(engine.stats().contexts, 2);
+  EXPECT_EQ(engine.stats().analyzed_contexts, 1);
+  EXPECT_EQ(engine.stats().skipped_contexts, 1);
+  EXPECT_LT(engine.stats().evaluated_nodes, unbounded.stats().evaluated_nodes);
+
+  // The first context in topological order is analyzed and the second falls
+  // back to the base ranges.
+  auto alternate_arm_range = engine.SpecializeGivenPredicate(
+      {PredicateState(res.node()->As<Select>(), kAlternateArm)});
+  auto consequent_arm_range = engine.SpecializeGivenPredicate(
+      {PredicateState(res.node()->As<Select>(), kConsequentArm)});
+  EXPECT_EQ(alternate_arm_range->GetIntervals(x.node()),
+            BitsLTT(x.node(), {Interval(UBits(9, 8), Bits::AllOnes(8))}));
+  EXPECT_EQ(consequent_arm_range->GetIntervals(x.node()),
+            engine.GetIntervals(x.node()));
+
+  ContextSensitiveRangeQueryEngine no_budget(/*node_evaluation_budget=*/0);
+  XLS_ASSERT_OK(no_budget.Populate(f));
+  EXPECT_EQ(no_budget.stats().analyzed_contexts, 0);
+  EXPECT_EQ(no_budget.stats().skipped_contexts, 2);
+  EXPECT_EQ(no_budget.stats().evaluated_nodes, 0);
+}
+
 INSTANTIATE_TEST_SUITE_P(Signed, SignedContextSensitiveRangeQueryEngineTest,
                          testing::Values(Signedness::kSigned,
                                          Signedness::kUnsigned),
@@ -14,19 +14,28 @@
 
 #include "xls/passes/cse_pass.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/op.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine_cache.h"
 
 namespace xls {
 
@@ -55,70 +64,147 @@ absl::Span<Node* const> GetOperandsForCse(
   return *span_backing_store;
 }
 
+// Returns the hash bucketing potentially common nodes together. The hash is
+// constructed from the op() of the node and the ids of the node's operands.
+int64_t CseHash(Node* n) {
+  std::vector<int64_t> values_to_hash = {static_cast<int64_t>(n->op())};
+  std::vector<Node*> span_backing_store;
+  for (Node* operand : GetOperandsForCse(n, &span_backing_store)) {
+    values_to_hash.push_back(operand->id());
+  }
+  // If this is slow because of many literals, the Literal values could be
+  // combined into the hash. As is, all literals get the same hash value.
+  return absl::Hash<std::vector<int64_t>>()(values_to_hash);
+}
+
 }  // namespace
 
-absl::StatusOr<bool> RunCse(FunctionBase* f,
-                            absl::flat_hash_map<Node*, Node*>* replacements) {
-  // To improve efficiency, bucket potentially common nodes together. The
-  // bucketing is done via an int64_t hash value which is constructed from the
-  // op() of the node and the uid's of the node's operands.
-  auto hasher = absl::Hash<std::vector<int64_t>>();
-  auto node_hash = [&](Node* n) {
-    std::vector<int64_t> values_to_hash = {static_cast<int64_t>(n->op())};
-    std::vector<Node*> span_backing_store;
-    for (Node* operand : GetOperandsForCse(n, &span_backing_store)) {
-      values_to_hash.push_back(operand->id());
-    }
-    // If this is slow because of many literals, the Literal values could be
-    // combined into the hash. As is, all literals get the same hash value.
-    return hasher(values_to_hash);
-  };
+absl::Status CseValueTable::Populate(FunctionBase* f) {
+  buckets_.clear();
+  node_hashes_.clear();
+  pending_.clear();
+  pending_set_.clear();
+  buckets_.reserve(f->node_count());
+  node_hashes_.reserve(f->node_count());
+  // Consider nodes in topological order so that common expressions are found
+  // in a single sweep.
+  for (Node* node : TopoSort(f)) {
+    AddPending(node);
+  }
+  return absl::OkStatus();
+}
 
+absl::Status CseValueTable::UpdateChangedNodes(
+    absl::Span<Node* const> changed_nodes) {
+  for (Node* node : changed_nodes) {
+    // The hash of a node with changed operands is stale so take it out of the
+    // table until it is considered again.
+    RemoveFromBucket(node);
+    AddPending(node);
+  }
+  return absl::OkStatus();
+}
+
+void CseValueTable::ForgetNode(Node* node) {
+  RemoveFromBucket(node);
+  pending_set_.erase(node);
+}
+
+void CseValueTable::RemoveFromBucket(Node* node) {
+  auto it = node_hashes_.find(node);
+  if (it == node_hashes_.end()) {
+    return;
+  }
+  std::vector<Node*>& bucket = buckets_.at(it->second);
+  bucket.erase(std::find(bucket.begin(), bucket.end(), node));
+  if (bucket.empty()) {
+    buckets_.erase(it->second);
+  }
+  node_hashes_.erase(it);
+}
+
+void CseValueTable::AddPending(Node* node) {
+  if (pending_set_.insert(node).second) {
+    pending_.push_back(node);
+  }
+}
+
+absl::StatusOr<bool> CseValueTable::Run(
+    absl::flat_hash_map<Node*, Node*>* replacements) {
   bool changed = false;
-  absl::flat_hash_map<int64_t, std::vector<Node*>> node_buckets;
-  node_buckets.reserve(f->node_count());
-  for (Node* node : TopoSort(f)) {
-    if (OpIsSideEffecting(node->op())) {
+  // `pending_` may grow as users of replaced nodes are added.
+  for (int64_t i = 0; i < pending_.size(); ++i) {
+    Node* node = pending_[i];
+    if (!pending_set_.erase(node) || OpIsSideEffecting(node->op())) {
       continue;
     }
 
-    int64_t hash = node_hash(node);
-    if (!node_buckets.contains(hash)) {
-      node_buckets[hash].push_back(node);
+    int64_t hash = CseHash(node);
+    auto bucket_it = buckets_.find(hash);
+    if (bucket_it == buckets_.end()) {
+      buckets_[hash].push_back(node);
+      node_hashes_[node] = hash;
       continue;
     }
-    bool replaced = false;
+    Node* equivalent = nullptr;
     std::vector<Node*> node_span_backing_store;
     absl::Span<Node* const> node_operands_for_cse =
         GetOperandsForCse(node, &node_span_backing_store);
-    for (Node* candidate : node_buckets.at(hash)) {
+    for (Node* candidate : bucket_it->second) {
       std::vector<Node*> candidate_span_backing_store;
       if (node_operands_for_cse ==
               GetOperandsForCse(candidate, &candidate_span_backing_store) &&
           node->IsDefinitelyEqualTo(candidate)) {
-        VLOG(3) << absl::StreamFormat("Replacing %s with equivalent node %s",
-                                      node->GetName(), candidate->GetName());
-        XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(candidate));
-        if (replacements != nullptr) {
-          (*replacements)[node] = candidate;
-        }
-        changed = true;
-        replaced = true;
+        equivalent = candidate;
         break;
       }
     }
-    if (!replaced) {
-      node_buckets[hash].push_back(node);
+    if (equivalent == nullptr) {
+      bucket_it->second.push_back(node);
+      node_hashes_[node] = hash;
+      continue;
+    }
+    if (node->users().empty() && !node->function_base()->HasImplicitUse(node)) {
+      // Replacing a dead node would not change the graph. It is not added to
+      // the table as an equivalent node already exists.
+      continue;
+    }
+    VLOG(3) << absl::StreamFormat("Replacing %s with equivalent node %s",
+                                  node->GetName(), equivalent->GetName());
+    std::vector<Node*> users(node->users().begin(), node->users().end());
+    XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(equivalent));
+    if (replacements != nullptr) {
+      (*replacements)[node] = equivalent;
+    }
+    changed = true;
+    // The users now have different operands so may be equivalent to other
+    // nodes. In the first Run they are already pending.
+    for (Node* user : users) {
+      RemoveFromBucket(user);
+      AddPending(user);
     }
   }
-
+  pending_.clear();
   return changed;
 }
 
+absl::StatusOr<bool> RunCse(FunctionBase* f,
+                            absl::flat_hash_map<Node*, Node*>* replacements) {
+  CseValueTable table;
+  XLS_RETURN_IF_ERROR(table.Populate(f));
+  return table.Run(replacements);
+}
+
 absl::StatusOr<bool> CsePass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
-  return RunCse(f, nullptr);
+  if (options.query_engine_cache == nullptr) {
+    return RunCse(f, nullptr);
+  }
+  XLS_ASSIGN_OR_RETURN(
+      CseValueTable * table,
+      options.query_engine_cache->GetAnalysis<CseValueTable>(f));
+  return table->Run(nullptr);
 }
 
 REGISTER_OPT_PASS(CsePass);
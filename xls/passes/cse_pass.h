@@ -15,17 +15,60 @@
 #ifndef XLS_PASSES_CSE_PASS_H_
 #define XLS_PASSES_CSE_PASS_H_
 
+#include <cstdint>
 #include <string_view>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine_cache.h"
 
 namespace xls {
 
+// A value numbering of the non-side-effecting nodes of a function used to find
+// common subexpressions. Nodes are bucketed by a hash of their op and operand
+// ids; nodes in the same bucket with the same operands which are definitely
+// equal compute the same value.
+//
+// The table is an IncrementalAnalysis so it may be held by a QueryEngineCache
+// across passes: the first Run considers every node of the function, later
+// Runs consider only the nodes added or with changed operands since the
+// previous Run along with the users of the nodes they replace.
+class CseValueTable : public IncrementalAnalysis {
+ public:
+  absl::Status Populate(FunctionBase* f) override;
+  absl::Status UpdateChangedNodes(
+      absl::Span<Node* const> changed_nodes) override;
+  void ForgetNode(Node* node) override;
+
+  // Replaces each pending node with an equivalent node in the table, if any.
+  // Each replacement is added to `replacements` if it is not `nullptr`.
+  // Returns true if any node was replaced.
+  absl::StatusOr<bool> Run(absl::flat_hash_map<Node*, Node*>* replacements);
+
+ private:
+  // Removes `node` from its bucket, if it is in one.
+  void RemoveFromBucket(Node* node);
+
+  // Adds `node` to the nodes to consider in the next Run.
+  void AddPending(Node* node);
+
+  absl::flat_hash_map<int64_t, std::vector<Node*>> buckets_;
+  // The hash of each node in `buckets_`.
+  absl::flat_hash_map<Node*, int64_t> node_hashes_;
+  // The nodes to consider in the next Run in order. Nodes in `pending_` which
+  // are not in `pending_set_` have been removed and are skipped.
+  std::vector<Node*> pending_;
+  absl::flat_hash_set<Node*> pending_set_;
+};
+
 // This function is called by the `CsePass` to merge together common
 // subexpressions. It exists so that you can call it inside other passes and
 // extract which nodes were merged. Each replacement done by the pass is added
@@ -56,7 +99,8 @@ absl::flat_hash_map<T, T> FixedPointOfSPO(
 
 // Pass which performs common subexpression elimination. Equivalent ops with the
 // same operands are commoned. The pass can find arbitrarily large common
-// expressions.
+// expressions. If the options have a query engine cache the value table is kept
+// in the cache so later runs only consider the nodes changed since.
 class CsePass : public OptimizationFunctionBasePass {
  public:
   static constexpr std::string_view kName = "cse";
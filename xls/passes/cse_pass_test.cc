@@ -15,6 +15,7 @@
 #include "xls/passes/cse_pass.h"
 
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -25,9 +26,14 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/query_engine_cache.h"
 
 namespace m = ::xls::op_matchers;
 
@@ -231,5 +237,49 @@ TEST_F(CsePassTest, NonCommutativeOperands) {
   EXPECT_NE(f->return_value()->operand(0), f->return_value()->operand(1));
 }
 
+TEST_F(CsePassTest, IncrementalWithQueryEngineCache) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue z = fb.Param("z", p->GetBitsType(8));
+  BValue or1 = fb.Or(fb.Negate(fb.And(x, y)), z);
+  BValue or2 = fb.Or(fb.Negate(fb.And(y, x)), z);
+  fb.Add(or1, or2);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  OptimizationPassOptions options;
+  options.query_engine_cache = &cache;
+  PassResults results;
+  EXPECT_THAT(CsePass().RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+  EXPECT_EQ(f->return_value()->operand(0), f->return_value()->operand(1));
+  EXPECT_THAT(CsePass().RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(false));
+
+  // Add another copy of the expression. Only the new nodes and the users of the
+  // nodes they are replaced by are considered by the next run.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * and3, f->MakeNode<NaryOp>(SourceInfo(),
+                                       std::vector<Node*>{x.node(), y.node()},
+                                       Op::kAnd));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * neg3,
+                           f->MakeNode<UnOp>(SourceInfo(), and3, Op::kNeg));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * or3,
+      f->MakeNode<NaryOp>(SourceInfo(), std::vector<Node*>{neg3, z.node()},
+                          Op::kOr));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * sum, f->MakeNode<BinOp>(SourceInfo(), f->return_value(), or3,
+                                     Op::kAdd));
+  XLS_ASSERT_OK(f->set_return_value(sum));
+  EXPECT_THAT(CsePass().RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+  EXPECT_EQ(sum->operand(1), or1.node());
+  EXPECT_THAT(CsePass().RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(false));
+}
+
 }  // namespace
 }  // namespace xls
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -40,6 +41,7 @@
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine_cache.h"
 
 namespace xls {
 namespace {
@@ -156,14 +158,25 @@ absl::StatusOr<bool> MaybeReplaceWithArrayOfExistingNodes(
 absl::StatusOr<bool> DataflowSimplificationPass::RunOnFunctionBaseInternal(
     FunctionBase* func, const OptimizationPassOptions& options,
     PassResults* results) const {
-  NodeSourceDataflowVisitor visitor;
-  XLS_RETURN_IF_ERROR(func->Accept(&visitor));
+  // Within a pipeline the analysis is retained by the query engine cache so
+  // only the nodes changed since the previous run are re-evaluated.
+  std::optional<NodeSourceDataflowVisitor> local_visitor;
+  NodeSourceDataflowVisitor* visitor;
+  if (options.query_engine_cache != nullptr) {
+    XLS_ASSIGN_OR_RETURN(visitor,
+                         options.query_engine_cache
+                             ->GetDataflowVisitor<NodeSourceDataflowVisitor>(
+                                 func));
+  } else {
+    visitor = &local_visitor.emplace();
+    XLS_RETURN_IF_ERROR(func->Accept(visitor));
+  }
   bool changed = false;
   // Hashmap from the LTT<NodeSource> of a node to the Node*. If two nodes have
   // the same LTT<NodeSource> they are necessarily equivalent.
   absl::flat_hash_map<LeafTypeTreeView<NodeSource>, Node*> source_map;
   for (Node* node : TopoSort(func)) {
-    LeafTypeTreeView<NodeSource> source = visitor.GetValue(node);
+    LeafTypeTreeView<NodeSource> source = visitor->GetValue(node);
     VLOG(3) << absl::StrFormat("Considering `%s`: %s", node->GetName(),
                                source.ToString());
     auto [it, inserted] = source_map.insert({source, node});
@@ -16,10 +16,13 @@
 #define XLS_PASSES_DATAFLOW_VISITOR_H_
 
 #include <cstdint>
+#include <optional>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/types/span.h"
@@ -31,6 +34,7 @@
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
 
 namespace xls {
@@ -68,6 +72,11 @@ namespace xls {
 //      for a select operation by joining the possible selected cases.
 //
 // Other handlers can optionally defined or overridden.
+//
+// After the visitor has been run over a function base with Accept, the values
+// can be brought up to date with changes to the graph by calling
+// UpdateChangedNodes with the changed nodes rather than re-running the
+// analysis over the whole graph.
 template <typename LeafT>
 class DataflowVisitor : public DfsVisitorWithDefault {
  public:
@@ -231,6 +240,40 @@ class DataflowVisitor : public DfsVisitorWithDefault {
     return ltt;
   }
 
+  // Re-evaluates the values of `changed_nodes` and of the transitive users of
+  // `changed_nodes` which have an operand whose value changed as a result.
+  // Nodes are visited in topological order with a work list so only the
+  // affected part of the graph is re-evaluated. `changed_nodes` must include
+  // every node which has been added or had its operands changed since the
+  // values were computed. Requires LeafT to be equality comparable.
+  absl::Status UpdateChangedNodes(absl::Span<Node* const> changed_nodes) {
+    absl::flat_hash_set<Node*> changed(changed_nodes.begin(),
+                                       changed_nodes.end());
+    // Nodes whose values differ from their previous values.
+    absl::flat_hash_set<Node*> updated;
+    for (Node* node : TopoSortTransitiveUsers(changed_nodes)) {
+      if (!changed.contains(node) &&
+          absl::c_none_of(node->operands(),
+                          [&](Node* o) { return updated.contains(o); })) {
+        continue;
+      }
+      std::optional<LeafTypeTree<LeafT>> previous;
+      if (auto it = map_.find(node); it != map_.end()) {
+        previous = std::move(it->second);
+        map_.erase(it);
+      }
+      XLS_RETURN_IF_ERROR(node->VisitSingleNode(this));
+      if (!previous.has_value() || *previous != map_.at(node)) {
+        updated.insert(node);
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  // Discards the value of `node`. Must be called before `node` is removed
+  // from the graph if the values are to be updated with UpdateChangedNodes.
+  void ForgetNode(Node* node) { map_.erase(node); }
+
  protected:
   // Joins the elements of `data_sources` together and returns the result.
   // This operation is used, for example, to join the leaf values of possible
@@ -39,6 +39,9 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/lsb_or_msb.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/source_location.h"
 
 namespace xls {
@@ -52,6 +55,8 @@ struct DataSource {
   absl::btree_set<std::string> sources;
   absl::btree_set<std::string> controls;
 
+  friend bool operator==(const DataSource&, const DataSource&) = default;
+
   template <typename Sink>
   friend void AbslStringify(Sink& sink, const DataSource& ds) {
     std::string src_str = absl::StrJoin(ds.sources, " OR ");
@@ -136,6 +141,21 @@ class TestDataflowVisitorWithControl : public TestDataflowVisitor {
   }
 };
 
+// Test visitor which counts the nodes evaluated by the default handler.
+class CountingDataflowVisitor : public TestDataflowVisitor {
+ public:
+  int64_t default_count() const { return default_count_; }
+
+ protected:
+  absl::Status DefaultHandler(Node* node) override {
+    ++default_count_;
+    return TestDataflowVisitor::DefaultHandler(node);
+  }
+
+ private:
+  int64_t default_count_ = 0;
+};
+
 TEST_F(DataflowVisitorTest, Tuples) {
   auto p = CreatePackage();
   Type* u32 = p->GetBitsType(32);
@@ -322,5 +342,52 @@ TEST_F(DataflowVisitorTest, OneHotSelects) {
   EXPECT_THAT(visitor.GetValue(onehot_ohs.node()).ToString(), "x OR y OR z");
 }
 
+TEST_F(DataflowVisitorTest, UpdateChangedNodes) {
+  auto p = CreatePackage();
+  Type* u32 = p->GetBitsType(32);
+  FunctionBuilder b(TestName(), p.get());
+
+  BValue x = b.Param("x", u32);
+  BValue y = b.Param("y", u32);
+  BValue z = b.Param("z", u32);
+  BValue xy = b.Tuple({x, y});
+  BValue xy0 = b.TupleIndex(xy, 0);
+  BValue not_xy0 = b.Not(xy0, SourceInfo(), "not_xy0");
+  BValue neg_z = b.Negate(z, SourceInfo(), "neg_z");
+  BValue sum = b.Add(not_xy0, neg_z, SourceInfo(), "sum");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, b.Build());
+
+  CountingDataflowVisitor visitor;
+  XLS_ASSERT_OK(f->Accept(&visitor));
+  EXPECT_EQ(visitor.default_count(), 6);
+  EXPECT_THAT(visitor.GetValue(xy0.node()).ToString(), "x");
+
+  // The value of `not_xy0` is unchanged so `sum` need not be re-evaluated.
+  XLS_ASSERT_OK(xy.node()->ReplaceOperandNumber(0, z.node()));
+  XLS_ASSERT_OK(visitor.UpdateChangedNodes({xy.node()}));
+  EXPECT_EQ(visitor.default_count(), 7);
+  EXPECT_THAT(visitor.GetValue(xy.node()).ToString(), "(z, y)");
+  EXPECT_THAT(visitor.GetValue(xy0.node()).ToString(), "z");
+  EXPECT_THAT(visitor.GetValue(not_xy0.node()).ToString(), "not_xy0");
+
+  // Newly added nodes are evaluated.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * y_copy, f->MakeNode<UnOp>(SourceInfo(), y.node(), Op::kIdentity));
+  XLS_ASSERT_OK(xy.node()->ReplaceOperandNumber(0, y_copy));
+  XLS_ASSERT_OK(visitor.UpdateChangedNodes({xy.node(), y_copy}));
+  EXPECT_EQ(visitor.default_count(), 8);
+  EXPECT_THAT(visitor.GetValue(xy.node()).ToString(), "(y, y)");
+  EXPECT_THAT(visitor.GetValue(sum.node()).ToString(), "sum");
+
+  // The updated values match a fresh analysis.
+  TestDataflowVisitor fresh;
+  XLS_ASSERT_OK(f->Accept(&fresh));
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(visitor.GetValue(node).ToString(),
+              fresh.GetValue(node).ToString())
+        << node;
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,53 +14,116 @@
 
 #include "xls/passes/dce_pass.h"
 
-#include <deque>
+#include <cstdint>
+#include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/log/log.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/function_base.h"
-#include "xls/ir/node_util.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine_cache.h"
 
 namespace xls {
 
-absl::StatusOr<bool> DeadCodeEliminationPass::RunOnFunctionBaseInternal(
-    FunctionBase* f, const OptimizationPassOptions& options,
-    PassResults* results) const {
-  auto is_deletable = [](Node* n) {
-    return !n->function_base()->HasImplicitUse(n) &&
-           (!OpIsSideEffecting(n->op()) || n->Is<Gate>());
-  };
-
-  std::deque<Node*> worklist;
-  for (Node* n : f->nodes()) {
-    if (n->users().empty() && is_deletable(n)) {
-      worklist.push_back(n);
+namespace {
+
+// Returns true if `node` may be removed when it has no users, ignoring implicit
+// uses.
+bool IsDeletableOp(Node* node) {
+  return !OpIsSideEffecting(node->op()) || node->Is<Gate>();
+}
+
+}  // namespace
+
+absl::Status DeadNodeWorklist::Populate(FunctionBase* f) {
+  f_ = f;
+  for (Node* node : f->nodes()) {
+    if (node->users().empty()) {
+      candidates_.insert(node);
     }
   }
+  return absl::OkStatus();
+}
+
+absl::Status DeadNodeWorklist::UpdateChangedNodes(
+    absl::Span<Node* const> changed_nodes) {
+  for (Node* node : changed_nodes) {
+    if (node->users().empty()) {
+      candidates_.insert(node);
+    }
+  }
+  return absl::OkStatus();
+}
+
+void DeadNodeWorklist::ForgetNode(Node* node) {
+  candidates_.erase(node);
+  implicitly_used_.erase(node);
+}
+
+void DeadNodeWorklist::UseRemoved(Node* node) {
+  // The use may not have been removed from the users of `node` yet so the
+  // users are only checked when the candidates are processed.
+  candidates_.insert(node);
+}
+
+absl::StatusOr<int64_t> DeadNodeWorklist::RemoveDeadNodes() {
+  // Implicit uses are not tracked through change notifications so recheck
+  // every implicitly used node.
+  candidates_.insert(implicitly_used_.begin(), implicitly_used_.end());
+  implicitly_used_.clear();
+
   int64_t removed_count = 0;
-  absl::flat_hash_set<Node*> unique_operands;
-  while (!worklist.empty()) {
-    Node* node = worklist.front();
-    worklist.pop_front();
-
-    // A node may appear more than once as an operand of 'node'. Keep track of
-    // which operands have been handled in a set.
-    unique_operands.clear();
-    for (Node* operand : node->operands()) {
-      if (unique_operands.insert(operand).second) {
-        if (HasSingleUse(operand) && is_deletable(operand)) {
-          worklist.push_back(operand);
-        }
+  while (!candidates_.empty()) {
+    // Process the candidates in id order for determinism.
+    std::vector<Node*> nodes(candidates_.begin(), candidates_.end());
+    candidates_.clear();
+    absl::c_sort(nodes, Node::NodeIdLessThan());
+    for (Node* node : nodes) {
+      if (!node->users().empty() || !IsDeletableOp(node)) {
+        continue;
+      }
+      if (f_->HasImplicitUse(node)) {
+        implicitly_used_.insert(node);
+        continue;
+      }
+      // A node may appear more than once as an operand of 'node'; the set of
+      // candidates ignores duplicates.
+      for (Node* operand : node->operands()) {
+        candidates_.insert(operand);
       }
+      // `node` may have become a candidate again as the operand of a node
+      // removed earlier in this round.
+      ForgetNode(node);
+      VLOG(3) << "DCE removing " << node->ToString();
+      XLS_RETURN_IF_ERROR(f_->RemoveNode(node));
+      removed_count++;
     }
-    VLOG(3) << "DCE removing " << node->ToString();
-    XLS_RETURN_IF_ERROR(f->RemoveNode(node));
-    removed_count++;
+  }
+  return removed_count;
+}
+
+absl::StatusOr<bool> DeadCodeEliminationPass::RunOnFunctionBaseInternal(
+    FunctionBase* f, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  int64_t removed_count;
+  if (options.query_engine_cache != nullptr) {
+    XLS_ASSIGN_OR_RETURN(
+        DeadNodeWorklist * worklist,
+        options.query_engine_cache->GetAnalysis<DeadNodeWorklist>(f));
+    XLS_ASSIGN_OR_RETURN(removed_count, worklist->RemoveDeadNodes());
+  } else {
+    DeadNodeWorklist worklist;
+    XLS_RETURN_IF_ERROR(worklist.Populate(f));
+    XLS_ASSIGN_OR_RETURN(removed_count, worklist.RemoveDeadNodes());
   }
 
   VLOG(2) << "Removed " << removed_count << " dead nodes";
@@ -17,18 +17,55 @@
 #ifndef XLS_PASSES_DCE_PASS_H_
 #define XLS_PASSES_DCE_PASS_H_
 
+#include <cstdint>
 #include <string_view>
 
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine_cache.h"
 
 namespace xls {
 
+// The nodes of a function which may be dead: those without users which were
+// added or lost a use since dead code elimination last ran, along with the
+// nodes kept alive only by an implicit use (e.g. the return value), which may
+// since have lost it.
+//
+// The worklist is an IncrementalAnalysis so it may be held by a
+// QueryEngineCache across passes. The first RemoveDeadNodes considers every
+// node of the function and later calls consider only the candidates recorded
+// since, so dead code elimination after a pass which changed a few nodes does
+// not rescan the whole function.
+class DeadNodeWorklist : public IncrementalAnalysis {
+ public:
+  absl::Status Populate(FunctionBase* f) override;
+  absl::Status UpdateChangedNodes(
+      absl::Span<Node* const> changed_nodes) override;
+  void ForgetNode(Node* node) override;
+  void UseRemoved(Node* node) override;
+
+  // Removes the dead candidates and, transitively, the operands which become
+  // dead as a result. Returns the number of nodes removed.
+  absl::StatusOr<int64_t> RemoveDeadNodes();
+
+ private:
+  FunctionBase* f_ = nullptr;
+  absl::flat_hash_set<Node*> candidates_;
+  // Deletable nodes without users which have an implicit use.
+  absl::flat_hash_set<Node*> implicitly_used_;
+};
+
 // class DeadCodeEliminationPass iterates up from a functions result
 // nodes and marks all visited node. After that, all unvisited nodes
-// are considered dead.
+// are considered dead. If OptimizationPassOptions::query_engine_cache is set
+// the DeadNodeWorklist of each function is kept in the cache so each run only
+// visits the nodes which may have become dead since the previous run.
 class DeadCodeEliminationPass : public OptimizationFunctionBasePass {
  public:
   static constexpr std::string_view kName = "dce";
@@ -13,17 +13,25 @@
 // limitations under the License.
 
 #include "xls/passes/dce_pass.h"
+
+#include <cstdint>
 #include <string_view>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "benchmark/benchmark.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/query_engine_cache.h"
 
 namespace xls {
 namespace {
@@ -159,5 +167,87 @@ TEST_F(DeadCodeEliminationPassTest, GateRemoved) {
   EXPECT_THAT(f->GetNode(kDeadNodeName), Not(IsOk()));
 }
 
+TEST_F(DeadCodeEliminationPassTest, IncrementalWithQueryEngineCache) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue neg_x = fb.Negate(x);
+  BValue add = fb.Add(neg_x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(add));
+
+  QueryEngineCache cache;
+  OptimizationPassOptions options;
+  options.query_engine_cache = &cache;
+  PassResults results;
+  DeadCodeEliminationPass pass;
+  EXPECT_THAT(pass.RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(false));
+  EXPECT_EQ(f->node_count(), 4);
+
+  // Replacing an operand makes `neg_x` dead.
+  XLS_ASSERT_OK(add.node()->ReplaceOperandNumber(0, x.node()));
+  EXPECT_THAT(pass.RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+  EXPECT_EQ(f->node_count(), 3);
+
+  // Changing the return value removes the only (implicit) use of `add`.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * neg_y,
+                           f->MakeNode<UnOp>(SourceInfo(), y.node(), Op::kNeg));
+  XLS_ASSERT_OK(f->set_return_value(neg_y));
+  EXPECT_THAT(pass.RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+  EXPECT_EQ(f->node_count(), 3);
+  EXPECT_THAT(f->return_value(), m::Neg(m::Param("y")));
+
+  // A newly added node without users is removed.
+  XLS_ASSERT_OK(
+      f->MakeNode<UnOp>(SourceInfo(), x.node(), Op::kNot).status());
+  EXPECT_THAT(pass.RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+  EXPECT_EQ(f->node_count(), 3);
+}
+
+// Runs dead code elimination after adding a single dead node to a function
+// with `state.range(0)` live nodes, as happens when DCE runs after a pass
+// which made a small change.
+void BM_DceAfterSmallChange(benchmark::State& state, bool use_cache) {
+  Package p("bm_test");
+  FunctionBuilder fb("f", &p);
+  BValue x = fb.Param("x", p.GetBitsType(32));
+  BValue value = x;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    value = fb.Add(value, x);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(value));
+
+  QueryEngineCache cache;
+  OptimizationPassOptions options;
+  if (use_cache) {
+    options.query_engine_cache = &cache;
+  }
+  DeadCodeEliminationPass pass;
+  PassResults results;
+  XLS_ASSERT_OK(pass.RunOnFunctionBase(f, options, &results).status());
+  for (auto s : state) {
+    XLS_ASSERT_OK(
+        f->MakeNode<UnOp>(SourceInfo(), x.node(), Op::kNeg).status());
+    XLS_ASSERT_OK_AND_ASSIGN(bool changed,
+                             pass.RunOnFunctionBase(f, options, &results));
+    benchmark::DoNotOptimize(changed);
+  }
+}
+
+void BM_DceAfterSmallChangeRescan(benchmark::State& state) {
+  BM_DceAfterSmallChange(state, /*use_cache=*/false);
+}
+
+void BM_DceAfterSmallChangeWorklist(benchmark::State& state) {
+  BM_DceAfterSmallChange(state, /*use_cache=*/true);
+}
+
+BENCHMARK(BM_DceAfterSmallChangeRescan)->Range(1000, 500000);
+BENCHMARK(BM_DceAfterSmallChangeWorklist)->Range(1000, 500000);
+
 }  // namespace
 }  // namespace xls
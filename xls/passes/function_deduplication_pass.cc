@@ -0,0 +1,277 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/function_deduplication_pass.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/optimization_pass_registry.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+namespace {
+
+// Map from each merged function to the function it was merged into.
+using MergeMap = absl::flat_hash_map<Function*, Function*>;
+
+// Returns the function called by `node`, or nullptr if `node` calls none.
+Function* CalledFunction(Node* node) {
+  switch (node->op()) {
+    case Op::kInvoke:
+      return node->As<Invoke>()->to_apply();
+    case Op::kMap:
+      return node->As<Map>()->to_apply();
+    case Op::kCountedFor:
+      return node->As<CountedFor>()->body();
+    case Op::kDynamicCountedFor:
+      return node->As<DynamicCountedFor>()->body();
+    default:
+      return nullptr;
+  }
+}
+
+Function* Representative(Function* f, const MergeMap& merged) {
+  auto it = merged.find(f);
+  return it == merged.end() ? f : it->second;
+}
+
+// Returns a hash of the structure of `f` given its nodes in topological order.
+// Functions which FunctionsAreIdentical considers identical hash equally.
+size_t StructuralHash(Function* f, absl::Span<Node* const> order,
+                      const MergeMap& merged) {
+  absl::flat_hash_map<Node*, int64_t> position;
+  size_t hash = absl::HashOf(f->params().size(), f->node_count());
+  for (int64_t i = 0; i < order.size(); ++i) {
+    Node* node = order[i];
+    position[node] = i;
+    Function* callee = CalledFunction(node);
+    hash = absl::HashOf(
+        hash, node->op(), node->GetType(),
+        callee == nullptr ? nullptr : Representative(callee, merged));
+    if (node->Is<Param>()) {
+      hash = absl::HashOf(hash, f->GetParamIndex(node->As<Param>()).value());
+    }
+    for (Node* operand : node->operands()) {
+      hash = absl::HashOf(hash, position.at(operand));
+    }
+  }
+  return absl::HashOf(hash, position.at(f->return_value()));
+}
+
+// Returns true if `a` and `b` compute the same thing given that their operands
+// do. Unlike Node::IsDefinitelyEqualTo this handles side-effecting ops and
+// compares callees modulo merging.
+bool NodesAreIdentical(Node* a, Node* b, const MergeMap& merged) {
+  if (a->op() != b->op() || a->GetType() != b->GetType() ||
+      a->operand_count() != b->operand_count()) {
+    return false;
+  }
+  if (Function* callee = CalledFunction(a); callee != nullptr) {
+    if (Representative(callee, merged) !=
+        Representative(CalledFunction(b), merged)) {
+      return false;
+    }
+    if (a->Is<CountedFor>()) {
+      return a->As<CountedFor>()->trip_count() ==
+                 b->As<CountedFor>()->trip_count() &&
+             a->As<CountedFor>()->stride() == b->As<CountedFor>()->stride();
+    }
+    return true;
+  }
+  switch (a->op()) {
+    case Op::kAssert:
+      return a->As<Assert>()->message() == b->As<Assert>()->message() &&
+             a->As<Assert>()->label() == b->As<Assert>()->label();
+    case Op::kCover:
+      return a->As<Cover>()->label() == b->As<Cover>()->label();
+    case Op::kTrace:
+      return a->As<Trace>()->format() == b->As<Trace>()->format() &&
+             a->As<Trace>()->verbosity() == b->As<Trace>()->verbosity();
+    case Op::kGate:
+      return true;
+    default:
+      return !OpIsSideEffecting(a->op()) && a->IsDefinitelyEqualTo(b);
+  }
+}
+
+// Returns true if `a` and `b`, with nodes in the given topological orders,
+// have the same parameter types and the same nodes connected the same way.
+bool FunctionsAreIdentical(Function* a, absl::Span<Node* const> a_order,
+                           Function* b, absl::Span<Node* const> b_order,
+                           const MergeMap& merged) {
+  if (a->params().size() != b->params().size() ||
+      a_order.size() != b_order.size()) {
+    return false;
+  }
+  absl::flat_hash_map<Node*, Node*> a_to_b;
+  for (int64_t i = 0; i < a->params().size(); ++i) {
+    if (a->param(i)->GetType() != b->param(i)->GetType()) {
+      return false;
+    }
+    a_to_b[a->param(i)] = b->param(i);
+  }
+  for (int64_t i = 0; i < a_order.size(); ++i) {
+    Node* a_node = a_order[i];
+    Node* b_node = b_order[i];
+    if (a_node->Is<Param>()) {
+      if (a_to_b.at(a_node) != b_node) {
+        return false;
+      }
+      continue;
+    }
+    if (!NodesAreIdentical(a_node, b_node, merged)) {
+      return false;
+    }
+    for (int64_t j = 0; j < a_node->operand_count(); ++j) {
+      if (a_to_b.at(a_node->operand(j)) != b_node->operand(j)) {
+        return false;
+      }
+    }
+    a_to_b[a_node] = b_node;
+  }
+  return a_to_b.at(a->return_value()) == b->return_value();
+}
+
+// Replaces `node`, which calls a function, with an equivalent node calling
+// `callee` instead.
+absl::Status Retarget(Node* node, Function* callee) {
+  Node* replacement;
+  switch (node->op()) {
+    case Op::kInvoke:
+      XLS_ASSIGN_OR_RETURN(replacement, node->ReplaceUsesWithNew<Invoke>(
+                                            node->operands(), callee));
+      break;
+    case Op::kMap:
+      XLS_ASSIGN_OR_RETURN(
+          replacement, node->ReplaceUsesWithNew<Map>(node->operand(0), callee));
+      break;
+    case Op::kCountedFor: {
+      CountedFor* loop = node->As<CountedFor>();
+      XLS_ASSIGN_OR_RETURN(replacement,
+                           node->ReplaceUsesWithNew<CountedFor>(
+                               loop->initial_value(), loop->invariant_args(),
+                               loop->trip_count(), loop->stride(), callee));
+      break;
+    }
+    case Op::kDynamicCountedFor: {
+      DynamicCountedFor* loop = node->As<DynamicCountedFor>();
+      XLS_ASSIGN_OR_RETURN(replacement,
+                           node->ReplaceUsesWithNew<DynamicCountedFor>(
+                               loop->initial_value(), loop->trip_count(),
+                               loop->stride(), loop->invariant_args(), callee));
+      break;
+    }
+    default:
+      return absl::InternalError(
+          absl::StrFormat("Node %s does not call a function", node->GetName()));
+  }
+  std::optional<std::string> name;
+  if (node->HasAssignedName()) {
+    name = node->GetName();
+  }
+  XLS_RETURN_IF_ERROR(node->function_base()->RemoveNode(node));
+  if (name.has_value()) {
+    replacement->SetName(*name);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<bool> FunctionDeduplicationPass::RunInternal(
+    Package* p, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  // Without a top any function may be an entry point, so none can be removed.
+  std::optional<FunctionBase*> top = p->GetTop();
+  if (!top.has_value()) {
+    return false;
+  }
+
+  // Callees are visited first so that callers are compared with their callees
+  // already merged.
+  MergeMap merged;
+  std::vector<Function*> duplicates;
+  absl::flat_hash_map<size_t, std::vector<Function*>> kept_by_hash;
+  absl::flat_hash_map<Function*, std::vector<Node*>> kept_orders;
+  for (FunctionBase* fb : FunctionsInPostOrder(p)) {
+    if (!fb->IsFunction() || fb == *top ||
+        fb->ForeignFunctionData().has_value()) {
+      continue;
+    }
+    Function* f = fb->AsFunctionOrDie();
+    std::vector<Node*> order = TopoSort(f);
+    std::vector<Function*>& candidates =
+        kept_by_hash[StructuralHash(f, order, merged)];
+    auto it = absl::c_find_if(candidates, [&](Function* kept) {
+      return FunctionsAreIdentical(f, order, kept, kept_orders.at(kept),
+                                   merged);
+    });
+    if (it != candidates.end()) {
+      VLOG(2) << absl::StreamFormat("Merging function %s into identical %s",
+                                    f->name(), (*it)->name());
+      merged[f] = *it;
+      duplicates.push_back(f);
+      continue;
+    }
+    candidates.push_back(f);
+    kept_orders[f] = std::move(order);
+  }
+  if (duplicates.empty()) {
+    return false;
+  }
+
+  for (FunctionBase* fb : p->GetFunctionBases()) {
+    if (fb->IsFunction() && merged.contains(fb->AsFunctionOrDie())) {
+      continue;
+    }
+    // Copy the nodes as retargeting replaces them.
+    std::vector<Node*> nodes(fb->nodes().begin(), fb->nodes().end());
+    for (Node* node : nodes) {
+      Function* callee = CalledFunction(node);
+      if (callee != nullptr && merged.contains(callee)) {
+        XLS_RETURN_IF_ERROR(Retarget(node, merged.at(callee)));
+      }
+    }
+  }
+  for (Function* duplicate : duplicates) {
+    XLS_RETURN_IF_ERROR(p->RemoveFunction(duplicate));
+  }
+  return true;
+}
+
+REGISTER_OPT_PASS(FunctionDeduplicationPass);
+
+}  // namespace xls
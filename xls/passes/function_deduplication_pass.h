@@ -0,0 +1,53 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_FUNCTION_DEDUPLICATION_PASS_H_
+#define XLS_PASSES_FUNCTION_DEDUPLICATION_PASS_H_
+
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+
+// Merges functions with identical bodies. Conversion of parametric code often
+// produces many copies of a function under different names; this pass keeps
+// one function of each set of structurally identical functions (same
+// parameter types and the same ops, types, attributes and operands in the
+// same order) and points the invokes, maps and loops which call the others at
+// it. Functions are compared after their callees have been merged so that
+// callers of identical callees are merged as well. The top function and
+// foreign functions are never merged away.
+//
+// Procs are not merged: their bodies are bound to the channels they use so
+// procs with identical-looking bodies are generally distinct.
+class FunctionDeduplicationPass : public OptimizationPass {
+ public:
+  static constexpr std::string_view kName = "function_dedup";
+  FunctionDeduplicationPass()
+      : OptimizationPass(kName, "Function Deduplication") {}
+  ~FunctionDeduplicationPass() override = default;
+
+ protected:
+  absl::StatusOr<bool> RunInternal(Package* p,
+                                   const OptimizationPassOptions& options,
+                                   PassResults* results) const override;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_FUNCTION_DEDUPLICATION_PASS_H_
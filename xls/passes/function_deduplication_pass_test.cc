@@ -0,0 +1,167 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/function_deduplication_pass.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+namespace m = ::xls::op_matchers;
+
+class FunctionDeduplicationPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Package* p) {
+    PassResults results;
+    return FunctionDeduplicationPass().Run(p, OptimizationPassOptions(),
+                                           &results);
+  }
+};
+
+TEST_F(FunctionDeduplicationPassTest, MergesIdenticalFunctions) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package p
+
+fn add_one__8(x: bits[8]) -> bits[8] {
+  one: bits[8] = literal(value=1)
+  ret add.2: bits[8] = add(x, one)
+}
+
+fn add_one__8_again(y: bits[8]) -> bits[8] {
+  literal.3: bits[8] = literal(value=1)
+  ret add.4: bits[8] = add(y, literal.3)
+}
+
+top fn main(a: bits[8]) -> (bits[8], bits[8]) {
+  invoke.5: bits[8] = invoke(a, to_apply=add_one__8)
+  result: bits[8] = invoke(a, to_apply=add_one__8_again)
+  ret tuple.7: (bits[8], bits[8]) = tuple(invoke.5, result)
+}
+)"));
+  Function* add_one = FindFunction("add_one__8", p.get());
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_EQ(p->functions().size(), 2);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, p->GetTopAsFunction());
+  EXPECT_THAT(main->return_value(),
+              m::Tuple(m::Invoke(m::Param("a")), m::Invoke(m::Param("a"))));
+  for (Node* operand : main->return_value()->operands()) {
+    EXPECT_EQ(operand->As<Invoke>()->to_apply(), add_one);
+  }
+  EXPECT_EQ(main->return_value()->operand(1)->GetName(), "result");
+
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+}
+
+TEST_F(FunctionDeduplicationPassTest, MergesCallersOfMergedFunctions) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package p
+
+fn body_a(i: bits[8], accum: bits[8]) -> bits[8] {
+  ret add.1: bits[8] = add(i, accum)
+}
+
+fn body_b(i: bits[8], accum: bits[8]) -> bits[8] {
+  ret add.2: bits[8] = add(i, accum)
+}
+
+fn loop_a(x: bits[8]) -> bits[8] {
+  ret counted_for.3: bits[8] = counted_for(x, trip_count=4, stride=1, body=body_a)
+}
+
+fn loop_b(x: bits[8]) -> bits[8] {
+  ret counted_for.4: bits[8] = counted_for(x, trip_count=4, stride=1, body=body_b)
+}
+
+fn loop_c(x: bits[8]) -> bits[8] {
+  ret counted_for.5: bits[8] = counted_for(x, trip_count=5, stride=1, body=body_b)
+}
+
+top fn main(x: bits[8]) -> (bits[8], bits[8], bits[8]) {
+  invoke.6: bits[8] = invoke(x, to_apply=loop_a)
+  invoke.7: bits[8] = invoke(x, to_apply=loop_b)
+  invoke.8: bits[8] = invoke(x, to_apply=loop_c)
+  ret tuple.9: (bits[8], bits[8], bits[8]) = tuple(invoke.6, invoke.7, invoke.8)
+}
+)"));
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(true));
+  // body_b and loop_b are merged; loop_c has a different trip count.
+  ASSERT_EQ(p->functions().size(), 4);
+  Function* loop_c = FindFunction("loop_c", p.get());
+  EXPECT_EQ(loop_c->return_value()->As<CountedFor>()->body(),
+            FindFunction("body_a", p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, p->GetTopAsFunction());
+  EXPECT_EQ(main->return_value()->operand(1)->As<Invoke>()->to_apply(),
+            FindFunction("loop_a", p.get()));
+}
+
+TEST_F(FunctionDeduplicationPassTest, DifferentSideEffectsAreNotMerged) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package p
+
+fn check_a(tok: token, x: bits[8]) -> bits[8] {
+  zero: bits[8] = literal(value=0)
+  ne.1: bits[1] = ne(x, zero)
+  assert.2: token = assert(tok, ne.1, message="a is zero")
+  ret x: bits[8] = param(name=x)
+}
+
+fn check_b(tok: token, x: bits[8]) -> bits[8] {
+  zero: bits[8] = literal(value=0)
+  ne.3: bits[1] = ne(x, zero)
+  assert.4: token = assert(tok, ne.3, message="b is zero")
+  ret x: bits[8] = param(name=x)
+}
+
+top fn main(tok: token, x: bits[8]) -> (bits[8], bits[8]) {
+  invoke.5: bits[8] = invoke(tok, x, to_apply=check_a)
+  invoke.6: bits[8] = invoke(tok, x, to_apply=check_b)
+  ret tuple.7: (bits[8], bits[8]) = tuple(invoke.5, invoke.6)
+}
+)"));
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+  EXPECT_EQ(p->functions().size(), 3);
+}
+
+TEST_F(FunctionDeduplicationPassTest, TopIsNotMerged) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package p
+
+fn same_as_main(x: bits[8]) -> bits[8] {
+  ret neg.1: bits[8] = neg(x)
+}
+
+top fn main(x: bits[8]) -> bits[8] {
+  ret neg.2: bits[8] = neg(x)
+}
+)"));
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+  EXPECT_EQ(p->functions().size(), 2);
+}
+
+}  // namespace
+}  // namespace xls
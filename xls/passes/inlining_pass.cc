@@ -22,13 +22,17 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/call_graph.h"
+#include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
@@ -207,25 +211,84 @@ absl::Status InliningPass::InlineOneInvoke(Invoke* invoke) {
   return InlineInvoke</*kCheckNoSubInvokes=*/false>(invoke, /*inline_count=*/0);
 }
 
-absl::StatusOr<bool> InliningPass::RunInternal(
-    Package* p, const OptimizationPassOptions& options,
-    PassResults* results) const {
+absl::StatusOr<bool> InliningPass::InlineStage(
+    Package* p, std::optional<int64_t> staging_threshold, int* inline_count,
+    absl::flat_hash_set<FunctionBase*>* deferred) const {
+  absl::flat_hash_map<Function*, int64_t> call_site_counts;
+  if (staging_threshold.has_value()) {
+    for (FunctionBase* f : p->GetFunctionBases()) {
+      for (Node* node : f->nodes()) {
+        if (node->Is<Invoke>()) {
+          ++call_site_counts[node->As<Invoke>()->to_apply()];
+        }
+      }
+    }
+  }
+  // Functions which had invokes inlined into them in this stage.
+  absl::flat_hash_set<FunctionBase*> inlined_into;
+  auto keep_out_of_line = [&](Function* callee) {
+    if (deferred->contains(callee)) {
+      // The callee still contains invokes.
+      return true;
+    }
+    if (!staging_threshold.has_value() || !inlined_into.contains(callee)) {
+      return false;
+    }
+    int64_t call_sites = call_site_counts[callee];
+    return call_sites > 1 &&
+           callee->node_count() * call_sites >= *staging_threshold;
+  };
+
   bool changed = false;
   // Inline all the invokes of each function where functions are processed in a
   // post order of the call graph (leaves first). This ensures that when a
   // function Foo is inlined into its callsites, no invokes remain in Foo. This
   // avoid duplicate work.
-  int inline_count = 0;
   for (FunctionBase* f : FunctionsInPostOrder(p)) {
     // Create copy of nodes() because we will be adding and removing nodes
     // during inlining.
     std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
     for (Node* node : nodes) {
-      if (node->Is<Invoke>() && IsInlineable(node->As<Invoke>())) {
-        XLS_RETURN_IF_ERROR(InlineInvoke(node->As<Invoke>(), inline_count++));
-        changed = true;
+      if (!node->Is<Invoke>() || !IsInlineable(node->As<Invoke>())) {
+        continue;
+      }
+      if (keep_out_of_line(node->As<Invoke>()->to_apply())) {
+        deferred->insert(f);
+        continue;
       }
+      XLS_RETURN_IF_ERROR(InlineInvoke(node->As<Invoke>(), (*inline_count)++));
+      inlined_into.insert(f);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+absl::StatusOr<bool> InliningPass::RunInternal(
+    Package* p, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  std::optional<int64_t> staging_threshold =
+      callee_optimizer_ == nullptr ? std::nullopt
+                                   : options.inlining_staging_threshold;
+  bool changed = false;
+  // Inline counts are unique across stages so labels remain unique.
+  int inline_count = 0;
+  int64_t stage = 0;
+  while (true) {
+    absl::flat_hash_set<FunctionBase*> deferred;
+    XLS_ASSIGN_OR_RETURN(
+        bool stage_changed,
+        InlineStage(p, staging_threshold, &inline_count, &deferred));
+    changed = changed || stage_changed;
+    if (deferred.empty()) {
+      break;
     }
+    XLS_RET_CHECK(stage_changed) << "Inlining made no progress";
+    VLOG(2) << absl::StreamFormat(
+        "Inlining stage %d deferred invokes in %d functions; optimizing", stage,
+        deferred.size());
+    XLS_RETURN_IF_ERROR(callee_optimizer_->Run(p, options, results).status());
+    ++stage;
   }
   return changed;
 }
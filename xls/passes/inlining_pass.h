@@ -15,8 +15,16 @@
 #ifndef XLS_PASSES_INLINING_PASS_H_
 #define XLS_PASSES_INLINING_PASS_H_
 
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/passes/optimization_pass.h"
@@ -24,10 +32,23 @@
 
 namespace xls {
 
+// Inlines all invocations of functions other than foreign functions.
+//
+// If the pass is given a callee optimizer and
+// OptimizationPassOptions::inlining_staging_threshold is set, inlining is
+// staged: a callee with more than one call site whose node count times its
+// number of call sites is at least the threshold is kept out-of-line while
+// invokes are being inlined into it. Once all such callees have had their own
+// invokes inlined, the callee optimizer is run on the package and the
+// optimized callees are inlined in the next stage. Each large, heavily reused
+// callee is thus optimized once rather than at every call site.
 class InliningPass : public OptimizationPass {
  public:
   static constexpr std::string_view kName = "inlining";
   InliningPass() : OptimizationPass(kName, "Inlines invocations") {}
+  explicit InliningPass(std::unique_ptr<OptimizationPass> callee_optimizer)
+      : OptimizationPass(kName, "Inlines invocations"),
+        callee_optimizer_(std::move(callee_optimizer)) {}
 
   // Inline a single invoke instruction. Provided for test and utility
   // (ir_minimizer) use.
@@ -39,6 +60,17 @@ class InliningPass : public OptimizationPass {
   absl::StatusOr<bool> RunInternal(Package* p,
                                    const OptimizationPassOptions& options,
                                    PassResults* results) const override;
+
+ private:
+  // Inlines the invokes of each function whose callee is not deferred. Adds the
+  // functions which still contain inlineable invokes to `deferred`.
+  absl::StatusOr<bool> InlineStage(Package* p,
+                                   std::optional<int64_t> staging_threshold,
+                                   int* inline_count,
+                                   absl::flat_hash_set<FunctionBase*>* deferred)
+      const;
+
+  std::unique_ptr<OptimizationPass> callee_optimizer_;
 };
 
 }  // namespace xls
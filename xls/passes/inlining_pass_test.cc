@@ -14,8 +14,10 @@
 
 #include "xls/passes/inlining_pass.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -41,6 +43,25 @@ using status_testing::IsOkAndHolds;
 using testing::AnyOf;
 using testing::Eq;
 
+// A pass which only counts the number of times it is run.
+class CountingPass : public OptimizationPass {
+ public:
+  static constexpr std::string_view kName = "counting";
+  explicit CountingPass(int64_t* run_count)
+      : OptimizationPass(kName, "Counting"), run_count_(run_count) {}
+
+ protected:
+  absl::StatusOr<bool> RunInternal(Package* p,
+                                   const OptimizationPassOptions& options,
+                                   PassResults* results) const override {
+    ++*run_count_;
+    return false;
+  }
+
+ private:
+  int64_t* run_count_;
+};
+
 class InliningPassTest : public IrTestBase {
  protected:
   absl::StatusOr<bool> Inline(Package* package) {
@@ -294,5 +315,69 @@ fn caller(the_token: token, x: bits[32]) -> (token, bits[32]) {
   }
 }
 
+TEST_F(InliningPassTest, StagedInlining) {
+  const std::string kProgram = R"(
+package some_package
+
+fn leaf(x: bits[32]) -> bits[32] {
+  ret neg.1: bits[32] = neg(x)
+}
+
+fn mid(x: bits[32]) -> bits[32] {
+  invoke.2: bits[32] = invoke(x, to_apply=leaf)
+  ret add.3: bits[32] = add(invoke.2, x)
+}
+
+fn caller(x: bits[32], y: bits[32]) -> bits[32] {
+  invoke.4: bits[32] = invoke(x, to_apply=mid)
+  invoke.5: bits[32] = invoke(y, to_apply=mid)
+  ret sub.6: bits[32] = sub(invoke.4, invoke.5)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(kProgram));
+  int64_t run_count = 0;
+  OptimizationPassOptions options;
+  options.inlining_staging_threshold = 1;
+  PassResults results;
+  ASSERT_THAT(InliningPass(std::make_unique<CountingPass>(&run_count))
+                  .Run(package.get(), options, &results),
+              IsOkAndHolds(true));
+  // `leaf` is inlined into `mid` in the first stage while `mid` is kept
+  // out-of-line, then `mid` is optimized and inlined in the second stage.
+  EXPECT_EQ(run_count, 1);
+  Function* f = FindFunction("caller", package.get());
+  EXPECT_THAT(f->return_value(),
+              m::Sub(m::Add(m::Neg(m::Param("x")), m::Param("x")),
+                     m::Add(m::Neg(m::Param("y")), m::Param("y"))));
+}
+
+TEST_F(InliningPassTest, StagingRequiresThreshold) {
+  const std::string kProgram = R"(
+package some_package
+
+fn leaf(x: bits[32]) -> bits[32] {
+  ret neg.1: bits[32] = neg(x)
+}
+
+fn mid(x: bits[32]) -> bits[32] {
+  invoke.2: bits[32] = invoke(x, to_apply=leaf)
+  ret add.3: bits[32] = add(invoke.2, x)
+}
+
+fn caller(x: bits[32], y: bits[32]) -> bits[32] {
+  invoke.4: bits[32] = invoke(x, to_apply=mid)
+  invoke.5: bits[32] = invoke(y, to_apply=mid)
+  ret sub.6: bits[32] = sub(invoke.4, invoke.5)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(kProgram));
+  int64_t run_count = 0;
+  PassResults results;
+  ASSERT_THAT(InliningPass(std::make_unique<CountingPass>(&run_count))
+                  .Run(package.get(), OptimizationPassOptions(), &results),
+              IsOkAndHolds(true));
+  EXPECT_EQ(run_count, 0);
+}
+
 }  // namespace
 }  // namespace xls
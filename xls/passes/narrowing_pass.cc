@@ -65,9 +65,8 @@
 #include "xls/passes/predicate_dominator_analysis.h"
 #include "xls/passes/predicate_state.h"
 #include "xls/passes/query_engine.h"
-#include "xls/passes/range_query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/stateless_query_engine.h"
-#include "xls/passes/ternary_query_engine.h"
 #include "xls/passes/union_query_engine.h"
 
 namespace xls {
@@ -1637,10 +1636,9 @@ class NarrowVisitor final : public DfsVisitorWithDefault {
 
 }  // namespace
 
-template <typename RangeEngine>
 static void RangeAnalysisLog(FunctionBase* f,
-                             const TernaryQueryEngine& ternary_query_engine,
-                             const RangeEngine& range_query_engine) {
+                             const QueryEngine& ternary_query_engine,
+                             const QueryEngine& range_query_engine) {
   int64_t bits_saved = 0;
   absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>> parents_map;
 
@@ -1715,43 +1713,127 @@ static void RangeAnalysisLog(FunctionBase* f,
   }
 }
 
-static absl::StatusOr<std::unique_ptr<QueryEngine>> GetQueryEngine(
-    FunctionBase* f, AnalysisType analysis) {
-  std::unique_ptr<QueryEngine> query_engine;
-  if (analysis == AnalysisType::kRangeWithContext) {
-    auto ternary_query_engine = std::make_unique<TernaryQueryEngine>();
-    auto range_query_engine =
-        std::make_unique<ContextSensitiveRangeQueryEngine>();
+namespace {
 
-    if (VLOG_IS_ON(3)) {
-      RangeAnalysisLog(f, *ternary_query_engine, *range_query_engine);
+// The nodes of a function added or with changed operands since each
+// configuration of the narrowing pass (analysis and whether splits are
+// enabled) last ran on it, held by the query engine cache. The ternary and
+// range facts of a node depend only on its transitive operands, so with those
+// analyses a node whose transitive operands are unchanged would be narrowed
+// exactly as on the previous run, i.e., not at all.
+class NarrowingChangedNodes final : public IncrementalAnalysis {
+ public:
+  using Config = std::pair<AnalysisType, bool>;
+
+  absl::Status Populate(FunctionBase* f) final { return absl::OkStatus(); }
+  absl::Status UpdateChangedNodes(
+      absl::Span<Node* const> changed_nodes) final {
+    for (auto& [config, nodes] : changed_nodes_) {
+      nodes.insert(changed_nodes.begin(), changed_nodes.end());
+    }
+    return absl::OkStatus();
+  }
+  void ForgetNode(Node* node) final {
+    for (auto& [config, nodes] : changed_nodes_) {
+      nodes.erase(node);
     }
+  }
 
-    std::vector<std::unique_ptr<QueryEngine>> engines;
-    engines.push_back(std::make_unique<StatelessQueryEngine>());
-    engines.push_back(std::move(ternary_query_engine));
-    engines.push_back(std::move(range_query_engine));
-    query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
-  } else if (analysis == AnalysisType::kRange) {
-    auto ternary_query_engine = std::make_unique<TernaryQueryEngine>();
-    auto range_query_engine = std::make_unique<RangeQueryEngine>();
+  // Returns the nodes changed since `config` last ran, or nullptr if it has
+  // not run on the function.
+  const absl::flat_hash_set<Node*>* ChangedNodes(const Config& config) const {
+    auto it = changed_nodes_.find(config);
+    return it == changed_nodes_.end() ? nullptr : &it->second;
+  }
+
+  // Called at the end of a run of `config`. Changes made by the run itself are
+  // reported by the cache on the next request.
+  void Clear(const Config& config) { changed_nodes_[config].clear(); }
+
+ private:
+  absl::flat_hash_map<Config, absl::flat_hash_set<Node*>> changed_nodes_;
+};
+
+// Returns the nodes of `order`, a topological sort of a function, which the
+// pass must visit given the nodes changed since it last ran.
+absl::flat_hash_set<Node*> NodesToNarrow(
+    absl::Span<Node* const> order,
+    const absl::flat_hash_set<Node*>& changed_nodes) {
+  absl::flat_hash_set<Node*> to_narrow;
+  for (Node* node : order) {
+    if (changed_nodes.contains(node) ||
+        absl::c_any_of(node->operands(), [&](Node* operand) {
+          return to_narrow.contains(operand);
+        })) {
+      to_narrow.insert(node);
+    }
+  }
+  // Literals and partial products are narrowed based on their users (and the
+  // users of the tuple indices of partial products).
+  std::vector<Node*> user_dependent;
+  for (Node* node : order) {
+    if (to_narrow.contains(node) ||
+        !node->OpIn({Op::kLiteral, Op::kUMulp, Op::kSMulp})) {
+      continue;
+    }
+    for (Node* user : node->users()) {
+      if (to_narrow.contains(user) ||
+          absl::c_any_of(user->users(), [&](Node* user_of_user) {
+            return to_narrow.contains(user_of_user);
+          })) {
+        user_dependent.push_back(node);
+        break;
+      }
+    }
+  }
+  to_narrow.insert(user_dependent.begin(), user_dependent.end());
+  return to_narrow;
+}
 
-    if (VLOG_IS_ON(3)) {
-      RangeAnalysisLog(f, *ternary_query_engine, *range_query_engine);
+// Returns the total width of the results and operands of the live operations
+// of `f`, excluding literals, params and operations which only rearrange bits.
+// The decrease of this over a run of the pass is reported as the number of
+// bits narrowed.
+int64_t DatapathBitCount(FunctionBase* f) {
+  int64_t bit_count = 0;
+  for (Node* node : f->nodes()) {
+    if (node->IsDead() ||
+        node->OpIn({Op::kLiteral, Op::kParam, Op::kZeroExt, Op::kSignExt,
+                    Op::kBitSlice, Op::kConcat, Op::kTuple, Op::kTupleIndex})) {
+      continue;
+    }
+    bit_count += node->GetType()->GetFlatBitCount();
+    for (Node* operand : node->operands()) {
+      bit_count += operand->GetType()->GetFlatBitCount();
     }
+  }
+  return bit_count;
+}
+
+}  // namespace
 
-    std::vector<std::unique_ptr<QueryEngine>> engines;
-    engines.push_back(std::make_unique<StatelessQueryEngine>());
-    engines.push_back(std::move(ternary_query_engine));
-    engines.push_back(std::move(range_query_engine));
-    query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
-  } else {
-    std::vector<std::unique_ptr<QueryEngine>> engines;
-    engines.push_back(std::make_unique<StatelessQueryEngine>());
-    engines.push_back(std::make_unique<TernaryQueryEngine>());
-    query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
+static absl::StatusOr<std::unique_ptr<QueryEngine>> GetQueryEngine(
+    FunctionBase* f, AnalysisType analysis,
+    const OptimizationPassOptions& options) {
+  std::vector<std::unique_ptr<QueryEngine>> engines;
+  engines.push_back(std::make_unique<StatelessQueryEngine>());
+  engines.push_back(MakeTernaryQueryEngine(options));
+  const QueryEngine& ternary_query_engine = *engines.back();
+  const QueryEngine* range_query_engine = nullptr;
+  if (analysis == AnalysisType::kRangeWithContext) {
+    engines.push_back(std::make_unique<ContextSensitiveRangeQueryEngine>(
+        options.context_narrowing_analysis_budget));
+    range_query_engine = engines.back().get();
+  } else if (analysis == AnalysisType::kRange) {
+    engines.push_back(MakeRangeQueryEngine(options));
+    range_query_engine = engines.back().get();
   }
+  auto query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
   XLS_RETURN_IF_ERROR(query_engine->Populate(f).status());
+
+  if (range_query_engine != nullptr && VLOG_IS_ON(3)) {
+    RangeAnalysisLog(f, ternary_query_engine, *range_query_engine);
+  }
   return std::move(query_engine);
 }
 
@@ -1759,7 +1841,10 @@ absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<QueryEngine> query_engine,
-                       GetQueryEngine(f, RealAnalysis(options)));
+                       GetQueryEngine(f, RealAnalysis(options), options));
+  if (options.record_memory_usage) {
+    results->RecordAnalysisMemoryUsage(query_engine->EstimateMemoryUsage());
+  }
 
   PredicateDominatorAnalysis pda = PredicateDominatorAnalysis::Run(f);
   SpecializedQueryEngines sqe(RealAnalysis(options), pda, *query_engine);
@@ -1767,7 +1852,34 @@ absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
   NarrowVisitor narrower(sqe, RealAnalysis(options), options,
                          SplitsEnabled(opt_level_));
 
-  for (Node* node : TopoSort(f)) {
+  std::vector<Node*> order = TopoSort(f);
+  // If set, only these nodes can be narrowed; the others are unchanged since
+  // the previous run.
+  std::optional<absl::flat_hash_set<Node*>> to_narrow;
+  NarrowingChangedNodes* changed_nodes = nullptr;
+  const NarrowingChangedNodes::Config config(RealAnalysis(options),
+                                             SplitsEnabled(opt_level_));
+  // Context sensitive facts also depend on the selectors of users.
+  if (options.query_engine_cache != nullptr &&
+      config.first != AnalysisType::kRangeWithContext) {
+    XLS_ASSIGN_OR_RETURN(
+        changed_nodes,
+        options.query_engine_cache->GetAnalysis<NarrowingChangedNodes>(f));
+    if (const absl::flat_hash_set<Node*>* changed =
+            changed_nodes->ChangedNodes(config);
+        changed != nullptr) {
+      to_narrow = NodesToNarrow(order, *changed);
+      VLOG(3) << absl::StreamFormat("Narrowing %d of %d nodes of %s",
+                                    to_narrow->size(), order.size(),
+                                    f->name());
+    }
+  }
+  const int64_t datapath_bits_before = DatapathBitCount(f);
+
+  for (Node* node : order) {
+    if (to_narrow.has_value() && !to_narrow->contains(node)) {
+      continue;
+    }
     // We specifically want gate ops to be eligible for being reduced to a
     // constant since there entire purpose is for preventing power consumption
     // and literals are basically free.
@@ -1791,6 +1903,14 @@ absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
     XLS_RETURN_IF_ERROR(narrower.MaybeReplacePreciseInputEdgeWithLiteral(node));
   }
   // LOG(ERROR) << "Unable to analyze " << narrower.err_cnt() << " times!";
+  if (changed_nodes != nullptr) {
+    changed_nodes->Clear(config);
+  }
+  if (narrower.changed()) {
+    results->IncrementCounter(
+        "bits_narrowed",
+        std::max<int64_t>(datapath_bits_before - DatapathBitCount(f), 0));
+  }
   return narrower.changed();
 }
 AnalysisType NarrowingPass::RealAnalysis(
@@ -28,6 +28,12 @@ namespace xls {
 
 // A pass which reduces the width of operations eliminating redundant or unused
 // bits.
+//
+// With a query engine cache in the options, runs after the first on a function
+// only revisit the nodes added or changed since the previous run and their
+// transitive users (except with context sensitive analysis). Each run which
+// changes the IR records the reduction in operation and operand widths as the
+// "bits_narrowed" counter of the pass invocation.
 class NarrowingPass : public OptimizationFunctionBasePass {
  public:
   enum class AnalysisType : uint8_t {
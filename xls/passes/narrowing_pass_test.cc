@@ -31,10 +31,13 @@
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
 #include "xls/ir/value.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/solvers/z3_ir_equivalence.h"
 #include "xls/solvers/z3_ir_equivalence_testutils.h"
 
@@ -52,6 +55,9 @@ using ::xls::solvers::z3::ScopedVerifyEquivalence;
 using ::testing::_;
 using ::testing::AllOf;
 using ::testing::Contains;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
 
 // The test is parameterized on whether to use range analysis or not.
 class NarrowingPassTestBase : public IrTestBase {
@@ -1235,6 +1241,56 @@ TEST_F(ContextNarrowingPassTest, KnownSmallAdd) {
       << f->DumpIr();
 }
 
+TEST_P(NarrowingPassTest, IncrementalWithQueryEngineCache) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u17 = p->GetBitsType(17);
+  BValue lhs = fb.Param("lhs", u17);
+  BValue rhs = fb.Param("rhs", u17);
+  fb.UMul(fb.ZeroExtend(lhs, 32), fb.SignExtend(rhs, 54),
+          /*result_width=*/62);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  OptimizationPassOptions options;
+  options.query_engine_cache = &cache;
+  NarrowingPass pass(analysis());
+  PassResults results;
+  ASSERT_THAT(pass.Run(p.get(), options, &results), IsOkAndHolds(true));
+  // The multiply's 32-bit operand is narrowed to 17 bits.
+  EXPECT_THAT(results.TakePendingCounters(),
+              UnorderedElementsAre(Pair("bits_narrowed", 15)));
+  Node* narrowed = f->return_value();
+  ASSERT_THAT(pass.Run(p.get(), options, &results), IsOkAndHolds(false));
+  EXPECT_THAT(results.TakePendingCounters(), IsEmpty());
+
+  // Only the added multiply is narrowed by the next run.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * lhs_wide, f->MakeNode<ExtendOp>(SourceInfo(), lhs.node(),
+                                             /*new_bit_count=*/32,
+                                             Op::kZeroExt));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * rhs_wide, f->MakeNode<ExtendOp>(SourceInfo(), rhs.node(),
+                                             /*new_bit_count=*/54,
+                                             Op::kSignExt));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * product, f->MakeNode<ArithOp>(SourceInfo(), lhs_wide, rhs_wide,
+                                           /*width=*/62, Op::kUMul));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * tuple, f->MakeNode<Tuple>(SourceInfo(),
+                                       std::vector<Node*>{narrowed, product}));
+  XLS_ASSERT_OK(f->set_return_value(tuple));
+  ScopedVerifyEquivalence stays_equivalent{f};
+  ASSERT_THAT(pass.Run(p.get(), options, &results), IsOkAndHolds(true));
+  EXPECT_THAT(results.TakePendingCounters(),
+              UnorderedElementsAre(Pair("bits_narrowed", 15)));
+  EXPECT_THAT(f->return_value(),
+              m::Tuple(narrowed,
+                       m::UMul(m::BitSlice(m::ZeroExt(m::Param("lhs")),
+                                           /*start=*/0, /*width=*/17),
+                               m::SignExt(m::Param("rhs")))));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     NarrowingPassTestInstantiation, NarrowingPassTest,
     testing::Values(NarrowingPass::AnalysisType::kTernary,
@@ -14,16 +14,20 @@
 
 #include "xls/passes/node_dependency_analysis.h"
 
+#include <algorithm>
 #include <cstdint>
-#include <tuple>
+#include <memory>
+#include <optional>
 #include <utility>
+#include <vector>
 
-#include "absl/container/flat_hash_map.h"
-#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/common/math_util.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/dense_node_map.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/topo_sort.h"
@@ -32,53 +36,126 @@ namespace xls {
 
 namespace {
 
+// Layers with fewer words of bitmaps to compute than this are computed on a
+// single thread.
+constexpr int64_t kMinParallelLayerWords = int64_t{1} << 16;
+// The minimum number of nodes of a layer computed by each thread.
+constexpr int64_t kMinNodesPerBlock = 64;
+
 // Perform actual analysis.
 // f is the function to analyze. We only care about getting results for
-// 'interesting_nodes' if the set is non-empty (otherwise all nodes are
-// searched). Preds returns the nodes the argument depends on. iter is the
-// iterator to walk the function in the topological order defined by preds.
+// 'interesting_nodes' if the span is non-empty (otherwise all nodes are
+// searched). Preds returns the nodes the argument depends on. topo_sort is the
+// order to walk the function in, which must be topological with respect to
+// preds. Bitmaps are indexed by Node::node_index().
 template <typename Predecessors>
-std::tuple<absl::flat_hash_map<Node*, InlineBitmap>,
-           absl::flat_hash_map<Node*, int64_t>>
-AnalyzeDependents(FunctionBase* f,
-                  const absl::flat_hash_set<Node*>& interesting_nodes,
-                  Predecessors preds, absl::Span<Node* const> topo_sort) {
-  absl::flat_hash_map<Node*, int64_t> node_ids;
-  node_ids.reserve(f->node_count());
-  int64_t cnt = 0;
-  for (Node* n : f->nodes()) {
-    node_ids[n] = cnt++;
-  }
-  auto is_interesting = [&](Node* n) {
-    return interesting_nodes.empty() || interesting_nodes.contains(n);
-  };
-  int64_t seen_interesting_nodes_count = 0;
-  auto is_last_interesting_node = [&](Node* node) {
-    if (interesting_nodes.empty()) {
-      return false;
+DenseNodeMap<InlineBitmap> AnalyzeDependents(
+    FunctionBase* f, absl::Span<Node* const> interesting_nodes,
+    Predecessors preds, absl::Span<Node* const> topo_sort,
+    int64_t thread_count) {
+  const int64_t bitmap_size = f->node_index_bound();
+  std::vector<bool> interesting(bitmap_size, interesting_nodes.empty());
+  // The nodes whose dependents need to be computed: the transitive
+  // predecessors of the interesting nodes.
+  std::vector<bool> needed(bitmap_size, interesting_nodes.empty());
+  std::vector<Node*> worklist;
+  for (Node* n : interesting_nodes) {
+    interesting[n->node_index()] = true;
+    if (!needed[n->node_index()]) {
+      needed[n->node_index()] = true;
+      worklist.push_back(n);
     }
-    if (interesting_nodes.contains(node)) {
-      ++seen_interesting_nodes_count;
+  }
+  while (!worklist.empty()) {
+    Node* n = worklist.back();
+    worklist.pop_back();
+    for (Node* pred : preds(n)) {
+      if (!needed[pred->node_index()]) {
+        needed[pred->node_index()] = true;
+        worklist.push_back(pred);
+      }
     }
-    return seen_interesting_nodes_count == interesting_nodes.size();
-  };
-  int64_t bitmap_size = f->node_count();
-  absl::flat_hash_map<Node*, InlineBitmap> results;
-  results.reserve(f->node_count());
+  }
+
+  // Group the needed nodes into layers where each node only depends on nodes
+  // in earlier layers, so the nodes of a layer can be computed concurrently.
+  // Also count the remaining uses of each node's bitmap so it can be released
+  // once the last user is computed.
+  std::vector<int64_t> layer_of(bitmap_size, 0);
+  std::vector<int64_t> remaining_uses(bitmap_size, 0);
+  std::vector<std::vector<Node*>> layers;
   for (Node* n : topo_sort) {
-    InlineBitmap& bm = results.emplace(n, bitmap_size).first->second;
-    bm.Set(node_ids[n]);
+    if (!needed[n->node_index()]) {
+      continue;
+    }
+    int64_t layer = 0;
     for (Node* pred : preds(n)) {
-      bm.Union(results.at(pred));
+      layer = std::max(layer, layer_of[pred->node_index()] + 1);
+      ++remaining_uses[pred->node_index()];
+    }
+    layer_of[n->node_index()] = layer;
+    if (layer >= layers.size()) {
+      layers.resize(layer + 1);
     }
-    if (is_last_interesting_node(n)) {
-      break;
+    layers[layer].push_back(n);
+  }
+
+  // Each element is only written by the thread computing its node, and read
+  // once the layer of the node has been completed.
+  std::vector<std::optional<InlineBitmap>> bitmaps(bitmap_size);
+  auto compute = [&](absl::Span<Node* const> nodes) {
+    for (Node* n : nodes) {
+      InlineBitmap& bm = bitmaps[n->node_index()].emplace(bitmap_size);
+      bm.Set(n->node_index());
+      for (Node* pred : preds(n)) {
+        bm.Union(*bitmaps[pred->node_index()]);
+      }
+    }
+  };
+  const int64_t bitmap_words = CeilOfRatio(bitmap_size, int64_t{64});
+  for (const std::vector<Node*>& layer : layers) {
+    int64_t layer_size = layer.size();
+    int64_t blocks = 1;
+    if (thread_count > 1 &&
+        layer_size * bitmap_words >= kMinParallelLayerWords) {
+      blocks = std::min(thread_count, layer_size / kMinNodesPerBlock);
+    }
+    if (blocks <= 1) {
+      compute(layer);
+    } else {
+      std::vector<std::unique_ptr<Thread>> threads;
+      threads.reserve(blocks);
+      for (int64_t i = 0; i < blocks; ++i) {
+        int64_t start = i * layer_size / blocks;
+        int64_t end = (i + 1) * layer_size / blocks;
+        threads.push_back(std::make_unique<Thread>([&, start, end]() {
+          compute(absl::MakeConstSpan(layer).subspan(start, end - start));
+        }));
+      }
+      for (std::unique_ptr<Thread>& thread : threads) {
+        thread->Join();
+      }
+    }
+    for (Node* n : layer) {
+      for (Node* pred : preds(n)) {
+        if (--remaining_uses[pred->node_index()] == 0 &&
+            !interesting[pred->node_index()]) {
+          bitmaps[pred->node_index()].reset();
+        }
+      }
+    }
+  }
+
+  DenseNodeMap<InlineBitmap> results;
+  results.reserve(interesting_nodes.empty() ? f->node_count()
+                                            : interesting_nodes.size());
+  for (Node* n : topo_sort) {
+    std::optional<InlineBitmap>& bitmap = bitmaps[n->node_index()];
+    if (interesting[n->node_index()] && bitmap.has_value()) {
+      results.try_emplace(n, *std::move(bitmap));
     }
   }
-  // To avoid any bugs delete everything that's not specifically requested.
-  absl::erase_if(results,
-                 [&](auto& pair) { return !is_interesting(pair.first); });
-  return {results, node_ids};
+  return results;
 }
 
 }  // namespace
@@ -88,25 +165,25 @@ absl::StatusOr<DependencyBitmap> NodeDependencyAnalysis::GetDependents(
   if (!IsAnalyzed(node)) {
     return absl::InvalidArgumentError("Node is not analyzed");
   }
-  return DependencyBitmap(dependents_.at(node), node_indices_);
+  return DependencyBitmap(dependents_.at(node), function_base_);
 }
 
 NodeDependencyAnalysis NodeDependencyAnalysis::BackwardDependents(
-    FunctionBase* fb, absl::Span<Node* const> nodes) {
-  absl::flat_hash_set<Node*> interesting(nodes.begin(), nodes.end());
-  auto [dependents, node_ids] = AnalyzeDependents(
-      fb, interesting, [](Node* node) { return node->operands(); },
-      TopoSort(fb));
-  return NodeDependencyAnalysis(/*is_forwards=*/false, dependents, node_ids);
+    FunctionBase* fb, absl::Span<Node* const> nodes, int64_t thread_count) {
+  DenseNodeMap<InlineBitmap> dependents = AnalyzeDependents(
+      fb, nodes, [](Node* node) { return node->operands(); }, TopoSort(fb),
+      thread_count);
+  return NodeDependencyAnalysis(/*is_forwards=*/false, fb,
+                                fb->node_index_bound(), std::move(dependents));
 }
 
 NodeDependencyAnalysis NodeDependencyAnalysis::ForwardDependents(
-    FunctionBase* fb, absl::Span<Node* const> nodes) {
-  absl::flat_hash_set<Node*> interesting(nodes.begin(), nodes.end());
-  auto [dependents, node_ids] = AnalyzeDependents(
-      fb, interesting, [](Node* node) { return node->users(); },
-      ReverseTopoSort(fb));
-  return NodeDependencyAnalysis(/*is_forwards=*/true, dependents, node_ids);
+    FunctionBase* fb, absl::Span<Node* const> nodes, int64_t thread_count) {
+  DenseNodeMap<InlineBitmap> dependents = AnalyzeDependents(
+      fb, nodes, [](Node* node) { return node->users(); },
+      ReverseTopoSort(fb), thread_count);
+  return NodeDependencyAnalysis(/*is_forwards=*/true, fb,
+                                fb->node_index_bound(), std::move(dependents));
 }
 
 }  // namespace xls
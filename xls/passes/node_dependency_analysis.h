@@ -18,48 +18,63 @@
 #include <cstdint>
 #include <utility>
 
-#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/dense_node_map.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 
 namespace xls {
 
 class NodeDependencyAnalysis;
+
+// A view of the dependents of a single node. The bitmap is indexed by
+// Node::node_index() and is owned by the NodeDependencyAnalysis it came from.
 class DependencyBitmap {
  public:
   DependencyBitmap(const DependencyBitmap&) = default;
   DependencyBitmap(DependencyBitmap&&) = default;
-  // Deleted because bitmap_ is const reference.
+  // Deleted because bitmap_ is a const reference.
   DependencyBitmap& operator=(const DependencyBitmap&) = delete;
   DependencyBitmap& operator=(DependencyBitmap&&) = delete;
 
+  // Returns the bitmap of dependents indexed by Node::node_index(). The bitmap
+  // has function_base()->node_index_bound() bits as of the analysis.
   const InlineBitmap& bitmap() const { return bitmap_; }
-  const absl::flat_hash_map<Node*, int64_t>& node_indices() const {
-    return node_indices_;
-  }
+
+  FunctionBase* function_base() const { return function_base_; }
+
   absl::StatusOr<bool> IsDependent(Node* n) const {
-    if (!node_indices_.contains(n)) {
+    if (n->function_base() != function_base_ ||
+        n->node_index() >= bitmap_.bit_count()) {
       return absl::InvalidArgumentError("node is from a different function!");
     }
-    return bitmap_.Get(node_indices_.at(n));
+    return bitmap_.Get(n->node_index());
   }
 
  private:
-  DependencyBitmap(const InlineBitmap& bitmap,
-                   const absl::flat_hash_map<Node*, int64_t>& node_ids)
-      : bitmap_(bitmap), node_indices_(node_ids) {}
+  DependencyBitmap(const InlineBitmap& bitmap, FunctionBase* function_base)
+      : bitmap_(bitmap), function_base_(function_base) {}
   const InlineBitmap& bitmap_;
-  const absl::flat_hash_map<Node*, int64_t> node_indices_;
+  FunctionBase* function_base_;
   friend class NodeDependencyAnalysis;
 };
 
 // Analysis which lets us check whether different nodes are connected or over a
 // horizon from each other.
+//
+// Dependents are only computed for the nodes which are needed to find the
+// dependents of the requested nodes, and the intermediate results of other
+// nodes are released as soon as they are no longer needed. The computation
+// proceeds over layers of the function in which no node depends on another and
+// if `thread_count` is greater than one the wide layers of large functions are
+// split into blocks which are computed concurrently. The result does not depend
+// on `thread_count`.
+//
+// The analysis is invalidated by modifying the function.
 class NodeDependencyAnalysis {
  public:
   NodeDependencyAnalysis(NodeDependencyAnalysis&&) = default;
@@ -73,7 +88,8 @@ class NodeDependencyAnalysis {
   // Optionally provide the set of nodes we will care about which will cause
   // this to only calculate the dependents for those given nodes.
   static NodeDependencyAnalysis ForwardDependents(
-      FunctionBase* fb, absl::Span<Node* const> nodes = {});
+      FunctionBase* fb, absl::Span<Node* const> nodes = {},
+      int64_t thread_count = 1);
 
   // Analyze the backwards dependents of the given nodes. That is find the nodes
   // which feed any a given node.
@@ -81,7 +97,8 @@ class NodeDependencyAnalysis {
   // Optionally provide the set of nodes we will care about which will cause
   // this to only calculate the dependents for those given nodes.
   static NodeDependencyAnalysis BackwardDependents(
-      FunctionBase* fb, absl::Span<Node* const> nodes = {});
+      FunctionBase* fb, absl::Span<Node* const> nodes = {},
+      int64_t thread_count = 1);
 
   // Returns if this is a forwards-dependency relationship. That is if
   // 'IsDependent(X, Y)' implies that a change in X could cause a change in Y.
@@ -91,8 +108,8 @@ class NodeDependencyAnalysis {
   // other calls will return error.
   bool IsAnalyzed(Node* node) const { return dependents_.contains(node); }
 
-  // Get the bitmap for Node->GetId() -> bool for dependents of 'node'. Return
-  // is owned by the NodeDependencyAnalysis object.
+  // Get the bitmap for Node->node_index() -> bool for dependents of 'node'.
+  // Return is a view of data owned by the NodeDependencyAnalysis object.
   absl::StatusOr<DependencyBitmap> GetDependents(Node* node) const;
 
   // Return if 'to' is a dependent of 'from'
@@ -100,21 +117,23 @@ class NodeDependencyAnalysis {
     XLS_ASSIGN_OR_RETURN(auto bitmap, GetDependents(from));
     return bitmap.IsDependent(to);
   }
-  const absl::flat_hash_map<Node*, int64_t>& node_indices() const {
-    return node_indices_;
-  }
+
+  // Returns the number of bits in each dependency bitmap.
+  int64_t bitmap_size() const { return bitmap_size_; }
 
  private:
-  NodeDependencyAnalysis(bool is_forwards,
-                         absl::flat_hash_map<Node*, InlineBitmap> dependents,
-                         absl::flat_hash_map<Node*, int64_t> node_ids)
+  NodeDependencyAnalysis(bool is_forwards, FunctionBase* function_base,
+                         int64_t bitmap_size,
+                         DenseNodeMap<InlineBitmap> dependents)
       : is_forward_(is_forwards),
-        dependents_(std::move(dependents)),
-        node_indices_(std::move(node_ids)) {}
+        function_base_(function_base),
+        bitmap_size_(bitmap_size),
+        dependents_(std::move(dependents)) {}
 
   bool is_forward_;
-  absl::flat_hash_map<Node*, InlineBitmap> dependents_;
-  absl::flat_hash_map<Node*, int64_t> node_indices_;
+  FunctionBase* function_base_;
+  int64_t bitmap_size_;
+  DenseNodeMap<InlineBitmap> dependents_;
 };
 
 }  // namespace xls
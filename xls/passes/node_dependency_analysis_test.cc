@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
@@ -294,6 +295,56 @@ TEST_F(NodeDependencyAnalysisTest, WorksWithNodeIdGaps) {
               testing::Not(status_testing::IsOk()));
 }
 
+TEST_F(NodeDependencyAnalysisTest, ParallelMatchesSerial) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  // Wide enough layers that they are split across threads.
+  constexpr int64_t kWidth = 4096;
+  std::vector<BValue> params;
+  params.reserve(kWidth);
+  for (int64_t i = 0; i < kWidth; ++i) {
+    params.push_back(fb.Param(absl::StrFormat("p%d", i), p->GetBitsType(8)));
+  }
+  std::vector<BValue> layer;
+  layer.reserve(kWidth);
+  for (int64_t i = 0; i < kWidth; ++i) {
+    layer.push_back(fb.Add(params[i], params[(i + 1) % kWidth]));
+  }
+  std::vector<BValue> top;
+  for (int64_t i = 0; i < kWidth; i += 256) {
+    top.push_back(fb.Add(layer[i], layer[kWidth - 1 - i]));
+  }
+  fb.Concat(top);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  NodeDependencyAnalysis serial_backward(
+      NodeDependencyAnalysis::BackwardDependents(f));
+  NodeDependencyAnalysis parallel_backward(
+      NodeDependencyAnalysis::BackwardDependents(f, {}, /*thread_count=*/4));
+  NodeDependencyAnalysis serial_forward(
+      NodeDependencyAnalysis::ForwardDependents(f));
+  NodeDependencyAnalysis parallel_forward(
+      NodeDependencyAnalysis::ForwardDependents(f, {}, /*thread_count=*/4));
+  for (Node* node : f->nodes()) {
+    XLS_ASSERT_OK_AND_ASSIGN(DependencyBitmap serial,
+                             serial_backward.GetDependents(node));
+    XLS_ASSERT_OK_AND_ASSIGN(DependencyBitmap parallel,
+                             parallel_backward.GetDependents(node));
+    EXPECT_EQ(serial.bitmap(), parallel.bitmap()) << node;
+    XLS_ASSERT_OK_AND_ASSIGN(DependencyBitmap serial_fwd,
+                             serial_forward.GetDependents(node));
+    XLS_ASSERT_OK_AND_ASSIGN(DependencyBitmap parallel_fwd,
+                             parallel_forward.GetDependents(node));
+    EXPECT_EQ(serial_fwd.bitmap(), parallel_fwd.bitmap()) << node;
+  }
+  EXPECT_THAT(parallel_backward.IsDependent(top.front().node(),
+                                            params[1].node()),
+              status_testing::IsOkAndHolds(true));
+  EXPECT_THAT(parallel_backward.IsDependent(top.front().node(),
+                                            params[2].node()),
+              status_testing::IsOkAndHolds(false));
+}
+
 template <typename Iter>
 Node* NodeAt(Iter nodes, int64_t off) {
   return *std::next(nodes.begin(), off);
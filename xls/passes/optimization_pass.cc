@@ -14,25 +14,36 @@
 
 #include "xls/passes/optimization_pass.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/passes/pass_base.h"
 
@@ -126,6 +137,251 @@ absl::StatusOr<std::vector<RamRewrite>> RamRewritesFromProto(
   return rewrites;
 }
 
+namespace {
+
+// Records the nodes added to a FunctionBase in the order they were added.
+// Entries for nodes which are subsequently removed are set to null.
+class AddedNodeRecorder : public ChangeListener {
+ public:
+  explicit AddedNodeRecorder(FunctionBase* f) : f_(f) {
+    f_->RegisterChangeListener(this);
+  }
+  ~AddedNodeRecorder() override {
+    if (f_ != nullptr) {
+      f_->UnregisterChangeListener(this);
+    }
+  }
+
+  absl::Span<Node* const> nodes() const { return nodes_; }
+
+  void NodeAdded(Node* node) override {
+    indices_[node] = nodes_.size();
+    nodes_.push_back(node);
+  }
+
+  void NodeDeleted(Node* node) override {
+    auto it = indices_.find(node);
+    if (it != indices_.end()) {
+      nodes_[it->second] = nullptr;
+      indices_.erase(it);
+    }
+  }
+
+  void FunctionBaseDeleted(FunctionBase* function_base) override {
+    f_ = nullptr;
+  }
+
+ private:
+  FunctionBase* f_;
+  std::vector<Node*> nodes_;
+  absl::flat_hash_map<Node*, int64_t> indices_;
+};
+
+// Returns true if none of the given FunctionBases call another FunctionBase.
+// Only such FunctionBases can be transformed concurrently as a pass may
+// inspect the FunctionBases called by the one it is transforming.
+bool AreIndependent(absl::Span<FunctionBase* const> function_bases) {
+  return std::all_of(function_bases.begin(), function_bases.end(),
+                     [](FunctionBase* f) {
+                       return GetDependentFunctions(f).size() == 1;
+                     });
+}
+
+// Calls `run_on_function_base` on each of the given FunctionBases and returns
+// whether any call returned true. If `options.thread_count` is greater than
+// one and the FunctionBases are independent the calls are made concurrently.
+//
+// The result of a concurrent run is identical to a serial run in the given
+// order. Node ids are allocated from a counter shared by the package, so the
+// nodes created during a concurrent run are renumbered afterwards to the ids
+// they would have received in a serial run. The relative order of the ids of
+// the nodes within each FunctionBase is unaffected by the renumbering.
+absl::StatusOr<bool> RunOnFunctionBases(
+    Package* p, absl::Span<FunctionBase* const> function_bases,
+    const OptimizationPassOptions& options,
+    absl::FunctionRef<absl::StatusOr<bool>(FunctionBase*)>
+        run_on_function_base) {
+  int64_t thread_count = std::min<int64_t>(options.thread_count,
+                                           function_bases.size());
+  if (thread_count <= 1 || !AreIndependent(function_bases)) {
+    bool changed = false;
+    for (FunctionBase* f : function_bases) {
+      XLS_ASSIGN_OR_RETURN(bool function_changed, run_on_function_base(f));
+      changed = changed || function_changed;
+    }
+    return changed;
+  }
+
+  int64_t first_new_id = p->next_node_id();
+  std::vector<std::unique_ptr<AddedNodeRecorder>> recorders;
+  recorders.reserve(function_bases.size());
+  for (FunctionBase* f : function_bases) {
+    recorders.push_back(std::make_unique<AddedNodeRecorder>(f));
+  }
+  std::vector<absl::StatusOr<bool>> results(function_bases.size(), false);
+  std::atomic<int64_t> next_index = 0;
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>([&]() {
+        for (int64_t index = next_index.fetch_add(1);
+             index < function_bases.size(); index = next_index.fetch_add(1)) {
+          results[index] = run_on_function_base(function_bases[index]);
+        }
+      }));
+    }
+    // Threads are joined on destruction.
+  }
+
+  bool changed = false;
+  for (const absl::StatusOr<bool>& result : results) {
+    XLS_RETURN_IF_ERROR(result.status());
+    changed = changed || *result;
+  }
+
+  // Renumber the new nodes in two phases. Node::SetId maintains user sets
+  // which are ordered by id so the relative order of the ids of the nodes in
+  // each FunctionBase must be preserved at every step. First move the new
+  // nodes, last to first, to ids above any assigned during the run. Then move
+  // them, first to last, to their final ids.
+  int64_t high_id = p->next_node_id();
+  int64_t offset = 0;
+  for (const std::unique_ptr<AddedNodeRecorder>& recorder : recorders) {
+    absl::Span<Node* const> nodes = recorder->nodes();
+    for (int64_t i = nodes.size() - 1; i >= 0; --i) {
+      if (nodes[i] != nullptr) {
+        nodes[i]->SetId(high_id + offset + i);
+      }
+    }
+    offset += nodes.size();
+  }
+  offset = 0;
+  for (const std::unique_ptr<AddedNodeRecorder>& recorder : recorders) {
+    absl::Span<Node* const> nodes = recorder->nodes();
+    for (int64_t i = 0; i < nodes.size(); ++i) {
+      if (nodes[i] != nullptr) {
+        nodes[i]->SetId(first_new_id + offset + i);
+      }
+    }
+    offset += nodes.size();
+  }
+  p->set_next_node_id(first_new_id + offset);
+  return changed;
+}
+
+// Calls `run_on_function_base` as RunOnFunctionBases does but only on those of
+// `function_bases` which `pass` may change according to
+// `options.change_tracker`.
+absl::StatusOr<bool> RunOnChangedFunctionBases(
+    const OptimizationPass* pass, Package* p,
+    absl::Span<FunctionBase* const> function_bases,
+    const OptimizationPassOptions& options, PassResults* results,
+    absl::FunctionRef<absl::StatusOr<bool>(FunctionBase*)>
+        run_on_function_base) {
+  FunctionBaseChangeTracker* tracker = options.change_tracker;
+  if (tracker == nullptr) {
+    return RunOnFunctionBases(p, function_bases, options,
+                              run_on_function_base);
+  }
+  std::vector<FunctionBase*> to_run =
+      tracker->FunctionBasesToRun(pass, function_bases, *results);
+  // Populated before the run so that concurrent runs only write values.
+  absl::flat_hash_map<FunctionBase*, bool> function_changed;
+  for (FunctionBase* f : to_run) {
+    function_changed[f] = false;
+  }
+  XLS_ASSIGN_OR_RETURN(
+      bool changed,
+      RunOnFunctionBases(p, to_run, options,
+                         [&](FunctionBase* f) -> absl::StatusOr<bool> {
+                           XLS_ASSIGN_OR_RETURN(bool f_changed,
+                                                run_on_function_base(f));
+                           function_changed.at(f) = f_changed;
+                           return f_changed;
+                         }));
+  for (FunctionBase* f : to_run) {
+    tracker->RecordRun(pass, f, function_changed.at(f));
+  }
+  tracker->RecordInvocation(pass, *results);
+  return changed;
+}
+
+}  // namespace
+
+std::vector<FunctionBase*> FunctionBaseChangeTracker::FunctionBasesToRun(
+    const OptimizationPass* pass,
+    absl::Span<FunctionBase* const> function_bases,
+    const PassResults& results) {
+  ProcessInvocations(results);
+  std::vector<FunctionBase*> to_run;
+  for (FunctionBase* f : function_bases) {
+    auto it = unchanged_since_.find({pass, f});
+    if (it == unchanged_since_.end()) {
+      to_run.push_back(f);
+      continue;
+    }
+    int64_t unchanged_epoch = it->second;
+    // A pass may inspect the FunctionBases called by `f`.
+    bool dependency_changed = false;
+    for (FunctionBase* dependency : GetDependentFunctions(f)) {
+      auto change_it = last_change_.find(dependency);
+      if (change_it != last_change_.end() &&
+          change_it->second > unchanged_epoch) {
+        dependency_changed = true;
+        break;
+      }
+    }
+    if (dependency_changed) {
+      to_run.push_back(f);
+    } else {
+      VLOG(2) << absl::StreamFormat(
+          "Skipping %s on %s: unchanged since the pass last ran",
+          pass->short_name(), f->name());
+    }
+  }
+  return to_run;
+}
+
+void FunctionBaseChangeTracker::RecordRun(const OptimizationPass* pass,
+                                          FunctionBase* f, bool changed) {
+  if (changed) {
+    last_change_[f] = ++epoch_;
+    unchanged_since_.erase({pass, f});
+  } else {
+    unchanged_since_[{pass, f}] = epoch_;
+  }
+}
+
+void FunctionBaseChangeTracker::RecordInvocation(const OptimizationPass* pass,
+                                                 const PassResults& results) {
+  recorded_invocation_ = {results.invocations.size(), pass->short_name()};
+}
+
+void FunctionBaseChangeTracker::ProcessInvocations(
+    const PassResults& results) {
+  for (int64_t i = processed_invocation_count_; i < results.invocations.size();
+       ++i) {
+    const PassInvocation& invocation = results.invocations[i];
+    if (recorded_invocation_.has_value() && recorded_invocation_->first == i &&
+        recorded_invocation_->second == invocation.pass_name) {
+      continue;
+    }
+    if (invocation.ir_changed) {
+      // The changes made by passes which are not function- or proc-level
+      // passes are not attributed to particular FunctionBases.
+      VLOG(2) << absl::StreamFormat(
+          "Pass %s changed the package; rerunning passes on all function "
+          "bases",
+          invocation.pass_name);
+      last_change_.clear();
+      unchanged_since_.clear();
+    }
+  }
+  processed_invocation_count_ = results.invocations.size();
+  recorded_invocation_.reset();
+}
+
 absl::StatusOr<bool> OptimizationFunctionBasePass::RunOnFunctionBase(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
@@ -146,13 +402,11 @@ absl::StatusOr<bool> OptimizationFunctionBasePass::RunOnFunctionBase(
 absl::StatusOr<bool> OptimizationFunctionBasePass::RunInternal(
     Package* p, const OptimizationPassOptions& options,
     PassResults* results) const {
-  bool changed = false;
-  for (FunctionBase* f : p->GetFunctionBases()) {
-    XLS_ASSIGN_OR_RETURN(bool function_changed,
-                         RunOnFunctionBaseInternal(f, options, results));
-    changed = changed || function_changed;
-  }
-  return changed;
+  return RunOnChangedFunctionBases(this, p, p->GetFunctionBases(), options,
+                                   results, [&](FunctionBase* f) {
+                                     return RunOnFunctionBaseInternal(
+                                         f, options, results);
+                                   });
 }
 
 absl::StatusOr<bool> OptimizationFunctionBasePass::TransformNodesToFixedPoint(
@@ -210,13 +464,22 @@ absl::StatusOr<bool> OptimizationProcPass::RunOnProc(
 absl::StatusOr<bool> OptimizationProcPass::RunInternal(
     Package* p, const OptimizationPassOptions& options,
     PassResults* results) const {
-  bool changed = false;
-  for (const auto& proc : p->procs()) {
-    XLS_ASSIGN_OR_RETURN(bool proc_changed,
-                         RunOnProcInternal(proc.get(), options, results));
-    changed = changed || proc_changed;
+  return RunOnProcs(p, options, results, [&](Proc* proc) {
+    return RunOnProcInternal(proc, options, results);
+  });
+}
+
+absl::StatusOr<bool> OptimizationProcPass::RunOnProcs(
+    Package* p, const OptimizationPassOptions& options, PassResults* results,
+    absl::FunctionRef<absl::StatusOr<bool>(Proc*)> run_on_proc) const {
+  std::vector<FunctionBase*> procs;
+  procs.reserve(p->procs().size());
+  for (const std::unique_ptr<Proc>& proc : p->procs()) {
+    procs.push_back(proc.get());
   }
-  return changed;
+  return RunOnChangedFunctionBases(
+      this, p, procs, options, results,
+      [&](FunctionBase* f) { return run_on_proc(f->AsProcOrDie()); });
 }
 
 }  // namespace xls
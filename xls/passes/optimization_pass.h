@@ -21,10 +21,13 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
@@ -35,6 +38,9 @@
 
 namespace xls {
 
+class FunctionBaseChangeTracker;
+class QueryEngineCache;
+
 // Metadata for RAMs.
 // TODO(google/xls#873): Ideally this metadata should live in the IR.
 //
@@ -129,8 +135,51 @@ struct OptimizationPassOptions : public PassOptionsBase {
   // variants.
   std::vector<RamRewrite> ram_rewrites;
 
+  // If set, inlining is staged so that large callees invoked from several call
+  // sites are optimized before they are inlined. A callee is staged if its node
+  // count times its number of call sites is at least this value. See
+  // InliningPass.
+  std::optional<int64_t> inlining_staging_threshold = std::nullopt;
+
+  // If set, counted for loops are unrolled one iteration at a time with each
+  // iteration inlined and simplified (folding values computed from the
+  // induction variable) before the next. Once unrolling a loop has added this
+  // many nodes to the function, its remaining iterations are left as a
+  // counted for.
+  std::optional<int64_t> unroll_node_budget = std::nullopt;
+
   // Use select context during narrowing range analysis.
   bool use_context_narrowing_analysis = false;
+
+  // If set, bounds the number of node evaluations the context sensitive
+  // narrowing analysis performs for each function. Select cases which don't fit
+  // in the budget are not used to narrow values.
+  std::optional<int64_t> context_narrowing_analysis_budget = std::nullopt;
+
+  // Cache of query engines shared by the passes of a pipeline. If set, passes
+  // which perform ternary or range analysis obtain their engines from the cache
+  // (see MakeTernaryQueryEngine) so that only nodes changed by earlier passes
+  // are re-analyzed. Not owned.
+  QueryEngineCache* query_engine_cache = nullptr;
+
+  // Number of threads used to run function- and proc-level passes. If greater
+  // than one, a pass is run concurrently on the FunctionBases of the package
+  // when none of them call another FunctionBase (e.g., after inlining). The
+  // resulting IR is identical to running the pass on each FunctionBase in
+  // turn.
+  int64_t thread_count = 1;
+
+  // Tracker of the FunctionBases changed by the passes of a pipeline. If set,
+  // function- and proc-level passes skip FunctionBases which have not changed
+  // since the pass last ran on them without changing them. Not owned.
+  FunctionBaseChangeTracker* change_tracker = nullptr;
+
+  // If set, the VerifierChecker verifies only the nodes added or changed since
+  // its previous run (along with new FunctionBases and package-wide name
+  // uniqueness) and verifies the entire package only every this many runs.
+  // Verifying the entire package after every pass dominates compile time for
+  // large packages with long pass pipelines.
+  std::optional<int64_t> incremental_verification_interval = std::nullopt;
 };
 
 // An object containing information about the invocation of a pass (single call
@@ -147,6 +196,57 @@ using OptimizationInvariantChecker = OptimizationCompoundPass::InvariantChecker;
 using OptimizationPipelineGenerator =
     PipelineGeneratorBase<Package, OptimizationPassOptions>;
 
+// Tracks the changes made to each FunctionBase during a run of a pass pipeline
+// so that function- and proc-level passes can skip FunctionBases which they
+// will not change. A pass is skipped on a FunctionBase if the last run of the
+// pass on it reported no change and neither the FunctionBase nor any
+// FunctionBase it calls has changed since. In a fixed-point compound pass this
+// avoids re-running every pass on every FunctionBase in each iteration when
+// only a few FunctionBases are still changing.
+//
+// Changes are attributed to FunctionBases using the value returned by each
+// pass, which fixed-point compound passes rely upon already. A change reported
+// by a pass which is not a function- or proc-level pass is assumed to affect
+// every FunctionBase. The tracker must only be used with a single PassResults
+// object.
+class FunctionBaseChangeTracker {
+ public:
+  // Returns the elements of `function_bases` on which `pass` must be run, in
+  // order. `results` is the results object of the pipeline.
+  std::vector<FunctionBase*> FunctionBasesToRun(
+      const OptimizationPass* pass,
+      absl::Span<FunctionBase* const> function_bases,
+      const PassResults& results);
+
+  // Records whether running `pass` on `f` changed it.
+  void RecordRun(const OptimizationPass* pass, FunctionBase* f, bool changed);
+
+  // Records that the changes made by the current invocation of `pass`, which
+  // has not yet been added to `results`, have been recorded by RecordRun.
+  void RecordInvocation(const OptimizationPass* pass,
+                        const PassResults& results);
+
+ private:
+  // Accounts for the changes made by the pass invocations added to `results`
+  // since the last call.
+  void ProcessInvocations(const PassResults& results);
+
+  // Incremented on each recorded change.
+  int64_t epoch_ = 0;
+  // The epoch of the most recent change to each FunctionBase.
+  absl::flat_hash_map<FunctionBase*, int64_t> last_change_;
+  // The epoch at which each pass last ran on each FunctionBase without
+  // changing it.
+  absl::flat_hash_map<std::pair<const OptimizationPass*, FunctionBase*>,
+                      int64_t>
+      unchanged_since_;
+  // The number of invocations in the PassResults which have been processed.
+  int64_t processed_invocation_count_ = 0;
+  // The index and pass name of the invocation recorded by RecordInvocation, if
+  // it has not been processed yet.
+  std::optional<std::pair<int64_t, std::string>> recorded_invocation_;
+};
+
 inline constexpr int64_t kMaxOptLevel = 3;
 
 using OptimizationPassStandardConfig = decltype(kMaxOptLevel);
@@ -216,6 +316,13 @@ class OptimizationProcPass : public OptimizationPass {
                                    const OptimizationPassOptions& options,
                                    PassResults* results) const override;
 
+  // Calls `run_on_proc` on each proc in the package which may have changed
+  // since this pass last ran. Passes which override RunInternal to share state
+  // between procs should iterate over the procs with this method.
+  absl::StatusOr<bool> RunOnProcs(
+      Package* p, const OptimizationPassOptions& options, PassResults* results,
+      absl::FunctionRef<absl::StatusOr<bool>(Proc*)> run_on_proc) const;
+
   virtual absl::StatusOr<bool> RunOnProcInternal(
       Proc* proc, const OptimizationPassOptions& options,
       PassResults* results) const = 0;
@@ -49,6 +49,7 @@
 #include "xls/passes/dataflow_simplification_pass.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/dfe_pass.h"
+#include "xls/passes/function_deduplication_pass.h"
 #include "xls/passes/identity_removal_pass.h"
 #include "xls/passes/inlining_pass.h"
 #include "xls/passes/label_recovery_pass.h"
@@ -62,6 +63,7 @@
 #include "xls/passes/proc_state_flattening_pass.h"
 #include "xls/passes/proc_state_narrowing_pass.h"
 #include "xls/passes/proc_state_optimization_pass.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/ram_rewrite_pass.h"
 #include "xls/passes/reassociation_pass.h"
 #include "xls/passes/receive_default_value_simplification_pass.h"
@@ -148,6 +150,9 @@ PreInliningPassGroup::PreInliningPassGroup(int64_t opt_level)
                                "pre-inlining passes") {
   Add<DeadFunctionEliminationPass>();
   Add<DeadCodeEliminationPass>();
+  // Merge identical functions before they are simplified and inlined so that
+  // the work is done once per unique body.
+  Add<FunctionDeduplicationPass>();
   // At this stage in the pipeline only optimizations up to level 2 should
   // run. 'opt_level' is the maximum level of optimization which should be run
   // in the entire pipeline so set the level of the simplification pass to the
@@ -160,7 +165,10 @@ UnrollingAndInliningPassGroup::UnrollingAndInliningPassGroup(int64_t opt_level)
                                "full function inlining passes") {
   Add<UnrollPass>();
   Add<MapInliningPass>();
-  Add<InliningPass>();
+  // Callees kept out-of-line by staged inlining are optimized with the
+  // post-inlining simplification passes before being inlined.
+  Add<InliningPass>(std::make_unique<FixedPointSimplificationPass>(
+      std::min(int64_t{2}, opt_level)));
   Add<DeadFunctionEliminationPass>();
 }
 
@@ -261,8 +269,13 @@ absl::StatusOr<bool> RunOptimizationPassPipeline(Package* package,
                                                  int64_t opt_level) {
   std::unique_ptr<OptimizationCompoundPass> pipeline =
       CreateOptimizationPassPipeline();
+  QueryEngineCache query_engine_cache;
+  FunctionBaseChangeTracker change_tracker;
+  OptimizationPassOptions options;
+  options.query_engine_cache = &query_engine_cache;
+  options.change_tracker = &change_tracker;
   PassResults results;
-  return pipeline->Run(package, OptimizationPassOptions(), &results);
+  return pipeline->Run(package, options, &results);
 }
 
 absl::Status OptimizationPassPipelineGenerator::AddPassToPipeline(
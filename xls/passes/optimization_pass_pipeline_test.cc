@@ -14,24 +14,34 @@
 
 #include "xls/passes/optimization_pass_pipeline.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
 
+#include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/status/matchers.h"
 #include "xls/examples/sample_packages.h"
+#include "xls/ir/benchmark_support.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/package.h"
+#include "xls/ir/value.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine_cache.h"
 
 namespace m = ::xls::op_matchers;
 
@@ -273,5 +283,113 @@ TEST_F(OptimizationPipelineTest, LogicCombining) {
   EXPECT_THAT(f->return_value(), m::Param("x"));
 }
 
+// Builds a package containing independent procs and functions with plenty of
+// opportunities for optimization.
+void BuildIndependentFunctionBases(Package* p) {
+  for (int64_t i = 0; i < 8; ++i) {
+    Channel* in = p->CreateStreamingChannel(absl::StrFormat("in%d", i),
+                                            ChannelOps::kReceiveOnly,
+                                            p->GetBitsType(32))
+                      .value();
+    Channel* out = p->CreateStreamingChannel(absl::StrFormat("out%d", i),
+                                             ChannelOps::kSendOnly,
+                                             p->GetBitsType(32))
+                       .value();
+    ProcBuilder pb(absl::StrFormat("proc%d", i), "tkn", p);
+    BValue state = pb.StateElement("st", Value(UBits(i, 32)));
+    BValue receive = pb.Receive(in, pb.GetTokenParam());
+    BValue x = pb.TupleIndex(receive, 1);
+    BValue scaled = pb.UMul(x, pb.Literal(UBits(8, 32)));
+    BValue masked = pb.And(pb.Add(scaled, pb.Literal(UBits(0, 32))),
+                           pb.Literal(UBits(0xfff0, 32)));
+    BValue selected = pb.Select(pb.ULt(masked, pb.Literal(UBits(i, 32))),
+                                {state, masked});
+    BValue send = pb.Send(out, pb.TupleIndex(receive, 0), selected);
+    CHECK_OK(pb.Build(send, {pb.Add(state, pb.Literal(UBits(1, 32)))})
+                 .status());
+
+    FunctionBuilder fb(absl::StrFormat("func%d", i), p);
+    BValue a = fb.Param("a", p->GetBitsType(16));
+    BValue b = fb.Param("b", p->GetBitsType(16));
+    BValue sum = fb.Add(fb.ZeroExtend(a, 32), fb.ZeroExtend(b, 32));
+    fb.Concat(
+        {fb.BitSlice(sum, 16, 16), fb.Not(fb.Not(fb.BitSlice(sum, 0, 16)))});
+    CHECK_OK(fb.Build().status());
+  }
+}
+
+TEST_F(OptimizationPipelineTest, ParallelRunMatchesSerialRun) {
+  auto serial = CreatePackage();
+  BuildIndependentFunctionBases(serial.get());
+  auto parallel = CreatePackage();
+  BuildIndependentFunctionBases(parallel.get());
+  ASSERT_EQ(serial->DumpIr(), parallel->DumpIr());
+
+  std::unique_ptr<OptimizationCompoundPass> pipeline =
+      CreateOptimizationPassPipeline();
+  PassResults results;
+  QueryEngineCache serial_cache;
+  OptimizationPassOptions serial_options;
+  serial_options.query_engine_cache = &serial_cache;
+  ASSERT_THAT(pipeline->Run(serial.get(), serial_options, &results),
+              IsOkAndHolds(true));
+
+  QueryEngineCache parallel_cache;
+  OptimizationPassOptions parallel_options;
+  parallel_options.query_engine_cache = &parallel_cache;
+  parallel_options.thread_count = 4;
+  ASSERT_THAT(pipeline->Run(parallel.get(), parallel_options, &results),
+              IsOkAndHolds(true));
+
+  EXPECT_EQ(serial->DumpIr(), parallel->DumpIr());
+  EXPECT_EQ(serial->next_node_id(), parallel->next_node_id());
+}
+
+// Measures the optimization pipeline on generated designs of increasing size,
+// and reports its complexity in the size.
+void BM_OptimizationPipeline(benchmark::State& state,
+                             benchmark_support::ScalingDesign design) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    Package package("BM");
+    FunctionBase* top = benchmark_support::GenerateScalingDesign(
+                            design, &package, state.range(0))
+                            .value();
+    CHECK_OK(package.SetTop(top));
+    state.ResumeTiming();
+    CHECK_OK(RunOptimizationPassPipeline(&package).status());
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+void ScalingArgs(benchmark::internal::Benchmark* b) {
+  b->RangeMultiplier(4)
+      ->Range(16, 1024)
+      ->Complexity()
+      ->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_CAPTURE(BM_OptimizationPipeline, chain,
+                  benchmark_support::ScalingDesign::kChain)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_OptimizationPipeline, balanced_tree,
+                  benchmark_support::ScalingDesign::kBalancedTree)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_OptimizationPipeline, ladder,
+                  benchmark_support::ScalingDesign::kLadder)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_OptimizationPipeline, large_select,
+                  benchmark_support::ScalingDesign::kLargeSelect)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_OptimizationPipeline, dynamic_array,
+                  benchmark_support::ScalingDesign::kDynamicArray)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_OptimizationPipeline, wide_state_proc,
+                  benchmark_support::ScalingDesign::kWideStateProc)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_OptimizationPipeline, proc_network,
+                  benchmark_support::ScalingDesign::kProcNetwork)
+    ->Apply(ScalingArgs);
+
 }  // namespace
 }  // namespace xls
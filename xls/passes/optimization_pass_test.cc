@@ -24,6 +24,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -34,15 +35,21 @@
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/ir/type.h"
+#include "xls/ir/value.h"
 #include "xls/passes/pass_base.h"
 
+namespace m = ::xls::op_matchers;
+
 namespace xls {
 namespace {
 
@@ -423,6 +430,91 @@ TEST(PassesTest, TestTransformNodesToFixedPointWhileRemovingNodes) {
       IsOkAndHolds(false));
 }
 
+// Decrements the value of functions which return a non-zero literal and counts
+// the number of times it is run on each function.
+class CountDownPass : public OptimizationFunctionBasePass {
+ public:
+  CountDownPass() : OptimizationFunctionBasePass("count_down", "Count down") {}
+
+  int64_t run_count(std::string_view function_name) const {
+    auto it = run_counts_.find(function_name);
+    return it == run_counts_.end() ? 0 : it->second;
+  }
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override {
+    ++run_counts_[f->name()];
+    Node* ret = f->AsFunctionOrDie()->return_value();
+    if (!ret->Is<Literal>() || ret->As<Literal>()->value().bits().IsZero()) {
+      return false;
+    }
+    XLS_RETURN_IF_ERROR(
+        ret->ReplaceUsesWithNew<Literal>(
+               Value(bits_ops::Decrement(ret->As<Literal>()->value().bits())))
+            .status());
+    return true;
+  }
+
+ private:
+  mutable absl::flat_hash_map<std::string, int64_t> run_counts_;
+};
+
+TEST(PassesTest, ChangeTrackerSkipsUnchangedFunctions) {
+  auto p = std::make_unique<Package>("p");
+  for (auto [name, value] : {std::pair{"a", 3}, std::pair{"b", 0}}) {
+    FunctionBuilder fb(name, p.get());
+    fb.Literal(UBits(value, 8));
+    XLS_ASSERT_OK(fb.Build().status());
+  }
+  OptimizationFixedPointCompoundPass fixed_point("fixed", "fixed");
+  auto* count_down = fixed_point.Add<CountDownPass>();
+  FunctionBaseChangeTracker tracker;
+  OptimizationPassOptions options;
+  options.change_tracker = &tracker;
+  PassResults results;
+  EXPECT_THAT(fixed_point.Run(p.get(), options, &results), IsOkAndHolds(true));
+
+  // `a` is changed in the first three iterations and unchanged in the fourth.
+  // `b` is unchanged in the first iteration and skipped thereafter.
+  EXPECT_EQ(count_down->run_count("a"), 4);
+  EXPECT_EQ(count_down->run_count("b"), 1);
+  EXPECT_EQ(results.invocations.size(), 4);
+  for (FunctionBase* f : p->GetFunctionBases()) {
+    EXPECT_THAT(f->AsFunctionOrDie()->return_value(),
+                m::Literal(UBits(0, 8)));
+  }
+}
+
+TEST(PassesTest, ChangeTrackerRerunsAfterPackageLevelChange) {
+  auto p = std::make_unique<Package>("p");
+  FunctionBuilder fb("a", p.get());
+  fb.Literal(UBits(0, 8));
+  XLS_ASSERT_OK(fb.Build().status());
+  OptimizationCompoundPass count_down_pipeline("count_down", "count_down");
+  auto* count_down = count_down_pipeline.Add<CountDownPass>();
+  OptimizationCompoundPass unchanged_pipeline("unchanged", "unchanged");
+  unchanged_pipeline.Add<DummyPass>("unchanged", "unchanged",
+                                    /*change=*/false);
+  OptimizationCompoundPass changed_pipeline("changed", "changed");
+  changed_pipeline.Add<DummyPass>("changed", "changed", /*change=*/true);
+
+  FunctionBaseChangeTracker tracker;
+  OptimizationPassOptions options;
+  options.change_tracker = &tracker;
+  PassResults results;
+  for (OptimizationCompoundPass* pipeline :
+       {&count_down_pipeline, &unchanged_pipeline, &count_down_pipeline,
+        &changed_pipeline, &count_down_pipeline}) {
+    XLS_ASSERT_OK(pipeline->Run(p.get(), options, &results).status());
+  }
+
+  // The pass is skipped after the first run until the package-level pass
+  // reports a change.
+  EXPECT_EQ(count_down->run_count("a"), 2);
+}
+
 TEST(RamDatastructuresTest, AddrWidthCorrect) {
   RamConfig config{.kind = RamKind::kAbstract, .depth = 2};
   EXPECT_EQ(config.addr_width(), 1);
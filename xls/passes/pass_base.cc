@@ -15,13 +15,17 @@
 #include "xls/passes/pass_base.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_format.h"
 #include "absl/time/time.h"
 #include "xls/ir/package.h"
+#include "xls/passes/pass_metrics.pb.h"
 
 namespace xls {
 
@@ -71,4 +75,95 @@ std::string CompoundPassResult::ToString() const {
   return s;
 }
 
+namespace {
+
+int64_t DurationToUs(absl::Duration duration) {
+  return absl::ToInt64Microseconds(duration);
+}
+
+// Sorts the given profile entries in descending order of total duration,
+// breaking ties by name.
+template <typename ProtoT>
+void SortByDuration(google::protobuf::RepeatedPtrField<ProtoT>* entries) {
+  std::sort(entries->begin(), entries->end(),
+            [](const ProtoT& a, const ProtoT& b) {
+              if (a.total_duration_us() != b.total_duration_us()) {
+                return a.total_duration_us() > b.total_duration_us();
+              }
+              return a.pass_name() < b.pass_name();
+            });
+}
+
+}  // namespace
+
+PassPipelineProfileProto PassResultsToProfileProto(const PassResults& results) {
+  absl::flat_hash_map<std::string, SinglePassResult> pass_results;
+  // Maximum IR and analysis memory of the runs of each pass.
+  absl::flat_hash_map<std::string, std::pair<int64_t, int64_t>> pass_memory;
+  absl::flat_hash_map<std::string, absl::flat_hash_map<std::string, int64_t>>
+      pass_counters;
+  absl::Duration total_duration;
+  for (const PassInvocation& invocation : results.invocations) {
+    SinglePassResult& result = pass_results[invocation.pass_name];
+    ++result.run_count;
+    result.changed_count += invocation.ir_changed ? 1 : 0;
+    result.duration += invocation.run_duration;
+    result.metrics = result.metrics + invocation.metrics;
+    total_duration += invocation.run_duration;
+    auto& [ir_bytes, analysis_bytes] = pass_memory[invocation.pass_name];
+    ir_bytes = std::max(ir_bytes, invocation.ir_memory_bytes);
+    analysis_bytes = std::max(analysis_bytes, invocation.analysis_memory_bytes);
+    absl::flat_hash_map<std::string, int64_t>& counters =
+        pass_counters[invocation.pass_name];
+    for (const auto& [counter, value] : invocation.counters) {
+      counters[counter] += value;
+    }
+  }
+
+  PassPipelineProfileProto profile;
+  profile.set_invocation_count(results.invocations.size());
+  profile.set_total_duration_us(DurationToUs(total_duration));
+  profile.set_invariant_checker_run_count(results.invariant_checker_run_count);
+  profile.set_invariant_checker_duration_us(
+      DurationToUs(results.invariant_checker_duration));
+  for (const auto& [name, result] : pass_results) {
+    PassProfileProto* pass = profile.add_passes();
+    pass->set_pass_name(name);
+    pass->set_run_count(result.run_count);
+    pass->set_changed_count(result.changed_count);
+    pass->set_total_duration_us(DurationToUs(result.duration));
+    TransformMetricsProto* metrics = pass->mutable_metrics();
+    metrics->set_nodes_added(result.metrics.nodes_added);
+    metrics->set_nodes_removed(result.metrics.nodes_removed);
+    metrics->set_nodes_replaced(result.metrics.nodes_replaced);
+    metrics->set_operands_replaced(result.metrics.operands_replaced);
+    const auto& [ir_bytes, analysis_bytes] = pass_memory.at(name);
+    pass->set_max_ir_memory_bytes(ir_bytes);
+    pass->set_max_analysis_memory_bytes(analysis_bytes);
+    for (const auto& [counter, value] : pass_counters.at(name)) {
+      (*pass->mutable_counters())[counter] = value;
+    }
+  }
+  SortByDuration(profile.mutable_passes());
+
+  absl::flat_hash_map<std::string, FixedPointProfileProto> fixed_points;
+  for (const FixedPointInvocation& invocation :
+       results.fixed_point_invocations) {
+    FixedPointProfileProto& fixed_point = fixed_points[invocation.pass_name];
+    fixed_point.set_pass_name(invocation.pass_name);
+    fixed_point.set_run_count(fixed_point.run_count() + 1);
+    fixed_point.set_total_iterations(fixed_point.total_iterations() +
+                                     invocation.iteration_count);
+    fixed_point.set_max_iterations(
+        std::max(fixed_point.max_iterations(), invocation.iteration_count));
+    fixed_point.set_total_duration_us(fixed_point.total_duration_us() +
+                                      DurationToUs(invocation.run_duration));
+  }
+  for (auto& [name, fixed_point] : fixed_points) {
+    *profile.add_fixed_points() = std::move(fixed_point);
+  }
+  SortByDuration(profile.mutable_fixed_points());
+  return profile;
+}
+
 }  // namespace xls
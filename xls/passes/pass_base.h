@@ -25,12 +25,14 @@
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
@@ -39,7 +41,9 @@
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/trace.h"
 #include "xls/ir/package.h"
+#include "xls/passes/pass_metrics.pb.h"
 
 namespace xls {
 
@@ -66,6 +70,11 @@ struct PassOptionsBase {
   // number of passes executed might change due to setting this field as
   // fixed-points may complete earlier.
   std::optional<int64_t> bisect_limit;
+
+  // Whether to estimate the memory used by the IR after each pass and by the
+  // analyses of passes which report it. This walks the entire IR so it is
+  // disabled by default.
+  bool record_memory_usage = false;
 };
 
 // An object containing information about the invocation of a pass (single call
@@ -79,6 +88,32 @@ struct PassInvocation {
 
   // The run duration of the pass.
   absl::Duration run_duration;
+
+  // The transformations performed by the pass.
+  TransformMetrics metrics;
+
+  // The estimated memory used by the IR after the pass and the peak estimated
+  // memory used by analyses during the pass, in bytes. Only recorded if
+  // PassOptionsBase::record_memory_usage is set.
+  int64_t ir_memory_bytes = 0;
+  int64_t analysis_memory_bytes = 0;
+
+  // Pass-specific statistics recorded with PassResults::IncrementCounter, e.g.,
+  // the number of bits removed by narrowing.
+  absl::flat_hash_map<std::string, int64_t> counters;
+};
+
+// An object containing information about a single run of a fixed-point
+// compound pass.
+struct FixedPointInvocation {
+  // The name of the compound pass.
+  std::string pass_name;
+
+  // The number of iterations required to reach the fixed point.
+  int64_t iteration_count;
+
+  // The run duration of the compound pass including all nested passes.
+  absl::Duration run_duration;
 };
 
 // A object to which metadata may be written in each pass invocation. This data
@@ -86,8 +121,51 @@ struct PassInvocation {
 struct PassResults {
   // This vector contains and entry for each invocation of each pass.
   std::vector<PassInvocation> invocations;
+
+  // This vector contains an entry for each run of each fixed-point compound
+  // pass.
+  std::vector<FixedPointInvocation> fixed_point_invocations;
+
+  // Records the estimated memory used by an analysis constructed by the
+  // currently running pass. The largest value recorded is attributed to the
+  // invocation of the pass.
+  void RecordAnalysisMemoryUsage(int64_t bytes) {
+    pending_analysis_memory_bytes =
+        std::max(pending_analysis_memory_bytes, bytes);
+  }
+
+  // The peak analysis memory recorded by the running pass so far.
+  int64_t pending_analysis_memory_bytes = 0;
+
+  // Adds `amount` to the pass-specific counter `name` of the currently running
+  // pass. The counters are attributed to the invocation of the pass. May be
+  // called concurrently by a pass running on several FunctionBases at once.
+  void IncrementCounter(std::string_view name, int64_t amount) {
+    absl::MutexLock lock(&counters_mutex);
+    pending_counters[std::string(name)] += amount;
+  }
+
+  // Returns the counters recorded by the running pass and resets them.
+  absl::flat_hash_map<std::string, int64_t> TakePendingCounters() {
+    absl::MutexLock lock(&counters_mutex);
+    return std::exchange(pending_counters, {});
+  }
+
+  absl::Mutex counters_mutex;
+  absl::flat_hash_map<std::string, int64_t> pending_counters
+      ABSL_GUARDED_BY(counters_mutex);
+
+  // The number of runs of invariant checkers, and the total time spent in them.
+  // Checkers such as the scheduling checker can take as long as the passes
+  // they check on large designs.
+  int64_t invariant_checker_run_count = 0;
+  absl::Duration invariant_checker_duration;
 };
 
+// Returns a profile of the pass invocations recorded in `results` aggregated
+// by pass name.
+PassPipelineProfileProto PassResultsToProfileProto(const PassResults& results);
+
 // Base class for all compiler passes. Template parameters:
 //
 //   IrT : The data type that the pass operates on (e.g., xls::Package). The
@@ -130,6 +208,7 @@ class PassBase {
   // fixed point computation.
   virtual absl::StatusOr<bool> Run(IrT* ir, const OptionsT& options,
                                    ResultsT* results) const {
+    TraceSpan span(short_name());
     VLOG(2) << absl::StreamFormat("Running %s [pass #%d]", long_name(),
                                   results->invocations.size());
     VLOG(3) << "Before:";
@@ -328,6 +407,7 @@ class FixedPointCompoundPassBase
     bool local_changed = true;
     int64_t iteration_count = 0;
     CompoundPassResult aggregate_result;
+    absl::Time start = absl::Now();
     while (local_changed) {
       ++iteration_count;
       XLS_ASSIGN_OR_RETURN(
@@ -339,6 +419,8 @@ class FixedPointCompoundPassBase
       local_changed = compound_result.changed();
       aggregate_result.AccumulateCompoundPassResult(compound_result);
     }
+    results->fixed_point_invocations.push_back(
+        {this->short_name(), iteration_count, absl::Now() - start});
     VLOG(1) << absl::StreamFormat(
         "Fixed point compound pass %s iterated %d times.", this->long_name(),
         iteration_count);
@@ -367,7 +449,11 @@ CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
   auto run_invariant_checkers =
       [&](std::string_view str_context) -> absl::Status {
     for (const auto& checker : checkers) {
+      TraceSpan span("invariant_checker");
+      absl::Time checker_start = absl::Now();
       absl::Status status = checker->Run(ir, options, results);
+      ++results->invariant_checker_run_count;
+      results->invariant_checker_duration += absl::Now() - checker_start;
       if (!status.ok()) {
         return absl::Status(status.code(), absl::StrCat(status.message(), "; [",
                                                         str_context, "]"));
@@ -385,10 +471,7 @@ CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
                                   pass->long_name(), pass->short_name(),
                                   results->invocations.size(), ir->name());
 
-    TransformMetrics before_metrics;
-    if (VLOG_IS_ON(1)) {
-      before_metrics = ir->transform_metrics();
-    }
+    TransformMetrics before_metrics = ir->transform_metrics();
 
     if (!pass->IsCompound() && options.bisect_limit &&
         results->invocations.size() >= options.bisect_limit) {
@@ -451,8 +534,18 @@ CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
       VLOG(1) << absl::StrFormat("Metrics: %s", pass_metrics.ToString());
     }
     if (!pass->IsCompound()) {
-      results->invocations.push_back(
-          {pass->short_name(), pass_changed, duration});
+      PassInvocation invocation{pass->short_name(), pass_changed, duration,
+                                pass_metrics};
+      if (options.record_memory_usage) {
+        if constexpr (requires { ir->EstimateMemoryUsage(); }) {
+          invocation.ir_memory_bytes = ir->EstimateMemoryUsage().TotalBytes();
+        }
+        invocation.analysis_memory_bytes =
+            results->pending_analysis_memory_bytes;
+      }
+      results->pending_analysis_memory_bytes = 0;
+      invocation.counters = results->TakePendingCounters();
+      results->invocations.push_back(std::move(invocation));
     }
     if (!options.ir_dump_path.empty()) {
       XLS_RETURN_IF_ERROR(DumpIr(options.ir_dump_path, ir, top_level_name,
@@ -14,12 +14,15 @@
 
 #include "xls/passes/pass_base.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
@@ -38,6 +41,7 @@
 #include "xls/ir/value.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_metrics.pb.h"
 
 namespace m = ::xls::op_matchers;
 namespace xls {
@@ -288,5 +292,110 @@ TEST_F(PassBaseTest, BisectLimitZero) {
   EXPECT_THAT(results.invocations, IsEmpty());
 }
 
+TEST_F(PassBaseTest, ProfileProto) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Literal(UBits(0, 2));
+  XLS_ASSERT_OK(fb.Build().status());
+  OptimizationCompoundPass opt("opt", "opt");
+  {
+    auto fp =
+        std::make_unique<OptimizationFixedPointCompoundPass>("fixed", "fixed");
+    fp->Add<LevelUpPass>();
+    fp->Add<DeadCodeEliminationPass>();
+    opt.AddOwned(std::move(fp));
+  }
+  opt.Add<DeadCodeEliminationPass>();
+  PassResults results;
+  XLS_ASSERT_OK(opt.Run(p.get(), OptimizationPassOptions(), &results));
+
+  // The literal is increased from 0 to 3 in three iterations and a fourth
+  // iteration finds nothing to change.
+  PassPipelineProfileProto profile = PassResultsToProfileProto(results);
+  EXPECT_EQ(profile.invocation_count(), 9);
+  ASSERT_EQ(profile.passes_size(), 2);
+  absl::flat_hash_map<std::string, PassProfileProto> passes;
+  for (const PassProfileProto& pass : profile.passes()) {
+    passes[pass.pass_name()] = pass;
+  }
+  EXPECT_EQ(passes.at("level_up").run_count(), 4);
+  EXPECT_EQ(passes.at("level_up").changed_count(), 3);
+  EXPECT_EQ(passes.at("level_up").metrics().nodes_added(), 3);
+  EXPECT_EQ(passes.at("dce").run_count(), 5);
+  EXPECT_EQ(passes.at("dce").changed_count(), 3);
+  EXPECT_EQ(passes.at("dce").metrics().nodes_removed(), 3);
+
+  ASSERT_EQ(profile.fixed_points_size(), 1);
+  EXPECT_EQ(profile.fixed_points(0).pass_name(), "fixed");
+  EXPECT_EQ(profile.fixed_points(0).run_count(), 1);
+  EXPECT_EQ(profile.fixed_points(0).total_iterations(), 4);
+  EXPECT_EQ(profile.fixed_points(0).max_iterations(), 4);
+}
+
+// An invariant checker which counts its runs.
+class CountingChecker : public OptimizationInvariantChecker {
+ public:
+  explicit CountingChecker(int64_t* run_count) : run_count_(run_count) {}
+
+  absl::Status Run(Package* p, const OptimizationPassOptions& options,
+                   PassResults* results) const override {
+    ++*run_count_;
+    return absl::OkStatus();
+  }
+
+ private:
+  int64_t* run_count_;
+};
+
+TEST_F(PassBaseTest, ProfileProtoInvariantCheckers) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Literal(UBits(0, 2));
+  XLS_ASSERT_OK(fb.Build().status());
+  OptimizationCompoundPass opt("opt", "opt");
+  opt.Add<LevelUpPass>();
+  opt.Add<DeadCodeEliminationPass>();
+  int64_t run_count = 0;
+  opt.AddInvariantChecker<CountingChecker>(&run_count);
+
+  // The checker runs at the start of the pipeline and after each pass which
+  // changes the IR.
+  PassResults results;
+  XLS_ASSERT_OK(opt.Run(p.get(), OptimizationPassOptions(), &results));
+  EXPECT_EQ(run_count, 3);
+  EXPECT_EQ(results.invariant_checker_run_count, 3);
+  PassPipelineProfileProto profile = PassResultsToProfileProto(results);
+  EXPECT_EQ(profile.invariant_checker_run_count(), 3);
+  EXPECT_GE(profile.invariant_checker_duration_us(), 0);
+}
+
+TEST_F(PassBaseTest, ProfileProtoMemoryUsage) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Literal(UBits(0, 2));
+  XLS_ASSERT_OK(fb.Build().status());
+  OptimizationCompoundPass opt("opt", "opt");
+  opt.Add<LevelUpPass>();
+  opt.Add<DeadCodeEliminationPass>();
+
+  PassResults results;
+  XLS_ASSERT_OK(opt.Run(p.get(), OptimizationPassOptions(), &results));
+  PassPipelineProfileProto profile = PassResultsToProfileProto(results);
+  ASSERT_EQ(profile.passes_size(), 2);
+  EXPECT_EQ(profile.passes(0).max_ir_memory_bytes(), 0);
+
+  PassResults memory_results;
+  XLS_ASSERT_OK(opt.Run(
+      p.get(),
+      OptimizationPassOptions(PassOptionsBase{.record_memory_usage = true}),
+      &memory_results));
+  profile = PassResultsToProfileProto(memory_results);
+  ASSERT_EQ(profile.passes_size(), 2);
+  for (const PassProfileProto& pass : profile.passes()) {
+    EXPECT_GT(pass.max_ir_memory_bytes(), 0) << pass.pass_name();
+    EXPECT_EQ(pass.max_analysis_memory_bytes(), 0) << pass.pass_name();
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -22,13 +22,13 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
-#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/meta/type_traits.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/ir/dense_node_map.h"
 #include "xls/ir/function.h"
 #include "xls/ir/node.h"
 #include "xls/ir/node_util.h"
@@ -101,7 +101,8 @@ PostDominatorAnalysis::Run(FunctionBase* f) {
   // Construct the postdominators for each node. Postdominators are gathered as
   // a sorted vector containing the node indices (in a reverse toposort) of the
   // post dominator nodes.
-  absl::flat_hash_map<Node*, std::vector<NodeIndex>> postdominators;
+  DenseNodeMap<std::vector<NodeIndex>> postdominators;
+  postdominators.reserve(reverse_toposort.size());
   for (NodeIndex i = 0; i < reverse_toposort.size(); ++i) {
     Node* node = reverse_toposort[i];
     std::vector<absl::Span<const NodeIndex>> user_postdominators;
@@ -130,9 +131,8 @@ PostDominatorAnalysis::Run(FunctionBase* f) {
 
   // Order nodes.
   auto generate_ordered_by_id_nodes =
-      [](const absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>>&
-             node_to_node_set,
-         absl::flat_hash_map<Node*, std::vector<Node*>>* node_to_node_vect) {
+      [](const DenseNodeMap<absl::flat_hash_set<Node*>>& node_to_node_set,
+         DenseNodeMap<std::vector<Node*>>* node_to_node_vect) {
         for (auto& [base_node, node_set] : node_to_node_set) {
           auto& node_vect = (*node_to_node_vect)[base_node];
           node_vect.insert(node_vect.begin(), node_set.begin(), node_set.end());
@@ -21,6 +21,7 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/ir/dense_node_map.h"
 #include "xls/ir/function.h"
 #include "xls/ir/node.h"
 
@@ -53,15 +54,13 @@ class PostDominatorAnalysis {
 
  private:
   // Maps from a node to all nodes that post-dominate the node.
-  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>>
-      dominated_node_to_post_dominators_;
-  absl::flat_hash_map<Node*, std::vector<Node*>>
+  DenseNodeMap<absl::flat_hash_set<Node*>> dominated_node_to_post_dominators_;
+  DenseNodeMap<std::vector<Node*>>
       dominated_node_to_post_dominators_ordered_by_id_;
 
   // Maps from a node to all nodes that are post-dominated by the node.
-  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>>
-      post_dominator_to_dominated_nodes_;
-  absl::flat_hash_map<Node*, std::vector<Node*>>
+  DenseNodeMap<absl::flat_hash_set<Node*>> post_dominator_to_dominated_nodes_;
+  DenseNodeMap<std::vector<Node*>>
       post_dominator_to_dominated_nodes_ordered_by_id_;
 };
 
@@ -1300,6 +1300,17 @@ class ProcThread {
     return sink_activation_node_->activation_out;
   }
 
+  // Returns the outgoing activation bits of every node in the activation
+  // network.
+  std::vector<Node*> GetActivationBits() const {
+    std::vector<Node*> bits;
+    bits.reserve(activation_nodes_.size());
+    for (const ActivationNode& anode : activation_nodes_) {
+      bits.push_back(anode.activation_out);
+    }
+    return bits;
+  }
+
  private:
   // The proc whose logic which this proc thread evaluates.
   Proc* inlined_proc_;
@@ -1635,7 +1646,8 @@ absl::StatusOr<Node*> ProcThread::ConvertToActivatedReceive(
 // the `virtual_send` and `virtual_receive` maps.
 absl::StatusOr<ProcThread> InlineProcAsProcThread(
     Proc* proc_to_inline, Proc* container_proc,
-    absl::flat_hash_map<Channel*, VirtualChannel>& virtual_channels) {
+    absl::flat_hash_map<Channel*, VirtualChannel>& virtual_channels,
+    std::vector<Node*>& next_tokens) {
   auto topo_sort = TopoSort(proc_to_inline);
   XLS_ASSIGN_OR_RETURN(ProcThread proc_thread,
                        ProcThread::Create(proc_to_inline, container_proc));
@@ -1701,10 +1713,9 @@ absl::StatusOr<ProcThread> InlineProcAsProcThread(
   }
   XLS_RETURN_IF_ERROR(proc_thread.SetNextState(next_state));
 
-  // Wire in the next-token value from the inlined proc into the next-token of
-  // the container proc.
-  XLS_RETURN_IF_ERROR(container_proc->JoinNextTokenWith(
-      {node_map.at(proc_to_inline->NextToken())}));
+  // The next-token value from the inlined proc is later joined into the
+  // next-token of the container proc along with those of the other procs.
+  next_tokens.push_back(node_map.at(proc_to_inline->NextToken()));
   return std::move(proc_thread);
 }
 
@@ -1800,24 +1811,58 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
   }
 
   std::vector<ProcThread> proc_threads;
+  proc_threads.reserve(procs_to_inline.size());
 
   // Inline each proc into `container_proc`. Sends/receives are converted to
-  // virtual send/receives.
+  // virtual send/receives. The next-tokens of the inlined procs are joined into
+  // the next-token of `container_proc` all at once; joining them one proc at a
+  // time rebuilds an ever-wider after_all and is quadratic in the number of
+  // procs.
   // TODO(meheff): 2022/02/11 Add analysis which determines whether inlining is
   // a legal transformation.
+  std::vector<Node*> next_tokens;
+  next_tokens.reserve(procs_to_inline.size());
   for (Proc* proc : procs_to_inline) {
-    XLS_ASSIGN_OR_RETURN(
-        ProcThread proc_thread,
-        InlineProcAsProcThread(proc, container_proc, virtual_channels));
+    XLS_ASSIGN_OR_RETURN(ProcThread proc_thread,
+                         InlineProcAsProcThread(proc, container_proc,
+                                                virtual_channels, next_tokens));
     proc_threads.push_back(std::move(proc_thread));
   }
+  XLS_RETURN_IF_ERROR(container_proc->JoinNextTokenWith(next_tokens));
 
   VLOG(3) << "After inlining procs:\n" << p->DumpIr();
 
+  // The query engine is only asked about activation bits so the BDD is only
+  // evaluated over their fan-in. This leaves out the datapath of the inlined
+  // procs, which is typically far larger than the activation networks, and
+  // gives the same answers because the BDD of a node only depends on the nodes
+  // in its fan-in.
+  absl::flat_hash_set<const Node*> activation_fan_in;
+  std::vector<Node*> worklist;
+  for (const ProcThread& proc_thread : proc_threads) {
+    for (Node* bit : proc_thread.GetActivationBits()) {
+      if (activation_fan_in.insert(bit).second) {
+        worklist.push_back(bit);
+      }
+    }
+  }
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    for (Node* operand : node->operands()) {
+      if (activation_fan_in.insert(operand).second) {
+        worklist.push_back(operand);
+      }
+    }
+  }
+
   // Changes were made to IsCheapForBdds which breaks proc inlining. Replicate
   // the old IsCheapForBdds function here. This doesn't matter because proc
   // inling is to be deleted soon.
-  auto should_compute_with_bdds = [](const Node* node) {
+  auto should_compute_with_bdds = [&](const Node* node) {
+    if (!activation_fan_in.contains(node)) {
+      return false;
+    }
     if (std::all_of(node->operands().begin(), node->operands().end(),
                     IsSingleBitType) &&
         IsSingleBitType(node)) {
@@ -1889,12 +1934,13 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
   }
 
   // Delete channels used for communicating with the inlined procs.
-  std::vector<Channel*> channels(p->channels().begin(), p->channels().end());
-  for (Channel* ch : channels) {
+  std::vector<Channel*> internal_channels;
+  for (Channel* ch : p->channels()) {
     if (ch->supported_ops() == ChannelOps::kSendReceive) {
-      XLS_RETURN_IF_ERROR(p->RemoveChannel(ch));
+      internal_channels.push_back(ch);
     }
   }
+  XLS_RETURN_IF_ERROR(p->RemoveChannels(internal_channels));
 
   VLOG(3) << "After deleting inlined procs:\n" << p->DumpIr();
 
@@ -37,6 +37,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/span.h"
+#include "benchmark/benchmark.h"
 #include "xls/common/source_location.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/ret_check.h"
@@ -44,6 +45,7 @@
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/interpreter_proc_runtime.h"
 #include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/benchmark_support.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
@@ -66,6 +68,7 @@ namespace {
 using ::testing::ElementsAreArray;
 using ::testing::FieldsAre;
 using ::testing::HasSubstr;
+using ::testing::SizeIs;
 using ::testing::UnorderedElementsAre;
 using ::xls::status_testing::IsOkAndHolds;
 using ::xls::status_testing::StatusIs;
@@ -4150,5 +4153,48 @@ proc output_passthrough(tkn: token, state:bits[1], init={0}) {
                     .status());
 }
 
+TEST_F(ProcInliningPassTest, LongProcPipeline) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<Proc*> procs,
+      benchmark_support::GenerateProcNetwork(p.get(), /*stage_count=*/8));
+  XLS_ASSERT_OK(p->SetTop(procs.front()));
+
+  // Each stage adds the number of values it has forwarded so far.
+  XLS_ASSERT_OK(EvalAndExpect(p.get(), {{"proc_network_in", {5, 10, 20}}},
+                              {{"proc_network_out", {5, 18, 36}}})
+                    .status());
+
+  ASSERT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_EQ(p->procs().size(), 1);
+  EXPECT_THAT(p->channels(), SizeIs(2));
+
+  XLS_ASSERT_OK(EvalAndExpect(p.get(), {{"proc_network_in", {5, 10, 20}}},
+                              {{"proc_network_out", {5, 18, 36}}})
+                    .status());
+}
+
+// Inlines a pipeline of `state.range(0)` procs to show how the pass scales
+// with the size of the proc network.
+void BM_InlineProcPipeline(benchmark::State& state) {
+  for (auto s : state) {
+    state.PauseTiming();
+    Package p("bm_test");
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::vector<Proc*> procs,
+        benchmark_support::GenerateProcNetwork(&p, state.range(0)));
+    XLS_ASSERT_OK(p.SetTop(procs.front()));
+    OptimizationPassOptions options;
+    options.inline_procs = true;
+    PassResults results;
+    state.ResumeTiming();
+    XLS_ASSERT_OK_AND_ASSIGN(bool changed,
+                             ProcInliningPass().Run(&p, options, &results));
+    benchmark::DoNotOptimize(changed);
+  }
+}
+
+BENCHMARK(BM_InlineProcPipeline)->Range(8, 1024);
+
 }  // namespace
 }  // namespace xls
@@ -16,11 +16,12 @@
 
 #include <array>
 #include <cstdint>
+#include <memory>
 #include <utility>
 #include <vector>
 
-#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
@@ -29,12 +30,14 @@
 #include "xls/ir/bits.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/ternary.h"
 #include "xls/ir/value.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/proc_structure.h"
 #include "xls/passes/ternary_query_engine.h"
 
 namespace xls {
@@ -74,18 +77,26 @@ struct ProcStateNarrowTransform : public Proc::StateElementTransformer {
  private:
   Bits known_leading_;
 };
-}  // namespace
 
-absl::StatusOr<bool> ProcStateNarrowingPass::RunOnProcInternal(
-    Proc* proc, const OptimizationPassOptions& options,
-    PassResults* results) const {
+// A narrowing of a state element, identified by its index so it can be
+// applied to any structurally identical proc.
+struct StateNarrowing {
+  int64_t state_index;
+  // The new init value without the known leading bits.
+  Value new_init_value;
+  // The values of the known leading bits.
+  Bits known_leading;
+};
+
+absl::StatusOr<std::vector<StateNarrowing>> ComputeStateNarrowings(
+    Proc* proc) {
   // Find basic ternary limits
   TernaryQueryEngine tqe;
   XLS_RETURN_IF_ERROR(tqe.Populate(proc).status());
 
-  // List of all the next instructions that change the param for each param.
-  absl::flat_hash_map<Param*, std::vector<Next*>> modifying_nexts_for_param;
-  for (Param* param : proc->StateParams()) {
+  std::vector<StateNarrowing> narrowings;
+  for (int64_t index = 0; index < proc->GetStateElementCount(); ++index) {
+    Param* param = proc->GetStateParam(index);
     // TODO(allight): Being able to narrow inside a compound value would be
     // nice. Since we unpack tuple state elements in other passes however the
     // actual impact would likely be negligible so no reason to bother with it
@@ -93,32 +104,22 @@ absl::StatusOr<bool> ProcStateNarrowingPass::RunOnProcInternal(
     if (!param->GetType()->IsBits()) {
       continue;
     }
-    std::vector<Next*>& nexts = modifying_nexts_for_param[param];
+    // The next instructions that change the param.
+    std::vector<Next*> updates;
     for (Next* n : proc->next_values(param)) {
       // TODO(allight): We might want to use data-flow to better track whether
       // things have changed. This should probably be good enough in practice
       // however.
       if (n->param() != n->value()) {
-        nexts.push_back(n);
+        updates.push_back(n);
       }
     }
-  }
-  bool made_changes = false;
-  // To avoid issues where changes to the param values leads to invalidating the
-  // TernaryQueryEngine we do all the modifications at the end.
-  struct ToTransform {
-    Param* orig_param;
-    Value new_init_value;
-    ProcStateNarrowTransform transformer;
-  };
-  std::vector<ToTransform> transforms;
-  for (const auto& [orig_param, updates] : modifying_nexts_for_param) {
     if (updates.empty()) {
       // The state only has identity updates? Strange but this will be cleaned
       // up by NextValueOptimizationPass so we can ignore it.
       continue;
     }
-    XLS_ASSIGN_OR_RETURN(Value orig_init_value, proc->GetInitValue(orig_param));
+    const Value& orig_init_value = proc->GetInitValueElement(index);
     TernaryVector possible_values =
         ternary_ops::BitsToTernary(orig_init_value.bits());
     for (Next* next : updates) {
@@ -132,23 +133,68 @@ absl::StatusOr<bool> ProcStateNarrowingPass::RunOnProcInternal(
       continue;
     }
 
-    transforms.push_back(
-        {.orig_param = orig_param,
+    narrowings.push_back(
+        {.state_index = index,
          // Remove the known leading bits from the proc state.
          .new_init_value = Value(
              orig_init_value.bits().Slice(0, initial_width - known_leading)),
-         .transformer = ProcStateNarrowTransform(ternary_ops::ToKnownBitsValues(
+         .known_leading = ternary_ops::ToKnownBitsValues(
              absl::MakeSpan(possible_values)
-                 .subspan(initial_width - known_leading)))});
+                 .subspan(initial_width - known_leading))});
+  }
+  return narrowings;
+}
+
+absl::StatusOr<bool> ApplyStateNarrowings(
+    Proc* proc, absl::Span<const StateNarrowing> narrowings) {
+  // Transforming a state element adds a new state element so look up all the
+  // params before making any modifications.
+  std::vector<Param*> params;
+  params.reserve(narrowings.size());
+  for (const StateNarrowing& narrowing : narrowings) {
+    params.push_back(proc->GetStateParam(narrowing.state_index));
   }
-  for (auto t : std::move(transforms)) {
+  for (int64_t i = 0; i < narrowings.size(); ++i) {
+    ProcStateNarrowTransform transformer(narrowings[i].known_leading);
     XLS_RETURN_IF_ERROR(proc->TransformStateElement(
-                                t.orig_param, t.new_init_value, t.transformer)
+                                params[i], narrowings[i].new_init_value,
+                                transformer)
                             .status());
-    made_changes = true;
   }
+  return !narrowings.empty();
+}
+
+}  // namespace
+
+absl::StatusOr<bool> ProcStateNarrowingPass::RunInternal(
+    Package* p, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  std::vector<Proc*> procs;
+  procs.reserve(p->procs().size());
+  for (const std::unique_ptr<Proc>& proc : p->procs()) {
+    procs.push_back(proc.get());
+  }
+  ProcStructureCache<std::vector<StateNarrowing>> cache(procs);
+  VLOG(3) << absl::StreamFormat(
+      "%d procs have %d distinct structures", procs.size(),
+      cache.group_count());
+  return RunOnProcs(p, options, results,
+                    [&](Proc* proc) -> absl::StatusOr<bool> {
+                      XLS_ASSIGN_OR_RETURN(
+                          const std::vector<StateNarrowing>* narrowings,
+                          cache.GetOrCompute(proc, ComputeStateNarrowings));
+                      return ApplyStateNarrowings(proc, *narrowings);
+                    });
+}
 
-  return made_changes;
+absl::StatusOr<bool> ProcStateNarrowingPass::RunOnProcInternal(
+    Proc* proc, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  // To avoid issues where changes to the param values leads to invalidating the
+  // TernaryQueryEngine we do all the modifications at the end.
+  XLS_ASSIGN_OR_RETURN(std::vector<StateNarrowing> narrowings,
+                       ComputeStateNarrowings(proc));
+  return ApplyStateNarrowings(proc, narrowings);
 }
 
 REGISTER_OPT_PASS(ProcStateNarrowingPass);
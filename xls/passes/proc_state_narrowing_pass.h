@@ -19,6 +19,7 @@
 #include <string_view>
 
 #include "absl/status/statusor.h"
+#include "xls/ir/package.h"
 #include "xls/ir/proc.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
@@ -28,6 +29,9 @@ namespace xls {
 // Pass which tries to minimize the size and total number of elements of the
 // proc state.  The optimizations include removal of dead state elements and
 // zero-width elements.
+//
+// The analysis of each proc is shared between structurally identical procs
+// (see ProcsHaveSameStructure) such as the instances of a parametric proc.
 class ProcStateNarrowingPass : public OptimizationProcPass {
  public:
   static constexpr std::string_view kName = "proc_state_narrow";
@@ -36,6 +40,9 @@ class ProcStateNarrowingPass : public OptimizationProcPass {
   ~ProcStateNarrowingPass() override = default;
 
  protected:
+  absl::StatusOr<bool> RunInternal(Package* p,
+                                   const OptimizationPassOptions& options,
+                                   PassResults* results) const override;
   absl::StatusOr<bool> RunOnProcInternal(Proc* proc,
                                          const OptimizationPassOptions& options,
                                          PassResults* results) const override;
@@ -19,6 +19,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel_ops.h"
@@ -129,5 +130,33 @@ TEST_F(ProcStateNarrowingPassTest, ZeroExtendWithBigInitial) {
       UnorderedElementsAre(AllOf(m::Type(p->GetBitsType(8)), m::Param("foo"))));
 }
 
+TEST_F(ProcStateNarrowingPassTest, StructurallyIdenticalProcs) {
+  auto p = CreatePackage();
+  auto build_proc = [&](std::string_view name) -> absl::StatusOr<Proc*> {
+    ProcBuilder fb(name, "tok", p.get());
+    auto st = fb.StateElement("foo", UBits(0, 32));
+    XLS_ASSIGN_OR_RETURN(auto chan, p->CreateStreamingChannel(
+                                        absl::StrCat(name, "_side_effect"),
+                                        ChannelOps::kSendOnly,
+                                        p->GetBitsType(32)));
+    auto tok = fb.Send(chan, fb.GetTokenParam(), st);
+    fb.Next(st, fb.ZeroExtend(fb.Add(fb.Literal(UBits(1, 3)),
+                                     fb.BitSlice(st, 0, 3)),
+                              32));
+    return fb.Build(tok);
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc_a, build_proc("proc_a"));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc_b, build_proc("proc_b"));
+
+  EXPECT_THAT(RunPass(proc_a), IsOkAndHolds(true));
+  EXPECT_THAT(RunProcStateCleanup(proc_a), IsOkAndHolds(true));
+
+  for (Proc* proc : {proc_a, proc_b}) {
+    EXPECT_THAT(proc->StateParams(),
+                UnorderedElementsAre(
+                    AllOf(m::Type(p->GetBitsType(3)), m::Param("foo"))));
+  }
+}
+
 }  // namespace
 }  // namespace xls
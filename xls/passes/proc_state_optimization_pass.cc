@@ -54,8 +54,8 @@
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/stateless_query_engine.h"
-#include "xls/passes/ternary_query_engine.h"
 #include "xls/passes/union_query_engine.h"
 
 namespace xls {
@@ -278,10 +278,7 @@ absl::StatusOr<bool> RemoveUnobservableStateElements(Proc* proc) {
 
   // The equivalence classes of state element indices. State element X is in the
   // same class as Y if the next-state value of X depends on Y or vice versa.
-  UnionFind<int64_t> state_components;
-  for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
-    state_components.Insert(i);
-  }
+  DenseUnionFind state_components(proc->GetStateElementCount());
 
   // At the end, the union-find data structure will have one equivalence class
   // corresponding to the set of all observable state indices. This value is
@@ -545,7 +542,7 @@ absl::StatusOr<bool> ProcStateOptimizationPass::RunOnProcInternal(
 
   std::vector<std::unique_ptr<QueryEngine>> query_engines;
   query_engines.push_back(std::make_unique<StatelessQueryEngine>());
-  query_engines.push_back(std::make_unique<TernaryQueryEngine>());
+  query_engines.push_back(MakeTernaryQueryEngine(options));
   UnionQueryEngine query_engine(std::move(query_engines));
   XLS_RETURN_IF_ERROR(query_engine.Populate(proc).status());
 
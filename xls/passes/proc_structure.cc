@@ -0,0 +1,136 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/proc_structure.h"
+
+#include <cstdint>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/status/statusor.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/proc.h"
+
+namespace xls {
+namespace {
+
+absl::flat_hash_map<Node*, int64_t> NodePositions(Proc* proc) {
+  absl::flat_hash_map<Node*, int64_t> positions;
+  positions.reserve(proc->node_count());
+  for (Node* node : proc->nodes()) {
+    positions.emplace(node, positions.size());
+  }
+  return positions;
+}
+
+// Returns true if the attributes of `a` and `b` (but not necessarily their
+// operands) are the same ignoring names and channels.
+bool AttributesMatch(Proc* proc_a, Node* a, Proc* proc_b, Node* b) {
+  if (a->op() != b->op() || a->operand_count() != b->operand_count() ||
+      !a->GetType()->IsEqualTo(b->GetType())) {
+    return false;
+  }
+  if (!OpIsSideEffecting(a->op())) {
+    return a->IsDefinitelyEqualTo(b);
+  }
+  switch (a->op()) {
+    case Op::kParam: {
+      if ((a == proc_a->TokenParam()) != (b == proc_b->TokenParam())) {
+        return false;
+      }
+      if (a == proc_a->TokenParam()) {
+        return true;
+      }
+      absl::StatusOr<int64_t> index_a =
+          proc_a->GetStateParamIndex(a->As<Param>());
+      absl::StatusOr<int64_t> index_b =
+          proc_b->GetStateParamIndex(b->As<Param>());
+      return index_a.ok() && index_b.ok() && *index_a == *index_b;
+    }
+    case Op::kNext:
+    case Op::kSend:
+    case Op::kGate:
+      return true;
+    case Op::kReceive:
+      return a->As<Receive>()->is_blocking() == b->As<Receive>()->is_blocking();
+    case Op::kAssert:
+      return a->As<Assert>()->message() == b->As<Assert>()->message() &&
+             a->As<Assert>()->label() == b->As<Assert>()->label();
+    case Op::kCover:
+      return a->As<Cover>()->label() == b->As<Cover>()->label();
+    case Op::kTrace:
+      return a->As<Trace>()->verbosity() == b->As<Trace>()->verbosity() &&
+             absl::c_equal(a->As<Trace>()->format(), b->As<Trace>()->format());
+    default:
+      // Block-only operations; conservatively never equal.
+      return false;
+  }
+}
+
+}  // namespace
+
+uint64_t ProcStructureHash(Proc* proc) {
+  absl::flat_hash_map<Node*, int64_t> positions = NodePositions(proc);
+  uint64_t hash = absl::HashOf(proc->node_count(),
+                               proc->GetStateElementCount());
+  for (Node* node : proc->nodes()) {
+    hash = absl::HashOf(hash, node->op(), node->GetType()->GetFlatBitCount());
+    for (Node* operand : node->operands()) {
+      hash = absl::HashOf(hash, positions.at(operand));
+    }
+  }
+  return hash;
+}
+
+bool ProcsHaveSameStructure(Proc* a, Proc* b) {
+  if (a == b) {
+    return true;
+  }
+  if (a->node_count() != b->node_count() ||
+      a->GetStateElementCount() != b->GetStateElementCount()) {
+    return false;
+  }
+  for (int64_t i = 0; i < a->GetStateElementCount(); ++i) {
+    if (a->GetInitValueElement(i) != b->GetInitValueElement(i)) {
+      return false;
+    }
+  }
+  absl::flat_hash_map<Node*, int64_t> positions_a = NodePositions(a);
+  absl::flat_hash_map<Node*, int64_t> positions_b = NodePositions(b);
+  auto it_b = b->nodes().begin();
+  for (Node* node_a : a->nodes()) {
+    Node* node_b = *it_b++;
+    if (!AttributesMatch(a, node_a, b, node_b)) {
+      return false;
+    }
+    for (int64_t i = 0; i < node_a->operand_count(); ++i) {
+      if (positions_a.at(node_a->operand(i)) !=
+          positions_b.at(node_b->operand(i))) {
+        return false;
+      }
+    }
+  }
+  for (int64_t i = 0; i < a->GetStateElementCount(); ++i) {
+    if (positions_a.at(a->GetNextStateElement(i)) !=
+        positions_b.at(b->GetNextStateElement(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace xls
@@ -0,0 +1,112 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_PROC_STRUCTURE_H_
+#define XLS_PASSES_PROC_STRUCTURE_H_
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/proc.h"
+
+namespace xls {
+
+// Returns a hash of the structure of `proc` which is equal for procs for
+// which ProcsHaveSameStructure returns true.
+uint64_t ProcStructureHash(Proc* proc);
+
+// Returns true if `a` and `b` are identical up to node names, node ids and the
+// channels they communicate over. That is, the node lists of the procs match
+// position by position in op, type, attributes and operands, and the procs have
+// the same state elements with the same initial values. The procs may be
+// different instances of the same parametric proc, so only analyses which do
+// not depend on the identity of channels may be shared between them.
+bool ProcsHaveSameStructure(Proc* a, Proc* b);
+
+// Shares the result of an analysis between structurally identical procs (see
+// ProcsHaveSameStructure). The procs are grouped on construction so the cache
+// must be created before any of them is modified, and the analysis must only
+// be run on a proc before the proc is modified. Results should refer to the
+// parts of a proc by index (e.g. state element index) rather than by Node*.
+//
+// Thread-safe: results of procs in the same group are computed once, with
+// concurrent requests for the group waiting for the computation.
+template <typename ResultT>
+class ProcStructureCache {
+ public:
+  explicit ProcStructureCache(absl::Span<Proc* const> procs) {
+    absl::flat_hash_map<uint64_t, std::vector<Group*>> groups_by_hash;
+    for (Proc* proc : procs) {
+      std::vector<Group*>& candidates = groups_by_hash[ProcStructureHash(proc)];
+      Group* group = nullptr;
+      for (Group* candidate : candidates) {
+        if (ProcsHaveSameStructure(candidate->representative, proc)) {
+          group = candidate;
+          break;
+        }
+      }
+      if (group == nullptr) {
+        group = &groups_.emplace_back();
+        group->representative = proc;
+        candidates.push_back(group);
+      }
+      proc_groups_[proc] = group;
+    }
+  }
+
+  // Returns the result for `proc`, calling `analyze` if no structurally
+  // identical proc has been analyzed yet.
+  absl::StatusOr<const ResultT*> GetOrCompute(
+      Proc* proc, absl::FunctionRef<absl::StatusOr<ResultT>(Proc*)> analyze) {
+    auto it = proc_groups_.find(proc);
+    XLS_RET_CHECK(it != proc_groups_.end())
+        << "Proc " << proc->name() << " is not in the cache";
+    Group* group = it->second;
+    absl::MutexLock lock(&group->mutex);
+    if (!group->result.has_value()) {
+      XLS_ASSIGN_OR_RETURN(ResultT result, analyze(proc));
+      group->result = std::move(result);
+    }
+    return &*group->result;
+  }
+
+  // Returns the number of groups of structurally identical procs.
+  int64_t group_count() const { return groups_.size(); }
+
+ private:
+  struct Group {
+    Proc* representative = nullptr;
+    absl::Mutex mutex;
+    std::optional<ResultT> result ABSL_GUARDED_BY(mutex);
+  };
+
+  // A deque is used so group addresses remain stable.
+  std::deque<Group> groups_;
+  absl::flat_hash_map<Proc*, Group*> proc_groups_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_PROC_STRUCTURE_H_
@@ -0,0 +1,102 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/proc_structure.h"
+
+#include <cstdint>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+class ProcStructureTest : public IrTestBase {
+ protected:
+  // Builds a counter proc which sends its state on its own channel.
+  absl::StatusOr<Proc*> BuildCounter(Package* p, std::string_view name,
+                                     int64_t init, int64_t increment) {
+    ProcBuilder pb(name, "tok", p);
+    BValue st = pb.StateElement("count", UBits(init, 32));
+    XLS_ASSIGN_OR_RETURN(
+        Channel * chan,
+        p->CreateStreamingChannel(absl::StrCat(name, "_out"),
+                                  ChannelOps::kSendOnly, p->GetBitsType(32)));
+    BValue tok = pb.Send(chan, pb.GetTokenParam(), st);
+    pb.Next(st, pb.Add(st, pb.Literal(UBits(increment, 32))));
+    return pb.Build(tok);
+  }
+};
+
+TEST_F(ProcStructureTest, IdenticalProcsOnDifferentChannels) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * a, BuildCounter(p.get(), "a", 0, 1));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * b, BuildCounter(p.get(), "b", 0, 1));
+  EXPECT_TRUE(ProcsHaveSameStructure(a, b));
+  EXPECT_EQ(ProcStructureHash(a), ProcStructureHash(b));
+}
+
+TEST_F(ProcStructureTest, DifferentInitValues) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * a, BuildCounter(p.get(), "a", 0, 1));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * b, BuildCounter(p.get(), "b", 5, 1));
+  EXPECT_FALSE(ProcsHaveSameStructure(a, b));
+}
+
+TEST_F(ProcStructureTest, DifferentLiterals) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * a, BuildCounter(p.get(), "a", 0, 1));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * b, BuildCounter(p.get(), "b", 0, 2));
+  EXPECT_FALSE(ProcsHaveSameStructure(a, b));
+}
+
+TEST_F(ProcStructureTest, CacheComputesOncePerGroup) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * a, BuildCounter(p.get(), "a", 0, 1));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * b, BuildCounter(p.get(), "b", 0, 1));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * c, BuildCounter(p.get(), "c", 0, 2));
+  ProcStructureCache<int64_t> cache({a, b, c});
+  EXPECT_EQ(cache.group_count(), 2);
+
+  int64_t analysis_count = 0;
+  auto analyze = [&](Proc* proc) -> absl::StatusOr<int64_t> {
+    return ++analysis_count;
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(const int64_t* result_a,
+                           cache.GetOrCompute(a, analyze));
+  XLS_ASSERT_OK_AND_ASSIGN(const int64_t* result_b,
+                           cache.GetOrCompute(b, analyze));
+  XLS_ASSERT_OK_AND_ASSIGN(const int64_t* result_c,
+                           cache.GetOrCompute(c, analyze));
+  EXPECT_EQ(*result_a, 1);
+  EXPECT_EQ(*result_b, 1);
+  EXPECT_EQ(*result_c, 2);
+  EXPECT_EQ(analysis_count, 2);
+}
+
+}  // namespace
+}  // namespace xls
@@ -189,6 +189,12 @@ class QueryEngine {
   // zero or one).
   virtual bool IsFullyKnown(Node* n) const;
 
+  // Returns an estimate of the heap memory in bytes used by the information
+  // this engine has computed, including that of any engines it combines.
+  // Engines which hold no significant state, or which are views of another
+  // engine such as specializations, return zero.
+  virtual int64_t EstimateMemoryUsage() const { return 0; }
+
   // Returns whether *all* the bits are known for 'node' (which must be
   // bits-type).
   bool AllBitsKnown(Node* node) const {
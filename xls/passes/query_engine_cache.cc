@@ -0,0 +1,334 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/query_engine_cache.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/data_structures/leaf_type_tree.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/change_listener.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/interval_set.h"
+#include "xls/ir/node.h"
+#include "xls/ir/ternary.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/predicate_state.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/range_query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+namespace {
+
+// An engine of type EngineT for a single function along with the changes made
+// to the function since the engine was last brought up to date. The engine is
+// lazy so only the nodes which are queried (and their transitive operands) are
+// analyzed, and changes only discard the analysis of the affected nodes.
+template <typename EngineT>
+class CachedEngine {
+ public:
+  absl::StatusOr<EngineT*> Get(FunctionBase* f) {
+    absl::Status status = Update(f);
+    if (!status.ok()) {
+      // The engine may be partially updated; start over next time.
+      engine_.reset();
+      changed_nodes_.clear();
+      return status;
+    }
+    return engine_.get();
+  }
+
+  void NodeChanged(Node* node) {
+    if (engine_ != nullptr) {
+      changed_nodes_.insert(node);
+    }
+  }
+
+  // Removed nodes are forgotten immediately as a new node may be allocated at
+  // the address of a removed node before the engine is next updated.
+  void NodeDeleted(Node* node) {
+    if (engine_ != nullptr) {
+      changed_nodes_.erase(node);
+      engine_->ForgetNode(node);
+    }
+  }
+
+ private:
+  absl::Status Update(FunctionBase* f) {
+    if (engine_ == nullptr) {
+      engine_ = std::make_unique<EngineT>(/*lazy=*/true);
+      XLS_RETURN_IF_ERROR(engine_->Populate(f).status());
+      return absl::OkStatus();
+    }
+    VLOG(3) << absl::StreamFormat(
+        "Updating cached query engine for %s: %d changed nodes", f->name(),
+        changed_nodes_.size());
+    std::vector<Node*> changed(changed_nodes_.begin(), changed_nodes_.end());
+    changed_nodes_.clear();
+    std::sort(changed.begin(), changed.end(), Node::NodeIdLessThan());
+    XLS_RETURN_IF_ERROR(engine_->UpdateChangedNodes(changed).status());
+    return absl::OkStatus();
+  }
+
+  // Null until the engine is first requested.
+  std::unique_ptr<EngineT> engine_;
+  absl::flat_hash_set<Node*> changed_nodes_;
+};
+
+// A query engine which forwards to an engine held by a QueryEngineCache.
+// Populating this engine brings the cached engine up to date.
+class CacheBackedQueryEngine final : public QueryEngine {
+ public:
+  explicit CacheBackedQueryEngine(
+      std::function<absl::StatusOr<QueryEngine*>(FunctionBase*)> get_engine)
+      : get_engine_(std::move(get_engine)) {}
+
+  absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override {
+    XLS_ASSIGN_OR_RETURN(engine_, get_engine_(f));
+    // The cached engine may have been populated by an earlier pass so whether
+    // a fixed point has been reached cannot be determined.
+    return ReachedFixpoint::Unknown;
+  }
+
+  bool IsTracked(Node* node) const override {
+    return engine().IsTracked(node);
+  }
+
+  LeafTypeTree<TernaryVector> GetTernary(Node* node) const override {
+    return engine().GetTernary(node);
+  }
+
+  std::unique_ptr<QueryEngine> SpecializeGivenPredicate(
+      const absl::flat_hash_set<PredicateState>& state) const override {
+    return engine().SpecializeGivenPredicate(state);
+  }
+
+  LeafTypeTree<IntervalSet> GetIntervals(Node* node) const override {
+    return engine().GetIntervals(node);
+  }
+
+  bool AtMostOneTrue(absl::Span<TreeBitLocation const> bits) const override {
+    return engine().AtMostOneTrue(bits);
+  }
+
+  bool AtLeastOneTrue(absl::Span<TreeBitLocation const> bits) const override {
+    return engine().AtLeastOneTrue(bits);
+  }
+
+  bool Implies(const TreeBitLocation& a,
+               const TreeBitLocation& b) const override {
+    return engine().Implies(a, b);
+  }
+
+  std::optional<Bits> ImpliedNodeValue(
+      absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+      Node* node) const override {
+    return engine().ImpliedNodeValue(predicate_bit_values, node);
+  }
+
+  bool KnownEquals(const TreeBitLocation& a,
+                   const TreeBitLocation& b) const override {
+    return engine().KnownEquals(a, b);
+  }
+
+  bool KnownNotEquals(const TreeBitLocation& a,
+                      const TreeBitLocation& b) const override {
+    return engine().KnownNotEquals(a, b);
+  }
+
+  bool IsFullyKnown(Node* n) const override { return engine().IsFullyKnown(n); }
+
+  // Reports the memory of the cached engine, which holds the information
+  // accessed through this engine.
+  int64_t EstimateMemoryUsage() const override {
+    return engine_ == nullptr ? 0 : engine_->EstimateMemoryUsage();
+  }
+
+ private:
+  const QueryEngine& engine() const {
+    CHECK(engine_ != nullptr) << "Query engine used before being populated";
+    return *engine_;
+  }
+
+  std::function<absl::StatusOr<QueryEngine*>(FunctionBase*)> get_engine_;
+  QueryEngine* engine_ = nullptr;
+};
+
+}  // namespace
+
+// The cached engines for a single function. Listens for changes to the
+// function to determine which nodes must be re-analyzed.
+class QueryEngineCache::FunctionCache : public ChangeListener {
+ public:
+  explicit FunctionCache(FunctionBase* f) : f_(f) {
+    f_->RegisterChangeListener(this);
+  }
+
+  ~FunctionCache() override {
+    if (f_ != nullptr) {
+      f_->UnregisterChangeListener(this);
+    }
+  }
+
+  // Returns whether the function has been destroyed.
+  bool is_dead() const { return f_ == nullptr; }
+
+  CachedEngine<TernaryQueryEngine>& ternary() { return ternary_; }
+  CachedEngine<RangeQueryEngine>& range() { return range_; }
+
+  absl::StatusOr<IncrementalAnalysis*> GetAnalysis(
+      const void* key,
+      absl::FunctionRef<std::unique_ptr<IncrementalAnalysis>()> make_analysis) {
+    CachedAnalysis& cached = analyses_[key];
+    absl::Status status;
+    if (cached.analysis == nullptr) {
+      cached.analysis = make_analysis();
+      status = cached.analysis->Populate(f_);
+    } else {
+      std::vector<Node*> changed(cached.changed_nodes.begin(),
+                                 cached.changed_nodes.end());
+      cached.changed_nodes.clear();
+      std::sort(changed.begin(), changed.end(), Node::NodeIdLessThan());
+      status = cached.analysis->UpdateChangedNodes(changed);
+    }
+    if (!status.ok()) {
+      // The analysis may be partially updated; start over next time.
+      analyses_.erase(key);
+      return status;
+    }
+    return cached.analysis.get();
+  }
+
+  void NodeAdded(Node* node) override { NodeChanged(node); }
+
+  void NodeDeleted(Node* node) override {
+    ternary_.NodeDeleted(node);
+    range_.NodeDeleted(node);
+    for (auto& [_, cached] : analyses_) {
+      for (Node* operand : node->operands()) {
+        cached.analysis->UseRemoved(operand);
+      }
+      cached.changed_nodes.erase(node);
+      cached.analysis->ForgetNode(node);
+    }
+  }
+
+  void OperandChanged(Node* node, Node* old_operand) override {
+    NodeChanged(node);
+    for (auto& [_, cached] : analyses_) {
+      cached.analysis->UseRemoved(old_operand);
+    }
+  }
+
+  void OperandAdded(Node* node) override { NodeChanged(node); }
+
+  void FunctionBaseDeleted(FunctionBase* function_base) override {
+    CHECK_EQ(function_base, f_);
+    f_ = nullptr;
+  }
+
+ private:
+  // An analysis along with the nodes changed since it was last updated.
+  struct CachedAnalysis {
+    std::unique_ptr<IncrementalAnalysis> analysis;
+    absl::flat_hash_set<Node*> changed_nodes;
+  };
+
+  void NodeChanged(Node* node) {
+    ternary_.NodeChanged(node);
+    range_.NodeChanged(node);
+    for (auto& [_, cached] : analyses_) {
+      cached.changed_nodes.insert(node);
+    }
+  }
+
+  FunctionBase* f_;
+  CachedEngine<TernaryQueryEngine> ternary_;
+  CachedEngine<RangeQueryEngine> range_;
+  // Analyses obtained through GetIncrementalAnalysis keyed by their kind.
+  absl::flat_hash_map<const void*, CachedAnalysis> analyses_;
+};
+
+QueryEngineCache::~QueryEngineCache() = default;
+
+QueryEngineCache::FunctionCache& QueryEngineCache::GetFunctionCache(
+    FunctionBase* f) {
+  absl::MutexLock lock(&mutex_);
+  std::unique_ptr<FunctionCache>& function_cache = function_caches_[f];
+  // A dead entry may be keyed by the address of a function which has since
+  // been destroyed and reallocated.
+  if (function_cache == nullptr || function_cache->is_dead()) {
+    function_cache = std::make_unique<FunctionCache>(f);
+  }
+  return *function_cache;
+}
+
+absl::StatusOr<TernaryQueryEngine*> QueryEngineCache::GetTernaryQueryEngine(
+    FunctionBase* f) {
+  return GetFunctionCache(f).ternary().Get(f);
+}
+
+absl::StatusOr<RangeQueryEngine*> QueryEngineCache::GetRangeQueryEngine(
+    FunctionBase* f) {
+  return GetFunctionCache(f).range().Get(f);
+}
+
+absl::StatusOr<IncrementalAnalysis*> QueryEngineCache::GetIncrementalAnalysis(
+    FunctionBase* f, const void* key,
+    absl::FunctionRef<std::unique_ptr<IncrementalAnalysis>()> make_analysis) {
+  return GetFunctionCache(f).GetAnalysis(key, make_analysis);
+}
+
+std::unique_ptr<QueryEngine> MakeTernaryQueryEngine(
+    const OptimizationPassOptions& options) {
+  if (options.query_engine_cache == nullptr) {
+    return std::make_unique<TernaryQueryEngine>();
+  }
+  QueryEngineCache* cache = options.query_engine_cache;
+  return std::make_unique<CacheBackedQueryEngine>(
+      [cache](FunctionBase* f) -> absl::StatusOr<QueryEngine*> {
+        return cache->GetTernaryQueryEngine(f);
+      });
+}
+
+std::unique_ptr<QueryEngine> MakeRangeQueryEngine(
+    const OptimizationPassOptions& options) {
+  if (options.query_engine_cache == nullptr) {
+    return std::make_unique<RangeQueryEngine>();
+  }
+  QueryEngineCache* cache = options.query_engine_cache;
+  return std::make_unique<CacheBackedQueryEngine>(
+      [cache](FunctionBase* f) -> absl::StatusOr<QueryEngine*> {
+        return cache->GetRangeQueryEngine(f);
+      });
+}
+
+}  // namespace xls
@@ -0,0 +1,167 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_QUERY_ENGINE_CACHE_H_
+#define XLS_PASSES_QUERY_ENGINE_CACHE_H_
+
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/range_query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+
+// An analysis of a function which can be held by a QueryEngineCache and
+// updated incrementally as the function changes.
+class IncrementalAnalysis {
+ public:
+  virtual ~IncrementalAnalysis() = default;
+
+  // Analyzes all of `f`. Called once before any other method.
+  virtual absl::Status Populate(FunctionBase* f) = 0;
+
+  // Updates the analysis given the nodes added or with changed operands since
+  // the last update, in increasing order of id.
+  virtual absl::Status UpdateChangedNodes(
+      absl::Span<Node* const> changed_nodes) = 0;
+
+  // Discards any information about `node` which is about to be removed.
+  virtual void ForgetNode(Node* node) = 0;
+
+  // Called when a use of `node` as an operand is removed, either because the
+  // operand of a user was changed or because a user is about to be removed.
+  // `node` may have other uses remaining.
+  virtual void UseRemoved(Node* node) {}
+};
+
+// A cache of query engines and other incrementally updated analyses (see
+// IncrementalAnalysis) for the functions and procs of a package. The
+// cache is owned by the driver of a pass pipeline and shared by the passes
+// through OptimizationPassOptions::query_engine_cache.
+//
+// The cache registers a ChangeListener with each function it analyzes and
+// records which nodes are added or have their operands changed. When an
+// engine is next requested only those nodes, and the transitive users whose
+// values change as a result, are re-analyzed. This avoids re-analyzing the
+// entire function in every pass when each pass changes only a few nodes.
+//
+// The cache may be used concurrently from multiple threads as long as each
+// FunctionBase is only accessed by one thread at a time.
+class QueryEngineCache {
+ public:
+  QueryEngineCache() = default;
+  ~QueryEngineCache();
+
+  QueryEngineCache(const QueryEngineCache&) = delete;
+  QueryEngineCache& operator=(const QueryEngineCache&) = delete;
+
+  // Returns the ternary query engine for `f` brought up to date with the
+  // current IR. The engine is owned by the cache. It remains valid until the
+  // cache or `f` is destroyed, but only reflects changes to `f` made before
+  // the most recent call.
+  absl::StatusOr<TernaryQueryEngine*> GetTernaryQueryEngine(FunctionBase* f);
+
+  // Returns the range query engine for `f` brought up to date with the current
+  // IR. Ownership and lifetime are as for GetTernaryQueryEngine.
+  absl::StatusOr<RangeQueryEngine*> GetRangeQueryEngine(FunctionBase* f);
+
+  // Returns the incremental analysis of type AnalysisT (a default-constructible
+  // subclass of IncrementalAnalysis) for `f` brought up to date with the
+  // current IR. The analysis is populated when first requested and is
+  // afterwards given the nodes changed since the previous request. Ownership
+  // and lifetime are as for GetTernaryQueryEngine.
+  template <typename AnalysisT>
+  absl::StatusOr<AnalysisT*> GetAnalysis(FunctionBase* f) {
+    // The address of this variable is unique to each AnalysisT.
+    static constexpr char kKey = 0;
+    XLS_ASSIGN_OR_RETURN(IncrementalAnalysis * analysis,
+                         GetIncrementalAnalysis(f, &kKey, []() {
+                           return std::make_unique<AnalysisT>();
+                         }));
+    return static_cast<AnalysisT*>(analysis);
+  }
+
+  // Returns the dataflow visitor of type VisitorT (a default-constructible
+  // DataflowVisitor) for `f` brought up to date with the current IR. The
+  // visitor is run over all of `f` when first requested; afterwards only the
+  // changed nodes and the users whose values change as a result are
+  // re-evaluated. Ownership and lifetime are as for GetTernaryQueryEngine.
+  template <typename VisitorT>
+  absl::StatusOr<VisitorT*> GetDataflowVisitor(FunctionBase* f) {
+    XLS_ASSIGN_OR_RETURN(CachedDataflowVisitor<VisitorT> * analysis,
+                         GetAnalysis<CachedDataflowVisitor<VisitorT>>(f));
+    return &analysis->visitor();
+  }
+
+ private:
+  class FunctionCache;
+
+  template <typename VisitorT>
+  class CachedDataflowVisitor final : public IncrementalAnalysis {
+   public:
+    absl::Status Populate(FunctionBase* f) final {
+      return f->Accept(&visitor_);
+    }
+    absl::Status UpdateChangedNodes(
+        absl::Span<Node* const> changed_nodes) final {
+      return visitor_.UpdateChangedNodes(changed_nodes);
+    }
+    void ForgetNode(Node* node) final { visitor_.ForgetNode(node); }
+
+    VisitorT& visitor() { return visitor_; }
+
+   private:
+    VisitorT visitor_;
+  };
+
+  FunctionCache& GetFunctionCache(FunctionBase* f);
+
+  // Returns the analysis of `f` identified by `key` brought up to date,
+  // creating it with `make_analysis` if it does not exist.
+  absl::StatusOr<IncrementalAnalysis*> GetIncrementalAnalysis(
+      FunctionBase* f, const void* key,
+      absl::FunctionRef<std::unique_ptr<IncrementalAnalysis>()> make_analysis);
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<FunctionBase*, std::unique_ptr<FunctionCache>>
+      function_caches_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Returns a ternary query engine for use by a pass. If `options` has a query
+// engine cache, the returned engine forwards to the engine held by the cache
+// and populating it updates the cached engine incrementally. Otherwise a new
+// TernaryQueryEngine is returned. In both cases the engine must be populated
+// before use.
+std::unique_ptr<QueryEngine> MakeTernaryQueryEngine(
+    const OptimizationPassOptions& options);
+
+// As MakeTernaryQueryEngine but for a range query engine.
+std::unique_ptr<QueryEngine> MakeRangeQueryEngine(
+    const OptimizationPassOptions& options);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_QUERY_ENGINE_CACHE_H_
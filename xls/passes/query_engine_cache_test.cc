@@ -0,0 +1,262 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/query_engine_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/data_structures/leaf_type_tree.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/passes/dataflow_visitor.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/range_query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+namespace {
+
+// Dataflow visitor which tracks the node from which each leaf originates.
+class SourceNodeVisitor : public DataflowVisitor<Node*> {
+ public:
+  absl::Status DefaultHandler(Node* node) override {
+    return SetValue(node, LeafTypeTree<Node*>(node->GetType(), node));
+  }
+
+ protected:
+  absl::StatusOr<Node*> JoinElements(
+      Type* element_type, absl::Span<Node* const* const> data_sources,
+      absl::Span<const LeafTypeTreeView<Node*>> control_sources, Node* node,
+      absl::Span<const int64_t> index) const override {
+    for (Node* const* source : data_sources) {
+      if (*source != *data_sources.front()) {
+        return node;
+      }
+    }
+    return *data_sources.front();
+  }
+};
+
+class QueryEngineCacheTest : public IrTestBase {
+ protected:
+  // Expects the cached engines for `f` to give the same results as freshly
+  // populated engines for every node in `f`.
+  void ExpectMatchesFreshEngines(QueryEngineCache& cache, FunctionBase* f) {
+    XLS_ASSERT_OK_AND_ASSIGN(TernaryQueryEngine * cached_ternary,
+                             cache.GetTernaryQueryEngine(f));
+    XLS_ASSERT_OK_AND_ASSIGN(RangeQueryEngine * cached_range,
+                             cache.GetRangeQueryEngine(f));
+    TernaryQueryEngine fresh_ternary;
+    XLS_ASSERT_OK(fresh_ternary.Populate(f).status());
+    RangeQueryEngine fresh_range;
+    XLS_ASSERT_OK(fresh_range.Populate(f).status());
+    for (Node* node : f->nodes()) {
+      EXPECT_EQ(cached_ternary->IsTracked(node), fresh_ternary.IsTracked(node))
+          << node;
+      if (fresh_ternary.IsTracked(node)) {
+        EXPECT_EQ(cached_ternary->GetTernary(node),
+                  fresh_ternary.GetTernary(node))
+            << node;
+      }
+      if (fresh_range.IsTracked(node)) {
+        EXPECT_EQ(cached_range->GetIntervals(node),
+                  fresh_range.GetIntervals(node))
+            << node;
+      }
+    }
+  }
+};
+
+TEST_F(QueryEngineCacheTest, ReturnsSameEngineWhenUnchanged) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  fb.And(x, fb.Literal(UBits(0x0f, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  XLS_ASSERT_OK_AND_ASSIGN(TernaryQueryEngine * first,
+                           cache.GetTernaryQueryEngine(f));
+  XLS_ASSERT_OK_AND_ASSIGN(TernaryQueryEngine * second,
+                           cache.GetTernaryQueryEngine(f));
+  EXPECT_EQ(first, second);
+  ExpectMatchesFreshEngines(cache, f);
+}
+
+TEST_F(QueryEngineCacheTest, UpdatesAfterReplacingOperand) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue mask = fb.Literal(UBits(0x0f, 8));
+  BValue masked = fb.And(x, mask);
+  BValue sum = fb.Add(masked, fb.Literal(UBits(1, 8)));
+  fb.Concat({sum, fb.Not(masked)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  ExpectMatchesFreshEngines(cache, f);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_mask, f->MakeNode<Literal>(SourceInfo(), Value(UBits(3, 8))));
+  EXPECT_TRUE(masked.node()->ReplaceOperand(mask.node(), new_mask));
+  ExpectMatchesFreshEngines(cache, f);
+
+  XLS_ASSERT_OK_AND_ASSIGN(TernaryQueryEngine * ternary,
+                           cache.GetTernaryQueryEngine(f));
+  EXPECT_EQ(ternary->ToString(masked.node()), "0b0000_00XX");
+}
+
+TEST_F(QueryEngineCacheTest, UpdatesAfterReplacingAndRemovingNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue product = fb.UMul(x, y);
+  BValue shifted = fb.Shll(product, fb.Literal(UBits(4, 8)));
+  fb.Or(shifted, fb.Literal(UBits(1, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  ExpectMatchesFreshEngines(cache, f);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * zero, f->MakeNode<Literal>(SourceInfo(), Value(UBits(0, 8))));
+  XLS_ASSERT_OK(product.node()->ReplaceUsesWith(zero));
+  XLS_ASSERT_OK(f->RemoveNode(product.node()));
+  ExpectMatchesFreshEngines(cache, f);
+
+  XLS_ASSERT_OK_AND_ASSIGN(TernaryQueryEngine * ternary,
+                           cache.GetTernaryQueryEngine(f));
+  EXPECT_EQ(ternary->ToString(f->return_value()), "0b0000_0001");
+}
+
+TEST_F(QueryEngineCacheTest, UpdatesAfterReplacingWithNewNode) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(4));
+  BValue concat = fb.Concat({fb.Literal(UBits(0, 4)), x});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  ExpectMatchesFreshEngines(cache, f);
+
+  // Replace the concat with a wider one which has an extra operand.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * one, f->MakeNode<Literal>(SourceInfo(), Value(UBits(1, 1))));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * wider,
+      f->MakeNode<Concat>(SourceInfo(),
+                          std::vector<Node*>{one, concat.node()->operand(0),
+                                             concat.node()->operand(1)}));
+  XLS_ASSERT_OK(f->set_return_value(wider));
+  XLS_ASSERT_OK(f->RemoveNode(concat.node()));
+  ExpectMatchesFreshEngines(cache, f);
+
+  XLS_ASSERT_OK_AND_ASSIGN(TernaryQueryEngine * ternary,
+                           cache.GetTernaryQueryEngine(f));
+  EXPECT_EQ(ternary->ToString(wider), "0b1_0000_XXXX");
+}
+
+TEST_F(QueryEngineCacheTest, HandlesDeletedFunction) {
+  auto p = CreatePackage();
+  QueryEngineCache cache;
+  {
+    FunctionBuilder fb("to_delete", p.get());
+    fb.Param("x", p->GetBitsType(8));
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+    XLS_ASSERT_OK(cache.GetTernaryQueryEngine(f).status());
+    XLS_ASSERT_OK(p->RemoveFunction(f));
+  }
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  fb.Not(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  ExpectMatchesFreshEngines(cache, f);
+}
+
+TEST_F(QueryEngineCacheTest, MakeQueryEngineUsesCache) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue masked = fb.And(x, fb.Literal(UBits(0xf0, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  OptimizationPassOptions options;
+  options.query_engine_cache = &cache;
+  std::unique_ptr<QueryEngine> ternary = MakeTernaryQueryEngine(options);
+  XLS_ASSERT_OK(ternary->Populate(f).status());
+  EXPECT_EQ(ternary->ToString(masked.node()), "0bXXXX_0000");
+
+  std::unique_ptr<QueryEngine> range = MakeRangeQueryEngine(options);
+  XLS_ASSERT_OK(range->Populate(f).status());
+  EXPECT_EQ(range->ToString(masked.node()), "0bXXXX_0000");
+
+  // Without a cache fresh engines are returned.
+  std::unique_ptr<QueryEngine> uncached =
+      MakeTernaryQueryEngine(OptimizationPassOptions());
+  XLS_ASSERT_OK(uncached->Populate(f).status());
+  EXPECT_EQ(uncached->ToString(masked.node()), "0bXXXX_0000");
+}
+
+TEST_F(QueryEngineCacheTest, UpdatesDataflowVisitor) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue s = fb.Param("s", p->GetBitsType(1));
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue sel = fb.Select(s, {x, y});
+  BValue tuple = fb.Tuple({sel, y});
+  BValue element = fb.TupleIndex(tuple, 0);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  XLS_ASSERT_OK_AND_ASSIGN(SourceNodeVisitor * visitor,
+                           cache.GetDataflowVisitor<SourceNodeVisitor>(f));
+  EXPECT_EQ(visitor->GetValue(element.node()).Get({}), sel.node());
+
+  // Both cases of the select are now `y`.
+  XLS_ASSERT_OK(sel.node()->ReplaceOperandNumber(1, y.node()));
+  XLS_ASSERT_OK_AND_ASSIGN(SourceNodeVisitor * updated,
+                           cache.GetDataflowVisitor<SourceNodeVisitor>(f));
+  EXPECT_EQ(updated, visitor);
+  EXPECT_EQ(updated->GetValue(element.node()).Get({}), y.node());
+
+  XLS_ASSERT_OK(sel.node()->ReplaceUsesWith(x.node()));
+  XLS_ASSERT_OK(f->RemoveNode(sel.node()));
+  XLS_ASSERT_OK_AND_ASSIGN(updated,
+                           cache.GetDataflowVisitor<SourceNodeVisitor>(f));
+  EXPECT_EQ(updated->GetValue(element.node()).Get({}), x.node());
+}
+
+}  // namespace
+}  // namespace xls
@@ -20,6 +20,7 @@
 #include <iterator>
 #include <limits>
 #include <optional>
+#include <type_traits>
 #include <ostream>
 #include <sstream>
 #include <string>
@@ -28,6 +29,7 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -36,6 +38,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/common/math_util.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/data_structures/leaf_type_tree.h"
@@ -49,6 +52,7 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/ternary.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
@@ -238,7 +242,110 @@ absl::StatusOr<ReachedFixpoint> RangeQueryEngine::PopulateWithGivens(
   return visitor.GetReachedFixpoint();
 }
 
+bool RangeQueryEngine::EnsureComputed(Node* node) const {
+  if (node->function_base() != function_) {
+    return false;
+  }
+  if (computed_.contains(node)) {
+    return true;
+  }
+  std::vector<Node*> to_compute = TopoSortTransitiveOperands(
+      node, [&](Node* n) { return computed_.contains(n); });
+  // The visitor only modifies the memoized ranges, which are mutable.
+  RangeQueryEngine* engine = const_cast<RangeQueryEngine*>(this);
+  NoGivensProvider givens(function_);
+  RangeQueryVisitor visitor(engine, givens);
+  for (Node* n : to_compute) {
+    // Mark the node as computed first as the visitor queries the ranges of the
+    // node being visited.
+    computed_.insert(n);
+    absl::Status status = n->VisitSingleNode(&visitor);
+    if (!status.ok()) {
+      VLOG(1) << "Range analysis of " << n << " failed: " << status;
+      engine->ForgetNode(n);
+      computed_.insert(n);
+      engine->InitializeNode(n);
+    }
+  }
+  return true;
+}
+
+absl::StatusOr<ReachedFixpoint> RangeQueryEngine::UpdateChangedNodes(
+    absl::Span<Node* const> changed_nodes) {
+  if (lazy_) {
+    // Discard the memoized ranges which may depend on the changed nodes. Nodes
+    // whose ranges have not been computed have no computed users.
+    std::vector<Node*> worklist(changed_nodes.begin(), changed_nodes.end());
+    for (Node* node : changed_nodes) {
+      ForgetNode(node);
+    }
+    while (!worklist.empty()) {
+      Node* node = worklist.back();
+      worklist.pop_back();
+      for (Node* user : node->users()) {
+        if (computed_.contains(user)) {
+          ForgetNode(user);
+          worklist.push_back(user);
+        }
+      }
+    }
+    return ReachedFixpoint::Unknown;
+  }
+  if (changed_nodes.empty()) {
+    return ReachedFixpoint::Unchanged;
+  }
+  absl::flat_hash_set<Node*> changed(changed_nodes.begin(),
+                                     changed_nodes.end());
+  NoGivensProvider givens(changed_nodes.front()->function_base());
+  RangeQueryVisitor visitor(this, givens);
+  // Nodes whose ranges differ from their previous ranges.
+  absl::flat_hash_set<Node*> updated;
+  // The nodes are visited in topological order so the ranges of the operands
+  // of each node are up to date when it is visited.
+  for (Node* node : TopoSortTransitiveUsers(changed_nodes)) {
+    if (!changed.contains(node) &&
+        absl::c_none_of(node->operands(),
+                        [&](Node* o) { return updated.contains(o); })) {
+      continue;
+    }
+    std::optional<Bits> old_known_bits;
+    std::optional<Bits> old_known_bit_values;
+    std::optional<IntervalSetTree> old_intervals;
+    if (auto it = known_bits_.find(node); it != known_bits_.end()) {
+      old_known_bits = std::move(it->second);
+    }
+    if (auto it = known_bit_values_.find(node); it != known_bit_values_.end()) {
+      old_known_bit_values = std::move(it->second);
+    }
+    if (auto it = interval_sets_.find(node); it != interval_sets_.end()) {
+      old_intervals = std::move(it->second);
+    }
+    // Forget the previous ranges so they are not intersected with the new
+    // ones.
+    ForgetNode(node);
+    XLS_RETURN_IF_ERROR(node->VisitSingleNode(&visitor));
+
+    auto get = [node](const auto& map)
+        -> std::optional<std::decay_t<decltype(map.begin()->second)>> {
+      if (auto it = map.find(node); it != map.end()) {
+        return it->second;
+      }
+      return std::nullopt;
+    };
+    if (get(known_bits_) != old_known_bits ||
+        get(known_bit_values_) != old_known_bit_values ||
+        get(interval_sets_) != old_intervals) {
+      updated.insert(node);
+    }
+  }
+  return updated.empty() ? ReachedFixpoint::Unchanged
+                         : ReachedFixpoint::Changed;
+}
+
 IntervalSetTree RangeQueryEngine::GetIntervalSetTree(Node* node) const {
+  if (lazy_) {
+    EnsureComputed(node);
+  }
   if (interval_sets_.contains(node)) {
     return interval_sets_.at(node);
   }
@@ -266,7 +373,7 @@ void RangeQueryEngine::SetIntervalSetTree(
   leaf_type_tree::SimpleUpdateFrom<IntervalSet, IntervalSet>(
       ist.AsMutableView(), interval_sets.AsView(),
       [](IntervalSet& lhs, const IntervalSet& rhs) {
-        lhs = IntervalSet::Intersect(lhs, rhs);
+        lhs.IntersectWith(rhs);
       });
   if (node->GetType()->IsBits()) {
     interval_ops::KnownBits bits =
@@ -274,7 +381,27 @@ void RangeQueryEngine::SetIntervalSetTree(
     known_bits_[node] = bits.known_bits;
     known_bit_values_[node] = bits.known_bit_values;
   }
-  interval_sets_[node] = ist;
+  interval_sets_[node] = std::move(ist);
+}
+
+static int64_t EstimateBitsMapHeapBytes(
+    const absl::flat_hash_map<Node*, Bits>& map) {
+  int64_t bytes = EstimateHeapBytes(map);
+  for (const auto& [node, bits] : map) {
+    bytes += EstimateHeapBytes(bits);
+  }
+  return bytes;
+}
+
+int64_t RangeQueryEngine::EstimateMemoryUsage() const {
+  int64_t bytes = EstimateBitsMapHeapBytes(known_bits_) +
+                  EstimateBitsMapHeapBytes(known_bit_values_) +
+                  EstimateHeapBytes(interval_sets_);
+  for (const auto& [node, tree] : interval_sets_) {
+    bytes += tree.EstimateMemoryUsage(
+        [](const IntervalSet& set) { return EstimateHeapBytes(set); });
+  }
+  return bytes;
 }
 
 void RangeQueryEngine::InitializeNode(Node* node) {
@@ -463,9 +590,8 @@ absl::Status RangeQueryVisitor::HandleEq(CompareOp* eq) {
 
   IntervalSet res(/*bit_count=*/1);
   for (int64_t i = 0; i < lhs_intervals.size(); ++i) {
-    res = IntervalSet::Combine(res,
-                               interval_ops::Eq(lhs_intervals.elements()[i],
-                                                rhs_intervals.elements()[i]));
+    res.CombineWith(interval_ops::Eq(lhs_intervals.elements()[i],
+                                     rhs_intervals.elements()[i]));
   }
   return SetIntervalSet(eq, std::move(res));
 }
@@ -608,7 +734,7 @@ absl::Status RangeQueryVisitor::HandleArrayIndex(ArrayIndex* array_index) {
     leaf_type_tree::SimpleUpdateFrom<IntervalSet, IntervalSet>(
         result.AsMutableView(), array_interval_set_tree.AsView(indexes),
         [](IntervalSet& lhs, const IntervalSet& rhs) {
-          lhs = IntervalSet::Combine(lhs, rhs);
+          lhs.CombineWith(rhs);
         });
     return false;
   });
@@ -649,7 +775,7 @@ absl::Status RangeQueryVisitor::HandleArraySlice(ArraySlice* slice) {
     leaf_type_tree::SimpleUpdateFrom<IntervalSet, IntervalSet>(
         result.AsMutableView(), slice_ltt->AsView(),
         [](IntervalSet& lhs, const IntervalSet& rhs) {
-          lhs = IntervalSet::Combine(lhs, rhs);
+          lhs.CombineWith(rhs);
         });
     return start >= slice->array()->GetType()->AsArrayOrDie()->size();
   });
@@ -700,9 +826,8 @@ absl::Status RangeQueryVisitor::HandleNe(CompareOp* ne) {
 
   IntervalSet res(/*bit_count=*/1);
   for (int64_t i = 0; i < lhs_intervals.size(); ++i) {
-    res = IntervalSet::Combine(res,
-                               interval_ops::Ne(lhs_intervals.elements()[i],
-                                                rhs_intervals.elements()[i]));
+    res.CombineWith(interval_ops::Ne(lhs_intervals.elements()[i],
+                                     rhs_intervals.elements()[i]));
   }
   return SetIntervalSet(ne, std::move(res));
 }
@@ -756,7 +881,7 @@ absl::Status RangeQueryVisitor::HandlePrioritySel(PrioritySelect* sel) {
     leaf_type_tree::SimpleUpdateFrom<IntervalSet, IntervalSet>(
         result.AsMutableView(), all_zero_default.AsView(),
         [](IntervalSet& lhs, const IntervalSet& rhs) {
-          lhs = IntervalSet::Combine(lhs, rhs);
+          lhs.CombineWith(rhs);
         });
   }
   for (int64_t i = 0; i < sel->cases().size(); ++i) {
@@ -767,7 +892,7 @@ absl::Status RangeQueryVisitor::HandlePrioritySel(PrioritySelect* sel) {
       leaf_type_tree::SimpleUpdateFrom<IntervalSet, IntervalSet>(
           result.AsMutableView(), GetIntervalSetTree(sel->cases()[i]).AsView(),
           [](IntervalSet& lhs, const IntervalSet& rhs) {
-            lhs = IntervalSet::Combine(lhs, rhs);
+            lhs.CombineWith(rhs);
           });
     }
   }
@@ -899,7 +1024,7 @@ absl::Status RangeQueryVisitor::HandleSel(Select* sel) {
       leaf_type_tree::SimpleUpdateFrom<IntervalSet, IntervalSet>(
           result.AsMutableView(), GetIntervalSetTree(sel->cases()[i]).AsView(),
           [](IntervalSet& lhs, const IntervalSet& rhs) {
-            lhs = IntervalSet::Combine(lhs, rhs);
+            lhs.CombineWith(rhs);
           });
     }
   }
@@ -908,7 +1033,7 @@ absl::Status RangeQueryVisitor::HandleSel(Select* sel) {
         result.AsMutableView(),
         GetIntervalSetTree(sel->default_value().value()).AsView(),
         [](IntervalSet& lhs, const IntervalSet& rhs) {
-          lhs = IntervalSet::Combine(lhs, rhs);
+          lhs.CombineWith(rhs);
         });
   }
   for (IntervalSet& intervals : result.elements()) {
@@ -982,8 +1107,7 @@ absl::Status RangeQueryVisitor::HandleTuple(Tuple* tuple) {
 absl::Status RangeQueryVisitor::HandleTupleIndex(TupleIndex* index) {
   INITIALIZE_OR_SKIP(index);
   LeafTypeTree<IntervalSet> arg = GetIntervalSetTree(index->operand(0));
-  SetIntervalSetTree(index,
-                     leaf_type_tree::Clone(arg.AsView({index->index()})));
+  SetIntervalSetTree(index, arg.Subtree({index->index()}));
   return absl::OkStatus();
 }
 
@@ -22,6 +22,8 @@
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
@@ -99,10 +101,16 @@ class NoGivensProvider final : public RangeDataProvider {
 };
 
 // A query engine which tracks sets of intervals that a value can be in.
+//
+// If constructed with `lazy` set, Populate only records the function and the
+// ranges of each node are computed the first time the node is queried, along
+// with those of its transitive operands which have not been computed yet. All
+// computed ranges are memoized. PopulateWithGivens always computes the ranges
+// of all nodes.
 class RangeQueryEngine : public QueryEngine {
  public:
   // Create a `RangeQueryEngine` that contains no data.
-  RangeQueryEngine() = default;
+  explicit RangeQueryEngine(bool lazy = false) : lazy_(lazy) {}
   RangeQueryEngine(RangeQueryEngine&&) = default;
   RangeQueryEngine(const RangeQueryEngine&) = default;
   RangeQueryEngine& operator=(const RangeQueryEngine&) = default;
@@ -111,6 +119,14 @@ class RangeQueryEngine : public QueryEngine {
   // Populate the data in this `RangeQueryEngine` using the
   // given `FunctionBase*`;
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override {
+    if (lazy_) {
+      function_ = f;
+      known_bits_.clear();
+      known_bit_values_.clear();
+      interval_sets_.clear();
+      computed_.clear();
+      return ReachedFixpoint::Unknown;
+    }
     NoGivensProvider givens(f);
     return PopulateWithGivens(givens);
   }
@@ -121,12 +137,39 @@ class RangeQueryEngine : public QueryEngine {
   // std::nullopt and `ShouldContinue` always returns true)
   absl::StatusOr<ReachedFixpoint> PopulateWithGivens(RangeDataProvider& givens);
 
+  // Brings the engine up to date after the IR has been modified in place.
+  // `changed_nodes` must include every node which has been added, or had its
+  // operands changed, since the engine was populated. These nodes are
+  // re-analyzed, as are any of their transitive users whose operand ranges
+  // change as a result. The ranges of all other nodes are reused. Unlike a
+  // repeated call to Populate, re-analyzed ranges replace the previous ranges
+  // rather than being intersected with them. In lazy mode the memoized ranges
+  // of these nodes and their transitive users are discarded instead and
+  // ReachedFixpoint::Unknown is returned.
+  absl::StatusOr<ReachedFixpoint> UpdateChangedNodes(
+      absl::Span<Node* const> changed_nodes);
+
+  // Discards the information about `node`, e.g. because it has been removed
+  // from its function.
+  void ForgetNode(Node* node) {
+    known_bits_.erase(node);
+    known_bit_values_.erase(node);
+    interval_sets_.erase(node);
+    computed_.erase(node);
+  }
+
   bool IsTracked(Node* node) const override {
+    if (lazy_ && !EnsureComputed(node)) {
+      return false;
+    }
     return known_bits_.contains(node);
   }
 
   // Check if there are explicit intervals associated with the node.
   bool HasExplicitIntervals(Node* node) const {
+    if (lazy_ && !EnsureComputed(node)) {
+      return false;
+    }
     return interval_sets_.contains(node);
   }
 
@@ -157,6 +200,9 @@ class RangeQueryEngine : public QueryEngine {
                  })
           .value();
     }
+    if (lazy_) {
+      CHECK(EnsureComputed(node)) << node;
+    }
     TernaryVector tvec = ternary_ops::FromKnownBits(known_bits_.at(node),
                                                     known_bit_values_.at(node));
     LeafTypeTree<TernaryVector> tree(node->GetType());
@@ -208,6 +254,8 @@ class RangeQueryEngine : public QueryEngine {
     return std::nullopt;
   }
 
+  int64_t EstimateMemoryUsage() const override;
+
   // Get the intervals associated with each leaf node in the type tree
   // associated with this node.
   IntervalSetTree GetIntervalSetTree(Node* node) const;
@@ -235,9 +283,23 @@ class RangeQueryEngine : public QueryEngine {
  private:
   friend class RangeQueryVisitor;
 
-  absl::flat_hash_map<Node*, Bits> known_bits_;
-  absl::flat_hash_map<Node*, Bits> known_bit_values_;
-  absl::flat_hash_map<Node*, IntervalSetTree> interval_sets_;
+  // In lazy mode, computes the ranges of `node` and its transitive operands if
+  // they have not been computed yet. Returns false if `node` is not in the
+  // populated function.
+  bool EnsureComputed(Node* node) const;
+
+  bool lazy_;
+  // The function being analyzed in lazy mode.
+  FunctionBase* function_ = nullptr;
+
+  // In lazy mode these hold the memoized ranges and are filled in by const
+  // queries.
+  mutable absl::flat_hash_map<Node*, Bits> known_bits_;
+  mutable absl::flat_hash_map<Node*, Bits> known_bit_values_;
+  mutable absl::flat_hash_map<Node*, IntervalSetTree> interval_sets_;
+  // The nodes whose ranges have been computed in lazy mode. Every node in the
+  // set has its operands in the set.
+  mutable absl::flat_hash_set<Node*> computed_;
 };
 
 std::string IntervalSetTreeToString(const IntervalSetTree& tree);
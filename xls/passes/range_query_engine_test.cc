@@ -23,15 +23,18 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "benchmark/benchmark.h"
 #include "fuzztest/fuzztest.h"
 #include "absl/algorithm/container.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/benchmark_support.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/dfs_visitor.h"
@@ -43,10 +46,13 @@
 #include "xls/ir/interval_set_test_utils.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
 #include "xls/ir/ternary.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 namespace {
@@ -1802,5 +1808,127 @@ TEST_F(RangeQueryEngineTest, MultipleRangeGivenValue) {
             BitsLTT(ltxyz.node(), {Interval::Precise(UBits(1, 1))}));
 }
 
+TEST_F(RangeQueryEngineTest, LazyMatchesEager) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue small_x = fb.ZeroExtend(fb.BitSlice(x, 0, 4), 8);
+  BValue sum = fb.Add(small_x, fb.Literal(UBits(3, 8)));
+  BValue lt = fb.ULt(sum, fb.Literal(UBits(20, 8)));
+  BValue other = fb.UMul(y, y);
+  fb.Tuple({lt, sum, other});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  RangeQueryEngine eager;
+  XLS_ASSERT_OK(eager.Populate(f));
+  RangeQueryEngine lazy(/*lazy=*/true);
+  XLS_ASSERT_OK(lazy.Populate(f));
+  EXPECT_EQ(lazy.EstimateMemoryUsage(), 0);
+
+  // Only the operand cone of the queried node is computed.
+  EXPECT_EQ(lazy.GetIntervalSetTree(lt.node()),
+            BitsLTT(lt.node(), {Interval::Precise(UBits(1, 1))}));
+  EXPECT_GT(lazy.EstimateMemoryUsage(), 0);
+  EXPECT_LT(lazy.EstimateMemoryUsage(), eager.EstimateMemoryUsage());
+
+  for (Node* node : ReverseTopoSort(f)) {
+    ASSERT_EQ(lazy.IsTracked(node), eager.IsTracked(node)) << node;
+    EXPECT_EQ(lazy.GetIntervals(node), eager.GetIntervals(node)) << node;
+    EXPECT_EQ(lazy.GetTernary(node), eager.GetTernary(node)) << node;
+  }
+}
+
+TEST_F(RangeQueryEngineTest, LazyUpdateChangedNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue small_x = fb.ZeroExtend(fb.BitSlice(x, 0, 4), 8);
+  BValue offset = fb.Literal(UBits(15, 8));
+  BValue sum = fb.Add(small_x, offset);
+  BValue result = fb.Identity(sum);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  RangeQueryEngine lazy(/*lazy=*/true);
+  XLS_ASSERT_OK(lazy.Populate(f));
+  EXPECT_EQ(lazy.GetIntervalSetTree(result.node()),
+            BitsLTT(result.node(), {Interval(UBits(15, 8), UBits(30, 8))}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_offset,
+      f->MakeNode<Literal>(SourceInfo(), Value(UBits(3, 8))));
+  EXPECT_TRUE(sum.node()->ReplaceOperand(offset.node(), new_offset));
+  XLS_ASSERT_OK(lazy.UpdateChangedNodes({sum.node(), new_offset}).status());
+  EXPECT_EQ(lazy.GetIntervalSetTree(result.node()),
+            BitsLTT(result.node(), {Interval(UBits(3, 8), UBits(18, 8))}));
+}
+
+
+// A leaf which is a zero-extended parameter so that the engine has non-trivial
+// ranges to combine.
+class ZeroExtendedParam final
+    : public benchmark_support::strategy::NullaryNode {
+ public:
+  explicit ZeroExtendedParam(int64_t bit_count) : bit_count_(bit_count) {}
+
+  absl::StatusOr<BValue> GenerateNullaryNode(
+      FunctionBuilder& builder) const final {
+    BValue param =
+        builder.Param(absl::StrCat("param_", param_count_++),
+                      builder.package()->GetBitsType(bit_count_ / 2));
+    return builder.ZeroExtend(param, bit_count_);
+  }
+
+ private:
+  int64_t bit_count_;
+  mutable int64_t param_count_ = 0;
+};
+
+// Balanced tree of adds of zero-extended parameters.
+void BM_AddTree(benchmark::State& state) {
+  auto p = std::make_unique<VerifiedPackage>("add_tree");
+  FunctionBuilder fb("add_tree", p.get());
+  XLS_ASSERT_OK(benchmark_support::GenerateBalancedTree(
+                    fb, /*depth=*/state.range(0), /*fan_out=*/2,
+                    benchmark_support::strategy::BinaryAdd(),
+                    ZeroExtendedParam(/*bit_count=*/state.range(1)))
+                    .status());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  for (auto _ : state) {
+    RangeQueryEngine engine;
+    XLS_ASSERT_OK_AND_ASSIGN(auto r, engine.Populate(f));
+    benchmark::DoNotOptimize(r);
+  }
+}
+
+// Fully connected layers of adds, each sum being selected against a shifted
+// copy so that interval sets are combined at every layer.
+void BM_AddSelectLayers(benchmark::State& state) {
+  auto p = std::make_unique<VerifiedPackage>("add_select_layers");
+  FunctionBuilder fb("add_select_layers", p.get());
+  int64_t bit_count = state.range(1);
+  BValue selector = fb.Param("selector", p->GetBitsType(1));
+  BValue a = fb.ZeroExtend(fb.Param("a", p->GetBitsType(bit_count / 2)),
+                           bit_count);
+  BValue b = fb.ZeroExtend(fb.Param("b", p->GetBitsType(bit_count / 2)),
+                           bit_count);
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    BValue sum = fb.Add(a, b);
+    BValue shifted = fb.Shrl(sum, fb.Literal(UBits(1, bit_count)));
+    a = fb.Select(selector, {sum, shifted});
+    b = fb.Select(selector, {shifted, b});
+  }
+  fb.Add(a, b);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  for (auto _ : state) {
+    RangeQueryEngine engine;
+    XLS_ASSERT_OK_AND_ASSIGN(auto r, engine.Populate(f));
+    benchmark::DoNotOptimize(r);
+  }
+}
+
+BENCHMARK(BM_AddTree)->ArgsProduct({{4, 8, 10}, {16, 64, 128}});
+BENCHMARK(BM_AddSelectLayers)->ArgsProduct({{8, 64, 256}, {16, 64, 128}});
+
 }  // namespace
 }  // namespace xls
@@ -16,20 +16,27 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
+#include <queue>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/delay_model/delay_estimators.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/op.h"
@@ -369,10 +376,94 @@ int64_t GatherExpressionLeaves(Op op, Node* node, std::vector<Node*>* leaves,
   return max_depth;
 }
 
+// Estimates of the critical-path delay from the start of the function to the
+// value of each node, used to shape reassociated trees around operands which
+// arrive late. Like BDD-CSE this runs before scheduling, so the standard delay
+// estimator is used and nodes it cannot estimate are given zero delay.
+class ArrivalTimes {
+ public:
+  explicit ArrivalTimes(FunctionBase* f) {
+    for (Node* node : TopoSort(f)) {
+      Get(node);
+    }
+  }
+
+  // Returns the arrival time of `node` in ps, computing it from its operands
+  // if `node` is new.
+  int64_t Get(Node* node) {
+    auto it = arrival_.find(node);
+    if (it != arrival_.end()) {
+      return it->second;
+    }
+    int64_t start = 0;
+    for (Node* operand : node->operands()) {
+      start = std::max(start, Get(operand));
+    }
+    int64_t arrival = start + NodeDelay(node);
+    arrival_[node] = arrival;
+    return arrival;
+  }
+
+  static int64_t NodeDelay(Node* node) {
+    absl::StatusOr<int64_t> delay =
+        GetStandardDelayEstimator().GetOperationDelayInPs(node);
+    return delay.ok() ? delay.value() : 0;
+  }
+
+ private:
+  absl::flat_hash_map<Node*, int64_t> arrival_;
+};
+
+// Returns the arrival time of the root of the tree built by balancing
+// operands with the given arrival times by count, as Reassociate does by
+// default, where each operation has delay `op_delay`.
+int64_t BalancedTreeArrival(std::vector<int64_t> arrivals, int64_t op_delay) {
+  if (!IsPowerOfTwo(arrivals.size())) {
+    int64_t op_count =
+        arrivals.size() - (1ULL << FloorOfLog2(arrivals.size()));
+    std::vector<int64_t> next;
+    for (int64_t i = 0; i < op_count; ++i) {
+      next.push_back(std::max(arrivals[2 * i], arrivals[2 * i + 1]) +
+                     op_delay);
+    }
+    for (int64_t i = op_count * 2; i < arrivals.size(); ++i) {
+      next.push_back(arrivals[i]);
+    }
+    arrivals = std::move(next);
+  }
+  while (arrivals.size() != 1) {
+    std::vector<int64_t> next;
+    for (int64_t i = 0; i < arrivals.size() / 2; ++i) {
+      next.push_back(std::max(arrivals[2 * i], arrivals[2 * i + 1]) +
+                     op_delay);
+    }
+    arrivals = std::move(next);
+  }
+  return arrivals.front();
+}
+
+// Returns the arrival time of the root of the tree built by repeatedly
+// combining the two earliest-arriving operands, where each operation has delay
+// `op_delay`. This is the minimum arrival time of any tree of the operands.
+int64_t EarliestFirstTreeArrival(absl::Span<const int64_t> arrivals,
+                                 int64_t op_delay) {
+  std::priority_queue<int64_t, std::vector<int64_t>, std::greater<>> queue(
+      arrivals.begin(), arrivals.end());
+  while (queue.size() > 1) {
+    int64_t first = queue.top();
+    queue.pop();
+    int64_t second = queue.top();
+    queue.pop();
+    queue.push(std::max(first, second) + op_delay);
+  }
+  return queue.top();
+}
+
 // Reassociate associative and commutative operations to minimize delay and
 // maximize opportunity for constant folding.
 absl::StatusOr<bool> Reassociate(FunctionBase* f) {
   bool changed = false;
+  ArrivalTimes arrival_times(f);
   // Keep track of which nodes we've already considered for reassociation so we
   // don't revisit subexpressions multiple times.
   absl::flat_hash_set<Node*> visited_nodes;
@@ -467,15 +558,43 @@ absl::StatusOr<bool> Reassociate(FunctionBase* f) {
       }
     }
 
-    // We only want to transform for one of the two cases above.
+    // (3) The expression is already balanced but some inputs arrive later
+    //     than others, e.g. the products in an unrolled multiply-accumulate.
+    //     Combining the earliest-arriving inputs first and the late inputs
+    //     last shortens the critical path through the expression.
+    //
+    // The literals collapse to a single input available at the start.
+    int64_t op_delay = ArrivalTimes::NodeDelay(node);
+    std::vector<int64_t> input_arrivals;
+    for (Node* input : inputs) {
+      input_arrivals.push_back(arrival_times.Get(input));
+    }
+    if (!literals.empty()) {
+      input_arrivals.push_back(0);
+    }
+    int64_t balanced_arrival = BalancedTreeArrival(input_arrivals, op_delay);
+    int64_t earliest_first_arrival =
+        EarliestFirstTreeArrival(input_arrivals, op_delay);
+    // Only deviate from the balanced tree if that is strictly faster.
+    const bool earliest_first = earliest_first_arrival < balanced_arrival;
+    const int64_t planned_arrival =
+        earliest_first ? earliest_first_arrival : balanced_arrival;
+    const int64_t current_arrival = arrival_times.Get(node);
+    // A tree deeper than balanced may already be shaped around late inputs.
+    const bool reduces_depth =
+        expression_depth > CeilOfLog2(leaves.size()) &&
+        !(earliest_first && planned_arrival >= current_arrival);
+
+    // We only want to transform for one of the three cases above.
     if (interior_nodes.size() <= 1 ||
-        (expression_depth == CeilOfLog2(leaves.size()) &&
-         literals.size() <= 1)) {
+        (!reduces_depth && literals.size() <= 1 &&
+         planned_arrival >= current_arrival)) {
       continue;
     }
 
     VLOG(4) << "Reassociated expression rooted at: " << node->GetName();
     VLOG(4) << "  is_full_width_addition: " << is_full_width_addition;
+    VLOG(4) << "  earliest_first: " << earliest_first;
 
     auto node_joiner = [](std::string* s, Node* node) {
       absl::StrAppendFormat(s, "%s (%s)", node->GetName(),
@@ -540,6 +659,28 @@ absl::StatusOr<bool> Reassociate(FunctionBase* f) {
     VLOG(4) << "  inputs before balancing:  "
             << absl::StrJoin(inputs, ", ", node_joiner);
 
+    if (earliest_first) {
+      // Repeatedly combine the two earliest-arriving inputs. Ties are broken
+      // by order of insertion so that inputs arriving together are combined
+      // in order.
+      using QueueEntry = std::tuple<int64_t, int64_t, Node*>;
+      std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>>
+          queue;
+      int64_t sequence = 0;
+      for (Node* input : inputs) {
+        queue.emplace(arrival_times.Get(input), sequence++, input);
+      }
+      while (queue.size() > 1) {
+        Node* lhs = std::get<Node*>(queue.top());
+        queue.pop();
+        Node* rhs = std::get<Node*>(queue.top());
+        queue.pop();
+        XLS_ASSIGN_OR_RETURN(Node * new_op, new_node(lhs, rhs));
+        queue.emplace(arrival_times.Get(new_op), sequence++, new_op);
+      }
+      inputs = {std::get<Node*>(queue.top())};
+    }
+
     // Reassociate the expressions into a balanced tree. First, reduce the
     // number of inputs to a power of two. Then build a balanced tree.
     if (!IsPowerOfTwo(inputs.size())) {
@@ -15,6 +15,7 @@
 #include "xls/passes/reassociation_pass.h"
 
 #include <cstdint>
+#include <string_view>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -415,5 +416,62 @@ TEST_F(ReassociationPassTest, SubOfSub) {
               m::Sub(m::Add(m::Param("x"), m::Param("z")), m::Param("y")));
 }
 
+// Returns a value which arrives much later than the parameters: a chain of
+// multiplies which reassociation leaves alone.
+BValue LateValue(FunctionBuilder& fb, Type* type) {
+  BValue product = fb.UMul(fb.UMul(fb.Param("m", type), fb.Param("n", type)),
+                           fb.Param("o", type));
+  return fb.SMul(product, fb.Param("q", type));
+}
+
+TEST_F(ReassociationPassTest, LateInputCombinedLast) {
+  // An accumulator starting from a late product. Balancing by count alone
+  // would put the product two adds from the root; it should be added last.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  BValue sum = LateValue(fb, u32);
+  for (std::string_view name : {"a", "b", "c", "d"}) {
+    sum = fb.Add(sum, fb.Param(name, u32));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  ScopedVerifyEquivalence stays_equivalent(f, kProverTimeout);
+  ASSERT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Add(m::Add(m::Add(m::Param("a"), m::Param("b")),
+                            m::Add(m::Param("c"), m::Param("d"))),
+                     m::SMul()));
+}
+
+TEST_F(ReassociationPassTest, BalancedTreeWithLateInputReassociated) {
+  // The tree is balanced but the late product is two adds from the root.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  fb.Add(fb.Add(LateValue(fb, u32), fb.Param("a", u32)),
+         fb.Add(fb.Param("b", u32), fb.Param("c", u32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  ScopedVerifyEquivalence stays_equivalent(f, kProverTimeout);
+  ASSERT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Add(m::Add(m::Param("c"),
+                            m::Add(m::Param("a"), m::Param("b"))),
+                     m::SMul()));
+  ASSERT_THAT(Run(p.get()), IsOkAndHolds(false));
+}
+
+TEST_F(ReassociationPassTest, LateInputAlreadyLastNotReassociated) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  fb.Add(fb.Add(fb.Add(fb.Param("a", u32), fb.Param("b", u32)),
+                fb.Param("c", u32)),
+         LateValue(fb, u32));
+  XLS_ASSERT_OK(fb.Build().status());
+  ASSERT_THAT(Run(p.get()), IsOkAndHolds(false));
+}
+
 }  // namespace
 }  // namespace xls
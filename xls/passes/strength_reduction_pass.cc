@@ -47,8 +47,8 @@
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/stateless_query_engine.h"
-#include "xls/passes/ternary_query_engine.h"
 #include "xls/passes/union_query_engine.h"
 
 namespace xls {
@@ -561,7 +561,7 @@ absl::StatusOr<bool> StrengthReductionPass::RunOnFunctionBaseInternal(
     PassResults* results) const {
   std::vector<std::unique_ptr<QueryEngine>> query_engines;
   query_engines.push_back(std::make_unique<StatelessQueryEngine>());
-  query_engines.push_back(std::make_unique<TernaryQueryEngine>());
+  query_engines.push_back(MakeTernaryQueryEngine(options));
 
   UnionQueryEngine query_engine(std::move(query_engines));
   XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
@@ -570,11 +570,9 @@ absl::StatusOr<bool> StrengthReductionPass::RunOnFunctionBaseInternal(
                        FindReducibleAdds(f, query_engine));
   // Note: because we introduce new nodes into the graph that were not present
   // for the original QueryEngine analysis, we may get less effective
-  // optimizations for these new nodes due to a lack of data.
-  //
-  // TODO(leary): 2019-09-05: We can eventually implement incremental
-  // recomputation of the bit tracking data for newly introduced nodes so the
-  // information is always fresh and precise.
+  // optimizations for these new nodes due to a lack of data. When a query
+  // engine cache is in use the new nodes are analyzed incrementally the next
+  // time the cached engine is requested.
   bool modified = false;
   for (Node* node : TopoSort(f)) {
     XLS_ASSIGN_OR_RETURN(
@@ -15,6 +15,9 @@
 #ifndef XLS_PASSES_TERNARY_EVALUATOR_H_
 #define XLS_PASSES_TERNARY_EVALUATOR_H_
 
+#include <cstdint>
+
+#include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
 #include "xls/ir/abstract_evaluator.h"
@@ -49,6 +52,59 @@ class TernaryEvaluator
   TernaryValue Or(const TernaryValue& a, const TernaryValue& b) const {
     return ternary_ops::Or(a, b);
   }
+
+  // The vector operations below shadow the element-wise versions of the base
+  // class with ones computed on packed vectors a 64-bit word at a time. The
+  // results are identical.
+  Vector BitwiseNot(const Span& input) {
+    return ternary_ops::Not(PackedTernaryVector::FromTernary(input))
+        .ToTernary();
+  }
+
+  Vector BitwiseAnd(SpanOfSpan inputs) {
+    return PackedNaryOp(inputs, [](const PackedTernaryVector& a,
+                                   const PackedTernaryVector& b) {
+      return ternary_ops::And(a, b);
+    });
+  }
+  Vector BitwiseOr(SpanOfSpan inputs) {
+    return PackedNaryOp(inputs, [](const PackedTernaryVector& a,
+                                   const PackedTernaryVector& b) {
+      return ternary_ops::Or(a, b);
+    });
+  }
+  Vector BitwiseXor(SpanOfSpan inputs) {
+    return PackedNaryOp(inputs, [](const PackedTernaryVector& a,
+                                   const PackedTernaryVector& b) {
+      return ternary_ops::Xor(a, b);
+    });
+  }
+  Vector BitwiseAnd(Span a, Span b) { return BitwiseAnd({a, b}); }
+  Vector BitwiseOr(Span a, Span b) { return BitwiseOr({a, b}); }
+  Vector BitwiseXor(Span a, Span b) { return BitwiseXor({a, b}); }
+
+  Vector Add(Span a, Span b) {
+    return ternary_ops::Add(PackedTernaryVector::FromTernary(a),
+                            PackedTernaryVector::FromTernary(b))
+        .ToTernary();
+  }
+
+  TernaryValue Equals(Span a, Span b) {
+    return ternary_ops::Equals(PackedTernaryVector::FromTernary(a),
+                               PackedTernaryVector::FromTernary(b));
+  }
+
+ private:
+  template <typename F>
+  Vector PackedNaryOp(SpanOfSpan inputs, F f) {
+    CHECK(!inputs.empty());
+    PackedTernaryVector result = PackedTernaryVector::FromTernary(inputs[0]);
+    for (int64_t i = 1; i < inputs.size(); ++i) {
+      CHECK_EQ(inputs[i].size(), result.bit_count());
+      result = f(result, PackedTernaryVector::FromTernary(inputs[i]));
+    }
+    return result.ToTernary();
+  }
 };
 
 }  // namespace xls
@@ -23,10 +23,13 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/data_structures/leaf_type_tree.h"
@@ -171,6 +174,12 @@ class TernaryNodeEvaluator : public AbstractNodeEvaluator<TernaryEvaluator> {
   using CompoundValueView = LeafTypeTreeView<TernaryEvaluator::Vector>;
   using AbstractNodeEvaluator<TernaryEvaluator>::AbstractNodeEvaluator;
 
+  // Sets the value of `n` to a value computed previously. This is used to
+  // provide operand values when only a subset of the nodes are evaluated.
+  absl::Status SetPrecomputedValue(Node* n, CompoundValue value) {
+    return SetValue(n, std::move(value));
+  }
+
   // By default everything is considered fully unconstrained.
   absl::Status DefaultHandler(Node* n) override {
     XLS_ASSIGN_OR_RETURN(auto unconstrained, UnconstrainedOf(n->GetType()));
@@ -309,6 +318,11 @@ class TernaryNodeEvaluator : public AbstractNodeEvaluator<TernaryEvaluator> {
 }  // namespace
 
 absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Populate(FunctionBase* f) {
+  if (lazy_) {
+    function_ = f;
+    values_.clear();
+    return ReachedFixpoint::Unknown;
+  }
   TernaryEvaluator evaluator;
   TernaryNodeEvaluator ternary_visitor(evaluator);
   for (Node* n : TopoSort(f)) {
@@ -341,6 +355,108 @@ absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Populate(FunctionBase* f) {
   return rf;
 }
 
+bool TernaryQueryEngine::EnsureComputed(Node* node) const {
+  if (node->function_base() != function_) {
+    return false;
+  }
+  if (values_.contains(node)) {
+    return true;
+  }
+  TernaryEvaluator evaluator;
+  TernaryNodeEvaluator ternary_visitor(evaluator);
+  std::vector<Node*> to_compute = TopoSortTransitiveOperands(
+      node, [&](Node* n) { return values_.contains(n); });
+  for (Node* n : to_compute) {
+    for (Node* operand : n->operands()) {
+      if (!ternary_visitor.values().contains(operand)) {
+        CHECK_OK(
+            ternary_visitor.SetPrecomputedValue(operand, values_.at(operand)));
+      }
+    }
+    absl::Status status =
+        IsExpensiveToEvaluate(n, ternary_visitor.values())
+            ? ternary_visitor.DefaultHandler(n)
+            : n->VisitSingleNode(&ternary_visitor);
+    if (!status.ok()) {
+      VLOG(1) << "Ternary evaluation of " << n << " failed: " << status;
+      CHECK_OK(ternary_visitor.DefaultHandler(n));
+    }
+  }
+  absl::flat_hash_map<Node*, LeafTypeTree<TernaryVector>> new_values =
+      std::move(ternary_visitor).values();
+  for (Node* n : to_compute) {
+    values_[n] = std::move(new_values.at(n));
+  }
+  return true;
+}
+
+int64_t TernaryQueryEngine::EstimateMemoryUsage() const {
+  int64_t bytes = EstimateHeapBytes(values_);
+  for (const auto& [node, value] : values_) {
+    bytes += value.EstimateMemoryUsage(
+        [](const TernaryVector& v) { return EstimateHeapBytes(v); });
+  }
+  return bytes;
+}
+
+absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::UpdateChangedNodes(
+    absl::Span<Node* const> changed_nodes) {
+  if (lazy_) {
+    // Discard the memoized values which may depend on the changed nodes. Nodes
+    // without a memoized value have no users with a memoized value.
+    std::vector<Node*> worklist(changed_nodes.begin(), changed_nodes.end());
+    for (Node* node : changed_nodes) {
+      values_.erase(node);
+    }
+    while (!worklist.empty()) {
+      Node* node = worklist.back();
+      worklist.pop_back();
+      for (Node* user : node->users()) {
+        if (values_.erase(user) > 0) {
+          worklist.push_back(user);
+        }
+      }
+    }
+    return ReachedFixpoint::Unknown;
+  }
+  absl::flat_hash_set<Node*> changed(changed_nodes.begin(),
+                                     changed_nodes.end());
+  TernaryEvaluator evaluator;
+  TernaryNodeEvaluator ternary_visitor(evaluator);
+  // Nodes whose values differ from their previous values.
+  absl::flat_hash_set<Node*> updated;
+  ReachedFixpoint rf = ReachedFixpoint::Unchanged;
+  for (Node* node : TopoSortTransitiveUsers(changed_nodes)) {
+    if (!changed.contains(node) &&
+        absl::c_none_of(node->operands(),
+                        [&](Node* o) { return updated.contains(o); })) {
+      continue;
+    }
+    for (Node* operand : node->operands()) {
+      if (!ternary_visitor.values().contains(operand)) {
+        XLS_RET_CHECK(values_.contains(operand))
+            << "No ternary value for " << operand;
+        XLS_RETURN_IF_ERROR(
+            ternary_visitor.SetPrecomputedValue(operand, values_.at(operand)));
+      }
+    }
+    if (IsExpensiveToEvaluate(node, ternary_visitor.values())) {
+      XLS_RETURN_IF_ERROR(ternary_visitor.DefaultHandler(node));
+    } else {
+      XLS_RETURN_IF_ERROR(node->VisitSingleNode(&ternary_visitor));
+    }
+    const LeafTypeTree<TernaryVector>& value =
+        ternary_visitor.values().at(node);
+    auto it = values_.find(node);
+    if (it == values_.end() || !(it->second == value)) {
+      updated.insert(node);
+      rf = ReachedFixpoint::Changed;
+      values_.insert_or_assign(node, value);
+    }
+  }
+  return rf;
+}
+
 bool TernaryQueryEngine::AtMostOneTrue(
     absl::Span<TreeBitLocation const> bits) const {
   int64_t maybe_one_count = 0;
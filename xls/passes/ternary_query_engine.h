@@ -38,17 +38,44 @@ namespace xls {
 // and can expose statically known bit values in the function (known 0 or 1),
 // but provides limited insight into relationships between bit values in the
 // function (implications, equality, etc).
+//
+// If constructed with `lazy` set, Populate only records the function and the
+// value of each node is computed the first time the node is queried, along
+// with the values of its transitive operands which have not been computed yet.
+// All computed values are memoized. This is cheaper than eager evaluation when
+// only a small fraction of the nodes are queried.
 class TernaryQueryEngine : public QueryEngine {
  public:
+  explicit TernaryQueryEngine(bool lazy = false) : lazy_(lazy) {}
+
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
+  // Brings the engine up to date after the IR has been modified in place.
+  // `changed_nodes` must include every node which has been added, or had its
+  // operands changed, since the engine was populated. These nodes are
+  // re-analyzed, as are any of their transitive users whose operand values
+  // change as a result. The values of all other nodes are reused. Unlike a
+  // repeated call to Populate, re-analyzed values replace the previous values
+  // rather than being merged with them. In lazy mode the memoized values of
+  // these nodes and their transitive users are discarded instead and
+  // ReachedFixpoint::Unknown is returned.
+  absl::StatusOr<ReachedFixpoint> UpdateChangedNodes(
+      absl::Span<Node* const> changed_nodes);
+
+  // Discards the information about `node`, e.g. because it has been removed
+  // from its function.
+  void ForgetNode(Node* node) { values_.erase(node); }
+
   bool IsTracked(Node* node) const override {
+    if (lazy_ && !EnsureComputed(node)) {
+      return false;
+    }
     return values_.contains(node) && values_.at(node).type() == node->GetType();
   }
 
   LeafTypeTree<TernaryVector> GetTernary(Node* node) const override {
-    return LeafTypeTree<TernaryVector>(node->GetType(),
-                                       GetTernaryView(node).elements());
+    CHECK(IsTracked(node)) << node;
+    return values_.at(node);
   }
   LeafTypeTreeView<TernaryVector> GetTernaryView(Node* node) const {
     CHECK(IsTracked(node)) << node;
@@ -74,6 +101,8 @@ class TernaryQueryEngine : public QueryEngine {
     return std::nullopt;
   }
 
+  int64_t EstimateMemoryUsage() const override;
+
   bool IsFullyKnown(Node* n) const override {
     if (!IsTracked(n)) {
       return false;
@@ -85,8 +114,20 @@ class TernaryQueryEngine : public QueryEngine {
   }
 
  private:
-  // Holds which bits values are known for nodes in the function.
-  absl::flat_hash_map<Node*, LeafTypeTree<TernaryEvaluator::Vector>> values_;
+  // In lazy mode, computes the values of `node` and its transitive operands if
+  // they have not been computed yet. Returns false if `node` is not in the
+  // populated function.
+  bool EnsureComputed(Node* node) const;
+
+  bool lazy_;
+  // The function being analyzed in lazy mode.
+  FunctionBase* function_ = nullptr;
+
+  // Holds which bits values are known for nodes in the function. In lazy mode
+  // this holds the memoized values and is filled in by const queries. Every
+  // node with a memoized value has memoized operands.
+  mutable absl::flat_hash_map<Node*, LeafTypeTree<TernaryEvaluator::Vector>>
+      values_;
 };
 
 }  // namespace xls
@@ -52,6 +52,7 @@
 #include "xls/ir/package.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/ternary.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_builder.h"
 
@@ -1706,6 +1707,62 @@ TEST_F(TernaryQueryEngineTest, Repopulate) {
   EXPECT_THAT(query_engine.ToString(result.node()), "0b0");
 }
 
+TEST_F(TernaryQueryEngineTest, LazyMatchesEager) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue masked = fb.And(x, fb.Literal(UBits(0x0f, 8)));
+  BValue with_msb = fb.Or(masked, fb.Literal(UBits(0x80, 8)));
+  BValue other = fb.Not(fb.Xor(y, fb.Literal(UBits(0xf0, 8))));
+  fb.Tuple({fb.Concat({with_msb, x}), other});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  TernaryQueryEngine eager;
+  XLS_ASSERT_OK(eager.Populate(f).status());
+  TernaryQueryEngine lazy(/*lazy=*/true);
+  XLS_ASSERT_OK(lazy.Populate(f).status());
+  EXPECT_EQ(lazy.EstimateMemoryUsage(), 0);
+
+  // Only the operand cone of the queried node is computed.
+  EXPECT_EQ(lazy.ToString(with_msb.node()), "0b1000_XXXX");
+  EXPECT_GT(lazy.EstimateMemoryUsage(), 0);
+  EXPECT_LT(lazy.EstimateMemoryUsage(), eager.EstimateMemoryUsage());
+
+  for (Node* node : ReverseTopoSort(f)) {
+    ASSERT_EQ(lazy.IsTracked(node), eager.IsTracked(node)) << node;
+    EXPECT_EQ(lazy.GetTernary(node), eager.GetTernary(node)) << node;
+  }
+
+  // Nodes of other functions are not tracked.
+  FunctionBuilder other_fb("other", p.get());
+  other_fb.Param("z", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * other_f, other_fb.Build());
+  EXPECT_FALSE(lazy.IsTracked(other_f->return_value()));
+}
+
+TEST_F(TernaryQueryEngineTest, LazyUpdateChangedNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue mask = fb.Literal(UBits(0x0f, 8));
+  BValue masked = fb.And(x, mask);
+  BValue result = fb.Not(masked);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  TernaryQueryEngine lazy(/*lazy=*/true);
+  XLS_ASSERT_OK(lazy.Populate(f).status());
+  EXPECT_EQ(lazy.ToString(result.node()), "0b1111_XXXX");
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_mask,
+      f->MakeNode<Literal>(SourceInfo(), Value(UBits(0x03, 8))));
+  EXPECT_TRUE(masked.node()->ReplaceOperand(mask.node(), new_mask));
+  XLS_ASSERT_OK(lazy.UpdateChangedNodes({masked.node(), new_mask}).status());
+  EXPECT_EQ(lazy.ToString(result.node()), "0b1111_11XX");
+  EXPECT_EQ(lazy.ToString(masked.node()), "0b0000_00XX");
+}
+
 namespace {
 
 class ArrayCreation : public benchmark_support::strategy::NaryNode {
@@ -1782,6 +1839,45 @@ void BM_ArrayIndexExactTree(benchmark::State& state) {
   }
 }
 
+// Measures populating the query engine for generated designs of increasing
+// size, and reports its complexity in the size.
+void BM_PopulateScaling(benchmark::State& state,
+                        benchmark_support::ScalingDesign design) {
+  Package package("BM");
+  XLS_ASSERT_OK_AND_ASSIGN(FunctionBase * f,
+                           benchmark_support::GenerateScalingDesign(
+                               design, &package, state.range(0)));
+  for (auto _ : state) {
+    TernaryQueryEngine query_engine;
+    XLS_ASSERT_OK_AND_ASSIGN(auto r, query_engine.Populate(f));
+    benchmark::DoNotOptimize(r);
+  }
+  state.SetComplexityN(state.range(0));
+}
+
+void ScalingArgs(benchmark::internal::Benchmark* b) {
+  b->RangeMultiplier(4)->Range(16, 4096)->Complexity();
+}
+
+BENCHMARK_CAPTURE(BM_PopulateScaling, chain,
+                  benchmark_support::ScalingDesign::kChain)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_PopulateScaling, balanced_tree,
+                  benchmark_support::ScalingDesign::kBalancedTree)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_PopulateScaling, ladder,
+                  benchmark_support::ScalingDesign::kLadder)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_PopulateScaling, large_select,
+                  benchmark_support::ScalingDesign::kLargeSelect)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_PopulateScaling, dynamic_array,
+                  benchmark_support::ScalingDesign::kDynamicArray)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_PopulateScaling, wide_state_proc,
+                  benchmark_support::ScalingDesign::kWideStateProc)
+    ->Apply(ScalingArgs);
+
 BENCHMARK(BM_ArrayIndexExactDeep)->DenseRange(2, 14, 1);
 BENCHMARK(BM_ArrayIndexExactShallow)->DenseRange(2, 14, 1);
 BENCHMARK(BM_ArrayIndexExactTree)->DenseRange(2, 12, 1);
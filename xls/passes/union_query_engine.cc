@@ -24,6 +24,7 @@
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/common/memory_usage.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/bits.h"
@@ -56,6 +57,21 @@ absl::StatusOr<ReachedFixpoint> UnownedUnionQueryEngine::Populate(
   return result;
 }
 
+int64_t UnownedUnionQueryEngine::EstimateMemoryUsage() const {
+  int64_t bytes =
+      EstimateHeapBytes(known_bits_) + EstimateHeapBytes(known_bit_values_);
+  for (const auto& [node, bits] : known_bits_) {
+    bytes += EstimateHeapBytes(bits);
+  }
+  for (const auto& [node, bits] : known_bit_values_) {
+    bytes += EstimateHeapBytes(bits);
+  }
+  for (const QueryEngine* engine : engines_) {
+    bytes += engine->EstimateMemoryUsage();
+  }
+  return bytes;
+}
+
 bool UnownedUnionQueryEngine::IsTracked(Node* node) const {
   for (const auto& engine : engines_) {
     if (engine->IsTracked(node)) {
@@ -110,7 +126,7 @@ LeafTypeTree<IntervalSet> UnownedUnionQueryEngine::GetIntervals(
       leaf_type_tree::SimpleUpdateFrom<IntervalSet, IntervalSet>(
           result.AsMutableView(), engine->GetIntervals(node).AsView(),
           [](IntervalSet& lhs, const IntervalSet& rhs) {
-            lhs = IntervalSet::Intersect(lhs, rhs);
+            lhs.IntersectWith(rhs);
           });
     }
   }
@@ -36,7 +36,8 @@
 namespace xls {
 
 // A query engine that combines the results of multiple (unowned) given query
-// engines.
+// engines. Queries are forwarded to the engines as they are made, so lazy
+// engines only compute facts for the nodes which are queried.
 //
 // `GetKnownBits` and `GetKnownBitsValues` use `const_cast<...>(this)` under the
 // hood, so it is undefined behavior to define a `const UnionQueryEngine`
@@ -78,6 +79,8 @@ class UnownedUnionQueryEngine : public QueryEngine {
       absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
       Node* node) const override;
 
+  int64_t EstimateMemoryUsage() const override;
+
  private:
   absl::flat_hash_map<Node*, Bits> known_bits_;
   absl::flat_hash_map<Node*, Bits> known_bit_values_;
@@ -14,13 +14,31 @@
 
 #include "xls/passes/unroll_pass.h"
 
+#include <cstdint>
+#include <optional>
+#include <string>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
 #include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 
@@ -28,10 +46,11 @@ namespace xls {
 namespace {
 
 // Finds an "effectively used" (has users or is return value) counted for in the
-// function f, or returns nullptr if none is found.
-CountedFor* FindCountedFor(FunctionBase* f) {
+// function f which is not in `skipped`, or returns nullptr if none is found.
+CountedFor* FindCountedFor(FunctionBase* f,
+                           const absl::flat_hash_set<Node*>& skipped) {
   for (Node* node : TopoSort(f)) {
-    if (node->Is<CountedFor>() &&
+    if (node->Is<CountedFor>() && !skipped.contains(node) &&
         (f->HasImplicitUse(node) || !node->users().empty())) {
       return node->As<CountedFor>();
     }
@@ -66,18 +85,174 @@ absl::Status UnrollCountedFor(CountedFor* loop) {
   return f->RemoveNode(loop);
 }
 
+// Returns whether the iterations of a loop with the given body may be inlined
+// as they are unrolled. The inlining pass makes the labels of covers and
+// asserts unique so bodies containing them are left to be inlined by it.
+bool CanInlineIterations(Function* body) {
+  return absl::c_none_of(body->nodes(), [](Node* node) {
+    return node->Is<Cover>() ||
+           (node->Is<Assert>() && node->As<Assert>()->label().has_value());
+  });
+}
+
+// Returns whether `node` of the loop body can be evaluated when its operands
+// are the literals `operands`.
+bool IsFoldable(Node* node, absl::Span<Node* const> operands) {
+  return !TypeHasToken(node->GetType()) && !OpIsSideEffecting(node->op()) &&
+         !node->Is<Invoke>() &&
+         absl::c_all_of(operands,
+                        [](Node* operand) { return operand->Is<Literal>(); });
+}
+
+// Inlines an iteration of the body of `loop` with the given arguments into the
+// function containing the loop. Nodes whose operands are all literals (such as
+// those computed from the induction variable) are folded as they are inlined
+// and nodes left dead by folding are removed. Returns the value of the
+// iteration.
+absl::StatusOr<Node*> InlineIteration(CountedFor* loop,
+                                      absl::Span<Node* const> args) {
+  FunctionBase* f = loop->function_base();
+  Function* body = loop->body();
+  absl::flat_hash_map<Node*, Node*> body_to_inlined;
+  for (int64_t i = 0; i < body->params().size(); ++i) {
+    body_to_inlined[body->param(i)] = args[i];
+  }
+  std::vector<Node*> inlined;
+  for (Node* node : TopoSort(body)) {
+    if (node->Is<Param>()) {
+      continue;
+    }
+    std::vector<Node*> operands;
+    for (Node* operand : node->operands()) {
+      operands.push_back(body_to_inlined.at(operand));
+    }
+    Node* new_node;
+    if (IsFoldable(node, operands)) {
+      std::vector<Value> operand_values;
+      for (Node* operand : operands) {
+        operand_values.push_back(operand->As<Literal>()->value());
+      }
+      XLS_ASSIGN_OR_RETURN(Value result, InterpretNode(node, operand_values));
+      XLS_ASSIGN_OR_RETURN(new_node, f->MakeNode<Literal>(node->loc(), result));
+    } else {
+      XLS_ASSIGN_OR_RETURN(new_node, node->CloneInNewFunction(operands, f));
+    }
+    if (new_node->loc().Empty()) {
+      new_node->SetLoc(loop->loc());
+    }
+    body_to_inlined[node] = new_node;
+    inlined.push_back(new_node);
+  }
+  Node* result = body_to_inlined.at(body->return_value());
+  // Remove the nodes left dead by folding, users before operands.
+  for (auto it = inlined.rbegin(); it != inlined.rend(); ++it) {
+    Node* node = *it;
+    if (node != result && node->users().empty() &&
+        !OpIsSideEffecting(node->op())) {
+      XLS_RETURN_IF_ERROR(f->RemoveNode(node));
+    }
+  }
+  return result;
+}
+
+// Returns a function which calls the body of `loop` with the induction variable
+// offset by `offset`. This is the body of the loop over the iterations which
+// remain after the first iterations of `loop` have been unrolled.
+absl::StatusOr<Function*> MakeOffsetBody(CountedFor* loop, int64_t offset) {
+  Function* body = loop->body();
+  Package* package = body->package();
+  std::string name = absl::StrFormat("%s__offset_%d", body->name(), offset);
+  for (int64_t i = 1; package->TryGetFunction(name).has_value(); ++i) {
+    name = absl::StrFormat("%s__offset_%d_%d", body->name(), offset, i);
+  }
+  FunctionBuilder fb(name, package);
+  std::vector<BValue> args;
+  for (Param* param : body->params()) {
+    args.push_back(fb.Param(param->GetName(), param->GetType()));
+  }
+  args[0] = fb.Add(args[0],
+                   fb.Literal(UBits(offset, body->param(0)->BitCountOrDie())));
+  fb.Invoke(args, body);
+  return fb.Build();
+}
+
+// Unrolls the node "loop" one iteration at a time, inlining and simplifying
+// each iteration (if the body allows it) before unrolling the next. Once the
+// unrolled iterations have added `node_budget` or more nodes to the function
+// the remaining iterations are left as a new counted for which is returned.
+// Returns nullptr if the loop is fully unrolled.
+absl::StatusOr<CountedFor*> UnrollCountedForWithBudget(CountedFor* loop,
+                                                       int64_t node_budget) {
+  FunctionBase* f = loop->function_base();
+  bool inline_iterations = CanInlineIterations(loop->body());
+  Node* loop_carry = loop->initial_value();
+  int64_t ivar_bit_count = loop->body()->params()[0]->BitCountOrDie();
+  int64_t initial_node_count = f->node_count();
+  int64_t trip = 0;
+  int64_t iv = 0;
+  for (; trip < loop->trip_count(); ++trip, iv += loop->stride()) {
+    if (trip > 0 && f->node_count() - initial_node_count >= node_budget) {
+      break;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        Literal * iv_node,
+        f->MakeNode<Literal>(loop->loc(), Value(UBits(iv, ivar_bit_count))));
+    std::vector<Node*> args = {iv_node, loop_carry};
+    for (Node* invariant_arg : loop->invariant_args()) {
+      args.push_back(invariant_arg);
+    }
+    if (inline_iterations) {
+      XLS_ASSIGN_OR_RETURN(loop_carry, InlineIteration(loop, args));
+      if (iv_node != loop_carry && iv_node->users().empty()) {
+        XLS_RETURN_IF_ERROR(f->RemoveNode(iv_node));
+      }
+    } else {
+      XLS_ASSIGN_OR_RETURN(
+          loop_carry, f->MakeNode<Invoke>(loop->loc(), absl::MakeSpan(args),
+                                          loop->body()));
+    }
+  }
+  CountedFor* remaining = nullptr;
+  Node* result = loop_carry;
+  if (trip < loop->trip_count()) {
+    VLOG(2) << absl::StreamFormat(
+        "Unrolled %d of %d iterations of %s within a budget of %d nodes", trip,
+        loop->trip_count(), loop->GetName(), node_budget);
+    XLS_ASSIGN_OR_RETURN(Function * offset_body, MakeOffsetBody(loop, iv));
+    XLS_ASSIGN_OR_RETURN(
+        remaining, f->MakeNode<CountedFor>(
+                       loop->loc(), loop_carry, loop->invariant_args(),
+                       loop->trip_count() - trip, loop->stride(), offset_body));
+    result = remaining;
+  }
+  XLS_RETURN_IF_ERROR(loop->ReplaceUsesWith(result));
+  XLS_RETURN_IF_ERROR(f->RemoveNode(loop));
+  return remaining;
+}
+
 }  // namespace
 
 absl::StatusOr<bool> UnrollPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
   bool changed = false;
+  // Partially unrolled loops which are not unrolled further by this run.
+  absl::flat_hash_set<Node*> remaining_loops;
   while (true) {
-    CountedFor* loop = FindCountedFor(f);
+    CountedFor* loop = FindCountedFor(f, remaining_loops);
     if (loop == nullptr) {
       break;
     }
-    XLS_RETURN_IF_ERROR(UnrollCountedFor(loop));
+    if (options.unroll_node_budget.has_value()) {
+      XLS_ASSIGN_OR_RETURN(
+          CountedFor * remaining,
+          UnrollCountedForWithBudget(loop, *options.unroll_node_budget));
+      if (remaining != nullptr) {
+        remaining_loops.insert(remaining);
+      }
+    } else {
+      XLS_RETURN_IF_ERROR(UnrollCountedFor(loop));
+    }
     changed = true;
   }
   return changed;
@@ -20,8 +20,11 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/optimization_pass.h"
 
@@ -61,5 +64,70 @@ fn unrollable() -> bits[32] {
                         m::Literal(0)));
 }
 
+TEST(UnrollPassTest, UnrollWithBudgetFoldsIterations) {
+  const std::string program = R"(
+package some_package
+
+fn body(i: bits[4], accum: bits[32], zero: bits[32]) -> bits[32] {
+  zero_ext.3: bits[32] = zero_ext(i, new_bit_count=32)
+  add.4: bits[32] = add(zero_ext.3, accum)
+  ret add.5: bits[32] = add(add.4, zero)
+}
+
+fn unrollable() -> bits[32] {
+  literal.1: bits[32] = literal(value=0)
+  ret counted_for.2: bits[32] = counted_for(literal.1, trip_count=3, stride=2, body=body, invariant_args=[literal.1])
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  PassResults results;
+  OptimizationPassOptions options;
+  options.unroll_node_budget = 1000;
+  EXPECT_THAT(UnrollPass().RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+  // Every iteration is computed from literals so the loop folds entirely.
+  EXPECT_THAT(f->return_value(), m::Literal(6));
+}
+
+TEST(UnrollPassTest, UnrollWithBudgetLeavesRemainingIterations) {
+  const std::string program = R"(
+package some_package
+
+fn body(i: bits[4], accum: bits[32]) -> bits[32] {
+  zero_ext.3: bits[32] = zero_ext(i, new_bit_count=32)
+  ret add.4: bits[32] = add(zero_ext.3, accum)
+}
+
+fn unrollable(x: bits[32]) -> bits[32] {
+  ret counted_for.2: bits[32] = counted_for(x, trip_count=8, stride=1, body=body)
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(program));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  PassResults results;
+  OptimizationPassOptions options;
+  // Each inlined iteration adds two nodes: the folded zero_ext and the add.
+  options.unroll_node_budget = 5;
+  EXPECT_THAT(UnrollPass().RunOnFunctionBase(f, options, &results),
+              IsOkAndHolds(true));
+  EXPECT_THAT(
+      f->return_value(),
+      m::CountedFor(m::Add(m::Literal(2),
+                           m::Add(m::Literal(1),
+                                  m::Add(m::Literal(0), m::Param("x"))))));
+  CountedFor* remaining = f->return_value()->As<CountedFor>();
+  EXPECT_EQ(remaining->trip_count(), 5);
+  EXPECT_EQ(remaining->stride(), 1);
+  EXPECT_EQ(remaining->body()->name(), "body__offset_3");
+  EXPECT_THAT(remaining->body()->return_value(),
+              m::Invoke(m::Add(m::Param("i"), m::Literal(3)),
+                        m::Param("accum")));
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,16 +14,157 @@
 
 #include "xls/passes/verifier_checker.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/change_listener.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
 #include "xls/ir/verifier.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
 
 namespace xls {
 
+// Records the nodes of a FunctionBase which were added or had their operands
+// changed since the last call to TakeChangedNodes.
+class VerifierChecker::ChangeRecorder : public ChangeListener {
+ public:
+  explicit ChangeRecorder(FunctionBase* f) : f_(f) {
+    f_->RegisterChangeListener(this);
+  }
+
+  ~ChangeRecorder() override {
+    if (f_ != nullptr) {
+      f_->UnregisterChangeListener(this);
+    }
+  }
+
+  // Returns whether the function has been destroyed.
+  bool is_dead() const { return f_ == nullptr; }
+
+  // Returns the changed nodes in ID order and clears the record.
+  std::vector<Node*> TakeChangedNodes() {
+    std::vector<Node*> changed(changed_nodes_.begin(), changed_nodes_.end());
+    changed_nodes_.clear();
+    std::sort(changed.begin(), changed.end(), Node::NodeIdLessThan());
+    return changed;
+  }
+
+  void NodeAdded(Node* node) override { changed_nodes_.insert(node); }
+
+  void NodeDeleted(Node* node) override { changed_nodes_.erase(node); }
+
+  void OperandChanged(Node* node, Node* old_operand) override {
+    changed_nodes_.insert(node);
+  }
+
+  void OperandAdded(Node* node) override { changed_nodes_.insert(node); }
+
+  void FunctionBaseDeleted(FunctionBase* function_base) override {
+    CHECK_EQ(function_base, f_);
+    f_ = nullptr;
+  }
+
+ private:
+  FunctionBase* f_;
+  absl::flat_hash_set<Node*> changed_nodes_;
+};
+
+namespace {
+
+absl::Status VerifyFunctionBase(FunctionBase* f) {
+  if (f->IsFunction()) {
+    return VerifyFunction(f->AsFunctionOrDie());
+  }
+  if (f->IsProc()) {
+    return VerifyProc(f->AsProcOrDie());
+  }
+  return VerifyBlock(f->AsBlockOrDie());
+}
+
+}  // namespace
+
+VerifierChecker::VerifierChecker() = default;
+
+VerifierChecker::~VerifierChecker() = default;
+
 absl::Status VerifierChecker::Run(Package* p,
                                   const OptimizationPassOptions& options,
                                   PassResults* results) const {
-  return VerifyPackage(p);
+  if (!options.incremental_verification_interval.has_value()) {
+    return VerifyPackage(p);
+  }
+  XLS_RET_CHECK_GT(*options.incremental_verification_interval, 0);
+  return RunIncremental(p, *options.incremental_verification_interval);
+}
+
+absl::Status VerifierChecker::RunIncremental(Package* p,
+                                             int64_t interval) const {
+  absl::MutexLock lock(&mutex_);
+  std::vector<FunctionBase*> function_bases = p->GetFunctionBases();
+  // Drop the recorders of destroyed FunctionBases; a new FunctionBase may be
+  // allocated at the same address.
+  absl::erase_if(recorders_,
+                 [](const auto& pair) { return pair.second->is_dead(); });
+
+  bool verify_everything = run_count_ % interval == 0;
+  ++run_count_;
+  if (verify_everything) {
+    VLOG(3) << "Verifying entire package " << p->name();
+    XLS_RETURN_IF_ERROR(VerifyPackage(p));
+    for (FunctionBase* f : function_bases) {
+      std::unique_ptr<ChangeRecorder>& recorder = recorders_[f];
+      if (recorder == nullptr) {
+        recorder = std::make_unique<ChangeRecorder>(f);
+      } else {
+        recorder->TakeChangedNodes();
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  absl::flat_hash_set<std::string_view> names;
+  for (FunctionBase* f : function_bases) {
+    if (!names.insert(f->name()).second) {
+      return absl::InternalError(absl::StrFormat(
+          "Function/proc/block with name %s is not unique within package %s",
+          f->name(), p->name()));
+    }
+    std::unique_ptr<ChangeRecorder>& recorder = recorders_[f];
+    if (recorder == nullptr) {
+      // New since the previous run.
+      recorder = std::make_unique<ChangeRecorder>(f);
+      XLS_RETURN_IF_ERROR(VerifyFunctionBase(f));
+      continue;
+    }
+    std::vector<Node*> changed = recorder->TakeChangedNodes();
+    if (changed.empty()) {
+      continue;
+    }
+    VLOG(3) << absl::StreamFormat("Verifying %d changed nodes of %s",
+                                  changed.size(), f->name());
+    if (f->IsFunction()) {
+      XLS_RETURN_IF_ERROR(VerifyChangedNodes(f, changed));
+    } else {
+      // Proc and block invariants (state, registers, ports) span the whole
+      // FunctionBase so a changed proc or block is verified in its entirety.
+      XLS_RETURN_IF_ERROR(VerifyFunctionBase(f));
+    }
+  }
+  return absl::OkStatus();
 }
 
 }  // namespace xls
@@ -15,16 +15,49 @@
 #ifndef XLS_PASSES_VERIFIER_CHECKER_H_
 #define XLS_PASSES_VERIFIER_CHECKER_H_
 
+#include <cstdint>
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/package.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
 
 namespace xls {
 
-// Invariant checker which just runs xls::Verifier.
+// Verifies the package between passes.
+//
+// By default the entire package is verified on every run. If
+// OptimizationPassOptions::incremental_verification_interval is set, the
+// checker instead records the nodes added or changed in each FunctionBase
+// (with a ChangeListener) and verifies only those, along with the procs and
+// blocks which changed and the FunctionBases new since the previous run. The
+// entire package is still verified on the first run and every
+// `incremental_verification_interval` runs thereafter, which catches the
+// invariants which are not checked incrementally (such as the absence of
+// cycles and the uniqueness of node IDs).
 class VerifierChecker : public OptimizationInvariantChecker {
  public:
+  VerifierChecker();
+  ~VerifierChecker() override;
+
   absl::Status Run(Package* p, const OptimizationPassOptions& options,
                    PassResults* results) const override;
+
+ private:
+  class ChangeRecorder;
+
+  absl::Status RunIncremental(Package* p, int64_t interval) const;
+
+  mutable absl::Mutex mutex_;
+  // The number of incremental-mode runs so far.
+  mutable int64_t run_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  mutable absl::flat_hash_map<FunctionBase*, std::unique_ptr<ChangeRecorder>>
+      recorders_ ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace xls
@@ -0,0 +1,107 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/verifier_checker.h"
+
+#include <cstdint>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+class VerifierCheckerTest : public IrTestBase {
+ protected:
+  absl::Status Check(const VerifierChecker& checker, Package* p,
+                     int64_t interval) {
+    OptimizationPassOptions options;
+    options.incremental_verification_interval = interval;
+    PassResults results;
+    return checker.Run(p, options, &results);
+  }
+};
+
+TEST_F(VerifierCheckerTest, IncrementalCatchesBadOperandChange) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package p
+
+top fn main(x: bits[8], y: bits[16]) -> bits[8] {
+  ret neg.1: bits[8] = neg(x)
+}
+)"));
+  VerifierChecker checker;
+  XLS_ASSERT_OK(Check(checker, p.get(), 100));
+  XLS_ASSERT_OK(Check(checker, p.get(), 100));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetTopAsFunction());
+  XLS_ASSERT_OK(f->return_value()->ReplaceOperandNumber(
+      0, FindNode("y", f), /*type_must_match=*/false));
+  EXPECT_THAT(Check(checker, p.get(), 100),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
+TEST_F(VerifierCheckerTest, IncrementalVerifiesEntirePackagePeriodically) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package p
+
+top fn main(x: bits[8]) -> bits[8] {
+  neg.1: bits[8] = neg(x)
+  ret not.2: bits[8] = not(neg.1)
+}
+)"));
+  VerifierChecker checker;
+  XLS_ASSERT_OK(Check(checker, p.get(), 3));
+
+  // A cycle is not visible to incremental verification of the changed node.
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetTopAsFunction());
+  XLS_ASSERT_OK(
+      FindNode("neg.1", f)->ReplaceOperandNumber(0, FindNode("not.2", f)));
+  XLS_EXPECT_OK(Check(checker, p.get(), 3));
+  XLS_EXPECT_OK(Check(checker, p.get(), 3));
+  EXPECT_THAT(
+      Check(checker, p.get(), 3),
+      StatusIs(absl::StatusCode::kInternal, HasSubstr("Cycle detected")));
+}
+
+TEST_F(VerifierCheckerTest, NewFunctionsAreVerified) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package p
+
+top fn main(x: bits[8]) -> bits[8] {
+  ret neg.1: bits[8] = neg(x)
+}
+)"));
+  VerifierChecker checker;
+  XLS_ASSERT_OK(Check(checker, p.get(), 100));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetTopAsFunction());
+  XLS_ASSERT_OK(f->Clone("main", p.get()).status());
+  EXPECT_THAT(Check(checker, p.get(), 100),
+              StatusIs(absl::StatusCode::kInternal, HasSubstr("not unique")));
+}
+
+}  // namespace
+}  // namespace xls
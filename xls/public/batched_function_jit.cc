@@ -0,0 +1,135 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/public/batched_function_jit.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/jit/function_jit.h"
+
+namespace xls {
+namespace {
+
+absl::Status CheckIndex(const BatchedBufferLayout& layout, int64_t index,
+                        int64_t buffer_size) {
+  if (index < 0 || layout.BufferSize(index + 1) > buffer_size) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Value %d does not fit in a buffer of %d bytes with a stride of %d",
+        index, buffer_size, layout.stride));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<BatchedFunctionJit>>
+BatchedFunctionJit::Create(Function* function, int64_t opt_level) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                       FunctionJit::Create(function, opt_level));
+  XLS_RET_CHECK(jit->jitted_function_base().HasBatchedFunction());
+  std::vector<BatchedBufferLayout> arg_layouts;
+  arg_layouts.reserve(function->params().size());
+  for (int64_t i = 0; i < function->params().size(); ++i) {
+    arg_layouts.push_back(BatchedBufferLayout{
+        .type_layout =
+            jit->runtime()->CreateTypeLayout(function->param(i)->GetType()),
+        .stride = jit->GetArgTypeSize(i),
+        .alignment = jit->GetArgTypeAlignment(i)});
+  }
+  BatchedBufferLayout result_layout{
+      .type_layout = jit->runtime()->CreateTypeLayout(
+          function->return_value()->GetType()),
+      .stride = jit->GetReturnTypeSize(),
+      .alignment = jit->GetReturnTypeAlignment()};
+  return absl::WrapUnique(new BatchedFunctionJit(
+      std::move(jit), std::move(arg_layouts), std::move(result_layout)));
+}
+
+absl::Status BatchedFunctionJit::Run(
+    int64_t count, absl::Span<const absl::Span<const uint8_t>> args,
+    absl::Span<uint8_t> result) {
+  if (count < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid batch size %d", count));
+  }
+  if (args.size() != arg_layouts_.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected %d argument buffers, got %d",
+                        arg_layouts_.size(), args.size()));
+  }
+  for (int64_t i = 0; i < args.size(); ++i) {
+    if (args[i].size() < arg_layouts_[i].BufferSize(count)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Argument %d buffer is too small - must be at least %d bytes", i,
+          arg_layouts_[i].BufferSize(count)));
+    }
+  }
+  if (result.size() < result_layout_.BufferSize(count)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Result buffer is too small - must be at least %d bytes",
+        result_layout_.BufferSize(count)));
+  }
+  if (count == 0) {
+    return absl::OkStatus();
+  }
+
+  // The jitted code does not write to its arguments.
+  std::vector<uint8_t*> arg_buffers;
+  arg_buffers.reserve(args.size());
+  for (absl::Span<const uint8_t> arg : args) {
+    arg_buffers.push_back(const_cast<uint8_t*>(arg.data()));
+  }
+  InterpreterEvents events;
+  XLS_RETURN_IF_ERROR(
+      jit_->RunBatchedWithViews(count, arg_buffers, result, &events));
+  return InterpreterEventsToStatus(events);
+}
+
+/* static */ absl::Status BatchedFunctionJit::WriteValue(
+    const BatchedBufferLayout& layout, const Value& value, int64_t index,
+    absl::Span<uint8_t> buffer) {
+  if (!ValueConformsToType(value, layout.type_layout.type())) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Value %s does not have type %s", value.ToString(),
+                        layout.type_layout.type()->ToString()));
+  }
+  XLS_RETURN_IF_ERROR(CheckIndex(layout, index, buffer.size()));
+  layout.type_layout.ValueToNativeLayout(
+      value, buffer.data() + index * layout.stride);
+  return absl::OkStatus();
+}
+
+/* static */ absl::StatusOr<Value> BatchedFunctionJit::ReadValue(
+    const BatchedBufferLayout& layout, int64_t index,
+    absl::Span<const uint8_t> buffer) {
+  XLS_RETURN_IF_ERROR(CheckIndex(layout, index, buffer.size()));
+  return layout.type_layout.NativeLayoutToValue(buffer.data() +
+                                                index * layout.stride);
+}
+
+}  // namespace xls
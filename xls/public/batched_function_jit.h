@@ -0,0 +1,109 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PUBLIC_BATCHED_FUNCTION_JIT_H_
+#define XLS_PUBLIC_BATCHED_FUNCTION_JIT_H_
+
+// Exposes JIT evaluation of an XLS function over many argument sets at once.
+//
+// The function is compiled once. Each call to Run() then evaluates it over
+// caller-owned buffers which hold the arguments and results of all evaluations
+// in the JIT's native data layout, so nothing is converted to or from Value
+// objects. The layout of each buffer is described by a BatchedBufferLayout,
+// which language bindings can use to read and write the buffers directly.
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/function.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+
+// The layout of the buffer holding one argument (or the result) of all the
+// evaluations in a batch. The value of evaluation j starts at byte offset
+// j * stride and is laid out as described by `type_layout`: each leaf (bits)
+// element of the type occupies `data_size` little-endian bytes at `offset`
+// within the value, zero-padded to `padded_size` bytes.
+struct BatchedBufferLayout {
+  TypeLayout type_layout;
+
+  // The distance in bytes between consecutive values of the batch.
+  int64_t stride;
+
+  // The alignment in bytes required of the start of the buffer.
+  int64_t alignment;
+
+  // Returns the number of bytes needed to hold `count` values.
+  int64_t BufferSize(int64_t count) const { return count * stride; }
+};
+
+class BatchedFunctionJit {
+ public:
+  // Compiles `function` for batched evaluation.
+  static absl::StatusOr<std::unique_ptr<BatchedFunctionJit>> Create(
+      Function* function, int64_t opt_level = 3);
+
+  // The layouts of the argument buffers, one per parameter of the function,
+  // and of the result buffer.
+  absl::Span<const BatchedBufferLayout> arg_layouts() const {
+    return arg_layouts_;
+  }
+  const BatchedBufferLayout& result_layout() const { return result_layout_; }
+
+  // Evaluates the function `count` times. `args[i]` holds the `count` values of
+  // the i-th parameter and `result` receives the `count` return values, each
+  // laid out as described by arg_layouts()[i] and result_layout() respectively.
+  // Returns an error if any evaluation fails an assertion; other events such as
+  // traces are discarded.
+  absl::Status Run(int64_t count,
+                   absl::Span<const absl::Span<const uint8_t>> args,
+                   absl::Span<uint8_t> result);
+
+  // Writes `value` as the `index`-th value of a buffer with the given layout.
+  static absl::Status WriteValue(const BatchedBufferLayout& layout,
+                                 const Value& value, int64_t index,
+                                 absl::Span<uint8_t> buffer);
+
+  // Returns the `index`-th value of a buffer with the given layout.
+  static absl::StatusOr<Value> ReadValue(const BatchedBufferLayout& layout,
+                                         int64_t index,
+                                         absl::Span<const uint8_t> buffer);
+
+  Function* function() const { return jit_->function(); }
+
+ private:
+  BatchedFunctionJit(std::unique_ptr<FunctionJit> jit,
+                     std::vector<BatchedBufferLayout> arg_layouts,
+                     BatchedBufferLayout result_layout)
+      : jit_(std::move(jit)),
+        arg_layouts_(std::move(arg_layouts)),
+        result_layout_(std::move(result_layout)) {}
+
+  std::unique_ptr<FunctionJit> jit_;
+  std::vector<BatchedBufferLayout> arg_layouts_;
+  BatchedBufferLayout result_layout_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PUBLIC_BATCHED_FUNCTION_JIT_H_
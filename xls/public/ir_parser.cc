@@ -16,9 +16,11 @@
 
 #include <memory>
 #include <optional>
+#include <string>
 #include <string_view>
 
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/package_serialization.h"
 
 namespace xls {
 
@@ -32,4 +34,13 @@ absl::StatusOr<Function*> ParseFunctionIntoPackage(
   return Parser::ParseFunction(function_string, package);
 }
 
+absl::StatusOr<std::unique_ptr<Package>> ParsePackageFromBinary(
+    std::string_view bytes) {
+  return DeserializePackage(bytes);
+}
+
+absl::StatusOr<std::string> SerializePackageToBinary(Package* package) {
+  return SerializePackage(package);
+}
+
 }  // namespace xls
@@ -17,6 +17,7 @@
 
 #include <memory>
 #include <optional>
+#include <string>
 #include <string_view>
 
 #include "absl/status/statusor.h"
@@ -48,6 +49,18 @@ absl::StatusOr<std::unique_ptr<Package>> ParsePackage(
 absl::StatusOr<Function*> ParseFunctionIntoPackage(
     std::string_view function_string, Package* package);
 
+// Parses a package from the compact binary form produced by
+// SerializePackageToBinary. This is much faster than parsing IR text for
+// large packages and is the preferred way to hand IR between tools of the
+// same XLS version.
+absl::StatusOr<std::unique_ptr<Package>> ParsePackageFromBinary(
+    std::string_view bytes);
+
+// Serializes the given package into a compact binary form which
+// ParsePackageFromBinary reads back into an identical package. Only packages
+// made up of functions are currently supported.
+absl::StatusOr<std::string> SerializePackageToBinary(Package* package);
+
 }  // namespace xls
 
 #endif  // XLS_PUBLIC_IR_PARSER_H_
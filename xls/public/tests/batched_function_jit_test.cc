@@ -0,0 +1,166 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/public/batched_function_jit.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "xls/public/function_builder.h"
+#include "xls/public/status_matchers.h"
+#include "xls/public/value.h"
+
+namespace {
+
+using ::testing::HasSubstr;
+using ::xls::status_testing::IsOkAndHolds;
+using ::xls::status_testing::StatusIs;
+
+// A buffer of `size` bytes aligned to `alignment`.
+class AlignedBuffer {
+ public:
+  AlignedBuffer(int64_t size, int64_t alignment)
+      : storage_(size + alignment) {
+    int64_t misalignment =
+        reinterpret_cast<uintptr_t>(storage_.data()) % alignment;
+    offset_ = misalignment == 0 ? 0 : alignment - misalignment;
+    size_ = size;
+  }
+
+  absl::Span<uint8_t> span() {
+    return absl::MakeSpan(storage_.data() + offset_, size_);
+  }
+
+ private:
+  std::vector<uint8_t> storage_;
+  int64_t offset_;
+  int64_t size_;
+};
+
+TEST(BatchedFunctionJitTest, AddWithRawBuffers) {
+  xls::Package package("test_package");
+  xls::FunctionBuilder builder("f", &package);
+  xls::BitsType* b32 = package.GetBitsType(32);
+  builder.Add(builder.Param("x", b32), builder.Param("y", b32));
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * f, builder.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<xls::BatchedFunctionJit> jit,
+                           xls::BatchedFunctionJit::Create(f));
+
+  ASSERT_EQ(jit->arg_layouts().size(), 2);
+  const xls::BatchedBufferLayout& layout = jit->arg_layouts()[0];
+  EXPECT_EQ(layout.stride, 4);
+  ASSERT_EQ(layout.type_layout.elements().size(), 1);
+  EXPECT_EQ(layout.type_layout.elements()[0].offset, 0);
+  EXPECT_EQ(layout.type_layout.elements()[0].data_size, 4);
+  EXPECT_EQ(jit->result_layout().stride, 4);
+
+  // Write the arguments directly as a binding would.
+  constexpr int64_t kCount = 1000;
+  AlignedBuffer x(kCount * 4, layout.alignment);
+  AlignedBuffer y(kCount * 4, layout.alignment);
+  AlignedBuffer result(kCount * 4, jit->result_layout().alignment);
+  for (uint32_t i = 0; i < kCount; ++i) {
+    uint32_t x_value = i;
+    uint32_t y_value = 3 * i + 0xfffff000;
+    std::memcpy(x.span().data() + 4 * i, &x_value, 4);
+    std::memcpy(y.span().data() + 4 * i, &y_value, 4);
+  }
+  XLS_ASSERT_OK(jit->Run(kCount, {x.span(), y.span()}, result.span()));
+  for (uint32_t i = 0; i < kCount; ++i) {
+    uint32_t result_value;
+    std::memcpy(&result_value, result.span().data() + 4 * i, 4);
+    EXPECT_EQ(result_value, i + 3 * i + 0xfffff000);
+  }
+}
+
+TEST(BatchedFunctionJitTest, TupleWithValueHelpers) {
+  xls::Package package("test_package");
+  xls::FunctionBuilder builder("f", &package);
+  xls::BValue x = builder.Param("x", package.GetBitsType(7));
+  xls::BValue y = builder.Param("y", package.GetBitsType(40));
+  builder.Tuple({builder.ZeroExtend(x, 40), builder.Not(y)});
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * f, builder.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<xls::BatchedFunctionJit> jit,
+                           xls::BatchedFunctionJit::Create(f));
+
+  constexpr int64_t kCount = 17;
+  const xls::BatchedBufferLayout& x_layout = jit->arg_layouts()[0];
+  const xls::BatchedBufferLayout& y_layout = jit->arg_layouts()[1];
+  const xls::BatchedBufferLayout& result_layout = jit->result_layout();
+  EXPECT_EQ(result_layout.type_layout.elements().size(), 2);
+  AlignedBuffer x_buffer(x_layout.BufferSize(kCount), x_layout.alignment);
+  AlignedBuffer y_buffer(y_layout.BufferSize(kCount), y_layout.alignment);
+  AlignedBuffer result_buffer(result_layout.BufferSize(kCount),
+                              result_layout.alignment);
+  for (int64_t i = 0; i < kCount; ++i) {
+    XLS_ASSERT_OK(xls::BatchedFunctionJit::WriteValue(
+        x_layout, xls::Value(xls::UBits(i, 7)), i, x_buffer.span()));
+    XLS_ASSERT_OK(xls::BatchedFunctionJit::WriteValue(
+        y_layout, xls::Value(xls::UBits(i << 20, 40)), i, y_buffer.span()));
+  }
+  XLS_ASSERT_OK(jit->Run(kCount, {x_buffer.span(), y_buffer.span()},
+                         result_buffer.span()));
+  for (int64_t i = 0; i < kCount; ++i) {
+    EXPECT_THAT(
+        xls::BatchedFunctionJit::ReadValue(result_layout, i,
+                                           result_buffer.span()),
+        IsOkAndHolds(xls::Value::Tuple(
+            {xls::Value(xls::UBits(i, 40)),
+             xls::Value(xls::bits_ops::Not(xls::UBits(i << 20, 40)))})));
+  }
+}
+
+TEST(BatchedFunctionJitTest, Errors) {
+  xls::Package package("test_package");
+  xls::FunctionBuilder builder("f", &package);
+  xls::BitsType* b32 = package.GetBitsType(32);
+  builder.Negate(builder.Param("x", b32));
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * f, builder.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<xls::BatchedFunctionJit> jit,
+                           xls::BatchedFunctionJit::Create(f));
+  const xls::BatchedBufferLayout& layout = jit->arg_layouts()[0];
+  AlignedBuffer x(layout.BufferSize(4), layout.alignment);
+  AlignedBuffer result(layout.BufferSize(4), layout.alignment);
+
+  EXPECT_THAT(jit->Run(4, {}, result.span()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Expected 1 argument buffers")));
+  EXPECT_THAT(jit->Run(5, {x.span()}, result.span()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Argument 0 buffer is too small")));
+  EXPECT_THAT(jit->Run(4, {x.span()}, result.span().subspan(4)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Result buffer is too small")));
+  XLS_EXPECT_OK(jit->Run(0, {x.span()}, result.span()));
+
+  EXPECT_THAT(xls::BatchedFunctionJit::WriteValue(
+                  layout, xls::Value(xls::UBits(1, 8)), 0, x.span()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("does not have type bits[32]")));
+  EXPECT_THAT(xls::BatchedFunctionJit::WriteValue(
+                  layout, xls::Value(xls::UBits(1, 32)), 4, x.span()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("does not fit")));
+  EXPECT_THAT(xls::BatchedFunctionJit::ReadValue(layout, -1, x.span()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("does not fit")));
+}
+
+}  // namespace
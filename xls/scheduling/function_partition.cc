@@ -14,22 +14,29 @@
 
 #include "xls/scheduling/function_partition.h"
 
+#include <cstdint>
 #include <limits>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/types/span.h"
 #include "xls/data_structures/min_cut.h"
+#include "xls/data_structures/union_find.h"
 #include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/topo_sort.h"
 
 namespace xls {
 namespace sched {
 
 std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
-    FunctionBase* f, absl::Span<Node* const> partitionable_nodes) {
+    FunctionBase* f, absl::Span<Node* const> partitionable_nodes,
+    min_cut::MaxFlowAlgorithm max_flow_algorithm) {
   if (VLOG_IS_ON(4)) {
     VLOG(4) << "Computing min-cut of function " << f->name()
             << ", partitionable nodes:";
@@ -164,7 +171,7 @@ std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
   }
 
   min_cut::GraphCut graph_cut =
-      min_cut::MinCutBetweenNodes(graph, source, sink);
+      min_cut::MinCutBetweenNodes(graph, source, sink, max_flow_algorithm);
 
   // Map the mincut graph partition back to the XLS graph.
   std::pair<std::vector<Node*>, std::vector<Node*>> partitions;
@@ -197,5 +204,99 @@ std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
   return partitions;
 }
 
+RegionPartition PartitionIntoRegions(FunctionBase* f,
+                                     absl::Span<Node* const> separators,
+                                     int64_t max_region_size) {
+  CHECK_GT(max_region_size, 0);
+  RegionPartition partition;
+  partition.separators.insert(separators.begin(), separators.end());
+
+  std::vector<Node*> topo_sort = TopoSort(f);
+  absl::flat_hash_map<Node*, int64_t> topo_index;
+  topo_index.reserve(topo_sort.size());
+  for (int64_t i = 0; i < topo_sort.size(); ++i) {
+    topo_index[topo_sort[i]] = i;
+  }
+
+  // Find the connected components of the graph without the separators.
+  DenseUnionFind union_find(topo_sort.size());
+  for (Node* node : topo_sort) {
+    if (partition.separators.contains(node)) {
+      continue;
+    }
+    for (Node* operand : node->operands()) {
+      if (!partition.separators.contains(operand)) {
+        union_find.Union(topo_index.at(node), topo_index.at(operand));
+      }
+    }
+  }
+  absl::flat_hash_map<int64_t, int64_t> component_of_representative;
+  std::vector<std::vector<Node*>> components;
+  for (Node* node : topo_sort) {
+    if (partition.separators.contains(node)) {
+      continue;
+    }
+    auto [it, inserted] = component_of_representative.try_emplace(
+        union_find.Find(topo_index.at(node)), components.size());
+    if (inserted) {
+      components.emplace_back();
+    }
+    components[it->second].push_back(node);
+  }
+
+  // Split the components which are too large into chunks. Once every node with
+  // a user in a later chunk is a separator no edge connects two chunks.
+  std::vector<std::vector<Node*>> pieces;
+  for (std::vector<Node*>& component : components) {
+    if (component.size() <= max_region_size) {
+      pieces.push_back(std::move(component));
+      continue;
+    }
+    absl::flat_hash_map<Node*, int64_t> chunk_of_node;
+    chunk_of_node.reserve(component.size());
+    for (int64_t i = 0; i < component.size(); ++i) {
+      chunk_of_node[component[i]] = i / max_region_size;
+    }
+    for (Node* node : component) {
+      for (Node* user : node->users()) {
+        auto it = chunk_of_node.find(user);
+        if (it != chunk_of_node.end() &&
+            it->second != chunk_of_node.at(node)) {
+          partition.separators.insert(node);
+          break;
+        }
+      }
+    }
+    std::vector<std::vector<Node*>> chunks(
+        (component.size() + max_region_size - 1) / max_region_size);
+    for (Node* node : component) {
+      if (!partition.separators.contains(node)) {
+        chunks[chunk_of_node.at(node)].push_back(node);
+      }
+    }
+    for (std::vector<Node*>& chunk : chunks) {
+      if (!chunk.empty()) {
+        pieces.push_back(std::move(chunk));
+      }
+    }
+  }
+
+  // Pack the pieces into regions.
+  for (std::vector<Node*>& piece : pieces) {
+    if (partition.regions.empty() ||
+        partition.regions.back().size() + piece.size() > max_region_size) {
+      partition.regions.emplace_back();
+    }
+    partition.regions.back().insert(partition.regions.back().end(),
+                                    piece.begin(), piece.end());
+  }
+  for (std::vector<Node*>& region : partition.regions) {
+    absl::c_sort(region, [&](Node* a, Node* b) {
+      return topo_index.at(a) < topo_index.at(b);
+    });
+  }
+  return partition;
+}
+
 }  // namespace sched
 }  // namespace xls
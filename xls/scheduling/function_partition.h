@@ -15,10 +15,13 @@
 #ifndef XLS_SCHEDULING_FUNCTION_PARTITION_H_
 #define XLS_SCHEDULING_FUNCTION_PARTITION_H_
 
+#include <cstdint>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/types/span.h"
+#include "xls/data_structures/min_cut.h"
 #include "xls/ir/function.h"
 #include "xls/ir/node.h"
 
@@ -53,8 +56,32 @@ namespace sched {
 //
 // Returns the two partitions as a std::pair. The first element is the
 // predecessor partition of the dicut (partition A in the example above).
+//
+// 'max_flow_algorithm' selects the algorithm used to compute the cut. All
+// algorithms return the same partition.
 std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
-    FunctionBase* f, absl::Span<Node* const> partitionable_nodes);
+    FunctionBase* f, absl::Span<Node* const> partitionable_nodes,
+    min_cut::MaxFlowAlgorithm max_flow_algorithm =
+        min_cut::MaxFlowAlgorithm::kPushRelabel);
+
+// A division of the nodes of a function into separators and regions such that
+// no edge connects nodes of two different regions: every path between regions
+// passes through a separator.
+struct RegionPartition {
+  // The nodes of each region in topological order.
+  std::vector<std::vector<Node*>> regions;
+  absl::flat_hash_set<Node*> separators;
+};
+
+// Partitions the nodes of `f` which are not in `separators` into regions of
+// at most `max_region_size` nodes. The connected components of the graph
+// remaining after removing the separators are packed into regions whole.
+// Components larger than `max_region_size` are split into chunks which are
+// contiguous in a topological order, and each node with a user in a later
+// chunk is made a separator. The returned separators include `separators`.
+RegionPartition PartitionIntoRegions(FunctionBase* f,
+                                     absl::Span<Node* const> separators,
+                                     int64_t max_region_size);
 
 }  // namespace sched
 }  // namespace xls
@@ -24,6 +24,7 @@
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
 #include "xls/common/status/matchers.h"
+#include "xls/data_structures/min_cut.h"
 #include "xls/examples/sample_packages.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
@@ -33,6 +34,7 @@ namespace xls {
 namespace sched {
 namespace {
 
+using testing::ElementsAre;
 using testing::UnorderedElementsAre;
 
 class FunctionPartitionTest : public IrTestBase {
@@ -155,6 +157,60 @@ TEST_F(FunctionPartitionTest, DisconnectedGraph) {
               UnorderedElementsAre(literal.node(), not_literal.node()));
 }
 
+TEST_F(FunctionPartitionTest, RegionsOfIndependentLanes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto not_x = fb.Not(x);
+  auto neg_x = fb.Negate(not_x);
+  auto not_y = fb.Not(y);
+  auto neg_y = fb.Negate(not_y);
+  auto result = fb.Tuple({neg_x, neg_y});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  std::vector<Node*> separators = {x.node(), y.node(), result.node()};
+  {
+    RegionPartition partition =
+        PartitionIntoRegions(f, separators, /*max_region_size=*/2);
+    EXPECT_THAT(partition.separators,
+                UnorderedElementsAre(x.node(), y.node(), result.node()));
+    EXPECT_THAT(partition.regions,
+                UnorderedElementsAre(ElementsAre(not_x.node(), neg_x.node()),
+                                     ElementsAre(not_y.node(), neg_y.node())));
+  }
+
+  {
+    // Both lanes fit in a single region.
+    RegionPartition partition =
+        PartitionIntoRegions(f, separators, /*max_region_size=*/4);
+    ASSERT_EQ(partition.regions.size(), 1);
+    EXPECT_THAT(partition.regions[0],
+                UnorderedElementsAre(not_x.node(), neg_x.node(), not_y.node(),
+                                     neg_y.node()));
+  }
+}
+
+TEST_F(FunctionPartitionTest, SplitLargeRegion) {
+  // A chain of three negates is too large for a region of two nodes, so the
+  // second negate becomes a separator.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto neg1 = fb.Negate(x);
+  auto neg2 = fb.Negate(neg1);
+  auto neg3 = fb.Negate(neg2);
+  auto result = fb.Not(neg3);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  RegionPartition partition = PartitionIntoRegions(
+      f, {x.node(), result.node()}, /*max_region_size=*/2);
+  EXPECT_THAT(partition.separators,
+              UnorderedElementsAre(x.node(), neg2.node(), result.node()));
+  EXPECT_THAT(partition.regions,
+              ElementsAre(ElementsAre(neg1.node(), neg3.node())));
+}
+
 TEST_F(FunctionPartitionTest, BenchmarkTest) {
   // Compute the minimum cost partition of each benchmark and validate the
   // results.
@@ -204,6 +260,11 @@ TEST_F(FunctionPartitionTest, BenchmarkTest) {
       EXPECT_EQ(partition.first.size() + partition.second.size(),
                 nodes_to_partition.size());
 
+      // The choice of max-flow algorithm should not affect the partition.
+      auto augmenting_path_partition = MinCostFunctionPartition(
+          f, nodes_to_partition, min_cut::MaxFlowAlgorithm::kAugmentingPath);
+      EXPECT_EQ(partition, augmenting_path_partition) << benchmark_name;
+
       // No params should be in the second partition.
       EXPECT_TRUE(std::all_of(partition.second.begin(), partition.second.end(),
                               [](Node* n) { return !n->Is<Param>(); }));
@@ -0,0 +1,403 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/list_scheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/scheduling/schedule_bounds.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+
+namespace {
+
+// The number of users of a value scheduled in each cycle, stored as (cycle,
+// count) pairs sorted by cycle. The users of most values are scheduled in one
+// or two distinct cycles.
+class UserCycles {
+ public:
+  void Add(int64_t cycle) {
+    auto it = Find(cycle);
+    if (it != counts_.end() && it->first == cycle) {
+      ++it->second;
+    } else {
+      counts_.insert(it, {cycle, 1});
+    }
+  }
+
+  void Remove(int64_t cycle) {
+    auto it = Find(cycle);
+    CHECK(it != counts_.end() && it->first == cycle);
+    if (--it->second == 0) {
+      counts_.erase(it);
+    }
+  }
+
+  // Returns the latest cycle of any user, or std::nullopt if there are none.
+  std::optional<int64_t> Latest() const {
+    if (counts_.empty()) {
+      return std::nullopt;
+    }
+    return counts_.back().first;
+  }
+
+  // Returns the latest cycle of any user if one of the users in `cycle` were
+  // removed.
+  std::optional<int64_t> LatestWithoutOneIn(int64_t cycle) const {
+    if (counts_.empty()) {
+      return std::nullopt;
+    }
+    if (counts_.back().first != cycle || counts_.back().second > 1) {
+      return counts_.back().first;
+    }
+    if (counts_.size() == 1) {
+      return std::nullopt;
+    }
+    return counts_[counts_.size() - 2].first;
+  }
+
+ private:
+  using Counts = absl::InlinedVector<std::pair<int64_t, int64_t>, 2>;
+
+  Counts::iterator Find(int64_t cycle) {
+    return absl::c_lower_bound(
+        counts_, cycle,
+        [](const std::pair<int64_t, int64_t>& entry, int64_t value) {
+          return entry.first < value;
+        });
+  }
+
+  Counts counts_;
+};
+
+// A schedule under refinement. Nodes are identified by their index in a
+// topological sort, and the operands and users of each node are stored as
+// indices so that a refinement pass doesn't need any hashing.
+class ListSchedule {
+ public:
+  static absl::StatusOr<ListSchedule> Create(
+      FunctionBase* f, const DelayEstimator& delay_estimator,
+      const sched::ScheduleBounds& bounds) {
+    ListSchedule schedule;
+    schedule.nodes_ = TopoSort(f);
+    int64_t node_count = schedule.nodes_.size();
+    absl::flat_hash_map<Node*, int64_t> index;
+    index.reserve(node_count);
+    for (int64_t i = 0; i < node_count; ++i) {
+      index[schedule.nodes_[i]] = i;
+    }
+    schedule.operands_.resize(node_count);
+    schedule.users_.resize(node_count);
+    schedule.delay_.resize(node_count);
+    schedule.bit_count_.resize(node_count);
+    schedule.lb_.resize(node_count);
+    schedule.ub_.resize(node_count);
+    schedule.cycle_.resize(node_count);
+    schedule.user_cycles_.resize(node_count);
+    for (int64_t i = 0; i < node_count; ++i) {
+      Node* node = schedule.nodes_[i];
+      XLS_ASSIGN_OR_RETURN(schedule.delay_[i],
+                           delay_estimator.GetOperationDelayInPs(node));
+      schedule.bit_count_[i] = node->GetType()->GetFlatBitCount();
+      schedule.lb_[i] = bounds.lb(node);
+      schedule.ub_[i] = bounds.ub(node);
+      schedule.cycle_[i] = bounds.lb(node);
+      std::vector<int64_t>& operands = schedule.operands_[i];
+      for (Node* operand : node->operands()) {
+        operands.push_back(index.at(operand));
+      }
+      absl::c_sort(operands);
+      operands.erase(std::unique(operands.begin(), operands.end()),
+                     operands.end());
+      for (int64_t operand : operands) {
+        schedule.users_[operand].push_back(i);
+      }
+    }
+    for (int64_t i = 0; i < node_count; ++i) {
+      for (int64_t user : schedule.users_[i]) {
+        schedule.user_cycles_[i].Add(schedule.cycle_[user]);
+      }
+    }
+    return schedule;
+  }
+
+  // Visits the nodes in reverse topological order, moving each to the later
+  // cycle which most reduces the register count. Returns the number of nodes
+  // moved.
+  //
+  // When a node is visited all of its users are in their final cycles for
+  // this pass, so the longest path through the node within its new cycle is
+  // the node's delay plus the longest path from its users in that cycle. Its
+  // (unvisited) operands are all in earlier cycles. A node which stays in its
+  // cycle needs no check: any path from the node through the nodes which are
+  // still in that cycle already existed at the start of the pass.
+  int64_t SinkPass(int64_t clock_period_ps) {
+    int64_t moved = 0;
+    // The longest combinational path from the start of each visited node to
+    // the end of its cycle.
+    std::vector<int64_t> path_to_end(nodes_.size());
+    for (int64_t i = nodes_.size() - 1; i >= 0; --i) {
+      int64_t latest = ub_[i];
+      for (int64_t user : users_[i]) {
+        latest = std::min(latest, cycle_[user]);
+      }
+      int64_t downstream_delay = 0;
+      for (int64_t user : users_[i]) {
+        if (cycle_[user] == latest) {
+          downstream_delay = std::max(downstream_delay, path_to_end[user]);
+        }
+      }
+      int64_t best_cycle = cycle_[i];
+      int64_t best_cost = PlacementCost(i, cycle_[i]);
+      for (int64_t cycle = cycle_[i] + 1; cycle <= latest; ++cycle) {
+        if (cycle == latest &&
+            delay_[i] + downstream_delay > clock_period_ps) {
+          break;
+        }
+        int64_t cost = PlacementCost(i, cycle);
+        if (cost < best_cost) {
+          best_cycle = cycle;
+          best_cost = cost;
+        }
+      }
+      if (best_cycle != cycle_[i]) {
+        Move(i, best_cycle);
+        ++moved;
+      }
+      int64_t path_after = 0;
+      for (int64_t user : users_[i]) {
+        if (cycle_[user] == cycle_[i]) {
+          path_after = std::max(path_after, path_to_end[user]);
+        }
+      }
+      path_to_end[i] = delay_[i] + path_after;
+    }
+    return moved;
+  }
+
+  // The mirror image of SinkPass: visits the nodes in topological order,
+  // moving each to the earlier cycle which most reduces the register count.
+  int64_t HoistPass(int64_t clock_period_ps) {
+    int64_t moved = 0;
+    // The longest combinational path from the start of the cycle of each
+    // visited node to its end.
+    std::vector<int64_t> path_from_start(nodes_.size());
+    for (int64_t i = 0; i < nodes_.size(); ++i) {
+      int64_t earliest = lb_[i];
+      for (int64_t operand : operands_[i]) {
+        earliest = std::max(earliest, cycle_[operand]);
+      }
+      int64_t upstream_delay = 0;
+      for (int64_t operand : operands_[i]) {
+        if (cycle_[operand] == earliest) {
+          upstream_delay = std::max(upstream_delay, path_from_start[operand]);
+        }
+      }
+      int64_t best_cycle = cycle_[i];
+      int64_t best_cost = PlacementCost(i, cycle_[i]);
+      for (int64_t cycle = cycle_[i] - 1; cycle >= earliest; --cycle) {
+        if (cycle == earliest &&
+            upstream_delay + delay_[i] > clock_period_ps) {
+          break;
+        }
+        int64_t cost = PlacementCost(i, cycle);
+        if (cost < best_cost) {
+          best_cycle = cycle;
+          best_cost = cost;
+        }
+      }
+      if (best_cycle != cycle_[i]) {
+        Move(i, best_cycle);
+        ++moved;
+      }
+      int64_t path_before = 0;
+      for (int64_t operand : operands_[i]) {
+        if (cycle_[operand] == cycle_[i]) {
+          path_before = std::max(path_before, path_from_start[operand]);
+        }
+      }
+      path_from_start[i] = path_before + delay_[i];
+    }
+    return moved;
+  }
+
+  // Returns the total number of bits held in pipeline registers.
+  int64_t RegisterBits() const {
+    int64_t bits = 0;
+    for (int64_t i = 0; i < nodes_.size(); ++i) {
+      std::optional<int64_t> latest_user = user_cycles_[i].Latest();
+      if (latest_user.has_value()) {
+        bits += bit_count_[i] * (*latest_user - cycle_[i]);
+      }
+    }
+    return bits;
+  }
+
+  ScheduleCycleMap ToCycleMap() const {
+    ScheduleCycleMap cycle_map;
+    cycle_map.reserve(nodes_.size());
+    for (int64_t i = 0; i < nodes_.size(); ++i) {
+      cycle_map[nodes_[i]] = cycle_[i];
+    }
+    return cycle_map;
+  }
+
+ private:
+  ListSchedule() = default;
+
+  // Returns the number of pipeline register bits holding node `i` and its
+  // operands if node `i` were scheduled in `cycle`. Only these registers
+  // depend on the cycle of node `i`, so the difference between the costs of
+  // two cycles is the change in the register count of the whole pipeline.
+  int64_t PlacementCost(int64_t i, int64_t cycle) const {
+    int64_t cost = 0;
+    std::optional<int64_t> latest_user = user_cycles_[i].Latest();
+    if (latest_user.has_value()) {
+      cost += bit_count_[i] * (*latest_user - cycle);
+    }
+    for (int64_t operand : operands_[i]) {
+      int64_t lifetime_end = std::max(
+          cycle,
+          user_cycles_[operand].LatestWithoutOneIn(cycle_[i]).value_or(cycle));
+      cost += bit_count_[operand] * (lifetime_end - cycle_[operand]);
+    }
+    return cost;
+  }
+
+  void Move(int64_t i, int64_t cycle) {
+    for (int64_t operand : operands_[i]) {
+      user_cycles_[operand].Remove(cycle_[i]);
+      user_cycles_[operand].Add(cycle);
+    }
+    cycle_[i] = cycle;
+  }
+
+  std::vector<Node*> nodes_;
+  std::vector<std::vector<int64_t>> operands_;
+  std::vector<std::vector<int64_t>> users_;
+  std::vector<int64_t> delay_;
+  std::vector<int64_t> bit_count_;
+  std::vector<int64_t> lb_;
+  std::vector<int64_t> ub_;
+  std::vector<int64_t> cycle_;
+  std::vector<UserCycles> user_cycles_;
+};
+
+}  // namespace
+
+absl::StatusOr<ScheduleCycleMap> ListScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    absl::Span<const SchedulingConstraint> constraints,
+    int64_t refinement_rounds) {
+  VLOG(3) << "ListScheduler()";
+  VLOG(3) << "  pipeline stages = " << pipeline_stages;
+
+  bool has_receives = absl::c_any_of(
+      f->nodes(), [](Node* node) { return node->Is<Receive>(); });
+  for (const SchedulingConstraint& constraint : constraints) {
+    if (std::holds_alternative<RecvsFirstSendsLastConstraint>(constraint)) {
+      // Bounds are propagated once for all of the nodes to keep this linear
+      // in the size of the graph.
+      for (Node* node : f->nodes()) {
+        if (node->Is<Receive>()) {
+          XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, 0));
+        }
+        if (node->Is<Send>()) {
+          XLS_RETURN_IF_ERROR(bounds->TightenNodeLb(node, pipeline_stages - 1));
+        }
+      }
+      XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
+      XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
+    } else if (std::holds_alternative<NodeInCycleConstraint>(constraint)) {
+      const NodeInCycleConstraint& node_in_cycle =
+          std::get<NodeInCycleConstraint>(constraint);
+      Node* node = node_in_cycle.GetNode();
+      int64_t cycle = node_in_cycle.GetCycle();
+      XLS_RETURN_IF_ERROR(bounds->TightenNodeLb(node, cycle));
+      XLS_RETURN_IF_ERROR(bounds->PropagateLowerBounds());
+      XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, cycle));
+      XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
+    } else if (std::holds_alternative<BackedgeConstraint>(constraint)) {
+      // Satisfied by scheduling the state backedge in the first cycle below.
+    } else if (std::holds_alternative<SendThenRecvConstraint>(constraint) &&
+               (std::get<SendThenRecvConstraint>(constraint)
+                        .MinimumLatency() == 0 ||
+                !has_receives)) {
+      // Trivially satisfied.
+    } else {
+      return absl::InternalError(
+          "ListScheduler doesn't support constraints other than "
+          "receives-first-sends-last, node-in-cycle and backedge constraints "
+          "or send-then-receive constraints in the absence of receives.");
+    }
+  }
+
+  for (Node* node : f->nodes()) {
+    if (node->Is<MinDelay>()) {
+      return absl::InternalError(
+          "ListScheduler doesn't support min_delay nodes.");
+    }
+  }
+
+  // The state backedge must be in the first cycle.
+  if (Proc* proc = dynamic_cast<Proc*>(f)) {
+    for (Node* node : proc->params()) {
+      XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, 0));
+    }
+    for (Node* node : proc->NextState()) {
+      XLS_RETURN_IF_ERROR(bounds->TightenNodeUb(node, 0));
+    }
+    XLS_RETURN_IF_ERROR(bounds->PropagateUpperBounds());
+  }
+  XLS_RET_CHECK_LT(bounds->max_lower_bound(), pipeline_stages);
+
+  XLS_ASSIGN_OR_RETURN(ListSchedule schedule,
+                       ListSchedule::Create(f, delay_estimator, *bounds));
+  VLOG(3) << "  initial register bits = " << schedule.RegisterBits();
+  for (int64_t round = 0; round < refinement_rounds; ++round) {
+    int64_t moved = schedule.SinkPass(clock_period_ps);
+    moved += schedule.HoistPass(clock_period_ps);
+    VLOG(3) << "  round " << round << ": moved " << moved
+            << " nodes, register bits = " << schedule.RegisterBits();
+    if (moved == 0) {
+      break;
+    }
+  }
+  return schedule.ToCycleMap();
+}
+
+}  // namespace xls
@@ -0,0 +1,57 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SCHEDULING_LIST_SCHEDULER_H_
+#define XLS_SCHEDULING_LIST_SCHEDULER_H_
+
+#include <cstdint>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/scheduling/schedule_bounds.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+
+// The default number of refinement rounds run by ListScheduler.
+inline constexpr int64_t kDefaultListSchedulerRefinementRounds = 8;
+
+// Schedules the given function into a pipeline with the given clock period
+// using a list scheduler intended for graphs too large for the SDC scheduler.
+//
+// Each node starts in the earliest cycle allowed by `bounds`. The schedule is
+// then refined by alternately visiting the nodes in reverse topological order,
+// moving each to a later cycle, and in topological order, moving each to an
+// earlier cycle. A node is moved to the cycle within its bounds which most
+// reduces the number of pipeline register bits, taking into account both its
+// own value and the values of its operands, provided the move keeps every
+// combinational path within the clock period. Every move strictly reduces the
+// register count, and refinement stops after `refinement_rounds` rounds or
+// when a round moves no node. Each round takes time linear in the number of
+// edges of the graph times the number of pipeline stages.
+//
+// Supports receives-first-sends-last, node-in-cycle and backedge constraints,
+// and send-then-receive constraints when `f` has no receives. As with the
+// min-cut scheduler, the state backedge of a proc is placed in the first cycle.
+absl::StatusOr<ScheduleCycleMap> ListScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    absl::Span<const SchedulingConstraint> constraints,
+    int64_t refinement_rounds = kDefaultListSchedulerRefinementRounds);
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_LIST_SCHEDULER_H_
@@ -0,0 +1,165 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests of the list scheduler. These go through RunPipelineSchedule, which
+// computes the initial schedule bounds and verifies the resulting schedule.
+
+#include <cstdint>
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/benchmark_support.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/run_pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+namespace {
+
+using ::testing::HasSubstr;
+using ::xls::benchmark_support::ScalingDesign;
+using ::xls::status_testing::StatusIs;
+
+class ListSchedulerTest : public IrTestBase {};
+
+TEST_F(ListSchedulerTest, SinksWideningOperation) {
+  // ASAP schedules the zero-extend of 'b' in the first cycle, so its 32-bit
+  // result would be registered twice. It should be sunk next to its user.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue b = fb.Param("b", p->GetBitsType(1));
+  BValue neg = fb.Negate(fb.Negate(fb.Negate(x)));
+  BValue wide_b = fb.ZeroExtend(b, 32);
+  fb.Concat({neg, wide_b});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule asap,
+      RunPipelineSchedule(
+          f, TestDelayEstimator(),
+          SchedulingOptions(SchedulingStrategy::ASAP).clock_period_ps(1)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(
+          f, TestDelayEstimator(),
+          SchedulingOptions(SchedulingStrategy::LIST).clock_period_ps(1)));
+
+  EXPECT_EQ(schedule.length(), 3);
+  EXPECT_EQ(asap.cycle(wide_b.node()), 0);
+  EXPECT_EQ(schedule.cycle(wide_b.node()), 2);
+  EXPECT_LT(schedule.CountFinalInteriorPipelineRegisters(),
+            asap.CountFinalInteriorPipelineRegisters());
+}
+
+TEST_F(ListSchedulerTest, NodeInCycleConstraint) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue b = fb.Param("b", p->GetBitsType(1));
+  BValue neg = fb.Negate(fb.Negate(fb.Negate(x)));
+  BValue wide_b = fb.ZeroExtend(b, 32);
+  fb.Concat({neg, wide_b});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(
+          f, TestDelayEstimator(),
+          SchedulingOptions(SchedulingStrategy::LIST)
+              .clock_period_ps(1)
+              .add_constraint(NodeInCycleConstraint(wide_b.node(), 1))));
+
+  EXPECT_EQ(schedule.cycle(wide_b.node()), 1);
+}
+
+TEST_F(ListSchedulerTest, NoMoreRegistersThanAsap) {
+  for (ScalingDesign design :
+       {ScalingDesign::kChain, ScalingDesign::kBalancedTree,
+        ScalingDesign::kLadder, ScalingDesign::kLargeSelect,
+        ScalingDesign::kDynamicArray}) {
+    auto p = CreatePackage();
+    XLS_ASSERT_OK_AND_ASSIGN(
+        FunctionBase * f,
+        benchmark_support::GenerateScalingDesign(design, p.get(), 64));
+
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule asap,
+        RunPipelineSchedule(
+            f, TestDelayEstimator(),
+            SchedulingOptions(SchedulingStrategy::ASAP).clock_period_ps(3)));
+    // RunPipelineSchedule verifies that the schedule meets the clock period.
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule schedule,
+        RunPipelineSchedule(f, TestDelayEstimator(),
+                            SchedulingOptions(SchedulingStrategy::LIST)
+                                .clock_period_ps(3)
+                                .pipeline_stages(asap.length())));
+    EXPECT_LE(schedule.CountFinalInteriorPipelineRegisters(),
+              asap.CountFinalInteriorPipelineRegisters())
+        << f->name();
+  }
+}
+
+TEST_F(ListSchedulerTest, RefineWithSdc) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           benchmark_support::GenerateLadder(p.get(), 16));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule sdc,
+      RunPipelineSchedule(
+          f, TestDelayEstimator(),
+          SchedulingOptions().clock_period_ps(3).pipeline_stages(8)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule refined,
+      RunPipelineSchedule(f, TestDelayEstimator(),
+                          SchedulingOptions(SchedulingStrategy::LIST)
+                              .clock_period_ps(3)
+                              .pipeline_stages(8)
+                              .refine_list_schedule_with_sdc(true)));
+
+  EXPECT_EQ(refined.CountFinalInteriorPipelineRegisters(),
+            sdc.CountFinalInteriorPipelineRegisters());
+}
+
+TEST_F(ListSchedulerTest, UnsupportedConstraint) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  fb.Add(fb.Negate(x), fb.Negate(y));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(
+      RunPipelineSchedule(f, TestDelayEstimator(),
+                          SchedulingOptions(SchedulingStrategy::LIST)
+                              .clock_period_ps(1)
+                              .add_constraint(DifferenceConstraint(
+                                  x.node(), y.node(), /*max_difference=*/0)))
+          .status(),
+      StatusIs(absl::StatusCode::kInternal,
+               HasSubstr("ListScheduler doesn't support constraints")));
+}
+
+}  // namespace
+}  // namespace xls
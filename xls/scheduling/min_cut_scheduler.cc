@@ -33,6 +33,7 @@
 #include "absl/strings/str_join.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/data_structures/min_cut.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
 #include "xls/scheduling/function_partition.h"
@@ -49,7 +50,8 @@ namespace {
 // 'cycle + 1'.
 absl::Status SplitAfterCycle(FunctionBase* f, int64_t cycle,
                              const DelayEstimator& delay_estimator,
-                             sched::ScheduleBounds* bounds) {
+                             sched::ScheduleBounds* bounds,
+                             min_cut::MaxFlowAlgorithm max_flow_algorithm) {
   VLOG(3) << "Splitting after cycle " << cycle;
 
   // The nodes which need to be partitioned are those which can be scheduled in
@@ -62,7 +64,8 @@ absl::Status SplitAfterCycle(FunctionBase* f, int64_t cycle,
   }
 
   std::pair<std::vector<Node*>, std::vector<Node*>> partitions =
-      sched::MinCostFunctionPartition(f, partitionable_nodes);
+      sched::MinCostFunctionPartition(f, partitionable_nodes,
+                                      max_flow_algorithm);
 
   // Tighten bounds based on the cut.
   for (Node* node : partitions.first) {
@@ -147,7 +150,8 @@ std::vector<std::vector<int64_t>> GetMinCutCycleOrders(int64_t length) {
 absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
     FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
     const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
-    absl::Span<const SchedulingConstraint> constraints) {
+    absl::Span<const SchedulingConstraint> constraints,
+    min_cut::MaxFlowAlgorithm max_flow_algorithm) {
   VLOG(3) << "MinCutScheduler()";
   VLOG(3) << "  pipeline stages = " << pipeline_stages;
   XLS_VLOG_LINES(4, f->DumpIr());
@@ -207,8 +211,8 @@ absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
     // cycle and those which must be scheduled after. Upon loop completion each
     // node will have a range of exactly one cycle.
     for (int64_t cycle : cut_order) {
-      XLS_RETURN_IF_ERROR(
-          SplitAfterCycle(f, cycle, delay_estimator, &trial_bounds));
+      XLS_RETURN_IF_ERROR(SplitAfterCycle(f, cycle, delay_estimator,
+                                          &trial_bounds, max_flow_algorithm));
       XLS_RETURN_IF_ERROR(trial_bounds.PropagateLowerBounds());
       XLS_RETURN_IF_ERROR(trial_bounds.PropagateUpperBounds());
     }
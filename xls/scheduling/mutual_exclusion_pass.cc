@@ -19,7 +19,6 @@
 #include <functional>
 #include <iterator>
 #include <memory>
-#include <numeric>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -39,9 +38,12 @@
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/common/casts.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/graph_coloring.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/data_structures/transitive_closure.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
@@ -55,7 +57,10 @@
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
+#include "xls/passes/bdd_function.h"
+#include "xls/passes/bdd_query_engine.h"
 #include "xls/passes/post_dominator_analysis.h"
+#include "xls/passes/query_engine.h"
 #include "xls/passes/token_provenance_analysis.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "xls/scheduling/scheduling_pass.h"
@@ -128,24 +133,6 @@ bool IsHeavyOp(Op op) {
 
 using NodeRelation = absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>>;
 
-// Find all nodes that the given node transitively depends on.
-absl::flat_hash_set<Node*> DependenciesOf(Node* root) {
-  std::vector<Node*> stack;
-  stack.push_back(root);
-  absl::flat_hash_set<Node*> discovered;
-  while (!stack.empty()) {
-    Node* popped = stack.back();
-    stack.pop_back();
-    if (!discovered.contains(popped)) {
-      discovered.insert(popped);
-      for (Node* child : popped->operands()) {
-        stack.push_back(child);
-      }
-    }
-  }
-  return discovered;
-}
-
 // Find the largest connected subgraph of the given token DAG, such that it is
 // a rooted DAG whose root is the given node, and all nodes in the subgraph
 // satisfy the given predicate.
@@ -209,8 +196,48 @@ absl::StatusOr<NodeRelation> ComputeMergableEffects(FunctionBase* f) {
     return predicate;
   };
 
+  // Number the nodes in topological order so reachability can be computed in a
+  // single pass. Data reachability is only needed from sends and receives and
+  // token reachability only from nodes in the token DAG.
+  std::vector<Node*> topo_sort = TopoSort(f);
+  absl::flat_hash_map<Node*, int64_t> topo_index;
+  std::vector<int64_t> effect_sources;
+  std::vector<int64_t> token_sources;
+  for (Node* node : topo_sort) {
+    int64_t index = topo_index.size();
+    topo_index[node] = index;
+    if (node->Is<Send>() || node->Is<Receive>()) {
+      effect_sources.push_back(index);
+    }
+    if (token_nodes.contains(node)) {
+      token_sources.push_back(index);
+    }
+  }
+  auto index_all = [&](auto&& nodes) {
+    std::vector<int64_t> indices;
+    indices.reserve(nodes.size());
+    for (Node* node : nodes) {
+      indices.push_back(topo_index.at(node));
+    }
+    return indices;
+  };
+  DagTransitiveClosure data_closure = DagTransitiveClosure::Create(
+      topo_sort.size(), effect_sources,
+      [&](int64_t i) { return index_all(topo_sort[i]->operands()); });
+  DagTransitiveClosure token_closure = DagTransitiveClosure::Create(
+      topo_sort.size(), token_sources, [&](int64_t i) {
+        auto it = token_dag.find(topo_sort[i]);
+        return it == token_dag.end() ? std::vector<int64_t>()
+                                     : index_all(it->second);
+      });
+
+  // Returns true if `node` is `pred` or `pred` transitively depends on it.
+  auto is_dependency_of = [&](Node* node, Node* pred) {
+    return node == pred ||
+           data_closure.IsReachable(topo_index.at(node), topo_index.at(pred));
+  };
+
   NodeRelation result;
-  NodeRelation transitive_closure = TransitiveClosure<Node*>(token_dag);
   for (Node* node : ReverseTopoSort(f)) {
     if (node->Is<Send>() || node->Is<Receive>()) {
       absl::flat_hash_set<Node*> subgraph =
@@ -224,16 +251,12 @@ absl::StatusOr<NodeRelation> ComputeMergableEffects(FunctionBase* f) {
           // can be token-dependent). The only way for two sends or two receives
           // to have a data dependency is through the predicate.
           if (std::optional<Node*> pred_x = get_predicate(x)) {
-            absl::flat_hash_set<Node*> dependencies_of_pred_x =
-                DependenciesOf(pred_x.value());
-            if (dependencies_of_pred_x.contains(y)) {
+            if (is_dependency_of(y, pred_x.value())) {
               continue;
             }
           }
           if (std::optional<Node*> pred_y = get_predicate(y)) {
-            absl::flat_hash_set<Node*> dependencies_of_pred_y =
-                DependenciesOf(pred_y.value());
-            if (dependencies_of_pred_y.contains(x)) {
+            if (is_dependency_of(x, pred_y.value())) {
               continue;
             }
           }
@@ -244,11 +267,11 @@ absl::StatusOr<NodeRelation> ComputeMergableEffects(FunctionBase* f) {
     }
   }
   for (Node* x : token_nodes) {
+    int64_t x_index = topo_index.at(x);
     for (Node* y : token_nodes) {
-      if (!(transitive_closure.contains(x) &&
-            transitive_closure.at(x).contains(y)) &&
-          !(transitive_closure.contains(y) &&
-            transitive_closure.at(y).contains(x))) {
+      int64_t y_index = topo_index.at(y);
+      if (!token_closure.IsReachable(x_index, y_index) &&
+          !token_closure.IsReachable(y_index, x_index)) {
         result[x].insert(y);
         result[y].insert(x);
       }
@@ -263,14 +286,9 @@ absl::StatusOr<NodeRelation> ComputeMergableEffects(FunctionBase* f) {
 // A merge class is a set of nodes that are all jointly mutually exclusive.
 absl::StatusOr<std::vector<absl::flat_hash_set<Node*>>> ComputeMergeClasses(
     Predicates* p, FunctionBase* f, const ScheduleCycleMap& scm) {
-  absl::flat_hash_set<Node*> nodes;
   std::vector<Node*> ordered_nodes;
-  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>> neighborhoods;
-
   for (Node* node : TopoSort(f)) {
     if (IsHeavyOp(node->op())) {
-      nodes.insert(node);
-      neighborhoods[node];
       ordered_nodes.push_back(node);
     }
   }
@@ -282,12 +300,18 @@ absl::StatusOr<std::vector<absl::flat_hash_set<Node*>>> ComputeMergeClasses(
            scm.at(x) == scm.at(y);
   };
 
-  for (Node* x : nodes) {
+  // The graph of mutually exclusive nodes, indexed by position in
+  // `ordered_nodes`.
+  const int64_t node_count = ordered_nodes.size();
+  std::vector<InlineBitmap> neighborhoods(node_count, InlineBitmap(node_count));
+  for (int64_t i = 0; i < node_count; ++i) {
+    Node* x = ordered_nodes[i];
     if (!(p->GetPredicate(x).has_value())) {
       continue;
     }
     Node* px = p->GetPredicate(x).value();
-    for (Node* y : nodes) {
+    for (int64_t j = 0; j < node_count; ++j) {
+      Node* y = ordered_nodes[j];
       if (!(p->GetPredicate(y).has_value())) {
         continue;
       }
@@ -306,44 +330,28 @@ absl::StatusOr<std::vector<absl::flat_hash_set<Node*>>> ComputeMergeClasses(
         continue;
       }
       if (p->QueryMutuallyExclusive(px, py) == std::make_optional(true)) {
-        neighborhoods[x].insert(y);
-        neighborhoods[y].insert(x);
+        neighborhoods[i].Set(j);
+        neighborhoods[j].Set(i);
       }
     }
   }
 
   // The complement of the `neighborhoods` graph
-  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>> inverted_neighborhoods;
-
-  for (Node* node : nodes) {
-    inverted_neighborhoods[node] = nodes;
-    for (Node* neighbor : neighborhoods.at(node)) {
-      inverted_neighborhoods[node].erase(neighbor);
+  std::vector<InlineBitmap> inverted_neighborhoods(
+      node_count, InlineBitmap(node_count, /*fill=*/true));
+  for (int64_t i = 0; i < node_count; ++i) {
+    for (int64_t j = 0; j < node_count; ++j) {
+      if (neighborhoods[i].Get(j)) {
+        inverted_neighborhoods[i].Set(j, false);
+      }
     }
   }
 
-  absl::flat_hash_map<Node*, int64_t> node_to_index;
-  for (int64_t i = 0; i < ordered_nodes.size(); ++i) {
-    node_to_index[ordered_nodes[i]] = i;
-  }
-
-  std::vector<int64_t> iota(ordered_nodes.size());
-  std::iota(iota.begin(), iota.end(), 0);
-  std::vector<absl::flat_hash_set<int64_t>> coloring_indices =
-      RecursiveLargestFirstColoring<int64_t>(
-          absl::flat_hash_set<int64_t>(iota.begin(), iota.end()),
-          [&](int64_t node_index) -> absl::flat_hash_set<int64_t> {
-            absl::flat_hash_set<Node*> inv_neighbors =
-                inverted_neighborhoods.at(ordered_nodes.at(node_index));
-            absl::flat_hash_set<int64_t> result;
-            for (Node* inv_neighbor : inv_neighbors) {
-              result.insert(node_to_index.at(inv_neighbor));
-            }
-            return result;
-          });
+  std::vector<std::vector<int64_t>> coloring_indices =
+      RecursiveLargestFirstColoring(inverted_neighborhoods);
 
   std::vector<absl::flat_hash_set<Node*>> coloring;
-  for (const absl::flat_hash_set<int64_t>& color_class : coloring_indices) {
+  for (const std::vector<int64_t>& color_class : coloring_indices) {
     absl::flat_hash_set<Node*> color_node_class;
     for (int64_t index : color_class) {
       color_node_class.insert(ordered_nodes[index]);
@@ -951,6 +959,131 @@ absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f) {
   return absl::OkStatus();
 }
 
+// Returns the sources of the fan-in of `node`: the non-literal nodes (including
+// possibly `node` itself) whose operands are all literals or tokens. Tokens
+// carry no data so token-typed nodes are not traversed. Predicates with
+// disjoint sources are functions of disjoint sets of values. The nodes of the
+// fan-in are added to `cone`.
+absl::flat_hash_set<Node*> PredicateSources(
+    Node* node, absl::flat_hash_set<const Node*>& cone) {
+  absl::flat_hash_set<Node*> sources;
+  absl::flat_hash_set<Node*> visited = {node};
+  std::vector<Node*> worklist = {node};
+  while (!worklist.empty()) {
+    Node* n = worklist.back();
+    worklist.pop_back();
+    cone.insert(n);
+    bool is_source = true;
+    for (Node* operand : n->operands()) {
+      if (operand->Is<Literal>()) {
+        cone.insert(operand);
+        continue;
+      }
+      if (operand->GetType()->IsToken()) {
+        continue;
+      }
+      is_source = false;
+      if (visited.insert(operand).second) {
+        worklist.push_back(operand);
+      }
+    }
+    if (is_source && !n->Is<Literal>()) {
+      sources.insert(n);
+    }
+  }
+  return sources;
+}
+
+// A query of whether the predicates `a` and `b` can be true at the same time.
+struct PairQuery {
+  Node* a;
+  Node* b;
+  // Whether `a` and `b` must be proven mutually exclusive for the channel
+  // operations to be legal, in which case the query is not resource limited.
+  bool required_for_compilation;
+};
+
+// Queries with fewer than this many pair queries per thread are not worth
+// translating the function into another Z3 context for.
+constexpr int64_t kMinQueriesPerThread = 256;
+
+// Solves the pair queries `queries[begin, end)` with a single incremental
+// solver session on the Z3 context of `translator`. Z3 errors are reported to
+// the caller's error handler for the context.
+void SolvePairQueriesInSession(solvers::z3::IrTranslator* translator,
+                               absl::Span<const PairQuery> queries,
+                               int64_t begin, int64_t end, int64_t z3_rlimit,
+                               absl::Span<Z3_lbool> results) {
+  Z3_context ctx = translator->ctx();
+  Z3_solver solver = solvers::z3::CreateSolver(ctx, 1);
+  for (int64_t i = begin; i < end; ++i) {
+    const PairQuery& query = queries[i];
+    Z3_ast z3_a = translator->GetTranslation(query.a);
+    Z3_ast z3_b = translator->GetTranslation(query.b);
+    // We try to find out if `a ∧ b` is satisfiable, which is true iff
+    // `a NAND b` is not valid.
+    Z3_ast a_and_b =
+        solvers::z3::BitVectorToBoolean(ctx, Z3_mk_bvand(ctx, z3_a, z3_b));
+    translator->SetRlimit(query.required_for_compilation ? 0 : z3_rlimit);
+    Z3_solver_push(ctx, solver);
+    Z3_solver_assert(ctx, solver, a_and_b);
+    results[i] = Z3_solver_check(ctx, solver);
+    Z3_solver_pop(ctx, solver, 1);
+  }
+  Z3_solver_dec_ref(ctx, solver);
+}
+
+// Returns whether `a ∧ b` is satisfiable for each of `queries`. The queries are
+// split into contiguous groups which are solved in parallel, each group in its
+// own Z3 context. The first group uses `translator`, whose context must have
+// an active error handler.
+absl::StatusOr<std::vector<Z3_lbool>> SolvePairQueries(
+    FunctionBase* f, solvers::z3::IrTranslator* translator,
+    absl::Span<const PairQuery> queries, int64_t z3_rlimit) {
+  std::vector<Z3_lbool> results(queries.size(), Z3_L_UNDEF);
+  const int64_t group_count = std::clamp(
+      static_cast<int64_t>(queries.size()) / kMinQueriesPerThread, int64_t{1},
+      std::max(int64_t{1}, static_cast<int64_t>(AvailableCPUs())));
+  const int64_t group_size = CeilOfRatio(
+      static_cast<int64_t>(queries.size()), group_count);
+  std::vector<absl::Status> statuses(group_count);
+  auto solve_group = [&](int64_t group) {
+    int64_t begin = group * group_size;
+    int64_t end =
+        std::min(begin + group_size, static_cast<int64_t>(queries.size()));
+    if (group == 0) {
+      SolvePairQueriesInSession(translator, queries, begin, end, z3_rlimit,
+                                absl::MakeSpan(results));
+      return;
+    }
+    absl::StatusOr<std::unique_ptr<solvers::z3::IrTranslator>>
+        group_translator =
+            solvers::z3::IrTranslator::CreateAndTranslate(f, true);
+    if (!group_translator.ok()) {
+      statuses[group] = group_translator.status();
+      return;
+    }
+    solvers::z3::ScopedErrorHandler seh((*group_translator)->ctx());
+    SolvePairQueriesInSession(group_translator->get(), queries, begin, end,
+                              z3_rlimit, absl::MakeSpan(results));
+    statuses[group] = seh.status();
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(group_count - 1);
+  for (int64_t group = 1; group < group_count; ++group) {
+    threads.push_back(
+        std::make_unique<Thread>([&, group]() { solve_group(group); }));
+  }
+  solve_group(0);
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return results;
+}
+
 absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
                                     int64_t z3_rlimit) {
   if (f->IsBlock()) {
@@ -966,26 +1099,49 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
 
   std::vector<std::pair<Node*, int64_t>> predicate_nodes = PredicateNodes(p, f);
 
+  // Cheap pre-filters which settle many pairs without Z3: a BDD over the fan-in
+  // of the predicates proves exclusivity of simple predicates, and predicates
+  // whose fan-ins share no sources are independent, so not exclusive if both
+  // can be true.
+  absl::flat_hash_set<const Node*> predicate_cones;
+  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>> sources;
+  for (const auto& [node, index] : predicate_nodes) {
+    sources[node] = PredicateSources(node, predicate_cones);
+  }
+  BddQueryEngine bdd_engine(
+      BddFunction::kDefaultPathLimit,
+      [&](const Node* node) { return predicate_cones.contains(node); });
+  XLS_RETURN_IF_ERROR(bdd_engine.Populate(f).status());
+  auto bdd_bit = [](Node* node) { return TreeBitLocation(node, 0); };
+
   // Determine for each predicate whether it is always false using Z3.
   // Dead nodes are mutually exclusive with all other nodes, so this can reduce
   // the runtime by doing only a linear amount of Z3 calls to remove
   // quadratically many Z3 calls.
+  absl::flat_hash_set<Node*> satisfiable;
   for (const auto& [node, index] : predicate_nodes) {
-    Z3_ast translated = translator->GetTranslation(node);
-    // Check whether it's possible for `node` to need to be proven mutually
-    // exclusive with some other node in order for channel operations to be
-    // legal; if so, we remove the rlimit on the prover.
-    XLS_ASSIGN_OR_RETURN(
-        bool required_for_compilation,
-        ControlsContendedProvenMutuallyExclusiveChannel(node, p, f));
-    if (required_for_compilation) {
-      LOG(INFO) << "Removing Z3's rlimit for always-false check on "
-                << node->GetName()
-                << " as mutual exclusion is required for compilation.";
+    Z3_lbool result;
+    if (FunctionIsOneBit(node) && bdd_engine.IsAllZeros(node)) {
+      result = Z3_L_FALSE;
+    } else {
+      Z3_ast translated = translator->GetTranslation(node);
+      // Check whether it's possible for `node` to need to be proven mutually
+      // exclusive with some other node in order for channel operations to be
+      // legal; if so, we remove the rlimit on the prover.
+      XLS_ASSIGN_OR_RETURN(
+          bool required_for_compilation,
+          ControlsContendedProvenMutuallyExclusiveChannel(node, p, f));
+      if (required_for_compilation) {
+        LOG(INFO) << "Removing Z3's rlimit for always-false check on "
+                  << node->GetName()
+                  << " as mutual exclusion is required for compilation.";
+      }
+      translator->SetRlimit(z3_rlimit);
+      result = RunSolver(ctx, solvers::z3::BitVectorToBoolean(ctx, translated));
     }
-    translator->SetRlimit(z3_rlimit);
-    if (RunSolver(ctx, solvers::z3::BitVectorToBoolean(ctx, translated)) ==
-        Z3_L_FALSE) {
+    if (result == Z3_L_TRUE) {
+      satisfiable.insert(node);
+    } else if (result == Z3_L_FALSE) {
       VLOG(3) << "Proved that " << node << " is always false";
       // A constant false node is mutually exclusive with all other nodes.
       for (const auto& [other, other_index] : predicate_nodes) {
@@ -1003,6 +1159,7 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
   int64_t known_false = 0;
   int64_t known_true = 0;
   int64_t unknown = 0;
+  int64_t prefiltered = 0;
 
   absl::flat_hash_map<Node*, absl::flat_hash_set<Op>> ops_for_pred;
   for (const auto& [node, index] : predicate_nodes) {
@@ -1023,10 +1180,17 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
     }
   }
 
-  for (const auto& [node_a, index_a] : predicate_nodes) {
+  absl::flat_hash_map<Node*, absl::flat_hash_set<Channel*>> channels_for_pred;
+  for (const auto& [node, index] : predicate_nodes) {
     XLS_ASSIGN_OR_RETURN(
-        absl::flat_hash_set<Channel*> channels_a,
-        GetControlledProvenMutuallyExclusiveChannels(node_a, p, f));
+        channels_for_pred[node],
+        GetControlledProvenMutuallyExclusiveChannels(node, p, f));
+  }
+
+  std::vector<PairQuery> queries;
+  for (const auto& [node_a, index_a] : predicate_nodes) {
+    const absl::flat_hash_set<Channel*>& channels_a =
+        channels_for_pred.at(node_a);
     for (const auto& [node_b, index_b] : predicate_nodes) {
       // This prevents checking `a NAND b` and then later checking `b NAND a`.
       if (index_a >= index_b) {
@@ -1043,48 +1207,63 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
         continue;
       }
 
-      Z3_ast z3_a = translator->GetTranslation(node_a);
-      Z3_ast z3_b = translator->GetTranslation(node_b);
-
-      // We try to find out if `a ∧ b` is satisfiable, which is true iff
-      // `a NAND b` is not valid.
-      Z3_ast a_and_b =
-          solvers::z3::BitVectorToBoolean(ctx, Z3_mk_bvand(ctx, z3_a, z3_b));
+      if (FunctionIsOneBit(node_a) && FunctionIsOneBit(node_b) &&
+          bdd_engine.AtMostOneTrue({bdd_bit(node_a), bdd_bit(node_b)})) {
+        ++known_true;
+        ++prefiltered;
+        XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node_a, node_b));
+        continue;
+      }
+      if (satisfiable.contains(node_a) && satisfiable.contains(node_b) &&
+          !HasIntersection(sources.at(node_a), sources.at(node_b))) {
+        ++known_false;
+        ++prefiltered;
+        XLS_RETURN_IF_ERROR(p->MarkNotMutuallyExclusive(node_a, node_b));
+        continue;
+      }
 
       // Check whether `a` and `b` must be proven mutually exclusive in order
       // for channel operations to be legal; if so, we remove the rlimit on the
       // prover.
-      XLS_ASSIGN_OR_RETURN(
-          absl::flat_hash_set<Channel*> channels_b,
-          GetControlledProvenMutuallyExclusiveChannels(node_b, p, f));
+      const absl::flat_hash_set<Channel*>& channels_b =
+          channels_for_pred.at(node_b);
       bool required_for_compilation = absl::c_any_of(
           channels_a,
           [&](Channel* channel) { return channels_b.contains(channel); });
-      translator->SetRlimit(required_for_compilation ? 0 : z3_rlimit);
       if (required_for_compilation) {
         LOG(INFO) << "Removing Z3's rlimit for mutual exclusion between "
                   << node_a->GetName() << " and " << node_b->GetName()
                   << " as mutual exclusion is required for compilation.";
       }
-      Z3_lbool satisfiable = RunSolver(ctx, a_and_b);
+      queries.push_back(PairQuery{.a = node_a,
+                                  .b = node_b,
+                                  .required_for_compilation =
+                                      required_for_compilation});
+    }
+  }
 
-      if (satisfiable == Z3_L_FALSE) {
-        known_true += 1;
-        XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node_a, node_b));
-      } else if (satisfiable == Z3_L_TRUE) {
-        known_false += 1;
-        XLS_RETURN_IF_ERROR(p->MarkNotMutuallyExclusive(node_a, node_b));
-      } else {
-        unknown += 1;
-        VLOG(3) << "Z3 ran out of time checking mutual exclusion of "
-                << node_a->GetName() << " and " << node_b->GetName();
-      }
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<Z3_lbool> results,
+      SolvePairQueries(f, translator.get(), queries, z3_rlimit));
+  for (int64_t i = 0; i < queries.size(); ++i) {
+    const PairQuery& query = queries[i];
+    if (results[i] == Z3_L_FALSE) {
+      known_true += 1;
+      XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(query.a, query.b));
+    } else if (results[i] == Z3_L_TRUE) {
+      known_false += 1;
+      XLS_RETURN_IF_ERROR(p->MarkNotMutuallyExclusive(query.a, query.b));
+    } else {
+      unknown += 1;
+      VLOG(3) << "Z3 ran out of time checking mutual exclusion of "
+              << query.a->GetName() << " and " << query.b->GetName();
     }
   }
 
   VLOG(3) << "known_false = " << known_false;
   VLOG(3) << "known_true  = " << known_true;
   VLOG(3) << "unknown     = " << unknown;
+  VLOG(3) << "prefiltered = " << prefiltered;
 
   XLS_RETURN_IF_ERROR(seh.status());
 
@@ -18,6 +18,7 @@
 #include <memory>
 #include <optional>
 #include <string_view>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -121,6 +122,38 @@ absl::StatusOr<Proc*> CreateTwoParallelSendsProc(Package* p,
   return pb.Build(pb.AfterAll({send0, send1}), {not_st});
 }
 
+// Like CreateTwoParallelSendsProc but the predicates are comparisons of two
+// state elements, which the pass can only prove exclusive with Z3.
+absl::StatusOr<Proc*> CreateTwoParallelComparisonSendsProc(
+    Package* p, std::string_view name, Channel* channel) {
+  ProcBuilder pb(name, "__token", p);
+  BValue a = pb.StateElement("a", Value(UBits(0, 32)));
+  BValue b = pb.StateElement("b", Value(UBits(0, 32)));
+  BValue lit50 = pb.Literal(UBits(50, 32));
+  BValue lit60 = pb.Literal(UBits(60, 32));
+  BValue send0 = pb.SendIf(channel, pb.GetTokenParam(), pb.ULt(a, b), lit50);
+  BValue send1 = pb.SendIf(channel, pb.GetTokenParam(), pb.UGe(a, b), lit60);
+  return pb.Build(pb.AfterAll({send0, send1}), {b, a});
+}
+
+// Creates a proc with `count` parallel sends on `channel`, the i-th of which
+// fires when `x + i == 0` for a state element `x`.
+absl::StatusOr<Proc*> CreateManyParallelSendsProc(Package* p,
+                                                  std::string_view name,
+                                                  Channel* channel,
+                                                  int64_t count) {
+  ProcBuilder pb(name, "__token", p);
+  BValue x = pb.StateElement("x", Value(UBits(0, 32)));
+  BValue zero = pb.Literal(UBits(0, 32));
+  std::vector<BValue> sends;
+  for (int64_t i = 0; i < count; ++i) {
+    BValue fires = pb.Eq(pb.Add(x, pb.Literal(UBits(i, 32))), zero);
+    sends.push_back(pb.SendIf(channel, pb.GetTokenParam(), fires,
+                              pb.Literal(UBits(i, 32))));
+  }
+  return pb.Build(pb.AfterAll(sends), {pb.Add(x, pb.Literal(UBits(1, 32)))});
+}
+
 absl::StatusOr<Node*> FindOp(FunctionBase* f, Op op) {
   Node* result = nullptr;
   for (Node* node : f->nodes()) {
@@ -185,13 +218,68 @@ TEST_F(MutualExclusionPassTest,
           /*flow_control=*/FlowControl::kReadyValid,
           /*strictness=*/ChannelStrictness::kArbitraryStaticOrder));
   XLS_ASSERT_OK_AND_ASSIGN(
-      Proc * proc, CreateTwoParallelSendsProc(p.get(), "main", test_channel));
+      Proc * proc,
+      CreateTwoParallelComparisonSendsProc(p.get(), "main", test_channel));
   EXPECT_THAT(RunMutualExclusionPass(
                   proc, SchedulingOptions().mutual_exclusion_z3_rlimit(1)),
               IsOkAndHolds(false));
   EXPECT_EQ(NumberOfOp(proc, Op::kSend), 2);
 }
 
+TEST_F(MutualExclusionPassTest, TwoParallelSendsProvenWithoutZ3) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * test_channel,
+      p->CreateStreamingChannel(
+          "test_channel", ChannelOps::kSendOnly, p->GetBitsType(32),
+          /*initial_values=*/{}, /*fifo_config=*/std::nullopt,
+          /*flow_control=*/FlowControl::kReadyValid,
+          /*strictness=*/ChannelStrictness::kArbitraryStaticOrder));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc, CreateTwoParallelSendsProc(p.get(), "main", test_channel));
+  // `st` and `!st` are exclusive according to the BDD so the sends are merged
+  // even though Z3 can't prove anything within the rlimit.
+  EXPECT_THAT(RunMutualExclusionPass(
+                  proc, SchedulingOptions().mutual_exclusion_z3_rlimit(1)),
+              IsOkAndHolds(true));
+  EXPECT_EQ(NumberOfOp(proc, Op::kSend), 1);
+  XLS_EXPECT_OK(VerifyProc(proc, true));
+}
+
+TEST_F(MutualExclusionPassTest, IndependentPredicatesAreNotMerged) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * test_channel,
+      p->CreateStreamingChannel("test_channel", ChannelOps::kSendOnly,
+                                p->GetBitsType(32)));
+  ProcBuilder pb("main", "__token", p.get());
+  BValue a = pb.StateElement("a", Value(UBits(0, 1)));
+  BValue b = pb.StateElement("b", Value(UBits(0, 1)));
+  BValue send0 = pb.SendIf(test_channel, pb.GetTokenParam(), a,
+                           pb.Literal(UBits(50, 32)));
+  BValue send1 = pb.SendIf(test_channel, pb.GetTokenParam(), b,
+                           pb.Literal(UBits(60, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc, pb.Build(pb.AfterAll({send0, send1}), {b, a}));
+  EXPECT_THAT(RunMutualExclusionPass(proc), IsOkAndHolds(false));
+  EXPECT_EQ(NumberOfOp(proc, Op::kSend), 2);
+}
+
+TEST_F(MutualExclusionPassTest, ManyParallelSends) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * test_channel,
+      p->CreateStreamingChannel("test_channel", ChannelOps::kSendOnly,
+                                p->GetBitsType(32)));
+  // Enough pairs of predicates that the Z3 queries are split across threads.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc,
+      CreateManyParallelSendsProc(p.get(), "main", test_channel, 40));
+  EXPECT_THAT(RunMutualExclusionPass(proc), IsOkAndHolds(true));
+  EXPECT_EQ(NumberOfOp(proc, Op::kSend), 1);
+  XLS_EXPECT_OK(VerifyProc(proc, true));
+}
+
 TEST_F(MutualExclusionPassTest, ThreeParallelSends) {
   XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
      package test_module
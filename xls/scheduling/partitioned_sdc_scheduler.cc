@@ -0,0 +1,303 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/partitioned_sdc_scheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/scheduling/function_partition.h"
+#include "xls/scheduling/list_scheduler.h"
+#include "xls/scheduling/schedule_bounds.h"
+#include "xls/scheduling/scheduling_options.h"
+#include "xls/scheduling/sdc_scheduler.h"
+
+namespace xls {
+
+namespace {
+
+// Returns precomputed delays for the nodes of a region function.
+class RegionDelayEstimator : public DelayEstimator {
+ public:
+  RegionDelayEstimator() : DelayEstimator("partitioned_sdc_region") {}
+
+  void SetDelay(Node* node, int64_t delay) { delays_[node] = delay; }
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    auto it = delays_.find(node);
+    XLS_RET_CHECK(it != delays_.end())
+        << "No delay for region node " << node->GetName();
+    return it->second;
+  }
+
+ private:
+  absl::flat_hash_map<Node*, int64_t> delays_;
+};
+
+// A region of the partitioned function rebuilt as a standalone function which
+// the SDC scheduler can schedule independently of the other regions.
+//
+// The free (non-separator) nodes of the region are cloned. Each separator
+// operand of a free node is replaced by a literal pinned to the separator's
+// cycle whose delay is the separator's arrival time in that cycle, so paths
+// starting at the separator are timed as in the full function. Each separator
+// user of a free node is cloned and pinned to its cycle, followed by a pinned
+// guard node whose delay is the slack of the separator in its cycle, so no
+// path through the region reaches the separator later than it did in the
+// initial schedule. The other operands of such a separator are replaced by
+// zero-delay literals pinned to the separator's cycle.
+struct Region {
+  std::unique_ptr<Package> package;
+  Function* function;
+  std::unique_ptr<RegionDelayEstimator> delay_estimator;
+  std::vector<SchedulingConstraint> constraints;
+
+  // The free nodes of the partitioned function and their clones.
+  std::vector<std::pair<Node*, Node*>> free_nodes;
+};
+
+absl::StatusOr<Region> BuildRegion(
+    int64_t index, absl::Span<Node* const> nodes,
+    const absl::flat_hash_set<Node*>& separators,
+    const ScheduleCycleMap& initial_schedule,
+    const absl::flat_hash_map<Node*, int64_t>& delays,
+    const absl::flat_hash_map<Node*, int64_t>& arrivals,
+    int64_t clock_period_ps) {
+  Region region;
+  std::string name = absl::StrFormat("region_%d", index);
+  region.package = std::make_unique<Package>(name);
+  region.function = region.package->AddFunction(
+      std::make_unique<Function>(name, region.package.get()));
+  region.delay_estimator = std::make_unique<RegionDelayEstimator>();
+  Function* function = region.function;
+
+  auto add_pinned = [&](Node* node, int64_t cycle, int64_t delay) {
+    region.delay_estimator->SetDelay(node, delay);
+    region.constraints.push_back(NodeInCycleConstraint(node, cycle));
+  };
+  auto add_literal = [&](Node* original, int64_t cycle,
+                         int64_t delay) -> absl::StatusOr<Node*> {
+    XLS_ASSIGN_OR_RETURN(
+        Node * literal, function->MakeNode<Literal>(
+                            SourceInfo(), ZeroOfType(original->GetType())));
+    add_pinned(literal, cycle, delay);
+    return literal;
+  };
+
+  absl::flat_hash_map<Node*, Node*> clones;
+  std::vector<Node*> separator_users;
+  absl::flat_hash_set<Node*> separator_user_set;
+  for (Node* node : nodes) {
+    std::vector<Node*> operands;
+    operands.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      auto it = clones.find(operand);
+      if (it == clones.end()) {
+        XLS_RET_CHECK(separators.contains(operand))
+            << operand->GetName() << " is in another region";
+        XLS_ASSIGN_OR_RETURN(Node * literal,
+                             add_literal(operand, initial_schedule.at(operand),
+                                         arrivals.at(operand)));
+        it = clones.emplace(operand, literal).first;
+      }
+      operands.push_back(it->second);
+    }
+    XLS_ASSIGN_OR_RETURN(Node * clone,
+                         node->CloneInNewFunction(operands, function));
+    region.delay_estimator->SetDelay(clone, delays.at(node));
+    clones[node] = clone;
+    region.free_nodes.push_back({node, clone});
+    for (Node* user : node->users()) {
+      if (separators.contains(user) && separator_user_set.insert(user).second) {
+        separator_users.push_back(user);
+      }
+    }
+  }
+
+  for (Node* separator : separator_users) {
+    int64_t cycle = initial_schedule.at(separator);
+    std::vector<Node*> operands;
+    operands.reserve(separator->operand_count());
+    for (Node* operand : separator->operands()) {
+      auto it = clones.find(operand);
+      if (it != clones.end() && !separators.contains(operand)) {
+        operands.push_back(it->second);
+      } else {
+        XLS_ASSIGN_OR_RETURN(Node * literal,
+                             add_literal(operand, cycle, /*delay=*/0));
+        operands.push_back(literal);
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(Node * clone,
+                         separator->CloneInNewFunction(operands, function));
+    add_pinned(clone, cycle, delays.at(separator));
+    XLS_ASSIGN_OR_RETURN(
+        Node * guard,
+        function->MakeNode<UnOp>(SourceInfo(), clone, Op::kIdentity));
+    add_pinned(guard, cycle, clock_period_ps - arrivals.at(separator));
+  }
+
+  XLS_ASSIGN_OR_RETURN(
+      Node * return_value,
+      function->MakeNode<Literal>(SourceInfo(), Value(UBits(0, 1))));
+  region.delay_estimator->SetDelay(return_value, 0);
+  XLS_RETURN_IF_ERROR(function->set_return_value(return_value));
+  return region;
+}
+
+absl::StatusOr<ScheduleCycleMap> ScheduleRegion(const Region& region,
+                                                int64_t pipeline_stages,
+                                                int64_t clock_period_ps) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<SDCScheduler> scheduler,
+      SDCScheduler::Create(region.function, *region.delay_estimator));
+  XLS_RETURN_IF_ERROR(scheduler->AddConstraints(region.constraints));
+  SchedulingFailureBehavior failure_behavior;
+  failure_behavior.explain_infeasibility = false;
+  return scheduler->Schedule(pipeline_stages, clock_period_ps,
+                             failure_behavior);
+}
+
+}  // namespace
+
+absl::StatusOr<ScheduleCycleMap> PartitionedSDCScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    absl::Span<const SchedulingConstraint> constraints,
+    int64_t max_region_size, int64_t threads) {
+  if (!f->IsFunction()) {
+    return absl::UnimplementedError(
+        "The partitioned SDC scheduler only supports functions.");
+  }
+  XLS_RET_CHECK_GT(max_region_size, 0);
+  XLS_RET_CHECK_GT(threads, 0);
+  XLS_ASSIGN_OR_RETURN(
+      ScheduleCycleMap cycle_map,
+      ListScheduler(f, pipeline_stages, clock_period_ps, delay_estimator,
+                    bounds, constraints));
+
+  // The delay of each node, and the time at which its value becomes available
+  // within its cycle of the initial schedule.
+  absl::flat_hash_map<Node*, int64_t> delays;
+  absl::flat_hash_map<Node*, int64_t> arrivals;
+  delays.reserve(f->node_count());
+  arrivals.reserve(f->node_count());
+  for (Node* node : TopoSort(f)) {
+    XLS_ASSIGN_OR_RETURN(int64_t delay,
+                         delay_estimator.GetOperationDelayInPs(node));
+    int64_t arrival = 0;
+    for (Node* operand : node->operands()) {
+      if (cycle_map.at(operand) == cycle_map.at(node)) {
+        arrival = std::max(arrival, arrivals.at(operand));
+      }
+    }
+    delays[node] = delay;
+    arrivals[node] = arrival + delay;
+  }
+
+  std::vector<Node*> separators;
+  for (Node* node : f->nodes()) {
+    if (node->operand_count() == 0) {
+      separators.push_back(node);
+    }
+  }
+  separators.push_back(f->AsFunctionOrDie()->return_value());
+  for (const SchedulingConstraint& constraint : constraints) {
+    if (std::holds_alternative<NodeInCycleConstraint>(constraint)) {
+      separators.push_back(
+          std::get<NodeInCycleConstraint>(constraint).GetNode());
+    }
+  }
+  sched::RegionPartition partition =
+      sched::PartitionIntoRegions(f, separators, max_region_size);
+  VLOG(2) << absl::StreamFormat(
+      "Partitioned %s into %d regions with %d separators", f->name(),
+      partition.regions.size(), partition.separators.size());
+
+  std::vector<Region> regions;
+  regions.reserve(partition.regions.size());
+  for (int64_t i = 0; i < partition.regions.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(
+        Region region,
+        BuildRegion(i, partition.regions[i], partition.separators, cycle_map,
+                    delays, arrivals, clock_period_ps));
+    regions.push_back(std::move(region));
+  }
+
+  // Each worker schedules every `worker_count`-th region.
+  std::vector<absl::StatusOr<ScheduleCycleMap>> region_schedules(
+      regions.size());
+  int64_t worker_count = std::min<int64_t>(threads, regions.size());
+  auto work = [&](int64_t worker) {
+    for (int64_t i = worker; i < regions.size(); i += worker_count) {
+      region_schedules[i] =
+          ScheduleRegion(regions[i], pipeline_stages, clock_period_ps);
+    }
+  };
+  if (worker_count == 1) {
+    work(0);
+  } else {
+    std::vector<std::unique_ptr<Thread>> workers;
+    workers.reserve(worker_count);
+    for (int64_t i = 0; i < worker_count; ++i) {
+      workers.push_back(std::make_unique<Thread>([&, i]() { work(i); }));
+    }
+    for (std::unique_ptr<Thread>& worker : workers) {
+      worker->Join();
+    }
+  }
+
+  for (int64_t i = 0; i < regions.size(); ++i) {
+    if (!region_schedules[i].ok()) {
+      LOG(WARNING) << absl::StreamFormat(
+          "Unable to schedule region %d of %s with the SDC scheduler; keeping "
+          "its list schedule: %s",
+          i, f->name(), region_schedules[i].status().ToString());
+      continue;
+    }
+    for (const auto& [node, clone] : regions[i].free_nodes) {
+      cycle_map[node] = region_schedules[i]->at(clone);
+    }
+  }
+  return cycle_map;
+}
+
+}  // namespace xls
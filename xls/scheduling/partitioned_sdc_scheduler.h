@@ -0,0 +1,60 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SCHEDULING_PARTITIONED_SDC_SCHEDULER_H_
+#define XLS_SCHEDULING_PARTITIONED_SDC_SCHEDULER_H_
+
+#include <cstdint>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/scheduling/schedule_bounds.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+
+// The default maximum number of nodes in a region scheduled by
+// PartitionedSDCScheduler.
+inline constexpr int64_t kDefaultMaxSchedulingRegionSize = 2048;
+
+// Schedules the given function into a pipeline with the given clock period by
+// solving many small SDC problems in parallel instead of one for the whole
+// function. Intended for functions too large for the SDC scheduler.
+//
+// The function is first scheduled with ListScheduler. Its nodes are then
+// partitioned into regions of at most `max_region_size` nodes separated by
+// nodes which keep their cycle from the list schedule: the nodes without
+// operands, the return value, the nodes of node-in-cycle constraints and the
+// nodes needed to split large regions (see sched::PartitionIntoRegions). Each
+// region is rescheduled with the SDC scheduler using up to `threads` threads.
+// The region's separators are pinned to their cycles, and the combinational
+// paths through them are limited to their delays in the list schedule, so the
+// rescheduled regions can be combined into a valid schedule of the whole
+// function. A region which fails to schedule keeps its list schedule.
+//
+// Each region minimizes its own pipeline registers, so a value used by several
+// regions may be registered for longer than in a schedule of the whole
+// function. Only functions are supported.
+absl::StatusOr<ScheduleCycleMap> PartitionedSDCScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    absl::Span<const SchedulingConstraint> constraints,
+    int64_t max_region_size = kDefaultMaxSchedulingRegionSize,
+    int64_t threads = 1);
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_PARTITIONED_SDC_SCHEDULER_H_
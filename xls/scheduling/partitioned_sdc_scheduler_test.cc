@@ -0,0 +1,129 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests of the partitioned SDC scheduler. These go through
+// RunPipelineSchedule, which verifies that the stitched schedule satisfies the
+// dependencies and the clock period.
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/benchmark_support.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/run_pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+namespace {
+
+using ::xls::benchmark_support::ScalingDesign;
+
+class PartitionedSDCSchedulerTest : public IrTestBase {};
+
+TEST_F(PartitionedSDCSchedulerTest, NoMoreRegistersThanList) {
+  for (ScalingDesign design :
+       {ScalingDesign::kChain, ScalingDesign::kBalancedTree,
+        ScalingDesign::kLadder}) {
+    auto p = CreatePackage();
+    XLS_ASSERT_OK_AND_ASSIGN(
+        FunctionBase * f,
+        benchmark_support::GenerateScalingDesign(design, p.get(), 64));
+
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule list,
+        RunPipelineSchedule(
+            f, TestDelayEstimator(),
+            SchedulingOptions(SchedulingStrategy::LIST).clock_period_ps(3)));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule schedule,
+        RunPipelineSchedule(
+            f, TestDelayEstimator(),
+            SchedulingOptions(SchedulingStrategy::PARTITIONED_SDC)
+                .clock_period_ps(3)
+                .pipeline_stages(list.length())));
+    EXPECT_LE(schedule.CountFinalInteriorPipelineRegisters(),
+              list.CountFinalInteriorPipelineRegisters())
+        << f->name();
+  }
+}
+
+TEST_F(PartitionedSDCSchedulerTest, IndependentLanes) {
+  // Each lane negates its input three times and then adds a zero-extended
+  // control bit, which is best computed next to its user. Every lane is a
+  // region of its own with a region size of five.
+  constexpr int64_t kLanes = 8;
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  std::vector<BValue> wide_bits;
+  std::vector<BValue> lanes;
+  for (int64_t i = 0; i < kLanes; ++i) {
+    BValue x = fb.Param(absl::StrFormat("x%d", i), p->GetBitsType(32));
+    BValue b = fb.Param(absl::StrFormat("b%d", i), p->GetBitsType(1));
+    BValue neg = fb.Negate(fb.Negate(fb.Negate(x)));
+    wide_bits.push_back(fb.ZeroExtend(b, 32));
+    lanes.push_back(fb.Concat({neg, wide_bits.back()}));
+  }
+  fb.Tuple(lanes);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule asap,
+      RunPipelineSchedule(
+          f, TestDelayEstimator(),
+          SchedulingOptions(SchedulingStrategy::ASAP).clock_period_ps(1)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(
+          f, TestDelayEstimator(),
+          SchedulingOptions(SchedulingStrategy::PARTITIONED_SDC)
+              .clock_period_ps(1)
+              .max_scheduling_region_size(5)
+              .scheduling_threads(4)));
+
+  EXPECT_EQ(schedule.length(), asap.length());
+  for (BValue wide_b : wide_bits) {
+    EXPECT_EQ(schedule.cycle(wide_b.node()), schedule.length() - 2);
+  }
+  EXPECT_LT(schedule.CountFinalInteriorPipelineRegisters(),
+            asap.CountFinalInteriorPipelineRegisters());
+}
+
+TEST_F(PartitionedSDCSchedulerTest, SplitsLargeRegions) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           benchmark_support::GenerateLadder(p.get(), 16));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(
+          f, TestDelayEstimator(),
+          SchedulingOptions(SchedulingStrategy::PARTITIONED_SDC)
+              .clock_period_ps(3)
+              .pipeline_stages(8)
+              .max_scheduling_region_size(8)
+              .scheduling_threads(2)));
+  EXPECT_EQ(schedule.length(), 8);
+}
+
+}  // namespace
+}  // namespace xls
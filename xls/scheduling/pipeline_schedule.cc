@@ -142,40 +142,44 @@ absl::Span<Node* const> PipelineSchedule::nodes_in_cycle(int64_t cycle) const {
   return absl::Span<Node* const>();
 }
 
-bool PipelineSchedule::IsLiveOutOfCycle(Node* node, int64_t c) const {
+std::optional<int64_t> PipelineSchedule::LastCycleLiveOutOf(
+    Node* node) const {
   Function* as_func = dynamic_cast<Function*>(function_base_);
 
-  if (cycle(node) > c) {
-    return false;
-  }
-
-  if (c >= length() - 1) {
-    return false;
-  }
-
+  // Values are never live out of the final cycle.
+  int64_t last_cycle = -1;
   if ((as_func != nullptr) && (node == as_func->return_value())) {
-    return true;
-  }
-
-  for (Node* user : node->users()) {
-    if (cycle(user) <= c) {
-      continue;
-    }
-    if (user->Is<Next>()) {
-      Next* user_next = user->As<Next>();
-      if (user_next->predicate() != node && user_next->value() != node) {
-        CHECK_EQ(user_next->param(), node);
-        // This Next node only uses this Param node to target the state register
-        // it needs to write to; it doesn't actually need the value read out of
-        // the Param node, so we don't need to keep the value in pipeline
-        // registers for its sake.
-        continue;
+    last_cycle = length() - 2;
+  } else {
+    for (Node* user : node->users()) {
+      if (user->Is<Next>()) {
+        Next* user_next = user->As<Next>();
+        if (user_next->predicate() != node && user_next->value() != node) {
+          CHECK_EQ(user_next->param(), node);
+          // This Next node only uses this Param node to target the state
+          // register it needs to write to; it doesn't actually need the value
+          // read out of the Param node, so we don't need to keep the value in
+          // pipeline registers for its sake.
+          continue;
+        }
       }
+      last_cycle = std::max(last_cycle, cycle(user) - 1);
     }
-    return true;
+    last_cycle = std::min(last_cycle, length() - 2);
   }
 
-  return false;
+  if (last_cycle < cycle(node)) {
+    return std::nullopt;
+  }
+  return last_cycle;
+}
+
+bool PipelineSchedule::IsLiveOutOfCycle(Node* node, int64_t c) const {
+  if (cycle(node) > c) {
+    return false;
+  }
+  std::optional<int64_t> last_cycle = LastCycleLiveOutOf(node);
+  return last_cycle.has_value() && c <= *last_cycle;
 }
 
 std::vector<Node*> PipelineSchedule::GetLiveOutOfCycle(int64_t c) const {
@@ -258,53 +262,71 @@ absl::Status PipelineSchedule::Verify() const {
 
 absl::Status PipelineSchedule::VerifyTiming(
     int64_t clock_period_ps, const DelayEstimator& delay_estimator) const {
-  // Critical path from start of the cycle that a node is scheduled through the
-  // node itself. If the schedule meets timing, then this value should be less
-  // than or equal to clock_period_ps for every node.
-  absl::flat_hash_map<Node*, int64_t> node_cp;
-  // The predecessor (operand) of the node through which the critical-path from
-  // the start of the cycle extends.
-  absl::flat_hash_map<Node*, Node*> cp_pred;
+  absl::flat_hash_map<Node*, int64_t> node_delays;
+  node_delays.reserve(function_base_->node_count());
+  for (Node* node : function_base_->nodes()) {
+    XLS_ASSIGN_OR_RETURN(node_delays[node],
+                         delay_estimator.GetOperationDelayInPs(node));
+  }
+  return VerifyTiming(clock_period_ps, node_delays);
+}
+
+absl::Status PipelineSchedule::VerifyTiming(
+    int64_t clock_period_ps,
+    const absl::flat_hash_map<Node*, int64_t>& node_delays) const {
+  // The critical path from the start of the cycle in which a node is scheduled
+  // through the node itself, and the predecessor (operand) of the node through
+  // which that path extends. If the schedule meets timing, then the path is no
+  // longer than clock_period_ps for every node. Both are computed in a single
+  // pass over the nodes in topological order.
+  struct CriticalPath {
+    int64_t delay;
+    Node* pred;
+  };
+  absl::flat_hash_map<Node*, CriticalPath> node_cp;
+  node_cp.reserve(function_base_->node_count());
   // The node with the longest critical path from the start of the stage in the
   // entire schedule.
   Node* max_cp_node = nullptr;
+  int64_t max_cp = 0;
   for (Node* node : TopoSort(function_base_)) {
+    int64_t node_cycle = cycle(node);
     // The critical-path delay from the start of the stage to the start of the
     // node.
-    int64_t cp_to_node_start = 0;
-    cp_pred[node] = nullptr;
+    CriticalPath cp{.delay = 0, .pred = nullptr};
     for (Node* operand : node->operands()) {
-      if (cycle(operand) == cycle(node)) {
-        if (cp_to_node_start < node_cp.at(operand)) {
-          cp_to_node_start = node_cp.at(operand);
-          cp_pred[node] = operand;
+      if (cycle(operand) == node_cycle) {
+        const CriticalPath& operand_cp = node_cp.at(operand);
+        if (cp.delay < operand_cp.delay) {
+          cp = CriticalPath{.delay = operand_cp.delay, .pred = operand};
         }
       }
     }
-    XLS_ASSIGN_OR_RETURN(int64_t node_delay,
-                         delay_estimator.GetOperationDelayInPs(node));
-    node_cp[node] = cp_to_node_start + node_delay;
-    if (max_cp_node == nullptr || node_cp[node] > node_cp[max_cp_node]) {
+    auto it = node_delays.find(node);
+    XLS_RET_CHECK(it != node_delays.end())
+        << "No delay given for node " << node->GetName();
+    cp.delay += it->second;
+    node_cp.emplace(node, cp);
+    if (max_cp_node == nullptr || cp.delay > max_cp) {
       max_cp_node = node;
+      max_cp = cp.delay;
     }
   }
 
-  if (node_cp[max_cp_node] > clock_period_ps) {
+  if (max_cp > clock_period_ps) {
     std::vector<Node*> path;
     Node* node = max_cp_node;
     do {
       path.push_back(node);
-      node = cp_pred[node];
+      node = node_cp.at(node).pred;
     } while (node != nullptr);
     std::reverse(path.begin(), path.end());
     return absl::InternalError(absl::StrFormat(
         "Schedule does not meet timing (%dps). Longest failing path (%dps): %s",
-        clock_period_ps, node_cp[max_cp_node],
+        clock_period_ps, max_cp,
         absl::StrJoin(path, " -> ", [&](std::string* out, Node* n) {
-          absl::StrAppend(
-              out, absl::StrFormat(
-                       "%s (%dps)", n->GetName(),
-                       delay_estimator.GetOperationDelayInPs(n).value()));
+          absl::StrAppendFormat(out, "%s (%dps)", n->GetName(),
+                                node_delays.at(n));
         })));
   }
   return absl::OkStatus();
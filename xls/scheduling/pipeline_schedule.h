@@ -80,6 +80,13 @@ class PipelineSchedule {
   // Returns true if the given node is live out of the given cycle.
   bool IsLiveOutOfCycle(Node* node, int64_t c) const;
 
+  // Returns the last cycle the given node is live out of, or std::nullopt if
+  // the node is not live out of any cycle. A node is live out of every cycle
+  // from cycle(node) through the returned cycle inclusive. This visits the
+  // users of the node once so it is cheaper than calling IsLiveOutOfCycle for
+  // every cycle.
+  std::optional<int64_t> LastCycleLiveOutOf(Node* node) const;
+
   // Returns the number of stages in the pipeline. Use 'length' instead of
   // 'size' as 'size' is ambiguous in this context (number of resources? number
   // of nodes? number of cycles?). Note that codegen may add flops to the input
@@ -97,6 +104,11 @@ class PipelineSchedule {
                             const DelayEstimator& delay_estimator) const;
   absl::Status VerifyTiming(int64_t clock_period_ps,
                             const DelayManager& delay_manager) const;
+  // As above, with the delay of every node given by `node_delays`. This avoids
+  // estimating the delays again when the scheduler has already done so.
+  absl::Status VerifyTiming(
+      int64_t clock_period_ps,
+      const absl::flat_hash_map<Node*, int64_t>& node_delays) const;
 
   // Verifies that all scheduling constraints are followed.
   absl::Status VerifyConstraints(
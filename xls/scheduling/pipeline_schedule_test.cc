@@ -17,18 +17,22 @@
 #include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <memory>
+#include <optional>
 #include <string_view>
 #include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "xls/area_model/area_estimator.h"
 #include "xls/common/status/matchers.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/delay_model/delay_estimators.h"
@@ -39,6 +43,7 @@
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
@@ -88,6 +93,7 @@ namespace {
 
 using ::testing::Each;
 using ::testing::HasSubstr;
+using ::testing::Optional;
 using ::testing::UnorderedElementsAre;
 using ::testing::UnorderedPointwise;
 using xls::status_testing::StatusIs;
@@ -271,6 +277,59 @@ TEST_F(PipelineScheduleTest, MinimizeRegisterBitslices) {
       UnorderedElementsAre(m::BitSlice(m::Param("x")), m::Neg(), m::Concat()));
 }
 
+// An area model in which narrow registers are expensive per bit.
+class NarrowRegistersAreaEstimator : public AreaEstimator {
+ public:
+  NarrowRegistersAreaEstimator()
+      : AreaEstimator("narrow_registers", /*register_area_per_bit=*/1) {}
+
+  absl::StatusOr<int64_t> GetOperationArea(Node* node) const override {
+    return 1;
+  }
+
+  int64_t GetRegisterArea(int64_t bit_count) const override {
+    return bit_count <= 8 ? 100 * bit_count : bit_count;
+  }
+};
+
+TEST_F(PipelineScheduleTest, MinimizeRegisterArea) {
+  // As in MinimizeRegisterBitslices but registering the 8-bit slice of 'y' is
+  // more expensive than registering 'y' itself.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto x_slice = fb.BitSlice(x, /*start=*/8, /*width=*/8);
+  auto y_slice = fb.BitSlice(y, /*start=*/8, /*width=*/8);
+  auto neg_neg_y = fb.Negate(fb.Negate(y));
+  fb.Concat({x, x_slice, y_slice, neg_neg_y});
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK(GetAreaEstimatorManagerSingleton().RegisterAreaEstimator(
+      std::make_unique<NarrowRegistersAreaEstimator>(),
+      AreaEstimatorPrecedence::kLow));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(
+          f, TestDelayEstimator(),
+          SchedulingOptions().clock_period_ps(1).area_model(
+              "narrow_registers")));
+
+  EXPECT_EQ(schedule.length(), 2);
+  EXPECT_THAT(schedule.nodes_in_cycle(0),
+              UnorderedElementsAre(m::Param("x"), m::Param("y"), m::Neg()));
+  EXPECT_THAT(schedule.nodes_in_cycle(1),
+              UnorderedElementsAre(m::BitSlice(m::Param("x")),
+                                   m::BitSlice(m::Param("y")), m::Neg(),
+                                   m::Concat()));
+
+  EXPECT_THAT(RunPipelineSchedule(
+                  f, TestDelayEstimator(),
+                  SchedulingOptions().clock_period_ps(1).area_model("unknown")),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
 TEST_F(PipelineScheduleTest, AsapScheduleComplex) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
@@ -367,6 +426,21 @@ TEST_F(PipelineScheduleTest, TestVerifyTiming) {
           ::testing::HasSubstr(
               "Schedule does not meet timing (1ps). Longest failing path "
               "(3ps): add.3 (1ps) -> neg.4 (1ps) -> sub.5 (1ps)")));
+
+  // Precomputed delays are used as given.
+  absl::flat_hash_map<Node*, int64_t> node_delays;
+  for (Node* node : func->nodes()) {
+    node_delays[node] = node->Is<Param>() ? 0 : 1;
+  }
+  node_delays[x_plus_y.node()] = 3;
+  XLS_EXPECT_OK(schedule.VerifyTiming(/*clock_period_ps=*/5, node_delays));
+  EXPECT_THAT(
+      schedule.VerifyTiming(/*clock_period_ps=*/4, node_delays),
+      status_testing::StatusIs(
+          absl::StatusCode::kInternal,
+          ::testing::HasSubstr(
+              "Schedule does not meet timing (4ps). Longest failing path "
+              "(5ps): add.3 (3ps) -> neg.4 (1ps) -> sub.5 (1ps)")));
 }
 
 TEST_F(PipelineScheduleTest, ClockPeriodAndPipelineLengthGiven) {
@@ -442,6 +516,30 @@ TEST_F(PipelineScheduleTest, JustPipelineLengthGiven) {
   EXPECT_THAT(scheduled_ops(5), UnorderedElementsAre(Op::kNeg));
 }
 
+TEST_F(PipelineScheduleTest, JustPipelineLengthGivenWithThreads) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  for (int64_t i = 0; i < 30; ++i) {
+    x = fb.Negate(x);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  // The critical path is 30ps so the minimum clock period for four stages is
+  // 8ps regardless of how many candidate clock periods are evaluated at once.
+  for (int64_t threads : {1, 2, 3, 8, 64}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule schedule,
+        RunPipelineSchedule(
+            func, TestDelayEstimator(),
+            SchedulingOptions().pipeline_stages(4).scheduling_threads(threads)));
+    EXPECT_EQ(schedule.length(), 4);
+    XLS_EXPECT_OK(schedule.VerifyTiming(8, TestDelayEstimator()));
+    EXPECT_FALSE(schedule.VerifyTiming(7, TestDelayEstimator()).ok())
+        << threads << " threads";
+  }
+}
+
 TEST_F(PipelineScheduleTest, LongPipelineLength) {
   // Generate an absurdly long pipeline schedule. Most stages are empty, but it
   // should not crash.
@@ -615,6 +713,42 @@ TEST_F(PipelineScheduleTest, NodeDelayInScheduleProto) {
   }
 }
 
+TEST_F(PipelineScheduleTest, LastCycleLiveOutOf) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue neg_x = fb.Negate(x);
+  BValue sum = fb.Add(neg_x, y);
+  BValue unused = fb.Not(y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(sum));
+
+  PipelineSchedule schedule(f,
+                            ScheduleCycleMap({{x.node(), 0},
+                                              {y.node(), 0},
+                                              {neg_x.node(), 1},
+                                              {unused.node(), 1},
+                                              {sum.node(), 3}}),
+                            /*length=*/5);
+
+  EXPECT_THAT(schedule.LastCycleLiveOutOf(x.node()), Optional(0));
+  EXPECT_THAT(schedule.LastCycleLiveOutOf(y.node()), Optional(2));
+  EXPECT_THAT(schedule.LastCycleLiveOutOf(neg_x.node()), Optional(2));
+  EXPECT_EQ(schedule.LastCycleLiveOutOf(unused.node()), std::nullopt);
+  // The return value is live out of every cycle except the last.
+  EXPECT_THAT(schedule.LastCycleLiveOutOf(sum.node()), Optional(3));
+
+  for (Node* node : f->nodes()) {
+    std::optional<int64_t> last_cycle = schedule.LastCycleLiveOutOf(node);
+    for (int64_t c = 0; c < schedule.length(); ++c) {
+      EXPECT_EQ(schedule.IsLiveOutOfCycle(node, c),
+                last_cycle.has_value() && schedule.cycle(node) <= c &&
+                    c <= *last_cycle)
+          << node->GetName() << " in cycle " << c;
+    }
+  }
+}
+
 TEST_F(PipelineScheduleTest, ProcSchedule) {
   Package p("p");
   Type* u16 = p.GetBitsType(16);
@@ -15,7 +15,9 @@
 #include "xls/scheduling/proc_state_legalization_pass.h"
 
 #include <cstdint>
+#include <memory>
 #include <optional>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -61,8 +63,11 @@ absl::StatusOr<bool> ModernizeNextValues(Proc* proc) {
   return proc->GetStateElementCount() > 0;
 }
 
-absl::StatusOr<bool> AddDefaultNextValue(Proc* proc, Param* param,
-                                         const SchedulingPassOptions& options) {
+// `prover_session` is created on first use so the proc is translated at most
+// once for all of its state params.
+absl::StatusOr<bool> AddDefaultNextValue(
+    Proc* proc, Param* param, const SchedulingPassOptions& options,
+    std::unique_ptr<solvers::z3::ProverSession>& prover_session) {
   absl::btree_set<Node*, Node::NodeIdLessThan> predicates;
   for (Next* next : proc->next_values(param)) {
     if (next->predicate().has_value()) {
@@ -126,14 +131,23 @@ absl::StatusOr<bool> AddDefaultNextValue(Proc* proc, Param* param,
       });
     }
 
-    absl::StatusOr<solvers::z3::ProverResult> no_default_needed =
-        solvers::z3::TryProveDisjunction(
-            proc, z3_predicates,
-            /*rlimit=*/*default_next_value_z3_rlimit,
-            /*allow_unsupported=*/true);
-    if (no_default_needed.ok() &&
-        std::holds_alternative<solvers::z3::ProvenTrue>(*no_default_needed)) {
-      return false;
+    if (prover_session == nullptr) {
+      absl::StatusOr<std::unique_ptr<solvers::z3::ProverSession>> session =
+          solvers::z3::ProverSession::Create(
+              proc, /*rlimit=*/*default_next_value_z3_rlimit,
+              /*allow_unsupported=*/true);
+      if (session.ok()) {
+        prover_session = *std::move(session);
+      }
+    }
+    if (prover_session != nullptr) {
+      absl::StatusOr<solvers::z3::ProverResult> no_default_needed =
+          prover_session->TryProveDisjunction(z3_predicates);
+      if (no_default_needed.ok() &&
+          std::holds_alternative<solvers::z3::ProvenTrue>(
+              *no_default_needed)) {
+        return false;
+      }
     }
   }
 
@@ -156,9 +170,11 @@ absl::StatusOr<bool> AddDefaultNextValues(
     Proc* proc, const SchedulingPassOptions& options) {
   bool changed = false;
 
+  std::unique_ptr<solvers::z3::ProverSession> prover_session;
   for (Param* param : proc->StateParams()) {
-    XLS_ASSIGN_OR_RETURN(bool param_changed,
-                         AddDefaultNextValue(proc, param, options));
+    XLS_ASSIGN_OR_RETURN(
+        bool param_changed,
+        AddDefaultNextValue(proc, param, options, prover_session));
     if (param_changed) {
       VLOG(4) << "Added default next_value for param: " << param->name();
       changed = true;
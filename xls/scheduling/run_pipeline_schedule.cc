@@ -27,6 +27,7 @@
 #include "absl/algorithm/container.h"
 #include "absl/base/log_severity.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/random/distributions.h"
@@ -36,9 +37,13 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
+#include "xls/area_model/area_estimator.h"
+#include "xls/area_model/area_estimators.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/common/trace.h"
 #include "xls/data_structures/binary_search.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/fdo/delay_manager.h"
@@ -49,7 +54,9 @@
 #include "xls/ir/node.h"
 #include "xls/ir/op.h"
 #include "xls/ir/topo_sort.h"
+#include "xls/scheduling/list_scheduler.h"
 #include "xls/scheduling/min_cut_scheduler.h"
+#include "xls/scheduling/partitioned_sdc_scheduler.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/schedule_bounds.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -176,6 +183,59 @@ absl::StatusOr<int64_t> ComputeCriticalPath(
   return ComputeCriticalPath(TopoSort(f), delay_estimator);
 }
 
+// Finds the minimum value in the inclusive range [start, end] for which `f`
+// returns true, where `f(end)` is known to be true and `f` is monotonic over
+// the range. This is a k-ary generalization of BinarySearchMinTrue: each round
+// evaluates up to `worker_count` evenly spaced points concurrently, calling
+// `f(worker, value)` on a separate thread for each worker index, and narrows
+// the range to the interval between the last false and first true point.
+int64_t ParallelSearchMinTrue(
+    int64_t start, int64_t end, int64_t worker_count,
+    absl::FunctionRef<bool(int64_t worker, int64_t value)> f) {
+  CHECK_LE(start, end);
+  CHECK_GT(worker_count, 0);
+  int64_t lo = start;
+  int64_t hi = end;
+  while (lo < hi) {
+    // Candidates are [lo, hi); `hi` is known to be true.
+    int64_t n = hi - lo;
+    int64_t k = std::min(worker_count, n);
+    std::vector<int64_t> probes(k);
+    for (int64_t i = 0; i < k; ++i) {
+      probes[i] = lo + ((i + 1) * n) / (k + 1);
+    }
+    // std::vector<bool> is not safe for concurrent writes to distinct elements.
+    std::vector<char> results(k);
+    if (k == 1) {
+      results[0] = f(0, probes[0]);
+    } else {
+      std::vector<std::unique_ptr<Thread>> threads;
+      threads.reserve(k);
+      for (int64_t i = 0; i < k; ++i) {
+        threads.push_back(std::make_unique<Thread>(
+            [&, i]() { results[i] = f(i, probes[i]); }));
+      }
+      for (std::unique_ptr<Thread>& thread : threads) {
+        thread->Join();
+      }
+    }
+    int64_t first_true = k;
+    for (int64_t i = 0; i < k; ++i) {
+      if (results[i]) {
+        first_true = i;
+        break;
+      }
+    }
+    if (first_true < k) {
+      hi = probes[first_true];
+    }
+    if (first_true > 0) {
+      lo = probes[first_true - 1] + 1;
+    }
+  }
+  return hi;
+}
+
 // Returns the minimum clock period in picoseconds for which it is feasible to
 // schedule the function into a pipeline with the given number of stages. If
 // `target_clock_period_ps` is specified, will not try to check lower clock
@@ -183,7 +243,7 @@ absl::StatusOr<int64_t> ComputeCriticalPath(
 absl::StatusOr<int64_t> FindMinimumClockPeriod(
     FunctionBase* f, std::optional<int64_t> pipeline_stages,
     const DelayEstimator& delay_estimator, SDCScheduler& scheduler,
-    SchedulingFailureBehavior failure_behavior,
+    SchedulingFailureBehavior failure_behavior, int64_t thread_count,
     std::optional<int64_t> target_clock_period_ps = std::nullopt) {
   VLOG(4) << "FindMinimumClockPeriod()";
   VLOG(4) << "  pipeline stages = "
@@ -229,16 +289,58 @@ absl::StatusOr<int64_t> FindMinimumClockPeriod(
   // Don't waste time explaining infeasibility for the failing points in the
   // search.
   failure_behavior.explain_infeasibility = false;
-  int64_t min_clk_period_ps = BinarySearchMinTrue(
-      optimistic_clk_period_ps, pessimistic_clk_period_ps,
-      [&](int64_t clk_period_ps) {
-        return scheduler
-            .Schedule(pipeline_stages, clk_period_ps,
-                      failure_behavior,
-                      /*check_feasibility=*/true)
-            .ok();
-      },
-      BinarySearchAssumptions::kEndKnownTrue);
+  int64_t worker_count = std::max(
+      int64_t{1}, std::min(thread_count, pessimistic_clk_period_ps -
+                                             optimistic_clk_period_ps));
+  int64_t min_clk_period_ps;
+  if (worker_count <= 1) {
+    min_clk_period_ps = BinarySearchMinTrue(
+        optimistic_clk_period_ps, pessimistic_clk_period_ps,
+        [&](int64_t clk_period_ps) {
+          return scheduler
+              .Schedule(pipeline_stages, clk_period_ps, failure_behavior,
+                        /*check_feasibility=*/true)
+              .ok();
+        },
+        BinarySearchAssumptions::kEndKnownTrue);
+  } else {
+    // Each worker needs its own scheduler as the model is updated for each
+    // probed clock period. The clones share the node delays and critical-path
+    // distances of `scheduler` so they are cheap to create.
+    std::vector<std::unique_ptr<SDCScheduler>> clones(worker_count - 1);
+    std::vector<absl::Status> clone_statuses(worker_count - 1);
+    {
+      std::vector<std::unique_ptr<Thread>> threads;
+      threads.reserve(worker_count - 1);
+      for (int64_t i = 0; i < worker_count - 1; ++i) {
+        threads.push_back(std::make_unique<Thread>([&, i]() {
+          absl::StatusOr<std::unique_ptr<SDCScheduler>> clone =
+              scheduler.Clone();
+          if (clone.ok()) {
+            clones[i] = *std::move(clone);
+          } else {
+            clone_statuses[i] = clone.status();
+          }
+        }));
+      }
+    }
+    for (const absl::Status& status : clone_statuses) {
+      XLS_RETURN_IF_ERROR(status);
+    }
+    std::vector<SDCScheduler*> schedulers = {&scheduler};
+    for (std::unique_ptr<SDCScheduler>& clone : clones) {
+      schedulers.push_back(clone.get());
+    }
+    VLOG(4) << absl::StreamFormat("Searching with %d workers", worker_count);
+    min_clk_period_ps = ParallelSearchMinTrue(
+        optimistic_clk_period_ps, pessimistic_clk_period_ps, worker_count,
+        [&](int64_t worker, int64_t clk_period_ps) {
+          return schedulers[worker]
+              ->Schedule(pipeline_stages, clk_period_ps, failure_behavior,
+                         /*check_feasibility=*/true)
+              .ok();
+        });
+  }
   VLOG(4) << "minimum clock period = " << min_clk_period_ps;
 
   return min_clk_period_ps;
@@ -322,6 +424,8 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
     FunctionBase* f, const DelayEstimator& delay_estimator,
     const SchedulingOptions& options,
     const synthesis::Synthesizer* synthesizer) {
+  TraceSpan span("schedule");
+  span.AddArg("function", f->name());
   if (!options.pipeline_stages().has_value() &&
       !options.clock_period_ps().has_value()) {
     return absl::InvalidArgumentError(
@@ -350,13 +454,21 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
   if (!options.clock_period_ps().has_value() ||
       (options.minimize_worst_case_throughput().value_or(false) &&
        f->IsProc() && f->GetInitiationInterval().value_or(1) <= 0) ||
-      options.strategy() == SchedulingStrategy::SDC) {
+      options.strategy() == SchedulingStrategy::SDC ||
+      (options.strategy() == SchedulingStrategy::LIST &&
+       options.refine_list_schedule_with_sdc())) {
     // We currently use the SDC scheduler to determine the minimum clock period
     // (if not specified) and worst-case throughput (if minimization is
-    // requested), even if we're not using it for the final schedule.
+    // requested), even if we're not using it for the final schedule. It may
+    // also refine the result of the list scheduler.
     XLS_ASSIGN_OR_RETURN(sdc_scheduler,
                          SDCScheduler::Create(f, input_delay_added));
     XLS_RETURN_IF_ERROR(sdc_scheduler->AddConstraints(options.constraints()));
+    if (options.area_model().has_value()) {
+      XLS_ASSIGN_OR_RETURN(AreaEstimator * area_estimator,
+                           GetAreaEstimator(*options.area_model()));
+      sdc_scheduler->SetAreaEstimator(area_estimator);
+    }
   }
 
   int64_t clock_period_ps;
@@ -384,7 +496,8 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
     XLS_ASSIGN_OR_RETURN(
         clock_period_ps,
         FindMinimumClockPeriod(f, options.pipeline_stages(), input_delay_added,
-                               *sdc_scheduler, options.failure_behavior()));
+                               *sdc_scheduler, options.failure_behavior(),
+                               options.scheduling_threads()));
 
     if (options.period_relaxation_percent().has_value()) {
       int64_t relaxation_percent = options.period_relaxation_percent().value();
@@ -473,7 +586,8 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
           int64_t target_clock_period_ps = clock_period_ps + 1;
           absl::StatusOr<int64_t> min_clock_period_ps = FindMinimumClockPeriod(
               f, options.pipeline_stages(), input_delay_added, *sdc_scheduler,
-              options.failure_behavior(), target_clock_period_ps);
+              options.failure_behavior(), options.scheduling_threads(),
+              target_clock_period_ps);
           if (min_clock_period_ps.ok()) {
             if (options.recover_after_minimizing_clock().value_or(false)) {
               LOG(WARNING) << "Continuing with clock period = "
@@ -555,6 +669,38 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
                                                bounds.max_lower_bound() + 1),
                                            clock_period_ps, input_delay_added,
                                            &bounds, options.constraints()));
+    } else if (options.strategy() == SchedulingStrategy::LIST) {
+      int64_t pipeline_stages =
+          options.pipeline_stages().value_or(bounds.max_lower_bound() + 1);
+      XLS_ASSIGN_OR_RETURN(
+          cycle_map,
+          ListScheduler(f, pipeline_stages, clock_period_ps, input_delay_added,
+                        &bounds, options.constraints()));
+      if (options.refine_list_schedule_with_sdc()) {
+        absl::StatusOr<ScheduleCycleMap> refined_cycle_map =
+            sdc_scheduler->Schedule(pipeline_stages, clock_period_ps,
+                                    options.failure_behavior(),
+                                    /*check_feasibility=*/false,
+                                    worst_case_throughput);
+        if (refined_cycle_map.ok()) {
+          cycle_map = *std::move(refined_cycle_map);
+        } else {
+          LOG(WARNING) << "Unable to refine the list schedule with the SDC "
+                          "scheduler; keeping the list schedule: "
+                       << refined_cycle_map.status();
+        }
+      }
+    } else if (options.strategy() == SchedulingStrategy::PARTITIONED_SDC) {
+      XLS_ASSIGN_OR_RETURN(
+          cycle_map,
+          PartitionedSDCScheduler(
+              f,
+              options.pipeline_stages().value_or(bounds.max_lower_bound() + 1),
+              clock_period_ps, input_delay_added, &bounds,
+              options.constraints(),
+              options.max_scheduling_region_size().value_or(
+                  kDefaultMaxSchedulingRegionSize),
+              options.scheduling_threads()));
     } else if (options.strategy() == SchedulingStrategy::RANDOM) {
       std::mt19937_64 gen(options.seed().value_or(0));
 
@@ -584,8 +730,14 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
 
   auto schedule = PipelineSchedule(f, cycle_map, options.pipeline_stages());
   XLS_RETURN_IF_ERROR(schedule.Verify());
-  XLS_RETURN_IF_ERROR(
-      schedule.VerifyTiming(clock_period_ps, input_delay_added));
+  if (sdc_scheduler != nullptr) {
+    // Reuse the delays already estimated by the SDC scheduler.
+    XLS_RETURN_IF_ERROR(
+        schedule.VerifyTiming(clock_period_ps, sdc_scheduler->node_delays()));
+  } else {
+    XLS_RETURN_IF_ERROR(
+        schedule.VerifyTiming(clock_period_ps, input_delay_added));
+  }
   XLS_RETURN_IF_ERROR(schedule.VerifyConstraints(options.constraints(),
                                                  f->GetInitiationInterval()));
 
@@ -0,0 +1,416 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of the cost of the pipeline schedulers on synthetic and real
+// designs. In addition to wall time each benchmark reports:
+//
+//   model_build_s: the time to construct the scheduler, e.g., the
+//     SDCSchedulingModel and its solver, per iteration.
+//   solve_s: the time to compute a schedule per iteration.
+//   registers: for the min-cut and list schedulers, the number of pipeline
+//     register bits in the schedule.
+//   peak_rss_mb: the peak resident set size of the benchmark process after the
+//     benchmark has run. This is a high-water mark for the whole process so
+//     run a single benchmark (--benchmark_filter) to attribute it.
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/delay_model/analyze_critical_path.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/delay_model/delay_estimators.h"
+#include "xls/examples/sample_packages.h"
+#include "xls/ir/benchmark_support.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/run_pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+#include "xls/scheduling/sdc_scheduler.h"
+
+namespace xls {
+namespace {
+
+using ::xls::benchmark_support::ScalingDesign;
+
+constexpr std::string_view kDelayModel = "asap7";
+
+struct Design {
+  std::unique_ptr<Package> package;
+  FunctionBase* top;
+};
+
+// A function of `lanes` 64-bit parameters where each lane computes a
+// multiply-add of neighboring parameters and the lanes are reduced with a tree
+// of xors.
+absl::StatusOr<Design> WideDatapath(int64_t lanes) {
+  auto package = std::make_unique<Package>("wide_datapath");
+  FunctionBuilder fb("wide_datapath", package.get());
+  std::vector<BValue> params;
+  for (int64_t i = 0; i < lanes; ++i) {
+    params.push_back(
+        fb.Param(absl::StrCat("p", i), package->GetBitsType(64)));
+  }
+  std::vector<BValue> values;
+  for (int64_t i = 0; i < lanes; ++i) {
+    values.push_back(fb.Add(fb.UMul(params[i], params[(i + 1) % lanes]),
+                            params[(i + 2) % lanes]));
+  }
+  while (values.size() > 1) {
+    std::vector<BValue> next;
+    for (int64_t i = 0; i + 1 < values.size(); i += 2) {
+      next.push_back(fb.Xor(values[i], values[i + 1]));
+    }
+    if (values.size() % 2 == 1) {
+      next.push_back(values.back());
+    }
+    values = std::move(next);
+  }
+  XLS_ASSIGN_OR_RETURN(FunctionBase * top, fb.Build());
+  return Design{std::move(package), top};
+}
+
+// A proc implementing a state machine with `state_count` states. The next
+// state is computed by a priority chain of comparisons against each state, so
+// the depth of the design grows with the number of states.
+absl::StatusOr<Design> DeepFsm(int64_t state_count) {
+  auto package = std::make_unique<Package>("deep_fsm");
+  TokenlessProcBuilder pb("deep_fsm", "tkn", package.get());
+  BValue state = pb.StateElement("state", Value(UBits(0, 32)));
+  BValue acc = pb.StateElement("acc", Value(UBits(0, 32)));
+  BValue next_state = pb.Literal(UBits(0, 32));
+  BValue next_acc = acc;
+  for (int64_t i = state_count - 1; i >= 0; --i) {
+    BValue is_state = pb.Eq(state, pb.Literal(UBits(i, 32)));
+    BValue successor = pb.Literal(UBits((i * 7 + 1) % state_count, 32));
+    next_state = pb.Select(is_state, /*on_true=*/successor,
+                           /*on_false=*/next_state);
+    next_acc = pb.Select(is_state,
+                         /*on_true=*/pb.Add(acc, pb.Literal(UBits(i, 32))),
+                         /*on_false=*/next_acc);
+  }
+  XLS_ASSIGN_OR_RETURN(FunctionBase * top, pb.Build({next_state, next_acc}));
+  return Design{std::move(package), top};
+}
+
+// A proc with `state_element_count` 32-bit state elements, each of which is
+// updated from itself and its neighbors.
+absl::StatusOr<Design> ManyStateProc(int64_t state_element_count) {
+  auto package = std::make_unique<Package>("many_state_proc");
+  TokenlessProcBuilder pb("many_state_proc", "tkn", package.get());
+  std::vector<BValue> state;
+  for (int64_t i = 0; i < state_element_count; ++i) {
+    state.push_back(
+        pb.StateElement(absl::StrCat("s", i), Value(UBits(i, 32))));
+  }
+  std::vector<BValue> next_state;
+  for (int64_t i = 0; i < state_element_count; ++i) {
+    BValue prev = state[(i + state_element_count - 1) % state_element_count];
+    BValue next = state[(i + 1) % state_element_count];
+    next_state.push_back(pb.Add(state[i], pb.UMul(prev, next)));
+  }
+  XLS_ASSIGN_OR_RETURN(FunctionBase * top, pb.Build(next_state));
+  return Design{std::move(package), top};
+}
+
+// A design from the scaling generators in benchmark_support.h.
+absl::StatusOr<Design> GeneratedDesign(ScalingDesign design, int64_t size) {
+  auto package = std::make_unique<Package>("scaling");
+  XLS_ASSIGN_OR_RETURN(
+      FunctionBase * top,
+      benchmark_support::GenerateScalingDesign(design, package.get(), size));
+  return Design{std::move(package), top};
+}
+
+absl::StatusOr<Design> SampleDesign(std::string_view name) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       sample_packages::GetBenchmark(name, /*optimized=*/true));
+  XLS_ASSIGN_OR_RETURN(FunctionBase * top, package->GetTopAsFunction());
+  return Design{std::move(package), top};
+}
+
+// Returns a clock period for which `f` can be scheduled in `stages` stages:
+// each stage holds at least 1/stages of the critical path plus the node which
+// crosses into the next stage.
+absl::StatusOr<int64_t> FeasibleClockPeriod(
+    FunctionBase* f, const DelayEstimator& delay_estimator, int64_t stages) {
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<CriticalPathEntry> critical_path,
+      AnalyzeCriticalPath(f, /*clock_period_ps=*/std::nullopt,
+                          delay_estimator));
+  int64_t critical_path_ps = 0;
+  for (const CriticalPathEntry& entry : critical_path) {
+    critical_path_ps = std::max(critical_path_ps, entry.path_delay_ps);
+  }
+  int64_t max_node_delay_ps = 0;
+  for (Node* node : f->nodes()) {
+    XLS_ASSIGN_OR_RETURN(int64_t delay,
+                         delay_estimator.GetOperationDelayInPs(node));
+    max_node_delay_ps = std::max(max_node_delay_ps, delay);
+  }
+  return (critical_path_ps + stages - 1) / stages + max_node_delay_ps;
+}
+
+void SetPeakMemoryCounter(benchmark::State& state) {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    // ru_maxrss is in kilobytes on Linux.
+    state.counters["peak_rss_mb"] =
+        static_cast<double>(usage.ru_maxrss) / 1024.0;
+  }
+}
+
+// Schedules `design` with the SDC scheduler, timing the construction of the
+// model separately from solving it. Procs may have state backedges spanning
+// all stages.
+void RunSdcBenchmark(benchmark::State& state,
+                     const absl::StatusOr<Design>& design, int64_t stages) {
+  if (!design.ok()) {
+    state.SkipWithError(design.status().ToString().c_str());
+    return;
+  }
+  FunctionBase* f = design->top;
+  const DelayEstimator& delay_estimator =
+      *GetDelayEstimator(kDelayModel).value();
+  absl::StatusOr<int64_t> clock_period_ps =
+      FeasibleClockPeriod(f, delay_estimator, stages);
+  if (!clock_period_ps.ok()) {
+    state.SkipWithError(clock_period_ps.status().ToString().c_str());
+    return;
+  }
+  std::optional<int64_t> worst_case_throughput;
+  if (f->IsProc()) {
+    worst_case_throughput = stages;
+  }
+
+  absl::Duration build_time;
+  absl::Duration solve_time;
+  for (auto _ : state) {
+    absl::Time start = absl::Now();
+    absl::StatusOr<std::unique_ptr<SDCScheduler>> scheduler =
+        SDCScheduler::Create(f, delay_estimator);
+    if (!scheduler.ok()) {
+      state.SkipWithError(scheduler.status().ToString().c_str());
+      return;
+    }
+    absl::Time built = absl::Now();
+    absl::StatusOr<ScheduleCycleMap> cycle_map = (*scheduler)->Schedule(
+        stages, *clock_period_ps, SchedulingFailureBehavior(),
+        /*check_feasibility=*/false, worst_case_throughput);
+    if (!cycle_map.ok()) {
+      state.SkipWithError(cycle_map.status().ToString().c_str());
+      return;
+    }
+    build_time += built - start;
+    solve_time += absl::Now() - built;
+    benchmark::DoNotOptimize(cycle_map);
+  }
+  state.counters["nodes"] = f->node_count();
+  state.counters["model_build_s"] = benchmark::Counter(
+      absl::ToDoubleSeconds(build_time), benchmark::Counter::kAvgIterations);
+  state.counters["solve_s"] = benchmark::Counter(
+      absl::ToDoubleSeconds(solve_time), benchmark::Counter::kAvgIterations);
+  SetPeakMemoryCounter(state);
+}
+
+// Schedules `design` with the min-cut or list scheduler. Neither has a
+// separate model so all of its time is reported as solve time. Only functions
+// are supported: both schedulers place all state in the first stage. Also
+// reports the number of pipeline register bits as `registers`.
+void RunHeuristicBenchmark(benchmark::State& state,
+                           const absl::StatusOr<Design>& design,
+                           int64_t stages, SchedulingStrategy strategy) {
+  if (!design.ok()) {
+    state.SkipWithError(design.status().ToString().c_str());
+    return;
+  }
+  FunctionBase* f = design->top;
+  const DelayEstimator& delay_estimator =
+      *GetDelayEstimator(kDelayModel).value();
+  absl::StatusOr<int64_t> clock_period_ps =
+      FeasibleClockPeriod(f, delay_estimator, stages);
+  if (!clock_period_ps.ok()) {
+    state.SkipWithError(clock_period_ps.status().ToString().c_str());
+    return;
+  }
+  SchedulingOptions options = SchedulingOptions(strategy)
+                                  .pipeline_stages(stages)
+                                  .clock_period_ps(*clock_period_ps);
+
+  absl::Duration solve_time;
+  int64_t registers = 0;
+  for (auto _ : state) {
+    absl::Time start = absl::Now();
+    absl::StatusOr<PipelineSchedule> schedule =
+        RunPipelineSchedule(f, delay_estimator, options);
+    if (!schedule.ok()) {
+      state.SkipWithError(schedule.status().ToString().c_str());
+      return;
+    }
+    solve_time += absl::Now() - start;
+    registers = schedule->CountFinalInteriorPipelineRegisters();
+    benchmark::DoNotOptimize(schedule);
+  }
+  state.counters["nodes"] = f->node_count();
+  state.counters["registers"] = registers;
+  state.counters["model_build_s"] = 0;
+  state.counters["solve_s"] = benchmark::Counter(
+      absl::ToDoubleSeconds(solve_time), benchmark::Counter::kAvgIterations);
+  SetPeakMemoryCounter(state);
+}
+
+using DesignFactory = absl::StatusOr<Design> (*)(int64_t size);
+
+// Arguments are the design size and the number of pipeline stages.
+void BM_Sdc(benchmark::State& state, DesignFactory factory) {
+  RunSdcBenchmark(state, factory(state.range(0)), state.range(1));
+}
+
+void BM_MinCut(benchmark::State& state, DesignFactory factory) {
+  RunHeuristicBenchmark(state, factory(state.range(0)), state.range(1),
+                        SchedulingStrategy::MIN_CUT);
+}
+
+void BM_List(benchmark::State& state, DesignFactory factory) {
+  RunHeuristicBenchmark(state, factory(state.range(0)), state.range(1),
+                        SchedulingStrategy::LIST);
+}
+
+// The argument is the size of the design, which is scheduled in four stages.
+// Reports the complexity of scheduling in the design size.
+void BM_SdcScaling(benchmark::State& state, ScalingDesign design) {
+  RunSdcBenchmark(state, GeneratedDesign(design, state.range(0)),
+                  /*stages=*/4);
+  state.SetComplexityN(state.range(0));
+}
+
+// The argument is the number of pipeline stages.
+void BM_SdcSample(benchmark::State& state, std::string_view name) {
+  RunSdcBenchmark(state, SampleDesign(name), state.range(0));
+}
+
+void BM_MinCutSample(benchmark::State& state, std::string_view name) {
+  RunHeuristicBenchmark(state, SampleDesign(name), state.range(0),
+                        SchedulingStrategy::MIN_CUT);
+}
+
+void BM_ListSample(benchmark::State& state, std::string_view name) {
+  RunHeuristicBenchmark(state, SampleDesign(name), state.range(0),
+                        SchedulingStrategy::LIST);
+}
+
+// As BM_SdcScaling but for the list scheduler, which is intended for designs
+// far larger than the SDC scheduler can handle.
+void BM_ListScaling(benchmark::State& state, ScalingDesign design) {
+  RunHeuristicBenchmark(state, GeneratedDesign(design, state.range(0)),
+                        /*stages=*/4, SchedulingStrategy::LIST);
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK_CAPTURE(BM_Sdc, wide_datapath, &WideDatapath)
+    ->Args({64, 4})
+    ->Args({1024, 8})
+    ->Args({8192, 16})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Sdc, deep_fsm, &DeepFsm)
+    ->Args({64, 4})
+    ->Args({1024, 16})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Sdc, many_state_proc, &ManyStateProc)
+    ->Args({64, 4})
+    ->Args({2048, 8})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_MinCut, wide_datapath, &WideDatapath)
+    ->Args({64, 4})
+    ->Args({1024, 8})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_List, wide_datapath, &WideDatapath)
+    ->Args({64, 4})
+    ->Args({1024, 8})
+    ->Args({8192, 16})
+    ->Args({65536, 16})
+    ->Unit(benchmark::kMillisecond);
+
+void ScalingArgs(benchmark::internal::Benchmark* b) {
+  b->RangeMultiplier(4)
+      ->Range(16, 4096)
+      ->Complexity()
+      ->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_CAPTURE(BM_SdcScaling, chain, ScalingDesign::kChain)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_SdcScaling, balanced_tree, ScalingDesign::kBalancedTree)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_SdcScaling, ladder, ScalingDesign::kLadder)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_SdcScaling, large_select, ScalingDesign::kLargeSelect)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_SdcScaling, dynamic_array, ScalingDesign::kDynamicArray)
+    ->Apply(ScalingArgs);
+BENCHMARK_CAPTURE(BM_SdcScaling, wide_state_proc,
+                  ScalingDesign::kWideStateProc)
+    ->Apply(ScalingArgs);
+
+BENCHMARK_CAPTURE(BM_ListScaling, chain, ScalingDesign::kChain)
+    ->RangeMultiplier(8)
+    ->Range(16, 1 << 19)
+    ->Complexity()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ListScaling, balanced_tree, ScalingDesign::kBalancedTree)
+    ->RangeMultiplier(8)
+    ->Range(16, 1 << 19)
+    ->Complexity()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_SdcSample, sha256, "examples/sha256")
+    ->Arg(4)
+    ->Arg(16)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SdcSample, crc32, "examples/crc32/crc32")
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_SdcSample, adler32, "examples/adler32/adler32")
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_MinCutSample, sha256, "examples/sha256")
+    ->Arg(4)
+    ->Arg(16)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ListSample, sha256, "examples/sha256")
+    ->Arg(4)
+    ->Arg(16)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace xls
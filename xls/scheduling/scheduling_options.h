@@ -46,6 +46,16 @@ enum class SchedulingStrategy : int8_t {
 
   // Create a random but sound schedule. This is useful for testing.
   RANDOM,
+
+  // Approximately minimize the number of pipeline registers with a list
+  // scheduler which refines an ASAP schedule using local moves. Much faster
+  // than SDC on very large graphs; see ListScheduler.
+  LIST,
+
+  // Exactly minimize the number of pipeline registers within each of many
+  // loosely-coupled regions of a list schedule, solving the regions in
+  // parallel; see PartitionedSDCScheduler.
+  PARTITIONED_SDC,
 };
 
 enum class PathEvaluateStrategy : int8_t {
@@ -233,6 +243,7 @@ class SchedulingOptions {
         minimize_clock_on_failure_(true),
         recover_after_minimizing_clock_(false),
         minimize_worst_case_throughput_(false),
+        scheduling_threads_(1),
         constraints_({
             BackedgeConstraint(),
             SendThenRecvConstraint(/*minimum_latency=*/1),
@@ -244,9 +255,15 @@ class SchedulingOptions {
         fdo_refinement_stochastic_ratio_(1.0),
         fdo_path_evaluate_strategy_(PathEvaluateStrategy::WINDOW),
         fdo_synthesizer_name_("yosys"),
-        schedule_all_procs_(false) {}
+        fdo_synthesis_batch_size_(1),
+        schedule_all_procs_(false),
+        refine_list_schedule_with_sdc_(false) {}
 
-  // Returns the scheduling strategy.
+  // Sets/gets the scheduling strategy.
+  SchedulingOptions& strategy(SchedulingStrategy value) {
+    strategy_ = value;
+    return *this;
+  }
   SchedulingStrategy strategy() const { return strategy_; }
 
   // Sets/gets the target delay model
@@ -256,6 +273,14 @@ class SchedulingOptions {
   }
   std::optional<std::string> delay_model() const { return delay_model_; }
 
+  // Sets/gets the area model used by the SDC scheduler to minimize the
+  // estimated area of the pipeline registers rather than their bit count.
+  SchedulingOptions& area_model(std::string_view value) {
+    area_model_ = value;
+    return *this;
+  }
+  std::optional<std::string> area_model() const { return area_model_; }
+
   // Sets/gets the target clock period in picoseconds.
   SchedulingOptions& clock_period_ps(int64_t value) {
     clock_period_ps_ = value;
@@ -322,6 +347,15 @@ class SchedulingOptions {
     return minimize_worst_case_throughput_;
   }
 
+  // Sets/gets the number of threads to use when searching for the minimum
+  // feasible clock period. With more than one thread several candidate clock
+  // periods are evaluated concurrently.
+  SchedulingOptions& scheduling_threads(int64_t value) {
+    scheduling_threads_ = value;
+    return *this;
+  }
+  int64_t scheduling_threads() const { return scheduling_threads_; }
+
   // Sets/gets the worst-case throughput bound to use when scheduling; for
   // procs, controls the length of state backedges allowed in scheduling.
   SchedulingOptions& worst_case_throughput(int64_t value) {
@@ -491,22 +525,64 @@ class SchedulingOptions {
     return fdo_synthesis_libraries_;
   }
 
+  // Directory in which synthesis results are persisted across runs. Empty
+  // disables the persistent cache.
+  SchedulingOptions& fdo_synthesis_cache_dir(std::string_view value) {
+    fdo_synthesis_cache_dir_ = value;
+    return *this;
+  }
+  std::string fdo_synthesis_cache_dir() const {
+    return fdo_synthesis_cache_dir_;
+  }
+
+  // Number of node cuts synthesized by each invocation of the synthesis tools.
+  // Larger batches amortize tool startup and library loading over more cuts.
+  SchedulingOptions& fdo_synthesis_batch_size(int64_t value) {
+    fdo_synthesis_batch_size_ = value;
+    return *this;
+  }
+  int64_t fdo_synthesis_batch_size() const { return fdo_synthesis_batch_size_; }
+
   SchedulingOptions& schedule_all_procs(bool value) {
     schedule_all_procs_ = value;
     return *this;
   }
   bool schedule_all_procs() const { return schedule_all_procs_; }
 
+  // Sets/gets whether the SDC scheduler is run after the list scheduler (see
+  // SchedulingStrategy::LIST) to improve its schedule. The list schedule is
+  // kept if the SDC scheduler fails.
+  SchedulingOptions& refine_list_schedule_with_sdc(bool value) {
+    refine_list_schedule_with_sdc_ = value;
+    return *this;
+  }
+  bool refine_list_schedule_with_sdc() const {
+    return refine_list_schedule_with_sdc_;
+  }
+
+  // Sets/gets the maximum number of nodes in each region scheduled by the
+  // partitioned SDC scheduler (see SchedulingStrategy::PARTITIONED_SDC). The
+  // regions are scheduled using scheduling_threads() threads.
+  SchedulingOptions& max_scheduling_region_size(int64_t value) {
+    max_scheduling_region_size_ = value;
+    return *this;
+  }
+  std::optional<int64_t> max_scheduling_region_size() const {
+    return max_scheduling_region_size_;
+  }
+
  private:
   SchedulingStrategy strategy_;
   std::optional<int64_t> clock_period_ps_;
   std::optional<std::string> delay_model_;
+  std::optional<std::string> area_model_;
   std::optional<int64_t> pipeline_stages_;
   std::optional<int64_t> clock_margin_percent_;
   std::optional<int64_t> period_relaxation_percent_;
   bool minimize_clock_on_failure_;
   bool recover_after_minimizing_clock_;
   bool minimize_worst_case_throughput_;
+  int64_t scheduling_threads_;
   std::optional<int64_t> worst_case_throughput_;
   std::optional<int64_t> additional_input_delay_ps_;
   std::optional<int64_t> ffi_fallback_delay_ps_;
@@ -525,7 +601,11 @@ class SchedulingOptions {
   std::string fdo_yosys_path_;
   std::string fdo_sta_path_;
   std::string fdo_synthesis_libraries_;
+  std::string fdo_synthesis_cache_dir_;
+  int64_t fdo_synthesis_batch_size_;
   bool schedule_all_procs_;
+  bool refine_list_schedule_with_sdc_;
+  std::optional<int64_t> max_scheduling_region_size_;
 };
 
 // A map from node to cycle as a bare-bones representation of a schedule.
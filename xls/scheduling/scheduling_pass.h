@@ -68,7 +68,7 @@ class SchedulingUnit {
   // schedule in `schedules()`.
   bool IsScheduled() const;
 
-  const TransformMetrics& transform_metrics() const {
+  TransformMetrics transform_metrics() const {
     return ir_->transform_metrics();
   }
 
@@ -14,8 +14,11 @@
 
 #include "xls/scheduling/sdc_scheduler.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -36,6 +39,7 @@
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/function.h"
@@ -67,29 +71,87 @@ absl::StatusOr<DelayMap> ComputeNodeDelays(
   return result;
 }
 
+// Calls `fn(i)` for each `i` in [0, `count`). When there is enough work the
+// calls are spread over the available CPUs, so `fn` must be safe to call
+// concurrently for different indices.
+void ParallelFor(int64_t count, const std::function<void(int64_t)>& fn) {
+  // Below this many calls per thread, starting threads costs more than it
+  // saves.
+  constexpr int64_t kMinCallsPerThread = 64;
+  static const int64_t kAvailableCpus = std::max(1, AvailableCPUs());
+  int64_t thread_count = std::min(kAvailableCpus, count / kMinCallsPerThread);
+  if (thread_count <= 1) {
+    for (int64_t i = 0; i < count; ++i) {
+      fn(i);
+    }
+    return;
+  }
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index++; i < count; i = next_index++) {
+      fn(i);
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (auto& t : threads) {
+    t->Join();
+  }
+}
+
+// Returns the nodes of `topo_sort` grouped by depth, where the depth of a node
+// is the length of the longest operand path from a node without operands.
+// There is no path between nodes of the same depth. Each group is in
+// topological order.
+std::vector<std::vector<Node*>> NodesByDepth(
+    absl::Span<Node* const> topo_sort) {
+  std::vector<std::vector<Node*>> result;
+  absl::flat_hash_map<Node*, int64_t> depth;
+  depth.reserve(topo_sort.size());
+  for (Node* node : topo_sort) {
+    int64_t node_depth = 0;
+    for (Node* operand : node->operands()) {
+      node_depth = std::max(node_depth, depth.at(operand) + 1);
+    }
+    depth[node] = node_depth;
+    if (node_depth >= result.size()) {
+      result.resize(node_depth + 1);
+    }
+    result[node_depth].push_back(node);
+  }
+  return result;
+}
+
 // Compute all-pairs longest distance between all nodes in `f`. The distance
 // from node `a` to node `b` is defined as the length of the longest delay path
 // from `a`'s start to `b`'s end, which includes the delay of the path endpoints
 // `a` and `b`. The all-pairs distance is stored in the map of maps
 // `distances_to_node` where `distances_to_node[y][x]` (if present) is the
 // critical-path distance from `x` to `y`.
-absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>
-ComputeDistancesToNodes(FunctionBase* f, absl::Span<Node* const> topo_sort,
-                        const DelayMap& delay_map) {
+//
+// The distances to a node only depend on the distances to its operands, so the
+// nodes of each depth are processed concurrently.
+SDCSchedulingModel::DistanceMap ComputeDistancesToNodes(
+    FunctionBase* f, absl::Span<Node* const> topo_sort,
+    const DelayMap& delay_map) {
   absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>
       distances_to_node;
   distances_to_node.reserve(f->node_count());
   for (Node* node : topo_sort) {
-    // Initialize the distance map entry to an empty map.
+    // Initialize the distance map entry to an empty map. The outer map is not
+    // modified after this so the entries may be filled in concurrently.
     distances_to_node[node];
   }
 
-  for (Node* node : topo_sort) {
+  auto compute_distances = [&](Node* node) {
     absl::flat_hash_map<Node*, int64_t>& distances = distances_to_node.at(node);
 
     // The critical path from `node` to `node` is always `node_delay` long.
     int64_t node_delay = delay_map.at(node);
-    distances_to_node.at(node)[node] = node_delay;
+    distances[node] = node_delay;
 
     // Compute the critical-path distance from `a` to `node` for all descendants
     // `a` of each operand, extending the critical path from `a` to each operand
@@ -106,6 +168,9 @@ ComputeDistancesToNodes(FunctionBase* f, absl::Span<Node* const> topo_sort,
         }
       }
     }
+  };
+  for (const std::vector<Node*>& nodes : NodesByDepth(topo_sort)) {
+    ParallelFor(nodes.size(), [&](int64_t i) { compute_distances(nodes[i]); });
   }
 
   if (VLOG_IS_ON(4)) {
@@ -143,8 +208,7 @@ ComputeDistancesToNodes(FunctionBase* f, absl::Span<Node* const> topo_sort,
 absl::flat_hash_map<Node*, std::vector<Node*>>
 ComputeCombinationalDelayConstraints(
     FunctionBase* f, absl::Span<Node* const> topo_sort, int64_t clock_period_ps,
-    const absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>&
-        distances_to_node,
+    const SDCSchedulingModel::DistanceMap& distances_to_node,
     const DelayMap& delay_map) {
   absl::flat_hash_map<Node*, std::vector<Node*>> result;
   result.reserve(f->node_count());
@@ -152,23 +216,33 @@ ComputeCombinationalDelayConstraints(
     result[a];
   }
 
-  for (Node* node : topo_sort) {
+  // The ancestors of each node which need a constraint are found concurrently
+  // and then merged in topological order, so the result does not depend on the
+  // number of threads.
+  std::vector<std::vector<Node*>> constrained_ancestors(topo_sort.size());
+  ParallelFor(topo_sort.size(), [&](int64_t i) {
+    Node* node = topo_sort[i];
     const int64_t node_delay = delay_map.at(node);
 
     // For each ancestor `a`, check whether the critical-path length from `a`'s
     // start to `node`'s end crosses a `clock_period_ps` boundary due to
     // `node`'s delay. If so, we need a constraint to ensure that `node` is in a
     // later stage than `a`.
-    //
-    // NOTE: The order in which we iterate over the ancestors `a` here does not
-    // matter. As long as our iteration over `node` is deterministic, we will
-    // push the same sequence of `node`s into each `result[a]` every time.
     for (auto [a, distance] : distances_to_node.at(node)) {
       if (distance > clock_period_ps &&
           distance - node_delay <= clock_period_ps) {
-        result.at(a).push_back(node);
+        constrained_ancestors[i].push_back(a);
       }
     }
+  });
+
+  // NOTE: The order of the ancestors of each node does not matter. As long as
+  // our iteration over `node` is deterministic, we will push the same sequence
+  // of `node`s into each `result[a]` every time.
+  for (int64_t i = 0; i < topo_sort.size(); ++i) {
+    for (Node* a : constrained_ancestors[i]) {
+      result.at(a).push_back(topo_sort[i]);
+    }
   }
 
   if (VLOG_IS_ON(4)) {
@@ -187,18 +261,28 @@ ComputeCombinationalDelayConstraints(
 SDCSchedulingModel::SDCSchedulingModel(FunctionBase* func,
                                        const DelayMap& delay_map,
                                        std::string_view model_name)
+    : SDCSchedulingModel(
+          func, delay_map,
+          // When subclassed for Iterative SDC, delay_map_ and
+          // distances_to_node_ are not used.
+          std::make_shared<const DistanceMap>(
+              delay_map.empty()
+                  ? DistanceMap()
+                  : ComputeDistancesToNodes(func, TopoSort(func), delay_map)),
+          model_name) {}
+
+SDCSchedulingModel::SDCSchedulingModel(
+    FunctionBase* func, const DelayMap& delay_map,
+    std::shared_ptr<const DistanceMap> distances_to_node,
+    std::string_view model_name)
     : func_(func),
       topo_sort_(TopoSort(func_)),
       model_(model_name),
       delay_map_(delay_map),
+      distances_to_node_(std::move(distances_to_node)),
       last_stage_(model_.AddContinuousVariable(0.0, kInfinity, "last_stage")),
       cycle_at_sinknode_(model_.AddContinuousVariable(-kInfinity, kInfinity,
                                                       "cycle_at_sinknode")) {
-  // when subclassed for Iterative SDC, delay_map_ and distances_to_node_
-  // are not used.
-  if (!delay_map_.empty()) {
-    distances_to_node_ = ComputeDistancesToNodes(func_, topo_sort_, delay_map_);
-  }
 
   for (Node* node : topo_sort_) {
     cycle_var_.emplace(
@@ -495,12 +579,15 @@ absl::Status SDCSchedulingModel::AddSendThenRecvConstraint(
 void SDCSchedulingModel::SetObjective() {
   math_opt::LinearExpression objective;
   for (Node* node : topo_sort_) {
+    int64_t bit_count = node->GetType()->GetFlatBitCount();
+    int64_t register_cost = area_estimator_ == nullptr
+                                ? bit_count
+                                : area_estimator_->GetRegisterArea(bit_count);
     // Minimize node lifetimes.
     // The scaling makes the tie-breaker small in comparison, and is a power
     // of two so that there's no imprecision (just add to exponent).
-    objective += 1024 *
-                 static_cast<double>(node->GetType()->GetFlatBitCount()) *
-                 lifetime_var_.at(node);
+    objective +=
+        1024 * static_cast<double>(register_cost) * lifetime_var_.at(node);
     // This acts as a tie-breaker for under-constrained problems, favoring ASAP
     // schedules.
     objective += cycle_var_.at(node);
@@ -525,31 +612,52 @@ absl::StatusOr<ScheduleCycleMap> SDCSchedulingModel::ExtractResult(
 }
 
 void SDCSchedulingModel::SetClockPeriod(int64_t clock_period_ps) {
+  if (clock_period_ps_ == clock_period_ps) {
+    return;
+  }
+  clock_period_ps_ = clock_period_ps;
+  SetTimingConstraints(ComputeCombinationalDelayConstraints(
+      func_, topo_sort_, clock_period_ps, *distances_to_node_, delay_map_));
+}
+
+void SDCSchedulingModel::SetTimingConstraints(
+    absl::flat_hash_map<Node*, std::vector<Node*>> delay_constraints) {
   absl::flat_hash_map<Node*, std::vector<Node*>> prev_delay_constraints =
       std::move(delay_constraints_);
-  delay_constraints_ = ComputeCombinationalDelayConstraints(
-      func_, topo_sort_, clock_period_ps, distances_to_node_, delay_map_);
+  delay_constraints_ = std::move(delay_constraints);
 
+  // Drop any prior constraints which are obsolete. The remaining constraints
+  // are left in place so the solver can start from its previous solution.
   for (Node* source : topo_sort_) {
-    if (!prev_delay_constraints.empty()) {
-      // Check over all the prior constraints, dropping any that are obsolete.
-      absl::flat_hash_set<Node*> new_targets(
-          delay_constraints_.at(source).begin(),
-          delay_constraints_.at(source).end());
-      for (Node* target : prev_delay_constraints.at(source)) {
-        if (new_targets.contains(target)) {
-          continue;
-        }
-
-        // No longer related; remove constraint.
-        auto it = timing_constraint_.find(std::make_pair(source, target));
-        model_.DeleteLinearConstraint(it->second);
-        timing_constraint_.erase(it);
+    auto prev_targets_it = prev_delay_constraints.find(source);
+    if (prev_targets_it == prev_delay_constraints.end()) {
+      continue;
+    }
+    absl::flat_hash_set<Node*> new_targets;
+    if (auto it = delay_constraints_.find(source);
+        it != delay_constraints_.end()) {
+      new_targets.insert(it->second.begin(), it->second.end());
+    }
+    for (Node* target : prev_targets_it->second) {
+      if (new_targets.contains(target)) {
+        continue;
       }
+
+      // No longer related; remove constraint.
+      auto it = timing_constraint_.find(std::make_pair(source, target));
+      CHECK(it != timing_constraint_.end());
+      model_.DeleteLinearConstraint(it->second);
+      timing_constraint_.erase(it);
     }
+  }
 
-    // Add all new constraints, avoiding duplicates for any that already exist.
-    for (Node* target : delay_constraints_.at(source)) {
+  // Add all new constraints, avoiding duplicates for any that already exist.
+  for (Node* source : topo_sort_) {
+    auto targets_it = delay_constraints_.find(source);
+    if (targets_it == delay_constraints_.end()) {
+      continue;
+    }
+    for (Node* target : targets_it->second) {
       auto key = std::make_pair(source, target);
       if (timing_constraint_.contains(key)) {
         continue;
@@ -916,11 +1024,28 @@ absl::StatusOr<std::unique_ptr<SDCScheduler>> SDCScheduler::Create(
   return std::move(scheduler);
 }
 
+absl::StatusOr<std::unique_ptr<SDCScheduler>> SDCScheduler::Clone() const {
+  std::unique_ptr<SDCScheduler> scheduler(
+      new SDCScheduler(f_, delay_map_, model_.distances_to_node()));
+  XLS_RETURN_IF_ERROR(scheduler->Initialize());
+  XLS_RETURN_IF_ERROR(scheduler->AddConstraints(constraints_));
+  scheduler->SetAreaEstimator(area_estimator_);
+  return std::move(scheduler);
+}
+
 SDCScheduler::SDCScheduler(FunctionBase* f, DelayMap delay_map)
     : f_(f),
       delay_map_(std::move(delay_map)),
       model_(f, delay_map_, absl::StrCat("sdc_model:", f->name())) {}
 
+SDCScheduler::SDCScheduler(
+    FunctionBase* f, DelayMap delay_map,
+    std::shared_ptr<const SDCSchedulingModel::DistanceMap> distances_to_node)
+    : f_(f),
+      delay_map_(std::move(delay_map)),
+      model_(f, delay_map_, std::move(distances_to_node),
+             absl::StrCat("sdc_model:", f->name())) {}
+
 absl::Status SDCScheduler::Initialize() {
   XLS_ASSIGN_OR_RETURN(
       solver_, math_opt::IncrementalSolver::New(&model_.UnderlyingModel(),
@@ -955,6 +1080,7 @@ absl::Status SDCScheduler::AddConstraints(
     absl::Span<const SchedulingConstraint> constraints) {
   for (const SchedulingConstraint& constraint : constraints) {
     XLS_RETURN_IF_ERROR(model_.AddSchedulingConstraint(constraint));
+    constraints_.push_back(constraint);
   }
   return absl::OkStatus();
 }
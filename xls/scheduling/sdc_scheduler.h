@@ -27,6 +27,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/area_model/area_estimator.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
@@ -46,9 +47,26 @@ class SDCSchedulingModel {
   static constexpr double kInfinity = std::numeric_limits<double>::infinity();
 
  public:
+  // A map holding the critical-path distances between pairs of nodes; if there
+  // is a path from `x` to `y`, `distances[y][x]` is the length of the critical
+  // path.
+  using DistanceMap =
+      absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>;
+
   SDCSchedulingModel(FunctionBase* func, const DelayMap& delay_map,
                      std::string_view model_name = "");
 
+  // As above but uses the given critical-path distances, which must have been
+  // computed from `delay_map`, rather than computing them. This allows the
+  // (quadratic) distance computation to be shared between models.
+  SDCSchedulingModel(FunctionBase* func, const DelayMap& delay_map,
+                     std::shared_ptr<const DistanceMap> distances_to_node,
+                     std::string_view model_name = "");
+
+  std::shared_ptr<const DistanceMap> distances_to_node() const {
+    return distances_to_node_;
+  }
+
   absl::Status AddDefUseConstraints(Node* node, std::optional<Node*> user);
   absl::Status AddCausalConstraint(Node* node, std::optional<Node*> user);
   absl::Status AddLifetimeConstraint(Node* node, std::optional<Node*> user);
@@ -63,6 +81,11 @@ class SDCSchedulingModel {
   absl::Status AddSendThenRecvConstraint(
       const SendThenRecvConstraint& constraint);
 
+  // Sets the timing constraints for the given clock period. Only the
+  // constraints which differ from those for the previous clock period are
+  // added to or removed from the model, so repeated calls (e.g., when
+  // searching for the minimum clock period) keep the model and the solver
+  // state alive. Does nothing if the clock period is unchanged.
   void SetClockPeriod(int64_t clock_period_ps);
 
   absl::Status SetWorstCaseThroughput(int64_t worst_case_throughput);
@@ -70,9 +93,21 @@ class SDCSchedulingModel {
   void SetPipelineLength(std::optional<int64_t> pipeline_length);
   void MinimizePipelineLength();
 
+  // Sets the objective to minimize the pipeline registers, weighting the
+  // lifetime of each node by its bit count or, if an area estimator has been
+  // set, by the estimated area of a register holding it.
   void SetObjective();
   void RemoveObjective();
 
+  // Makes SetObjective minimize the estimated area of the pipeline registers
+  // according to `area_estimator` (which must outlive this model) rather than
+  // their bit count. The area of the logic does not depend on the schedule, so
+  // this minimizes the estimated area of the whole pipeline. Pass nullptr to
+  // restore the default objective.
+  void SetAreaEstimator(const AreaEstimator* area_estimator) {
+    area_estimator_ = area_estimator;
+  }
+
   absl::StatusOr<int64_t> ExtractPipelineLength(
       const operations_research::math_opt::VariableMap<double>& variable_values)
       const;
@@ -118,6 +153,14 @@ class SDCSchedulingModel {
   operations_research::math_opt::LinearConstraint DiffEqualsConstraint(
       Node* x, Node* y, int64_t diff, std::string_view name);
 
+ protected:
+  // Replaces the timing constraints in the model with the given constraints.
+  // `delay_constraints[x]` is the set of nodes which must be scheduled at least
+  // one cycle later than `x`. Constraints which are already present in the
+  // model are kept.
+  void SetTimingConstraints(
+      absl::flat_hash_map<Node*, std::vector<Node*>> delay_constraints);
+
  private:
   operations_research::math_opt::Variable AddUpperBoundSlack(
       operations_research::math_opt::LinearConstraint c,
@@ -153,14 +196,15 @@ class SDCSchedulingModel {
   const DelayMap& delay_map_;
 
   // Stores the critical-path distances between all pairs of Nodes; if there is
-  // a path from `x` to `y`, `distances_to_node_[y][x]` is the length of the
-  // critical path.
-  absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>
-      distances_to_node_;
+  // a path from `x` to `y`, `(*distances_to_node_)[y][x]` is the length of the
+  // critical path. May be shared with other models of the same function.
+  std::shared_ptr<const DistanceMap> distances_to_node_;
 
   operations_research::math_opt::Variable last_stage_;
   std::optional<operations_research::math_opt::Variable> last_stage_slack_;
 
+  const AreaEstimator* area_estimator_ = nullptr;
+
   // Node's cycle after scheduling
   absl::flat_hash_map<Node*, operations_research::math_opt::Variable>
       cycle_var_;
@@ -174,6 +218,10 @@ class SDCSchedulingModel {
   // data-dependence graph.
   operations_research::math_opt::Variable cycle_at_sinknode_;
 
+  // The clock period for which the timing constraints were last computed by
+  // SetClockPeriod.
+  std::optional<int64_t> clock_period_ps_;
+
   // A cache of the delay constraints.
   absl::flat_hash_map<Node*, std::vector<Node*>> delay_constraints_;
 
@@ -214,9 +262,29 @@ class SDCScheduler {
   static absl::StatusOr<std::unique_ptr<SDCScheduler>> Create(
       FunctionBase* f, const DelayEstimator& delay_estimator);
 
+  // Returns a new scheduler for the same function with the same constraints.
+  // The new scheduler shares the node delays and the critical-path analysis of
+  // this one, so this is much cheaper than Create. Each scheduler may be used
+  // by a different thread, e.g., to evaluate several clock periods
+  // concurrently.
+  absl::StatusOr<std::unique_ptr<SDCScheduler>> Clone() const;
+
   absl::Status AddConstraints(
       absl::Span<const SchedulingConstraint> constraints);
 
+  // The delay of each node of the function, as given by the delay estimator.
+  const absl::flat_hash_map<Node*, int64_t>& node_delays() const {
+    return delay_map_;
+  }
+
+  // Schedules to minimize the estimated area of the pipeline registers
+  // according to `area_estimator` rather than their bit count; see
+  // SDCSchedulingModel::SetAreaEstimator. Clones share the estimator.
+  void SetAreaEstimator(const AreaEstimator* area_estimator) {
+    area_estimator_ = area_estimator;
+    model_.SetAreaEstimator(area_estimator);
+  }
+
   // Schedule to minimize the total pipeline registers using SDC scheduling
   // the constraint matrix is totally unimodular, this ILP problem can be solved
   // by LP.
@@ -248,6 +316,9 @@ class SDCScheduler {
 
  private:
   SDCScheduler(FunctionBase* f, DelayMap delay_map);
+  SDCScheduler(FunctionBase* f, DelayMap delay_map,
+               std::shared_ptr<const SDCSchedulingModel::DistanceMap>
+                   distances_to_node);
   absl::Status Initialize();
 
   absl::Status BuildError(
@@ -259,6 +330,11 @@ class SDCScheduler {
 
   SDCSchedulingModel model_;
   std::unique_ptr<operations_research::math_opt::IncrementalSolver> solver_;
+
+  // The constraints added by AddConstraints.
+  std::vector<SchedulingConstraint> constraints_;
+
+  const AreaEstimator* area_estimator_ = nullptr;
 };
 
 }  // namespace xls
@@ -0,0 +1,405 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/simulation/compiled_module_simulator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "absl/types/span.h"
+#include "xls/codegen/flattening.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/codegen/module_signature.pb.h"
+#include "xls/codegen/vast.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/number_parser.h"
+#include "xls/ir/value.h"
+#include "xls/simulation/verilog_simulator.h"
+#include "xls/tools/verilog_include.h"
+
+namespace xls {
+namespace verilog {
+namespace {
+
+// Prefix of the lines of simulator output holding the outputs for one input.
+constexpr std::string_view kOutputMarker = "__xls_output";
+
+// The number of cycles the module is held in reset, as in ModuleTestbench.
+constexpr int64_t kResetCycles = 5;
+
+// The testbench clock has a period of 10 time units with rising edges at 5,
+// 15, 25, etc. Inputs are driven at the start of each cycle and outputs are
+// sampled at its end, just before the rising edge.
+constexpr int64_t kClockPeriod = 10;
+constexpr int64_t kSampleDelay = 4;
+
+// Returns the data ports of non-zero width, which are the ports present in
+// the Verilog module.
+std::vector<const PortProto*> NonZeroWidthPorts(
+    absl::Span<const PortProto> ports) {
+  std::vector<const PortProto*> result;
+  for (const PortProto& port : ports) {
+    if (port.width() > 0) {
+      result.push_back(&port);
+    }
+  }
+  return result;
+}
+
+// Returns the Verilog concatenation of the given ports.
+std::string ConcatenatePorts(absl::Span<const PortProto* const> ports) {
+  return absl::StrCat(
+      "{",
+      absl::StrJoin(ports, ", ",
+                    [](std::string* out, const PortProto* port) {
+                      absl::StrAppend(out, port->name());
+                    }),
+      "}");
+}
+
+// Generates a testbench which instantiates the module of `signature`, reads
+// the concatenated data inputs of `+count` vectors from the file named by
+// `+stimulus` and prints the data outputs for each vector as a line:
+//
+//   __xls_output <index>: <output 0> <output 1> ...
+//
+// with each output in hexadecimal.
+absl::StatusOr<std::string> GenerateTestbench(const ModuleSignature& signature,
+                                              int64_t max_batch_size) {
+  const ModuleSignatureProto& proto = signature.proto();
+  int64_t latency = 0;
+  std::optional<std::string> valid_input;
+  std::optional<std::string> load_enable;
+  if (proto.has_fixed_latency()) {
+    latency = proto.fixed_latency().latency();
+  } else if (proto.has_pipeline()) {
+    latency = proto.pipeline().latency();
+    const PipelineControl& control = proto.pipeline().pipeline_control();
+    if (control.has_valid()) {
+      valid_input = control.valid().input_name();
+    } else if (control.has_manual()) {
+      XLS_RET_CHECK_GT(latency, 0);
+      load_enable = control.manual().input_name();
+    }
+  } else if (!proto.has_combinational()) {
+    return absl::UnimplementedError(absl::StrCat(
+        "Unsupported interface: ", proto.interface_oneof_case()));
+  }
+  if (!proto.has_combinational() && !proto.has_clock_name()) {
+    return absl::InvalidArgumentError("Expected clock in signature");
+  }
+
+  std::vector<const PortProto*> inputs =
+      NonZeroWidthPorts(signature.data_inputs());
+  std::vector<const PortProto*> outputs =
+      NonZeroWidthPorts(signature.data_outputs());
+  int64_t input_width = 0;
+  for (const PortProto* input : inputs) {
+    input_width += input->width();
+  }
+
+  std::string tb = "module __xls_testbench;\n";
+  absl::StrAppendFormat(&tb, "  reg [%d:0] __stimulus [0:%d];\n",
+                        std::max<int64_t>(input_width, 1) - 1,
+                        max_batch_size - 1);
+  absl::StrAppend(&tb, "  reg [8191:0] __stimulus_path;\n");
+  absl::StrAppend(&tb, "  integer __count;\n  integer __cycle;\n");
+  std::vector<std::string> connections;
+  if (proto.has_clock_name()) {
+    const std::string& clk = proto.clock_name();
+    absl::StrAppendFormat(&tb, "  reg %s;\n", clk);
+    absl::StrAppendFormat(&tb, "  initial begin\n    %s = 0;\n", clk);
+    absl::StrAppendFormat(&tb, "    forever #%d %s = !%s;\n  end\n",
+                          kClockPeriod / 2, clk, clk);
+    connections.push_back(clk);
+  }
+  if (proto.has_reset()) {
+    absl::StrAppendFormat(&tb, "  reg %s;\n", proto.reset().name());
+    connections.push_back(proto.reset().name());
+  }
+  if (valid_input.has_value()) {
+    absl::StrAppendFormat(&tb, "  reg %s;\n", *valid_input);
+    connections.push_back(*valid_input);
+  }
+  if (load_enable.has_value()) {
+    absl::StrAppendFormat(&tb, "  reg [%d:0] %s;\n", latency - 1,
+                          *load_enable);
+    connections.push_back(*load_enable);
+  }
+  for (const PortProto* input : inputs) {
+    absl::StrAppendFormat(&tb, "  reg [%d:0] %s;\n", input->width() - 1,
+                          input->name());
+    connections.push_back(input->name());
+  }
+  for (const PortProto* output : outputs) {
+    absl::StrAppendFormat(&tb, "  wire [%d:0] %s;\n", output->width() - 1,
+                          output->name());
+    connections.push_back(output->name());
+  }
+  absl::StrAppendFormat(
+      &tb, "  %s dut (\n%s\n  );\n\n", signature.module_name(),
+      absl::StrJoin(connections, ",\n",
+                    [](std::string* out, const std::string& name) {
+                      absl::StrAppendFormat(out, "    .%s(%s)", name, name);
+                    }));
+
+  // Statements driving the data inputs from the stimulus or with X.
+  std::vector<std::string> drive_inputs;
+  std::vector<std::string> drive_x;
+  if (!inputs.empty()) {
+    drive_inputs.push_back(absl::StrFormat("%s = __stimulus[__cycle];",
+                                           ConcatenatePorts(inputs)));
+    drive_x.push_back(absl::StrFormat(
+        "%s = {%d{1'bx}};", ConcatenatePorts(inputs), input_width));
+  }
+  if (valid_input.has_value()) {
+    drive_inputs.push_back(absl::StrFormat("%s = 1;", *valid_input));
+    drive_x.push_back(absl::StrFormat("%s = 0;", *valid_input));
+  }
+  // Returns the statement printing the outputs for the input `index`.
+  auto display = [&](std::string_view index) {
+    std::string format = absl::StrCat(kOutputMarker, " %0d:");
+    std::string args = std::string(index);
+    for (const PortProto* output : outputs) {
+      absl::StrAppend(&format, " %h");
+      absl::StrAppend(&args, ", ", output->name());
+    }
+    return absl::StrFormat("$display(\"%s\", %s);", format, args);
+  };
+  auto append = [&](int64_t indent, absl::Span<const std::string> lines) {
+    for (const std::string& line : lines) {
+      absl::StrAppend(&tb, std::string(indent, ' '), line, "\n");
+    }
+  };
+
+  absl::StrAppend(&tb, R"(  initial begin
+    if (!$value$plusargs("stimulus=%s", __stimulus_path) ||
+        !$value$plusargs("count=%d", __count)) begin
+      $display("ERROR: +stimulus and +count must be specified");
+      $finish;
+    end
+    $readmemh(__stimulus_path, __stimulus, 0, __count - 1);
+)");
+  append(4, drive_x);
+  if (load_enable.has_value()) {
+    absl::StrAppendFormat(&tb, "    %s = {%d{1'b1}};\n", *load_enable,
+                          latency);
+  }
+  if (proto.has_reset()) {
+    bool active_low = proto.reset().active_low();
+    absl::StrAppendFormat(&tb, "    %s = %d;\n    #%d;\n    %s = %d;\n",
+                          proto.reset().name(), active_low ? 0 : 1,
+                          kResetCycles * kClockPeriod, proto.reset().name(),
+                          active_low ? 1 : 0);
+  }
+
+  if (proto.has_fixed_latency()) {
+    // Each input is held until its output is sampled and for one more cycle.
+    append(4, {"for (__cycle = 0; __cycle < __count; "
+               "__cycle = __cycle + 1) begin"});
+    append(6, drive_inputs);
+    append(6, {absl::StrFormat("#%d;", latency * kClockPeriod + kSampleDelay),
+               display("__cycle"),
+               absl::StrFormat("#%d;", 2 * kClockPeriod - kSampleDelay)});
+    append(4, {"end"});
+  } else {
+    // The output for the input driven in cycle `c` is sampled at the end of
+    // cycle `c + latency`.
+    append(4, {absl::StrFormat("for (__cycle = 0; __cycle < __count + %d; "
+                               "__cycle = __cycle + 1) begin",
+                               latency),
+               "  if (__cycle < __count) begin"});
+    append(8, drive_inputs);
+    append(6, {"end else begin"});
+    append(8, drive_x);
+    append(6, {"end", absl::StrFormat("#%d;", kSampleDelay),
+               absl::StrFormat("if (__cycle >= %d) begin", latency)});
+    append(8, {display(absl::StrFormat("__cycle - %d", latency))});
+    append(6, {"end", absl::StrFormat("#%d;", kClockPeriod - kSampleDelay)});
+    append(4, {"end"});
+  }
+  absl::StrAppend(&tb, "    $finish;\n  end\nendmodule\n");
+  return tb;
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<CompiledModuleSimulator>>
+CompiledModuleSimulator::Create(const ModuleSignature& signature,
+                                std::string_view verilog_text,
+                                FileType file_type,
+                                const VerilogSimulator* simulator,
+                                absl::Span<const VerilogInclude> includes,
+                                int64_t max_batch_size) {
+  XLS_RET_CHECK_GT(max_batch_size, 0);
+  XLS_ASSIGN_OR_RETURN(std::string testbench,
+                       GenerateTestbench(signature, max_batch_size));
+  VLOG(2) << "Testbench:\n" << testbench;
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<VerilogSimulator::CompiledSimulation> simulation,
+      simulator->Compile(absl::StrCat(verilog_text, "\n", testbench),
+                         file_type, /*macro_definitions=*/{}, includes));
+  return absl::WrapUnique(new CompiledModuleSimulator(
+      signature, max_batch_size, std::move(testbench), std::move(simulation)));
+}
+
+absl::StatusOr<std::vector<CompiledModuleSimulator::BitsMap>>
+CompiledModuleSimulator::RunBatched(absl::Span<const BitsMap> inputs) const {
+  std::vector<BitsMap> outputs;
+  outputs.reserve(inputs.size());
+  for (int64_t begin = 0; begin < inputs.size(); begin += max_batch_size_) {
+    int64_t size = std::min<int64_t>(max_batch_size_, inputs.size() - begin);
+    XLS_ASSIGN_OR_RETURN(std::vector<BitsMap> chunk_outputs,
+                         RunChunk(inputs.subspan(begin, size)));
+    for (BitsMap& output : chunk_outputs) {
+      outputs.push_back(std::move(output));
+    }
+  }
+  return outputs;
+}
+
+absl::StatusOr<std::vector<Value>> CompiledModuleSimulator::RunBatched(
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const {
+  XLS_RET_CHECK_EQ(signature_.data_outputs().size(), 1);
+  std::vector<BitsMap> bits_inputs;
+  bits_inputs.reserve(inputs.size());
+  for (const auto& input : inputs) {
+    XLS_RETURN_IF_ERROR(signature_.ValidateInputs(input));
+    BitsMap bits_input;
+    for (const auto& [name, value] : input) {
+      bits_input[name] = FlattenValueToBits(value);
+    }
+    bits_inputs.push_back(std::move(bits_input));
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<BitsMap> bits_outputs,
+                       RunBatched(bits_inputs));
+  const PortProto& output_port = signature_.data_outputs().front();
+  std::vector<Value> outputs;
+  outputs.reserve(bits_outputs.size());
+  for (const BitsMap& bits_output : bits_outputs) {
+    XLS_ASSIGN_OR_RETURN(
+        Value output, UnflattenBitsToValue(bits_output.at(output_port.name()),
+                                           output_port.type()));
+    outputs.push_back(std::move(output));
+  }
+  return outputs;
+}
+
+absl::StatusOr<std::vector<CompiledModuleSimulator::BitsMap>>
+CompiledModuleSimulator::RunChunk(absl::Span<const BitsMap> inputs) const {
+  if (inputs.empty()) {
+    return std::vector<BitsMap>();
+  }
+  std::vector<const PortProto*> input_ports =
+      NonZeroWidthPorts(signature_.data_inputs());
+  std::string stimulus;
+  for (const BitsMap& input : inputs) {
+    XLS_RETURN_IF_ERROR(signature_.ValidateInputs(input));
+    std::vector<Bits> elements;
+    elements.reserve(input_ports.size());
+    for (const PortProto* port : input_ports) {
+      elements.push_back(input.at(port->name()));
+    }
+    Bits vector = elements.empty() ? UBits(0, 1) : bits_ops::Concat(elements);
+    absl::StrAppend(&stimulus,
+                    BitsToString(vector, FormatPreference::kPlainHex), "\n");
+  }
+  XLS_ASSIGN_OR_RETURN(TempFile stimulus_file, TempFile::Create(".hex"));
+  XLS_RETURN_IF_ERROR(SetFileContents(stimulus_file.path(), stimulus));
+
+  std::pair<std::string, std::string> stdout_stderr;
+  XLS_ASSIGN_OR_RETURN(
+      stdout_stderr,
+      simulation_->Run(
+          {absl::StrCat("stimulus=", stimulus_file.path().string()),
+           absl::StrCat("count=", inputs.size())}));
+  VLOG(2) << "Verilog simulator stdout:\n" << stdout_stderr.first;
+
+  std::vector<const PortProto*> output_ports =
+      NonZeroWidthPorts(signature_.data_outputs());
+  std::vector<std::optional<BitsMap>> outputs(inputs.size());
+  for (std::string_view line : absl::StrSplit(stdout_stderr.first, '\n')) {
+    if (absl::StartsWith(line, "ERROR")) {
+      return absl::InternalError(
+          absl::StrCat("Simulation failed: ", stdout_stderr.first));
+    }
+    if (!absl::ConsumePrefix(&line, kOutputMarker)) {
+      continue;
+    }
+    std::vector<std::string_view> fields =
+        absl::StrSplit(line, ' ', absl::SkipEmpty());
+    XLS_RET_CHECK_EQ(fields.size(), output_ports.size() + 1) << line;
+    int64_t index;
+    XLS_RET_CHECK(absl::SimpleAtoi(absl::StripSuffix(fields[0], ":"), &index))
+        << line;
+    XLS_RET_CHECK(index >= 0 && index < inputs.size()) << line;
+    BitsMap& output = outputs[index].emplace();
+    for (int64_t i = 0; i < output_ports.size(); ++i) {
+      const PortProto& port = *output_ports[i];
+      if (absl::StrContainsIgnoreCase(fields[i + 1], "x") ||
+          absl::StrContainsIgnoreCase(fields[i + 1], "z")) {
+        return absl::FailedPreconditionError(absl::StrFormat(
+            "Output `%s` for input %d has X or Z bits: %s", port.name(), index,
+            fields[i + 1]));
+      }
+      XLS_ASSIGN_OR_RETURN(output[port.name()],
+                           ParseUnsignedNumberWithoutPrefix(
+                               fields[i + 1], FormatPreference::kHex,
+                               port.width()));
+    }
+  }
+
+  std::vector<BitsMap> result;
+  result.reserve(inputs.size());
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    if (!outputs[i].has_value()) {
+      return absl::InternalError(
+          absl::StrFormat("Simulation produced no output for input %d", i));
+    }
+    for (const PortProto& port : signature_.data_outputs()) {
+      if (port.width() == 0) {
+        (*outputs[i])[port.name()] = Bits();
+      }
+    }
+    result.push_back(*std::move(outputs[i]));
+  }
+  return result;
+}
+
+}  // namespace verilog
+}  // namespace xls
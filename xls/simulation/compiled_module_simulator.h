@@ -0,0 +1,98 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SIMULATION_COMPILED_MODULE_SIMULATOR_H_
+#define XLS_SIMULATION_COMPILED_MODULE_SIMULATOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/codegen/vast.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/value.h"
+#include "xls/simulation/module_simulator.h"
+#include "xls/simulation/verilog_simulator.h"
+#include "xls/tools/verilog_include.h"
+
+namespace xls {
+namespace verilog {
+
+// Simulates a module with a function-like interface (combinational, fixed
+// latency or pipelined) like ModuleSimulator::RunBatched, but compiles the
+// module only once. The module is compiled along with a generic testbench
+// which reads the input vectors from a file with $readmemh at run time, so
+// each batch only costs a run of the compiled image. This pays off when the
+// same module is simulated repeatedly with different inputs.
+//
+// Requires a simulator which supports VerilogSimulator::Compile().
+class CompiledModuleSimulator {
+ public:
+  using BitsMap = ModuleSimulator::BitsMap;
+
+  // The default maximum number of inputs per run of the compiled image.
+  static constexpr int64_t kDefaultMaxBatchSize = 4096;
+
+  // Compiles the module described by `signature` in `verilog_text`. The
+  // testbench has room for `max_batch_size` inputs; larger batches are run in
+  // several runs of the compiled image.
+  static absl::StatusOr<std::unique_ptr<CompiledModuleSimulator>> Create(
+      const ModuleSignature& signature, std::string_view verilog_text,
+      FileType file_type, const VerilogSimulator* simulator,
+      absl::Span<const VerilogInclude> includes = {},
+      int64_t max_batch_size = kDefaultMaxBatchSize);
+
+  // Runs the given inputs through the module. The results are the same as
+  // those of ModuleSimulator::RunBatched.
+  absl::StatusOr<std::vector<BitsMap>> RunBatched(
+      absl::Span<const BitsMap> inputs) const;
+
+  // Overload which accepts Values rather than Bits. The module must have a
+  // single data output.
+  absl::StatusOr<std::vector<Value>> RunBatched(
+      absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const;
+
+  // Returns the generic testbench compiled along with the module.
+  const std::string& testbench() const { return testbench_; }
+
+ private:
+  CompiledModuleSimulator(
+      const ModuleSignature& signature, int64_t max_batch_size,
+      std::string testbench,
+      std::unique_ptr<VerilogSimulator::CompiledSimulation> simulation)
+      : signature_(signature),
+        max_batch_size_(max_batch_size),
+        testbench_(std::move(testbench)),
+        simulation_(std::move(simulation)) {}
+
+  // Runs a batch of at most `max_batch_size_` inputs.
+  absl::StatusOr<std::vector<BitsMap>> RunChunk(
+      absl::Span<const BitsMap> inputs) const;
+
+  ModuleSignature signature_;
+  int64_t max_batch_size_;
+  std::string testbench_;
+  std::unique_ptr<VerilogSimulator::CompiledSimulation> simulation_;
+};
+
+}  // namespace verilog
+}  // namespace xls
+
+#endif  // XLS_SIMULATION_COMPILED_MODULE_SIMULATOR_H_
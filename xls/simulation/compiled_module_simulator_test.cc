@@ -0,0 +1,208 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/simulation/compiled_module_simulator.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/simulation/module_simulator.h"
+#include "xls/simulation/verilog_test_base.h"
+
+namespace xls {
+namespace verilog {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+using BitsMap = ModuleSimulator::BitsMap;
+
+constexpr char kFixedLatencyText[] = R"(
+module fixed_latency_3(
+  input wire clk,
+  input wire [7:0] x,
+  output wire [7:0] out
+);
+
+  reg [7:0] x_0;
+  reg [7:0] x_1;
+  reg [7:0] x_2;
+  assign out = x_2 + x;
+
+  always @ (posedge clk) begin
+    x_0 <= x;
+    x_1 <= x_0;
+    x_2 <= x_1;
+  end
+
+endmodule
+)";
+
+constexpr char kCombinationalText[] = R"(
+module comb_diff(
+  input wire [7:0] x,
+  input wire [7:0] y,
+  output wire [7:0] out
+);
+
+  assign out = x - y;
+
+endmodule
+)";
+
+constexpr char kPipelineText[] = R"(
+module pipelined_sum(
+  input wire clk,
+  input wire [7:0] x,
+  input wire [7:0] y,
+  output wire [7:0] out
+);
+
+  reg [7:0] x_0;
+  reg [7:0] y_0;
+  reg [7:0] sum_1;
+  assign out = sum_1;
+
+  always @ (posedge clk) begin
+    x_0 <= x;
+    y_0 <= y;
+    sum_1 <= x_0 + y_0;
+  end
+
+endmodule
+)";
+
+class CompiledModuleSimulatorTest : public VerilogTestBase {
+ protected:
+  // Compiles the module, or returns nullptr if the simulator does not support
+  // separate compilation.
+  absl::StatusOr<std::unique_ptr<CompiledModuleSimulator>> Compile(
+      const ModuleSignature& signature, std::string_view text,
+      int64_t max_batch_size = CompiledModuleSimulator::kDefaultMaxBatchSize) {
+    absl::StatusOr<std::unique_ptr<CompiledModuleSimulator>> simulator =
+        CompiledModuleSimulator::Create(signature, text, GetFileType(),
+                                        GetSimulator(), /*includes=*/{},
+                                        max_batch_size);
+    if (absl::IsUnimplemented(simulator.status())) {
+      return nullptr;
+    }
+    return simulator;
+  }
+};
+
+TEST_P(CompiledModuleSimulatorTest, FixedLatency) {
+  ModuleSignatureBuilder b("fixed_latency_3");
+  b.WithClock("clk").WithFixedLatencyInterface(3);
+  b.AddDataInputAsBits("x", 8);
+  b.AddDataOutputAsBits("out", 8);
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleSignature signature, b.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledModuleSimulator> simulator,
+                           Compile(signature, kFixedLatencyText));
+  if (simulator == nullptr) {
+    GTEST_SKIP() << "Simulator does not support separate compilation";
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<BitsMap> outputs,
+      simulator->RunBatched({BitsMap{{"x", UBits(44, 8)}},
+                             BitsMap{{"x", UBits(123, 8)}},
+                             BitsMap{{"x", UBits(7, 8)}}}));
+  ASSERT_EQ(outputs.size(), 3);
+  EXPECT_THAT(outputs[0], ElementsAre(Pair("out", UBits(88, 8))));
+  EXPECT_THAT(outputs[1], ElementsAre(Pair("out", UBits(246, 8))));
+  EXPECT_THAT(outputs[2], ElementsAre(Pair("out", UBits(14, 8))));
+}
+
+TEST_P(CompiledModuleSimulatorTest, CombinationalSeveralBatches) {
+  ModuleSignatureBuilder b("comb_diff");
+  b.WithCombinationalInterface();
+  b.AddDataInputAsBits("x", 8);
+  b.AddDataInputAsBits("y", 8);
+  b.AddDataOutputAsBits("out", 8);
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleSignature signature, b.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledModuleSimulator> simulator,
+                           Compile(signature, kCombinationalText));
+  if (simulator == nullptr) {
+    GTEST_SKIP() << "Simulator does not support separate compilation";
+  }
+
+  // The compiled image is reused for each batch.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<BitsMap> outputs,
+      simulator->RunBatched(
+          {BitsMap{{"x", UBits(99, 8)}, {"y", UBits(12, 8)}},
+           BitsMap{{"x", UBits(100, 8)}, {"y", UBits(25, 8)}}}));
+  EXPECT_THAT(outputs, ElementsAre(ElementsAre(Pair("out", UBits(87, 8))),
+                                   ElementsAre(Pair("out", UBits(75, 8)))));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      outputs, simulator->RunBatched(
+                   {BitsMap{{"x", UBits(255, 8)}, {"y", UBits(155, 8)}}}));
+  EXPECT_THAT(outputs, ElementsAre(ElementsAre(Pair("out", UBits(100, 8)))));
+
+  XLS_ASSERT_OK_AND_ASSIGN(outputs,
+                           simulator->RunBatched(std::vector<BitsMap>()));
+  EXPECT_TRUE(outputs.empty());
+}
+
+TEST_P(CompiledModuleSimulatorTest, PipelineBatchLargerThanMaxBatchSize) {
+  ModuleSignatureBuilder b("pipelined_sum");
+  b.WithClock("clk").WithPipelineInterface(/*latency=*/2,
+                                           /*initiation_interval=*/1);
+  b.AddDataInputAsBits("x", 8);
+  b.AddDataInputAsBits("y", 8);
+  b.AddDataOutputAsBits("out", 8);
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleSignature signature, b.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledModuleSimulator> simulator,
+                           Compile(signature, kPipelineText,
+                                   /*max_batch_size=*/16));
+  if (simulator == nullptr) {
+    GTEST_SKIP() << "Simulator does not support separate compilation";
+  }
+
+  // Enough inputs for three runs of the compiled image.
+  const int64_t kInputCount = 40;
+  std::vector<BitsMap> inputs;
+  for (int64_t i = 0; i < kInputCount; ++i) {
+    inputs.push_back(
+        BitsMap{{"x", UBits(i, 8)}, {"y", UBits((5 * i) % 256, 8)}});
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<BitsMap> outputs,
+                           simulator->RunBatched(inputs));
+  ASSERT_EQ(outputs.size(), kInputCount);
+  for (int64_t i = 0; i < kInputCount; ++i) {
+    EXPECT_THAT(outputs[i], ElementsAre(Pair("out", UBits((6 * i) % 256, 8))))
+        << "input " << i;
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(CompiledModuleSimulatorTestInstantiation,
+                         CompiledModuleSimulatorTest,
+                         testing::ValuesIn(kDefaultSimulationTargets),
+                         ParameterizedTestName<CompiledModuleSimulatorTest>);
+
+}  // namespace
+}  // namespace verilog
+}  // namespace xls
@@ -16,6 +16,8 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <string>
@@ -34,12 +36,16 @@
 #include "absl/types/span.h"
 #include "xls/codegen/flattening.h"
 #include "xls/codegen/module_signature.h"
+#include "xls/codegen/module_signature.pb.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/value.h"
 #include "xls/simulation/module_testbench.h"
 #include "xls/simulation/module_testbench_thread.h"
+#include "xls/simulation/testbench_stream.h"
 #include "xls/tools/eval_utils.h"
 
 namespace xls {
@@ -304,7 +310,45 @@ absl::StatusOr<Bits> ModuleSimulator::RunAndReturnSingleOutput(
 }
 
 absl::StatusOr<std::vector<ModuleSimulator::BitsMap>>
-ModuleSimulator::RunBatched(absl::Span<const BitsMap> inputs) const {
+ModuleSimulator::RunBatched(absl::Span<const BitsMap> inputs,
+                            int64_t max_shard_count) const {
+  int64_t input_count = inputs.size();
+  int64_t shard_count =
+      std::min(max_shard_count, CeilOfRatio(input_count, kMinShardSize));
+  if (shard_count <= 1) {
+    return RunBatchedInOneSimulation(inputs);
+  }
+
+  VLOG(1) << absl::StreamFormat("Running %d inputs in %d shards", input_count,
+                                shard_count);
+  std::vector<absl::StatusOr<std::vector<BitsMap>>> shard_outputs(shard_count);
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(shard_count);
+    for (int64_t i = 0; i < shard_count; ++i) {
+      int64_t begin = i * input_count / shard_count;
+      int64_t end = (i + 1) * input_count / shard_count;
+      threads.push_back(std::make_unique<Thread>([&, i, begin, end]() {
+        shard_outputs[i] =
+            RunBatchedInOneSimulation(inputs.subspan(begin, end - begin));
+      }));
+    }
+    // The threads are joined on destruction.
+  }
+
+  std::vector<BitsMap> outputs;
+  outputs.reserve(input_count);
+  for (absl::StatusOr<std::vector<BitsMap>>& shard : shard_outputs) {
+    XLS_RETURN_IF_ERROR(shard.status());
+    std::move(shard->begin(), shard->end(), std::back_inserter(outputs));
+  }
+  XLS_RET_CHECK_EQ(outputs.size(), input_count);
+  return outputs;
+}
+
+absl::StatusOr<std::vector<ModuleSimulator::BitsMap>>
+ModuleSimulator::RunBatchedInOneSimulation(
+    absl::Span<const BitsMap> inputs) const {
   VLOG(1) << "Running Verilog module with signature:\n"
           << signature_.ToString();
   if (VLOG_IS_ON(1)) {
@@ -332,6 +376,10 @@ ModuleSimulator::RunBatched(absl::Span<const BitsMap> inputs) const {
     return absl::InvalidArgumentError("Expected clock in signature");
   }
 
+  if (inputs.size() >= kMinStreamingBatchSize) {
+    return RunBatchedWithStreams(inputs);
+  }
+
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<ModuleTestbench> tb,
                        ModuleTestbench::CreateFromVerilogText(
                            verilog_text_, file_type_, signature_, simulator_,
@@ -485,6 +533,226 @@ ModuleSimulator::RunBatched(absl::Span<const BitsMap> inputs) const {
   return outputs;
 }
 
+absl::StatusOr<std::vector<ModuleSimulator::BitsMap>>
+ModuleSimulator::RunBatchedWithStreams(absl::Span<const BitsMap> inputs) const {
+  const ModuleSignatureProto& proto = signature_.proto();
+  const int64_t input_count = inputs.size();
+  int64_t latency = 0;
+  int64_t cycle_count;
+  std::optional<PipelineControl> pipeline_control;
+  if (proto.has_fixed_latency()) {
+    latency = proto.fixed_latency().latency();
+    cycle_count = input_count * (latency + 2);
+  } else if (proto.has_pipeline()) {
+    latency = proto.pipeline().latency();
+    cycle_count = input_count + latency + 1;
+    if (proto.pipeline().has_pipeline_control()) {
+      pipeline_control = proto.pipeline().pipeline_control();
+    }
+  } else if (proto.has_combinational()) {
+    cycle_count = input_count;
+  } else {
+    return absl::UnimplementedError(
+        absl::StrCat("Unsupported interface: ", proto.interface_oneof_case()));
+  }
+  std::optional<std::string> valid_output;
+  if (pipeline_control.has_value() && pipeline_control->has_valid() &&
+      pipeline_control->valid().has_output_name()) {
+    valid_output = pipeline_control->valid().output_name();
+  }
+
+  // A large batch may need more than the default cycle limit so scale the
+  // limit with the batch.
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ModuleTestbench> tb,
+      ModuleTestbench::CreateFromVerilogText(
+          verilog_text_, file_type_, signature_, simulator_,
+          /*reset_dut=*/true, includes_,
+          /*simulation_cycle_limit=*/cycle_count +
+              kDefaultSimulationCycleLimit));
+
+  // Each data port is connected to a stream carrying one value per input.
+  // Zero-width ports are not present in the Verilog so they are neither driven
+  // nor captured.
+  std::vector<const PortProto*> input_ports;
+  std::vector<const TestbenchStream*> input_streams;
+  for (const PortProto& port : signature_.data_inputs()) {
+    if (port.width() > 0) {
+      XLS_ASSIGN_OR_RETURN(
+          const TestbenchStream* stream,
+          tb->CreateInputStream(absl::StrCat("input_", port.name()),
+                                port.width()));
+      input_ports.push_back(&port);
+      input_streams.push_back(stream);
+    }
+  }
+  std::vector<const PortProto*> output_ports;
+  std::vector<const TestbenchStream*> output_streams;
+  for (const PortProto& port : signature_.data_outputs()) {
+    if (port.width() > 0) {
+      XLS_ASSIGN_OR_RETURN(
+          const TestbenchStream* stream,
+          tb->CreateOutputStream(absl::StrCat("output_", port.name()),
+                                 port.width()));
+      output_ports.push_back(&port);
+      output_streams.push_back(stream);
+    }
+  }
+  // The output valid signal is streamed as well rather than checked with an
+  // expectation so the simulator output does not grow with the batch.
+  const TestbenchStream* valid_stream = nullptr;
+  if (valid_output.has_value()) {
+    XLS_ASSIGN_OR_RETURN(valid_stream,
+                         tb->CreateOutputStream("output_valid", 1));
+  }
+
+  std::vector<DutInput> dut_inputs = DeassertControlSignals();
+  for (const auto& [name, _] : inputs.front()) {
+    dut_inputs.push_back(DutInput{name, IsX()});
+  }
+  XLS_ASSIGN_OR_RETURN(ModuleTestbenchThread * tbt,
+                       tb->CreateThread("input driver", dut_inputs));
+  SequentialBlock& seq_block = tbt->MainBlock();
+
+  auto read_inputs = [&](SequentialBlock& block) {
+    for (int64_t i = 0; i < input_ports.size(); ++i) {
+      block.ReadFromStreamAndSet(input_ports[i]->name(), input_streams[i]);
+    }
+  };
+  auto write_outputs = [&](EndOfCycleEvent& event) {
+    for (int64_t i = 0; i < output_ports.size(); ++i) {
+      event.CaptureAndWriteToStream(output_ports[i]->name(), output_streams[i]);
+    }
+    if (valid_stream != nullptr) {
+      event.CaptureAndWriteToStream(*valid_output, valid_stream);
+    }
+  };
+
+  if (proto.has_fixed_latency()) {
+    // As in the inline testbench, each input is held while the output is read
+    // and for one more cycle.
+    SequentialBlock& loop = seq_block.Repeat(input_count);
+    read_inputs(loop);
+    if (latency > 0) {
+      loop.AdvanceNCycles(latency);
+    }
+    write_outputs(loop.AtEndOfCycle());
+    loop.NextCycle();
+  } else if (proto.has_combinational()) {
+    SequentialBlock& loop = seq_block.Repeat(input_count);
+    read_inputs(loop);
+    write_outputs(loop.AtEndOfCycle());
+  } else {
+    if (pipeline_control.has_value() && pipeline_control->has_manual()) {
+      // Drive the pipeline register load-enable signals high.
+      seq_block.Set(pipeline_control->manual().input_name(),
+                    Bits::AllOnes(latency));
+    }
+    if (pipeline_control.has_value() && pipeline_control->has_valid()) {
+      seq_block.Set(pipeline_control->valid().input_name(), 1);
+    }
+    SequentialBlock& loop = seq_block.Repeat(input_count);
+    read_inputs(loop);
+    loop.NextCycle();
+    for (const PortProto& input : signature_.data_inputs()) {
+      seq_block.SetX(input.name());
+    }
+    if (pipeline_control.has_value() && pipeline_control->has_valid()) {
+      seq_block.Set(pipeline_control->valid().input_name(), 0);
+    }
+
+    // A second thread captures the outputs once the first input has reached
+    // the end of the pipeline.
+    XLS_ASSIGN_OR_RETURN(ModuleTestbenchThread * output_thread,
+                         tb->CreateThread("output capture", /*dut_inputs=*/{}));
+    SequentialBlock& output_block = output_thread->MainBlock();
+    for (int64_t i = 0; i < latency; ++i) {
+      EndOfCycleEvent& event = output_block.AtEndOfCycle();
+      if (valid_output.has_value()) {
+        // The output_valid signal should still be X if there is no reset
+        // signal.
+        if (proto.has_reset()) {
+          event.ExpectEq(*valid_output, 0);
+        } else {
+          event.ExpectX(*valid_output);
+        }
+      }
+    }
+    write_outputs(output_block.Repeat(input_count).AtEndOfCycle());
+    if (valid_output.has_value()) {
+      // valid == 0 should have propagated all the way through the pipeline to
+      // output_valid.
+      output_block.AtEndOfCycle().ExpectEq(*valid_output, 0);
+    }
+  }
+
+  // The streaming threads hold references to the producers and consumers so
+  // they are kept in vectors which outlive the simulation.
+  std::vector<int64_t> next_input(input_ports.size(), 0);
+  std::vector<std::function<std::optional<Bits>()>> producers;
+  producers.reserve(input_ports.size());
+  for (int64_t i = 0; i < input_ports.size(); ++i) {
+    producers.push_back([&, i]() -> std::optional<Bits> {
+      if (next_input[i] >= input_count) {
+        return std::nullopt;
+      }
+      return inputs[next_input[i]++].at(input_ports[i]->name());
+    });
+  }
+  std::vector<std::vector<Bits>> output_values(output_ports.size());
+  std::vector<std::function<absl::Status(const Bits&)>> consumers;
+  consumers.reserve(output_ports.size() + 1);
+  for (int64_t i = 0; i < output_ports.size(); ++i) {
+    consumers.push_back([&, i](const Bits& bits) {
+      output_values[i].push_back(bits);
+      return absl::OkStatus();
+    });
+  }
+  if (valid_stream != nullptr) {
+    consumers.push_back([&](const Bits& bits) {
+      if (!bits.IsOne()) {
+        return absl::FailedPreconditionError(absl::StrFormat(
+            "Expected `%s` to be asserted when outputs are captured",
+            *valid_output));
+      }
+      return absl::OkStatus();
+    });
+  }
+  absl::flat_hash_map<std::string, TestbenchStreamThread::Producer>
+      input_producers;
+  for (int64_t i = 0; i < input_streams.size(); ++i) {
+    input_producers.emplace(input_streams[i]->name, producers[i]);
+  }
+  absl::flat_hash_map<std::string, TestbenchStreamThread::Consumer>
+      output_consumers;
+  for (int64_t i = 0; i < output_streams.size(); ++i) {
+    output_consumers.emplace(output_streams[i]->name, consumers[i]);
+  }
+  if (valid_stream != nullptr) {
+    output_consumers.emplace(valid_stream->name, consumers.back());
+  }
+
+  XLS_RETURN_IF_ERROR(
+      tb->RunWithStreamingIo(input_producers, output_consumers));
+
+  std::vector<BitsMap> outputs(input_count);
+  for (int64_t i = 0; i < output_ports.size(); ++i) {
+    XLS_RET_CHECK_EQ(output_values[i].size(), input_count)
+        << "Output " << output_ports[i]->name();
+    for (int64_t j = 0; j < input_count; ++j) {
+      outputs[j][output_ports[i]->name()] = std::move(output_values[i][j]);
+    }
+  }
+  for (const PortProto& port : signature_.data_outputs()) {
+    if (port.width() == 0) {
+      for (BitsMap& output : outputs) {
+        output[port.name()] = Bits();
+      }
+    }
+  }
+  return outputs;
+}
+
 absl::StatusOr<Value> ModuleSimulator::RunFunction(
     const absl::flat_hash_map<std::string, Value>& inputs) const {
   absl::flat_hash_map<std::string, Value> input_map(inputs.begin(),
@@ -495,14 +763,15 @@ absl::StatusOr<Value> ModuleSimulator::RunFunction(
 }
 
 absl::StatusOr<std::vector<Value>> ModuleSimulator::RunBatched(
-    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const {
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+    int64_t max_shard_count) const {
   std::vector<BitsMap> bits_inputs;
   for (const auto& input : inputs) {
     XLS_RETURN_IF_ERROR(signature_.ValidateInputs(input));
     bits_inputs.push_back(ValueMapToBitsMap(input));
   }
   XLS_ASSIGN_OR_RETURN(std::vector<BitsMap> bits_outputs,
-                       RunBatched(bits_inputs));
+                       RunBatched(bits_inputs, max_shard_count));
   CHECK_EQ(signature_.data_outputs().size(), 1);
   std::vector<Value> outputs;
   for (const BitsMap& bits_output : bits_outputs) {
@@ -15,6 +15,7 @@
 #ifndef XLS_SIMULATION_MODULE_SIMULATOR_H_
 #define XLS_SIMULATION_MODULE_SIMULATOR_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -23,6 +24,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/vast.h"
 #include "xls/ir/value.h"
@@ -102,14 +104,33 @@ class ModuleSimulator {
   // Runs the given batch of argument values through the module with a single
   // invocation of the Verilog simulator. Generally, this is much faster than
   // running via separate calls to Run.
+  //
+  // If `max_shard_count` is greater than one, large batches are instead split
+  // into up to that many contiguous shards of at least kMinShardSize inputs,
+  // each run by a concurrent invocation of the Verilog simulator with its own
+  // testbench. Outputs are returned in the order of the inputs. Each shard
+  // starts from reset so sharding is only equivalent to a single invocation
+  // if the outputs for each input do not depend on earlier inputs.
   absl::StatusOr<std::vector<BitsMap>> RunBatched(
-      absl::Span<const BitsMap> inputs) const;
+      absl::Span<const BitsMap> inputs, int64_t max_shard_count = 1) const;
 
   // Overloads which accept Values rather than Bits.
   absl::StatusOr<Value> RunFunction(
       const absl::flat_hash_map<std::string, Value>& inputs) const;
   absl::StatusOr<std::vector<Value>> RunBatched(
-      absl::Span<const absl::flat_hash_map<std::string, Value>> inputs) const;
+      absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+      int64_t max_shard_count = 1) const;
+
+  // The minimum number of inputs of each shard run by RunBatched. Smaller
+  // shards would not amortize the cost of compiling the testbench.
+  static constexpr int64_t kMinShardSize = 256;
+
+  // Batches of at least this many inputs are run with a testbench which
+  // streams the inputs and outputs through named pipes rather than one which
+  // embeds each input vector, so the size and compile time of the testbench do
+  // not grow with the batch. Smaller batches use the inline testbench which is
+  // easier to read.
+  static constexpr int64_t kMinStreamingBatchSize = 16;
 
   // Runs the given channel inputs and expects a number of values at an output
   // channel on the a design under test (DUT) derived from a proc.
@@ -140,6 +161,14 @@ class ModuleSimulator {
   // Returns the control input ports and their deasserted values.
   std::vector<DutInput> DeassertControlSignals() const;
 
+  // Runs the given batch with a single invocation of the Verilog simulator.
+  absl::StatusOr<std::vector<BitsMap>> RunBatchedInOneSimulation(
+      absl::Span<const BitsMap> inputs) const;
+
+  // Runs the given non-empty and validated batch with a streaming testbench.
+  absl::StatusOr<std::vector<BitsMap>> RunBatchedWithStreams(
+      absl::Span<const BitsMap> inputs) const;
+
   struct ProcTestbench {
     std::unique_ptr<ModuleTestbench> testbench;
 
@@ -353,6 +353,53 @@ TEST_P(ModuleSimulatorTest, CombinationalBatched) {
   EXPECT_THAT(outputs[2], ElementsAre(Pair("out", UBits(100, 8))));
 }
 
+TEST_P(ModuleSimulatorTest, CombinationalBatchedInShards) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto verilog_signature, MakeCombinationalModule());
+  ModuleSimulator simulator =
+      NewModuleSimulator(verilog_signature.first, verilog_signature.second);
+
+  // Enough inputs for four shards, with a partial last shard.
+  using BitsMap = ModuleSimulator::BitsMap;
+  const int64_t kInputCount = 3 * ModuleSimulator::kMinShardSize + 17;
+  std::vector<BitsMap> inputs;
+  for (int64_t i = 0; i < kInputCount; ++i) {
+    inputs.push_back(
+        BitsMap{{"x", UBits(i % 256, 8)}, {"y", UBits((7 * i) % 256, 8)}});
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<BitsMap> outputs,
+      simulator.RunBatched(inputs, /*max_shard_count=*/8));
+
+  ASSERT_EQ(outputs.size(), kInputCount);
+  for (int64_t i = 0; i < kInputCount; ++i) {
+    EXPECT_THAT(outputs[i],
+                ElementsAre(Pair("out", UBits((i - 7 * i) & 0xff, 8))))
+        << "input " << i;
+  }
+}
+
+TEST_P(ModuleSimulatorTest, FixedLatencyBatchedWithStreams) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto verilog_signature, MakeFixedLatencyModule());
+  ModuleSimulator simulator =
+      NewModuleSimulator(verilog_signature.first, verilog_signature.second);
+
+  // Large enough to be streamed through the testbench.
+  using BitsMap = ModuleSimulator::BitsMap;
+  const int64_t kInputCount = 4 * ModuleSimulator::kMinStreamingBatchSize + 3;
+  std::vector<BitsMap> inputs;
+  for (int64_t i = 0; i < kInputCount; ++i) {
+    inputs.push_back(BitsMap{{"x", UBits((3 * i) % 256, 8)}});
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<BitsMap> outputs,
+                           simulator.RunBatched(inputs));
+
+  ASSERT_EQ(outputs.size(), kInputCount);
+  for (int64_t i = 0; i < kInputCount; ++i) {
+    EXPECT_THAT(outputs[i], ElementsAre(Pair("out", UBits((6 * i) & 0xff, 8))))
+        << "input " << i;
+  }
+}
+
 TEST_P(ModuleSimulatorTest, MultipleOutputs) {
   const std::string text = R"(
 module delay_3(
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <filesystem>  // NOLINT
+#include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -21,6 +22,7 @@
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/strip.h"
 #include "absl/types/span.h"
@@ -89,8 +91,57 @@ void AppendMacroDefinitionsToArgs(
   }
 }
 
+// A simulation compiled by iverilog which is run by vvp. Owns the directory
+// holding the compiled image.
+class IcarusCompiledSimulation : public VerilogSimulator::CompiledSimulation {
+ public:
+  IcarusCompiledSimulation(TempDirectory temp_dir,
+                           std::filesystem::path image_path)
+      : temp_dir_(std::move(temp_dir)), image_path_(std::move(image_path)) {}
+
+  absl::StatusOr<std::pair<std::string, std::string>> Run(
+      absl::Span<const std::string> plusargs) const override {
+    // vvp passes arguments after the image to the simulation as plusargs.
+    std::vector<std::string> args = {image_path_.string()};
+    for (const std::string& plusarg : plusargs) {
+      args.push_back(absl::StrCat("+", plusarg));
+    }
+    return InvokeVvp(args);
+  }
+
+ private:
+  TempDirectory temp_dir_;
+  std::filesystem::path image_path_;
+};
+
 class IcarusVerilogSimulator : public VerilogSimulator {
  public:
+  absl::StatusOr<std::unique_ptr<CompiledSimulation>> Compile(
+      std::string_view text, FileType file_type,
+      absl::Span<const MacroDefinition> macro_definitions,
+      absl::Span<const VerilogInclude> includes) const override {
+    if (file_type == FileType::kSystemVerilog) {
+      return absl::UnimplementedError(
+          "iverilog does not support SystemVerilog");
+    }
+    XLS_ASSIGN_OR_RETURN(TempDirectory temp_top, TempDirectory::Create());
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(temp_top.path()));
+    std::filesystem::path temp_dir = temp_top.path();
+
+    std::string top_v_path = temp_dir / GetTopFileName(file_type);
+    XLS_RETURN_IF_ERROR(SetFileContents(top_v_path, text));
+    XLS_RETURN_IF_ERROR(SetUpIncludes(temp_dir, includes));
+
+    std::filesystem::path image_path = temp_dir / "top.vvp";
+    std::vector<std::string> args = {top_v_path, "-o", image_path.string(),
+                                     "-I", temp_dir.string()};
+    AppendMacroDefinitionsToArgs(macro_definitions, args);
+    XLS_RETURN_IF_ERROR(InvokeIverilog(args).status());
+
+    return std::make_unique<IcarusCompiledSimulation>(std::move(temp_top),
+                                                      std::move(image_path));
+  }
+
   absl::StatusOr<std::pair<std::string, std::string>> Run(
       std::string_view text, FileType file_type,
       absl::Span<const MacroDefinition> macro_definitions,
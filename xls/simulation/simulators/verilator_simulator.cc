@@ -0,0 +1,181 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A VerilogSimulator which compiles the design with Verilator into a native
+// executable. Compilation is slower than with iverilog but the compiled
+// simulation runs much faster, which pays off for large designs and for
+// designs simulated repeatedly through CompiledModuleSimulator.
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/codegen/vast.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/module_initializer.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/subprocess.h"
+#include "xls/simulation/verilog_simulator.h"
+#include "xls/tools/verilog_include.h"
+
+ABSL_FLAG(std::string, verilator_path, "verilator",
+          "Path of the Verilator executable used by the `verilator` Verilog "
+          "simulator. Looked up in PATH if it is not an absolute path. "
+          "Requires Verilator 5 or later.");
+
+namespace xls {
+namespace verilog {
+namespace {
+
+absl::Status SetUpIncludes(const std::filesystem::path& temp_dir,
+                           absl::Span<const VerilogInclude> includes) {
+  for (const VerilogInclude& include : includes) {
+    std::filesystem::path path = temp_dir / include.relative_path;
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(path.parent_path()));
+    XLS_RETURN_IF_ERROR(SetFileContents(path, include.verilog_text));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::pair<std::string, std::string>> InvokeVerilator(
+    absl::Span<const std::string> args) {
+  std::vector<std::string> args_vec = {absl::GetFlag(FLAGS_verilator_path)};
+  args_vec.insert(args_vec.end(), args.begin(), args.end());
+  return SubprocessResultToStrings(
+      SubprocessErrorAsStatus(InvokeSubprocess(args_vec)));
+}
+
+// Returns the Verilator arguments common to compilation and syntax checking
+// of `top_path`. Lint and style warnings are common in generated code and
+// testbenches, and no warning should fail the simulation.
+std::vector<std::string> CommonArgs(
+    const std::filesystem::path& top_path, FileType file_type,
+    const std::filesystem::path& include_dir,
+    absl::Span<const VerilogSimulator::MacroDefinition> macro_definitions) {
+  std::vector<std::string> args = {"-Wno-fatal", "-Wno-lint", "-Wno-style",
+                                   absl::StrCat("-I", include_dir.string())};
+  if (file_type == FileType::kVerilog) {
+    args.push_back("--default-language");
+    args.push_back("1364-2005");
+  }
+  for (const VerilogSimulator::MacroDefinition& macro : macro_definitions) {
+    if (macro.value.has_value()) {
+      args.push_back(absl::StrFormat("-D%s=%s", macro.name, *macro.value));
+    } else {
+      args.push_back(absl::StrFormat("-D%s", macro.name));
+    }
+  }
+  args.push_back(top_path.string());
+  return args;
+}
+
+// A simulation compiled by Verilator into a native executable. Owns the
+// directory holding the executable.
+class VerilatorCompiledSimulation
+    : public VerilogSimulator::CompiledSimulation {
+ public:
+  VerilatorCompiledSimulation(TempDirectory temp_dir,
+                              std::filesystem::path executable_path)
+      : temp_dir_(std::move(temp_dir)),
+        executable_path_(std::move(executable_path)) {}
+
+  absl::StatusOr<std::pair<std::string, std::string>> Run(
+      absl::Span<const std::string> plusargs) const override {
+    std::vector<std::string> args = {executable_path_.string()};
+    for (const std::string& plusarg : plusargs) {
+      args.push_back(absl::StrCat("+", plusarg));
+    }
+    return SubprocessResultToStrings(
+        SubprocessErrorAsStatus(InvokeSubprocess(args)));
+  }
+
+ private:
+  TempDirectory temp_dir_;
+  std::filesystem::path executable_path_;
+};
+
+class VerilatorSimulator : public VerilogSimulator {
+ public:
+  absl::StatusOr<std::unique_ptr<CompiledSimulation>> Compile(
+      std::string_view text, FileType file_type,
+      absl::Span<const MacroDefinition> macro_definitions,
+      absl::Span<const VerilogInclude> includes) const override {
+    XLS_ASSIGN_OR_RETURN(TempDirectory temp_top, TempDirectory::Create());
+    std::filesystem::path temp_dir = temp_top.path();
+    std::filesystem::path top_path = temp_dir / GetTopFileName(file_type);
+    XLS_RETURN_IF_ERROR(SetFileContents(top_path, text));
+    XLS_RETURN_IF_ERROR(SetUpIncludes(temp_dir, includes));
+
+    // --binary builds a complete executable, including a main function which
+    // runs the top-level testbench, and --timing supports the delays and event
+    // controls used by the testbenches.
+    std::filesystem::path build_dir = temp_dir / "obj_dir";
+    std::vector<std::string> args = {"--binary", "--timing", "--Mdir",
+                                     build_dir.string(), "-o", "simulation"};
+    std::vector<std::string> common_args =
+        CommonArgs(top_path, file_type, temp_dir, macro_definitions);
+    args.insert(args.end(), common_args.begin(), common_args.end());
+    XLS_RETURN_IF_ERROR(InvokeVerilator(args).status());
+
+    return std::make_unique<VerilatorCompiledSimulation>(
+        std::move(temp_top), build_dir / "simulation");
+  }
+
+  absl::StatusOr<std::pair<std::string, std::string>> Run(
+      std::string_view text, FileType file_type,
+      absl::Span<const MacroDefinition> macro_definitions,
+      absl::Span<const VerilogInclude> includes) const override {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<CompiledSimulation> simulation,
+        Compile(text, file_type, macro_definitions, includes));
+    return simulation->Run(/*plusargs=*/{});
+  }
+
+  absl::Status RunSyntaxChecking(
+      std::string_view text, FileType file_type,
+      absl::Span<const MacroDefinition> macro_definitions,
+      absl::Span<const VerilogInclude> includes) const override {
+    XLS_ASSIGN_OR_RETURN(TempDirectory temp_top, TempDirectory::Create());
+    std::filesystem::path temp_dir = temp_top.path();
+    std::filesystem::path top_path = temp_dir / GetTopFileName(file_type);
+    XLS_RETURN_IF_ERROR(SetFileContents(top_path, text));
+    XLS_RETURN_IF_ERROR(SetUpIncludes(temp_dir, includes));
+
+    std::vector<std::string> args = {"--lint-only", "--timing"};
+    std::vector<std::string> common_args =
+        CommonArgs(top_path, file_type, temp_dir, macro_definitions);
+    args.insert(args.end(), common_args.begin(), common_args.end());
+    return InvokeVerilator(args).status();
+  }
+};
+
+XLS_REGISTER_MODULE_INITIALIZER(verilator_simulator, {
+  CHECK_OK(GetVerilogSimulatorManagerSingleton().RegisterVerilogSimulator(
+      "verilator", std::make_unique<VerilatorSimulator>()));
+});
+
+}  // namespace
+}  // namespace verilog
+}  // namespace xls
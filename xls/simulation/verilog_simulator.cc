@@ -104,6 +104,14 @@ absl::StatusOr<std::pair<std::string, std::string>> VerilogSimulator::Run(
   return Run(text, file_type, macro_definitions, /*includes=*/{});
 }
 
+absl::StatusOr<std::unique_ptr<VerilogSimulator::CompiledSimulation>>
+VerilogSimulator::Compile(std::string_view text, FileType file_type,
+                          absl::Span<const MacroDefinition> macro_definitions,
+                          absl::Span<const VerilogInclude> includes) const {
+  return absl::UnimplementedError(
+      "Simulator does not support separate compilation");
+}
+
 absl::Status VerilogSimulator::RunSyntaxChecking(std::string_view text,
                                                  FileType file_type) const {
   return RunSyntaxChecking(text, file_type, /*macro_definitions=*/{},
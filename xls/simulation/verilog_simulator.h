@@ -69,6 +69,29 @@ class VerilogSimulator {
       absl::Span<const MacroDefinition> macro_definitions,
       absl::Span<const VerilogInclude> includes) const = 0;
 
+  // A simulation compiled once by Compile() which may be run many times, e.g.,
+  // with different stimulus files.
+  class CompiledSimulation {
+   public:
+    virtual ~CompiledSimulation() = default;
+
+    // Runs the simulation and returns the stdout/stderr as a string pair. Each
+    // element of `plusargs` is passed to the simulation as a plusarg, e.g.,
+    // "count=4" may be read with `$value$plusargs("count=%d", count)`.
+    virtual absl::StatusOr<std::pair<std::string, std::string>> Run(
+        absl::Span<const std::string> plusargs) const = 0;
+  };
+
+  // Compiles the given Verilog text for repeated simulation with
+  // CompiledSimulation::Run(). This avoids recompiling the design when the
+  // same text is simulated repeatedly with stimulus which is read at run
+  // time. Returns an unimplemented error if the simulator does not support
+  // separate compilation.
+  virtual absl::StatusOr<std::unique_ptr<CompiledSimulation>> Compile(
+      std::string_view text, FileType file_type,
+      absl::Span<const MacroDefinition> macro_definitions,
+      absl::Span<const VerilogInclude> includes) const;
+
   // Runs the simulator to check the Verilog syntax. Does not run simulation.
   absl::Status RunSyntaxChecking(std::string_view text,
                                  FileType file_type) const;
@@ -14,12 +14,21 @@
 
 #include "xls/solvers/z3_ir_equivalence.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <functional>
+#include <iterator>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -28,6 +37,7 @@
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
@@ -37,7 +47,9 @@
 #include "xls/ir/package.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/passes/cse_pass.h"
 #include "xls/solvers/z3_ir_translator.h"
 
 namespace xls::solvers::z3 {
@@ -90,10 +102,110 @@ absl::StatusOr<Node*> FlattenToBits(Function* function, Node* original) {
       SourceInfo(), values,
       absl::StrFormat("split_concat_%s", original->GetName()), function));
 }
+
+// A Bits-typed element of the outputs of a miter.
+struct OutputLeaf {
+  std::string element;
+  Node* a;
+  Node* b;
+};
+
+// Appends leaves computing each Bits-typed element of `a` and `b` to `leaves`
+// in the order of the bits of the flattened output. Returns a single leaf for
+// aggregates computed by the same node in both functions and skips elements
+// without bits.
+absl::Status CollectOutputLeaves(Function* function, std::string element,
+                                 Node* a, Node* b,
+                                 std::vector<OutputLeaf>& leaves) {
+  Type* type = a->GetType();
+  if (type->GetFlatBitCount() == 0) {
+    return absl::OkStatus();
+  }
+  if (type->IsBits() || a == b) {
+    leaves.push_back(OutputLeaf{.element = std::move(element), .a = a, .b = b});
+    return absl::OkStatus();
+  }
+  if (type->IsTuple()) {
+    for (int64_t i = 0; i < type->AsTupleOrDie()->size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(Node * a_element,
+                           function->MakeNode<TupleIndex>(SourceInfo(), a, i));
+      XLS_ASSIGN_OR_RETURN(Node * b_element,
+                           function->MakeNode<TupleIndex>(SourceInfo(), b, i));
+      XLS_RETURN_IF_ERROR(CollectOutputLeaves(
+          function, absl::StrFormat("%s.%d", element, i), a_element, b_element,
+          leaves));
+    }
+    return absl::OkStatus();
+  }
+  XLS_RET_CHECK(type->IsArray()) << type;
+  for (int64_t i = 0; i < type->AsArrayOrDie()->size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(
+        Node * index,
+        function->MakeNode<Literal>(SourceInfo(), Value(UBits(i, 64))));
+    XLS_ASSIGN_OR_RETURN(
+        Node * a_element,
+        function->MakeNode<ArrayIndex>(SourceInfo(), a,
+                                       absl::MakeConstSpan({index})));
+    XLS_ASSIGN_OR_RETURN(
+        Node * b_element,
+        function->MakeNode<ArrayIndex>(SourceInfo(), b,
+                                       absl::MakeConstSpan({index})));
+    XLS_RETURN_IF_ERROR(CollectOutputLeaves(
+        function, absl::StrFormat("%s[%d]", element, i), a_element, b_element,
+        leaves));
+  }
+  return absl::OkStatus();
+}
+
+// A function in its own package returning whether one slice of the outputs of
+// a miter is equal.
+struct SubMiter {
+  std::unique_ptr<Package> package;
+  Function* function;
+  int64_t slice_index;
+};
+
+// Returns a function which has the same params as the function of `check` and
+// computes only the nodes `check` depends on.
+absl::StatusOr<SubMiter> ExtractSubMiter(Node* check, std::string_view name) {
+  Function* source = check->function_base()->AsFunctionOrDie();
+  absl::flat_hash_set<Node*> cone;
+  std::vector<Node*> worklist = {check};
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    if (!cone.insert(node).second) {
+      continue;
+    }
+    absl::c_copy(node->operands(), std::back_inserter(worklist));
+  }
+
+  auto package = std::make_unique<Package>(name);
+  Function* function =
+      package->AddFunction(std::make_unique<Function>(name, package.get()));
+  absl::flat_hash_map<Node*, Node*> node_map;
+  for (Param* param : source->params()) {
+    XLS_ASSIGN_OR_RETURN(node_map[param],
+                         param->CloneInNewFunction({}, function));
+  }
+  for (Node* node : TopoSort(source)) {
+    if (node->Is<Param>() || !cone.contains(node)) {
+      continue;
+    }
+    std::vector<Node*> new_ops;
+    new_ops.reserve(node->operand_count());
+    for (Node* op : node->operands()) {
+      new_ops.push_back(node_map.at(op));
+    }
+    XLS_ASSIGN_OR_RETURN(node_map[node],
+                         node->CloneInNewFunction(new_ops, function));
+  }
+  XLS_RETURN_IF_ERROR(function->set_return_value(node_map.at(check)));
+  return SubMiter{.package = std::move(package), .function = function};
+}
 }  // namespace
 
-absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
-                                                 absl::Duration timeout) {
+absl::StatusOr<Miter> BuildMiter(Function* a, Function* b) {
   std::unique_ptr<Package> to_test = std::make_unique<Package>(
       absl::StrFormat("%s_tester", a->package()->name()));
   XLS_ASSIGN_OR_RETURN(
@@ -129,14 +241,25 @@ absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
                          n->CloneInNewFunction(new_ops, to_test_func));
   }
 
+  Node* a_result = to_test_func->return_value();
+  Node* b_result = node_map[b->return_value()];
+  return Miter{.package = std::move(to_test),
+               .function = to_test_func,
+               .a_result = a_result,
+               .b_result = b_result};
+}
+
+absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
+                                                 absl::Duration timeout) {
+  XLS_ASSIGN_OR_RETURN(Miter miter, BuildMiter(a, b));
+  Function* to_test_func = miter.function;
+
   // Add check, coerce any tuples/arays into bit-arrays since z3 ir-translator
   // doesn't support eq of tuples/arrays yet.
-  XLS_ASSIGN_OR_RETURN(
-      Node * original_result,
-      FlattenToBits(to_test_func, to_test_func->return_value()));
-  XLS_ASSIGN_OR_RETURN(
-      Node * transformed_result,
-      FlattenToBits(to_test_func, node_map[b->return_value()]));
+  XLS_ASSIGN_OR_RETURN(Node * original_result,
+                       FlattenToBits(to_test_func, miter.a_result));
+  XLS_ASSIGN_OR_RETURN(Node * transformed_result,
+                       FlattenToBits(to_test_func, miter.b_result));
   Node* new_ret = to_test_func->AddNode(std::make_unique<CompareOp>(
       SourceInfo(), original_result, transformed_result, Op::kEq, "TestCheck",
       to_test_func));
@@ -145,6 +268,119 @@ absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
   return TryProve(to_test_func, new_ret, Predicate::NotEqualToZero(), timeout);
 }
 
+absl::StatusOr<std::vector<OutputSliceResult>> TryProveEquivalenceByOutput(
+    Function* a, Function* b, const OutputPartitionOptions& options) {
+  XLS_RET_CHECK_GE(options.max_slice_bit_count, 0);
+  XLS_RET_CHECK_GE(options.thread_count, 1);
+  XLS_ASSIGN_OR_RETURN(Miter miter, BuildMiter(a, b));
+  Function* to_test_func = miter.function;
+
+  // Merge the logic shared by both functions. The results are held in a tuple
+  // while doing so as CSE may replace either of them.
+  XLS_ASSIGN_OR_RETURN(Node * results,
+                       to_test_func->MakeNode<Tuple>(
+                           SourceInfo(), std::vector<Node*>{miter.a_result,
+                                                            miter.b_result}));
+  XLS_RETURN_IF_ERROR(to_test_func->set_return_value(results));
+  XLS_RETURN_IF_ERROR(RunCse(to_test_func, /*replacements=*/nullptr).status());
+  results = to_test_func->return_value();
+
+  std::vector<OutputLeaf> leaves;
+  XLS_RETURN_IF_ERROR(CollectOutputLeaves(to_test_func, "ret",
+                                          results->operand(0),
+                                          results->operand(1), leaves));
+
+  // Split the leaves into slices and extract the check of each slice which is
+  // not trivially true into its own package so it can be proven on its own.
+  std::vector<OutputSliceResult> slice_results;
+  std::vector<SubMiter> sub_miters;
+  for (const OutputLeaf& leaf : leaves) {
+    int64_t bit_count = leaf.a->GetType()->GetFlatBitCount();
+    if (leaf.a == leaf.b) {
+      slice_results.push_back(OutputSliceResult{.element = leaf.element,
+                                                .bit_offset = 0,
+                                                .bit_count = bit_count,
+                                                .result = ProvenTrue()});
+      continue;
+    }
+    int64_t slice_bit_count = options.max_slice_bit_count == 0
+                                  ? bit_count
+                                  : options.max_slice_bit_count;
+    for (int64_t offset = 0; offset < bit_count; offset += slice_bit_count) {
+      int64_t width = std::min(slice_bit_count, bit_count - offset);
+      Node* a_slice = leaf.a;
+      Node* b_slice = leaf.b;
+      if (width != bit_count) {
+        XLS_ASSIGN_OR_RETURN(a_slice, to_test_func->MakeNode<BitSlice>(
+                                          SourceInfo(), leaf.a, offset, width));
+        XLS_ASSIGN_OR_RETURN(b_slice, to_test_func->MakeNode<BitSlice>(
+                                          SourceInfo(), leaf.b, offset, width));
+      }
+      XLS_ASSIGN_OR_RETURN(Node * check, to_test_func->MakeNode<CompareOp>(
+                                             SourceInfo(), a_slice, b_slice,
+                                             Op::kEq));
+      XLS_ASSIGN_OR_RETURN(
+          SubMiter sub_miter,
+          ExtractSubMiter(check,
+                          absl::StrFormat("%s_slice_%d", to_test_func->name(),
+                                          slice_results.size())));
+      sub_miter.slice_index = slice_results.size();
+      sub_miters.push_back(std::move(sub_miter));
+      slice_results.push_back(OutputSliceResult{.element = leaf.element,
+                                                .bit_offset = offset,
+                                                .bit_count = width,
+                                                .result = ProvenTrue()});
+    }
+  }
+
+  // Each proof creates its own translator and so its own Z3 context which
+  // makes it safe to run them concurrently.
+  std::atomic<int64_t> next_sub_miter = 0;
+  auto prove_sub_miters = [&]() {
+    for (int64_t i = next_sub_miter++; i < sub_miters.size();
+         i = next_sub_miter++) {
+      const SubMiter& sub_miter = sub_miters[i];
+      slice_results[sub_miter.slice_index].result =
+          TryProve(sub_miter.function, sub_miter.function->return_value(),
+                   Predicate::NotEqualToZero(), options.timeout);
+    }
+  };
+  {
+    std::vector<std::unique_ptr<Thread>> threads;
+    int64_t thread_count =
+        std::min<int64_t>(options.thread_count, sub_miters.size());
+    for (int64_t i = 1; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(prove_sub_miters));
+    }
+    prove_sub_miters();
+  }
+
+  for (const SubMiter& sub_miter : sub_miters) {
+    absl::StatusOr<ProverResult>& result =
+        slice_results[sub_miter.slice_index].result;
+    if (!result.ok()) {
+      if (!absl::IsDeadlineExceeded(result.status())) {
+        return result.status();
+      }
+      continue;
+    }
+    // Report counterexamples in terms of the params of `a` as the sub-miter
+    // is about to be destroyed.
+    if (ProvenFalse* proven_false = std::get_if<ProvenFalse>(&*result);
+        proven_false != nullptr && proven_false->counterexample.ok()) {
+      absl::flat_hash_map<const Param*, Value> counterexample;
+      for (const auto& [param, value] : *proven_false->counterexample) {
+        XLS_ASSIGN_OR_RETURN(
+            int64_t index,
+            sub_miter.function->GetParamIndex(const_cast<Param*>(param)));
+        counterexample[a->param(index)] = value;
+      }
+      proven_false->counterexample = std::move(counterexample);
+    }
+  }
+  return slice_results;
+}
+
 absl::StatusOr<ProverResult> TryProveEquivalence(
     Function* original,
     const std::function<absl::Status(Package*, Function*)>& run_pass,
@@ -15,12 +15,17 @@
 #ifndef XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
 #define XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
 
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/time/time.h"
 #include "xls/ir/function.h"
+#include "xls/ir/node.h"
 #include "xls/ir/package.h"
 #include "xls/solvers/z3_ir_translator.h"
 
@@ -50,6 +55,66 @@ absl::StatusOr<ProverResult> TryProveEquivalence(
     Function* a, Function* b,
     absl::Duration timeout = absl::InfiniteDuration());
 
+// A function which computes the results of two functions side by side from the
+// same params.
+struct Miter {
+  std::unique_ptr<Package> package;
+  Function* function;
+  // The results of each function within `function`.
+  Node* a_result;
+  Node* b_result;
+};
+
+// Returns the miter of `a` and `b` in a new package. Both functions must have
+// exactly the same types.
+//
+// This call does not alter either function.
+absl::StatusOr<Miter> BuildMiter(Function* a, Function* b);
+
+// Options for TryProveEquivalenceByOutput.
+struct OutputPartitionOptions {
+  // The timeout for the proof of each slice of the output.
+  absl::Duration timeout = absl::InfiniteDuration();
+  // Bits-typed elements of the output wider than this are split into slices
+  // of at most this many bits. If zero, elements are not split.
+  int64_t max_slice_bit_count = 0;
+  // The number of threads proving slices concurrently.
+  int64_t thread_count = 1;
+};
+
+// The result of proving that one slice of the outputs of two functions is the
+// same.
+struct OutputSliceResult {
+  // The element of the return value, e.g. "ret.1[2]" is element 2 of the
+  // array at index 1 of the returned tuple.
+  std::string element;
+  // The bits of the element covered by the slice.
+  int64_t bit_offset;
+  int64_t bit_count;
+  // ProvenTrue, ProvenFalse with a counterexample over the params of `a`, or
+  // a DeadlineExceeded error if the solver timed out.
+  absl::StatusOr<ProverResult> result;
+};
+
+// Verify that both functions have the same behaviors by proving each slice of
+// their outputs separately. Both functions must have exactly the same types.
+//
+// Common subexpressions of the two functions are merged before the outputs
+// are split so each slice only includes the logic that differs between the
+// functions, and slices which are computed by exactly the same logic are
+// proven without invoking the solver. The remaining slices are proven in
+// their own Z3 context, possibly concurrently, so a slice which times out does
+// not prevent the others from being proven.
+//
+// This call does not alter either function.
+//
+// Returns the result of each slice in the order of the bits of the flattened
+// output. Returns an error if any slice fails for a reason other than a
+// timeout.
+absl::StatusOr<std::vector<OutputSliceResult>> TryProveEquivalenceByOutput(
+    Function* a, Function* b,
+    const OutputPartitionOptions& options = OutputPartitionOptions());
+
 }  // namespace xls::solvers::z3
 
 #endif  // XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
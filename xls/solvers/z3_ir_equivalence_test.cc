@@ -17,6 +17,8 @@
 #include <cstdint>
 #include <memory>
 #include <string_view>
+#include <variant>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest-spi.h"
@@ -351,5 +353,85 @@ TEST_F(EquivalenceTest, MultiFunctionDetectsDifference) {
   EXPECT_THAT(TryProveEquivalence(f1, f2), IsOkAndHolds(IsProvenFalse()));
 }
 
+TEST_F(EquivalenceTest, ByOutputProvesEachElement) {
+  std::unique_ptr<Package> p = CreatePackage();
+  Function* f1;
+  Function* f2;
+  {
+    FunctionBuilder fb(absl::StrCat(TestName(), "1"), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue y = fb.Param("y", p->GetBitsType(32));
+    fb.Tuple({fb.Add(x, y), fb.Array({fb.UMul(x, y), fb.Subtract(x, y)},
+                                     p->GetBitsType(32))});
+    XLS_ASSERT_OK_AND_ASSIGN(f1, fb.Build());
+  }
+  {
+    FunctionBuilder fb(absl::StrCat(TestName(), "2"), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue y = fb.Param("y", p->GetBitsType(32));
+    fb.Tuple({fb.Add(y, x), fb.Array({fb.UMul(x, y), fb.Subtract(x, y)},
+                                     p->GetBitsType(32))});
+    XLS_ASSERT_OK_AND_ASSIGN(f2, fb.Build());
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<OutputSliceResult> results,
+      TryProveEquivalenceByOutput(f1, f2,
+                                  OutputPartitionOptions{.thread_count = 2}));
+  // The array is computed by the same logic in both functions so is proven
+  // as a whole.
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].element, "ret.0");
+  EXPECT_EQ(results[0].bit_count, 32);
+  EXPECT_THAT(results[0].result, IsOkAndHolds(IsProvenTrue()));
+  EXPECT_EQ(results[1].element, "ret.1");
+  EXPECT_EQ(results[1].bit_count, 64);
+  EXPECT_THAT(results[1].result, IsOkAndHolds(IsProvenTrue()));
+}
+
+TEST_F(EquivalenceTest, ByOutputReportsRefutedSlices) {
+  std::unique_ptr<Package> p = CreatePackage();
+  Function* f1;
+  Function* f2;
+  {
+    FunctionBuilder fb(absl::StrCat(TestName(), "1"), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue y = fb.Param("y", p->GetBitsType(32));
+    fb.Tuple({fb.Add(x, y), fb.Concat({fb.Subtract(x, y), fb.And(x, y)})});
+    XLS_ASSERT_OK_AND_ASSIGN(f1, fb.Build());
+  }
+  {
+    FunctionBuilder fb(absl::StrCat(TestName(), "2"), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(32));
+    BValue y = fb.Param("y", p->GetBitsType(32));
+    fb.Tuple({fb.Add(y, x), fb.Concat({fb.Subtract(y, x), fb.And(y, x)})});
+    XLS_ASSERT_OK_AND_ASSIGN(f2, fb.Build());
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<OutputSliceResult> results,
+      TryProveEquivalenceByOutput(
+          f1, f2,
+          OutputPartitionOptions{.max_slice_bit_count = 32,
+                                 .thread_count = 3}));
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_EQ(results[0].element, "ret.0");
+  EXPECT_THAT(results[0].result, IsOkAndHolds(IsProvenTrue()));
+  EXPECT_EQ(results[1].element, "ret.1");
+  EXPECT_EQ(results[1].bit_offset, 0);
+  EXPECT_EQ(results[1].bit_count, 32);
+  EXPECT_THAT(results[1].result, IsOkAndHolds(IsProvenTrue()));
+  EXPECT_EQ(results[2].element, "ret.1");
+  EXPECT_EQ(results[2].bit_offset, 32);
+  EXPECT_EQ(results[2].bit_count, 32);
+  ASSERT_THAT(results[2].result, IsOkAndHolds(IsProvenFalse()));
+
+  // The counterexample is in terms of the params of f1.
+  const ProvenFalse& proven_false = std::get<ProvenFalse>(*results[2].result);
+  XLS_ASSERT_OK(proven_false.counterexample.status());
+  EXPECT_TRUE(proven_false.counterexample->contains(f1->param(0)));
+  EXPECT_TRUE(proven_false.counterexample->contains(f1->param(1)));
+}
+
 }  // namespace
 }  // namespace xls::solvers::z3
@@ -0,0 +1,204 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/solvers/z3_ir_sweeping.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "absl/cleanup/cleanup.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/solvers/z3_ir_equivalence.h"
+#include "xls/solvers/z3_ir_translator.h"
+#include "xls/solvers/z3_utils.h"
+#include "../z3/src/api/z3.h"
+#include "../z3/src/api/z3_api.h"
+
+namespace xls::solvers::z3 {
+namespace {
+
+// The number of random inputs evaluated by each call into the JIT.
+constexpr int64_t kSampleBatchSize = 256;
+
+// Returns a hash of the values of each of `nodes` over random inputs.
+absl::StatusOr<std::vector<uint64_t>> SimulateSignatures(
+    Function* f, absl::Span<Node* const> nodes, const SweepOptions& options) {
+  // Make the function temporarily return the values of all the nodes. The
+  // function is restored before returning so it must only be evaluated within
+  // this scope.
+  Node* return_value = f->return_value();
+  XLS_ASSIGN_OR_RETURN(
+      Node * probe,
+      f->MakeNode<Tuple>(SourceInfo(),
+                         std::vector<Node*>(nodes.begin(), nodes.end())));
+  XLS_RETURN_IF_ERROR(f->set_return_value(probe));
+  std::vector<uint64_t> signatures(nodes.size());
+  absl::Status status = [&]() -> absl::Status {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                         FunctionJit::Create(f));
+    std::mt19937_64 rng(options.seed);
+    std::vector<std::vector<Value>> batch;
+    for (int64_t sample = 0; sample < options.sample_count;
+         sample += kSampleBatchSize) {
+      int64_t batch_size =
+          std::min(kSampleBatchSize, options.sample_count - sample);
+      batch.clear();
+      for (int64_t i = 0; i < batch_size; ++i) {
+        batch.push_back(RandomFunctionArguments(f, rng));
+      }
+      XLS_ASSIGN_OR_RETURN(InterpreterResult<std::vector<Value>> results,
+                           jit->RunBatched(batch));
+      for (const Value& result : results.value) {
+        for (int64_t i = 0; i < nodes.size(); ++i) {
+          signatures[i] =
+              absl::HashOf(signatures[i], result.element(i).bits());
+        }
+      }
+    }
+    return absl::OkStatus();
+  }();
+  XLS_RETURN_IF_ERROR(f->set_return_value(return_value));
+  XLS_RETURN_IF_ERROR(f->RemoveNode(probe));
+  XLS_RETURN_IF_ERROR(status);
+  return signatures;
+}
+
+}  // namespace
+
+absl::StatusOr<SweepStats> SweepEquivalentNodes(Function* f,
+                                                const SweepOptions& options) {
+  XLS_RET_CHECK_GT(options.sample_count, 0);
+  std::vector<Node*> nodes;
+  for (Node* node : TopoSort(f)) {
+    if (node->GetType()->IsBits() && node->BitCountOrDie() > 0 &&
+        !OpIsSideEffecting(node->op())) {
+      nodes.push_back(node);
+    }
+  }
+  SweepStats stats;
+  if (nodes.empty()) {
+    return stats;
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<uint64_t> signatures,
+                       SimulateSignatures(f, nodes, options));
+
+  // Nodes are visited in topological order so each candidate is proven
+  // after the equivalences of its operands have been asserted.
+  std::vector<std::pair<Node*, Node*>> replacements;
+  {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
+                         IrTranslator::CreateAndTranslate(f));
+    translator->SetTimeout(options.candidate_timeout);
+    Z3_context ctx = translator->ctx();
+    Z3_solver solver = CreateSolver(ctx, /*num_threads=*/1);
+    auto cleanup = absl::Cleanup([&] { Z3_solver_dec_ref(ctx, solver); });
+
+    // The nodes of each class of nodes with the same simulated values which
+    // are not known to be equivalent to one another.
+    absl::flat_hash_map<std::pair<int64_t, uint64_t>, std::vector<Node*>>
+        representatives;
+    for (int64_t i = 0; i < nodes.size(); ++i) {
+      Node* node = nodes[i];
+      std::vector<Node*>& class_representatives =
+          representatives[{node->BitCountOrDie(), signatures[i]}];
+      if (!class_representatives.empty() && !node->Is<Param>()) {
+        ++stats.candidate_count;
+      }
+      bool replaced = false;
+      for (Node* representative : class_representatives) {
+        if (node->Is<Param>()) {
+          break;
+        }
+        Z3_ast equal = Z3_mk_eq(ctx, translator->GetTranslation(representative),
+                                translator->GetTranslation(node));
+        Z3_solver_push(ctx, solver);
+        Z3_solver_assert(ctx, solver, Z3_mk_not(ctx, equal));
+        Z3_lbool satisfiable = Z3_solver_check(ctx, solver);
+        Z3_solver_pop(ctx, solver, 1);
+        if (satisfiable == Z3_L_FALSE) {
+          VLOG(2) << "Proved " << node->GetName() << " equivalent to "
+                  << representative->GetName();
+          Z3_solver_assert(ctx, solver, equal);
+          replacements.push_back({node, representative});
+          ++stats.proven_count;
+          replaced = true;
+          break;
+        }
+        if (satisfiable == Z3_L_TRUE) {
+          ++stats.refuted_count;
+        } else {
+          ++stats.timed_out_count;
+        }
+      }
+      if (!replaced) {
+        class_representatives.push_back(node);
+      }
+    }
+  }
+
+  // Representatives are never replaced so each node is replaced directly with
+  // the earliest node it is known to be equivalent to.
+  for (const auto& [node, representative] : replacements) {
+    XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(representative));
+  }
+  for (Node* node : ReverseTopoSort(f)) {
+    if (node->users().empty() && !node->Is<Param>() &&
+        node != f->return_value() && !OpIsSideEffecting(node->op())) {
+      XLS_RETURN_IF_ERROR(f->RemoveNode(node));
+    }
+  }
+  VLOG(1) << "Swept " << f->name() << ": " << stats;
+  return stats;
+}
+
+absl::StatusOr<SweepStats> SweepMiter(Miter& miter,
+                                      const SweepOptions& options) {
+  // Keep both results alive, and up to date, while sweeping by returning them.
+  Function* f = miter.function;
+  XLS_ASSIGN_OR_RETURN(
+      Node * results,
+      f->MakeNode<Tuple>(SourceInfo(),
+                         std::vector<Node*>{miter.a_result, miter.b_result}));
+  XLS_RETURN_IF_ERROR(f->set_return_value(results));
+  XLS_ASSIGN_OR_RETURN(SweepStats stats, SweepEquivalentNodes(f, options));
+  miter.a_result = results->operand(0);
+  miter.b_result = results->operand(1);
+  XLS_RETURN_IF_ERROR(f->set_return_value(miter.a_result));
+  XLS_RETURN_IF_ERROR(f->RemoveNode(results));
+  return stats;
+}
+
+}  // namespace xls::solvers::z3
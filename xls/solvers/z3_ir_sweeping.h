@@ -0,0 +1,81 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_SOLVERS_Z3_IR_SWEEPING_H_
+#define XLS_SOLVERS_Z3_IR_SWEEPING_H_
+
+#include <cstdint>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "xls/ir/function.h"
+#include "xls/solvers/z3_ir_equivalence.h"
+
+namespace xls::solvers::z3 {
+
+struct SweepOptions {
+  // The number of random inputs simulated to find candidate equivalences.
+  int64_t sample_count = 1024;
+  // The seed of the random inputs.
+  int64_t seed = 0;
+  // The timeout for the proof of each candidate equivalence.
+  absl::Duration candidate_timeout = absl::Seconds(1);
+};
+
+struct SweepStats {
+  // The number of nodes which computed the same values as an earlier node over
+  // all the random inputs.
+  int64_t candidate_count = 0;
+  // The number of candidates proven equivalent to an earlier node and
+  // replaced.
+  int64_t proven_count = 0;
+  // The number of proofs of candidate equivalences which found a
+  // counterexample or timed out. A candidate may be compared to several
+  // earlier nodes.
+  int64_t refuted_count = 0;
+  int64_t timed_out_count = 0;
+};
+
+template <typename Sink>
+void AbslStringify(Sink& sink, const SweepStats& stats) {
+  absl::Format(&sink, "%d candidates: %d proven, %d refuted, %d timed out",
+               stats.candidate_count, stats.proven_count, stats.refuted_count,
+               stats.timed_out_count);
+}
+
+// Replaces Bits-typed nodes of `f` which are equivalent to an earlier node of
+// `f` with that node and removes the nodes which become dead (SAT sweeping).
+//
+// Candidate equivalences are found cheaply by evaluating all the nodes of `f`
+// on random inputs with the JIT and grouping nodes which produced the same
+// values. Candidates are then proven in topological order with small Z3
+// queries in a single context, each proven equivalence being asserted so that
+// it simplifies the queries of the nodes which depend on it. Candidates which
+// are refuted or time out are kept.
+//
+// Sweeping the miter of two functions before proving them equivalent merges
+// the logic they share, so the final proof only has to reason about their
+// differences.
+absl::StatusOr<SweepStats> SweepEquivalentNodes(
+    Function* f, const SweepOptions& options = SweepOptions());
+
+// Sweeps the function of `miter`, updating its results.
+absl::StatusOr<SweepStats> SweepMiter(
+    Miter& miter, const SweepOptions& options = SweepOptions());
+
+}  // namespace xls::solvers::z3
+
+#endif  // XLS_SOLVERS_Z3_IR_SWEEPING_H_
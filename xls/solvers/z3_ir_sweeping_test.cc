@@ -0,0 +1,105 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/solvers/z3_ir_sweeping.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/solvers/z3_ir_equivalence.h"
+#include "xls/solvers/z3_ir_translator_matchers.h"
+
+namespace xls::solvers::z3 {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+class SweepTest : public IrTestBase {};
+
+TEST_F(SweepTest, MergesEquivalentNodes) {
+  std::unique_ptr<Package> p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue sum = fb.Add(x, y);
+  BValue other_sum = fb.Subtract(x, fb.Negate(y));
+  fb.Tuple({fb.UMul(sum, x), fb.UMul(other_sum, x)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * original,
+                           f->Clone(absl::StrCat(TestName(), "_original")));
+  int64_t node_count = f->node_count();
+
+  XLS_ASSERT_OK_AND_ASSIGN(SweepStats stats, SweepEquivalentNodes(f));
+  EXPECT_EQ(stats.candidate_count, 2);
+  EXPECT_EQ(stats.proven_count, 2);
+  EXPECT_EQ(f->return_value()->operand(0), f->return_value()->operand(1));
+  EXPECT_LT(f->node_count(), node_count);
+
+  EXPECT_THAT(TryProveEquivalence(original, f), IsOkAndHolds(IsProvenTrue()));
+}
+
+TEST_F(SweepTest, KeepsNodesWhichDifferOnRareInputs) {
+  std::unique_ptr<Package> p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue is_magic = fb.Eq(x, fb.Literal(UBits(0x12345678, 32)));
+  fb.Select(is_magic, fb.Add(x, fb.Literal(UBits(1, 32))), x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  int64_t node_count = f->node_count();
+
+  XLS_ASSERT_OK_AND_ASSIGN(SweepStats stats, SweepEquivalentNodes(f));
+  EXPECT_EQ(stats.candidate_count, 1);
+  EXPECT_EQ(stats.proven_count, 0);
+  EXPECT_EQ(stats.refuted_count, 1);
+  EXPECT_EQ(f->node_count(), node_count);
+}
+
+TEST_F(SweepTest, MergesLogicSharedByMiter) {
+  std::unique_ptr<Package> p = CreatePackage();
+  Function* f1;
+  Function* f2;
+  {
+    FunctionBuilder fb(absl::StrCat(TestName(), "1"), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(16));
+    BValue y = fb.Param("y", p->GetBitsType(16));
+    fb.Add(fb.UMul(x, y), fb.Shll(x, fb.Literal(UBits(1, 16))));
+    XLS_ASSERT_OK_AND_ASSIGN(f1, fb.Build());
+  }
+  {
+    FunctionBuilder fb(absl::StrCat(TestName(), "2"), p.get());
+    BValue x = fb.Param("x", p->GetBitsType(16));
+    BValue y = fb.Param("y", p->GetBitsType(16));
+    fb.Add(fb.UMul(y, x), fb.Add(x, x));
+    XLS_ASSERT_OK_AND_ASSIGN(f2, fb.Build());
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(Miter miter, BuildMiter(f1, f2));
+  XLS_ASSERT_OK_AND_ASSIGN(SweepStats stats, SweepMiter(miter));
+  EXPECT_EQ(stats.proven_count, 3);
+  EXPECT_EQ(miter.a_result, miter.b_result);
+  EXPECT_EQ(miter.function->return_value(), miter.a_result);
+}
+
+}  // namespace
+}  // namespace xls::solvers::z3
@@ -28,6 +28,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -1451,8 +1452,10 @@ namespace {
 
 enum class PredicateCombination : std::uint8_t { kDisjunction, kConjunction };
 
+// Checks the combination of `terms` in a new scope of `solver` which is popped
+// before returning, leaving `solver` as it was.
 absl::StatusOr<ProverResult> TryProveCombination(
-    FunctionBase* f, std::unique_ptr<IrTranslator> translator,
+    FunctionBase* f, IrTranslator* translator, Z3_solver solver,
     absl::Span<const PredicateOfNode> terms,
     PredicateCombination predicate_combination) {
   Z3OpTranslator t(translator->ctx());
@@ -1465,7 +1468,7 @@ absl::StatusOr<ProverResult> TryProveCombination(
     // Translate the predicate to a term we can throw into the conjunction.
     XLS_ASSIGN_OR_RETURN(Z3_ast objective_term,
                          PredicateToNegatedObjective(term.p, term.subject,
-                                                     value, translator.get()));
+                                                     value, translator));
     XLS_RET_CHECK(objective_term != nullptr);
 
     if (objective.has_value()) {
@@ -1489,8 +1492,8 @@ absl::StatusOr<ProverResult> TryProveCombination(
 
   Z3_context ctx = translator->ctx();
   VLOG(1) << "objective:\n" << Z3_ast_to_string(ctx, objective.value());
-  Z3_solver solver = solvers::z3::CreateSolver(ctx, /*num_threads=*/1);
-  auto cleanup = absl::Cleanup([&] { Z3_solver_dec_ref(ctx, solver); });
+  Z3_solver_push(ctx, solver);
+  auto cleanup = absl::Cleanup([&] { Z3_solver_pop(ctx, solver, 1); });
 
   Z3_solver_assert(ctx, solver, objective.value());
   Z3_lbool satisfiable = Z3_solver_check(ctx, solver);
@@ -1538,7 +1541,10 @@ absl::StatusOr<ProverResult> TryProveConjunction(
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
                        IrTranslator::CreateAndTranslate(f, allow_unsupported));
   translator->SetTimeout(timeout);
-  return TryProveCombination(f, std::move(translator), terms,
+  Z3_solver solver = CreateSolver(translator->ctx(), /*num_threads=*/1);
+  auto cleanup =
+      absl::Cleanup([&] { Z3_solver_dec_ref(translator->ctx(), solver); });
+  return TryProveCombination(f, translator.get(), solver, terms,
                              PredicateCombination::kConjunction);
 }
 
@@ -1549,7 +1555,10 @@ absl::StatusOr<ProverResult> TryProveConjunction(
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
                        IrTranslator::CreateAndTranslate(f, allow_unsupported));
   translator->SetRlimit(rlimit);
-  return TryProveCombination(f, std::move(translator), terms,
+  Z3_solver solver = CreateSolver(translator->ctx(), /*num_threads=*/1);
+  auto cleanup =
+      absl::Cleanup([&] { Z3_solver_dec_ref(translator->ctx(), solver); });
+  return TryProveCombination(f, translator.get(), solver, terms,
                              PredicateCombination::kConjunction);
 }
 
@@ -1560,7 +1569,10 @@ absl::StatusOr<ProverResult> TryProveDisjunction(
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
                        IrTranslator::CreateAndTranslate(f, allow_unsupported));
   translator->SetTimeout(timeout);
-  return TryProveCombination(f, std::move(translator), terms,
+  Z3_solver solver = CreateSolver(translator->ctx(), /*num_threads=*/1);
+  auto cleanup =
+      absl::Cleanup([&] { Z3_solver_dec_ref(translator->ctx(), solver); });
+  return TryProveCombination(f, translator.get(), solver, terms,
                              PredicateCombination::kDisjunction);
 }
 
@@ -1571,10 +1583,75 @@ absl::StatusOr<ProverResult> TryProveDisjunction(
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
                        IrTranslator::CreateAndTranslate(f, allow_unsupported));
   translator->SetRlimit(rlimit);
-  return TryProveCombination(f, std::move(translator), terms,
+  Z3_solver solver = CreateSolver(translator->ctx(), /*num_threads=*/1);
+  auto cleanup =
+      absl::Cleanup([&] { Z3_solver_dec_ref(translator->ctx(), solver); });
+  return TryProveCombination(f, translator.get(), solver, terms,
                              PredicateCombination::kDisjunction);
 }
 
+absl::StatusOr<std::unique_ptr<ProverSession>> ProverSession::Create(
+    FunctionBase* f, absl::Duration timeout, bool allow_unsupported) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
+                       IrTranslator::CreateAndTranslate(f, allow_unsupported));
+  translator->SetTimeout(timeout);
+  return absl::WrapUnique(new ProverSession(f, std::move(translator)));
+}
+
+absl::StatusOr<std::unique_ptr<ProverSession>> ProverSession::Create(
+    FunctionBase* f, int64_t rlimit, bool allow_unsupported) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
+                       IrTranslator::CreateAndTranslate(f, allow_unsupported));
+  translator->SetRlimit(rlimit);
+  return absl::WrapUnique(new ProverSession(f, std::move(translator)));
+}
+
+ProverSession::ProverSession(FunctionBase* f,
+                             std::unique_ptr<IrTranslator> translator)
+    : f_(f),
+      translator_(std::move(translator)),
+      solver_(CreateSolver(translator_->ctx(), /*num_threads=*/1)) {}
+
+ProverSession::~ProverSession() {
+  Z3_solver_dec_ref(translator_->ctx(), solver_);
+}
+
+absl::Status ProverSession::TranslateNewNodes(
+    absl::Span<const PredicateOfNode> terms) {
+  for (const PredicateOfNode& term : terms) {
+    if (!translator_->IsVisited(term.subject)) {
+      XLS_RETURN_IF_ERROR(term.subject->Accept(translator_.get()));
+    }
+    if (term.p.kind() == PredicateKind::kEqualToNode &&
+        !translator_->IsVisited(term.p.node())) {
+      XLS_RETURN_IF_ERROR(term.p.node()->Accept(translator_.get()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<ProverResult> ProverSession::TryProveConjunction(
+    absl::Span<const PredicateOfNode> terms) {
+  XLS_RET_CHECK(!terms.empty());
+  XLS_RETURN_IF_ERROR(TranslateNewNodes(terms));
+  return TryProveCombination(f_, translator_.get(), solver_, terms,
+                             PredicateCombination::kConjunction);
+}
+
+absl::StatusOr<ProverResult> ProverSession::TryProveDisjunction(
+    absl::Span<const PredicateOfNode> terms) {
+  XLS_RET_CHECK(!terms.empty());
+  XLS_RETURN_IF_ERROR(TranslateNewNodes(terms));
+  return TryProveCombination(f_, translator_.get(), solver_, terms,
+                             PredicateCombination::kDisjunction);
+}
+
+absl::StatusOr<ProverResult> ProverSession::TryProve(Node* subject,
+                                                     Predicate p) {
+  PredicateOfNode term = {.subject = subject, .p = std::move(p)};
+  return TryProveConjunction(absl::MakeConstSpan(&term, 1));
+}
+
 absl::StatusOr<ProverResult> TryProve(FunctionBase* f, Node* subject,
                                       Predicate p, absl::Duration timeout,
                                       bool allow_unsupported) {
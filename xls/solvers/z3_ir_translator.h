@@ -429,6 +429,46 @@ absl::StatusOr<ProverResult> TryProve(FunctionBase* f, Node* subject,
                                       Predicate p, int64_t rlimit,
                                       bool allow_unsupported = false);
 
+// Answers many queries about the nodes of a function while translating it only
+// once, unlike the functions above which translate the whole function for each
+// query. Each query is checked in its own scope of a single solver so queries
+// do not affect one another.
+//
+// Nodes may be added to the function during the session and are translated
+// when first queried, but nodes must not be removed or modified.
+class ProverSession {
+ public:
+  // Creates a session in which each query is limited to the duration
+  // "timeout" or the "rlimit".
+  static absl::StatusOr<std::unique_ptr<ProverSession>> Create(
+      FunctionBase* f, absl::Duration timeout, bool allow_unsupported = false);
+  static absl::StatusOr<std::unique_ptr<ProverSession>> Create(
+      FunctionBase* f, int64_t rlimit, bool allow_unsupported = false);
+
+  ~ProverSession();
+
+  ProverSession(const ProverSession&) = delete;
+  ProverSession& operator=(const ProverSession&) = delete;
+
+  // As the functions of the same name above, within this session.
+  absl::StatusOr<ProverResult> TryProveConjunction(
+      absl::Span<const PredicateOfNode> terms);
+  absl::StatusOr<ProverResult> TryProveDisjunction(
+      absl::Span<const PredicateOfNode> terms);
+  absl::StatusOr<ProverResult> TryProve(Node* subject, Predicate p);
+
+ private:
+  ProverSession(FunctionBase* f, std::unique_ptr<IrTranslator> translator);
+
+  // Translates the nodes referred to by `terms` which were added to the
+  // function after the session was created.
+  absl::Status TranslateNewNodes(absl::Span<const PredicateOfNode> terms);
+
+  FunctionBase* f_;
+  std::unique_ptr<IrTranslator> translator_;
+  Z3_solver solver_;
+};
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
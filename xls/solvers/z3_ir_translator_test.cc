@@ -49,6 +49,7 @@ using solvers::z3::IrTranslator;
 using solvers::z3::Predicate;
 using solvers::z3::PredicateOfNode;
 using solvers::z3::ProverResult;
+using solvers::z3::ProverSession;
 using solvers::z3::TryProve;
 using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
@@ -142,6 +143,46 @@ TEST_F(Z3IrTranslatorTest, ParamAddOneIsGeParam) {
   EXPECT_THAT(proven, IsProvenFalse());
 }
 
+TEST_F(Z3IrTranslatorTest, SessionAnswersIndependentQueries) {
+  auto p = CreatePackage();
+  Type* u32 = p->GetBitsType(32);
+  FunctionBuilder b("f", p.get());
+  auto x = b.Param("x", u32);
+  auto one = b.Literal(UBits(1, /*bit_count=*/32));
+  auto xp1 = b.Add(x, one);
+  auto is_zero = b.Eq(x, b.Literal(UBits(0, /*bit_count=*/32)));
+  auto is_nonzero = b.Ne(x, b.Literal(UBits(0, /*bit_count=*/32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, b.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProverSession> session,
+      ProverSession::Create(f, absl::InfiniteDuration()));
+
+  // A refuted query leaves nothing behind which would affect later queries.
+  EXPECT_THAT(session->TryProve(xp1.node(), Predicate::UnsignedGreaterOrEqual(
+                                                UBits(1, /*bit_count=*/32))),
+              IsOkAndHolds(IsProvenFalse()));
+  EXPECT_THAT(session->TryProve(x.node(), Predicate::EqualToZero()),
+              IsOkAndHolds(IsProvenFalse()));
+  EXPECT_THAT(session->TryProve(x.node(), Predicate::NotEqualToZero()),
+              IsOkAndHolds(IsProvenFalse()));
+  std::vector<PredicateOfNode> terms = {
+      PredicateOfNode{is_zero.node(), Predicate::NotEqualToZero()},
+      PredicateOfNode{is_nonzero.node(), Predicate::NotEqualToZero()},
+  };
+  EXPECT_THAT(session->TryProveDisjunction(terms),
+              IsOkAndHolds(IsProvenTrue()));
+  EXPECT_THAT(session->TryProveConjunction(terms),
+              IsOkAndHolds(IsProvenFalse()));
+
+  // Nodes added after the session was created are translated on demand.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * x_or_one,
+      f->MakeNode<NaryOp>(SourceInfo(),
+                          std::vector<Node*>{x.node(), one.node()}, Op::kOr));
+  EXPECT_THAT(session->TryProve(x_or_one, Predicate::NotEqualToZero()),
+              IsOkAndHolds(IsProvenTrue()));
+}
+
 TEST_F(Z3IrTranslatorTest, ZeroTwoBitsIsZero) {
   auto p = CreatePackage();
   FunctionBuilder b("f", p.get());
@@ -20,6 +20,7 @@
 #include <iostream>
 #include <memory>
 #include <optional>
+#include <random>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
 #include <utility>
@@ -33,16 +34,22 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/codegen/vast.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/interpreter/random_value.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
+#include "xls/ir/events.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/function.h"
 #include "xls/ir/node.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/netlist/compiled_interpreter.h"
 #include "xls/netlist/netlist.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/solvers/z3_ir_translator.h"
@@ -66,6 +73,21 @@ bool CheckingSingleStage(std::optional<PipelineSchedule> schedule,
   return schedule && stage != -1;
 }
 
+// Appends the bits of `value` to `bits` in the order of
+// IrTranslator::FlattenValue() with `little_endian` set, i.e., each leaf from
+// its most significant bit down with leaves in element order.
+void FlattenValueMsbFirst(const Value& value, std::vector<bool>& bits) {
+  if (value.IsBits()) {
+    for (int64_t i = value.bits().bit_count() - 1; i >= 0; --i) {
+      bits.push_back(value.bits().Get(i));
+    }
+    return;
+  }
+  for (const Value& element : value.elements()) {
+    FlattenValueMsbFirst(element, bits);
+  }
+}
+
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<Lec>> Lec::Create(const LecParams& params) {
@@ -274,6 +296,156 @@ absl::Status Lec::AddConstraints(Function* constraints) {
   Z3_ast eq_node = Z3_mk_eq(ctx(), constraint_translator->GetReturnNode(),
                             Z3_mk_int(ctx(), 1, Z3_mk_bv_sort(ctx(), 1)));
   Z3_solver_assert(ctx(), solver_.value(), eq_node);
+  constraints_ = constraints;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<bool> Lec::FindCounterexampleBySimulation(int64_t sample_count,
+                                                         int64_t seed) {
+  if (CheckingSingleStage(schedule_, stage_)) {
+    return absl::UnimplementedError(
+        "Simulation is only supported for whole-function LEC.");
+  }
+  constexpr int64_t kLaneCount = netlist::CompiledInterpreter::kLaneCount;
+
+  // The netlist is cut at the same nets as are bound to the IR inputs in
+  // FlattenNetlistInputs(). Each cut net is identified with a parameter and a
+  // bit index counting from the LSB of the flattened parameter.
+  std::vector<NetRef> cut_nets;
+  std::vector<std::pair<int64_t, int64_t>> cut_bits;
+  for (int64_t p = 0; p < ir_function_->params().size(); ++p) {
+    Param* param = ir_function_->param(p);
+    int64_t bit_count = param->GetType()->GetFlatBitCount();
+    for (int64_t i = 0; i < bit_count; ++i) {
+      std::optional<int> bit_index;
+      if (bit_count > 1) {
+        bit_index = i;
+      }
+      auto status_or_cell =
+          module_->ResolveCell(NodeToNetlistName(param, bit_index));
+      if (!status_or_cell.ok()) {
+        continue;
+      }
+      for (const auto& output : status_or_cell.value()->outputs()) {
+        cut_nets.push_back(output.netref);
+        cut_bits.push_back({p, i});
+      }
+    }
+  }
+
+  // GetIrNetrefs() lists the netlist outputs from the MSB down.
+  Node* return_value = ir_function_->return_value();
+  int64_t return_bit_count = return_value->GetType()->GetFlatBitCount();
+  XLS_ASSIGN_OR_RETURN(std::vector<NetRef> output_refs,
+                       GetIrNetrefs(return_value));
+  XLS_RET_CHECK_EQ(output_refs.size(), return_bit_count);
+  std::vector<NetRef> probe_nets;
+  std::vector<int64_t> probe_bits;
+  for (int64_t i = 0; i < output_refs.size(); ++i) {
+    if (output_refs[i] != nullptr) {
+      probe_nets.push_back(output_refs[i]);
+      probe_bits.push_back(return_bit_count - 1 - i);
+    }
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<netlist::CompiledInterpreter> netlist,
+                       netlist::CompiledInterpreter::Create(
+                           netlist_, module_, cut_nets, probe_nets));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                       FunctionJit::Create(ir_function_));
+  std::unique_ptr<FunctionJit> constraints_jit;
+  if (constraints_ != nullptr) {
+    XLS_ASSIGN_OR_RETURN(constraints_jit, FunctionJit::Create(constraints_));
+  }
+
+  std::mt19937_64 rng(seed);
+  int64_t module_input_count = module_->inputs().size();
+  int64_t module_output_count = module_->outputs().size();
+  for (int64_t begin = 0; begin < sample_count; begin += kLaneCount) {
+    std::vector<std::vector<Value>> args(kLaneCount);
+    for (std::vector<Value>& lane_args : args) {
+      lane_args = RandomFunctionArguments(ir_function_, rng);
+    }
+    XLS_ASSIGN_OR_RETURN(InterpreterResult<std::vector<Value>> ir_results,
+                         jit->RunBatched(args));
+    std::vector<Value> satisfied;
+    if (constraints_jit != nullptr) {
+      XLS_ASSIGN_OR_RETURN(InterpreterResult<std::vector<Value>> results,
+                           constraints_jit->RunBatched(args));
+      satisfied = std::move(results.value);
+    }
+
+    // Netlist inputs which are not bound to IR inputs are unconstrained in the
+    // solver, so they are given random values as well.
+    std::vector<uint64_t> input_words(module_input_count + cut_nets.size(), 0);
+    for (int64_t i = 0; i < module_input_count; ++i) {
+      input_words[i] = rng();
+    }
+    for (int64_t lane = 0; lane < kLaneCount; ++lane) {
+      std::vector<std::vector<bool>> param_bits(args[lane].size());
+      for (int64_t p = 0; p < args[lane].size(); ++p) {
+        FlattenValueMsbFirst(args[lane][p], param_bits[p]);
+      }
+      for (int64_t c = 0; c < cut_nets.size(); ++c) {
+        const std::vector<bool>& bits = param_bits[cut_bits[c].first];
+        if (bits[bits.size() - 1 - cut_bits[c].second]) {
+          input_words[module_input_count + c] |= uint64_t{1} << lane;
+        }
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(std::vector<uint64_t> output_words,
+                         netlist->Run(input_words));
+
+    for (int64_t lane = 0; lane < kLaneCount; ++lane) {
+      if (constraints_jit != nullptr && !satisfied[lane].bits().IsOne()) {
+        continue;
+      }
+      std::vector<bool> result_bits;
+      FlattenValueMsbFirst(ir_results.value[lane], result_bits);
+      std::vector<int64_t> mismatched_bits;
+      for (int64_t j = 0; j < probe_nets.size(); ++j) {
+        bool netlist_bit =
+            ((output_words[module_output_count + j] >> lane) & 1) != 0;
+        if (netlist_bit != result_bits[return_bit_count - 1 - probe_bits[j]]) {
+          mismatched_bits.push_back(probe_bits[j]);
+        }
+      }
+      if (!mismatched_bits.empty()) {
+        LOG(INFO) << "Simulation found a mismatch in output bits "
+                  << absl::StrJoin(mismatched_bits, ", ") << " after "
+                  << begin + lane + 1 << " samples";
+        XLS_RETURN_IF_ERROR(AssertInputs(args[lane]));
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+absl::Status Lec::AssertInputs(absl::Span<const Value> args) {
+  XLS_RET_CHECK_EQ(args.size(), ir_function_->params().size());
+  Z3_sort bit_sort = Z3_mk_bv_sort(ctx(), 1);
+  Z3_solver_push(ctx(), solver_.value());
+  for (int64_t p = 0; p < args.size(); ++p) {
+    Param* param = ir_function_->param(p);
+    std::vector<Z3_ast> z3_bits = ir_translator_->FlattenValue(
+        param->GetType(), input_mapping_.at(param), /*little_endian=*/true);
+    std::vector<bool> bits;
+    FlattenValueMsbFirst(args[p], bits);
+    XLS_RET_CHECK_EQ(z3_bits.size(), bits.size());
+    for (int64_t i = 0; i < bits.size(); ++i) {
+      Z3_solver_assert(
+          ctx(), solver_.value(),
+          Z3_mk_eq(ctx(), z3_bits[i], Z3_mk_int(ctx(), bits[i], bit_sort)));
+    }
+  }
+  // With all inputs fixed this check is trivial, and it guards against
+  // reporting a mismatch which the solver does not agree with.
+  if (Z3_solver_check(ctx(), solver_.value()) != Z3_L_TRUE) {
+    Z3_solver_pop(ctx(), solver_.value(), 1);
+    return absl::InternalError(
+        "Mismatch found by simulation is not confirmed by the solver.");
+  }
   return absl::OkStatus();
 }
 
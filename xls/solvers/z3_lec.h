@@ -15,6 +15,7 @@
 #ifndef XLS_SOLVERS_Z3_LEC_H_
 #define XLS_SOLVERS_Z3_LEC_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -23,7 +24,9 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/package.h"
+#include "xls/ir/value.h"
 #include "xls/netlist/netlist.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/solvers/z3_ir_translator.h"
@@ -75,6 +78,18 @@ class Lec {
   // Constraints can not be currently specified with per-stage evaluation.
   absl::Status AddConstraints(Function* constraints);
 
+  // Evaluates the IR function with the JIT and the netlist with the compiled,
+  // bit-parallel netlist interpreter on `sample_count` random inputs (rounded
+  // up to a multiple of 64), skipping inputs rejected by the constraints. This
+  // is far cheaper than Run() and finds most mismatches between non-equivalent
+  // designs. Returns true if a mismatch was found, in which case its inputs
+  // are asserted in the solver so that Run() returns false without a search
+  // and ResultToString() describes the mismatch. A false result proves
+  // nothing; Run() must still be called. Only whole-function checks are
+  // supported.
+  absl::StatusOr<bool> FindCounterexampleBySimulation(int64_t sample_count,
+                                                      int64_t seed = 0);
+
   // Returns true of the netlist and IR are proved to be equivalent.
   bool Run();
 
@@ -103,6 +118,10 @@ class Lec {
   // whole-function or last-stage checks, or stage outputs for all others.
   void CollectIrOutputNodes();
 
+  // Asserts that the IR params have the given values and checks that the
+  // solver still finds a mismatch.
+  absl::Status AssertInputs(absl::Span<const Value> args);
+
   // Connects IR Params to netlist inputs.
   absl::Status BindNetlistInputs();
 
@@ -141,6 +160,8 @@ class Lec {
 
   Function* ir_function_;
   std::unique_ptr<IrTranslator> ir_translator_;
+  // The function given to AddConstraints(), if any.
+  Function* constraints_ = nullptr;
 
   netlist::rtl::Netlist* netlist_;
   std::string netlist_module_name_;
@@ -19,6 +19,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/log/log.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/ir_parser.h"
@@ -174,6 +175,113 @@ endmodule
   ASSERT_FALSE(match);
 }
 
+struct SimulationResult {
+  // Whether FindCounterexampleBySimulation() found a mismatch.
+  bool found_counterexample;
+  // The result of Lec::Run() afterwards.
+  bool match;
+};
+
+// Parses the IR and netlist, looks for a counterexample by simulation and then
+// runs the LEC.
+absl::StatusOr<SimulationResult> SimulateAndMatch(
+    const std::string& ir_text, const std::string& netlist_text) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text));
+  XLS_ASSIGN_OR_RETURN(Function * entry_function, package->GetTopAsFunction());
+
+  XLS_ASSIGN_OR_RETURN(netlist::CellLibrary cell_library,
+                       netlist::MakeFakeCellLibrary());
+  netlist::rtl::Scanner scanner(netlist_text);
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Netlist> netlist,
+      netlist::rtl::Parser::ParseNetlist(&cell_library, &scanner));
+
+  LecParams params;
+  params.ir_package = package.get();
+  params.ir_function = entry_function;
+  params.netlist = netlist.get();
+  params.netlist_module_name = "main";
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Lec> lec, Lec::Create(params));
+  XLS_ASSIGN_OR_RETURN(
+      bool found, lec->FindCounterexampleBySimulation(/*sample_count=*/256));
+  bool match = lec->Run();
+  if (!match) {
+    LOG(INFO) << lec->ResultToString();
+  }
+  return SimulationResult{.found_counterexample = found, .match = match};
+}
+
+TEST(Z3LecTest, SimulationFindsCounterexample) {
+  // The netlist computes a + a instead of a + b.
+  std::string ir_text = R"(
+package p
+
+top fn main(a: bits[2], b: bits[2]) -> bits[2] {
+  ret add.3: bits[2] = add(a, b)
+}
+)";
+
+  std::string netlist_text = R"(
+module main(clk, a_1_, a_0_, b_1_, b_0_, out_1_, out_0_);
+  input clk, a_1_, a_0_, b_1_, b_0_;
+  output out_1_, out_0_;
+  wire p0_a_1_, p0_a_0_, p0_b_1_, p0_b_0_, p0_add_3_comb_0_, p0_add_3_comb_1_;
+
+  DFF p0_a_reg_1_ ( .D(a_1_), .CLK(clk), .Q(p0_a_1_) );
+  DFF p0_a_reg_0_ ( .D(a_0_), .CLK(clk), .Q(p0_a_0_) );
+  DFF p0_b_reg_1_ ( .D(b_1_), .CLK(clk), .Q(p0_b_1_) );
+  DFF p0_b_reg_0_ ( .D(b_0_), .CLK(clk), .Q(p0_b_0_) );
+
+  XOR out_0_cell ( .A(p0_a_0_), .B(p0_a_0_), .Z(p0_add_3_comb_0_) );
+  XOR out_1_cell ( .A(p0_a_1_), .B(p0_b_1_), .Z(p0_add_3_comb_1_) );
+
+  DFF p0_add_3_reg_1_ ( .D(p0_add_3_comb_1_), .CLK(clk), .Q(out_1_) );
+  DFF p0_add_3_reg_0_ ( .D(p0_add_3_comb_0_), .CLK(clk), .Q(out_0_) );
+endmodule
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(SimulationResult result,
+                           SimulateAndMatch(ir_text, netlist_text));
+  EXPECT_TRUE(result.found_counterexample);
+  EXPECT_FALSE(result.match);
+}
+
+TEST(Z3LecTest, SimulationPassesEquivalentNetlist) {
+  std::string ir_text = R"(
+package p
+
+top fn main(a: bits[2], b: bits[2]) -> bits[2] {
+  ret and.3: bits[2] = and(a, b)
+}
+)";
+
+  std::string netlist_text = R"(
+module main(clk, a_1_, a_0_, b_1_, b_0_, out_1_, out_0_);
+  input clk, a_1_, a_0_, b_1_, b_0_;
+  output out_1_, out_0_;
+  wire p0_a_1_, p0_a_0_, p0_b_1_, p0_b_0_, p0_and_3_comb_0_, p0_and_3_comb_1_;
+
+  DFF p0_a_reg_1_ ( .D(a_1_), .CLK(clk), .Q(p0_a_1_) );
+  DFF p0_a_reg_0_ ( .D(a_0_), .CLK(clk), .Q(p0_a_0_) );
+  DFF p0_b_reg_1_ ( .D(b_1_), .CLK(clk), .Q(p0_b_1_) );
+  DFF p0_b_reg_0_ ( .D(b_0_), .CLK(clk), .Q(p0_b_0_) );
+
+  AND out_0_cell ( .A(p0_a_0_), .B(p0_b_0_), .Z(p0_and_3_comb_0_) );
+  AND out_1_cell ( .A(p0_a_1_), .B(p0_b_1_), .Z(p0_and_3_comb_1_) );
+
+  DFF p0_and_3_reg_1_ ( .D(p0_and_3_comb_1_), .CLK(clk), .Q(out_1_) );
+  DFF p0_and_3_reg_0_ ( .D(p0_and_3_comb_0_), .CLK(clk), .Q(out_0_) );
+endmodule
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(SimulationResult result,
+                           SimulateAndMatch(ir_text, netlist_text));
+  EXPECT_FALSE(result.found_counterexample);
+  EXPECT_TRUE(result.match);
+}
+
 // This test verifies that we can do a simple multi-stage LEC.
 // There are three defined stages:
 // [inputs] -> p0_AND -> p1_OR -> p2 NOT -> [outputs]
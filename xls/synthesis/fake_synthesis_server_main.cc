@@ -82,6 +82,19 @@ class FakeSynthesisServiceImpl : public SynthesisService::Service {
     return ::grpc::Status::OK;
   }
 
+  ::grpc::Status CompileBatch(::grpc::ServerContext* server_context,
+                              const CompileBatchRequest* request,
+                              CompileBatchResponse* result) override {
+    for (const CompileRequest& compile_request : request->requests()) {
+      CompileBatchResponse::Result* batch_result = result->add_results();
+      ::grpc::Status status = Compile(server_context, &compile_request,
+                                      batch_result->mutable_response());
+      batch_result->set_status_code(static_cast<int32_t>(status.error_code()));
+      batch_result->set_error_message(status.error_message());
+    }
+    return ::grpc::Status::OK;
+  }
+
  private:
   int64_t max_frequency_hz_;
   bool serve_errors_;
@@ -14,17 +14,27 @@
 
 #include "xls/synthesis/synthesis_client.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
 #include "grpcpp/support/status.h"
 #include "grpcpp/channel.h"
 #include "grpcpp/client_context.h"
 #include "grpcpp/create_channel.h"
 #include "grpcpp/security/credentials.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/synthesis/credentials.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/synthesis_service.grpc.pb.h"
@@ -62,5 +72,76 @@ absl::StatusOr<CompileResponse> SynthesizeViaClient(
   return response;
 }
 
+std::vector<absl::StatusOr<CompileResponse>> SynthesizeAllViaClient(
+    const std::string& server, absl::Span<const CompileRequest> requests,
+    int64_t max_in_flight) {
+  // Map each request to the first identical request. The deterministic
+  // serialization of a request is used as its key so only exact duplicates are
+  // merged.
+  std::vector<int64_t> unique_requests;
+  std::vector<int64_t> request_to_unique(requests.size());
+  absl::flat_hash_map<std::string, int64_t> key_to_unique;
+  for (int64_t i = 0; i < requests.size(); ++i) {
+    std::string key;
+    {
+      google::protobuf::io::StringOutputStream stream(&key);
+      google::protobuf::io::CodedOutputStream coded_stream(&stream);
+      coded_stream.SetSerializationDeterministic(true);
+      requests[i].SerializeToCodedStream(&coded_stream);
+    }
+    auto [it, inserted] =
+        key_to_unique.try_emplace(std::move(key), unique_requests.size());
+    if (inserted) {
+      unique_requests.push_back(i);
+    }
+    request_to_unique[i] = it->second;
+  }
+
+  std::shared_ptr<grpc::ChannelCredentials> creds = GetChannelCredentials();
+  std::shared_ptr<grpc::Channel> channel = grpc::CreateChannel(server, creds);
+  // Stubs are thread-safe so the workers share one.
+  std::unique_ptr<SynthesisService::Stub> stub(
+      SynthesisService::NewStub(channel));
+
+  // Each worker issues blocking RPCs one after another so there are at most
+  // `max_in_flight` outstanding. Requests are handed out one at a time as
+  // synthesis runtimes vary widely between modules.
+  std::vector<absl::StatusOr<CompileResponse>> unique_responses(
+      unique_requests.size(), absl::UnknownError("Not synthesized"));
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index++; i < unique_requests.size();
+         i = next_index++) {
+      grpc::ClientContext context;
+      CompileResponse response;
+      absl::Status status = GrpcToAbslStatus(
+          stub->Compile(&context, requests[unique_requests[i]], &response));
+      if (status.ok()) {
+        unique_responses[i] = std::move(response);
+      } else {
+        unique_responses[i] = status;
+      }
+    }
+  };
+  int64_t worker_count =
+      std::min(std::max(max_in_flight, int64_t{1}),
+               static_cast<int64_t>(unique_requests.size()));
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(worker_count);
+  for (int64_t i = 0; i < worker_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  std::vector<absl::StatusOr<CompileResponse>> responses;
+  responses.reserve(requests.size());
+  for (int64_t i = 0; i < requests.size(); ++i) {
+    responses.push_back(unique_responses[request_to_unique[i]]);
+  }
+  return responses;
+}
+
 }  // namespace synthesis
 }  // namespace xls
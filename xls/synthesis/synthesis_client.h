@@ -15,9 +15,12 @@
 #ifndef XLS_SYNTHESIS_SYNTHESIS_CLIENT_H_
 #define XLS_SYNTHESIS_SYNTHESIS_CLIENT_H_
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/synthesis/synthesis.pb.h"
 
 namespace xls {
@@ -28,6 +31,15 @@ absl::StatusOr<CompileResponse> SynthesizeViaClient(
     const std::string& server,
     const CompileRequest& request);
 
+// Synthesizes each of `requests` over a single channel, keeping up to
+// `max_in_flight` Compile RPCs outstanding at once. Identical requests (the
+// same module text, signature, top and target frequency) are sent to the
+// server only once. Returns one result per request, in the order of
+// `requests`.
+std::vector<absl::StatusOr<CompileResponse>> SynthesizeAllViaClient(
+    const std::string& server, absl::Span<const CompileRequest> requests,
+    int64_t max_in_flight);
+
 }  // namespace synthesis
 }  // namespace xls
 
@@ -19,7 +19,9 @@
 #include <vector>
 
 #include "absl/flags/flag.h"
+#include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "google/protobuf/text_format.h"
@@ -33,6 +35,9 @@ ABSL_FLAG(std::string, server, "localhost", "Server to connect to");
 ABSL_FLAG(int, port, 10000, "Server port to connect to");
 ABSL_FLAG(double, ghz, 1.0, "The target frequency for synthesis (GHz)");
 ABSL_FLAG(std::string, top, "main", "Name of the top module to synthesize");
+ABSL_FLAG(int64_t, max_in_flight, 1,
+          "Maximum number of requests outstanding at once when synthesizing "
+          "several Verilog files.");
 
 static constexpr char kUsage[] = R"(
 A test client in C++ for using the synthesis server.
@@ -43,7 +48,11 @@ The default port matches that used by the Yosys synth server.
        [--port=10000] \
        [--server=localhost] \
        [--top="main"] \
-       <path_to_verilog>
+       [--max_in_flight=1] \
+       <path_to_verilog> [<path_to_verilog> ...]
+
+When several Verilog files are given each is synthesized separately and the
+responses are printed in order, each preceded by the path of its file.
 )";
 
 int main(int argc, char** argv) {
@@ -53,32 +62,54 @@ int main(int argc, char** argv) {
   const std::string server =
       absl::StrCat(absl::GetFlag(FLAGS_server), ":", absl::GetFlag(FLAGS_port));
 
-  // Data we are sending to the server.
-  xls::synthesis::CompileRequest request;
-  request.set_top_module_name(absl::GetFlag(FLAGS_top));
-  request.set_target_frequency_hz(
-      static_cast<int64_t>(absl::GetFlag(FLAGS_ghz) * 1e9));
-
-  // Check that input Verilog is provided, and get it
-  if (positional_arguments.size() != 1) {
+  // Check that input Verilog is provided.
+  if (positional_arguments.empty()) {
     LOG(QFATAL) << absl::StrCat("Expected invocation: ", argv[0],
-                                " [flags] VERILOG_FILE\n");
+                                " [flags] VERILOG_FILE...\n");
+  }
+
+  // Data we are sending to the server, one request per Verilog file.
+  std::vector<xls::synthesis::CompileRequest> requests;
+  for (std::string_view vpath : positional_arguments) {
+    xls::synthesis::CompileRequest& request = requests.emplace_back();
+    request.set_top_module_name(absl::GetFlag(FLAGS_top));
+    request.set_target_frequency_hz(
+        static_cast<int64_t>(absl::GetFlag(FLAGS_ghz) * 1e9));
+    absl::StatusOr<std::string> verilog_contents = xls::GetFileContents(vpath);
+    QCHECK_OK(verilog_contents.status());
+    request.set_module_text(verilog_contents.value());
   }
-  std::string_view vpath = positional_arguments[0];
-  absl::StatusOr<std::string> verilog_contents = xls::GetFileContents(vpath);
-  QCHECK_OK(verilog_contents.status());
-  request.set_module_text(verilog_contents.value());
 
-  // Use the client to perform the RPC
-  absl::StatusOr<xls::synthesis::CompileResponse> compile_response_status =
-      xls::synthesis::SynthesizeViaClient(server, request);
+  if (requests.size() == 1) {
+    // Use the client to perform the RPC
+    absl::StatusOr<xls::synthesis::CompileResponse> compile_response_status =
+        xls::synthesis::SynthesizeViaClient(server, requests.front());
+
+    // Examine the response
+    if (compile_response_status.ok()) {
+      std::string compile_response_text;
+      google::protobuf::TextFormat::PrintToString(
+          compile_response_status.value(), &compile_response_text);
+      std::cout << compile_response_text << '\n';
+    }
+    return xls::ExitStatus(compile_response_status.status());
+  }
 
-  // Examine the response
-  if (compile_response_status.ok()) {
+  std::vector<absl::StatusOr<xls::synthesis::CompileResponse>> responses =
+      xls::synthesis::SynthesizeAllViaClient(
+          server, requests, absl::GetFlag(FLAGS_max_in_flight));
+  absl::Status status;
+  for (int64_t i = 0; i < responses.size(); ++i) {
+    std::cout << "# " << positional_arguments[i] << '\n';
+    if (!responses[i].ok()) {
+      std::cout << "# error: " << responses[i].status() << "\n\n";
+      status.Update(responses[i].status());
+      continue;
+    }
     std::string compile_response_text;
-    google::protobuf::TextFormat::PrintToString(compile_response_status.value(),
+    google::protobuf::TextFormat::PrintToString(responses[i].value(),
                                       &compile_response_text);
     std::cout << compile_response_text << '\n';
   }
-  return xls::ExitStatus(compile_response_status.status());
+  return xls::ExitStatus(status);
 }
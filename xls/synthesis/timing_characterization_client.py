@@ -16,16 +16,20 @@
 
 These datapoints can be used in a delay model (where they will be interpolated)
 -- the results emitted on stdout are in xls.delay_model.DataPoints prototext
-format.
+format. The areas of the synthesized modules can optionally be saved for use in
+an area model (see xls/area_model/area_model.proto).
 """
 
+import concurrent.futures
 import sys
-from typing import Dict, Sequence, Set, Tuple
+import threading
+from typing import Dict, Optional, Sequence, Set, Tuple
 
 from absl import flags
 from absl import logging
 
 from google.protobuf import text_format
+from xls.area_model import area_model_pb2
 from xls.common import gfile
 from xls.delay_model import delay_model_pb2
 from xls.delay_model import op_module_generator
@@ -43,6 +47,21 @@ _CHECKPOINT_PATH = flags.DEFINE_string(
     'Checkpoints will not be kept if unspecified.')
 _SAMPLES_PATH = flags.DEFINE_string(
     'samples_path', '', 'Path at which to load samples textproto.')
+_AREA_CHECKPOINT_PATH = flags.DEFINE_string(
+    'area_checkpoint_path', '', 'Path at which to load and save the areas ' +
+    'of the characterized data points as xls.area_model.AreaDataPoints. ' +
+    'Areas are not recorded if unspecified.')
+_AREA_SCALE = flags.DEFINE_integer(
+    'area_scale', 1000, 'Factor by which areas reported by the synthesis ' +
+    'server are multiplied before being rounded to integers.')
+_MAX_IN_FLIGHT = flags.DEFINE_integer(
+    'max_in_flight', 1,
+    'Number of data points to characterize concurrently. Each data point ' +
+    'has at most one Compile request outstanding at a time.')
+
+# Guards the results and data points shared by concurrently characterized
+# data points.
+_RESULTS_LOCK = threading.Lock()
 
 ENUM2NAME_MAP = dict((op.enum_name, op.name) for op in OPS)
 
@@ -62,6 +81,49 @@ def save_checkpoint(results: delay_model_pb2.DataPoints, checkpoint_path: str):
       f.write(text_format.MessageToString(results))
 
 
+def _flopped_bit_count(operation: delay_model_pb2.Operation) -> int:
+  """Returns the number of bits registered around the characterized module."""
+  bit_count = operation.bit_count
+  for operand in operation.operands:
+    bit_count += operand.bit_count * max(operand.element_count, 1)
+  return bit_count
+
+
+def check_area_offset(results: area_model_pb2.AreaDataPoints):
+  """Sets the register area and the area offset of each data point."""
+  # The smallest area per flopped bit, presumably from an operation which is
+  # only wires between its input and output registers.
+  per_bit_areas = [
+      x.area // _flopped_bit_count(x.operation)
+      for x in results.data_points
+      if x.area and _flopped_bit_count(x.operation)
+  ]
+  if not per_bit_areas:
+    return
+  results.register_area_per_bit = min(per_bit_areas)
+  logging.vlog(0, f'USING REGISTER_AREA_PER_BIT {min(per_bit_areas)}')
+  for dp in results.data_points:
+    dp.area_offset = results.register_area_per_bit * _flopped_bit_count(
+        dp.operation)
+
+
+def save_area_checkpoint(results: area_model_pb2.AreaDataPoints,
+                         checkpoint_path: str):
+  if checkpoint_path:
+    check_area_offset(results)
+    with gfile.open(checkpoint_path, 'w') as f:
+      f.write(text_format.MessageToString(results))
+
+
+def init_area_data(checkpoint_path: str) -> area_model_pb2.AreaDataPoints:
+  """Returns the area data points loaded from a checkpoint, if available."""
+  results = area_model_pb2.AreaDataPoints()
+  if checkpoint_path and gfile.exists(checkpoint_path):
+    with gfile.open(checkpoint_path, 'r') as f:
+      results = text_format.Parse(f.read(), results)
+  return results
+
+
 def _search_for_fmax_and_synth(
     stub: synthesis_service_pb2_grpc.SynthesisServiceStub,
     verilog_text: str,
@@ -158,10 +220,10 @@ def _synthesize_ir(stub: synthesis_service_pb2_grpc.SynthesisServiceStub,
                    op: str, result_bit_count: int,
                    operand_bit_counts: Sequence[int],
                    operand_element_counts: Dict[int, int],
-                   specialization: delay_model_pb2.SpecializationKind) -> None:
+                   specialization: delay_model_pb2.SpecializationKind,
+                   area_results: Optional[area_model_pb2.AreaDataPoints] = None
+                   ) -> None:
   """Synthesizes the given IR text and checkpoint resulting data points."""
-  if op not in data_points:
-    data_points[op] = set()
 
   bit_count_strs = []
   for bit_count in operand_bit_counts:
@@ -172,9 +234,12 @@ def _synthesize_ir(stub: synthesis_service_pb2_grpc.SynthesisServiceStub,
   key = ', '.join([str(result_bit_count)] + bit_count_strs)
   if specialization:
     key = key + ' ' + str(specialization)
-  if key in data_points[op]:
-    return
-  data_points[op].add(key)
+  with _RESULTS_LOCK:
+    if op not in data_points:
+      data_points[op] = set()
+    if key in data_points[op]:
+      return
+    data_points[op].add(key)
 
   logging.info('Running %s with %d / %s', op, result_bit_count,
                ', '.join([str(x) for x in operand_bit_counts]))
@@ -193,21 +258,28 @@ def _synthesize_ir(stub: synthesis_service_pb2_grpc.SynthesisServiceStub,
   else:
     ps = 0
 
-  # Add a new record to the results proto
-  result_dp = results.data_points.add()
-  result_dp.operation.op = op
-  result_dp.operation.bit_count = result_bit_count
-  if specialization:
-    result_dp.operation.specialization = specialization
-  for bit_count in operand_bit_counts:
-    operand = result_dp.operation.operands.add(bit_count=bit_count)
-  for opnd_num, element_count in operand_element_counts.items():
-    result_dp.operation.operands[opnd_num].element_count = element_count
-  result_dp.delay = int(ps)
-  # TODO(tcal) currently no support for array result type here
-
-  # Checkpoint after every run.
-  save_checkpoint(results, _CHECKPOINT_PATH.value)
+  with _RESULTS_LOCK:
+    # Add a new record to the results proto
+    result_dp = results.data_points.add()
+    result_dp.operation.op = op
+    result_dp.operation.bit_count = result_bit_count
+    if specialization:
+      result_dp.operation.specialization = specialization
+    for bit_count in operand_bit_counts:
+      operand = result_dp.operation.operands.add(bit_count=bit_count)
+    for opnd_num, element_count in operand_element_counts.items():
+      result_dp.operation.operands[opnd_num].element_count = element_count
+    result_dp.delay = int(ps)
+    # TODO(tcal) currently no support for array result type here
+
+    # Checkpoint after every run.
+    save_checkpoint(results, _CHECKPOINT_PATH.value)
+
+    if area_results is not None and result.area > 0:
+      area_dp = area_results.data_points.add()
+      area_dp.operation.CopyFrom(result_dp.operation)
+      area_dp.area = round(result.area * _AREA_SCALE.value)
+      save_area_checkpoint(area_results, _AREA_CHECKPOINT_PATH.value)
 
 
 def _run_point(
@@ -216,6 +288,7 @@ def _run_point(
     results: delay_model_pb2.DataPoints,
     data_points: Dict[str, Set[str]],
     stub: synthesis_service_pb2_grpc.SynthesisServiceStub,
+    area_results: Optional[area_model_pb2.AreaDataPoints] = None,
 ) -> None:
   """Generate IR and Verilog, run synthesis for one op parameterization."""
 
@@ -262,7 +335,8 @@ def _run_point(
   logging.info('ir_text:\n%s\n', ir_text)
   _synthesize_ir(
       stub, results, data_points, ir_text, op, res_bit_count,
-      list(point.operand_widths), opnd_element_counts, specialization
+      list(point.operand_widths), opnd_element_counts, specialization,
+      area_results
   )
 
 
@@ -292,15 +366,32 @@ def run_characterization(
 ) -> None:
   """Run characterization with the given synthesis service."""
   data_points, data_points_proto = init_data(_CHECKPOINT_PATH.value)
+  area_results = (
+      init_area_data(_AREA_CHECKPOINT_PATH.value)
+      if _AREA_CHECKPOINT_PATH.value else None)
   samples_file = _SAMPLES_PATH.value
   op_samples_list = delay_model_pb2.OpSamplesList()
   with gfile.open(samples_file, 'r') as f:
     op_samples_list = text_format.Parse(f.read(), op_samples_list)
-  for op_samples in op_samples_list.op_samples:
-    for point in op_samples.samples:
-      _run_point(op_samples,
-                 point,
-                 data_points_proto, data_points, stub)
+  if _MAX_IN_FLIGHT.value <= 1:
+    for op_samples in op_samples_list.op_samples:
+      for point in op_samples.samples:
+        _run_point(op_samples,
+                   point,
+                   data_points_proto, data_points, stub, area_results)
+  else:
+    # The fmax search of each data point is sequential but the data points are
+    # independent, so overlap the searches. gRPC stubs are thread-safe.
+    with concurrent.futures.ThreadPoolExecutor(
+        max_workers=_MAX_IN_FLIGHT.value) as executor:
+      futures = [
+          executor.submit(_run_point, op_samples, point, data_points_proto,
+                          data_points, stub, area_results)
+          for op_samples in op_samples_list.op_samples
+          for point in op_samples.samples
+      ]
+      for future in futures:
+        future.result()
 
   print('# proto-file: xls/delay_model/delay_model.proto')
   print('# proto-message: xls.delay_model.DataPoints')
@@ -18,6 +18,7 @@ import collections
 import tempfile
 
 from absl.testing import absltest
+from xls.area_model import area_model_pb2
 from xls.delay_model import delay_model_pb2
 from xls.synthesis import timing_characterization_client as client
 
@@ -61,6 +62,30 @@ class TimingCharacterizationClientMainTest(absltest.TestCase):
         self.assertIn(bit_config, data_points[op])
     self.assertEqual(data_points, loaded_data_points)
 
+  def test_save_load_area_checkpoint(self):
+    results = area_model_pb2.AreaDataPoints()
+    # An identity (registers only) and an add of two 8-bit operands.
+    identity = results.data_points.add()
+    identity.operation.op = "kIdentity"
+    identity.operation.bit_count = 8
+    identity.operation.operands.add(bit_count=8)
+    identity.area = 160
+    add = results.data_points.add()
+    add.operation.op = "kAdd"
+    add.operation.bit_count = 8
+    add.operation.operands.add(bit_count=8)
+    add.operation.operands.add(bit_count=8)
+    add.area = 500
+
+    tf = tempfile.NamedTemporaryFile()
+    client.save_area_checkpoint(results, tf.name)
+    loaded_results = client.init_area_data(tf.name)
+
+    self.assertEqual(results, loaded_results)
+    self.assertEqual(loaded_results.register_area_per_bit, 10)
+    self.assertEqual(loaded_results.data_points[0].area_offset, 160)
+    self.assertEqual(loaded_results.data_points[1].area_offset, 240)
+
 
 if __name__ == "__main__":
   absltest.main()
@@ -14,8 +14,11 @@
 
 #include "xls/synthesis/yosys/yosys_synthesis_service.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <filesystem>  // NOLINT
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -39,6 +42,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
+#include "xls/common/thread.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/yosys/yosys_util.h"
 
@@ -62,6 +66,42 @@ namespace synthesis {
   return ::grpc::Status::OK;
 }
 
+::grpc::Status YosysSynthesisServiceImpl::CompileBatch(
+    ::grpc::ServerContext* server_context, const CompileBatchRequest* request,
+    CompileBatchResponse* result) {
+  const int64_t request_count = request->requests_size();
+  for (int64_t i = 0; i < request_count; ++i) {
+    result->add_results();
+  }
+  // Each synthesis run is a separate set of subprocesses in its own temporary
+  // directory so the requests can be run concurrently. Requests are handed out
+  // one at a time because their runtimes vary widely.
+  int64_t worker_count = request->max_parallelism() > 0
+                             ? request->max_parallelism()
+                             : std::max(1, AvailableCPUs());
+  worker_count = std::min(worker_count, request_count);
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index++; i < request_count; i = next_index++) {
+      CompileBatchResponse::Result* batch_result = result->mutable_results(i);
+      ::grpc::Status status =
+          Compile(server_context, &request->requests(i),
+                  batch_result->mutable_response());
+      batch_result->set_status_code(static_cast<int32_t>(status.error_code()));
+      batch_result->set_error_message(status.error_message());
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(worker_count);
+  for (int64_t i = 0; i < worker_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  return ::grpc::Status::OK;
+}
+
 // Run the given arguments as a subprocess with InvokeSubprocess.
 // InvokeSubprocess is wrapped because the error message can be very large (it
 // includes both stdout and stderr) which breaks propagation of the error via
@@ -95,7 +135,8 @@ YosysSynthesisServiceImpl::RunSubprocess(
 std::string YosysSynthesisServiceImpl::BuildYosysTcl(
     const CompileRequest* request, const std::filesystem::path& verilog_path,
     const std::filesystem::path& json_path,
-    const std::filesystem::path& netlist_path) const {
+    const std::filesystem::path& netlist_path,
+    std::optional<std::string_view> output_module_name) const {
   std::vector<std::string> yosys_tcl_vec;
   std::string yosys_tcl;
 
@@ -149,6 +190,11 @@ std::string YosysSynthesisServiceImpl::BuildYosysTcl(
   yosys_tcl_vec.push_back(perform_cleanup);
   yosys_tcl_vec.push_back(perform_optimizations);
 
+  if (output_module_name.has_value()) {
+    yosys_tcl_vec.push_back(absl::StrFormat(
+        "rename %s %s", request->top_module_name(), *output_module_name));
+  }
+
   yosys_tcl_vec.push_back(write_json_netlist);
   yosys_tcl_vec.push_back(write_verilog_netlist);
 
@@ -239,6 +285,128 @@ absl::Status YosysSynthesisServiceImpl::RunSynthesis(
   return RunSTA(request, result, temp_dir_path, synth_verilog_path);
 }
 
+absl::StatusOr<std::vector<CompileResponse>>
+YosysSynthesisServiceImpl::RunSynthesisBatch(
+    absl::Span<const CompileRequest> requests) const {
+  if (!synthesis_target_.empty()) {
+    return absl::UnimplementedError(
+        "Batched synthesis is only supported for the stdcell backend.");
+  }
+  const int64_t module_count = requests.size();
+  std::vector<CompileResponse> results(module_count);
+  if (module_count == 0) {
+    return results;
+  }
+  for (const CompileRequest& request : requests) {
+    if (request.top_module_name().empty()) {
+      return absl::InvalidArgumentError("Must specify top module name.");
+    }
+  }
+
+  XLS_ASSIGN_OR_RETURN(TempDirectory temp_dir, TempDirectory::Create());
+  const std::filesystem::path temp_dir_path = temp_dir.path();
+  if (save_temps_) {
+    std::move(temp_dir).Release();
+  }
+
+  // All modules are synthesized by one yosys script. The design is reset
+  // between modules and each synthesized top module is renamed so that modules
+  // sharing a top module name can be linked separately by OpenSTA.
+  std::vector<std::string> design_names;
+  std::vector<std::filesystem::path> json_paths;
+  std::vector<std::filesystem::path> netlist_paths;
+  std::vector<std::string> yosys_tcl_vec;
+  for (int64_t i = 0; i < module_count; ++i) {
+    const CompileRequest& request = requests[i];
+    design_names.push_back(
+        absl::StrFormat("%s_xls_batch_%d", request.top_module_name(), i));
+    std::filesystem::path verilog_path =
+        temp_dir_path / absl::StrFormat("input_%d.v", i);
+    XLS_RETURN_IF_ERROR(SetFileContents(verilog_path, request.module_text()));
+    json_paths.push_back(temp_dir_path / absl::StrFormat("netlist_%d.json", i));
+    netlist_paths.push_back(temp_dir_path /
+                            absl::StrFormat("output_%d.v", i));
+    yosys_tcl_vec.push_back("yosys design -reset");
+    yosys_tcl_vec.push_back(
+        absl::StrFormat("yosys log %s %d", kBatchModuleMarker, i));
+    yosys_tcl_vec.push_back(BuildYosysTcl(&request, verilog_path,
+                                          json_paths.back(),
+                                          netlist_paths.back(),
+                                          design_names.back()));
+  }
+  std::filesystem::path yosys_tcl_path = temp_dir_path / "yosys.tcl";
+  XLS_RETURN_IF_ERROR(
+      SetFileContents(yosys_tcl_path, absl::StrJoin(yosys_tcl_vec, "\n")));
+  LOG(INFO) << "Running Yosys on " << module_count
+            << " modules: command file: " << yosys_tcl_path;
+  XLS_ASSIGN_OR_RETURN(auto yosys_string_pair,
+                       RunSubprocess({yosys_path_, "-c", yosys_tcl_path}));
+  auto [yosys_stdout, yosys_stderr] = yosys_string_pair;
+  if (save_temps_) {
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(temp_dir_path / "yosys.stdout", yosys_stdout));
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(temp_dir_path / "yosys.stderr", yosys_stderr));
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<std::string_view> yosys_outputs,
+                       SplitBatchOutput(yosys_stdout, module_count));
+  for (int64_t i = 0; i < module_count; ++i) {
+    CompileResponse& result = results[i];
+    result.set_insensitive_to_target_freq(true);
+    if (return_netlist_) {
+      XLS_ASSIGN_OR_RETURN(std::string netlist,
+                           GetFileContents(json_paths[i]));
+      result.set_netlist(netlist);
+    }
+    XLS_ASSIGN_OR_RETURN(YosysSynthesisStatistics parse_stats,
+                         ParseYosysOutput(yosys_outputs[i]));
+    for (const auto& name_count : parse_stats.cell_histogram) {
+      (*result.mutable_instance_count()
+            ->mutable_cell_histogram())[name_count.first] = name_count.second;
+    }
+  }
+
+  if (synthesis_only_) {
+    return results;
+  }
+
+  // The liberty files are read once for all of the netlists.
+  std::vector<std::string> sta_cmd_vec = BuildSTALibraryCmds();
+  for (int64_t i = 0; i < module_count; ++i) {
+    sta_cmd_vec.push_back(absl::StrFormat("puts \"%s %d\"",
+                                          kBatchModuleMarker, i));
+    for (std::string& cmd :
+         BuildSTADesignCmds(&requests[i], netlist_paths[i], design_names[i])) {
+      sta_cmd_vec.push_back(std::move(cmd));
+    }
+  }
+  sta_cmd_vec.push_back("exit");
+  std::filesystem::path sta_cmd_path = temp_dir_path / "sta.tcl";
+  XLS_RETURN_IF_ERROR(
+      SetFileContents(sta_cmd_path, absl::StrJoin(sta_cmd_vec, "\n")));
+  LOG(INFO) << "Running OpenSTA on " << module_count
+            << " modules: command file: " << sta_cmd_path;
+  XLS_ASSIGN_OR_RETURN(auto sta_string_pair,
+                       RunSubprocess({sta_path_, "-no_splash", "-exit",
+                                      sta_cmd_path}));
+  auto [sta_stdout, sta_stderr] = sta_string_pair;
+  if (save_temps_) {
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(temp_dir_path / "sta.stdout", sta_stdout));
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(temp_dir_path / "sta.stderr", sta_stderr));
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<std::string_view> sta_outputs,
+                       SplitBatchOutput(sta_stdout, module_count));
+  for (int64_t i = 0; i < module_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(STAStatistics sta_stats,
+                         ParseOpenSTAOutput(sta_outputs[i]));
+    results[i].set_max_frequency_hz(sta_stats.max_frequency_hz);
+    results[i].set_slack_ps(sta_stats.slack_ps);
+  }
+  return results;
+}
+
 absl::Status YosysSynthesisServiceImpl::RunNextPNR(
     const CompileRequest* request, CompileResponse* result,
     const std::filesystem::path& temp_dir_path,
@@ -291,22 +459,42 @@ std::string YosysSynthesisServiceImpl::BuildSTACmds(
     const CompileRequest* request,
     const std::filesystem::path& netlist_path) const {
   // Invoke STA for timing and max freq analysis.
+  std::vector<std::string> sta_cmd_vec = BuildSTALibraryCmds();
+  for (std::string& cmd : BuildSTADesignCmds(request, netlist_path,
+                                             request->top_module_name())) {
+    sta_cmd_vec.push_back(std::move(cmd));
+  }
+  sta_cmd_vec.push_back("exit");
+
+  std::string sta_cmd = absl::StrJoin(sta_cmd_vec, "\n");
+
+  VLOG(1) << "about to start, sta cmd: " << sta_cmd;
+  return sta_cmd;
+}
+
+std::vector<std::string> YosysSynthesisServiceImpl::BuildSTALibraryCmds()
+    const {
+  const std::string setup_libraries =
+      absl::StrFormat("set LIB_FILES { %s }", sta_libraries_);
+  const std::string read_libraries =
+      absl::StrFormat("foreach libFile $LIB_FILES { read_liberty $libFile }");
+  return {setup_libraries, read_libraries};
+}
+
+std::vector<std::string> YosysSynthesisServiceImpl::BuildSTADesignCmds(
+    const CompileRequest* request, const std::filesystem::path& netlist_path,
+    std::string_view design_name) const {
   std::vector<std::string> sta_cmd_vec;
-  std::string sta_cmd;
 
   // Input in hz, adjust for scale ps
   double clock_period_ps =
       1e12 / static_cast<double>(request->target_frequency_hz());
   std::string delay_target = absl::StrCat(clock_period_ps);
 
-  const std::string setup_libraries =
-      absl::StrFormat("set LIB_FILES { %s }", sta_libraries_);
-  const std::string read_libraries =
-      absl::StrFormat("foreach libFile $LIB_FILES { read_liberty $libFile }");
   const std::string read_verilog_netlist =
       absl::StrFormat("read_verilog %s ", netlist_path.string());
   const std::string perform_elaboratation =
-      absl::StrFormat("link_design %s  ", request->top_module_name());
+      absl::StrFormat("link_design %s  ", design_name);
 
   const std::string setup_units = absl::StrFormat("set_cmd_units -time ps");
   const std::string setup_clk_period =
@@ -334,10 +522,6 @@ std::string YosysSynthesisServiceImpl::BuildSTACmds(
       "report_checks -path_delay min_max -fields {slew cap input nets"
       "fanout} -format full_clock_expanded");
 
-  const std::string perform_exit = absl::StrFormat("exit");
-
-  sta_cmd_vec.push_back(setup_libraries);
-  sta_cmd_vec.push_back(read_libraries);
   sta_cmd_vec.push_back(read_verilog_netlist);
   sta_cmd_vec.push_back(perform_elaboratation);
 
@@ -353,12 +537,7 @@ std::string YosysSynthesisServiceImpl::BuildSTACmds(
   sta_cmd_vec.push_back(perform_report_negative_slacks);
   sta_cmd_vec.push_back(perform_report_checks);
 
-  sta_cmd_vec.push_back(perform_exit);
-
-  sta_cmd = absl::StrJoin(sta_cmd_vec, "\n");
-
-  VLOG(1) << "about to start, sta cmd: " << sta_cmd;
-  return sta_cmd;
+  return sta_cmd_vec;
 }
 
 absl::Status YosysSynthesisServiceImpl::RunSTA(
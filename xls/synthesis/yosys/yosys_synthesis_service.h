@@ -16,9 +16,11 @@
 #define XLS_SYNTHESIS_YOSYS_YOSYS_SYNTHESIS_SERVICE_H_
 
 #include <filesystem>  // NOLINT
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -53,6 +55,11 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
                          const CompileRequest* request,
                          CompileResponse* result) override;
 
+  // Runs the requests of the batch concurrently, each as by Compile.
+  ::grpc::Status CompileBatch(::grpc::ServerContext* server_context,
+                              const CompileBatchRequest* request,
+                              CompileBatchResponse* result) override;
+
   // Run the given arguments as a subprocess with InvokeSubprocess.
   // InvokeSubprocess is wrapped because the error message can be very large (it
   // includes both stdout and stderr) which breaks propagation of the error via
@@ -61,17 +68,28 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
   absl::StatusOr<std::pair<std::string, std::string>> RunSubprocess(
       absl::Span<const std::string> args) const;
 
-  // Build yosys synthesis script contents for stdcell backend
-  std::string BuildYosysTcl(const CompileRequest* request,
-                             const std::filesystem::path& verilog_path,
-                             const std::filesystem::path& json_path,
-                             const std::filesystem::path& netlist_path) const;
+  // Build yosys synthesis script contents for stdcell backend. If
+  // `output_module_name` is given the synthesized top module is renamed to it
+  // before the netlist is written.
+  std::string BuildYosysTcl(
+      const CompileRequest* request, const std::filesystem::path& verilog_path,
+      const std::filesystem::path& json_path,
+      const std::filesystem::path& netlist_path,
+      std::optional<std::string_view> output_module_name = std::nullopt) const;
 
   // Invokes yosys and nextpnr to synthesis the verilog given in the
   // CompileRequest.
   absl::Status RunSynthesis(const CompileRequest* request,
                             CompileResponse* result) const;
 
+  // Synthesizes the Verilog of each of the requests with a single invocation
+  // of yosys and (unless synthesis_only) a single invocation of OpenSTA, which
+  // avoids paying the tool startup and liberty parsing costs for every module.
+  // Only the stdcell backend is supported. The responses are returned in the
+  // order of the requests.
+  absl::StatusOr<std::vector<CompileResponse>> RunSynthesisBatch(
+      absl::Span<const CompileRequest> requests) const;
+
   absl::Status RunNextPNR(const CompileRequest* request,
                           CompileResponse* result,
                           const std::filesystem::path& temp_dir_path,
@@ -80,6 +98,15 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
   std::string BuildSTACmds(const CompileRequest* request,
                            const std::filesystem::path& netlist_path) const;
 
+  // The STA commands which read the liberty files.
+  std::vector<std::string> BuildSTALibraryCmds() const;
+
+  // The STA commands which read the netlist of the design `design_name` and
+  // report its timing.
+  std::vector<std::string> BuildSTADesignCmds(
+      const CompileRequest* request, const std::filesystem::path& netlist_path,
+      std::string_view design_name) const;
+
   absl::Status RunSTA(const CompileRequest* request, CompileResponse* result,
                       const std::filesystem::path& temp_dir_path,
                       const std::filesystem::path& netlist_path) const;
@@ -15,14 +15,19 @@
 
 #include "xls/synthesis/yosys/yosys_util.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "re2/re2.h"
@@ -30,6 +35,44 @@
 namespace xls {
 namespace synthesis {
 
+absl::StatusOr<std::vector<std::string_view>> SplitBatchOutput(
+    std::string_view output, int64_t module_count) {
+  std::vector<std::string_view> module_outputs;
+  std::optional<size_t> module_start;
+  size_t line_start = 0;
+  while (line_start < output.size()) {
+    size_t line_end = output.find('\n', line_start);
+    if (line_end == std::string_view::npos) {
+      line_end = output.size();
+    }
+    std::string_view line = absl::StripAsciiWhitespace(
+        output.substr(line_start, line_end - line_start));
+    int64_t index;
+    if (absl::ConsumePrefix(&line, kBatchModuleMarker) &&
+        absl::SimpleAtoi(line, &index)) {
+      int64_t expected_index = static_cast<int64_t>(module_outputs.size()) +
+                               (module_start.has_value() ? 1 : 0);
+      XLS_RET_CHECK_EQ(index, expected_index)
+          << "Batch module markers are out of order";
+      if (module_start.has_value()) {
+        module_outputs.push_back(
+            output.substr(*module_start, line_start - *module_start));
+      }
+      module_start = std::min(line_end + 1, output.size());
+    }
+    line_start = line_end + 1;
+  }
+  if (module_start.has_value()) {
+    module_outputs.push_back(output.substr(*module_start));
+  }
+  if (static_cast<int64_t>(module_outputs.size()) != module_count) {
+    return absl::InternalError(absl::StrCat(
+        "Expected output for ", module_count, " modules, found ",
+        module_outputs.size()));
+  }
+  return module_outputs;
+}
+
 absl::StatusOr<int64_t> ParseNextpnrOutput(std::string_view nextpnr_output) {
   bool found = false;
   double max_mhz = 0.0;
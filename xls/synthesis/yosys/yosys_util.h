@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
@@ -50,6 +51,17 @@ struct STAStatistics {
 };
 absl::StatusOr<STAStatistics> ParseOpenSTAOutput(std::string_view sta_output);
 
+// When several modules are synthesized by one invocation of a tool, the output
+// for the module with index `i` is preceded by a line holding
+// kBatchModuleMarker followed by `i`.
+inline constexpr std::string_view kBatchModuleMarker = "XLS_BATCH_MODULE";
+
+// Splits the output of a tool invocation covering `module_count` modules into
+// the output for each module, using the marker lines described above. Output
+// before the first marker is dropped.
+absl::StatusOr<std::vector<std::string_view>> SplitBatchOutput(
+    std::string_view output, int64_t module_count);
+
 }  // namespace synthesis
 }  // namespace xls
 
@@ -18,10 +18,12 @@
 
 #include <filesystem>
 #include <string>
+#include <string_view>
 #include <utility>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/matchers.h"
@@ -31,7 +33,9 @@ namespace xls {
 namespace synthesis {
 namespace {
 
+using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
+using testing::ElementsAre;
 using testing::HasSubstr;
 using testing::UnorderedElementsAre;
 
@@ -232,6 +236,23 @@ Fanout     Cap    Slew   Delay    Time   Description
   EXPECT_EQ(sta_stats.max_frequency_hz, 21177466627);
 }
 
+TEST(YosysUtilTest, SplitBatchOutput) {
+  constexpr std::string_view kOutput = R"(preamble
+XLS_BATCH_MODULE 0
+first
+module
+  XLS_BATCH_MODULE 1
+second
+)";
+  EXPECT_THAT(SplitBatchOutput(kOutput, 2),
+              IsOkAndHolds(ElementsAre("first\nmodule\n", "second\n")));
+  EXPECT_THAT(SplitBatchOutput(kOutput, 3),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Expected output for 3 modules, found 2")));
+  EXPECT_THAT(SplitBatchOutput("XLS_BATCH_MODULE 1\n", 1),
+              StatusIs(absl::StatusCode::kInternal, HasSubstr("out of order")));
+}
+
 }  // namespace
 }  // namespace synthesis
 }  // namespace xls
@@ -41,12 +41,16 @@
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "xls/area_model/area_estimator.h"
+#include "xls/area_model/area_estimators.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/binary_decision_diagram.h"
 #include "xls/delay_model/analyze_critical_path.h"
 #include "xls/delay_model/delay_estimator.h"
@@ -56,9 +60,14 @@
 #include "xls/fdo/synthesizer.h"
 #include "xls/interpreter/block_evaluator.h"
 #include "xls/interpreter/block_interpreter.h"
+#include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/interpreter_proc_runtime.h"
 #include "xls/interpreter/random_value.h"
+#include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/block.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/ir_parser.h"
@@ -70,14 +79,14 @@
 #include "xls/ir/value.h"
 #include "xls/jit/block_jit.h"
 #include "xls/jit/function_jit.h"
-#include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_runtime.h"
-#include "xls/jit/proc_jit.h"
+#include "xls/jit/jit_proc_runtime.h"
 #include "xls/passes/bdd_function.h"
 #include "xls/passes/bdd_query_engine.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/pass_metrics.pb.h"
 #include "xls/passes/query_engine.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/tools/codegen.h"
@@ -127,7 +136,26 @@ ABSL_FLAG(bool, compare_delay_to_synthesis, false,
 ABSL_FLAG(std::string, synthesis_server, "ipv4:///0.0.0.0:10000",
           "The address, including port, of the gRPC server to use with "
           "--compare_delay_to_synthesis.");
+ABSL_FLAG(int64_t, evaluator_run_ms, 500,
+          "Duration in milliseconds of each measured run of the JIT and "
+          "interpreter.");
+ABSL_FLAG(int64_t, evaluator_warmup_ms, 0,
+          "Duration in milliseconds to run each evaluator before it is "
+          "measured.");
+ABSL_FLAG(int64_t, evaluator_batch_size, 100,
+          "Number of random inputs (or proc ticks) per batch of evaluations. "
+          "Inputs are generated before the measurement starts.");
+ABSL_FLAG(int64_t, evaluator_threads, 1,
+          "Number of threads evaluating concurrently. Each thread has its own "
+          "inputs and evaluator state. Functions and blocks share one "
+          "compiled JIT; procs are compiled per thread.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
+ABSL_FLAG(std::optional<std::string>, pass_profile_path, std::nullopt,
+          "If specified, write a text-format PassPipelineProfileProto "
+          "describing the optimization pipeline run to this path.");
+ABSL_FLAG(std::optional<std::string>, evaluator_benchmark_json, std::nullopt,
+          "If specified, write the evaluator measurements (rate, ns per "
+          "evaluation and JIT compile time) to this path as JSON.");
 
 namespace xls {
 namespace {
@@ -245,6 +273,25 @@ absl::Status RunOptimizationAndPrintStats(Package* package) {
                                     changed_counts.at(name),
                                     pass_counts.at(name));
   }
+
+  PassPipelineProfileProto profile = PassResultsToProfileProto(pass_results);
+  std::cout << "Fixed-point pass iterations (total / max per run / # of runs):"
+            << '\n';
+  for (const FixedPointProfileProto& fixed_point : profile.fixed_points()) {
+    std::cout << absl::StreamFormat(
+        "  %-20s : %-5dms (%3d / %3d / %3d)\n", fixed_point.pass_name(),
+        fixed_point.total_duration_us() / 1000, fixed_point.total_iterations(),
+        fixed_point.max_iterations(), fixed_point.run_count());
+  }
+  std::cout << absl::StreamFormat(
+      "Invariant checkers: %dms (%d runs)\n",
+      profile.invariant_checker_duration_us() / 1000,
+      profile.invariant_checker_run_count());
+  if (std::optional<std::string> profile_path =
+          absl::GetFlag(FLAGS_pass_profile_path);
+      profile_path.has_value()) {
+    XLS_RETURN_IF_ERROR(SetTextProtoFile(*profile_path, profile));
+  }
   return absl::OkStatus();
 }
 
@@ -344,10 +391,45 @@ absl::StatusOr<std::vector<int64_t>> GetDelayPerStageInPs(
   return delay_per_stage;
 }
 
+// Prints the estimated area of the logic and of the pipeline registers at the
+// end of each stage.
+absl::Status PrintAreaPerStage(const PipelineSchedule& schedule,
+                               absl::Span<const int64_t> flops_per_stage,
+                               const AreaEstimator& area_estimator) {
+  int64_t total_logic_area = 0;
+  int64_t total_register_area = 0;
+  std::cout << absl::StreamFormat("Estimated area (%s model):
+",
+                                  area_estimator.name());
+  for (int64_t i = 0; i < schedule.length(); ++i) {
+    int64_t logic_area = 0;
+    for (Node* node : schedule.nodes_in_cycle(i)) {
+      XLS_ASSIGN_OR_RETURN(int64_t node_area,
+                           area_estimator.GetOperationArea(node));
+      logic_area += node_area;
+    }
+    int64_t register_area = i + 1 == schedule.length()
+                                ? 0
+                                : area_estimator.GetRegisterArea(
+                                      flops_per_stage[i]);
+    std::cout << absl::StreamFormat(
+        "  [Stage %2d] logic: %8d, registers: %8d, total: %8d\n", i,
+        logic_area, register_area, logic_area + register_area);
+    total_logic_area += logic_area;
+    total_register_area += register_area;
+  }
+  std::cout << absl::StreamFormat(
+      "Total estimated area: %d (%d logic, %d pipeline registers)\n",
+      total_logic_area + total_register_area, total_logic_area,
+      total_register_area);
+  return absl::OkStatus();
+}
+
 absl::Status PrintScheduleInfo(FunctionBase* f,
                                const PipelineSchedule& schedule,
                                const BddQueryEngine& bdd_query_engine,
                                const DelayEstimator& delay_estimator,
+                               const AreaEstimator* area_estimator,
                                std::optional<int64_t> clock_period_ps) {
   int64_t total_flops = 0;
   int64_t total_duplicates = 0;
@@ -423,6 +505,11 @@ absl::Status PrintScheduleInfo(FunctionBase* f,
     std::cout << absl::StreamFormat("Min stage slack: %d\n", min_slack);
   }
 
+  if (area_estimator != nullptr) {
+    XLS_RETURN_IF_ERROR(
+        PrintAreaPerStage(schedule, flops_per_stage, *area_estimator));
+  }
+
   return absl::OkStatus();
 }
 
@@ -430,10 +517,11 @@ absl::Status PrintScheduleInfo(FunctionBase* f,
                                const PipelineScheduleOrGroup& schedules,
                                const BddQueryEngine& bdd_query_engine,
                                const DelayEstimator& delay_estimator,
+                               const AreaEstimator* area_estimator,
                                std::optional<int64_t> clock_period_ps) {
   if (std::holds_alternative<PipelineSchedule>(schedules)) {
     return PrintScheduleInfo(f, std::get<PipelineSchedule>(schedules),
-                             bdd_query_engine, delay_estimator,
+                             bdd_query_engine, delay_estimator, area_estimator,
                              clock_period_ps);
   }
 
@@ -443,7 +531,7 @@ absl::Status PrintScheduleInfo(FunctionBase* f,
     std::cout << "\n\nFunction: " << function_base->name() << "\n";
     XLS_RETURN_IF_ERROR(PrintScheduleInfo(function_base, schedule,
                                           bdd_query_engine, delay_estimator,
-                                          clock_period_ps));
+                                          area_estimator, clock_period_ps));
   }
   return absl::OkStatus();
 }
@@ -461,29 +549,172 @@ absl::Status PrintProcInfo(Proc* p) {
   return absl::OkStatus();
 }
 
-// Invokes `f` until (approximately) at least`duration_ms` milliseconds have
-// passed and returns the number of calls per second.
-absl::StatusOr<float> CountRate(const std::function<void()>& f,
-                                int64_t duration_ms) {
-  // To avoid including absl::Now() calls in the time measurement, first
-  // estimate how many calls it will take for `duration_ms` milliseconds to
-  // elapse. This is done my running until `duration_ms / 10` milliseconds have
-  // elapsed with absl::Now() in the loop.
-  int64_t call_count = 0;
-  absl::Time start_estimate = absl::Now();
-  while (DurationToMs(absl::Now() - start_estimate) < duration_ms / 10) {
-    f();
-    ++call_count;
-  }
-
-  // Then run 10x the estimated call count to get close to `duration_ms` total
-  // run time.
-  absl::Time start_actual = absl::Now();
-  for (int64_t i = 0; i < call_count * 10; ++i) {
-    f();
-  }
-  int64_t elapsed_ms = DurationToMs(absl::Now() - start_actual);
-  return elapsed_ms == 0 ? 0.0f : (1000.0 * call_count) / elapsed_ms;
+// A function which runs one batch of evaluations.
+using BatchFn = std::function<absl::Status()>;
+
+// The outcome of timing an evaluator.
+struct RateMeasurement {
+  // Total number of evaluations over all threads.
+  int64_t evaluations = 0;
+  // The longest time any thread spent in the measured run.
+  absl::Duration elapsed;
+};
+
+// Runs batches of `batch_size` evaluations on each of --evaluator_threads
+// threads, first for --evaluator_warmup_ms (not measured) and then for
+// --evaluator_run_ms. `make_batch_fn` is called once per thread before any
+// thread starts so that each thread owns its inputs and evaluator state.
+absl::StatusOr<RateMeasurement> MeasureRate(
+    const std::function<absl::StatusOr<BatchFn>()>& make_batch_fn,
+    int64_t batch_size) {
+  const int64_t thread_count =
+      std::max(int64_t{1}, absl::GetFlag(FLAGS_evaluator_threads));
+  const absl::Duration warmup =
+      absl::Milliseconds(absl::GetFlag(FLAGS_evaluator_warmup_ms));
+  const absl::Duration run_duration =
+      absl::Milliseconds(absl::GetFlag(FLAGS_evaluator_run_ms));
+
+  std::vector<BatchFn> batch_fns;
+  batch_fns.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    XLS_ASSIGN_OR_RETURN(BatchFn batch_fn, make_batch_fn());
+    batch_fns.push_back(std::move(batch_fn));
+  }
+
+  // The clock is read once per batch, which is negligible next to a batch of
+  // evaluations.
+  std::vector<absl::Status> statuses(thread_count);
+  std::vector<int64_t> batch_counts(thread_count, 0);
+  std::vector<absl::Duration> elapsed(thread_count);
+  auto run = [&](int64_t thread) {
+    absl::Time warmup_end = absl::Now() + warmup;
+    while (absl::Now() < warmup_end) {
+      statuses[thread] = batch_fns[thread]();
+      if (!statuses[thread].ok()) {
+        return;
+      }
+    }
+    absl::Time start = absl::Now();
+    absl::Time end = start + run_duration;
+    do {
+      statuses[thread] = batch_fns[thread]();
+      if (!statuses[thread].ok()) {
+        return;
+      }
+      ++batch_counts[thread];
+    } while (absl::Now() < end);
+    elapsed[thread] = absl::Now() - start;
+  };
+  if (thread_count == 1) {
+    run(0);
+  } else {
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(thread_count);
+    for (int64_t i = 0; i < thread_count; ++i) {
+      threads.push_back(std::make_unique<Thread>([&run, i]() { run(i); }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
+
+  RateMeasurement measurement;
+  for (int64_t i = 0; i < thread_count; ++i) {
+    XLS_RETURN_IF_ERROR(statuses[i]);
+    measurement.evaluations += batch_counts[i] * batch_size;
+    measurement.elapsed = std::max(measurement.elapsed, elapsed[i]);
+  }
+  return measurement;
+}
+
+// A measurement of one evaluator, reported on stdout and optionally written to
+// --evaluator_benchmark_json.
+struct EvaluatorBenchmarkResult {
+  // The stage of the benchmark, e.g. "optimized".
+  std::string description;
+  // "function", "proc" or "block".
+  std::string kind;
+  // "jit" or "interpreter".
+  std::string evaluator;
+  // What an evaluation is: "calls", "ticks" or "cycles".
+  std::string unit;
+  std::optional<absl::Duration> compile_time;
+  int64_t threads;
+  int64_t batch_size;
+  RateMeasurement measurement;
+
+  double PerSecond() const {
+    double seconds = absl::ToDoubleSeconds(measurement.elapsed);
+    return seconds == 0.0 ? 0.0 : measurement.evaluations / seconds;
+  }
+  // The average latency of an evaluation on a single thread.
+  double NanosecondsPerEvaluation() const {
+    return measurement.evaluations == 0
+               ? 0.0
+               : absl::ToDoubleNanoseconds(measurement.elapsed) * threads /
+                     measurement.evaluations;
+  }
+};
+
+// Measures the evaluator and records the result. `compile_time` is read after
+// the batch functions are made, so they may fill it in.
+absl::Status RecordEvaluatorResult(
+    std::string_view description, std::string_view kind,
+    std::string_view evaluator, std::string_view unit,
+    const std::optional<absl::Duration>& compile_time,
+    const std::function<absl::StatusOr<BatchFn>()>& make_batch_fn,
+    int64_t batch_size, std::vector<EvaluatorBenchmarkResult>& results) {
+  XLS_ASSIGN_OR_RETURN(RateMeasurement measurement,
+                       MeasureRate(make_batch_fn, batch_size));
+  EvaluatorBenchmarkResult result{
+      .description = std::string(description),
+      .kind = std::string(kind),
+      .evaluator = std::string(evaluator),
+      .unit = std::string(unit),
+      .compile_time = compile_time,
+      .threads = std::max(int64_t{1}, absl::GetFlag(FLAGS_evaluator_threads)),
+      .batch_size = batch_size,
+      .measurement = measurement};
+  if (compile_time.has_value()) {
+    std::cout << absl::StreamFormat("JIT compile time (%s): %dms\n",
+                                    description, DurationToMs(*compile_time));
+  }
+  // The text output is scraped by benchmark tooling so it keeps its format,
+  // with the JIT rate in thousands. The JSON output has the full detail.
+  const bool is_jit = evaluator == "jit";
+  const int64_t per_second = static_cast<int64_t>(result.PerSecond());
+  std::cout << absl::StreamFormat(
+      "%s run time (%s): %d %s%s/s\n", is_jit ? "JIT" : "Interpreter",
+      description, is_jit ? per_second / 1000 : per_second, is_jit ? "K" : "",
+      kind == "proc" ? "ticks" : "calls");
+  results.push_back(std::move(result));
+  return absl::OkStatus();
+}
+
+std::string EvaluatorResultsToJson(
+    absl::Span<const EvaluatorBenchmarkResult> results) {
+  std::vector<std::string> entries;
+  entries.reserve(results.size());
+  for (const EvaluatorBenchmarkResult& result : results) {
+    std::string compile_time_ms =
+        result.compile_time.has_value()
+            ? absl::StrFormat(
+                  "%.3f", absl::ToDoubleMilliseconds(*result.compile_time))
+            : "null";
+    entries.push_back(absl::StrFormat(
+        "    {\"description\": \"%s\", \"kind\": \"%s\", \"evaluator\": "
+        "\"%s\", \"unit\": \"%s\", \"threads\": %d, \"batch_size\": %d, "
+        "\"compile_time_ms\": %s, \"evaluations\": %d, "
+        "\"elapsed_seconds\": %.6f, \"per_second\": %.3f, "
+        "\"ns_per_evaluation\": %.3f}",
+        result.description, result.kind, result.evaluator, result.unit,
+        result.threads, result.batch_size, compile_time_ms,
+        result.measurement.evaluations,
+        absl::ToDoubleSeconds(result.measurement.elapsed), result.PerSecond(),
+        result.NanosecondsPerEvaluation()));
+  }
+  return absl::StrCat("{\n  \"evaluator_benchmarks\": [\n",
+                      absl::StrJoin(entries, ",\n"), "\n  ]\n}\n");
 }
 
 template <typename ParamNode, typename Rng>
@@ -534,189 +765,259 @@ absl::StatusOr<JitArguments> ConvertToJitArguments(
   return JitArguments{std::move(arg_buffers), std::move(arg_pointers)};
 }
 
-// Run the interpreter/JIT for a fixed amount of time and measure the rate of
-// calls per second.
-constexpr int64_t kRunDurationMs = 500;
-constexpr int64_t kJitRunMultiplier = 1000;
-
 template <typename Rng>
-absl::Status RunFunctionInterpreterAndJit(Function* function,
-                                          std::string_view description,
-                                          Rng& rng_engine) {
+absl::Status RunFunctionInterpreterAndJit(
+    Function* function, std::string_view description, Rng& rng_engine,
+    std::vector<EvaluatorBenchmarkResult>& results) {
   absl::Time start_jit_compile = absl::Now();
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
                        FunctionJit::Create(function));
-  std::cout << absl::StreamFormat(
-      "JIT compile time (%s): %dms\n", description,
-      DurationToMs(absl::Now() - start_jit_compile));
-
-  const int64_t kInputCount = 100;
-  auto arg_set =
-      GetRandomParams(function, kInputCount, function->params(), rng_engine);
+  absl::Duration compile_time = absl::Now() - start_jit_compile;
 
-  // To avoid being dominated by xls::Value conversion to native
-  // format, preconvert the arguments.
-  XLS_ASSIGN_OR_RETURN(
-      JitArguments jit_args,
-      ConvertToJitArguments(arg_set, function->GetType()->parameters(),
-                            jit->runtime()));
-  auto [jit_arg_buffers, jit_arg_pointers] = std::move(jit_args);
-
-  // The JIT is much faster so run many times.
-  InterpreterEvents events;
-  std::vector<uint8_t> result_buffer(jit->runtime()->ShouldAllocateForAlignment(
-      jit->GetReturnTypeSize(), jit->GetReturnTypeAlignment()));
-  absl::Span<uint8_t> result_aligned = jit->runtime()->AsAligned(
-      absl::MakeSpan(result_buffer), jit->GetReturnTypeAlignment());
-  XLS_ASSIGN_OR_RETURN(
-      float jit_run_rate,
-      CountRate(
-          [&]() -> absl::Status {
-            for (int64_t i = 0; i < kJitRunMultiplier; ++i) {
-              for (const std::vector<uint8_t*>& pointers : jit_arg_pointers) {
-                CHECK_OK(jit->RunWithViews(pointers, result_aligned, &events));
-              }
-            }
-            return absl::OkStatus();
-          },
-          kRunDurationMs));
-  std::cout << absl::StreamFormat(
-      "JIT run time (%s): %d Kcalls/s\n", description,
-      static_cast<int64_t>(kInputCount * jit_run_rate));
+  const int64_t batch_size = absl::GetFlag(FLAGS_evaluator_batch_size);
 
-  XLS_ASSIGN_OR_RETURN(
-      float interpreter_run_rate,
-      CountRate(
-          [&]() -> absl::Status {
-            for (const std::vector<Value>& args : arg_set) {
-              CHECK_OK(InterpretFunction(function, args).status());
-            }
-            return absl::OkStatus();
-          },
-          kRunDurationMs));
-  std::cout << absl::StreamFormat(
-      "Interpreter run time (%s): %d calls/s\n", description,
-      static_cast<int64_t>(kInputCount * interpreter_run_rate));
-  return absl::OkStatus();
+  // The compiled function is shared by all threads. Each thread has its own
+  // arguments, which are preconverted to the native format so that the
+  // measurement is not dominated by xls::Value conversion.
+  auto make_jit_batch = [&]() -> absl::StatusOr<BatchFn> {
+    auto arg_set =
+        GetRandomParams(function, batch_size, function->params(), rng_engine);
+    XLS_ASSIGN_OR_RETURN(
+        JitArguments jit_args,
+        ConvertToJitArguments(arg_set, function->GetType()->parameters(),
+                              jit->runtime()));
+    auto args = std::make_shared<JitArguments>(std::move(jit_args));
+    auto result_buffer = std::make_shared<std::vector<uint8_t>>(
+        jit->runtime()->ShouldAllocateForAlignment(
+            jit->GetReturnTypeSize(), jit->GetReturnTypeAlignment()));
+    absl::Span<uint8_t> result_aligned = jit->runtime()->AsAligned(
+        absl::MakeSpan(*result_buffer), jit->GetReturnTypeAlignment());
+    auto events = std::make_shared<InterpreterEvents>();
+    return [jit = jit.get(), args, result_buffer, result_aligned,
+            events]() -> absl::Status {
+      for (const std::vector<uint8_t*>& pointers : args->arg_pointers) {
+        XLS_RETURN_IF_ERROR(
+            jit->RunWithViews(pointers, result_aligned, events.get()));
+      }
+      events->Clear();
+      return absl::OkStatus();
+    };
+  };
+  XLS_RETURN_IF_ERROR(RecordEvaluatorResult(description, "function", "jit",
+                                            "calls", compile_time,
+                                            make_jit_batch, batch_size,
+                                            results));
+
+  auto make_interpreter_batch = [&]() -> absl::StatusOr<BatchFn> {
+    auto arg_set = std::make_shared<std::vector<std::vector<Value>>>(
+        GetRandomParams(function, batch_size, function->params(), rng_engine));
+    return [function, arg_set]() -> absl::Status {
+      for (const std::vector<Value>& args : *arg_set) {
+        XLS_RETURN_IF_ERROR(InterpretFunction(function, args).status());
+      }
+      return absl::OkStatus();
+    };
+  };
+  return RecordEvaluatorResult(description, "function", "interpreter",
+                               "calls", /*compile_time=*/std::nullopt,
+                               make_interpreter_batch, batch_size, results);
 }
 
 template <typename Rng>
-absl::Status RunBlockInterpreterAndJit(Block* block,
-                                       std::string_view description,
-                                       Rng& rng_engine) {
+absl::Status RunBlockInterpreterAndJit(
+    Block* block, std::string_view description, Rng& rng_engine,
+    std::vector<EvaluatorBenchmarkResult>& results) {
   absl::Time start_jit_compile = absl::Now();
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitRuntime> runtime,
                        JitRuntime::Create());
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<BlockJit> jit,
                        BlockJit::Create(block, runtime.get()));
-  std::cout << absl::StreamFormat(
-      "JIT compile time (%s): %dms\n", description,
-      DurationToMs(absl::Now() - start_jit_compile));
-
-  const int64_t kInputCount = 100;
-  std::vector<std::vector<Value>> arg_set =
-      GetRandomParams(block, kInputCount, block->GetInputPorts(), rng_engine);
-  std::vector<absl::flat_hash_map<std::string, Value>> port_set;
-  port_set.reserve(arg_set.size());
-  absl::c_transform(arg_set, std::back_inserter(port_set),
-                    [&](const std::vector<Value>& ports) {
-                      absl::flat_hash_map<std::string, Value> out;
-                      out.reserve(ports.size());
-                      for (int i = 0; i < ports.size(); ++i) {
-                        out[block->GetInputPorts()[i]->name()] = ports[i];
-                      }
-                      return out;
-                    });
-
-  // To avoid being dominated by xls::Value conversion to native
-  // format, preconvert the arguments.
+  absl::Duration compile_time = absl::Now() - start_jit_compile;
+
+  const int64_t batch_size = absl::GetFlag(FLAGS_evaluator_batch_size);
   std::vector<Type*> input_types;
   input_types.reserve(block->GetInputPorts().size());
   absl::c_transform(block->GetInputPorts(), std::back_inserter(input_types),
                     [](InputPort* v) { return v->GetType(); });
-  XLS_ASSIGN_OR_RETURN(auto jit_args, ConvertToJitArguments(
-                                          arg_set, input_types, runtime.get()));
-  auto [jit_arg_buffers, jit_arg_pointers] = std::move(jit_args);
-
-  // The JIT is much faster so run many times.
-  auto jit_continuation = jit->NewContinuation();
-  XLS_ASSIGN_OR_RETURN(
-      float jit_run_rate,
-      CountRate(
-          [&]() -> absl::Status {
-            for (int64_t i = 0; i < kJitRunMultiplier; ++i) {
-              for (const std::vector<uint8_t*>& pointers : jit_arg_pointers) {
-                CHECK_OK(jit_continuation->SetInputPorts(pointers));
-                CHECK_OK(jit->RunOneCycle(*jit_continuation));
-              }
-            }
-            return absl::OkStatus();
-          },
-          kRunDurationMs));
-  std::cout << absl::StreamFormat(
-      "JIT run time (%s): %d Kcalls/s\n", description,
-      static_cast<int64_t>(kInputCount * jit_run_rate));
 
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<BlockContinuation> continuation,
-                       kInterpreterBlockEvaluator.NewContinuation(block));
-  XLS_ASSIGN_OR_RETURN(
-      float interpreter_run_rate,
-      CountRate(
-          [&]() -> absl::Status {
-            for (const absl::flat_hash_map<std::string, Value>& ports :
-                 port_set) {
-              CHECK_OK(continuation->RunOneCycle(ports));
-            }
-            return absl::OkStatus();
-          },
-          kRunDurationMs));
-  std::cout << absl::StreamFormat(
-      "Interpreter run time (%s): %d calls/s\n", description,
-      static_cast<int64_t>(kInputCount * interpreter_run_rate));
-  return absl::OkStatus();
+  // Each thread runs its own continuation of the shared compiled block.
+  auto make_jit_batch = [&]() -> absl::StatusOr<BatchFn> {
+    std::vector<std::vector<Value>> arg_set =
+        GetRandomParams(block, batch_size, block->GetInputPorts(), rng_engine);
+    XLS_ASSIGN_OR_RETURN(JitArguments jit_args,
+                         ConvertToJitArguments(arg_set, input_types,
+                                               runtime.get()));
+    auto args = std::make_shared<JitArguments>(std::move(jit_args));
+    std::shared_ptr<BlockJitContinuation> continuation =
+        jit->NewContinuation();
+    return [jit = jit.get(), args, continuation]() -> absl::Status {
+      for (const std::vector<uint8_t*>& pointers : args->arg_pointers) {
+        XLS_RETURN_IF_ERROR(continuation->SetInputPorts(pointers));
+        XLS_RETURN_IF_ERROR(jit->RunOneCycle(*continuation));
+      }
+      return absl::OkStatus();
+    };
+  };
+  XLS_RETURN_IF_ERROR(RecordEvaluatorResult(description, "block", "jit",
+                                            "cycles", compile_time,
+                                            make_jit_batch, batch_size,
+                                            results));
+
+  auto make_interpreter_batch = [&]() -> absl::StatusOr<BatchFn> {
+    std::vector<std::vector<Value>> arg_set =
+        GetRandomParams(block, batch_size, block->GetInputPorts(), rng_engine);
+    using PortValues = absl::flat_hash_map<std::string, Value>;
+    auto port_set = std::make_shared<std::vector<PortValues>>();
+    port_set->reserve(arg_set.size());
+    absl::c_transform(arg_set, std::back_inserter(*port_set),
+                      [&](const std::vector<Value>& ports) {
+                        absl::flat_hash_map<std::string, Value> out;
+                        out.reserve(ports.size());
+                        for (int i = 0; i < ports.size(); ++i) {
+                          out[block->GetInputPorts()[i]->name()] = ports[i];
+                        }
+                        return out;
+                      });
+    XLS_ASSIGN_OR_RETURN(std::shared_ptr<BlockContinuation> continuation,
+                         kInterpreterBlockEvaluator.NewContinuation(block));
+    return [port_set, continuation]() -> absl::Status {
+      for (const PortValues& ports : *port_set) {
+        XLS_RETURN_IF_ERROR(continuation->RunOneCycle(ports));
+      }
+      return absl::OkStatus();
+    };
+  };
+  return RecordEvaluatorResult(description, "block", "interpreter", "cycles",
+                               /*compile_time=*/std::nullopt,
+                               make_interpreter_batch, batch_size, results);
 }
 
+// Returns a function which ticks the proc network in `runtime` `batch_size`
+// times. Receive-only channels are fed with random values generated up front
+// and send-only channels are drained after every batch so the queues stay
+// small.
 template <typename Rng>
-absl::Status RunProcInterpreterAndJit(Proc* proc, std::string_view description,
-                                      Rng& rng_engine) {
-  absl::Time start_jit_compile = absl::Now();
-  XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<JitChannelQueueManager> queue_manager,
-      JitChannelQueueManager::CreateThreadSafe(proc->package()));
-  XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<ProcJit> jit,
-      ProcJit::Create(proc, &queue_manager->runtime(), queue_manager.get()));
-  std::cout << absl::StreamFormat(
-      "JIT compile time (%s): %dms\n", description,
-      DurationToMs(absl::Now() - start_jit_compile));
-  // TODO(meheff): 2022/5/16 Run the proc as well.
+absl::StatusOr<BatchFn> MakeProcBatch(
+    std::shared_ptr<SerialProcRuntime> runtime, int64_t batch_size,
+    Rng& rng_engine) {
+  std::vector<ChannelQueue*> output_queues;
+  for (ChannelQueue* queue : runtime->queue_manager().queues()) {
+    Channel* channel = queue->channel();
+    if (channel->supported_ops() == ChannelOps::kSendOnly) {
+      output_queues.push_back(queue);
+      continue;
+    }
+    if (channel->supported_ops() != ChannelOps::kReceiveOnly) {
+      continue;
+    }
+    if (channel->kind() == ChannelKind::kSingleValue) {
+      XLS_RETURN_IF_ERROR(
+          queue->Write(RandomValue(channel->type(), rng_engine)));
+      continue;
+    }
+    auto values = std::make_shared<std::vector<Value>>();
+    values->reserve(batch_size);
+    for (int64_t i = 0; i < batch_size; ++i) {
+      values->push_back(RandomValue(channel->type(), rng_engine));
+    }
+    auto next = std::make_shared<int64_t>(0);
+    XLS_RETURN_IF_ERROR(
+        queue->AttachGenerator([values, next]() -> std::optional<Value> {
+          const Value& value = (*values)[*next];
+          *next = (*next + 1) % values->size();
+          return value;
+        }));
+  }
+  return [runtime, output_queues, batch_size]() -> absl::Status {
+    for (int64_t i = 0; i < batch_size; ++i) {
+      XLS_RETURN_IF_ERROR(runtime->Tick());
+    }
+    for (ChannelQueue* queue : output_queues) {
+      while (queue->Read().has_value()) {
+      }
+    }
+    runtime->ClearInterpreterEvents();
+    return absl::OkStatus();
+  };
+}
 
-  return absl::OkStatus();
+template <typename Rng>
+absl::Status RunProcInterpreterAndJit(
+    Proc* proc, std::string_view description, Rng& rng_engine,
+    std::vector<EvaluatorBenchmarkResult>& results) {
+  const int64_t batch_size = absl::GetFlag(FLAGS_evaluator_batch_size);
+
+  // Proc runtimes hold the network state so each thread compiles its own. The
+  // compile time reported is that of the first.
+  std::optional<absl::Duration> compile_time;
+  auto make_jit_batch = [&]() -> absl::StatusOr<BatchFn> {
+    absl::Time start_jit_compile = absl::Now();
+    XLS_ASSIGN_OR_RETURN(std::shared_ptr<SerialProcRuntime> runtime,
+                         proc->is_new_style_proc()
+                             ? CreateJitSerialProcRuntime(proc)
+                             : CreateJitSerialProcRuntime(proc->package()));
+    if (!compile_time.has_value()) {
+      compile_time = absl::Now() - start_jit_compile;
+    }
+    return MakeProcBatch(std::move(runtime), batch_size, rng_engine);
+  };
+  XLS_RETURN_IF_ERROR(RecordEvaluatorResult(description, "proc", "jit",
+                                            "ticks", compile_time,
+                                            make_jit_batch, batch_size,
+                                            results));
+
+  auto make_interpreter_batch = [&]() -> absl::StatusOr<BatchFn> {
+    XLS_ASSIGN_OR_RETURN(
+        std::shared_ptr<SerialProcRuntime> runtime,
+        proc->is_new_style_proc()
+            ? CreateInterpreterSerialProcRuntime(proc)
+            : CreateInterpreterSerialProcRuntime(proc->package()));
+    return MakeProcBatch(std::move(runtime), batch_size, rng_engine);
+  };
+  return RecordEvaluatorResult(description, "proc", "interpreter", "ticks",
+                               /*compile_time=*/std::nullopt,
+                               make_interpreter_batch, batch_size, results);
 }
 
-absl::Status RunInterpreterAndJit(FunctionBase* function_base,
-                                  std::string_view description) {
+absl::Status RunInterpreterAndJit(
+    FunctionBase* function_base, std::string_view description,
+    std::vector<EvaluatorBenchmarkResult>& results) {
+  if (absl::GetFlag(FLAGS_evaluator_batch_size) <= 0) {
+    return absl::InvalidArgumentError(
+        "--evaluator_batch_size must be positive");
+  }
   std::minstd_rand rng_engine;
   if (function_base->IsFunction()) {
     Function* function = function_base->AsFunctionOrDie();
-    return RunFunctionInterpreterAndJit(function, description, rng_engine);
+    return RunFunctionInterpreterAndJit(function, description, rng_engine,
+                                        results);
   }
 
   if (function_base->IsBlock()) {
     Block* block = function_base->AsBlockOrDie();
-    return RunBlockInterpreterAndJit(block, description, rng_engine);
+    return RunBlockInterpreterAndJit(block, description, rng_engine, results);
   }
 
   XLS_RET_CHECK(function_base->IsProc());
   Proc* proc = function_base->AsProcOrDie();
-  return RunProcInterpreterAndJit(proc, description, rng_engine);
+  // A proc network may not be able to run on random inputs (e.g., it
+  // deadlocks), which should not prevent the rest of the benchmark.
+  absl::Status status =
+      RunProcInterpreterAndJit(proc, description, rng_engine, results);
+  if (!status.ok()) {
+    LOG(WARNING) << absl::StreamFormat("Unable to run proc %s (%s): %s",
+                                       proc->name(), description,
+                                       status.ToString());
+  }
+  return absl::OkStatus();
 }
 
+
 absl::Status RealMain(std::string_view path) {
   VLOG(1) << "Reading contents at path: " << path;
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+  XLS_ASSIGN_OR_RETURN(MappedFile ir_file, MappedFile::Open(path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                       Parser::ParsePackage(contents));
+                       Parser::ParsePackage(ir_file.contents()));
 
   XLS_ASSIGN_OR_RETURN(CodegenFlagsProto codegen_flags_proto,
                        GetCodegenFlags());
@@ -734,9 +1035,11 @@ absl::Status RealMain(std::string_view path) {
     return absl::InternalError(absl::StrFormat(
         "Top entity not set for package: %s.", package->name()));
   }
+  std::vector<EvaluatorBenchmarkResult> evaluator_results;
   if (absl::GetFlag(FLAGS_run_evaluators)) {
     XLS_RETURN_IF_ERROR(
-        RunInterpreterAndJit(package->GetTop().value(), "unoptimized"));
+        RunInterpreterAndJit(package->GetTop().value(), "unoptimized",
+                             evaluator_results));
   }
   XLS_RETURN_IF_ERROR(RunOptimizationAndPrintStats(package.get()));
 
@@ -781,7 +1084,8 @@ absl::Status RealMain(std::string_view path) {
             parameters.name(), parameters));
   }
   if (absl::GetFlag(FLAGS_run_evaluators)) {
-    XLS_RETURN_IF_ERROR(RunInterpreterAndJit(f, "optimized"));
+    XLS_RETURN_IF_ERROR(
+        RunInterpreterAndJit(f, "optimized", evaluator_results));
   }
   const bool benchmark_codegen =
       scheduling_options_flags_proto.clock_period_ps() > 0 ||
@@ -833,8 +1137,14 @@ absl::Status RealMain(std::string_view path) {
     // bdd.
     BddQueryEngine sched_qe(BddFunction::kDefaultPathLimit);
     XLS_RETURN_IF_ERROR(sched_qe.Populate(f).status());
+    const AreaEstimator* area_estimator = nullptr;
+    if (!scheduling_options_flags_proto.area_model().empty()) {
+      XLS_ASSIGN_OR_RETURN(
+          area_estimator,
+          GetAreaEstimator(scheduling_options_flags_proto.area_model()));
+    }
     XLS_RETURN_IF_ERROR(PrintScheduleInfo(
-        f, schedules, sched_qe, delay_estimator,
+        f, schedules, sched_qe, delay_estimator, area_estimator,
         scheduling_options_flags_proto.has_clock_period_ps()
             ? std::make_optional(
                   scheduling_options_flags_proto.clock_period_ps())
@@ -846,10 +1156,16 @@ absl::Status RealMain(std::string_view path) {
     }
     if (absl::GetFlag(FLAGS_run_evaluators)) {
       XLS_RETURN_IF_ERROR(
-          RunInterpreterAndJit(package->blocks()[0].get(), "block"));
+          RunInterpreterAndJit(package->blocks()[0].get(), "block",
+                               evaluator_results));
     }
   }
 
+  if (absl::GetFlag(FLAGS_evaluator_benchmark_json).has_value()) {
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(*absl::GetFlag(FLAGS_evaluator_benchmark_json),
+                        EvaluatorResultsToJson(evaluator_results)));
+  }
   return absl::OkStatus();
 }
 
@@ -0,0 +1,372 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/bit_sliced_evaluator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
+#include "absl/numeric/bits.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/codegen/flattening.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+
+namespace xls {
+namespace {
+
+// Returns the index of the array element selected by `index`, clamped to the
+// last element as in the IR semantics of array_index.
+int64_t ClampedIndex(const Bits& index, int64_t size) {
+  if (!index.FitsInUint64() || index.ToUint64().value() >= size) {
+    return size - 1;
+  }
+  return static_cast<int64_t>(index.ToUint64().value());
+}
+
+}  // namespace
+
+absl::StatusOr<BitSlicedEvaluator> BitSlicedEvaluator::Create(Function* f) {
+  BitSlicedEvaluator evaluator;
+  // The slot holding each flattened bit of each node, least significant first.
+  absl::flat_hash_map<Node*, std::vector<int64_t>> node_slots;
+  for (Param* param : f->params()) {
+    evaluator.param_types_.push_back(param->GetType());
+    std::vector<int64_t>& slots = node_slots[param];
+    for (int64_t i = 0; i < param->GetType()->GetFlatBitCount(); ++i) {
+      slots.push_back(kFirstInputSlot + evaluator.input_bit_count_++);
+    }
+  }
+  evaluator.return_type_ = f->return_value()->GetType();
+  evaluator.slot_count_ = kFirstInputSlot + evaluator.input_bit_count_;
+
+  auto emit = [&](Opcode opcode, int64_t lhs, int64_t rhs) {
+    int64_t dst = evaluator.slot_count_++;
+    evaluator.instructions_.push_back(
+        Instruction{.opcode = opcode, .dst = dst, .lhs = lhs, .rhs = rhs});
+    return dst;
+  };
+  for (Node* node : TopoSort(f)) {
+    if (node->Is<Param>()) {
+      continue;
+    }
+    std::vector<int64_t> slots;
+    slots.reserve(node->GetType()->GetFlatBitCount());
+    auto operand_slots = [&](int64_t i) -> const std::vector<int64_t>& {
+      return node_slots.at(node->operand(i));
+    };
+    auto append = [&](absl::Span<const int64_t> bits) {
+      slots.insert(slots.end(), bits.begin(), bits.end());
+    };
+    switch (node->op()) {
+      case Op::kLiteral: {
+        Bits bits = FlattenValueToBits(node->As<Literal>()->value());
+        for (int64_t i = 0; i < bits.bit_count(); ++i) {
+          slots.push_back(bits.Get(i) ? kOneSlot : kZeroSlot);
+        }
+        break;
+      }
+      case Op::kIdentity:
+        append(operand_slots(0));
+        break;
+      case Op::kBitSlice:
+        append(absl::MakeConstSpan(operand_slots(0))
+                   .subspan(node->As<BitSlice>()->start(),
+                            node->As<BitSlice>()->width()));
+        break;
+      case Op::kTupleIndex: {
+        Node* tuple = node->operand(0);
+        int64_t start = GetFlatBitIndexOfElement(
+            tuple->GetType()->AsTupleOrDie(), node->As<TupleIndex>()->index());
+        append(absl::MakeConstSpan(operand_slots(0))
+                   .subspan(start, node->GetType()->GetFlatBitCount()));
+        break;
+      }
+      case Op::kArrayIndex: {
+        ArrayIndex* array_index = node->As<ArrayIndex>();
+        Type* type = array_index->array()->GetType();
+        int64_t start = 0;
+        for (Node* index : array_index->indices()) {
+          if (!index->Is<Literal>()) {
+            return absl::UnimplementedError(absl::StrFormat(
+                "Array index %s has a non-literal index; the function is not "
+                "booleanified",
+                node->GetName()));
+          }
+          ArrayType* array_type = type->AsArrayOrDie();
+          start += GetFlatBitIndexOfElement(
+              array_type, ClampedIndex(index->As<Literal>()->value().bits(),
+                                       array_type->size()));
+          type = array_type->element_type();
+        }
+        append(absl::MakeConstSpan(operand_slots(0))
+                   .subspan(start, type->GetFlatBitCount()));
+        break;
+      }
+      case Op::kConcat:
+        // Operand zero holds the most significant bits.
+        for (int64_t i = node->operand_count() - 1; i >= 0; --i) {
+          append(operand_slots(i));
+        }
+        break;
+      case Op::kTuple:
+      case Op::kArray: {
+        slots.resize(node->GetType()->GetFlatBitCount());
+        for (int64_t i = 0; i < node->operand_count(); ++i) {
+          int64_t start =
+              node->GetType()->IsTuple()
+                  ? GetFlatBitIndexOfElement(node->GetType()->AsTupleOrDie(),
+                                             i)
+                  : GetFlatBitIndexOfElement(node->GetType()->AsArrayOrDie(),
+                                             i);
+          absl::c_copy(operand_slots(i), slots.begin() + start);
+        }
+        break;
+      }
+      case Op::kNot:
+        for (int64_t bit : operand_slots(0)) {
+          slots.push_back(emit(Opcode::kNot, bit, bit));
+        }
+        break;
+      case Op::kAnd:
+      case Op::kOr:
+      case Op::kXor:
+      case Op::kNand:
+      case Op::kNor: {
+        Opcode opcode = Opcode::kOr;
+        if (node->op() == Op::kXor) {
+          opcode = Opcode::kXor;
+        } else if (node->op() == Op::kAnd || node->op() == Op::kNand) {
+          opcode = Opcode::kAnd;
+        }
+        bool invert = node->op() == Op::kNand || node->op() == Op::kNor;
+        for (int64_t b = 0; b < node->BitCountOrDie(); ++b) {
+          int64_t result = operand_slots(0)[b];
+          for (int64_t i = 1; i < node->operand_count(); ++i) {
+            result = emit(opcode, result, operand_slots(i)[b]);
+          }
+          slots.push_back(invert ? emit(Opcode::kNot, result, result) : result);
+        }
+        break;
+      }
+      default:
+        return absl::UnimplementedError(absl::StrFormat(
+            "Node %s has op %s; the function is not booleanified",
+            node->GetName(), OpToString(node->op())));
+    }
+    XLS_RET_CHECK_EQ(slots.size(), node->GetType()->GetFlatBitCount())
+        << node->GetName();
+    node_slots[node] = std::move(slots);
+  }
+  evaluator.output_slots_ = std::move(node_slots.at(f->return_value()));
+  return evaluator;
+}
+
+void BitSlicedEvaluator::RunBatch(absl::Span<const uint64_t> inputs,
+                                  absl::Span<uint64_t> outputs) const {
+  CHECK_EQ(inputs.size(), input_bit_count_ * kWordsPerBatch);
+  CHECK_EQ(outputs.size(), output_bit_count() * kWordsPerBatch);
+  std::vector<uint64_t> words(slot_count_ * kWordsPerBatch, 0);
+  auto slot = [&](int64_t s) { return words.data() + s * kWordsPerBatch; };
+  std::fill_n(slot(kOneSlot), kWordsPerBatch, ~uint64_t{0});
+  absl::c_copy(inputs, slot(kFirstInputSlot));
+  // The fixed trip count of the inner loops lets the compiler turn each of
+  // them into a few SIMD instructions.
+  for (const Instruction& instruction : instructions_) {
+    uint64_t* dst = slot(instruction.dst);
+    const uint64_t* lhs = slot(instruction.lhs);
+    const uint64_t* rhs = slot(instruction.rhs);
+    switch (instruction.opcode) {
+      case Opcode::kAnd:
+        for (int64_t w = 0; w < kWordsPerBatch; ++w) {
+          dst[w] = lhs[w] & rhs[w];
+        }
+        break;
+      case Opcode::kOr:
+        for (int64_t w = 0; w < kWordsPerBatch; ++w) {
+          dst[w] = lhs[w] | rhs[w];
+        }
+        break;
+      case Opcode::kXor:
+        for (int64_t w = 0; w < kWordsPerBatch; ++w) {
+          dst[w] = lhs[w] ^ rhs[w];
+        }
+        break;
+      case Opcode::kNot:
+        for (int64_t w = 0; w < kWordsPerBatch; ++w) {
+          dst[w] = ~lhs[w];
+        }
+        break;
+    }
+  }
+  for (int64_t i = 0; i < output_slots_.size(); ++i) {
+    std::copy_n(slot(output_slots_[i]), kWordsPerBatch,
+                outputs.begin() + i * kWordsPerBatch);
+  }
+}
+
+absl::StatusOr<std::vector<Value>> BitSlicedEvaluator::Run(
+    absl::Span<const std::vector<Value>> args) const {
+  std::vector<Value> results;
+  results.reserve(args.size());
+  std::vector<uint64_t> inputs(input_bit_count_ * kWordsPerBatch);
+  std::vector<uint64_t> outputs(output_bit_count() * kWordsPerBatch);
+  for (int64_t base = 0; base < args.size(); base += kVectorsPerBatch) {
+    int64_t count = std::min<int64_t>(kVectorsPerBatch, args.size() - base);
+    absl::c_fill(inputs, 0);
+    for (int64_t v = 0; v < count; ++v) {
+      absl::Span<const Value> vector_args = args[base + v];
+      XLS_RET_CHECK_EQ(vector_args.size(), param_types_.size());
+      int64_t input_bit = 0;
+      for (int64_t p = 0; p < param_types_.size(); ++p) {
+        XLS_RET_CHECK(ValueConformsToType(vector_args[p], param_types_[p]))
+            << vector_args[p] << " is not of type "
+            << param_types_[p]->ToString();
+        Bits bits = FlattenValueToBits(vector_args[p]);
+        for (int64_t i = 0; i < bits.bit_count(); ++i, ++input_bit) {
+          inputs[input_bit * kWordsPerBatch + v / 64] |=
+              uint64_t{bits.Get(i)} << (v % 64);
+        }
+      }
+    }
+    RunBatch(inputs, absl::MakeSpan(outputs));
+    for (int64_t v = 0; v < count; ++v) {
+      InlineBitmap bitmap(output_bit_count());
+      for (int64_t i = 0; i < output_bit_count(); ++i) {
+        bitmap.Set(i, (outputs[i * kWordsPerBatch + v / 64] >> (v % 64)) & 1);
+      }
+      XLS_ASSIGN_OR_RETURN(
+          Value result,
+          UnflattenBitsToValue(Bits::FromBitmap(std::move(bitmap)),
+                               return_type_));
+      results.push_back(std::move(result));
+    }
+  }
+  return results;
+}
+
+namespace {
+
+// The truth table of each of the first six variables: bit `m` of
+// kVariableMasks[i] is bit `i` of `m`.
+constexpr uint64_t kVariableMasks[] = {
+    0xaaaaaaaaaaaaaaaa, 0xcccccccccccccccc, 0xf0f0f0f0f0f0f0f0,
+    0xff00ff00ff00ff00, 0xffff0000ffff0000, 0xffffffff00000000};
+
+// Returns the word of input bit `bit` in batch `batch` of an exhaustive
+// enumeration, where vector `v` of the batch is the input
+// `batch * kVectorsPerBatch + v`.
+uint64_t ExhaustiveInputWord(int64_t bit, int64_t batch, int64_t word) {
+  constexpr int64_t kWordBits = 6;
+  constexpr int64_t kBatchBits = 9;
+  static_assert(BitSlicedEvaluator::kVectorsPerBatch ==
+                (int64_t{1} << kBatchBits));
+  if (bit < kWordBits) {
+    return kVariableMasks[bit];
+  }
+  bool set = bit < kBatchBits ? (word >> (bit - kWordBits)) & 1
+                              : (batch >> (bit - kBatchBits)) & 1;
+  return set ? ~uint64_t{0} : uint64_t{0};
+}
+
+}  // namespace
+
+absl::StatusOr<std::optional<std::vector<Value>>>
+FindCounterexampleExhaustively(Function* a, Function* b,
+                               int64_t max_input_bits) {
+  XLS_RET_CHECK(a->GetType()->IsEqualTo(b->GetType()))
+      << a->name() << " and " << b->name() << " have different types";
+  XLS_ASSIGN_OR_RETURN(BitSlicedEvaluator a_evaluator,
+                       BitSlicedEvaluator::Create(a));
+  XLS_ASSIGN_OR_RETURN(BitSlicedEvaluator b_evaluator,
+                       BitSlicedEvaluator::Create(b));
+  int64_t input_bits = a_evaluator.input_bit_count();
+  XLS_RET_CHECK_LT(max_input_bits, 63);
+  if (input_bits > max_input_bits) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "%s has %d input bits; at most %d can be enumerated", a->name(),
+        input_bits, max_input_bits));
+  }
+
+  constexpr int64_t kWords = BitSlicedEvaluator::kWordsPerBatch;
+  int64_t input_count = int64_t{1} << input_bits;
+  int64_t batch_count =
+      std::max<int64_t>(input_count / BitSlicedEvaluator::kVectorsPerBatch, 1);
+  std::vector<uint64_t> inputs(input_bits * kWords);
+  std::vector<uint64_t> a_outputs(a_evaluator.output_bit_count() * kWords);
+  std::vector<uint64_t> b_outputs(b_evaluator.output_bit_count() * kWords);
+  for (int64_t batch = 0; batch < batch_count; ++batch) {
+    for (int64_t bit = 0; bit < input_bits; ++bit) {
+      for (int64_t w = 0; w < kWords; ++w) {
+        inputs[bit * kWords + w] = ExhaustiveInputWord(bit, batch, w);
+      }
+    }
+    a_evaluator.RunBatch(inputs, absl::MakeSpan(a_outputs));
+    b_evaluator.RunBatch(inputs, absl::MakeSpan(b_outputs));
+    for (int64_t w = 0; w < kWords; ++w) {
+      uint64_t differ = 0;
+      for (int64_t i = 0; i < a_evaluator.output_bit_count(); ++i) {
+        differ |= a_outputs[i * kWords + w] ^ b_outputs[i * kWords + w];
+      }
+      // Small inputs repeat across the batch; only the first `input_count`
+      // vectors are distinct.
+      int64_t vector_base =
+          batch * BitSlicedEvaluator::kVectorsPerBatch + w * 64;
+      if (vector_base >= input_count) {
+        break;
+      }
+      if (input_count - vector_base < 64) {
+        differ &= (uint64_t{1} << (input_count - vector_base)) - 1;
+      }
+      if (differ == 0) {
+        continue;
+      }
+      Bits input = UBits(vector_base + absl::countr_zero(differ), input_bits);
+      std::vector<Value> counterexample;
+      int64_t offset = 0;
+      for (Param* param : a->params()) {
+        int64_t width = param->GetType()->GetFlatBitCount();
+        XLS_ASSIGN_OR_RETURN(
+            Value value, UnflattenBitsToValue(input.Slice(offset, width),
+                                              param->GetType()));
+        counterexample.push_back(std::move(value));
+        offset += width;
+      }
+      return counterexample;
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace xls
@@ -0,0 +1,105 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_TOOLS_BIT_SLICED_EVALUATOR_H_
+#define XLS_TOOLS_BIT_SLICED_EVALUATOR_H_
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/function.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// Evaluates a booleanified function (see Booleanifier) on many input vectors
+// at once. The function is compiled into a straight-line list of bitwise
+// operations on machine words where each bit of a word holds the value of one
+// bit of the function for a different input vector ("bit slicing"). A batch
+// is kWordsPerBatch words wide per bit so the inner loops vectorize to SIMD
+// instructions on targets which have them.
+//
+// Values are mapped to bits as in codegen (see codegen/flattening.h): input
+// bit `i` is bit `i` of the concatenation of the flattened parameters, with
+// the first parameter in the lowest bits.
+class BitSlicedEvaluator {
+ public:
+  static constexpr int64_t kWordsPerBatch = 8;
+  static constexpr int64_t kVectorsPerBatch = 64 * kWordsPerBatch;
+
+  // Compiles `f`, which must contain only the operations produced by the
+  // Booleanifier: bitwise and/or/not/xor, literals, and bit slices, tuple
+  // indices, literal array indices, concats, arrays and tuples which only
+  // rearrange bits.
+  static absl::StatusOr<BitSlicedEvaluator> Create(Function* f);
+
+  int64_t input_bit_count() const { return input_bit_count_; }
+  int64_t output_bit_count() const { return output_slots_.size(); }
+
+  // Evaluates one batch of kVectorsPerBatch input vectors. `inputs` holds
+  // kWordsPerBatch words for each input bit: bit `j` of word
+  // `inputs[i * kWordsPerBatch + w]` is input bit `i` of vector `64 * w + j`.
+  // `outputs` receives the output bits in the same layout.
+  void RunBatch(absl::Span<const uint64_t> inputs,
+                absl::Span<uint64_t> outputs) const;
+
+  // Evaluates the function on each of `args`, one set of parameter values per
+  // element, and returns the result for each.
+  absl::StatusOr<std::vector<Value>> Run(
+      absl::Span<const std::vector<Value>> args) const;
+
+ private:
+  enum class Opcode : uint8_t { kAnd, kOr, kXor, kNot };
+
+  // Sets `slots[dst]` to the given operation applied to `slots[lhs]` and, for
+  // binary operations, `slots[rhs]`.
+  struct Instruction {
+    Opcode opcode;
+    int64_t dst;
+    int64_t lhs;
+    int64_t rhs;
+  };
+
+  // Slots holding constant zero and constant one.
+  static constexpr int64_t kZeroSlot = 0;
+  static constexpr int64_t kOneSlot = 1;
+  // The slot of input bit 0; the input bits occupy consecutive slots.
+  static constexpr int64_t kFirstInputSlot = 2;
+
+  BitSlicedEvaluator() = default;
+
+  std::vector<Type*> param_types_;
+  Type* return_type_ = nullptr;
+  int64_t input_bit_count_ = 0;
+  int64_t slot_count_ = kFirstInputSlot;
+  std::vector<Instruction> instructions_;
+  std::vector<int64_t> output_slots_;
+};
+
+// Evaluates the booleanified functions `a` and `b` on every possible input and
+// returns an input on which they differ (one value per parameter), or
+// std::nullopt if they are equivalent. Both must have the same parameter and
+// return types and at most `max_input_bits` input bits.
+absl::StatusOr<std::optional<std::vector<Value>>>
+FindCounterexampleExhaustively(Function* a, Function* b,
+                               int64_t max_input_bits = 32);
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_BIT_SLICED_EVALUATOR_H_
@@ -0,0 +1,205 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/bit_sliced_evaluator.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "benchmark/benchmark.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/tools/booleanifier.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+class BitSlicedEvaluatorTest : public IrTestBase {
+ protected:
+  // Checks that the bit-sliced evaluation of the booleanified `f` matches the
+  // interpreter on `count` random inputs.
+  void ExpectMatchesInterpreter(Function* f, int64_t count) {
+    XLS_ASSERT_OK_AND_ASSIGN(Function * boolified,
+                             Booleanifier::Booleanify(f));
+    XLS_ASSERT_OK_AND_ASSIGN(BitSlicedEvaluator evaluator,
+                             BitSlicedEvaluator::Create(boolified));
+    std::minstd_rand rng(0);
+    std::vector<std::vector<Value>> args(count);
+    for (std::vector<Value>& vector_args : args) {
+      for (Param* param : f->params()) {
+        vector_args.push_back(RandomValue(param->GetType(), rng));
+      }
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(std::vector<Value> results, evaluator.Run(args));
+    ASSERT_EQ(results.size(), count);
+    for (int64_t i = 0; i < count; ++i) {
+      XLS_ASSERT_OK_AND_ASSIGN(
+          Value expected, DropInterpreterEvents(InterpretFunction(f, args[i])));
+      EXPECT_EQ(results[i], expected) << "input " << i;
+    }
+  }
+};
+
+TEST_F(BitSlicedEvaluatorTest, Arithmetic) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package p
+
+fn f(x: bits[16], y: bits[16]) -> bits[16] {
+  add.1: bits[16] = add(x, y)
+  umul.2: bits[16] = umul(x, y)
+  ret sub.3: bits[16] = sub(add.1, umul.2)
+}
+)"));
+  // More than one batch, with a partial last batch.
+  ExpectMatchesInterpreter(FindFunction("f", p.get()),
+                           BitSlicedEvaluator::kVectorsPerBatch * 2 + 17);
+}
+
+TEST_F(BitSlicedEvaluatorTest, AggregateParamsAndResults) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package p
+
+fn f(a: (bits[3], bits[5][2]), b: bits[4]) -> (bits[5], bits[3][2]) {
+  tuple_index.1: bits[3] = tuple_index(a, index=0)
+  tuple_index.2: bits[5][2] = tuple_index(a, index=1)
+  array_index.3: bits[5] = array_index(tuple_index.2, indices=[b])
+  bit_slice.4: bits[3] = bit_slice(b, start=1, width=3)
+  array.5: bits[3][2] = array(tuple_index.1, bit_slice.4)
+  ret tuple.6: (bits[5], bits[3][2]) = tuple(array_index.3, array.5)
+}
+)"));
+  ExpectMatchesInterpreter(FindFunction("f", p.get()), 100);
+}
+
+TEST_F(BitSlicedEvaluatorTest, RejectsNonBooleanFunctions) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package p
+
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  ret add.1: bits[8] = add(x, y)
+}
+)"));
+  EXPECT_THAT(BitSlicedEvaluator::Create(FindFunction("f", p.get())),
+              StatusIs(absl::StatusCode::kUnimplemented,
+                       HasSubstr("not booleanified")));
+}
+
+TEST_F(BitSlicedEvaluatorTest, ExhaustiveEquivalence) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package p
+
+fn add(x: bits[8], y: bits[4]) -> bits[8] {
+  zero_ext.1: bits[8] = zero_ext(y, new_bit_count=8)
+  ret add.2: bits[8] = add(x, zero_ext.1)
+}
+
+fn add_commuted(x: bits[8], y: bits[4]) -> bits[8] {
+  zero_ext.3: bits[8] = zero_ext(y, new_bit_count=8)
+  ret add.4: bits[8] = add(zero_ext.3, x)
+}
+
+fn add_wrong(x: bits[8], y: bits[4]) -> bits[8] {
+  zero_ext.5: bits[8] = zero_ext(y, new_bit_count=8)
+  literal.6: bits[8] = literal(value=0xa7)
+  eq.7: bits[1] = eq(x, literal.6)
+  add.8: bits[8] = add(x, zero_ext.5)
+  ret sel.9: bits[8] = sel(eq.7, cases=[add.8, literal.6])
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * add, Booleanifier::Booleanify(FindFunction("add", p.get())));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * add_commuted,
+      Booleanifier::Booleanify(FindFunction("add_commuted", p.get())));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * add_wrong,
+      Booleanifier::Booleanify(FindFunction("add_wrong", p.get())));
+
+  EXPECT_THAT(FindCounterexampleExhaustively(add, add_commuted),
+              IsOkAndHolds(std::nullopt));
+
+  // The functions only differ when x is 0xa7 and y is non-zero.
+  XLS_ASSERT_OK_AND_ASSIGN(std::optional<std::vector<Value>> counterexample,
+                           FindCounterexampleExhaustively(add, add_wrong));
+  ASSERT_TRUE(counterexample.has_value());
+  EXPECT_EQ(counterexample->at(0), Value(UBits(0xa7, 8)));
+  EXPECT_EQ(counterexample->at(1), Value(UBits(1, 4)));
+
+  EXPECT_THAT(FindCounterexampleExhaustively(add, add_wrong,
+                                             /*max_input_bits=*/8),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("12 input bits")));
+}
+
+void BM_RunBatch(benchmark::State& state) {
+  Package p("benchmark");
+  absl::StatusOr<Function*> f = Parser::ParseFunction(
+      R"(
+fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  umul.1: bits[32] = umul(x, y)
+  ret add.2: bits[32] = add(umul.1, x)
+}
+)",
+      &p);
+  CHECK_OK(f.status());
+  absl::StatusOr<Function*> boolified = Booleanifier::Booleanify(*f);
+  CHECK_OK(boolified.status());
+  absl::StatusOr<BitSlicedEvaluator> evaluator =
+      BitSlicedEvaluator::Create(*boolified);
+  CHECK_OK(evaluator.status());
+
+  std::minstd_rand rng(0);
+  std::vector<uint64_t> inputs(evaluator->input_bit_count() *
+                               BitSlicedEvaluator::kWordsPerBatch);
+  for (uint64_t& word : inputs) {
+    word = (uint64_t{rng()} << 32) ^ rng();
+  }
+  std::vector<uint64_t> outputs(evaluator->output_bit_count() *
+                                BitSlicedEvaluator::kWordsPerBatch);
+  for (auto _ : state) {
+    evaluator->RunBatch(inputs, absl::MakeSpan(outputs));
+    benchmark::DoNotOptimize(outputs);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          BitSlicedEvaluator::kVectorsPerBatch);
+}
+
+BENCHMARK(BM_RunBatch);
+
+}  // namespace
+}  // namespace xls
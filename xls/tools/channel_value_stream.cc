@@ -0,0 +1,175 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/channel_value_stream.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <ios>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/jit/jit_runtime.h"
+
+namespace xls {
+
+/* static */ absl::StatusOr<std::unique_ptr<ChannelValueStreamReader>>
+ChannelValueStreamReader::Create(const std::filesystem::path& path, Type* type,
+                                 int64_t chunk_size) {
+  XLS_RET_CHECK_GT(chunk_size, 0);
+  std::ifstream stream(path, std::ios::in | std::ios::binary);
+  if (!stream.is_open()) {
+    return absl::NotFoundError(
+        absl::StrFormat("Unable to open channel value file %s", path.string()));
+  }
+  std::string magic;
+  std::string type_string;
+  if (!std::getline(stream, magic) || magic != kChannelValueStreamMagic ||
+      !std::getline(stream, type_string)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "File %s is not a packed channel value file", path.string()));
+  }
+  if (type_string != type->ToString()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Channel value file %s holds values of type %s, expected %s",
+        path.string(), type_string, type->ToString()));
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitRuntime> runtime,
+                       JitRuntime::Create());
+  int64_t value_size = runtime->GetTypeByteSize(type);
+  // Zero-sized values take no space in the file so there is no way to tell how
+  // many there are.
+  XLS_RET_CHECK_GT(value_size, 0)
+      << "Cannot stream values of zero-width type " << type->ToString();
+  return absl::WrapUnique(new ChannelValueStreamReader(
+      std::move(stream), type, std::move(runtime), value_size, chunk_size));
+}
+
+absl::Status ChannelValueStreamReader::ReadChunk() {
+  std::vector<uint8_t> buffer(chunk_size_ * value_size_);
+  stream_.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+  int64_t bytes_read = stream_.gcount();
+  if (stream_.bad()) {
+    return absl::InternalError("Error reading channel value file");
+  }
+  if (bytes_read % value_size_ != 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Channel value file ends with a partial value of type %s",
+        type_->ToString()));
+  }
+  if (bytes_read < buffer.size()) {
+    at_end_ = true;
+  }
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<Value> values,
+      runtime_->NativeLayoutToValues(absl::MakeConstSpan(buffer), type_,
+                                     bytes_read / value_size_));
+  for (Value& value : values) {
+    pending_.push_back(std::move(value));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<bool> ChannelValueStreamReader::AtEnd() {
+  if (pending_.empty() && !at_end_) {
+    XLS_RETURN_IF_ERROR(ReadChunk());
+  }
+  return pending_.empty();
+}
+
+absl::StatusOr<std::optional<Value>> ChannelValueStreamReader::Next() {
+  XLS_ASSIGN_OR_RETURN(bool at_end, AtEnd());
+  if (at_end) {
+    return std::nullopt;
+  }
+  Value value = std::move(pending_.front());
+  pending_.pop_front();
+  ++values_read_;
+  return value;
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<ChannelValueStreamWriter>>
+ChannelValueStreamWriter::Create(const std::filesystem::path& path, Type* type,
+                                 int64_t chunk_size) {
+  XLS_RET_CHECK_GT(chunk_size, 0);
+  std::ofstream stream(path,
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!stream.is_open()) {
+    return absl::InternalError(absl::StrFormat(
+        "Unable to create channel value file %s", path.string()));
+  }
+  stream << kChannelValueStreamMagic << "\n" << type->ToString() << "\n";
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitRuntime> runtime,
+                       JitRuntime::Create());
+  int64_t value_size = runtime->GetTypeByteSize(type);
+  XLS_RET_CHECK_GT(value_size, 0)
+      << "Cannot stream values of zero-width type " << type->ToString();
+  return absl::WrapUnique(new ChannelValueStreamWriter(
+      std::move(stream), type, std::move(runtime), value_size, chunk_size));
+}
+
+absl::Status ChannelValueStreamWriter::WriteChunk() {
+  std::vector<uint8_t> buffer(pending_.size() * value_size_);
+  XLS_RETURN_IF_ERROR(runtime_->ValuesToNativeLayout(
+      pending_, type_, absl::MakeSpan(buffer)));
+  stream_.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+  if (!stream_.good()) {
+    return absl::InternalError("Error writing channel value file");
+  }
+  pending_.clear();
+  return absl::OkStatus();
+}
+
+absl::Status ChannelValueStreamWriter::Write(const Value& value) {
+  XLS_RET_CHECK(!closed_);
+  if (!ValueConformsToType(value, type_)) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Value %s does not have type %s", value.ToString(),
+                        type_->ToString()));
+  }
+  pending_.push_back(value);
+  if (pending_.size() >= chunk_size_) {
+    XLS_RETURN_IF_ERROR(WriteChunk());
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ChannelValueStreamWriter::Close() {
+  XLS_RET_CHECK(!closed_);
+  closed_ = true;
+  if (!pending_.empty()) {
+    XLS_RETURN_IF_ERROR(WriteChunk());
+  }
+  stream_.close();
+  if (stream_.fail()) {
+    return absl::InternalError("Error closing channel value file");
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls
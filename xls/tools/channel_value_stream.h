@@ -0,0 +1,128 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_TOOLS_CHANNEL_VALUE_STREAM_H_
+#define XLS_TOOLS_CHANNEL_VALUE_STREAM_H_
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_runtime.h"
+
+namespace xls {
+
+// Files of channel values in packed binary form, for feeding and checking long
+// proc simulations without holding every value in memory.
+//
+// A file starts with the line "XLS_CHANNEL_VALUES" followed by a line holding
+// the type of the values (e.g. "(bits[32], bits[8])"). The rest of the file is
+// the values in the native layout used by the JIT, each occupying
+// JitRuntime::GetTypeByteSize(type) bytes. The layout depends on the host so
+// the files are not portable between hosts with different data layouts.
+inline constexpr char kChannelValueStreamMagic[] = "XLS_CHANNEL_VALUES";
+
+// Reads values lazily from a packed channel value file. Values are read from
+// the file in chunks of `chunk_size` values.
+class ChannelValueStreamReader {
+ public:
+  static constexpr int64_t kDefaultChunkSize = 1024;
+
+  // Opens the file at `path`, which must hold values of type `type`.
+  static absl::StatusOr<std::unique_ptr<ChannelValueStreamReader>> Create(
+      const std::filesystem::path& path, Type* type,
+      int64_t chunk_size = kDefaultChunkSize);
+
+  // Returns the next value in the file, or std::nullopt at the end of the
+  // file.
+  absl::StatusOr<std::optional<Value>> Next();
+
+  // Returns whether all values in the file have been returned by Next().
+  absl::StatusOr<bool> AtEnd();
+
+  // Returns the number of values returned by Next() so far.
+  int64_t values_read() const { return values_read_; }
+
+ private:
+  ChannelValueStreamReader(std::ifstream stream, Type* type,
+                           std::unique_ptr<JitRuntime> runtime,
+                           int64_t value_size, int64_t chunk_size)
+      : stream_(std::move(stream)),
+        type_(type),
+        runtime_(std::move(runtime)),
+        value_size_(value_size),
+        chunk_size_(chunk_size) {}
+
+  absl::Status ReadChunk();
+
+  std::ifstream stream_;
+  Type* type_;
+  std::unique_ptr<JitRuntime> runtime_;
+  int64_t value_size_;
+  int64_t chunk_size_;
+  std::deque<Value> pending_;
+  bool at_end_ = false;
+  int64_t values_read_ = 0;
+};
+
+// Writes values to a packed channel value file. Values are buffered and
+// written in chunks of `chunk_size` values; Close() writes out the remainder.
+class ChannelValueStreamWriter {
+ public:
+  static constexpr int64_t kDefaultChunkSize = 1024;
+
+  // Creates (or truncates) the file at `path` for values of type `type`.
+  static absl::StatusOr<std::unique_ptr<ChannelValueStreamWriter>> Create(
+      const std::filesystem::path& path, Type* type,
+      int64_t chunk_size = kDefaultChunkSize);
+
+  absl::Status Write(const Value& value);
+
+  // Flushes the buffered values and closes the file. No values may be written
+  // afterwards.
+  absl::Status Close();
+
+ private:
+  ChannelValueStreamWriter(std::ofstream stream, Type* type,
+                           std::unique_ptr<JitRuntime> runtime,
+                           int64_t value_size, int64_t chunk_size)
+      : stream_(std::move(stream)),
+        type_(type),
+        runtime_(std::move(runtime)),
+        value_size_(value_size),
+        chunk_size_(chunk_size) {}
+
+  absl::Status WriteChunk();
+
+  std::ofstream stream_;
+  Type* type_;
+  std::unique_ptr<JitRuntime> runtime_;
+  int64_t value_size_;
+  int64_t chunk_size_;
+  std::vector<Value> pending_;
+  bool closed_ = false;
+};
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_CHANNEL_VALUE_STREAM_H_
@@ -0,0 +1,128 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/channel_value_stream.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+using ::testing::Optional;
+
+TEST(ChannelValueStreamTest, RoundTrip) {
+  Package p("test");
+  Type* type = p.GetTupleType({p.GetBitsType(17), p.GetBitsType(100)});
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "values.bin";
+
+  // Use a small chunk size so values span several chunks.
+  constexpr int64_t kValueCount = 10;
+  std::vector<Value> values;
+  for (int64_t i = 0; i < kValueCount; ++i) {
+    values.push_back(Value::Tuple(
+        {Value(UBits(i * 1000, 17)),
+         Value(Bits::FromBytes({0x12, static_cast<uint8_t>(i), 0x34}, 100))}));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ChannelValueStreamWriter> writer,
+      ChannelValueStreamWriter::Create(path, type, /*chunk_size=*/3));
+  for (const Value& value : values) {
+    XLS_ASSERT_OK(writer->Write(value));
+  }
+  XLS_ASSERT_OK(writer->Close());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ChannelValueStreamReader> reader,
+      ChannelValueStreamReader::Create(path, type, /*chunk_size=*/4));
+  for (const Value& value : values) {
+    EXPECT_THAT(reader->AtEnd(), IsOkAndHolds(false));
+    EXPECT_THAT(reader->Next(), IsOkAndHolds(Optional(value)));
+  }
+  EXPECT_THAT(reader->AtEnd(), IsOkAndHolds(true));
+  EXPECT_THAT(reader->Next(), IsOkAndHolds(std::nullopt));
+  EXPECT_EQ(reader->values_read(), kValueCount);
+}
+
+TEST(ChannelValueStreamTest, EmptyFile) {
+  Package p("test");
+  Type* type = p.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "values.bin";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelValueStreamWriter> writer,
+                           ChannelValueStreamWriter::Create(path, type));
+  XLS_ASSERT_OK(writer->Close());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelValueStreamReader> reader,
+                           ChannelValueStreamReader::Create(path, type));
+  EXPECT_THAT(reader->Next(), IsOkAndHolds(std::nullopt));
+}
+
+TEST(ChannelValueStreamTest, Errors) {
+  Package p("test");
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "values.bin";
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ChannelValueStreamWriter> writer,
+      ChannelValueStreamWriter::Create(path, p.GetBitsType(32)));
+  EXPECT_THAT(writer->Write(Value(UBits(1, 8))),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("does not have type bits[32]")));
+  XLS_ASSERT_OK(writer->Write(Value(UBits(1, 32))));
+  XLS_ASSERT_OK(writer->Close());
+
+  EXPECT_THAT(ChannelValueStreamReader::Create(path, p.GetBitsType(16)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("holds values of type bits[32], expected "
+                                 "bits[16]")));
+
+  // A truncated value is an error.
+  XLS_ASSERT_OK_AND_ASSIGN(std::string contents, GetFileContents(path));
+  XLS_ASSERT_OK(
+      SetFileContents(path, contents.substr(0, contents.size() - 1)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ChannelValueStreamReader> reader,
+      ChannelValueStreamReader::Create(path, p.GetBitsType(32)));
+  EXPECT_THAT(reader->Next(), StatusIs(absl::StatusCode::kInvalidArgument,
+                                       HasSubstr("partial value")));
+
+  XLS_ASSERT_OK(SetFileContents(path, "not a channel value file\n"));
+  EXPECT_THAT(ChannelValueStreamReader::Create(path, p.GetBitsType(32)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("is not a packed channel value file")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -12,8 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <thread>  // NOLINT(build/c++11)
@@ -24,10 +26,12 @@
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/time.h"
 #include "xls/common/exit_status.h"
-#include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -39,6 +43,8 @@
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/unroll_pass.h"
+#include "xls/solvers/z3_ir_equivalence.h"
+#include "xls/solvers/z3_ir_sweeping.h"
 #include "xls/solvers/z3_ir_translator.h"
 #include "xls/solvers/z3_utils.h"
 #include "../z3/src/api/z3.h"
@@ -64,6 +70,16 @@ ABSL_FLAG(std::string, top, "",
           "Functions are supported.");
 ABSL_FLAG(absl::Duration, timeout, absl::InfiniteDuration(),
           "How long to wait for any proof to complete.");
+ABSL_FLAG(bool, sweep, false,
+          "Before the proof, merge the nodes of the two functions which random "
+          "simulation and small proofs show to be equivalent. This usually "
+          "makes proofs of large, mostly similar functions much faster.");
+ABSL_FLAG(int64_t, sweep_sample_count, 1024,
+          "The number of random inputs simulated to find candidate "
+          "equivalences when --sweep is given.");
+ABSL_FLAG(absl::Duration, sweep_candidate_timeout, absl::Seconds(1),
+          "How long to wait for the proof of each candidate equivalence when "
+          "--sweep is given.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
 namespace xls {
@@ -85,12 +101,15 @@ static absl::StatusOr<Z3_ast> CreateComparisonFunction(
   return Z3_mk_eq(ctx, result1, result2);
 }
 
-static absl::Status RealMain(const std::vector<std::string_view>& ir_paths,
-                             const std::string& entry, absl::Duration timeout) {
+static absl::Status RealMain(
+    const std::vector<std::string_view>& ir_paths, const std::string& entry,
+    absl::Duration timeout,
+    const std::optional<solvers::z3::SweepOptions>& sweep_options) {
   std::vector<std::unique_ptr<Package>> packages;
   for (const auto ir_path : ir_paths) {
-    XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
-    XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
+    XLS_ASSIGN_OR_RETURN(MappedFile ir_file, MappedFile::Open(ir_path));
+    XLS_ASSIGN_OR_RETURN(auto package,
+                         Parser::ParsePackage(ir_file.contents()));
     if (!entry.empty()) {
       XLS_RETURN_IF_ERROR(package->SetTopByName(entry));
     }
@@ -126,27 +145,47 @@ static absl::Status RealMain(const std::vector<std::string_view>& ir_paths,
     functions.push_back(func);
   }
 
+  // When sweeping, both functions are combined into a single function so the
+  // logic they share can be merged before translation.
+  std::optional<solvers::z3::Miter> miter;
   std::vector<std::unique_ptr<IrTranslator>> translators;
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
-                       IrTranslator::CreateAndTranslate(functions[0]));
-  translators.push_back(std::move(translator));
-
-  // Get the params for the first function, so we can map the second function's
-  // parameters to them.
-  Z3_context ctx = translators[0]->ctx();
-  std::vector<Z3_ast> z3_params;
-  for (const Param* param : functions[0]->params()) {
-    z3_params.push_back(translators[0]->GetTranslation(param));
-  }
+  Z3_context ctx;
+  Z3_ast results_equal;
+  if (sweep_options.has_value()) {
+    XLS_ASSIGN_OR_RETURN(miter,
+                         solvers::z3::BuildMiter(functions[0], functions[1]));
+    XLS_ASSIGN_OR_RETURN(solvers::z3::SweepStats stats,
+                         solvers::z3::SweepMiter(*miter, *sweep_options));
+    std::cerr << absl::StrFormat("Sweeping: %v", stats) << '\n';
+
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
+                         IrTranslator::CreateAndTranslate(miter->function));
+    ctx = translator->ctx();
+    results_equal = Z3_mk_eq(ctx, translator->GetTranslation(miter->a_result),
+                             translator->GetTranslation(miter->b_result));
+    translators.push_back(std::move(translator));
+  } else {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
+                         IrTranslator::CreateAndTranslate(functions[0]));
+    translators.push_back(std::move(translator));
+
+    // Get the params for the first function, so we can map the second
+    // function's parameters to them.
+    ctx = translators[0]->ctx();
+    std::vector<Z3_ast> z3_params;
+    for (const Param* param : functions[0]->params()) {
+      z3_params.push_back(translators[0]->GetTranslation(param));
+    }
 
-  XLS_ASSIGN_OR_RETURN(
-      translator, IrTranslator::CreateAndTranslate(ctx, functions[1],
-                                                   absl::MakeSpan(z3_params)));
-  translators.push_back(std::move(translator));
+    XLS_ASSIGN_OR_RETURN(translator,
+                         IrTranslator::CreateAndTranslate(
+                             ctx, functions[1], absl::MakeSpan(z3_params)));
+    translators.push_back(std::move(translator));
 
-  XLS_ASSIGN_OR_RETURN(
-      Z3_ast results_equal,
-      CreateComparisonFunction(absl::MakeSpan(translators), functions));
+    XLS_ASSIGN_OR_RETURN(
+        results_equal,
+        CreateComparisonFunction(absl::MakeSpan(translators), functions));
+  }
   translators[0]->SetTimeout(timeout);
 
   Z3_solver solver =
@@ -174,6 +213,14 @@ int main(int argc, char** argv) {
   std::vector<std::string_view> positional_args =
       xls::InitXls(kUsage, argc, argv);
   QCHECK_EQ(positional_args.size(), 2) << "Two IR files must be specified!";
-  return xls::ExitStatus(xls::RealMain(
-      positional_args, absl::GetFlag(FLAGS_top), absl::GetFlag(FLAGS_timeout)));
+  std::optional<xls::solvers::z3::SweepOptions> sweep_options;
+  if (absl::GetFlag(FLAGS_sweep)) {
+    sweep_options = xls::solvers::z3::SweepOptions{
+        .sample_count = absl::GetFlag(FLAGS_sweep_sample_count),
+        .candidate_timeout = absl::GetFlag(FLAGS_sweep_candidate_timeout)};
+  }
+  return xls::ExitStatus(xls::RealMain(positional_args,
+                                       absl::GetFlag(FLAGS_top),
+                                       absl::GetFlag(FLAGS_timeout),
+                                       sweep_options));
 }
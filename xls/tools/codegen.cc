@@ -14,6 +14,9 @@
 
 #include "xls/tools/codegen.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -29,6 +32,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/combinational_generator.h"
 #include "xls/codegen/module_signature.h"
@@ -38,11 +42,14 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/stopwatch.h"
+#include "xls/common/thread.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/delay_model/ffi_delay_estimator.h"
 #include "xls/fdo/synthesizer.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
 #include "xls/ir/op.h"
+#include "xls/ir/package.h"
 #include "xls/ir/verifier.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -109,6 +116,10 @@ absl::StatusOr<PipelineScheduleOrGroup> RunSchedulingPipeline(
     }
     return scheduling_status;
   }
+  VLOG(1) << absl::StreamFormat(
+      "Scheduling invariant checkers ran %d times in %s",
+      results.invariant_checker_run_count,
+      absl::FormatDuration(results.invariant_checker_duration));
   XLS_RET_CHECK(scheduling_unit.schedules().contains(main));
   if (scheduling_options.schedule_all_procs()) {
     return std::move(scheduling_unit).schedules();
@@ -197,6 +208,7 @@ absl::StatusOr<verilog::CodegenOptions> CodegenOptionsFromProto(
 
   options.gate_recvs(p.gate_recvs());
   options.array_index_bounds_checking(p.array_index_bounds_checking());
+  options.min_delay_line_length(p.min_delay_line_length());
   switch (p.register_merge_strategy()) {
     case STRATEGY_DONT_MERGE:
       options.register_merge_strategy(
@@ -212,6 +224,14 @@ absl::StatusOr<verilog::CodegenOptions> CodegenOptionsFromProto(
           "Unknown merge strategy: %v", p.register_merge_strategy()));
   }
 
+  if (!p.verilog_cache_dir().empty()) {
+    // The flags determine all of the options. Scheduling options only affect
+    // the Verilog of a block through its IR, which is also part of the key.
+    CodegenFlagsProto key = p;
+    key.clear_verilog_cache_dir();
+    options.verilog_cache(p.verilog_cache_dir(), key.DebugString());
+  }
+
   return options;
 }
 
@@ -370,4 +390,56 @@ absl::StatusOr<CodegenResult> ScheduleAndCodegen(
       timing_report ? &timing_report->codegen_time : nullptr);
 }
 
+std::vector<absl::StatusOr<ConfigurationCodegenResult>>
+ScheduleAndCodegenConfigurations(
+    const Package& p, absl::Span<const CodegenConfiguration> configurations,
+    bool with_delay_model, int64_t thread_count) {
+  // Scheduling and codegen modify the package so each configuration works on
+  // its own copy, parsed from a single dump of `p`.
+  const std::string ir_text = p.DumpIr();
+  auto run_configuration = [&](const CodegenConfiguration& configuration)
+      -> absl::StatusOr<ConfigurationCodegenResult> {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         Parser::ParsePackage(ir_text));
+    XLS_ASSIGN_OR_RETURN(
+        CodegenResult codegen_result,
+        ScheduleAndCodegen(package.get(),
+                           configuration.scheduling_options_flags_proto,
+                           configuration.codegen_flags_proto,
+                           with_delay_model));
+    return ConfigurationCodegenResult{
+        .package = std::move(package),
+        .codegen_result = std::move(codegen_result),
+    };
+  };
+
+  std::vector<absl::StatusOr<ConfigurationCodegenResult>> results(
+      configurations.size(), absl::UnknownError("Configuration was not run"));
+  std::atomic<int64_t> next_configuration = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_configuration++; i < configurations.size();
+         i = next_configuration++) {
+      VLOG(1) << absl::StreamFormat("Running codegen configuration %d of %d",
+                                    i + 1, configurations.size());
+      results[i] = run_configuration(configurations[i]);
+    }
+  };
+  thread_count = std::clamp(
+      thread_count, int64_t{1},
+      std::max(int64_t{1}, static_cast<int64_t>(configurations.size())));
+  if (thread_count == 1) {
+    worker();
+    return results;
+  }
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(thread_count);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  return results;
+}
+
 }  // namespace xls
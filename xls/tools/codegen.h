@@ -12,11 +12,15 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <variant>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/delay_model/delay_estimator.h"
@@ -72,6 +76,30 @@ absl::StatusOr<CodegenResult> ScheduleAndCodegen(
     TimingReport* timing_report = nullptr,
     PipelineScheduleOrGroup* schedules = nullptr);
 
+// One configuration of a sweep over scheduling and codegen options.
+struct CodegenConfiguration {
+  SchedulingOptionsFlagsProto scheduling_options_flags_proto;
+  CodegenFlagsProto codegen_flags_proto;
+};
+
+struct ConfigurationCodegenResult {
+  // The copy of the input package which the configuration was scheduled and
+  // generated from. It holds the scheduled IR and the generated blocks.
+  std::unique_ptr<Package> package;
+  CodegenResult codegen_result;
+};
+
+// Runs ScheduleAndCodegen for each of `configurations` on its own copy of `p`,
+// running up to `thread_count` configurations at a time. This avoids starting
+// a process and parsing the IR per configuration, and the configurations share
+// the (process-wide) delay estimators and their delay caches. The result of
+// each configuration is at the same index as the configuration; a failure of
+// one configuration does not affect the others.
+std::vector<absl::StatusOr<ConfigurationCodegenResult>>
+ScheduleAndCodegenConfigurations(
+    const Package& p, absl::Span<const CodegenConfiguration> configurations,
+    bool with_delay_model, int64_t thread_count);
+
 }  // namespace xls
 
 #endif  // XLS_TOOLS_CODEGEN_H_
@@ -48,6 +48,10 @@ ABSL_FLAG(
 ABSL_FLAG(std::string, output_verilog_line_map_path, "",
           "Specific output path for Verilog line map. If not specified then "
           "Verilog line map is not generated.");
+ABSL_FLAG(std::string, output_codegen_pass_profile_path, "",
+          "Specific output path for a textproto of the run time and changes "
+          "of each pass of the codegen pass pipeline. If not specified then "
+          "the profile is not written.");
 ABSL_FLAG(std::string, top, "",
           "Top entity of the package to generate the (System)Verilog code.");
 ABSL_FLAG(std::string, generator, "pipeline",
@@ -128,7 +132,8 @@ ABSL_FLAG(std::vector<std::string>, ram_configurations, {},
           "the output of the RAM. Note: this flag should generally be used in "
           "conjunction with a scheduling constraint to ensure that the receive "
           "on the response channel comes a cycle after the send on the request "
-          "channel.");
+          "channel. A trailing :banks=N option interleaves the RAM across N "
+          "physical banks selected by the low address bits.");
 ABSL_FLAG(bool, gate_recvs, true,
           "If true, emit logic to gate the data value to zero for a receive "
           "operation in Verilog. Otherwise, the data value is not gated.");
@@ -138,6 +143,14 @@ ABSL_FLAG(bool, array_index_bounds_checking, true,
 ABSL_FLAG(int64_t, max_trace_verbosity, 0,
           "Maximum verbosity for traces. Traces with higher verbosity are "
           "stripped from codegen output. 0 by default.");
+ABSL_FLAG(std::string, verilog_cache_dir, "",
+          "If non-empty, a directory in which the Verilog generated for each "
+          "block is cached. Blocks whose IR and codegen options match a "
+          "previous run reuse the cached Verilog.");
+ABSL_FLAG(int64_t, min_delay_line_length, 0,
+          "If at least 2, chains of at least this many pass-through pipeline "
+          "registers are emitted as shift-register delay lines. Has no effect "
+          "when emitting as a pipeline.");
 ABSL_FLAG(std::string, codegen_options_proto, "",
           "Path to a protobuf containing all codegen args.");
 ABSL_FLAG(std::optional<std::string>, codegen_options_used_textproto_file,
@@ -247,10 +260,12 @@ static absl::StatusOr<bool> SetOptionsFromFlags(CodegenFlagsProto &proto) {
   POPULATE_FLAG(streaming_channel_valid_suffix);
   POPULATE_FLAG(streaming_channel_ready_suffix);
   POPULATE_REPEATED_FLAG(ram_configurations);
+  POPULATE_FLAG(verilog_cache_dir);
 
   // Optimizations
   POPULATE_FLAG(gate_recvs);
   POPULATE_FLAG(array_index_bounds_checking);
+  POPULATE_FLAG(min_delay_line_length);
   XLS_ASSIGN_OR_RETURN(
       RegisterMergeStrategyProto merge_strategy,
       MergeStrategyFromString(absl::GetFlag(FLAGS_register_merge_strategy)));
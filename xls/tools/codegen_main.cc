@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include <cstdint>
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <iostream>
 #include <memory>
@@ -20,17 +21,21 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/verifier.h"
@@ -54,18 +59,124 @@ Emit a feed-forward pipelined module:
        --clock_period_ps=500 \
        --pipeline_stages=7 \
        IR_FILE
+
+Emit a module for each configuration listed in a CodegenConfigurationsProto:
+   codegen_main --generator=pipeline \
+       --configurations_path=CONFIGS_TEXTPROTO \
+       --configurations_output_dir=DIR \
+       IR_FILE
 )";
 
+ABSL_FLAG(std::string, configurations_path, "",
+          "Path to a CodegenConfigurationsProto text proto. If given, the IR "
+          "is parsed once and a module is generated for each configuration. "
+          "The options of each configuration are applied on top of the "
+          "options given by the other flags. The outputs of each "
+          "configuration are written to --configurations_output_dir.");
+ABSL_FLAG(std::string, configurations_output_dir, "",
+          "Directory in which to write the outputs of each configuration of "
+          "--configurations_path: NAME.v (or NAME.sv), NAME.sig.textproto, "
+          "NAME.schedule.textproto and NAME.block.ir.");
+ABSL_FLAG(int64_t, configurations_jobs, 0,
+          "Number of configurations of --configurations_path to generate "
+          "concurrently. If zero, the number of available CPUs is used.");
+
 namespace xls {
 namespace {
 
+absl::Status WriteConfigurationOutputs(
+    const std::filesystem::path& output_dir, std::string_view name,
+    const CodegenFlagsProto& codegen_flags_proto,
+    const ConfigurationCodegenResult& result) {
+  const verilog::ModuleGeneratorResult& module =
+      result.codegen_result.module_generator_result;
+  std::string_view verilog_extension =
+      codegen_flags_proto.use_system_verilog() ? "sv" : "v";
+  XLS_RETURN_IF_ERROR(SetFileContents(
+      output_dir / absl::StrFormat("%s.%s", name, verilog_extension),
+      module.verilog_text));
+  XLS_RETURN_IF_ERROR(SetTextProtoFile(
+      output_dir / absl::StrFormat("%s.sig.textproto", name),
+      module.signature.proto()));
+  if (result.codegen_result.package_pipeline_schedules_proto.has_value()) {
+    XLS_RETURN_IF_ERROR(SetTextProtoFile(
+        output_dir / absl::StrFormat("%s.schedule.textproto", name),
+        *result.codegen_result.package_pipeline_schedules_proto));
+  }
+  return SetFileContents(output_dir / absl::StrFormat("%s.block.ir", name),
+                         result.package->DumpIr());
+}
+
+// Generates a module for each configuration of --configurations_path from
+// the single package `p`.
+absl::Status RunConfigurations(
+    const Package& p,
+    const SchedulingOptionsFlagsProto& scheduling_options_flags_proto,
+    const CodegenFlagsProto& codegen_flags_proto,
+    bool delay_model_flag_passed) {
+  XLS_ASSIGN_OR_RETURN(CodegenConfigurationsProto configurations_proto,
+                       ParseTextProtoFile<CodegenConfigurationsProto>(
+                           absl::GetFlag(FLAGS_configurations_path)));
+  const std::filesystem::path output_dir =
+      absl::GetFlag(FLAGS_configurations_output_dir);
+  QCHECK(!output_dir.empty())
+      << "--configurations_output_dir is required with --configurations_path";
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(output_dir));
+
+  std::vector<CodegenConfiguration> configurations;
+  absl::flat_hash_set<std::string> names;
+  for (const CodegenConfigurationsProto::Configuration& configuration :
+       configurations_proto.configurations()) {
+    QCHECK(!configuration.name().empty())
+        << "Every configuration must have a name";
+    QCHECK(names.insert(configuration.name()).second)
+        << "Duplicate configuration name: " << configuration.name();
+    CodegenConfiguration& c = configurations.emplace_back();
+    c.scheduling_options_flags_proto = scheduling_options_flags_proto;
+    c.scheduling_options_flags_proto.MergeFrom(
+        configuration.scheduling_options());
+    c.codegen_flags_proto = codegen_flags_proto;
+    c.codegen_flags_proto.MergeFrom(configuration.codegen_options());
+  }
+
+  int64_t jobs = absl::GetFlag(FLAGS_configurations_jobs);
+  if (jobs <= 0) {
+    jobs = AvailableCPUs();
+  }
+  std::vector<absl::StatusOr<ConfigurationCodegenResult>> results =
+      ScheduleAndCodegenConfigurations(p, configurations,
+                                       delay_model_flag_passed, jobs);
+
+  // Write the outputs of every configuration which succeeded before reporting
+  // the first failure.
+  absl::Status status = absl::OkStatus();
+  for (int64_t i = 0; i < results.size(); ++i) {
+    const std::string& name = configurations_proto.configurations(i).name();
+    absl::Status config_status = results[i].status();
+    if (config_status.ok()) {
+      config_status = WriteConfigurationOutputs(
+          output_dir, name, configurations[i].codegen_flags_proto,
+          *results[i]);
+    }
+    if (!config_status.ok()) {
+      LOG(ERROR) << absl::StreamFormat("Configuration %s failed: %s", name,
+                                       config_status.ToString());
+      if (status.ok()) {
+        status = xabsl::StatusBuilder(config_status).SetPrepend()
+                 << absl::StrFormat("Configuration %s: ", name);
+      }
+    }
+  }
+  return status;
+}
+
 absl::Status RealMain(std::string_view ir_path) {
   if (ir_path == "-") {
     ir_path = "/dev/stdin";
   }
-  XLS_ASSIGN_OR_RETURN(std::string ir_contents, GetFileContents(ir_path));
+  XLS_ASSIGN_OR_RETURN(MappedFile ir_file, MappedFile::Open(ir_path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> p,
-                       Parser::ParsePackage(ir_contents, ir_path));
+                       Parser::ParsePackage(ir_file.contents(), ir_path));
 
   XLS_ASSIGN_OR_RETURN(CodegenFlagsProto codegen_flags_proto,
                        GetCodegenFlags());
@@ -83,6 +194,10 @@ absl::Status RealMain(std::string_view ir_path) {
   XLS_ASSIGN_OR_RETURN(
       bool delay_model_flag_passed,
       IsDelayModelSpecifiedViaFlag(scheduling_options_flags_proto));
+  if (!absl::GetFlag(FLAGS_configurations_path).empty()) {
+    return RunConfigurations(*p, scheduling_options_flags_proto,
+                             codegen_flags_proto, delay_model_flag_passed);
+  }
   XLS_ASSIGN_OR_RETURN(
       CodegenResult r,
       ScheduleAndCodegen(p.get(), scheduling_options_flags_proto,
@@ -135,6 +250,13 @@ absl::Status RealMain(std::string_view ir_path) {
         SetTextProtoFile(verilog_line_map_path, result.verilog_line_map));
   }
 
+  const std::string& pass_profile_path =
+      absl::GetFlag(FLAGS_output_codegen_pass_profile_path);
+  if (!pass_profile_path.empty()) {
+    XLS_RETURN_IF_ERROR(
+        SetTextProtoFile(pass_profile_path, result.pass_profile));
+  }
+
   if (verilog_path.empty()) {
     std::cout << result.verilog_text;
   } else {
@@ -241,6 +241,54 @@ class CodeGenMainTest(parameterized.TestCase):
         SHA256_IR_PATH,
     ])
 
+  def test_multiple_configurations(self):
+    configurations = self.create_tempfile(content="""
+      configurations {
+        name: "two_stages"
+        scheduling_options { pipeline_stages: 2 }
+      }
+      configurations {
+        name: "four_stages"
+        scheduling_options { pipeline_stages: 4 }
+        codegen_options { module_name: "sha256_four" use_system_verilog: false }
+      }
+    """)
+    output_dir = self.create_tempdir()
+    subprocess.check_call([
+        CODEGEN_MAIN_PATH,
+        '--generator=pipeline',
+        '--delay_model=unit',
+        '--reset_data_path=false',
+        '--alsologtostderr',
+        '--configurations_path=' + configurations.full_path,
+        '--configurations_output_dir=' + output_dir.full_path,
+        '--configurations_jobs=2',
+        SHA256_IR_PATH,
+    ])
+
+    for name, pipeline_stages in (('two_stages', 2), ('four_stages', 4)):
+      sig_path = os.path.join(output_dir.full_path, f'{name}.sig.textproto')
+      with open(sig_path) as f:
+        sig_proto = text_format.Parse(
+            f.read(), module_signature_pb2.ModuleSignatureProto()
+        )
+        self.assertEqual(sig_proto.pipeline.latency, pipeline_stages + 1)
+      self.assertTrue(
+          os.path.exists(
+              os.path.join(output_dir.full_path, f'{name}.schedule.textproto')
+          )
+      )
+      self.assertTrue(
+          os.path.exists(os.path.join(output_dir.full_path, f'{name}.block.ir'))
+      )
+
+    with open(os.path.join(output_dir.full_path, 'two_stages.sv')) as f:
+      self.assertIn('// ===== Pipe stage 2', f.read())
+    with open(os.path.join(output_dir.full_path, 'four_stages.v')) as f:
+      verilog = f.read()
+      self.assertIn('module sha256_four(', verilog)
+      self.assertIn('// ===== Pipe stage 4', verilog)
+
   def test_clock_period_and_pipeline_stages(self):
     pipeline_stages = 5
     clock_period_ps = 5000
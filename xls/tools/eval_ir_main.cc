@@ -69,6 +69,7 @@
 #include "llvm/include/llvm/Target/TargetMachine.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -79,6 +80,7 @@
 #include "xls/dslx/mangle.h"
 #include "xls/dslx/parse_and_typecheck.h"
 #include "xls/dslx/warning_kind.h"
+#include "xls/interpreter/compiled_function_interpreter.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/interpreter/random_value.h"
 #include "xls/ir/bits.h"
@@ -91,6 +93,7 @@
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
+#include "xls/ir/xls_value.pb.h"
 #include "xls/jit/function_jit.h"
 #include "xls/jit/jit_buffer.h"
 #include "xls/jit/llvm_type_converter.h"
@@ -99,6 +102,7 @@
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
 #include "xls/passes/pass_base.h"
+#include "xls/tools/function_arg_sets.pb.h"
 
 const char kUsage[] = R"(
 Evaluates an IR file with user-specified or random inputs using the IR
@@ -119,6 +123,11 @@ and compare each result against a corresponding values in EXPECTED_FILE:
 
    eval_ir_main --input_file=INPUT_FILE --expected_file=EXPECTED_FILE IR_FILE
 
+Evaluate an IR function with a batch of arguments (and optionally expected
+results) held in a binary xls.FunctionArgSetsProto:
+
+   eval_ir_main --input_proto_file=ARG_SETS_PROTO IR_FILE
+
 Evaluate IR with randomly generated inputs:
 
    eval_ir_main --random_inputs=100 IR_FILE
@@ -155,6 +164,11 @@ ABSL_FLAG(std::string, input_file, "",
           "Inputs to interpreter, one set per line. Each line should contain a "
           "semicolon-separated set of typed values. Cannot be specified with "
           "--input.");
+ABSL_FLAG(std::string, input_proto_file, "",
+          "Inputs to interpreter as a binary xls.FunctionArgSetsProto. Any "
+          "expected results in the proto are checked as with --expected_file. "
+          "This avoids formatting and parsing text for large inputs. Cannot be "
+          "specified with --input or --input_file.");
 ABSL_FLAG(int64_t, random_inputs, 0,
           "If non-zero, this is the number of randomly generated inputs to use "
           "in evaluation. Cannot be specified with --input.");
@@ -180,7 +194,8 @@ ABSL_FLAG(bool, test_llvm_jit, false,
           "interpereter.");
 ABSL_FLAG(int64_t, llvm_opt_level, 3,
           "The optimization level of the LLVM JIT. Valid values are from 0 (no "
-          "optimizations) to 3 (maximum optimizations).");
+          "optimizations) to 3 (maximum optimizations). Only used by the "
+          "standard --jit_pipeline.");
 ABSL_FLAG(std::string, input_validator_expr, "",
           "DSLX expression to validate randomly-generated inputs. "
           "The expression can reference entry function input arguments "
@@ -587,11 +602,18 @@ absl::StatusOr<std::vector<Value>> Eval(
                              absl::GetFlag(FLAGS_use_llvm_jit_interpreter),
                              absl::GetFlag(FLAGS_llvm_jit_asm_output));
   std::unique_ptr<FunctionJit> jit;
+  std::unique_ptr<CompiledFunctionInterpreter> interpreter;
   if (use_jit) {
     // No support for procs yet.
     XLS_ASSIGN_OR_RETURN(
         jit,
-        FunctionJit::Create(f, absl::GetFlag(FLAGS_llvm_opt_level), &observer));
+        FunctionJit::Create(
+            f, JitOptions{.opt_level = absl::GetFlag(FLAGS_llvm_opt_level)},
+            &observer));
+  } else {
+    // Lower the function once rather than walking the IR for every argument
+    // set.
+    XLS_ASSIGN_OR_RETURN(interpreter, CompiledFunctionInterpreter::Create(f));
   }
 
   if (absl::GetFlag(FLAGS_llvm_jit_main_wrapper_output)) {
@@ -624,7 +646,7 @@ absl::StatusOr<std::vector<Value>> Eval(
       // require rethinking some of the control flow because event comparison
       // only makes sense for certain modes (optimize_ir and test_llvm_jit).
       XLS_ASSIGN_OR_RETURN(
-          result, DropInterpreterEvents(InterpretFunction(f, arg_set.args)));
+          result, DropInterpreterEvents(interpreter->Run(arg_set.args)));
     }
     std::cout << result.ToString(FormatPreference::kHex) << '\n';
 
@@ -741,6 +763,31 @@ absl::StatusOr<ArgSet> ArgSetFromString(std::string_view args_string) {
   return arg_set;
 }
 
+// Returns the ArgSets held in the given binary FunctionArgSetsProto file.
+absl::StatusOr<std::vector<ArgSet>> ArgSetsFromProtoFile(
+    std::string_view filename) {
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(filename));
+  FunctionArgSetsProto proto;
+  if (!proto.ParseFromString(contents)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Unable to parse %s as a FunctionArgSetsProto", filename));
+  }
+  std::vector<ArgSet> arg_sets;
+  arg_sets.reserve(proto.arg_sets_size());
+  for (const FunctionArgSetsProto::ArgSet& arg_set_proto : proto.arg_sets()) {
+    ArgSet& arg_set = arg_sets.emplace_back();
+    arg_set.args.reserve(arg_set_proto.args_size());
+    for (const ValueProto& arg : arg_set_proto.args()) {
+      XLS_ASSIGN_OR_RETURN(arg_set.args.emplace_back(), Value::FromProto(arg));
+    }
+    if (arg_set_proto.has_expected()) {
+      XLS_ASSIGN_OR_RETURN(arg_set.expected,
+                           Value::FromProto(arg_set_proto.expected()));
+    }
+  }
+  return arg_sets;
+}
+
 // Converts the given DSLX validation function into IR.
 absl::StatusOr<std::unique_ptr<Package>> ConvertValidator(
     Function* f, std::string_view dslx_stdlib_path,
@@ -827,9 +874,9 @@ absl::Status RealMain(std::string_view input_path,
   if (input_path == "-") {
     input_path = "/dev/stdin";
   }
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(input_path));
+  XLS_ASSIGN_OR_RETURN(MappedFile ir_file, MappedFile::Open(input_path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                       Parser::ParsePackage(contents, input_path));
+                       Parser::ParsePackage(ir_file.contents(), input_path));
   if (!absl::GetFlag(FLAGS_top).empty()) {
     XLS_RETURN_IF_ERROR(package->SetTopByName(absl::GetFlag(FLAGS_top)));
   }
@@ -841,6 +888,8 @@ absl::Status RealMain(std::string_view input_path,
         << "Cannot specify both --input and --random_inputs";
     QCHECK(absl::GetFlag(FLAGS_input_file).empty())
         << "Cannot specify both --input and --input_file";
+    QCHECK(absl::GetFlag(FLAGS_input_proto_file).empty())
+        << "Cannot specify both --input and --input_proto_file";
     absl::StatusOr<ArgSet> arg_set_status =
         ArgSetFromString(absl::GetFlag(FLAGS_input));
     QCHECK_OK(arg_set_status.status())
@@ -850,6 +899,8 @@ absl::Status RealMain(std::string_view input_path,
   } else if (!absl::GetFlag(FLAGS_input_file).empty()) {
     QCHECK_EQ(absl::GetFlag(FLAGS_random_inputs), 0)
         << "Cannot specify both --input_file and --random_inputs";
+    QCHECK(absl::GetFlag(FLAGS_input_proto_file).empty())
+        << "Cannot specify both --input_file and --input_proto_file";
     absl::StatusOr<std::string> args_input_file =
         GetFileContents(absl::GetFlag(FLAGS_input_file));
     QCHECK_OK(args_input_file.status());
@@ -861,9 +912,15 @@ absl::Status RealMain(std::string_view input_path,
                                 absl::GetFlag(FLAGS_input_file), arg_line);
       arg_sets.push_back(arg_set_status.value());
     }
+  } else if (!absl::GetFlag(FLAGS_input_proto_file).empty()) {
+    QCHECK_EQ(absl::GetFlag(FLAGS_random_inputs), 0)
+        << "Cannot specify both --input_proto_file and --random_inputs";
+    XLS_ASSIGN_OR_RETURN(
+        arg_sets, ArgSetsFromProtoFile(absl::GetFlag(FLAGS_input_proto_file)));
   } else {
     QCHECK_NE(absl::GetFlag(FLAGS_random_inputs), 0)
-        << "Must specify --input, --input_file, or --random_inputs.";
+        << "Must specify --input, --input_file, --input_proto_file, or "
+           "--random_inputs.";
     arg_sets.resize(absl::GetFlag(FLAGS_random_inputs));
     std::minstd_rand rng_engine;
     std::string validator_text = absl::GetFlag(FLAGS_input_validator_expr);
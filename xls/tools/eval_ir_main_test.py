@@ -19,6 +19,8 @@ import subprocess
 from absl.testing import absltest
 from xls.common import runfiles
 from xls.common import test_base
+from xls.ir import xls_value_pb2
+from xls.tools import function_arg_sets_pb2
 
 EVAL_IR_MAIN_PATH = runfiles.get_path('xls/tools/eval_ir_main')
 
@@ -165,6 +167,40 @@ class EvalMainTest(absltest.TestCase):
     self.assertIn('Miscompare for input[1] "bits[32]:0x10; bits[32]:0x0"',
                   comp.stderr.decode('utf-8'))
 
+  def test_input_proto_file(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+
+    def bits32(value):
+      return xls_value_pb2.ValueProto(
+          bits=xls_value_pb2.ValueProto.Bits(
+              bit_count=32, data=value.to_bytes(4, 'little')))
+
+    arg_sets = function_arg_sets_pb2.FunctionArgSetsProto()
+    arg_sets.arg_sets.add(args=[bits32(0x42), bits32(0x123)],
+                          expected=bits32(0x165))
+    arg_sets.arg_sets.add(args=[bits32(0x10), bits32(0xf0f)])
+    proto_file = self.create_tempfile(
+        content=arg_sets.SerializeToString(), mode='wb')
+    results = subprocess.check_output([
+        EVAL_IR_MAIN_PATH, '--input_proto_file=' + proto_file.full_path,
+        ir_file.full_path
+    ])
+    self.assertSequenceEqual(('bits[32]:0x165', 'bits[32]:0xf1f'),
+                             results.decode('utf-8').strip().split('\n'))
+
+    # A mismatching expected result is reported.
+    arg_sets.arg_sets[1].expected.CopyFrom(bits32(0x1))
+    proto_file = self.create_tempfile(
+        content=arg_sets.SerializeToString(), mode='wb')
+    comp = subprocess.run([
+        EVAL_IR_MAIN_PATH, '--input_proto_file=' + proto_file.full_path,
+        ir_file.full_path
+    ],
+                          stderr=subprocess.PIPE,
+                          check=False)
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn('Miscompare for input[1]', comp.stderr.decode('utf-8'))
+
   def test_empty_input_file(self):
     ir_file = self.create_tempfile(content=ADD_IR)
     input_file = self.create_tempfile(content='')
@@ -20,6 +20,7 @@
 #include <deque>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <numeric>
 #include <optional>
@@ -70,6 +71,7 @@
 #include "xls/ir/value_utils.h"
 #include "xls/jit/block_jit.h"
 #include "xls/jit/jit_proc_runtime.h"
+#include "xls/tools/channel_value_stream.h"
 #include "xls/tools/eval_utils.h"
 
 constexpr const char* kUsage = R"(
@@ -90,7 +92,9 @@ ABSL_FLAG(std::string, backend, "serial_jit",
           " * serial_jit: JIT-backed single-stepping runtime.\n"
           " * ir_interpreter: Interpreter at the IR level.\n"
           " * block_interpreter: Interpret a block generated from a proc.\n"
-          " * block_jit: JIT-backed block execution generated from a proc.");
+          " * block_jit: JIT-backed block execution generated from a proc.\n"
+          "The JIT backends compile with the LLVM pipeline given by "
+          "--jit_pipeline.");
 ABSL_FLAG(std::string, block_signature_proto, "",
           "Path to textproto file containing signature from codegen");
 ABSL_FLAG(int64_t, max_cycles_no_output, 100,
@@ -180,6 +184,18 @@ ABSL_FLAG(std::vector<std::string>, model_memories, {},
 ABSL_FLAG(bool, fail_on_assert, false,
           "When set to true, the simulation fails on the activation or cycle "
           "in which an assertion fires.");
+ABSL_FLAG(std::vector<std::string>, streaming_inputs_for_channels, {},
+          "Comma separated list of channel=filename pairs of packed channel "
+          "value files (see channel_value_stream.h). Values are read as the "
+          "procs consume them rather than loaded up front. Only supported by "
+          "the serial_jit and ir_interpreter backends.");
+ABSL_FLAG(std::vector<std::string>, streaming_expected_outputs_for_channels, {},
+          "Like --streaming_inputs_for_channels, but for expected outputs. "
+          "Outputs are compared as they are produced.");
+ABSL_FLAG(std::vector<std::string>, streaming_outputs_for_channels, {},
+          "Comma separated list of channel=filename pairs. The values sent on "
+          "each channel are written to the file as a packed channel value "
+          "file.");
 
 namespace xls {
 
@@ -221,6 +237,11 @@ static absl::Status EvaluateProcs(
   } else {
     XLS_ASSIGN_OR_RETURN(runtime, CreateInterpreterSerialProcRuntime(package));
   }
+  // Traces which will not be printed are dropped before they are formatted.
+  runtime->SetTraceOptions(TraceOptions{
+      .max_verbosity = absl::GetFlag(FLAGS_show_trace)
+                           ? absl::GetFlag(FLAGS_max_trace_verbosity)
+                           : std::numeric_limits<int64_t>::min()});
 
   ChannelQueueManager& queue_manager = runtime->queue_manager();
   for (const auto& [channel_name, values] : inputs_for_channels) {
@@ -424,6 +445,181 @@ static absl::Status EvaluateProcs(
   return absl::OkStatus();
 }
 
+// An output channel checked against or written to a packed channel value file.
+struct StreamingOutputChannel {
+  ChannelQueue* queue;
+  std::unique_ptr<ChannelValueStreamReader> expected;
+  std::unique_ptr<ChannelValueStreamWriter> writer;
+};
+
+// Like EvaluateProcs but channel values are read from and written to packed
+// channel value files (see channel_value_stream.h) as the procs run. Inputs
+// are read when the procs consume them and outputs are compared or written
+// after each tick, so memory use does not grow with the number of values.
+static absl::Status EvaluateProcsStreaming(
+    Package* package,
+    const absl::flat_hash_map<std::string, std::string>& input_files,
+    const absl::flat_hash_map<std::string, std::string>& expected_output_files,
+    const absl::flat_hash_map<std::string, std::string>& output_files,
+    const EvaluateProcsOptions& options) {
+  if (expected_output_files.empty() &&
+      absl::c_any_of(options.ticks, [](int64_t t) { return t < 0; })) {
+    return absl::InvalidArgumentError(
+        "Running until all outputs are verified requires "
+        "--streaming_expected_outputs_for_channels");
+  }
+
+  std::unique_ptr<SerialProcRuntime> runtime;
+  if (options.use_jit) {
+    XLS_ASSIGN_OR_RETURN(runtime, CreateJitSerialProcRuntime(package));
+  } else {
+    XLS_ASSIGN_OR_RETURN(runtime, CreateInterpreterSerialProcRuntime(package));
+  }
+  runtime->SetTraceOptions(TraceOptions{
+      .max_verbosity = absl::GetFlag(FLAGS_show_trace)
+                           ? absl::GetFlag(FLAGS_max_trace_verbosity)
+                           : std::numeric_limits<int64_t>::min()});
+  ChannelQueueManager& queue_manager = runtime->queue_manager();
+
+  // Generators cannot return errors so the first read error is recorded here
+  // and checked after each tick.
+  absl::Status input_status = absl::OkStatus();
+  std::vector<std::unique_ptr<ChannelValueStreamReader>> input_readers;
+  for (const auto& [channel_name, filename] : input_files) {
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * in_queue,
+                         queue_manager.GetQueueByName(channel_name));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<ChannelValueStreamReader> reader,
+                         ChannelValueStreamReader::Create(
+                             filename, in_queue->channel()->type()));
+    ChannelValueStreamReader* reader_ptr = reader.get();
+    XLS_RETURN_IF_ERROR(in_queue->AttachGenerator(
+        [reader_ptr, &input_status]() -> std::optional<Value> {
+          absl::StatusOr<std::optional<Value>> value = reader_ptr->Next();
+          if (!value.ok()) {
+            input_status.Update(value.status());
+            return std::nullopt;
+          }
+          return *std::move(value);
+        }));
+    input_readers.push_back(std::move(reader));
+  }
+
+  absl::btree_map<std::string, StreamingOutputChannel> outputs;
+  for (const auto& [channel_name, filename] : expected_output_files) {
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * out_queue,
+                         queue_manager.GetQueueByName(channel_name));
+    outputs[channel_name].queue = out_queue;
+    XLS_ASSIGN_OR_RETURN(outputs[channel_name].expected,
+                         ChannelValueStreamReader::Create(
+                             filename, out_queue->channel()->type()));
+  }
+  for (const auto& [channel_name, filename] : output_files) {
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * out_queue,
+                         queue_manager.GetQueueByName(channel_name));
+    outputs[channel_name].queue = out_queue;
+    XLS_ASSIGN_OR_RETURN(outputs[channel_name].writer,
+                         ChannelValueStreamWriter::Create(
+                             filename, out_queue->channel()->type()));
+  }
+
+  std::vector<Proc*> sorted_procs;
+  for (const auto& proc : package->procs()) {
+    sorted_procs.push_back(proc.get());
+  }
+  std::sort(sorted_procs.begin(), sorted_procs.end(),
+            [](Proc* a, Proc* b) { return a->name() < b->name(); });
+
+  // Values beyond the end of an expected output file are not checked, as with
+  // the non-streaming flags.
+  auto drain_outputs = [&]() -> absl::StatusOr<bool> {
+    bool all_outputs_produced = true;
+    for (auto& [channel_name, output] : outputs) {
+      while (!output.queue->IsEmpty()) {
+        Value value = *output.queue->Read();
+        if (output.writer != nullptr) {
+          XLS_RETURN_IF_ERROR(output.writer->Write(value));
+        }
+        if (output.expected == nullptr) {
+          continue;
+        }
+        int64_t processed_count = output.expected->values_read();
+        XLS_ASSIGN_OR_RETURN(std::optional<Value> expected,
+                             output.expected->Next());
+        if (expected.has_value() && *expected != value) {
+          return absl::UnknownError(absl::StrFormat(
+              "Outputs did not match expectations:\n\nMismatched "
+              "(channel=%s) after %d outputs (%s != %s)",
+              channel_name, processed_count, expected->ToString(),
+              value.ToString()));
+        }
+      }
+      if (output.expected != nullptr) {
+        XLS_ASSIGN_OR_RETURN(bool at_end, output.expected->AtEnd());
+        all_outputs_produced = all_outputs_produced && at_end;
+      }
+    }
+    return all_outputs_produced;
+  };
+
+  for (int64_t this_ticks : options.ticks) {
+    runtime->ResetState();
+    for (int64_t i = 0; this_ticks < 0 || i < this_ticks; ++i) {
+      runtime->ClearInterpreterEvents();
+      XLS_RETURN_IF_ERROR(runtime->Tick());
+      XLS_RETURN_IF_ERROR(input_status);
+
+      std::vector<std::string> asserts;
+      for (Proc* proc : sorted_procs) {
+        const InterpreterEvents& events = runtime->GetInterpreterEvents(proc);
+        XLS_RETURN_IF_ERROR(LogInterpreterEvents(proc->name(), events));
+        if (options.fail_on_assert) {
+          for (const std::string& assert : events.assert_msgs) {
+            asserts.push_back(
+                absl::StrFormat("Proc %s: %s", proc->name(), assert));
+          }
+        }
+      }
+      if (!asserts.empty()) {
+        return absl::UnknownError(absl::StrFormat(
+            "Assert(s) fired:\n\n%s", absl::StrJoin(asserts, "\n")));
+      }
+
+      XLS_ASSIGN_OR_RETURN(bool all_outputs_produced, drain_outputs());
+      if (this_ticks < 0 && all_outputs_produced) {
+        break;
+      }
+    }
+  }
+
+  std::vector<std::string> errors;
+  bool checked_any_output = false;
+  for (auto& [channel_name, output] : outputs) {
+    if (output.writer != nullptr) {
+      XLS_RETURN_IF_ERROR(output.writer->Close());
+    }
+    if (output.expected == nullptr) {
+      continue;
+    }
+    checked_any_output =
+        checked_any_output || output.expected->values_read() > 0;
+    XLS_ASSIGN_OR_RETURN(bool at_end, output.expected->AtEnd());
+    if (!at_end) {
+      errors.push_back(absl::StrFormat(
+          "Channel %s didn't produce all expected values (processed %d)",
+          channel_name, output.expected->values_read()));
+    }
+  }
+  if (!errors.empty()) {
+    return absl::UnknownError(
+        absl::StrFormat("Outputs did not match expectations:\n\n%s",
+                        absl::StrJoin(errors, "\n")));
+  }
+  if (!checked_any_output && !expected_output_files.empty()) {
+    return absl::UnknownError("No output verified (empty expected values?)");
+  }
+  return absl::OkStatus();
+}
+
 struct ChannelInfo {
   int64_t width = -1;
   bool port_input = false;
@@ -1074,7 +1270,11 @@ static absl::Status RealMain(
     std::string_view memory_write_data_suffix,
     std::string_view idle_channel_name, const int random_seed,
     const double prob_input_valid_assert, bool show_trace,
-    std::string_view output_stats_path, bool fail_on_assert) {
+    std::string_view output_stats_path, bool fail_on_assert,
+    const std::vector<std::string>& streaming_inputs_for_channels_text,
+    const std::vector<std::string>&
+        streaming_expected_outputs_for_channels_text,
+    const std::vector<std::string>& streaming_outputs_for_channels_text) {
   // Don't waste time and memory parsing more input than can possibly be
   // consumed.
   const int64_t total_ticks =
@@ -1173,6 +1373,22 @@ static absl::Status RealMain(
   } else {
     LOG(QFATAL) << "Unknown backend type";
   }
+  if (!streaming_inputs_for_channels_text.empty() ||
+      !streaming_expected_outputs_for_channels_text.empty() ||
+      !streaming_outputs_for_channels_text.empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        auto input_files,
+        ParseChannelFilenames(streaming_inputs_for_channels_text));
+    XLS_ASSIGN_OR_RETURN(
+        auto expected_output_files,
+        ParseChannelFilenames(streaming_expected_outputs_for_channels_text));
+    XLS_ASSIGN_OR_RETURN(
+        auto output_files,
+        ParseChannelFilenames(streaming_outputs_for_channels_text));
+    return EvaluateProcsStreaming(package.get(), input_files,
+                                  expected_output_files, output_files,
+                                  evaluate_procs_options);
+  }
   return EvaluateProcs(package.get(), inputs_for_channels,
                        expected_outputs_for_channels, evaluate_procs_options);
 }
@@ -1232,6 +1448,27 @@ int main(int argc, char* argv[]) {
                    "--expected_proto_outputs_for_all_channels must be set.";
   }
 
+  const bool streaming =
+      !absl::GetFlag(FLAGS_streaming_inputs_for_channels).empty() ||
+      !absl::GetFlag(FLAGS_streaming_expected_outputs_for_channels).empty() ||
+      !absl::GetFlag(FLAGS_streaming_outputs_for_channels).empty();
+  if (streaming) {
+    if (backend != "serial_jit" && backend != "ir_interpreter") {
+      LOG(QFATAL) << "Streaming channel files are only supported by the "
+                     "serial_jit and ir_interpreter backends.";
+    }
+    if (!absl::GetFlag(FLAGS_inputs_for_channels).empty() ||
+        !absl::GetFlag(FLAGS_inputs_for_all_channels).empty() ||
+        !absl::GetFlag(FLAGS_proto_inputs_for_all_channels).empty() ||
+        !absl::GetFlag(FLAGS_expected_outputs_for_channels).empty() ||
+        !absl::GetFlag(FLAGS_expected_outputs_for_all_channels).empty() ||
+        !absl::GetFlag(FLAGS_expected_proto_outputs_for_all_channels)
+             .empty()) {
+      LOG(QFATAL) << "Streaming channel files cannot be combined with other "
+                     "channel value flags.";
+    }
+  }
+
   return xls::ExitStatus(xls::RealMain(
       positional_args[0], backend, absl::GetFlag(FLAGS_block_signature_proto),
       ticks, absl::GetFlag(FLAGS_max_cycles_no_output),
@@ -1254,5 +1491,8 @@ int main(int argc, char* argv[]) {
       absl::GetFlag(FLAGS_idle_channel_name), absl::GetFlag(FLAGS_random_seed),
       absl::GetFlag(FLAGS_prob_input_valid_assert),
       absl::GetFlag(FLAGS_show_trace), absl::GetFlag(FLAGS_output_stats_path),
-      absl::GetFlag(FLAGS_fail_on_assert)));
+      absl::GetFlag(FLAGS_fail_on_assert),
+      absl::GetFlag(FLAGS_streaming_inputs_for_channels),
+      absl::GetFlag(FLAGS_streaming_expected_outputs_for_channels),
+      absl::GetFlag(FLAGS_streaming_outputs_for_channels)));
 }
@@ -13,6 +13,7 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import struct
 import subprocess
 import textwrap
 
@@ -460,6 +461,72 @@ class EvalProcTest(parameterized.TestCase):
     output = run_command(shared_args + ["--backend", "serial_jit"])
     self.assertIn("Proc test_proc", output.stderr)
 
+  def test_streaming_channel_files(self):
+    ir_file = self.create_tempfile(content=PROC_IR)
+
+    def packed_bits64(values):
+      # Values of type bits[64] are stored as 64-bit little-endian words in the
+      # native layout of x86 and ARM hosts.
+      header = b"XLS_CHANNEL_VALUES\nbits[64]\n"
+      return header + b"".join(struct.pack("<Q", v) for v in values)
+
+    input_file = self.create_tempfile(content=packed_bits64([42, 101]))
+    input_file_2 = self.create_tempfile(content=packed_bits64([10, 6]))
+    output_file = self.create_tempfile()
+    output_file_2 = self.create_tempfile()
+
+    for backend in ("ir_interpreter", "serial_jit"):
+      # Record the outputs and check them against the expected values.
+      run_command([
+          EVAL_PROC_MAIN_PATH,
+          ir_file.full_path,
+          "--ticks",
+          "2",
+          "--backend",
+          backend,
+          "--streaming_inputs_for_channels",
+          f"in_ch={input_file.full_path},in_ch_2={input_file_2.full_path}",
+          "--streaming_outputs_for_channels",
+          f"out_ch={output_file.full_path},out_ch_2={output_file_2.full_path}",
+      ])
+      self.assertEqual(output_file.read_bytes(), packed_bits64([62, 127]))
+      self.assertEqual(output_file_2.read_bytes(), packed_bits64([55, 55]))
+
+      # The recorded outputs can be used as expected outputs.
+      run_command([
+          EVAL_PROC_MAIN_PATH,
+          ir_file.full_path,
+          "--ticks",
+          "-1",
+          "--backend",
+          backend,
+          "--streaming_inputs_for_channels",
+          f"in_ch={input_file.full_path},in_ch_2={input_file_2.full_path}",
+          "--streaming_expected_outputs_for_channels",
+          f"out_ch={output_file.full_path},out_ch_2={output_file_2.full_path}",
+      ])
+
+    # A mismatch is reported.
+    bad_output_file = self.create_tempfile(content=packed_bits64([62, 128]))
+    comp = subprocess.run(
+        [
+            EVAL_PROC_MAIN_PATH,
+            ir_file.full_path,
+            "--ticks",
+            "-1",
+            "--streaming_inputs_for_channels",
+            f"in_ch={input_file.full_path},in_ch_2={input_file_2.full_path}",
+            "--streaming_expected_outputs_for_channels",
+            f"out_ch={bad_output_file.full_path}",
+        ],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        encoding="utf-8",
+        check=False,
+    )
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn("Mismatched (channel=out_ch) after 1 outputs", comp.stderr)
+
   def test_reset_static(self):
     ir_file = self.create_tempfile(content=PROC_IR)
     input_file = self.create_tempfile(content=textwrap.dedent("""
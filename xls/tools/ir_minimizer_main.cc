@@ -51,6 +51,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
+#include "xls/common/thread.h"
 #include "xls/data_structures/binary_search.h"
 #include "xls/data_structures/inline_bitmap.h"
 #include "xls/interpreter/function_interpreter.h"
@@ -202,6 +203,14 @@ ABSL_FLAG(int64_t, simplifications_between_tests, 1,
 ABSL_FLAG(int64_t, failed_attempts_between_tests_limit, 16,
           "Failed simplification attempts between tests before we conclude we "
           "need to check our changes so far.");
+ABSL_FLAG(int64_t, jobs, 1,
+          "Number of candidate simplifications to test concurrently. If "
+          "greater than one, each round generates up to this many independent "
+          "simplifications of the last known failing IR, tests them in "
+          "parallel and keeps the first one (in generation order) which still "
+          "fails. --simplifications_between_tests is ignored in this mode. "
+          "Combine with --test_llvm_jit to test JIT/interpreter mismatches "
+          "in-process without starting a subprocess per test.");
 ABSL_FLAG(
     bool, verify_ir, true,
     "Verify IR whenever parsing. In most cases, this is a good check that the "
@@ -1177,10 +1186,157 @@ absl::Status CleanUp(FunctionBase* f, bool can_remove_params) {
   return absl::OkStatus();
 }
 
+// Returns the function base to simplify next: TOP if --simplify_top_only is
+// set, otherwise a function base picked at random weighted by node count.
+FunctionBase* PickFunctionBaseToSimplify(Package* package, std::mt19937& rng) {
+  if (absl::GetFlag(FLAGS_simplify_top_only)) {
+    return package->GetTop().value();
+  }
+  std::vector<FunctionBase*> bases = package->GetFunctionBases();
+  std::vector<int64_t> node_counts;
+  node_counts.reserve(bases.size());
+  absl::c_transform(bases, std::back_inserter(node_counts),
+                    [](FunctionBase* f) { return f->node_count(); });
+  absl::discrete_distribution<size_t> distribution(node_counts.cbegin(),
+                                                   node_counts.cend());
+  return bases[distribution(rng)];
+}
+
+// Parallel variant of the minimization loop used when --jobs > 1. Each round
+// generates up to `jobs` independent simplifications of the last known failing
+// IR and tests them concurrently. The first candidate (in generation order)
+// which still fails is accepted and the rest are discarded, so for a given
+// value of `jobs` the result does not depend on thread scheduling. Returns the
+// minimized IR text.
+absl::StatusOr<std::string> MinimizeInParallel(
+    std::string knownf_ir_text, const std::optional<std::vector<Value>>& inputs,
+    int64_t failed_attempt_limit, int64_t total_attempt_limit,
+    int64_t failed_attempts_between_tests_limit, int64_t jobs,
+    absl::flat_hash_map<std::string, bool>& test_cache) {
+  const bool can_remove_params = absl::GetFlag(FLAGS_can_remove_params);
+  std::mt19937 rng;  // Default constructor uses deterministic seed.
+
+  int64_t failed_simplification_attempts = 0;
+  int64_t total_attempts = 0;
+  struct Candidate {
+    std::string which_transform;
+    std::string candidate_name;
+    std::string ir_text;
+    int64_t node_count;
+  };
+  bool done = false;
+  while (!done) {
+    if (failed_simplification_attempts >= failed_attempt_limit) {
+      LOG(INFO) << "Hit failed-simplification-attempt-limit: "
+                << failed_simplification_attempts;
+      break;
+    }
+    LOG(INFO) << "Total attempts " << total_attempts << "/"
+              << total_attempt_limit;
+    LOG(INFO) << "Failed attempt count " << failed_simplification_attempts
+              << "/" << failed_attempt_limit;
+
+    // Generate this round's candidates. Simplifications which do not change
+    // the IR, or which produce IR already known to pass, count as failed
+    // attempts without being tested.
+    std::vector<Candidate> candidates;
+    absl::flat_hash_set<std::string> candidate_ir_texts;
+    int64_t unchanged_attempts = 0;
+    while (candidates.size() < jobs &&
+           unchanged_attempts < failed_attempts_between_tests_limit &&
+           failed_simplification_attempts < failed_attempt_limit) {
+      total_attempts++;
+      if (total_attempts >= total_attempt_limit) {
+        LOG(INFO) << "Hit total-attempt-limit: " << total_attempts;
+        done = true;
+        break;
+      }
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                           ParsePackage(knownf_ir_text));
+      FunctionBase* candidate =
+          PickFunctionBaseToSimplify(package.get(), rng);
+      std::string candidate_name = candidate->name();
+      std::string which_transform;
+      XLS_ASSIGN_OR_RETURN(SimplifiedIr simplification,
+                           Simplify(candidate, inputs, rng, &which_transform));
+      if (simplification.result == SimplificationResult::kCannotChange) {
+        LOG(INFO) << "Cannot simplify any further, done!";
+        done = true;
+        break;
+      }
+      if (simplification.result == SimplificationResult::kDidChange &&
+          simplification.in_place()) {
+        XLS_RETURN_IF_ERROR(CleanUp(candidate, can_remove_params));
+      }
+      std::string ir_text = simplification.ir();
+      auto cached = test_cache.find(ir_text);
+      if (simplification.result == SimplificationResult::kDidNotChange ||
+          ir_text == knownf_ir_text || candidate_ir_texts.contains(ir_text) ||
+          (cached != test_cache.end() && !cached->second)) {
+        VLOG(1) << "Did not change the sample.";
+        failed_simplification_attempts++;
+        unchanged_attempts++;
+        continue;
+      }
+      LOG(INFO) << "Trying " << which_transform << " on " << candidate_name;
+      candidate_ir_texts.insert(ir_text);
+      candidates.push_back({.which_transform = which_transform,
+                            .candidate_name = candidate_name,
+                            .ir_text = std::move(ir_text),
+                            .node_count = simplification.node_count});
+    }
+    if (candidates.empty()) {
+      continue;
+    }
+
+    // Test all of the candidates concurrently.
+    std::vector<absl::StatusOr<bool>> results(candidates.size(), false);
+    {
+      std::vector<std::unique_ptr<Thread>> threads;
+      threads.reserve(candidates.size());
+      for (int64_t i = 0; i < candidates.size(); ++i) {
+        threads.push_back(std::make_unique<Thread>([&, i]() {
+          results[i] = StillFailsHelper(candidates[i].ir_text, inputs);
+        }));
+      }
+      for (std::unique_ptr<Thread>& thread : threads) {
+        thread->Join();
+      }
+    }
+    std::optional<int64_t> accepted;
+    for (int64_t i = 0; i < candidates.size(); ++i) {
+      XLS_RETURN_IF_ERROR(results[i].status());
+      test_cache[candidates[i].ir_text] = *results[i];
+      if (*results[i] && !accepted.has_value()) {
+        accepted = i;
+      }
+    }
+    if (!accepted.has_value()) {
+      failed_simplification_attempts += candidates.size();
+      LOG(INFO) << "None of " << candidates.size()
+                << " candidates still fail. Failed simplification attempts "
+                   "now: "
+                << failed_simplification_attempts;
+      continue;
+    }
+
+    const Candidate& known_failure = candidates[*accepted];
+    knownf_ir_text = known_failure.ir_text;
+    std::cerr << "---\ntransform: " << known_failure.which_transform << " on "
+              << known_failure.candidate_name << " (candidate "
+              << (*accepted + 1) << "/" << candidates.size() << ")\n"
+              << (known_failure.node_count > 50 ? "" : known_failure.ir_text)
+              << "(" << known_failure.node_count << " nodes)\n";
+    failed_simplification_attempts = 0;
+  }
+  return knownf_ir_text;
+}
+
 absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
                       const int64_t total_attempt_limit,
                       const int64_t simplifications_between_tests,
-                      const int64_t failed_attempts_between_tests_limit) {
+                      const int64_t failed_attempts_between_tests_limit,
+                      const int64_t jobs) {
   XLS_ASSIGN_OR_RETURN(std::string knownf_ir_text, GetFileContents(path));
   // Cache of test results to avoid duplicate invocations of the
   // test_executable.
@@ -1227,6 +1383,19 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
     LOG(INFO) << "=== Done cleaning up initial garbage";
   }
 
+  if (jobs > 1) {
+    XLS_ASSIGN_OR_RETURN(
+        knownf_ir_text,
+        MinimizeInParallel(knownf_ir_text, inputs, failed_attempt_limit,
+                           total_attempt_limit,
+                           failed_attempts_between_tests_limit, jobs,
+                           test_cache));
+    std::cout << knownf_ir_text;
+    return VerifyStillFails(knownf_ir_text, inputs,
+                            "Minimized function does not fail!",
+                            /*test_cache=*/nullptr);
+  }
+
   // If so, we start simplifying via this seeded RNG.
   std::mt19937 rng;  // Default constructor uses deterministic seed.
 
@@ -1266,19 +1435,7 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
 
     VLOG(1) << "=== Simplification attempt " << total_attempts;
 
-    FunctionBase* candidate;
-    if (absl::GetFlag(FLAGS_simplify_top_only)) {
-      candidate = package->GetTop().value();
-    } else {
-      std::vector<FunctionBase*> bases = package->GetFunctionBases();
-      std::vector<int64_t> node_counts;
-      node_counts.reserve(bases.size());
-      absl::c_transform(bases, std::back_inserter(node_counts),
-                        [](FunctionBase* f) { return f->node_count(); });
-      absl::discrete_distribution<size_t> distribution(node_counts.cbegin(),
-                                                       node_counts.cend());
-      candidate = bases[distribution(rng)];
-    }
+    FunctionBase* candidate = PickFunctionBaseToSimplify(package.get(), rng);
     std::string candidate_name = candidate->name();
     XLS_VLOG_LINES(2,
                    "=== Candidate for simplification:\n" + candidate->DumpIr());
@@ -1434,6 +1591,7 @@ int main(int argc, char** argv) {
   QCHECK(!absl::GetFlag(FLAGS_test_executable).empty() ^
          absl::GetFlag(FLAGS_test_llvm_jit))
       << "Must specify either --test_executable or --test_llvm_jit";
+  QCHECK_GE(absl::GetFlag(FLAGS_jobs), 1) << "--jobs must be positive";
 
   if (absl::GetFlag(FLAGS_can_extract_segments)) {
     std::vector<std::string> failures;
@@ -1463,5 +1621,6 @@ int main(int argc, char** argv) {
       positional_arguments[0], absl::GetFlag(FLAGS_failed_attempt_limit),
       absl::GetFlag(FLAGS_total_attempt_limit),
       absl::GetFlag(FLAGS_simplifications_between_tests),
-      absl::GetFlag(FLAGS_failed_attempts_between_tests_limit)));
+      absl::GetFlag(FLAGS_failed_attempts_between_tests_limit),
+      absl::GetFlag(FLAGS_jobs)));
 }
@@ -576,6 +576,36 @@ top proc foo<input: bits[32] streaming in, output:bits[32] streaming out>(tkn: t
     # The minimizer should reduce the test case to just a literal.
     self.assertIn('ret literal', minimized_ir.decode('utf-8'))
 
+  def test_minimize_jit_mismatch_parallel(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    minimized_ir = subprocess.check_output(
+        [
+            IR_MINIMIZER_MAIN_PATH,
+            '--test_llvm_jit',
+            '--jobs=4',
+            '--input=bits[32]:0x42; bits[32]:0x123',
+            '--test_only_inject_jit_result=bits[32]:0x22',
+            ir_file.full_path,
+        ],
+        stderr=subprocess.PIPE,
+    )
+    self.assertIn('ret literal', minimized_ir.decode('utf-8'))
+
+  def test_minimize_add_parallel(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    test_sh_file = self.create_tempfile()
+    self._write_sh_script(test_sh_file.full_path, ['/usr/bin/env grep add $1'])
+    minimized_ir = subprocess.check_output([
+        IR_MINIMIZER_MAIN_PATH,
+        '--test_executable=' + test_sh_file.full_path,
+        '--can_remove_params',
+        '--jobs=4',
+        ir_file.full_path,
+    ])
+    minimized_ir = minimized_ir.decode('utf-8')
+    self.assertIn('add(', minimized_ir)
+    self.assertNotIn('not(', minimized_ir)
+
   def test_minimize_jit_mismatch_but_no_mismatch(self):
     ir_file = self.create_tempfile(content=ADD_IR)
     comp = subprocess.run(
@@ -15,43 +15,141 @@
 // Prints summary information about an IR file to the terminal.
 // Output will be added as needs warrant, so feel free to make additions!
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
-#include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/topo_sort.h"
 
 ABSL_FLAG(
     std::string, top, "",
     "The name of the top entity. Currently, only functions are supported. "
     "If set, restrict dumping to the given function. "
     "The name should not be mangled with the Package name.");
+ABSL_FLAG(int64_t, threads, 1,
+          "Number of threads used to collect statistics. Each function is "
+          "processed by a single thread.");
 
 namespace xls {
+namespace {
+
+struct FunctionStats {
+  // Number of nodes of each opcode.
+  absl::flat_hash_map<Op, int64_t> op_counts;
+  // Number of nodes on the longest path through the function.
+  int64_t depth = 0;
+};
+
+FunctionStats CollectStats(Function* f) {
+  FunctionStats stats;
+  absl::flat_hash_map<Node*, int64_t> depths;
+  depths.reserve(f->node_count());
+  for (Node* node : TopoSort(f)) {
+    ++stats.op_counts[node->op()];
+    int64_t depth = 0;
+    for (Node* operand : node->operands()) {
+      depth = std::max(depth, depths.at(operand));
+    }
+    depths[node] = depth + 1;
+    stats.depth = std::max(stats.depth, depth + 1);
+  }
+  return stats;
+}
+
+// Returns the opcode counts ordered from most to least common.
+std::string OpCountsToString(const FunctionStats& stats) {
+  std::vector<std::pair<Op, int64_t>> op_counts(stats.op_counts.begin(),
+                                                stats.op_counts.end());
+  std::sort(op_counts.begin(), op_counts.end(),
+            [](const auto& a, const auto& b) {
+              if (a.second != b.second) {
+                return a.second > b.second;
+              }
+              return OpToString(a.first) < OpToString(b.first);
+            });
+  return absl::StrJoin(op_counts, ", ", [](std::string* out, const auto& p) {
+    absl::StrAppendFormat(out, "%s: %d", OpToString(p.first), p.second);
+  });
+}
+
+// Collects the statistics of each function, spreading the functions over
+// `thread_count` threads. The functions are only read so they can be processed
+// concurrently.
+std::vector<FunctionStats> CollectAllStats(absl::Span<Function* const> fns,
+                                           int64_t thread_count) {
+  std::vector<FunctionStats> stats(fns.size());
+  std::atomic<int64_t> next_index = 0;
+  auto worker = [&]() {
+    for (int64_t i = next_index++; i < fns.size(); i = next_index++) {
+      stats[i] = CollectStats(fns[i]);
+    }
+  };
+  int64_t worker_count =
+      std::min(thread_count, static_cast<int64_t>(fns.size()));
+  if (worker_count <= 1) {
+    worker();
+    return stats;
+  }
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(worker_count);
+  for (int64_t i = 0; i < worker_count; ++i) {
+    threads.push_back(std::make_unique<Thread>(worker));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  return stats;
+}
+
+}  // namespace
 
 static absl::Status RealMain(std::string_view ir_path,
-                             std::optional<std::string> restrict_fn) {
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(ir_path));
-  XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(contents));
+                             std::optional<std::string> restrict_fn,
+                             int64_t thread_count) {
+  XLS_ASSIGN_OR_RETURN(MappedFile ir_file, MappedFile::Open(ir_path));
+  XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_file.contents()));
 
-  std::cout << "Package \"" << package->name() << "\"" << '\n';
+  std::vector<Function*> fns;
   for (const auto& f : package->functions()) {
     if (restrict_fn && restrict_fn.value() != f->name()) {
       continue;
     }
+    fns.push_back(f.get());
+  }
+  std::vector<FunctionStats> stats = CollectAllStats(fns, thread_count);
+
+  std::cout << "Package \"" << package->name() << "\"" << '\n';
+  for (int64_t i = 0; i < fns.size(); ++i) {
+    Function* f = fns[i];
     std::cout << "  Function: \"" << f->name() << "\"" << '\n';
     std::cout << "    Signature: " << f->GetType()->ToString() << '\n';
     std::cout << "    Nodes: " << f->node_count() << '\n';
+    std::cout << "    Depth: " << stats[i].depth << '\n';
+    std::cout << "    Ops: " << OpCountsToString(stats[i]) << '\n';
     std::cout << '\n';
   }
   return absl::OkStatus();
@@ -68,5 +166,6 @@ int main(int argc, char** argv) {
   if (!absl::GetFlag(FLAGS_top).empty()) {
     restrict_fn = absl::GetFlag(FLAGS_top);
   }
-  return xls::ExitStatus(xls::RealMain(positional_args[0], restrict_fn));
+  return xls::ExitStatus(xls::RealMain(positional_args[0], restrict_fn,
+                                       absl::GetFlag(FLAGS_threads)));
 }
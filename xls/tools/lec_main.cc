@@ -15,6 +15,7 @@
 // Tool to prove or disprove logical equivalence of XLS IR and a netlist.
 
 #include <csignal>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -31,6 +32,7 @@
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -93,6 +95,11 @@ ABSL_FLAG(int32_t, stage, -1,
           "Pipeline stage to evaluate. Requires --schedule.\n"
           "If \"schedule\" is set, but this is not, then the entire module "
           "will be evaluated.");
+ABSL_FLAG(int64_t, simulation_samples, 1024,
+          "Number of random inputs on which the IR and netlist are simulated "
+          "before invoking the solver. A mismatch found by simulation is "
+          "reported without a solver search. Not used for per-stage LEC. Set "
+          "to 0 to disable.");
 
 namespace xls {
 namespace {
@@ -105,15 +112,12 @@ constexpr const char kIrConverterPath[] =
 absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
     std::string_view cell_lib_path, std::string_view cell_proto_path) {
   if (!cell_proto_path.empty()) {
-    XLS_ASSIGN_OR_RETURN(std::string cell_proto_text,
-                         GetFileContents(cell_proto_path));
-    netlist::CellLibraryProto cell_proto;
-    XLS_RET_CHECK(cell_proto.ParseFromString(cell_proto_text));
+    XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto cell_proto,
+                         netlist::ReadCellLibraryProto(cell_proto_path));
     return netlist::CellLibrary::FromProto(cell_proto);
   }
-  XLS_ASSIGN_OR_RETURN(std::string lib_text, GetFileContents(cell_lib_path));
   XLS_ASSIGN_OR_RETURN(auto stream,
-                       netlist::cell_lib::CharStream::FromText(lib_text));
+                       netlist::cell_lib::CharStream::FromPath(cell_lib_path));
   XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto proto,
                        netlist::function::ExtractFunctions(&stream));
   return netlist::CellLibrary::FromProto(proto);
@@ -122,8 +126,8 @@ absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
 // Loads and parses a netlist from a file.
 absl::StatusOr<std::unique_ptr<netlist::rtl::Netlist>> GetNetlist(
     std::string_view netlist_path, netlist::CellLibrary* cell_library) {
-  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
+  XLS_ASSIGN_OR_RETURN(MappedFile netlist_file, MappedFile::Open(netlist_path));
+  netlist::rtl::Scanner scanner(netlist_file.contents());
   return netlist::rtl::Parser::ParseNetlist(cell_library, &scanner);
 }
 
@@ -231,10 +235,10 @@ static absl::Status RealMain(
     std::string_view netlist_module_name, std::string_view cell_lib_path,
     std::string_view cell_proto_path, std::string_view netlist_path,
     std::string_view constraints_file, std::string_view schedule_path,
-    int stage, bool auto_stage, int timeout_sec) {
+    int stage, bool auto_stage, int timeout_sec, int64_t simulation_samples) {
   solvers::z3::LecParams lec_params;
-  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
-  XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSIGN_OR_RETURN(MappedFile ir_file, MappedFile::Open(ir_path));
+  XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_file.contents()));
   lec_params.ir_package = package.get();
   if (entry_function_name.empty()) {
     XLS_ASSIGN_OR_RETURN(lec_params.ir_function,
@@ -285,6 +289,14 @@ static absl::Status RealMain(
     XLS_RETURN_IF_ERROR(lec->AddConstraints(function));
   }
 
+  if (simulation_samples > 0 && stage == -1) {
+    XLS_ASSIGN_OR_RETURN(bool found, lec->FindCounterexampleBySimulation(
+                                         simulation_samples));
+    if (found) {
+      std::cout << "Simulation found a mismatch.\n";
+    }
+  }
+
   struct sigaction old_action;
   if (timeout_sec != -1) {
     old_action = SetAlarm(timeout_sec);
@@ -340,5 +352,6 @@ int main(int argc, char* argv[]) {
       ir_path, absl::GetFlag(FLAGS_entry_function_name),
       absl::GetFlag(FLAGS_netlist_module_name), cell_lib_path, cell_proto_path,
       netlist_path, absl::GetFlag(FLAGS_constraints_file), schedule_path, stage,
-      auto_stage, absl::GetFlag(FLAGS_timeout_sec)));
+      auto_stage, absl::GetFlag(FLAGS_timeout_sec),
+      absl::GetFlag(FLAGS_simulation_samples)));
 }
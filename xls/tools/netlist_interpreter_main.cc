@@ -16,6 +16,7 @@
 // (taken from the command line) into it, and prints the result.
 
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -26,7 +27,7 @@
 #include "absl/strings/str_split.h"
 #include "xls/codegen/flattening.h"
 #include "xls/common/exit_status.h"
-#include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -34,6 +35,7 @@
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value.h"
 #include "xls/netlist/cell_library.h"
+#include "xls/netlist/compiled_interpreter.h"
 #include "xls/netlist/function_extractor.h"
 #include "xls/netlist/interpreter.h"
 #include "xls/netlist/lib_parser.h"
@@ -58,6 +60,10 @@ ABSL_FLAG(std::string, output_type, "",
           "Type of the value as an XLS-formatted string. If un-set, then the "
           "output will be printed as flat uninterpreted bits.");
 ABSL_FLAG(std::string, module_name, "", "Module in the netlist to interpret.");
+ABSL_FLAG(bool, compiled, false,
+          "Compile the netlist into a levelized, bit-parallel form before "
+          "evaluating it. Much faster for large netlists but does not support "
+          "--dump_cells.");
 ABSL_FLAG(std::string, netlist, "", "Path to the netlist to interpret.");
 
 namespace xls {
@@ -66,17 +72,14 @@ static absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
     const std::string& cell_library_path,
     const std::string& cell_library_proto_path) {
   if (!cell_library_proto_path.empty()) {
-    XLS_ASSIGN_OR_RETURN(std::string proto_text,
-                         GetFileContents(cell_library_proto_path));
-    netlist::CellLibraryProto lib_proto;
-    XLS_RET_CHECK(lib_proto.ParseFromString(proto_text));
+    XLS_ASSIGN_OR_RETURN(
+        netlist::CellLibraryProto lib_proto,
+        netlist::ReadCellLibraryProto(cell_library_proto_path));
     return netlist::CellLibrary::FromProto(lib_proto);
   }
-  XLS_ASSIGN_OR_RETURN(std::string cell_library_text,
-                       GetFileContents(cell_library_path));
   XLS_ASSIGN_OR_RETURN(
       auto char_stream,
-      netlist::cell_lib::CharStream::FromText(cell_library_text));
+      netlist::cell_lib::CharStream::FromPath(cell_library_path));
   XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto lib_proto,
                        netlist::function::ExtractFunctions(&char_stream));
   return netlist::CellLibrary::FromProto(lib_proto);
@@ -88,15 +91,19 @@ static absl::Status RealMain(const std::string& netlist_path,
                              const std::string& module_name,
                              absl::Span<const std::string> inputs,
                              const std::string& output_type_string,
-                             absl::Span<const std::string> dump_cells) {
+                             absl::Span<const std::string> dump_cells,
+                             bool compiled) {
   XLS_ASSIGN_OR_RETURN(
       netlist::CellLibrary cell_library,
       GetCellLibrary(cell_library_path, cell_library_proto_path));
 
-  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
-  XLS_ASSIGN_OR_RETURN(auto netlist, netlist::rtl::Parser::ParseNetlist(
-                                         &cell_library, &scanner));
+  // Post-synthesis netlists can be very large, so scan them in place and only
+  // build the modules needed to interpret `module_name`.
+  XLS_ASSIGN_OR_RETURN(MappedFile netlist_file, MappedFile::Open(netlist_path));
+  netlist::rtl::Scanner scanner(netlist_file.contents());
+  XLS_ASSIGN_OR_RETURN(auto netlist,
+                       netlist::rtl::Parser::ParseNetlist(
+                           &cell_library, &scanner, module_name));
   XLS_ASSIGN_OR_RETURN(const auto* module, netlist->GetModule(module_name));
 
   // Input values are listed in the same order as inputs are declared by
@@ -129,9 +136,17 @@ static absl::Status RealMain(const std::string& netlist_path,
     input_nets[in] = input_bits.Get(module->GetInputPortOffset(in->name()));
   }
 
-  netlist::Interpreter interpreter(netlist.get());
-  XLS_ASSIGN_OR_RETURN(auto output_nets, interpreter.InterpretModule(
-                                             module, input_nets, dump_cells));
+  netlist::NetRef2Value output_nets;
+  if (compiled) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<netlist::CompiledInterpreter> interpreter,
+        netlist::CompiledInterpreter::Create(netlist.get(), module));
+    XLS_ASSIGN_OR_RETURN(output_nets, interpreter->InterpretModule(input_nets));
+  } else {
+    netlist::Interpreter interpreter(netlist.get());
+    XLS_ASSIGN_OR_RETURN(output_nets, interpreter.InterpretModule(
+                                          module, input_nets, dump_cells));
+  }
 
   BitsRope rope(output_nets.size());
   for (const netlist::rtl::NetRef ref : module->outputs()) {
@@ -181,7 +196,11 @@ int main(int argc, char* argv[]) {
 
   std::string output_type = absl::GetFlag(FLAGS_output_type);
 
-  return xls::ExitStatus(xls::RealMain(netlist_path, cell_library_path,
-                                       cell_library_proto_path, module_name,
-                                       inputs, output_type, dump_cells));
+  bool compiled = absl::GetFlag(FLAGS_compiled);
+  QCHECK(!compiled || dump_cells_str.empty())
+      << "--dump_cells is not supported with --compiled.";
+
+  return xls::ExitStatus(xls::RealMain(
+      netlist_path, cell_library_path, cell_library_proto_path, module_name,
+      inputs, output_type, dump_cells, compiled));
 }
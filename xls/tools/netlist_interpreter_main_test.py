@@ -25,12 +25,17 @@ NETLIST_INTERPRETER_MAIN = runfiles.get_path(XLS_TOOLS +
 CELL_LIBRARY = runfiles.get_path(XLS_TOOLS + 'testdata/simple_cell.lib')
 
 
-def run_netlist_interpreter(netlist, module, input_data, output_type):
+def run_netlist_interpreter(netlist,
+                            module,
+                            input_data,
+                            output_type,
+                            compiled=False):
   result = subprocess.check_output([
       NETLIST_INTERPRETER_MAIN,
       '--netlist=' + runfiles.get_path(XLS_TOOLS + netlist),
       '--module_name=' + module, '--input=' + input_data,
-      '--output_type=' + output_type, '--cell_library=' + CELL_LIBRARY
+      '--output_type=' + output_type, '--cell_library=' + CELL_LIBRARY,
+      '--compiled=' + str(compiled).lower()
   ])
   return result.decode('utf-8').strip()
 
@@ -48,6 +53,17 @@ class NetlistTranspilerMainTest(test_base.TestCase):
                                   'bits[8]')
     self.assertEqual(res, 'bits[8]:0xaa')
 
+  def test_sqrt_compiled(self):
+    res = run_netlist_interpreter('testdata/sqrt.v', 'isqrt', 'bits[16]:100',
+                                  'bits[8]', compiled=True)
+    self.assertEqual(res, 'bits[8]:0xa')
+
+  def test_ifte_compiled(self):
+    res = run_netlist_interpreter('testdata/ifte.v', 'ifte',
+                                  'bits[1]:1;bits[8]:0xaa;bits[8]:0xbb',
+                                  'bits[8]', compiled=True)
+    self.assertEqual(res, 'bits[8]:0xaa')
+
 
 if __name__ == '__main__':
   test_base.main()
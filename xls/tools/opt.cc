@@ -14,32 +14,262 @@
 
 #include "xls/tools/opt.h"
 
+#include <array>
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <system_error>  // NOLINT
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/ir/verifier.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/verifier_checker.h"
+#include "openssl/sha.h"
 
 namespace xls::tools {
+namespace {
+
+// Bump to invalidate the entries of existing optimized function caches.
+constexpr std::string_view kOptCacheVersion = "xls-opt-cache-v1";
+
+std::string OptionalToString(const std::optional<int64_t>& value) {
+  return value.has_value() ? absl::StrCat(*value) : "none";
+}
+
+// Returns the part of the cache keys of the functions of `package` which does
+// not depend on the function: the options which affect the optimization of a
+// function and the file table which gives meaning to source locations. RAM
+// rewrites and proc inlining only affect procs, which are not cached.
+std::string OptCacheKeyPrefix(const Package& package,
+                              const OptOptions& options) {
+  std::vector<std::string> files;
+  for (const auto& [fileno, name] : package.fileno_to_name()) {
+    files.push_back(absl::StrCat(fileno.value(), ":", name));
+  }
+  absl::c_sort(files);
+  return absl::StrCat(
+      kOptCacheVersion, "\nopt_level=", options.opt_level,
+      "\npasses=", options.pass_list.value_or("default"),
+      "\nskip_passes=", absl::StrJoin(options.skip_passes, ","),
+      "\nconvert_array_index_to_select=",
+      OptionalToString(options.convert_array_index_to_select),
+      "\nsplit_next_value_selects=",
+      OptionalToString(options.split_next_value_selects),
+      "\nuse_context_narrowing_analysis=",
+      options.use_context_narrowing_analysis ? "true" : "false",
+      "\ncontext_narrowing_analysis_budget=",
+      OptionalToString(options.context_narrowing_analysis_budget),
+      "\nunroll_node_budget=", OptionalToString(options.unroll_node_budget),
+      "\ninlining_staging_threshold=",
+      OptionalToString(options.inlining_staging_threshold),
+      "\nfiles=", absl::StrJoin(files, ","), "\n");
+}
+
+// Returns the key of `f`: its IR and that of its transitive callees, as
+// given, under the options summarized by `prefix`.
+std::string OptCacheKey(std::string_view prefix, Function* f) {
+  std::string key(prefix);
+  for (FunctionBase* dependency : GetDependentFunctions(f)) {
+    absl::StrAppend(&key, dependency->DumpIr());
+  }
+  return key;
+}
+
+std::filesystem::path OptCachePath(const std::filesystem::path& cache_dir,
+                                   std::string_view key) {
+  std::array<uint8_t, SHA256_DIGEST_LENGTH> digest;
+  SHA256(reinterpret_cast<const uint8_t*>(key.data()), key.size(),
+         digest.data());
+  return cache_dir /
+         absl::StrCat(absl::BytesToHexString(std::string_view(
+                          reinterpret_cast<const char*>(digest.data()),
+                          digest.size())),
+                      ".ir");
+}
+
+// Replaces the body of `f` with that of the function in `function_ir`, which
+// must have the same name and parameter types as `f`. The callers of `f` are
+// unaffected. If the function does not match `f`, `f` is left unchanged.
+absl::Status ReplaceFunctionBody(Function* f, std::string_view function_ir) {
+  std::string name = f->name();
+  f->SetName(absl::StrCat(name, "__opt_cache_stale"));
+  absl::StatusOr<Function*> replacement =
+      Parser::ParseFunction(function_ir, f->package(),
+                            /*verify_function_only=*/true);
+  f->SetName(name);
+  XLS_RETURN_IF_ERROR(replacement.status());
+  absl::Status status = [&]() -> absl::Status {
+    XLS_RET_CHECK_EQ((*replacement)->name(), name);
+    XLS_RET_CHECK_EQ((*replacement)->params().size(), f->params().size());
+    for (int64_t i = 0; i < f->params().size(); ++i) {
+      XLS_RET_CHECK_EQ((*replacement)->param(i)->GetType(),
+                       f->param(i)->GetType());
+    }
+    return absl::OkStatus();
+  }();
+  if (status.ok()) {
+    std::vector<Node*> stale_nodes;
+    for (Node* node : ReverseTopoSort(f)) {
+      if (!node->Is<Param>()) {
+        stale_nodes.push_back(node);
+      }
+    }
+    absl::flat_hash_map<Node*, Node*> node_map;
+    for (int64_t i = 0; i < f->params().size(); ++i) {
+      node_map[(*replacement)->param(i)] = f->param(i);
+    }
+    for (Node* node : TopoSort(*replacement)) {
+      if (node->Is<Param>()) {
+        continue;
+      }
+      std::vector<Node*> operands;
+      for (Node* operand : node->operands()) {
+        operands.push_back(node_map.at(operand));
+      }
+      XLS_ASSIGN_OR_RETURN(node_map[node],
+                           node->CloneInNewFunction(operands, f));
+    }
+    XLS_RETURN_IF_ERROR(
+        f->set_return_value(node_map.at((*replacement)->return_value())));
+    for (Node* node : stale_nodes) {
+      XLS_RETURN_IF_ERROR(f->RemoveNode(node));
+    }
+  }
+  XLS_RETURN_IF_ERROR(f->package()->RemoveFunction(*replacement));
+  return status;
+}
+
+// Returns the IR of `f` optimized as the top of a package holding only it and
+// its callees.
+absl::StatusOr<std::string> OptimizeFunctionInIsolation(
+    Function* f, const OptimizationCompoundPass& pipeline,
+    OptimizationPassOptions pass_options) {
+  Package package(f->package()->name());
+  XLS_ASSIGN_OR_RETURN(Function * clone,
+                       CloneFunctionAndItsDependencies(f, f->name(), &package));
+  XLS_RETURN_IF_ERROR(package.SetTop(clone));
+  QueryEngineCache query_engine_cache;
+  pass_options.query_engine_cache = &query_engine_cache;
+  FunctionBaseChangeTracker change_tracker;
+  pass_options.change_tracker = &change_tracker;
+  PassResults results;
+  XLS_RETURN_IF_ERROR(pipeline.Run(&package, pass_options, &results).status());
+  return clone->DumpIr();
+}
+
+// Replaces the body of each non-top function of `package` which is called by
+// another function or proc with its optimized body. The optimized body is read
+// from `cache_dir` if a function and its callees are unchanged since it was
+// stored and is otherwise computed and stored. Functions are handled callees
+// first so that the callees of a changed function are already optimized when
+// it is optimized. The package pipeline then mostly optimizes the top and
+// what is exposed by inlining the optimized bodies.
+absl::Status ApplyOptCache(Package* package,
+                           const std::filesystem::path& cache_dir,
+                           const OptOptions& options,
+                           const OptimizationCompoundPass& pipeline,
+                           const OptimizationPassOptions& pass_options) {
+  std::vector<FunctionBase*> function_bases = FunctionsInPostOrder(package);
+  absl::flat_hash_set<FunctionBase*> callees;
+  for (FunctionBase* f : function_bases) {
+    for (FunctionBase* dependency : GetDependentFunctions(f)) {
+      if (dependency != f) {
+        callees.insert(dependency);
+      }
+    }
+  }
+  // Keys must be computed from the IR as given, before any body is replaced.
+  std::string prefix = OptCacheKeyPrefix(*package, options);
+  std::optional<FunctionBase*> top = package->GetTop();
+  std::vector<std::pair<Function*, std::filesystem::path>> cached_functions;
+  for (FunctionBase* f : function_bases) {
+    if (!f->IsFunction() || !callees.contains(f) || top == f ||
+        f->ForeignFunctionData().has_value()) {
+      continue;
+    }
+    Function* function = f->AsFunctionOrDie();
+    cached_functions.push_back(
+        {function, OptCachePath(cache_dir, OptCacheKey(prefix, function))});
+  }
+
+  OptimizationPassOptions isolated_options = pass_options;
+  isolated_options.ir_dump_path = "";
+  isolated_options.record_memory_usage = false;
+  int64_t hits = 0;
+  for (const auto& [f, path] : cached_functions) {
+    if (FileExists(path).ok()) {
+      absl::StatusOr<std::string> cached_ir = GetFileContents(path);
+      absl::Status status = cached_ir.ok()
+                                ? ReplaceFunctionBody(f, *cached_ir)
+                                : cached_ir.status();
+      if (status.ok()) {
+        ++hits;
+        continue;
+      }
+      LOG(WARNING) << "Unable to use optimized IR of `" << f->name()
+                   << "` cached in " << path << ": " << status;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        std::string optimized_ir,
+        OptimizeFunctionInIsolation(f, pipeline, isolated_options));
+    XLS_RETURN_IF_ERROR(ReplaceFunctionBody(f, optimized_ir));
+    // Write to a temporary file and rename so that concurrent readers never
+    // see a partially written file.
+    std::filesystem::path temp_path = path;
+    temp_path += ".tmp";
+    absl::Status status = RecursivelyCreateDir(cache_dir);
+    if (status.ok()) {
+      status = SetFileContents(temp_path, optimized_ir);
+    }
+    if (status.ok()) {
+      std::error_code error;
+      std::filesystem::rename(temp_path, path, error);
+      if (error) {
+        status = absl::InternalError(error.message());
+      }
+    }
+    if (!status.ok()) {
+      LOG(WARNING) << "Unable to write optimized IR cache file " << path
+                   << ": " << status;
+    }
+  }
+  VLOG(1) << absl::StreamFormat(
+      "Optimized IR cache: %d hits, %d misses of %d callees", hits,
+      cached_functions.size() - hits, cached_functions.size());
+  return absl::OkStatus();
+}
+
+}  // namespace
 
 absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
                                              const OptOptions& options) {
@@ -84,10 +314,40 @@ absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
   pass_options.ram_rewrites = options.ram_rewrites;
   pass_options.use_context_narrowing_analysis =
       options.use_context_narrowing_analysis;
+  pass_options.context_narrowing_analysis_budget =
+      options.context_narrowing_analysis_budget;
+  pass_options.unroll_node_budget = options.unroll_node_budget;
+  pass_options.inlining_staging_threshold = options.inlining_staging_threshold;
   pass_options.bisect_limit = options.bisect_limit;
+  pass_options.thread_count = options.opt_threads;
+  pass_options.incremental_verification_interval =
+      options.incremental_verification_interval;
+  pass_options.record_memory_usage = options.pass_profile_path.has_value();
+  QueryEngineCache query_engine_cache;
+  pass_options.query_engine_cache = &query_engine_cache;
+  FunctionBaseChangeTracker change_tracker;
+  pass_options.change_tracker = &change_tracker;
+  if (options.opt_cache_dir.has_value()) {
+    if (options.bisect_limit.has_value()) {
+      LOG(WARNING) << "Ignoring the optimized IR cache as a bisect limit is "
+                      "set.";
+    } else {
+      XLS_RETURN_IF_ERROR(ApplyOptCache(package.get(), *options.opt_cache_dir,
+                                        options, *pipeline, pass_options));
+    }
+  }
   PassResults results;
   XLS_RETURN_IF_ERROR(
       pipeline->Run(package.get(), pass_options, &results).status());
+  if (options.incremental_verification_interval.has_value()) {
+    // Incremental verification leaves some invariants to the periodic full
+    // verification; make sure the final IR satisfies all of them.
+    XLS_RETURN_IF_ERROR(VerifyPackage(package.get()));
+  }
+  if (options.pass_profile_path.has_value()) {
+    XLS_RETURN_IF_ERROR(SetTextProtoFile(*options.pass_profile_path,
+                                         PassResultsToProfileProto(results)));
+  }
   return package->DumpIr();
 }
 
@@ -97,8 +357,14 @@ absl::StatusOr<std::string> OptimizeIrForTop(
     int64_t convert_array_index_to_select, int64_t split_next_value_selects,
     bool inline_procs, std::string_view ram_rewrites_pb,
     bool use_context_narrowing_analysis, std::optional<std::string> pass_list,
-    std::optional<int64_t> bisect_limit) {
-  XLS_ASSIGN_OR_RETURN(std::string ir, GetFileContents(input_path));
+    std::optional<int64_t> bisect_limit, int64_t opt_threads,
+    std::optional<std::string> pass_profile_path,
+    std::optional<int64_t> context_narrowing_analysis_budget,
+    std::optional<int64_t> unroll_node_budget,
+    std::optional<int64_t> inlining_staging_threshold,
+    std::optional<std::string> opt_cache_dir,
+    std::optional<int64_t> incremental_verification_interval) {
+  XLS_ASSIGN_OR_RETURN(MappedFile ir_file, MappedFile::Open(input_path));
   std::vector<RamRewrite> ram_rewrites;
   if (!ram_rewrites_pb.empty()) {
     RamRewritesProto ram_rewrite_proto;
@@ -123,10 +389,17 @@ absl::StatusOr<std::string> OptimizeIrForTop(
       .inline_procs = inline_procs,
       .ram_rewrites = std::move(ram_rewrites),
       .use_context_narrowing_analysis = use_context_narrowing_analysis,
+      .context_narrowing_analysis_budget = context_narrowing_analysis_budget,
+      .unroll_node_budget = unroll_node_budget,
+      .inlining_staging_threshold = inlining_staging_threshold,
       .pass_list = std::move(pass_list),
       .bisect_limit = bisect_limit,
+      .opt_threads = opt_threads,
+      .pass_profile_path = std::move(pass_profile_path),
+      .opt_cache_dir = std::move(opt_cache_dir),
+      .incremental_verification_interval = incremental_verification_interval,
   };
-  return OptimizeIrForTop(ir, options);
+  return OptimizeIrForTop(ir_file.contents(), options);
 }
 
 }  // namespace xls::tools
@@ -44,8 +44,29 @@ struct OptOptions {
   bool inline_procs;
   std::vector<RamRewrite> ram_rewrites = {};
   bool use_context_narrowing_analysis;
+  // Bound on the node evaluations of the context sensitive narrowing analysis
+  // of each function.
+  std::optional<int64_t> context_narrowing_analysis_budget = std::nullopt;
+  // Bound on the nodes added by unrolling each loop. If set, loops are unrolled
+  // and simplified one iteration at a time.
+  std::optional<int64_t> unroll_node_budget = std::nullopt;
+  // Size above which reused callees are optimized before being inlined.
+  std::optional<int64_t> inlining_staging_threshold = std::nullopt;
   std::optional<std::string> pass_list;
   std::optional<int64_t> bisect_limit;
+  // Number of threads used to run passes on independent functions and procs.
+  int64_t opt_threads = 1;
+  // If set, a text-format PassPipelineProfileProto describing the time spent
+  // in each pass and the changes it made is written to this path.
+  std::optional<std::string> pass_profile_path = std::nullopt;
+  // If set, the optimized bodies of the non-top functions of the package are
+  // cached in this directory keyed by a fingerprint of their IR, that of their
+  // callees and the options. A function whose key is found is not optimized
+  // again; the package pipeline is then run on the whole package.
+  std::optional<std::string> opt_cache_dir = std::nullopt;
+  // If set, only the nodes changed by each pass are verified and the entire
+  // package is verified every this many verifier runs and once at the end.
+  std::optional<int64_t> incremental_verification_interval = std::nullopt;
 };
 
 // Helper used in the opt_main tool, optimizes the given IR for a particular
@@ -62,7 +83,13 @@ absl::StatusOr<std::string> OptimizeIrForTop(
     int64_t convert_array_index_to_select, int64_t split_next_value_selects,
     bool inline_procs, std::string_view ram_rewrites_pb,
     bool use_context_narrowing_analysis, std::optional<std::string> pass_list,
-    std::optional<int64_t> bisect_limit);
+    std::optional<int64_t> bisect_limit, int64_t opt_threads = 1,
+    std::optional<std::string> pass_profile_path = std::nullopt,
+    std::optional<int64_t> context_narrowing_analysis_budget = std::nullopt,
+    std::optional<int64_t> unroll_node_budget = std::nullopt,
+    std::optional<int64_t> inlining_staging_threshold = std::nullopt,
+    std::optional<std::string> opt_cache_dir = std::nullopt,
+    std::optional<int64_t> incremental_verification_interval = std::nullopt);
 
 }  // namespace xls::tools
 
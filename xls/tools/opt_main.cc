@@ -110,6 +110,46 @@ ABSL_FLAG(
 ABSL_FLAG(std::optional<int64_t>, passes_bisect_limit, std::nullopt,
           "Number of passes to allow to execute. This can be used as compiler "
           "fuel to ensure the compiler finishes at a particular point.");
+ABSL_FLAG(std::optional<int64_t>, context_narrowing_analysis_budget,
+          std::nullopt,
+          "If set, the maximum number of node evaluations the context "
+          "sensitive narrowing analysis performs for each function. Select "
+          "cases beyond the budget are not used for narrowing.");
+ABSL_FLAG(std::optional<int64_t>, unroll_node_budget, std::nullopt,
+          "If set, counted for loops are unrolled one iteration at a time "
+          "with each iteration inlined and simplified, and unrolling of a loop "
+          "stops once it has added this many nodes. The remaining iterations "
+          "are left as a counted for.");
+ABSL_FLAG(std::optional<int64_t>, inlining_staging_threshold, std::nullopt,
+          "If set, callees invoked from several call sites whose node count "
+          "times their number of call sites is at least this value are "
+          "optimized before being inlined rather than after.");
+ABSL_FLAG(int64_t, opt_threads, 1,
+          "Number of threads used to run function- and proc-level passes. "
+          "Values greater than one run each such pass concurrently on the "
+          "functions and procs of the package when none of them call another "
+          "function (e.g., after inlining). The output is identical to a "
+          "single-threaded run.");
+ABSL_FLAG(std::optional<std::string>, pass_profile_path, std::nullopt,
+          "If specified, write a text-format PassPipelineProfileProto to this "
+          "path listing the run count, total run time, change in IR size and "
+          "peak estimated IR and analysis memory of each pass, and the "
+          "iteration count of each fixed-point pass.");
+ABSL_FLAG(std::optional<std::string>, opt_cache_dir, std::nullopt,
+          "If specified, directory in which the optimized bodies of the "
+          "functions called by the top are cached across runs, keyed by a "
+          "fingerprint of the function, its callees and the options. Only "
+          "functions which changed since they were cached are optimized on "
+          "their own before the whole package is optimized. The output is "
+          "equivalent to, but not necessarily identical to, that of a run "
+          "without a cache.");
+ABSL_FLAG(std::optional<int64_t>, incremental_verification_interval,
+          std::nullopt,
+          "If specified, the IR verifier run between passes checks only the "
+          "nodes changed by the previous pass, and verifies the entire package "
+          "only every this many runs and once after the last pass. Speeds up "
+          "optimization of large packages at the cost of catching some "
+          "malformed IR later than the pass which produced it.");
 ABSL_FLAG(bool, list_passes, false,
           "If passed list the names of all passes and exit.");
 
@@ -176,6 +216,24 @@ absl::Status RealMain(std::string_view input_path) {
   std::optional<std::string> pass_list = absl::GetFlag(FLAGS_passes);
   std::optional<int64_t> bisect_limit =
       absl::GetFlag(FLAGS_passes_bisect_limit);
+  int64_t opt_threads = absl::GetFlag(FLAGS_opt_threads);
+  std::optional<std::string> pass_profile_path =
+      absl::GetFlag(FLAGS_pass_profile_path);
+  std::optional<int64_t> context_narrowing_analysis_budget =
+      absl::GetFlag(FLAGS_context_narrowing_analysis_budget);
+  std::optional<int64_t> unroll_node_budget =
+      absl::GetFlag(FLAGS_unroll_node_budget);
+  std::optional<int64_t> inlining_staging_threshold =
+      absl::GetFlag(FLAGS_inlining_staging_threshold);
+  std::optional<std::string> opt_cache_dir =
+      absl::GetFlag(FLAGS_opt_cache_dir);
+  std::optional<int64_t> incremental_verification_interval =
+      absl::GetFlag(FLAGS_incremental_verification_interval);
+  if (incremental_verification_interval.has_value() &&
+      *incremental_verification_interval <= 0) {
+    return absl::InvalidArgumentError(
+        "--incremental_verification_interval must be positive");
+  }
 
   XLS_ASSIGN_OR_RETURN(
       std::string opt_ir,
@@ -190,7 +248,16 @@ absl::Status RealMain(std::string_view input_path) {
           /*ram_rewrites_pb=*/ram_rewrites_pb,
           /*use_context_narrowing_analysis=*/use_context_narrowing_analysis,
           /*pass_list=*/pass_list,
-          /*bisect_limit=*/bisect_limit));
+          /*bisect_limit=*/bisect_limit,
+          /*opt_threads=*/opt_threads,
+          /*pass_profile_path=*/pass_profile_path,
+          /*context_narrowing_analysis_budget=*/
+          context_narrowing_analysis_budget,
+          /*unroll_node_budget=*/unroll_node_budget,
+          /*inlining_staging_threshold=*/inlining_staging_threshold,
+          /*opt_cache_dir=*/opt_cache_dir,
+          /*incremental_verification_interval=*/
+          incremental_verification_interval));
 
   if (output_path == "-") {
     std::cout << opt_ir;
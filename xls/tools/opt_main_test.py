@@ -15,6 +15,7 @@
 
 """Tests for xls.tools.codegen_main."""
 
+import os
 import subprocess
 
 from xls.common import runfiles
@@ -51,6 +52,20 @@ top fn add_zero(x: bits[32]) -> bits[32] {
 }
 """
 
+INVOKE_IR_TEMPLATE = """package invoke
+
+fn callee(x: bits[32]) -> bits[32] {
+  literal.1: bits[32] = literal(value=0)
+  ret add.2: bits[32] = add(x, literal.1)
+}
+
+top fn main(x: bits[32]) -> bits[32] {
+  invoke.3: bits[32] = invoke(x, to_apply=callee)
+  literal.4: bits[32] = literal(value=%d)
+  ret add.5: bits[32] = add(invoke.3, literal.4)
+}
+"""
+
 
 class OptMainTest(test_base.TestCase):
 
@@ -184,6 +199,40 @@ class OptMainTest(test_base.TestCase):
     # add is not removed since the DCE was not run.
     self.assertIn('bits[32] = add', optimized_ir)
 
+  def test_opt_cache_dir(self):
+    cache_dir = self.create_tempdir().full_path
+
+    # The first run populates the cache with the optimized callee and later
+    # runs reuse it.
+    ir_file = self.create_tempfile(content=INVOKE_IR_TEMPLATE % 1)
+    optimized_ir = subprocess.check_output(
+        [OPT_MAIN_PATH, '--opt_cache_dir', cache_dir, ir_file.full_path]
+    ).decode('utf-8')
+    self.assertNotIn('invoke', optimized_ir)
+    self.assertLen(os.listdir(cache_dir), 1)
+    self.assertEqual(
+        optimized_ir,
+        subprocess.check_output(
+            [OPT_MAIN_PATH, '--opt_cache_dir', cache_dir, ir_file.full_path]
+        ).decode('utf-8'),
+    )
+
+    # Changing only the top reuses the cached callee.
+    ir_file = self.create_tempfile(content=INVOKE_IR_TEMPLATE % 2)
+    optimized_ir = subprocess.check_output(
+        [OPT_MAIN_PATH, '--opt_cache_dir', cache_dir, ir_file.full_path]
+    ).decode('utf-8')
+    self.assertIn('literal(value=2', optimized_ir)
+    self.assertNotIn('invoke', optimized_ir)
+    self.assertLen(os.listdir(cache_dir), 1)
+
+    # Changing the options does not.
+    subprocess.check_output([
+        OPT_MAIN_PATH, '--opt_cache_dir', cache_dir, '--opt_level=1',
+        ir_file.full_path
+    ])
+    self.assertLen(os.listdir(cache_dir), 2)
+
 
 if __name__ == '__main__':
   test_base.main()
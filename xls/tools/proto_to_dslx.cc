@@ -35,6 +35,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
 #include "google/protobuf/compiler/importer.h"
@@ -882,8 +883,11 @@ absl::Status EmitIntegralData(
   }
 
   uint64_t value = GetFieldValue(message, *reflection, *fd);
+  std::string text = IsFieldSigned(field_type)
+                         ? absl::StrCat(static_cast<int64_t>(value))
+                         : absl::StrCat(value);
   dslx::Number* number = module->Make<dslx::Number>(
-      span, absl::StrCat(value), dslx::NumberKind::kOther, array_elem_type);
+      span, text, dslx::NumberKind::kOther, array_elem_type);
   elements->push_back(std::make_pair(field_name, number));
 
   return absl::OkStatus();
@@ -933,6 +937,180 @@ absl::StatusOr<dslx::Expr*> EmitData(const std::string& top_package,
   return module->Make<dslx::StructInstance>(span, struct_def, elements);
 }
 
+// Writes the DSLX text for message instances holding the same values as the
+// Emit*Data functions above, but directly, without creating an AST node per
+// field or array element. Repeated integral fields are written as a single typed array
+// literal, e.g., "sN[64][3]:[1, -2, 0]", rather than typing every element.
+class DataWriter {
+ public:
+  DataWriter(const std::string& top_package, const NameToRecord& name_to_record,
+             std::string* out)
+      : top_package_(top_package),
+        name_to_record_(name_to_record),
+        out_(out) {}
+
+  absl::Status WriteMessage(const Message& message) {
+    const Descriptor* descriptor = message.GetDescriptor();
+    XLS_ASSIGN_OR_RETURN(const MessageRecord* message_record,
+                         GetRecord(descriptor));
+    const Reflection* reflection = message.GetReflection();
+    absl::StrAppend(out_, message_record->name, " { ");
+    bool first = true;
+    for (int field_idx = 0; field_idx < descriptor->field_count();
+         field_idx++) {
+      const FieldDescriptor* fd = descriptor->field(field_idx);
+      const MessageRecord::ChildElement& element =
+          message_record->children.at(fd->name());
+      if (element.unsupported || element.count == 0) {
+        continue;
+      }
+      if (!first) {
+        absl::StrAppend(out_, ", ");
+      }
+      first = false;
+      absl::StrAppend(out_, fd->name(), ": ");
+      if (!fd->is_repeated()) {
+        XLS_RETURN_IF_ERROR(WriteElement(message, *reflection, *fd));
+        continue;
+      }
+
+      int num_elements = reflection->FieldSize(message, fd);
+      if (num_elements > element.count) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Field %s has %d elements, but its type was sized for at most %d.",
+            fd->full_name(), num_elements, element.count));
+      }
+      if (fd->type() != FieldDescriptor::Type::TYPE_MESSAGE &&
+          fd->type() != FieldDescriptor::Type::TYPE_ENUM) {
+        absl::StrAppend(out_, IntegralTypeName(fd->type()), "[",
+                        element.count, "]:");
+      }
+      absl::StrAppend(out_, "[");
+      for (int i = 0; i < element.count; i++) {
+        if (i != 0) {
+          absl::StrAppend(out_, ", ");
+        }
+        if (i < num_elements) {
+          XLS_RETURN_IF_ERROR(WriteElement(message, *reflection, *fd, i));
+        } else {
+          XLS_RETURN_IF_ERROR(WriteZeroElement(*reflection, *fd));
+        }
+      }
+      absl::StrAppend(out_, "], ", fd->name(), "_count: u32:", num_elements);
+    }
+    absl::StrAppend(out_, " }");
+    return absl::OkStatus();
+  }
+
+ private:
+  // Returns the DSLX name of the given integral type, e.g., "uN[32]".
+  static std::string IntegralTypeName(FieldDescriptor::Type type) {
+    return absl::StrCat(IsFieldSigned(type) ? "sN[" : "uN[",
+                        GetFieldWidth(type), "]");
+  }
+
+  // Writes a single (or, if "index" is set, a single repeated) value of the
+  // given field. Elements of repeated integral fields are written untyped, as
+  // the enclosing array literal carries their type.
+  absl::Status WriteElement(const Message& message,
+                            const Reflection& reflection,
+                            const FieldDescriptor& fd,
+                            std::optional<int> index = std::nullopt) {
+    switch (fd.type()) {
+      case FieldDescriptor::Type::TYPE_MESSAGE:
+        return WriteMessage(
+            index ? reflection.GetRepeatedMessage(message, &fd, *index)
+                  : reflection.GetMessage(message, &fd));
+      case FieldDescriptor::Type::TYPE_ENUM: {
+        const google::protobuf::EnumValueDescriptor* evd =
+            index ? reflection.GetRepeatedEnum(message, &fd, *index)
+                  : reflection.GetEnum(message, &fd);
+        XLS_ASSIGN_OR_RETURN(const MessageRecord* enum_record,
+                             GetRecord(evd->type()));
+        absl::StrAppend(out_, enum_record->name, "::", evd->name());
+        return absl::OkStatus();
+      }
+      default:
+        break;
+    }
+    if (!index) {
+      absl::StrAppend(out_, IntegralTypeName(fd.type()), ":");
+    }
+    uint64_t value = GetFieldValue(message, reflection, fd, index);
+    if (IsFieldSigned(fd.type())) {
+      absl::StrAppend(out_, static_cast<int64_t>(value));
+    } else {
+      absl::StrAppend(out_, value);
+    }
+    return absl::OkStatus();
+  }
+
+  // Writes the zero-valued element used to pad out the given repeated field.
+  absl::Status WriteZeroElement(const Reflection& reflection,
+                                const FieldDescriptor& fd) {
+    switch (fd.type()) {
+      case FieldDescriptor::Type::TYPE_MESSAGE: {
+        XLS_ASSIGN_OR_RETURN(
+            const std::string* zero,
+            GetZeroMessage(*reflection.GetMessageFactory()->GetPrototype(
+                fd.message_type())));
+        absl::StrAppend(out_, *zero);
+        return absl::OkStatus();
+      }
+      case FieldDescriptor::Type::TYPE_ENUM: {
+        XLS_ASSIGN_OR_RETURN(const MessageRecord* enum_record,
+                             GetRecord(fd.enum_type()));
+        absl::StrAppend(out_, enum_record->name,
+                        "::", fd.enum_type()->value(0)->name());
+        return absl::OkStatus();
+      }
+      default:
+        absl::StrAppend(out_, "0");
+        return absl::OkStatus();
+    }
+  }
+
+  // Returns the text of the given default (i.e., zero-valued) message, which
+  // is computed once per type as padding can repeat it many times.
+  absl::StatusOr<const std::string*> GetZeroMessage(
+      const Message& prototype) {
+    const Descriptor* descriptor = prototype.GetDescriptor();
+    if (auto it = zero_messages_.find(descriptor); it != zero_messages_.end()) {
+      return &it->second;
+    }
+    std::string zero;
+    std::string* out = std::exchange(out_, &zero);
+    absl::Status status = WriteMessage(prototype);
+    out_ = out;
+    XLS_RETURN_IF_ERROR(status);
+    zero_messages_[descriptor] = std::move(zero);
+    return &zero_messages_.at(descriptor);
+  }
+
+  // Returns the record for the given message or enum type, caching the lookup
+  // since computing the record name is relatively expensive.
+  template <typename DescriptorT>
+  absl::StatusOr<const MessageRecord*> GetRecord(
+      const DescriptorT* descriptor) {
+    auto it = records_.find(descriptor);
+    if (it != records_.end()) {
+      return it->second;
+    }
+    auto record_it =
+        name_to_record_.find(GetParentPrefixedName(top_package_, descriptor));
+    XLS_RET_CHECK(record_it != name_to_record_.end())
+        << "No record for type " << descriptor->full_name();
+    records_[descriptor] = record_it->second.get();
+    return record_it->second.get();
+  }
+
+  const std::string& top_package_;
+  const NameToRecord& name_to_record_;
+  std::string* out_;
+  absl::flat_hash_map<const void*, const MessageRecord*> records_;
+  absl::flat_hash_map<const Descriptor*, std::string> zero_messages_;
+};
+
 absl::StatusOr<std::unique_ptr<dslx::Module>> ProtoToDslxWithDescriptorPool(
     std::string_view message_name, std::string_view text_proto,
     std::string_view binding_name, DescriptorPool* descriptor_pool) {
@@ -954,6 +1132,27 @@ absl::StatusOr<std::unique_ptr<dslx::Module>> ProtoToDslxWithDescriptorPool(
   return module;
 }
 
+absl::StatusOr<std::string> ProtoToDslxTextWithDescriptorPool(
+    std::string_view message_name, std::string_view text_proto,
+    std::string_view binding_name, DescriptorPool* descriptor_pool) {
+  XLS_RET_CHECK(descriptor_pool != nullptr);
+
+  google::protobuf::DynamicMessageFactory factory;
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Message> new_message,
+                       ConstructProtoViaText(text_proto, message_name,
+                                             descriptor_pool, &factory));
+
+  dslx::Module module("the_module", /*fs_path=*/std::nullopt);
+
+  ProtoToDslxManager proto_to_dslx(&module);
+  std::string constant;
+  XLS_RETURN_IF_ERROR(proto_to_dslx.WriteProtoInstantiation(
+      binding_name, *new_message, &constant));
+
+  return absl::StrCat(module.ToString(), "\n", constant);
+}
+
 }  // namespace
 
 ProtoToDslxManager::ProtoToDslxManager(dslx::Module* module)
@@ -988,6 +1187,24 @@ absl::Status ProtoToDslxManager::AddProtoInstantiationToDslxModule(
   return absl::OkStatus();
 }
 
+absl::Status ProtoToDslxManager::WriteProtoInstantiation(
+    std::string_view binding_name, const Message& message, std::string* out) {
+  XLS_RET_CHECK(module_ != nullptr);
+
+  const Descriptor* descriptor = message.GetDescriptor();
+
+  if (!name_to_records_.contains(descriptor)) {
+    XLS_RETURN_IF_ERROR(AddProtoTypeToDslxModule(message));
+  }
+  std::string top_package = descriptor->file()->package();
+
+  absl::StrAppend(out, "pub const ", binding_name, " = ");
+  DataWriter writer(top_package, name_to_records_.at(descriptor), out);
+  XLS_RETURN_IF_ERROR(writer.WriteMessage(message));
+  absl::StrAppend(out, ";");
+  return absl::OkStatus();
+}
+
 absl::Status ProtoToDslxManager::AddProtoTypeToDslxModule(
     const Message& message) {
   XLS_RET_CHECK(module_ != nullptr);
@@ -1066,6 +1283,26 @@ absl::StatusOr<std::unique_ptr<dslx::Module>> ProtoToDslxViaText(
                                        descriptor_pool.get());
 }
 
+absl::StatusOr<std::string> ProtoToDslxText(
+    const std::filesystem::path& source_root,
+    const std::filesystem::path& proto_schema_path,
+    std::string_view message_name, std::string_view text_proto,
+    std::string_view binding_name) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<DescriptorPool> descriptor_pool,
+                       ProcessProtoSchema(source_root, proto_schema_path));
+  return ProtoToDslxTextWithDescriptorPool(message_name, text_proto,
+                                           binding_name, descriptor_pool.get());
+}
+
+absl::StatusOr<std::string> ProtoToDslxTextViaText(
+    std::string_view proto_def, std::string_view message_name,
+    std::string_view text_proto, std::string_view binding_name) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<DescriptorPool> descriptor_pool,
+                       ProcessStringProtoSchema(proto_def));
+  return ProtoToDslxTextWithDescriptorPool(message_name, text_proto,
+                                           binding_name, descriptor_pool.get());
+}
+
 absl::StatusOr<std::unique_ptr<Message>> ConstructProtoViaText(
     std::string_view text_proto, std::string_view message_name,
     DescriptorPool* descriptor_pool, google::protobuf::DynamicMessageFactory* factory) {
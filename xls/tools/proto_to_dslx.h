@@ -60,6 +60,17 @@ class ProtoToDslxManager {
   absl::Status AddProtoInstantiationToDslxModule(
       std::string_view binding_name, const google::protobuf::Message& message);
 
+  // As AddProtoInstantiationToDslxModule, but rather than adding the constant
+  // to the module, appends its DSLX definition as text to `out` (without a
+  // trailing newline). The type definitions are still added to the module.
+  // No AST is created for the constant's fields or array elements, and
+  // repeated integral fields are written as compact typed array literals
+  // (e.g., `uN[32][3]:[1, 2, 3]`), so this scales to messages with very large
+  // repeated fields.
+  absl::Status WriteProtoInstantiation(std::string_view binding_name,
+                                       const google::protobuf::Message& message,
+                                       std::string* out);
+
  private:
   // AddProtoTypeToDslxModule accepts a proto message and adds its type
   // definition into a corresponding DSLX module as a DSLX struct.
@@ -139,6 +150,18 @@ absl::StatusOr<std::unique_ptr<dslx::Module>> ProtoToDslxViaText(
     std::string_view proto_def, std::string_view message_name,
     std::string_view text_proto, std::string_view binding_name);
 
+// As ProtoToDslx and ProtoToDslxViaText, but returns the text of the DSLX
+// module with the constant written via
+// ProtoToDslxManager::WriteProtoInstantiation. Preferred for large messages.
+absl::StatusOr<std::string> ProtoToDslxText(
+    const std::filesystem::path& source_root,
+    const std::filesystem::path& proto_schema_path,
+    std::string_view message_name, std::string_view text_proto,
+    std::string_view binding_name);
+absl::StatusOr<std::string> ProtoToDslxTextViaText(
+    std::string_view proto_def, std::string_view message_name,
+    std::string_view text_proto, std::string_view binding_name);
+
 // Compiles the specified proto schema into a "Descriptor" (contained in the
 // returned pool), potentially loading dependent schema files along the way.
 // Args:
@@ -22,7 +22,7 @@
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
-#include "xls/dslx/frontend/module.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/tools/proto_to_dslx.h"
 
 ABSL_FLAG(std::string, proto_def_path, "",
@@ -50,10 +50,10 @@ static absl::Status RealMain(const std::string& source_root_path,
                              const std::string& var_name,
                              const std::string& output_path) {
   XLS_ASSIGN_OR_RETURN(std::string textproto, GetFileContents(textproto_path));
-  XLS_ASSIGN_OR_RETURN(auto module,
-                       ProtoToDslx(source_root_path, proto_def_path, proto_name,
-                                   textproto, var_name));
-  return SetFileContents(output_path, module->ToString());
+  XLS_ASSIGN_OR_RETURN(std::string dslx,
+                       ProtoToDslxText(source_root_path, proto_def_path,
+                                       proto_name, textproto, var_name));
+  return SetFileContents(output_path, dslx);
 }
 
 }  // namespace xls
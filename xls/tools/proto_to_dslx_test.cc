@@ -14,13 +14,22 @@
 
 #include "xls/tools/proto_to_dslx.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/log/check.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/dynamic_message.h"
+#include "google/protobuf/message.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/temp_directory.h"
 #include "xls/common/file/temp_file.h"
@@ -31,6 +40,9 @@
 namespace xls {
 namespace {
 
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
 // Shotgun test to cover a bunch of areas for basic functionality.
 TEST(ProtoToDslxTest, Smoke) {
   const std::string kSchema = R"(
@@ -517,5 +529,222 @@ pub const a1 = TypeA { index_a: uN[32]:10 };
 pub const a2 = TypeA { index_a: uN[32]:11 };)");
 }
 
+TEST(ProtoToDslxTest, TextWritesCompactArrays) {
+  const std::string kSchema = R"(
+syntax = "proto2";
+
+package xls;
+
+message Field {
+  optional int32 index = 1;
+  repeated int64 foo = 2;
+}
+
+message Fields {
+  repeated Field fields = 1;
+  optional Field loner = 2;
+}
+)";
+  std::string textproto = R"(
+fields {
+  index: -1
+  foo: 1
+  foo: -2
+  foo: 3
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string dslx,
+      ProtoToDslxTextViaText(kSchema, "xls.Fields", textproto, "foo"));
+  EXPECT_EQ(dslx,
+            R"(pub struct Field {
+    index: sN[32],
+    foo: sN[64][3],
+    foo_count: u32,
+}
+pub struct Fields {
+    fields: Field[1],
+    fields_count: u32,
+    loner: Field,
+}
+pub const foo = Fields { fields: [Field { index: sN[32]:-1, foo: sN[64][3]:[1, -2, 3], foo_count: u32:3 }], fields_count: u32:1, loner: Field { index: sN[32]:0, foo: sN[64][3]:[0, 0, 0], foo_count: u32:0 } };)");
+}
+
+TEST(ProtoToDslxTest, TextPadsNestedRepeatedFields) {
+  const std::string kSchema = R"(
+syntax = "proto2";
+
+package xls;
+
+enum Color {
+  RED = 0;
+  GREEN = 1;
+}
+
+message Entry {
+  repeated int32 values = 1;
+  optional Color color = 2;
+}
+
+message Group {
+  repeated Entry entries = 1;
+}
+
+message Top {
+  repeated Group groups = 1;
+}
+)";
+  std::string textproto = R"(
+groups {
+  entries {
+    values: 1
+    values: 2
+    color: GREEN
+  }
+  entries { values: 3 }
+}
+groups {}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string dslx,
+      ProtoToDslxTextViaText(kSchema, "xls.Top", textproto, "top"));
+  EXPECT_EQ(dslx,
+            R"(pub enum Color : bits[1] {
+    RED = 0,
+    GREEN = 1,
+}
+pub struct Entry {
+    values: sN[32][2],
+    values_count: u32,
+    color: Color,
+}
+pub struct Group {
+    entries: Entry[2],
+    entries_count: u32,
+}
+pub struct Top {
+    groups: Group[2],
+    groups_count: u32,
+}
+pub const top = Top { groups: [Group { entries: [Entry { values: sN[32][2]:[1, 2], values_count: u32:2, color: Color::GREEN }, Entry { values: sN[32][2]:[3, 0], values_count: u32:1, color: Color::RED }], entries_count: u32:2 }, Group { entries: [Entry { values: sN[32][2]:[0, 0], values_count: u32:0, color: Color::RED }, Entry { values: sN[32][2]:[0, 0], values_count: u32:0, color: Color::RED }], entries_count: u32:0 }], groups_count: u32:2 };)");
+}
+
+TEST(ProtoToDslxTest, TextRejectsArraysLargerThanType) {
+  const std::string kSchema = R"(
+syntax = "proto2";
+
+package xls;
+
+message Top {
+  repeated int64 values = 1;
+}
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<google::protobuf::DescriptorPool> descriptor_pool,
+      ProcessStringProtoSchema(kSchema));
+  google::protobuf::DynamicMessageFactory factory;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<google::protobuf::Message> small,
+      ConstructProtoViaText("values: 1", "xls.Top", descriptor_pool.get(),
+                            &factory));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<google::protobuf::Message> large,
+      ConstructProtoViaText("values: 1 values: 2", "xls.Top",
+                            descriptor_pool.get(), &factory));
+
+  dslx::Module module("test_module", /*fs_path=*/std::nullopt);
+  ProtoToDslxManager proto_to_dslx(&module);
+  std::string text;
+  XLS_ASSERT_OK(proto_to_dslx.WriteProtoInstantiation("small", *small, &text));
+  EXPECT_EQ(text,
+            "pub const small = Top { values: sN[64][1]:[1], values_count: "
+            "u32:1 };");
+  EXPECT_THAT(proto_to_dslx.WriteProtoInstantiation("large", *large, &text),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("xls.Top.values has 2 elements")));
+}
+
+constexpr std::string_view kBenchmarkSchema = R"(
+syntax = "proto2";
+
+package xls;
+
+message Entry {
+  optional int32 index = 1;
+  optional fixed32 mask = 2;
+}
+
+message Top {
+  repeated int64 values = 1;
+  repeated Entry entries = 2;
+}
+)";
+
+// Returns a message with `size` repeated integers and `size` repeated
+// submessages.
+std::unique_ptr<google::protobuf::Message> MakeLargeMessage(
+    google::protobuf::DescriptorPool* descriptor_pool,
+    google::protobuf::DynamicMessageFactory* factory, int64_t size) {
+  absl::StatusOr<std::unique_ptr<google::protobuf::Message>> message =
+      ConstructProtoViaText("", "xls.Top", descriptor_pool, factory);
+  CHECK_OK(message.status());
+  const google::protobuf::Descriptor* top = (*message)->GetDescriptor();
+  const google::protobuf::Reflection* reflection = (*message)->GetReflection();
+  for (int64_t i = 0; i < size; ++i) {
+    reflection->AddInt64(message->get(), top->FindFieldByName("values"),
+                         i * 7 - size);
+    google::protobuf::Message* entry = reflection->AddMessage(
+        message->get(), top->FindFieldByName("entries"), factory);
+    const google::protobuf::Descriptor* entry_desc = entry->GetDescriptor();
+    entry->GetReflection()->SetInt32(
+        entry, entry_desc->FindFieldByName("index"), static_cast<int32_t>(i));
+    entry->GetReflection()->SetUInt32(
+        entry, entry_desc->FindFieldByName("mask"),
+        static_cast<uint32_t>(i * 0x9e3779b9));
+  }
+  return *std::move(message);
+}
+
+void BM_ProtoToDslxAst(benchmark::State& state) {
+  absl::StatusOr<std::unique_ptr<google::protobuf::DescriptorPool>>
+      descriptor_pool = ProcessStringProtoSchema(kBenchmarkSchema);
+  CHECK_OK(descriptor_pool.status());
+  google::protobuf::DynamicMessageFactory factory;
+  std::unique_ptr<google::protobuf::Message> message =
+      MakeLargeMessage(descriptor_pool->get(), &factory, state.range(0));
+  for (auto _ : state) {
+    absl::StatusOr<std::unique_ptr<dslx::Module>> module =
+        CreateDslxFromParams("the_module", {{"top", message.get()}});
+    CHECK_OK(module.status());
+    std::string text = (*module)->ToString();
+    benchmark::DoNotOptimize(text);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ProtoToDslxText(benchmark::State& state) {
+  absl::StatusOr<std::unique_ptr<google::protobuf::DescriptorPool>>
+      descriptor_pool = ProcessStringProtoSchema(kBenchmarkSchema);
+  CHECK_OK(descriptor_pool.status());
+  google::protobuf::DynamicMessageFactory factory;
+  std::unique_ptr<google::protobuf::Message> message =
+      MakeLargeMessage(descriptor_pool->get(), &factory, state.range(0));
+  for (auto _ : state) {
+    dslx::Module module("the_module", /*fs_path=*/std::nullopt);
+    ProtoToDslxManager proto_to_dslx(&module);
+    std::string constant;
+    CHECK_OK(proto_to_dslx.WriteProtoInstantiation("top", *message, &constant));
+    std::string text = absl::StrCat(module.ToString(), "\n", constant);
+    benchmark::DoNotOptimize(text);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ProtoToDslxAst)->Range(1 << 10, 1 << 17);
+BENCHMARK(BM_ProtoToDslxText)->Range(1 << 10, 1 << 17);
+
 }  // namespace
 }  // namespace xls
@@ -76,6 +76,13 @@ _STA_LIBS = flags.DEFINE_string(
 _OUT_PATH = flags.DEFINE_string(
     'out_path', None, 'Path for output text proto'
 )
+_AREA_OUT_PATH = flags.DEFINE_string(
+    'area_out_path', None,
+    'Path for output text proto of the areas of the characterized operations '
+    '(xls.area_model.AreaDataPoints); areas are not recorded if unspecified. '
+    'With --openroad_path the areas of each PDK are written next to its delay '
+    'checkpoint instead.'
+)
 
 # The options below are used when bazel_bin_path is NOT specified
 _CLIENT = flags.DEFINE_string(
@@ -109,6 +116,7 @@ class WorkerConfig:
   client_args = []
   client_extra_args = []
   client_checkpoint_file: str
+  client_area_checkpoint_file: str
 
 
 def _do_config_task(config: WorkerConfig):
@@ -119,6 +127,9 @@ def _do_config_task(config: WorkerConfig):
     config.sta_bin = f'{config.openroad_path}/tools/install/OpenROAD/bin/sta'
     config.client_checkpoint_file = (
         f'../../{config.target}_checkpoint.textproto')
+    config.client_area_checkpoint_file = (
+        f'../../{config.target}_area_checkpoint.textproto'
+        if _AREA_OUT_PATH.value else None)
   else:
     if not _YOSYS_PATH.value:
       raise app.UsageError(
@@ -151,6 +162,7 @@ def _do_config_task(config: WorkerConfig):
     else:
       raise app.UsageError(
           'If not using --openroad_path, then must provide --out_path.')
+    config.client_area_checkpoint_file = _AREA_OUT_PATH.value
 
     if not _SAMPLES_PATH.value:
       if _QUICK_RUN.value:
@@ -286,6 +298,9 @@ def _do_worker_task(config: WorkerConfig):
 
   client = [config.client_bin]
   client.append(f'--checkpoint_path {config.client_checkpoint_file}')
+  if config.client_area_checkpoint_file:
+    client.append(
+        f'--area_checkpoint_path {config.client_area_checkpoint_file}')
   client.append(' '.join(config.client_args))
   client.append(' '.join(config.client_extra_args))
   client.append(f'--port={config.rpc_port}')
@@ -48,6 +48,25 @@ ABSL_FLAG(int64_t, pipeline_stages, 0,
           "https://google.github.io/xls/scheduling for details.");
 ABSL_FLAG(std::string, delay_model, "",
           "Delay model name to use from registry.");
+ABSL_FLAG(std::string, area_model, "",
+          "Area model name to use from registry. If given, the SDC scheduler "
+          "minimizes the estimated area of the pipeline registers rather than "
+          "their bit count.");
+ABSL_FLAG(std::string, scheduling_strategy, "sdc",
+          "The scheduler to use: 'sdc', 'min_cut', 'list' or "
+          "'partitioned_sdc'. The list scheduler is much faster than the SDC "
+          "scheduler on very large designs but only approximately minimizes "
+          "the pipeline registers. The partitioned SDC scheduler refines the "
+          "list schedule by solving regions of the design in parallel. Both "
+          "require --clock_period_ps for such designs, since the minimum "
+          "clock period is otherwise found with the SDC scheduler.");
+ABSL_FLAG(bool, refine_list_schedule_with_sdc, false,
+          "If true, the schedule found by the list scheduler is refined with "
+          "the SDC scheduler, keeping the list schedule if that fails.");
+ABSL_FLAG(int64_t, max_scheduling_region_size, 0,
+          "The maximum number of nodes in each region scheduled by the "
+          "partitioned SDC scheduler, which uses --scheduling_threads threads. "
+          "If zero, a default is used.");
 ABSL_FLAG(int64_t, clock_margin_percent, 0,
           "The percentage of clock period to set aside as a margin to ensure "
           "timing is met. Effectively, this lowers the clock period by this "
@@ -72,6 +91,11 @@ ABSL_FLAG(
     "use the shortest feasible clock period - even if this does not meet the "
     "`--clock_period_ps` target - after printing a warning."
     "Otherwise, will stop with an error if `--clock_period_ps` is infeasible.");
+ABSL_FLAG(int64_t, scheduling_threads, 1,
+          "The number of threads to use when searching for the minimum "
+          "feasible clock period. With more than one thread, several "
+          "candidate clock periods are evaluated concurrently, reducing the "
+          "number of sequential search rounds.");
 ABSL_FLAG(bool, minimize_worst_case_throughput, false,
           "If true, when `--worst_case_throughput` is not given, search for & "
           "report the best possible worst-case throughput of the circuit "
@@ -158,6 +182,13 @@ ABSL_FLAG(std::string, fdo_yosys_path, "", "Absolute path of yosys.");
 ABSL_FLAG(std::string, fdo_sta_path, "", "Absolute path of OpenSTA.");
 ABSL_FLAG(std::string, fdo_synthesis_libraries, "",
           "Synthesis and STA libraries.");
+ABSL_FLAG(std::string, fdo_synthesis_cache_dir, "",
+          "Directory in which FDO synthesis results are cached across runs. "
+          "If empty, results are only cached within a run.");
+ABSL_FLAG(int64_t, fdo_synthesis_batch_size, 1,
+          "Number of node cuts synthesized by each invocation of the FDO "
+          "synthesis tools. Larger batches amortize tool startup and library "
+          "loading over more cuts.");
 // TODO: google/xls#869 - Remove when proc-scoped channels supplant old-style
 // procs.
 ABSL_FLAG(bool, multi_proc, false,
@@ -193,10 +224,15 @@ static absl::StatusOr<bool> SetOptionsFromFlags(
   POPULATE_FLAG(clock_period_ps);
   POPULATE_FLAG(pipeline_stages);
   POPULATE_FLAG(delay_model);
+  POPULATE_FLAG(area_model);
+  POPULATE_FLAG(scheduling_strategy);
+  POPULATE_FLAG(refine_list_schedule_with_sdc);
+  POPULATE_FLAG(max_scheduling_region_size);
   POPULATE_FLAG(clock_margin_percent);
   POPULATE_FLAG(period_relaxation_percent);
   POPULATE_FLAG(minimize_clock_on_failure);
   POPULATE_FLAG(recover_after_minimizing_clock);
+  POPULATE_FLAG(scheduling_threads);
   POPULATE_FLAG(minimize_worst_case_throughput);
   {
     any_flags_set |= FLAGS_worst_case_throughput.IsSpecifiedOnCommandLine();
@@ -220,6 +256,8 @@ static absl::StatusOr<bool> SetOptionsFromFlags(
   POPULATE_FLAG(fdo_yosys_path);
   POPULATE_FLAG(fdo_sta_path);
   POPULATE_FLAG(fdo_synthesis_libraries);
+  POPULATE_FLAG(fdo_synthesis_cache_dir);
+  POPULATE_FLAG(fdo_synthesis_batch_size);
   POPULATE_FLAG(multi_proc);
 #undef POPULATE_FLAG
 #undef POPULATE_REPEATED_FLAG
@@ -280,6 +318,30 @@ static absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
   if (proto.clock_margin_percent() != 0) {
     scheduling_options.clock_margin_percent(proto.clock_margin_percent());
   }
+  if (!proto.area_model().empty()) {
+    scheduling_options.area_model(proto.area_model());
+  }
+  if (proto.has_scheduling_strategy()) {
+    if (proto.scheduling_strategy() == "sdc") {
+      scheduling_options.strategy(SchedulingStrategy::SDC);
+    } else if (proto.scheduling_strategy() == "min_cut") {
+      scheduling_options.strategy(SchedulingStrategy::MIN_CUT);
+    } else if (proto.scheduling_strategy() == "list") {
+      scheduling_options.strategy(SchedulingStrategy::LIST);
+    } else if (proto.scheduling_strategy() == "partitioned_sdc") {
+      scheduling_options.strategy(SchedulingStrategy::PARTITIONED_SDC);
+    } else {
+      return absl::InternalError(
+          "scheduling_strategy must be 'sdc', 'min_cut', 'list', or "
+          "'partitioned_sdc'");
+    }
+  }
+  scheduling_options.refine_list_schedule_with_sdc(
+      proto.refine_list_schedule_with_sdc());
+  if (proto.max_scheduling_region_size() > 0) {
+    scheduling_options.max_scheduling_region_size(
+        proto.max_scheduling_region_size());
+  }
   if (proto.period_relaxation_percent() != 0) {
     scheduling_options.period_relaxation_percent(
         proto.period_relaxation_percent());
@@ -288,6 +350,9 @@ static absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
       proto.minimize_clock_on_failure());
   scheduling_options.recover_after_minimizing_clock(
       proto.recover_after_minimizing_clock());
+  if (proto.scheduling_threads() > 1) {
+    scheduling_options.scheduling_threads(proto.scheduling_threads());
+  }
   if (proto.worst_case_throughput() != 1) {
     scheduling_options.worst_case_throughput(proto.worst_case_throughput());
   }
@@ -451,6 +516,14 @@ static absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
   scheduling_options.fdo_yosys_path(proto.fdo_yosys_path());
   scheduling_options.fdo_sta_path(proto.fdo_sta_path());
   scheduling_options.fdo_synthesis_libraries(proto.fdo_synthesis_libraries());
+  scheduling_options.fdo_synthesis_cache_dir(proto.fdo_synthesis_cache_dir());
+  if (proto.has_fdo_synthesis_batch_size()) {
+    if (proto.fdo_synthesis_batch_size() < 1) {
+      return absl::InternalError("fdo_synthesis_batch_size must be >= 1");
+    }
+    scheduling_options.fdo_synthesis_batch_size(
+        proto.fdo_synthesis_batch_size());
+  }
 
   scheduling_options.schedule_all_procs(proto.multi_proc());
 
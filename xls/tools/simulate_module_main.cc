@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
+#include <memory>
 #include <iostream>
 #include <iterator>
 #include <string>
@@ -32,6 +34,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/types/span.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/vast.h"
 #include "xls/common/exit_status.h"
@@ -41,6 +44,7 @@
 #include "xls/ir/format_preference.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value.h"
+#include "xls/simulation/compiled_module_simulator.h"
 #include "xls/simulation/module_simulator.h"
 #include "xls/simulation/verilog_simulators.h"
 #include "xls/tools/eval_utils.h"
@@ -97,6 +101,17 @@ ABSL_FLAG(std::string, file_type, "",
           "The type of input file, may be either 'verilog' or "
           "'system_verilog'. If not specified the file type is determined by "
           "the file extensoin of the input file");
+ABSL_FLAG(int64_t, max_simulator_processes, 1,
+          "Maximum number of concurrent Verilog simulator processes among "
+          "which a batch of function arguments (--args_file) is split. Only "
+          "valid for modules whose outputs do not depend on earlier inputs.");
+ABSL_FLAG(bool, compile_once, false,
+          "Compile the module once along with a testbench which reads the "
+          "function arguments (--args or --args_file) at run time rather than "
+          "generating a testbench holding the arguments. Requires a simulator "
+          "which supports separate compilation, such as iverilog or "
+          "verilator, and pays off most for large batches with a compiled "
+          "simulator such as verilator. --max_simulator_processes is ignored.");
 
 namespace xls {
 namespace {
@@ -124,9 +139,9 @@ absl::Status RunProc(const verilog::ModuleSimulator& simulator,
   return absl::OkStatus();
 }
 
-absl::Status RunFunction(const verilog::ModuleSimulator& simulator,
-                         const verilog::ModuleSignature& signature,
-                         FunctionInput function_input) {
+absl::StatusOr<std::vector<absl::flat_hash_map<std::string, Value>>>
+ParseArgsSets(const verilog::ModuleSignature& signature,
+              const FunctionInput& function_input) {
   std::vector<absl::flat_hash_map<std::string, Value>> args_sets;
   for (std::string_view args_string : function_input.args_strings) {
     std::vector<Value> arg_values;
@@ -138,13 +153,44 @@ absl::Status RunFunction(const verilog::ModuleSimulator& simulator,
     XLS_ASSIGN_OR_RETURN(MapT args_set, signature.ToKwargs(arg_values));
     args_sets.push_back(std::move(args_set));
   }
+  return args_sets;
+}
 
-  XLS_ASSIGN_OR_RETURN(std::vector<Value> outputs,
-                       simulator.RunBatched(args_sets));
-
+void PrintOutputs(absl::Span<const Value> outputs) {
   for (const Value& output : outputs) {
     std::cout << output.ToString(FormatPreference::kHex) << '\n';
   }
+}
+
+absl::Status RunFunction(const verilog::ModuleSimulator& simulator,
+                         const verilog::ModuleSignature& signature,
+                         const FunctionInput& function_input,
+                         int64_t max_simulator_processes) {
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<absl::flat_hash_map<std::string, Value>> args_sets,
+      ParseArgsSets(signature, function_input));
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> outputs,
+                       simulator.RunBatched(args_sets,
+                                            max_simulator_processes));
+  PrintOutputs(outputs);
+  return absl::OkStatus();
+}
+
+absl::Status RunCompiledFunction(
+    std::string_view verilog_text, verilog::FileType file_type,
+    const verilog::ModuleSignature& signature,
+    const FunctionInput& function_input,
+    const verilog::VerilogSimulator* verilog_simulator) {
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<absl::flat_hash_map<std::string, Value>> args_sets,
+      ParseArgsSets(signature, function_input));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<verilog::CompiledModuleSimulator> simulator,
+      verilog::CompiledModuleSimulator::Create(signature, verilog_text,
+                                                file_type, verilog_simulator));
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> outputs,
+                       simulator->RunBatched(args_sets));
+  PrintOutputs(outputs);
   return absl::OkStatus();
 }
 
@@ -152,12 +198,23 @@ absl::Status RealMain(std::string_view verilog_text,
                       verilog::FileType file_type,
                       const verilog::ModuleSignature& signature,
                       InputType inputs,
-                      const verilog::VerilogSimulator* verilog_simulator) {
+                      const verilog::VerilogSimulator* verilog_simulator,
+                      int64_t max_simulator_processes, bool compile_once) {
+  if (compile_once) {
+    if (!std::holds_alternative<FunctionInput>(inputs)) {
+      return absl::InvalidArgumentError(
+          "--compile_once requires --args or --args_file");
+    }
+    return RunCompiledFunction(verilog_text, file_type, signature,
+                               std::get<FunctionInput>(inputs),
+                               verilog_simulator);
+  }
   verilog::ModuleSimulator simulator(signature, verilog_text, file_type,
                                      verilog_simulator);
 
   if (std::holds_alternative<FunctionInput>(inputs)) {
-    return RunFunction(simulator, signature, std::get<FunctionInput>(inputs));
+    return RunFunction(simulator, signature, std::get<FunctionInput>(inputs),
+                       max_simulator_processes);
   }
   return RunProc(simulator, signature, std::get<ProcInput>(inputs));
 }
@@ -273,7 +330,8 @@ int main(int argc, char** argv) {
       xls::verilog::ModuleSignature::FromProto(signature_proto);
   QCHECK_OK(signature_status.status());
 
-  return xls::ExitStatus(xls::RealMain(verilog_text.value(), file_type,
-                                       signature_status.value(), input,
-                                       verilog_simulator));
+  return xls::ExitStatus(xls::RealMain(
+      verilog_text.value(), file_type, signature_status.value(), input,
+      verilog_simulator, absl::GetFlag(FLAGS_max_simulator_processes),
+      absl::GetFlag(FLAGS_compile_once)));
 }
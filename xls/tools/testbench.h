@@ -15,6 +15,7 @@
 #ifndef XLS_TOOLS_TESTBENCH_H_
 #define XLS_TOOLS_TESTBENCH_H_
 
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <functional>
@@ -34,15 +35,19 @@ namespace xls {
 
 // Testbench is a helper class to test an XLS module (or...anything, really)
 // across a range of inputs. This class creates a set of worker threads and
-// divides the input across them, and sets them to go until complete.
-// Execution status (percent complete, number of result mismatches) will be
-// periodically printed to the terminal, as this class' primary use is for
-// exploring large test spaces.
+// sets them to go until the input space is exhausted. Execution status (percent
+// complete, throughput, number of result mismatches) will be periodically
+// printed to the terminal, as this class' primary use is for exploring large
+// test spaces.
 //
-// Presently, work is parititioned uniformly across threads at startup. This can
-// lead to work imbalance if certain areas of the input space execute faster
-// than others. More advanced strategies can be explored in the future if this
-// becomes a problem.
+// Work is distributed dynamically: each thread repeatedly claims the next
+// `chunk_size` indices of the input space, so threads which hit cheap regions
+// of the space (e.g., early-exit paths) pick up more chunks instead of idling
+// while the others finish. Smaller chunks balance better at the cost of more
+// contention on the shared index counter.
+
+// The default number of indices claimed by a thread at a time.
+inline constexpr uint64_t kDefaultTestbenchChunkSize = 1024;
 
 namespace internal {
 // Forward decl of common Testbench base class.
@@ -75,6 +80,8 @@ class Testbench : public internal::TestbenchBase<InputT, ResultT, ShardDataT> {
   //                     are considered equivalent.
   //   log_errors      : The function to log errors when compare_results returns
   //                     false.
+  //   chunk_size      : The number of indices claimed by a worker thread at a
+  //                     time.
   //
   // All lambdas must be thread-safe.
   //
@@ -89,17 +96,19 @@ class Testbench : public internal::TestbenchBase<InputT, ResultT, ShardDataT> {
             std::function<ResultT(ShardDataT*, InputT)> compute_expected,
             std::function<ResultT(ShardDataT*, InputT)> compute_actual,
             std::function<bool(ResultT, ResultT)> compare_results,
-            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+            uint64_t chunk_size = kDefaultTestbenchChunkSize)
       : internal::TestbenchBase<InputT, ResultT, ShardDataT>(
-            start, end, num_threads, max_failures, index_to_input,
+            start, end, num_threads, max_failures, chunk_size, index_to_input,
             compare_results, log_errors),
         create_shard_(create_shard),
         compute_expected_(compute_expected),
         compute_actual_(compute_actual) {
-    this->thread_create_fn_ = [this](uint64_t start, uint64_t end) {
+    this->thread_create_fn_ = [this]() {
       return std::make_unique<TestbenchThread<InputT, ResultT, ShardDataT>>(
-          &this->mutex_, &this->wake_me_, start, end, this->max_failures_,
-          this->index_to_input_, create_shard_, compute_expected_,
+          &this->mutex_, &this->wake_me_, &this->next_index_, this->end_,
+          this->chunk_size_, this->max_failures_, this->index_to_input_,
+          create_shard_, compute_expected_,
           compute_actual_, this->compare_results_, this->log_errors_);
     };
   }
@@ -122,17 +131,19 @@ class Testbench<InputT, ResultT, ShardDataT,
             std::function<ResultT(InputT)> compute_expected,
             std::function<ResultT(InputT)> compute_actual,
             std::function<bool(ResultT, ResultT)> compare_results,
-            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+            uint64_t chunk_size = kDefaultTestbenchChunkSize)
       : internal::TestbenchBase<InputT, ResultT, ShardDataT>(
-            start, end, num_threads, max_failures, index_to_input,
+            start, end, num_threads, max_failures, chunk_size, index_to_input,
             compare_results, log_errors),
         compute_expected_(compute_expected),
         compute_actual_(compute_actual) {
-    this->thread_create_fn_ = [this](uint64_t start, uint64_t end) {
+    this->thread_create_fn_ = [this]() {
       return std::make_unique<TestbenchThread<InputT, ResultT, ShardDataT>>(
-          &this->mutex_, &this->wake_me_, start, end, this->max_failures_,
-          this->index_to_input_, compute_expected_, compute_actual_,
-          this->compare_results_, this->log_errors_);
+          &this->mutex_, &this->wake_me_, &this->next_index_, this->end_,
+          this->chunk_size_, this->max_failures_, this->index_to_input_,
+          compute_expected_, compute_actual_, this->compare_results_,
+          this->log_errors_);
     };
   }
 
@@ -151,7 +162,7 @@ class TestbenchBase {
  public:
   TestbenchBase(
       uint64_t start, uint64_t end, uint64_t num_threads, uint64_t max_failures,
-      std::function<InputT(uint64_t)> index_to_input,
+      uint64_t chunk_size, std::function<InputT(uint64_t)> index_to_input,
       std::function<bool(ResultT, ResultT)> compare_results,
       std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
       : started_(false),
@@ -159,6 +170,8 @@ class TestbenchBase {
         start_(start),
         end_(end),
         max_failures_(max_failures),
+        chunk_size_(chunk_size),
+        next_index_(start),
         num_samples_processed_(0),
         index_to_input_(index_to_input),
         compare_results_(compare_results),
@@ -175,6 +188,18 @@ class TestbenchBase {
     return absl::OkStatus();
   }
 
+  // Sets the number of indices claimed by a worker thread at a time. Must be
+  // called before Run().
+  absl::Status SetChunkSize(uint64_t chunk_size) {
+    absl::MutexLock lock(&mutex_);
+    if (this->started_) {
+      return absl::FailedPreconditionError(
+          "Can't change the chunk size after starting execution.");
+    }
+    chunk_size_ = chunk_size;
+    return absl::OkStatus();
+  }
+
   // Executes the test.
   absl::Status Run() {
     // Lock before spawning threads to prevent missing any early wakeup signals
@@ -182,24 +207,12 @@ class TestbenchBase {
     mutex_.Lock();
     started_ = true;
 
-    // Set up all the workers.
-    uint64_t chunk_size = (end_ - start_) / num_threads_;
-    uint64_t chunk_remainder =
-        chunk_size == 0 ? (end_ - start_) : (end_ - start_) % chunk_size;
-    uint64_t first = 0;
-    uint64_t last;
+    // Set up all the workers. They claim chunks of the input space as they go
+    // so no up-front partitioning is needed.
+    next_index_.store(start_);
     for (int i = 0; i < num_threads_; i++) {
-      last = first + chunk_size;
-      // Distribute any remainder evenly amongst the threads.
-      if (chunk_remainder > 0) {
-        last++;
-        chunk_remainder--;
-      }
-
-      threads_.push_back(thread_create_fn_(first, last));
+      threads_.push_back(thread_create_fn_());
       threads_.back()->Run();
-
-      first = last + 1;
     }
 
     // Wait for all to be ready.
@@ -218,6 +231,7 @@ class TestbenchBase {
 
     // Don't include startup time.
     start_time_ = absl::Now();
+    last_print_time_ = start_time_;
 
     for (int i = 0; i < threads_.size(); i++) {
       threads_[i]->SignalStart();
@@ -270,21 +284,10 @@ class TestbenchBase {
   // How many seconds to wait before printing status (at most).
   static constexpr absl::Duration kPrintInterval = absl::Seconds(5);
 
-  // Prints the current execution status across all threads.
+  // Prints the current execution status across all threads. Since threads
+  // claim work dynamically, per-thread progress is reported as a sample count
+  // and overall progress as a fraction of the whole space.
   void PrintStatus() {
-    // Get the remainder-adjusted chunk size for this thread.
-    auto thread_chunk_size = [this](int thread_index) {
-      uint64_t total_size = end_ - start_;
-      uint64_t chunk_size = total_size / threads_.size();
-      uint64_t remainder =
-          chunk_size == 0 ? total_size : total_size % chunk_size;
-      if (thread_index < remainder) {
-        chunk_size++;
-      }
-      return chunk_size;
-    };
-
-    // Ignore remainder issues here. It shouldn't matter much at all.
     absl::Time now = absl::Now();
     auto delta = now - start_time_;
     uint64_t total_done = 0;
@@ -292,32 +295,47 @@ class TestbenchBase {
       uint64_t num_passes = threads_[i]->num_passes();
       uint64_t num_failures = threads_[i]->num_failures();
       uint64_t thread_done = num_passes + num_failures;
-      uint64_t chunk_size = thread_chunk_size(i);
       total_done += thread_done;
       std::cout << absl::StreamFormat(
-                       "thread %02d: %f%% @ %.1f us/sample :: failures %d", i,
-                       static_cast<double>(thread_done) / chunk_size * 100.0,
-                       absl::ToDoubleMicroseconds(delta) / thread_done,
+                       "thread %02d: %d samples @ %.1f us/sample :: failures "
+                       "%d",
+                       i, thread_done,
+                       thread_done == 0 ? 0.0
+                                        : absl::ToDoubleMicroseconds(delta) /
+                                              static_cast<double>(thread_done),
                        num_failures)
                 << "\n";
     }
-    double done_per_second = delta == absl::ZeroDuration()
-                                 ? 0.0
-                                 : total_done / absl::ToDoubleSeconds(delta);
-    int64_t remaining = end_ - start_ - total_done;
+    uint64_t total_size = end_ - start_;
+    double done_per_second =
+        delta == absl::ZeroDuration()
+            ? 0.0
+            : static_cast<double>(total_done) / absl::ToDoubleSeconds(delta);
+    int64_t remaining = total_size - total_done;
     auto estimate = absl::Seconds(
         done_per_second == 0.0 ? 0.0 : remaining / done_per_second);
+    // Throughput since the last print; the monitor may be woken early so use
+    // the actual interval rather than kPrintInterval.
+    double seconds_since_last_print =
+        absl::ToDoubleSeconds(now - last_print_time_);
     double throughput_this_print =
-        static_cast<double>(total_done - num_samples_processed_) /
-        ToInt64Seconds(kPrintInterval);
+        seconds_since_last_print == 0.0
+            ? 0.0
+            : static_cast<double>(total_done - num_samples_processed_) /
+                  seconds_since_last_print;
     std::cout << absl::StreamFormat(
-                     "--- ^ after %s elapsed; %f Misamples/s; estimate %s "
-                     "remaining ...",
+                     "--- ^ %.2f%% done after %s elapsed; %f Misamples/s; "
+                     "estimate %s remaining ...",
+                     total_size == 0 ? 100.0
+                                     : static_cast<double>(total_done) /
+                                           static_cast<double>(total_size) *
+                                           100.0,
                      absl::FormatDuration(delta),
                      throughput_this_print / std::pow(2, 20),
                      absl::FormatDuration(estimate))
               << std::endl;
     num_samples_processed_ = total_done;
+    last_print_time_ = now;
   }
 
   // Requests that all running threads terminate (but doesn't Join() them).
@@ -330,16 +348,20 @@ class TestbenchBase {
   bool started_;
   int num_threads_;
   absl::Time start_time_;
+  absl::Time last_print_time_;
   uint64_t start_;
   uint64_t end_;
   uint64_t max_failures_;
+  uint64_t chunk_size_;
+  // The next index of [start_, end_) not yet claimed by a worker thread.
+  std::atomic<uint64_t> next_index_;
   uint64_t num_samples_processed_;
   std::function<InputT(uint64_t)> index_to_input_;
   std::function<bool(ResultT, ResultT)> compare_results_;
   std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors_;
 
   using ThreadT = TestbenchThread<InputT, ResultT, ShardDataT>;
-  std::function<std::unique_ptr<ThreadT>(uint64_t, uint64_t)> thread_create_fn_;
+  std::function<std::unique_ptr<ThreadT>()> thread_create_fn_;
   std::vector<std::unique_ptr<ThreadT>> threads_;
 
   // The main thread sleeps while tests are running. As worker threads finish,
@@ -95,6 +95,12 @@ class TestbenchBuilder {
     return *this;
   }
 
+  // Sets the number of indices claimed by a worker thread at a time.
+  TestbenchBuilder& SetChunkSize(int64_t chunk_size) {
+    chunk_size_ = chunk_size;
+    return *this;
+  }
+
   TestbenchBuilder& SetPrintInputFn(const PrintInputFnT& fn) {
     print_input_ = fn;
     return *this;
@@ -115,6 +121,7 @@ class TestbenchBuilder {
  private:
   uint64_t num_samples_ = 16 * 1024;
   uint64_t num_threads_ = std::thread::hardware_concurrency();
+  uint64_t chunk_size_ = kDefaultTestbenchChunkSize;
   int64_t max_failures_ = 1;
   ComputeFnT compute_expected_;
   ComputeFnT compute_actual_;
@@ -167,6 +174,12 @@ class TestbenchBuilder<
     return *this;
   }
 
+  // Sets the number of indices claimed by a worker thread at a time.
+  TestbenchBuilder& SetChunkSize(int64_t chunk_size) {
+    chunk_size_ = chunk_size;
+    return *this;
+  }
+
   TestbenchBuilder& SetPrintInputFn(const PrintInputFnT& fn) {
     print_input_ = fn;
     return *this;
@@ -187,6 +200,7 @@ class TestbenchBuilder<
  private:
   uint64_t num_samples_ = 16 * 1024;
   uint64_t num_threads_ = std::thread::hardware_concurrency();
+  uint64_t chunk_size_ = kDefaultTestbenchChunkSize;
   int64_t max_failures_ = 1;
   ComputeFnT compute_expected_;
   ComputeFnT compute_actual_;
@@ -234,7 +248,7 @@ TestbenchBuilder<InputT, ResultT, ShardDataT, EnableT>::Build() {
   return Testbench<InputT, ResultT, ShardDataT>(
       /*start=*/0, this->num_samples_, this->num_threads_, this->max_failures_,
       index_to_input, create_shard_data_, this->compute_expected_,
-      this->compute_actual_, compare_results, log_errors);
+      this->compute_actual_, compare_results, log_errors, this->chunk_size_);
 }
 
 // Non-shard-data-containing Build() implementation.
@@ -274,7 +288,7 @@ Testbench<InputT, ResultT> TestbenchBuilder<
   return Testbench<InputT, ResultT, ShardDataT>(
       /*start=*/0, this->num_samples_, this->num_threads_, this->max_failures_,
       index_to_input, this->compute_expected_, this->compute_actual_,
-      compare_results, log_errors);
+      compare_results, log_errors, this->chunk_size_);
 }
 
 }  // namespace xls
@@ -15,7 +15,9 @@
 #ifndef XLS_TOOLS_TESTBENCH_THREAD_H_
 #define XLS_TOOLS_TESTBENCH_THREAD_H_
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -34,8 +36,9 @@ template <typename InputT, typename ResultT, typename ShardDataT>
 class TestbenchThreadBase;
 
 // TestbenchThread handles the work of _actually_ running tests.
-// It simply iterates over its given range of the index space and calls the
-// expected/actual calculators.
+// It repeatedly claims the next chunk of the index space shared with the other
+// threads and calls the expected/actual calculators for each index in the
+// chunk, so threads which run faster simply process more chunks.
 //
 // Just as with Testbench, TestbenchThread supports execution both with and
 // without per-shard data, and uses the same type of construct to expose an API
@@ -49,6 +52,9 @@ class TestbenchThread
   // All specified functions must be thread-safe.
   //  - wake_parent_mutex: A mutex that protects:
   //  - wake_parent: A condvar to kick the parent when this thread has finished.
+  //  - next_index: The next unclaimed index of the space shared by all
+  //                threads. Indices up to `end_index` are claimed `chunk_size`
+  //                at a time.
   //  - max_failures: The number of failures that will cause us to bail out.
   //                  If 0, then there will be no limit.
   //  - index_to_input: A function that can convert an index to an input to the
@@ -58,7 +64,8 @@ class TestbenchThread
   //                     under test.
   TestbenchThread(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
-      uint64_t start_index, uint64_t end_index, uint64_t max_failures,
+      std::atomic<uint64_t>* next_index, uint64_t end_index,
+      uint64_t chunk_size, uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<std::unique_ptr<ShardDataT>()> create_shard,
       std::function<ResultT(ShardDataT*, InputT)> generate_expected,
@@ -66,8 +73,9 @@ class TestbenchThread
       std::function<bool(ResultT, ResultT)> compare_results,
       std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
       : TestbenchThreadBase<InputT, ResultT, ShardDataT>(
-            wake_parent_mutex, wake_parent, start_index, end_index,
-            max_failures, index_to_input, compare_results, log_errors),
+            wake_parent_mutex, wake_parent, next_index, end_index,
+            chunk_size, max_failures, index_to_input, compare_results,
+            log_errors),
         create_shard_fn_(create_shard),
         generate_expected_(generate_expected),
         generate_actual_(generate_actual) {
@@ -98,15 +106,17 @@ class TestbenchThread<
  public:
   TestbenchThread(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
-      uint64_t start_index, uint64_t end_index, uint64_t max_failures,
+      std::atomic<uint64_t>* next_index, uint64_t end_index,
+      uint64_t chunk_size, uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<ResultT(InputT)> generate_expected,
       std::function<ResultT(InputT)> generate_actual,
       std::function<bool(ResultT, ResultT)> compare_results,
       std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
       : TestbenchThreadBase<InputT, ResultT, ShardDataT>(
-            wake_parent_mutex, wake_parent, start_index, end_index,
-            max_failures, index_to_input, compare_results, log_errors),
+            wake_parent_mutex, wake_parent, next_index, end_index,
+            chunk_size, max_failures, index_to_input, compare_results,
+            log_errors),
         generate_expected_(generate_expected),
         generate_actual_(generate_actual) {
     this->generate_expected_fn_ = [this](InputT& input) {
@@ -131,7 +141,8 @@ class TestbenchThreadBase {
  public:
   TestbenchThreadBase(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
-      uint64_t start_index, uint64_t end_index, uint64_t max_failures,
+      std::atomic<uint64_t>* next_index, uint64_t end_index,
+      uint64_t chunk_size, uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<bool(ResultT, ResultT)> compare_results,
       std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
@@ -141,8 +152,9 @@ class TestbenchThreadBase {
         running_(false),
         ready_(false),
         start_(false),
-        start_index_(start_index),
+        next_index_(next_index),
         end_index_(end_index),
+        chunk_size_(std::max<uint64_t>(chunk_size, 1)),
         max_failures_(max_failures),
         num_passes_(0),
         num_failures_(0),
@@ -177,25 +189,36 @@ class TestbenchThreadBase {
     }
 
     running_.store(true);
-    for (uint64_t i = start_index_; i < end_index_; i++) {
-      // Don't check for cancelled on every iteration; it's a touch slow.
-      if (i % 128 == 0 && cancelled_.load()) {
-        return_status = absl::CancelledError("This thread was cancelled.");
+    bool stop = false;
+    while (!stop) {
+      uint64_t chunk_start = next_index_->fetch_add(chunk_size_);
+      if (chunk_start >= end_index_) {
         break;
       }
-
-      InputT input = index_to_input_(i);
-      ResultT expected = generate_expected_fn_(input);
-      ResultT actual = generate_actual_fn_(input);
-      if (!compare_results_(expected, actual)) {
-        num_failures_.store(num_failures_.load() + 1);
-        log_errors_(i, input, expected, actual);
-        if (max_failures_ <= num_failures_.load()) {
-          return_status = absl::UnknownError("Maximum error count reached.");
+      uint64_t chunk_end =
+          chunk_start + std::min(chunk_size_, end_index_ - chunk_start);
+      for (uint64_t i = chunk_start; i < chunk_end; i++) {
+        // Don't check for cancelled on every iteration; it's a touch slow.
+        if (i % 128 == 0 && cancelled_.load()) {
+          return_status = absl::CancelledError("This thread was cancelled.");
+          stop = true;
           break;
         }
-      } else {
-        num_passes_.store(num_passes_.load() + 1);
+
+        InputT input = index_to_input_(i);
+        ResultT expected = generate_expected_fn_(input);
+        ResultT actual = generate_actual_fn_(input);
+        if (!compare_results_(expected, actual)) {
+          num_failures_.store(num_failures_.load() + 1);
+          log_errors_(i, input, expected, actual);
+          if (max_failures_ <= num_failures_.load()) {
+            return_status = absl::UnknownError("Maximum error count reached.");
+            stop = true;
+            break;
+          }
+        } else {
+          num_passes_.store(num_passes_.load() + 1);
+        }
       }
     }
 
@@ -257,8 +280,10 @@ class TestbenchThreadBase {
   std::atomic<bool> ready_;
   std::atomic<bool> start_;
 
-  uint64_t start_index_;
+  // Parent-owned counter from which chunks of indices are claimed.
+  std::atomic<uint64_t>* next_index_;
   uint64_t end_index_;
+  uint64_t chunk_size_;
 
   // Bookkeeping data.
   uint64_t max_failures_;
@@ -22,8 +22,9 @@ import os
 import subprocess
 import sys
 import tempfile
+import threading
 
-from typing import List, Tuple
+from typing import Any, Dict, List, Optional, Tuple
 
 from absl import app
 from absl import flags
@@ -57,6 +58,16 @@ flags.DEFINE_string(
 flags.DEFINE_string(
     'top', None, 'Name of entity (function, proc, etc) to visualize. If not '
     'given then the entity specified as top in the IR file is visualzied.')
+flags.DEFINE_bool(
+    'lazy', False, 'Keep the posted IR loaded in a resident ir_viz_server_main '
+    'process and send the UI only the critical path and the neighborhoods of '
+    'the nodes it selects, analyzing each function only when it is first '
+    'viewed. Use this for IR too large to convert to a single graph. The IR '
+    'text is not marked up in this mode and --pipeline_stages is ignored.')
+flags.DEFINE_integer(
+    'lazy_max_neighborhood_nodes', 200,
+    'With --lazy, the maximum number of nodes returned for the neighborhood '
+    'of a node.')
 flags.mark_flag_as_required('delay_model')
 
 IR_EXAMPLES_FILE_LIST = 'xls/visualization/ir_viz/ir_examples_file_list.txt'
@@ -72,6 +83,68 @@ OPT_MAIN_PATH = runfiles.get_path('xls/tools/opt_main')
 IR_TO_JSON_MAIN_PATH = runfiles.get_path(
     'xls/visualization/ir_viz/ir_to_json_main'
 )
+IR_VIZ_SERVER_MAIN_PATH = runfiles.get_path(
+    'xls/visualization/ir_viz/ir_viz_server_main'
+)
+
+
+class IrVizServer:
+  """A resident ir_viz_server_main process holding a parsed IR package.
+
+  Requests and responses are xls.viz.Request and xls.viz.Response protos
+  exchanged as one JSON object per line over the process's stdin and stdout.
+  """
+
+  def __init__(self, ir: str):
+    # The file is only needed until the server has parsed it, which it does
+    # before answering the first request.
+    with tempfile.NamedTemporaryFile(
+        mode='w', encoding='utf-8', prefix='ir_viz.', suffix='.ir'
+    ) as tmp_ir:
+      tmp_ir.write(ir)
+      tmp_ir.flush()
+      self._process = subprocess.Popen(
+          [
+              IR_VIZ_SERVER_MAIN_PATH,
+              '--delay_model={}'.format(FLAGS.delay_model),
+              tmp_ir.name,
+          ],
+          stdin=subprocess.PIPE,
+          stdout=subprocess.PIPE,
+          stderr=subprocess.PIPE,
+          encoding='utf-8',
+      )
+      self._outline = self.request(
+          {'outline': {'entry_name': FLAGS.top} if FLAGS.top else {}}
+      )
+
+  def outline(self) -> Dict[str, Any]:
+    return self._outline
+
+  def request(self, request: Dict[str, Any]) -> Dict[str, Any]:
+    """Sends the request to the server and returns the response."""
+    self._process.stdin.write(json.dumps(request) + '\n')
+    self._process.stdin.flush()
+    line = self._process.stdout.readline()
+    if not line:
+      raise RuntimeError(
+          'ir_viz_server_main exited: ' + self._process.stderr.read()
+      )
+    response = json.loads(line)
+    if 'error' in response:
+      raise RuntimeError(response['error'])
+    return response
+
+  def close(self):
+    self._process.stdin.close()
+    self._process.wait()
+
+
+# With --lazy, the server holding the most recently posted IR and the IR it
+# holds. Requests are sent one at a time.
+lazy_server: Optional[IrVizServer] = None
+lazy_server_ir: Optional[str] = None
+lazy_server_lock = threading.Lock()
 
 
 def load_precanned_examples() -> List[Tuple[str, str]]:
@@ -242,10 +315,63 @@ def example_handler(filename: str):
     flask.abort(404)
 
 
+def lazy_graph(text: str) -> Dict[str, Any]:
+  """Loads the IR into a resident server and returns the package outline."""
+  global lazy_server, lazy_server_ir
+  with lazy_server_lock:
+    if lazy_server_ir != text:
+      if lazy_server is not None:
+        lazy_server.close()
+        lazy_server = None
+        lazy_server_ir = None
+      lazy_server = IrVizServer(text)
+      lazy_server_ir = text
+    return lazy_server.outline()['outline']
+
+
+def lazy_request(request: Dict[str, Any]):
+  """Sends a request for a subgraph to the resident server."""
+  with lazy_server_lock:
+    if lazy_server is None:
+      return flask.jsonify({'error_code': 'error', 'message': 'No IR loaded'})
+    try:
+      response = lazy_server.request(request)
+    except Exception as e:  # pylint: disable=broad-except
+      return flask.jsonify({'error_code': 'error', 'message': str(e)})
+  return flask.jsonify({'error_code': 'ok', 'graph': response['graph']})
+
+
+@webapp.route('/neighborhood')
+def neighborhood_handler():
+  """Returns the subgraph around a node of the IR loaded with --lazy."""
+  return lazy_request({
+      'neighborhood': {
+          'function_id': flask.request.args['function_id'],
+          'node_id': flask.request.args['node_id'],
+          'radius': int(flask.request.args.get('radius', '1')),
+          'max_nodes': FLAGS.lazy_max_neighborhood_nodes,
+      }
+  })
+
+
+@webapp.route('/critical_path')
+def critical_path_handler():
+  """Returns the critical path of a function of the IR loaded with --lazy."""
+  return lazy_request(
+      {'critical_path': {'function_id': flask.request.args['function_id']}}
+  )
+
+
 @webapp.route('/graph', methods=['POST'])
 def graph_handler():
   """Parses the posted text and returns a parse status."""
   text = flask.request.form['text']
+  if FLAGS.lazy:
+    try:
+      outline = lazy_graph(text)
+    except Exception as e:  # pylint: disable=broad-except
+      return flask.jsonify({'error_code': 'error', 'message': str(e)})
+    return flask.jsonify({'error_code': 'ok', 'graph': outline, 'lazy': True})
   with tempfile.NamedTemporaryFile(
       mode='w', encoding='utf-8', prefix='ir_viz.', suffix='.ir'
   ) as tmp_ir:
@@ -102,18 +102,40 @@ class IrGraph {
      */
     this.neighborNodeIds_ = {};
 
-    for (let n of jsonGraph['nodes']) {
+    this.addElements(jsonGraph);
+  }
+
+  /**
+   * Adds the nodes and edges of the given graph which are not already in this
+   * graph. Used to grow the graph with subgraphs loaded from the server on
+   * demand (see xls::VisualizationSession). Every edge must be between nodes
+   * in this graph or `jsonGraph`.
+   * @param {!Object} jsonGraph An object in the same form as the constructor
+   *     argument.
+   * @return {boolean} Whether any node or edge was added.
+   */
+  addElements(jsonGraph) {
+    let added = false;
+    // The graph may have no nodes or edges (property undefined).
+    for (let n of (jsonGraph['nodes'] || [])) {
+      if (n['id'] in this.nodeById_) {
+        continue;
+      }
       let node = new IrNode(n);
       this.nodes_.push(node);
       this.nodeById_[node.id] = node;
       this.neighborNodeIds_[node.id] = [];
+      added = true;
     }
 
-    // The graph may have no edges ('edges' property undefined).
     for (let e of (jsonGraph['edges'] || [])) {
+      if (e['id'] in this.edgeById_) {
+        continue;
+      }
       let edge = new IrEdge(e);
       this.edges_.push(edge);
       this.edgeById_[edge.id] = edge;
+      added = true;
 
       if (!this.neighborNodeIds_[edge.sourceId].includes(edge.targetId)) {
         this.neighborNodeIds_[edge.sourceId].push(edge.targetId);
@@ -122,6 +144,7 @@ class IrGraph {
         this.neighborNodeIds_[edge.targetId].push(edge.sourceId);
       }
     }
+    return added;
   }
 
   /**
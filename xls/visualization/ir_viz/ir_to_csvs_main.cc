@@ -27,6 +27,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "riegeli/bytes/fd_writer.h"
 #include "riegeli/csv/csv_record.h"
 #include "riegeli/csv/csv_writer.h"
@@ -50,9 +51,15 @@ ABSL_FLAG(std::string, delay_model, "", "Delay model to use.");
 ABSL_FLAG(std::optional<int64_t>, pipeline_stages, std::nullopt,
           "Pipeline stages to use when scheduling the function");
 ABSL_FLAG(std::optional<std::string>, entry_name, std::nullopt, "Entry name");
+ABSL_FLAG(std::string, output_format, "csv",
+          "Format of the output. `csv` writes the nodes and edges of the entry "
+          "to separate CSV files. `columnar` writes a single binary "
+          "xls.viz.ColumnarFunctionBase proto, which is much smaller and "
+          "faster to load for very large graphs.");
 
 constexpr std::string_view kUsage =
-    R"(Expected: ir_to_csvs_main --delay_model=MODEL [--pipeline_stages=N] [--entry_name=ENTRY] /path/to/file.ir /path/to/node_output.csv /path/to/edge_output.csv)";
+    R"(Expected: ir_to_csvs_main --delay_model=MODEL [--pipeline_stages=N] [--entry_name=ENTRY] /path/to/file.ir /path/to/node_output.csv /path/to/edge_output.csv
+   or: ir_to_csvs_main --output_format=columnar --delay_model=MODEL [--pipeline_stages=N] [--entry_name=ENTRY] /path/to/file.ir /path/to/output.pb)";
 
 namespace xls {
 namespace {
@@ -129,9 +136,43 @@ riegeli::CsvRecord EdgeRecord(const viz::Edge& edge) {
                                    : ""});
 }
 
+absl::Status WriteCsvs(const viz::FunctionBase& entry,
+                       const std::filesystem::path& node_csv_path,
+                       const std::filesystem::path& edge_csv_path) {
+  riegeli::CsvWriterBase::Options node_options;
+  node_options.set_header(*kNodeHeader);
+  auto node_writer = riegeli::CsvWriter(
+      riegeli::FdWriter(node_csv_path.string()), node_options);
+  XLS_RETURN_IF_ERROR(node_writer.status());
+
+  riegeli::CsvWriterBase::Options edge_options;
+  edge_options.set_header(*kEdgeHeader);
+  auto edge_writer = riegeli::CsvWriter(
+      riegeli::FdWriter(edge_csv_path.string()), edge_options);
+  XLS_RETURN_IF_ERROR(edge_writer.status());
+
+  for (const auto& node : entry.nodes()) {
+    node_writer.WriteRecord(NodeRecord(node));
+  }
+  for (const auto& edge : entry.edges()) {
+    edge_writer.WriteRecord(EdgeRecord(edge));
+  }
+
+  absl::Status status;
+  if (!edge_writer.Close()) {
+    LOG(ERROR) << "Failed to close edge CSV writer";
+    status.Update(edge_writer.status());
+  }
+  if (!node_writer.Close()) {
+    LOG(ERROR) << "Failed to close node CSV writer";
+    status.Update(node_writer.status());
+  }
+  return status;
+}
+
 absl::Status RealMain(const std::filesystem::path& ir_path,
-                      const std::filesystem::path& node_csv_path,
-                      const std::filesystem::path& edge_csv_path,
+                      absl::Span<const std::string_view> output_paths,
+                      std::string_view output_format,
                       std::string_view delay_model_name,
                       std::optional<int64_t> pipeline_stages,
                       std::optional<std::string_view> entry_name) {
@@ -148,7 +189,9 @@ absl::Status RealMain(const std::filesystem::path& ir_path,
   XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
                        GetDelayEstimator(delay_model_name));
 
-  viz::Package package_proto;
+  // Only the entry is written so there is no need to analyze the rest of the
+  // package.
+  viz::FunctionBase entry;
   if (pipeline_stages.has_value()) {
     // TODO(meheff): Support scheduled procs.
     XLS_RET_CHECK(func_base->IsFunction());
@@ -157,57 +200,20 @@ absl::Status RealMain(const std::filesystem::path& ir_path,
         RunPipelineSchedule(
             func_base->AsFunctionOrDie(), *delay_estimator,
             SchedulingOptions().pipeline_stages(pipeline_stages.value())));
-    XLS_ASSIGN_OR_RETURN(package_proto,
-                         IrToProto(package.get(), *delay_estimator, &schedule,
-                                   func_base->name()));
+    XLS_ASSIGN_OR_RETURN(
+        entry, FunctionBaseToProto(func_base, *delay_estimator, &schedule));
   } else {
-    XLS_ASSIGN_OR_RETURN(package_proto,
-                         IrToProto(package.get(), *delay_estimator,
-                                   /*schedule=*/nullptr, func_base->name()));
-  }
-
-  const viz::FunctionBase* entry = nullptr;
-  for (const auto& function_base : package_proto.function_bases()) {
-    if (function_base.name() == func_base->name()) {
-      entry = &function_base;
-      break;
-    }
-  }
-  if (entry == nullptr) {
-    return absl::NotFoundError(
-        absl::StrFormat("Entry %s missing from proto", func_base->name()));
+    XLS_ASSIGN_OR_RETURN(entry,
+                         FunctionBaseToProto(func_base, *delay_estimator));
   }
 
-  riegeli::CsvWriterBase::Options node_options;
-  node_options.set_header(*kNodeHeader);
-  auto node_writer = riegeli::CsvWriter(
-      riegeli::FdWriter(node_csv_path.string()), node_options);
-  XLS_RETURN_IF_ERROR(node_writer.status());
-
-  riegeli::CsvWriterBase::Options edge_options;
-  edge_options.set_header(*kEdgeHeader);
-  auto edge_writer = riegeli::CsvWriter(
-      riegeli::FdWriter(edge_csv_path.string()), edge_options);
-  XLS_RETURN_IF_ERROR(edge_writer.status());
-
-  for (const auto& node : entry->nodes()) {
-    node_writer.WriteRecord(NodeRecord(node));
+  if (output_format == "columnar") {
+    XLS_RET_CHECK_EQ(output_paths.size(), 1);
+    return SetFileContents(output_paths[0],
+                           ToColumnar(entry).SerializeAsString());
   }
-  for (const auto& edge : entry->edges()) {
-    edge_writer.WriteRecord(EdgeRecord(edge));
-  }
-
-  absl::Status status;
-  if (!edge_writer.Close()) {
-    LOG(ERROR) << "Failed to close edge CSV writer";
-    status.Update(edge_writer.status());
-  }
-  if (!node_writer.Close()) {
-    LOG(ERROR) << "Failed to close node CSV writer";
-    status.Update(node_writer.status());
-  }
-
-  return absl::OkStatus();
+  XLS_RET_CHECK_EQ(output_paths.size(), 2);
+  return WriteCsvs(entry, output_paths[0], output_paths[1]);
 }
 
 }  // namespace
@@ -217,17 +223,29 @@ int main(int argc, char** argv) {
   std::vector<std::string_view> positional_arguments =
       xls::InitXls(kUsage, argc, argv);
 
-  if (positional_arguments.size() != 3 || positional_arguments[0].empty()) {
-    LOG(QFATAL) << "Expected three position arguments (IR path, node CSV "
-                   "path, edge CSV path): "
-                << argv[0] << " <ir_path> <node_csv_path> <edge_csv_path>";
+  std::string output_format = absl::GetFlag(FLAGS_output_format);
+  if (output_format == "columnar") {
+    if (positional_arguments.size() != 2 || positional_arguments[0].empty()) {
+      LOG(QFATAL) << "Expected two position arguments (IR path, output path): "
+                  << argv[0] << " <ir_path> <output_path>";
+    }
+  } else if (output_format == "csv") {
+    if (positional_arguments.size() != 3 || positional_arguments[0].empty()) {
+      LOG(QFATAL) << "Expected three position arguments (IR path, node CSV "
+                     "path, edge CSV path): "
+                  << argv[0] << " <ir_path> <node_csv_path> <edge_csv_path>";
+    }
+  } else {
+    LOG(QFATAL) << "--output_format must be `csv` or `columnar`, got: "
+                << output_format;
   }
   if (absl::GetFlag(FLAGS_delay_model).empty()) {
     LOG(QFATAL) << "--delay_model is required";
   }
 
   return xls::ExitStatus(xls::RealMain(
-      positional_arguments[0], positional_arguments[1], positional_arguments[2],
+      positional_arguments[0],
+      absl::MakeConstSpan(positional_arguments).subspan(1), output_format,
       absl::GetFlag(FLAGS_delay_model), absl::GetFlag(FLAGS_pipeline_stages),
       absl::GetFlag(FLAGS_entry_name)));
 }
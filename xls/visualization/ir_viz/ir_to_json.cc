@@ -14,6 +14,7 @@
 
 #include "xls/visualization/ir_viz/ir_to_json.h"
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -33,9 +34,10 @@ namespace xls {
 absl::StatusOr<std::string> IrToJson(
     Package* package, const DelayEstimator& delay_estimator,
     const PipelineSchedule* schedule,
-    std::optional<std::string_view> entry_name) {
-  XLS_ASSIGN_OR_RETURN(viz::Package proto, IrToProto(package, delay_estimator,
-                                                     schedule, entry_name));
+    std::optional<std::string_view> entry_name, int64_t thread_count) {
+  XLS_ASSIGN_OR_RETURN(viz::Package proto,
+                       IrToProto(package, delay_estimator, schedule,
+                                 entry_name, thread_count));
 
   std::string serialized_json;
   google::protobuf::util::JsonPrintOptions print_options;
@@ -15,6 +15,7 @@
 #ifndef XLS_VISUALIZATION_IR_VIZ_IR_TO_JSON_H_
 #define XLS_VISUALIZATION_IR_VIZ_IR_TO_JSON_H_
 
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -26,11 +27,12 @@ namespace xls {
 
 // Returns a JSON representation of the given package for use by the
 // visualizer. The JSON is based on the xls::viz::Package proto (see
-// ir_to_json_test.cc for examples)
+// ir_to_json_test.cc for examples). `thread_count` is passed on to IrToProto.
 absl::StatusOr<std::string> IrToJson(
     Package* package, const DelayEstimator& delay_estimator,
     const PipelineSchedule* schedule = nullptr,
-    std::optional<std::string_view> entry_name = std::nullopt);
+    std::optional<std::string_view> entry_name = std::nullopt,
+    int64_t thread_count = 1);
 
 }  // namespace xls
 
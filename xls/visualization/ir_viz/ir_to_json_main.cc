@@ -45,6 +45,9 @@ ABSL_FLAG(std::string, delay_model, "", "Delay model to use.");
 ABSL_FLAG(std::optional<int64_t>, pipeline_stages, std::nullopt,
           "Pipeline stages to use when scheduling the function");
 ABSL_FLAG(std::optional<std::string>, entry_name, std::nullopt, "Entry name");
+ABSL_FLAG(int64_t, threads, 1,
+          "Number of threads used to analyze the functions, procs and blocks "
+          "of the package. Each is analyzed by a single thread.");
 
 constexpr std::string_view kUsage =
     R"(Expected: ir_to_json_main --delay_model=MODEL [--pipeline_stages=N] [--entry_name=ENTRY] /path/to/file.ir)";
@@ -70,7 +73,8 @@ absl::StatusOr<FunctionBase*> GetFunctionBaseToView(Package* package) {
 absl::Status RealMain(const std::filesystem::path& ir_path,
                       std::string_view delay_model_name,
                       std::optional<int64_t> pipeline_stages,
-                      std::optional<std::string_view> entry_name) {
+                      std::optional<std::string_view> entry_name,
+                      int64_t thread_count) {
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        Parser::ParsePackage(ir_text));
@@ -92,12 +96,14 @@ absl::Status RealMain(const std::filesystem::path& ir_path,
         RunPipelineSchedule(
             func_base->AsFunctionOrDie(), *delay_estimator,
             SchedulingOptions().pipeline_stages(pipeline_stages.value())));
-    XLS_ASSIGN_OR_RETURN(json, IrToJson(package.get(), *delay_estimator,
-                                        &schedule, func_base->name()));
+    XLS_ASSIGN_OR_RETURN(json,
+                         IrToJson(package.get(), *delay_estimator, &schedule,
+                                  func_base->name(), thread_count));
   } else {
     XLS_ASSIGN_OR_RETURN(json,
                          IrToJson(package.get(), *delay_estimator,
-                                  /*schedule=*/nullptr, func_base->name()));
+                                  /*schedule=*/nullptr, func_base->name(),
+                                  thread_count));
   }
   std::cout << json << "\n";
   return absl::OkStatus();
@@ -120,5 +126,6 @@ int main(int argc, char** argv) {
 
   return xls::ExitStatus(xls::RealMain(
       positional_arguments[0], absl::GetFlag(FLAGS_delay_model),
-      absl::GetFlag(FLAGS_pipeline_stages), absl::GetFlag(FLAGS_entry_name)));
+      absl::GetFlag(FLAGS_pipeline_stages), absl::GetFlag(FLAGS_entry_name),
+      absl::GetFlag(FLAGS_threads)));
 }
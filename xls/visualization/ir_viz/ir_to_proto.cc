@@ -14,6 +14,8 @@
 
 #include "xls/visualization/ir_viz/ir_to_proto.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -23,7 +25,9 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -33,11 +37,14 @@
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/delay_model/analyze_critical_path.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/block.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/format_preference.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
@@ -57,31 +64,7 @@ namespace {
 std::string GetNodeUniqueId(
     Node* node,
     const absl::flat_hash_map<FunctionBase*, std::string>& function_ids) {
-  // Parameters can share xls::Node::id() values with non-parameter nodes so
-  // handle them specially.
-  return absl::StrFormat("%s_%s%d", function_ids.at(node->function_base()),
-                         node->Is<Param>() ? "p" : "", node->id());
-}
-
-// Returns a globally unique identifier for the edge.
-std::string GetEdgeUniqueId(
-    Node* source, Node* target,
-    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids) {
-  return absl::StrFormat("%s_to_%s", GetNodeUniqueId(source, function_ids),
-                         GetNodeUniqueId(target, function_ids));
-}
-
-// Create a short unique id for each function. We avoid using function names
-// because they can be very long (e.g., mangled names from xlscc) and because
-// names can be shared between blocks and functions/procs.
-absl::flat_hash_map<FunctionBase*, std::string> GetFunctionIds(
-    Package* package) {
-  absl::flat_hash_map<FunctionBase*, std::string> function_ids;
-  std::vector<FunctionBase*> function_bases = package->GetFunctionBases();
-  for (int64_t i = 0; i < function_bases.size(); ++i) {
-    function_ids[function_bases[i]] = absl::StrCat("f", i);
-  }
-  return function_ids;
+  return GetNodeUniqueId(node, function_ids.at(node->function_base()));
 }
 
 // Visitor which constructs the attributes (if any) of a node and returns them
@@ -141,19 +124,16 @@ std::optional<int64_t> MaybeGetStateParamIndex(Node* node) {
 // Returns the attributes of a node (e.g., the index value of a kTupleIndex
 // instruction) as a proto which is to be serialized to JSON.
 absl::StatusOr<viz::NodeAttributes> NodeAttributes(
-    Node* node,
-    const absl::flat_hash_map<Node*, CriticalPathEntry*>& critical_path_map,
-    const QueryEngine& query_engine, const PipelineSchedule* schedule,
-    const DelayEstimator& delay_estimator) {
+    Node* node, const FunctionBaseAnalysis& analysis,
+    const PipelineSchedule* schedule) {
   AttributeVisitor visitor;
   XLS_RETURN_IF_ERROR(node->VisitSingleNode(&visitor));
   viz::NodeAttributes attributes = visitor.attributes();
-  auto it = critical_path_map.find(node);
-  if (it != critical_path_map.end()) {
+  if (analysis.IsOnCriticalPath(node)) {
     attributes.set_on_critical_path(true);
   }
-  if (query_engine.IsTracked(node)) {
-    attributes.set_known_bits(query_engine.ToString(node));
+  if (analysis.query_engine().IsTracked(node)) {
+    attributes.set_known_bits(analysis.query_engine().ToString(node));
   }
   if (std::optional<int64_t> state_index = MaybeGetStateParamIndex(node);
       state_index.has_value()) {
@@ -165,7 +145,7 @@ absl::StatusOr<viz::NodeAttributes> NodeAttributes(
   }
 
   absl::StatusOr<int64_t> delay_ps_status =
-      delay_estimator.GetOperationDelayInPs(node);
+      analysis.delay_estimator().GetOperationDelayInPs(node);
   // The delay model may not have an estimate for this node. This can occur, for
   // example, when viewing a graph before optimizations and optimizations may
   // eliminate the node kind in question so it never is characterized in the
@@ -185,90 +165,12 @@ absl::StatusOr<viz::FunctionBase> FunctionBaseToVisualizationProto(
     FunctionBase* function, const DelayEstimator& delay_estimator,
     const PipelineSchedule* schedule,
     const absl::flat_hash_map<FunctionBase*, std::string>& function_ids) {
-  viz::FunctionBase proto;
-  proto.set_name(function->name());
-  if (function->IsFunction()) {
-    proto.set_kind("function");
-  } else if (function->IsProc()) {
-    proto.set_kind("proc");
-  } else {
-    XLS_RET_CHECK(function->IsBlock());
-    proto.set_kind("block");
-  }
-  proto.set_id(function_ids.at(function));
-  absl::StatusOr<std::vector<CriticalPathEntry>> critical_path =
-      AnalyzeCriticalPath(function, /*clock_period_ps=*/std::nullopt,
-                          delay_estimator);
-  absl::flat_hash_map<Node*, CriticalPathEntry*> node_to_critical_path_entry;
-  if (critical_path.ok()) {
-    for (CriticalPathEntry& entry : critical_path.value()) {
-      node_to_critical_path_entry[entry.node] = &entry;
-    }
-  } else {
-    LOG(WARNING) << "Could not analyze critical path for function: "
-                 << critical_path.status();
-  }
-
-  std::vector<std::unique_ptr<QueryEngine>> engines;
-  engines.emplace_back(
-      std::make_unique<BddQueryEngine>(BddFunction::kDefaultPathLimit));
-  engines.emplace_back(std::make_unique<TernaryQueryEngine>());
-  UnionQueryEngine query_engine(std::move(engines));
-  XLS_RETURN_IF_ERROR(query_engine.Populate(function).status());
-
-  for (Node* node : function->nodes()) {
-    viz::Node* graph_node = proto.add_nodes();
-    graph_node->set_name(node->GetName());
-    graph_node->set_id(GetNodeUniqueId(node, function_ids));
-    graph_node->set_opcode(OpToString(node->op()));
-    graph_node->set_ir(node->ToStringWithOperandTypes());
-    XLS_ASSIGN_OR_RETURN(
-        *graph_node->mutable_attributes(),
-        NodeAttributes(node, node_to_critical_path_entry, query_engine,
-                       schedule, delay_estimator));
-  }
-  viz::Node* implicit_sink = nullptr;
-  auto get_implicit_sink = [&]() {
-    if (implicit_sink == nullptr) {
-      implicit_sink = proto.add_nodes();
-      implicit_sink->set_name(absl::StrCat(function->name(), "_sink"));
-      implicit_sink->set_id(
-          absl::StrCat("f", function_ids.at(function), "_sink"));
-      implicit_sink->set_opcode("ret");
-      implicit_sink->mutable_attributes()->set_on_critical_path(false);
-    }
-    return implicit_sink;
-  };
-
-  for (Node* node : function->nodes()) {
-    bool node_on_critical_path = node_to_critical_path_entry.contains(node);
-    for (int64_t i = 0; i < node->operand_count(); ++i) {
-      Node* operand = node->operand(i);
-      viz::Edge* graph_edge = proto.add_edges();
-      graph_edge->set_id(GetEdgeUniqueId(operand, node, function_ids));
-      graph_edge->set_source_id(GetNodeUniqueId(operand, function_ids));
-      graph_edge->set_target_id(GetNodeUniqueId(node, function_ids));
-      graph_edge->set_type(operand->GetType()->ToString());
-      graph_edge->set_bit_width(operand->GetType()->GetFlatBitCount());
-      graph_edge->set_on_critical_path(
-          node_on_critical_path &&
-          node_to_critical_path_entry.contains(operand));
-    }
-    if (function->HasImplicitUse(node)) {
-      viz::Node* sink = get_implicit_sink();
-      if (node_on_critical_path) {
-        sink->mutable_attributes()->set_on_critical_path(true);
-      }
-
-      viz::Edge* sink_edge = proto.add_edges();
-      sink_edge->set_id(absl::StrFormat(
-          "%s_to_%s", GetNodeUniqueId(node, function_ids), sink->id()));
-      sink_edge->set_source_id(GetNodeUniqueId(node, function_ids));
-      sink_edge->set_target_id(sink->id());
-      sink_edge->set_on_critical_path(node_on_critical_path);
-    }
-  }
-  return std::move(proto);
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<FunctionBaseAnalysis> analysis,
+      FunctionBaseAnalysis::Create(function, function_ids.at(function),
+                                   delay_estimator));
+  std::vector<Node*> nodes(function->nodes().begin(), function->nodes().end());
+  return FunctionBaseSubgraphToProto(*analysis, nodes, schedule);
 }
 
 // Wraps the given text in a span with the given id, classes, and data. The
@@ -373,7 +275,7 @@ absl::Status WrapFunctionNameInSpan(std::string_view function_name,
 
 absl::StatusOr<std::string> MarkUpIrText(Package* package) {
   absl::flat_hash_map<FunctionBase*, std::string> function_ids =
-      GetFunctionIds(package);
+      GetFunctionBaseIds(package);
 
   std::vector<std::string> lines;
   FunctionBase* current_function = nullptr;
@@ -496,26 +398,179 @@ absl::StatusOr<std::string> MarkUpIrText(Package* package) {
 
 }  // namespace
 
+absl::flat_hash_map<FunctionBase*, std::string> GetFunctionBaseIds(
+    Package* package) {
+  absl::flat_hash_map<FunctionBase*, std::string> function_ids;
+  std::vector<FunctionBase*> function_bases = package->GetFunctionBases();
+  for (int64_t i = 0; i < function_bases.size(); ++i) {
+    function_ids[function_bases[i]] = absl::StrCat("f", i);
+  }
+  return function_ids;
+}
+
+std::string GetNodeUniqueId(Node* node, std::string_view function_id) {
+  // Parameters can share xls::Node::id() values with non-parameter nodes so
+  // handle them specially.
+  return absl::StrFormat("%s_%s%d", function_id, node->Is<Param>() ? "p" : "",
+                         node->id());
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<FunctionBaseAnalysis>>
+FunctionBaseAnalysis::Create(FunctionBase* function_base, std::string_view id,
+                             const DelayEstimator& delay_estimator) {
+  std::vector<std::unique_ptr<QueryEngine>> engines;
+  engines.emplace_back(
+      std::make_unique<BddQueryEngine>(BddFunction::kDefaultPathLimit));
+  engines.emplace_back(std::make_unique<TernaryQueryEngine>());
+  auto query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
+  XLS_RETURN_IF_ERROR(query_engine->Populate(function_base).status());
+
+  auto analysis = absl::WrapUnique(new FunctionBaseAnalysis(
+      function_base, id, delay_estimator, std::move(query_engine)));
+  absl::StatusOr<std::vector<CriticalPathEntry>> critical_path =
+      AnalyzeCriticalPath(function_base, /*clock_period_ps=*/std::nullopt,
+                          delay_estimator);
+  if (critical_path.ok()) {
+    for (const CriticalPathEntry& entry : critical_path.value()) {
+      analysis->critical_path_.push_back(entry.node);
+      analysis->critical_path_nodes_.insert(entry.node);
+    }
+  } else {
+    LOG(WARNING) << "Could not analyze critical path for function: "
+                 << critical_path.status();
+  }
+  return analysis;
+}
+
+absl::StatusOr<viz::FunctionBase> FunctionBaseSubgraphToProto(
+    const FunctionBaseAnalysis& analysis, absl::Span<Node* const> nodes,
+    const PipelineSchedule* schedule) {
+  FunctionBase* function = analysis.function_base();
+  XLS_RET_CHECK(schedule == nullptr || schedule->function_base() == function);
+  viz::FunctionBase proto;
+  proto.set_name(function->name());
+  if (function->IsFunction()) {
+    proto.set_kind("function");
+  } else if (function->IsProc()) {
+    proto.set_kind("proc");
+  } else {
+    XLS_RET_CHECK(function->IsBlock());
+    proto.set_kind("block");
+  }
+  proto.set_id(analysis.id());
+
+  absl::flat_hash_set<Node*> in_subgraph(nodes.begin(), nodes.end());
+  for (Node* node : nodes) {
+    XLS_RET_CHECK_EQ(node->function_base(), function);
+    viz::Node* graph_node = proto.add_nodes();
+    graph_node->set_name(node->GetName());
+    graph_node->set_id(GetNodeUniqueId(node, analysis.id()));
+    graph_node->set_opcode(OpToString(node->op()));
+    graph_node->set_ir(node->ToStringWithOperandTypes());
+    XLS_ASSIGN_OR_RETURN(*graph_node->mutable_attributes(),
+                         NodeAttributes(node, analysis, schedule));
+  }
+  viz::Node* implicit_sink = nullptr;
+  auto get_implicit_sink = [&]() {
+    if (implicit_sink == nullptr) {
+      implicit_sink = proto.add_nodes();
+      implicit_sink->set_name(absl::StrCat(function->name(), "_sink"));
+      implicit_sink->set_id(absl::StrCat("f", analysis.id(), "_sink"));
+      implicit_sink->set_opcode("ret");
+      implicit_sink->mutable_attributes()->set_on_critical_path(false);
+    }
+    return implicit_sink;
+  };
+
+  for (Node* node : nodes) {
+    std::string node_id = GetNodeUniqueId(node, analysis.id());
+    bool node_on_critical_path = analysis.IsOnCriticalPath(node);
+    for (int64_t i = 0; i < node->operand_count(); ++i) {
+      Node* operand = node->operand(i);
+      if (!in_subgraph.contains(operand)) {
+        continue;
+      }
+      std::string operand_id = GetNodeUniqueId(operand, analysis.id());
+      viz::Edge* graph_edge = proto.add_edges();
+      graph_edge->set_id(absl::StrFormat("%s_to_%s", operand_id, node_id));
+      graph_edge->set_source_id(operand_id);
+      graph_edge->set_target_id(node_id);
+      graph_edge->set_type(operand->GetType()->ToString());
+      graph_edge->set_bit_width(operand->GetType()->GetFlatBitCount());
+      graph_edge->set_on_critical_path(node_on_critical_path &&
+                                       analysis.IsOnCriticalPath(operand));
+    }
+    if (function->HasImplicitUse(node)) {
+      viz::Node* sink = get_implicit_sink();
+      if (node_on_critical_path) {
+        sink->mutable_attributes()->set_on_critical_path(true);
+      }
+
+      viz::Edge* sink_edge = proto.add_edges();
+      sink_edge->set_id(absl::StrFormat("%s_to_%s", node_id, sink->id()));
+      sink_edge->set_source_id(node_id);
+      sink_edge->set_target_id(sink->id());
+      sink_edge->set_on_critical_path(node_on_critical_path);
+    }
+  }
+  return std::move(proto);
+}
+
 absl::StatusOr<viz::Package> IrToProto(
     Package* package, const DelayEstimator& delay_estimator,
     const PipelineSchedule* schedule,
-    std::optional<std::string_view> entry_name) {
+    std::optional<std::string_view> entry_name, int64_t thread_count) {
   viz::Package proto;
 
   absl::flat_hash_map<FunctionBase*, std::string> function_ids =
-      GetFunctionIds(package);
+      GetFunctionBaseIds(package);
+
+  std::vector<FunctionBase*> function_bases = package->GetFunctionBases();
+  std::vector<absl::StatusOr<viz::FunctionBase>> function_base_protos(
+      function_bases.size(), absl::UnknownError("Not converted"));
+  auto convert = [&](int64_t i) {
+    FunctionBase* fb = function_bases[i];
+    function_base_protos[i] = FunctionBaseToVisualizationProto(
+        fb, delay_estimator,
+        schedule != nullptr && schedule->function_base() == fb ? schedule
+                                                               : nullptr,
+        function_ids);
+  };
+  int64_t worker_count =
+      std::min(thread_count, static_cast<int64_t>(function_bases.size()));
+  if (worker_count <= 1) {
+    for (int64_t i = 0; i < function_bases.size(); ++i) {
+      convert(i);
+      XLS_RETURN_IF_ERROR(function_base_protos[i].status());
+    }
+  } else {
+    // The analyses of each function base are independent so hand them out to
+    // the workers one at a time. Function bases vary widely in size so this
+    // balances better than a static partition.
+    std::atomic<int64_t> next_index = 0;
+    auto worker = [&]() {
+      for (int64_t i = next_index++; i < function_bases.size();
+           i = next_index++) {
+        convert(i);
+      }
+    };
+    std::vector<std::unique_ptr<Thread>> threads;
+    threads.reserve(worker_count);
+    for (int64_t i = 0; i < worker_count; ++i) {
+      threads.push_back(std::make_unique<Thread>(worker));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+  }
 
   std::optional<FunctionBase*> entry_function_base;
-  for (FunctionBase* fb : package->GetFunctionBases()) {
-    XLS_ASSIGN_OR_RETURN(
-        *proto.add_function_bases(),
-        FunctionBaseToVisualizationProto(
-            fb, delay_estimator,
-            schedule != nullptr && schedule->function_base() == fb ? schedule
-                                                                   : nullptr,
-            function_ids));
-    if (entry_name.has_value() && fb->name() == entry_name.value()) {
-      entry_function_base = fb;
+  for (int64_t i = 0; i < function_bases.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(*proto.add_function_bases(),
+                         std::move(function_base_protos[i]));
+    if (entry_name.has_value() &&
+        function_bases[i]->name() == entry_name.value()) {
+      entry_function_base = function_bases[i];
     }
   }
   proto.set_name(package->name());
@@ -533,4 +588,57 @@ absl::StatusOr<viz::Package> IrToProto(
   return proto;
 }
 
+absl::StatusOr<viz::FunctionBase> FunctionBaseToProto(
+    FunctionBase* function_base, const DelayEstimator& delay_estimator,
+    const PipelineSchedule* schedule) {
+  XLS_RET_CHECK(schedule == nullptr ||
+                schedule->function_base() == function_base);
+  return FunctionBaseToVisualizationProto(
+      function_base, delay_estimator, schedule,
+      GetFunctionBaseIds(function_base->package()));
+}
+
+viz::ColumnarFunctionBase ToColumnar(const viz::FunctionBase& function_base) {
+  viz::ColumnarFunctionBase columnar;
+  columnar.set_name(function_base.name());
+  columnar.set_id(function_base.id());
+  columnar.set_kind(function_base.kind());
+
+  absl::flat_hash_map<std::string, int32_t> string_indices;
+  auto intern = [&](const std::string& str) {
+    auto [it, inserted] =
+        string_indices.try_emplace(str, columnar.strings_size());
+    if (inserted) {
+      columnar.add_strings(str);
+    }
+    return it->second;
+  };
+
+  absl::flat_hash_map<std::string, int32_t> node_indices;
+  node_indices.reserve(function_base.nodes_size());
+  for (const viz::Node& node : function_base.nodes()) {
+    node_indices[node.id()] = columnar.node_names_size();
+    columnar.add_node_names(node.name());
+    columnar.add_node_opcodes(intern(node.opcode()));
+    const viz::NodeAttributes& attributes = node.attributes();
+    columnar.add_node_delays_ps(
+        attributes.has_delay_ps()
+            ? static_cast<int64_t>(attributes.delay_ps())
+            : -1);
+    columnar.add_node_cycles(attributes.has_cycle()
+                                 ? static_cast<int64_t>(attributes.cycle())
+                                 : -1);
+    columnar.add_node_on_critical_path(attributes.on_critical_path());
+  }
+  for (const viz::Edge& edge : function_base.edges()) {
+    columnar.add_edge_sources(node_indices.at(edge.source_id()));
+    columnar.add_edge_targets(node_indices.at(edge.target_id()));
+    columnar.add_edge_bit_widths(
+        edge.has_bit_width() ? static_cast<int64_t>(edge.bit_width()) : 0);
+    columnar.add_edge_types(edge.has_type() ? intern(edge.type()) : -1);
+    columnar.add_edge_on_critical_path(edge.on_critical_path());
+  }
+  return columnar;
+}
+
 }  // namespace xls
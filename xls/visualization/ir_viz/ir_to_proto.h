@@ -15,13 +15,23 @@
 #ifndef XLS_VISUALIZATION_IR_VIZ_IR_TO_PROTO_H_
 #define XLS_VISUALIZATION_IR_VIZ_IR_TO_PROTO_H_
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
 #include "xls/ir/package.h"
+#include "xls/passes/query_engine.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/visualization/ir_viz/visualization.pb.h"
 
@@ -29,10 +39,92 @@ namespace xls {
 
 // Returns a xls::viz::Package proto representation of the given package for use
 // by a visualizer.
+//
+// The function bases are converted independently; with a `thread_count`
+// greater than one they are converted concurrently, which requires
+// `delay_estimator` to be safe to call from multiple threads.
 absl::StatusOr<xls::viz::Package> IrToProto(
     Package* package, const DelayEstimator& delay_estimator,
     const PipelineSchedule* schedule = nullptr,
-    std::optional<std::string_view> entry_name = std::nullopt);
+    std::optional<std::string_view> entry_name = std::nullopt,
+    int64_t thread_count = 1);
+
+// Returns the xls::viz::FunctionBase proto representation of a single function
+// base. This avoids the analysis of the rest of the package (and the marked up
+// IR text) when only one function base is needed. Ids are the same as those
+// produced by IrToProto for the same package.
+absl::StatusOr<xls::viz::FunctionBase> FunctionBaseToProto(
+    FunctionBase* function_base, const DelayEstimator& delay_estimator,
+    const PipelineSchedule* schedule = nullptr);
+
+// Returns the ids given to the function bases of `package` in the
+// visualization protos. Ids are short strings ("f0", "f1", ...) rather than
+// names because names can be very long and are shared between blocks and the
+// functions they were generated from.
+absl::flat_hash_map<FunctionBase*, std::string> GetFunctionBaseIds(
+    Package* package);
+
+// Returns the id of `node` in the visualization protos. `function_id` is the id
+// of the function base containing `node` (see GetFunctionBaseIds).
+std::string GetNodeUniqueId(Node* node, std::string_view function_id);
+
+// The analyses used to annotate the nodes of a function base: its critical
+// path and the bits of each node known by the query engines. Computing these
+// dominates the cost of converting a function base, so a caller which only
+// shows part of a large graph at a time computes them once and converts
+// subgraphs with FunctionBaseSubgraphToProto as they are needed.
+class FunctionBaseAnalysis {
+ public:
+  // `id` is the id of the function base in the visualization protos.
+  static absl::StatusOr<std::unique_ptr<FunctionBaseAnalysis>> Create(
+      FunctionBase* function_base, std::string_view id,
+      const DelayEstimator& delay_estimator);
+
+  FunctionBase* function_base() const { return function_base_; }
+  const std::string& id() const { return id_; }
+  const DelayEstimator& delay_estimator() const { return delay_estimator_; }
+  const QueryEngine& query_engine() const { return *query_engine_; }
+
+  // The nodes on the critical path, starting with the return value (or the
+  // recurrent state of a proc). Empty if the delay model could not estimate
+  // the critical path.
+  absl::Span<Node* const> critical_path() const { return critical_path_; }
+  bool IsOnCriticalPath(Node* node) const {
+    return critical_path_nodes_.contains(node);
+  }
+
+ private:
+  FunctionBaseAnalysis(FunctionBase* function_base, std::string_view id,
+                       const DelayEstimator& delay_estimator,
+                       std::unique_ptr<QueryEngine> query_engine)
+      : function_base_(function_base),
+        id_(id),
+        delay_estimator_(delay_estimator),
+        query_engine_(std::move(query_engine)) {}
+
+  FunctionBase* function_base_;
+  std::string id_;
+  const DelayEstimator& delay_estimator_;
+  std::unique_ptr<QueryEngine> query_engine_;
+  std::vector<Node*> critical_path_;
+  absl::flat_hash_set<Node*> critical_path_nodes_;
+};
+
+// Returns the xls::viz::FunctionBase proto representation of the subgraph of
+// the analyzed function base made up of `nodes`. Only the edges between nodes
+// in `nodes` are included, plus the edges to the implicit sink node of the
+// nodes with implicit uses. Node and edge ids are those of the complete graph
+// so that subgraphs can be merged by the viewer.
+absl::StatusOr<xls::viz::FunctionBase> FunctionBaseSubgraphToProto(
+    const FunctionBaseAnalysis& analysis, absl::Span<Node* const> nodes,
+    const PipelineSchedule* schedule = nullptr);
+
+// Returns a compact column-oriented form of `function_base` suitable for
+// loading graphs too large for the JSON representation. Nodes and edges are
+// referred to by index rather than by string id and the per-node IR text and
+// known bits are dropped.
+xls::viz::ColumnarFunctionBase ToColumnar(
+    const xls::viz::FunctionBase& function_base);
 
 }  // namespace xls
 
@@ -14,10 +14,12 @@
 
 #include "xls/visualization/ir_viz/ir_to_proto.h"
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <string_view>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/log/log.h"
 #include "absl/strings/str_format.h"
@@ -177,5 +179,95 @@ top proc the_proc(tkn: token, x: bits[32], y: bits[64], init={0, 42}) {
   ExpectEqualToGoldenFile(GoldenFilePath("htmltext"), proto.ir_html());
 }
 
+TEST_F(IrToProtoTest, MultipleThreads) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package test
+
+fn f1(z: bits[32]) -> bits[32] {
+  ret neg.1: bits[32] = neg(z, id=1)
+}
+
+fn f2(z: bits[32]) -> bits[32] {
+  ret not.2: bits[32] = not(z, id=2)
+}
+
+fn main(x: bits[32], xx: bits[32]) -> bits[32] {
+  a: bits[32] = invoke(x, to_apply=f1)
+  b: bits[32] = invoke(xx, to_apply=f2)
+  ret sub: bits[32] = sub(a, b)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * delay_estimator,
+                           GetDelayEstimator("unit"));
+  XLS_ASSERT_OK_AND_ASSIGN(viz::Package serial,
+                           IrToProto(p.get(), *delay_estimator,
+                                     /*schedule=*/nullptr,
+                                     /*entry_name=*/"main",
+                                     /*thread_count=*/1));
+  XLS_ASSERT_OK_AND_ASSIGN(viz::Package parallel,
+                           IrToProto(p.get(), *delay_estimator,
+                                     /*schedule=*/nullptr,
+                                     /*entry_name=*/"main",
+                                     /*thread_count=*/4));
+  EXPECT_EQ(serial.SerializeAsString(), parallel.SerializeAsString());
+
+  // Converting a single function base gives the same result as converting the
+  // whole package.
+  ASSERT_EQ(serial.function_bases_size(), 3);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, p->GetFunction("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(viz::FunctionBase main_proto,
+                           FunctionBaseToProto(main, *delay_estimator));
+  EXPECT_EQ(main_proto.SerializeAsString(),
+            serial.function_bases(2).SerializeAsString());
+}
+
+TEST_F(IrToProtoTest, Columnar) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package test
+
+fn main(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.1: bits[32] = add(x, y)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * delay_estimator,
+                           GetDelayEstimator("unit"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, p->GetFunction("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(viz::FunctionBase proto,
+                           FunctionBaseToProto(main, *delay_estimator));
+  viz::ColumnarFunctionBase columnar = ToColumnar(proto);
+
+  EXPECT_EQ(columnar.name(), "main");
+  EXPECT_EQ(columnar.kind(), "function");
+  // The parameters, the add and the implicit sink of the return value.
+  ASSERT_EQ(columnar.node_names_size(), 4);
+  EXPECT_EQ(columnar.node_opcodes_size(), 4);
+  EXPECT_EQ(columnar.node_delays_ps_size(), 4);
+  EXPECT_EQ(columnar.node_cycles_size(), 4);
+  EXPECT_EQ(columnar.node_on_critical_path_size(), 4);
+  // Opcodes and types are each stored once.
+  EXPECT_THAT(columnar.strings(),
+              testing::UnorderedElementsAre("param", "add", "ret", "bits[32]"));
+
+  ASSERT_EQ(columnar.edge_sources_size(), 3);
+  for (int64_t i = 0; i < columnar.edge_sources_size(); ++i) {
+    const viz::Edge& edge = proto.edges(i);
+    EXPECT_EQ(proto.nodes(columnar.edge_sources(i)).id(), edge.source_id());
+    EXPECT_EQ(proto.nodes(columnar.edge_targets(i)).id(), edge.target_id());
+    if (edge.has_type()) {
+      EXPECT_EQ(columnar.strings(columnar.edge_types(i)), edge.type());
+      EXPECT_EQ(columnar.edge_bit_widths(i), 32);
+    } else {
+      EXPECT_EQ(columnar.edge_types(i), -1);
+    }
+  }
+  for (int64_t i = 0; i < columnar.node_names_size(); ++i) {
+    EXPECT_EQ(columnar.node_names(i), proto.nodes(i).name());
+    EXPECT_EQ(columnar.strings(columnar.node_opcodes(i)),
+              proto.nodes(i).opcode());
+    // The function is not scheduled.
+    EXPECT_EQ(columnar.node_cycles(i), -1);
+  }
+}
+
 }  // namespace
 }  // namespace xls
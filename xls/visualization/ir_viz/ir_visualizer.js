@@ -195,6 +195,15 @@ class IrVisualizer {
      */
     this.selectedFunctionId_ = null;
 
+    /**
+     *  Whether the server loads the graphs lazily (app.py --lazy). If so the
+     *  package holds only the names and ids of the function bases, the graph
+     *  of the selected function starts out as its critical path, and the
+     *  neighborhood of each selected node is added to it as it is selected.
+     *  @private {boolean}
+     */
+    this.lazy_ = false;
+
     let self = this;
     this.functionSelector_.addEventListener('change', e => {
       if (e.target.value) {
@@ -394,6 +403,59 @@ class IrVisualizer {
    */
   selectNode(nodeId, value) {
     this.applyChange_(this.graph_.selectNode(nodeId, value));
+    if (this.lazy_ && value) {
+      this.loadNeighborhood_(nodeId);
+    }
+  }
+
+  /**
+   * Sends a request for a subgraph of the selected function to the server and
+   * calls `cb` with the graph in the response.
+   * @param {string} url
+   * @param {function(!Object)} cb
+   * @private
+   */
+  requestSubgraph_(url, cb) {
+    let functionId = this.selectedFunctionId_;
+    let xmr = new XMLHttpRequest();
+    xmr.open('GET', url);
+    let self = this;
+    xmr.addEventListener('load', function() {
+      if (xmr.status < 200 || xmr.status >= 400) {
+        return;
+      }
+      let response = /** @type {!Object} */ (JSON.parse(xmr.responseText));
+      if (functionId != self.selectedFunctionId_) {
+        // Another function was selected while the request was in flight.
+        return;
+      }
+      if (response['error_code'] != 'ok') {
+        if (!!self.sourceErrorCallback_) {
+          self.sourceErrorCallback_(response['message']);
+        }
+        return;
+      }
+      cb(response['graph']);
+    });
+    xmr.send();
+  }
+
+  /**
+   * Adds the neighborhood of the given node to the graph of the selected
+   * function and redraws the graph if it grew.
+   * @param {string} nodeId
+   * @private
+   */
+  loadNeighborhood_(nodeId) {
+    let url = '/neighborhood?function_id=' +
+        encodeURIComponent(this.selectedFunctionId_) +
+        '&node_id=' + encodeURIComponent(nodeId);
+    this.requestSubgraph_(url, (graph) => {
+      if (this.irGraph_.addElements(graph) && this.graphView_) {
+        this.graphView_.destroy();
+        this.draw(document.getElementById('only-selected-checkbox').checked);
+      }
+    });
   }
 
   /**
@@ -414,8 +476,22 @@ class IrVisualizer {
     if (graph == null) {
       return;
     }
-    this.irGraph_ = new irGraph.IrGraph(graph);
-    this.graph_ = new selectableGraph.SelectableGraph(this.irGraph_);
+    if (this.lazy_) {
+      // Start with the critical path of the function. The IR text is not
+      // marked up.
+      this.selectedFunctionId_ = functionId;
+      this.requestSubgraph_(
+          '/critical_path?function_id=' + encodeURIComponent(functionId),
+          (criticalPath) => {
+            this.showGraph_(criticalPath);
+            if (this.graphView_) {
+              this.draw(
+                  document.getElementById('only-selected-checkbox').checked);
+            }
+          });
+      return;
+    }
+    this.showGraph_(graph);
     this.highlightIr_(graph);
     this.setIrTextListeners_();
     this.selectedFunctionId_ = functionId;
@@ -440,6 +516,16 @@ class IrVisualizer {
         .classList.add('ir-function-selected');
   }
 
+  /**
+   * Constructs the IR graph and selectable graph of the given function graph.
+   * @param {!Object} graph
+   * @private
+   */
+  showGraph_(graph) {
+    this.irGraph_ = new irGraph.IrGraph(graph);
+    this.graph_ = new selectableGraph.SelectableGraph(this.irGraph_);
+  }
+
   /**
    * Sets various listeners for hovering over and selecting identifiers in the
    * IR text.
@@ -534,6 +620,7 @@ class IrVisualizer {
           self.sourceOkCallback_();
         }
         self.package_ = response['graph'];
+        self.lazy_ = !!response['lazy'];
 
         // Fill in the names and ids of function in the select element.
         let functions = [];
@@ -616,8 +703,12 @@ class IrVisualizer {
     this.graphView_.setClickCallback((nodeId, ctrlPressed) => {
       if (nodeId) {
         if (ctrlPressed) {
-          // Scroll the node into view in the IR text window.
-          document.getElementById(`ir-node-def-${nodeId}`).scrollIntoView();
+          // Scroll the node into view in the IR text window. The IR text is
+          // not marked up when graphs are loaded lazily.
+          let nodeDef = document.getElementById(`ir-node-def-${nodeId}`);
+          if (nodeDef) {
+            nodeDef.scrollIntoView();
+          }
         } else {
           // Toggle the selection state.
           this.selectNode(nodeId, !this.graph_.isNodeSelected(nodeId));
@@ -0,0 +1,112 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Keeps an IR package loaded and serves parts of its visualization on demand,
+// for packages too large to convert with ir_to_json_main. Each line read from
+// stdin is an xls.viz.Request in JSON form and is answered with one line on
+// stdout holding an xls.viz.Response in JSON form. Function bases are analyzed
+// the first time a request refers to them. The visualization app runs this
+// binary when given --lazy.
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "google/protobuf/util/json_util.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/delay_model/delay_estimators.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/visualization/ir_viz/visualization.pb.h"
+#include "xls/visualization/ir_viz/visualization_session.h"
+
+ABSL_FLAG(std::string, delay_model, "", "Delay model to use.");
+
+constexpr std::string_view kUsage =
+    R"(Expected: ir_viz_server_main --delay_model=MODEL /path/to/file.ir)";
+
+namespace xls {
+namespace {
+
+absl::Status RealMain(std::string_view ir_path,
+                      std::string_view delay_model_name) {
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text));
+  XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
+                       GetDelayEstimator(delay_model_name));
+  VisualizationSession session(std::move(package), *delay_estimator);
+
+  google::protobuf::util::JsonParseOptions parse_options;
+  parse_options.ignore_unknown_fields = true;
+  google::protobuf::util::JsonPrintOptions print_options;
+  print_options.preserve_proto_field_names = true;
+
+  std::string line;
+  while (std::getline(std::cin, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    viz::Request request;
+    viz::Response response;
+    if (auto status = google::protobuf::util::JsonStringToMessage(line, &request,
+                                                        parse_options);
+        status.ok()) {
+      response = session.Handle(request);
+    } else {
+      response.set_error(
+          absl::StrCat("Invalid request: ", std::string{status.message()}));
+    }
+    std::string json;
+    if (auto status =
+            google::protobuf::util::MessageToJsonString(response, &json, print_options);
+        !status.ok()) {
+      return absl::InternalError(std::string{status.message()});
+    }
+    std::cout << json << std::endl;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.size() != 1 || positional_arguments[0].empty()) {
+    LOG(QFATAL) << "Expected one position argument (IR path): " << argv[0]
+                << " <ir_path>";
+  }
+  if (absl::GetFlag(FLAGS_delay_model).empty()) {
+    LOG(QFATAL) << "--delay_model is required";
+  }
+
+  return xls::ExitStatus(xls::RealMain(positional_arguments[0],
+                                       absl::GetFlag(FLAGS_delay_model)));
+}
@@ -0,0 +1,205 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/visualization/ir_viz/visualization_session.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/visualization/ir_viz/ir_to_proto.h"
+#include "xls/visualization/ir_viz/visualization.pb.h"
+
+namespace xls {
+namespace {
+
+std::string_view KindOf(FunctionBase* function_base) {
+  if (function_base->IsFunction()) {
+    return "function";
+  }
+  if (function_base->IsProc()) {
+    return "proc";
+  }
+  return "block";
+}
+
+}  // namespace
+
+VisualizationSession::VisualizationSession(
+    std::unique_ptr<Package> package, const DelayEstimator& delay_estimator)
+    : package_(std::move(package)),
+      delay_estimator_(delay_estimator),
+      function_ids_(GetFunctionBaseIds(package_.get())) {
+  for (const auto& [function_base, id] : function_ids_) {
+    function_bases_by_id_[id] = function_base;
+  }
+}
+
+viz::Package VisualizationSession::GetOutline(
+    std::optional<std::string_view> entry_name) const {
+  viz::Package proto;
+  proto.set_name(package_->name());
+  std::optional<FunctionBase*> entry;
+  for (FunctionBase* function_base : package_->GetFunctionBases()) {
+    viz::FunctionBase* function_base_proto = proto.add_function_bases();
+    function_base_proto->set_name(function_base->name());
+    function_base_proto->set_id(function_ids_.at(function_base));
+    function_base_proto->set_kind(KindOf(function_base));
+    if (entry_name.has_value() && function_base->name() == *entry_name) {
+      entry = function_base;
+    }
+  }
+  if (!entry.has_value()) {
+    entry = package_->GetTop();
+  }
+  if (entry.has_value()) {
+    proto.set_entry_id(function_ids_.at(*entry));
+  }
+  return proto;
+}
+
+absl::StatusOr<VisualizationSession::AnalyzedFunctionBase*>
+VisualizationSession::GetAnalyzedFunctionBase(std::string_view function_id) {
+  auto it = function_bases_by_id_.find(function_id);
+  if (it == function_bases_by_id_.end()) {
+    return absl::NotFoundError(
+        absl::StrFormat("No function base with id `%s`", function_id));
+  }
+  FunctionBase* function_base = it->second;
+  std::unique_ptr<AnalyzedFunctionBase>& analyzed = analyzed_[function_base];
+  if (analyzed != nullptr) {
+    return analyzed.get();
+  }
+
+  absl::Time start = absl::Now();
+  auto result = std::make_unique<AnalyzedFunctionBase>();
+  XLS_ASSIGN_OR_RETURN(result->analysis,
+                       FunctionBaseAnalysis::Create(
+                           function_base, function_id, delay_estimator_));
+  result->nodes_by_id.reserve(function_base->node_count());
+  for (Node* node : function_base->nodes()) {
+    result->nodes_by_id[GetNodeUniqueId(node, function_id)] = node;
+  }
+  VLOG(1) << absl::StreamFormat("Analyzed %s (%d nodes) in %s",
+                                function_base->name(),
+                                function_base->node_count(),
+                                absl::FormatDuration(absl::Now() - start));
+  analyzed = std::move(result);
+  return analyzed.get();
+}
+
+absl::StatusOr<viz::FunctionBase> VisualizationSession::GetNeighborhood(
+    std::string_view function_id, std::string_view node_id, int64_t radius,
+    std::optional<int64_t> max_nodes) {
+  XLS_RET_CHECK_GE(radius, 0);
+  XLS_RET_CHECK(!max_nodes.has_value() || *max_nodes > 0);
+  XLS_ASSIGN_OR_RETURN(AnalyzedFunctionBase * analyzed,
+                       GetAnalyzedFunctionBase(function_id));
+  auto it = analyzed->nodes_by_id.find(node_id);
+  if (it == analyzed->nodes_by_id.end()) {
+    return absl::NotFoundError(absl::StrFormat(
+        "No node with id `%s` in function base `%s`", node_id, function_id));
+  }
+
+  // Breadth-first search over operands and users. `nodes[frontier_begin, end)`
+  // holds the nodes at the current distance from the start node.
+  std::vector<Node*> nodes = {it->second};
+  absl::flat_hash_set<Node*> visited = {it->second};
+  auto is_full = [&]() {
+    return max_nodes.has_value() && nodes.size() >= *max_nodes;
+  };
+  int64_t frontier_begin = 0;
+  for (int64_t distance = 0; distance < radius && !is_full(); ++distance) {
+    int64_t frontier_end = nodes.size();
+    for (int64_t i = frontier_begin; i < frontier_end && !is_full(); ++i) {
+      auto visit = [&](Node* neighbor) {
+        if (!is_full() && visited.insert(neighbor).second) {
+          nodes.push_back(neighbor);
+        }
+      };
+      for (Node* operand : nodes[i]->operands()) {
+        visit(operand);
+      }
+      for (Node* user : nodes[i]->users()) {
+        visit(user);
+      }
+    }
+    frontier_begin = frontier_end;
+  }
+  return FunctionBaseSubgraphToProto(*analyzed->analysis, nodes);
+}
+
+absl::StatusOr<viz::FunctionBase> VisualizationSession::GetCriticalPath(
+    std::string_view function_id) {
+  XLS_ASSIGN_OR_RETURN(AnalyzedFunctionBase * analyzed,
+                       GetAnalyzedFunctionBase(function_id));
+  return FunctionBaseSubgraphToProto(*analyzed->analysis,
+                                     analyzed->analysis->critical_path());
+}
+
+viz::Response VisualizationSession::Handle(const viz::Request& request) {
+  viz::Response response;
+  absl::StatusOr<viz::FunctionBase> graph;
+  switch (request.request_case()) {
+    case viz::Request::kOutline:
+      *response.mutable_outline() = GetOutline(
+          request.outline().has_entry_name()
+              ? std::make_optional<std::string_view>(
+                    request.outline().entry_name())
+              : std::nullopt);
+      return response;
+    case viz::Request::kNeighborhood: {
+      const viz::NeighborhoodRequest& neighborhood = request.neighborhood();
+      graph = GetNeighborhood(
+          neighborhood.function_id(), neighborhood.node_id(),
+          neighborhood.radius(),
+          neighborhood.has_max_nodes()
+              ? std::make_optional(neighborhood.max_nodes())
+              : std::nullopt);
+      break;
+    }
+    case viz::Request::kCriticalPath:
+      graph = GetCriticalPath(request.critical_path().function_id());
+      break;
+    case viz::Request::REQUEST_NOT_SET:
+      graph = absl::InvalidArgumentError("Empty request");
+      break;
+  }
+  if (graph.ok()) {
+    *response.mutable_graph() = *std::move(graph);
+  } else {
+    response.set_error(graph.status().ToString());
+  }
+  return response;
+}
+
+}  // namespace xls
@@ -0,0 +1,95 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_VISUALIZATION_IR_VIZ_VISUALIZATION_SESSION_H_
+#define XLS_VISUALIZATION_IR_VIZ_VISUALIZATION_SESSION_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/visualization/ir_viz/ir_to_proto.h"
+#include "xls/visualization/ir_viz/visualization.pb.h"
+
+namespace xls {
+
+// Serves parts of the visualization of a package on demand. IrToProto
+// analyzes every function base of the package up front, which takes far too
+// long (and produces far too much JSON) for packages with hundreds of
+// thousands of nodes. A session instead analyzes a function base the first
+// time a request refers to it and keeps the analysis for later requests, and
+// returns only the requested subgraph: the neighborhood of a node or the
+// critical path. Node and edge ids are those produced by IrToProto.
+//
+// Thread-compatible.
+class VisualizationSession {
+ public:
+  VisualizationSession(std::unique_ptr<Package> package,
+                       const DelayEstimator& delay_estimator);
+
+  Package* package() const { return package_.get(); }
+
+  // Returns the package with the name, id and kind of each function base but
+  // none of their nodes and no IR text. The entry is the function base named
+  // `entry_name` if given, otherwise the top of the package.
+  viz::Package GetOutline(
+      std::optional<std::string_view> entry_name = std::nullopt) const;
+
+  // Returns the subgraph of the nodes at most `radius` operand or user edges
+  // away from the node with id `node_id`, in breadth-first order. If
+  // `max_nodes` is given, returns at most that many nodes.
+  absl::StatusOr<viz::FunctionBase> GetNeighborhood(
+      std::string_view function_id, std::string_view node_id, int64_t radius,
+      std::optional<int64_t> max_nodes = std::nullopt);
+
+  // Returns the subgraph of the nodes on the critical path of the function
+  // base.
+  absl::StatusOr<viz::FunctionBase> GetCriticalPath(
+      std::string_view function_id);
+
+  // Dispatches `request` to the methods above. Errors are returned in the
+  // `error` field of the response.
+  viz::Response Handle(const viz::Request& request);
+
+ private:
+  struct AnalyzedFunctionBase {
+    std::unique_ptr<FunctionBaseAnalysis> analysis;
+    absl::flat_hash_map<std::string, Node*> nodes_by_id;
+  };
+
+  // Returns the analysis of the function base with the given id, analyzing it
+  // if this is the first request for it.
+  absl::StatusOr<AnalyzedFunctionBase*> GetAnalyzedFunctionBase(
+      std::string_view function_id);
+
+  std::unique_ptr<Package> package_;
+  const DelayEstimator& delay_estimator_;
+  absl::flat_hash_map<FunctionBase*, std::string> function_ids_;
+  absl::flat_hash_map<std::string, FunctionBase*> function_bases_by_id_;
+  absl::flat_hash_map<FunctionBase*, std::unique_ptr<AnalyzedFunctionBase>>
+      analyzed_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_VISUALIZATION_IR_VIZ_VISUALIZATION_SESSION_H_
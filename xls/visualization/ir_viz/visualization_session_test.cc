@@ -0,0 +1,206 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/visualization/ir_viz/visualization_session.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/matchers.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/delay_model/delay_estimators.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/visualization/ir_viz/ir_to_proto.h"
+#include "xls/visualization/ir_viz/visualization.pb.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::IsSupersetOf;
+using ::testing::UnorderedElementsAre;
+
+constexpr char kIr[] = R"(
+package test
+
+fn helper(a: bits[8]) -> bits[8] {
+  ret neg.1: bits[8] = neg(a)
+}
+
+top fn main(x: bits[8], y: bits[8]) -> bits[8] {
+  add.2: bits[8] = add(x, y)
+  sub.3: bits[8] = sub(add.2, y)
+  umul.4: bits[8] = umul(sub.3, sub.3)
+  ret and.5: bits[8] = and(umul.4, x)
+}
+)";
+
+std::vector<std::string> NodeNames(const viz::FunctionBase& proto) {
+  std::vector<std::string> names;
+  for (const viz::Node& node : proto.nodes()) {
+    names.push_back(node.name());
+  }
+  return names;
+}
+
+std::vector<std::string> EdgeIds(const viz::FunctionBase& proto) {
+  std::vector<std::string> ids;
+  for (const viz::Edge& edge : proto.edges()) {
+    ids.push_back(edge.id());
+  }
+  return ids;
+}
+
+class VisualizationSessionTest : public IrTestBase {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(kIr));
+    XLS_ASSERT_OK_AND_ASSIGN(delay_estimator_, GetDelayEstimator("unit"));
+    session_ = std::make_unique<VisualizationSession>(std::move(p),
+                                                      *delay_estimator_);
+  }
+
+  // Returns the visualization id of the node of `main` with the given name.
+  std::string MainNodeId(std::string_view name) {
+    return GetNodeUniqueId(
+        FindNode(name, FindFunction("main", session_->package())), "f1");
+  }
+
+  std::string MainEdgeId(std::string_view source, std::string_view target) {
+    return absl::StrFormat("%s_to_%s", MainNodeId(source), MainNodeId(target));
+  }
+
+  DelayEstimator* delay_estimator_;
+  std::unique_ptr<VisualizationSession> session_;
+};
+
+TEST_F(VisualizationSessionTest, Outline) {
+  viz::Package outline = session_->GetOutline();
+  EXPECT_EQ(outline.name(), "test");
+  ASSERT_EQ(outline.function_bases_size(), 2);
+  EXPECT_EQ(outline.function_bases(0).name(), "helper");
+  EXPECT_EQ(outline.function_bases(0).id(), "f0");
+  EXPECT_EQ(outline.function_bases(0).kind(), "function");
+  EXPECT_EQ(outline.function_bases(1).name(), "main");
+  EXPECT_EQ(outline.function_bases(1).id(), "f1");
+  EXPECT_THAT(outline.function_bases(1).nodes(), IsEmpty());
+  EXPECT_FALSE(outline.has_ir_html());
+  EXPECT_EQ(outline.entry_id(), "f1");
+
+  EXPECT_EQ(session_->GetOutline("helper").entry_id(), "f0");
+}
+
+TEST_F(VisualizationSessionTest, Neighborhood) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      viz::FunctionBase radius0,
+      session_->GetNeighborhood("f1", MainNodeId("sub.3"), 0));
+  EXPECT_THAT(NodeNames(radius0), ElementsAre("sub.3"));
+  EXPECT_THAT(EdgeIds(radius0), IsEmpty());
+
+  // Only the edges between nodes of the neighborhood are included. umul.4 uses
+  // sub.3 twice.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      viz::FunctionBase radius1,
+      session_->GetNeighborhood("f1", MainNodeId("sub.3"), 1));
+  EXPECT_EQ(radius1.id(), "f1");
+  EXPECT_THAT(NodeNames(radius1), ElementsAre("sub.3", "add.2", "y", "umul.4"));
+  EXPECT_THAT(EdgeIds(radius1),
+              UnorderedElementsAre(
+                  MainEdgeId("add.2", "sub.3"), MainEdgeId("y", "sub.3"),
+                  MainEdgeId("y", "add.2"), MainEdgeId("sub.3", "umul.4"),
+                  MainEdgeId("sub.3", "umul.4")));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      viz::FunctionBase limited,
+      session_->GetNeighborhood("f1", MainNodeId("sub.3"), 2,
+                                /*max_nodes=*/3));
+  EXPECT_THAT(NodeNames(limited), ElementsAre("sub.3", "add.2", "y"));
+}
+
+TEST_F(VisualizationSessionTest, SubgraphsMatchFullConversion) {
+  absl::flat_hash_map<std::string, viz::Node> full_nodes;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      viz::FunctionBase full,
+      FunctionBaseToProto(FindFunction("main", session_->package()),
+                          *delay_estimator_));
+  for (const viz::Node& node : full.nodes()) {
+    full_nodes[node.id()] = node;
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(viz::FunctionBase neighborhood,
+                           session_->GetNeighborhood("f1", MainNodeId("x"), 8));
+  EXPECT_EQ(neighborhood.nodes_size(), full_nodes.size());
+  for (const viz::Node& node : neighborhood.nodes()) {
+    ASSERT_TRUE(full_nodes.contains(node.id())) << node.id();
+    EXPECT_EQ(node.ir(), full_nodes.at(node.id()).ir());
+    EXPECT_EQ(node.attributes().known_bits(),
+              full_nodes.at(node.id()).attributes().known_bits());
+    EXPECT_EQ(node.attributes().on_critical_path(),
+              full_nodes.at(node.id()).attributes().on_critical_path());
+  }
+}
+
+TEST_F(VisualizationSessionTest, CriticalPath) {
+  XLS_ASSERT_OK_AND_ASSIGN(viz::FunctionBase critical_path,
+                           session_->GetCriticalPath("f1"));
+  EXPECT_THAT(NodeNames(critical_path),
+              IsSupersetOf({"and.5", "umul.4", "sub.3", "add.2", "main_sink"}));
+  for (const viz::Node& node : critical_path.nodes()) {
+    EXPECT_TRUE(node.attributes().on_critical_path()) << node.name();
+  }
+}
+
+TEST_F(VisualizationSessionTest, Errors) {
+  EXPECT_THAT(session_->GetCriticalPath("f7"),
+              StatusIs(absl::StatusCode::kNotFound, HasSubstr("f7")));
+  EXPECT_THAT(session_->GetNeighborhood("f1", "f1_42", 1),
+              StatusIs(absl::StatusCode::kNotFound, HasSubstr("f1_42")));
+
+  viz::Request request;
+  request.mutable_critical_path()->set_function_id("f7");
+  viz::Response response = session_->Handle(request);
+  EXPECT_THAT(response.error(), HasSubstr("f7"));
+  EXPECT_FALSE(response.has_graph());
+}
+
+TEST_F(VisualizationSessionTest, Handle) {
+  viz::Request request;
+  request.mutable_outline();
+  viz::Response response = session_->Handle(request);
+  EXPECT_FALSE(response.has_error());
+  EXPECT_EQ(response.outline().function_bases_size(), 2);
+
+  request.mutable_neighborhood()->set_function_id("f0");
+  request.mutable_neighborhood()->set_node_id("f0_1");
+  request.mutable_neighborhood()->set_radius(1);
+  response = session_->Handle(request);
+  EXPECT_FALSE(response.has_error());
+  EXPECT_THAT(NodeNames(response.graph()), ElementsAre("neg.1", "a"));
+}
+
+}  // namespace
+}  // namespace xls